@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Merge per-process Chrome traces into one cluster timeline.
+
+Each coordinator or worker process traced with SIM_TRACE (or
+distributed_demo --trace) writes its own trace-event JSON, stamped in
+wall-clock microseconds and labelled with its process id, so merging is
+a concatenation of the event lists. Processes from different hosts that
+happen to share a pid are renumbered. Flow events already pair a send
+with the handler in the receiving process by span id.
+
+--offset FILE=US shifts one file's timestamps (known clock skew).
+
+Usage:
+    SIM_TRACE=/tmp/trace-%p.json <run coordinator and workers>
+    scripts/merge_traces.py /tmp/trace-*.json -o cluster.json
+    (open cluster.json in chrome://tracing or ui.perfetto.dev)
+"""
+
+import argparse
+import json
+import sys
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    ap.add_argument("traces", nargs="+", help="per-process trace files")
+    ap.add_argument("-o", "--output", default="-", help="merged trace (default: stdout)")
+    ap.add_argument("--offset", action="append", default=[], metavar="FILE=US",
+                    help="add US microseconds to FILE's timestamps; repeatable")
+    args = ap.parse_args()
+
+    offsets = {}
+    for spec in args.offset:
+        name, _, us = spec.rpartition("=")
+        offsets[name] = float(us)
+
+    merged = []
+    used_pids = set()
+    dropped = 0
+    for path in args.traces:
+        with open(path) as f:
+            doc = json.load(f)
+        events = doc.get("traceEvents", [])
+        dropped += doc.get("droppedSpans", 0)
+
+        # A pid already taken by another file gets a fresh one
+        remap = {}
+        for pid in sorted({e.get("pid", 0) for e in events}):
+            new = pid
+            while new in used_pids:
+                new += 1 << 22
+            remap[pid] = new
+            used_pids.add(new)
+
+        shift = offsets.get(path, 0.0)
+        for e in events:
+            e["pid"] = remap.get(e.get("pid", 0), e.get("pid", 0))
+            if "ts" in e:
+                e["ts"] += shift
+            merged.append(e)
+
+    merged.sort(key=lambda e: (e.get("ph") != "M", e.get("ts", 0.0)))
+    out = {"displayTimeUnit": "ms", "traceEvents": merged}
+    if dropped:
+        out["droppedSpans"] = dropped
+        print(f"warning: {dropped} spans were dropped at capture", file=sys.stderr)
+
+    if args.output == "-":
+        json.dump(out, sys.stdout)
+        sys.stdout.write("\n")
+    else:
+        with open(args.output, "w") as f:
+            json.dump(out, f)
+        print(f"{len(merged)} events from {len(args.traces)} files -> {args.output}",
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,368 @@
+#!/usr/bin/env python3
+"""
+Performance regression gate with golden-output equivalence checks.
+
+Runs the shipped demos and Monte Carlo scenarios with fixed seeds in a
+scratch directory, fingerprints what they write, and compares results and
+runtime against the baselines in data/regression/golden.json.
+
+Fingerprints are compact. Every output (a JSON file, a text file or the
+program's stdout) is flattened to its leaf values, grouped by path with
+array indices dropped ("runs[].engagementLog[].time"). Per group the
+gate keeps the count, sum, absolute sum, min, max and up to 8 evenly
+spaced checkpoint values, plus one hash over every value quantized to
+9 significant digits. Text that is not valid JSON is read as lines of
+numbers, grouped by the line with its numbers blanked out.
+
+A case passes when its hash matches, or else when every group agrees
+within the case tolerance (relative, with an absolute floor for values
+near zero) and no group appeared or vanished. Runtime is the median wall
+time over --repeat runs; it regresses when it exceeds the baseline by
+more than --runtime-threshold and by more than --runtime-floor seconds
+(so millisecond demos cannot flap). Runs that disagree with each other
+are reported as nondeterministic.
+
+Usage:
+    scripts/regression_gate.py [--build-dir _gate_build] [--case NAME]...
+                               [--repeat 3] [--runtime-threshold 0.25]
+                               [--runtime-floor 0.05] [--no-runtime]
+                               [--slow] [--update] [--list]
+
+--update rewrites the golden file from this build (only the cases run;
+others are kept). Runtimes are machine-specific: refresh them on the
+machine that gates, or pass --no-runtime elsewhere. Exit status is 0 on
+pass, 1 on any drift or regression, 2 on a harness error.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+GOLDEN = os.path.join(REPO, "data", "regression", "golden.json")
+SCENARIOS = os.path.join(REPO, "visualization", "cesium", "scenarios")
+
+CHECKPOINTS = 8
+DIGITS = 9
+
+# Lines and keys that carry wall-clock measurements, not results
+TIMING_LINE = re.compile(r"(?i)\b(completed in|elapsed|wall[- ]?time|took)\b|\d\s*ms\b")
+TIMING_KEY = re.compile(r"(?i)^(wall|elapsed|runtime|timestamp)")
+
+NUMBER = re.compile(r"[-+]?(?:\d+\.\d*|\.\d+|\d+)(?:[eE][-+]?\d+)?")
+
+
+def mc(name, scenario, runs=20, max_time=300, extra=()):
+    return {
+        "name": name,
+        "cmd": ["mc_engine", "--scenario", os.path.join(SCENARIOS, scenario),
+                "--runs", str(runs), "--seed", "42", "--max-time", str(max_time),
+                "--output", "out.json", *extra],
+        "outputs": ["out.json"],
+        "stdout": False,
+    }
+
+
+# name, command (binary first, run from the scratch directory), outputs to
+# fingerprint, whether stdout is fingerprinted, per-case tolerance
+CASES = [
+    {"name": "perturbation_demo", "cmd": ["perturbation_demo"],
+     "outputs": ["perturbation_data.json"], "stdout": True},
+    {"name": "gps_pdop_demo", "cmd": ["gps_pdop_demo"],
+     "outputs": ["visualization/cesium/gps_pdop_data.json"], "stdout": True},
+    {"name": "launch_intercept_demo", "cmd": ["launch_intercept_demo"],
+     "outputs": ["launch_intercept_data.json", "launch_orbit_insertion.json"],
+     "stdout": True},
+    {"name": "geo_rendezvous_demo", "cmd": ["geo_rendezvous_demo"],
+     "outputs": ["geo_rendezvous_data.json"], "stdout": True},
+    {"name": "rendezvous_demo", "cmd": ["rendezvous_demo"],
+     "outputs": ["rendezvous_data.json"], "stdout": True},
+    {"name": "simple_gravity_turn", "cmd": ["simple_gravity_turn"],
+     "outputs": ["gravity_turn_data.json"], "stdout": True},
+    {"name": "interplanetary_demo", "cmd": ["interplanetary_demo"],
+     "outputs": ["interplanetary_trajectory.json", "interplanetary_porkchop.json",
+                 "interplanetary_evm_mission.json"], "stdout": True},
+    {"name": "lunar_return_demo", "cmd": ["lunar_return_demo"],
+     "outputs": ["visualization/cesium/lunar_return_data.json"], "stdout": True},
+    {"name": "leo_imager_demo", "cmd": ["leo_imager_demo"],
+     "outputs": ["visualization/cesium/leo_imagers_data.json"], "stdout": True},
+    # collision_data.json is ~80 MB of trajectory; the printed summary covers it
+    {"name": "collision_demo", "cmd": ["collision_demo", "42"], "outputs": [],
+     "stdout": True},
+    {"name": "leo_sensor_revisit", "cmd": ["leo_sensor_revisit"],
+     "outputs": ["visualization/cesium/sensor_revisit_data.json"], "stdout": True,
+     "slow": True},
+    mc("mc_iads_engagement", "demo_iads_engagement.json"),
+    mc("mc_orbital_arena_small", "test_orbital_arena_small.json"),
+    mc("mc_contested_orbit", "template_contested_orbit.json"),
+    mc("mc_multi_domain", "demo_multi_domain.json"),
+    mc("mc_fighter_patrol", "demo_fighter_patrol.json"),
+    mc("mc_iads_replay", "demo_iads_engagement.json", runs=1,
+       extra=("--replay", "--sample-interval", "10")),
+]
+
+DEFAULT_TOLERANCE = {"rel": 1e-6, "abs": 1e-9}
+
+
+# ── Fingerprints ──
+
+def quantize(x):
+    if isinstance(x, bool) or x is None:
+        return str(x)
+    if isinstance(x, (int, float)):
+        if isinstance(x, float) and not math.isfinite(x):
+            return str(x)
+        return format(float(x), ".%dg" % DIGITS)
+    return str(x)
+
+
+class Fingerprint:
+    def __init__(self):
+        self.groups = {}       # path -> list of numbers
+        self.text = {}         # path -> hash of the non-numeric values
+        self.hash = hashlib.sha256()
+
+    def add(self, path, value):
+        self.hash.update(path.encode())
+        self.hash.update(quantize(value).encode())
+        if isinstance(value, (int, float)) and not isinstance(value, bool):
+            if math.isfinite(value):
+                self.groups.setdefault(path, []).append(float(value))
+        else:
+            h = self.text.setdefault(path, hashlib.sha256())
+            h.update(quantize(value).encode())
+
+    def walk_json(self, prefix, obj):
+        if isinstance(obj, dict):
+            for k, v in obj.items():
+                if TIMING_KEY.match(k):
+                    continue
+                self.walk_json(prefix + "." + k, v)
+        elif isinstance(obj, list):
+            for v in obj:
+                self.walk_json(prefix + "[]", v)
+        else:
+            self.add(prefix, obj)
+
+    def walk_text(self, prefix, text):
+        for line in text.splitlines():
+            if TIMING_LINE.search(line):
+                continue
+            label = NUMBER.sub("#", line).strip()
+            if not label:
+                continue
+            nums = NUMBER.findall(line)
+            if not nums:
+                self.add(prefix + ":" + label, label)
+            for n in nums:
+                self.add(prefix + ":" + label, float(n))
+
+    def summary(self):
+        groups = {}
+        for path, xs in sorted(self.groups.items()):
+            step = max(1, len(xs) // CHECKPOINTS)
+            groups[path] = {
+                "n": len(xs),
+                "sum": math.fsum(xs),
+                "absSum": math.fsum(abs(x) for x in xs),
+                "min": min(xs),
+                "max": max(xs),
+                "checkpoints": xs[::step][:CHECKPOINTS],
+            }
+        for path, h in sorted(self.text.items()):
+            groups.setdefault(path, {})["text"] = h.hexdigest()[:16]
+        return {"hash": self.hash.hexdigest()[:32], "groups": groups}
+
+
+def fingerprint_output(name, text):
+    fp = Fingerprint()
+    try:
+        fp.walk_json(name, json.loads(text))
+    except ValueError:
+        fp.walk_text(name, text)
+    return fp.summary()
+
+
+# ── Running ──
+
+def run_case(case, bin_dir, repeat):
+    """Run a case `repeat` times; returns (runtimes, fingerprints per run)."""
+    exe = os.path.join(bin_dir, case["cmd"][0])
+    if not os.path.exists(exe):
+        raise RuntimeError("missing binary " + exe)
+    times, prints = [], []
+    for _ in range(repeat):
+        work = tempfile.mkdtemp(prefix="regression_gate_")
+        try:
+            os.symlink(os.path.join(REPO, "data"), os.path.join(work, "data"))
+            os.makedirs(os.path.join(work, "visualization", "cesium"))
+            t0 = time.perf_counter()
+            proc = subprocess.run([exe, *case["cmd"][1:]], cwd=work,
+                                  stdin=subprocess.DEVNULL,
+                                  stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                                  timeout=case.get("timeout", 600))
+            times.append(time.perf_counter() - t0)
+            if proc.returncode != 0:
+                raise RuntimeError("%s exited %d: %s" % (
+                    case["name"], proc.returncode,
+                    proc.stderr.decode(errors="replace").strip()[-400:]))
+            outputs = {}
+            if case["stdout"]:
+                # Usage lines echo argv[0]; keep the build location out of the golden
+                stdout = proc.stdout.decode(errors="replace")
+                stdout = stdout.replace(exe, "<exe>").replace(bin_dir, "<bin>")
+                outputs["stdout"] = fingerprint_output("stdout", stdout)
+            for rel in case["outputs"]:
+                path = os.path.join(work, rel)
+                if not os.path.exists(path):
+                    raise RuntimeError("%s wrote no %s" % (case["name"], rel))
+                with open(path, encoding="utf-8", errors="replace") as f:
+                    outputs[rel] = fingerprint_output(os.path.basename(rel), f.read())
+            prints.append(outputs)
+        finally:
+            shutil.rmtree(work, ignore_errors=True)
+    return times, prints
+
+
+# ── Comparison ──
+
+def close(a, b, tol):
+    return abs(a - b) <= max(tol["abs"], tol["rel"] * max(abs(a), abs(b)))
+
+
+def compare_output(golden, current, tol):
+    """List of drift messages (empty when equivalent)."""
+    if golden["hash"] == current["hash"]:
+        return []
+    msgs = []
+    g_groups, c_groups = golden["groups"], current["groups"]
+    for path in sorted(set(g_groups) | set(c_groups)):
+        g, c = g_groups.get(path), c_groups.get(path)
+        if g is None or c is None:
+            msgs.append("%s: %s" % (path, "new" if g is None else "missing"))
+            continue
+        if g.get("text") != c.get("text"):
+            msgs.append("%s: text differs" % path)
+        if g.get("n") != c.get("n"):
+            msgs.append("%s: %s values, golden %s" % (path, c.get("n"), g.get("n")))
+            continue
+        if "n" not in g:
+            continue
+        for key in ("sum", "absSum", "min", "max"):
+            if not close(g[key], c[key], tol):
+                msgs.append("%s: %s %.9g, golden %.9g" % (path, key, c[key], g[key]))
+        for k, (a, b) in enumerate(zip(g["checkpoints"], c["checkpoints"])):
+            if not close(a, b, tol):
+                msgs.append("%s: checkpoint %d %.9g, golden %.9g" % (path, k, b, a))
+                break
+    return msgs
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--build-dir", default=os.path.join(REPO, "_gate_build"))
+    ap.add_argument("--golden", default=GOLDEN)
+    ap.add_argument("--case", action="append", default=[],
+                    help="run only this case (repeatable)")
+    ap.add_argument("--repeat", type=int, default=3)
+    ap.add_argument("--runtime-threshold", type=float, default=0.25,
+                    help="allowed relative slowdown (default: 0.25)")
+    ap.add_argument("--runtime-floor", type=float, default=0.05,
+                    help="slowdowns under this many seconds pass (default: 0.05)")
+    ap.add_argument("--no-runtime", action="store_true")
+    ap.add_argument("--slow", action="store_true", help="include slow cases")
+    ap.add_argument("--update", action="store_true", help="rewrite the goldens")
+    ap.add_argument("--list", action="store_true")
+    args = ap.parse_args()
+
+    cases = [c for c in CASES
+             if (c["name"] in args.case) or (not args.case and (args.slow or not c.get("slow")))]
+    if args.list:
+        for c in CASES:
+            print(c["name"] + (" (slow)" if c.get("slow") else ""))
+        return 0
+    unknown = set(args.case) - {c["name"] for c in CASES}
+    if unknown:
+        print("Unknown case: " + ", ".join(sorted(unknown)), file=sys.stderr)
+        return 2
+
+    # Absolute: each case runs with its own temporary working directory
+    bin_dir = os.path.abspath(os.path.join(args.build_dir, "bin"))
+    golden = {"cases": {}}
+    if os.path.exists(args.golden):
+        with open(args.golden) as f:
+            golden = json.load(f)
+
+    failed = False
+    for case in cases:
+        name = case["name"]
+        try:
+            times, prints = run_case(case, bin_dir, max(1, args.repeat))
+        except OSError as e:
+            print("FAIL   %-24s  could not launch: %s" % (name, e))
+            failed = True
+            continue
+        except (RuntimeError, subprocess.TimeoutExpired) as e:
+            print("ERROR  %s: %s" % (name, e))
+            return 2
+        runtime = statistics.median(times)
+        current = prints[-1]
+
+        problems = []
+        for other in prints[:-1]:
+            if any(other[k]["hash"] != current[k]["hash"] for k in current):
+                problems.append("nondeterministic: runs differ")
+                break
+
+        if args.update:
+            golden["cases"][name] = {"runtime": round(runtime, 4),
+                                     "outputs": current}
+            print("UPDATE %-24s %8.3f s" % (name, runtime))
+            failed = failed or bool(problems)
+            for p in problems:
+                print("       " + p)
+            continue
+
+        base = golden["cases"].get(name)
+        if base is None:
+            print("NEW    %-24s %8.3f s  (no golden; run --update)" % (name, runtime))
+            failed = True
+            continue
+        tol = dict(DEFAULT_TOLERANCE, **case.get("tolerance", {}))
+        for out in sorted(set(base["outputs"]) | set(current)):
+            if out not in current or out not in base["outputs"]:
+                problems.append("%s: %s" % (out, "missing" if out not in current else "new"))
+                continue
+            for msg in compare_output(base["outputs"][out], current[out], tol)[:10]:
+                problems.append(out + ": " + msg)
+        slow = (runtime - base["runtime"] > args.runtime_floor and
+                runtime > base["runtime"] * (1.0 + args.runtime_threshold))
+        if slow and not args.no_runtime:
+            problems.append("runtime %.3f s, golden %.3f s (+%.0f%%)" % (
+                runtime, base["runtime"], 100.0 * (runtime / base["runtime"] - 1.0)))
+
+        status = "FAIL" if problems else "PASS"
+        print("%-6s %-24s %8.3f s  golden %8.3f s" % (status, name, runtime, base["runtime"]))
+        for p in problems:
+            print("       " + p)
+        failed = failed or bool(problems)
+
+    if args.update:
+        os.makedirs(os.path.dirname(args.golden), exist_ok=True)
+        with open(args.golden, "w") as f:
+            json.dump(golden, f, indent=1, sort_keys=True)
+            f.write("\n")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <cstdlib>
 #include <ctime>
+#include <string>
 
 #include "core/state_vector.hpp"
 #include "physics/orbital_elements.hpp"
@@ -153,8 +154,10 @@ std::vector<OrbitalDebris> create_orbital_debris(
     return debris;
 }
 
-int main() {
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+int main(int argc, char* argv[]) {
+    // Optional seed argument makes the debris cloud reproducible
+    std::srand(argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                        : static_cast<unsigned>(std::time(nullptr)));
 
     std::cout << "=== GEO Collision Simulation ===" << std::endl;
     std::cout << "Two satellites 1 degree apart, intercepting and colliding" << std::endl;
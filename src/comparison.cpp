@@ -10,7 +10,8 @@ void run_comparison() {
     std::cout << "======================================================\n\n";
     
     // Load single satellite (ISS)
-    auto tles = sim::TLEParser::parse_file("data/tles/example_satcat.txt");
+    auto catalog = sim::TLEParser::load_file("data/tles/example_satcat.txt");
+    const auto& tles = *catalog;
     if (tles.empty()) {
         std::cerr << "ERROR: No TLEs loaded" << std::endl;
         return;
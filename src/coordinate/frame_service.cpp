@@ -0,0 +1,233 @@
+#include "coordinate/frame_service.hpp"
+#include "coordinate/time_utils.hpp"
+#include <cmath>
+
+namespace sim {
+
+// Constants
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG_TO_RAD = PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / PI;
+constexpr double ARCSEC_TO_RAD = DEG_TO_RAD / 3600.0;
+constexpr double EARTH_ROTATION_RATE = 7.2921150e-5;   // [rad/s]
+
+// ---------------------------------------------------------------------------
+// Rotation helpers
+// ---------------------------------------------------------------------------
+
+/// out = a * b (3x3)
+static void mat_mul(const double a[3][3], const double b[3][3], double out[3][3]) {
+    double t[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            t[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) out[i][j] = t[i][j];
+    }
+}
+
+/// Frame rotation about axis (0 = x, 1 = y, 2 = z) by angle [rad]
+static void rot(int axis, double angle, double out[3][3]) {
+    double c = std::cos(angle);
+    double s = std::sin(angle);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) out[i][j] = (i == j) ? 1.0 : 0.0;
+    }
+    int i = (axis + 1) % 3;
+    int j = (axis + 2) % 3;
+    out[i][i] = c;
+    out[i][j] = s;
+    out[j][i] = -s;
+    out[j][j] = c;
+}
+
+// ---------------------------------------------------------------------------
+// FrameService
+// ---------------------------------------------------------------------------
+
+FrameService::FrameService(const FrameServiceConfig& config) : config_(config) {}
+
+FrameService& FrameService::thread_instance() {
+    static thread_local FrameService service;
+    return service;
+}
+
+const FrameService::Rotation& FrameService::rotation(double jd) {
+    if (cache_valid_[last_slot_] && cache_[last_slot_].jd == jd) {
+        ++hits_;
+        return cache_[last_slot_];
+    }
+    for (int k = 0; k < CACHE_SLOTS; k++) {
+        if (cache_valid_[k] && cache_[k].jd == jd) {
+            ++hits_;
+            last_slot_ = k;
+            return cache_[k];
+        }
+    }
+
+    ++misses_;
+    int k = next_slot_;
+    next_slot_ = (next_slot_ + 1) % CACHE_SLOTS;
+    compute(jd, cache_[k]);
+    cache_valid_[k] = true;
+    last_slot_ = k;
+    return cache_[k];
+}
+
+void FrameService::compute(double jd, Rotation& out) {
+    out.jd = jd;
+    double theta = TimeUtils::compute_gmst(jd);
+
+    if (config_.fidelity == FrameFidelity::EARTH_ROTATION) {
+        rot(2, theta, out.m);
+        return;
+    }
+
+    update_precession_nutation(jd);
+    double earth[3][3];
+    rot(2, theta + eq_equinoxes_, earth);   // Apparent sidereal time
+    mat_mul(earth, pn_, out.m);
+}
+
+void FrameService::update_precession_nutation(double jd) {
+    if (pn_valid_ && std::abs(jd - pn_jd_) <= config_.pn_cadence_days) return;
+    pn_jd_ = jd;
+    pn_valid_ = true;
+
+    double T = (jd - TimeUtils::J2000_EPOCH_JD) / 36525.0;
+
+    // IAU 1976 precession angles
+    double zeta  = (2306.2181 * T + 0.30188 * T * T + 0.017998 * T * T * T) * ARCSEC_TO_RAD;
+    double z     = (2306.2181 * T + 1.09468 * T * T + 0.018203 * T * T * T) * ARCSEC_TO_RAD;
+    double theta = (2004.3109 * T - 0.42665 * T * T - 0.041833 * T * T * T) * ARCSEC_TO_RAD;
+
+    double r1[3][3], r2[3][3], r3[3][3], p[3][3];
+    rot(2, -zeta, r1);
+    rot(1, theta, r2);
+    rot(2, -z, r3);
+    mat_mul(r3, r2, p);
+    mat_mul(p, r1, p);
+
+    // IAU 1980 nutation, four largest terms
+    double omega = (125.04452 - 1934.136261 * T) * DEG_TO_RAD;   // Lunar node
+    double l_sun = (280.4665 + 36000.7698 * T) * DEG_TO_RAD;
+    double l_moon = (218.3165 + 481267.8813 * T) * DEG_TO_RAD;
+    double dpsi = (-17.20 * std::sin(omega) - 1.32 * std::sin(2.0 * l_sun)
+                   - 0.23 * std::sin(2.0 * l_moon) + 0.21 * std::sin(2.0 * omega)) * ARCSEC_TO_RAD;
+    double deps = (9.20 * std::cos(omega) + 0.57 * std::cos(2.0 * l_sun)
+                   + 0.10 * std::cos(2.0 * l_moon) - 0.09 * std::cos(2.0 * omega)) * ARCSEC_TO_RAD;
+
+    double eps0 = (84381.448 - 46.8150 * T - 0.00059 * T * T + 0.001813 * T * T * T) * ARCSEC_TO_RAD;
+    double eps = eps0 + deps;
+
+    double n1[3][3], n2[3][3], n3[3][3], n[3][3];
+    rot(0, eps0, n1);
+    rot(2, -dpsi, n2);
+    rot(0, -eps, n3);
+    mat_mul(n3, n2, n);
+    mat_mul(n, n1, n);
+
+    mat_mul(n, p, pn_);
+    eq_equinoxes_ = dpsi * std::cos(eps);
+}
+
+Vec3 FrameService::eci_to_ecef(const Vec3& pos_eci, double jd) {
+    const auto& m = rotation(jd).m;
+    return Vec3(m[0][0] * pos_eci.x + m[0][1] * pos_eci.y + m[0][2] * pos_eci.z,
+                m[1][0] * pos_eci.x + m[1][1] * pos_eci.y + m[1][2] * pos_eci.z,
+                m[2][0] * pos_eci.x + m[2][1] * pos_eci.y + m[2][2] * pos_eci.z);
+}
+
+Vec3 FrameService::ecef_to_eci(const Vec3& pos_ecef, double jd) {
+    // Inverse of a rotation is its transpose
+    const auto& m = rotation(jd).m;
+    return Vec3(m[0][0] * pos_ecef.x + m[1][0] * pos_ecef.y + m[2][0] * pos_ecef.z,
+                m[0][1] * pos_ecef.x + m[1][1] * pos_ecef.y + m[2][1] * pos_ecef.z,
+                m[0][2] * pos_ecef.x + m[1][2] * pos_ecef.y + m[2][2] * pos_ecef.z);
+}
+
+Vec3 FrameService::vel_eci_to_ecef(const Vec3& pos_eci, const Vec3& vel_eci, double jd) {
+    Vec3 r = eci_to_ecef(pos_eci, jd);
+    Vec3 v = eci_to_ecef(vel_eci, jd);
+    return Vec3(v.x + EARTH_ROTATION_RATE * r.y, v.y - EARTH_ROTATION_RATE * r.x, v.z);
+}
+
+GeodeticCoord FrameService::eci_to_geodetic(const Vec3& pos_eci, double jd) {
+    return ecef_to_geodetic(eci_to_ecef(pos_eci, jd));
+}
+
+void FrameService::eci_to_ecef(double jd, size_t n, const double* x, const double* y,
+                               const double* z, double* ex, double* ey, double* ez) {
+    const auto& m = rotation(jd).m;
+    const double m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+    const double m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+    const double m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        double px = x[i], py = y[i], pz = z[i];
+        ex[i] = m00 * px + m01 * py + m02 * pz;
+        ey[i] = m10 * px + m11 * py + m12 * pz;
+        ez[i] = m20 * px + m21 * py + m22 * pz;
+    }
+}
+
+/// Vermeille (2004) closed form; false inside the evolute region near the centre
+static bool geodetic_closed_form(double x, double y, double z,
+                                 double& lat, double& lon, double& alt) {
+    constexpr double A = FrameTransformer::WGS84_A;
+    constexpr double E2 = FrameTransformer::WGS84_E2;
+    constexpr double E4 = E2 * E2;
+
+    double w2 = x * x + y * y;
+    double p = w2 / (A * A);
+    double q = (1.0 - E2) * z * z / (A * A);
+    double r = (p + q - E4) / 6.0;
+    if (r <= 0.0) return false;
+
+    double s = E4 * p * q / (4.0 * r * r * r);
+    double t = std::cbrt(1.0 + s + std::sqrt(s * (2.0 + s)));
+    double u = r * (1.0 + t + 1.0 / t);
+    double v = std::sqrt(u * u + E4 * q);
+    double w = E2 * (u + v - q) / (2.0 * v);
+    double k = std::sqrt(u + v + w * w) - w;
+    double d = k * std::sqrt(w2) / (k + E2);
+    double dz = std::sqrt(d * d + z * z);
+
+    lat = 2.0 * std::atan2(z, d + dz);
+    lon = std::atan2(y, x);
+    alt = (k + E2 - 1.0) / k * dz;
+    return true;
+}
+
+GeodeticCoord FrameService::ecef_to_geodetic(const Vec3& pos_ecef) {
+    double lat, lon, alt;
+    if (!geodetic_closed_form(pos_ecef.x, pos_ecef.y, pos_ecef.z, lat, lon, alt)) {
+        return FrameTransformer::ecef_to_geodetic(pos_ecef);
+    }
+    GeodeticCoord result;
+    result.latitude = lat * RAD_TO_DEG;
+    result.longitude = lon * RAD_TO_DEG;
+    result.altitude = alt;
+    return result;
+}
+
+void FrameService::ecef_to_geodetic(size_t n, const double* x, const double* y, const double* z,
+                                    double* lat_deg, double* lon_deg, double* alt) {
+    for (size_t i = 0; i < n; i++) {
+        double lat, lon, h;
+        if (geodetic_closed_form(x[i], y[i], z[i], lat, lon, h)) {
+            lat_deg[i] = lat * RAD_TO_DEG;
+            lon_deg[i] = lon * RAD_TO_DEG;
+            alt[i] = h;
+        } else {
+            GeodeticCoord g = FrameTransformer::ecef_to_geodetic(Vec3(x[i], y[i], z[i]));
+            lat_deg[i] = g.latitude;
+            lon_deg[i] = g.longitude;
+            alt[i] = g.altitude;
+        }
+    }
+}
+
+} // namespace sim
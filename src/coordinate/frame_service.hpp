@@ -0,0 +1,112 @@
+#ifndef FRAME_SERVICE_HPP
+#define FRAME_SERVICE_HPP
+
+#include "coordinate/frame_transformer.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace sim {
+
+/**
+ * @brief Earth orientation model used by FrameService
+ *
+ * EARTH_ROTATION matches FrameTransformer: ECI is rotated into ECEF by
+ * GMST alone (a true-of-date ECI). PRECESSION_NUTATION treats ECI as
+ * J2000 and applies IAU 1976 precession, a truncated IAU 1980 nutation
+ * (four terms; about 0.5" in longitude, 0.1" in obliquity) and the
+ * equation of the equinoxes. Polar motion is neglected in both.
+ */
+enum class FrameFidelity {
+    EARTH_ROTATION,
+    PRECESSION_NUTATION
+};
+
+struct FrameServiceConfig {
+    FrameFidelity fidelity = FrameFidelity::EARTH_ROTATION;
+    double pn_cadence_days = 1.0 / 24.0;   // Precession-nutation reuse window
+};
+
+/**
+ * @brief Cached Earth-orientation and frame-rotation service
+ *
+ * The ECI→ECEF rotation is computed once per epoch and kept for the last
+ * few epochs, so every query at a timestamp (all entities of a step, all
+ * radars of a frame) shares one GMST evaluation and one sin/cos pair.
+ * In PRECESSION_NUTATION mode the slowly varying precession-nutation
+ * matrix is recomputed only every pn_cadence_days (it moves by ~0.006"
+ * per hour); the Earth rotation angle is still exact per epoch.
+ *
+ * Geodetic conversion is Vermeille's closed form (J. Geodesy 2004): no
+ * iteration, machine-precision latitude and altitude everywhere outside
+ * ~45 km of the Earth's centre, where it falls back to
+ * FrameTransformer::ecef_to_geodetic.
+ *
+ * Array overloads take structure-of-arrays spans and are written as
+ * plain loops the compiler vectorizes. An instance is not thread-safe;
+ * thread_instance() gives each thread its own default service.
+ */
+class FrameService {
+public:
+    /// ECI -> ECEF rotation at one epoch: ecef = m * eci
+    struct Rotation {
+        double jd = 0.0;
+        double m[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    };
+
+    explicit FrameService(const FrameServiceConfig& config = FrameServiceConfig{});
+
+    const FrameServiceConfig& config() const { return config_; }
+
+    /// Rotation at jd, computed on the first query at that epoch
+    const Rotation& rotation(double jd);
+
+    Vec3 eci_to_ecef(const Vec3& pos_eci, double jd);
+    Vec3 ecef_to_eci(const Vec3& pos_ecef, double jd);
+
+    /// ECEF velocity, including the ω × r term of the rotating frame
+    Vec3 vel_eci_to_ecef(const Vec3& pos_eci, const Vec3& vel_eci, double jd);
+
+    GeodeticCoord eci_to_geodetic(const Vec3& pos_eci, double jd);
+
+    /// Batched ECI -> ECEF of n positions at one epoch (outputs may alias inputs)
+    void eci_to_ecef(double jd, size_t n, const double* x, const double* y, const double* z,
+                     double* ex, double* ey, double* ez);
+
+    /// Closed-form WGS84 geodetic conversion (see class comment)
+    static GeodeticCoord ecef_to_geodetic(const Vec3& pos_ecef);
+
+    /// Batched geodetic conversion: latitude, longitude [deg], altitude [m]
+    static void ecef_to_geodetic(size_t n, const double* x, const double* y, const double* z,
+                                 double* lat_deg, double* lon_deg, double* alt);
+
+    /// Epochs served from the cache / computed
+    uint64_t cache_hits() const { return hits_; }
+    uint64_t cache_misses() const { return misses_; }
+
+    /// This thread's service with the default configuration
+    static FrameService& thread_instance();
+
+private:
+    static constexpr int CACHE_SLOTS = 4;
+
+    FrameServiceConfig config_;
+    Rotation cache_[CACHE_SLOTS];
+    bool cache_valid_[CACHE_SLOTS] = {};
+    int next_slot_ = 0;
+    int last_slot_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+
+    // Precession-nutation, reused within pn_cadence_days
+    double pn_jd_ = 0.0;
+    bool pn_valid_ = false;
+    double pn_[3][3];
+    double eq_equinoxes_ = 0.0;   // GAST - GMST [rad]
+
+    void compute(double jd, Rotation& out);
+    void update_precession_nutation(double jd);
+};
+
+} // namespace sim
+
+#endif // FRAME_SERVICE_HPP
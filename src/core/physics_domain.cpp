@@ -1,4 +1,7 @@
 #include "core/physics_domain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace sim {
 
@@ -23,4 +26,45 @@ PhysicsDomain DomainThresholds::determine_domain(double altitude, double velocit
     return PhysicsDomain::AERO;
 }
 
+/// Worst-case time to cover `distance` starting at `rate` toward it, with max_accel
+static double time_to_cover(double distance, double rate, double max_accel) {
+    if (distance <= 0.0) return 0.0;
+    if (max_accel <= 0.0) {
+        return rate > 0.0 ? distance / rate : std::numeric_limits<double>::infinity();
+    }
+    // distance = rate t + a t^2 / 2, rate may be negative (moving away)
+    return (-rate + std::sqrt(rate * rate + 2.0 * max_accel * distance)) / max_accel;
+}
+
+double DomainThresholds::time_to_transition(double altitude, double radial_velocity,
+                                            double velocity, double max_accel) const {
+    double t = std::numeric_limits<double>::infinity();
+    for (double h : {ground_to_aero_alt, aero_to_orbital_alt}) {
+        double rate = altitude > h ? -radial_velocity : radial_velocity;
+        t = std::min(t, time_to_cover(std::abs(altitude - h), rate, max_accel));
+    }
+    // Speed thresholds only matter below the orbital altitude, and getting
+    // below it is itself bounded above
+    if (altitude < aero_to_orbital_alt) {
+        for (double v : {ground_max_velocity, aero_max_velocity}) {
+            t = std::min(t, time_to_cover(std::abs(velocity - v), 0.0, max_accel));
+        }
+    }
+    return t;
+}
+
+double DomainThresholds::locate_transition(double t0, double alt0, double vel0,
+                                           double t1, double alt1, double vel1) const {
+    double t = t1;
+    auto secant = [&](double a, double b, double threshold) {
+        if ((a < threshold) == (b < threshold) || a == b) return;
+        t = std::min(t, t0 + (threshold - a) / (b - a) * (t1 - t0));
+    };
+    secant(alt0, alt1, ground_to_aero_alt);
+    secant(alt0, alt1, aero_to_orbital_alt);
+    secant(vel0, vel1, ground_max_velocity);
+    secant(vel0, vel1, aero_max_velocity);
+    return t;
+}
+
 } // namespace sim
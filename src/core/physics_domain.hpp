@@ -33,6 +33,50 @@ struct DomainThresholds {
     
     // Current domain determination
     PhysicsDomain determine_domain(double altitude, double velocity) const;
+
+    /**
+     * Shortest time [s] before determine_domain() can change, assuming the
+     * speed changes no faster than max_accel and the altitude follows
+     * radial_velocity with at most max_accel of curvature. 0 if a
+     * threshold is already at hand; infinity if none can be reached.
+     */
+    double time_to_transition(double altitude, double radial_velocity, double velocity,
+                              double max_accel) const;
+
+    /**
+     * When a domain changed: time inside [t0, t1] at which the first
+     * threshold crossed between the samples was crossed (secant on the
+     * crossing quantity); t1 if no crossing is bracketed.
+     */
+    double locate_transition(double t0, double alt0, double vel0,
+                             double t1, double alt1, double vel1) const;
+};
+
+/**
+ * @brief Event-driven domain checks in SimulationEngine
+ *
+ * Instead of testing every entity after every step, each entity is
+ * re-checked only when its next transition could first occur:
+ * DomainThresholds::time_to_transition() under max_acceleration, or, for
+ * a coasting entity (Entity::warp_horizon() > 0) on a bound orbit whose
+ * periapsis clears aero_to_orbital_alt, its warp horizon. No entity goes
+ * unchecked longer than max_interval, so slow effects (drag decay) and
+ * out-of-band state changes are still caught. Impulsive changes beyond
+ * max_acceleration (ground contact clamps, set_state()) are seen late
+ * unless followed by SimulationEngine::invalidate_domain_prediction().
+ */
+struct DomainPredictionConfig {
+    bool enabled = false;
+    double max_acceleration = 100.0;   // Bound on |dv/dt| [m/s^2] (~10 g)
+    double max_interval = 60.0;        // Longest gap between checks [s]
+};
+
+/// A domain change reported by SimulationEngine
+struct DomainTransition {
+    int entity_id;
+    PhysicsDomain from;
+    PhysicsDomain to;
+    double time;   // Located crossing time [s]
 };
 
 } // namespace sim
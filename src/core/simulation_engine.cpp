@@ -1,6 +1,8 @@
 #include "core/simulation_engine.hpp"
 #include "io/checkpoint.hpp"
+#include "utils/thread_pool.hpp"
 #include <algorithm>
+#include <numeric>
 #include <thread>
 
 namespace sim {
@@ -12,11 +14,17 @@ SimulationEngine::SimulationEngine()
     time_scale_.factor = 1.0;
 }
 
+SimulationEngine::~SimulationEngine() = default;
+
 void SimulationEngine::add_entity(std::shared_ptr<Entity> entity) {
+    entity_index_.emplace(entity->get_id(), entities_.size());
     entities_.push_back(entity);
+    buckets_dirty_ = true;
+    if (domain_config_.enabled) schedule_domain_check(entity->get_id(), sim_time_);
 }
 
 void SimulationEngine::remove_entity(int entity_id) {
+    if (entity_index_.find(entity_id) == entity_index_.end()) return;
     entities_.erase(
         std::remove_if(entities_.begin(), entities_.end(),
             [entity_id](const std::shared_ptr<Entity>& e) {
@@ -24,15 +32,24 @@ void SimulationEngine::remove_entity(int entity_id) {
             }),
         entities_.end()
     );
+
+    // Positions behind the removed entities shifted
+    entity_index_.clear();
+    for (size_t i = 0; i < entities_.size(); ++i) {
+        entity_index_.emplace(entities_[i]->get_id(), i);
+    }
+    buckets_dirty_ = true;
+    domain_samples_.erase(entity_id);   // Its queue entries are now stale
 }
 
 std::shared_ptr<Entity> SimulationEngine::get_entity(int entity_id) {
-    auto it = std::find_if(entities_.begin(), entities_.end(),
-        [entity_id](const std::shared_ptr<Entity>& e) {
-            return e->get_id() == entity_id;
-        });
-    
-    return (it != entities_.end()) ? *it : nullptr;
+    auto it = entity_index_.find(entity_id);
+    return it != entity_index_.end() ? entities_[it->second] : nullptr;
+}
+
+Entity* SimulationEngine::get_entity_ptr(int entity_id) {
+    auto it = entity_index_.find(entity_id);
+    return it != entity_index_.end() ? entities_[it->second].get() : nullptr;
 }
 
 const std::vector<std::shared_ptr<Entity>>& SimulationEngine::get_all_entities() const {
@@ -54,42 +71,138 @@ void SimulationEngine::initialize() {
 
 void SimulationEngine::step(double dt) {
     // Apply time scale
-    double scaled_dt = dt * time_scale_.factor;
-    
+    advance(dt * time_scale_.factor);
+}
+
+void SimulationEngine::advance(double dt) {
     // Update all entities
-    update_entities(scaled_dt);
+    update_entities(dt);
     
     // Check for domain transitions
-    handle_domain_transitions();
+    handle_domain_transitions(sim_time_ + dt);
     
     // Advance simulation time
-    sim_time_ += scaled_dt;
+    sim_time_ += dt;
 }
 
 void SimulationEngine::run_until(double end_time) {
     is_running_ = true;
     
-    if (mode_ == SimulationMode::MODEL_MODE) {
+    if (mode_ == SimulationMode::MODEL_MODE && warp_config_.enabled) {
+        run_warp(end_time);
+    } else if (mode_ == SimulationMode::MODEL_MODE) {
         // Model mode: run as fast as possible
         double dt = 0.1;  // 100ms time steps (configurable)
         while (sim_time_ < end_time && is_running_) {
             step(dt);
         }
     } else {
-        // Simulation mode: respect real-time constraints
-        while (sim_time_ < end_time && is_running_) {
-            auto now = std::chrono::high_resolution_clock::now();
-            auto elapsed = std::chrono::duration<double>(now - last_update_time_).count();
-            
-            if (elapsed > 0.0) {
-                step(elapsed);
-                last_update_time_ = now;
+        run_real_time(end_time);
+    }
+}
+
+void SimulationEngine::run_warp(double end_time) {
+    while (sim_time_ < end_time && is_running_) {
+        double horizon = std::min(end_time - sim_time_, warp_config_.max_jump);
+        for (const auto& entity : entities_) {
+            horizon = std::min(horizon, entity->warp_horizon());
+            if (horizon < warp_config_.min_jump) break;
+        }
+
+        if (horizon < warp_config_.min_jump) {
+            step(warp_config_.fine_dt);
+            ++warp_stats_.fine_steps;
+            continue;
+        }
+
+        for (auto& entity : entities_) {
+            entity->coast(horizon);
+        }
+        handle_domain_transitions(sim_time_ + horizon);
+        sim_time_ += horizon;
+        ++warp_stats_.jumps;
+        warp_stats_.warped_time += horizon;
+    }
+}
+
+void SimulationEngine::run_real_time(double end_time) {
+    using Clock = std::chrono::steady_clock;
+    const double h = rt_config_.physics_dt;
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(rt_config_.frame_period));
+
+    auto deadline = Clock::now();
+    auto last = deadline;
+    interpolating_ = true;
+
+    while (sim_time_ < end_time && is_running_) {
+        std::this_thread::sleep_until(deadline);
+        auto wake = Clock::now();
+        rt_stats_.record_latency(std::chrono::duration<double>(wake - deadline).count());
+
+        rt_accumulator_ += std::chrono::duration<double>(wake - last).count() * time_scale_.factor;
+        last = wake;
+
+        int steps = 0;
+        while (rt_accumulator_ >= h && steps < rt_config_.max_catchup_steps &&
+               sim_time_ < end_time && is_running_) {
+            previous_states_.resize(entities_.size());
+            for (size_t i = 0; i < entities_.size(); ++i) {
+                previous_states_[i] = entities_[i]->get_state();
             }
-            
-            // Small sleep to prevent CPU spinning
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            advance(h);
+            rt_accumulator_ -= h;
+            ++steps;
+        }
+        if (rt_accumulator_ >= h) {
+            // Catch-up limit: give the backlog up instead of spiralling
+            auto dropped = static_cast<uint64_t>(rt_accumulator_ / h);
+            rt_stats_.dropped_steps += dropped;
+            rt_accumulator_ -= static_cast<double>(dropped) * h;
+        }
+        rt_stats_.steps += static_cast<uint64_t>(steps);
+        ++rt_stats_.frames;
+
+        auto done = Clock::now();
+        double frame_time = std::chrono::duration<double>(done - wake).count();
+        if (frame_time > rt_stats_.max_frame_time) rt_stats_.max_frame_time = frame_time;
+
+        // Next absolute deadline; deadlines already past are skipped
+        deadline += period;
+        if (done > deadline) {
+            ++rt_stats_.overruns;
+            auto missed = (done - deadline) / period + 1;
+            rt_stats_.missed_deadlines += static_cast<uint64_t>(missed);
+            deadline += missed * period;
         }
     }
+    last_update_time_ = std::chrono::high_resolution_clock::now();
+}
+
+double SimulationEngine::get_interpolation_alpha() const {
+    if (!interpolating_ || rt_config_.physics_dt <= 0.0) return 0.0;
+    return std::min(rt_accumulator_ / rt_config_.physics_dt, 1.0);
+}
+
+static Vec3 lerp(const Vec3& a, const Vec3& b, double t) {
+    return Vec3(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+}
+
+bool SimulationEngine::get_interpolated_state(int entity_id, StateVector& out) const {
+    auto it = entity_index_.find(entity_id);
+    if (it == entity_index_.end()) return false;
+    const StateVector& cur = entities_[it->second]->get_state();
+    out = cur;
+    if (!interpolating_ || previous_states_.size() != entities_.size()) return true;
+
+    // Between the last two steps, so consumers see smooth motion one
+    // physics step behind the simulation
+    const StateVector& prev = previous_states_[it->second];
+    double alpha = get_interpolation_alpha();
+    out.position = lerp(prev.position, cur.position, alpha);
+    out.velocity = lerp(prev.velocity, cur.velocity, alpha);
+    out.time = prev.time + (cur.time - prev.time) * alpha;
+    return true;
 }
 
 void SimulationEngine::pause() {
@@ -101,27 +214,207 @@ void SimulationEngine::resume() {
     last_update_time_ = std::chrono::high_resolution_clock::now();
 }
 
+void SimulationEngine::set_storage_mode(EntityStorage mode) {
+    storage_ = mode;
+    buckets_dirty_ = true;
+}
+
+void SimulationEngine::register_batch_update(std::type_index type, BatchUpdate update) {
+    batch_updates_[type] = update;
+    buckets_dirty_ = true;
+}
+
+void SimulationEngine::set_update_threads(int threads) {
+    if (threads <= 0) threads = ThreadPool::hardware_threads();
+    update_threads_ = threads;
+    update_pool_.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
 void SimulationEngine::update_entities(double dt) {
+    if (storage_ == EntityStorage::TYPE_BUCKETED) {
+        update_buckets(dt);
+        return;
+    }
+    if (update_pool_ && entities_.size() > 1) {
+        update_entities_parallel(dt);
+        return;
+    }
     for (auto& entity : entities_) {
         entity->update(dt);
     }
 }
 
-void SimulationEngine::handle_domain_transitions() {
-    DomainThresholds thresholds;
-    
-    for (auto& entity : entities_) {
-        const StateVector& state = entity->get_state();
-        double altitude = state.altitude_msl();
-        double velocity = state.velocity.norm();
-        
-        PhysicsDomain new_domain = thresholds.determine_domain(altitude, velocity);
-        
-        if (new_domain != entity->get_physics_domain()) {
-            entity->set_physics_domain(new_domain);
-            // TODO: Log domain transition
+void SimulationEngine::update_entities_parallel(double dt) {
+    // Entities added or removed since the last step: costs are unknown again
+    if (update_costs_.size() != entities_.size()) {
+        update_costs_.assign(entities_.size(), 1e-6);
+    }
+    plan_chunks();
+
+    update_pool_->parallel_for(chunk_bounds_.size() - 1, [&](size_t c) {
+        for (size_t i = chunk_bounds_[c]; i < chunk_bounds_[c + 1]; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            entities_[i]->update(dt);
+            double cost = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - t0).count();
+            update_costs_[i] = 0.75 * update_costs_[i] + 0.25 * cost;
+        }
+    });
+}
+
+void SimulationEngine::rebuild_buckets() {
+    buckets_.clear();
+    std::unordered_map<std::type_index, size_t> bucket_of;
+    for (const auto& entity : entities_) {
+        std::type_index type(typeid(*entity));
+        auto it = bucket_of.find(type);
+        if (it == bucket_of.end()) {
+            auto reg = batch_updates_.find(type);
+            BatchUpdate update = reg != batch_updates_.end() ? reg->second
+                : [](Entity* const* entities, size_t count, double dt) {
+                      for (size_t i = 0; i < count; ++i) entities[i]->update(dt);
+                  };
+            it = bucket_of.emplace(type, buckets_.size()).first;
+            buckets_.push_back(TypeBucket{type, update, {}});
+        }
+        buckets_[it->second].entities.push_back(entity.get());
+    }
+    buckets_dirty_ = false;
+}
+
+void SimulationEngine::update_buckets(double dt) {
+    if (buckets_dirty_) rebuild_buckets();
+
+    for (auto& bucket : buckets_) {
+        const size_t n = bucket.entities.size();
+        if (!update_pool_ || n < 2) {
+            bucket.update(bucket.entities.data(), n, dt);
+            continue;
+        }
+        // One type per bucket: equal-count chunks are equal-cost chunks
+        const size_t chunk = std::max<size_t>(1, n / (static_cast<size_t>(update_threads_) * 4));
+        update_pool_->parallel_for((n + chunk - 1) / chunk, [&](size_t c) {
+            size_t begin = c * chunk;
+            bucket.update(bucket.entities.data() + begin, std::min(chunk, n - begin), dt);
+        });
+    }
+}
+
+void SimulationEngine::plan_chunks() {
+    // About four chunks per thread of equal estimated cost, so stealing can
+    // even out the estimate's error
+    const size_t n = entities_.size();
+    const size_t target_chunks = static_cast<size_t>(update_threads_) * 4;
+    double total = std::accumulate(update_costs_.begin(), update_costs_.end(), 0.0);
+    double per_chunk = total / static_cast<double>(target_chunks);
+
+    chunk_bounds_.clear();
+    chunk_bounds_.push_back(0);
+    double acc = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        acc += update_costs_[i];
+        if (acc >= per_chunk && i + 1 < n) {
+            chunk_bounds_.push_back(i + 1);
+            acc = 0.0;
+        }
+    }
+    chunk_bounds_.push_back(n);
+}
+
+void SimulationEngine::set_domain_prediction(const DomainPredictionConfig& config) {
+    domain_config_ = config;
+    domain_samples_.clear();
+    domain_queue_ = decltype(domain_queue_)();
+    if (!config.enabled) return;
+    for (const auto& entity : entities_) schedule_domain_check(entity->get_id(), sim_time_);
+}
+
+void SimulationEngine::invalidate_domain_prediction(int entity_id) {
+    if (domain_config_.enabled && entity_index_.count(entity_id)) {
+        schedule_domain_check(entity_id, sim_time_);
+        domain_samples_[entity_id].time = -1.0;   // No bracket for root finding
+    }
+}
+
+void SimulationEngine::schedule_domain_check(int entity_id, double due) {
+    auto& sample = domain_samples_[entity_id];
+    sample.due = due;
+    domain_queue_.emplace(due, entity_id);
+}
+
+void SimulationEngine::check_domain(Entity& entity, double t, DomainSample& sample) {
+    ++domain_checks_;
+    const StateVector& state = entity.get_state();
+    double altitude = state.altitude_msl();
+    double velocity = state.velocity.norm();
+
+    PhysicsDomain old_domain = entity.get_physics_domain();
+    PhysicsDomain new_domain = thresholds_.determine_domain(altitude, velocity);
+    if (new_domain != old_domain) {
+        entity.set_physics_domain(new_domain);
+        if (on_transition_) {
+            double when = t;
+            if (domain_config_.enabled && sample.time >= 0.0 && sample.time < t) {
+                when = thresholds_.locate_transition(sample.time, sample.altitude, sample.velocity,
+                                                     t, altitude, velocity);
+            }
+            on_transition_(DomainTransition{entity.get_id(), old_domain, new_domain, when});
+        }
+    }
+    sample.time = t;
+    sample.altitude = altitude;
+    sample.velocity = velocity;
+}
+
+void SimulationEngine::handle_domain_transitions(double t) {
+    if (!domain_config_.enabled) {
+        DomainSample unused;
+        for (auto& entity : entities_) check_domain(*entity, t, unused);
+        return;
+    }
+
+    constexpr double MU = 3.986004418e14;       // Same Earth as altitude_msl()
+    constexpr double R_EARTH = 6378137.0;
+    std::vector<DomainCheck> next;
+    while (!domain_queue_.empty() && domain_queue_.top().first <= t) {
+        DomainCheck due = domain_queue_.top();
+        domain_queue_.pop();
+        auto it = domain_samples_.find(due.second);
+        if (it == domain_samples_.end() || it->second.due != due.first) continue;   // Stale
+        Entity* entity = get_entity_ptr(due.second);
+        if (!entity) continue;
+
+        check_domain(*entity, t, it->second);
+
+        const StateVector& s = entity->get_state();
+        double r = s.position.norm();
+        double v2 = s.velocity.x * s.velocity.x + s.velocity.y * s.velocity.y +
+                    s.velocity.z * s.velocity.z;
+        double radial = r > 0.0 ? (s.position.x * s.velocity.x + s.position.y * s.velocity.y +
+                                   s.position.z * s.velocity.z) / r : 0.0;
+        double horizon = thresholds_.time_to_transition(it->second.altitude, radial,
+                                                        it->second.velocity,
+                                                        domain_config_.max_acceleration);
+
+        // Coasting on a bound orbit that never dips to the orbital threshold
+        double coast = entity->warp_horizon();
+        if (coast > horizon && entity->get_physics_domain() == PhysicsDomain::ORBITAL) {
+            double energy = 0.5 * v2 - MU / r;
+            if (energy < 0.0) {
+                double a = -MU / (2.0 * energy);
+                Vec3 h(s.position.y * s.velocity.z - s.position.z * s.velocity.y,
+                       s.position.z * s.velocity.x - s.position.x * s.velocity.z,
+                       s.position.x * s.velocity.y - s.position.y * s.velocity.x);
+                double e = std::sqrt(std::max(0.0, 1.0 - h.x * h.x / (MU * a) -
+                                                       h.y * h.y / (MU * a) -
+                                                       h.z * h.z / (MU * a)));
+                if (a * (1.0 - e) - R_EARTH > thresholds_.aero_to_orbital_alt) horizon = coast;
+            }
         }
+        horizon = std::min(horizon, domain_config_.max_interval);
+        next.emplace_back(t + horizon, due.second);
     }
+    for (const auto& check : next) schedule_domain_check(check.second, check.first);
 }
 
 bool SimulationEngine::save_state(const std::string& filename) const {
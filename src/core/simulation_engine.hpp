@@ -6,31 +6,124 @@
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <queue>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
 
 namespace sim {
 
+class ThreadPool;
+
+/// How SimulationEngine walks its entities each step
+enum class EntityStorage {
+    FLAT,            // Insertion order, one virtual update() per entity
+    TYPE_BUCKETED    // Per concrete type, through registered batch updates
+};
+
 /**
  * @brief Main simulation engine
  * 
  * Manages all entities, time progression, and mode switching
  * Orchestrates physics updates and output generation
+ *
+ * Each step has a parallel phase, in which every entity's update(dt) runs
+ * on a work-stealing pool (entities do not interact inside update), then
+ * a serial phase for domain transitions and cross-entity work. Entities
+ * are grouped into chunks of roughly equal measured cost, so a 6-DOF
+ * fighter is not scheduled like a coasting satellite. With one update
+ * thread (the default) entities update serially in insertion order, which
+ * keeps runs bit-reproducible for debugging.
+ *
+ * In EntityStorage::TYPE_BUCKETED mode entities are grouped by concrete
+ * type into contiguous pointer pools, and each pool is updated by one
+ * batched call. For types registered with register_entity_type<T>() that
+ * call invokes T::update directly (no virtual dispatch, inlinable); other
+ * types, e.g. plugin entities, go through the virtual update(). Pools are
+ * rebuilt only when entities are added or removed.
+ *
+ * Lookup by id is O(1) through an id index in both modes; the id is the
+ * stable handle, and get_entity_ptr() avoids the shared_ptr refcount.
+ *
+ * In SIMULATION_MODE, run_until() is a real-time executive (see
+ * RealTimeConfig): fixed physics steps from an accumulator, frames on
+ * absolute deadlines, overrun accounting in get_real_time_stats(). Output
+ * consumers read get_interpolated_state(), which blends the last two
+ * physics steps by the accumulator's leftover fraction.
+ *
+ * In MODEL_MODE with WarpConfig::enabled, run_until() jumps between
+ * entity events instead of stepping through coasts (see WarpConfig).
+ *
+ * Domain transitions are polled for every entity after every step unless
+ * DomainPredictionConfig::enabled, in which case entities sit in a queue
+ * keyed by the earliest time their domain could change and are checked
+ * only then. Either way, changes go to the transition callback.
  */
 class SimulationEngine {
 public:
     SimulationEngine();
-    ~SimulationEngine() = default;
+    ~SimulationEngine();
     
     // Entity management
     void add_entity(std::shared_ptr<Entity> entity);
     void remove_entity(int entity_id);
     std::shared_ptr<Entity> get_entity(int entity_id);
+    Entity* get_entity_ptr(int entity_id);
     const std::vector<std::shared_ptr<Entity>>& get_all_entities() const;
+
+    // Entity storage (see EntityStorage)
+    void set_storage_mode(EntityStorage mode);
+    EntityStorage get_storage_mode() const { return storage_; }
+
+    /// Batched update of `count` entities of one concrete type
+    using BatchUpdate = void (*)(Entity* const* entities, size_t count, double dt);
+    void register_batch_update(std::type_index type, BatchUpdate update);
+
+    /// Update entities of exact type T with non-virtual T::update calls
+    template <class T>
+    void register_entity_type() {
+        register_batch_update(std::type_index(typeid(T)),
+            [](Entity* const* entities, size_t count, double dt) {
+                for (size_t i = 0; i < count; ++i) static_cast<T*>(entities[i])->T::update(dt);
+            });
+    }
     
     // Mode control
     void set_mode(SimulationMode mode);
     SimulationMode get_mode() const { return mode_; }
     void set_time_scale(double scale);
     double get_time_scale() const { return time_scale_.factor; }
+
+    // Domain transitions
+    void set_domain_prediction(const DomainPredictionConfig& config);
+    const DomainPredictionConfig& get_domain_prediction() const { return domain_config_; }
+    using DomainTransitionCallback = std::function<void(const DomainTransition&)>;
+    void set_domain_transition_callback(DomainTransitionCallback cb) { on_transition_ = std::move(cb); }
+
+    /// Re-check an entity's domain after the next step (after set_state())
+    void invalidate_domain_prediction(int entity_id);
+
+    /// Entity domain checks performed so far
+    uint64_t get_domain_checks() const { return domain_checks_; }
+
+    // Time skip (MODEL_MODE)
+    void set_warp_config(const WarpConfig& config) { warp_config_ = config; }
+    const WarpConfig& get_warp_config() const { return warp_config_; }
+    const WarpStats& get_warp_stats() const { return warp_stats_; }
+
+    // Real-time executive (SIMULATION_MODE)
+    void set_real_time_config(const RealTimeConfig& config) { rt_config_ = config; }
+    const RealTimeConfig& get_real_time_config() const { return rt_config_; }
+    const RealTimeStats& get_real_time_stats() const { return rt_stats_; }
+    void reset_real_time_stats() { rt_stats_ = RealTimeStats(); }
+
+    /// Fraction [0, 1) of a physics step accumulated but not yet simulated
+    double get_interpolation_alpha() const;
+
+    /// Entity state between the last two physics steps at the current alpha
+    /// (the latest state outside real-time runs); false if the id is unknown
+    bool get_interpolated_state(int entity_id, StateVector& out) const;
     
     // Simulation control
     void initialize();
@@ -39,6 +132,10 @@ public:
     void pause();
     void resume();
     bool is_running() const { return is_running_; }
+
+    /// Threads for the entity update phase (1 = serial, 0 = hardware concurrency)
+    void set_update_threads(int threads);
+    int get_update_threads() const { return update_threads_; }
     
     // Time management
     double get_simulation_time() const { return sim_time_; }
@@ -55,10 +152,63 @@ private:
     bool is_running_;
     
     std::vector<std::shared_ptr<Entity>> entities_;
-    
+    std::unordered_map<int, size_t> entity_index_;     // Id -> first position in entities_
+
+    // Type-bucketed storage
+    struct TypeBucket {
+        std::type_index type;
+        BatchUpdate update;
+        std::vector<Entity*> entities;
+    };
+    EntityStorage storage_ = EntityStorage::FLAT;
+    std::unordered_map<std::type_index, BatchUpdate> batch_updates_;
+    std::vector<TypeBucket> buckets_;
+    bool buckets_dirty_ = true;
+
+    // Parallel update phase
+    int update_threads_ = 1;
+    std::unique_ptr<ThreadPool> update_pool_;
+    std::vector<double> update_costs_;     // Smoothed update() time per entity [s]
+    std::vector<size_t> chunk_bounds_;     // Chunk c is [bounds[c], bounds[c+1])
+
+    // Domain transitions
+    struct DomainSample {
+        double time = 0.0;       // Last check: time, altitude, speed
+        double altitude = 0.0;
+        double velocity = 0.0;
+        double due = 0.0;        // Scheduled next check (stale queue entries differ)
+    };
+    using DomainCheck = std::pair<double, int>;        // (due, entity id)
+    DomainThresholds thresholds_;
+    DomainPredictionConfig domain_config_;
+    DomainTransitionCallback on_transition_;
+    std::unordered_map<int, DomainSample> domain_samples_;
+    std::priority_queue<DomainCheck, std::vector<DomainCheck>, std::greater<DomainCheck>> domain_queue_;
+    uint64_t domain_checks_ = 0;
+
+    // Time skip
+    WarpConfig warp_config_;
+    WarpStats warp_stats_;
+
+    // Real-time executive
+    RealTimeConfig rt_config_;
+    RealTimeStats rt_stats_;
+    double rt_accumulator_ = 0.0;                      // Scaled wall time not yet simulated [s]
+    std::vector<StateVector> previous_states_;         // Parallel to entities_, before the last step
+    bool interpolating_ = false;
+
     // Internal update loop
+    void advance(double dt);
+    void run_real_time(double end_time);
+    void run_warp(double end_time);
     void update_entities(double dt);
-    void handle_domain_transitions();
+    void update_entities_parallel(double dt);
+    void update_buckets(double dt);
+    void rebuild_buckets();
+    void plan_chunks();
+    void handle_domain_transitions(double t);
+    void check_domain(Entity& entity, double t, DomainSample& sample);
+    void schedule_domain_check(int entity_id, double due);
     
     // Timing for real-time mode
     std::chrono::high_resolution_clock::time_point last_update_time_;
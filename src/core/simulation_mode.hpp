@@ -1,6 +1,10 @@
 #ifndef SIMULATION_MODE_HPP
 #define SIMULATION_MODE_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace sim {
 
 /**
@@ -29,6 +33,72 @@ struct TimeScale {
     bool is_slowed() const { return factor < 1.0; }
 };
 
+/**
+ * @brief Time-skip ("warp") settings for MODEL_MODE
+ *
+ * Each iteration asks every entity for its warp horizon (Entity::
+ * warp_horizon) and, when the earliest is at least min_jump away, coasts
+ * all entities straight to it (capped at max_jump). Otherwise the engine
+ * takes one fine_dt step, so events are resolved at the usual resolution.
+ */
+struct WarpConfig {
+    bool enabled = false;
+    double fine_dt = 0.1;       // Step around events [s]
+    double min_jump = 1.0;      // Shorter horizons are fine-stepped [s]
+    double max_jump = 3600.0;   // Longest single jump [s]
+};
+
+/// Warp counters
+struct WarpStats {
+    uint64_t jumps = 0;
+    uint64_t fine_steps = 0;
+    double warped_time = 0.0;   // Simulation time covered by jumps [s]
+};
+
+/**
+ * @brief Real-time executive settings for SIMULATION_MODE
+ *
+ * Physics always advances in fixed physics_dt steps of simulation time,
+ * drawn from an accumulator of scaled wall time. Frames start on absolute
+ * wall-clock deadlines frame_period apart. A late frame runs at most
+ * max_catchup_steps steps; simulation time beyond that is dropped (the
+ * simulation slips behind real time rather than spiralling).
+ */
+struct RealTimeConfig {
+    double physics_dt = 0.01;      // Fixed physics step [s of simulation time]
+    double frame_period = 0.01;    // Wall time between frame deadlines [s]
+    int max_catchup_steps = 5;     // Physics steps allowed per frame
+};
+
+/**
+ * @brief Real-time executive counters
+ *
+ * Wake latency is how late a frame started past its deadline. An overrun
+ * is a frame that finished after the next frame's deadline; the missed
+ * deadlines are skipped, not run back to back.
+ */
+struct RealTimeStats {
+    /// Upper edges [s] of the latency histogram bins (the last bin is open)
+    static constexpr std::array<double, 10> LATENCY_EDGES = {
+        50e-6, 100e-6, 200e-6, 500e-6, 1e-3, 2e-3, 5e-3, 10e-3, 20e-3, 50e-3};
+
+    uint64_t frames = 0;
+    uint64_t steps = 0;
+    uint64_t overruns = 0;             // Frames that ran past the next deadline
+    uint64_t missed_deadlines = 0;     // Deadlines skipped after overruns
+    uint64_t dropped_steps = 0;        // Steps lost to the catch-up limit
+    double max_latency = 0.0;          // Worst wake latency [s]
+    double max_frame_time = 0.0;       // Worst frame compute time [s]
+    std::array<uint64_t, LATENCY_EDGES.size() + 1> latency_histogram{};
+
+    void record_latency(double seconds) {
+        size_t bin = 0;
+        while (bin < LATENCY_EDGES.size() && seconds > LATENCY_EDGES[bin]) ++bin;
+        ++latency_histogram[bin];
+        if (seconds > max_latency) max_latency = seconds;
+    }
+};
+
 } // namespace sim
 
 #endif // SIMULATION_MODE_HPP
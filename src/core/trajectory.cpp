@@ -0,0 +1,232 @@
+#include "core/trajectory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sim {
+
+// ═══════════════════════════════════════════════════════════════
+// Column
+// ═══════════════════════════════════════════════════════════════
+
+void Trajectory::Column::push(double v) {
+    if (!f32) {
+        d_.push_back(v);
+        return;
+    }
+    if (f_.size() % BLOCK == 0) anchor_.push_back(v);
+    f_.push_back(static_cast<float>(v - anchor_.back()));
+}
+
+void Trajectory::Column::reserve(size_t n) {
+    if (f32) {
+        f_.reserve(n);
+        anchor_.reserve((n + BLOCK - 1) / BLOCK);
+    } else {
+        d_.reserve(n);
+    }
+}
+
+void Trajectory::Column::clear() {
+    d_.clear();
+    f_.clear();
+    anchor_.clear();
+}
+
+size_t Trajectory::Column::bytes() const {
+    return d_.capacity() * sizeof(double) + f_.capacity() * sizeof(float) +
+           anchor_.capacity() * sizeof(double);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Trajectory
+// ═══════════════════════════════════════════════════════════════
+
+Trajectory::Trajectory(CoordinateFrame frame, const Options& options)
+    : Trajectory(options) {
+    frame_ = frame;
+    frame_set_ = true;
+}
+
+Trajectory::Trajectory(const Options& options) : options_(options) {
+    const bool f32 = options.precision == Precision::Float32;
+    for (Column* c : {&t_, &px_, &py_, &pz_, &vx_, &vy_, &vz_,
+                      &qw_, &qx_, &qy_, &qz_, &wx_, &wy_, &wz_}) {
+        c->f32 = f32;
+    }
+}
+
+Trajectory Trajectory::from_states(const std::vector<StateVector>& states,
+                                   const Options& options) {
+    Trajectory traj(options);
+    traj.reserve(states.size());
+    for (const auto& s : states) traj.push_back(s);
+    return traj;
+}
+
+void Trajectory::push_back(const StateVector& s) {
+    if (!frame_set_) {
+        frame_ = s.frame;
+        frame_set_ = true;
+    } else if (s.frame != frame_) {
+        throw std::invalid_argument("Trajectory sample frame differs from the trajectory's");
+    }
+
+    // Time: stay on the grid while samples land exactly on it
+    if (uniform_) {
+        if (size_ == 0) {
+            t0_ = s.time;
+        } else if (size_ == 1) {
+            dt_ = s.time - t0_;
+        } else if (s.time != t0_ + static_cast<double>(size_) * dt_) {
+            t_.reserve(size_ + 1);
+            for (size_t i = 0; i < size_; i++) t_.push(t0_ + static_cast<double>(i) * dt_);
+            uniform_ = false;
+        }
+    }
+    if (!uniform_) t_.push(s.time);
+
+    px_.push(s.position.x);
+    py_.push(s.position.y);
+    pz_.push(s.position.z);
+    vx_.push(s.velocity.x);
+    vy_.push(s.velocity.y);
+    vz_.push(s.velocity.z);
+    if (options_.attitude) {
+        qw_.push(s.attitude.w);
+        qx_.push(s.attitude.x);
+        qy_.push(s.attitude.y);
+        qz_.push(s.attitude.z);
+        wx_.push(s.angular_velocity.x);
+        wy_.push(s.angular_velocity.y);
+        wz_.push(s.angular_velocity.z);
+    }
+    size_++;
+}
+
+void Trajectory::reserve(size_t n) {
+    if (!uniform_) t_.reserve(n);
+    for (Column* c : {&px_, &py_, &pz_, &vx_, &vy_, &vz_}) c->reserve(n);
+    if (options_.attitude) {
+        for (Column* c : {&qw_, &qx_, &qy_, &qz_, &wx_, &wy_, &wz_}) c->reserve(n);
+    }
+}
+
+void Trajectory::clear() {
+    for (Column* c : {&t_, &px_, &py_, &pz_, &vx_, &vy_, &vz_,
+                      &qw_, &qx_, &qy_, &qz_, &wx_, &wy_, &wz_}) {
+        c->clear();
+    }
+    size_ = 0;
+    uniform_ = true;
+    t0_ = dt_ = 0.0;
+}
+
+StateVector Trajectory::state(size_t i) const {
+    StateVector s;
+    s.position = position(i);
+    s.velocity = velocity(i);
+    if (options_.attitude) {
+        s.attitude = Quat(qw_[i], qx_[i], qy_[i], qz_[i]);
+        s.angular_velocity = Vec3(wx_[i], wy_[i], wz_[i]);
+    }
+    s.time = time(i);
+    s.frame = frame_;
+    return s;
+}
+
+std::vector<StateVector> Trajectory::to_states() const {
+    std::vector<StateVector> out;
+    out.reserve(size_);
+    for (size_t i = 0; i < size_; i++) out.push_back(state(i));
+    return out;
+}
+
+size_t Trajectory::memory_bytes() const {
+    size_t bytes = 0;
+    for (const Column* c : {&t_, &px_, &py_, &pz_, &vx_, &vy_, &vz_,
+                            &qw_, &qx_, &qy_, &qz_, &wx_, &wy_, &wz_}) {
+        bytes += c->bytes();
+    }
+    return bytes;
+}
+
+size_t Trajectory::locate(double t, double& s) const {
+    size_t i;
+    if (uniform_) {
+        double k = dt_ > 0.0 ? std::floor((t - t0_) / dt_) : 0.0;
+        i = static_cast<size_t>(std::max(0.0, std::min(k, static_cast<double>(size_ - 2))));
+    } else {
+        // Last sample with time <= t, kept below the final sample
+        size_t lo = 0, hi = size_ - 1;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (t_[mid] <= t) lo = mid; else hi = mid;
+        }
+        i = lo;
+    }
+    double h = time(i + 1) - time(i);
+    s = h > 0.0 ? std::min(1.0, std::max(0.0, (t - time(i)) / h)) : 0.0;
+    return i;
+}
+
+Vec3 Trajectory::position_at(double t) const {
+    if (size_ == 0) return Vec3::Zero();
+    if (size_ == 1) return position(0);
+    double s;
+    size_t i = locate(t, s);
+    double h = time(i + 1) - time(i);
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = (s3 - 2.0 * s2 + s) * h;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = (s3 - s2) * h;
+    Vec3 p0 = position(i), p1 = position(i + 1);
+    Vec3 v0 = velocity(i), v1 = velocity(i + 1);
+    return Vec3(h00 * p0.x + h10 * v0.x + h01 * p1.x + h11 * v1.x,
+                h00 * p0.y + h10 * v0.y + h01 * p1.y + h11 * v1.y,
+                h00 * p0.z + h10 * v0.z + h01 * p1.z + h11 * v1.z);
+}
+
+StateVector Trajectory::at(double t) const {
+    if (size_ == 0) return StateVector();
+    if (size_ == 1) return state(0);
+    double s;
+    size_t i = locate(t, s);
+    double h = time(i + 1) - time(i);
+    if (!(h > 0.0)) return state(i);
+
+    StateVector out;
+    out.frame = frame_;
+    out.time = time(i) + s * h;
+    out.position = position_at(out.time);
+
+    // d/dt of the Hermite basis
+    double s2 = s * s;
+    double d00 = (6.0 * s2 - 6.0 * s) / h;
+    double d10 = 3.0 * s2 - 4.0 * s + 1.0;
+    double d01 = -d00;
+    double d11 = 3.0 * s2 - 2.0 * s;
+    Vec3 p0 = position(i), p1 = position(i + 1);
+    Vec3 v0 = velocity(i), v1 = velocity(i + 1);
+    out.velocity = Vec3(d00 * p0.x + d10 * v0.x + d01 * p1.x + d11 * v1.x,
+                        d00 * p0.y + d10 * v0.y + d01 * p1.y + d11 * v1.y,
+                        d00 * p0.z + d10 * v0.z + d01 * p1.z + d11 * v1.z);
+
+    if (options_.attitude) {
+        // Normalized lerp along the shorter arc
+        Quat q0(qw_[i], qx_[i], qy_[i], qz_[i]);
+        Quat q1(qw_[i + 1], qx_[i + 1], qy_[i + 1], qz_[i + 1]);
+        double sign = q0.w * q1.w + q0.x * q1.x + q0.y * q1.y + q0.z * q1.z < 0.0 ? -1.0 : 1.0;
+        Quat q((1.0 - s) * q0.w + s * sign * q1.w, (1.0 - s) * q0.x + s * sign * q1.x,
+               (1.0 - s) * q0.y + s * sign * q1.y, (1.0 - s) * q0.z + s * sign * q1.z);
+        double n = std::sqrt(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+        if (n > 1e-15) out.attitude = Quat(q.w / n, q.x / n, q.y / n, q.z / n);
+        out.angular_velocity = Vec3((1.0 - s) * wx_[i] + s * wx_[i + 1],
+                                    (1.0 - s) * wy_[i] + s * wy_[i + 1],
+                                    (1.0 - s) * wz_[i] + s * wz_[i + 1]);
+    }
+    return out;
+}
+
+} // namespace sim
@@ -0,0 +1,138 @@
+/**
+ * Trajectory — columnar storage for sampled states
+ *
+ * A std::vector<StateVector> spends 120 bytes per sample on position,
+ * velocity, attitude, angular velocity, time and frame, even when only
+ * position and velocity vary. Trajectory keeps one column per component
+ * and the frame once:
+ *
+ *   - Time: a uniform grid (start, step) while the samples stay on one,
+ *     promoted to a column at the first sample off the grid.
+ *   - Position and velocity: always.
+ *   - Attitude and angular velocity: only with TrajectoryOptions::attitude;
+ *     otherwise they read back as identity and zero.
+ *
+ * With TrajectoryPrecision::Float32 each column stores float offsets from a double
+ * anchor taken every BLOCK samples, so the error is float rounding of the
+ * excursion within a block (about 6e-8 of it) rather than of the absolute
+ * value. Double storage round-trips exactly.
+ *
+ *   Storage                     Bytes/sample
+ *   Double, uniform time        48
+ *   Double                      56
+ *   Float32, uniform time       ~25
+ *   + attitude (Double)         +56
+ *
+ * at(t) interpolates: cubic Hermite on position and velocity (C1, exact
+ * for the sampled derivative), normalized lerp on attitude, linear on
+ * angular velocity. Times outside the samples clamp to the ends; an empty
+ * trajectory gives a default state.
+ */
+
+#ifndef SIM_TRAJECTORY_HPP
+#define SIM_TRAJECTORY_HPP
+
+#include "core/state_vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace sim {
+
+enum class TrajectoryPrecision { Double, Float32 };
+
+struct TrajectoryOptions {
+    bool attitude = false;                      // Keep attitude and angular velocity
+    TrajectoryPrecision precision = TrajectoryPrecision::Double;
+};
+
+class Trajectory {
+public:
+    using Precision = TrajectoryPrecision;
+    using Options = TrajectoryOptions;
+
+    static constexpr size_t BLOCK = 64;         // Float32 anchor spacing [samples]
+
+    /** Frame taken from the first sample */
+    Trajectory() = default;
+    explicit Trajectory(const Options& options);
+    Trajectory(CoordinateFrame frame, const Options& options = Options());
+
+    /** Copy of states */
+    static Trajectory from_states(const std::vector<StateVector>& states,
+                                  const Options& options = Options());
+
+    /**
+     * Append a sample. Times must not decrease.
+     * @throws std::invalid_argument on a frame other than frame() (once set)
+     */
+    void push_back(const StateVector& state);
+    void reserve(size_t n);
+    void clear();
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    CoordinateFrame frame() const { return frame_; }
+    const Options& options() const { return options_; }
+    bool uniform_time() const { return uniform_; }
+
+    double time(size_t i) const { return uniform_ ? t0_ + static_cast<double>(i) * dt_ : t_[i]; }
+    Vec3 position(size_t i) const { return Vec3(px_[i], py_[i], pz_[i]); }
+    Vec3 velocity(size_t i) const { return Vec3(vx_[i], vy_[i], vz_[i]); }
+
+    /** Sample i as a StateVector */
+    StateVector state(size_t i) const;
+    StateVector operator[](size_t i) const { return state(i); }
+    StateVector front() const { return state(0); }
+    StateVector back() const { return state(size_ - 1); }
+
+    double start_time() const { return time(0); }
+    double end_time() const { return time(size_ - 1); }
+
+    /** Interpolated state at t (see the file comment) */
+    StateVector at(double t) const;
+    Vec3 position_at(double t) const;
+
+    std::vector<StateVector> to_states() const;
+
+    /** Heap bytes held by the columns */
+    size_t memory_bytes() const;
+
+private:
+    /** One component, double or block-anchored float */
+    class Column {
+    public:
+        bool f32 = false;
+
+        void push(double v);
+        void reserve(size_t n);
+        void clear();
+        size_t bytes() const;
+
+        double operator[](size_t i) const {
+            return f32 ? anchor_[i / BLOCK] + static_cast<double>(f_[i]) : d_[i];
+        }
+
+    private:
+        std::vector<double> d_;
+        std::vector<float> f_;
+        std::vector<double> anchor_;
+    };
+
+    CoordinateFrame frame_ = CoordinateFrame::J2000_ECI;
+    bool frame_set_ = false;                     // Else adopted from the first sample
+    Options options_;
+    size_t size_ = 0;
+
+    bool uniform_ = true;
+    double t0_ = 0.0, dt_ = 0.0;
+    Column t_;                                   // Only once !uniform_
+    Column px_, py_, pz_, vx_, vy_, vz_;
+    Column qw_, qx_, qy_, qz_, wx_, wy_, wz_;    // Only with options_.attitude
+
+    /** Interval [i, i+1] holding t (t already clamped), and its parameter */
+    size_t locate(double t, double& s) const;
+};
+
+} // namespace sim
+
+#endif // SIM_TRAJECTORY_HPP
@@ -1,9 +1,12 @@
 #include "world_cities.hpp"
+#include "io/resource_cache.hpp"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdint>
+#include <queue>
 #include <set>
 
 namespace sim {
@@ -39,6 +42,63 @@ namespace {
         return R * c;
     }
 
+    const double EARTH_RADIUS_KM = 6371.0;  // As in haversine_km
+
+    void unit_vector(double lat, double lon, double u[3]) {
+        const double DEG_TO_RAD = M_PI / 180.0;
+        lat *= DEG_TO_RAD;
+        lon *= DEG_TO_RAD;
+        u[0] = std::cos(lat) * std::cos(lon);
+        u[1] = std::cos(lat) * std::sin(lon);
+        u[2] = std::sin(lat);
+    }
+
+    double dot3(const double a[3], const double b[3]) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    void cross3(const double a[3], const double b[3], double out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+    /** Angle between unit vectors [rad] (atan2 form: accurate at 0 and pi) */
+    double angle3(const double a[3], const double b[3]) {
+        double c[3];
+        cross3(a, b, c);
+        return std::atan2(std::sqrt(dot3(c, c)), dot3(a, b));
+    }
+
+    /** Great-circle distance from p to the arc a-b [km] */
+    double arc_distance_km(const double p[3], const double a[3], const double b[3]) {
+        double n[3];
+        cross3(a, b, n);
+        const double len = std::sqrt(dot3(n, n));
+        if (len > 1e-12) {
+            for (double& v : n) v /= len;
+            // Foot of the perpendicular lies on the arc when it is between a and b
+            double an[3], nb[3];
+            double foot[3];
+            const double h = dot3(p, n);
+            for (int i = 0; i < 3; i++) foot[i] = p[i] - h * n[i];
+            cross3(a, foot, an);
+            cross3(foot, b, nb);
+            if (dot3(an, n) >= 0.0 && dot3(nb, n) >= 0.0) {
+                return std::asin(std::min(1.0, std::fabs(h))) * EARTH_RADIUS_KM;
+            }
+        }
+        return std::min(angle3(p, a), angle3(p, b)) * EARTH_RADIUS_KM;
+    }
+
+    /** Squared chord of a great-circle radius, padded so rounding never excludes a city */
+    double chord2_for_km(double radius_km) {
+        const double angle = radius_km / EARTH_RADIUS_KM;
+        if (angle >= M_PI) return 4.0 + 1e-9;
+        const double chord = 2.0 * std::sin(0.5 * std::max(angle, 0.0));
+        return chord * chord * (1.0 + 1e-9) + 1e-15;
+    }
+
     // Extract string value from JSON
     std::string extract_string(const std::string& json, const std::string& key) {
         std::string search = "\"" + key + "\"";
@@ -87,10 +147,14 @@ namespace {
     }
 }
 
-bool WorldCities::load(const std::string& filename) {
+namespace {
+
+// The "cities" array of a world_cities_1000.json (empty if unreadable)
+std::vector<City> parse_cities(const std::string& filename) {
+    std::vector<City> cities;
     std::ifstream file(filename);
     if (!file.is_open()) {
-        return false;
+        return cities;
     }
 
     // Read entire file
@@ -99,15 +163,12 @@ bool WorldCities::load(const std::string& filename) {
     std::string content = buffer.str();
     file.close();
 
-    cities_.clear();
-    id_index_.clear();
-
     // Find the cities array
     size_t cities_start = content.find("\"cities\"");
-    if (cities_start == std::string::npos) return false;
+    if (cities_start == std::string::npos) return cities;
 
     cities_start = content.find('[', cities_start);
-    if (cities_start == std::string::npos) return false;
+    if (cities_start == std::string::npos) return cities;
 
     // Parse each city object
     size_t pos = cities_start;
@@ -133,8 +194,7 @@ bool WorldCities::load(const std::string& filename) {
         city.timezone = extract_string(city_json, "timezone");
 
         if (!city.name.empty()) {
-            id_index_[city.id] = cities_.size();
-            cities_.push_back(city);
+            cities.push_back(city);
         }
 
         pos = obj_end + 1;
@@ -148,18 +208,184 @@ bool WorldCities::load(const std::string& filename) {
         }
     }
 
-    return !cities_.empty();
+    return cities;
+}
+
+} // namespace
+
+/**
+ * Implicit k-d tree: the node for a range of `order` is its midpoint, with
+ * cities no greater on its axis to the left and no less to the right.
+ */
+struct WorldCities::SpatialIndex {
+    std::vector<size_t> order;      // City indices in tree order
+    std::vector<uint8_t> axis;      // Split axis of the node at each position
+    std::vector<double> xyz;        // Unit vector of city i at 3 * i
+
+    const double* at(size_t city) const { return &xyz[3 * city]; }
+
+    double dist2(size_t city, const double u[3]) const {
+        const double* p = at(city);
+        const double dx = p[0] - u[0], dy = p[1] - u[1], dz = p[2] - u[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    void build(size_t lo, size_t hi) {
+        if (hi - lo < 2) {
+            if (hi > lo) axis[lo] = 0;
+            return;
+        }
+        // Split on the axis of widest spread
+        double mn[3] = {2, 2, 2}, mx[3] = {-2, -2, -2};
+        for (size_t i = lo; i < hi; i++) {
+            const double* p = at(order[i]);
+            for (int k = 0; k < 3; k++) {
+                mn[k] = std::min(mn[k], p[k]);
+                mx[k] = std::max(mx[k], p[k]);
+            }
+        }
+        int ax = 0;
+        for (int k = 1; k < 3; k++) {
+            if (mx[k] - mn[k] > mx[ax] - mn[ax]) ax = k;
+        }
+        const size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                         [&](size_t a, size_t b) { return at(a)[ax] < at(b)[ax]; });
+        axis[mid] = static_cast<uint8_t>(ax);
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    void within(size_t lo, size_t hi, const double u[3], double r2,
+                std::vector<size_t>& out) const {
+        if (lo >= hi) return;
+        const size_t mid = lo + (hi - lo) / 2;
+        const size_t city = order[mid];
+        if (dist2(city, u) <= r2) out.push_back(city);
+        const double diff = u[axis[mid]] - at(city)[axis[mid]];
+        if (diff <= 0.0 || diff * diff <= r2) within(lo, mid, u, r2, out);
+        if (diff >= 0.0 || diff * diff <= r2) within(mid + 1, hi, u, r2, out);
+    }
+
+    using Candidate = std::pair<double, size_t>;   // (chord², city), max-heap on chord²
+
+    void nearest(size_t lo, size_t hi, const double u[3], size_t k,
+                 std::priority_queue<Candidate>& best) const {
+        if (lo >= hi) return;
+        const size_t mid = lo + (hi - lo) / 2;
+        const size_t city = order[mid];
+        const Candidate c(dist2(city, u), city);
+        if (best.size() < k) {
+            best.push(c);
+        } else if (c < best.top()) {
+            best.pop();
+            best.push(c);
+        }
+        const double diff = u[axis[mid]] - at(city)[axis[mid]];
+        const bool left_first = diff <= 0.0;
+        nearest(left_first ? lo : mid + 1, left_first ? mid : hi, u, k, best);
+        if (best.size() < k || diff * diff <= best.top().first) {
+            nearest(left_first ? mid + 1 : lo, left_first ? hi : mid, u, k, best);
+        }
+    }
+};
+
+template <>
+struct ResourceCodec<std::vector<City>> {
+    static constexpr const char* kind = "cities";
+    static constexpr uint32_t version = 1;
+
+    static void save(ResourceWriter& w, const std::vector<City>& cities) {
+        w.put(static_cast<uint64_t>(cities.size()));
+        for (const City& c : cities) {
+            w.put(c.id);
+            w.put(c.name);
+            w.put(c.ascii_name);
+            w.put(c.country);
+            w.put(c.country_code);
+            w.put(c.latitude);
+            w.put(c.longitude);
+            w.put(c.elevation_m);
+            w.put(c.population);
+            w.put(c.timezone);
+        }
+    }
+
+    static bool restore(ResourceReader& r, std::vector<City>& cities) {
+        uint64_t n = 0;
+        if (!r.get(n)) return false;
+        cities.resize(static_cast<size_t>(n));
+        for (City& c : cities) {
+            if (!(r.get(c.id) && r.get(c.name) && r.get(c.ascii_name) && r.get(c.country) &&
+                  r.get(c.country_code) && r.get(c.latitude) && r.get(c.longitude) &&
+                  r.get(c.elevation_m) && r.get(c.population) && r.get(c.timezone))) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+bool WorldCities::load(const std::string& filename) {
+    open(filename);
+    return !cities().empty();
+}
+
+void WorldCities::open(const std::string& filename) {
+    pending_ = filename;
+    cities_.reset();
+    id_index_.clear();
+    spatial_.reset();
+    name_index_.clear();
+}
+
+const std::vector<City>& WorldCities::cities() const {
+    if (!cities_) {
+        if (pending_.empty()) {
+            cities_ = std::make_shared<const std::vector<City>>();
+        } else {
+            cities_ = ResourceCache::global().load<std::vector<City>>(
+                pending_, parse_cities, [](const std::vector<City>& v) { return v.size(); });
+            pending_.clear();
+        }
+        for (size_t i = 0; i < cities_->size(); i++) id_index_[(*cities_)[i].id] = i;
+    }
+    return *cities_;
+}
+
+const WorldCities::SpatialIndex& WorldCities::spatial() const {
+    if (!spatial_) {
+        const auto& all = cities();
+        auto index = std::make_shared<SpatialIndex>();
+        index->order.resize(all.size());
+        index->axis.resize(all.size());
+        index->xyz.resize(3 * all.size());
+        for (size_t i = 0; i < all.size(); i++) {
+            index->order[i] = i;
+            unit_vector(all[i].latitude, all[i].longitude, &index->xyz[3 * i]);
+        }
+        index->build(0, all.size());
+        spatial_ = index;
+    }
+    return *spatial_;
+}
+
+void WorldCities::collect_within(const double u[3], double radius_km,
+                                 std::vector<size_t>& out) const {
+    const SpatialIndex& index = spatial();
+    index.within(0, index.order.size(), u, chord2_for_km(radius_km), out);
 }
 
 const City* WorldCities::get_by_id(int id) const {
+    cities();
     auto it = id_index_.find(id);
     if (it == id_index_.end()) return nullptr;
-    return &cities_[it->second];
+    return &cities()[it->second];
 }
 
 const City* WorldCities::find_by_name(const std::string& name) const {
     std::string lower_name = to_lower(name);
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         if (to_lower(city.name).find(lower_name) != std::string::npos ||
             to_lower(city.ascii_name).find(lower_name) != std::string::npos) {
             return &city;
@@ -171,7 +397,7 @@ const City* WorldCities::find_by_name(const std::string& name) const {
 std::vector<const City*> WorldCities::find_all_by_name(const std::string& name) const {
     std::vector<const City*> results;
     std::string lower_name = to_lower(name);
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         if (to_lower(city.name).find(lower_name) != std::string::npos ||
             to_lower(city.ascii_name).find(lower_name) != std::string::npos) {
             results.push_back(&city);
@@ -183,7 +409,7 @@ std::vector<const City*> WorldCities::find_all_by_name(const std::string& name)
 std::vector<const City*> WorldCities::get_by_country(const std::string& country) const {
     std::vector<const City*> results;
     std::string lower_country = to_lower(country);
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         if (to_lower(city.country).find(lower_country) != std::string::npos) {
             results.push_back(&city);
         }
@@ -193,7 +419,7 @@ std::vector<const City*> WorldCities::get_by_country(const std::string& country)
 
 std::vector<const City*> WorldCities::get_by_min_population(int min_pop) const {
     std::vector<const City*> results;
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         if (city.population >= min_pop) {
             results.push_back(&city);
         }
@@ -206,7 +432,7 @@ std::vector<const City*> WorldCities::get_in_region(
     double min_lon, double max_lon) const {
 
     std::vector<const City*> results;
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         if (city.latitude >= min_lat && city.latitude <= max_lat &&
             city.longitude >= min_lon && city.longitude <= max_lon) {
             results.push_back(&city);
@@ -218,17 +444,24 @@ std::vector<const City*> WorldCities::get_in_region(
 std::vector<const City*> WorldCities::get_near_point(
     double lat, double lon, double radius_km) const {
 
+    double u[3];
+    unit_vector(lat, lon, u);
+    std::vector<size_t> candidates;
+    collect_within(u, radius_km, candidates);
+    std::sort(candidates.begin(), candidates.end());
+
+    const auto& all = cities();
     std::vector<std::pair<double, const City*>> results;
-    for (const auto& city : cities_) {
-        double dist = haversine_km(lat, lon, city.latitude, city.longitude);
+    for (size_t i : candidates) {
+        double dist = haversine_km(lat, lon, all[i].latitude, all[i].longitude);
         if (dist <= radius_km) {
-            results.push_back({dist, &city});
+            results.push_back({dist, &all[i]});
         }
     }
 
     // Sort by distance
-    std::sort(results.begin(), results.end(),
-              [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::stable_sort(results.begin(), results.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
 
     std::vector<const City*> sorted;
     for (const auto& pair : results) {
@@ -237,18 +470,172 @@ std::vector<const City*> WorldCities::get_near_point(
     return sorted;
 }
 
+std::vector<const City*> WorldCities::get_nearest(double lat, double lon, size_t k) const {
+    std::vector<const City*> results;
+    if (k == 0 || cities().empty()) return results;
+
+    double u[3];
+    unit_vector(lat, lon, u);
+    const SpatialIndex& index = spatial();
+    std::priority_queue<SpatialIndex::Candidate> best;
+    index.nearest(0, index.order.size(), u, k, best);
+
+    // Chord length orders the same as great-circle distance
+    results.resize(best.size());
+    for (size_t i = best.size(); i-- > 0; best.pop()) {
+        results[i] = &cities()[best.top().second];
+    }
+    return results;
+}
+
+const City* WorldCities::nearest(double lat, double lon) const {
+    auto results = get_nearest(lat, lon, 1);
+    return results.empty() ? nullptr : results[0];
+}
+
+std::vector<const City*> WorldCities::get_near_track(
+    const std::vector<std::pair<double, double>>& track, double radius_km) const {
+
+    std::vector<const City*> sorted;
+    if (track.empty()) return sorted;
+    if (track.size() == 1) return get_near_point(track[0].first, track[0].second, radius_km);
+
+    const auto& all = cities();
+    const SpatialIndex& index = spatial();
+    std::unordered_map<size_t, double> dist;   // city -> distance to the nearest arc
+    std::vector<size_t> candidates;
+    for (size_t s = 0; s + 1 < track.size(); s++) {
+        double a[3], b[3], m[3];
+        unit_vector(track[s].first, track[s].second, a);
+        unit_vector(track[s + 1].first, track[s + 1].second, b);
+
+        // Cities near the arc are within (half its length + radius) of its midpoint
+        const double half_km = 0.5 * angle3(a, b) * EARTH_RADIUS_KM;
+        for (int i = 0; i < 3; i++) m[i] = a[i] + b[i];
+        const double len = std::sqrt(dot3(m, m));
+        double cap_km = half_km + radius_km;
+        if (len > 1e-12) {
+            for (double& v : m) v /= len;
+        } else {
+            std::copy(a, a + 3, m);   // Antipodal ends: no unique arc, search everything
+            cap_km = M_PI * EARTH_RADIUS_KM;
+        }
+
+        candidates.clear();
+        collect_within(m, cap_km, candidates);
+        for (size_t i : candidates) {
+            double d = arc_distance_km(index.at(i), a, b);
+            if (d > radius_km) continue;
+            auto it = dist.find(i);
+            if (it == dist.end()) {
+                dist.emplace(i, d);
+            } else {
+                it->second = std::min(it->second, d);
+            }
+        }
+    }
+
+    std::vector<std::pair<double, size_t>> results;
+    for (const auto& d : dist) results.push_back({d.second, d.first});
+    std::sort(results.begin(), results.end());
+    for (const auto& r : results) {
+        sorted.push_back(&all[r.second]);
+    }
+    return sorted;
+}
+
+std::vector<const City*> WorldCities::get_in_polygon(
+    const std::vector<std::pair<double, double>>& vertices) const {
+
+    std::vector<const City*> results;
+    const size_t n = vertices.size();
+    if (n < 3) return results;
+
+    // Centre of the vertices; every vertex must be in its hemisphere
+    std::vector<double> v(3 * n);
+    double c[3] = {0, 0, 0};
+    for (size_t i = 0; i < n; i++) {
+        unit_vector(vertices[i].first, vertices[i].second, &v[3 * i]);
+        for (int k = 0; k < 3; k++) c[k] += v[3 * i + k];
+    }
+    const double len = std::sqrt(dot3(c, c));
+    if (len < 1e-12) return results;
+    for (double& x : c) x /= len;
+    double cap = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (dot3(&v[3 * i], c) <= 1e-12) return results;
+        cap = std::max(cap, angle3(&v[3 * i], c));
+    }
+
+    // Gnomonic projection about c: great-circle edges become straight lines
+    double e1[3], e2[3];
+    const double ref[3] = {std::fabs(c[2]) < 0.9 ? 0.0 : 1.0, 0.0, std::fabs(c[2]) < 0.9 ? 1.0 : 0.0};
+    cross3(ref, c, e1);
+    const double l1 = std::sqrt(dot3(e1, e1));
+    for (double& x : e1) x /= l1;
+    cross3(c, e1, e2);
+    auto project = [&](const double p[3], double& x, double& y) {
+        const double w = dot3(p, c);
+        x = dot3(p, e1) / w;
+        y = dot3(p, e2) / w;
+    };
+    std::vector<double> px(n), py(n);
+    for (size_t i = 0; i < n; i++) project(&v[3 * i], px[i], py[i]);
+
+    // A cap narrower than a hemisphere holds every edge of its vertices
+    std::vector<size_t> candidates;
+    collect_within(c, cap * EARTH_RADIUS_KM, candidates);
+    std::sort(candidates.begin(), candidates.end());
+
+    const SpatialIndex& index = spatial();
+    const auto& all = cities();
+    for (size_t city : candidates) {
+        const double* p = index.at(city);
+        if (dot3(p, c) <= 0.0) continue;
+        double x, y;
+        project(p, x, y);
+        bool inside = false;
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            if ((py[i] > y) != (py[j] > y) &&
+                x < (px[j] - px[i]) * (y - py[i]) / (py[j] - py[i]) + px[i]) {
+                inside = !inside;
+            }
+        }
+        if (inside) results.push_back(&all[city]);
+    }
+    return results;
+}
+
+std::vector<const City*> WorldCities::find_exact(const std::string& name) const {
+    const auto& all = cities();
+    if (name_index_.empty() && !all.empty()) {
+        for (size_t i = 0; i < all.size(); i++) {
+            std::string lower = to_lower(all[i].name);
+            std::string ascii = to_lower(all[i].ascii_name);
+            name_index_[lower].push_back(i);
+            if (ascii != lower) name_index_[ascii].push_back(i);
+        }
+    }
+    std::vector<const City*> results;
+    auto it = name_index_.find(to_lower(name));
+    if (it != name_index_.end()) {
+        for (size_t i : it->second) results.push_back(&all[i]);
+    }
+    return results;
+}
+
 std::vector<const City*> WorldCities::get_top_n(size_t n) const {
     std::vector<const City*> results;
-    size_t count = std::min(n, cities_.size());
+    size_t count = std::min(n, cities().size());
     for (size_t i = 0; i < count; i++) {
-        results.push_back(&cities_[i]);
+        results.push_back(&cities()[i]);
     }
     return results;
 }
 
 std::vector<std::string> WorldCities::get_countries() const {
     std::set<std::string> country_set;
-    for (const auto& city : cities_) {
+    for (const auto& city : cities()) {
         country_set.insert(city.country);
     }
     return std::vector<std::string>(country_set.begin(), country_set.end());
@@ -1,7 +1,9 @@
 #ifndef WORLD_CITIES_HPP
 #define WORLD_CITIES_HPP
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
@@ -42,6 +44,21 @@ struct City {
  *
  *   // Find by name
  *   auto tokyo = cities.find_by_name("Tokyo");
+ *
+ *   // Spatial queries
+ *   auto near = cities.get_near_point(40.6, -73.8, 500.0);
+ *   auto closest = cities.get_nearest(lat, lon, 5);
+ *
+ * Files are read through ResourceCache::global(): parsed once per process
+ * and shared by every WorldCities that loads them, and with a cache
+ * directory (SIM_DATA_CACHE) read back from their binary form while the
+ * file is unchanged. open() defers the read to the first query.
+ *
+ * Spatial queries (get_near_point, get_nearest, get_near_track,
+ * get_in_polygon) go through a k-d tree on the cities' unit vectors, built
+ * on the first such query: a great-circle radius is a chord radius, so a
+ * lookup visits only the cities near the answer. Exact-name lookups go
+ * through a hash of lower-cased names, built on first use.
  */
 class WorldCities {
 public:
@@ -54,15 +71,22 @@ public:
      */
     bool load(const std::string& filename);
 
+    /**
+     * Attach a cities file without reading it; the first query loads it
+     * (an unreadable file then reads as no cities)
+     * @param filename Path to world_cities_1000.json
+     */
+    void open(const std::string& filename);
+
     /**
      * Get all loaded cities
      */
-    const std::vector<City>& get_all() const { return cities_; }
+    const std::vector<City>& get_all() const { return cities(); }
 
     /**
      * Get number of cities
      */
-    size_t size() const { return cities_.size(); }
+    size_t size() const { return cities().size(); }
 
     /**
      * Get city by ID
@@ -121,6 +145,46 @@ public:
     std::vector<const City*> get_near_point(
         double lat, double lon, double radius_km) const;
 
+    /**
+     * Get the k cities closest to a point
+     * @param lat Latitude
+     * @param lon Longitude
+     * @param k Number of cities to return
+     * @return Up to k cities, nearest first
+     */
+    std::vector<const City*> get_nearest(double lat, double lon, size_t k) const;
+
+    /**
+     * Get the city closest to a point
+     * @return Nearest city or nullptr if none are loaded
+     */
+    const City* nearest(double lat, double lon) const;
+
+    /**
+     * Get cities within radius of a ground track
+     * @param track (lat, lon) points in degrees, joined by great-circle arcs
+     * @param radius_km Radius in kilometers
+     * @return Cities within radius of any arc (or of the point, for a
+     *         one-point track), sorted by distance to the track
+     */
+    std::vector<const City*> get_near_track(
+        const std::vector<std::pair<double, double>>& track, double radius_km) const;
+
+    /**
+     * Get cities inside a footprint polygon
+     * @param vertices (lat, lon) corners in degrees, edges along great circles;
+     *        the polygon must fit in a hemisphere (any footprint does)
+     * @return Cities inside, in database order
+     */
+    std::vector<const City*> get_in_polygon(
+        const std::vector<std::pair<double, double>>& vertices) const;
+
+    /**
+     * Find cities whose name or ASCII name equals `name` (case-insensitive)
+     * @return Matching cities, in database order
+     */
+    std::vector<const City*> find_exact(const std::string& name) const;
+
     /**
      * Get the N largest cities by population
      * @param n Number of cities to return
@@ -151,8 +215,23 @@ public:
     static double distance_km(double lat, double lon, const City& city);
 
 private:
-    std::vector<City> cities_;
-    std::unordered_map<int, size_t> id_index_;  // id -> vector index
+    struct SpatialIndex;
+
+    /** The cities, loading an open()ed file first */
+    const std::vector<City>& cities() const;
+
+    /** The k-d tree, built on first use */
+    const SpatialIndex& spatial() const;
+
+    /** Indices within great-circle radius_km of a unit vector (unsorted) */
+    void collect_within(const double u[3], double radius_km, std::vector<size_t>& out) const;
+
+    // Filled on the first query after open() (not thread-safe)
+    mutable std::string pending_;
+    mutable std::shared_ptr<const std::vector<City>> cities_;   // Shared with the cache
+    mutable std::unordered_map<int, size_t> id_index_;  // id -> vector index
+    mutable std::shared_ptr<const SpatialIndex> spatial_;
+    mutable std::unordered_map<std::string, std::vector<size_t>> name_index_;  // lower-cased
 };
 
 } // namespace sim
@@ -1,7 +1,9 @@
 #include "atmospheric_debris.hpp"
+#include "physics/atmosphere_table.hpp"
 #include <cmath>
 #include <random>
 #include <chrono>
+#include <limits>
 
 namespace sim {
 
@@ -30,8 +32,8 @@ void AtmosphericDebris::update(double dt) {
 
     time_since_creation += dt;
 
-    // Atmospheric density (exponential model)
-    double rho = RHO_SEA_LEVEL * std::exp(-altitude / SCALE_HEIGHT);
+    // Atmospheric density (shared US Standard Atmosphere table)
+    double rho = AtmosphereTable::earth().density(altitude);
 
     // Current speed
     double speed = get_speed();
@@ -150,26 +152,187 @@ bool simulate_debris_until_landing(
     double max_time,
     double record_interval) {
 
-    double elapsed = 0.0;
+    // Steps of the shared clock; pieces are independent, so each one is
+    // run to landing (or the step limit) on its own
+    long steps = 0;
+    for (double elapsed = 0.0; elapsed < max_time; elapsed += dt) steps++;
+
+    // All pieces must be down before the last step for the clock loop to
+    // see an all-landed pass
+    bool all_landed = true;
+    for (auto& d : debris) {
+        long used = 0;
+        while (d.is_falling && used < steps) {
+            d.update(dt);
+            used++;
+        }
+        all_landed = all_landed && !d.is_falling && used < steps;
+    }
+
+    return all_landed;
+}
+
+namespace {
 
-    while (elapsed < max_time) {
-        bool any_falling = false;
+struct FallState {
+    double lat, lon, alt;    // degrees, degrees, meters
+    double ve, vn, vu;       // m/s
+};
 
-        for (auto& d : debris) {
-            if (d.is_falling) {
-                d.update(dt);
-                any_falling = true;
+constexpr double METERS_PER_DEG_LAT = 111132.0;
+
+/// Drag + gravity acceleration (ENU, flat-earth as in AtmosphericDebris::update)
+void fall_acceleration(const AtmosphereTable& atm, double k_drag, const FallState& s,
+                       double& ae, double& an, double& au) {
+    double speed = std::sqrt(s.ve * s.ve + s.vn * s.vn + s.vu * s.vu);
+    double c = (speed > 0.1) ? 0.5 * atm.density(s.alt) * speed * k_drag : 0.0;
+    ae = -c * s.ve;
+    an = -c * s.vn;
+    au = -c * s.vu - AtmosphericDebris::GRAVITY;
+}
+
+/// s += dt * (velocity, acceleration)
+void fall_advance(const FallState& s, double dt, double ve, double vn, double vu,
+                  double ae, double an, double au, FallState& out) {
+    double meters_per_deg_lon = METERS_PER_DEG_LAT * std::cos(s.lat * M_PI / 180.0);
+    out.lon = s.lon + (meters_per_deg_lon > 1.0 ? ve * dt / meters_per_deg_lon : 0.0);
+    out.lat = s.lat + vn * dt / METERS_PER_DEG_LAT;
+    out.alt = s.alt + vu * dt;
+    out.ve = s.ve + ae * dt;
+    out.vn = s.vn + an * dt;
+    out.vu = s.vu + au * dt;
+}
+
+/// Terminal speed at alt (infinite where there is no air)
+double terminal_speed(const AtmosphereTable& atm, double k_drag, double alt) {
+    double rho = atm.density(alt);
+    return (rho > 0.0 && k_drag > 0.0) ?
+        std::sqrt(2.0 * AtmosphericDebris::GRAVITY / (rho * k_drag)) :
+        std::numeric_limits<double>::infinity();
+}
+
+} // namespace
+
+size_t simulate_debris_impacts(
+    std::vector<AtmosphericDebris>& debris,
+    const DebrisFallConfig& config,
+    const std::function<void(const DebrisImpact&)>& on_impact) {
+
+    const AtmosphereTable& atm = AtmosphereTable::earth();
+    const double g = AtmosphericDebris::GRAVITY;
+    size_t landed = 0;
+
+    for (auto& d : debris) {
+        if (!d.is_falling) continue;
+
+        // Drag acceleration = 0.5 rho v^2 k_drag
+        const double k_drag = d.mass > 0.0 ? d.drag_coeff * d.drag_area / d.mass : 0.0;
+        FallState s{d.latitude, d.longitude, d.altitude, d.vel_east, d.vel_north, d.vel_up};
+        double t = 0.0;
+        bool down = false;
+        double impact_speed = 0.0;
+
+        while (t < config.max_time) {
+            double ae, an, au;
+            fall_acceleration(atm, k_drag, s, ae, an, au);
+            double speed = std::sqrt(s.ve * s.ve + s.vn * s.vn + s.vu * s.vu);
+            double accel = std::sqrt(ae * ae + an * an + au * au);
+
+            // Terminal-velocity close-out
+            double vt = terminal_speed(atm, k_drag, s.alt);
+            if (config.terminal_shortcut && std::isfinite(vt) && s.alt > 0.0) {
+                double horizontal = std::sqrt(s.ve * s.ve + s.vn * s.vn);
+                double rho = atm.density(s.alt);
+                double dh = std::min(100.0, s.alt);
+                double scale_height = rho * dh / std::max(atm.density(s.alt - dh) - rho, 1e-300);
+                if (std::fabs(s.vu + vt) < config.terminal_tolerance * vt &&
+                    horizontal < config.terminal_tolerance * vt &&
+                    vt * vt < 0.1 * g * scale_height) {
+
+                    // Fall time: trapezoid on 1 / v(h) in 250 m slices. Falling
+                    // into denser air the piece lags its terminal speed,
+                    // v = v_t (1 + v_t^2 / (4 g H)), H the slice's scale height
+                    double fall = 0.0, h = s.alt, vt_prev = vt;
+                    while (h > 0.0) {
+                        double h_next = std::max(0.0, h - 250.0);
+                        double vt_next = terminal_speed(atm, k_drag, h_next);
+                        double log_ratio = 2.0 * std::log(vt_prev / vt_next);
+                        double lag = log_ratio > 0.0 ? log_ratio / (4.0 * g * (h - h_next)) : 0.0;
+                        fall += 0.5 * (h - h_next) *
+                                (1.0 / (vt_prev * (1.0 + vt_prev * vt_prev * lag)) +
+                                 1.0 / (vt_next * (1.0 + vt_next * vt_next * lag)));
+                        h = h_next;
+                        vt_prev = vt_next;
+                    }
+                    if (t + fall <= config.max_time) {
+                        // Residual horizontal velocity decays on v_t / g
+                        double drift = vt / g;
+                        FallState end;
+                        fall_advance(s, drift, s.ve, s.vn, 0.0, 0.0, 0.0, 0.0, end);
+                        s.lat = end.lat;
+                        s.lon = end.lon;
+                        s.alt = 0.0;
+                        t += fall;
+                        impact_speed = vt_prev;
+                        down = true;
+                        break;
+                    }
+                }
+            }
+
+            // Adaptive midpoint step
+            double dt = config.step_tolerance * std::max(speed, 1.0) / std::max(accel, 1e-9);
+            dt = std::max(config.min_step, std::min(config.max_step, dt));
+            dt = std::min(dt, config.max_time - t);
+
+            FallState mid, next;
+            fall_advance(s, 0.5 * dt, s.ve, s.vn, s.vu, ae, an, au, mid);
+            double me, mn, mu;
+            fall_acceleration(atm, k_drag, mid, me, mn, mu);
+            fall_advance(s, dt, mid.ve, mid.vn, mid.vu, me, mn, mu, next);
+
+            if (next.alt <= 0.0) {
+                // Interpolate to the ground crossing
+                double f = s.alt / std::max(s.alt - next.alt, 1e-300);
+                s.lat += f * (next.lat - s.lat);
+                s.lon += f * (next.lon - s.lon);
+                double ve = s.ve + f * (next.ve - s.ve);
+                double vn = s.vn + f * (next.vn - s.vn);
+                double vu = s.vu + f * (next.vu - s.vu);
+                s.alt = 0.0;
+                t += f * dt;
+                impact_speed = std::sqrt(ve * ve + vn * vn + vu * vu);
+                down = true;
+                break;
             }
+            s = next;
+            t += dt;
         }
 
-        if (!any_falling) {
-            return true;  // All debris has landed
+        d.latitude = s.lat;
+        d.longitude = s.lon;
+        d.altitude = s.alt;
+        d.time_since_creation += t;
+        if (!down) {
+            d.vel_east = s.ve;
+            d.vel_north = s.vn;
+            d.vel_up = s.vu;
+            continue;
         }
 
-        elapsed += dt;
+        d.altitude = 0.0;
+        d.is_falling = false;
+        d.vel_east = 0.0;
+        d.vel_north = 0.0;
+        d.vel_up = 0.0;
+        landed++;
+        if (on_impact) {
+            on_impact(DebrisImpact{d.id, d.source_id, d.team_id, d.latitude, d.longitude,
+                                   d.time_since_creation, impact_speed});
+        }
     }
 
-    return false;  // Timeout
+    return landed;
 }
 
 } // namespace sim
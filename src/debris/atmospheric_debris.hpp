@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <functional>
 
 namespace sim {
 
@@ -15,7 +16,7 @@ namespace sim {
  * Physics:
  * - Ballistic trajectory with gravity
  * - Atmospheric drag: F_drag = 0.5 * rho * v^2 * Cd * A
- * - Exponential atmosphere model: rho = rho_0 * exp(-h/H)
+ * - US Standard Atmosphere density via sim::AtmosphereTable
  */
 
 struct AtmosphericDebris {
@@ -68,8 +69,6 @@ struct AtmosphericDebris {
 
     // Physical constants
     static constexpr double GRAVITY = 9.81;           // m/s^2
-    static constexpr double RHO_SEA_LEVEL = 1.225;    // kg/m^3
-    static constexpr double SCALE_HEIGHT = 8500.0;    // m
     static constexpr double EARTH_RADIUS = 6371000.0; // m
 };
 
@@ -114,6 +113,57 @@ bool simulate_debris_until_landing(
     double max_time = 600.0,
     double record_interval = 0.0);
 
+/**
+ * Ground impact of one debris piece
+ */
+struct DebrisImpact {
+    int id;
+    int source_id;
+    int team_id;
+    double latitude;         // degrees
+    double longitude;        // degrees
+    double time;             // Seconds since creation at impact
+    double speed;            // Impact speed (m/s)
+};
+
+/**
+ * Settings for simulate_debris_impacts
+ */
+struct DebrisFallConfig {
+    double max_time = 600.0;            // Per-piece flight time limit (seconds)
+    double step_tolerance = 0.02;       // Velocity change per step, fraction of speed
+    double min_step = 1e-3;             // seconds
+    double max_step = 2.0;              // seconds
+    bool terminal_shortcut = true;      // Close out pieces at drag equilibrium
+    double terminal_tolerance = 0.01;   // Equilibrium: |v - v_terminal| / v_terminal
+};
+
+/**
+ * Fly each debris piece to the ground on its own adaptive step
+ *
+ * Pieces have no interaction, so each one is integrated to impact
+ * (midpoint RK2 against AtmosphereTable::earth(), step sized so the
+ * velocity changes by step_tolerance of the speed) before the next
+ * starts; nothing is spent on pieces that have already landed.
+ *
+ * Once a piece falls straight down at its terminal velocity, and the
+ * atmosphere changes slowly on the scale of its drag response time
+ * (v_t^2 / (g H) < 0.1), the rest of the fall is closed out
+ * quasi-statically: time from the integral of dh / v(h), with v the
+ * terminal velocity plus its first-order lag in thickening air, and
+ * horizontal drift from the decay of the residual horizontal velocity.
+ *
+ * @param debris Pieces (updated to their final state; landed pieces as in
+ *               AtmosphericDebris::update)
+ * @param config Step and shortcut settings
+ * @param on_impact Called for every piece that lands, in piece order
+ * @return Number of pieces that landed within config.max_time
+ */
+size_t simulate_debris_impacts(
+    std::vector<AtmosphericDebris>& debris,
+    const DebrisFallConfig& config = DebrisFallConfig(),
+    const std::function<void(const DebrisImpact&)>& on_impact = nullptr);
+
 } // namespace sim
 
 #endif // ATMOSPHERIC_DEBRIS_HPP
@@ -0,0 +1,280 @@
+#include "breakup_generator.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t TASK = 4096;                  // Fragments per pool task
+constexpr double CATASTROPHIC_EMR = 40000.0;   // Impact energy / target mass [J/kg]
+constexpr double LN10 = 2.302585092994046;
+
+// Random draws per fragment
+enum Draw : uint64_t {
+    DRAW_SIZE,
+    DRAW_MODE,        // Area-to-mass distribution pick
+    DRAW_NORMAL_R,    // Box-Muller pair: log10 A/M and log10 dv
+    DRAW_NORMAL_T,
+    DRAW_DIR_Z,
+    DRAW_DIR_PHI,
+    DRAW_SOURCE,      // Target or projectile (collisions)
+    DRAWS
+};
+
+inline double clamp(double v, double lo, double hi) {
+    return std::min(std::max(v, lo), hi);
+}
+
+/** Uniform in (0, 1) from a counter (splitmix64 finalizer) */
+inline double uniform(uint64_t key, uint64_t counter) {
+    uint64_t z = key + counter * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (static_cast<double>(z >> 11) + 0.5) * 0x1.0p-53;
+}
+
+inline uint64_t event_key(uint64_t seed, size_t event) {
+    return seed * 0xD1B54A32D192ED03ull ^ (static_cast<uint64_t>(event) + 1) * 0xA0761D6478BD642Full;
+}
+
+/** Per-event constants of the size, velocity and source distributions */
+struct EventModel {
+    double count;            // Expected fragments
+    double exponent;         // Size power-law exponent b
+    double a, c;             // min_size^-b, max_size^-b
+    double dv_slope, dv_offset;
+    double projectile_share; // Chance a fragment comes from the projectile
+};
+
+EventModel event_model(const BreakupEvent& e, const BreakupConfig& cfg) {
+    EventModel m{};
+    double coeff;
+    if (e.type == BreakupType::EXPLOSION) {
+        coeff = 6.0 * e.scale;
+        m.exponent = 1.6;
+        m.dv_slope = 0.2;
+        m.dv_offset = 1.85;
+    } else {
+        Vec3 dv(e.parent.velocity.x - e.projectile.velocity.x,
+                e.parent.velocity.y - e.projectile.velocity.y,
+                e.parent.velocity.z - e.projectile.velocity.z);
+        double v_rel = dv.norm();
+        double emr = 0.5 * e.projectile_mass * v_rel * v_rel / e.parent_mass;
+        double mass = emr > CATASTROPHIC_EMR
+            ? e.parent_mass + e.projectile_mass
+            : e.projectile_mass * (v_rel / 1000.0) * (v_rel / 1000.0);
+        coeff = 0.1 * std::pow(mass, 0.75);
+        m.exponent = 1.71;
+        m.dv_slope = 0.9;
+        m.dv_offset = 2.9;
+        m.projectile_share = e.projectile_mass / (e.parent_mass + e.projectile_mass);
+    }
+    m.a = std::pow(cfg.min_size, -m.exponent);
+    m.c = std::pow(cfg.max_size, -m.exponent);
+    m.count = cfg.max_size > cfg.min_size ? coeff * (m.a - m.c) : 0.0;
+    return m;
+}
+
+struct EventSlice {
+    size_t event;
+    size_t offset;           // First fragment in the output
+    size_t count;            // Fragments the event emits
+};
+
+/**
+ * Fragments [first, first + n) of one event into out at position `at`.
+ * Fragment k of the event keeps its draws whatever block it lands in.
+ */
+void sample_block(const BreakupEvent& e, const EventModel& m, uint64_t key,
+                  size_t first, size_t n, size_t event_count, bool cloud,
+                  double weight, int event_index, size_t at, FragmentBatch& out) {
+    const double inv_b = -1.0 / m.exponent;
+    const double stratum = cloud ? 1.0 / static_cast<double>(event_count) : 1.0;
+    const bool collision = e.type == BreakupType::COLLISION;
+
+    double* lc_out = out.size.data() + at;
+    double* am_out = out.area_to_mass.data() + at;
+    double* mass_out = out.mass.data() + at;
+    double* x = out.x.data() + at;
+    double* y = out.y.data() + at;
+    double* z = out.z.data() + at;
+    double* vx = out.vx.data() + at;
+    double* vy = out.vy.data() + at;
+    double* vz = out.vz.data() + at;
+    int* source = out.source_ids.data() + at;
+
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t k = first + i;
+        const uint64_t base = k * DRAWS;
+
+        // Size: inverse CDF of the truncated power law (stratified for clouds)
+        double u = uniform(key, base + DRAW_SIZE);
+        if (cloud) u = (static_cast<double>(k) + u) * stratum;
+        const double log_lc = inv_b * std::log(m.a - u * (m.a - m.c));
+        const double lc = std::exp(log_lc);
+        const double lam = log_lc * (1.0 / LN10);
+
+        // log10 A/M distribution for this size
+        const double alpha = clamp(0.3 + 0.4 * (lam + 1.2), 0.0, 1.0);
+        const double mu1 = -0.6 - 0.318 * clamp(lam + 1.1, 0.0, 1.1);
+        const double sigma1 = 0.1 + 0.2 * clamp(lam + 1.3, 0.0, 1.0);
+        const double mu2 = -1.2 - 1.333 * clamp(lam + 0.7, 0.0, 0.6);
+        const double sigma2 = 0.5 - clamp(lam + 0.5, 0.0, 0.2);
+        const double mu_small = -0.45 - 0.9 * clamp(lam + 1.75, 0.0, 0.5);
+        const double sigma_small = 0.55;
+
+        const double bridge = clamp((lc - 0.08) / 0.03, 0.0, 1.0);
+        const double pick = uniform(key, base + DRAW_MODE);
+        const bool large = pick < bridge;
+        const bool first_mode = pick < alpha * bridge;
+        const double mu = large ? (first_mode ? mu1 : mu2) : mu_small;
+        const double sigma = large ? (first_mode ? sigma1 : sigma2) : sigma_small;
+
+        const double r = std::sqrt(-2.0 * std::log(uniform(key, base + DRAW_NORMAL_R)));
+        const double t = 2.0 * M_PI * uniform(key, base + DRAW_NORMAL_T);
+        const double chi = mu + sigma * r * std::cos(t);
+        const double nu = m.dv_slope * chi + m.dv_offset + 0.4 * r * std::sin(t);
+
+        const double am = std::exp(chi * LN10);
+        const double area = lc < 0.00167 ? 0.540424 * lc * lc
+                                         : 0.556945 * std::exp(2.0047077 * log_lc);
+
+        // Spreading velocity, uniform direction
+        const double dv = std::exp(nu * LN10);
+        const double cz = 2.0 * uniform(key, base + DRAW_DIR_Z) - 1.0;
+        const double sz = std::sqrt(std::max(0.0, 1.0 - cz * cz));
+        const double phi = 2.0 * M_PI * uniform(key, base + DRAW_DIR_PHI);
+
+        const bool from_projectile =
+            collision && uniform(key, base + DRAW_SOURCE) < m.projectile_share;
+        const StateVector& s0 = from_projectile ? e.projectile : e.parent;
+
+        lc_out[i] = lc;
+        am_out[i] = am;
+        mass_out[i] = area / am;
+        x[i] = s0.position.x;
+        y[i] = s0.position.y;
+        z[i] = s0.position.z;
+        vx[i] = s0.velocity.x + dv * sz * std::cos(phi);
+        vy[i] = s0.velocity.y + dv * sz * std::sin(phi);
+        vz[i] = s0.velocity.z + dv * cz;
+        source[i] = from_projectile ? e.projectile_id : e.parent_id;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const size_t j = at + i;
+        out.ids[j] = static_cast<int>(j);
+        out.events[j] = event_index;
+        out.weight[j] = weight;
+        out.time[j] = e.time;
+        out.active[j] = 1;
+    }
+}
+
+} // namespace
+
+// ============================================================
+// FragmentBatch
+// ============================================================
+
+void FragmentBatch::resize(size_t n) {
+    ids.resize(n);
+    source_ids.resize(n);
+    events.resize(n);
+    for (auto* v : {&x, &y, &z, &vx, &vy, &vz, &size, &area_to_mass, &mass, &weight, &time}) {
+        v->resize(n);
+    }
+    active.resize(n);
+}
+
+std::vector<OrbitalDebris> FragmentBatch::to_debris() const {
+    std::vector<OrbitalDebris> debris;
+    debris.reserve(count());
+    for (size_t i = 0; i < count(); i++) {
+        StateVector s;
+        s.position = Vec3(x[i], y[i], z[i]);
+        s.velocity = Vec3(vx[i], vy[i], vz[i]);
+        OrbitalDebris d(ids[i], source_ids[i], s, mass[i], size[i]);
+        d.time = time[i];
+        d.active = active[i] != 0;
+        debris.push_back(d);
+    }
+    return debris;
+}
+
+// ============================================================
+// BreakupGenerator
+// ============================================================
+
+BreakupGenerator::BreakupGenerator(const BreakupConfig& config)
+    : config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+double BreakupGenerator::expected_fragments(const BreakupEvent& event) const {
+    return event_model(event, config_).count;
+}
+
+size_t BreakupGenerator::generate(const BreakupEvent& event, FragmentBatch& out) const {
+    return generate(std::vector<BreakupEvent>{event}, out);
+}
+
+size_t BreakupGenerator::generate(const std::vector<BreakupEvent>& events,
+                                  FragmentBatch& out) const {
+    const bool cloud = config_.cloud_samples > 0;
+    const size_t start = out.count();
+
+    // Fragment counts first, so the output is sized once
+    std::vector<EventModel> models(events.size());
+    std::vector<EventSlice> slices(events.size());
+    size_t total = start;
+    for (size_t e = 0; e < events.size(); e++) {
+        models[e] = event_model(events[e], config_);
+        size_t n;
+        if (cloud) {
+            n = models[e].count > 0.0 ? config_.cloud_samples : 0;
+        } else {
+            // Unbiased integer count from the expected value
+            double u = uniform(event_key(config_.seed, e), ~0ull);
+            n = static_cast<size_t>(std::floor(models[e].count + u));
+        }
+        slices[e] = {e, total, n};
+        total += n;
+    }
+    out.resize(total);
+
+    // Work items: runs of up to TASK fragments within one event
+    struct Task { size_t event, first, n; };
+    std::vector<Task> tasks;
+    for (const EventSlice& s : slices) {
+        for (size_t first = 0; first < s.count; first += TASK) {
+            tasks.push_back({s.event, first, std::min(TASK, s.count - first)});
+        }
+    }
+
+    auto run = [&](size_t t) {
+        const Task& task = tasks[t];
+        const EventSlice& s = slices[task.event];
+        const EventModel& m = models[task.event];
+        double weight = cloud ? m.count / static_cast<double>(s.count) : 1.0;
+        sample_block(events[task.event], m, event_key(config_.seed, task.event),
+                     task.first, task.n, s.count, cloud, weight,
+                     static_cast<int>(task.event), s.offset + task.first, out);
+    };
+
+    if (pool_ && tasks.size() > 1) {
+        pool_->parallel_for(tasks.size(), run);
+    } else {
+        for (size_t t = 0; t < tasks.size(); t++) run(t);
+    }
+
+    return total - start;
+}
+
+} // namespace sim
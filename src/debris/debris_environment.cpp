@@ -0,0 +1,536 @@
+#include "debris_environment.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+
+namespace {
+
+constexpr double MU = OrbitalDebris::MU;
+constexpr double RE = OrbitalDebris::RE;
+constexpr double DEG = M_PI / 180.0;
+constexpr double CATASTROPHIC_EMR = 40000.0;   // [J/kg], as BreakupGenerator
+constexpr double REFERENCE_SPEED = 10000.0;    // Template collision speed [m/s]
+constexpr double TRACKED_DECAY_STEP = 1000.0;  // Max altitude change per sub-step [m]
+constexpr int CROSSING_NODES = 64;             // Node-difference samples
+
+uint64_t mix(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::vector<double> checked_edges(const std::vector<double>& edges,
+                                  const std::vector<double>& fallback, const char* what) {
+    const std::vector<double>& e = edges.empty() ? fallback : edges;
+    if (e.size() < 2 || !std::is_sorted(e.begin(), e.end()) ||
+        std::adjacent_find(e.begin(), e.end()) != e.end()) {
+        throw std::invalid_argument(std::string("DebrisEnvironment: ") + what +
+                                    " edges must be at least two increasing values");
+    }
+    return e;
+}
+
+/// Combined cross-section of two objects of mean areas a and b
+double cross_section(double a, double b) {
+    double r = std::sqrt(a / M_PI) + std::sqrt(b / M_PI);
+    return M_PI * r * r;
+}
+
+/// Decay rate |da/dt| on a circular orbit [m/s]
+double decay_rate(double rho, double altitude, double area_to_mass, double cd) {
+    return rho * std::sqrt(MU * (RE + altitude)) * cd * area_to_mass;
+}
+
+} // namespace
+
+DebrisEnvironment::DebrisEnvironment(const DebrisEnvironmentConfig& config)
+    : config_(config), rng_(config.seed) {
+    std::vector<double> alt, inc;
+    for (double h = 200e3; h <= 2000e3 + 1.0; h += 50e3) alt.push_back(h);
+    for (double d : {0.0, 30.0, 45.0, 60.0, 75.0, 90.0, 105.0, 180.0}) inc.push_back(d * DEG);
+    altitude_edges_ = checked_edges(config_.altitude_edges, alt, "altitude");
+    inclination_edges_ = checked_edges(config_.inclination_edges, inc, "inclination");
+    size_edges_ = checked_edges(config_.size_edges, {0.1, 0.3, 1.0, 3.0, 10.0}, "size");
+
+    bins_.resize(shells() * inclinations() * sizes());
+    fragments_.assign(shells() * inclinations(), 0.0);
+
+    const AtmosphereTable& atmosphere = AtmosphereTable::earth();
+    for (size_t s = 0; s < shells(); s++) {
+        double lo = RE + altitude_edges_[s], hi = RE + altitude_edges_[s + 1];
+        double mid = 0.5 * (altitude_edges_[s] + altitude_edges_[s + 1]);
+        shell_density_.push_back(atmosphere.density(mid));
+        shell_volume_.push_back(4.0 / 3.0 * M_PI * (hi * hi * hi - lo * lo * lo));
+        shell_speed_.push_back(std::sqrt(MU / (RE + mid)));
+    }
+
+    // Mean crossing speed / circular speed: 2 sin(theta / 2) over node differences
+    const size_t ni = inclinations();
+    crossing_.resize(ni * ni);
+    for (size_t p = 0; p < ni; p++) {
+        for (size_t q = 0; q < ni; q++) {
+            double ip = 0.5 * (inclination_edges_[p] + inclination_edges_[p + 1]);
+            double iq = 0.5 * (inclination_edges_[q] + inclination_edges_[q + 1]);
+            double sum = 0.0;
+            for (int k = 0; k < CROSSING_NODES; k++) {
+                double dnode = 2.0 * M_PI * (k + 0.5) / CROSSING_NODES;
+                double c = std::cos(ip) * std::cos(iq) + std::sin(ip) * std::sin(iq) * std::cos(dnode);
+                sum += std::sqrt(std::max(2.0 * (1.0 - c), 0.0));
+            }
+            crossing_[p * ni + q] = sum / CROSSING_NODES;
+        }
+    }
+
+    BreakupConfig bc;
+    bc.min_size = size_edges_.front();
+    bc.max_size = size_edges_.back();
+    bc.cloud_samples = std::max<size_t>(config_.template_samples, 1);
+    bc.seed = config_.seed;
+    bc.num_threads = 1;
+    generator_ = BreakupGenerator(bc);
+
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+
+    // Fragment templates: one reference catastrophic collision per (shell, inclination)
+    templates_.resize(shells() * ni);
+    auto build = [&](size_t t) {
+        size_t shell = t / ni, band = t % ni;
+        double inc = 0.5 * (inclination_edges_[band] + inclination_edges_[band + 1]);
+        BreakupEvent event = collision_event(shell, inc, 1000.0, 10.0, REFERENCE_SPEED);
+        BreakupConfig tc = bc;
+        tc.seed = mix(config_.seed ^ (t + 1));
+        BreakupGenerator gen(tc);
+        double expected = gen.expected_fragments(event);
+        if (expected <= 0.0) return;
+
+        FragmentBatch batch;
+        gen.generate(event, batch);
+        Binned binned;
+        bin_batch(batch, 1.0 / expected, binned);
+        Template& tpl = templates_[t];
+        for (size_t b = 0; b < binned.add.size(); b++) {
+            const DebrisBin& a = binned.add[b];
+            if (a.count <= 0.0) continue;
+            tpl.bin.push_back(b);
+            tpl.fraction.push_back(a.count);
+            tpl.mass_each.push_back(a.mass / a.count);
+            tpl.area_each.push_back(a.area / a.count);
+        }
+        tpl.reentered = binned.reentered;
+        tpl.lost = binned.lost;
+    };
+    if (pool_) {
+        pool_->parallel_for(templates_.size(), build);
+    } else {
+        for (size_t t = 0; t < templates_.size(); t++) build(t);
+    }
+}
+
+DebrisEnvironment::~DebrisEnvironment() = default;
+
+int DebrisEnvironment::shell_of(double altitude) const {
+    if (altitude < altitude_edges_.front() || altitude >= altitude_edges_.back()) return -1;
+    auto it = std::upper_bound(altitude_edges_.begin(), altitude_edges_.end(), altitude);
+    return static_cast<int>(it - altitude_edges_.begin()) - 1;
+}
+
+int DebrisEnvironment::inclination_of(double inclination) const {
+    if (inclination < inclination_edges_.front() || inclination > inclination_edges_.back()) return -1;
+    auto it = std::upper_bound(inclination_edges_.begin(), inclination_edges_.end(), inclination);
+    return std::min(static_cast<int>(it - inclination_edges_.begin()) - 1,
+                    static_cast<int>(inclinations()) - 1);
+}
+
+size_t DebrisEnvironment::size_of(double size) const {
+    auto it = std::upper_bound(size_edges_.begin(), size_edges_.end(), size);
+    size_t s = static_cast<size_t>(std::max<ptrdiff_t>(it - size_edges_.begin() - 1, 0));
+    return std::min(s, sizes() - 1);
+}
+
+double DebrisEnvironment::shell_count(size_t shell) const {
+    double n = 0.0;
+    size_t first = bin(shell, 0, 0);
+    for (size_t b = first; b < first + inclinations() * sizes(); b++) n += bins_[b].count;
+    return n;
+}
+
+double DebrisEnvironment::relative_speed(size_t shell, size_t inc_a, size_t inc_b) const {
+    return std::max(shell_speed_[shell] * crossing_[inc_a * inclinations() + inc_b],
+                    config_.min_relative_speed);
+}
+
+BreakupEvent DebrisEnvironment::collision_event(size_t shell, double inclination,
+                                                double parent_mass, double projectile_mass,
+                                                double speed) const {
+    // Both on circular orbits at the shell centre, crossing at the ascending node
+    double h = 0.5 * (altitude_edges_[shell] + altitude_edges_[shell + 1]);
+    double vc = shell_speed_[shell];
+    double theta = 2.0 * std::asin(std::min(speed / (2.0 * vc), 1.0));
+
+    BreakupEvent e;
+    e.type = BreakupType::COLLISION;
+    e.parent.position = Vec3(RE + h, 0.0, 0.0);
+    e.parent.velocity = Vec3(0.0, vc * std::cos(inclination), vc * std::sin(inclination));
+    e.parent_mass = parent_mass;
+    e.projectile.position = e.parent.position;
+    e.projectile.velocity = Vec3(0.0, vc * std::cos(inclination + theta),
+                                 vc * std::sin(inclination + theta));
+    e.projectile_mass = projectile_mass;
+    e.time = stats_.time;
+    return e;
+}
+
+bool DebrisEnvironment::add(double altitude, double inclination, double size, double count,
+                            double mass_each, double area_each) {
+    int shell = shell_of(altitude);
+    int band = inclination_of(inclination);
+    if (shell < 0 || band < 0 || size < size_edges_.front() || count <= 0.0) return false;
+    DebrisBin& b = bins_[bin(shell, band, size_of(size))];
+    b.count += count;
+    b.mass += count * mass_each;
+    b.area += count * area_each;
+    refresh_stats();
+    return true;
+}
+
+void DebrisEnvironment::bin_batch(const FragmentBatch& batch, double scale, Binned& out) const {
+    out.add.assign(bins_.size(), DebrisBin());
+    for (size_t k = 0; k < batch.count(); k++) {
+        if (!batch.active[k] || batch.size[k] < size_edges_.front()) continue;
+        double w = batch.weight[k] * scale;
+        Vec3 r(batch.x[k], batch.y[k], batch.z[k]);
+        Vec3 v(batch.vx[k], batch.vy[k], batch.vz[k]);
+        double rn = r.norm(), v2 = v.x * v.x + v.y * v.y + v.z * v.z;
+        double inv_a = 2.0 / rn - v2 / MU;
+        if (inv_a <= 0.0) {
+            out.lost += w;
+            continue;
+        }
+        double a = 1.0 / inv_a;
+        Vec3 h(r.y * v.z - r.z * v.y, r.z * v.x - r.x * v.z, r.x * v.y - r.y * v.x);
+        double hn = h.norm();
+        double e = std::sqrt(std::max(1.0 - hn * hn / (MU * a), 0.0));
+        if (a * (1.0 - e) - RE < altitude_edges_.front()) {
+            out.reentered += w;
+            continue;
+        }
+        int shell = shell_of(a - RE);
+        int band = inclination_of(std::acos(std::clamp(h.z / hn, -1.0, 1.0)));
+        if (shell < 0 || band < 0) {
+            out.lost += w;
+            continue;
+        }
+        DebrisBin& b = out.add[bin(shell, band, size_of(batch.size[k]))];
+        b.count += w;
+        b.mass += w * batch.mass[k];
+        b.area += w * batch.mass[k] * batch.area_to_mass[k];
+        out.count += w;
+    }
+}
+
+void DebrisEnvironment::apply(const Binned& binned) {
+    for (size_t b = 0; b < bins_.size(); b++) {
+        bins_[b].count += binned.add[b].count;
+        bins_[b].mass += binned.add[b].mass;
+        bins_[b].area += binned.add[b].area;
+    }
+    stats_.fragments += binned.count;
+    stats_.reentered += binned.reentered;
+    stats_.lost += binned.lost;
+}
+
+void DebrisEnvironment::add(const FragmentBatch& batch) {
+    Binned binned;
+    bin_batch(batch, 1.0, binned);
+    apply(binned);
+    refresh_stats();
+}
+
+void DebrisEnvironment::add_breakup(const BreakupEvent& event) {
+    BreakupConfig bc = generator_.config();
+    bc.seed = mix(config_.seed ^ (0x5EEDull << 32) ^ ++breakups_);
+    FragmentBatch batch;
+    BreakupGenerator(bc).generate(event, batch);
+    Binned binned;
+    bin_batch(batch, 1.0, binned);
+    apply(binned);
+    refresh_stats();
+}
+
+size_t DebrisEnvironment::track(const TrackedDebris& object) {
+    tracked_.push_back(object);
+    refresh_stats();
+    return tracked_.size() - 1;
+}
+
+void DebrisEnvironment::drag(double dt) {
+    const size_t columns = inclinations() * sizes();
+    const size_t ns = shells();
+    std::vector<double> reentered(columns, 0.0);
+
+    auto column = [&](size_t c) {
+        auto at = [&](size_t s) -> DebrisBin& { return bins_[s * columns + c]; };
+        auto fraction = [&](size_t s) {
+            const DebrisBin& b = at(s);
+            if (b.count <= 0.0 || b.mass <= 0.0) return 0.0;
+            double mid = 0.5 * (altitude_edges_[s] + altitude_edges_[s + 1]);
+            double width = altitude_edges_[s + 1] - altitude_edges_[s];
+            return decay_rate(shell_density_[s], mid, b.area / b.mass, config_.drag_coeff) * dt / width;
+        };
+        double worst = 0.0;
+        for (size_t s = 0; s < ns; s++) worst = std::max(worst, fraction(s));
+        int sub = std::max(1, static_cast<int>(std::ceil(worst)));
+
+        for (int k = 0; k < sub; k++) {
+            // Upwind, bottom up: a shell loses its outflow before gaining its inflow
+            for (size_t s = 0; s < ns; s++) {
+                double f = std::min(fraction(s) / sub, 1.0);
+                if (f <= 0.0) continue;
+                DebrisBin& b = at(s);
+                DebrisBin out{b.count * f, b.mass * f, b.area * f};
+                b.count -= out.count;
+                b.mass -= out.mass;
+                b.area -= out.area;
+                if (s == 0) {
+                    reentered[c] += out.count;
+                } else {
+                    DebrisBin& below = at(s - 1);
+                    below.count += out.count;
+                    below.mass += out.mass;
+                    below.area += out.area;
+                }
+            }
+        }
+    };
+    if (pool_) {
+        pool_->parallel_for(columns, column);
+    } else {
+        for (size_t c = 0; c < columns; c++) column(c);
+    }
+    for (double r : reentered) stats_.reentered += r;
+}
+
+void DebrisEnvironment::collide_shell(size_t shell, double dt) {
+    const size_t ni = inclinations(), nz = sizes(), nb = ni * nz;
+    const size_t first = bin(shell, 0, 0);
+    const double volume = shell_volume_[shell];
+
+    std::mt19937_64 rng(mix(config_.seed ^ mix(steps_ * shells() + shell)));
+    std::vector<double> removed(nb, 0.0);
+    double collisions = 0.0;
+
+    // Rates from the start-of-step contents; removals applied afterwards
+    for (size_t p = 0; p < nb; p++) {
+        const DebrisBin& bp = bins_[first + p];
+        if (bp.count < 1e-12 || bp.mass <= 0.0) continue;
+        for (size_t q = p; q < nb; q++) {
+            const DebrisBin& bq = bins_[first + q];
+            if (bq.count < 1e-12 || bq.mass <= 0.0) continue;
+            size_t ip = p / nz, iq = q / nz;
+            double v = relative_speed(shell, ip, iq);
+            double sigma = cross_section(bp.area / bp.count, bq.area / bq.count);
+            double rate = bp.count * bq.count * sigma * v / volume * (p == q ? 0.5 : 1.0);
+            double events = rate * dt;
+            if (config_.stochastic) {
+                events = events > 0.0
+                    ? static_cast<double>(std::poisson_distribution<long long>(events)(rng))
+                    : 0.0;
+            }
+            if (events <= 0.0) continue;
+
+            double mp = bp.mass / bp.count, mq = bq.mass / bq.count;
+            bool p_large = mp >= mq;
+            double ml = p_large ? mp : mq, ms = p_large ? mq : mp;
+            size_t large = p_large ? p : q, small = p_large ? q : p;
+            bool catastrophic = 0.5 * ms * v * v / ml > CATASTROPHIC_EMR;
+            removed[small] += events;
+            if (catastrophic) removed[large] += events;
+
+            double inc = 0.5 * (inclination_edges_[large / nz] + inclination_edges_[large / nz + 1]);
+            double per_event = generator_.expected_fragments(collision_event(shell, inc, ml, ms, v));
+            fragments_[shell * ni + large / nz] += events * per_event;
+            collisions += events;
+        }
+    }
+
+    for (size_t p = 0; p < nb; p++) {
+        DebrisBin& b = bins_[first + p];
+        if (removed[p] <= 0.0 || b.count <= 0.0) continue;
+        double keep = std::max(1.0 - removed[p] / b.count, 0.0);
+        b.count *= keep;
+        b.mass *= keep;
+        b.area *= keep;
+    }
+    shell_collisions_[shell] = collisions;
+}
+
+void DebrisEnvironment::step_tracked(double dt) {
+    const AtmosphereTable& atmosphere = AtmosphereTable::earth();
+    const size_t nz = sizes();
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    // Decay, sub-stepped so each step moves at most TRACKED_DECAY_STEP
+    for (TrackedDebris& t : tracked_) {
+        if (!t.active || t.mass <= 0.0) continue;
+        double rate = decay_rate(atmosphere.density(t.altitude), t.altitude, t.area / t.mass,
+                                 config_.drag_coeff);
+        int sub = std::clamp(static_cast<int>(std::ceil(rate * dt / TRACKED_DECAY_STEP)), 1, 10000);
+        for (int k = 0; k < sub && t.altitude >= altitude_edges_.front(); k++) {
+            t.altitude -= decay_rate(atmosphere.density(t.altitude), t.altitude,
+                                     t.area / t.mass, config_.drag_coeff) * dt / sub;
+        }
+        if (t.altitude < altitude_edges_.front()) {
+            t.active = false;
+            stats_.reentered += 1.0;
+        }
+    }
+
+    // Collisions against the bins of the object's shell and later tracked objects
+    std::vector<double> rates;
+    for (size_t i = 0; i < tracked_.size(); i++) {
+        TrackedDebris& t = tracked_[i];
+        int shell = shell_of(t.altitude);
+        int band = inclination_of(t.inclination);
+        if (!t.active || shell < 0 || band < 0) continue;
+        const size_t first = bin(shell, 0, 0), nb = inclinations() * nz;
+        const double volume = shell_volume_[shell];
+
+        rates.assign(nb + tracked_.size(), 0.0);
+        double total = 0.0;
+        for (size_t p = 0; p < nb; p++) {
+            const DebrisBin& b = bins_[first + p];
+            if (b.count < 1e-12) continue;
+            double v = relative_speed(shell, band, p / nz);
+            rates[p] = b.count * cross_section(t.area, b.area / b.count) * v / volume;
+            total += rates[p];
+        }
+        for (size_t j = i + 1; j < tracked_.size(); j++) {
+            const TrackedDebris& o = tracked_[j];
+            int ob = inclination_of(o.inclination);
+            if (!o.active || ob < 0 || shell_of(o.altitude) != shell) continue;
+            double v = relative_speed(shell, band, ob);
+            rates[nb + j] = cross_section(t.area, o.area) * v / volume;
+            total += rates[nb + j];
+        }
+        if (total <= 0.0 || uniform(rng_) >= 1.0 - std::exp(-total * dt)) continue;
+
+        // Partner in proportion to its rate
+        double pick = uniform(rng_) * total, cumulative = 0.0;
+        size_t partner = 0;
+        for (size_t k = 0; k < rates.size(); k++) {
+            if (rates[k] <= 0.0) continue;
+            partner = k;
+            cumulative += rates[k];
+            if (pick < cumulative) break;
+        }
+
+        double partner_mass, partner_inc, v;
+        if (partner < nb) {
+            const DebrisBin& b = bins_[first + partner];
+            partner_mass = b.mass / b.count;
+            partner_inc = 0.5 * (inclination_edges_[partner / nz] + inclination_edges_[partner / nz + 1]);
+            v = relative_speed(shell, band, partner / nz);
+        } else {
+            const TrackedDebris& o = tracked_[partner - nb];
+            partner_mass = o.mass;
+            partner_inc = o.inclination;
+            v = relative_speed(shell, band, inclination_of(o.inclination));
+        }
+        bool tracked_large = t.mass >= partner_mass;
+        double ml = tracked_large ? t.mass : partner_mass;
+        double ms = tracked_large ? partner_mass : t.mass;
+        bool catastrophic = 0.5 * ms * v * v / ml > CATASTROPHIC_EMR;
+
+        BreakupEvent event = collision_event(shell, tracked_large ? t.inclination : partner_inc,
+                                             ml, ms, v);
+        event.parent_id = tracked_large ? t.id : -1;
+        event.projectile_id = tracked_large ? -1 : t.id;
+        if (catastrophic || !tracked_large) t.active = false;
+        if (catastrophic || tracked_large) {
+            if (partner < nb) {
+                DebrisBin& b = bins_[first + partner];
+                double keep = std::max(1.0 - 1.0 / b.count, 0.0);
+                b.count *= keep;
+                b.mass *= keep;
+                b.area *= keep;
+            } else {
+                tracked_[partner - nb].active = false;
+            }
+        }
+        stats_.collisions += 1.0;
+        add_breakup(event);
+    }
+}
+
+void DebrisEnvironment::step(double dt) {
+    if (dt <= 0.0) return;
+    drag(dt);
+
+    shell_collisions_.assign(shells(), 0.0);
+    auto shell = [&](size_t s) { collide_shell(s, dt); };
+    if (pool_) {
+        pool_->parallel_for(shells(), shell);
+    } else {
+        for (size_t s = 0; s < shells(); s++) shell(s);
+    }
+    for (double c : shell_collisions_) stats_.collisions += c;
+
+    // Collision fragments, by their source's template
+    for (size_t t = 0; t < templates_.size(); t++) {
+        double n = fragments_[t];
+        fragments_[t] = 0.0;
+        if (n <= 0.0) continue;
+        const Template& tpl = templates_[t];
+        for (size_t k = 0; k < tpl.bin.size(); k++) {
+            double count = n * tpl.fraction[k];
+            DebrisBin& b = bins_[tpl.bin[k]];
+            b.count += count;
+            b.mass += count * tpl.mass_each[k];
+            b.area += count * tpl.area_each[k];
+            stats_.fragments += count;
+        }
+        stats_.reentered += n * tpl.reentered;
+        stats_.lost += n * tpl.lost;
+    }
+
+    step_tracked(dt);
+    steps_++;
+    stats_.time += dt;
+    refresh_stats();
+}
+
+void DebrisEnvironment::evolve(double duration, double dt, const StepCallback& on_step) {
+    if (dt <= 0.0) throw std::invalid_argument("DebrisEnvironment: step must be positive");
+    double t = 0.0;
+    while (t < duration * (1.0 - 1e-12)) {
+        double h = std::min(dt, duration - t);
+        step(h);
+        t += h;
+        if (on_step) on_step(stats_);
+    }
+}
+
+void DebrisEnvironment::refresh_stats() {
+    stats_.objects = 0.0;
+    stats_.mass = 0.0;
+    stats_.tracked = 0;
+    for (const DebrisBin& b : bins_) {
+        stats_.objects += b.count;
+        stats_.mass += b.mass;
+    }
+    for (const TrackedDebris& t : tracked_) {
+        if (!t.active) continue;
+        stats_.tracked++;
+        stats_.mass += t.mass;
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,208 @@
+#ifndef DEBRIS_ENVIRONMENT_HPP
+#define DEBRIS_ENVIRONMENT_HPP
+
+#include "debris/breakup_generator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+/**
+ * Statistical Debris Environment
+ *
+ * Long-term (decades) evolution of the orbital population, for Kessler
+ * cascade studies where DebrisFieldEngine's per-fragment propagation would
+ * be too slow. Objects are not tracked one by one. Each bin, an altitude
+ * shell x inclination band x size (Lc) band, holds a fractional object
+ * count with its total mass and cross-section area. Every step costs
+ * O(bins) for drag and O(pairs of bins per shell) for collisions, however
+ * many objects the bins represent.
+ *
+ * Per step:
+ *   1. Drag: each bin's objects decay at the circular-orbit rate
+ *      da/dt = -rho(h) sqrt(mu a) Cd A/m, with A/m the bin's mean and rho
+ *      from AtmosphereTable::earth() at the shell centre. A fraction
+ *      (rate dt / shell width) of the count, mass and area moves one
+ *      shell down (first-order upwind, sub-stepped where that fraction
+ *      would exceed 1). Outflow from the lowest shell has reentered.
+ *   2. Collisions: within a shell, bins p and q collide at
+ *        n_p n_q sigma_pq v_pq / V   (halved for p = q)
+ *      where V is the shell volume, sigma the combined cross-section
+ *      from the bins' mean areas, and v_pq the circular speed times the
+ *      mean crossing factor of the two inclinations over random node
+ *      differences (floored at min_relative_speed). The expected events
+ *      are applied directly, or Poisson-drawn with `stochastic`.
+ *      Catastrophic events (40 J/g) remove both objects, others only the
+ *      smaller one.
+ *   3. Fragments: each collision yields BreakupGenerator::
+ *      expected_fragments() for its masses and speed. They are spread
+ *      over the bins by the template of the larger object's shell and
+ *      inclination band: the binned fragments of one reference
+ *      catastrophic collision there (BreakupGenerator cloud,
+ *      template_samples representative fragments).
+ *
+ * Optional hybrid tracking: large objects (intact satellites, rocket
+ * bodies) can be tracked individually with track(). They decay by the same
+ * law and collide with the binned population and each other at the same
+ * rates. Their collisions are always drawn (one seeded generator, serial),
+ * and a hit breaks them up through BreakupGenerator::generate() with the
+ * actual masses, fragments binned from their orbits.
+ *
+ * Fragments and batches are binned by semi-major axis altitude;
+ * perigees below the lowest shell count as reentered. Fragments above the
+ * top shell or on open orbits count as lost. Fragments smaller than the
+ * first size edge are not modelled, and larger than the last land in the
+ * top size band.
+ *
+ * Drag runs per (inclination, size) column and collisions per shell on
+ * a thread pool. Stochastic draws are keyed on (seed, step, shell), so
+ * results do not depend on the thread count.
+ */
+
+struct DebrisEnvironmentConfig {
+    // Bin edges, each increasing
+    std::vector<double> altitude_edges;      // [m]; empty = 200-2000 km every 50 km
+    std::vector<double> inclination_edges;   // [rad]; empty = 0,30,45,60,75,90,105,180 deg
+    std::vector<double> size_edges;          // Lc [m]; empty = 0.1, 0.3, 1, 3, 10
+
+    double drag_coeff = 2.2;
+    double min_relative_speed = 500.0;       // [m/s] collision speed floor
+    bool stochastic = false;                 // Poisson collision counts
+    size_t template_samples = 2000;          // Cloud fragments per breakup
+    uint64_t seed = 1;
+    int num_threads = 0;                     // 0 = hardware concurrency, 1 = serial
+};
+
+/// Contents of one bin (totals over its objects)
+struct DebrisBin {
+    double count = 0.0;
+    double mass = 0.0;                       // [kg]
+    double area = 0.0;                       // Cross-section [m^2]
+};
+
+/// An individually tracked object (hybrid mode)
+struct TrackedDebris {
+    int id = 0;
+    double altitude = 0.0;                   // [m] circular
+    double inclination = 0.0;                // [rad]
+    double size = 1.0;                       // Lc [m]
+    double mass = 1000.0;                    // [kg]
+    double area = 1.0;                       // [m^2]
+    bool active = true;                      // False once reentered or broken up
+};
+
+struct DebrisEnvironmentStats {
+    double time = 0.0;                       // [s] since construction
+    double objects = 0.0;                    // Binned count
+    double mass = 0.0;                       // Binned and tracked [kg]
+    size_t tracked = 0;                      // Active tracked objects
+    double reentered = 0.0;                  // Cumulative counts
+    double lost = 0.0;
+    double collisions = 0.0;
+    double fragments = 0.0;                  // Binned fragments created
+};
+
+class DebrisEnvironment {
+public:
+    using StepCallback = std::function<void(const DebrisEnvironmentStats&)>;
+
+    /** @throws std::invalid_argument on empty or non-increasing edges */
+    explicit DebrisEnvironment(const DebrisEnvironmentConfig& config = DebrisEnvironmentConfig());
+    ~DebrisEnvironment();
+
+    size_t shells() const { return altitude_edges_.size() - 1; }
+    size_t inclinations() const { return inclination_edges_.size() - 1; }
+    size_t sizes() const { return size_edges_.size() - 1; }
+    size_t bins() const { return bins_.size(); }
+    size_t bin(size_t shell, size_t inclination, size_t size) const {
+        return (shell * inclinations() + inclination) * sizes() + size;
+    }
+    const DebrisBin& operator[](size_t bin) const { return bins_[bin]; }
+    const DebrisEnvironmentConfig& config() const { return config_; }
+
+    /** Objects in one shell, over every inclination and size */
+    double shell_count(size_t shell) const;
+
+    /**
+     * Add `count` objects at a circular altitude, inclination and size
+     * @return false if that falls outside the bins (nothing added)
+     */
+    bool add(double altitude, double inclination, double size, double count,
+             double mass_each, double area_each);
+
+    /** Bin a fragment batch's active fragments (weighted) by their orbits */
+    void add(const FragmentBatch& batch);
+
+    /** Generate an event's fragments (BreakupGenerator cloud) and bin them */
+    void add_breakup(const BreakupEvent& event);
+
+    /** Track an object individually; @return its index in tracked() */
+    size_t track(const TrackedDebris& object);
+    const std::vector<TrackedDebris>& tracked() const { return tracked_; }
+
+    /** Advance the environment by dt [s] */
+    void step(double dt);
+
+    /** Steps of dt (the last one shortened) to duration; on_step after each */
+    void evolve(double duration, double dt, const StepCallback& on_step = nullptr);
+
+    const DebrisEnvironmentStats& stats() const { return stats_; }
+
+private:
+    /// Binned fragments of a reference catastrophic collision, per expected fragment
+    struct Template {
+        std::vector<size_t> bin;
+        std::vector<double> fraction;        // Share of the expected fragments
+        std::vector<double> mass_each;       // [kg]
+        std::vector<double> area_each;       // [m^2]
+        double reentered = 0.0;              // Shares that leave at once
+        double lost = 0.0;
+    };
+
+    /// Binned totals of a fragment set
+    struct Binned {
+        std::vector<DebrisBin> add;          // Per bin
+        double reentered = 0.0, lost = 0.0, count = 0.0;
+    };
+
+    DebrisEnvironmentConfig config_;
+    std::vector<double> altitude_edges_, inclination_edges_, size_edges_;
+    std::vector<DebrisBin> bins_;
+    std::vector<Template> templates_;        // [shell][inclination]
+    std::vector<double> shell_density_;      // [kg/m^3] at shell centres
+    std::vector<double> shell_volume_;       // [m^3]
+    std::vector<double> shell_speed_;        // Circular [m/s]
+    std::vector<double> crossing_;           // [inclination][inclination] speed factor
+    std::vector<double> fragments_;          // Per template, pending this step
+    std::vector<double> shell_collisions_;   // Per shell, this step
+    std::vector<TrackedDebris> tracked_;
+    BreakupGenerator generator_;
+    std::mt19937_64 rng_;                    // Tracked-object draws
+    uint64_t steps_ = 0;
+    uint64_t breakups_ = 0;                  // add_breakup() calls, for their streams
+    DebrisEnvironmentStats stats_;
+    std::shared_ptr<ThreadPool> pool_;       // Null when serial
+
+    int shell_of(double altitude) const;
+    int inclination_of(double inclination) const;
+    size_t size_of(double size) const;
+    void bin_batch(const FragmentBatch& batch, double scale, Binned& out) const;
+    void apply(const Binned& binned);
+    BreakupEvent collision_event(size_t shell, double inclination, double parent_mass,
+                                 double projectile_mass, double speed) const;
+    double relative_speed(size_t shell, size_t inc_a, size_t inc_b) const;
+    void drag(double dt);
+    void collide_shell(size_t shell, double dt);
+    void step_tracked(double dt);
+    void refresh_stats();
+};
+
+} // namespace sim
+
+#endif // DEBRIS_ENVIRONMENT_HPP
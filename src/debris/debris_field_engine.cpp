@@ -0,0 +1,374 @@
+#include "debris_field_engine.hpp"
+#include "breakup_generator.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t BLOCK = 64;
+constexpr double EARTH_ROTATION = 7.2921159e-5;   // [rad/s]
+
+struct Kernel {
+    double j2c;          // 1.5 J2 mu Re^2 (0 without J2)
+    bool drag;
+    double ceiling;      // Drag is skipped for blocks entirely above this
+    double reentry_radius;
+};
+
+/**
+ * a(p, v) for n lanes: two-body + J2 as in OrbitalDebris::propagate, plus
+ * drag against the co-rotating atmosphere when the kernel has it
+ */
+inline void accel_block(const Kernel& g, size_t n,
+                        const double* x, const double* y, const double* z,
+                        const double* vx, const double* vy, const double* vz,
+                        const double* ballistic,
+                        double* ax, double* ay, double* az) {
+    double alt[BLOCK];
+    double min_alt = std::numeric_limits<double>::infinity();
+
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        const double r2 = x[k] * x[k] + y[k] * y[k] + z[k] * z[k];
+        const double r = std::sqrt(r2);
+        const double r3 = r2 * r;
+        const double r5 = r2 * r3;
+
+        const double c0 = -OrbitalDebris::MU / r3;
+        const double c2 = g.j2c / r5;
+        const double zf = 5.0 * z[k] * z[k] / r2;
+
+        ax[k] = c0 * x[k] + c2 * x[k] * (zf - 1.0);
+        ay[k] = c0 * y[k] + c2 * y[k] * (zf - 1.0);
+        az[k] = c0 * z[k] + c2 * z[k] * (zf - 3.0);
+
+        alt[k] = r - OrbitalDebris::RE;
+        min_alt = std::min(min_alt, alt[k]);
+    }
+
+    if (!g.drag || min_alt > g.ceiling) return;
+
+    double rho[BLOCK];
+    AtmosphereTable::earth().density(alt, rho, n);
+
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        const double ux = vx[k] + EARTH_ROTATION * y[k];
+        const double uy = vy[k] - EARTH_ROTATION * x[k];
+        const double uz = vz[k];
+        const double speed = std::sqrt(ux * ux + uy * uy + uz * uz);
+        const double c = -0.5 * rho[k] * speed * ballistic[k];
+        ax[k] += c * ux;
+        ay[k] += c * uy;
+        az[k] += c * uz;
+    }
+}
+
+} // namespace
+
+// ============================================================
+// DebrisSamples
+// ============================================================
+
+bool DebrisSamples::active(size_t sample, size_t column) const {
+    return !std::isnan(x[index(sample, column)]);
+}
+
+Vec3 DebrisSamples::position(size_t sample, size_t column) const {
+    size_t k = index(sample, column);
+    return Vec3(x[k], y[k], z[k]);
+}
+
+Vec3 DebrisSamples::velocity(size_t sample, size_t column) const {
+    size_t k = index(sample, column);
+    return Vec3(vx[k], vy[k], vz[k]);
+}
+
+// ============================================================
+// DebrisFieldEngine
+// ============================================================
+
+DebrisFieldEngine::DebrisFieldEngine(const DebrisEngineConfig& config)
+    : config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+void DebrisFieldEngine::resize(size_t n) {
+    for (auto* v : {&x_, &y_, &z_, &vx_, &vy_, &vz_, &ballistic_, &time_}) v->resize(n);
+    alive_.resize(n);
+    column_.resize(n);
+    ids_.resize(n);
+}
+
+void DebrisFieldEngine::load(const std::vector<OrbitalDebris>& debris) {
+    const size_t n = debris.size();
+    resize(n);
+
+    for (size_t i = 0; i < n; i++) {
+        const OrbitalDebris& d = debris[i];
+        x_[i] = d.state.position.x;
+        y_[i] = d.state.position.y;
+        z_[i] = d.state.position.z;
+        vx_[i] = d.state.velocity.x;
+        vy_[i] = d.state.velocity.y;
+        vz_[i] = d.state.velocity.z;
+        double area = 0.25 * M_PI * d.size * d.size;
+        ballistic_[i] = d.mass > 0.0 ? config_.drag_coeff * area / d.mass : 0.0;
+        time_[i] = d.time;
+        alive_[i] = d.active ? 1 : 0;
+        column_[i] = i;
+        ids_[i] = d.id;
+    }
+    active_ = n;
+    compact();
+}
+
+void DebrisFieldEngine::load(const FragmentBatch& batch) {
+    const size_t n = batch.count();
+    resize(n);
+
+    std::copy(batch.x.begin(), batch.x.end(), x_.begin());
+    std::copy(batch.y.begin(), batch.y.end(), y_.begin());
+    std::copy(batch.z.begin(), batch.z.end(), z_.begin());
+    std::copy(batch.vx.begin(), batch.vx.end(), vx_.begin());
+    std::copy(batch.vy.begin(), batch.vy.end(), vy_.begin());
+    std::copy(batch.vz.begin(), batch.vz.end(), vz_.begin());
+    std::copy(batch.time.begin(), batch.time.end(), time_.begin());
+    std::copy(batch.active.begin(), batch.active.end(), alive_.begin());
+    std::copy(batch.ids.begin(), batch.ids.end(), ids_.begin());
+    for (size_t i = 0; i < n; i++) {
+        ballistic_[i] = config_.drag_coeff * batch.area_to_mass[i];
+        column_[i] = i;
+    }
+    active_ = n;
+    compact();
+}
+
+void DebrisFieldEngine::store(FragmentBatch& batch) const {
+    for (size_t i = 0; i < size(); i++) {
+        size_t j = column_[i];
+        batch.x[j] = x_[i];
+        batch.y[j] = y_[i];
+        batch.z[j] = z_[i];
+        batch.vx[j] = vx_[i];
+        batch.vy[j] = vy_[i];
+        batch.vz[j] = vz_[i];
+        batch.time[j] = time_[i];
+        batch.active[j] = alive_[i];
+    }
+}
+
+void DebrisFieldEngine::store(std::vector<OrbitalDebris>& debris) const {
+    for (size_t i = 0; i < size(); i++) {
+        OrbitalDebris& d = debris[column_[i]];
+        d.state.position = Vec3(x_[i], y_[i], z_[i]);
+        d.state.velocity = Vec3(vx_[i], vy_[i], vz_[i]);
+        d.time = time_[i];
+        d.active = alive_[i] != 0;
+        d.elements_valid = false;
+    }
+}
+
+void DebrisFieldEngine::compact() {
+    size_t i = 0;
+    while (i < active_) {
+        if (alive_[i]) {
+            i++;
+            continue;
+        }
+        size_t last = --active_;
+        for (auto* v : {&x_, &y_, &z_, &vx_, &vy_, &vz_, &ballistic_, &time_}) {
+            std::swap((*v)[i], (*v)[last]);
+        }
+        std::swap(alive_[i], alive_[last]);
+        std::swap(column_[i], column_[last]);
+    }
+}
+
+void DebrisFieldEngine::propagate(double duration, DebrisSamples* samples) {
+    const double dt = config_.dt;
+    if (duration <= 0.0 || dt <= 0.0) return;
+    const bool recording = samples && config_.record_interval > 0.0;
+
+    // Step indices of the samples, on the same clock as propagate_debris_field
+    std::vector<int> sample_steps;
+    std::vector<double> sample_times;
+    int total_steps = 0;
+    double elapsed = 0.0, next_record = 0.0;
+    while (elapsed < duration) {
+        if (recording && elapsed >= next_record) {
+            sample_steps.push_back(total_steps);
+            sample_times.push_back(elapsed);
+            next_record += config_.record_interval;
+        }
+        elapsed += dt;
+        total_steps++;
+    }
+
+    if (recording) {
+        const size_t cells = sample_steps.size() * size();
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        samples->times = sample_times;
+        samples->ids = ids_;
+        for (auto* v : {&samples->x, &samples->y, &samples->z,
+                        &samples->vx, &samples->vy, &samples->vz}) {
+            v->assign(cells, nan);
+        }
+    }
+
+    auto advance = [&](int steps) {
+        compact();
+        if (steps <= 0 || active_ == 0) return;
+        const size_t blocks = (active_ + BLOCK - 1) / BLOCK;
+        auto run = [&](size_t b) {
+            size_t begin = b * BLOCK;
+            step_block(begin, std::min(BLOCK, active_ - begin), steps);
+        };
+        if (pool_ && blocks > 1) {
+            pool_->parallel_for(blocks, run);
+        } else {
+            for (size_t b = 0; b < blocks; b++) run(b);
+        }
+        compact();
+    };
+
+    int done = 0;
+    for (size_t m = 0; m < sample_steps.size(); m++) {
+        advance(sample_steps[m] - done);
+        done = sample_steps[m];
+        for (size_t i = 0; i < active_; i++) {
+            size_t k = samples->index(m, column_[i]);
+            samples->x[k] = x_[i];
+            samples->y[k] = y_[i];
+            samples->z[k] = z_[i];
+            samples->vx[k] = vx_[i];
+            samples->vy[k] = vy_[i];
+            samples->vz[k] = vz_[i];
+        }
+    }
+    advance(total_steps - done);
+}
+
+void DebrisFieldEngine::step_block(size_t begin, size_t n, int steps) {
+    const double h = config_.dt;
+    const double half = h / 2.0;
+    const double sixth = h / 6.0;
+    const double mu = OrbitalDebris::MU;
+
+    Kernel g;
+    g.j2c = config_.use_j2 ?
+        1.5 * OrbitalDebris::J2 * mu * OrbitalDebris::RE * OrbitalDebris::RE : 0.0;
+    g.drag = config_.use_drag;
+    g.ceiling = AtmosphereTable::earth().ceiling();
+    g.reentry_radius = OrbitalDebris::RE + OrbitalDebris::REENTRY_ALT;
+
+    double px[BLOCK], py[BLOCK], pz[BLOCK], qx[BLOCK], qy[BLOCK], qz[BLOCK];
+    double sx[BLOCK], sy[BLOCK], sz[BLOCK], svx[BLOCK], svy[BLOCK], svz[BLOCK];
+    double ax[BLOCK], ay[BLOCK], az[BLOCK];
+    double dpx[BLOCK], dpy[BLOCK], dpz[BLOCK], dvx[BLOCK], dvy[BLOCK], dvz[BLOCK];
+    double bc[BLOCK], t[BLOCK], live[BLOCK];
+
+    std::copy_n(&x_[begin], n, px);
+    std::copy_n(&y_[begin], n, py);
+    std::copy_n(&z_[begin], n, pz);
+    std::copy_n(&vx_[begin], n, qx);
+    std::copy_n(&vy_[begin], n, qy);
+    std::copy_n(&vz_[begin], n, qz);
+    std::copy_n(&ballistic_[begin], n, bc);
+    std::copy_n(&time_[begin], n, t);
+    for (size_t k = 0; k < n; k++) live[k] = alive_[begin + k] ? 1.0 : 0.0;
+
+    for (int s = 0; s < steps; s++) {
+        // k1
+        accel_block(g, n, px, py, pz, qx, qy, qz, bc, ax, ay, az);
+#pragma GCC ivdep
+        for (size_t k = 0; k < n; k++) {
+            dpx[k] = qx[k]; dpy[k] = qy[k]; dpz[k] = qz[k];
+            dvx[k] = ax[k]; dvy[k] = ay[k]; dvz[k] = az[k];
+            sx[k] = px[k] + qx[k] * half;
+            sy[k] = py[k] + qy[k] * half;
+            sz[k] = pz[k] + qz[k] * half;
+            svx[k] = qx[k] + ax[k] * half;
+            svy[k] = qy[k] + ay[k] * half;
+            svz[k] = qz[k] + az[k] * half;
+        }
+
+        // k2
+        accel_block(g, n, sx, sy, sz, svx, svy, svz, bc, ax, ay, az);
+#pragma GCC ivdep
+        for (size_t k = 0; k < n; k++) {
+            dpx[k] += 2.0 * svx[k]; dpy[k] += 2.0 * svy[k]; dpz[k] += 2.0 * svz[k];
+            dvx[k] += 2.0 * ax[k]; dvy[k] += 2.0 * ay[k]; dvz[k] += 2.0 * az[k];
+            sx[k] = px[k] + svx[k] * half;
+            sy[k] = py[k] + svy[k] * half;
+            sz[k] = pz[k] + svz[k] * half;
+            svx[k] = qx[k] + ax[k] * half;
+            svy[k] = qy[k] + ay[k] * half;
+            svz[k] = qz[k] + az[k] * half;
+        }
+
+        // k3
+        accel_block(g, n, sx, sy, sz, svx, svy, svz, bc, ax, ay, az);
+#pragma GCC ivdep
+        for (size_t k = 0; k < n; k++) {
+            dpx[k] += 2.0 * svx[k]; dpy[k] += 2.0 * svy[k]; dpz[k] += 2.0 * svz[k];
+            dvx[k] += 2.0 * ax[k]; dvy[k] += 2.0 * ay[k]; dvz[k] += 2.0 * az[k];
+            sx[k] = px[k] + svx[k] * h;
+            sy[k] = py[k] + svy[k] * h;
+            sz[k] = pz[k] + svz[k] * h;
+            svx[k] = qx[k] + ax[k] * h;
+            svy[k] = qy[k] + ay[k] * h;
+            svz[k] = qz[k] + az[k] * h;
+        }
+
+        // k4, combine on live lanes, then the reentry check
+        accel_block(g, n, sx, sy, sz, svx, svy, svz, bc, ax, ay, az);
+#pragma GCC ivdep
+        for (size_t k = 0; k < n; k++) {
+            const bool on = live[k] != 0.0;
+            const double nx = px[k] + sixth * (dpx[k] + svx[k]);
+            const double ny = py[k] + sixth * (dpy[k] + svy[k]);
+            const double nz = pz[k] + sixth * (dpz[k] + svz[k]);
+            const double nvx = qx[k] + sixth * (dvx[k] + ax[k]);
+            const double nvy = qy[k] + sixth * (dvy[k] + ay[k]);
+            const double nvz = qz[k] + sixth * (dvz[k] + az[k]);
+            px[k] = on ? nx : px[k];
+            py[k] = on ? ny : py[k];
+            pz[k] = on ? nz : pz[k];
+            qx[k] = on ? nvx : qx[k];
+            qy[k] = on ? nvy : qy[k];
+            qz[k] = on ? nvz : qz[k];
+            t[k] += live[k] * h;
+
+            // Perigee h^2 / (mu (1 + e)), valid for any conic
+            const double r = std::sqrt(px[k] * px[k] + py[k] * py[k] + pz[k] * pz[k]);
+            const double v2 = qx[k] * qx[k] + qy[k] * qy[k] + qz[k] * qz[k];
+            const double hx = py[k] * qz[k] - pz[k] * qy[k];
+            const double hy = pz[k] * qx[k] - px[k] * qz[k];
+            const double hz = px[k] * qy[k] - py[k] * qx[k];
+            const double h2 = hx * hx + hy * hy + hz * hz;
+            const double energy = 0.5 * v2 - mu / r;
+            const double e = std::sqrt(std::max(0.0, 1.0 + 2.0 * energy * h2 / (mu * mu)));
+            const double perigee = h2 / (mu * (1.0 + e));
+            live[k] = (on && perigee >= g.reentry_radius) ? 1.0 : 0.0;
+        }
+    }
+
+    std::copy_n(px, n, &x_[begin]);
+    std::copy_n(py, n, &y_[begin]);
+    std::copy_n(pz, n, &z_[begin]);
+    std::copy_n(qx, n, &vx_[begin]);
+    std::copy_n(qy, n, &vy_[begin]);
+    std::copy_n(qz, n, &vz_[begin]);
+    std::copy_n(t, n, &time_[begin]);
+    for (size_t k = 0; k < n; k++) alive_[begin + k] = live[k] != 0.0 ? 1 : 0;
+}
+
+} // namespace sim
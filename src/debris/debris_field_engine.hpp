@@ -0,0 +1,115 @@
+#ifndef DEBRIS_FIELD_ENGINE_HPP
+#define DEBRIS_FIELD_ENGINE_HPP
+
+#include "debris/orbital_debris.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+struct FragmentBatch;
+
+/**
+ * Debris Field Engine
+ *
+ * Batched propagation for large fragment fields (breakups with 10^4 to
+ * 10^5 pieces). Fragment states live in structure-of-arrays form and are
+ * advanced with the same two-body + J2 RK4 step as OrbitalDebris::propagate,
+ * but in blocks of lanes with branch-free J2 and drag kernels the compiler
+ * vectorizes. Blocks are sharded across a thread pool and run every step
+ * between two trajectory samples while they are in cache.
+ *
+ * Reentry (osculating perigee below OrbitalDebris::REENTRY_ALT) is
+ * checked after every step as in OrbitalDebris; a reentered fragment is
+ * frozen for the rest of its block's run and compacted out of the active
+ * set at the next sample, so later steps only touch live fragments.
+ *
+ * Sampled trajectories go into a DebrisSamples buffer that is allocated
+ * once per propagate() call.
+ */
+
+struct DebrisEngineConfig {
+    bool use_j2 = true;
+    bool use_drag = false;         // Drag below AtmosphereTable::earth().ceiling()
+    double drag_coeff = 2.2;
+    double dt = 10.0;              // RK4 step [s]
+    double record_interval = 0.0;  // Sample spacing [s] (0 = no samples)
+    int num_threads = 0;           // 0 = hardware concurrency, 1 = serial
+};
+
+/**
+ * Columnar trajectory samples: one row per sample time, one column per
+ * fragment in load() order. Entries for fragments that are no longer
+ * active at a sample are NaN.
+ */
+struct DebrisSamples {
+    std::vector<double> times;     // Seconds from the start of propagate()
+    std::vector<int> ids;          // OrbitalDebris::id per column
+    std::vector<double> x, y, z;   // ECI position [m], [sample * columns + column]
+    std::vector<double> vx, vy, vz;
+
+    size_t samples() const { return times.size(); }
+    size_t columns() const { return ids.size(); }
+    size_t index(size_t sample, size_t column) const { return sample * ids.size() + column; }
+
+    bool active(size_t sample, size_t column) const;
+    Vec3 position(size_t sample, size_t column) const;
+    Vec3 velocity(size_t sample, size_t column) const;
+};
+
+class DebrisFieldEngine {
+public:
+    explicit DebrisFieldEngine(const DebrisEngineConfig& config = DebrisEngineConfig());
+
+    /** Replace the field with these pieces (inactive pieces stay inactive) */
+    void load(const std::vector<OrbitalDebris>& debris);
+
+    /**
+     * Replace the field with a generated batch, straight from its columns
+     * (ballistic coefficient from drag_coeff and the batch's area-to-mass)
+     */
+    void load(const FragmentBatch& batch);
+
+    /**
+     * Advance every active fragment by duration, in steps of config dt
+     * (the last step may overshoot, as in propagate_debris_field).
+     * @param samples If non-null and record_interval > 0, receives the
+     *                sampled trajectories
+     */
+    void propagate(double duration, DebrisSamples* samples = nullptr);
+
+    /**
+     * Write states, times and active flags back to the pieces passed to
+     * load() (same order).
+     */
+    void store(std::vector<OrbitalDebris>& debris) const;
+
+    /** Write states, times and active flags back to the loaded batch */
+    void store(FragmentBatch& batch) const;
+
+    size_t size() const { return column_.size(); }
+    size_t active_count() const { return active_; }
+
+private:
+    DebrisEngineConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+
+    // Fragment state; [0, active_) is the live set
+    std::vector<double> x_, y_, z_, vx_, vy_, vz_;
+    std::vector<double> ballistic_;      // Cd A / m [m^2/kg]
+    std::vector<double> time_;           // Piece time (frozen at reentry)
+    std::vector<unsigned char> alive_;
+    std::vector<size_t> column_;         // load() index
+    std::vector<int> ids_;               // OrbitalDebris::id by load() index
+    size_t active_ = 0;
+
+    void resize(size_t n);
+    void step_block(size_t begin, size_t n, int steps);
+    void compact();
+};
+
+} // namespace sim
+
+#endif // DEBRIS_FIELD_ENGINE_HPP
@@ -1,4 +1,5 @@
 #include "orbital_debris.hpp"
+#include "debris_field_engine.hpp"
 #include <cmath>
 #include <random>
 #include <chrono>
@@ -314,37 +315,32 @@ std::vector<OrbitalDebrisTrajectory> propagate_debris_field(
     bool use_j2,
     double record_interval) {
 
-    std::vector<OrbitalDebrisTrajectory> trajectories;
-
-    bool recording = (record_interval > 0.0);
-    if (recording) {
-        trajectories.resize(debris.size());
-        for (size_t i = 0; i < debris.size(); i++) {
-            trajectories[i].debris_id = debris[i].id;
-        }
-    }
+    DebrisEngineConfig config;
+    config.use_j2 = use_j2;
+    config.dt = dt;
+    config.record_interval = record_interval;
 
-    double elapsed = 0.0;
-    double next_record = 0.0;
-
-    while (elapsed < duration) {
-        // Record if needed
-        if (recording && elapsed >= next_record) {
-            for (size_t i = 0; i < debris.size(); i++) {
-                if (debris[i].active) {
-                    trajectories[i].times.push_back(elapsed);
-                    trajectories[i].states.push_back(debris[i].state);
-                }
-            }
-            next_record += record_interval;
-        }
+    DebrisFieldEngine engine(config);
+    engine.load(debris);
+    DebrisSamples samples;
+    engine.propagate(duration, &samples);
+    engine.store(debris);
 
-        // Propagate all active debris
-        for (auto& d : debris) {
-            d.propagate(dt, use_j2);
+    std::vector<OrbitalDebrisTrajectory> trajectories;
+    if (record_interval <= 0.0) return trajectories;
+
+    trajectories.resize(debris.size());
+    for (size_t i = 0; i < debris.size(); i++) {
+        OrbitalDebrisTrajectory& traj = trajectories[i];
+        traj.debris_id = debris[i].id;
+        for (size_t s = 0; s < samples.samples(); s++) {
+            if (!samples.active(s, i)) continue;
+            StateVector state = debris[i].state;
+            state.position = samples.position(s, i);
+            state.velocity = samples.velocity(s, i);
+            traj.times.push_back(samples.times[s]);
+            traj.states.push_back(state);
         }
-
-        elapsed += dt;
     }
 
     return trajectories;
@@ -96,7 +96,8 @@ int main(int argc, char* argv[]) {
 
     // Parse TLEs
     std::cout << "Loading TLEs from: " << tle_file << std::endl;
-    auto tles = sim::TLEParser::parse_file(tle_file);
+    auto catalog = sim::TLEParser::load_file(tle_file);
+    const auto& tles = *catalog;
 
     if (tles.empty()) {
         std::cerr << "ERROR: No TLEs loaded. Check file path." << std::endl;
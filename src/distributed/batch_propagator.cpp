@@ -0,0 +1,80 @@
+#include "distributed/batch_propagator.hpp"
+#include "distributed/kepler_device.hpp"
+#include "physics/encke_propagator.hpp"
+#include "utils/gpu.hpp"
+
+namespace sim { namespace distributed {
+
+// ---------------------------------------------------------------------------
+// KeplerBatchPropagator
+// ---------------------------------------------------------------------------
+
+KeplerBatchPropagator::KeplerBatchPropagator(double fallback_max_step) {
+    fallback_.use_j2 = fallback_.use_j3 = fallback_.use_j4 = false;
+    fallback_.max_step = fallback_max_step;
+    if (gpu_available()) device_ = KeplerDevice::create(fallback_.body.mu);
+}
+
+KeplerBatchPropagator::~KeplerBatchPropagator() = default;
+
+bool KeplerBatchPropagator::advance_block(const EntityBlock& b, double dt) {
+    if (!device_) return false;
+    device_->advance(b, dt, unbound_);
+    for (size_t i : unbound_) {
+        CatalogPropagator::propagate_arrays(fallback_, 1, &b.x[i], &b.y[i], &b.z[i],
+                                            &b.vx[i], &b.vy[i], &b.vz[i], dt);
+    }
+    return true;
+}
+
+void KeplerBatchPropagator::advance(const EntityBlock& b, size_t begin, size_t end, double dt) {
+    const double mu = fallback_.body.mu;
+    for (size_t i = begin; i < end; ++i) {
+        Vec3 r(b.x[i], b.y[i], b.z[i]);
+        Vec3 v(b.vx[i], b.vy[i], b.vz[i]);
+        Vec3 r1, v1;
+        if (EnckePropagator::kepler_fg(r, v, dt, mu, r1, v1)) {
+            b.x[i] = r1.x;   b.y[i] = r1.y;   b.z[i] = r1.z;
+            b.vx[i] = v1.x;  b.vy[i] = v1.y;  b.vz[i] = v1.z;
+        } else {
+            CatalogPropagator::propagate_arrays(fallback_, 1, &b.x[i], &b.y[i], &b.z[i],
+                                                &b.vx[i], &b.vy[i], &b.vz[i], dt);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RK4BatchPropagator
+// ---------------------------------------------------------------------------
+
+RK4BatchPropagator::RK4BatchPropagator(const CatalogConfig& config) : config_(config) {}
+
+void RK4BatchPropagator::advance(const EntityBlock& b, size_t begin, size_t end, double dt) {
+    CatalogPropagator::propagate_arrays(config_, end - begin, &b.x[begin], &b.y[begin],
+                                        &b.z[begin], &b.vx[begin], &b.vy[begin],
+                                        &b.vz[begin], dt);
+}
+
+// ---------------------------------------------------------------------------
+// SGP4BatchPropagator
+// ---------------------------------------------------------------------------
+
+void SGP4BatchPropagator::add(int entity_id, const TLE& tle) {
+    records_[entity_id] = SGP4Propagator::initialize(tle);
+}
+
+void SGP4BatchPropagator::advance(const EntityBlock& b, size_t begin, size_t end, double dt) {
+    const double jd = epoch_jd_ + (b.time + dt) / 86400.0;
+    for (size_t i = begin; i < end; ++i) {
+        auto it = records_.find(b.ids[i]);
+        if (it == records_.end() || it->second.init_error != SGP4Error::NONE) continue;
+
+        Vec3 r, v;
+        double tsince = (jd - it->second.epoch_jd) * 1440.0;
+        if (SGP4Propagator::propagate(it->second, tsince, r, v) != SGP4Error::NONE) continue;
+        b.x[i] = r.x;   b.y[i] = r.y;   b.z[i] = r.z;
+        b.vx[i] = v.x;  b.vy[i] = v.y;  b.vz[i] = v.z;
+    }
+}
+
+}} // namespace sim::distributed
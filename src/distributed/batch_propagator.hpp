@@ -0,0 +1,125 @@
+#ifndef SIM_BATCH_PROPAGATOR_HPP
+#define SIM_BATCH_PROPAGATOR_HPP
+
+#include "propagators/catalog_propagator.hpp"
+#include "propagators/sgp4_propagator.hpp"
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sim { namespace distributed {
+
+class KeplerDevice;
+
+/**
+ * @brief A worker's entity block in structure-of-arrays form
+ *
+ * Index i of every span is entity ids[i]. Positions [m] and velocities
+ * [m/s] are in the frame of the entities' StateVectors; mass [kg] is 0
+ * where unknown.
+ */
+struct EntityBlock {
+    const int* ids = nullptr;
+    double* x = nullptr;
+    double* y = nullptr;
+    double* z = nullptr;
+    double* vx = nullptr;
+    double* vy = nullptr;
+    double* vz = nullptr;
+    double* mass = nullptr;
+    size_t size = 0;
+    double time = 0.0;   // [s] block time at the start of the step
+};
+
+/**
+ * @brief Batched physics for SimWorker (see SimWorker::set_batch_propagator)
+ *
+ * Instead of one update call per entity, the worker hands its whole block
+ * over once per step, cut into chunk_size() ranges that its thread pool
+ * runs concurrently. advance() must therefore only write its own range.
+ * A propagator that can take the whole block at once on an accelerator
+ * does so in advance_block(), and the worker skips the chunks.
+ */
+class BatchPropagator {
+public:
+    virtual ~BatchPropagator() = default;
+
+    /// Advance entities [begin, end) of the block by dt
+    virtual void advance(const EntityBlock& block, size_t begin, size_t end, double dt) = 0;
+
+    /// Entities per advance() call (cache blocking and load-balancing grain)
+    virtual size_t chunk_size() const { return 256; }
+
+    /// Advance the whole block by dt off the CPU; false = not offloaded,
+    /// use advance() on chunks
+    virtual bool advance_block(const EntityBlock& block, double dt) {
+        (void)block;
+        (void)dt;
+        return false;
+    }
+};
+
+/**
+ * @brief Exact two-body motion (f and g functions, EnckePropagator::kepler_fg)
+ *
+ * Entities on non-elliptical orbits, which kepler_fg rejects, fall back to
+ * two-body RK4 with steps of at most fallback_max_step seconds.
+ *
+ * On a GPU build with a device present (utils/gpu.hpp) the block is
+ * advanced on the device with its states kept resident (KeplerDevice);
+ * the RK4 fallback still runs on the CPU.
+ */
+class KeplerBatchPropagator : public BatchPropagator {
+public:
+    explicit KeplerBatchPropagator(double fallback_max_step = 10.0);
+    ~KeplerBatchPropagator() override;
+
+    void advance(const EntityBlock& block, size_t begin, size_t end, double dt) override;
+    bool advance_block(const EntityBlock& block, double dt) override;
+
+private:
+    CatalogConfig fallback_;
+    std::unique_ptr<KeplerDevice> device_;   // Null without a GPU
+    std::vector<size_t> unbound_;
+};
+
+/**
+ * @brief Two-body + J2 (optionally J3/J4) RK4 through CatalogPropagator's
+ * blocked kernel, on the worker's arrays in place
+ */
+class RK4BatchPropagator : public BatchPropagator {
+public:
+    explicit RK4BatchPropagator(const CatalogConfig& config = CatalogConfig{});
+
+    void advance(const EntityBlock& block, size_t begin, size_t end, double dt) override;
+
+private:
+    CatalogConfig config_;
+};
+
+/**
+ * @brief SGP4 evaluated at the block's time for entities with a TLE
+ *
+ * Block time 0 corresponds to epoch_jd. Positions and velocities are
+ * TEME; entities without a record, or whose record fails to propagate,
+ * keep their state.
+ */
+class SGP4BatchPropagator : public BatchPropagator {
+public:
+    explicit SGP4BatchPropagator(double epoch_jd) : epoch_jd_(epoch_jd) {}
+
+    /// Attach a TLE to an entity (before the worker starts stepping)
+    void add(int entity_id, const TLE& tle);
+    void add(int entity_id, const SGP4Record& record) { records_[entity_id] = record; }
+
+    void advance(const EntityBlock& block, size_t begin, size_t end, double dt) override;
+
+private:
+    double epoch_jd_;
+    std::unordered_map<int, SGP4Record> records_;
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_BATCH_PROPAGATOR_HPP
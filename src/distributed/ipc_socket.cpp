@@ -1,14 +1,29 @@
 #include "distributed/ipc_socket.hpp"
+#include "distributed/metrics.hpp"
 
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
 #include <cstdint>
 #include <cstring>
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+
+#ifdef SIM_HAVE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#endif
 
 namespace sim { namespace distributed {
 
@@ -26,6 +41,10 @@ static std::string message_type_to_string(MessageType t) {
         case MessageType::STEP_COMPLETE: return "STEP_COMPLETE";
         case MessageType::SYNC_RESPONSE: return "SYNC_RESPONSE";
         case MessageType::ERROR:         return "ERROR";
+        case MessageType::MIGRATE_OUT:   return "MIGRATE_OUT";
+        case MessageType::MIGRATE_STATE: return "MIGRATE_STATE";
+        case MessageType::MIGRATE_IN:    return "MIGRATE_IN";
+        case MessageType::GHOSTS:        return "GHOSTS";
     }
     return "UNKNOWN";
 }
@@ -38,6 +57,10 @@ static MessageType string_to_message_type(const std::string& s) {
     if (s == "READY")         return MessageType::READY;
     if (s == "STEP_COMPLETE") return MessageType::STEP_COMPLETE;
     if (s == "SYNC_RESPONSE") return MessageType::SYNC_RESPONSE;
+    if (s == "MIGRATE_OUT")   return MessageType::MIGRATE_OUT;
+    if (s == "MIGRATE_STATE") return MessageType::MIGRATE_STATE;
+    if (s == "MIGRATE_IN")    return MessageType::MIGRATE_IN;
+    if (s == "GHOSTS")        return MessageType::GHOSTS;
     return MessageType::ERROR;
 }
 
@@ -131,6 +154,161 @@ static double json_get_number(const std::string& json, const std::string& key) {
     return std::stod(num_str);
 }
 
+static constexpr uint32_t MAX_JSON_FRAME = 10 * 1024 * 1024;  // 10 MB safety limit
+
+/// Big-endian length prefix
+static void encode_length(uint32_t len, unsigned char out[4]) {
+    out[0] = static_cast<unsigned char>((len >> 24) & 0xFF);
+    out[1] = static_cast<unsigned char>((len >> 16) & 0xFF);
+    out[2] = static_cast<unsigned char>((len >> 8)  & 0xFF);
+    out[3] = static_cast<unsigned char>((len)       & 0xFF);
+}
+
+/// Split "tcp://host:port" / "tls://host:port"; false for a Unix path
+static bool parse_network_address(const std::string& address, bool& tls,
+                                  std::string& host, std::string& port) {
+    std::string rest;
+    if (address.compare(0, 6, "tcp://") == 0) {
+        tls = false;
+    } else if (address.compare(0, 6, "tls://") == 0) {
+        tls = true;
+    } else {
+        return false;
+    }
+    rest = address.substr(6);
+
+    auto colon = rest.rfind(':');
+    if (colon == std::string::npos || colon + 1 == rest.size()) {
+        throw std::runtime_error("Address needs a port: " + address);
+    }
+    host = rest.substr(0, colon);
+    port = rest.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);   // [::1]:7000
+    }
+    return true;
+}
+
+// Transport volume for the metrics endpoint (payload and framing bytes)
+struct IPCMetrics {
+    Counter sent;
+    Counter received;
+};
+
+static const IPCMetrics& ipc_metrics() {
+    static const IPCMetrics m{
+        MetricsRegistry::global().counter("sim_ipc_sent_bytes_total",
+                                          "Bytes written to IPC sockets"),
+        MetricsRegistry::global().counter("sim_ipc_received_bytes_total",
+                                          "Bytes read from IPC sockets")};
+    return m;
+}
+
+static void set_tcp_nodelay(int fd) {
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+static std::mutex tls_mutex;
+static TlsConfig tls_config = TlsConfig::from_environment();
+
+TlsConfig TlsConfig::from_environment() {
+    TlsConfig c;
+    if (const char* v = std::getenv("SIM_TLS_CERT")) c.cert_file = v;
+    if (const char* v = std::getenv("SIM_TLS_KEY")) c.key_file = v;
+    if (const char* v = std::getenv("SIM_TLS_CA")) c.ca_file = v;
+    if (const char* v = std::getenv("SIM_TLS_VERIFY")) c.verify_peer = std::string(v) != "0";
+    return c;
+}
+
+#ifdef SIM_HAVE_OPENSSL
+
+static std::string tls_error() {
+    unsigned long e = ERR_get_error();
+    if (e == 0) return "unknown TLS error";
+    char buf[256];
+    ERR_error_string_n(e, buf, sizeof(buf));
+    return buf;
+}
+
+static SSL_CTX* server_ctx = nullptr;
+static SSL_CTX* client_ctx = nullptr;
+
+/// Process-wide contexts, built on first use from the current TlsConfig
+static SSL_CTX* tls_context(bool server) {
+    std::lock_guard<std::mutex> lock(tls_mutex);
+    SSL_CTX*& ctx = server ? server_ctx : client_ctx;
+    if (ctx) return ctx;
+
+    SSL_CTX* c = SSL_CTX_new(server ? TLS_server_method() : TLS_client_method());
+    if (!c) throw std::runtime_error("TLS context: " + tls_error());
+    SSL_CTX_set_min_proto_version(c, TLS1_2_VERSION);
+
+    if (server) {
+        if (tls_config.cert_file.empty() || tls_config.key_file.empty()) {
+            SSL_CTX_free(c);
+            throw std::runtime_error("TLS listener needs a certificate and key (SIM_TLS_CERT, SIM_TLS_KEY)");
+        }
+        if (SSL_CTX_use_certificate_chain_file(c, tls_config.cert_file.c_str()) != 1 ||
+            SSL_CTX_use_PrivateKey_file(c, tls_config.key_file.c_str(), SSL_FILETYPE_PEM) != 1) {
+            std::string err = tls_error();
+            SSL_CTX_free(c);
+            throw std::runtime_error("TLS certificate: " + err);
+        }
+    } else if (tls_config.verify_peer) {
+        int ok = tls_config.ca_file.empty()
+                     ? SSL_CTX_set_default_verify_paths(c)
+                     : SSL_CTX_load_verify_locations(c, tls_config.ca_file.c_str(), nullptr);
+        if (ok != 1) {
+            std::string err = tls_error();
+            SSL_CTX_free(c);
+            throw std::runtime_error("TLS CA: " + err);
+        }
+        SSL_CTX_set_verify(c, SSL_VERIFY_PEER, nullptr);
+    }
+    ctx = c;
+    return ctx;
+}
+
+/// Handshake on a connected descriptor (blocking), then switch it to non-blocking;
+/// the caller owns fd on failure
+static SSL* tls_handshake(int fd, bool server, const std::string& host) {
+    SSL* ssl = SSL_new(tls_context(server));
+    if (!ssl) throw std::runtime_error("TLS session: " + tls_error());
+    SSL_set_fd(ssl, fd);
+
+    int ret;
+    if (server) {
+        ret = SSL_accept(ssl);
+    } else {
+        SSL_set_tlsext_host_name(ssl, host.c_str());
+        if (tls_config.verify_peer) SSL_set1_host(ssl, host.c_str());
+        ret = SSL_connect(ssl);
+    }
+    if (ret != 1) {
+        std::string err = tls_error();
+        SSL_free(ssl);
+        throw std::runtime_error("TLS handshake failed: " + err);
+    }
+    // Non-blocking from here: SSL_read stands in for recv(MSG_DONTWAIT)
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return ssl;
+}
+
+#endif // SIM_HAVE_OPENSSL
+
+void IPCSocket::set_tls_config(const TlsConfig& config) {
+    std::lock_guard<std::mutex> lock(tls_mutex);
+    tls_config = config;
+#ifdef SIM_HAVE_OPENSSL
+    // Open sessions keep a reference to their context
+    SSL_CTX_free(server_ctx);
+    SSL_CTX_free(client_ctx);
+    server_ctx = nullptr;
+    client_ctx = nullptr;
+#endif
+}
+
 // ---------------------------------------------------------------------------
 // Construction / Destruction / Move
 // ---------------------------------------------------------------------------
@@ -142,10 +320,12 @@ IPCSocket::~IPCSocket() {
 }
 
 IPCSocket::IPCSocket(IPCSocket&& other) noexcept
-    : fd_(other.fd_), is_server_(other.is_server_), socket_path_(std::move(other.socket_path_))
+    : fd_(other.fd_), is_server_(other.is_server_), tcp_(other.tcp_), tls_(other.tls_),
+      ssl_(other.ssl_), socket_path_(std::move(other.socket_path_)), rx_(std::move(other.rx_))
 {
     other.fd_ = -1;
     other.is_server_ = false;
+    other.ssl_ = nullptr;
 }
 
 IPCSocket& IPCSocket::operator=(IPCSocket&& other) noexcept {
@@ -153,9 +333,14 @@ IPCSocket& IPCSocket::operator=(IPCSocket&& other) noexcept {
         close();
         fd_ = other.fd_;
         is_server_ = other.is_server_;
+        tcp_ = other.tcp_;
+        tls_ = other.tls_;
+        ssl_ = other.ssl_;
         socket_path_ = std::move(other.socket_path_);
+        rx_ = std::move(other.rx_);
         other.fd_ = -1;
         other.is_server_ = false;
+        other.ssl_ = nullptr;
     }
     return *this;
 }
@@ -165,6 +350,50 @@ IPCSocket& IPCSocket::operator=(IPCSocket&& other) noexcept {
 // ---------------------------------------------------------------------------
 
 IPCSocket IPCSocket::listen(const std::string& socket_path) {
+    bool tls = false;
+    std::string host, port;
+    if (parse_network_address(socket_path, tls, host, port)) {
+#ifndef SIM_HAVE_OPENSSL
+        if (tls) throw std::runtime_error("TLS transport not available (built without OpenSSL)");
+#else
+        if (tls) tls_context(true);   // Fail now on a missing certificate, not per accept
+#endif
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        struct addrinfo* res = nullptr;
+        int gai = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res);
+        if (gai != 0) {
+            throw std::runtime_error("Cannot resolve " + socket_path + ": " + ::gai_strerror(gai));
+        }
+
+        int fd = -1;
+        std::string err;
+        for (auto* ai = res; ai; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0) continue;
+            int one = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, 64) == 0) break;
+            err = std::strerror(errno);
+            ::close(fd);
+            fd = -1;
+        }
+        ::freeaddrinfo(res);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to listen on " + socket_path + ": " + err);
+        }
+
+        IPCSocket sock;
+        sock.fd_ = fd;
+        sock.is_server_ = true;
+        sock.tcp_ = true;
+        sock.tls_ = tls;
+        return sock;
+    }
+
     // Remove stale socket file if it exists
     ::unlink(socket_path.c_str());
 
@@ -200,6 +429,55 @@ IPCSocket IPCSocket::listen(const std::string& socket_path) {
 }
 
 IPCSocket IPCSocket::connect(const std::string& socket_path) {
+    bool tls = false;
+    std::string host, port;
+    if (parse_network_address(socket_path, tls, host, port)) {
+#ifndef SIM_HAVE_OPENSSL
+        if (tls) throw std::runtime_error("TLS transport not available (built without OpenSSL)");
+#endif
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* res = nullptr;
+        int gai = ::getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(),
+                                &hints, &res);
+        if (gai != 0) {
+            throw std::runtime_error("Cannot resolve " + socket_path + ": " + ::gai_strerror(gai));
+        }
+
+        int fd = -1;
+        std::string err;
+        for (auto* ai = res; ai; ai = ai->ai_next) {
+            fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0) continue;
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+            err = std::strerror(errno);
+            ::close(fd);
+            fd = -1;
+        }
+        ::freeaddrinfo(res);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to connect to " + socket_path + ": " + err);
+        }
+        set_tcp_nodelay(fd);
+
+        IPCSocket sock;
+        sock.fd_ = fd;
+        sock.tcp_ = true;
+#ifdef SIM_HAVE_OPENSSL
+        if (tls) {
+            try {
+                sock.ssl_ = tls_handshake(fd, false, host);
+            } catch (...) {
+                sock.close();
+                throw;
+            }
+        }
+#endif
+        return sock;
+    }
+
     int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
     if (fd < 0) {
         throw std::runtime_error("Failed to create Unix domain socket: " +
@@ -228,9 +506,10 @@ IPCSocket IPCSocket::accept() {
         throw std::runtime_error("Cannot accept on non-server or closed socket");
     }
 
-    struct sockaddr_un client_addr;
+    struct sockaddr_storage client_addr;
     socklen_t client_len = sizeof(client_addr);
-    int client_fd = ::accept(fd_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
+    int client_fd = ::accept4(fd_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len,
+                              SOCK_CLOEXEC);
     if (client_fd < 0) {
         throw std::runtime_error("Failed to accept connection: " +
                                  std::string(std::strerror(errno)));
@@ -239,76 +518,371 @@ IPCSocket IPCSocket::accept() {
     IPCSocket sock;
     sock.fd_ = client_fd;
     sock.is_server_ = false;
+    sock.tcp_ = tcp_;
+    if (tcp_) set_tcp_nodelay(client_fd);
+#ifdef SIM_HAVE_OPENSSL
+    if (tls_) {
+        sock.ssl_ = tls_handshake(client_fd, true, "");
+    }
+#endif
     return sock;
 }
 
+bool IPCSocket::accept(IPCSocket& out, int timeout_ms) {
+    if (!is_server_ || fd_ < 0) {
+        throw std::runtime_error("Cannot accept on non-server or closed socket");
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret;
+    do {
+        ret = ::poll(&pfd, 1, timeout_ms);
+    } while (ret < 0 && errno == EINTR);
+    if (ret <= 0 || !(pfd.revents & POLLIN)) return false;
+
+    out = accept();
+    return true;
+}
+
 // ---------------------------------------------------------------------------
 // Send / Receive
 // ---------------------------------------------------------------------------
 
 bool IPCSocket::send(const IPCMessage& msg) {
     if (fd_ < 0) return false;
-    std::string data = serialize_message(msg);
+    TraceSpan span("ipc.send", "ipc");
+    std::string data;
+    {
+        TraceSpan serialize("ipc.serialize", "ipc");
+        data = serialize_message(msg, span.context());
+    }
+    span.set_bytes(data.size() + 4);
+    span.mark_flow_out();
     return send_raw(data);
 }
 
+bool IPCSocket::send_states(MessageType type, double timestamp,
+                            const wire::StateRecord* records, size_t count) {
+    if (fd_ < 0) return false;
+
+    size_t body = count * sizeof(wire::StateRecord);
+    if (body > wire::MAX_STATE_FRAME - sizeof(wire::StateHeader)) return false;
+    TraceSpan span("ipc.send_states", "ipc");
+    span.set_bytes(4 + sizeof(wire::StateHeader) + body);
+
+    wire::StateHeader header;
+    std::memcpy(header.magic, wire::STATE_MAGIC, 4);
+    header.type = static_cast<uint32_t>(type);
+    header.timestamp = timestamp;
+    header.count = static_cast<uint32_t>(count);
+    header.record_bytes = sizeof(wire::StateRecord);
+
+    unsigned char prefix[4];
+    encode_length(static_cast<uint32_t>(sizeof(header) + body), prefix);
+
+    struct iovec iov[3];
+    iov[0] = {prefix, sizeof(prefix)};
+    iov[1] = {&header, sizeof(header)};
+    iov[2] = {const_cast<wire::StateRecord*>(records), body};
+    return write_all(iov, body > 0 ? 3 : 2);
+}
+
 IPCMessage IPCSocket::receive() {
     if (fd_ < 0) {
         throw std::runtime_error("Cannot receive on closed socket");
     }
-    std::string data = receive_raw();
-    return deserialize_message(data);
+    IPCMessage msg;
+    while (!receive_ready(msg)) wait_io(false);
+    return msg;
 }
 
-std::pair<bool, IPCMessage> IPCSocket::receive_timeout(int timeout_ms) {
-    if (fd_ < 0) {
-        return {false, IPCMessage()};
+long IPCSocket::read_some(void* dst, size_t bytes) {
+#ifdef SIM_HAVE_OPENSSL
+    if (ssl_) {
+        int n = SSL_read(ssl_, dst, static_cast<int>(std::min<size_t>(bytes, 1 << 30)));
+        if (n > 0) {
+            ipc_metrics().received.add(static_cast<uint64_t>(n));
+            return n;
+        }
+        int err = SSL_get_error(ssl_, n);
+        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+            errno = EAGAIN;
+            return -1;
+        }
+        if (err == SSL_ERROR_ZERO_RETURN) return 0;
+        errno = EIO;
+        return -1;
     }
+#endif
+    long n = static_cast<long>(::recv(fd_, dst, bytes, MSG_DONTWAIT));
+    if (n > 0) ipc_metrics().received.add(static_cast<uint64_t>(n));
+    return n;
+}
 
+bool IPCSocket::write_all(struct iovec* iov, int count) {
+    size_t total = 0;
+    for (int k = 0; k < count; ++k) total += iov[k].iov_len;
+#ifdef SIM_HAVE_OPENSSL
+    if (ssl_) {
+        for (int k = 0; k < count; ++k) {
+            const char* p = static_cast<const char*>(iov[k].iov_base);
+            size_t left = iov[k].iov_len;
+            while (left > 0) {
+                int n = SSL_write(ssl_, p, static_cast<int>(std::min<size_t>(left, 1 << 30)));
+                if (n > 0) {
+                    p += n;
+                    left -= static_cast<size_t>(n);
+                    continue;
+                }
+                int err = SSL_get_error(ssl_, n);
+                if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE) {
+                    wait_io(err == SSL_ERROR_WANT_WRITE);
+                    continue;
+                }
+                return false;
+            }
+        }
+        ipc_metrics().sent.add(total);
+        return true;
+    }
+#endif
+    // writev until every iovec is sent (advances iov in place)
+    while (count > 0) {
+        ssize_t n = ::writev(fd_, iov, count);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            wait_io(true);
+            continue;
+        }
+        if (n <= 0) return false;
+        size_t sent = static_cast<size_t>(n);
+        while (count > 0 && sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    ipc_metrics().sent.add(total);
+    return true;
+}
+
+bool IPCSocket::write_bytes(const void* data, size_t bytes) {
+    if (fd_ < 0) return false;
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(data);
+    iov.iov_len = bytes;
+    return write_all(&iov, 1);
+}
+
+void IPCSocket::read_exact(void* dst, size_t bytes, const char* what) {
+    char* p = static_cast<char*>(dst);
+    while (bytes > 0) {
+        long r = read_some(p, bytes);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            wait_io(false);
+            continue;
+        }
+        if (r <= 0) {
+            throw std::runtime_error(std::string("Connection closed while reading ") + what);
+        }
+        p += r;
+        bytes -= static_cast<size_t>(r);
+    }
+}
+
+void IPCSocket::wait_io(bool for_write) {
     struct pollfd pfd;
     pfd.fd = fd_;
-    pfd.events = POLLIN;
+    pfd.events = for_write ? POLLOUT : POLLIN;
     pfd.revents = 0;
+    if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+        throw std::runtime_error("poll failed: " + std::string(std::strerror(errno)));
+    }
+}
 
-    int ret = ::poll(&pfd, 1, timeout_ms);
-    if (ret <= 0) {
-        // Timeout or error
-        return {false, IPCMessage()};
+bool IPCSocket::fill(void* dst, size_t bytes) {
+    char* p = static_cast<char*>(dst);
+    while (rx_.got < bytes) {
+        long n = read_some(p + rx_.got, bytes - rx_.got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+        if (n <= 0) {
+            bool in_header = rx_.stage == RxState::LENGTH;
+            rx_ = RxState();
+            throw std::runtime_error(in_header ? "Connection closed while reading header"
+                                               : "Connection closed while reading payload");
+        }
+        rx_.got += static_cast<size_t>(n);
     }
+    rx_.got = 0;
+    return true;
+}
 
-    if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+bool IPCSocket::receive_ready(IPCMessage& out) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot receive on closed socket");
+    }
+
+    for (;;) {
+        switch (rx_.stage) {
+            case RxState::LENGTH:
+                if (!fill(rx_.prefix, sizeof(rx_.prefix))) return false;
+                rx_.len = (static_cast<uint32_t>(rx_.prefix[0]) << 24) |
+                          (static_cast<uint32_t>(rx_.prefix[1]) << 16) |
+                          (static_cast<uint32_t>(rx_.prefix[2]) << 8)  |
+                          (static_cast<uint32_t>(rx_.prefix[3]));
+                if (Tracer::global().enabled()) rx_.start_ns = TraceSpan::now_ns();
+                if (rx_.len < sizeof(wire::StateHeader)) {
+                    rx_.text.assign(rx_.len, '\0');
+                    rx_.stage = RxState::TEXT;
+                } else {
+                    rx_.stage = RxState::HEADER;
+                }
+                break;
+
+            case RxState::HEADER: {
+                if (!fill(&rx_.header, sizeof(rx_.header))) return false;
+                size_t rest = rx_.len - sizeof(rx_.header);
+
+                if (std::memcmp(rx_.header.magic, wire::STATE_MAGIC, 4) != 0) {
+                    // JSON message: the bytes read are the start of its text
+                    if (rx_.len > MAX_JSON_FRAME) {
+                        uint32_t len = rx_.len;
+                        rx_ = RxState();
+                        throw std::runtime_error("Message too large: " + std::to_string(len) +
+                                                 " bytes");
+                    }
+                    rx_.text.assign(rx_.len, '\0');
+                    std::memcpy(&rx_.text[0], &rx_.header, sizeof(rx_.header));
+                    rx_.got = sizeof(rx_.header);
+                    rx_.stage = RxState::TEXT;
+                    break;
+                }
+
+                const wire::StateHeader& h = rx_.header;
+                if (rx_.len > wire::MAX_STATE_FRAME || h.record_bytes != sizeof(wire::StateRecord) ||
+                    rest != static_cast<size_t>(h.count) * sizeof(wire::StateRecord)) {
+                    uint32_t len = rx_.len;
+                    rx_ = RxState();
+                    throw std::runtime_error("Malformed state frame: " + std::to_string(len) +
+                                             " bytes");
+                }
+                rx_.msg = IPCMessage();
+                rx_.msg.type = h.type <= static_cast<uint32_t>(MessageType::GHOSTS)
+                                   ? static_cast<MessageType>(h.type) : MessageType::ERROR;
+                rx_.msg.timestamp = h.timestamp;
+                rx_.msg.states.resize(h.count);
+                rx_.stage = RxState::STATES;
+                break;
+            }
+
+            case RxState::STATES:
+                if (!fill(rx_.msg.states.data(), rx_.msg.states.size() * sizeof(wire::StateRecord))) {
+                    return false;
+                }
+                out = std::move(rx_.msg);
+                rx_.msg = IPCMessage();
+                rx_.stage = RxState::LENGTH;
+                if (rx_.start_ns) {
+                    TraceSpan::record_completed("ipc.receive", "ipc", rx_.start_ns,
+                                                TraceSpan::now_ns(), rx_.len + 4);
+                    rx_.start_ns = 0;
+                }
+                return true;
+
+            case RxState::TEXT:
+                if (!fill(&rx_.text[0], rx_.text.size())) return false;
+                out = deserialize_message(rx_.text);
+                rx_.text.clear();
+                rx_.stage = RxState::LENGTH;
+                if (rx_.start_ns) {
+                    TraceSpan::record_completed("ipc.receive", "ipc", rx_.start_ns,
+                                                TraceSpan::now_ns(), rx_.len + 4);
+                    rx_.start_ns = 0;
+                }
+                return true;
+        }
+    }
+}
+
+std::pair<bool, IPCMessage> IPCSocket::receive_timeout(int timeout_ms) {
+    if (fd_ < 0) {
         return {false, IPCMessage()};
     }
 
-    if (pfd.revents & POLLIN) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    IPCMessage msg;
+    for (;;) {
         try {
-            IPCMessage msg = receive();
-            return {true, msg};
+            if (receive_ready(msg)) return {true, msg};
         } catch (...) {
             return {false, IPCMessage()};
         }
-    }
 
-    return {false, IPCMessage()};
+        int left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        struct pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ret = ::poll(&pfd, 1, std::max(left, 0));
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) {
+            // Timeout or error
+            return {false, IPCMessage()};
+        }
+        if (!(pfd.revents & POLLIN) && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+            return {false, IPCMessage()};
+        }
+    }
 }
 
 void IPCSocket::close() {
+#ifdef SIM_HAVE_OPENSSL
+    if (ssl_) {
+        SSL_shutdown(ssl_);
+        SSL_free(ssl_);
+        ssl_ = nullptr;
+    }
+#endif
     if (fd_ >= 0) {
         ::close(fd_);
         fd_ = -1;
     }
+    rx_ = RxState();
     // Remove socket file if we were the server
     if (is_server_ && !socket_path_.empty()) {
         ::unlink(socket_path_.c_str());
         socket_path_.clear();
-        is_server_ = false;
     }
+    is_server_ = false;
+    tcp_ = false;
+    tls_ = false;
 }
 
 bool IPCSocket::is_connected() const {
     return fd_ >= 0;
 }
 
+bool IPCSocket::peer_closed() const {
+    if (fd_ < 0) return true;
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLRDHUP;
+    pfd.revents = 0;
+    return ::poll(&pfd, 1, 0) > 0 &&
+           (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR | POLLNVAL)) != 0;
+}
+
 // ---------------------------------------------------------------------------
 // Frame protocol: [4-byte big-endian length][payload]
 // ---------------------------------------------------------------------------
@@ -316,33 +890,22 @@ bool IPCSocket::is_connected() const {
 bool IPCSocket::send_raw(const std::string& data) {
     if (fd_ < 0) return false;
 
-    uint32_t len = static_cast<uint32_t>(data.size());
-
-    // Big-endian length prefix
     unsigned char header[4];
-    header[0] = static_cast<unsigned char>((len >> 24) & 0xFF);
-    header[1] = static_cast<unsigned char>((len >> 16) & 0xFF);
-    header[2] = static_cast<unsigned char>((len >> 8)  & 0xFF);
-    header[3] = static_cast<unsigned char>((len)       & 0xFF);
-
-    // Send header
-    ssize_t total = 0;
-    while (total < 4) {
-        ssize_t n = ::write(fd_, header + total, 4 - static_cast<size_t>(total));
-        if (n <= 0) return false;
-        total += n;
-    }
+    encode_length(static_cast<uint32_t>(data.size()), header);
 
-    // Send payload
-    total = 0;
-    ssize_t payload_len = static_cast<ssize_t>(data.size());
-    while (total < payload_len) {
-        ssize_t n = ::write(fd_, data.data() + total, static_cast<size_t>(payload_len - total));
-        if (n <= 0) return false;
-        total += n;
-    }
+    struct iovec iov[2];
+    iov[0] = {header, sizeof(header)};
+    iov[1] = {const_cast<char*>(data.data()), data.size()};
+    return write_all(iov, data.empty() ? 1 : 2);
+}
 
-    return true;
+uint32_t IPCSocket::receive_length() {
+    unsigned char header[4];
+    read_exact(header, sizeof(header), "header");
+    return (static_cast<uint32_t>(header[0]) << 24) |
+           (static_cast<uint32_t>(header[1]) << 16) |
+           (static_cast<uint32_t>(header[2]) << 8)  |
+           (static_cast<uint32_t>(header[3]));
 }
 
 std::string IPCSocket::receive_raw() {
@@ -350,40 +913,14 @@ std::string IPCSocket::receive_raw() {
         throw std::runtime_error("Cannot receive on closed socket");
     }
 
-    // Read 4-byte length header
-    unsigned char header[4];
-    ssize_t total = 0;
-    while (total < 4) {
-        ssize_t n = ::read(fd_, header + total, 4 - static_cast<size_t>(total));
-        if (n <= 0) {
-            throw std::runtime_error("Connection closed while reading header");
-        }
-        total += n;
-    }
-
-    uint32_t len = (static_cast<uint32_t>(header[0]) << 24) |
-                   (static_cast<uint32_t>(header[1]) << 16) |
-                   (static_cast<uint32_t>(header[2]) << 8)  |
-                   (static_cast<uint32_t>(header[3]));
-
+    uint32_t len = receive_length();
     if (len == 0) return "";
-    if (len > 10 * 1024 * 1024) {  // 10 MB safety limit
+    if (len > MAX_JSON_FRAME) {
         throw std::runtime_error("Message too large: " + std::to_string(len) + " bytes");
     }
 
-    // Read payload
     std::string data(len, '\0');
-    total = 0;
-    ssize_t payload_len = static_cast<ssize_t>(len);
-    while (total < payload_len) {
-        ssize_t n = ::read(fd_, &data[static_cast<size_t>(total)],
-                           static_cast<size_t>(payload_len - total));
-        if (n <= 0) {
-            throw std::runtime_error("Connection closed while reading payload");
-        }
-        total += n;
-    }
-
+    read_exact(&data[0], len, "payload");
     return data;
 }
 
@@ -391,10 +928,11 @@ std::string IPCSocket::receive_raw() {
 // JSON serialization (no external library)
 // ---------------------------------------------------------------------------
 
-std::string IPCSocket::serialize_message(const IPCMessage& msg) {
+std::string IPCSocket::serialize_message(const IPCMessage& msg, const TraceContext& trace) {
     std::ostringstream oss;
-    oss << "{\"type\":\"" << message_type_to_string(msg.type) << "\""
-        << ",\"payload\":\"" << json_escape(msg.payload) << "\""
+    oss << "{\"type\":\"" << message_type_to_string(msg.type) << "\"";
+    if (trace.valid()) oss << ",\"trace\":\"" << trace.to_string() << "\"";
+    oss << ",\"payload\":\"" << json_escape(msg.payload) << "\""
         << ",\"timestamp\":" << std::to_string(msg.timestamp)
         << "}";
     return oss.str();
@@ -404,6 +942,7 @@ IPCMessage IPCSocket::deserialize_message(const std::string& json) {
     IPCMessage msg;
     msg.type = string_to_message_type(json_get_string(json, "type"));
     msg.payload = json_get_string(json, "payload");
+    msg.trace = TraceContext::parse(json_get_string(json, "trace"));
     msg.timestamp = json_get_number(json, "timestamp");
     return msg;
 }
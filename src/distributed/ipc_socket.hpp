@@ -1,8 +1,15 @@
 #ifndef SIM_IPC_SOCKET_HPP
 #define SIM_IPC_SOCKET_HPP
 
+#include "distributed/tracing.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
+
+struct iovec;
+struct ssl_st;
 
 namespace sim { namespace distributed {
 
@@ -14,19 +21,91 @@ enum class MessageType {
     READY,          // worker -> coordinator
     STEP_COMPLETE,  // worker -> coordinator
     SYNC_RESPONSE,  // worker -> coordinator
-    ERROR           // worker -> coordinator
+    ERROR,          // worker -> coordinator
+    MIGRATE_OUT,    // coordinator -> worker: release entities
+    MIGRATE_STATE,  // worker -> coordinator: full state of the released entities
+    MIGRATE_IN,     // coordinator -> worker: adopt entities (MIGRATE_STATE payload)
+    GHOSTS          // coordinator -> worker: read-only neighbor states (state frame)
+};
+
+/**
+ * Binary state frames: bulk entity state without JSON text.
+ *
+ * Same length-prefixed framing as JSON messages; the payload is a
+ * StateHeader followed by count StateRecords, host byte order (nodes of
+ * one deployment are assumed to share endianness). The magic cannot
+ * begin a JSON message, so receive() tells the two apart from the first
+ * bytes.
+ */
+namespace wire {
+
+constexpr char STATE_MAGIC[4] = {'S', 'V', 'B', '1'};
+constexpr uint32_t MAX_STATE_FRAME = 1u << 30;   // 16M records
+
+#pragma pack(push, 1)
+struct StateHeader {
+    char     magic[4];
+    uint32_t type;           // MessageType
+    double   timestamp;
+    uint32_t count;          // Records that follow
+    uint32_t record_bytes;   // sizeof(StateRecord)
 };
 
+struct StateRecord {
+    int32_t  entity_id;
+    uint32_t reserved;       // Flags (RECORD_LEAVING, RECORD_REMOVED)
+    double   state[6];       // px py pz [m], vx vy vz [m/s]
+    double   time;           // [s]
+};
+#pragma pack(pop)
+
+/// StateRecord::reserved flag: the entity left the sender's region
+constexpr uint32_t RECORD_LEAVING = 1;
+
+/// StateRecord::reserved flag (delta sync): the entity left the subscriber's interest set
+constexpr uint32_t RECORD_REMOVED = 2;
+
+static_assert(sizeof(StateHeader) == 24, "state frame header layout");
+static_assert(sizeof(StateRecord) == 64, "state record layout");
+
+} // namespace wire
+
 struct IPCMessage {
     MessageType type;
     std::string payload;   // JSON string
     double timestamp;
+    std::vector<wire::StateRecord> states;   // Binary state frames only
+    TraceContext trace;    // Received: the sender's span (JSON messages, when tracing)
 
     IPCMessage() : type(MessageType::ERROR), timestamp(0.0) {}
     IPCMessage(MessageType t, const std::string& p, double ts)
         : type(t), payload(p), timestamp(ts) {}
 };
 
+/**
+ * TLS settings for "tls://" addresses. Defaults come from the environment
+ * (SIM_TLS_CERT, SIM_TLS_KEY, SIM_TLS_CA; SIM_TLS_VERIFY=0 to skip
+ * verification), so deployments switch to TLS by address alone. A listener needs cert_file and key_file; a client
+ * verifies the server against ca_file (or the system store) unless
+ * verify_peer is false.
+ */
+struct TlsConfig {
+    std::string cert_file;
+    std::string key_file;
+    std::string ca_file;
+    bool verify_peer = true;
+
+    static TlsConfig from_environment();
+};
+
+/**
+ * Transport for one coordinator/worker connection.
+ *
+ * Addresses select the transport:
+ *   "/tmp/sim.sock"          Unix domain socket (same host)
+ *   "tcp://host:port"        TCP with TCP_NODELAY ("tcp://:port" listens on all interfaces)
+ *   "tls://host:port"        TCP wrapped in TLS (needs a build with OpenSSL)
+ */
 class IPCSocket {
 public:
     IPCSocket();
@@ -38,21 +117,40 @@ public:
     IPCSocket(const IPCSocket&) = delete;
     IPCSocket& operator=(const IPCSocket&) = delete;
 
-    /// Create a listening server socket at the given Unix domain path
+    /// Create a listening server socket at the given address
     static IPCSocket listen(const std::string& socket_path);
 
-    /// Connect to a listening server at the given Unix domain path
+    /// Connect to a listening server at the given address
     static IPCSocket connect(const std::string& socket_path);
 
     /// Accept an incoming connection (blocking)
     IPCSocket accept();
 
-    /// Send a message (length-prefixed JSON frame)
+    /// Accept with timeout; false if no connection arrived in time
+    bool accept(IPCSocket& out, int timeout_ms);
+
+    /// TLS settings used by later listen()/connect() calls on tls:// addresses
+    static void set_tls_config(const TlsConfig& config);
+
+    /// Whether the connection runs over TCP (tcp:// or tls://)
+    bool is_tcp() const { return tcp_; }
+
+    /// Send a message (length-prefixed JSON frame); carries the trace
+    /// context of the "ipc.send" span when tracing is on
     bool send(const IPCMessage& msg);
 
-    /// Receive a message (blocking)
+    /// Send a binary state frame: header and records in one writev, no copy
+    bool send_states(MessageType type, double timestamp,
+                     const wire::StateRecord* records, size_t count);
+
+    /// Receive a message (blocking); state frames arrive in msg.states
     IPCMessage receive();
 
+    /// Read whatever bytes are ready without blocking; true once a whole
+    /// message is assembled into out. Partial frames are kept for the next
+    /// call. Throws on disconnect or a malformed frame.
+    bool receive_ready(IPCMessage& out);
+
     /// Receive with timeout; returns {true, msg} on success, {false, {}} on timeout
     std::pair<bool, IPCMessage> receive_timeout(int timeout_ms);
 
@@ -62,16 +160,59 @@ public:
     /// Check if the socket is connected
     bool is_connected() const;
 
+    /// True once the peer has hung up (non-blocking check, consumes nothing)
+    bool peer_closed() const;
+
+    /// Underlying descriptor, for registering with poll/epoll (-1 if closed)
+    int native_handle() const { return fd_; }
+
+    /// Send one raw frame (length-prefixed, payload sent as-is)
+    bool send_frame(const std::string& data) { return send_raw(data); }
+
+    /// Receive one raw frame (blocking); throws on disconnect
+    std::string receive_frame() { return receive_raw(); }
+
+    /// Unframed bytes, for protocols layered on the stream (WebSocket).
+    /// read_bytes() never blocks: -1 with EAGAIN when nothing is ready,
+    /// 0 once the peer has hung up. write_bytes() blocks until all is sent.
+    long read_bytes(void* dst, size_t bytes) { return read_some(dst, bytes); }
+    bool write_bytes(const void* data, size_t bytes);
+
 private:
     int fd_ = -1;
     bool is_server_ = false;
+    bool tcp_ = false;
+    bool tls_ = false;                // Listener: wrap accepted connections
+    ssl_st* ssl_ = nullptr;           // Connected TLS session
     std::string socket_path_;
 
-    // Frame protocol: [4-byte big-endian length][JSON payload]
+    // Incoming frame being assembled by receive_ready()
+    struct RxState {
+        enum Stage { LENGTH, HEADER, STATES, TEXT } stage = LENGTH;
+        size_t got = 0;                 // Bytes of the current part read so far
+        uint32_t len = 0;
+        unsigned char prefix[4];
+        wire::StateHeader header;
+        IPCMessage msg;                 // STATES: records read in place
+        std::string text;               // TEXT: JSON message
+        int64_t start_ns = 0;           // Length prefix complete (tracing)
+    };
+    RxState rx_;
+
+    bool fill(void* dst, size_t bytes);
+
+    // Byte I/O shared by every transport (TLS or plain)
+    long read_some(void* dst, size_t bytes);           // -1 + EAGAIN when nothing is ready
+    bool write_all(struct iovec* iov, int count);      // Blocking; advances iov
+    void read_exact(void* dst, size_t bytes, const char* what);
+    void wait_io(bool for_write);
+
+        // Frame protocol: [4-byte big-endian length][JSON or state payload]
     bool send_raw(const std::string& data);
     std::string receive_raw();
+    uint32_t receive_length();
 
-    static std::string serialize_message(const IPCMessage& msg);
+    static std::string serialize_message(const IPCMessage& msg, const TraceContext& trace);
     static IPCMessage deserialize_message(const std::string& json);
 };
 
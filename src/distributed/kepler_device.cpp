@@ -0,0 +1,11 @@
+#include "distributed/kepler_device.hpp"
+
+namespace sim { namespace distributed {
+
+// CPU-only build: no GPU backend
+std::unique_ptr<KeplerDevice> KeplerDevice::create(double mu) {
+    (void)mu;
+    return nullptr;
+}
+
+}} // namespace sim::distributed
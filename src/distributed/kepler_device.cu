@@ -0,0 +1,136 @@
+#include "distributed/kepler_device.hpp"
+#include "physics/kepler_fg.hpp"
+
+#include <cuda_runtime.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace sim { namespace distributed {
+
+namespace {
+
+void check(cudaError_t err, const char* what) {
+    if (err != cudaSuccess) {
+        throw std::runtime_error(std::string("CUDA ") + what + ": " + cudaGetErrorString(err));
+    }
+}
+
+constexpr int THREADS = 128;
+constexpr int COMPONENTS = 6;   // x y z vx vy vz, each a run of n doubles
+
+__global__ void kepler_step(double* state, size_t n, double dt, double mu, uint8_t* ok) {
+    const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if (i >= n) return;
+    double r[3] = {state[i], state[n + i], state[2 * n + i]};
+    double v[3] = {state[3 * n + i], state[4 * n + i], state[5 * n + i]};
+    ok[i] = kepler_fg_inplace(r, v, dt, mu) ? 1 : 0;
+    if (!ok[i]) return;
+    for (int j = 0; j < 3; j++) {
+        state[j * n + i] = r[j];
+        state[(3 + j) * n + i] = v[j];
+    }
+}
+
+class CudaKeplerDevice : public KeplerDevice {
+public:
+    explicit CudaKeplerDevice(double mu) : mu_(mu) {}
+
+    void init() { check(cudaStreamCreate(&stream_), "stream"); }
+
+    ~CudaKeplerDevice() override {
+        cudaFree(state_);
+        cudaFree(ok_);
+        cudaFreeHost(host_);
+        cudaFreeHost(host_ok_);
+        if (stream_) cudaStreamDestroy(stream_);
+    }
+
+    void advance(const EntityBlock& b, double dt, std::vector<size_t>& unbound) override {
+        unbound.clear();
+        const size_t n = b.size;
+        if (n == 0) return;
+        double* host[COMPONENTS] = {b.x, b.y, b.z, b.vx, b.vy, b.vz};
+
+        // Resident state is reused unless the block is not what we left it as
+        bool upload = reserve(n) || n != size_ ||
+                      !std::equal(b.ids, b.ids + n, ids_.begin());
+        for (int c = 0; c < COMPONENTS && !upload; c++) {
+            upload = std::memcmp(host[c], host_ + c * n, n * sizeof(double)) != 0;
+        }
+        if (upload) {
+            for (int c = 0; c < COMPONENTS; c++) {
+                std::memcpy(host_ + c * n, host[c], n * sizeof(double));
+            }
+            check(cudaMemcpyAsync(state_, host_, COMPONENTS * n * sizeof(double),
+                                  cudaMemcpyHostToDevice, stream_), "upload");
+            ids_.assign(b.ids, b.ids + n);
+            size_ = n;
+        }
+
+        const unsigned blocks = static_cast<unsigned>((n + THREADS - 1) / THREADS);
+        kepler_step<<<blocks, THREADS, 0, stream_>>>(state_, n, dt, mu_, ok_);
+        check(cudaGetLastError(), "launch");
+        check(cudaMemcpyAsync(host_, state_, COMPONENTS * n * sizeof(double),
+                              cudaMemcpyDeviceToHost, stream_), "download");
+        check(cudaMemcpyAsync(host_ok_, ok_, n, cudaMemcpyDeviceToHost, stream_), "download");
+        check(cudaStreamSynchronize(stream_), "sync");
+
+        for (int c = 0; c < COMPONENTS; c++) {
+            std::memcpy(host[c], host_ + c * n, n * sizeof(double));
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!host_ok_[i]) unbound.push_back(i);
+        }
+        // The caller's fallback changes those entities: upload next step
+        if (!unbound.empty()) size_ = 0;
+    }
+
+private:
+    /** Grow device and staging buffers to n entities; true if reallocated */
+    bool reserve(size_t n) {
+        if (n <= capacity_) return false;
+        cudaFree(state_);
+        cudaFree(ok_);
+        cudaFreeHost(host_);
+        cudaFreeHost(host_ok_);
+        state_ = nullptr;
+        ok_ = host_ok_ = nullptr;
+        host_ = nullptr;
+        capacity_ = 0;
+        check(cudaMalloc(&state_, COMPONENTS * n * sizeof(double)), "malloc");
+        check(cudaMalloc(&ok_, n), "malloc");
+        check(cudaMallocHost(&host_, COMPONENTS * n * sizeof(double)), "host malloc");
+        check(cudaMallocHost(&host_ok_, n), "host malloc");
+        capacity_ = n;
+        return true;
+    }
+
+    double mu_;
+    cudaStream_t stream_ = nullptr;
+    double* state_ = nullptr;       // Device: COMPONENTS runs of n
+    uint8_t* ok_ = nullptr;
+    double* host_ = nullptr;        // Pinned copy of the last download
+    uint8_t* host_ok_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;               // Entities resident (0 = nothing valid)
+    std::vector<int> ids_;
+};
+
+} // namespace
+
+std::unique_ptr<KeplerDevice> KeplerDevice::create(double mu) {
+    try {
+        auto device = std::make_unique<CudaKeplerDevice>(mu);
+        device->init();
+        return device;
+    } catch (const std::exception& e) {
+        std::cerr << "[GPU] Kepler batch on CPU: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+}} // namespace sim::distributed
@@ -0,0 +1,39 @@
+#ifndef SIM_KEPLER_DEVICE_HPP
+#define SIM_KEPLER_DEVICE_HPP
+
+#include "distributed/batch_propagator.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim { namespace distributed {
+
+/**
+ * @brief Two-body f and g propagation of a whole EntityBlock on a GPU
+ *
+ * Positions and velocities stay resident in device memory between steps.
+ * A step uploads the block only when the host arrays differ from what the
+ * previous step downloaded (a new assignment, a migration, a restored
+ * state), runs kepler_fg_inplace() (physics/kepler_fg.hpp) one thread per
+ * entity, and downloads the new states with a flag per entity. Entities
+ * on non-elliptical orbits come back untouched and flagged, for the
+ * caller's CPU fallback.
+ *
+ * create() returns null when no GPU backend is built (see utils/gpu.hpp)
+ * or the device cannot be set up.
+ */
+class KeplerDevice {
+public:
+    static std::unique_ptr<KeplerDevice> create(double mu);
+
+    virtual ~KeplerDevice() = default;
+
+    /**
+     * Advance every entity of the block by dt
+     * @param unbound Set to the indices the kernel could not advance
+     */
+    virtual void advance(const EntityBlock& block, double dt, std::vector<size_t>& unbound) = 0;
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_KEPLER_DEVICE_HPP
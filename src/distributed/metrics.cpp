@@ -0,0 +1,267 @@
+#include "distributed/metrics.hpp"
+
+#include <malloc.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace sim { namespace distributed {
+
+// ---------------------------------------------------------------------------
+// Thread shards
+// ---------------------------------------------------------------------------
+
+/** Hands the calling thread's shard back to the registry at thread exit. */
+struct ShardOwner {
+    MetricsRegistry::Shard* shard = nullptr;
+    ~ShardOwner() {
+        if (!shard) return;
+        MetricsRegistry::tls_shard_ = nullptr;
+        MetricsRegistry::global().retire(shard);
+    }
+};
+
+namespace {
+
+thread_local ShardOwner shard_owner;
+
+/** Heap in use (malloc arenas and mmapped blocks) and resident set size. */
+void write_process_metrics(std::ostream& out) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = ::mallinfo2();
+    out << "# HELP process_heap_bytes Bytes allocated from the heap and not yet freed\n"
+        << "# TYPE process_heap_bytes gauge\n"
+        << "process_heap_bytes " << mi.uordblks + mi.hblkhd << "\n";
+#endif
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    if (statm >> pages >> resident) {
+        out << "# HELP process_resident_memory_bytes Resident memory size in bytes\n"
+            << "# TYPE process_resident_memory_bytes gauge\n"
+            << "process_resident_memory_bytes " << resident * ::sysconf(_SC_PAGESIZE) << "\n";
+    }
+}
+
+} // namespace
+
+MetricsRegistry& MetricsRegistry::global() {
+    // Never destroyed: threads may still retire shards during exit
+    static MetricsRegistry* registry = [] {
+        auto* r = new MetricsRegistry();
+        r->collectors_.push_back(write_process_metrics);
+        return r;
+    }();
+    return *registry;
+}
+
+MetricsRegistry::Shard& MetricsRegistry::attach() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Shard* s;
+    if (!free_.empty()) {
+        s = free_.back();
+        free_.pop_back();
+    } else {
+        shards_.push_back(std::make_unique<Shard>());
+        s = shards_.back().get();
+    }
+    live_.push_back(s);
+    tls_shard_ = s;
+    shard_owner.shard = s;
+    return *s;
+}
+
+void MetricsRegistry::retire(Shard* shard) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t k = 0; k < MAX_SLOTS; k++) {
+        retired_[k] += shard->v[k].load(std::memory_order_relaxed);
+        shard->v[k].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < live_.size(); i++) {
+        if (live_[i] != shard) continue;
+        live_[i] = live_.back();
+        live_.pop_back();
+        break;
+    }
+    free_.push_back(shard);
+}
+
+uint64_t MetricsRegistry::sum_locked(uint32_t slot) const {
+    uint64_t v = retired_[slot];
+    for (const Shard* s : live_) v += s->v[slot].load(std::memory_order_relaxed);
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Registration
+// ---------------------------------------------------------------------------
+
+uint32_t MetricsRegistry::reserve_slots(uint32_t n) {
+    if (next_slot_ + n > MAX_SLOTS) {
+        throw std::runtime_error("MetricsRegistry: out of metric slots");
+    }
+    uint32_t first = next_slot_;
+    next_slot_ += n;
+    return first;
+}
+
+Counter MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                 const std::string& labels, double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Metric m{Kind::COUNTER, name, help, labels, scale};
+    m.slot = reserve_slots(1);
+    metrics_.push_back(m);
+    return Counter(m.slot);
+}
+
+Gauge MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (next_gauge_ >= MAX_GAUGES) {
+        throw std::runtime_error("MetricsRegistry: out of gauges");
+    }
+    Metric m{Kind::GAUGE, name, help, ""};
+    m.slot = next_gauge_++;
+    metrics_.push_back(m);
+    return Gauge(&gauges_[m.slot]);
+}
+
+Histogram MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                     uint64_t first_bound, uint32_t buckets, double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Metric m{Kind::HISTOGRAM, name, help, "", scale};
+    m.first_bound = std::max<uint64_t>(first_bound, 1);
+    m.buckets = std::max<uint32_t>(buckets, 1);
+    m.slot = reserve_slots(m.buckets + 2);      // buckets, overflow, sum
+    metrics_.push_back(m);
+    return Histogram(m.slot, m.first_bound, m.buckets);
+}
+
+void MetricsRegistry::add_collector(Collector c) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectors_.push_back(std::move(c));
+}
+
+uint64_t MetricsRegistry::value(Counter c) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sum_locked(c.slot_);
+}
+
+// ---------------------------------------------------------------------------
+// Exposition
+// ---------------------------------------------------------------------------
+
+void MetricsRegistry::write_prometheus(std::ostream& out) const {
+    out.precision(15);
+    std::vector<Collector> collectors;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string last_name;
+        for (const Metric& m : metrics_) {
+            if (m.name != last_name) {
+                static const char* TYPES[] = {"counter", "gauge", "histogram"};
+                out << "# HELP " << m.name << " " << m.help << "\n"
+                    << "# TYPE " << m.name << " " << TYPES[static_cast<int>(m.kind)] << "\n";
+                last_name = m.name;
+            }
+            const std::string labels = m.labels.empty() ? "" : "{" + m.labels + "}";
+            switch (m.kind) {
+                case Kind::COUNTER:
+                    out << m.name << labels << " " << sum_locked(m.slot) / m.scale << "\n";
+                    break;
+                case Kind::GAUGE:
+                    out << m.name << " " << gauges_[m.slot].load(std::memory_order_relaxed) << "\n";
+                    break;
+                case Kind::HISTOGRAM: {
+                    uint64_t cumulative = 0;
+                    uint64_t bound = m.first_bound;
+                    for (uint32_t k = 0; k < m.buckets; k++, bound *= 2) {
+                        cumulative += sum_locked(m.slot + k);
+                        out << m.name << "_bucket{le=\"" << bound / m.scale << "\"} "
+                            << cumulative << "\n";
+                    }
+                    cumulative += sum_locked(m.slot + m.buckets);
+                    out << m.name << "_bucket{le=\"+Inf\"} " << cumulative << "\n"
+                        << m.name << "_sum " << sum_locked(m.slot + m.buckets + 1) / m.scale << "\n"
+                        << m.name << "_count " << cumulative << "\n";
+                    break;
+                }
+            }
+        }
+        collectors = collectors_;
+    }
+    // Outside the lock: a collector may read other locked state
+    for (const Collector& c : collectors) c(out);
+}
+
+// ---------------------------------------------------------------------------
+// HTTP endpoint
+// ---------------------------------------------------------------------------
+
+MetricsServer::MetricsServer(MetricsRegistry& registry, const std::string& address)
+    : registry_(registry) {
+    if (address.rfind("tls://", 0) == 0) {
+        throw std::runtime_error("Metrics endpoint is plain HTTP; use tcp:// or a socket path");
+    }
+    listener_ = IPCSocket::listen(address);
+    thread_ = std::thread([this] { serve(); });
+}
+
+MetricsServer::~MetricsServer() {
+    stop_.store(true);
+    if (thread_.joinable()) thread_.join();
+}
+
+void MetricsServer::serve() {
+    while (!stop_.load()) {
+        IPCSocket conn;
+        try {
+            if (!listener_.accept(conn, 200)) continue;
+        } catch (const std::exception&) {
+            continue;
+        }
+        answer(conn.native_handle());
+    }
+}
+
+void MetricsServer::answer(int fd) {
+    // Read the request head (the path is not checked: every GET gets the page)
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        struct pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 1000) <= 0) return;
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    std::ostringstream body;
+    std::string status = "200 OK";
+    if (request.rfind("GET ", 0) == 0) {
+        registry_.write_prometheus(body);
+    } else {
+        status = "405 Method Not Allowed";
+    }
+    const std::string text = body.str();
+    std::ostringstream head;
+    head << "HTTP/1.1 " << status << "\r\n"
+         << "Content-Type: text/plain; version=0.0.4\r\n"
+         << "Content-Length: " << text.size() << "\r\n"
+         << "Connection: close\r\n\r\n";
+    const std::string reply = head.str() + text;
+
+    size_t sent = 0;
+    while (sent < reply.size()) {
+        ssize_t n = ::send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+}} // namespace sim::distributed
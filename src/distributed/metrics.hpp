@@ -0,0 +1,218 @@
+/**
+ * Metrics — Process-wide counters, gauges and histograms with a
+ * Prometheus text endpoint, for long-running mc_engine modes and the
+ * distributed coordinator.
+ *
+ * Counters and histograms are sharded per thread: each thread that
+ * records gets its own cache-line-aligned slot array on first use, and
+ * an update is a relaxed load and store to a slot only that thread
+ * writes — no atomic read-modify-write, no shared cache line. A scrape
+ * sums the live shards plus the totals of threads that have exited
+ * (their shard is folded in and recycled at thread exit). Gauges are one
+ * relaxed atomic each; they are set, not summed.
+ *
+ * Metrics are registered once (a mutex, at startup) and return a small
+ * handle to keep in a static. Histograms use power-of-two buckets over a
+ * raw integer unit (ns, bytes) and are exposed divided by a scale (1e9
+ * for seconds). Collectors add exposition text computed at scrape time
+ * for values that already live elsewhere (per-system tick time from a
+ * TickProfiler, heap size).
+ *
+ * MetricsServer answers plain HTTP GETs with the exposition format
+ * (text/plain; version=0.0.4) on a tcp:// address or Unix socket path
+ * (curl --unix-socket), one connection at a time on its own thread.
+ */
+
+#ifndef SIM_METRICS_HPP
+#define SIM_METRICS_HPP
+
+#include "distributed/ipc_socket.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim { namespace distributed {
+
+class MetricsRegistry;
+
+/** Monotonic counter handle (sharded per thread). */
+class Counter {
+public:
+    Counter() = default;
+    inline void add(uint64_t n = 1) const;
+
+private:
+    friend class MetricsRegistry;
+    explicit Counter(uint32_t slot) : slot_(slot) {}
+    uint32_t slot_ = 0;
+};
+
+/** Gauge handle: one shared value, set or adjusted. */
+class Gauge {
+public:
+    Gauge() = default;
+    void set(int64_t v) const { if (value_) value_->store(v, std::memory_order_relaxed); }
+    void add(int64_t d) const { if (value_) value_->fetch_add(d, std::memory_order_relaxed); }
+
+private:
+    friend class MetricsRegistry;
+    explicit Gauge(std::atomic<int64_t>* value) : value_(value) {}
+    std::atomic<int64_t>* value_ = nullptr;
+};
+
+/**
+ * Histogram handle. Bucket k holds values <= first_bound * 2^k (raw
+ * units); one more slot holds the overflow and one the raw sum.
+ */
+class Histogram {
+public:
+    Histogram() = default;
+    inline void observe(uint64_t raw) const;
+
+private:
+    friend class MetricsRegistry;
+    Histogram(uint32_t slot, uint64_t first_bound, uint32_t buckets)
+        : slot_(slot), first_bound_(first_bound), buckets_(buckets) {}
+    uint32_t slot_ = 0;
+    uint64_t first_bound_ = 1;
+    uint32_t buckets_ = 0;
+};
+
+class MetricsRegistry {
+public:
+    static constexpr size_t MAX_SLOTS = 1024;    // counter + histogram slots
+    static constexpr size_t MAX_GAUGES = 64;
+
+    /** Writes extra exposition text at scrape time. */
+    using Collector = std::function<void(std::ostream& out)>;
+
+    /** The process-wide registry. */
+    static MetricsRegistry& global();
+
+    /**
+     * Register a counter. `labels` is the Prometheus label set without
+     * braces (e.g. "system=\"Kepler\""); series sharing a name share one
+     * HELP/TYPE header. Exposed as value / scale.
+     * @throws std::runtime_error when the slots are exhausted
+     */
+    Counter counter(const std::string& name, const std::string& help,
+                    const std::string& labels = "", double scale = 1.0);
+
+    Gauge gauge(const std::string& name, const std::string& help);
+
+    Histogram histogram(const std::string& name, const std::string& help,
+                        uint64_t first_bound, uint32_t buckets, double scale = 1.0);
+
+    void add_collector(Collector c);
+
+    /** Prometheus text exposition of every metric and collector. */
+    void write_prometheus(std::ostream& out) const;
+
+    /** Current value of a counter over all threads (raw units). */
+    uint64_t value(Counter c) const;
+
+    /** Per-thread slot array; public for the inline handle updates. */
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, MAX_SLOTS> v{};
+    };
+
+    /** The calling thread's shard, created on first use. */
+    static Shard& local() {
+        Shard* s = tls_shard_;
+        return s ? *s : global().attach();
+    }
+
+    /** Single-writer add to a slot of the calling thread's shard. */
+    static void bump(uint32_t slot, uint64_t n) {
+        std::atomic<uint64_t>& a = local().v[slot];
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+private:
+    enum class Kind : uint8_t { COUNTER, GAUGE, HISTOGRAM };
+
+    struct Metric {
+        Kind kind;
+        std::string name;
+        std::string help;
+        std::string labels;
+        double scale = 1.0;
+        uint32_t slot = 0;              // counter, histogram: first slot; gauge: index
+        uint64_t first_bound = 1;       // histogram
+        uint32_t buckets = 0;           // histogram
+    };
+
+    MetricsRegistry() = default;
+
+    /** Create (or recycle) the calling thread's shard. */
+    Shard& attach();
+    /** Fold a finished thread's shard into retired_ and recycle it. */
+    void retire(Shard* shard);
+    /** Sum of a slot over live shards and retired threads; mutex_ held. */
+    uint64_t sum_locked(uint32_t slot) const;
+    uint32_t reserve_slots(uint32_t n);
+
+    friend struct ShardOwner;
+    static inline thread_local Shard* tls_shard_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::vector<Metric> metrics_;
+    std::vector<Collector> collectors_;
+    uint32_t next_slot_ = 0;
+    std::array<std::atomic<int64_t>, MAX_GAUGES> gauges_{};
+    uint32_t next_gauge_ = 0;
+
+    std::vector<std::unique_ptr<Shard>> shards_;    // every shard ever made
+    std::vector<Shard*> live_;
+    std::vector<Shard*> free_;
+    std::array<uint64_t, MAX_SLOTS> retired_{};
+};
+
+inline void Counter::add(uint64_t n) const { MetricsRegistry::bump(slot_, n); }
+
+inline void Histogram::observe(uint64_t raw) const {
+    if (buckets_ == 0) return;
+    uint32_t k = 0;
+    const uint64_t q = raw / first_bound_ + (raw % first_bound_ != 0);
+    if (q > 1) k = static_cast<uint32_t>(64 - __builtin_clzll(q - 1));
+    if (k > buckets_) k = buckets_;                 // overflow slot
+    MetricsRegistry::bump(slot_ + k, 1);
+    MetricsRegistry::bump(slot_ + buckets_ + 1, raw);
+}
+
+/**
+ * Prometheus endpoint for a registry, served on a background thread.
+ */
+class MetricsServer {
+public:
+    /**
+     * Listen on `address` ("tcp://host:port", "tcp://:port" or a Unix
+     * socket path) and start serving.
+     * @throws std::runtime_error if the address cannot be bound or is tls://
+     */
+    MetricsServer(MetricsRegistry& registry, const std::string& address);
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+private:
+    MetricsRegistry& registry_;
+    IPCSocket listener_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+    void serve();
+    void answer(int fd);
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_METRICS_HPP
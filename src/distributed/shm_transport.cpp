@@ -0,0 +1,288 @@
+#include "distributed/shm_transport.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+namespace sim { namespace distributed {
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static constexpr size_t HEADER_BYTES = 64;   // RegionHeader, padded to a cache line
+static constexpr int SEND_TIMEOUT_MS = 5000;
+
+static_assert(sizeof(shm::RegionHeader) <= HEADER_BYTES, "shm region header");
+
+static size_t round_up_64(size_t n) {
+    return (n + 63) & ~static_cast<size_t>(63);
+}
+
+/// Spins before sleeping; none on a single core, where spinning only delays the peer
+static int spin_limit() {
+    static const int limit = std::thread::hardware_concurrency() > 1 ? 20000 : 0;
+    return limit;
+}
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Process-shared futex on a ring index (not FUTEX_PRIVATE: the peer may be another process)
+static void futex_wait(std::atomic<uint32_t>* word, uint32_t expected, const struct timespec* timeout) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, timeout,
+              nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+// ---------------------------------------------------------------------------
+// ShmChannel
+// ---------------------------------------------------------------------------
+
+ShmChannel::ShmChannel(shm::SlotHeader* slot, wire::StateRecord* states, size_t capacity,
+                       bool coordinator_side)
+    : slot_(slot),
+      out_(coordinator_side ? &slot->to_worker : &slot->to_coordinator),
+      in_(coordinator_side ? &slot->to_coordinator : &slot->to_worker),
+      states_(states),
+      capacity_(capacity)
+{
+}
+
+bool ShmChannel::send(const shm::Command& cmd) {
+    if (!out_) return false;
+
+    uint32_t head = out_->head.load(std::memory_order_relaxed);
+    if (head - out_->tail.load(std::memory_order_acquire) >= shm::RING_SIZE) {
+        // Full: the peer is behind by a whole ring (lockstep traffic never gets here)
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(SEND_TIMEOUT_MS);
+        while (head - out_->tail.load(std::memory_order_acquire) >= shm::RING_SIZE) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::yield();
+        }
+    }
+
+    out_->slots[head & (shm::RING_SIZE - 1)] = cmd;
+    out_->head.store(head + 1, std::memory_order_seq_cst);
+    if (out_->waiting.load(std::memory_order_seq_cst)) {
+        futex_wake(&out_->head);
+    }
+    return true;
+}
+
+bool ShmChannel::receive(shm::Command& cmd, int timeout_ms) {
+    if (!in_) return false;
+
+    uint32_t tail = in_->tail.load(std::memory_order_relaxed);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    int spins = 0;
+
+    for (;;) {
+        if (in_->head.load(std::memory_order_acquire) != tail) {
+            cmd = in_->slots[tail & (shm::RING_SIZE - 1)];
+            in_->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        if (timeout_ms != 0 && spins < spin_limit()) {
+            ++spins;
+            cpu_relax();
+            continue;
+        }
+
+        // Flag before the final check: a producer that misses the flag
+        // published its command before this load, so it is seen here.
+        in_->waiting.store(1, std::memory_order_seq_cst);
+        if (in_->head.load(std::memory_order_seq_cst) != tail) {
+            in_->waiting.store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        struct timespec ts;
+        const struct timespec* timeout = nullptr;
+        if (timeout_ms >= 0) {
+            auto left = deadline - std::chrono::steady_clock::now();
+            if (left <= std::chrono::steady_clock::duration::zero()) {
+                in_->waiting.store(0, std::memory_order_relaxed);
+                return false;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(left).count();
+            ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+            ts.tv_nsec = static_cast<long>(ns % 1000000000);
+            timeout = &ts;
+        }
+        futex_wait(&in_->head, tail, timeout);
+        in_->waiting.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ShmRegion
+// ---------------------------------------------------------------------------
+
+ShmRegion::~ShmRegion() {
+    close();
+}
+
+ShmRegion::ShmRegion(ShmRegion&& other) noexcept
+    : base_(other.base_), bytes_(other.bytes_), name_(std::move(other.name_)),
+      owner_(other.owner_)
+{
+    other.base_ = nullptr;
+    other.bytes_ = 0;
+    other.owner_ = false;
+}
+
+ShmRegion& ShmRegion::operator=(ShmRegion&& other) noexcept {
+    if (this != &other) {
+        close();
+        base_ = other.base_;
+        bytes_ = other.bytes_;
+        name_ = std::move(other.name_);
+        owner_ = other.owner_;
+        other.base_ = nullptr;
+        other.bytes_ = 0;
+        other.owner_ = false;
+    }
+    return *this;
+}
+
+ShmRegion ShmRegion::create(const std::string& name, int num_workers, size_t capacity) {
+    if (num_workers <= 0) {
+        throw std::runtime_error("Shared-memory region needs at least one worker");
+    }
+
+    // Remove a stale region left by a crashed coordinator
+    ::shm_unlink(name.c_str());
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared memory " + name + ": " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    size_t slot_bytes = round_up_64(sizeof(shm::SlotHeader) + capacity * sizeof(wire::StateRecord));
+    size_t total = HEADER_BYTES + static_cast<size_t>(num_workers) * slot_bytes;
+
+    if (::ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to size shared memory " + name + ": " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    void* base = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to map shared memory " + name + ": " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    char* p = static_cast<char*>(base);
+    for (int w = 0; w < num_workers; ++w) {
+        new (p + HEADER_BYTES + static_cast<size_t>(w) * slot_bytes) shm::SlotHeader();
+    }
+
+    // Header last: a worker that validates it sees initialized rings
+    auto* header = reinterpret_cast<shm::RegionHeader*>(p);
+    header->version = shm::VERSION;
+    header->num_workers = static_cast<uint32_t>(num_workers);
+    header->capacity = static_cast<uint32_t>(capacity);
+    header->slot_bytes = slot_bytes;
+    header->total_bytes = total;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shm::MAGIC;
+
+    ShmRegion region;
+    region.base_ = base;
+    region.bytes_ = total;
+    region.name_ = name;
+    region.owner_ = true;
+    return region;
+}
+
+ShmRegion ShmRegion::attach(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open shared memory " + name + ": " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory " + name + " is not a state region");
+    }
+    size_t total = static_cast<size_t>(st.st_size);
+
+    void* base = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared memory " + name + ": " +
+                                 std::string(std::strerror(errno)));
+    }
+
+    ShmRegion region;
+    region.base_ = base;
+    region.bytes_ = total;
+    region.name_ = name;
+
+    const auto* header = static_cast<const shm::RegionHeader*>(base);
+    if (header->magic != shm::MAGIC || header->version != shm::VERSION ||
+        header->total_bytes != total ||
+        HEADER_BYTES + header->num_workers * header->slot_bytes != total) {
+        throw std::runtime_error("Shared memory " + name + " is not a state region");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return region;
+}
+
+int ShmRegion::num_workers() const {
+    return base_ ? static_cast<int>(static_cast<const shm::RegionHeader*>(base_)->num_workers) : 0;
+}
+
+size_t ShmRegion::capacity() const {
+    return base_ ? static_cast<const shm::RegionHeader*>(base_)->capacity : 0;
+}
+
+ShmChannel ShmRegion::channel(int worker, bool coordinator_side) const {
+    if (worker < 0 || worker >= num_workers()) return ShmChannel();
+
+    const auto* header = static_cast<const shm::RegionHeader*>(base_);
+    char* slot = static_cast<char*>(base_) + HEADER_BYTES +
+                 static_cast<size_t>(worker) * header->slot_bytes;
+    auto* states = reinterpret_cast<wire::StateRecord*>(slot + sizeof(shm::SlotHeader));
+    return ShmChannel(reinterpret_cast<shm::SlotHeader*>(slot), states, header->capacity,
+                      coordinator_side);
+}
+
+void ShmRegion::close() {
+    if (base_) {
+        ::munmap(base_, bytes_);
+        base_ = nullptr;
+        bytes_ = 0;
+    }
+    if (owner_ && !name_.empty()) {
+        ::shm_unlink(name_.c_str());
+        owner_ = false;
+    }
+    name_.clear();
+}
+
+}} // namespace sim::distributed
@@ -1,13 +1,51 @@
 #include "distributed/sim_coordinator.hpp"
+#include "distributed/metrics.hpp"
+#include "distributed/tracing.hpp"
 
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <cstdlib>
 #include <cstring>
+#include <chrono>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <thread>
+#include <map>
+#include <unordered_set>
+#include <cmath>
+#include <iomanip>
+#include <limits>
 
 namespace sim { namespace distributed {
 
+// ---------------------------------------------------------------------------
+// Metrics
+// ---------------------------------------------------------------------------
+
+struct CoordinatorMetrics {
+    Counter steps;
+    Histogram barrier_wait;     // ns until the last worker answered a step
+};
+
+static const CoordinatorMetrics& coordinator_metrics() {
+    static const CoordinatorMetrics m{
+        MetricsRegistry::global().counter("sim_coordinator_steps_total",
+                                          "Simulation steps completed by every worker"),
+        MetricsRegistry::global().histogram("sim_barrier_wait_seconds",
+                                            "Coordinator wait for worker responses",
+                                            1000, 28, 1e9)};    // 1 us .. ~134 s
+    return m;
+}
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
 // ---------------------------------------------------------------------------
 // JSON helpers (local to this TU)
 // ---------------------------------------------------------------------------
@@ -39,58 +77,35 @@ static std::string extract_json_string(const std::string& json, const std::strin
     return json.substr(pos, end - pos);
 }
 
-/// Extract a JSON number value for a given key
-static double extract_json_number(const std::string& json, const std::string& key) {
+/// Extract a JSON number value for a given key (simple flat object); fallback if absent
+static double extract_json_number(const std::string& json, const std::string& key,
+                                  double fallback) {
     std::string search = "\"" + key + "\"";
     auto pos = json.find(search);
-    if (pos == std::string::npos) return 0.0;
+    if (pos == std::string::npos) return fallback;
     pos = json.find(':', pos + search.size());
-    if (pos == std::string::npos) return 0.0;
-    ++pos;
-    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t')) ++pos;
-    std::string num_str;
-    while (pos < json.size() && (std::isdigit(json[pos]) || json[pos] == '.' ||
-           json[pos] == '-' || json[pos] == '+' || json[pos] == 'e' || json[pos] == 'E')) {
-        num_str += json[pos++];
-    }
-    if (num_str.empty()) return 0.0;
-    return std::stod(num_str);
+    if (pos == std::string::npos) return fallback;
+    const char* start = json.c_str() + pos + 1;
+    char* end = nullptr;
+    double v = std::strtod(start, &end);
+    return end == start ? fallback : v;
 }
 
-/// Parse a JSON array of state vectors from the payload
-/// Format: {"states":[{"entity_id":0,"px":...,"py":...,"pz":...,"vx":...,"vy":...,"vz":...,"time":...}, ...]}
-static std::vector<sim::StateVector> parse_state_vectors(const std::string& payload) {
-    std::vector<sim::StateVector> results;
-
-    // Find the "states" array
-    auto arr_start = payload.find("[");
-    if (arr_start == std::string::npos) return results;
-
-    // Walk through objects in the array
-    size_t pos = arr_start;
-    while (true) {
-        auto obj_start = payload.find('{', pos);
-        if (obj_start == std::string::npos) break;
-        auto obj_end = payload.find('}', obj_start);
-        if (obj_end == std::string::npos) break;
-
-        std::string obj = payload.substr(obj_start, obj_end - obj_start + 1);
-
+/// State vectors from a SYNC_RESPONSE (frame or shared-memory slot), appended to out
+static void unpack_states(const wire::StateRecord* records, size_t count,
+                          std::vector<sim::StateVector>& out) {
+    for (size_t i = 0; i < count; ++i) {
+        const auto& r = records[i];
         sim::StateVector sv;
-        sv.position.x = extract_json_number(obj, "px");
-        sv.position.y = extract_json_number(obj, "py");
-        sv.position.z = extract_json_number(obj, "pz");
-        sv.velocity.x = extract_json_number(obj, "vx");
-        sv.velocity.y = extract_json_number(obj, "vy");
-        sv.velocity.z = extract_json_number(obj, "vz");
-        sv.time = extract_json_number(obj, "time");
-
-        results.push_back(sv);
-
-        pos = obj_end + 1;
+        sv.position.x = r.state[0];
+        sv.position.y = r.state[1];
+        sv.position.z = r.state[2];
+        sv.velocity.x = r.state[3];
+        sv.velocity.y = r.state[4];
+        sv.velocity.z = r.state[5];
+        sv.time = r.time;
+        out.push_back(sv);
     }
-
-    return results;
 }
 
 // ---------------------------------------------------------------------------
@@ -101,6 +116,11 @@ SimCoordinator::SimCoordinator(const std::string& socket_path)
     : server_socket_(IPCSocket::listen(socket_path)),
       current_time_(0.0)
 {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Failed to create epoll instance: " +
+                                 std::string(std::strerror(errno)));
+    }
 }
 
 SimCoordinator::~SimCoordinator() {
@@ -127,48 +147,143 @@ void SimCoordinator::start(int expected_workers) {
 }
 
 bool SimCoordinator::accept_new_worker(int timeout_ms) {
-    // Use poll on the server socket to implement timeout
-    struct pollfd pfd;
-    pfd.fd = -1; // We'll work around this by using the accept with a timeout approach
-
-    // For simplicity, we use a blocking accept wrapped by poll on the raw fd.
-    // Access the server socket's fd through a receive_timeout-style approach.
-    // Since IPCSocket doesn't expose fd_, we use the accept() method directly
-    // with a poll on the server socket. We need to use the socket's is_connected
-    // to check if server is valid.
-
-    // Actually, IPCSocket::accept() is blocking. For the demo, short timeouts
-    // are okay. In production, we'd expose fd_ or add accept_timeout().
-    // Let's do a simple poll-based approach using the raw fd from the socket.
-    // We can't access fd_ directly, but we can accept since workers connect fast.
-
-    // For robustness: try accept(), workers should connect quickly in practice.
-    // The server_socket_ will block on accept(). For the in-process demo,
-    // workers connect immediately. For a real system, we would add accept_timeout().
-
-    (void)timeout_ms; // In-process demo: workers connect quickly
-
     try {
-        IPCSocket worker = server_socket_.accept();
+        IPCSocket worker;
+        if (!server_socket_.accept(worker, timeout_ms)) return false;
 
-        // Wait for READY message from worker
+        // Wait for READY (with the worker's capability report)
         auto [ok, msg] = worker.receive_timeout(5000);
-        if (ok && msg.type == MessageType::READY) {
-            std::cout << "[Coordinator] Worker " << num_connected() << " connected." << std::endl;
-            worker_sockets_.push_back(std::move(worker));
-            return true;
-        } else {
+        if (!ok || msg.type != MessageType::READY) {
             std::cerr << "[Coordinator] Worker did not send READY, dropping." << std::endl;
             worker.close();
             return false;
         }
+
+        // A reconnecting worker names the slot it held; otherwise take the
+        // first disconnected slot, or a new one while still registering
+        size_t slot = worker_sockets_.size();
+        int claimed = static_cast<int>(extract_json_number(msg.payload, "worker_id", -1.0));
+        if (claimed >= 0 && claimed < static_cast<int>(worker_sockets_.size()) &&
+            !worker_sockets_[static_cast<size_t>(claimed)].is_connected()) {
+            slot = static_cast<size_t>(claimed);
+        } else {
+            for (size_t i = 0; i < worker_sockets_.size(); ++i) {
+                if (!worker_sockets_[i].is_connected()) {
+                    slot = i;
+                    break;
+                }
+            }
+        }
+        if (slot == worker_sockets_.size() && barrier_) {
+            std::cerr << "[Coordinator] No free worker slot, dropping connection." << std::endl;
+            worker.close();
+            return false;
+        }
+        return attach_worker(slot, std::move(worker), msg);
     } catch (const std::exception& e) {
         std::cerr << "[Coordinator] Accept failed: " << e.what() << std::endl;
         return false;
     }
 }
 
+bool SimCoordinator::attach_worker(size_t slot, IPCSocket&& worker, const IPCMessage& ready) {
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    ev.data.u32 = static_cast<uint32_t>(slot);
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, worker.native_handle(), &ev) != 0) {
+        std::cerr << "[Coordinator] epoll_ctl failed: " << std::strerror(errno) << std::endl;
+        worker.close();
+        return false;
+    }
+
+    bool rejoin = slot < worker_sockets_.size();
+    if (rejoin) {
+        worker_sockets_[slot] = std::move(worker);
+    } else {
+        worker_sockets_.push_back(std::move(worker));
+        worker_info_.resize(worker_sockets_.size());
+    }
+
+    WorkerInfo& info = worker_info_[slot];
+    info.host = extract_json_string(ready.payload, "host");
+    info.cores = static_cast<int>(extract_json_number(ready.payload, "cores", 0.0));
+    info.memory_bytes = static_cast<uint64_t>(
+        extract_json_number(ready.payload, "memory_mb", 0.0) * 1024.0 * 1024.0);
+    if (rejoin) info.reconnects++;
+
+    std::cout << "[Coordinator] Worker " << slot << (rejoin ? " reconnected" : " connected")
+              << " (" << (info.host.empty() ? "?" : info.host) << ", " << info.cores
+              << " cores, " << (info.memory_bytes >> 20) << " MB)." << std::endl;
+
+    // Rejoin after assignment: hand the slot its entities again (socket transport)
+    if (slot < init_payloads_.size() && !init_payloads_[slot].empty()) {
+        IPCSocket& ws = worker_sockets_[slot];
+        bool acked = false;
+        if (ws.send(IPCMessage(MessageType::INIT, init_payloads_[slot], current_time_))) {
+            auto [ok, ack] = ws.receive_timeout(5000);
+            acked = ok && ack.type == MessageType::READY;
+            if (acked && slot < lookahead_.size()) {
+                lookahead_[slot] = extract_json_number(ack.payload, "lookahead", 0.0);
+            }
+        }
+        if (!acked) {
+            std::cerr << "[Coordinator] Worker " << slot << " did not acknowledge INIT." << std::endl;
+            handle_worker_disconnect(static_cast<int>(slot));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SimCoordinator::await_rejoin(int timeout_ms) {
+    auto missing = [&]() {
+        int count = 0;
+        for (size_t i = 0; i < worker_sockets_.size(); ++i) {
+            if (!worker_sockets_[i].is_connected()) ++count;
+        }
+        return count;
+    };
+    if (missing() == 0) return true;
+    if (timeout_ms <= 0) return false;
+
+    std::cerr << "[Coordinator] Waiting for " << missing() << " worker(s) to rejoin..." << std::endl;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (missing() > 0) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) break;
+        accept_new_worker(static_cast<int>(std::min<long long>(left, 500)));
+    }
+    return missing() == 0;
+}
+
 void SimCoordinator::assign_entities(const std::vector<WorkerAssignment>& assignments) {
+    shm_channels_.assign(worker_sockets_.size(), ShmChannel());
+    shm_counts_.assign(worker_sockets_.size(), 0);
+    init_payloads_.assign(worker_sockets_.size(), std::string());
+    assigned_.assign(worker_sockets_.size(), std::vector<int>());
+    lookahead_.assign(worker_sockets_.size(), 0.0);
+    entity_order_.clear();
+    entity_cost_.clear();
+    ghost_out_.assign(worker_sockets_.size(), std::vector<wire::StateRecord>());
+    if (spatial_active_ &&
+        spatial_.boundaries.size() + 1 != worker_sockets_.size()) {
+        throw std::runtime_error("Spatial decomposition needs one boundary fewer than workers");
+    }
+    if (spatial_active_ && !shm_name_.empty()) {
+        std::cerr << "[Coordinator] Spatial decomposition runs over sockets; "
+                  << "shared memory not offered." << std::endl;
+    } else if (!shm_name_.empty() && !worker_sockets_.empty()) {
+        size_t capacity = 0;
+        for (const auto& a : assignments) capacity = std::max(capacity, a.entity_ids.size());
+        try {
+            shm_region_ = ShmRegion::create(shm_name_, num_connected(), capacity);
+        } catch (const std::exception& e) {
+            std::cerr << "[Coordinator] " << e.what() << "; using sockets." << std::endl;
+        }
+    }
+
     for (const auto& assignment : assignments) {
         int wid = assignment.worker_id;
         if (wid < 0 || wid >= static_cast<int>(worker_sockets_.size())) {
@@ -176,24 +291,36 @@ void SimCoordinator::assign_entities(const std::vector<WorkerAssignment>& assign
             continue;
         }
 
-        // Build JSON payload: {"worker_id":0,"entity_ids":[0,1]}
-        std::ostringstream oss;
-        oss << "{\"worker_id\":" << wid
-            << ",\"entity_ids\":" << ints_to_json_array(assignment.entity_ids)
-            << "}";
+        // Rejoins re-send the plain payload (socket transport)
+        assigned_[static_cast<size_t>(wid)] = assignment.entity_ids;
+        std::string payload = init_payload(static_cast<size_t>(wid));
+        init_payloads_[static_cast<size_t>(wid)] = payload;
+        if (shm_region_.is_open()) {
+            payload.insert(payload.size() - 1, ",\"shm\":\"" + shm_name_ + "\"");
+        }
 
-        IPCMessage msg(MessageType::INIT, oss.str(), current_time_);
+        IPCMessage msg(MessageType::INIT, payload, current_time_);
         if (!worker_sockets_[static_cast<size_t>(wid)].send(msg)) {
             std::cerr << "[Coordinator] Failed to send INIT to worker " << wid << std::endl;
         }
     }
 
+    // gather_states() order: worker by worker, as assigned
+    for (const auto& ids : assigned_) {
+        for (int id : ids) entity_order_.emplace(id, entity_order_.size());
+    }
+
     // Wait for acknowledgements (workers respond with READY after INIT)
     for (size_t i = 0; i < worker_sockets_.size(); ++i) {
         auto [ok, resp] = worker_sockets_[i].receive_timeout(5000);
         if (!ok || resp.type != MessageType::READY) {
             std::cerr << "[Coordinator] Worker " << i
                       << " did not acknowledge INIT." << std::endl;
+        } else {
+            lookahead_[i] = extract_json_number(resp.payload, "lookahead", 0.0);
+            if (shm_region_.is_open() && resp.payload.find("\"shm\":true") != std::string::npos) {
+                shm_channels_[i] = shm_region_.channel(static_cast<int>(i), true);
+            }
         }
     }
 
@@ -202,20 +329,46 @@ void SimCoordinator::assign_entities(const std::vector<WorkerAssignment>& assign
 
 bool SimCoordinator::step(double dt) {
     if (worker_sockets_.empty()) return false;
+    TraceSpan trace_step("coordinator.step");
+    await_rejoin(rejoin_timeout_ms_);
 
-    // Build step payload: {"dt":60.0,"time":0.0}
+    // Build step payload: {"dt":60.0,"time":0.0}, plus "costs" on a balancing step
+    bool profile = balance_interval_ > 0 && (step_count_ + 1) % balance_interval_ == 0;
     std::ostringstream oss;
-    oss << "{\"dt\":" << dt << ",\"time\":" << current_time_ << "}";
+    oss << "{\"dt\":" << dt << ",\"time\":" << current_time_;
+    if (profile) oss << ",\"costs\":true";
+    oss << "}";
 
     IPCMessage step_msg(MessageType::STEP, oss.str(), current_time_);
-    broadcast(step_msg);
+    if (spatial_active_) {
+        // Ghosts first: the same socket delivers them ahead of the STEP
+        for (size_t i = 0; i < worker_sockets_.size() && i < ghost_out_.size(); ++i) {
+            if (!worker_sockets_[i].is_connected()) continue;
+            worker_sockets_[i].send_states(MessageType::GHOSTS, current_time_,
+                                           ghost_out_[i].data(), ghost_out_[i].size());
+        }
+    }
+    broadcast(step_msg, dt);
 
     // Collect STEP_COMPLETE responses
     if (barrier_) {
         barrier_->reset();
     }
 
+    auto wait_start = std::chrono::steady_clock::now();
     auto responses = collect_responses(5000);
+    coordinator_metrics().barrier_wait.observe(elapsed_ns(wait_start));
+
+    // Workers lost mid-step: once they rejoin, step them again (a worker
+    // that had already applied this step only acknowledges it)
+    for (size_t i = 0; i < responses.size(); ++i) {
+        if (responses[i].type != MessageType::ERROR || responses[i].payload != "disconnected" ||
+            !await_rejoin(rejoin_timeout_ms_)) continue;
+        auto& ws = worker_sockets_[i];
+        if (!ws.is_connected() || !ws.send(step_msg)) continue;
+        auto [ok, resp] = ws.receive_timeout(5000);
+        if (ok) responses[i] = std::move(resp);
+    }
 
     bool all_ok = true;
     for (size_t i = 0; i < responses.size(); ++i) {
@@ -227,15 +380,29 @@ bool SimCoordinator::step(double dt) {
         }
         if (barrier_) {
             barrier_->worker_done(static_cast<int>(i),
-                                  responses[i].type == MessageType::STEP_COMPLETE);
+                                  responses[i].type == MessageType::STEP_COMPLETE,
+                                  response_latency_[i]);
         }
     }
 
     current_time_ += dt;
+    ++step_count_;
+    coordinator_metrics().steps.add();
+
+    if (spatial_active_ && all_ok) exchange_boundaries(responses);
+    if (profile && all_ok) {
+        for (const auto& resp : responses) record_costs(resp.payload);
+        rebalance();
+    }
     return all_ok;
 }
 
 bool SimCoordinator::run_until(double end_time, double dt) {
+    round_trips_ = 0;
+    if (lookahead_sync_ && !spatial_active_ && balance_interval_ == 0) {
+        return advance_until(end_time, dt);
+    }
+
     int step_count = 0;
     while (current_time_ < end_time) {
         if (!step(dt)) {
@@ -243,83 +410,652 @@ bool SimCoordinator::run_until(double end_time, double dt) {
             return false;
         }
         ++step_count;
+        ++round_trips_;
     }
     std::cout << "[Coordinator] Completed " << step_count << " steps. Time = "
               << current_time_ << "s" << std::endl;
+
+    // Per-worker step latency: a straggler shows up as the outlier
+    if (barrier_ && step_count > 0) {
+        int slowest = barrier_->slowest_worker();
+        for (int i = 0; i < barrier_->num_workers(); ++i) {
+            WorkerTiming t = barrier_->timing(i);
+            if (t.steps == 0) continue;
+            std::cout << "[Coordinator] Worker " << i << " step latency: mean "
+                      << t.mean() * 1e6 << " us, max " << t.max * 1e6 << " us"
+                      << (i == slowest && barrier_->num_workers() > 1 ? " (slowest last step)" : "")
+                      << std::endl;
+        }
+    }
     return true;
 }
 
+bool SimCoordinator::advance_until(double end_time, double dt) {
+    const size_t n = worker_sockets_.size();
+    if (n == 0 || dt <= 0.0) return false;
+    TraceSpan trace_advance("coordinator.advance_until");
+    if (barrier_) barrier_->reset();
+
+    // Steps left for each worker, and its clock (whole steps from current_time_)
+    const long total_steps = static_cast<long>(std::ceil((end_time - current_time_) / dt - 1e-9));
+    std::vector<long> done(n, 0);
+    std::vector<long> reach(n, 0);   // Lookahead in whole steps, at least one
+    for (size_t i = 0; i < n; ++i) {
+        double l = i < lookahead_.size() ? lookahead_[i] : 0.0;
+        reach[i] = std::max(1L, static_cast<long>(std::floor(l / dt + 1e-9)));
+    }
+
+    std::vector<char> pending(n, 0);
+    std::vector<std::chrono::steady_clock::time_point> granted(n);
+    size_t outstanding = 0;
+
+    auto grant = [&](size_t i) {
+        // Safe horizon: no other worker can reach i before min_j (t_j + L_j)
+        long horizon = total_steps;
+        for (size_t j = 0; j < n; ++j) {
+            if (j != i) horizon = std::min(horizon, done[j] + reach[j]);
+        }
+        long steps = horizon - done[i];
+        if (steps <= 0) return;
+
+        double t = current_time_ + static_cast<double>(done[i]) * dt;
+        bool sent;
+        if (shared_memory_active(static_cast<int>(i))) {
+            shm::Command cmd;
+            cmd.type = static_cast<uint32_t>(MessageType::STEP);
+            cmd.count = static_cast<uint32_t>(steps);
+            cmd.timestamp = t;
+            cmd.dt = dt;
+            sent = shm_channels_[i].send(cmd);
+        } else {
+            std::ostringstream oss;
+            oss << "{\"dt\":" << dt << ",\"time\":" << t << ",\"steps\":" << steps << "}";
+            sent = worker_sockets_[i].is_connected() &&
+                   worker_sockets_[i].send(IPCMessage(MessageType::STEP, oss.str(), t));
+        }
+        if (!sent) return;
+        pending[i] = 1;
+        granted[i] = std::chrono::steady_clock::now();
+        ++outstanding;
+        ++round_trips_;
+    };
+
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i) grant(i);
+    while (outstanding > 0) {
+        size_t i = 0;
+        IPCMessage msg;
+        auto wait_start = std::chrono::steady_clock::now();
+        bool got = next_response(pending, i, msg, 5000);
+        coordinator_metrics().barrier_wait.observe(elapsed_ns(wait_start));
+        if (!got) {
+            std::cerr << "[Coordinator] Timed out waiting for an advance." << std::endl;
+            ok = false;
+            break;
+        }
+        --outstanding;
+        if (msg.type != MessageType::STEP_COMPLETE) {
+            std::cerr << "[Coordinator] Worker " << i << " returned "
+                      << static_cast<int>(msg.type) << " instead of STEP_COMPLETE." << std::endl;
+            ok = false;
+            break;
+        }
+        done[i] = std::min(total_steps, static_cast<long>(
+            std::llround((msg.timestamp - current_time_) / dt)));
+        if (barrier_) {
+            barrier_->worker_done(static_cast<int>(i), true, std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - granted[i]).count());
+        }
+
+        // The reporter, and anyone its progress unblocked, may advance now
+        for (size_t j = 0; j < n; ++j) {
+            if (!pending[j] && done[j] < total_steps) grant(j);
+        }
+    }
+
+    // Drain grants still in flight so the next exchange starts clean
+    while (outstanding > 0) {
+        size_t i = 0;
+        IPCMessage msg;
+        if (!next_response(pending, i, msg, 5000)) break;
+        --outstanding;
+    }
+
+    if (!ok) return false;
+    long reached = *std::min_element(done.begin(), done.end());
+    current_time_ += static_cast<double>(reached) * dt;
+    coordinator_metrics().steps.add(static_cast<uint64_t>(reached));
+    std::cout << "[Coordinator] Completed " << reached << " steps in " << round_trips_
+              << " round trips (lookahead sync). Time = " << current_time_ << "s" << std::endl;
+    return reached == total_steps;
+}
+
+bool SimCoordinator::next_response(std::vector<char>& pending, size_t& worker, IPCMessage& msg,
+                                   int timeout_ms) {
+    const size_t n = pending.size();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    struct epoll_event events[64];
+    int idle = 0;
+
+    for (;;) {
+        bool sockets = false;
+        bool rings = false;
+        for (size_t i = 0; i < n; ++i) {
+            if (!pending[i]) continue;
+            if (shared_memory_active(static_cast<int>(i))) {
+                shm::Command cmd;
+                if (shm_channels_[i].receive(cmd, 0)) {
+                    msg = IPCMessage(static_cast<MessageType>(cmd.type), "", cmd.timestamp);
+                    pending[i] = 0;
+                    worker = i;
+                    return true;
+                }
+                rings = true;
+            } else if (worker_sockets_[i].is_connected()) {
+                sockets = true;
+            } else {
+                msg = IPCMessage(MessageType::ERROR, "disconnected", current_time_);
+                pending[i] = 0;
+                worker = i;
+                return true;
+            }
+        }
+        if (!sockets && !rings) return false;
+
+        int left = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+        if (left < 0) return false;
+
+        if (!sockets) {
+            // Rings only: yield, then nap briefly (as in collect_responses)
+            if (++idle < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        int ready = ::epoll_wait(epoll_fd_, events, 64, rings ? std::min(left, 1) : left);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (int k = 0; k < ready; ++k) {
+            size_t i = events[k].data.u32;
+            if (i >= n || !worker_sockets_[i].is_connected()) continue;
+            try {
+                IPCMessage in;
+                while (worker_sockets_[i].receive_ready(in)) {
+                    if (!pending[i]) continue;   // Stray reply: dropped
+                    msg = std::move(in);
+                    pending[i] = 0;
+                    worker = i;
+                    return true;
+                }
+            } catch (const std::exception&) {
+                handle_worker_disconnect(static_cast<int>(i));
+            }
+        }
+    }
+}
+
 std::vector<sim::StateVector> SimCoordinator::gather_states() {
+    TraceSpan trace_gather("coordinator.gather_states");
     IPCMessage sync_msg(MessageType::SYNC_REQUEST, "{}", current_time_);
     broadcast(sync_msg);
 
     auto responses = collect_responses(5000);
 
+    size_t total = 0;
+    for (const auto& resp : responses) total += resp.states.size();
+    for (size_t c : shm_counts_) total += c;
+
     std::vector<sim::StateVector> all_states;
-    for (const auto& resp : responses) {
-        if (resp.type == MessageType::SYNC_RESPONSE) {
-            auto states = parse_state_vectors(resp.payload);
-            all_states.insert(all_states.end(), states.begin(), states.end());
+    all_states.reserve(total);
+    std::vector<int> ids;   // Only needed to undo migrations
+    for (size_t i = 0; i < responses.size(); ++i) {
+        if (responses[i].type != MessageType::SYNC_RESPONSE) continue;
+        auto view = state_view(static_cast<int>(i));
+        const wire::StateRecord* records = view.first ? view.first : responses[i].states.data();
+        size_t count = view.first ? view.second : responses[i].states.size();
+        unpack_states(records, count, all_states);
+        if (migrations_ > 0) {
+            for (size_t k = 0; k < count; ++k) ids.push_back(records[k].entity_id);
         }
     }
 
+    // Entities have moved: restore the original assignment order
+    if (migrations_ > 0) {
+        std::vector<std::pair<size_t, size_t>> order(all_states.size());
+        for (size_t k = 0; k < all_states.size(); ++k) {
+            auto it = entity_order_.find(ids[k]);
+            order[k] = {it != entity_order_.end() ? it->second : entity_order_.size() + k, k};
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<sim::StateVector> sorted;
+        sorted.reserve(all_states.size());
+        for (const auto& o : order) sorted.push_back(all_states[o.second]);
+        all_states = std::move(sorted);
+    }
+
     return all_states;
 }
 
+int SimCoordinator::subscribe(const SyncInterest& interest) {
+    int id = next_subscription_++;
+    subscriptions_[id].interest = interest;
+    return id;
+}
+
+void SimCoordinator::unsubscribe(int subscription) {
+    if (subscriptions_.erase(subscription) == 0) return;
+    broadcast(IPCMessage(MessageType::SYNC_REQUEST,
+                         "{\"sub\":" + std::to_string(subscription) + ",\"drop\":true}",
+                         current_time_));
+    collect_responses(5000);
+}
+
+std::vector<wire::StateRecord> SimCoordinator::sync_delta(int subscription) {
+    auto sub = subscriptions_.find(subscription);
+    if (sub == subscriptions_.end()) {
+        throw std::runtime_error("Unknown sync subscription " + std::to_string(subscription));
+    }
+    Subscription& s = sub->second;
+
+    broadcast(IPCMessage(MessageType::SYNC_REQUEST, s.interest.to_payload(subscription),
+                         current_time_));
+    auto responses = collect_responses(5000);
+
+    std::vector<wire::StateRecord> delta;
+    if (s.shm_filters.size() < responses.size()) s.shm_filters.resize(responses.size());
+    for (size_t i = 0; i < responses.size(); ++i) {
+        if (responses[i].type != MessageType::SYNC_RESPONSE) continue;
+        auto view = state_view(static_cast<int>(i));
+        if (view.first) {
+            // Full slot in shared memory: no wire cost, filter here
+            s.shm_filters[i].filter(s.interest, view.first, view.second, delta);
+        } else {
+            delta.insert(delta.end(), responses[i].states.begin(), responses[i].states.end());
+        }
+    }
+    return delta;
+}
+
 void SimCoordinator::shutdown() {
     IPCMessage shutdown_msg(MessageType::SHUTDOWN, "{}", current_time_);
 
-    for (auto& ws : worker_sockets_) {
-        try {
-            ws.send(shutdown_msg);
-        } catch (...) {}
-    }
+    try {
+        broadcast(shutdown_msg);
+    } catch (...) {}
 
     // Close all worker sockets
     for (auto& ws : worker_sockets_) {
         ws.close();
     }
     worker_sockets_.clear();
+    worker_info_.clear();
+    init_payloads_.clear();
+    assigned_.clear();
+    subscriptions_.clear();
+    shm_channels_.clear();
+    shm_counts_.clear();
+    shm_region_.close();
 
     server_socket_.close();
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+std::pair<const wire::StateRecord*, size_t> SimCoordinator::state_view(int worker_id) const {
+    if (!shared_memory_active(worker_id)) return {nullptr, 0};
+    const auto& ch = shm_channels_[static_cast<size_t>(worker_id)];
+    return {ch.states(), std::min(shm_counts_[static_cast<size_t>(worker_id)], ch.capacity())};
+}
+
+bool SimCoordinator::shared_memory_active(int worker_id) const {
+    return worker_id >= 0 && worker_id < static_cast<int>(shm_channels_.size()) &&
+           shm_channels_[static_cast<size_t>(worker_id)].valid();
 }
 
 void SimCoordinator::handle_worker_disconnect(int worker_id) {
     if (worker_id < 0 || worker_id >= static_cast<int>(worker_sockets_.size())) return;
 
     std::cerr << "[Coordinator] Worker " << worker_id << " disconnected." << std::endl;
-    worker_sockets_[static_cast<size_t>(worker_id)].close();
-    // Note: We don't erase to keep worker indices stable.
-    // A production system would handle re-assignment.
+    auto& ws = worker_sockets_[static_cast<size_t>(worker_id)];
+    if (ws.is_connected() && epoll_fd_ >= 0) {
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, ws.native_handle(), nullptr);
+    }
+    ws.close();
+    if (shared_memory_active(worker_id)) shm_channels_[static_cast<size_t>(worker_id)] = ShmChannel();
+    // Not erased: indices stay stable and the slot waits for a rejoin
 }
 
-void SimCoordinator::broadcast(const IPCMessage& msg) {
-    for (auto& ws : worker_sockets_) {
-        if (ws.is_connected()) {
-            if (!ws.send(msg)) {
+std::string SimCoordinator::init_payload(size_t worker) const {
+    // {"worker_id":0,"entity_ids":[0,1]}, plus the slab in spatial mode
+    std::ostringstream oss;
+    oss << std::setprecision(17) << "{\"worker_id\":" << worker
+        << ",\"entity_ids\":" << ints_to_json_array(assigned_[worker]);
+    if (spatial_active_) {
+        const auto& b = spatial_.boundaries;
+        double lo = worker > 0 ? b[worker - 1] : -std::numeric_limits<double>::max();
+        double hi = worker < b.size() ? b[worker] : std::numeric_limits<double>::max();
+        oss << ",\"spatial\":true,\"axis\":" << spatial_.axis << ",\"lo\":" << lo
+            << ",\"hi\":" << hi << ",\"halo\":" << spatial_.halo;
+    }
+    oss << "}";
+    return oss.str();
+}
+
+size_t SimCoordinator::region_of(double coordinate) const {
+    const auto& b = spatial_.boundaries;
+    return static_cast<size_t>(std::upper_bound(b.begin(), b.end(), coordinate) - b.begin());
+}
+
+void SimCoordinator::exchange_boundaries(const std::vector<IPCMessage>& responses) {
+    const size_t n = worker_sockets_.size();
+    const int axis = spatial_.axis;
+    for (auto& g : ghost_out_) g.clear();
+
+    // (from, to) -> entities that left the sender's slab
+    std::map<std::pair<size_t, size_t>, std::vector<int>> handover;
+
+    for (size_t i = 0; i < responses.size() && i < n; ++i) {
+        for (const auto& r : responses[i].states) {
+            double c = r.state[axis];
+            size_t owner = i;
+            if (r.reserved == wire::RECORD_LEAVING && region_of(c) != i) {
+                owner = region_of(c);
+                handover[{i, owner}].push_back(r.entity_id);
+            }
+
+            // Every other slab whose halo band reaches the entity sees a ghost
+            size_t first = region_of(c - spatial_.halo);
+            size_t last = region_of(c + spatial_.halo);
+            for (size_t k = first; k <= last && k < n; ++k) {
+                if (k == owner) continue;
+                ghost_out_[k].push_back(r);
+                ghost_out_[k].back().reserved = 0;
+            }
+        }
+    }
+
+    for (const auto& h : handover) {
+        migrate(h.first.first, h.first.second, h.second);
+    }
+}
+
+void SimCoordinator::record_costs(const std::string& payload) {
+    auto pos = payload.find("\"costs\"");
+    if (pos == std::string::npos) return;
+    pos = payload.find('[', pos);
+    if (pos == std::string::npos) return;
+
+    const char* p = payload.c_str() + pos + 1;
+    for (;;) {
+        char* end = nullptr;
+        double id = std::strtod(p, &end);
+        if (end == p) break;
+        p = end;
+        if (*p == ',') ++p;
+        double cost = std::strtod(p, &end);
+        if (end == p) break;
+        p = end;
+        if (*p == ',') ++p;
+
+        // One profiled step is noisy: smooth across reports
+        auto it = entity_cost_.find(static_cast<int>(id));
+        if (it == entity_cost_.end()) {
+            entity_cost_.emplace(static_cast<int>(id), cost);
+        } else {
+            it->second = 0.5 * it->second + 0.5 * cost;
+        }
+    }
+}
+
+void SimCoordinator::rebalance() {
+    if (spatial_active_) return;   // Ownership follows position instead
+
+    // Candidates: socket workers holding an assignment
+    std::vector<size_t> workers;
+    for (size_t i = 0; i < worker_sockets_.size() && i < assigned_.size(); ++i) {
+        if (worker_sockets_[i].is_connected() && !shared_memory_active(static_cast<int>(i)) &&
+            i < init_payloads_.size() && !init_payloads_[i].empty()) {
+            workers.push_back(i);
+        }
+    }
+    if (workers.size() < 2) return;
+
+    auto cost_of = [&](int id) {
+        auto it = entity_cost_.find(id);
+        return it != entity_cost_.end() ? it->second : 0.0;
+    };
+
+    std::vector<double> load(workers.size(), 0.0);
+    std::vector<std::vector<int>> owned(workers.size());
+    double total = 0.0;
+    for (size_t k = 0; k < workers.size(); ++k) {
+        owned[k] = assigned_[workers[k]];
+        for (int id : owned[k]) load[k] += cost_of(id);
+        total += load[k];
+    }
+    double mean = total / static_cast<double>(workers.size());
+    if (mean <= 0.0) return;
+
+    // Greedy: move the entity from the heaviest to the lightest worker that
+    // best halves their gap, until the heaviest is within the ratio
+    std::map<std::pair<size_t, size_t>, std::vector<int>> moves;
+    const size_t max_moves = 256;
+    size_t planned = 0;
+    while (planned < max_moves) {
+        size_t h = static_cast<size_t>(std::max_element(load.begin(), load.end()) - load.begin());
+        size_t l = static_cast<size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        if (load[h] <= balance_ratio_ * mean) break;
+
+        double gap = load[h] - load[l];
+        size_t best = owned[h].size();
+        double best_miss = 0.0;
+        for (size_t e = 0; e < owned[h].size(); ++e) {
+            double c = cost_of(owned[h][e]);
+            if (c <= 0.0 || c >= gap) continue;   // Would not lower the maximum
+            double miss = std::abs(c - 0.5 * gap);
+            if (best == owned[h].size() || miss < best_miss) {
+                best = e;
+                best_miss = miss;
+            }
+        }
+        if (best == owned[h].size()) break;
+
+        int id = owned[h][best];
+        double c = cost_of(id);
+        owned[h].erase(owned[h].begin() + static_cast<std::ptrdiff_t>(best));
+        owned[l].push_back(id);
+        load[h] -= c;
+        load[l] += c;
+        moves[{workers[h], workers[l]}].push_back(id);
+        ++planned;
+    }
+
+    for (const auto& m : moves) {
+        if (migrate(m.first.first, m.first.second, m.second)) {
+            std::cout << "[Coordinator] Migrated " << m.second.size() << " entities from worker "
+                      << m.first.first << " to worker " << m.first.second << "." << std::endl;
+        }
+    }
+}
+
+bool SimCoordinator::migrate(size_t from, size_t to, const std::vector<int>& entity_ids) {
+    auto& src = worker_sockets_[from];
+    auto& dst = worker_sockets_[to];
+
+    std::string release = "{\"entity_ids\":" + ints_to_json_array(entity_ids) + "}";
+    if (!src.send(IPCMessage(MessageType::MIGRATE_OUT, release, current_time_))) return false;
+    auto [ok, handoff] = src.receive_timeout(5000);
+    if (!ok || handoff.type != MessageType::MIGRATE_STATE) {
+        std::cerr << "[Coordinator] Worker " << from << " did not release entities." << std::endl;
+        return false;
+    }
+
+    // The state travels verbatim; on failure it goes back to the source
+    IPCMessage adopt(MessageType::MIGRATE_IN, handoff.payload, current_time_);
+    auto hand_to = [&](IPCSocket& ws) {
+        if (!ws.send(adopt)) return false;
+        auto [acked, ack] = ws.receive_timeout(5000);
+        return acked && ack.type == MessageType::READY;
+    };
+    if (!hand_to(dst)) {
+        std::cerr << "[Coordinator] Worker " << to << " did not adopt entities; returning them."
+                  << std::endl;
+        hand_to(src);
+        return false;
+    }
+
+    std::unordered_set<int> moved(entity_ids.begin(), entity_ids.end());
+    auto& from_ids = assigned_[from];
+    from_ids.erase(std::remove_if(from_ids.begin(), from_ids.end(),
+                                  [&](int id) { return moved.count(id) > 0; }),
+                   from_ids.end());
+    assigned_[to].insert(assigned_[to].end(), entity_ids.begin(), entity_ids.end());
+    init_payloads_[from] = init_payload(from);
+    init_payloads_[to] = init_payload(to);
+    migrations_ += static_cast<int>(entity_ids.size());
+    return true;
+}
+
+void SimCoordinator::broadcast(const IPCMessage& msg, double dt) {
+    TraceSpan trace_broadcast("coordinator.broadcast");
+    dispatch_time_ = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < worker_sockets_.size(); ++i) {
+        if (shared_memory_active(static_cast<int>(i))) {
+            shm::Command cmd;
+            cmd.type = static_cast<uint32_t>(msg.type);
+            cmd.timestamp = msg.timestamp;
+            cmd.dt = dt;
+            if (!shm_channels_[i].send(cmd)) {
+                std::cerr << "[Coordinator] Failed to send to a worker." << std::endl;
+            }
+        } else if (worker_sockets_[i].is_connected()) {
+            if (!worker_sockets_[i].send(msg)) {
                 std::cerr << "[Coordinator] Failed to send to a worker." << std::endl;
             }
         }
     }
 }
 
+void SimCoordinator::record_response(size_t worker, IPCMessage&& msg,
+                                     std::vector<IPCMessage>& responses) {
+    response_latency_[worker] = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - dispatch_time_).count();
+    responses[worker] = std::move(msg);
+}
+
 std::vector<IPCMessage> SimCoordinator::collect_responses(int timeout_ms) {
-    std::vector<IPCMessage> responses;
-    responses.reserve(worker_sockets_.size());
+    TraceSpan trace_collect("coordinator.collect_responses");
+    const size_t n = worker_sockets_.size();
+    std::vector<IPCMessage> responses(n, IPCMessage(MessageType::ERROR, "timeout", current_time_));
+    response_latency_.assign(n, -1.0);
 
-    for (auto& ws : worker_sockets_) {
-        if (!ws.is_connected()) {
-            // Push an error placeholder
-            responses.push_back(IPCMessage(MessageType::ERROR, "disconnected", current_time_));
+    std::vector<char> pending(n, 0);
+    size_t socket_pending = 0;
+    size_t shm_pending = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (shared_memory_active(static_cast<int>(i))) {
+            pending[i] = 1;
+            ++shm_pending;
+        } else if (worker_sockets_[i].is_connected()) {
+            pending[i] = 1;
+            ++socket_pending;
+        } else {
+            responses[i] = IPCMessage(MessageType::ERROR, "disconnected", current_time_);
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    auto ms_left = [&]() {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count());
+    };
+
+    auto take_shm = [&](size_t i, int wait_ms) {
+        shm::Command cmd;
+        if (!shm_channels_[i].receive(cmd, wait_ms)) return false;
+        if (cmd.type == static_cast<uint32_t>(MessageType::SYNC_RESPONSE)) {
+            shm_counts_[i] = cmd.count;
+        }
+        record_response(i, IPCMessage(static_cast<MessageType>(cmd.type), "", cmd.timestamp),
+                        responses);
+        pending[i] = 0;
+        --shm_pending;
+        return true;
+    };
+
+    // Sockets: whichever worker answers first is read first
+    struct epoll_event events[64];
+    while (socket_pending > 0) {
+        int left = ms_left();
+        if (left < 0) break;
+        // Mixed transports: keep sweeping the shared-memory rings meanwhile
+        int wait = shm_pending > 0 ? std::min(left, 1) : left;
+        int ready = ::epoll_wait(epoll_fd_, events, 64, wait);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Coordinator] epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int k = 0; k < ready; ++k) {
+            size_t i = events[k].data.u32;
+            if (i >= n || !worker_sockets_[i].is_connected()) continue;
+            try {
+                // Drain the socket; a message from a worker already answered
+                // (late reply to an earlier timed-out request) is dropped
+                IPCMessage msg;
+                while (worker_sockets_[i].receive_ready(msg)) {
+                    if (pending[i]) {
+                        record_response(i, std::move(msg), responses);
+                        pending[i] = 0;
+                        --socket_pending;
+                    }
+                }
+            } catch (const std::exception& e) {
+                if (pending[i]) {
+                    responses[i] = IPCMessage(MessageType::ERROR, "disconnected", current_time_);
+                    pending[i] = 0;
+                    --socket_pending;
+                }
+                handle_worker_disconnect(static_cast<int>(i));
+            }
+        }
+
+        for (size_t i = 0; i < n && shm_pending > 0; ++i) {
+            if (pending[i] && shared_memory_active(static_cast<int>(i))) take_shm(i, 0);
+        }
+        if (left == 0) break;
+    }
+
+    // Remaining shared-memory rings: sweep them all, so each reply is timed
+    // when it lands; after a quiet spell sleep briefly on one, then sweep again
+    int idle = 0;
+    while (shm_pending > 0) {
+        bool got = false;
+        size_t first = n;
+        for (size_t i = 0; i < n; ++i) {
+            if (!pending[i] || !shared_memory_active(static_cast<int>(i))) continue;
+            if (take_shm(i, 0)) got = true;
+            else if (first == n) first = i;
+        }
+        if (got) {
+            idle = 0;
             continue;
         }
+        if (first == n) break;   // Disconnected while pending
 
-        auto [ok, msg] = ws.receive_timeout(timeout_ms);
-        if (ok) {
-            responses.push_back(msg);
-        } else {
-            responses.push_back(IPCMessage(MessageType::ERROR, "timeout", current_time_));
+        int left = ms_left();
+        if (left < 0) break;
+        if (++idle < 64) {
+            std::this_thread::yield();
+            continue;
         }
+        take_shm(first, std::min(left, 1));
     }
 
     return responses;
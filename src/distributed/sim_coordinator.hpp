@@ -3,10 +3,14 @@
 
 #include "ipc_socket.hpp"
 #include "time_barrier.hpp"
+#include "shm_transport.hpp"
+#include "state_sync.hpp"
 #include "core/state_vector.hpp"
+#include <chrono>
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
 
 namespace sim { namespace distributed {
 
@@ -18,15 +22,79 @@ struct WorkerAssignment {
     std::vector<int> entity_ids;
 };
 
+/**
+ * @brief Capability report a worker sends with its READY registration
+ */
+struct WorkerInfo {
+    std::string host;
+    int cores = 0;
+    uint64_t memory_bytes = 0;
+    int reconnects = 0;       // Times this slot was re-taken after a disconnect
+};
+
+/**
+ * @brief Spatial domain decomposition: worker k owns the slab
+ * [boundaries[k-1], boundaries[k]) along one position axis (the first and
+ * last slabs are open-ended), and sees ghost copies of other workers'
+ * entities within `halo` of its slab.
+ */
+struct SpatialDecomposition {
+    int axis = 0;                     // 0 = x, 1 = y, 2 = z of StateVector::position
+    std::vector<double> boundaries;   // num_workers - 1 ascending cut points [m]
+    double halo = 0.0;                // Ghost band width [m]
+};
+
 /**
  * @brief Coordinator process that manages workers and orchestrates time-stepped simulation
  *
  * The coordinator:
- * 1. Listens on a Unix domain socket for worker connections
+ * 1. Listens for worker connections (Unix socket, tcp:// or tls://; see
+ *    IPCSocket) and records each worker's capability report
  * 2. Assigns entities to workers via INIT messages
  * 3. Steps the simulation by broadcasting STEP and waiting for STEP_COMPLETE
- * 4. Gathers state via SYNC_REQUEST / SYNC_RESPONSE
+ * 4. Gathers state via SYNC_REQUEST / SYNC_RESPONSE (binary state frames)
  * 5. Shuts down workers with SHUTDOWN
+ *
+ * Responses are collected through epoll in arrival order, so one slow
+ * worker does not hold up reading the others; each worker's step latency
+ * is fed to the TimeBarrier (see barrier()->timing()).
+ *
+ * With use_shared_memory(), workers on the same host step and sync through
+ * a shared-memory region instead of the socket (see shm_transport.hpp);
+ * a worker that cannot map it stays on the socket.
+ *
+ * A worker whose connection drops may reconnect: its READY names the
+ * worker_id it held, and the coordinator re-sends that slot's INIT (a new
+ * worker with no id takes the first free slot). step() waits up to the
+ * rejoin timeout for disconnected slots before giving up.
+ *
+ * With set_load_balancing(), every interval-th STEP asks socket workers
+ * for per-entity update costs; when the slowest worker's load exceeds the
+ * mean by the given ratio, entities move from the heaviest to the
+ * lightest workers (MIGRATE_OUT / MIGRATE_IN, full state handed over).
+ * gather_states() keeps the original assignment order throughout.
+ *
+ * With use_spatial_decomposition(), each worker owns a slab of space
+ * instead of a fixed entity list. After every step a worker reports, as a
+ * binary STEP_COMPLETE frame, only its entities inside the halo band next
+ * to its slab edges plus those that left the slab. The coordinator routes
+ * boundary states to the neighbours as GHOSTS before the next STEP, and
+ * hands leaving entities to their new owner with the migration protocol.
+ * The initial assignment need not match the slabs; entities reach their
+ * owners after the first step.
+ *
+ * With use_lookahead_sync(), run_until() drops the per-dt barrier for
+ * conservative synchronization: each worker declares a lookahead L (the
+ * earliest its entities can affect anyone else), and worker i is granted
+ * an advance to min over j != i of (t_j + L_j) as soon as it reports,
+ * as one STEP of several dt. Workers that cannot influence each other for
+ * long stretches then only meet every lookahead instead of every dt.
+ *
+ * Delta sync: subscribe() registers a consumer (visualization, monitoring)
+ * with a SyncInterest, and sync_delta() returns only the entities that
+ * changed for it since its previous call. Socket workers filter at the
+ * source, so unchanged or uninteresting entities never cross the network;
+ * the coordinator filters shared-memory slots itself.
  */
 class SimCoordinator {
 public:
@@ -36,6 +104,10 @@ public:
     /// Accept workers until expected_workers are connected
     void start(int expected_workers);
 
+    /// Offer workers the shared-memory transport (POSIX name, e.g. "/sim_state").
+    /// Call before assign_entities(), which creates the region.
+    void use_shared_memory(const std::string& name) { shm_name_ = name; }
+
     /// Send entity assignments to each worker
     void assign_entities(const std::vector<WorkerAssignment>& assignments);
 
@@ -48,30 +120,156 @@ public:
     /// Request all workers to send their current entity states
     std::vector<sim::StateVector> gather_states();
 
+    /// Register a delta-sync subscriber; returns its subscription id
+    int subscribe(const SyncInterest& interest);
+
+    /// End a subscription (workers drop what they tracked for it)
+    void unsubscribe(int subscription);
+
+    /// Records that changed for a subscriber since its last sync_delta(), in
+    /// worker order; RECORD_REMOVED marks entities that left its interest set
+    std::vector<wire::StateRecord> sync_delta(int subscription);
+
+    /// A shared-memory worker's records from the last gather_states(), read
+    /// in place from the region ({nullptr, 0} for socket workers)
+    std::pair<const wire::StateRecord*, size_t> state_view(int worker_id) const;
+
+    /// Whether a worker steps and syncs through shared memory
+    bool shared_memory_active(int worker_id) const;
+
     /// Send SHUTDOWN to all workers and close connections
     void shutdown();
 
     /// Try to accept a single new worker connection (with timeout)
     bool accept_new_worker(int timeout_ms = 1000);
 
-    /// Handle a disconnected worker (remove from list)
+    /// Handle a disconnected worker (slot kept for a reconnect)
     void handle_worker_disconnect(int worker_id);
 
+    /// How long step() waits for disconnected workers to rejoin (0 = fail fast)
+    void set_rejoin_timeout(int timeout_ms) { rejoin_timeout_ms_ = timeout_ms; }
+
+    /// Rebalance every interval_steps steps when max load > ratio * mean (0 = off).
+    /// Shared-memory workers keep their entities.
+    void set_load_balancing(int interval_steps, double imbalance_ratio = 1.25) {
+        balance_interval_ = interval_steps;
+        balance_ratio_ = imbalance_ratio;
+    }
+
+    /// Partition by position (call before assign_entities(); socket transport only,
+    /// and load balancing is suspended while it is active)
+    void use_spatial_decomposition(const SpatialDecomposition& decomposition) {
+        spatial_ = decomposition;
+        spatial_active_ = true;
+    }
+
+    /// Grant lookahead-bounded multi-step advances in run_until() instead of
+    /// lock-step STEPs (not combined with spatial decomposition or balancing)
+    void use_lookahead_sync(bool enabled) { lookahead_sync_ = enabled; }
+
+    /// STEP round trips issued by the last run_until()
+    uint64_t round_trips() const { return round_trips_; }
+
+    /// Entities moved between workers so far
+    int migrations() const { return migrations_; }
+
+    /// Entity ids a worker currently owns
+    const std::vector<int>& assigned_entities(int worker_id) const {
+        return assigned_.at(static_cast<size_t>(worker_id));
+    }
+
+    /// Capability report of a registered worker
+    const WorkerInfo& worker_info(int worker_id) const {
+        return worker_info_.at(static_cast<size_t>(worker_id));
+    }
+
     int num_connected() const { return static_cast<int>(worker_sockets_.size()); }
 
     double current_time() const { return current_time_; }
 
+    /// Step barrier with per-worker latency statistics (null before start())
+    const TimeBarrier* barrier() const { return barrier_.get(); }
+
 private:
     IPCSocket server_socket_;
     std::vector<IPCSocket> worker_sockets_;
+    std::vector<WorkerInfo> worker_info_;
+    std::vector<std::string> init_payloads_;   // Per worker, re-sent on a rejoin
+    int rejoin_timeout_ms_ = 5000;
+
+    std::vector<std::vector<int>> assigned_;            // Entity ids per worker (after migrations)
+    std::unordered_map<int, size_t> entity_order_;      // Entity id -> gather_states() position
+    std::unordered_map<int, double> entity_cost_;       // [s] per update, smoothed over reports
+    int balance_interval_ = 0;
+    double balance_ratio_ = 1.25;
+    uint64_t step_count_ = 0;
+    int migrations_ = 0;
+
+    SpatialDecomposition spatial_;
+    bool spatial_active_ = false;
+    std::vector<std::vector<wire::StateRecord>> ghost_out_;   // Per worker, sent before the next STEP
+
+    struct Subscription {
+        SyncInterest interest;
+        std::vector<DeltaFilter> shm_filters;   // Per worker, shared-memory workers only
+    };
+    std::unordered_map<int, Subscription> subscriptions_;
+    int next_subscription_ = 0;
+
+    bool lookahead_sync_ = false;
+    std::vector<double> lookahead_;   // [s] declared per worker (0 = none)
+    uint64_t round_trips_ = 0;
     std::unique_ptr<TimeBarrier> barrier_;
     double current_time_ = 0.0;
 
-    /// Send a message to all connected workers
-    void broadcast(const IPCMessage& msg);
+    int epoll_fd_ = -1;                                  // Worker sockets, data.u32 = index
+    std::chrono::steady_clock::time_point dispatch_time_;   // Last broadcast
+    std::vector<double> response_latency_;               // [s] per worker, last collect (-1 none)
+
+    std::string shm_name_;
+    ShmRegion shm_region_;
+    std::vector<ShmChannel> shm_channels_;   // Per worker; invalid = socket transport
+    std::vector<size_t> shm_counts_;         // Records in each slot after a sync
+
+    /// Send a message to all connected workers (dt rides along for STEP)
+    void broadcast(const IPCMessage& msg, double dt = 0.0);
 
-    /// Collect one response from each worker (with timeout)
+    /// Collect one response from each worker, in arrival order (with timeout)
     std::vector<IPCMessage> collect_responses(int timeout_ms = 5000);
+
+    /// Register an accepted worker's socket in slot `slot` (poll set and info)
+    bool attach_worker(size_t slot, IPCSocket&& worker, const IPCMessage& ready);
+
+    /// Accept rejoining workers until every slot is connected or the timeout passes
+    bool await_rejoin(int timeout_ms);
+
+    /// INIT payload for a worker's current entities (and slab, if spatial)
+    std::string init_payload(size_t worker) const;
+
+    /// Slab owning a position coordinate
+    size_t region_of(double coordinate) const;
+
+    /// Route boundary states to neighbouring slabs and hand over leaving entities
+    void exchange_boundaries(const std::vector<IPCMessage>& responses);
+
+    /// run_until() under lookahead synchronization
+    bool advance_until(double end_time, double dt);
+
+    /// Wait for the first response from a pending worker (clears its flag)
+    bool next_response(std::vector<char>& pending, size_t& worker, IPCMessage& msg,
+                       int timeout_ms);
+
+    /// Fold a STEP_COMPLETE cost report ({"costs":[id,s,...]}) into entity_cost_
+    void record_costs(const std::string& payload);
+
+    /// Plan and carry out migrations if the measured loads are out of balance
+    void rebalance();
+
+    /// Move entities (with state) from one worker to another
+    bool migrate(size_t from, size_t to, const std::vector<int>& entity_ids);
+
+    /// Store a worker's response and its latency since the last broadcast
+    void record_response(size_t worker, IPCMessage&& msg, std::vector<IPCMessage>& responses);
 };
 
 }} // namespace sim::distributed
@@ -1,9 +1,18 @@
 #include "distributed/sim_worker.hpp"
+#include "distributed/tracing.hpp"
 
 #include <sstream>
 #include <iostream>
 #include <stdexcept>
+#include <cstdlib>
 #include <cstring>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+#include <time.h>
+#include <unistd.h>
 
 namespace sim { namespace distributed {
 
@@ -29,6 +38,21 @@ static double extract_number(const std::string& json, const std::string& key) {
     return std::stod(num_str);
 }
 
+/// Extract a JSON string value for a given key (no escapes)
+static std::string extract_string(const std::string& json, const std::string& key) {
+    std::string search = "\"" + key + "\"";
+    auto pos = json.find(search);
+    if (pos == std::string::npos) return "";
+    pos = json.find(':', pos + search.size());
+    if (pos == std::string::npos) return "";
+    pos = json.find('\"', pos + 1);
+    if (pos == std::string::npos) return "";
+    ++pos;
+    auto end = json.find('\"', pos);
+    if (end == std::string::npos) return "";
+    return json.substr(pos, end - pos);
+}
+
 /// Parse integer array from JSON: [0,1,2]
 static std::vector<int> parse_int_array(const std::string& json, const std::string& key) {
     std::vector<int> result;
@@ -62,6 +86,41 @@ static std::vector<int> parse_int_array(const std::string& json, const std::stri
     return result;
 }
 
+/// Parse rows of numbers from JSON: "key":[[1,2],[3,4]]
+static std::vector<std::vector<double>> parse_number_rows(const std::string& json,
+                                                          const std::string& key) {
+    std::vector<std::vector<double>> rows;
+    auto pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return rows;
+    pos = json.find('[', pos);
+    if (pos == std::string::npos) return rows;
+
+    const char* p = json.c_str() + pos + 1;
+    for (;;) {
+        while (*p == ' ' || *p == ',') ++p;
+        if (*p != '[') break;
+        ++p;
+        std::vector<double> row;
+        for (;;) {
+            while (*p == ' ' || *p == ',') ++p;
+            if (*p == ']' || *p == '\0') break;
+            char* end = nullptr;
+            double v = std::strtod(p, &end);
+            if (end == p) return rows;   // Malformed; keep the complete rows
+            row.push_back(v);
+            p = end;
+        }
+        if (*p != ']') break;
+        ++p;
+        rows.push_back(std::move(row));
+    }
+    return rows;
+}
+
+/// Fields of one migrated entity row: id, pos, vel, attitude, angular velocity, time, frame
+/// (then mass, when known)
+static constexpr size_t MIGRATE_FIELDS = 16;
+
 // ---------------------------------------------------------------------------
 // SimWorker
 // ---------------------------------------------------------------------------
@@ -81,8 +140,8 @@ bool SimWorker::connect() {
     try {
         socket_ = IPCSocket::connect(socket_path_);
 
-        // Send READY to coordinator
-        IPCMessage ready(MessageType::READY, "{}", 0.0);
+        // Send READY (capability report) to coordinator
+        IPCMessage ready(MessageType::READY, ready_payload(), 0.0);
         return socket_.send(ready);
     } catch (const std::exception& e) {
         std::cerr << "[Worker] Connection failed: " << e.what() << std::endl;
@@ -90,6 +149,36 @@ bool SimWorker::connect() {
     }
 }
 
+std::string SimWorker::ready_payload() const {
+    char host[256] = {0};
+    if (::gethostname(host, sizeof(host) - 1) != 0) host[0] = '\0';
+    long pages = ::sysconf(_SC_PHYS_PAGES);
+    long page_size = ::sysconf(_SC_PAGESIZE);
+    long long memory_mb = (pages > 0 && page_size > 0)
+                              ? static_cast<long long>(pages) * page_size / (1024 * 1024)
+                              : 0;
+
+    std::ostringstream oss;
+    oss << "{\"host\":\"" << host << "\",\"cores\":" << std::thread::hardware_concurrency()
+        << ",\"memory_mb\":" << memory_mb;
+    if (worker_id_ >= 0) oss << ",\"worker_id\":" << worker_id_;
+    oss << "}";
+    return oss.str();
+}
+
+bool SimWorker::reconnect() {
+    socket_.close();
+    // Replies may have been lost with the connection: deltas restart from scratch
+    sync_filters_.clear();
+    for (int attempt = 1; attempt <= reconnect_attempts_; ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(reconnect_delay_ms_));
+        std::cerr << "[Worker] Reconnecting (attempt " << attempt << "/"
+                  << reconnect_attempts_ << ")..." << std::endl;
+        if (connect()) return true;
+    }
+    return false;
+}
+
 void SimWorker::run() {
     if (!socket_.is_connected()) {
         std::cerr << "[Worker] Not connected, cannot run." << std::endl;
@@ -104,6 +193,10 @@ void SimWorker::run() {
             switch (msg.type) {
                 case MessageType::INIT:
                     handle_init(msg);
+                    if (shm_.valid()) {
+                        run_shared_memory();
+                        running = false;
+                    }
                     break;
 
                 case MessageType::STEP:
@@ -114,6 +207,18 @@ void SimWorker::run() {
                     handle_sync_request(msg);
                     break;
 
+                case MessageType::MIGRATE_OUT:
+                    handle_migrate_out(msg);
+                    break;
+
+                case MessageType::MIGRATE_IN:
+                    handle_migrate_in(msg);
+                    break;
+
+                case MessageType::GHOSTS:
+                    ghosts_ = std::move(msg.states);
+                    break;
+
                 case MessageType::SHUTDOWN:
                     std::cout << "[Worker] Received SHUTDOWN." << std::endl;
                     running = false;
@@ -126,7 +231,8 @@ void SimWorker::run() {
             }
         } catch (const std::exception& e) {
             std::cerr << "[Worker] Error in event loop: " << e.what() << std::endl;
-            running = false;
+            // The shared-memory rings do not survive the coordinator's slot reset
+            running = !shm_.valid() && reconnect();
         }
     }
 
@@ -137,77 +243,362 @@ void SimWorker::set_update_function(UpdateFunction fn) {
     update_fn_ = std::move(fn);
 }
 
+void SimWorker::set_batch_propagator(std::shared_ptr<BatchPropagator> propagator, int threads,
+                                     const sim::ThreadPlacement& placement) {
+    batch_ = std::move(propagator);
+    batch_pool_.reset(batch_ ? new sim::ThreadPool(threads, placement) : nullptr);
+}
+
 void SimWorker::handle_init(const IPCMessage& msg) {
     // Parse entity IDs from payload: {"worker_id":0,"entity_ids":[0,1]}
-    entity_ids_ = parse_int_array(msg.payload, "entity_ids");
+    std::vector<int> ids = parse_int_array(msg.payload, "entity_ids");
+    worker_id_ = static_cast<int>(extract_number(msg.payload, "worker_id"));
 
-    // Create a StateVector for each entity
-    states_.clear();
-    states_.resize(entity_ids_.size());
+    // Same assignment after a reconnect: keep the propagated states
+    bool resume = !ids.empty() && ids == entity_ids_ && states_.size() == ids.size();
+    entity_ids_ = std::move(ids);
 
-    // Initialize time from the message timestamp
-    for (auto& sv : states_) {
-        sv.time = msg.timestamp;
+    if (!resume) {
+        // Create a StateVector for each entity
+        states_.clear();
+        states_.resize(entity_ids_.size());
+
+        // Initialize time from the message timestamp
+        for (auto& sv : states_) {
+            sv.time = msg.timestamp;
+        }
     }
 
-    std::cout << "[Worker] Initialized with " << entity_ids_.size() << " entities: ";
+    std::cout << "[Worker] " << (resume ? "Resumed" : "Initialized") << " with " << entity_ids_.size() << " entities: ";
     for (size_t i = 0; i < entity_ids_.size(); ++i) {
         if (i > 0) std::cout << ", ";
         std::cout << entity_ids_[i];
     }
     std::cout << std::endl;
 
+    // Spatial mode: this worker's slab
+    spatial_ = msg.payload.find("\"spatial\":true") != std::string::npos;
+    if (spatial_) {
+        axis_ = std::min(2, std::max(0, static_cast<int>(extract_number(msg.payload, "axis"))));
+        lo_ = extract_number(msg.payload, "lo");
+        hi_ = extract_number(msg.payload, "hi");
+        halo_ = extract_number(msg.payload, "halo");
+    }
+    ghosts_.clear();
+
+    // Shared-memory transport, if the coordinator offers one
+    std::string shm_name = extract_string(msg.payload, "shm");
+    if (!shm_name.empty()) {
+        try {
+            shm_region_ = ShmRegion::attach(shm_name);
+            shm_ = shm_region_.channel(static_cast<int>(extract_number(msg.payload, "worker_id")),
+                                       false);
+            if (shm_.valid() && shm_.capacity() < states_.size()) shm_ = ShmChannel();
+        } catch (const std::exception& e) {
+            std::cerr << "[Worker] Shared memory unavailable: " << e.what() << std::endl;
+        }
+        if (!shm_.valid()) shm_region_.close();
+    }
+
     // Acknowledge with READY
-    IPCMessage ack(MessageType::READY, "{}", msg.timestamp);
+    std::ostringstream oss;
+    oss << "{\"lookahead\":" << lookahead_ << (shm_.valid() ? ",\"shm\":true}" : "}");
+    IPCMessage ack(MessageType::READY, oss.str(), msg.timestamp);
     socket_.send(ack);
 }
 
+void SimWorker::run_shared_memory() {
+    std::cout << "[Worker] Using shared memory transport." << std::endl;
+
+    for (;;) {
+        shm::Command cmd;
+        if (!shm_.receive(cmd, 1000)) {
+            if (socket_.peer_closed()) {
+                std::cerr << "[Worker] Coordinator disconnected." << std::endl;
+                return;
+            }
+            continue;
+        }
+
+        switch (static_cast<MessageType>(cmd.type)) {
+            case MessageType::STEP: {
+                // count > 1: a lookahead grant of several dt
+                uint32_t steps = std::max<uint32_t>(cmd.count, 1);
+                for (uint32_t k = 0; k < steps; ++k) step_entities(cmd.dt);
+                shm::Command complete;
+                complete.type = static_cast<uint32_t>(MessageType::STEP_COMPLETE);
+                complete.timestamp = cmd.timestamp + steps * cmd.dt;
+                shm_.send(complete);
+                break;
+            }
+
+            case MessageType::SYNC_REQUEST: {
+                // States go straight into the coordinator-visible slot
+                size_t n = std::min(states_.size(), shm_.capacity());
+                pack_states(shm_.states(), n);
+                shm::Command response;
+                response.type = static_cast<uint32_t>(MessageType::SYNC_RESPONSE);
+                response.count = static_cast<uint32_t>(n);
+                response.timestamp = cmd.timestamp;
+                shm_.send(response);
+                break;
+            }
+
+            case MessageType::SHUTDOWN:
+                std::cout << "[Worker] Received SHUTDOWN." << std::endl;
+                return;
+
+            default:
+                std::cerr << "[Worker] Unknown message type: " << cmd.type << std::endl;
+                break;
+        }
+    }
+}
+
 void SimWorker::handle_step(const IPCMessage& msg) {
-    // Parse dt from payload: {"dt":60.0,"time":0.0}
+    TraceSpan trace_step("worker.handle_step", msg.trace);
+    // Parse dt from payload: {"dt":60.0,"time":0.0}, "steps":k for a multi-step grant
     double dt = extract_number(msg.payload, "dt");
+    int steps = std::max(1, static_cast<int>(extract_number(msg.payload, "steps")));
+    double end = msg.timestamp + steps * dt;
+    bool want_costs = msg.payload.find("\"costs\":true") != std::string::npos;
+
+    // A step already applied before a reconnect (its reply was lost) is only acknowledged
+    bool applied = !states_.empty() && states_.front().time >= end - 1e-9;
+    std::vector<double> costs;
+    {
+        TraceSpan trace_compute("worker.compute");
+        for (int k = 0; k < steps && !applied; ++k) {
+            step_entities(dt, want_costs && k + 1 == steps ? &costs : nullptr);
+        }
+    }
+
+    // Send STEP_COMPLETE, with {"costs":[id,seconds,...]} when asked
+    std::string payload = "{}";
+    if (!costs.empty()) {
+        std::ostringstream oss;
+        oss << "{\"costs\":[";
+        for (size_t i = 0; i < costs.size(); ++i) {
+            if (i > 0) oss << ",";
+            oss << entity_ids_[i] << "," << costs[i];
+        }
+        oss << "]}";
+        payload = oss.str();
+    }
+    if (spatial_) {
+        send_boundary(end);
+        return;
+    }
+    IPCMessage complete(MessageType::STEP_COMPLETE, payload, end);
+    socket_.send(complete);
+}
+
+void SimWorker::send_boundary(double timestamp) {
+    // Only the halo band next to the slab edges, plus entities that left it
+    sync_records_.clear();
+    for (size_t i = 0; i < states_.size(); ++i) {
+        const auto& p = states_[i].position;
+        double c = axis_ == 0 ? p.x : axis_ == 1 ? p.y : p.z;
+        bool leaving = c < lo_ || c >= hi_;
+        if (!leaving && c >= lo_ + halo_ && c < hi_ - halo_) continue;
+
+        sync_records_.emplace_back();
+        pack_state(i, sync_records_.back());
+        if (leaving) sync_records_.back().reserved = wire::RECORD_LEAVING;
+    }
+    socket_.send_states(MessageType::STEP_COMPLETE, timestamp, sync_records_.data(),
+                        sync_records_.size());
+}
 
-    // Update each entity
+void SimWorker::step_entities(double dt, std::vector<double>* costs) {
+    if (batch_) {
+        step_batch(dt, costs);
+        return;
+    }
+    if (costs) {
+        // Profiled step, only when balancing asks: thread CPU time, so time
+        // spent descheduled (other workers sharing the core) is not billed
+        costs->resize(entity_ids_.size());
+        struct timespec t0, t1;
+        ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+        for (size_t i = 0; i < entity_ids_.size(); ++i) {
+            update_fn_(entity_ids_[i], dt, states_[i]);
+            states_[i].time += dt;
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+            (*costs)[i] = static_cast<double>(t1.tv_sec - t0.tv_sec) +
+                          1e-9 * static_cast<double>(t1.tv_nsec - t0.tv_nsec);
+            t0 = t1;
+        }
+        return;
+    }
     for (size_t i = 0; i < entity_ids_.size(); ++i) {
         update_fn_(entity_ids_[i], dt, states_[i]);
         states_[i].time += dt;
     }
+}
 
-    // Send STEP_COMPLETE
-    IPCMessage complete(MessageType::STEP_COMPLETE, "{}", msg.timestamp + dt);
-    socket_.send(complete);
+void SimWorker::step_batch(double dt, std::vector<double>* costs) {
+    const size_t n = entity_ids_.size();
+    if (n == 0) return;
+
+    for (auto& a : soa_) a.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto& sv = states_[i];
+        soa_[0][i] = sv.position.x;
+        soa_[1][i] = sv.position.y;
+        soa_[2][i] = sv.position.z;
+        soa_[3][i] = sv.velocity.x;
+        soa_[4][i] = sv.velocity.y;
+        soa_[5][i] = sv.velocity.z;
+        auto it = masses_.find(entity_ids_[i]);
+        soa_[6][i] = it != masses_.end() ? it->second : 0.0;
+    }
+
+    EntityBlock block;
+    block.ids = entity_ids_.data();
+    block.x = soa_[0].data();
+    block.y = soa_[1].data();
+    block.z = soa_[2].data();
+    block.vx = soa_[3].data();
+    block.vy = soa_[4].data();
+    block.vz = soa_[5].data();
+    block.mass = soa_[6].data();
+    block.size = n;
+    block.time = states_.front().time;
+
+    // Chunks run concurrently; a profiled step bills each chunk's thread CPU
+    // time evenly to its entities (an offloaded block bills its wall time)
+    const size_t chunk = std::max<size_t>(batch_->chunk_size(), 1);
+    const size_t chunks = (n + chunk - 1) / chunk;
+    if (costs) costs->resize(n);
+    auto start = std::chrono::steady_clock::now();
+    if (batch_->advance_block(block, dt)) {
+        if (costs) {
+            std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+            std::fill(costs->begin(), costs->end(), seconds.count() / static_cast<double>(n));
+        }
+    } else {
+        batch_pool_->parallel_for(chunks, [&](size_t c) {
+            size_t begin = c * chunk;
+            size_t end = std::min(n, begin + chunk);
+            struct timespec t0, t1;
+            if (costs) ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+            batch_->advance(block, begin, end, dt);
+            if (costs) {
+                ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+                double seconds = static_cast<double>(t1.tv_sec - t0.tv_sec) +
+                                 1e-9 * static_cast<double>(t1.tv_nsec - t0.tv_nsec);
+                std::fill(costs->begin() + begin, costs->begin() + end,
+                          seconds / static_cast<double>(end - begin));
+            }
+        });
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        auto& sv = states_[i];
+        sv.position = sim::Vec3(soa_[0][i], soa_[1][i], soa_[2][i]);
+        sv.velocity = sim::Vec3(soa_[3][i], soa_[4][i], soa_[5][i]);
+        sv.time += dt;
+    }
 }
 
 void SimWorker::handle_sync_request(const IPCMessage& msg) {
-    std::string payload = serialize_states();
+    TraceSpan trace_sync("worker.handle_sync_request", msg.trace);
+    sync_records_.resize(states_.size());
+    pack_states(sync_records_.data(), sync_records_.size());
+
+    // {"sub":id,...}: only what changed for that subscriber; "drop" ends it
+    SyncInterest interest;
+    int subscription = SyncInterest::from_payload(msg.payload, interest);
+    if (subscription < 0) {
+        socket_.send_states(MessageType::SYNC_RESPONSE, msg.timestamp,
+                            sync_records_.data(), sync_records_.size());
+        return;
+    }
 
-    IPCMessage response(MessageType::SYNC_RESPONSE, payload, msg.timestamp);
-    socket_.send(response);
+    delta_records_.clear();
+    if (msg.payload.find("\"drop\":true") != std::string::npos) {
+        sync_filters_.erase(subscription);
+    } else {
+        sync_filters_[subscription].filter(interest, sync_records_.data(),
+                                           sync_records_.size(), delta_records_);
+    }
+    socket_.send_states(MessageType::SYNC_RESPONSE, msg.timestamp,
+                        delta_records_.data(), delta_records_.size());
 }
 
-std::string SimWorker::serialize_states() const {
-    std::ostringstream oss;
-    oss << "{\"states\":[";
-
-    for (size_t i = 0; i < states_.size(); ++i) {
-        if (i > 0) oss << ",";
+void SimWorker::handle_migrate_out(const IPCMessage& msg) {
+    // Release the listed entities: {"entity_ids":[3,4]}
+    std::vector<int> ids = parse_int_array(msg.payload, "entity_ids");
+    std::unordered_set<int> release(ids.begin(), ids.end());
 
+    std::ostringstream oss;
+    oss << std::setprecision(17) << "{\"entities\":[";
+    std::vector<int> kept_ids;
+    std::vector<sim::StateVector> kept_states;
+    bool first = true;
+    for (size_t i = 0; i < entity_ids_.size(); ++i) {
+        if (release.count(entity_ids_[i]) == 0) {
+            kept_ids.push_back(entity_ids_[i]);
+            kept_states.push_back(states_[i]);
+            continue;
+        }
         const auto& sv = states_[i];
-        int eid = (i < entity_ids_.size()) ? entity_ids_[i] : -1;
+        oss << (first ? "" : ",") << "[" << entity_ids_[i] << ","
+            << sv.position.x << "," << sv.position.y << "," << sv.position.z << ","
+            << sv.velocity.x << "," << sv.velocity.y << "," << sv.velocity.z << ","
+            << sv.attitude.w << "," << sv.attitude.x << "," << sv.attitude.y << ","
+            << sv.attitude.z << "," << sv.angular_velocity.x << "," << sv.angular_velocity.y << ","
+            << sv.angular_velocity.z << "," << sv.time << "," << static_cast<int>(sv.frame);
+        auto mass = masses_.find(entity_ids_[i]);
+        if (mass != masses_.end()) {
+            oss << "," << mass->second;
+            masses_.erase(mass);
+        }
+        oss << "]";
+        first = false;
+    }
+    oss << "]}";
+    entity_ids_ = std::move(kept_ids);
+    states_ = std::move(kept_states);
+
+    socket_.send(IPCMessage(MessageType::MIGRATE_STATE, oss.str(), msg.timestamp));
+}
 
-        oss << "{"
-            << "\"entity_id\":" << eid
-            << ",\"px\":" << sv.position.x
-            << ",\"py\":" << sv.position.y
-            << ",\"pz\":" << sv.position.z
-            << ",\"vx\":" << sv.velocity.x
-            << ",\"vy\":" << sv.velocity.y
-            << ",\"vz\":" << sv.velocity.z
-            << ",\"time\":" << sv.time
-            << "}";
+void SimWorker::handle_migrate_in(const IPCMessage& msg) {
+    for (const auto& row : parse_number_rows(msg.payload, "entities")) {
+        if (row.size() < MIGRATE_FIELDS) continue;
+        sim::StateVector sv;
+        sv.position = sim::Vec3(row[1], row[2], row[3]);
+        sv.velocity = sim::Vec3(row[4], row[5], row[6]);
+        sv.attitude = sim::Quat(row[7], row[8], row[9], row[10]);
+        sv.angular_velocity = sim::Vec3(row[11], row[12], row[13]);
+        sv.time = row[14];
+        sv.frame = static_cast<sim::CoordinateFrame>(static_cast<int>(row[15]));
+        if (row.size() > MIGRATE_FIELDS) masses_[static_cast<int>(row[0])] = row[MIGRATE_FIELDS];
+        entity_ids_.push_back(static_cast<int>(row[0]));
+        states_.push_back(sv);
     }
 
-    oss << "]}";
-    return oss.str();
+    IPCMessage ack(MessageType::READY, "{}", msg.timestamp);
+    socket_.send(ack);
+}
+
+void SimWorker::pack_states(wire::StateRecord* out, size_t count) const {
+    for (size_t i = 0; i < count; ++i) pack_state(i, out[i]);
+}
+
+void SimWorker::pack_state(size_t i, wire::StateRecord& r) const {
+    const auto& sv = states_[i];
+    r.entity_id = (i < entity_ids_.size()) ? entity_ids_[i] : -1;
+    r.reserved = 0;
+    r.state[0] = sv.position.x;
+    r.state[1] = sv.position.y;
+    r.state[2] = sv.position.z;
+    r.state[3] = sv.velocity.x;
+    r.state[4] = sv.velocity.y;
+    r.state[5] = sv.velocity.z;
+    r.time = sv.time;
 }
 
 }} // namespace sim::distributed
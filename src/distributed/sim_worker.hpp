@@ -1,11 +1,17 @@
 #ifndef SIM_SIM_WORKER_HPP
 #define SIM_SIM_WORKER_HPP
 
+#include "batch_propagator.hpp"
 #include "ipc_socket.hpp"
+#include "shm_transport.hpp"
+#include "state_sync.hpp"
 #include "core/state_vector.hpp"
+#include "utils/thread_pool.hpp"
+#include <memory>
 #include <vector>
 #include <string>
 #include <functional>
+#include <unordered_map>
 
 namespace sim { namespace distributed {
 
@@ -15,15 +21,51 @@ namespace sim { namespace distributed {
  * The worker connects to a coordinator, receives entity assignments,
  * and repeatedly steps its entities forward when instructed.
  * Users provide a custom update function to define per-entity physics.
+ * When INIT names a shared-memory region, stepping and state syncs move
+ * to that region's rings after the READY acknowledgement.
+ *
+ * READY carries a capability report (host, cores, memory). If the socket
+ * connection drops, the worker reconnects (a few attempts, see
+ * set_reconnect()) and re-registers under its worker_id, keeping its
+ * entity states when the coordinator re-sends the same assignment.
+ *
+ * For load balancing, a STEP may ask for per-entity update costs (timed
+ * around each update call, returned with STEP_COMPLETE), and MIGRATE_OUT /
+ * MIGRATE_IN hand entities and their full state to another worker.
+ *
+ * In spatial mode (INIT carries a slab), STEP_COMPLETE is a state frame
+ * of the entities near the slab edges and of those that left it, and
+ * GHOSTS replaces the read-only neighbour states visible through ghosts()
+ * before each step, so an update function can look across workers.
+ *
+ * set_lookahead() declares how far ahead of its own clock this worker's
+ * entities can first influence other workers; under lookahead
+ * synchronization a STEP may then cover several dt at once.
+ *
+ * A SYNC_REQUEST naming a subscription (see SyncInterest) is answered
+ * with the delta for that subscriber only: the worker remembers what it
+ * last sent each one and forgets it all on a reconnect, so the next sync
+ * after a lost reply is complete again.
+ *
+ * set_batch_propagator() replaces the per-entity update function: each
+ * step the worker's states are laid out as structure-of-arrays spans
+ * (EntityBlock) and handed to the propagator in chunks run on an internal
+ * thread pool, then written back. Masses travel with migrated entities.
  */
 class SimWorker {
 public:
     explicit SimWorker(const std::string& socket_path);
     ~SimWorker();
 
-    /// Connect to the coordinator's Unix domain socket
+    /// Connect to the coordinator (Unix path, tcp:// or tls://) and register
     bool connect();
 
+    /// Reconnect policy after a lost connection (attempts = 0 disables)
+    void set_reconnect(int attempts, int delay_ms) {
+        reconnect_attempts_ = attempts;
+        reconnect_delay_ms_ = delay_ms;
+    }
+
     /// Main event loop: blocks until SHUTDOWN is received
     void run();
 
@@ -31,17 +73,67 @@ public:
     using UpdateFunction = std::function<void(int entity_id, double dt, sim::StateVector& state)>;
     void set_update_function(UpdateFunction fn);
 
+    /// Batched physics over the whole block per step (nullptr: back to the
+    /// update function); threads = 0 uses hardware concurrency, placed per
+    /// `placement` on NUMA hosts
+    void set_batch_propagator(std::shared_ptr<BatchPropagator> propagator, int threads = 0,
+                              const sim::ThreadPlacement& placement = sim::ThreadPlacement());
+
+    /// Mass [kg] of an entity, as seen by a batch propagator (may precede INIT)
+    void set_mass(int entity_id, double mass) { masses_[entity_id] = mass; }
+
+    /// Minimum time [s] before this worker's entities can affect others
+    /// (reported with the INIT acknowledgement; 0 = lock-step)
+    void set_lookahead(double seconds) { lookahead_ = seconds; }
+
+    /// Owned entities, for interactions inside an update function
+    const std::vector<int>& entity_ids() const { return entity_ids_; }
+    const std::vector<sim::StateVector>& states() const { return states_; }
+
+    /// Neighbouring workers' entities near this slab, as of the start of the step
+    const std::vector<wire::StateRecord>& ghosts() const { return ghosts_; }
+
 private:
     IPCSocket socket_;
     std::string socket_path_;
     std::vector<int> entity_ids_;
     std::vector<sim::StateVector> states_;
     UpdateFunction update_fn_;
+    std::unordered_map<int, double> masses_;        // Known masses [kg] by entity
+    std::shared_ptr<BatchPropagator> batch_;
+    std::unique_ptr<sim::ThreadPool> batch_pool_;
+    std::vector<double> soa_[7];                    // x, y, z, vx, vy, vz, mass of the block
+    std::vector<wire::StateRecord> sync_records_;   // Reused for every SYNC_RESPONSE
+    ShmRegion shm_region_;
+    ShmChannel shm_;
+    int worker_id_ = -1;              // From INIT; names the slot on reconnect
+    int reconnect_attempts_ = 5;
+    int reconnect_delay_ms_ = 1000;
+    double lookahead_ = 0.0;
+
+    bool spatial_ = false;            // Slab [lo_, hi_) along axis_ (from INIT)
+    int axis_ = 0;
+    double lo_ = 0.0;
+    double hi_ = 0.0;
+    double halo_ = 0.0;
+    std::vector<wire::StateRecord> ghosts_;
+
+    std::unordered_map<int, DeltaFilter> sync_filters_;   // Per subscription
+    std::vector<wire::StateRecord> delta_records_;
 
+    std::string ready_payload() const;
+    bool reconnect();
     void handle_init(const IPCMessage& msg);
     void handle_step(const IPCMessage& msg);
     void handle_sync_request(const IPCMessage& msg);
-    std::string serialize_states() const;
+    void handle_migrate_out(const IPCMessage& msg);
+    void handle_migrate_in(const IPCMessage& msg);
+    void send_boundary(double timestamp);
+    void run_shared_memory();
+    void step_entities(double dt, std::vector<double>* costs = nullptr);
+    void step_batch(double dt, std::vector<double>* costs);
+    void pack_states(wire::StateRecord* out, size_t count) const;
+    void pack_state(size_t index, wire::StateRecord& out) const;
 };
 
 }} // namespace sim::distributed
@@ -0,0 +1,160 @@
+#include "distributed/state_sync.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace sim { namespace distributed {
+
+// ---------------------------------------------------------------------------
+// JSON helpers (local to this TU)
+// ---------------------------------------------------------------------------
+
+/// Numbers of a flat JSON array "key":[1,2,3] (empty if the key is absent)
+static std::vector<double> parse_number_array(const std::string& json, const std::string& key) {
+    std::vector<double> values;
+    auto pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return values;
+    pos = json.find('[', pos);
+    if (pos == std::string::npos) return values;
+
+    const char* p = json.c_str() + pos + 1;
+    for (;;) {
+        while (*p == ' ' || *p == ',') ++p;
+        if (*p == ']' || *p == '\0') break;
+        char* end = nullptr;
+        double v = std::strtod(p, &end);
+        if (end == p) break;
+        values.push_back(v);
+        p = end;
+    }
+    return values;
+}
+
+/// A JSON number for a key, or fallback if absent
+static double extract_number(const std::string& json, const std::string& key, double fallback) {
+    auto pos = json.find("\"" + key + "\"");
+    if (pos == std::string::npos) return fallback;
+    pos = json.find(':', pos);
+    if (pos == std::string::npos) return fallback;
+    char* end = nullptr;
+    double v = std::strtod(json.c_str() + pos + 1, &end);
+    return end == json.c_str() + pos + 1 ? fallback : v;
+}
+
+// ---------------------------------------------------------------------------
+// SyncInterest
+// ---------------------------------------------------------------------------
+
+bool SyncInterest::matches(const wire::StateRecord& r) const {
+    if (!entity_ids.empty() &&
+        std::find(entity_ids.begin(), entity_ids.end(), r.entity_id) == entity_ids.end()) {
+        return false;
+    }
+    if (use_box) {
+        for (int k = 0; k < 3; ++k) {
+            if (r.state[k] < box_min[k] || r.state[k] > box_max[k]) return false;
+        }
+    }
+    return true;
+}
+
+std::string SyncInterest::to_payload(int subscription) const {
+    std::ostringstream oss;
+    oss << std::setprecision(17) << "{\"sub\":" << subscription
+        << ",\"posTol\":" << position_tolerance << ",\"velTol\":" << velocity_tolerance;
+    if (dead_reckoning) oss << ",\"dr\":1";
+    if (!entity_ids.empty()) {
+        oss << ",\"ids\":[";
+        for (size_t i = 0; i < entity_ids.size(); ++i) {
+            oss << (i > 0 ? "," : "") << entity_ids[i];
+        }
+        oss << "]";
+    }
+    if (use_box) {
+        oss << ",\"box\":[" << box_min[0] << "," << box_min[1] << "," << box_min[2] << ","
+            << box_max[0] << "," << box_max[1] << "," << box_max[2] << "]";
+    }
+    oss << "}";
+    return oss.str();
+}
+
+int SyncInterest::from_payload(const std::string& payload, SyncInterest& out) {
+    int subscription = static_cast<int>(extract_number(payload, "sub", -1.0));
+    if (subscription < 0) return -1;
+
+    out = SyncInterest();
+    out.position_tolerance = extract_number(payload, "posTol", 0.0);
+    out.velocity_tolerance = extract_number(payload, "velTol", 0.0);
+    out.dead_reckoning = extract_number(payload, "dr", 0.0) != 0.0;
+    for (double id : parse_number_array(payload, "ids")) {
+        out.entity_ids.push_back(static_cast<int>(id));
+    }
+    std::vector<double> box = parse_number_array(payload, "box");
+    if (box.size() == 6) {
+        out.use_box = true;
+        std::copy(box.begin(), box.begin() + 3, out.box_min);
+        std::copy(box.begin() + 3, box.end(), out.box_max);
+    }
+    return subscription;
+}
+
+// ---------------------------------------------------------------------------
+// DeltaFilter
+// ---------------------------------------------------------------------------
+
+/// Whether r has drifted from the last sent state by more than the tolerances
+static bool moved(const SyncInterest& interest, const wire::StateRecord& last,
+                  const wire::StateRecord& r) {
+    double dp = 0.0, dv = 0.0;
+    const double ahead = interest.dead_reckoning ? r.time - last.time : 0.0;
+    for (int k = 0; k < 3; ++k) {
+        double a = r.state[k] - (last.state[k] + last.state[k + 3] * ahead);
+        double b = r.state[k + 3] - last.state[k + 3];
+        dp += a * a;
+        dv += b * b;
+    }
+    double pt = interest.position_tolerance;
+    double vt = interest.velocity_tolerance;
+    return dp > pt * pt || dv > vt * vt;
+}
+
+void DeltaFilter::filter(const SyncInterest& interest, const wire::StateRecord* records,
+                         size_t count, std::vector<wire::StateRecord>& out) {
+    ++pass_;
+    for (size_t i = 0; i < count; ++i) {
+        const wire::StateRecord& r = records[i];
+        auto it = sent_.find(r.entity_id);
+
+        if ((r.reserved & wire::RECORD_REMOVED) || !interest.matches(r)) {
+            if (it != sent_.end()) {
+                out.push_back(r);
+                out.back().reserved = wire::RECORD_REMOVED;
+                sent_.erase(it);
+            }
+            continue;
+        }
+
+        if (it == sent_.end()) {
+            sent_.emplace(r.entity_id, Sent{r, pass_});
+            out.push_back(r);
+            out.back().reserved = 0;
+            continue;
+        }
+        it->second.pass = pass_;
+        if (moved(interest, it->second.record, r)) {
+            it->second.record = r;
+            out.push_back(r);
+            out.back().reserved = 0;
+        }
+    }
+
+    // Entities that left this worker: their new owner reports them
+    for (auto it = sent_.begin(); it != sent_.end(); ) {
+        if (it->second.pass != pass_) it = sent_.erase(it);
+        else ++it;
+    }
+}
+
+}} // namespace sim::distributed
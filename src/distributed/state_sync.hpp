@@ -0,0 +1,69 @@
+#ifndef SIM_STATE_SYNC_HPP
+#define SIM_STATE_SYNC_HPP
+
+#include "ipc_socket.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim { namespace distributed {
+
+/**
+ * @brief What one delta-sync subscriber wants to see
+ *
+ * An entity is of interest when it is in entity_ids (empty = any) and,
+ * with use_box, inside [box_min, box_max]. It is resent only once its
+ * position or velocity has moved more than the tolerance from the state
+ * the subscriber last received (0 = any change). With dead_reckoning, the
+ * position is compared against the last one received carried forward at
+ * its velocity to the record's time, which is what a subscriber that
+ * extrapolates between updates displays.
+ */
+struct SyncInterest {
+    std::vector<int> entity_ids;
+    bool use_box = false;
+    double box_min[3] = {0.0, 0.0, 0.0};   // [m]
+    double box_max[3] = {0.0, 0.0, 0.0};
+    double position_tolerance = 0.0;       // [m]
+    double velocity_tolerance = 0.0;       // [m/s]
+    bool dead_reckoning = false;
+
+    bool matches(const wire::StateRecord& r) const;
+
+    /// SYNC_REQUEST payload: {"sub":id,"posTol","velTol","ids":[...],"box":[6],"dr"}
+    std::string to_payload(int subscription) const;
+
+    /// Parse a SYNC_REQUEST payload; returns the subscription id (-1 = full sync)
+    static int from_payload(const std::string& payload, SyncInterest& out);
+};
+
+/**
+ * @brief Per-subscriber record of what was last sent, yielding the delta
+ *
+ * filter() appends the records the subscriber must receive: entities of
+ * interest it has not seen or that moved beyond tolerance, and, flagged
+ * wire::RECORD_REMOVED, entities it has seen that are no longer of
+ * interest. Records already flagged RECORD_REMOVED in `records` (entities
+ * gone from the simulation) are never of interest. Entities absent from `records` (moved to another worker) are
+ * forgotten silently, since their new owner sends them.
+ */
+class DeltaFilter {
+public:
+    void filter(const SyncInterest& interest, const wire::StateRecord* records, size_t count,
+                std::vector<wire::StateRecord>& out);
+
+    /// Forget everything sent (the next filter() sends the full interest set)
+    void reset() { sent_.clear(); }
+
+private:
+    struct Sent {
+        wire::StateRecord record;
+        uint64_t pass = 0;
+    };
+    std::unordered_map<int, Sent> sent_;
+    uint64_t pass_ = 0;
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_STATE_SYNC_HPP
@@ -9,6 +9,7 @@ TimeBarrier::TimeBarrier(int num_workers)
     : num_workers_(num_workers),
       completed_(static_cast<size_t>(num_workers), false),
       success_(static_cast<size_t>(num_workers), false),
+      timing_(static_cast<size_t>(num_workers)),
       done_count_(0)
 {
     if (num_workers <= 0) {
@@ -31,7 +32,7 @@ bool TimeBarrier::wait_for_all(int timeout_ms) {
     return true;
 }
 
-void TimeBarrier::worker_done(int worker_id, bool success) {
+void TimeBarrier::worker_done(int worker_id, bool success, double latency_s) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (worker_id < 0 || worker_id >= num_workers_) {
@@ -43,6 +44,14 @@ void TimeBarrier::worker_done(int worker_id, bool success) {
         success_[static_cast<size_t>(worker_id)] = success;
         ++done_count_;
 
+        if (latency_s >= 0.0) {
+            WorkerTiming& t = timing_[static_cast<size_t>(worker_id)];
+            t.last = latency_s;
+            t.total += latency_s;
+            if (latency_s > t.max) t.max = latency_s;
+            ++t.steps;
+        }
+
         if (done_count_ >= num_workers_) {
             cv_.notify_all();
         }
@@ -64,4 +73,22 @@ bool TimeBarrier::all_succeeded() const {
     return true;
 }
 
+WorkerTiming TimeBarrier::timing(int worker_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (worker_id < 0 || worker_id >= num_workers_) return WorkerTiming();
+    return timing_[static_cast<size_t>(worker_id)];
+}
+
+int TimeBarrier::slowest_worker() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int slowest = -1;
+    for (int i = 0; i < num_workers_; ++i) {
+        const WorkerTiming& t = timing_[static_cast<size_t>(i)];
+        if (t.steps > 0 && (slowest < 0 || t.last > timing_[static_cast<size_t>(slowest)].last)) {
+            slowest = i;
+        }
+    }
+    return slowest;
+}
+
 }} // namespace sim::distributed
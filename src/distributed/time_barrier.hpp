@@ -3,16 +3,31 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <cstdint>
 #include <vector>
 
 namespace sim { namespace distributed {
 
+/// Step latency of one worker, accumulated over the steps it reported
+struct WorkerTiming {
+    double last = 0.0;     // [s]
+    double total = 0.0;    // [s]
+    double max = 0.0;      // [s]
+    uint64_t steps = 0;
+
+    double mean() const { return steps > 0 ? total / static_cast<double>(steps) : 0.0; }
+};
+
 /**
  * @brief Thread-safe synchronization barrier for coordinating worker completion
  *
  * The coordinator calls wait_for_all() to block until every worker has reported
  * completion for the current time step. Workers report via worker_done().
  * After the barrier releases, call reset() before the next step.
+ *
+ * worker_done() may carry the worker's step latency (dispatch to
+ * response); per-worker timing accumulates across resets so a straggler
+ * stands out in timing() and slowest_worker().
  */
 class TimeBarrier {
 public:
@@ -22,7 +37,7 @@ public:
     bool wait_for_all(int timeout_ms = 5000);
 
     /// Called by coordinator when a worker reports done for the current step
-    void worker_done(int worker_id, bool success);
+    void worker_done(int worker_id, bool success, double latency_s = -1.0);
 
     /// Reset the barrier for the next time step
     void reset();
@@ -32,12 +47,19 @@ public:
     /// Returns true only if all workers completed successfully
     bool all_succeeded() const;
 
+    /// Latency statistics of a worker (kept across reset())
+    WorkerTiming timing(int worker_id) const;
+
+    /// Worker with the highest latency on the last step (-1 if none reported)
+    int slowest_worker() const;
+
 private:
     int num_workers_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::condition_variable cv_;
     std::vector<bool> completed_;
     std::vector<bool> success_;
+    std::vector<WorkerTiming> timing_;
     int done_count_ = 0;
 };
 
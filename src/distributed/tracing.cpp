@@ -0,0 +1,245 @@
+#include "distributed/tracing.hpp"
+#include "io/json_writer.hpp"
+
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace sim { namespace distributed {
+
+namespace {
+
+thread_local TraceSpan* tls_current = nullptr;
+thread_local int tls_tid = -1;
+
+std::string hex64(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+std::string program_name() {
+    std::ifstream comm("/proc/self/comm");
+    std::string name;
+    if (!std::getline(comm, name) || name.empty()) name = "sim";
+    return name;
+}
+
+void flush_at_exit() {
+    Tracer& t = Tracer::global();
+    if (t.enabled() && !t.flush()) {
+        std::cerr << "[Trace] Cannot write " << t.output_path() << std::endl;
+    }
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// TraceContext
+// ---------------------------------------------------------------------------
+
+std::string TraceContext::to_string() const {
+    if (!valid()) return "";
+    return hex64(trace_id) + ":" + hex64(span_id);
+}
+
+TraceContext TraceContext::parse(const std::string& text) {
+    TraceContext ctx;
+    auto colon = text.find(':');
+    if (colon == std::string::npos) return ctx;
+    char* end = nullptr;
+    uint64_t trace = std::strtoull(text.c_str(), &end, 16);
+    if (end != text.c_str() + colon) return ctx;
+    uint64_t span = std::strtoull(text.c_str() + colon + 1, &end, 16);
+    if (*end != '\0') return ctx;
+    ctx.trace_id = trace;
+    ctx.span_id = span;
+    return ctx;
+}
+
+// ---------------------------------------------------------------------------
+// Tracer
+// ---------------------------------------------------------------------------
+
+Tracer::Tracer()
+    : id_state_(static_cast<uint64_t>(::getpid()) << 32 ^
+                static_cast<uint64_t>(TraceSpan::now_ns())) {}
+
+Tracer& Tracer::global() {
+    // Never destroyed: spans may close during exit
+    static Tracer* tracer = [] {
+        auto* t = new Tracer();
+        if (const char* path = std::getenv("SIM_TRACE")) {
+            if (*path) t->enable(path, program_name());
+        }
+        return t;
+    }();
+    return *tracer;
+}
+
+void Tracer::enable(const std::string& path, const std::string& process_name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        process_name_ = process_name;
+    }
+    static bool registered = (std::atexit(flush_at_exit), true);
+    (void)registered;
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+std::string Tracer::output_path() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string path = path_;
+    auto p = path.find("%p");
+    if (p != std::string::npos) path.replace(p, 2, std::to_string(::getpid()));
+    return path;
+}
+
+uint64_t Tracer::next_id() {
+    // splitmix64 over a shared counter: unique per process, spread across processes
+    uint64_t z = id_state_.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) +
+                 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+int Tracer::thread_index() {
+    if (tls_tid < 0) tls_tid = next_tid_.fetch_add(1, std::memory_order_relaxed);
+    return tls_tid;
+}
+
+TraceContext Tracer::current() {
+    return tls_current ? tls_current->context() : TraceContext();
+}
+
+void Tracer::record(const Event& e) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (events_.size() >= MAX_EVENTS) {
+        ++dropped_;
+        return;
+    }
+    events_.push_back(e);
+}
+
+bool Tracer::flush() {
+    const std::string path = output_path();
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int pid = static_cast<int>(::getpid());
+    sim::JsonWriter w(out, 0);
+    w.set_precision(0);
+    w.begin_object();
+    w.kv("displayTimeUnit", "ms");
+    if (dropped_ > 0) w.kv("droppedSpans", static_cast<int64_t>(dropped_));
+    w.key("traceEvents").begin_array();
+
+    w.begin_object();
+    w.kv("name", "process_name");
+    w.kv("ph", "M");
+    w.kv("pid", pid);
+    w.key("args").begin_object();
+    w.kv("name", process_name_ + " (" + std::to_string(pid) + ")");
+    w.end_object();
+    w.end_object();
+
+    for (const Event& e : events_) {
+        const double ts = e.start_ns * 1e-3;
+        w.begin_object();
+        w.kv("name", e.name);
+        w.kv("cat", e.category);
+        w.kv("ph", "X");
+        w.kv("ts", ts);
+        w.kv("dur", (e.end_ns - e.start_ns) * 1e-3);
+        w.kv("pid", pid);
+        w.kv("tid", e.tid);
+        w.key("args").begin_object();
+        w.kv("trace", hex64(e.trace_id));
+        w.kv("span", hex64(e.span_id));
+        if (e.parent_id) w.kv("parent", hex64(e.parent_id));
+        if (e.bytes >= 0) w.kv("bytes", e.bytes);
+        w.end_object();
+        w.end_object();
+
+        // Flow arrows: send (start) -> remote handler (finish), keyed by the send's span
+        if (e.flow_out || e.remote_parent) {
+            w.begin_object();
+            w.kv("name", "message");
+            w.kv("cat", "flow");
+            w.kv("ph", e.flow_out ? "s" : "f");
+            if (!e.flow_out) w.kv("bp", "e");
+            w.kv("id", hex64(e.flow_out ? e.span_id : e.parent_id));
+            w.kv("ts", ts);
+            w.kv("pid", pid);
+            w.kv("tid", e.tid);
+            w.end_object();
+        }
+    }
+    w.end_array();
+    w.end_object();
+    w.flush();
+    out << "\n";
+    return out.good();
+}
+
+// ---------------------------------------------------------------------------
+// TraceSpan
+// ---------------------------------------------------------------------------
+
+int64_t TraceSpan::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category) {
+    if (!Tracer::global().enabled()) return;
+    open(name, category, Tracer::current(), false);
+}
+
+TraceSpan::TraceSpan(const char* name, const TraceContext& remote, const char* category) {
+    if (!Tracer::global().enabled()) return;
+    open(name, category, remote, remote.valid());
+}
+
+void TraceSpan::open(const char* name, const char* category, const TraceContext& parent,
+                     bool remote) {
+    Tracer& t = Tracer::global();
+    active_ = true;
+    remote_parent_ = remote;
+    name_ = name;
+    category_ = category;
+    trace_id_ = parent.valid() ? parent.trace_id : t.next_id();
+    parent_id_ = parent.valid() ? parent.span_id : 0;
+    span_id_ = t.next_id();
+    outer_ = tls_current;
+    tls_current = this;
+    start_ns_ = now_ns();
+}
+
+TraceSpan::~TraceSpan() {
+    if (!active_) return;
+    const int64_t end = now_ns();
+    tls_current = outer_;
+    Tracer& t = Tracer::global();
+    t.record({name_, category_, start_ns_, end, t.thread_index(), trace_id_, span_id_,
+              parent_id_, remote_parent_, flow_out_, bytes_});
+}
+
+void TraceSpan::record_completed(const char* name, const char* category,
+                                 int64_t start_ns, int64_t end_ns, size_t bytes) {
+    Tracer& t = Tracer::global();
+    if (!t.enabled()) return;
+    const TraceContext parent = Tracer::current();
+    t.record({name, category, start_ns, end_ns, t.thread_index(),
+              parent.valid() ? parent.trace_id : t.next_id(), t.next_id(), parent.span_id,
+              false, false, static_cast<int64_t>(bytes)});
+}
+
+}} // namespace sim::distributed
@@ -0,0 +1,161 @@
+/**
+ * Tracing — Spans across the coordinator and its workers, written per
+ * process as Chrome trace-event JSON that merges into one timeline.
+ *
+ * A TraceSpan times a scope on the calling thread. Spans nest: the
+ * innermost open span is the parent of the next, and a span opened with
+ * no parent starts a new trace. IPCSocket::send() carries the sending
+ * span's context in the message header ("trace":"<trace>:<span>"), and
+ * the receiving side opens its handler span with that context as parent,
+ * so one coordinator step and the worker work it caused share a trace
+ * id. Flow events join the send to the remote handler, so a merged
+ * timeline draws an arrow from one process to the other. Shared-memory
+ * commands and binary state frames carry no context.
+ *
+ * Tracing is off unless enabled, by Tracer::enable() or the SIM_TRACE
+ * environment variable (the output path; "%p" becomes the process id).
+ * A disabled span costs one relaxed atomic load. Spans are buffered in
+ * memory (capped at MAX_EVENTS) and written by flush(), which also runs
+ * at exit. Timestamps are wall-clock microseconds since the epoch, so
+ * traces from several hosts line up as well as their clocks do;
+ * scripts/merge_traces.py concatenates the per-process files.
+ */
+
+#ifndef SIM_TRACING_HPP
+#define SIM_TRACING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sim { namespace distributed {
+
+/** Identity of a span as seen from another process. */
+struct TraceContext {
+    uint64_t trace_id = 0;
+    uint64_t span_id = 0;
+
+    bool valid() const { return trace_id != 0; }
+
+    /** "<trace hex>:<span hex>", or "" when invalid. */
+    std::string to_string() const;
+    /** Parse to_string() output; an invalid context on malformed input. */
+    static TraceContext parse(const std::string& text);
+};
+
+class Tracer {
+public:
+    static constexpr size_t MAX_EVENTS = 1u << 20;
+
+    /** The process-wide tracer (enabled here when SIM_TRACE is set). */
+    static Tracer& global();
+
+    /**
+     * Record from now on and write to `path` ("%p" = process id) on flush().
+     * @param process_name Label of this process in the merged timeline
+     */
+    void enable(const std::string& path, const std::string& process_name);
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /** Write every span recorded so far. @return false if the file failed */
+    bool flush();
+
+    /** Output path with "%p" substituted. */
+    std::string output_path() const;
+
+    /** Innermost open span on the calling thread (invalid if none). */
+    static TraceContext current();
+
+    /** Fresh nonzero id. */
+    uint64_t next_id();
+
+private:
+    friend class TraceSpan;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        int64_t start_ns;          // since the epoch
+        int64_t end_ns;
+        int tid;
+        uint64_t trace_id;
+        uint64_t span_id;
+        uint64_t parent_id;
+        bool remote_parent;        // parent_id is a span in another process
+        bool flow_out;             // a send: start of a flow to the receiver
+        int64_t bytes;             // -1 = none
+    };
+
+    Tracer();
+    void record(const Event& e);
+    int thread_index();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> id_state_;
+    std::atomic<int> next_tid_{0};
+    mutable std::mutex mutex_;
+    std::string path_;
+    std::string process_name_;
+    std::vector<Event> events_;
+    uint64_t dropped_ = 0;
+};
+
+/**
+ * Times its scope as one span. `name` and `category` must outlive the
+ * tracer (string literals).
+ */
+class TraceSpan {
+public:
+    /** Child of the thread's current span, or the root of a new trace. */
+    explicit TraceSpan(const char* name, const char* category = "sim");
+
+    /** Child of a span in another process (a new root if `remote` is invalid). */
+    TraceSpan(const char* name, const TraceContext& remote, const char* category = "sim");
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /** This span's context (invalid when tracing is off). */
+    TraceContext context() const { return {trace_id_, span_id_}; }
+
+    /** Attach a payload size to the span. */
+    void set_bytes(size_t bytes) { bytes_ = static_cast<int64_t>(bytes); }
+
+    /** Mark the span as a send whose context travels with the message. */
+    void mark_flow_out() { flow_out_ = true; }
+
+    /**
+     * Record an already finished span (e.g. a receive timed from the
+     * first byte of its frame).
+     */
+    static void record_completed(const char* name, const char* category,
+                                 int64_t start_ns, int64_t end_ns, size_t bytes);
+
+    /** Wall-clock ns since the epoch. */
+    static int64_t now_ns();
+
+private:
+    void open(const char* name, const char* category, const TraceContext& parent, bool remote);
+
+    bool active_ = false;
+    bool remote_parent_ = false;
+    bool flow_out_ = false;
+    const char* name_ = nullptr;
+    const char* category_ = nullptr;
+    uint64_t trace_id_ = 0;
+    uint64_t span_id_ = 0;
+    uint64_t parent_id_ = 0;
+    int64_t start_ns_ = 0;
+    int64_t bytes_ = -1;
+    TraceSpan* outer_ = nullptr;
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_TRACING_HPP
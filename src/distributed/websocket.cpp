@@ -0,0 +1,284 @@
+#include "distributed/websocket.hpp"
+
+#include <poll.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace sim { namespace distributed {
+
+// ---------------------------------------------------------------------------
+// Handshake helpers (local to this TU)
+// ---------------------------------------------------------------------------
+
+/// SHA-1 digest (FIPS 180-4); only the handshake's accept key needs it
+static void sha1(const std::string& data, unsigned char digest[20]) {
+    uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u};
+    std::string msg = data;
+    const uint64_t bits = static_cast<uint64_t>(data.size()) * 8;
+    msg += static_cast<char>(0x80);
+    while (msg.size() % 64 != 56) msg += '\0';
+    for (int k = 7; k >= 0; --k) msg += static_cast<char>((bits >> (8 * k)) & 0xff);
+
+    auto rol = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    for (size_t block = 0; block < msg.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(&msg[block + 4 * i]);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999u; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1u; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDCu; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6u; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rol(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 20; ++i) digest[i] = static_cast<unsigned char>(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static std::string base64(const unsigned char* data, size_t size) {
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t v = uint32_t(data[i]) << 16;
+        if (i + 1 < size) v |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) v |= data[i + 2];
+        out += table[(v >> 18) & 63];
+        out += table[(v >> 12) & 63];
+        out += i + 1 < size ? table[(v >> 6) & 63] : '=';
+        out += i + 2 < size ? table[v & 63] : '=';
+    }
+    return out;
+}
+
+/// Value of an HTTP header (name matched case-insensitively), empty if absent
+static std::string header_value(const std::string& request, const std::string& name) {
+    size_t pos = request.find("\r\n");
+    while (pos != std::string::npos && pos + 2 < request.size()) {
+        size_t start = pos + 2;
+        size_t end = request.find("\r\n", start);
+        if (end == std::string::npos) end = request.size();
+        size_t colon = request.find(':', start);
+        if (colon < end && colon - start == name.size() &&
+            std::equal(name.begin(), name.end(), request.begin() + static_cast<long>(start),
+                       [](char x, char y) { return std::tolower(x) == std::tolower(y); })) {
+            size_t v = request.find_first_not_of(" \t", colon + 1);
+            size_t e = request.find_last_not_of(" \t", end - 1);
+            return v <= e && v < end ? request.substr(v, e - v + 1) : std::string();
+        }
+        pos = end;
+    }
+    return std::string();
+}
+
+static bool contains_token(std::string value, const std::string& token) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    return value.find(token) != std::string::npos;
+}
+
+// ---------------------------------------------------------------------------
+// WebSocket
+// ---------------------------------------------------------------------------
+
+bool WebSocket::accept(IPCSocket& listener, WebSocket& out, int timeout_ms,
+                       int handshake_ms) {
+    WebSocket ws;
+    if (!listener.accept(ws.sock_, timeout_ms)) return false;
+    ws.handshake(handshake_ms);
+    out = std::move(ws);
+    return true;
+}
+
+void WebSocket::handshake(int timeout_ms) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    std::string request;
+    size_t end;
+    char buf[4096];
+    while ((end = request.find("\r\n\r\n")) == std::string::npos) {
+        long n = sock_.read_bytes(buf, sizeof(buf));
+        if (n > 0) {
+            request.append(buf, static_cast<size_t>(n));
+            if (request.size() > 16384) {
+                sock_.close();
+                throw std::runtime_error("WebSocket handshake: request too large");
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            sock_.close();
+            throw std::runtime_error("WebSocket handshake: connection closed");
+        }
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        struct pollfd pfd;
+        pfd.fd = sock_.native_handle();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (left <= 0 || ::poll(&pfd, 1, static_cast<int>(left)) == 0) {
+            sock_.close();
+            throw std::runtime_error("WebSocket handshake: timed out");
+        }
+    }
+    rx_ = request.substr(end + 4);   // A client may send its first frame right away
+    request.resize(end + 2);
+
+    const std::string key = header_value(request, "Sec-WebSocket-Key");
+    if (request.compare(0, 4, "GET ") != 0 || key.empty() ||
+        !contains_token(header_value(request, "Upgrade"), "websocket")) {
+        const std::string reply = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n";
+        sock_.write_bytes(reply.data(), reply.size());
+        sock_.close();
+        throw std::runtime_error("WebSocket handshake: not an upgrade request");
+    }
+    const size_t target_end = request.find(' ', 4);
+    path_ = request.substr(4, target_end == std::string::npos ? 0 : target_end - 4);
+
+    unsigned char digest[20];
+    sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+    const std::string reply =
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+    if (!sock_.write_bytes(reply.data(), reply.size())) {
+        sock_.close();
+        throw std::runtime_error("WebSocket handshake: connection closed");
+    }
+}
+
+bool WebSocket::send(uint8_t opcode, const void* data, size_t bytes) {
+    if (!sock_.is_connected()) return false;
+    tx_.clear();
+    tx_ += static_cast<char>(0x80 | opcode);   // FIN, unmasked
+    if (bytes < 126) {
+        tx_ += static_cast<char>(bytes);
+    } else if (bytes <= 0xffff) {
+        tx_ += static_cast<char>(126);
+        tx_ += static_cast<char>(bytes >> 8);
+        tx_ += static_cast<char>(bytes & 0xff);
+    } else {
+        tx_ += static_cast<char>(127);
+        for (int k = 7; k >= 0; --k) tx_ += static_cast<char>((uint64_t(bytes) >> (8 * k)) & 0xff);
+    }
+    tx_.append(static_cast<const char*>(data), bytes);
+    return sock_.write_bytes(tx_.data(), tx_.size());
+}
+
+bool WebSocket::receive_ready(std::string& out, bool& binary) {
+    if (!sock_.is_connected()) throw std::runtime_error("WebSocket closed");
+
+    char buf[16384];
+    for (;;) {
+        long n = sock_.read_bytes(buf, sizeof(buf));
+        if (n > 0) {
+            rx_.append(buf, static_cast<size_t>(n));
+            if (rx_.size() > 2 * MAX_MESSAGE) break;   // Parse before reading more
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        sock_.close();
+        throw std::runtime_error("WebSocket connection closed");
+    }
+
+    // Frames: [FIN|opcode][MASK|len7][ext len 16/64][mask key 4][payload]
+    for (;;) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(rx_.data());
+        if (rx_.size() < 2) return false;
+        const bool fin = (p[0] & 0x80) != 0;
+        const uint8_t opcode = p[0] & 0x0f;
+        if (!(p[1] & 0x80)) {
+            sock_.close();
+            throw std::runtime_error("WebSocket protocol error: unmasked client frame");
+        }
+        size_t head = 2;
+        uint64_t len = p[1] & 0x7f;
+        if (len == 126) {
+            if (rx_.size() < 4) return false;
+            len = (uint64_t(p[2]) << 8) | p[3];
+            head = 4;
+        } else if (len == 127) {
+            if (rx_.size() < 10) return false;
+            len = 0;
+            for (int k = 0; k < 8; ++k) len = (len << 8) | p[2 + k];
+            head = 10;
+        }
+        if (len > MAX_MESSAGE || message_.size() + len > MAX_MESSAGE) {
+            close(1009);
+            throw std::runtime_error("WebSocket message too large");
+        }
+        if (rx_.size() < head + 4 + len) return false;
+
+        const unsigned char* mask = p + head;
+        std::string payload(rx_, head + 4, static_cast<size_t>(len));
+        for (size_t i = 0; i < payload.size(); ++i) payload[i] ^= static_cast<char>(mask[i % 4]);
+        rx_.erase(0, head + 4 + static_cast<size_t>(len));
+
+        switch (opcode) {
+            case 0x0:   // Continuation
+                if (!in_message_) {
+                    close(1002);
+                    throw std::runtime_error("WebSocket protocol error: stray continuation");
+                }
+                message_ += payload;
+                break;
+            case 0x1:   // Text
+            case 0x2:   // Binary
+                if (in_message_) {
+                    close(1002);
+                    throw std::runtime_error("WebSocket protocol error: interleaved message");
+                }
+                message_ = std::move(payload);
+                message_binary_ = opcode == 0x2;
+                in_message_ = true;
+                break;
+            case 0x8:   // Close: echo it, then report the disconnect
+                close(payload.size() >= 2
+                          ? static_cast<uint16_t>((uint8_t(payload[0]) << 8) | uint8_t(payload[1]))
+                          : 1000);
+                throw std::runtime_error("WebSocket closed by peer");
+            case 0x9:   // Ping
+                send(0xA, payload.data(), payload.size());
+                continue;
+            case 0xA:   // Pong
+                continue;
+            default:
+                close(1002);
+                throw std::runtime_error("WebSocket protocol error: unknown opcode");
+        }
+
+        if (fin && in_message_) {
+            out = std::move(message_);
+            message_.clear();
+            binary = message_binary_;
+            in_message_ = false;
+            return true;
+        }
+    }
+}
+
+void WebSocket::close(uint16_t code) {
+    if (!sock_.is_connected()) return;
+    const char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+    send(0x8, payload, sizeof(payload));
+    sock_.close();
+}
+
+}} // namespace sim::distributed
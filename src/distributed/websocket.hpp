@@ -0,0 +1,77 @@
+#ifndef SIM_WEBSOCKET_HPP
+#define SIM_WEBSOCKET_HPP
+
+#include "ipc_socket.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sim { namespace distributed {
+
+/**
+ * @brief Server end of a WebSocket (RFC 6455) connection, for browser clients
+ *
+ * Layered on an accepted tcp:// (or tls://, for wss://) IPCSocket, whose
+ * length-prefixed framing it bypasses. accept() completes the HTTP upgrade
+ * handshake; no extensions or subprotocols are negotiated. Outgoing
+ * messages are single unmasked frames. Incoming frames must be masked, as
+ * browsers send them; fragments are reassembled, pings answered, and a
+ * close frame is echoed before receive_ready() reports the disconnect.
+ *
+ * Sends block until the kernel has taken the bytes, so a client that stops
+ * reading eventually stalls its sender.
+ */
+class WebSocket {
+public:
+    static constexpr size_t MAX_MESSAGE = 1u << 20;   // Largest incoming message [bytes]
+
+    WebSocket() = default;
+    WebSocket(WebSocket&&) = default;
+    WebSocket& operator=(WebSocket&&) = default;
+
+    /**
+     * Accept a connection on `listener` and complete the upgrade handshake
+     * @return false if no connection arrived within timeout_ms
+     * @throws std::runtime_error if the handshake fails or takes over handshake_ms
+     */
+    static bool accept(IPCSocket& listener, WebSocket& out, int timeout_ms,
+                       int handshake_ms = 2000);
+
+    bool send_text(const std::string& text) { return send(1, text.data(), text.size()); }
+    bool send_binary(const void* data, size_t bytes) { return send(2, data, bytes); }
+
+    /**
+     * Read whatever bytes are ready without blocking; true once a whole
+     * message is in `out` (`binary` tells which kind). Partial frames are
+     * kept, and so are further messages already read: call again until it
+     * returns false. Throws on disconnect, a close frame or a protocol error.
+     */
+    bool receive_ready(std::string& out, bool& binary);
+
+    /// Send a close frame (if still open) and close the socket
+    void close(uint16_t code = 1000);
+
+    bool is_open() const { return sock_.is_connected(); }
+
+    /// Underlying descriptor, for registering with poll (-1 if closed)
+    int native_handle() const { return sock_.native_handle(); }
+
+    /// Request target of the upgrade, e.g. "/live?fps=30"
+    const std::string& path() const { return path_; }
+
+private:
+    IPCSocket sock_;
+    std::string path_;
+    std::string rx_;                    // Bytes read, not yet parsed
+    std::string message_;               // Fragments of the message being assembled
+    bool message_binary_ = false;
+    bool in_message_ = false;
+    std::string tx_;                    // Frame being sent (header + payload)
+
+    bool send(uint8_t opcode, const void* data, size_t bytes);
+    void handshake(int timeout_ms);
+};
+
+}} // namespace sim::distributed
+
+#endif // SIM_WEBSOCKET_HPP
@@ -1,5 +1,6 @@
 #include "distributed/sim_coordinator.hpp"
 #include "distributed/sim_worker.hpp"
+#include "distributed/tracing.hpp"
 #include "core/state_vector.hpp"
 
 #include <thread>
@@ -27,6 +28,13 @@
 //
 // The coordinator steps 100 times at dt = 60s (100 minutes total),
 // then gathers final states and prints positions.
+//
+// --shm: step and sync through shared memory instead of the socket.
+// --tcp: connect over TCP on loopback (the multi-node transport).
+// --lookahead: the two orbit shells never interact, so each worker declares
+//   a 10-minute lookahead and the coordinator grants multi-step advances.
+// --trace <path>: record coordinator and worker spans as a Chrome trace
+//   (see distributed/tracing.hpp; SIM_TRACE=<path> does the same).
 // ---------------------------------------------------------------------------
 
 static const double MU_EARTH = 3.986004418e14;  // m^3/s^2
@@ -34,6 +42,11 @@ static const double R_EARTH  = 6371000.0;        // m
 static const double PI       = 3.14159265358979323846;
 
 static const std::string SOCKET_PATH = "/tmp/sim_distributed.sock";
+static const std::string TCP_ADDRESS = "tcp://127.0.0.1:47310";
+static std::string address = SOCKET_PATH;
+static bool use_lookahead = false;
+static const double LOOKAHEAD_S = 600.0;
+static const std::string SHM_NAME = "/sim_distributed_state";
 
 /// Orbital config for each entity
 struct OrbitConfig {
@@ -104,8 +117,9 @@ static void worker_thread_fn(int worker_id) {
     // Small delay to let coordinator start listening
     std::this_thread::sleep_for(std::chrono::milliseconds(100 + worker_id * 50));
 
-    sim::distributed::SimWorker worker(SOCKET_PATH);
+    sim::distributed::SimWorker worker(address);
     worker.set_update_function(circular_orbit_update);
+    if (use_lookahead) worker.set_lookahead(LOOKAHEAD_S);
 
     if (!worker.connect()) {
         std::cerr << "[Worker " << worker_id << "] Failed to connect." << std::endl;
@@ -118,13 +132,15 @@ static void worker_thread_fn(int worker_id) {
 }
 
 /// Coordinator thread function
-static void coordinator_thread_fn() {
+static void coordinator_thread_fn(bool use_shm) {
     const int NUM_WORKERS = 2;
     const int NUM_STEPS = 100;
     const double DT = 60.0;  // seconds per step
 
     try {
-        sim::distributed::SimCoordinator coordinator(SOCKET_PATH);
+        sim::distributed::SimCoordinator coordinator(address);
+        if (use_shm) coordinator.use_shared_memory(SHM_NAME);
+        coordinator.use_lookahead_sync(use_lookahead);
 
         // Wait for both workers
         coordinator.start(NUM_WORKERS);
@@ -141,7 +157,13 @@ static void coordinator_thread_fn() {
                   << DT << "s each (" << (NUM_STEPS * DT / 60.0)
                   << " minutes total)...\n" << std::endl;
 
+        auto t_run = std::chrono::steady_clock::now();
         bool ok = coordinator.run_until(NUM_STEPS * DT, DT);
+        double run_us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - t_run).count();
+        std::cout << "[Coordinator] " << (use_shm ? "Shared memory" : "Socket")
+                  << " stepping: " << run_us / NUM_STEPS << " us/step, "
+                  << coordinator.round_trips() << " round trips" << std::endl;
 
         if (!ok) {
             std::cerr << "[Coordinator] Simulation did not complete successfully." << std::endl;
@@ -217,12 +239,23 @@ static void coordinator_thread_fn() {
     }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    bool use_shm = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--shm") use_shm = true;
+        if (std::string(argv[i]) == "--tcp") address = TCP_ADDRESS;
+        if (std::string(argv[i]) == "--lookahead") use_lookahead = true;
+        if (std::string(argv[i]) == "--trace" && i + 1 < argc) {
+            sim::distributed::Tracer::global().enable(argv[++i], "distributed_demo");
+        }
+    }
+
     std::cout << "=========================================" << std::endl;
     std::cout << "  All-Domain Distributed Simulation Demo" << std::endl;
     std::cout << "=========================================" << std::endl;
-    std::cout << "Socket: " << SOCKET_PATH << std::endl;
+    std::cout << "Socket: " << address << std::endl;
     std::cout << "Topology: 1 coordinator + 2 workers" << std::endl;
+    std::cout << "Transport: " << (use_shm ? "shared memory" : address == TCP_ADDRESS ? "TCP" : "Unix socket") << std::endl;
     std::cout << "Entities: 4 satellites in circular orbits" << std::endl;
     std::cout << "=========================================" << std::endl;
 
@@ -230,7 +263,7 @@ int main() {
     ::unlink(SOCKET_PATH.c_str());
 
     // Launch coordinator thread
-    std::thread coord_thread(coordinator_thread_fn);
+    std::thread coord_thread(coordinator_thread_fn, use_shm);
 
     // Launch worker threads (with staggered delays built into worker_thread_fn)
     std::thread worker0(worker_thread_fn, 0);
@@ -244,6 +277,15 @@ int main() {
     // Clean up socket file
     ::unlink(SOCKET_PATH.c_str());
 
+    auto& tracer = sim::distributed::Tracer::global();
+    if (tracer.enabled()) {
+        if (tracer.flush()) {
+            std::cout << "Trace written to " << tracer.output_path() << std::endl;
+        } else {
+            std::cerr << "Cannot write trace " << tracer.output_path() << std::endl;
+        }
+    }
+
     std::cout << "\nDistributed simulation demo complete." << std::endl;
     return 0;
 }
@@ -0,0 +1,222 @@
+#include "air_combat.hpp"
+#include <cmath>
+#include <limits>
+
+namespace sim {
+
+// Constants (as in fighter.cpp)
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG_TO_RAD = PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / PI;
+constexpr double EARTH_RADIUS = 6371000.0;
+
+// ---------------------------------------------------------------------------
+// Pair geometry (Fighter::bearing_to / range_to / compute_aspect_angle)
+// ---------------------------------------------------------------------------
+
+static double initial_bearing(const FlightState& from, const FlightState& to) {
+    double lat1 = from.latitude * DEG_TO_RAD;
+    double lon1 = from.longitude * DEG_TO_RAD;
+    double lat2 = to.latitude * DEG_TO_RAD;
+    double lon2 = to.longitude * DEG_TO_RAD;
+
+    double y = std::sin(lon2 - lon1) * std::cos(lat2);
+    double x = std::cos(lat1) * std::sin(lat2) -
+               std::sin(lat1) * std::cos(lat2) * std::cos(lon2 - lon1);
+    double bearing = std::atan2(y, x) * RAD_TO_DEG;
+    return std::fmod(bearing + 360.0, 360.0);
+}
+
+static double slant_range(const FlightState& from, const FlightState& to) {
+    double dlat = (to.latitude - from.latitude) * DEG_TO_RAD;
+    double dlon = (to.longitude - from.longitude) * DEG_TO_RAD;
+    double a = std::sin(dlat/2) * std::sin(dlat/2) +
+               std::cos(from.latitude * DEG_TO_RAD) * std::cos(to.latitude * DEG_TO_RAD) *
+               std::sin(dlon/2) * std::sin(dlon/2);
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1-a));
+    double horiz_dist = EARTH_RADIUS * c;
+    double vert_dist = to.altitude_msl - from.altitude_msl;
+    return std::sqrt(horiz_dist * horiz_dist + vert_dist * vert_dist);
+}
+
+/// Aspect of `target` seen from us, given the bearing from the target to us
+static double aspect_from(double bearing_to_us, const FlightState& target) {
+    double aspect = bearing_to_us - target.heading;
+    while (aspect > 180.0) aspect -= 360.0;
+    while (aspect < -180.0) aspect += 360.0;
+    return std::abs(aspect);
+}
+
+/// Row entry for `other` seen from `own`
+static ContactGeometry contact(Fighter* other, const FlightState& own, const FlightState& tgt,
+                               double range, double bearing, double back_bearing) {
+    ContactGeometry c;
+    c.other = other;
+    c.range = range;
+    c.bearing = bearing;
+    c.aspect_angle = aspect_from(back_bearing, tgt);
+    c.altitude = tgt.altitude_msl;
+
+    // Closure = my velocity toward them + their velocity toward me
+    double b = bearing * DEG_TO_RAD;
+    c.closure_rate = own.groundspeed * std::cos(b - own.heading * DEG_TO_RAD) +
+                     tgt.groundspeed * std::cos(b + PI - tgt.heading * DEG_TO_RAD);
+    return c;
+}
+
+// ---------------------------------------------------------------------------
+// AirCombatSimulator
+// ---------------------------------------------------------------------------
+
+AirCombatSimulator::AirCombatSimulator(const AirCombatConfig& config) : config_(config) {}
+
+void AirCombatSimulator::add(std::shared_ptr<Fighter> fighter) {
+    if (!fighter) return;
+    fighter->set_external_missile_update(true);
+    index_[fighter->get_id()] = fighters_.size();
+    launched_.push_back(fighter->get_missiles().size());
+    fighters_.push_back(std::move(fighter));
+    picture_.emplace_back();
+    snapshot_valid_ = false;
+}
+
+size_t AirCombatSimulator::alive(Team team) const {
+    size_t n = 0;
+    for (const auto& f : fighters_) {
+        if (f->is_alive() && f->get_team() == team) n++;
+    }
+    return n;
+}
+
+void AirCombatSimulator::step(double dt) {
+    if (!snapshot_valid_) snapshot();
+
+    if (!decision_primed_ || since_decision_ >= config_.decision_interval - 1e-9) {
+        build_picture();
+        run_decisions();
+        since_decision_ = 0.0;
+        decision_primed_ = true;
+    }
+
+    for (auto& f : fighters_) {
+        if (f->is_alive()) f->update(dt);
+    }
+    collect_launches();
+
+    snapshot();
+    fly_missiles(dt);
+
+    time_ += dt;
+    since_decision_ += dt;
+}
+
+void AirCombatSimulator::snapshot() {
+    size_t n = fighters_.size();
+    states_.resize(n);
+    positions_.resize(n);
+
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < n; i++) {
+        const Fighter& f = *fighters_[i];
+        if (!f.is_alive()) {
+            positions_[i] = Vec3(NaN, NaN, NaN);
+            continue;
+        }
+        states_[i] = f.get_flight_state();
+        positions_[i] = f.get_state().position;
+    }
+    snapshot_valid_ = true;
+}
+
+void AirCombatSimulator::build_picture() {
+    for (auto& row : picture_) row.clear();
+
+    double radius = config_.table_radius;
+    grid_.build(positions_, radius);
+
+    // Each pair once, from its lower index: rows stay in ascending order
+    for (size_t i = 0; i < fighters_.size(); i++) {
+        if (!fighters_[i]->is_alive()) continue;
+        grid_.query(positions_[i], radius, candidates_);
+
+        const FlightState& si = states_[i];
+        for (uint32_t j : candidates_) {
+            if (j <= i) continue;
+
+            const FlightState& sj = states_[j];
+            double range = slant_range(si, sj);
+            if (range > radius) continue;
+
+            double bij = initial_bearing(si, sj);
+            double bji = initial_bearing(sj, si);
+            picture_[i].push_back(contact(fighters_[j].get(), si, sj, range, bij, bji));
+            picture_[j].push_back(contact(fighters_[i].get(), sj, si, range, bji, bij));
+        }
+    }
+}
+
+void AirCombatSimulator::run_decisions() {
+    std::vector<uint8_t> inbound(fighters_.size(), 0);
+    for (const auto& m : missiles_) {
+        if (!m->is_active()) continue;
+        auto it = index_.find(m->target_id);
+        if (it != index_.end() && fighters_[it->second]->get_team() != m->team) {
+            inbound[it->second] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < fighters_.size(); i++) {
+        Fighter& f = *fighters_[i];
+        if (!f.is_alive()) continue;
+
+        f.set_picture(&states_[i], &picture_[i]);
+        f.update_radar();
+        f.run_tactical_ai(inbound[i] != 0);
+        f.set_picture(nullptr, nullptr);
+    }
+}
+
+void AirCombatSimulator::collect_launches() {
+    for (size_t i = 0; i < fighters_.size(); i++) {
+        const auto& own = fighters_[i]->get_missiles();
+        for (size_t k = launched_[i]; k < own.size(); k++) {
+            const auto& m = own[k];
+            missiles_.push_back(m);
+            events_.push_back({AirCombatEvent::Type::LAUNCH, time_, m->id,
+                               m->shooter_id, m->target_id, m->type});
+        }
+        launched_[i] = own.size();
+    }
+}
+
+void AirCombatSimulator::fly_missiles(double dt) {
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    for (auto& m : missiles_) {
+        if (!m->is_active()) continue;
+
+        auto it = index_.find(m->target_id);
+        Fighter* target = it != index_.end() ? fighters_[it->second].get() : nullptr;
+        if (!target || !target->is_alive()) {
+            m->state = Missile::State::MISS;
+            events_.push_back({AirCombatEvent::Type::MISS, time_ + dt, m->id,
+                               m->shooter_id, m->target_id, m->type});
+            continue;
+        }
+
+        const FlightState& tgt = states_[it->second];
+        m->update(dt, tgt.latitude, tgt.longitude, tgt.altitude_msl);
+
+        if (m->state == Missile::State::HIT) {
+            target->kill();
+            positions_[it->second] = Vec3(NaN, NaN, NaN);
+            events_.push_back({AirCombatEvent::Type::HIT, time_ + dt, m->id,
+                               m->shooter_id, m->target_id, m->type});
+        } else if (m->state == Missile::State::MISS) {
+            events_.push_back({AirCombatEvent::Type::MISS, time_ + dt, m->id,
+                               m->shooter_id, m->target_id, m->type});
+        }
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,103 @@
+#ifndef AIR_COMBAT_HPP
+#define AIR_COMBAT_HPP
+
+#include "fighter.hpp"
+#include "core/state_vector.hpp"
+#include "montecarlo/spatial_grid.hpp"
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+struct AirCombatConfig {
+    double decision_interval = 1.0;    // [s] radar and tactical AI cadence
+    double table_radius = 200000.0;    // [m] pairs beyond this are left out of the picture
+};
+
+/// Weapon event logged by AirCombatSimulator
+struct AirCombatEvent {
+    enum class Type { LAUNCH, HIT, MISS };
+
+    Type type;
+    double time;
+    int missile_id;
+    int shooter_id;
+    int target_id;
+    Missile::Type weapon;
+};
+
+/**
+ * @brief Many-vs-many air combat driver
+ *
+ * The per-fighter loop in the dogfight demo has every fighter read every
+ * other fighter's flight state several times per step (radar sweep,
+ * closest-enemy search, aspect / ATA, launch checks), and every missile
+ * search the whole roster for its target: O(N^2) flight-state
+ * reconstructions per step.
+ *
+ * The simulator instead snapshots every live fighter once per step. Every
+ * decision_interval it buckets the snapshots in a SpatialGrid and builds
+ * one relative-geometry row per fighter: range, bearing, aspect and
+ * closure to every fighter within table_radius, each pair evaluated once
+ * with Fighter's own formulas. Radar, RWR and the tactical AI read those
+ * rows (set_picture) instead of the roster. Missiles are flown out in one
+ * pass against the post-step snapshots.
+ *
+ * Fighters' own missile update is disabled while they belong to the
+ * simulator, so each missile advances exactly once per step toward its
+ * target_id; a dead or missing target makes it a MISS.
+ */
+class AirCombatSimulator {
+public:
+    explicit AirCombatSimulator(const AirCombatConfig& config = AirCombatConfig{});
+
+    void add(std::shared_ptr<Fighter> fighter);
+    size_t size() const { return fighters_.size(); }
+
+    /// Advance every fighter and missile by dt
+    void step(double dt);
+
+    double get_time() const { return time_; }
+    size_t alive(Team team) const;
+
+    const std::vector<std::shared_ptr<Fighter>>& get_fighters() const { return fighters_; }
+    const std::vector<std::shared_ptr<Missile>>& get_missiles() const { return missiles_; }
+
+    /// Relative-geometry row of fighter i as of the last decision
+    const std::vector<ContactGeometry>& get_picture(size_t i) const { return picture_[i]; }
+
+    const std::vector<AirCombatEvent>& get_events() const { return events_; }
+    void clear_events() { events_.clear(); }
+
+private:
+    AirCombatConfig config_;
+    double time_ = 0.0;
+    double since_decision_ = 0.0;
+    bool decision_primed_ = false;
+    bool snapshot_valid_ = false;
+
+    std::vector<std::shared_ptr<Fighter>> fighters_;
+    std::vector<std::shared_ptr<Missile>> missiles_;
+    std::vector<size_t> launched_;                  // Missiles already collected per fighter
+    std::vector<AirCombatEvent> events_;
+    std::unordered_map<int, size_t> index_;         // Fighter id -> index
+
+    // Tick snapshot, index i = fighters_[i]
+    std::vector<FlightState> states_;
+    std::vector<Vec3> positions_;                   // ECEF; NaN for dead fighters
+    std::vector<std::vector<ContactGeometry>> picture_;
+    mc::SpatialGrid grid_;
+    std::vector<uint32_t> candidates_;
+
+    void snapshot();
+    void build_picture();
+    void run_decisions();
+    void collect_launches();
+    void fly_missiles(double dt);
+};
+
+} // namespace sim
+
+#endif // AIR_COMBAT_HPP
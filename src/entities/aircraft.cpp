@@ -4,6 +4,7 @@
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 
 namespace sim {
 
@@ -81,6 +82,25 @@ void Aircraft::set_wind_field(const std::vector<WindVector>& winds) {
               });
 }
 
+void Aircraft::set_wind_grid(std::shared_ptr<const WindGrid> grid, double time_offset) {
+    wind_grid_ = std::move(grid);
+    wind_time_offset_ = time_offset;
+    wind_cursor_ = WindGrid::Cursor();
+}
+
+WindVector Aircraft::get_wind(double lat, double lon, double alt) const {
+    if (!wind_grid_) return get_wind_at_altitude(alt);
+
+    double east, north;
+    wind_grid_->sample(lat, lon, alt, state_.time + wind_time_offset_, wind_cursor_, east, north);
+    WindVector result;
+    result.altitude = alt;
+    result.speed = std::sqrt(east * east + north * north);
+    // Meteorological convention: the direction it blows from
+    result.direction = std::fmod(std::atan2(-east, -north) * RAD_TO_DEG + 360.0, 360.0);
+    return result;
+}
+
 WindVector Aircraft::get_wind_at_altitude(double alt) const {
     if (wind_field_.empty()) {
         return WindVector{0, 0, alt};
@@ -124,6 +144,14 @@ void Aircraft::update(double dt) {
     state_.time += dt;
 }
 
+double Aircraft::warp_horizon() const {
+    bool idle = throttle_ <= 0.1 && groundspeed_ <= 0.0;
+    if (idle && (phase_ == AircraftFlightPhase::PARKED || phase_ == AircraftFlightPhase::LANDED)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return 0.0;
+}
+
 void Aircraft::update_phase() {
     double lat, lon, alt;
     ecef_to_geodetic(state_.position.x, state_.position.y, state_.position.z, lat, lon, alt);
@@ -412,7 +440,7 @@ void Aircraft::update_aerodynamics(double dt) {
     ecef_to_geodetic(state_.position.x, state_.position.y, state_.position.z, lat, lon, alt);
 
     // Get wind
-    WindVector wind = get_wind_at_altitude(alt);
+    WindVector wind = get_wind(lat, lon, alt);
 
     // Convert wind to velocity components (wind direction is where it's FROM)
     double wind_rad = (wind.direction + 180.0) * DEG_TO_RAD;  // Convert to where it's going
@@ -550,7 +578,7 @@ void Aircraft::update_kinematics(double dt) {
         true_airspeed_ = std::clamp(true_airspeed_, 60.0, 280.0);  // 60-280 m/s
 
         // Apply wind
-        WindVector wind = get_wind_at_altitude(alt);
+        WindVector wind = get_wind(lat, lon, alt);
         double wind_rad = (wind.direction + 180.0) * DEG_TO_RAD;
         double wind_east = wind.speed * std::sin(wind_rad);
         double wind_north = wind.speed * std::cos(wind_rad);
@@ -678,7 +706,7 @@ FlightState Aircraft::get_flight_state() const {
     }
 
     // Environment
-    WindVector wind = get_wind_at_altitude(fs.altitude_msl);
+    WindVector wind = get_wind(fs.latitude, fs.longitude, fs.altitude_msl);
     fs.wind_speed = wind.speed;
     fs.wind_direction = wind.direction;
 
@@ -751,9 +779,16 @@ void Aircraft::update_6dof(double dt) {
     double beta = 0.0;
 
     // Run 6DOF rotational step: moments → angular accel → ω → quaternion
-    Aerodynamics6DOF::step_rotation(
-        state_, alpha, beta, q_bar, V,
-        control_surfaces_, config_.moment_coeffs, config_.inertia, dt);
+    if (config_.aero_database) {
+        AeroMoments moments = Aerodynamics6DOF::compute_aero_moments(
+            *config_.aero_database, aero_cursor_, mach_, alpha, beta,
+            state_.angular_velocity, q_bar, V, control_surfaces_, config_.moment_coeffs);
+        Aerodynamics6DOF::step_rotation(state_, moments, config_.inertia, dt);
+    } else {
+        Aerodynamics6DOF::step_rotation(
+            state_, alpha, beta, q_bar, V,
+            control_surfaces_, config_.moment_coeffs, config_.inertia, dt);
+    }
 
     // Sync Euler angles back into the 3DOF state variables for telemetry
     Vec3 euler = quat_to_euler(state_.attitude);
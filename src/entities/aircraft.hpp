@@ -4,6 +4,8 @@
 #include "entity.hpp"
 #include "core/state_vector.hpp"
 #include "physics/aerodynamics_6dof.hpp"
+#include "physics/wind_grid.hpp"
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -43,6 +45,7 @@ struct AircraftConfig {
     bool use_6dof = false;
     MomentCoefficients moment_coeffs;  // Stability/control derivatives
     InertiaMatrix inertia;             // Rotational inertia tensor
+    std::shared_ptr<const AeroDatabase> aero_database;  // Tabulated moments; null = derivatives
 };
 
 // Flight phase enumeration
@@ -116,11 +119,18 @@ struct FlightState {
 };
 
 class Aircraft : public Entity {
+    friend class AircraftFleet;   // Batched kinematics on the protected state
+
 public:
     Aircraft(int id, const std::string& callsign, const AircraftConfig& config);
 
     // Entity interface
     void update(double dt) override;
+
+    // Parked or stopped after landing with engines idle: nothing changes
+    // until the throttle is set, so time may skip freely
+    double warp_horizon() const override;
+    void coast(double dt) override { state_.time += dt; }
     std::string get_model_path() const override { return config_.model_path; }
 
     // Flight plan
@@ -148,6 +158,8 @@ public:
     // Wind
     void set_wind(const WindVector& wind);
     void set_wind_field(const std::vector<WindVector>& winds);  // Altitude-varying
+    // Gridded 4D wind, replacing the profile while set; grid time at state time 0
+    void set_wind_grid(std::shared_ptr<const WindGrid> grid, double time_offset = 0.0);
 
     // Configuration
     const AircraftConfig& get_config() const { return config_; }
@@ -197,9 +209,13 @@ protected:
 
     // Wind
     std::vector<WindVector> wind_field_;
+    std::shared_ptr<const WindGrid> wind_grid_;
+    double wind_time_offset_ = 0.0;
+    mutable WindGrid::Cursor wind_cursor_;
 
     // 6DOF state
     ControlSurfaces control_surfaces_;
+    AeroDatabase::Cursor aero_cursor_;
 
     // Physics helpers
     void update_autopilot(double dt);
@@ -216,6 +232,7 @@ protected:
     double get_air_density() const;
     double get_speed_of_sound() const;
     WindVector get_wind_at_altitude(double alt) const;
+    WindVector get_wind(double lat, double lon, double alt) const;  // Grid, else profile
 
     // Navigation
     double distance_to_waypoint(const Waypoint& wp) const;
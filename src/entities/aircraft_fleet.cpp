@@ -0,0 +1,295 @@
+#include "aircraft_fleet.hpp"
+#include "coordinate/frame_service.hpp"
+#include "physics/atmosphere_model.hpp"
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+
+namespace sim {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG_TO_RAD = PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / PI;
+constexpr double EARTH_RADIUS = 6371000.0;  // meters (as Aircraft)
+constexpr double GRAVITY = 9.80665;          // m/s²
+
+/// Wind at an altitude, interpolated exactly as Aircraft::get_wind_at_altitude
+static WindVector wind_at(const std::vector<WindVector>& winds, double alt) {
+    if (winds.empty()) return WindVector{0, 0, alt};
+    if (winds.size() == 1) return winds[0];
+
+    for (size_t i = 0; i + 1 < winds.size(); i++) {
+        if (alt >= winds[i].altitude && alt <= winds[i + 1].altitude) {
+            double t = (alt - winds[i].altitude) / (winds[i + 1].altitude - winds[i].altitude);
+            WindVector result;
+            result.altitude = alt;
+            result.speed = winds[i].speed * (1 - t) + winds[i + 1].speed * t;
+            result.direction = winds[i].direction * (1 - t) + winds[i + 1].direction * t;
+            return result;
+        }
+    }
+    if (alt < winds.front().altitude) return winds.front();
+    return winds.back();
+}
+
+static bool on_ground(AircraftFlightPhase p) {
+    return p == AircraftFlightPhase::PARKED || p == AircraftFlightPhase::TAXI ||
+           p == AircraftFlightPhase::TAKEOFF || p == AircraftFlightPhase::LANDING ||
+           p == AircraftFlightPhase::LANDED;
+}
+
+// ---------------------------------------------------------------------------
+// Setup
+// ---------------------------------------------------------------------------
+
+AircraftFleet::AircraftFleet(const AircraftFleetConfig& config) : config_(config) {
+    size_t n = std::max<size_t>(2, static_cast<size_t>(
+        std::ceil(config_.table_ceiling / config_.table_step)) + 1);
+    sound_speed_.resize(n);
+    wind_east_.assign(n, 0.0);
+    wind_north_.assign(n, 0.0);
+    for (size_t k = 0; k < n; k++) {
+        sound_speed_[k] = AtmosphereModel::get_atmosphere(k * config_.table_step).speed_of_sound;
+    }
+}
+
+void AircraftFleet::set_wind_field(const std::vector<WindVector>& winds) {
+    std::vector<WindVector> sorted = winds;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const WindVector& a, const WindVector& b) { return a.altitude < b.altitude; });
+
+    for (size_t k = 0; k < wind_east_.size(); k++) {
+        WindVector w = wind_at(sorted, k * config_.table_step);
+        double going = (w.direction + 180.0) * DEG_TO_RAD;   // Direction it blows towards
+        wind_east_[k] = w.speed * std::sin(going);
+        wind_north_[k] = w.speed * std::cos(going);
+    }
+}
+
+void AircraftFleet::set_wind_grid(std::shared_ptr<const WindGrid> grid, double time_offset) {
+    grid_ = std::move(grid);
+    grid_offset_ = time_offset;
+    cursors_.assign(members_.size(), WindGrid::Cursor());
+}
+
+void AircraftFleet::add(std::shared_ptr<Aircraft> aircraft) {
+    if (!aircraft) return;
+    if (aircraft->config_.use_6dof || typeid(*aircraft) != typeid(Aircraft)) {
+        scalar_.push_back(std::move(aircraft));
+        return;
+    }
+
+    const Aircraft& a = *aircraft;
+    GeodeticCoord g = FrameService::ecef_to_geodetic(a.state_.position);
+    lat_.push_back(g.latitude);
+    lon_.push_back(g.longitude);
+    alt_.push_back(on_ground(a.phase_) ? 0.0 : g.altitude);
+    heading_.push_back(a.heading_);
+    track_.push_back(a.track_);
+    bank_.push_back(a.bank_angle_);
+    tas_.push_back(a.true_airspeed_);
+    gs_.push_back(a.groundspeed_);
+    vs_.push_back(a.state_.velocity.z);
+    phase_.push_back(static_cast<uint8_t>(a.phase_));
+    target_alt_.push_back(a.target_altitude_);
+    target_speed_.push_back(a.target_speed_);
+    max_climb_.push_back(a.config_.max_climb_rate);
+    max_descent_.push_back(a.config_.max_descent_rate);
+    ceiling_.push_back(a.config_.service_ceiling);
+    max_mach_.push_back(a.config_.max_mach);
+    cursors_.emplace_back();
+    members_.push_back(std::move(aircraft));
+}
+
+void AircraftFleet::lookup(double alt, double& sound_speed,
+                           double& wind_east, double& wind_north) const {
+    double f = std::clamp(alt, 0.0, config_.table_ceiling) / config_.table_step;
+    size_t k = std::min(static_cast<size_t>(f), sound_speed_.size() - 2);
+    double t = f - k;
+    sound_speed = sound_speed_[k] + t * (sound_speed_[k + 1] - sound_speed_[k]);
+    wind_east = wind_east_[k] + t * (wind_east_[k + 1] - wind_east_[k]);
+    wind_north = wind_north_[k] + t * (wind_north_[k + 1] - wind_north_[k]);
+}
+
+// ---------------------------------------------------------------------------
+// Member synchronisation
+// ---------------------------------------------------------------------------
+
+void AircraftFleet::write_back(size_t i) {
+    Aircraft& a = *members_[i];
+    double x, y, z;
+    a.geodetic_to_ecef(lat_[i], lon_[i], alt_[i], x, y, z);
+    if (pending_ > 0.0) {
+        a.state_.velocity.x = (x - a.state_.position.x) / pending_;
+        a.state_.velocity.y = (y - a.state_.position.y) / pending_;
+    }
+    a.state_.velocity.z = vs_[i];
+    a.state_.position = Vec3(x, y, z);
+
+    double sound_speed, we, wn;
+    lookup(alt_[i], sound_speed, we, wn);
+    a.heading_ = heading_[i];
+    a.track_ = track_[i];
+    a.bank_angle_ = bank_[i];
+    a.true_airspeed_ = tas_[i];
+    a.groundspeed_ = gs_[i];
+    a.mach_ = tas_[i] / sound_speed;
+    a.phase_ = static_cast<AircraftFlightPhase>(phase_[i]);
+
+    // Throttle only changes on autopilot ticks, so one burn covers the interval
+    a.update_fuel(pending_);
+    a.state_.time += pending_;
+}
+
+void AircraftFleet::read_back(size_t i) {
+    const Aircraft& a = *members_[i];
+    phase_[i] = static_cast<uint8_t>(a.phase_);
+    heading_[i] = a.heading_;
+    bank_[i] = a.bank_angle_;
+    target_alt_[i] = a.target_altitude_;
+    target_speed_[i] = a.target_speed_;
+}
+
+void AircraftFleet::sync() {
+    for (size_t i = 0; i < members_.size(); i++) write_back(i);
+    pending_ = 0.0;
+}
+
+void AircraftFleet::run_autopilot(double dt) {
+    sync();
+    for (size_t i = 0; i < members_.size(); i++) {
+        Aircraft& a = *members_[i];
+        a.update_phase();
+        a.update_autopilot(dt);
+        read_back(i);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Dynamics
+// ---------------------------------------------------------------------------
+
+void AircraftFleet::update(double dt) {
+    for (auto& a : scalar_) a->update(dt);
+
+    if (!autopilot_primed_ || since_autopilot_ >= config_.autopilot_interval - 1e-9) {
+        run_autopilot(std::max(config_.autopilot_interval, dt));
+        since_autopilot_ = 0.0;
+        autopilot_primed_ = true;
+    }
+
+    const size_t n = members_.size();
+    const double grid_time = time_ + grid_offset_;
+    if (grid_) {
+        grid_east_.resize(n);
+        grid_north_.resize(n);
+        grid_->sample(n, lat_.data(), lon_.data(), alt_.data(), grid_time, cursors_.data(),
+                      grid_east_.data(), grid_north_.data());
+    }
+
+    // Airspeed, vertical and speed control, wind triangle (phase dependent)
+    for (size_t i = 0; i < n; i++) {
+        auto phase = static_cast<AircraftFlightPhase>(phase_[i]);
+        double alt = alt_[i];
+
+        if (on_ground(phase)) {
+            double gs = gs_[i];
+            if (phase == AircraftFlightPhase::TAKEOFF) {
+                gs += 3.0 * dt;
+                if (gs > 77.0) {   // Rotation
+                    phase_[i] = static_cast<uint8_t>(AircraftFlightPhase::CLIMB);
+                    alt = 10.0;
+                }
+            } else if (phase == AircraftFlightPhase::LANDING) {
+                gs = std::max(gs - 3.0 * dt, 0.0);
+                alt = 0.0;
+            } else if (phase == AircraftFlightPhase::TAXI) {
+                gs += (15.0 - gs) * 0.5 * dt;
+                alt = 0.0;
+            } else {
+                gs = std::max(gs - 1.0 * dt, 0.0);
+                alt = 0.0;
+            }
+            alt_[i] = alt;
+            gs_[i] = gs;
+            tas_[i] = gs;
+            track_[i] = heading_[i];
+            vs_[i] = 0.0;
+            continue;
+        }
+
+        // update_aerodynamics: airspeed from the last ground vector, Mach limited
+        double sound_speed, we, wn;
+        lookup(alt, sound_speed, we, wn);
+        if (grid_) {
+            we = grid_east_[i];
+            wn = grid_north_[i];
+        }
+        double track = track_[i] * DEG_TO_RAD;
+        double ae = gs_[i] * std::sin(track) - we;
+        double an = gs_[i] * std::cos(track) - wn;
+        double tas = std::sqrt(ae * ae + an * an + vs_[i] * vs_[i]);
+        tas = std::min(tas, max_mach_[i] * sound_speed);
+
+        // Altitude control
+        double alt_error = target_alt_[i] - alt;
+        double vs;
+        if (phase == AircraftFlightPhase::CLIMB) {
+            vs = alt_error < 200.0 ? alt_error * 0.05 : max_climb_[i] * 0.8;
+        } else if (phase == AircraftFlightPhase::DESCENT || phase == AircraftFlightPhase::APPROACH) {
+            vs = alt_error > -200.0 ? alt_error * 0.05 : -max_descent_[i] * 0.7;
+            if (phase == AircraftFlightPhase::APPROACH) vs = std::max(vs, -5.0);
+        } else {
+            vs = std::clamp(alt_error * 0.02, -3.0, 3.0);
+        }
+        vs = std::clamp(vs, -max_descent_[i], max_climb_[i]);
+        alt = std::clamp(alt + vs * dt, 0.0, ceiling_[i]);
+
+        // Speed control
+        double accel = std::clamp((target_speed_[i] - tas) * 0.1, -2.0, 2.0);
+        tas = std::clamp(tas + accel * dt, 60.0, 280.0);
+
+        // Wind triangle at the new altitude
+        lookup(alt, sound_speed, we, wn);
+        if (grid_) grid_->sample(lat_[i], lon_[i], alt, grid_time, cursors_[i], we, wn);
+        double heading = heading_[i] * DEG_TO_RAD;
+        double ge = tas * std::sin(heading) + we;
+        double gn = tas * std::cos(heading) + wn;
+
+        alt_[i] = alt;
+        vs_[i] = vs;
+        tas_[i] = tas;
+        gs_[i] = std::sqrt(ge * ge + gn * gn);
+        track_[i] = std::fmod(std::atan2(ge, gn) * RAD_TO_DEG + 360.0, 360.0);
+    }
+
+    // Coordinated turn and great-circle position update (branch-free)
+    double* lat = lat_.data();
+    double* lon = lon_.data();
+    double* heading = heading_.data();
+    const double* track = track_.data();
+    const double* bank = bank_.data();
+    const double* gs = gs_.data();
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        double rate = GRAVITY * std::tan(bank[i] * DEG_TO_RAD) / std::max(gs[i], 30.0) * RAD_TO_DEG;
+        rate = std::clamp(rate, -3.0, 3.0);
+        rate = (gs[i] > 30.0 && std::abs(bank[i]) > 0.5) ? rate : 0.0;
+        heading[i] = std::fmod(heading[i] + rate * dt + 360.0, 360.0);
+
+        double d = gs[i] * dt / EARTH_RADIUS;
+        double b = track[i] * DEG_TO_RAD;
+        double phi = lat[i] * DEG_TO_RAD;
+        double sin_phi = std::sin(phi), cos_phi = std::cos(phi);
+        double sin_d = std::sin(d), cos_d = std::cos(d);
+        double sin_new = sin_phi * cos_d + cos_phi * sin_d * std::cos(b);
+        lat[i] = std::asin(sin_new) * RAD_TO_DEG;
+        lon[i] += std::atan2(std::sin(b) * sin_d * cos_phi, cos_d - sin_phi * sin_new) * RAD_TO_DEG;
+    }
+
+    since_autopilot_ += dt;
+    pending_ += dt;
+    time_ += dt;
+}
+
+} // namespace sim
@@ -0,0 +1,101 @@
+#ifndef AIRCRAFT_FLEET_HPP
+#define AIRCRAFT_FLEET_HPP
+
+#include "aircraft.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+struct AircraftFleetConfig {
+    double autopilot_interval = 1.0;   // [s] phase, autopilot and navigation cadence
+    double table_step = 50.0;          // [m] altitude resolution of the shared tables
+    double table_ceiling = 20000.0;    // [m] tables are clamped above this
+};
+
+/**
+ * @brief Batched point-mass simulation of many Aircraft
+ *
+ * Aircraft::update converts ECEF to geodetic several times per step and
+ * walks the wind field per aircraft. The fleet instead keeps latitude,
+ * longitude, altitude, heading, airspeed and the autopilot targets of
+ * every member in structure-of-arrays form and integrates the same
+ * kinematics (update_aerodynamics + update_kinematics) directly in
+ * geodetic coordinates. Speed of sound and wind come from altitude
+ * tables shared by the whole fleet, and the turn / great-circle update
+ * is a branch-free loop the compiler can vectorize.
+ *
+ * Phase logic, autopilot, waypoint navigation and fuel burn run through
+ * the aircraft's own methods every autopilot_interval, after the SoA
+ * state has been written back (sync()); anything they change is read
+ * back before the next dynamics step. Between those points the Aircraft
+ * objects hold stale state, so call sync() before reading them.
+ *
+ * 6DOF aircraft and subclasses (Fighter) keep their full update() and are
+ * stepped one by one. Members must not also be updated elsewhere
+ * (e.g. by a SimulationEngine). The fleet's wind (profile or WindGrid,
+ * sampled in one batch per step with a cursor per member) replaces the
+ * members' own.
+ */
+class AircraftFleet {
+public:
+    explicit AircraftFleet(const AircraftFleetConfig& config = AircraftFleetConfig{});
+
+    void add(std::shared_ptr<Aircraft> aircraft);
+    size_t size() const { return members_.size() + scalar_.size(); }
+
+    /// Altitude-varying wind shared by all members (same convention as Aircraft)
+    void set_wind_field(const std::vector<WindVector>& winds);
+
+    /// Gridded wind instead of the shared profile; grid time at fleet time 0
+    void set_wind_grid(std::shared_ptr<const WindGrid> grid, double time_offset = 0.0);
+
+    /// Advance every member by dt
+    void update(double dt);
+
+    /// Write the SoA state (position, velocity, speeds, time, fuel) back into the members
+    void sync();
+
+    double get_time() const { return time_; }
+
+private:
+    AircraftFleetConfig config_;
+    double time_ = 0.0;
+    double since_autopilot_ = 0.0;
+    double pending_ = 0.0;             // [s] integrated since the last sync()
+    bool autopilot_primed_ = false;
+
+    std::vector<std::shared_ptr<Aircraft>> members_;   // SoA index i
+    std::vector<std::shared_ptr<Aircraft>> scalar_;    // Full per-aircraft update
+
+    // Kinematic state (degrees, metres, m/s)
+    std::vector<double> lat_, lon_, alt_;
+    std::vector<double> heading_, track_, bank_;
+    std::vector<double> tas_, gs_, vs_;
+    std::vector<uint8_t> phase_;
+
+    // Autopilot targets and limits
+    std::vector<double> target_alt_, target_speed_;
+    std::vector<double> max_climb_, max_descent_, ceiling_, max_mach_;
+
+    // Shared tables, index k at altitude k * table_step
+    std::vector<double> sound_speed_;
+    std::vector<double> wind_east_, wind_north_;
+
+    // Gridded wind: one cursor per member, batched samples at the step start
+    std::shared_ptr<const WindGrid> grid_;
+    double grid_offset_ = 0.0;
+    std::vector<WindGrid::Cursor> cursors_;
+    std::vector<double> grid_east_, grid_north_;
+
+    void lookup(double alt, double& sound_speed, double& wind_east, double& wind_north) const;
+    void run_autopilot(double dt);
+    void write_back(size_t i);
+    void read_back(size_t i);
+};
+
+} // namespace sim
+
+#endif // AIRCRAFT_FLEET_HPP
@@ -6,9 +6,11 @@
 #include "physics/gravity_model.hpp"
 #include "physics/atmosphere_model.hpp"
 #include "physics/multi_body_gravity.hpp"
+#include "physics/orbital_elements.hpp"
 #include "propagators/rk4_integrator.hpp"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 namespace sim {
 
@@ -160,34 +162,61 @@ void CommandModule::update(double dt) {
     }
 }
 
-void CommandModule::update_orbital(double dt) {
-    // Multi-body gravity derivative function
-    auto derivatives = [this](const StateVector& s) {
-        StateVector deriv;
+double CommandModule::warp_horizon() const {
+    if (flight_phase_ != CMFlightPhase::ORBITAL || primary_body_ != PrimaryBody::EARTH) {
+        return 0.0;
+    }
 
-        // Get gravity acceleration based on primary body
-        Vec3 accel = MultiBodyGravity::compute_acceleration(
-            s.position, primary_body_, moon_state_.position,
-            true,   // include J2
-            true);  // include third-body
+    double horizon = std::numeric_limits<double>::infinity();
+    for (const auto& m : maneuvers_) {
+        if (!m.executed) horizon = std::min(horizon, m.start_time - mission_time_);
+    }
 
-        deriv.position = accel;    // Acceleration stored as position derivative
-        deriv.velocity = s.velocity;
+    // Entry interface: the next descending crossing of its radius
+    constexpr double ENTRY_ALTITUDE = 120000.0;
+    constexpr double ENTRY_MARGIN = 60.0;     // [s] left to fine steps (J2, moon)
+    double r_entry = EARTH_RADIUS + ENTRY_ALTITUDE;
+    double r = state_.position.norm();
+    if (r <= r_entry) return 0.0;
+
+    OrbitalElements el = OrbitalMechanics::state_to_elements(state_);
+    double a = el.semi_major_axis;
+    double e = el.eccentricity;
+    if (e >= 1.0 || a <= 0.0) return 0.0;     // Escape: SOI change ahead
+    if (a * (1.0 - e) < r_entry) {
+        double cos_nu = (a * (1.0 - e * e) / r_entry - 1.0) / e;
+        double nu_entry = 2.0 * M_PI - std::acos(std::clamp(cos_nu, -1.0, 1.0));
+        double m_now = OrbitalMechanics::true_to_mean_anomaly(el.true_anomaly, e);
+        double m_entry = OrbitalMechanics::true_to_mean_anomaly(nu_entry, e);
+        double dm = std::fmod(m_entry - m_now + 4.0 * M_PI, 2.0 * M_PI);
+        horizon = std::min(horizon, dm / el.mean_motion() - ENTRY_MARGIN);
+    }
+    return std::max(horizon, 0.0);
+}
 
+void CommandModule::coast(double dt) {
+    constexpr double MAX_COAST_STEP = 10.0;  // [s]
+    int steps = static_cast<int>(std::ceil(dt / MAX_COAST_STEP));
+    for (int k = 0; k < steps; ++k) update_orbital(dt / steps);
+    mission_time_ += dt;
+}
+
+void CommandModule::update_orbital(double dt) {
+    // Primary and force-model terms are settled once per step, not per stage
+    gravity_.set_primary(primary_body_);
+    gravity_.classify(state_, moon_state_);
+    primary_body_ = gravity_.primary();
+
+    double t0 = state_.time;
+    auto derivatives = [this, t0](const StateVector& s) {
+        StateVector deriv;
+        deriv.position = gravity_.acceleration(s.position, s.time - t0);  // Acceleration stored as position derivative
+        deriv.velocity = s.velocity;
         return deriv;
     };
 
     // RK4 integration
     state_ = RK4Integrator::step(state_, dt, derivatives);
-
-    // Check for SOI transition
-    PrimaryBody new_primary = MultiBodyGravity::determine_primary(
-        state_.position, moon_state_.position);
-
-    if (new_primary != primary_body_) {
-        primary_body_ = new_primary;
-        // Note: Velocity is already in ECI, so no conversion needed
-    }
 }
 
 void CommandModule::update_atmospheric(double dt) {
@@ -91,6 +91,13 @@ public:
      */
     void update(double dt) override;
 
+    /**
+     * Earth orbit coasting: until the next scheduled maneuver or the
+     * predicted entry interface crossing (two-body estimate, less a margin)
+     */
+    double warp_horizon() const override;
+    void coast(double dt) override;
+
     // State queries
     CMFlightPhase get_flight_phase() const { return flight_phase_; }
     PrimaryBody get_primary_body() const { return primary_body_; }
@@ -147,6 +154,7 @@ private:
 
     // Moon state for multi-body gravity
     StateVector moon_state_;
+    HierarchicalGravity gravity_;
 
     // Heat shield
     double heat_shield_remaining_ = 1.0;  // Fraction remaining
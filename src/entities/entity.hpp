@@ -38,6 +38,17 @@ public:
     
     // Update state based on time step
     virtual void update(double dt) = 0;
+
+    /**
+     * Time-skip support for SimulationEngine warp (see WarpConfig).
+     * warp_horizon() is how far [s] coast() may advance this entity before
+     * its next discrete event (maneuver, waypoint, staging, atmosphere
+     * interface); 0 means it needs fine update() steps now.
+     */
+    virtual double warp_horizon() const { return 0.0; }
+
+    /// Advance dt <= warp_horizon() seconds, analytically or in coarse steps
+    virtual void coast(double dt) { update(dt); }
     
     // Get 3D model path (if applicable)
     virtual std::string get_model_path() const { return ""; }
@@ -249,8 +249,9 @@ void Fighter::update(double dt) {
     // Update base aircraft physics
     Aircraft::update(dt);
 
-    // Update missiles
+    // Update missiles (unless a driver flies them out in batch)
     for (auto& missile : missiles_) {
+        if (external_missiles_) break;
         if (missile->is_active() && locked_target_) {
             FlightState tgt_state = locked_target_->get_flight_state();
             missile->update(dt, tgt_state.latitude, tgt_state.longitude, tgt_state.altitude_msl);
@@ -270,7 +271,7 @@ void Fighter::update_radar(const std::vector<Fighter*>& all_fighters) {
     radar_contacts_.clear();
     is_spiked_ = false;
 
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
 
     for (const auto* other : all_fighters) {
         if (other == this || !other->is_alive()) continue;
@@ -323,17 +324,16 @@ bool Fighter::is_in_radar_cone(const Fighter* target) const {
 }
 
 double Fighter::compute_antenna_train_angle(const Fighter* target) const {
-    FlightState my_state = get_flight_state();
-    FlightState tgt_state = target->get_flight_state();
-    double bearing = bearing_to(tgt_state.latitude, tgt_state.longitude);
-    double ata = bearing - my_state.heading;
+    double ata = bearing_to(target) - own_state().heading;
     while (ata > 180.0) ata -= 360.0;
     while (ata < -180.0) ata += 360.0;
     return ata;
 }
 
 double Fighter::compute_aspect_angle(const Fighter* target) const {
-    FlightState my_state = get_flight_state();
+    if (const ContactGeometry* c = find_contact(target)) return c->aspect_angle;
+
+    FlightState my_state = own_state();
     FlightState tgt_state = target->get_flight_state();
 
     // Bearing FROM target TO us
@@ -357,7 +357,7 @@ double Fighter::compute_aspect_angle(const Fighter* target) const {
 }
 
 double Fighter::bearing_to(double lat, double lon) const {
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
     double lat1 = my_state.latitude * DEG_TO_RAD;
     double lon1 = my_state.longitude * DEG_TO_RAD;
     double lat2 = lat * DEG_TO_RAD;
@@ -371,7 +371,7 @@ double Fighter::bearing_to(double lat, double lon) const {
 }
 
 double Fighter::range_to(double lat, double lon, double alt) const {
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
     double dlat = (lat - my_state.latitude) * DEG_TO_RAD;
     double dlon = (lon - my_state.longitude) * DEG_TO_RAD;
     double a = std::sin(dlat/2) * std::sin(dlat/2) +
@@ -383,6 +383,76 @@ double Fighter::range_to(double lat, double lon, double alt) const {
     return std::sqrt(horiz_dist * horiz_dist + vert_dist * vert_dist);
 }
 
+// ---------------------------------------------------------------------------
+// Shared relative-geometry picture
+// ---------------------------------------------------------------------------
+
+void Fighter::set_picture(const FlightState* own, const std::vector<ContactGeometry>* contacts) {
+    picture_state_ = own;
+    picture_ = contacts;
+}
+
+FlightState Fighter::own_state() const {
+    return picture_state_ ? *picture_state_ : get_flight_state();
+}
+
+const ContactGeometry* Fighter::find_contact(const Fighter* other) const {
+    if (!picture_) return nullptr;
+    for (const auto& c : *picture_) {
+        if (c.other == other) return &c;
+    }
+    return nullptr;
+}
+
+double Fighter::bearing_to(const Fighter* target) const {
+    if (const ContactGeometry* c = find_contact(target)) return c->bearing;
+    FlightState tgt = target->get_flight_state();
+    return bearing_to(tgt.latitude, tgt.longitude);
+}
+
+double Fighter::range_to(const Fighter* target) const {
+    if (const ContactGeometry* c = find_contact(target)) return c->range;
+    FlightState tgt = target->get_flight_state();
+    return range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+}
+
+void Fighter::update_radar() {
+    radar_contacts_.clear();
+    is_spiked_ = false;
+    if (!picture_) return;
+
+    double heading = own_state().heading;
+    for (const auto& c : *picture_) {
+        const Fighter* other = c.other;
+        if (!other->is_alive()) continue;
+
+        double ata = c.bearing - heading;
+        while (ata > 180.0) ata -= 360.0;
+        while (ata < -180.0) ata += 360.0;
+
+        if (c.range < fighter_config_.radar_range && std::abs(ata) < fighter_config_.radar_fov / 2.0) {
+            RadarContact contact;
+            contact.target_id = other->get_id();
+            contact.range = c.range;
+            contact.bearing = c.bearing - heading;
+            contact.aspect_angle = c.aspect_angle;
+            contact.altitude = c.altitude;
+            contact.is_locked = (locked_target_ == other);
+            contact.closure_rate = c.closure_rate;
+            radar_contacts_.push_back(contact);
+        }
+
+        if (other->get_team() != team_ && other->locked_target_ == this) {
+            is_spiked_ = true;
+        }
+    }
+
+    std::sort(radar_contacts_.begin(), radar_contacts_.end(),
+              [](const RadarContact& a, const RadarContact& b) {
+                  return a.range < b.range;
+              });
+}
+
 void Fighter::lock_target(Fighter* target) {
     locked_target_ = target;
     for (auto& contact : radar_contacts_) {
@@ -402,8 +472,7 @@ bool Fighter::can_fire_aim120() const {
     if (!locked_target_ || !locked_target_->is_alive()) return false;
     if (time_since_last_shot_ < 3.0) return false;  // 3 second minimum between shots
 
-    FlightState tgt = locked_target_->get_flight_state();
-    double range = range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+    double range = range_to(locked_target_);
 
     return range >= fighter_config_.aim120_min_range &&
            range <= fighter_config_.aim120_max_range;
@@ -414,8 +483,7 @@ bool Fighter::can_fire_aim9() const {
     if (!locked_target_ || !locked_target_->is_alive()) return false;
     if (time_since_last_shot_ < 2.0) return false;
 
-    FlightState tgt = locked_target_->get_flight_state();
-    double range = range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+    double range = range_to(locked_target_);
     double ata = std::abs(compute_antenna_train_angle(locked_target_));
 
     return range >= fighter_config_.aim9_min_range &&
@@ -426,7 +494,7 @@ bool Fighter::can_fire_aim9() const {
 std::shared_ptr<Missile> Fighter::fire_aim120() {
     if (!can_fire_aim120()) return nullptr;
 
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
     auto missile = std::make_shared<Missile>(
         next_missile_id_++, Missile::Type::AIM120,
         get_id(), locked_target_->get_id(), team_
@@ -451,7 +519,7 @@ std::shared_ptr<Missile> Fighter::fire_aim120() {
 std::shared_ptr<Missile> Fighter::fire_aim9() {
     if (!can_fire_aim9()) return nullptr;
 
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
     auto missile = std::make_shared<Missile>(
         next_missile_id_++, Missile::Type::AIM9,
         get_id(), locked_target_->get_id(), team_
@@ -477,8 +545,6 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
                                const std::vector<std::shared_ptr<Missile>>& incoming) {
     if (killed_) return;
 
-    FlightState my_state = get_flight_state();
-
     // Check for incoming missiles
     missile_inbound_ = false;
     for (const auto& m : incoming) {
@@ -501,6 +567,32 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
         }
     }
 
+    run_state_machine(closest_enemy, closest_range);
+}
+
+void Fighter::run_tactical_ai(bool missile_inbound) {
+    if (killed_) return;
+    missile_inbound_ = missile_inbound;
+
+    // Closest live enemy within the picture
+    Fighter* closest_enemy = nullptr;
+    double closest_range = 999999.0;
+    if (picture_) {
+        for (const auto& c : *picture_) {
+            if (c.other->get_team() == team_ || !c.other->is_alive()) continue;
+            if (c.range < closest_range) {
+                closest_range = c.range;
+                closest_enemy = c.other;
+            }
+        }
+    }
+
+    run_state_machine(closest_enemy, closest_range);
+}
+
+void Fighter::run_state_machine(Fighter* closest_enemy, double closest_range) {
+    FlightState my_state = own_state();
+
     // State machine logic
     switch (tactical_state_) {
         case TacticalState::PATROL:
@@ -531,13 +623,12 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
         case TacticalState::COMMIT:
             // Turn toward target (hot)
             if (locked_target_ && locked_target_->is_alive()) {
-                FlightState tgt = locked_target_->get_flight_state();
-                double bearing = bearing_to(tgt.latitude, tgt.longitude);
+                double bearing = bearing_to(locked_target_);
                 set_target_heading(bearing);
                 set_target_speed(280.0);  // Speed up for engagement
                 set_throttle(0.95);
 
-                double range = range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+                double range = range_to(locked_target_);
 
                 // Check for missile launch
                 if (can_fire_aim120() && range < fighter_config_.aim120_max_range * 0.8) {
@@ -578,8 +669,7 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
             if (locked_target_ && locked_target_->is_alive()) {
                 execute_crank(0.0);  // dt not used, just sets heading
 
-                FlightState tgt = locked_target_->get_flight_state();
-                double range = range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+                double range = range_to(locked_target_);
 
                 // If range opens up and we have missiles, can go for another shot
                 if (state_timer_ > 10.0 && shots_fired_this_engagement_ < 2 && loadout_.aim120_count > 0) {
@@ -638,8 +728,7 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
                 execute_pursuit(0.0);
                 set_throttle(1.0);
 
-                FlightState tgt = locked_target_->get_flight_state();
-                double range = range_to(tgt.latitude, tgt.longitude, tgt.altitude_msl);
+                double range = range_to(locked_target_);
 
                 // Try to get a Sidewinder shot
                 if (can_fire_aim9()) {
@@ -680,8 +769,7 @@ void Fighter::run_tactical_ai(const std::vector<Fighter*>& friendlies,
 void Fighter::execute_crank(double dt) {
     if (!locked_target_) return;
 
-    FlightState tgt = locked_target_->get_flight_state();
-    double bearing = bearing_to(tgt.latitude, tgt.longitude);
+    double bearing = bearing_to(locked_target_);
 
     // Crank angle off the target (beam maneuver)
     double crank_heading = bearing + crank_direction_ * fighter_config_.crank_angle;
@@ -694,9 +782,7 @@ void Fighter::execute_crank(double dt) {
 void Fighter::execute_pump(double dt) {
     if (!locked_target_) return;
 
-    FlightState my_state = get_flight_state();
-    FlightState tgt = locked_target_->get_flight_state();
-    double bearing = bearing_to(tgt.latitude, tgt.longitude);
+    double bearing = bearing_to(locked_target_);
 
     // Turn cold (away from target)
     double cold_heading = bearing + 180.0;
@@ -708,7 +794,7 @@ void Fighter::execute_pump(double dt) {
 }
 
 void Fighter::execute_break(double dt) {
-    FlightState my_state = get_flight_state();
+    FlightState my_state = own_state();
 
     // Hard break turn into the threat
     double break_heading = my_state.heading + 90.0 * crank_direction_;
@@ -722,8 +808,10 @@ void Fighter::execute_break(double dt) {
 void Fighter::execute_pursuit(double dt) {
     if (!locked_target_) return;
 
-    FlightState tgt = locked_target_->get_flight_state();
-    double bearing = bearing_to(tgt.latitude, tgt.longitude);
+    const ContactGeometry* contact = find_contact(locked_target_);
+    double bearing = bearing_to(locked_target_);
+    double target_altitude = contact ? contact->altitude
+                                     : locked_target_->get_flight_state().altitude_msl;
 
     // Lead pursuit
     double lead = 5.0;  // degrees of lead
@@ -731,7 +819,7 @@ void Fighter::execute_pursuit(double dt) {
     pursuit_heading = std::fmod(pursuit_heading + 360.0, 360.0);
 
     set_target_heading(pursuit_heading);
-    set_target_altitude(tgt.altitude_msl);
+    set_target_altitude(target_altitude);
     set_target_speed(fighter_config_.corner_speed);
 }
 
@@ -44,6 +44,17 @@ struct RadarContact {
     double time_since_update;
 };
 
+// Geometry of another fighter from this one, precomputed once per tick
+// (AirCombatSimulator) and read by the radar and tactical AI
+struct ContactGeometry {
+    Fighter* other;
+    double range;           // meters
+    double bearing;         // degrees true, from us to them
+    double aspect_angle;    // degrees (0 = head-on, 180 = tail)
+    double closure_rate;    // m/s (positive = closing)
+    double altitude;        // meters
+};
+
 // Missile loadout
 struct MissileLoadout {
     int aim120_count = 4;   // AMRAAM (active radar, BVR)
@@ -176,6 +187,9 @@ public:
     // Override update
     void update(double dt) override;
 
+    // Weapons and sensor timers run every step: never time-skipped
+    double warp_horizon() const override { return 0.0; }
+
     // Team
     Team get_team() const { return team_; }
     void set_team(Team t) { team_ = t; }
@@ -185,8 +199,14 @@ public:
     bool is_alive() const { return !killed_; }
     void kill() { killed_ = true; tactical_state_ = TacticalState::KILLED; }
 
+    // Shared tick picture: own flight state and the fighters within the
+    // table radius. While set, range/bearing/aspect queries read it instead
+    // of recomputing flight states; pass nullptrs to clear.
+    void set_picture(const FlightState* own, const std::vector<ContactGeometry>* contacts);
+
     // Radar and targeting
     void update_radar(const std::vector<Fighter*>& all_fighters);
+    void update_radar();  // From the picture
     const std::vector<RadarContact>& get_contacts() const { return radar_contacts_; }
     Fighter* get_locked_target() const { return locked_target_; }
     void lock_target(Fighter* target);
@@ -205,6 +225,10 @@ public:
     void run_tactical_ai(const std::vector<Fighter*>& friendlies,
                          const std::vector<Fighter*>& enemies,
                          const std::vector<std::shared_ptr<Missile>>& incoming);
+    void run_tactical_ai(bool missile_inbound);  // From the picture
+
+    // Missiles flown by the caller (AirCombatSimulator) instead of update()
+    void set_external_missile_update(bool external) { external_missiles_ = external; }
 
     // RWR (Radar Warning Receiver)
     bool is_spiked() const { return is_spiked_; }
@@ -248,8 +272,18 @@ private:
     double pump_timer_ = 0.0;
     double state_timer_ = 0.0;
     int shots_fired_this_engagement_ = 0;
+    bool external_missiles_ = false;
+
+    // Tick picture (set_picture)
+    const FlightState* picture_state_ = nullptr;
+    const std::vector<ContactGeometry>* picture_ = nullptr;
 
     // Helper functions
+    FlightState own_state() const;
+    const ContactGeometry* find_contact(const Fighter* other) const;
+    double bearing_to(const Fighter* target) const;
+    double range_to(const Fighter* target) const;
+    void run_state_machine(Fighter* closest_enemy, double closest_range);
     double compute_aspect_angle(const Fighter* target) const;
     double compute_antenna_train_angle(const Fighter* target) const;
     bool is_in_radar_cone(const Fighter* target) const;
@@ -3,9 +3,11 @@
 #include "physics/atmosphere_model.hpp"
 #include "physics/orbital_elements.hpp"
 #include "coordinate/time_utils.hpp"
+#include "propagators/rk4_integrator.hpp"
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 
 namespace sim {
 
@@ -43,6 +45,8 @@ LaunchVehicle::LaunchVehicle(const std::string& name, int id,
       target_inclination_(28.5 * DEG_TO_RAD),  // Cape Canaveral latitude
       gravity_turn_start_alt_(1000.0),  // Start turn at 1 km
       gravity_turn_rate_(0.005),  // ~0.3 deg/s
+      explicit_guidance_(false),
+      guidance_engage_alt_(60000.0),
       drag_coefficient_(0.3),
       reference_area_(10.0)  // m^2
 {
@@ -137,6 +141,14 @@ void LaunchVehicle::set_gravity_turn_start(double altitude, double pitch_rate) {
     gravity_turn_rate_ = pitch_rate;
 }
 
+void LaunchVehicle::enable_explicit_guidance(double engage_altitude,
+                                             const AscentGuidanceConfig& config) {
+    explicit_guidance_ = true;
+    guidance_engage_alt_ = engage_altitude;
+    guidance_config_ = config;
+    guidance_config_.mu = GravityModel::EARTH_MU;
+}
+
 void LaunchVehicle::add_maneuver(const Maneuver& maneuver) {
     maneuvers_.push_back(maneuver);
 }
@@ -197,6 +209,7 @@ void LaunchVehicle::update(double dt) {
 
         case FlightPhase::VERTICAL_ASCENT:
         case FlightPhase::GRAVITY_TURN:
+        case FlightPhase::EXPLICIT_GUIDANCE:
         case FlightPhase::CIRCULARIZATION:
             update_powered_flight(dt);
             break;
@@ -214,6 +227,32 @@ void LaunchVehicle::update(double dt) {
     state_.time += dt;
 }
 
+double LaunchVehicle::warp_horizon() const {
+    if (phase_ == FlightPhase::PRE_LAUNCH) return std::numeric_limits<double>::infinity();
+    if (phase_ != FlightPhase::ORBITAL) return 0.0;
+
+    double horizon = std::numeric_limits<double>::infinity();
+    for (const auto& m : maneuvers_) {
+        if (!m.completed) horizon = std::min(horizon, m.start_time - state_.time);
+    }
+    return std::max(horizon, 0.0);
+}
+
+void LaunchVehicle::coast(double dt) {
+    if (phase_ == FlightPhase::ORBITAL) {
+        // Same J2 gravity as update_orbital(), in RK4 steps coarse enough to skip
+        auto derivatives = [](const StateVector& s) {
+            return GravityModel::compute_derivatives(s, true);
+        };
+        constexpr double MAX_COAST_STEP = 10.0;  // [s]
+        int steps = static_cast<int>(std::ceil(dt / MAX_COAST_STEP));
+        double t = state_.time;
+        for (int k = 0; k < steps; ++k) state_ = RK4Integrator::step(state_, dt / steps, derivatives);
+        state_.time = t;
+    }
+    state_.time += dt;
+}
+
 void LaunchVehicle::update_pre_launch(double dt) {
     // Vehicle is on the pad - no movement
     // Could add countdown logic here
@@ -228,6 +267,12 @@ void LaunchVehicle::update_powered_flight(double dt) {
         std::cout << "T+" << state_.time << "s: Beginning gravity turn at "
                   << alt/1000.0 << " km" << std::endl;
     }
+    if (phase_ == FlightPhase::GRAVITY_TURN && explicit_guidance_ && alt > guidance_engage_alt_) {
+        engage_guidance();
+    }
+    if (phase_ == FlightPhase::EXPLICIT_GUIDANCE && guidance_.due(state_.time)) {
+        guidance_.update(state_.position, state_.velocity, state_.time, guidance_stages());
+    }
 
     // Compute forces
     Vec3 gravity = compute_gravity(state_.position);
@@ -235,6 +280,18 @@ void LaunchVehicle::update_powered_flight(double dt) {
     double thrust_mag = compute_current_thrust();
     double mass = get_total_mass();
 
+    // Guided flight: burn only the part of the last step that reaches the target energy
+    bool cutoff = false;
+    if (phase_ == FlightPhase::EXPLICIT_GUIDANCE && thrust_mag > 0.0) {
+        double energy_gain = (thrust_dir.x * state_.velocity.x + thrust_dir.y * state_.velocity.y +
+                              thrust_dir.z * state_.velocity.z) * thrust_mag / mass * dt;
+        double to_go = guidance_.energy_to_go(state_.position, state_.velocity);
+        if (energy_gain >= to_go) {
+            thrust_mag *= std::max(0.0, to_go / energy_gain);
+            cutoff = true;
+        }
+    }
+
     // Thrust force
     Vec3 thrust;
     thrust.x = thrust_mag * thrust_dir.x;
@@ -273,6 +330,16 @@ void LaunchVehicle::update_powered_flight(double dt) {
         }
     }
 
+    // Guided flight ends at the target energy, not at the first stable orbit
+    if (phase_ == FlightPhase::EXPLICIT_GUIDANCE) {
+        if (!cutoff && !guidance_.cutoff(state_.position, state_.velocity)) return;
+        engines_on_ = false;
+        phase_ = FlightPhase::COAST;
+        std::cout << "T+" << state_.time << "s: Guidance cutoff at "
+                  << get_altitude()/1000.0 << " km, " << get_velocity_magnitude() << " m/s"
+                  << std::endl;
+    }
+
     // Check for orbit insertion
     check_orbit_insertion();
 }
@@ -329,6 +396,30 @@ void LaunchVehicle::stage_separation() {
     }
 }
 
+void LaunchVehicle::engage_guidance() {
+    const double radius = GravityModel::EARTH_RADIUS + target_altitude_;
+    const AscentTarget target = AscentTarget::circular(
+        radius, target_inclination_ * RAD_TO_DEG, state_.position, state_.velocity,
+        GravityModel::EARTH_MU);
+    guidance_ = AscentGuidance(target, guidance_config_);
+    phase_ = FlightPhase::EXPLICIT_GUIDANCE;
+    std::cout << "T+" << state_.time << "s: Explicit guidance engaged at "
+              << get_altitude()/1000.0 << " km" << std::endl;
+}
+
+std::vector<GuidanceStage> LaunchVehicle::guidance_stages() const {
+    // Vacuum performance; the burning stage as it is now, later ones at ignition
+    std::vector<GuidanceStage> out;
+    double mass = get_total_mass();
+    for (size_t i = current_stage_; i < stages_.size(); i++) {
+        const RocketStage& s = stages_[i];
+        const double ve = s.isp_vac * AtmosphereModel::G0;
+        out.push_back({s.thrust, ve, mass, propellant_remaining_[i] * ve / s.thrust});
+        mass -= s.dry_mass + propellant_remaining_[i];
+    }
+    return out;
+}
+
 Vec3 LaunchVehicle::compute_thrust_direction() const {
     Vec3 dir;
     double r_mag = state_.position.norm();
@@ -400,6 +491,9 @@ Vec3 LaunchVehicle::compute_thrust_direction() const {
 
         return dir;
     }
+    else if (phase_ == FlightPhase::EXPLICIT_GUIDANCE) {
+        return guidance_.steer(state_.position, state_.time);
+    }
     else if (phase_ == FlightPhase::CIRCULARIZATION) {
         // Thrust prograde for circularization
         double v_mag = state_.velocity.norm();
@@ -3,6 +3,7 @@
 
 #include "entities/entity.hpp"
 #include "coordinate/frame_transformer.hpp"
+#include "physics/ascent_guidance.hpp"
 #include <vector>
 #include <functional>
 
@@ -34,7 +35,8 @@ enum class FlightPhase {
     COAST,           // Engine off, coasting
     CIRCULARIZATION, // Final burn for orbit insertion
     ORBITAL,         // In stable orbit
-    MANEUVER         // Executing a planned maneuver
+    MANEUVER,        // Executing a planned maneuver
+    EXPLICIT_GUIDANCE // Closed-loop steering to insertion
 };
 
 /**
@@ -56,6 +58,9 @@ struct Maneuver {
  *
  * Simulates a multi-stage rocket from ground launch through orbit insertion.
  * Includes thrust, mass flow, atmospheric drag, and gravity turn guidance.
+ * With explicit guidance enabled, the open-loop gravity turn hands over to
+ * AscentGuidance above the engage altitude, which steers to the target
+ * orbit and cuts the engines at its energy.
  */
 class LaunchVehicle : public Entity {
 public:
@@ -75,6 +80,10 @@ public:
     // Entity interface
     virtual void update(double dt) override;
 
+    // On the pad before ignite(), or in orbit until the next maneuver
+    double warp_horizon() const override;
+    void coast(double dt) override;
+
     // Stage configuration
     void add_stage(const RocketStage& stage);
     void set_payload_mass(double mass) { payload_mass_ = mass; }
@@ -86,6 +95,9 @@ public:
     // Guidance
     void set_target_orbit(double altitude, double inclination);
     void set_gravity_turn_start(double altitude, double pitch_rate);
+    void enable_explicit_guidance(double engage_altitude = 60000.0,
+                                  const AscentGuidanceConfig& config = AscentGuidanceConfig());
+    const AscentGuidance& get_guidance() const { return guidance_; }
 
     // Maneuver scheduling
     void add_maneuver(const Maneuver& maneuver);
@@ -132,6 +144,12 @@ private:
     double gravity_turn_rate_;  // rad/s pitch rate during turn
     double initial_heading_;    // Launch azimuth [rad]
 
+    // Explicit guidance
+    bool explicit_guidance_;
+    double guidance_engage_alt_;
+    AscentGuidanceConfig guidance_config_;
+    AscentGuidance guidance_;
+
     // Aerodynamics
     double drag_coefficient_;
     double reference_area_;
@@ -156,6 +174,8 @@ private:
     double compute_current_isp() const;
 
     void check_orbit_insertion();
+    void engage_guidance();
+    std::vector<GuidanceStage> guidance_stages() const;
     void execute_maneuvers(double dt);
 
     // Convert geodetic to ECI for initialization
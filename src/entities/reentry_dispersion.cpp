@@ -0,0 +1,344 @@
+/**
+ * Reentry Dispersion Implementation
+ */
+
+#include "entities/reentry_dispersion.hpp"
+#include "physics/atmosphere_model.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "physics/gravity_model.hpp"
+#include "physics/kepler_fg.hpp"
+#include "physics/orbital_elements.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace sim {
+
+namespace {
+
+/// Footprint moments of one block of trials; merged in block order
+struct FootprintSums {
+    ReentryFootprint f;
+    double m2_ee = 0.0, m2_en = 0.0, m2_nn = 0.0;
+    double sum_flight_time = 0.0;
+    double sum_peak_g = 0.0, sum_peak_heat_flux = 0.0, sum_heat_load = 0.0;
+
+    void add(const ReentryTrialResult& r) {
+        f.trials++;
+        sum_peak_g += r.peak_g;
+        sum_peak_heat_flux += r.peak_heat_flux;
+        sum_heat_load += r.heat_load;
+        f.max_peak_g = std::max(f.max_peak_g, r.peak_g);
+        f.max_peak_heat_flux = std::max(f.max_peak_heat_flux, r.peak_heat_flux);
+        if (r.outcome == ReentryOutcome::SKIP_OUT) f.skip_outs++;
+        if (r.outcome == ReentryOutcome::TIMEOUT) f.timeouts++;
+        if (r.outcome != ReentryOutcome::SPLASHDOWN) return;
+
+        // Welford update of the impact point
+        f.splashdowns++;
+        sum_flight_time += r.flight_time;
+        const double de = r.east - f.mean_east;
+        const double dn = r.north - f.mean_north;
+        f.mean_east += de / f.splashdowns;
+        f.mean_north += dn / f.splashdowns;
+        m2_ee += de * (r.east - f.mean_east);
+        m2_en += de * (r.north - f.mean_north);
+        m2_nn += dn * (r.north - f.mean_north);
+    }
+
+    void merge(const FootprintSums& o) {
+        const double na = f.splashdowns, nb = o.f.splashdowns, n = na + nb;
+        if (nb > 0) {
+            const double de = o.f.mean_east - f.mean_east;
+            const double dn = o.f.mean_north - f.mean_north;
+            const double w = na * nb / n;
+            m2_ee += o.m2_ee + de * de * w;
+            m2_en += o.m2_en + de * dn * w;
+            m2_nn += o.m2_nn + dn * dn * w;
+            f.mean_east += de * nb / n;
+            f.mean_north += dn * nb / n;
+        }
+        f.trials += o.f.trials;
+        f.splashdowns += o.f.splashdowns;
+        f.skip_outs += o.f.skip_outs;
+        f.timeouts += o.f.timeouts;
+        f.max_peak_g = std::max(f.max_peak_g, o.f.max_peak_g);
+        f.max_peak_heat_flux = std::max(f.max_peak_heat_flux, o.f.max_peak_heat_flux);
+        sum_flight_time += o.sum_flight_time;
+        sum_peak_g += o.sum_peak_g;
+        sum_peak_heat_flux += o.sum_peak_heat_flux;
+        sum_heat_load += o.sum_heat_load;
+    }
+
+    ReentryFootprint finish() const {
+        ReentryFootprint out = f;
+        if (f.trials > 0) {
+            out.mean_peak_g = sum_peak_g / f.trials;
+            out.mean_peak_heat_flux = sum_peak_heat_flux / f.trials;
+            out.mean_heat_load = sum_heat_load / f.trials;
+        }
+        if (f.splashdowns > 0) out.mean_flight_time = sum_flight_time / f.splashdowns;
+        if (f.splashdowns > 1) {
+            const double dof = f.splashdowns - 1.0;
+            out.cov_ee = m2_ee / dof;
+            out.cov_en = m2_en / dof;
+            out.cov_nn = m2_nn / dof;
+            const double mid = 0.5 * (out.cov_ee + out.cov_nn);
+            const double rad = std::hypot(0.5 * (out.cov_nn - out.cov_ee), out.cov_en);
+            out.semi_major = std::sqrt(mid + rad);
+            out.semi_minor = std::sqrt(std::max(mid - rad, 0.0));
+            out.orientation = 0.5 * std::atan2(2.0 * out.cov_en, out.cov_nn - out.cov_ee);
+        }
+        return out;
+    }
+};
+
+/// Sutton-Graves stagnation heating, as AtmosphereModel::compute_heat_flux
+double heat_flux(double rho, double speed, double altitude, double nose_radius) {
+    if (rho < 1e-15 || nose_radius <= 0.0) return 0.0;
+    double q = AtmosphereModel::SUTTON_GRAVES_K * std::sqrt(rho / nose_radius) *
+               speed * speed * speed;
+    if (altitude > 90000.0) q *= 1.0 - 0.9 * std::min((altitude - 90000.0) / 30000.0, 1.0);
+    return q;
+}
+
+}  // namespace
+
+ReentryDispersion::ReentryDispersion(const CommandModule& vehicle, const StateVector& state,
+                                     const ReentryDispersionConfig& config)
+    : config_(config) {
+    vehicle_.dry_mass = vehicle.dry_mass + vehicle.propellant_mass;
+    vehicle_.shield_mass = vehicle.heat_shield_mass * vehicle.get_heat_shield_remaining();
+    vehicle_.Cd = vehicle.Cd;
+    vehicle_.area = vehicle.cross_section;
+    vehicle_.nose_radius = vehicle.nose_radius;
+    vehicle_.lift_to_drag = vehicle.Cd > 0.0 ? vehicle.CL / vehicle.Cd : 0.0;
+    vehicle_.drogue_Cd = vehicle.drogue_Cd;
+    vehicle_.drogue_area = vehicle.drogue_area;
+    vehicle_.drogue_alt = vehicle.drogue_deploy_alt;
+    vehicle_.drogue_mach = vehicle.drogue_deploy_mach;
+    vehicle_.main_Cd = vehicle.main_Cd;
+    vehicle_.main_area = vehicle.main_area;
+    vehicle_.main_alt = vehicle.main_deploy_alt;
+
+    // Analytic coast to the next descending crossing of the interface
+    entry_ = state;
+    const double r_entry = EARTH_RADIUS + ENTRY_ALTITUDE;
+    if (state.position.norm() > r_entry) {
+        OrbitalElements el = OrbitalMechanics::state_to_elements(state, EARTH_MU);
+        const double a = el.semi_major_axis;
+        const double e = el.eccentricity;
+        if (e >= 1.0 || a <= 0.0) {
+            throw std::invalid_argument("ReentryDispersion: nominal orbit is not elliptic");
+        }
+        if (a * (1.0 - e) >= r_entry) {
+            throw std::invalid_argument("ReentryDispersion: nominal orbit does not reach the entry interface");
+        }
+        const double cos_nu = (a * (1.0 - e * e) / r_entry - 1.0) / e;
+        const double nu_entry = 2.0 * M_PI - std::acos(std::clamp(cos_nu, -1.0, 1.0));
+        const double m_now = OrbitalMechanics::true_to_mean_anomaly(el.true_anomaly, e);
+        const double m_entry = OrbitalMechanics::true_to_mean_anomaly(nu_entry, e);
+        const double dm = std::fmod(m_entry - m_now + 4.0 * M_PI, 2.0 * M_PI);
+        const double coast = dm / el.mean_motion();
+
+        double r[3] = {state.position.x, state.position.y, state.position.z};
+        double v[3] = {state.velocity.x, state.velocity.y, state.velocity.z};
+        kepler_fg_inplace(r, v, coast, EARTH_MU);
+        entry_.position = Vec3{r[0], r[1], r[2]};
+        entry_.velocity = Vec3{v[0], v[1], v[2]};
+        entry_.time = state.time + coast;
+    }
+
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+
+    // Undispersed entry: the footprint's origin
+    Dispersion d;
+    d.lift_to_drag = vehicle_.lift_to_drag;
+    d.drogue_delay = std::max(config_.drogue_delay, 0.0);
+    d.main_delay = std::max(config_.main_delay, 0.0);
+    nominal_ = fly(d);
+    const double cl = std::cos(nominal_.latitude), sl = std::sin(nominal_.latitude);
+    const double co = std::cos(nominal_.longitude), so = std::sin(nominal_.longitude);
+    impact_up_ = Vec3{cl * co, cl * so, sl};
+    impact_east_ = Vec3{-so, co, 0.0};
+    impact_north_ = Vec3{-sl * co, -sl * so, cl};
+}
+
+ReentryDispersion::~ReentryDispersion() = default;
+
+ReentryTrialResult ReentryDispersion::run_trial(int trial) const {
+    std::mt19937_64 rng(config_.seed + static_cast<uint64_t>(trial));
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    Dispersion d;
+    d.flight_path = config_.flight_path_sigma * normal(rng);
+    d.speed = config_.speed_sigma * normal(rng);
+    d.density_scale = std::max(1.0 + config_.density_sigma * normal(rng), 0.05);
+    d.lift_to_drag = vehicle_.lift_to_drag + config_.lift_to_drag_sigma * normal(rng);
+    d.drogue_delay = std::max(config_.drogue_delay + config_.drogue_delay_sigma * normal(rng), 0.0);
+    d.main_delay = std::max(config_.main_delay + config_.main_delay_sigma * normal(rng), 0.0);
+
+    ReentryTrialResult r = fly(d);
+    const double cl = std::cos(r.latitude);
+    const Vec3 up{cl * std::cos(r.longitude), cl * std::sin(r.longitude), std::sin(r.latitude)};
+    const Vec3 du{up.x - impact_up_.x, up.y - impact_up_.y, up.z - impact_up_.z};
+    r.east = EARTH_RADIUS * (du.x * impact_east_.x + du.y * impact_east_.y + du.z * impact_east_.z);
+    r.north = EARTH_RADIUS * (du.x * impact_north_.x + du.y * impact_north_.y + du.z * impact_north_.z);
+    return r;
+}
+
+ReentryFootprint ReentryDispersion::run(int trials, const TrialCallback& on_trial) const {
+    if (trials <= 0) return ReentryFootprint();
+    const size_t block = static_cast<size_t>(std::max(config_.block, 1));
+    const size_t count = static_cast<size_t>(trials);
+    std::vector<FootprintSums> sums((count + block - 1) / block);
+
+    auto one_block = [&](size_t b) {
+        const size_t end = std::min(count, (b + 1) * block);
+        for (size_t k = b * block; k < end; k++) {
+            ReentryTrialResult r = run_trial(static_cast<int>(k));
+            sums[b].add(r);
+            if (on_trial) on_trial(static_cast<int>(k), r);
+        }
+    };
+    if (pool_ && sums.size() > 1) {
+        pool_->parallel_for(sums.size(), one_block);
+    } else {
+        for (size_t b = 0; b < sums.size(); b++) one_block(b);
+    }
+
+    FootprintSums total;
+    for (const FootprintSums& s : sums) total.merge(s);
+    return total.finish();
+}
+
+ReentryTrialResult ReentryDispersion::fly(const Dispersion& d) const {
+    const AtmosphereTable& atmosphere = AtmosphereTable::earth();
+    ReentryTrialResult result;
+
+    Vec3 r = entry_.position;
+    Vec3 v = entry_.velocity;
+
+    // Interface perturbation: turn v in the orbit plane, then rescale it
+    {
+        Vec3 h = cross(r, v);
+        h = h * (1.0 / h.norm());
+        const Vec3 hv = cross(h, v);   // v turned 90 deg toward the ground
+        const double c = std::cos(d.flight_path), s = std::sin(d.flight_path);
+        v = v * c - hv * s;
+        const double speed = v.norm();
+        v = v * (std::max(speed + d.speed, 1.0) / speed);
+    }
+
+    double shield = 1.0;
+    double Cd = vehicle_.Cd;
+    double area = vehicle_.area;
+    double lift_to_drag = d.lift_to_drag;
+    const double cos_bank = std::cos(config_.bank_angle);
+    const double sin_bank = std::sin(config_.bank_angle);
+    double drogue_trigger = -1.0, main_trigger = -1.0;
+
+    // Aerodynamic acceleration; lift at the bank angle from the vertical
+    auto aero = [&](const Vec3& pos, const Vec3& vel, double mass) {
+        const double speed = vel.norm();
+        const double rho = atmosphere.density(pos.norm() - EARTH_RADIUS) * d.density_scale;
+        if (speed < 1e-6 || rho < 1e-15) return Vec3{0.0, 0.0, 0.0};
+        const double drag = 0.5 * rho * speed * speed * Cd * area / mass;
+        const Vec3 vhat = vel * (1.0 / speed);
+        Vec3 acc = vhat * (-drag);
+        if (lift_to_drag != 0.0) {
+            Vec3 up = pos * (1.0 / pos.norm());
+            up = up - vhat * dot(up, vhat);
+            const double n = up.norm();
+            if (n > 1e-12) {
+                up = up * (1.0 / n);
+                const Vec3 side = cross(vhat, up);
+                acc = acc + (up * cos_bank + side * sin_bank) * (lift_to_drag * drag);
+            }
+        }
+        return acc;
+    };
+
+    const double dt = config_.dt;
+    const int max_steps = static_cast<int>(std::ceil(config_.max_flight_time / dt));
+    double t = 0.0;
+    double alt = r.norm() - EARTH_RADIUS;
+
+    for (int step = 0; step < max_steps; step++) {
+        const double mass = vehicle_.dry_mass + vehicle_.shield_mass * shield;
+        auto accel = [&](const Vec3& pos, const Vec3& vel) {
+            return GravityModel::compute_with_j2(pos) + aero(pos, vel, mass);
+        };
+
+        // RK4
+        const Vec3 k1v = accel(r, v), k1r = v;
+        const Vec3 k2v = accel(r + k1r * (0.5 * dt), v + k1v * (0.5 * dt)), k2r = v + k1v * (0.5 * dt);
+        const Vec3 k3v = accel(r + k2r * (0.5 * dt), v + k2v * (0.5 * dt)), k3r = v + k2v * (0.5 * dt);
+        const Vec3 k4v = accel(r + k3r * dt, v + k3v * dt), k4r = v + k3v * dt;
+        const Vec3 r_prev = r, v_prev = v;
+        const double alt_prev = alt;
+        r = r + (k1r + k2r * 2.0 + k3r * 2.0 + k4r) * (dt / 6.0);
+        v = v + (k1v + k2v * 2.0 + k3v * 2.0 + k4v) * (dt / 6.0);
+        t += dt;
+        alt = r.norm() - EARTH_RADIUS;
+
+        if (alt < 0.0) {
+            // Splashdown, interpolated to the surface
+            const double f = alt_prev / (alt_prev - alt);
+            r = r_prev + (r - r_prev) * f;
+            v = v_prev + (v - v_prev) * f;
+            t -= (1.0 - f) * dt;
+            result.outcome = ReentryOutcome::SPLASHDOWN;
+            break;
+        }
+
+        // Loads, heating and ablation, as CommandModule::update_atmospheric
+        const double speed = v.norm();
+        const double rho = atmosphere.density(alt) * d.density_scale;
+        const double q = heat_flux(rho, speed, alt, vehicle_.nose_radius);
+        result.peak_g = std::max(result.peak_g, aero(r, v, mass).norm() / G0);
+        result.peak_heat_flux = std::max(result.peak_heat_flux, q);
+        result.heat_load += q * dt;
+        if (q > 1e6) shield = std::max(0.0, shield - q * dt / 1e9);
+
+        if (alt > ENTRY_ALTITUDE && dot(r, v) > 0.0) {
+            result.outcome = ReentryOutcome::SKIP_OUT;
+            break;
+        }
+
+        // Parachutes: CommandModule's triggers, opening after the delays
+        if (drogue_trigger < 0.0 && alt < vehicle_.drogue_alt &&
+            speed < vehicle_.drogue_mach * atmosphere.state(alt).speed_of_sound) {
+            drogue_trigger = t;
+        }
+        if (drogue_trigger >= 0.0 && result.drogue_time < 0.0 && t >= drogue_trigger + d.drogue_delay) {
+            result.drogue_time = t;
+            Cd = vehicle_.drogue_Cd;
+            area = vehicle_.drogue_area;
+            lift_to_drag = 0.0;
+        }
+        if (result.drogue_time >= 0.0 && main_trigger < 0.0 && alt < vehicle_.main_alt) {
+            main_trigger = t;
+        }
+        if (main_trigger >= 0.0 && result.main_time < 0.0 && t >= main_trigger + d.main_delay) {
+            result.main_time = t;
+            Cd = vehicle_.main_Cd;
+            area = vehicle_.main_area;
+        }
+    }
+
+    result.flight_time = t;
+    result.impact_speed = v.norm();
+    const double rn = r.norm();
+    result.latitude = std::asin(r.z / rn);
+    result.longitude = std::remainder(std::atan2(r.y, r.x) - EARTH_OMEGA * (entry_.time + t),
+                                      2.0 * M_PI);
+    return result;
+}
+
+}  // namespace sim
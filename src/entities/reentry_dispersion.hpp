@@ -0,0 +1,184 @@
+/**
+ * Reentry Dispersion — splashdown footprints for the command module
+ *
+ * Flies thousands of dispersed entries of one CommandModule and reduces
+ * them to an impact ellipse, without keeping trajectories.
+ *
+ *   1. Coast: the nominal state (anywhere on an Earth orbit that reaches
+ *      the atmosphere) goes to the entry interface (ENTRY_ALTITUDE,
+ *      descending) in one Kepler step. This runs once, in the constructor.
+ *   2. Entry: each trial perturbs the interface state and flies the same
+ *      force model as CommandModule::update_atmospheric (J2 gravity, drag
+ *      on the inertial velocity, Sutton-Graves heating and ablation) with
+ *      fixed-step RK4. Density comes from the shared AtmosphereTable::
+ *      earth() scaled by the trial's density factor. Lift is L/D times the
+ *      drag, at `bank_angle` from the local vertical, until the drogue
+ *      opens.
+ *   3. Parachutes: CommandModule's triggers (drogue below
+ *      drogue_deploy_alt and drogue_deploy_mach, main below
+ *      main_deploy_alt) fire, and each chute opens after its dispersed
+ *      delay. Cd and area then switch to the chute's.
+ *   4. Splashdown: the first step below 0 m altitude, interpolated to the
+ *      surface.
+ *
+ * Dispersions (1-sigma, Gaussian): flight path angle and speed at the
+ * interface, a density factor held for the whole entry, L/D, and each
+ * chute's opening delay (the nominal delay plus the error, floored at 0).
+ *
+ * Impact points are Earth-fixed with GMST = 0 at t = 0 of the state's time
+ * origin, on a spherical Earth. Footprint offsets are east / north of the
+ * undispersed entry's impact point in its tangent plane. Trials run in
+ * blocks on a thread pool, each with its own RNG stream (seed + trial).
+ * Block statistics merge in block order, so the footprint does not depend
+ * on the thread count.
+ */
+
+#ifndef SIM_REENTRY_DISPERSION_HPP
+#define SIM_REENTRY_DISPERSION_HPP
+
+#include "entities/command_module.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace sim {
+
+class ThreadPool;
+
+struct ReentryDispersionConfig {
+    // Dispersions (1-sigma)
+    double flight_path_sigma = 0.0;      // [rad] at the interface
+    double speed_sigma = 0.0;            // [m/s] at the interface
+    double density_sigma = 0.0;          // Fractional density scale
+    double lift_to_drag_sigma = 0.0;     // About the vehicle's CL / Cd
+    double bank_angle = 0.0;             // [rad] lift from the local vertical
+    double drogue_delay = 0.0;           // [s] trigger to open
+    double drogue_delay_sigma = 0.0;
+    double main_delay = 0.0;             // [s]
+    double main_delay_sigma = 0.0;
+
+    double dt = 0.5;                     // RK4 step [s]
+    double max_flight_time = 3600.0;     // [s] from the interface
+    int block = 64;                      // Trials per parallel task
+    uint64_t seed = 1;
+    int num_threads = 0;                 // 0 = hardware concurrency, 1 = serial
+};
+
+enum class ReentryOutcome {
+    SPLASHDOWN,
+    SKIP_OUT,                            // Climbed back above the interface
+    TIMEOUT                              // Still flying at max_flight_time
+};
+
+struct ReentryTrialResult {
+    ReentryOutcome outcome = ReentryOutcome::TIMEOUT;
+    double flight_time = 0.0;            // [s] interface to splashdown
+    double latitude = 0.0;               // [rad] geocentric, at splashdown
+    double longitude = 0.0;              // [rad] Earth-fixed
+    double east = 0.0;                   // [m] from the nominal impact
+    double north = 0.0;                  // [m]
+    double impact_speed = 0.0;           // [m/s]
+    double peak_g = 0.0;                 // [g] aerodynamic
+    double peak_heat_flux = 0.0;         // [W/m^2]
+    double heat_load = 0.0;              // [J/m^2]
+    double drogue_time = -1.0;           // [s] from the interface; -1 = never
+    double main_time = -1.0;
+};
+
+/**
+ * Streaming statistics of a batch: the impact ellipse and flight time over
+ * the splashdowns, loads and heating over every trial
+ */
+struct ReentryFootprint {
+    int trials = 0;
+    int splashdowns = 0;
+    int skip_outs = 0;
+    int timeouts = 0;
+
+    double mean_east = 0.0;              // [m] from the nominal impact
+    double mean_north = 0.0;
+    double cov_ee = 0.0;                 // [m^2]
+    double cov_en = 0.0;
+    double cov_nn = 0.0;
+    double semi_major = 0.0;             // [m] 1-sigma ellipse axes
+    double semi_minor = 0.0;
+    double orientation = 0.0;            // [rad] major axis from north, toward east
+
+    double mean_flight_time = 0.0;       // [s]
+    double mean_peak_g = 0.0;
+    double max_peak_g = 0.0;
+    double mean_peak_heat_flux = 0.0;    // [W/m^2]
+    double max_peak_heat_flux = 0.0;
+    double mean_heat_load = 0.0;         // [J/m^2]
+};
+
+class ReentryDispersion {
+public:
+    static constexpr double ENTRY_ALTITUDE = 120000.0;   // [m] entry interface
+
+    /// Receives each trial's result, concurrently from the worker threads
+    using TrialCallback = std::function<void(int trial, const ReentryTrialResult&)>;
+
+    /**
+     * @param vehicle Mass, aerodynamic and parachute properties (pre-entry)
+     * @param state Nominal Earth-centred inertial state, outside the
+     *        atmosphere or already inside it
+     * @throws std::invalid_argument if the orbit does not reach the interface
+     */
+    ReentryDispersion(const CommandModule& vehicle, const StateVector& state,
+                      const ReentryDispersionConfig& config = ReentryDispersionConfig());
+    ~ReentryDispersion();
+
+    /// Nominal state at the interface, and its time
+    const StateVector& entry_state() const { return entry_; }
+
+    /// The undispersed entry
+    const ReentryTrialResult& nominal() const { return nominal_; }
+
+    /// One dispersed trial
+    ReentryTrialResult run_trial(int trial) const;
+
+    /// Trials 0..trials-1 in parallel, reduced to a footprint
+    ReentryFootprint run(int trials, const TrialCallback& on_trial = nullptr) const;
+
+private:
+    struct Vehicle {
+        double dry_mass;                 // Everything but the ablating shield [kg]
+        double shield_mass;              // [kg] at the interface
+        double Cd, area, nose_radius, lift_to_drag;
+        double drogue_Cd, drogue_area, drogue_alt, drogue_mach;
+        double main_Cd, main_area, main_alt;
+    };
+
+    /// Perturbations of one trial
+    struct Dispersion {
+        double flight_path = 0.0;
+        double speed = 0.0;
+        double density_scale = 1.0;
+        double lift_to_drag = 0.0;
+        double drogue_delay = 0.0;
+        double main_delay = 0.0;
+    };
+
+    Vehicle vehicle_;
+    ReentryDispersionConfig config_;
+    StateVector entry_;
+    ReentryTrialResult nominal_;
+    Vec3 impact_up_, impact_east_, impact_north_;   // Nominal impact frame (Earth-fixed)
+    std::shared_ptr<ThreadPool> pool_;              // Null when serial
+
+    ReentryTrialResult fly(const Dispersion& d) const;
+};
+
+inline const char* reentry_outcome_to_string(ReentryOutcome outcome) {
+    switch (outcome) {
+        case ReentryOutcome::SPLASHDOWN: return "Splashdown";
+        case ReentryOutcome::SKIP_OUT:   return "Skip-out";
+        case ReentryOutcome::TIMEOUT:    return "Timeout";
+        default:                         return "Unknown";
+    }
+}
+
+}  // namespace sim
+
+#endif  // SIM_REENTRY_DISPERSION_HPP
@@ -1,10 +1,12 @@
 #include "entities/satellite.hpp"
 #include "propagators/rk4_integrator.hpp"
 #include "physics/gravity_model.hpp"
+#include "physics/kepler_solver.hpp"
 #include "physics/orbital_perturbations.hpp"
 #include "coordinate/time_utils.hpp"
 #include <cmath>
 #include <iostream>
+#include <limits>
 
 namespace sim {
 
@@ -35,13 +37,8 @@ void Satellite::initialize_from_tle() {
     double M = tle_.mean_anomaly * DEG_TO_RAD;
     double e = tle_.eccentricity;
     
-    // Solve Kepler's equation for eccentric anomaly (Newton-Raphson)
-    double E = M;  // Initial guess
-    for (int iter = 0; iter < 10; iter++) {
-        double E_new = E - (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
-        if (std::abs(E_new - E) < 1e-10) break;
-        E = E_new;
-    }
+    // Solve Kepler's equation for eccentric anomaly
+    double E = kepler::eccentric_anomaly(M, e);
     
     // True anomaly
     double nu = 2.0 * std::atan2(std::sqrt(1.0 + e) * std::sin(E/2.0), 
@@ -91,9 +88,41 @@ void Satellite::initialize_from_tle() {
 }
 
 void Satellite::update(double dt) {
+    if (use_sgp4_) {
+        // Closed form at the new time, no integration error to accumulate;
+        // a decayed or invalid element set holds its last state
+        double t = state_.time + dt;
+        Vec3 pos, vel;
+        if (SGP4Propagator::propagate(sgp4_, t / 60.0, pos, vel) == SGP4Error::NONE) {
+            state_.position = pos;
+            state_.velocity = vel;
+            state_.frame = CoordinateFrame::TEME;
+        }
+        state_.time = t;
+        return;
+    }
     propagate_rk4(dt);
 }
 
+double Satellite::warp_horizon() const {
+    return std::numeric_limits<double>::infinity();
+}
+
+void Satellite::coast(double dt) {
+    if (use_sgp4_) {
+        update(dt);
+        return;
+    }
+    constexpr double MAX_COAST_STEP = 10.0;  // [s]
+    int steps = static_cast<int>(std::ceil(dt / MAX_COAST_STEP));
+    for (int k = 0; k < steps; ++k) propagate_rk4(dt / steps);
+}
+
+void Satellite::set_use_sgp4(bool use_sgp4) {
+    use_sgp4_ = use_sgp4;
+    if (use_sgp4_) sgp4_ = SGP4Propagator::initialize(tle_);
+}
+
 void Satellite::set_perturbation_config(const PerturbationConfig& config) {
     perturbation_config_ = config;
     use_perturbations_ = true;
@@ -4,6 +4,7 @@
 #include "entities/entity.hpp"
 #include "io/tle_parser.hpp"
 #include "physics/orbital_perturbations.hpp"
+#include "propagators/sgp4_propagator.hpp"
 
 namespace sim {
 
@@ -19,6 +20,10 @@ public:
     
     // Update state (propagate orbit)
     virtual void update(double dt) override;
+
+    // No discrete events: SGP4 jumps in closed form, RK4 in coarse steps
+    double warp_horizon() const override;
+    void coast(double dt) override;
     
     // Get TLE data
     const TLE& get_tle() const { return tle_; }
@@ -38,11 +43,18 @@ public:
     const PerturbationConfig& get_perturbation_config() const { return perturbation_config_; }
     bool has_perturbation_config() const { return use_perturbations_; }
 
+    // Analytic SGP4/SDP4 from the TLE instead of RK4 (state time = seconds
+    // from TLE epoch, TEME); overrides the integrated models when enabled
+    void set_use_sgp4(bool use_sgp4);
+    bool get_use_sgp4() const { return use_sgp4_; }
+
 private:
     TLE tle_;
     bool use_j2_;
     bool use_perturbations_ = false;
     PerturbationConfig perturbation_config_;
+    bool use_sgp4_ = false;
+    SGP4Record sgp4_;
 
     // Propagate using RK4 integrator with gravity model
     void propagate_rk4(double dt);
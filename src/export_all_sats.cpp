@@ -3,13 +3,19 @@
 #include <vector>
 #include <cmath>
 #include <iomanip>
+#include <algorithm>
+#include <unordered_map>
 
 #include "core/state_vector.hpp"
 #include "physics/orbital_elements.hpp"
 #include "physics/gravity_model.hpp"
+#include "propagators/catalog_propagator.hpp"
 #include "io/tle_parser.hpp"
+#include "io/catalog_snapshot.hpp"
+#include "io/async_output.hpp"
 #include "coordinate/time_utils.hpp"
 #include "coordinate/frame_transformer.hpp"
+#include "utils/thread_pool.hpp"
 
 using namespace sim;
 
@@ -29,26 +35,73 @@ OrbitalElements tle_to_elements(const TLE& tle) {
 
     double M = tle.mean_anomaly * DEG_TO_RAD;
     double e = tle.eccentricity;
-    double E = M;
-    for (int i = 0; i < 10; i++) {
-        E = M + e * std::sin(E);
-    }
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
+    double nu = OrbitalMechanics::mean_to_true_anomaly(M, e);
     elem.true_anomaly = nu;
     return elem;
 }
 
+// Run fn(i) for i in [0, count) on the pool, in blocks
+template <typename Fn>
+void for_each_block(ThreadPool& pool, size_t count, Fn&& fn) {
+    constexpr size_t BLOCK = 256;
+    pool.parallel_for((count + BLOCK - 1) / BLOCK, [&](size_t b) {
+        size_t end = std::min(count, (b + 1) * BLOCK);
+        for (size_t i = b * BLOCK; i < end; i++) fn(i);
+    });
+}
+
+void print_usage() {
+    std::cout << "Usage: export_all_sats [tle_file] [propagate_seconds] [options]\n"
+              << "  --threads N        Worker threads (0 = all cores, default)\n"
+              << "  --track STEPS DT   Also tabulate ECEF positions at STEPS samples DT s apart\n"
+              << "  --snapshot FILE    Binary snapshot (default all_sats.bin); its rows are\n"
+              << "                     reused for satellites whose TLE did not change\n"
+              << "  --full             Recompute every satellite\n";
+}
+
+// Usage: export_all_sats [tle_file] [propagate_seconds] [options]
 int main(int argc, char* argv[]) {
     std::string tle_file = "data/tles/satcat.txt";
-    if (argc > 1) {
-        tle_file = argv[1];
+    // Optional: advance the whole catalog (two-body + J2/J3/J4) first
+    double propagate_s = 0.0;
+    int num_threads = 0;
+    uint32_t track_steps = 0;
+    double track_step_s = 0.0;
+    std::string snapshot_file = "all_sats.bin";
+    bool full = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_next = i + 1 < argc;
+        if (arg == "--threads" && has_next) {
+            num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--track" && i + 2 < argc) {
+            track_steps = static_cast<uint32_t>(std::stoul(argv[++i]));
+            track_step_s = std::stod(argv[++i]);
+        } else if (arg == "--snapshot" && has_next) {
+            snapshot_file = argv[++i];
+        } else if (arg == "--full") {
+            full = true;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if (positional == 0) {
+            tle_file = arg;
+            positional++;
+        } else if (positional == 1) {
+            propagate_s = std::stod(arg);
+            positional++;
+        } else {
+            print_usage();
+            return 1;
+        }
     }
 
     std::cout << "Loading TLEs from: " << tle_file << std::endl;
-    std::vector<TLE> tles = TLEParser::parse_file(tle_file);
+    TLEParseOptions parse_options;
+    parse_options.num_threads = num_threads;
+    std::vector<TLE> tles = TLEParser::parse_file(tle_file, parse_options);
 
     if (tles.empty()) {
         std::cerr << "Failed to load TLEs" << std::endl;
@@ -59,47 +112,128 @@ int main(int argc, char* argv[]) {
     double mu = GravityModel::EARTH_MU;
     double jd = TimeUtils::J2000_EPOCH_JD; // Use J2000 as reference epoch
 
-    std::ofstream json("all_sats.json");
-    json << std::fixed << std::setprecision(6);
-    json << "{\n";
-    json << "  \"count\": " << tles.size() << ",\n";
-    json << "  \"satellites\": [\n";
+    const size_t n = tles.size();
+    CatalogSnapshot snap;
+    snap.epoch_jd = jd;
+    snap.propagate_s = std::max(propagate_s, 0.0);
+    snap.track_steps = track_steps;
+    snap.track_step_s = track_steps > 0 ? track_step_s : 0.0;
+    snap.resize(n);
+
+    // Rows of the previous snapshot whose TLE is unchanged are reused;
+    // everything else is recomputed
+    CatalogSnapshot previous;
+    std::unordered_map<int32_t, size_t> previous_index;
+    if (!full && previous.load(snapshot_file) && previous.matches(snap)) {
+        previous_index.reserve(previous.size());
+        for (size_t j = 0; j < previous.size(); j++) previous_index[previous.norad[j]] = j;
+    }
 
-    for (size_t i = 0; i < tles.size(); i++) {
-        const auto& tle = tles[i];
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t h = CatalogSnapshot::hash(tles[i]);
+        auto it = previous_index.find(tles[i].satellite_number);
+        if (it != previous_index.end() && previous.tle_hash[it->second] == h) {
+            snap.copy_row(i, previous, it->second);
+        } else {
+            snap.names[i] = tles[i].name;
+            snap.norad[i] = tles[i].satellite_number;
+            snap.tle_hash[i] = h;
+            changed.push_back(i);
+        }
+    }
+    std::cout << "Recomputing " << changed.size() << " satellites ("
+              << (n - changed.size()) << " unchanged)" << std::endl;
+
+    ThreadPool pool(num_threads);
+    const size_t m = changed.size();
+
+    // Convert TLEs to state vectors into one batched catalog
+    std::vector<StateVector> states(m);
+    for_each_block(pool, m, [&](size_t k) {
+        size_t i = changed[k];
+        OrbitalElements elem = tle_to_elements(tles[i]);
+        const double e[snap::NUM_ELEMENTS] = {
+            elem.semi_major_axis, elem.eccentricity, elem.inclination,
+            elem.raan, elem.arg_periapsis, elem.true_anomaly
+        };
+        for (int c = 0; c < snap::NUM_ELEMENTS; c++) snap.elements[c * n + i] = static_cast<float>(e[c]);
+        states[k] = OrbitalMechanics::elements_to_state(elem, mu);
+    });
+
+    CatalogConfig config;
+    config.num_threads = num_threads;
+    CatalogPropagator catalog(config);
+    catalog.reserve(m);
+    for (const auto& state : states) catalog.add(state);
+    if (propagate_s > 0.0) {
+        std::cout << "Propagating catalog " << propagate_s << " s" << std::endl;
+        catalog.propagate(propagate_s);
+        jd += propagate_s / 86400.0;
+    }
 
-        // Convert TLE to state vector
-        OrbitalElements elem = tle_to_elements(tle);
-        StateVector state = OrbitalMechanics::elements_to_state(elem, mu);
+    for_each_block(pool, m, [&](size_t k) {
+        size_t i = changed[k];
 
         // Convert to geodetic
-        GeodeticCoord geo = FrameTransformer::eci_to_geodetic(state.position, jd);
+        Vec3 position(catalog.x()[k], catalog.y()[k], catalog.z()[k]);
+        GeodeticCoord geo = FrameTransformer::eci_to_geodetic(position, jd);
+        snap.lat[i] = geo.latitude;
+        snap.lon[i] = geo.longitude;
+        snap.alt[i] = geo.altitude;
 
         // Altitude in km for classification
         double alt_km = geo.altitude / 1000.0;
-        std::string orbit_type = "LEO";
-        if (alt_km > 35000) orbit_type = "GEO";
-        else if (alt_km > 2000) orbit_type = "MEO";
-
-        json << "    {\"name\": \"" << tle.name << "\""
-             << ", \"norad\": " << tle.satellite_number
-             << ", \"lat\": " << geo.latitude
-             << ", \"lon\": " << geo.longitude
-             << ", \"alt\": " << geo.altitude
-             << ", \"type\": \"" << orbit_type << "\""
+        snap.orbit_type[i] = snap::LEO;
+        if (alt_km > 35000) snap.orbit_type[i] = snap::GEO;
+        else if (alt_km > 2000) snap.orbit_type[i] = snap::MEO;
+    });
+
+    // Time-tabulated ECEF positions, so the viewer need not propagate
+    for (uint32_t s = 0; s < track_steps; s++) {
+        if (s > 0) catalog.propagate(track_step_s);
+        double step_jd = jd + s * track_step_s / 86400.0;
+        float* out = snap.track.data() + static_cast<size_t>(s) * n * 3;
+        for_each_block(pool, m, [&](size_t k) {
+            size_t i = changed[k];
+            Vec3 ecef = FrameTransformer::eci_to_ecef(
+                Vec3(catalog.x()[k], catalog.y()[k], catalog.z()[k]), step_jd);
+            out[i * 3 + 0] = static_cast<float>(ecef.x);
+            out[i * 3 + 1] = static_cast<float>(ecef.y);
+            out[i * 3 + 2] = static_cast<float>(ecef.z);
+        });
+    }
+
+    AsyncOFStream json("all_sats.json");
+    json << std::fixed << std::setprecision(6);
+    json << "{\n";
+    json << "  \"count\": " << n << ",\n";
+    json << "  \"satellites\": [\n";
+
+    static const char* const ORBIT_TYPES[] = {"LEO", "MEO", "GEO"};
+    for (size_t i = 0; i < n; i++) {
+        json << "    {\"name\": \"" << snap.names[i] << "\""
+             << ", \"norad\": " << snap.norad[i]
+             << ", \"lat\": " << snap.lat[i]
+             << ", \"lon\": " << snap.lon[i]
+             << ", \"alt\": " << snap.alt[i]
+             << ", \"type\": \"" << ORBIT_TYPES[snap.orbit_type[i]] << "\""
              << "}";
-        if (i < tles.size() - 1) json << ",";
+        if (i < n - 1) json << ",";
         json << "\n";
-
-        if ((i + 1) % 100 == 0) {
-            std::cout << "Processed " << (i + 1) << " / " << tles.size() << std::endl;
-        }
     }
 
     json << "  ]\n";
     json << "}\n";
     json.close();
-
     std::cout << "Exported to: all_sats.json" << std::endl;
+
+    if (!snap.save(snapshot_file)) {
+        std::cerr << "Failed to write " << snapshot_file << std::endl;
+        return 1;
+    }
+    std::cout << "Exported to: " << snapshot_file;
+    if (track_steps > 0) std::cout << " (" << track_steps << " track samples)";
+    std::cout << std::endl;
     return 0;
 }
@@ -0,0 +1,314 @@
+/**
+ * Constellation Search Implementation
+ */
+
+#include "constellation_search.hpp"
+#include "fom_ephemeris.hpp"
+#include "gps_pdop.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+
+namespace sim {
+namespace fom {
+
+namespace {
+
+constexpr double PDOP_CLAMP = 10.0;   // MEAN_PDOP clamp (GPSPDOP metadata max_value)
+
+bool is_revisit(SearchObjective o) {
+    return o == SearchObjective::MEAN_REVISIT_GAP || o == SearchObjective::MAX_REVISIT_GAP ||
+           o == SearchObjective::MEAN_RESPONSE_TIME || o == SearchObjective::UNCOVERED_FRACTION;
+}
+
+bool is_pdop(SearchObjective o) {
+    return o == SearchObjective::MEAN_PDOP || o == SearchObjective::PDOP_OUTAGE;
+}
+
+// Access intervals of one satellite, flattened by cell
+struct CellIntervals {
+    std::vector<uint32_t> offsets;   // Cell c spans [offsets[c], offsets[c + 1])
+    std::vector<AccessInterval> intervals;
+};
+
+bool dominates(const std::vector<double>& a, const std::vector<double>& b) {
+    bool better = false;
+    for (size_t k = 0; k < a.size(); k++) {
+        if (a[k] > b[k]) return false;
+        if (a[k] < b[k]) better = true;
+    }
+    return better;
+}
+
+} // namespace
+
+std::vector<OrbitalElements> WalkerDesign::elements() const {
+    std::vector<OrbitalElements> sats;
+    if (!valid()) return sats;
+
+    const int per_plane = total_satellites / planes;
+    for (int p = 0; p < planes; p++) {
+        for (int k = 0; k < per_plane; k++) {
+            OrbitalElements e;
+            e.semi_major_axis = (EARTH_RADIUS_KM + altitude_km) * 1000.0;
+            e.eccentricity = 0.0;
+            e.inclination = inclination_deg * DEG_TO_RAD;
+            e.raan = 2.0 * PI * p / planes;
+            e.arg_periapsis = 0.0;
+            e.mean_anomaly = std::fmod(2.0 * PI * k / per_plane +
+                                       2.0 * PI * phasing * p / total_satellites, 2.0 * PI);
+            e.true_anomaly = e.mean_anomaly;
+            sats.push_back(e);
+        }
+    }
+    return sats;
+}
+
+std::vector<SensorSatellite> WalkerDesign::sensor_satellites() const {
+    SensorConfig sensor(sensor_half_angle_deg);
+    sensor.compute_footprint(altitude_km);
+
+    std::vector<SensorSatellite> sats;
+    for (const auto& e : elements()) sats.emplace_back(e, sensor);
+    return sats;
+}
+
+std::vector<WalkerDesign> WalkerDesignSpace::enumerate() const {
+    std::vector<WalkerDesign> designs;
+    for (int t : total_satellites)
+    for (int p : planes) {
+        std::vector<int> fs = phasings;
+        if (fs.empty()) {
+            for (int f = 0; f < p; f++) fs.push_back(f);
+        }
+        for (int f : fs)
+        for (double alt : altitudes_km)
+        for (double inc : inclinations_deg)
+        for (double half : sensor_half_angles_deg) {
+            WalkerDesign d;
+            d.total_satellites = t;
+            d.planes = p;
+            d.phasing = f;
+            d.altitude_km = alt;
+            d.inclination_deg = inc;
+            d.sensor_half_angle_deg = half;
+            if (d.valid()) designs.push_back(d);
+        }
+    }
+    return designs;
+}
+
+ConstellationSearch::ConstellationSearch(const SearchConfig& config)
+    : config_(config)
+{
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+void ConstellationSearch::parallel(size_t count, const std::function<void(size_t)>& fn) {
+    if (pool_ && count > 1) {
+        pool_->parallel_for(count, fn);
+    } else {
+        for (size_t i = 0; i < count; i++) fn(i);
+    }
+}
+
+std::vector<std::vector<double>> ConstellationSearch::evaluate(
+    const std::vector<WalkerDesign>& all_designs, const FOMGrid& grid) {
+
+    const auto& objectives = config_.objectives;
+    bool need_revisit = std::any_of(objectives.begin(), objectives.end(), is_revisit);
+    bool need_pdop = std::any_of(objectives.begin(), objectives.end(), is_pdop);
+
+    std::vector<WalkerDesign> designs;
+    for (const auto& d : all_designs) {
+        if (d.valid()) designs.push_back(d);
+    }
+
+    // Distinct satellites; the footprint only matters to the revisit objectives
+    using Key = std::array<double, 7>;
+    std::map<Key, size_t> known;
+    std::vector<SensorSatellite> distinct;
+    std::vector<std::vector<size_t>> members(designs.size());
+    last_satellites_ = 0;
+
+    for (size_t d = 0; d < designs.size(); d++) {
+        for (const auto& sat : designs[d].sensor_satellites()) {
+            const OrbitalElements& e = sat.elements;
+            Key key = {e.semi_major_axis, e.eccentricity, e.inclination, e.raan,
+                       e.arg_periapsis, e.mean_anomaly,
+                       need_revisit ? sat.sensor.footprint_radius_km : 0.0};
+            auto it = known.find(key);
+            if (it == known.end()) {
+                it = known.emplace(key, distinct.size()).first;
+                distinct.push_back(sat);
+            }
+            members[d].push_back(it->second);
+            last_satellites_++;
+        }
+    }
+    last_distinct_ = distinct.size();
+
+    const size_t num_cells = grid.size();
+
+    // Per-satellite access intervals
+    std::vector<CellIntervals> access(need_revisit ? distinct.size() : 0);
+    parallel(access.size(), [&](size_t s) {
+        SensorRevisit single(grid, {distinct[s]});
+        auto per_cell = single.compute_access_intervals(
+            config_.start_time, config_.end_time, config_.max_step, config_.max_arc_deg);
+
+        CellIntervals& out = access[s];
+        out.offsets.resize(num_cells + 1);
+        out.offsets[0] = 0;
+        for (size_t c = 0; c < num_cells; c++) {
+            out.intervals.insert(out.intervals.end(), per_cell[c].begin(), per_cell[c].end());
+            out.offsets[c + 1] = static_cast<uint32_t>(out.intervals.size());
+        }
+    });
+
+    // Per-orbit positions at the PDOP samples
+    std::vector<double> times;
+    std::vector<std::vector<Vec3>> positions;
+    if (need_pdop) {
+        std::vector<OrbitalElements> orbits;
+        for (const auto& sat : distinct) orbits.push_back(sat.elements);
+        ConstellationEphemeris ephemeris(orbits);
+        for (double t = config_.start_time; t <= config_.end_time; t += config_.pdop_step) {
+            times.push_back(t);
+            positions.push_back(ephemeris.positions(t));
+        }
+    }
+
+    std::vector<std::vector<double>> values(designs.size());
+    parallel(designs.size(), [&](size_t d) {
+        const std::vector<size_t>& sats = members[d];
+
+        double gap_sum = 0, max_gap = 0, response_sum = 0, coverage_sum = 0;
+        if (need_revisit) {
+            std::vector<AccessInterval> merged;
+            for (size_t c = 0; c < num_cells; c++) {
+                merged.clear();
+                for (size_t s : sats) {
+                    const CellIntervals& a = access[s];
+                    merged.insert(merged.end(), a.intervals.begin() + a.offsets[c],
+                                  a.intervals.begin() + a.offsets[c + 1]);
+                }
+                std::sort(merged.begin(), merged.end(),
+                          [](const AccessInterval& x, const AccessInterval& y) { return x.start < y.start; });
+                RevisitStatistics st = SensorRevisit::revisit_statistics(
+                    merged, config_.start_time, config_.end_time);
+                gap_sum += st.mean_gap;
+                max_gap = std::max(max_gap, st.max_gap);
+                response_sum += st.mean_response_time;
+                coverage_sum += st.coverage_fraction;
+            }
+        }
+
+        double pdop_sum = 0;
+        size_t outages = 0;
+        if (need_pdop) {
+            std::vector<GPSSatellite> gps;
+            for (size_t s : sats) gps.emplace_back(distinct[s].elements);
+            GPSPDOP pdop(grid, gps, config_.min_elevation_deg, 1);
+
+            std::vector<Vec3> ecef(sats.size());
+            std::vector<double> cell_pdop(num_cells);
+            for (size_t k = 0; k < times.size(); k++) {
+                for (size_t i = 0; i < sats.size(); i++) ecef[i] = positions[k][sats[i]];
+                pdop.compute_cells(times[k], ecef, 0, num_cells, cell_pdop.data());
+                for (double v : cell_pdop) {
+                    pdop_sum += std::min(v, PDOP_CLAMP);
+                    if (v > config_.pdop_threshold) outages++;
+                }
+            }
+        }
+
+        const double cells = num_cells > 0 ? static_cast<double>(num_cells) : 1.0;
+        const double samples = std::max<size_t>(1, times.size() * num_cells);
+        for (SearchObjective o : objectives) {
+            double v = 0;
+            switch (o) {
+                case SearchObjective::MEAN_REVISIT_GAP:   v = gap_sum / cells; break;
+                case SearchObjective::MAX_REVISIT_GAP:    v = max_gap; break;
+                case SearchObjective::MEAN_RESPONSE_TIME: v = response_sum / cells; break;
+                case SearchObjective::UNCOVERED_FRACTION: v = 1.0 - coverage_sum / cells; break;
+                case SearchObjective::MEAN_PDOP:          v = pdop_sum / samples; break;
+                case SearchObjective::PDOP_OUTAGE:        v = outages / samples; break;
+                case SearchObjective::SATELLITE_COUNT:    v = designs[d].total_satellites; break;
+            }
+            values[d].push_back(v);
+        }
+    });
+
+    return values;
+}
+
+std::vector<int> ConstellationSearch::pareto_ranks(const std::vector<std::vector<double>>& values) {
+    const size_t n = values.size();
+    std::vector<int> rank(n, -1);
+    size_t ranked = 0;
+
+    // Peel off successive non-dominated fronts
+    for (int front = 0; ranked < n; front++) {
+        std::vector<size_t> members;
+        for (size_t i = 0; i < n; i++) {
+            if (rank[i] >= 0) continue;
+            bool dominated = false;
+            for (size_t j = 0; j < n && !dominated; j++) {
+                dominated = j != i && rank[j] < 0 && dominates(values[j], values[i]);
+            }
+            if (!dominated) members.push_back(i);
+        }
+        for (size_t i : members) rank[i] = front;
+        ranked += members.size();
+    }
+    return rank;
+}
+
+std::vector<DesignEvaluation> ConstellationSearch::run(const std::vector<WalkerDesign>& designs) {
+    std::vector<DesignEvaluation> evaluations;
+    std::vector<WalkerDesign> valid;
+    for (const auto& d : designs) {
+        if (!d.valid()) continue;
+        DesignEvaluation e;
+        e.design = d;
+        evaluations.push_back(e);
+        valid.push_back(d);
+    }
+
+    // Screening
+    FOMGrid coarse = FOMGrid::create_global(config_.coarse_grid_km);
+    auto coarse_values = evaluate(valid, coarse);
+    auto coarse_ranks = pareto_ranks(coarse_values);
+
+    std::vector<size_t> refine;
+    std::vector<WalkerDesign> refine_designs;
+    for (size_t i = 0; i < evaluations.size(); i++) {
+        evaluations[i].coarse = coarse_values[i];
+        evaluations[i].coarse_rank = coarse_ranks[i];
+        if (coarse_ranks[i] < config_.refine_fronts) {
+            refine.push_back(i);
+            refine_designs.push_back(valid[i]);
+        }
+    }
+
+    // Refinement of the leading fronts
+    FOMGrid fine = FOMGrid::create_global(config_.fine_grid_km);
+    auto fine_values = evaluate(refine_designs, fine);
+    auto fine_ranks = pareto_ranks(fine_values);
+    for (size_t k = 0; k < refine.size(); k++) {
+        DesignEvaluation& e = evaluations[refine[k]];
+        e.fine = fine_values[k];
+        e.refined = true;
+        e.pareto = fine_ranks[k] == 0;
+    }
+
+    return evaluations;
+}
+
+} // namespace fom
+} // namespace sim
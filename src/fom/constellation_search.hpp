@@ -0,0 +1,155 @@
+/**
+ * Constellation Search - Design-space exploration over Walker constellations
+ *
+ * Scores every design of a Walker delta design space (T/P/F, altitude,
+ * inclination, sensor half-angle) on a set of objectives from the FOM
+ * calculators, all minimized:
+ *
+ *   1. Screening: every design on a coarse global grid, designs in
+ *      parallel, then non-dominated sorting of the coarse scores.
+ *   2. Refinement: the designs of the first refine_fronts coarse ranks
+ *      again on the full-resolution grid, and the Pareto front of those
+ *      full-resolution scores.
+ *
+ * Within a pass the work is shared between designs: the revisit
+ * objectives come from per-satellite access intervals
+ * (SensorRevisit::compute_access_intervals), computed once for every
+ * distinct (orbit, footprint) and merged per design, and the PDOP
+ * objectives from positions propagated once per distinct orbit. Designs
+ * that share orbital planes - the first plane of every design with the
+ * same T/P, altitude and inclination, or designs differing only in the
+ * phasing of other planes' slots - evaluate those satellites once.
+ *
+ * The interval cache holds every distinct satellite of a pass at once, so
+ * for large spaces keep the coarse grid coarse.
+ */
+
+#pragma once
+
+#include "fom_grid.hpp"
+#include "sensor_revisit.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+namespace fom {
+
+/**
+ * Walker delta constellation T/P/F: T satellites in P equally spaced
+ * planes, neighbouring planes' slots offset by F * 360 / T degrees
+ */
+struct WalkerDesign {
+    int total_satellites = 24;       // T
+    int planes = 6;                  // P
+    int phasing = 1;                 // F, 0 .. P-1
+    double altitude_km = 800.0;      // Circular orbit altitude
+    double inclination_deg = 55.0;
+    double sensor_half_angle_deg = 30.0;
+
+    bool valid() const {
+        return total_satellites > 0 && planes > 0 && total_satellites % planes == 0 &&
+               phasing >= 0 && phasing < planes && altitude_km > 0;
+    }
+
+    /** Elements of every satellite, plane by plane (RAAN of plane 0 = 0) */
+    std::vector<OrbitalElements> elements() const;
+
+    /** Satellites with the sensor footprint for the altitude */
+    std::vector<SensorSatellite> sensor_satellites() const;
+};
+
+/**
+ * Cartesian design space; empty phasings means every F in 0 .. P-1
+ */
+struct WalkerDesignSpace {
+    std::vector<int> total_satellites = {24};
+    std::vector<int> planes = {6};
+    std::vector<int> phasings;
+    std::vector<double> altitudes_km = {800.0};
+    std::vector<double> inclinations_deg = {55.0};
+    std::vector<double> sensor_half_angles_deg = {30.0};
+
+    /** Every valid combination */
+    std::vector<WalkerDesign> enumerate() const;
+};
+
+enum class SearchObjective {
+    MEAN_REVISIT_GAP,       // Cell-averaged mean gap between accesses [s]
+    MAX_REVISIT_GAP,        // Longest gap over all cells [s]
+    MEAN_RESPONSE_TIME,     // Cell-averaged mean response time [s]
+    UNCOVERED_FRACTION,     // 1 - cell-averaged coverage fraction
+    MEAN_PDOP,              // PDOP averaged over cells and samples, clamped to 10
+    PDOP_OUTAGE,            // Fraction of samples with PDOP above pdop_threshold
+    SATELLITE_COUNT         // T (cost)
+};
+
+struct SearchConfig {
+    double start_time = 0.0;
+    double end_time = 86400.0;
+    double coarse_grid_km = 500.0;     // Screening grid
+    double fine_grid_km = 100.0;       // Full-resolution grid
+    int refine_fronts = 1;             // Coarse non-dominated ranks refined
+
+    std::vector<SearchObjective> objectives = {
+        SearchObjective::MEAN_REVISIT_GAP, SearchObjective::SATELLITE_COUNT};
+
+    // Revisit objectives (access interval sampling)
+    double max_step = 10.0;            // [s]
+    double max_arc_deg = 0.5;
+
+    // PDOP objectives
+    double pdop_step = 600.0;          // Sample spacing [s]
+    double min_elevation_deg = 5.0;
+    double pdop_threshold = 6.0;
+
+    int num_threads = 0;               // 0 = hardware concurrency, 1 = serial
+};
+
+struct DesignEvaluation {
+    WalkerDesign design;
+    std::vector<double> coarse;        // Objective values on the coarse grid
+    std::vector<double> fine;          // On the full grid (refined designs only)
+    int coarse_rank = 0;               // Non-dominated rank on the coarse grid (0 = front)
+    bool refined = false;
+    bool pareto = false;               // On the full-resolution front
+};
+
+class ConstellationSearch {
+public:
+    explicit ConstellationSearch(const SearchConfig& config = SearchConfig());
+
+    /**
+     * Screen and refine designs (invalid ones are dropped)
+     * @return One evaluation per valid design, in input order
+     */
+    std::vector<DesignEvaluation> run(const std::vector<WalkerDesign>& designs);
+    std::vector<DesignEvaluation> run(const WalkerDesignSpace& space) { return run(space.enumerate()); }
+
+    /** Objective values of valid designs on one grid, in config order */
+    std::vector<std::vector<double>> evaluate(const std::vector<WalkerDesign>& designs,
+                                              const FOMGrid& grid);
+
+    /** Non-dominated rank of each point (0 = Pareto front), all objectives minimized */
+    static std::vector<int> pareto_ranks(const std::vector<std::vector<double>>& values);
+
+    const SearchConfig& config() const { return config_; }
+
+    // Sharing in the last evaluate(): satellites over all designs, and distinct ones evaluated
+    size_t last_satellites() const { return last_satellites_; }
+    size_t last_distinct_satellites() const { return last_distinct_; }
+
+private:
+    SearchConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+    size_t last_satellites_ = 0;
+    size_t last_distinct_ = 0;
+
+    void parallel(size_t count, const std::function<void(size_t)>& fn);
+};
+
+} // namespace fom
+} // namespace sim
@@ -12,6 +12,8 @@
 #pragma once
 
 #include "fom_grid.hpp"
+#include "physics/orbital_elements.hpp"
+#include "utils/memory_accounting.hpp"
 #include <vector>
 #include <string>
 #include <memory>
@@ -23,9 +25,12 @@ namespace fom {
 /**
  * A single frame of FOM data at a specific time
  */
+/** Cell values; storage is charged to MemoryTag::FOM_FRAMES. */
+using FOMValues = std::vector<double, TrackedAllocator<double, MemoryTag::FOM_FRAMES>>;
+
 struct FOMFrame {
     double time;                    // Simulation time (seconds)
-    std::vector<double> values;     // FOM value for each grid cell
+    FOMValues values;               // FOM value for each grid cell
 
     FOMFrame() : time(0) {}
     FOMFrame(double t, size_t num_cells) : time(t), values(num_cells, 0.0) {}
@@ -91,6 +96,44 @@ struct FOMResult {
     }
 };
 
+/**
+ * Consumer of FOM frames as a series is computed
+ *
+ * compute_series() calls begin() once, consume() for every output frame
+ * in time order, then end(). A frame is only valid during its consume()
+ * call, so sinks that keep summaries instead of frames run in memory
+ * independent of the series length.
+ */
+class FOMSink {
+public:
+    virtual ~FOMSink() = default;
+
+    virtual void begin(const FOMGrid& grid, const FOMMetadata& metadata) {
+        (void)grid;
+        (void)metadata;
+    }
+    virtual void consume(const FOMFrame& frame) = 0;
+    virtual void end() {}
+};
+
+/**
+ * Sink that keeps every frame in a FOMResult (the non-streaming path)
+ */
+class FOMFrameCollector : public FOMSink {
+public:
+    explicit FOMFrameCollector(FOMResult& result) : result_(result) {}
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        result_.grid = grid;
+        result_.metadata = metadata;
+        result_.frames.clear();
+    }
+    void consume(const FOMFrame& frame) override { result_.frames.push_back(frame); }
+
+private:
+    FOMResult& result_;
+};
+
 /**
  * Abstract base class for Figure of Merit calculators
  */
@@ -117,18 +160,30 @@ public:
      * @param time_step Time step in seconds
      * @return Complete FOM result with all frames
      */
-    virtual FOMResult compute_series(double start_time, double end_time, double time_step) {
+    FOMResult compute_series(double start_time, double end_time, double time_step) {
         FOMResult result;
-        result.metadata = get_metadata();
-        result.grid = get_grid();
+        FOMFrameCollector collector(result);
+        compute_series(start_time, end_time, time_step, collector);
+        return result;
+    }
 
+    /**
+     * Compute the FOM for a time series, handing each frame to a sink as
+     * it is produced instead of storing the series
+     */
+    virtual void compute_series(double start_time, double end_time, double time_step,
+                                FOMSink& sink) {
+        sink.begin(get_grid(), get_metadata());
+
+        FOMFrame frame;
         for (double t = start_time; t <= end_time; t += time_step) {
-            FOMFrame frame(t, result.grid.size());
-            frame.values = compute(t);
-            result.frames.push_back(std::move(frame));
+            frame.time = t;
+            const std::vector<double> values = compute(t);
+            frame.values.assign(values.begin(), values.end());
+            sink.consume(frame);
         }
 
-        return result;
+        sink.end();
     }
 
     /**
@@ -136,6 +191,47 @@ public:
      */
     virtual const FOMGrid& get_grid() const = 0;
 
+    // Shared-state evaluation, used by FOMPipeline. A FOM opts in by
+    // listing its satellites; the pipeline then propagates them (once per
+    // step for all registered FOMs, see fom_ephemeris.hpp) and passes their
+    // ECEF positions [m] in this order.
+
+    /** Satellites taken from the shared state buffer (empty = compute() only) */
+    virtual std::vector<OrbitalElements> shared_state_satellites() const { return {}; }
+
+    /** Clear accumulated state before a series */
+    virtual void reset() {}
+
+    /** Every pipeline step, serially: fold this step into accumulated state */
+    virtual void advance(double time, const std::vector<Vec3>& ecef) {
+        (void)time;
+        (void)ecef;
+    }
+
+    /**
+     * Values of cells [begin, end) into out[begin .. end). Called
+     * concurrently for disjoint ranges, after advance() for the same step.
+     */
+    virtual void compute_cells(double time, const std::vector<Vec3>& ecef,
+                               size_t begin, size_t end, double* out) const {
+        (void)time;
+        (void)ecef;
+        (void)begin;
+        (void)end;
+        (void)out;
+    }
+
+    /**
+     * True when compute_frame() runs on an accelerator: the pipeline then
+     * hands it the whole grid as one task instead of cell ranges
+     */
+    virtual bool offloaded() const { return false; }
+
+    /** Values of every cell (shared-state evaluation), after advance() */
+    virtual void compute_frame(double time, const std::vector<Vec3>& ecef, double* out) const {
+        compute_cells(time, ecef, 0, get_grid().size(), out);
+    }
+
 protected:
     FOMGrid grid_;
 };
@@ -7,6 +7,13 @@
  * - GPSPDOP: GPS Position Dilution of Precision
  * - SensorRevisit: Sensor revisit time tracking
  * - FOMExporter: JSON export utilities
+ * - FOMPipeline: several FOMs stepped together over one propagated
+ *   constellation, streaming to their sinks
+ * - ConstellationSearch: Walker design-space screening and Pareto refinement
+ * - FOMBinaryWriter / export_binary: quantized, chunked binary export
+ *   (decoded in the viewers by js/fom_binary.js)
+ * - FOMSink: streaming frame consumers (FOMCellStats, FOMThresholdTime,
+ *   FOMJsonWriter) for series too long to hold in memory
  *
  * Example usage:
  *
@@ -21,6 +28,12 @@
  *
  *   // Export to JSON
  *   FOMExporter::export_json(result, "output.json");
+ *
+ *   // Or stream: write frames and keep per-cell stats without storing them
+ *   FOMJsonWriter writer("output.json");
+ *   FOMCellStats stats;
+ *   FOMSinkGroup sinks{&writer, &stats};
+ *   revisit.compute_series(0, 86400, 60.0, sinks);
  */
 
 #pragma once
@@ -29,4 +42,8 @@
 #include "figure_of_merit.hpp"
 #include "gps_pdop.hpp"
 #include "sensor_revisit.hpp"
+#include "fom_pipeline.hpp"
+#include "constellation_search.hpp"
+#include "fom_sinks.hpp"
 #include "fom_export.hpp"
+#include "fom_binary.hpp"
@@ -0,0 +1,288 @@
+/**
+ * FOM Binary - Compact quantized FOM export
+ *
+ * A binary alternative to FOMExporter::export_json for long series and fine
+ * grids, laid out so a browser can fetch the grid once and decode frames
+ * progressively into typed arrays (js/fom_binary.js). All fields are
+ * little-endian.
+ *
+ *   Header
+ *     char[4]  "FOMB"
+ *     u32      version (1)
+ *     u32      num_cells
+ *     u32      bits (8 or 16)
+ *     u32      flags (1 = fixed range, 2 = delta coding)
+ *     u32      frames_per_chunk
+ *     f64      invalid_value, min_value, max_value, grid_size_km
+ *     u32      metadata_len, then metadata_len bytes of JSON (name, unit,
+ *              lower_is_better, smart_grid and any extra metadata),
+ *              zero-padded to 4 bytes
+ *     f32      lat[num_cells], lon[num_cells]
+ *
+ *   Chunks (frames_per_chunk frames each, the last may be short)
+ *     char[4]  "CHNK"
+ *     u32      frame_count
+ *     u32      payload bytes (frames that follow)
+ *     u32      reserved
+ *     per frame:
+ *       f64    time
+ *       f32    lo, hi           Quantization range of this frame
+ *       u32    length           Payload bytes, before the 4-byte padding
+ *       u8     encoding         0 raw, 1 delta, 2 RLE raw, 3 RLE delta
+ *       u8[3]  reserved
+ *       payload, zero-padded to 4 bytes
+ *
+ *   Index (footer)
+ *     per chunk: u64 offset, u32 bytes, u32 first_frame, u32 frame_count,
+ *                u32 reserved
+ *     u32      num_frames, num_chunks
+ *     u64      index offset
+ *     char[4]  "FOMI"
+ *
+ * Values are quantized to codes 0 .. 2^bits - 2 over [lo, hi]; code
+ * 2^bits - 1 marks invalid_value. Without the fixed-range flag each frame
+ * uses the range of its own valid values; with it every frame uses
+ * [min_value, max_value] (values outside are clamped), which delta coding
+ * requires. Delta frames store code - previous code (mod 2^bits); the first
+ * frame of a chunk is never a delta, so chunks decode independently. RLE
+ * payloads are (count, code) word pairs with count >= 1, and a frame is
+ * only RLE-coded when that is smaller.
+ */
+
+#pragma once
+
+#include "figure_of_merit.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace sim {
+namespace fom {
+
+struct FOMBinaryOptions {
+    int bits = 16;                // 8 or 16
+    bool fixed_range = false;     // Quantize over the metadata range
+    bool delta = false;           // Delta frames (implies fixed_range)
+    bool rle = true;              // Run-length code frames where it is smaller
+    uint32_t frames_per_chunk = 16;
+};
+
+/**
+ * Streaming binary FOM writer
+ */
+class FOMBinaryWriter : public FOMSink {
+public:
+    explicit FOMBinaryWriter(const std::string& filename,
+                             const FOMBinaryOptions& options = FOMBinaryOptions(),
+                             const std::string& extra_metadata = "")
+        : filename_(filename), options_(options), extra_metadata_(extra_metadata) {
+        options_.bits = options_.bits <= 8 ? 8 : 16;
+        if (options_.delta) options_.fixed_range = true;
+        if (options_.frames_per_chunk == 0) options_.frames_per_chunk = 1;
+    }
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        out_.open(filename_, std::ios::binary);
+        metadata_ = metadata;
+        num_cells_ = grid.size();
+        frames_ = 0;
+        index_.clear();
+        chunk_.clear();
+        chunk_frames_ = 0;
+
+        uint32_t flags = (options_.fixed_range ? 1u : 0u) | (options_.delta ? 2u : 0u);
+        out_.write("FOMB", 4);
+        put_u32(1);
+        put_u32(static_cast<uint32_t>(num_cells_));
+        put_u32(static_cast<uint32_t>(options_.bits));
+        put_u32(flags);
+        put_u32(options_.frames_per_chunk);
+        put_f64(metadata.invalid_value);
+        put_f64(metadata.min_value);
+        put_f64(metadata.max_value);
+        put_f64(grid.grid_size_km());
+
+        std::ostringstream meta;
+        meta << "{\"name\": \"" << metadata.name << "\", \"unit\": \"" << metadata.unit
+             << "\", \"lower_is_better\": " << (metadata.lower_is_better ? "true" : "false")
+             << ", \"smart_grid\": " << (grid.is_smart_grid() ? "true" : "false");
+        if (!extra_metadata_.empty()) meta << ",\n" << extra_metadata_;
+        meta << "}";
+        std::string json = meta.str();
+        put_u32(static_cast<uint32_t>(json.size()));
+        out_.write(json.data(), json.size());
+        pad(out_, json.size());
+
+        std::vector<float> column(num_cells_);
+        for (size_t i = 0; i < num_cells_; i++) column[i] = static_cast<float>(grid.cells()[i].lat);
+        out_.write(reinterpret_cast<const char*>(column.data()), num_cells_ * sizeof(float));
+        for (size_t i = 0; i < num_cells_; i++) column[i] = static_cast<float>(grid.cells()[i].lon);
+        out_.write(reinterpret_cast<const char*>(column.data()), num_cells_ * sizeof(float));
+
+        codes_.assign(num_cells_, 0);
+        prev_codes_.assign(num_cells_, 0);
+    }
+
+    void consume(const FOMFrame& frame) override {
+        const uint32_t invalid_code = (1u << options_.bits) - 1;
+        const double levels = invalid_code - 1;
+
+        // Quantization range
+        double lo = metadata_.min_value, hi = metadata_.max_value;
+        if (!options_.fixed_range) {
+            lo = INFINITY;
+            hi = -INFINITY;
+            for (double v : frame.values) {
+                if (v == metadata_.invalid_value) continue;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+            if (lo > hi) lo = hi = 0.0;
+        }
+        const double scale = hi > lo ? levels / (hi - lo) : 0.0;
+
+        for (size_t i = 0; i < num_cells_; i++) {
+            double v = i < frame.values.size() ? frame.values[i] : metadata_.invalid_value;
+            if (v == metadata_.invalid_value) {
+                codes_[i] = invalid_code;
+            } else {
+                double q = std::round((v - lo) * scale);
+                codes_[i] = static_cast<uint32_t>(std::max(0.0, std::min(q, levels)));
+            }
+        }
+
+        // Delta against the previous frame of this chunk
+        bool delta = options_.delta && chunk_frames_ > 0;
+        words_.resize(num_cells_);
+        for (size_t i = 0; i < num_cells_; i++) {
+            words_[i] = delta ? (codes_[i] - prev_codes_[i]) & invalid_code : codes_[i];
+        }
+        prev_codes_.swap(codes_);
+
+        // Run-length pairs, kept only when smaller
+        uint8_t encoding = delta ? 1 : 0;
+        const std::vector<uint32_t>* payload = &words_;
+        if (options_.rle) {
+            rle_.clear();
+            for (size_t i = 0; i < num_cells_ && rle_.size() < num_cells_;) {
+                size_t j = i + 1;
+                while (j < num_cells_ && words_[j] == words_[i] && j - i < invalid_code) j++;
+                rle_.push_back(static_cast<uint32_t>(j - i));
+                rle_.push_back(words_[i]);
+                i = j;
+            }
+            if (rle_.size() < num_cells_) {
+                encoding += 2;
+                payload = &rle_;
+            }
+        }
+
+        size_t bytes = payload->size() * (options_.bits / 8);
+        append(chunk_, frame.time);
+        append(chunk_, static_cast<float>(lo));
+        append(chunk_, static_cast<float>(hi));
+        append(chunk_, static_cast<uint32_t>(bytes));
+        append(chunk_, static_cast<uint32_t>(encoding));
+        for (uint32_t w : *payload) {
+            if (options_.bits == 8) append(chunk_, static_cast<uint8_t>(w));
+            else append(chunk_, static_cast<uint16_t>(w));
+        }
+        chunk_.resize(chunk_.size() + (4 - bytes % 4) % 4, 0);
+
+        frames_++;
+        if (++chunk_frames_ == options_.frames_per_chunk) flush_chunk();
+    }
+
+    void end() override {
+        flush_chunk();
+
+        uint64_t index_offset = static_cast<uint64_t>(out_.tellp());
+        for (const ChunkEntry& c : index_) {
+            put_u64(c.offset);
+            put_u32(c.bytes);
+            put_u32(c.first_frame);
+            put_u32(c.frame_count);
+            put_u32(0);
+        }
+        put_u32(static_cast<uint32_t>(frames_));
+        put_u32(static_cast<uint32_t>(index_.size()));
+        put_u64(index_offset);
+        out_.write("FOMI", 4);
+        out_.close();
+    }
+
+    size_t frames_written() const { return frames_; }
+
+private:
+    struct ChunkEntry {
+        uint64_t offset;
+        uint32_t bytes, first_frame, frame_count;
+    };
+
+    std::string filename_;
+    FOMBinaryOptions options_;
+    std::string extra_metadata_;
+    std::ofstream out_;
+    FOMMetadata metadata_;
+    size_t num_cells_ = 0;
+    size_t frames_ = 0;
+
+    std::vector<uint32_t> codes_, prev_codes_, words_, rle_;
+    std::vector<char> chunk_;          // Frames of the open chunk
+    uint32_t chunk_frames_ = 0;
+    std::vector<ChunkEntry> index_;
+
+    template <typename T>
+    static void append(std::vector<char>& buf, T v) {
+        size_t at = buf.size();
+        buf.resize(at + sizeof(T));
+        std::memcpy(buf.data() + at, &v, sizeof(T));
+    }
+    template <typename T>
+    void put(T v) { out_.write(reinterpret_cast<const char*>(&v), sizeof(T)); }
+    void put_u32(uint32_t v) { put(v); }
+    void put_u64(uint64_t v) { put(v); }
+    void put_f64(double v) { put(v); }
+    static void pad(std::ofstream& out, size_t bytes) {
+        static const char zeros[4] = {0, 0, 0, 0};
+        out.write(zeros, (4 - bytes % 4) % 4);
+    }
+
+    void flush_chunk() {
+        if (chunk_frames_ == 0) return;
+        ChunkEntry entry;
+        entry.offset = static_cast<uint64_t>(out_.tellp());
+        entry.bytes = static_cast<uint32_t>(16 + chunk_.size());
+        entry.first_frame = static_cast<uint32_t>(frames_ - chunk_frames_);
+        entry.frame_count = chunk_frames_;
+        index_.push_back(entry);
+
+        out_.write("CHNK", 4);
+        put_u32(chunk_frames_);
+        put_u32(static_cast<uint32_t>(chunk_.size()));
+        put_u32(0);
+        out_.write(chunk_.data(), chunk_.size());
+
+        chunk_.clear();
+        chunk_frames_ = 0;
+    }
+};
+
+/**
+ * Write a stored FOM result in the binary format
+ */
+inline void export_binary(const FOMResult& result, const std::string& filename,
+                          const FOMBinaryOptions& options = FOMBinaryOptions(),
+                          const std::string& extra_metadata = "") {
+    FOMBinaryWriter writer(filename, options, extra_metadata);
+    writer.begin(result.grid, result.metadata);
+    for (const auto& frame : result.frames) writer.consume(frame);
+    writer.end();
+}
+
+} // namespace fom
+} // namespace sim
@@ -0,0 +1,17 @@
+/**
+ * FOM device - CPU-only build (no GPU backend)
+ */
+
+#include "fom_device.hpp"
+
+namespace sim {
+namespace fom {
+
+std::unique_ptr<PDOPDevice> PDOPDevice::create(const FOMGrid& grid, double min_cos_zenith) {
+    (void)grid;
+    (void)min_cos_zenith;
+    return nullptr;
+}
+
+} // namespace fom
+} // namespace sim
@@ -0,0 +1,123 @@
+/**
+ * FOM device - CUDA backend
+ */
+
+#include "fom_device.hpp"
+#include "pdop_kernel.hpp"
+#include <cuda_runtime.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+namespace fom {
+
+namespace {
+
+void check(cudaError_t err, const char* what) {
+    if (err != cudaSuccess) {
+        throw std::runtime_error(std::string("CUDA ") + what + ": " + cudaGetErrorString(err));
+    }
+}
+
+constexpr int THREADS = 256;
+
+/** One thread per cell; sats is x[0..n) y[0..n) z[0..n) */
+__global__ void pdop_frame(const double* ux, const double* uy, const double* uz, size_t cells,
+                           const double* sats, int num_sats, double min_cos_zenith,
+                           float* out) {
+    const size_t k = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if (k >= cells) return;
+    out[k] = static_cast<float>(pdop_cell(ux[k], uy[k], uz[k], sats, sats + num_sats,
+                                          sats + 2 * num_sats, num_sats, min_cos_zenith));
+}
+
+class CudaPDOPDevice : public PDOPDevice {
+public:
+    explicit CudaPDOPDevice(double min_cos_zenith) : min_cos_zenith_(min_cos_zenith) {}
+
+    /** Allocate and upload the grid (throws; the destructor frees what was allocated) */
+    void init(const FOMGrid& grid) {
+        cells_ = grid.size();
+        check(cudaStreamCreate(&stream_), "stream");
+        const size_t bytes = cells_ * sizeof(double);
+        check(cudaMalloc(&ux_, bytes), "malloc");
+        check(cudaMalloc(&uy_, bytes), "malloc");
+        check(cudaMalloc(&uz_, bytes), "malloc");
+        check(cudaMalloc(&out_, cells_ * sizeof(float)), "malloc");
+        check(cudaMallocHost(&host_out_, cells_ * sizeof(float)), "host malloc");
+        check(cudaMemcpy(ux_, grid.unit_x().data(), bytes, cudaMemcpyHostToDevice), "upload");
+        check(cudaMemcpy(uy_, grid.unit_y().data(), bytes, cudaMemcpyHostToDevice), "upload");
+        check(cudaMemcpy(uz_, grid.unit_z().data(), bytes, cudaMemcpyHostToDevice), "upload");
+    }
+
+    ~CudaPDOPDevice() override {
+        cudaFree(ux_);
+        cudaFree(uy_);
+        cudaFree(uz_);
+        cudaFree(out_);
+        cudaFree(sats_);
+        cudaFreeHost(host_out_);
+        if (stream_) cudaStreamDestroy(stream_);
+    }
+
+    void evaluate(const std::vector<Vec3>& ecef, double* out) override {
+        if (cells_ == 0) return;
+        const int n = static_cast<int>(ecef.size());
+        host_sats_.resize(3 * ecef.size());
+        for (int s = 0; s < n; s++) {
+            host_sats_[s] = ecef[s].x;
+            host_sats_[n + s] = ecef[s].y;
+            host_sats_[2 * n + s] = ecef[s].z;
+        }
+        if (host_sats_.size() > sats_capacity_) {
+            cudaFree(sats_);
+            sats_ = nullptr;
+            check(cudaMalloc(&sats_, host_sats_.size() * sizeof(double)), "malloc");
+            sats_capacity_ = host_sats_.size();
+        }
+        if (n > 0) {
+            check(cudaMemcpyAsync(sats_, host_sats_.data(), host_sats_.size() * sizeof(double),
+                                  cudaMemcpyHostToDevice, stream_), "upload");
+        }
+
+        const unsigned blocks = static_cast<unsigned>((cells_ + THREADS - 1) / THREADS);
+        pdop_frame<<<blocks, THREADS, 0, stream_>>>(ux_, uy_, uz_, cells_, sats_, n,
+                                                     min_cos_zenith_, out_);
+        check(cudaGetLastError(), "launch");
+        check(cudaMemcpyAsync(host_out_, out_, cells_ * sizeof(float), cudaMemcpyDeviceToHost,
+                              stream_), "download");
+        check(cudaStreamSynchronize(stream_), "sync");
+
+        for (size_t k = 0; k < cells_; k++) out[k] = host_out_[k];
+    }
+
+private:
+    size_t cells_ = 0;
+    double min_cos_zenith_;
+    cudaStream_t stream_ = nullptr;
+    double* ux_ = nullptr;
+    double* uy_ = nullptr;
+    double* uz_ = nullptr;
+    double* sats_ = nullptr;
+    size_t sats_capacity_ = 0;
+    float* out_ = nullptr;
+    float* host_out_ = nullptr;
+    std::vector<double> host_sats_;
+};
+
+} // namespace
+
+std::unique_ptr<PDOPDevice> PDOPDevice::create(const FOMGrid& grid, double min_cos_zenith) {
+    try {
+        auto device = std::make_unique<CudaPDOPDevice>(min_cos_zenith);
+        device->init(grid);
+        return device;
+    } catch (const std::exception& e) {
+        std::cerr << "[GPU] PDOP on CPU: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+} // namespace fom
+} // namespace sim
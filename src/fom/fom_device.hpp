@@ -0,0 +1,40 @@
+/**
+ * FOM device - GPU evaluation of grid figures of merit
+ *
+ * A PDOPDevice keeps a grid's up unit vectors resident in device memory
+ * from construction on. Each evaluation uploads only the satellite
+ * positions, runs pdop_cell() (pdop_kernel.hpp) with one thread per cell,
+ * and copies the frame back as 32-bit floats, half the bytes of the
+ * double frame it is widened into. Values therefore agree with the CPU
+ * path to float precision.
+ *
+ * create() returns null when no GPU backend is built (see utils/gpu.hpp)
+ * or the device cannot be set up; callers keep their CPU path for that.
+ */
+
+#pragma once
+
+#include "figure_of_merit.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim {
+namespace fom {
+
+class PDOPDevice {
+public:
+    /**
+     * @param grid           Cells to evaluate (unit vectors are copied to the device)
+     * @param min_cos_zenith sin(minimum elevation)
+     * @return null without a usable GPU
+     */
+    static std::unique_ptr<PDOPDevice> create(const FOMGrid& grid, double min_cos_zenith);
+
+    virtual ~PDOPDevice() = default;
+
+    /** PDOP of every grid cell into out[0 .. grid size) */
+    virtual void evaluate(const std::vector<Vec3>& ecef, double* out) = 0;
+};
+
+} // namespace fom
+} // namespace sim
@@ -0,0 +1,201 @@
+/**
+ * FOM Ephemeris - Satellite positions shared by the FOM calculators
+ *
+ * Keplerian propagation of mean elements to an Earth-fixed position, with
+ * the Earth rotating from a zero angle at t = 0. GPSPDOP, SensorRevisit and
+ * FOMPipeline all place satellites with it, so a constellation propagated
+ * once can feed any of them: kepler_ecef() for single queries and
+ * ConstellationEphemeris for a whole constellation stepped through time.
+ */
+
+#pragma once
+
+#include "fom_grid.hpp"
+#include "physics/gravity_model.hpp"
+#include "physics/kepler_solver.hpp"
+#include "physics/orbital_elements.hpp"
+#include "io/tle_parser.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace sim {
+namespace fom {
+
+constexpr double EARTH_ROTATION_RATE = 7.2921159e-5;  // [rad/s]
+
+/**
+ * TLE mean elements as OrbitalElements (semi-major axis from the mean motion)
+ */
+inline OrbitalElements elements_from_tle(const TLE& tle) {
+    OrbitalElements elements;
+    double n_rad_per_sec = tle.mean_motion * 2.0 * PI / 86400.0;
+    elements.semi_major_axis = std::cbrt(GravityModel::EARTH_MU / (n_rad_per_sec * n_rad_per_sec));
+    elements.eccentricity = tle.eccentricity;
+    elements.inclination = tle.inclination * DEG_TO_RAD;
+    elements.raan = tle.raan * DEG_TO_RAD;
+    elements.arg_periapsis = tle.arg_perigee * DEG_TO_RAD;
+    elements.mean_anomaly = tle.mean_anomaly * DEG_TO_RAD;
+    elements.true_anomaly = elements.mean_anomaly; // Approximate
+    return elements;
+}
+
+/**
+ * Keplerian orbit with its per-satellite constants precomputed: mean
+ * motion, semi-minor axis and the perifocal P and Q axes in ECI, so a
+ * position costs one Kepler solve and no element trigonometry.
+ */
+struct KeplerOrbit {
+    double a = 0, e = 0, b = 0;     // Semi-major / semi-minor axis [m], eccentricity
+    double n = 0, M0 = 0;           // Mean motion [rad/s], mean anomaly at t = 0
+    Vec3 P, Q;                      // Periapsis and in-plane normal directions (ECI)
+
+    static constexpr double TOLERANCE = 1e-12;   // Kepler residual [rad]
+    static constexpr int MAX_ITERATIONS = 16;
+
+    KeplerOrbit() = default;
+    explicit KeplerOrbit(const OrbitalElements& elements)
+        : a(elements.semi_major_axis)
+        , e(elements.eccentricity)
+        , b(elements.semi_major_axis * std::sqrt(1.0 - elements.eccentricity * elements.eccentricity))
+        , n(std::sqrt(GravityModel::EARTH_MU / (a * a * a)))
+        , M0(elements.mean_anomaly)
+    {
+        double cos_O = std::cos(elements.raan), sin_O = std::sin(elements.raan);
+        double cos_i = std::cos(elements.inclination), sin_i = std::sin(elements.inclination);
+        double cos_w = std::cos(elements.arg_periapsis), sin_w = std::sin(elements.arg_periapsis);
+        P = Vec3(cos_O * cos_w - sin_O * sin_w * cos_i,
+                 sin_O * cos_w + cos_O * sin_w * cos_i,
+                 sin_w * sin_i);
+        Q = Vec3(-cos_O * sin_w - sin_O * cos_w * cos_i,
+                 -sin_O * sin_w + cos_O * cos_w * cos_i,
+                 cos_w * sin_i);
+    }
+
+    /** Mean anomaly at t in [0, 2 pi) */
+    double mean_anomaly(double t) const {
+        double M = std::fmod(M0 + n * t, 2.0 * PI);
+        return M < 0 ? M + 2.0 * PI : M;
+    }
+
+    /**
+     * Newton solve of E - e sin E = M from the guess E, leaving sin E and
+     * cos E of the solution in sin_E / cos_E
+     */
+    double eccentric_anomaly(double M, double E, double& sin_E, double& cos_E) const {
+        return kepler::refine_eccentric_anomaly(M, e, E, sin_E, cos_E, TOLERANCE, MAX_ITERATIONS);
+    }
+
+    /** Cold solve of E - e sin E = M, with sin E and cos E */
+    double eccentric_anomaly(double M, double& sin_E, double& cos_E) const {
+        return kepler::eccentric_anomaly(M, e, sin_E, cos_E);
+    }
+
+    /** ECI position [m] from the eccentric anomaly's sine and cosine */
+    Vec3 eci(double sin_E, double cos_E) const {
+        double x = a * (cos_E - e), y = b * sin_E;
+        return Vec3(P.x * x + Q.x * y, P.y * x + Q.y * y, P.z * x + Q.z * y);
+    }
+};
+
+/** ECI to ECEF for the Earth rotation angle with cosine c and sine s */
+inline Vec3 eci_to_ecef(const Vec3& eci, double c, double s) {
+    return Vec3(eci.x * c + eci.y * s, -eci.x * s + eci.y * c, eci.z);
+}
+
+/**
+ * ECEF position [m] of a satellite at time t [s] since its element epoch
+ * (cold-started solve; ConstellationEphemeris for stepped series)
+ */
+inline Vec3 kepler_ecef(const OrbitalElements& elements, double t) {
+    KeplerOrbit orbit(elements);
+    double M = orbit.mean_anomaly(t);
+    double sin_E, cos_E;
+    orbit.eccentric_anomaly(M, sin_E, cos_E);
+    double theta = t * EARTH_ROTATION_RATE;
+    return eci_to_ecef(orbit.eci(sin_E, cos_E), std::cos(theta), std::sin(theta));
+}
+
+/**
+ * Constellation ephemeris for time-stepped FOM evaluation
+ *
+ * Orbits are precomputed once, and each positions() call warm-starts every
+ * satellite's Kepler solve from its previous anomaly: E - M = e sin E is
+ * continuous across the 2 pi wrap of M, so the guess is
+ *   E = M + (E_prev - M_prev) + dM e cos E_prev / (1 - e cos E_prev)
+ * and one Newton step usually meets the tolerance. Jumps of more than
+ * MAX_WARM_STEP in mean anomaly (or the first call) start cold, on
+ * kepler::eccentric_anomaly. The Earth rotation is evaluated once per
+ * call.
+ */
+class ConstellationEphemeris {
+public:
+    static constexpr double MAX_WARM_STEP = 0.5;   // [rad] of mean anomaly
+
+    ConstellationEphemeris() = default;
+    explicit ConstellationEphemeris(const std::vector<OrbitalElements>& elements) {
+        orbits_.reserve(elements.size());
+        for (const auto& e : elements) orbits_.emplace_back(e);
+        reset();
+    }
+
+    size_t size() const { return orbits_.size(); }
+    const KeplerOrbit& orbit(size_t i) const { return orbits_[i]; }
+
+    /** ECEF [m] of every satellite at time t, in construction order */
+    void positions(double t, std::vector<Vec3>& ecef) {
+        ecef.resize(orbits_.size());
+        double theta = t * EARTH_ROTATION_RATE;
+        double c = std::cos(theta), s = std::sin(theta);
+
+        for (size_t i = 0; i < orbits_.size(); i++) {
+            const KeplerOrbit& orbit = orbits_[i];
+            double M = orbit.mean_anomaly(t);
+            double dM = std::remainder(M - last_M_[i], 2.0 * PI);
+            double sin_E, cos_E;
+            if (warm_ && std::fabs(dM) <= MAX_WARM_STEP) {
+                double ec = orbit.e * last_cos_E_[i];
+                double E = M + (last_E_[i] - last_M_[i]) + dM * ec / (1.0 - ec);
+                last_E_[i] = orbit.eccentric_anomaly(M, E, sin_E, cos_E);
+            } else {
+                last_E_[i] = orbit.eccentric_anomaly(M, sin_E, cos_E);
+            }
+            last_M_[i] = M;
+            last_cos_E_[i] = cos_E;
+            ecef[i] = eci_to_ecef(orbit.eci(sin_E, cos_E), c, s);
+        }
+        warm_ = true;
+    }
+
+    std::vector<Vec3> positions(double t) {
+        std::vector<Vec3> ecef;
+        positions(t, ecef);
+        return ecef;
+    }
+
+    /** Forget the previous anomalies (next call starts cold) */
+    void reset() {
+        last_M_.assign(orbits_.size(), 0.0);
+        last_E_.assign(orbits_.size(), 0.0);
+        last_cos_E_.assign(orbits_.size(), 1.0);
+        warm_ = false;
+    }
+
+private:
+    std::vector<KeplerOrbit> orbits_;
+    std::vector<double> last_M_, last_E_, last_cos_E_;
+    bool warm_ = false;
+};
+
+/**
+ * Geocentric sub-point (lat, lon) [deg] of an ECEF position
+ */
+inline std::pair<double, double> subpoint(const Vec3& ecef) {
+    double r_ecef = ecef.norm();
+    double lat = std::asin(ecef.z / r_ecef) * RAD_TO_DEG;
+    double lon = std::atan2(ecef.y, ecef.x) * RAD_TO_DEG;
+    return {lat, lon};
+}
+
+} // namespace fom
+} // namespace sim
@@ -2,11 +2,14 @@
  * FOM Export - JSON export utilities for Figure of Merit data
  *
  * Exports FOM results to JSON format for visualization with Cesium viewers.
+ * The one-shot exporters write through AsyncOFStream, so formatting a
+ * large document overlaps the disk writes.
  */
 
 #pragma once
 
 #include "figure_of_merit.hpp"
+#include "io/async_output.hpp"
 #include <fstream>
 #include <iomanip>
 #include <sstream>
@@ -27,57 +30,16 @@ public:
      */
     static void export_json(const FOMResult& result, const std::string& filename,
                            const std::string& extra_metadata = "") {
-        std::ofstream out(filename);
+        AsyncOFStream out(filename);
         out << std::fixed << std::setprecision(4);
 
-        out << "{\n";
-
-        // Metadata
-        out << "  \"metadata\": {\n";
-        out << "    \"name\": \"" << result.metadata.name << "\",\n";
-        out << "    \"unit\": \"" << result.metadata.unit << "\",\n";
-        out << "    \"min_value\": " << result.metadata.min_value << ",\n";
-        out << "    \"max_value\": " << result.metadata.max_value << ",\n";
-        out << "    \"invalid_value\": " << result.metadata.invalid_value << ",\n";
-        out << "    \"lower_is_better\": " << (result.metadata.lower_is_better ? "true" : "false") << ",\n";
-        out << "    \"num_grid_cells\": " << result.grid.size() << ",\n";
-        out << "    \"num_time_steps\": " << result.frames.size() << ",\n";
-        out << "    \"grid_size_km\": " << result.grid.grid_size_km() << ",\n";
-        out << "    \"smart_grid\": " << (result.grid.is_smart_grid() ? "true" : "false");
-
-        if (!extra_metadata.empty()) {
-            out << ",\n" << extra_metadata;
-        }
-
-        out << "\n  },\n";
-
-        // Grid
-        out << "  \"grid\": [\n";
-        const auto& cells = result.grid.cells();
-        for (size_t i = 0; i < cells.size(); i++) {
-            out << "    {\"lat\": " << cells[i].lat << ", \"lon\": " << cells[i].lon << "}";
-            if (i < cells.size() - 1) out << ",";
-            out << "\n";
-        }
-        out << "  ],\n";
+        write_header(out, result.metadata, result.grid, result.frames.size(), extra_metadata);
 
         // Frames
-        out << "  \"frames\": [\n";
         for (size_t f = 0; f < result.frames.size(); f++) {
-            const auto& frame = result.frames[f];
-            out << "    {\n";
-            out << "      \"t\": " << frame.time << ",\n";
-            out << "      \"values\": [";
-
-            for (size_t i = 0; i < frame.values.size(); i++) {
-                out << std::setprecision(1) << frame.values[i];
-                if (i < frame.values.size() - 1) out << ",";
-            }
-            out << "]\n";
-            out << "    }";
-            if (f < result.frames.size() - 1) out << ",";
-            out << "\n";
+            write_frame(out, result.frames[f], f == 0);
         }
+        out << "\n";
         out << "  ]\n";
 
         out << "}\n";
@@ -91,7 +53,7 @@ public:
                                        const std::vector<std::tuple<double, double, double, double>>& trajectory,
                                        const std::string& filename,
                                        const std::string& extra_metadata = "") {
-        std::ofstream out(filename);
+        AsyncOFStream out(filename);
         out << std::fixed << std::setprecision(4);
 
         out << "{\n";
@@ -155,6 +117,108 @@ public:
         out << "}\n";
         out.close();
     }
+
+    /**
+     * Metadata, grid and the opening of the frames array. num_time_steps
+     * is printed right-aligned in `width` characters (0 = unpadded) so a
+     * streaming writer can patch it in place.
+     */
+    static void write_header(std::ostream& out, const FOMMetadata& metadata, const FOMGrid& grid,
+                             size_t num_time_steps, const std::string& extra_metadata,
+                             std::streampos* steps_pos = nullptr, int width = 0) {
+        out << "{\n";
+
+        // Metadata
+        out << "  \"metadata\": {\n";
+        out << "    \"name\": \"" << metadata.name << "\",\n";
+        out << "    \"unit\": \"" << metadata.unit << "\",\n";
+        out << "    \"min_value\": " << metadata.min_value << ",\n";
+        out << "    \"max_value\": " << metadata.max_value << ",\n";
+        out << "    \"invalid_value\": " << metadata.invalid_value << ",\n";
+        out << "    \"lower_is_better\": " << (metadata.lower_is_better ? "true" : "false") << ",\n";
+        out << "    \"num_grid_cells\": " << grid.size() << ",\n";
+        out << "    \"num_time_steps\": ";
+        if (steps_pos) *steps_pos = out.tellp();
+        out << std::setw(width) << num_time_steps << ",\n";
+        out << "    \"grid_size_km\": " << grid.grid_size_km() << ",\n";
+        out << "    \"smart_grid\": " << (grid.is_smart_grid() ? "true" : "false");
+
+        if (!extra_metadata.empty()) {
+            out << ",\n" << extra_metadata;
+        }
+
+        out << "\n  },\n";
+
+        // Grid
+        out << "  \"grid\": [\n";
+        const auto& cells = grid.cells();
+        for (size_t i = 0; i < cells.size(); i++) {
+            out << "    {\"lat\": " << cells[i].lat << ", \"lon\": " << cells[i].lon << "}";
+            if (i < cells.size() - 1) out << ",";
+            out << "\n";
+        }
+        out << "  ],\n";
+
+        out << "  \"frames\": [\n";
+    }
+
+    /** One element of the frames array (comma-separated from the previous one) */
+    static void write_frame(std::ostream& out, const FOMFrame& frame, bool first) {
+        if (!first) out << ",\n";
+        out << "    {\n";
+        out << "      \"t\": " << frame.time << ",\n";
+        out << "      \"values\": [";
+
+        for (size_t i = 0; i < frame.values.size(); i++) {
+            out << std::setprecision(1) << frame.values[i];
+            if (i < frame.values.size() - 1) out << ",";
+        }
+        out << "]\n";
+        out << "    }";
+    }
+};
+
+/**
+ * Streaming JSON export: writes the same document as
+ * FOMExporter::export_json, one frame at a time as compute_series()
+ * produces it. The frame count in the metadata is patched in at end().
+ */
+class FOMJsonWriter : public FOMSink {
+public:
+    explicit FOMJsonWriter(const std::string& filename, const std::string& extra_metadata = "")
+        : filename_(filename), extra_metadata_(extra_metadata) {}
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        out_.open(filename_);
+        out_ << std::fixed << std::setprecision(4);
+        frames_ = 0;
+        FOMExporter::write_header(out_, metadata, grid, 0, extra_metadata_, &steps_pos_, STEPS_WIDTH);
+    }
+
+    void consume(const FOMFrame& frame) override {
+        FOMExporter::write_frame(out_, frame, frames_ == 0);
+        frames_++;
+    }
+
+    void end() override {
+        out_ << "\n";
+        out_ << "  ]\n";
+        out_ << "}\n";
+        out_.seekp(steps_pos_);
+        out_ << std::setw(STEPS_WIDTH) << frames_;
+        out_.close();
+    }
+
+    size_t frames_written() const { return frames_; }
+
+private:
+    static constexpr int STEPS_WIDTH = 12;
+
+    std::string filename_;
+    std::string extra_metadata_;
+    std::ofstream out_;
+    std::streampos steps_pos_;
+    size_t frames_ = 0;
 };
 
 } // namespace fom
@@ -2,7 +2,9 @@
  * FOM Grid - Spatial grid for Figure of Merit calculations
  *
  * Provides common grid functionality for computing metrics across
- * geographic areas. Supports both full-globe and smart (path-based) grids.
+ * geographic areas. Supports full-globe and smart (path-based) lat/lon
+ * grids, and equal-area hierarchical grids (HEALPix, nested numbering)
+ * that can be refined adaptively where a FOM varies.
  */
 
 #pragma once
@@ -10,7 +12,11 @@
 #include <vector>
 #include <set>
 #include <cmath>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <numeric>
 
 namespace sim {
 namespace fom {
@@ -73,6 +79,7 @@ public:
             }
         }
 
+        grid.build_index();
         return grid;
     }
 
@@ -123,19 +130,213 @@ public:
             grid.cells_.emplace_back(lat, lon, idx++);
         }
 
+        grid.build_index();
         return grid;
     }
 
+    /**
+     * Create an equal-area hierarchical grid: the HEALPix tessellation of
+     * the given order (12 * 4^order cells of identical area), in nested
+     * numbering so cell p at order k has children 4p .. 4p+3 at order k+1.
+     */
+    static FOMGrid create_equal_area(int order) {
+        std::vector<std::pair<int, uint64_t>> pixels;
+        uint64_t n = 12ull << (2 * order);
+        pixels.reserve(n);
+        for (uint64_t p = 0; p < n; p++) pixels.emplace_back(order, p);
+        return from_pixels(pixels);
+    }
+
+    /**
+     * Create an equal-area grid refined where the FOM varies.
+     *
+     * Starts from the order-base_order HEALPix cells and evaluates them.
+     * Then, level by level, every candidate cell's four children are
+     * evaluated; when their values spread by more than threshold (or some
+     * but not all are invalid) the children replace the cell and become
+     * candidates themselves, otherwise the cell is kept whole. Refinement
+     * stops at max_order. Uniform regions cost one extra level of
+     * evaluations and stay coarse. Detail is only found where it shows in
+     * the children's values, so base_order should resolve the narrowest
+     * features expected.
+     *
+     * @param evaluate FOM values for every cell of a grid (e.g. a frame
+     *                 of a FOM built on it, or a max over several times)
+     * @param invalid_value The FOM's no-data value
+     * @param values If non-null, receives the values of the returned cells
+     */
+    static FOMGrid create_adaptive(int base_order, int max_order, double threshold,
+                                   const std::function<std::vector<double>(const FOMGrid&)>& evaluate,
+                                   double invalid_value = -1.0,
+                                   std::vector<double>* values = nullptr) {
+        std::vector<std::pair<int, uint64_t>> final_cells;
+        std::vector<double> final_values;
+
+        FOMGrid level = create_equal_area(base_order);
+        std::vector<std::pair<int, uint64_t>> candidates = level.pixels_;
+        std::vector<double> candidate_values = evaluate(level);
+
+        for (int order = base_order; order < max_order && !candidates.empty(); order++) {
+            std::vector<std::pair<int, uint64_t>> children;
+            children.reserve(candidates.size() * 4);
+            for (const auto& c : candidates) {
+                for (uint64_t k = 0; k < 4; k++) children.emplace_back(order + 1, 4 * c.second + k);
+            }
+            FOMGrid child_grid = from_pixels(children);
+            std::vector<double> child_values = evaluate(child_grid);
+
+            std::vector<std::pair<int, uint64_t>> next;
+            std::vector<double> next_values;
+            for (size_t i = 0; i < candidates.size(); i++) {
+                const double* v = &child_values[4 * i];
+                int invalid = 0;
+                double lo = std::numeric_limits<double>::max();
+                double hi = std::numeric_limits<double>::lowest();
+                for (int k = 0; k < 4; k++) {
+                    if (v[k] == invalid_value) {
+                        invalid++;
+                    } else {
+                        lo = std::min(lo, v[k]);
+                        hi = std::max(hi, v[k]);
+                    }
+                }
+                bool refine = (invalid > 0 && invalid < 4) || (invalid == 0 && hi - lo > threshold);
+                if (refine) {
+                    for (int k = 0; k < 4; k++) {
+                        next.push_back(children[4 * i + k]);
+                        next_values.push_back(v[k]);
+                    }
+                } else {
+                    final_cells.push_back(candidates[i]);
+                    final_values.push_back(candidate_values[i]);
+                }
+            }
+            candidates.swap(next);
+            candidate_values.swap(next_values);
+        }
+        final_cells.insert(final_cells.end(), candidates.begin(), candidates.end());
+        final_values.insert(final_values.end(), candidate_values.begin(), candidate_values.end());
+
+        // Spatially coherent order: nested index at the finest order
+        std::vector<size_t> order(final_cells.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto key = [&](size_t i) {
+            return final_cells[i].second << (2 * (max_order - final_cells[i].first));
+        };
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return key(a) < key(b); });
+
+        std::vector<std::pair<int, uint64_t>> sorted(final_cells.size());
+        if (values) values->resize(final_cells.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            sorted[i] = final_cells[order[i]];
+            if (values) (*values)[i] = final_values[order[i]];
+        }
+        return from_pixels(sorted);
+    }
+
+    /**
+     * Visit every cell whose center is within radius_km (great circle) of
+     * (lat, lon), calling fn(cell_index).
+     *
+     * Only the latitude bands the circle spans are visited, and in each
+     * only the longitude interval it can reach; candidates are confirmed
+     * with a unit-vector dot product against cos(radius / R), which is
+     * the great_circle_distance_km test without the trig.
+     */
+    template <typename Fn>
+    void for_each_cell_within(double lat, double lon, double radius_km, Fn&& fn) const {
+        double theta = radius_km / EARTH_RADIUS_KM;
+        if (theta < 0) return;
+        if (theta >= PI) {
+            for (const auto& cell : cells_) fn(cell.index);
+            return;
+        }
+
+        double phi0 = lat * DEG_TO_RAD;
+        double sin_phi0 = std::sin(phi0), cos_phi0 = std::cos(phi0);
+        double lam0 = lon * DEG_TO_RAD;
+        double cx = cos_phi0 * std::cos(lam0);
+        double cy = cos_phi0 * std::sin(lam0);
+        double cz = sin_phi0;
+        double cos_theta = std::cos(theta);
+        bool covers_pole = lat + theta * RAD_TO_DEG >= 90.0 || lat - theta * RAD_TO_DEG <= -90.0;
+
+        auto visit = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++) {
+                int c = band_cells_[k];
+                if (ux_[c] * cx + uy_[c] * cy + uz_[c] * cz >= cos_theta) fn(c);
+            }
+        };
+
+        // Bands with |lat_band - lat| <= theta (small pad for rounding)
+        double pad = 1e-9;
+        auto first = std::lower_bound(bands_.begin(), bands_.end(),
+                                      lat - theta * RAD_TO_DEG - pad,
+                                      [](const LatBand& b, double v) { return b.lat < v; });
+
+        for (auto band = first; band != bands_.end() && band->lat <= lat + theta * RAD_TO_DEG + pad; ++band) {
+            double cos_phi = band->cos_lat;
+            double dlon_deg = 180.0;
+            if (!covers_pole && cos_phi > 1e-12) {
+                // Longitude half-width of the circle at this latitude
+                double c = (cos_theta - band->sin_lat * sin_phi0) / (cos_phi * cos_phi0);
+                if (c > 1.0 + 1e-12) continue;
+                if (c > -1.0) dlon_deg = std::acos(std::min(1.0, c)) * RAD_TO_DEG + pad;
+            }
+
+            if (dlon_deg >= 180.0) {
+                visit(band->begin, band->end);
+                continue;
+            }
+
+            // Longitude window [lon - dlon, lon + dlon], split at the antimeridian
+            auto lon_range = [&](double lo, double hi) {
+                auto b = band_lons_.begin();
+                size_t i0 = std::lower_bound(b + band->begin, b + band->end, lo) - b;
+                size_t i1 = std::upper_bound(b + i0, b + band->end, hi) - b;
+                visit(i0, i1);
+            };
+            double lo = lon - dlon_deg, hi = lon + dlon_deg;
+            if (lo < -180.0) {
+                lon_range(lo + 360.0, 360.0);
+                lon_range(-180.0, hi);
+            } else if (hi >= 180.0) {
+                lon_range(lo, 360.0);
+                lon_range(-360.0, hi - 360.0);
+            } else {
+                lon_range(lo, hi);
+            }
+        }
+    }
+
     // Accessors
     const std::vector<GridCell>& cells() const { return cells_; }
+
+    // Cell-center unit vectors by cell index: the ECEF direction of the
+    // center and its local up on the spherical Earth
+    const std::vector<double>& unit_x() const { return ux_; }
+    const std::vector<double>& unit_y() const { return uy_; }
+    const std::vector<double>& unit_z() const { return uz_; }
     size_t size() const { return cells_.size(); }
     double grid_size_km() const { return grid_size_km_; }
     bool is_smart_grid() const { return is_smart_grid_; }
 
+    // Equal-area (HEALPix) grids: order and nested index of each cell
+    bool is_equal_area() const { return !pixels_.empty(); }
+    int cell_order(size_t index) const { return pixels_[index].first; }
+    uint64_t cell_pixel(size_t index) const { return pixels_[index].second; }
+
+    /** Angular size of a HEALPix cell of the given order (sqrt of its area) [deg] */
+    static double equal_area_cell_deg(int order) {
+        double nside = static_cast<double>(1ull << order);
+        return std::sqrt(4.0 * PI / (12.0 * nside * nside)) * RAD_TO_DEG;
+    }
+
     // Get cell bounds for visualization
     void get_cell_bounds(const GridCell& cell, double& west, double& east,
                          double& south, double& north) const {
         double lat_step = grid_size_km_ / 111.0;
+        if (is_equal_area()) lat_step = equal_area_cell_deg(cell_order(cell.index));
         double lon_step = lat_step / std::max(0.1, std::cos(cell.lat * DEG_TO_RAD));
         lon_step = std::min(lon_step, 30.0);
 
@@ -149,6 +350,122 @@ private:
     std::vector<GridCell> cells_;
     double grid_size_km_ = 50.0;
     bool is_smart_grid_ = false;
+
+    std::vector<std::pair<int, uint64_t>> pixels_;   // (order, nested index); equal-area only
+
+    /** Grid of HEALPix cells, one per (order, nested index) */
+    static FOMGrid from_pixels(const std::vector<std::pair<int, uint64_t>>& pixels) {
+        FOMGrid grid;
+        grid.is_smart_grid_ = false;
+        grid.pixels_ = pixels;
+
+        int finest = 0;
+        int idx = 0;
+        for (const auto& p : pixels) {
+            double lat, lon;
+            healpix_center(p.first, p.second, lat, lon);
+            grid.cells_.emplace_back(lat, lon, idx++);
+            finest = std::max(finest, p.first);
+        }
+        grid.grid_size_km_ = equal_area_cell_deg(finest) * DEG_TO_RAD * EARTH_RADIUS_KM;
+
+        grid.build_index();
+        return grid;
+    }
+
+    /** Center of a nested-scheme HEALPix pixel (Gorski et al., 2005) [deg] */
+    static void healpix_center(int order, uint64_t pix, double& lat, double& lon) {
+        static const int jrll[12] = {2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4};
+        static const int jpll[12] = {1, 3, 5, 7, 0, 2, 4, 6, 1, 3, 5, 7};
+
+        const int64_t nside = int64_t(1) << order;
+        const int64_t npface = nside * nside;
+        const int64_t face = static_cast<int64_t>(pix) / npface;
+        const uint64_t ipf = pix % static_cast<uint64_t>(npface);
+
+        // De-interleave the in-face index into (ix, iy)
+        auto compress = [](uint64_t v) {
+            uint64_t r = 0;
+            for (int b = 0; b < 32; b++) r |= ((v >> (2 * b)) & 1ull) << b;
+            return static_cast<int64_t>(r);
+        };
+        const int64_t ix = compress(ipf);
+        const int64_t iy = compress(ipf >> 1);
+
+        const int64_t jr = jrll[face] * nside - ix - iy - 1;
+        const int64_t nl4 = 4 * nside;
+        const double fact2 = 4.0 / (12.0 * nside * nside);
+
+        int64_t nr, kshift;
+        double z;
+        if (jr < nside) {                    // North polar cap
+            nr = jr;
+            z = 1.0 - nr * nr * fact2;
+            kshift = 0;
+        } else if (jr > 3 * nside) {          // South polar cap
+            nr = nl4 - jr;
+            z = nr * nr * fact2 - 1.0;
+            kshift = 0;
+        } else {                              // Equatorial belt
+            nr = nside;
+            z = (2 * nside - jr) * (2.0 / (3.0 * nside));
+            kshift = (jr - nside) & 1;
+        }
+
+        int64_t jp = (jpll[face] * nr + ix - iy + 1 + kshift) / 2;
+        if (jp > nl4) jp -= nl4;
+        if (jp < 1) jp += nl4;
+        double phi = (jp - (kshift + 1) * 0.5) * (0.5 * PI / nr);
+
+        lat = std::asin(std::max(-1.0, std::min(1.0, z))) * RAD_TO_DEG;
+        lon = phi * RAD_TO_DEG;
+        if (lon >= 180.0) lon -= 360.0;
+    }
+
+    // Spatial index: cells grouped by latitude, each group sorted by longitude
+    struct LatBand {
+        double lat;
+        double sin_lat, cos_lat;
+        size_t begin, end;         // Range in band_cells_ / band_lons_
+    };
+    std::vector<LatBand> bands_;           // By latitude
+    std::vector<int> band_cells_;          // Cell indices, band by band
+    std::vector<double> band_lons_;        // Their longitudes
+    std::vector<double> ux_, uy_, uz_;     // Unit vector of each cell center
+
+    void build_index() {
+        size_t n = cells_.size();
+        ux_.resize(n);
+        uy_.resize(n);
+        uz_.resize(n);
+        for (const auto& cell : cells_) {
+            double phi = cell.lat * DEG_TO_RAD, lam = cell.lon * DEG_TO_RAD;
+            ux_[cell.index] = std::cos(phi) * std::cos(lam);
+            uy_[cell.index] = std::cos(phi) * std::sin(lam);
+            uz_[cell.index] = std::sin(phi);
+        }
+
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (cells_[a].lat != cells_[b].lat) return cells_[a].lat < cells_[b].lat;
+            return cells_[a].lon < cells_[b].lon;
+        });
+
+        bands_.clear();
+        band_cells_.resize(n);
+        band_lons_.resize(n);
+        for (size_t k = 0; k < n; k++) {
+            const GridCell& cell = cells_[order[k]];
+            band_cells_[k] = cell.index;
+            band_lons_[k] = cell.lon;
+            if (bands_.empty() || bands_.back().lat != cell.lat) {
+                double phi = cell.lat * DEG_TO_RAD;
+                bands_.push_back({cell.lat, std::sin(phi), std::cos(phi), k, k});
+            }
+            bands_.back().end = k + 1;
+        }
+    }
 };
 
 } // namespace fom
@@ -0,0 +1,130 @@
+/**
+ * FOM Pipeline Implementation
+ */
+
+#include "fom_pipeline.hpp"
+#include "fom_ephemeris.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <map>
+
+namespace sim {
+namespace fom {
+
+FOMPipeline::FOMPipeline(const FOMPipelineConfig& config)
+    : config_(config)
+{
+    if (config_.cells_per_task == 0) config_.cells_per_task = 1;
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads, config_.placement);
+    }
+}
+
+void FOMPipeline::add(FigureOfMerit& fom, FOMSink& sink) {
+    Entry entry;
+    entry.fom = &fom;
+    entry.sink = &sink;
+
+    std::vector<OrbitalElements> sats = fom.shared_state_satellites();
+    entry.shared = !sats.empty();
+
+    // Identical element sets share one propagation
+    using Key = std::array<double, 6>;
+    std::map<Key, size_t> known;
+    auto key = [](const OrbitalElements& e) {
+        return Key{e.semi_major_axis, e.eccentricity, e.inclination,
+                   e.raan, e.arg_periapsis, e.mean_anomaly};
+    };
+    for (size_t i = 0; i < constellation_.size(); i++) known.emplace(key(constellation_[i]), i);
+
+    for (const auto& e : sats) {
+        auto it = known.find(key(e));
+        if (it == known.end()) {
+            it = known.emplace(key(e), constellation_.size()).first;
+            constellation_.push_back(e);
+        }
+        entry.satellites.push_back(it->second);
+    }
+    entry.ecef.resize(sats.size());
+
+    entries_.push_back(std::move(entry));
+}
+
+void FOMPipeline::run(double start_time, double end_time, double step, double output_step) {
+    if (output_step <= 0.0) output_step = step;
+
+    auto parallel = [&](size_t count, const std::function<void(size_t)>& fn) {
+        if (pool_ && count > 1) {
+            pool_->parallel_for(count, fn);
+        } else {
+            for (size_t i = 0; i < count; i++) fn(i);
+        }
+    };
+
+    for (auto& e : entries_) {
+        e.fom->reset();
+        e.sink->begin(e.fom->get_grid(), e.fom->get_metadata());
+    }
+
+    // Output-step work items: (entry, first cell); non-shared and offloaded
+    // FOMs are one item each
+    struct Task { size_t entry, begin, end; };
+    std::vector<Task> tasks;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        size_t cells = entries_[i].fom->get_grid().size();
+        if (entries_[i].shared) entries_[i].frame.values.assign(cells, 0.0);
+        if (!entries_[i].shared || entries_[i].fom->offloaded()) {
+            tasks.push_back({i, 0, cells});
+            continue;
+        }
+        for (size_t b = 0; b < cells; b += config_.cells_per_task) {
+            tasks.push_back({i, b, std::min(b + config_.cells_per_task, cells)});
+        }
+    }
+
+    ConstellationEphemeris ephemeris(constellation_);
+    std::vector<Vec3> state;
+    double next_output = start_time;
+
+    for (double t = start_time; t <= end_time; t += step) {
+        // 1. Shared constellation state
+        ephemeris.positions(t, state);
+
+        // 2. Accumulated FOM state
+        parallel(entries_.size(), [&](size_t i) {
+            Entry& e = entries_[i];
+            if (!e.shared) return;
+            for (size_t k = 0; k < e.satellites.size(); k++) e.ecef[k] = state[e.satellites[k]];
+            e.fom->advance(t, e.ecef);
+        });
+
+        if (t < next_output - step / 2) continue;
+        next_output += output_step;
+
+        // 3. Frames, all FOMs' grid partitions in one pass
+        parallel(tasks.size(), [&](size_t k) {
+            const Task& task = tasks[k];
+            Entry& e = entries_[task.entry];
+            if (e.shared && e.fom->offloaded()) {
+                e.fom->compute_frame(t, e.ecef, e.frame.values.data());
+            } else if (e.shared) {
+                e.fom->compute_cells(t, e.ecef, task.begin, task.end, e.frame.values.data());
+            } else {
+                const std::vector<double> values = e.fom->compute(t);
+                e.frame.values.assign(values.begin(), values.end());
+            }
+        });
+
+        // 4. Sinks
+        for (auto& e : entries_) {
+            e.frame.time = t;
+            e.sink->consume(e.frame);
+        }
+    }
+
+    for (auto& e : entries_) e.sink->end();
+}
+
+} // namespace fom
+} // namespace sim
@@ -0,0 +1,73 @@
+/**
+ * FOM Pipeline - Several figures of merit over one shared constellation state
+ *
+ * Registered FOMs that support shared-state evaluation (GPSPDOP,
+ * SensorRevisit) list their satellites; the pipeline merges identical
+ * element sets into one constellation and, every step:
+ *
+ *   1. propagates each distinct satellite once (ConstellationEphemeris),
+ *   2. hands every FOM its satellites' ECEF positions to advance() its
+ *      accumulated state (FOMs in parallel),
+ *   3. at output steps, evaluates all FOMs together with the cell ranges
+ *      of every FOM split into tasks on one thread pool (a FOM offloaded
+ *      to a GPU is one task for its whole grid), and
+ *   4. streams each FOM's frame to its sink, in registration order.
+ *
+ * FOMs without shared-state support are computed with compute() at output
+ * steps, one task each.
+ *
+ * Stateful FOMs see every step, so with step = 1 s and output_step = 60 s
+ * a SensorRevisit produces the same frames as its own compute_series(..., 60).
+ */
+
+#pragma once
+
+#include "figure_of_merit.hpp"
+#include "utils/thread_pool.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim {
+namespace fom {
+
+struct FOMPipelineConfig {
+    int num_threads = 0;            // 0 = hardware concurrency, 1 = serial
+    ThreadPlacement placement;      // NUMA grouping / CPU pinning of the pool
+    size_t cells_per_task = 4096;   // Grid partition size at output steps
+};
+
+class FOMPipeline {
+public:
+    explicit FOMPipeline(const FOMPipelineConfig& config = FOMPipelineConfig());
+
+    /** Register a FOM and the sink its frames go to (both must outlive run()) */
+    void add(FigureOfMerit& fom, FOMSink& sink);
+
+    /**
+     * Run every registered FOM over [start_time, end_time]
+     * @param step State step [s]
+     * @param output_step Frame spacing [s] (0 = every step)
+     */
+    void run(double start_time, double end_time, double step, double output_step = 0.0);
+
+    /** Distinct satellites propagated per step */
+    size_t num_shared_satellites() const { return constellation_.size(); }
+
+private:
+    struct Entry {
+        FigureOfMerit* fom;
+        FOMSink* sink;
+        bool shared;                   // Uses the shared state buffer
+        std::vector<size_t> satellites;   // Indices into constellation_
+        std::vector<Vec3> ecef;        // This FOM's satellites at the current step
+        FOMFrame frame;
+    };
+
+    FOMPipelineConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+    std::vector<Entry> entries_;
+    std::vector<OrbitalElements> constellation_;
+};
+
+} // namespace fom
+} // namespace sim
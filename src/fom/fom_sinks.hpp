@@ -0,0 +1,201 @@
+/**
+ * FOM Sinks - Streaming consumers for FOM time series
+ *
+ * Summaries that are updated frame by frame as compute_series() runs, so
+ * a long series at fine resolution never has to be held in memory:
+ * - FOMCellStats: per-cell min / mean / max and optional percentiles
+ * - FOMThresholdTime: per-cell time spent above (or below) a threshold
+ * - FOMSinkGroup: fans frames out to several sinks in one pass
+ *
+ * FOMJsonWriter (fom_export.hpp) is the streaming counterpart of
+ * FOMExporter::export_json.
+ */
+
+#pragma once
+
+#include "figure_of_merit.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+namespace sim {
+namespace fom {
+
+/**
+ * Running per-cell statistics over the valid (non-invalid_value) samples
+ *
+ * Percentiles are optional: with histogram_bins > 0 every cell keeps a
+ * histogram over [metadata.min_value, metadata.max_value] (values outside
+ * land in the end bins), and percentile() interpolates within a bin, so
+ * its resolution is the bin width.
+ */
+class FOMCellStats : public FOMSink {
+public:
+    explicit FOMCellStats(size_t histogram_bins = 0) : bins_(histogram_bins) {}
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        size_t n = grid.size();
+        invalid_ = metadata.invalid_value;
+        lo_ = metadata.min_value;
+        hi_ = metadata.max_value;
+        frames_ = 0;
+        count_.assign(n, 0);
+        sum_.assign(n, 0.0);
+        min_.assign(n, std::numeric_limits<double>::max());
+        max_.assign(n, std::numeric_limits<double>::lowest());
+        histogram_.assign(bins_ > 0 ? n * bins_ : 0, 0);
+    }
+
+    void consume(const FOMFrame& frame) override {
+        frames_++;
+        const double bin_scale = hi_ > lo_ ? bins_ / (hi_ - lo_) : 0.0;
+        for (size_t i = 0; i < frame.values.size(); i++) {
+            double v = frame.values[i];
+            if (v == invalid_) continue;
+            count_[i]++;
+            sum_[i] += v;
+            min_[i] = std::min(min_[i], v);
+            max_[i] = std::max(max_[i], v);
+            if (bins_ > 0) {
+                double b = std::max(0.0, std::min((v - lo_) * bin_scale, bins_ - 1.0));
+                histogram_[i * bins_ + static_cast<size_t>(b)]++;
+            }
+        }
+    }
+
+    size_t num_frames() const { return frames_; }
+    size_t size() const { return count_.size(); }
+
+    // Per-cell results; cells with no valid sample report invalid_value
+    uint32_t valid_count(size_t cell) const { return count_[cell]; }
+    double min(size_t cell) const { return count_[cell] ? min_[cell] : invalid_; }
+    double max(size_t cell) const { return count_[cell] ? max_[cell] : invalid_; }
+    double mean(size_t cell) const { return count_[cell] ? sum_[cell] / count_[cell] : invalid_; }
+
+    /** Fraction of frames in which the cell was valid */
+    double valid_fraction(size_t cell) const {
+        return frames_ ? static_cast<double>(count_[cell]) / frames_ : 0.0;
+    }
+
+    /**
+     * Approximate p-th percentile (p in [0, 1]) of the cell's valid samples;
+     * invalid_value without histograms or samples
+     */
+    double percentile(size_t cell, double p) const {
+        if (bins_ == 0 || count_[cell] == 0) return invalid_;
+        const uint32_t* h = &histogram_[cell * bins_];
+        double target = std::max(0.0, std::min(p, 1.0)) * count_[cell];
+        double width = (hi_ - lo_) / bins_;
+        double seen = 0;
+        for (size_t b = 0; b < bins_; b++) {
+            if (h[b] > 0 && seen + h[b] >= target) {
+                double v = lo_ + width * (b + (target - seen) / h[b]);
+                return std::max(min_[cell], std::min(v, max_[cell]));
+            }
+            seen += h[b];
+        }
+        return max_[cell];
+    }
+
+    /** Summary map for a statistic over all cells (e.g. for export) */
+    std::vector<double> mean_map() const { return map([this](size_t i) { return mean(i); }); }
+    std::vector<double> min_map() const { return map([this](size_t i) { return min(i); }); }
+    std::vector<double> max_map() const { return map([this](size_t i) { return max(i); }); }
+    std::vector<double> percentile_map(double p) const {
+        return map([this, p](size_t i) { return percentile(i, p); });
+    }
+
+private:
+    size_t bins_;
+    double invalid_ = -1;
+    double lo_ = 0, hi_ = 0;
+    size_t frames_ = 0;
+    std::vector<uint32_t> count_;
+    std::vector<double> sum_, min_, max_;
+    std::vector<uint32_t> histogram_;   // [cell * bins + bin]
+
+    template <typename Fn>
+    std::vector<double> map(Fn fn) const {
+        std::vector<double> out(size());
+        for (size_t i = 0; i < out.size(); i++) out[i] = fn(i);
+        return out;
+    }
+};
+
+/**
+ * Per-cell time a valid value spent above a threshold (or below it with
+ * above = false). Each frame accounts for the interval since the previous
+ * frame, so the first frame adds nothing.
+ */
+class FOMThresholdTime : public FOMSink {
+public:
+    explicit FOMThresholdTime(double threshold, bool above = true)
+        : threshold_(threshold), above_(above) {}
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        invalid_ = metadata.invalid_value;
+        frames_.assign(grid.size(), 0);
+        time_.assign(grid.size(), 0.0);
+        span_ = 0;
+        have_prev_ = false;
+    }
+
+    void consume(const FOMFrame& frame) override {
+        double dt = have_prev_ ? frame.time - prev_time_ : 0.0;
+        for (size_t i = 0; i < frame.values.size(); i++) {
+            double v = frame.values[i];
+            bool hit = v != invalid_ && (above_ ? v > threshold_ : v < threshold_);
+            if (hit) {
+                frames_[i]++;
+                time_[i] += dt;
+            }
+        }
+        span_ += dt;
+        prev_time_ = frame.time;
+        have_prev_ = true;
+    }
+
+    uint32_t frames(size_t cell) const { return frames_[cell]; }
+    double time(size_t cell) const { return time_[cell]; }
+    double fraction(size_t cell) const { return span_ > 0 ? time_[cell] / span_ : 0.0; }
+    const std::vector<double>& time_map() const { return time_; }
+
+private:
+    double threshold_;
+    bool above_;
+    double invalid_ = -1;
+    std::vector<uint32_t> frames_;
+    std::vector<double> time_;
+    double span_ = 0;
+    double prev_time_ = 0;
+    bool have_prev_ = false;
+};
+
+/**
+ * Forwards every call to each of a set of sinks, in order
+ */
+class FOMSinkGroup : public FOMSink {
+public:
+    FOMSinkGroup() = default;
+    FOMSinkGroup(std::initializer_list<FOMSink*> sinks) : sinks_(sinks) {}
+
+    void add(FOMSink& sink) { sinks_.push_back(&sink); }
+
+    void begin(const FOMGrid& grid, const FOMMetadata& metadata) override {
+        for (auto* s : sinks_) s->begin(grid, metadata);
+    }
+    void consume(const FOMFrame& frame) override {
+        for (auto* s : sinks_) s->consume(frame);
+    }
+    void end() override {
+        for (auto* s : sinks_) s->end();
+    }
+
+private:
+    std::vector<FOMSink*> sinks_;
+};
+
+} // namespace fom
+} // namespace sim
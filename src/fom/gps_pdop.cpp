@@ -3,26 +3,41 @@
  */
 
 #include "gps_pdop.hpp"
+#include "fom_device.hpp"
 #include "physics/gravity_model.hpp"
 #include "io/tle_parser.hpp"
+#include "utils/gpu.hpp"
+#include "utils/thread_pool.hpp"
 #include <cmath>
 #include <algorithm>
 
 namespace sim {
 namespace fom {
 
+namespace {
+constexpr size_t BLOCK = 64;   // Cells per lane block in compute()
+}
+
 GPSPDOP::GPSPDOP(const FOMGrid& grid, const std::vector<GPSSatellite>& satellites,
-                 double min_elevation_deg)
+                 double min_elevation_deg, int num_threads)
     : grid_(grid)
     , satellites_(satellites)
     , min_elevation_deg_(min_elevation_deg)
     , epoch_jd_(2460000.5)  // Default epoch ~2023
 {
+    ephemeris_ = ConstellationEphemeris(GPSPDOP::shared_state_satellites());
+    if (num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(num_threads);
+    }
+    if (gpu_available()) {
+        device_ = PDOPDevice::create(grid_, std::sin(min_elevation_deg_ * DEG_TO_RAD));
+    }
 }
 
 GPSPDOP GPSPDOP::from_tle_file(const FOMGrid& grid, const std::string& tle_file,
-                                double min_elevation_deg) {
-    auto tles = TLEParser::parse_file(tle_file);
+                                double min_elevation_deg, int num_threads) {
+    auto catalog = TLEParser::load_file(tle_file);
+    const auto& tles = *catalog;
 
     std::vector<GPSSatellite> satellites;
     for (const auto& tle : tles) {
@@ -30,25 +45,13 @@ GPSPDOP GPSPDOP::from_tle_file(const FOMGrid& grid, const std::string& tle_file,
         if (tle.name.find("GPS") != std::string::npos ||
             tle.name.find("NAVSTAR") != std::string::npos) {
             GPSSatellite sat;
-
-            // Convert TLE to orbital elements
-            // Mean motion is in revs/day, convert to semi-major axis
-            double n_rad_per_sec = tle.mean_motion * 2.0 * PI / 86400.0;
-            double mu = GravityModel::EARTH_MU;
-            sat.elements.semi_major_axis = std::pow(mu / (n_rad_per_sec * n_rad_per_sec), 1.0/3.0);
-            sat.elements.eccentricity = tle.eccentricity;
-            sat.elements.inclination = tle.inclination * DEG_TO_RAD;
-            sat.elements.raan = tle.raan * DEG_TO_RAD;
-            sat.elements.arg_periapsis = tle.arg_perigee * DEG_TO_RAD;
-            sat.elements.mean_anomaly = tle.mean_anomaly * DEG_TO_RAD;
-            sat.elements.true_anomaly = sat.elements.mean_anomaly; // Approximate
-
+            sat.elements = elements_from_tle(tle);
             sat.prn = tle.name;
             satellites.push_back(sat);
         }
     }
 
-    return GPSPDOP(grid, satellites, min_elevation_deg);
+    return GPSPDOP(grid, satellites, min_elevation_deg, num_threads);
 }
 
 FOMMetadata GPSPDOP::get_metadata() const {
@@ -62,217 +65,122 @@ FOMMetadata GPSPDOP::get_metadata() const {
     return meta;
 }
 
-Vec3 GPSPDOP::get_satellite_ecef(const GPSSatellite& sat, double t) const {
-    // Propagate using Keplerian motion
-    double mu = GravityModel::EARTH_MU;
-    double n = std::sqrt(mu / std::pow(sat.elements.semi_major_axis, 3));
-    double new_M = sat.elements.mean_anomaly + n * t;
-
-    // Normalize mean anomaly
-    while (new_M > 2.0 * PI) new_M -= 2.0 * PI;
-    while (new_M < 0) new_M += 2.0 * PI;
-
-    // Solve Kepler's equation
-    double e = sat.elements.eccentricity;
-    double E = new_M;
-    for (int i = 0; i < 10; i++) {
-        E = new_M + e * std::sin(E);
-    }
-
-    // True anomaly
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
-
-    // Position in orbital plane
-    double r = sat.elements.semi_major_axis * (1 - e * std::cos(E));
-    double x_orb = r * std::cos(nu);
-    double y_orb = r * std::sin(nu);
-
-    // Transform to ECI
-    double i = sat.elements.inclination;
-    double omega = sat.elements.arg_periapsis;
-    double Omega = sat.elements.raan;
-
-    double cos_O = std::cos(Omega), sin_O = std::sin(Omega);
-    double cos_i = std::cos(i), sin_i = std::sin(i);
-    double cos_w = std::cos(omega), sin_w = std::sin(omega);
-
-    Vec3 eci;
-    eci.x = (cos_O * cos_w - sin_O * sin_w * cos_i) * x_orb +
-            (-cos_O * sin_w - sin_O * cos_w * cos_i) * y_orb;
-    eci.y = (sin_O * cos_w + cos_O * sin_w * cos_i) * x_orb +
-            (-sin_O * sin_w + cos_O * cos_w * cos_i) * y_orb;
-    eci.z = (sin_w * sin_i) * x_orb + (cos_w * sin_i) * y_orb;
-
-    // Convert ECI to ECEF (account for Earth rotation)
-    double earth_rotation = t * 7.2921159e-5;
-    double cos_rot = std::cos(earth_rotation);
-    double sin_rot = std::sin(earth_rotation);
-
-    Vec3 ecef;
-    ecef.x = eci.x * cos_rot + eci.y * sin_rot;
-    ecef.y = -eci.x * sin_rot + eci.y * cos_rot;
-    ecef.z = eci.z;
-
-    return ecef;
+std::vector<OrbitalElements> GPSPDOP::shared_state_satellites() const {
+    std::vector<OrbitalElements> elements;
+    for (const auto& sat : satellites_) elements.push_back(sat.elements);
+    return elements;
 }
 
-bool GPSPDOP::is_visible(const Vec3& sat_ecef, double ground_lat, double ground_lon) const {
-    // Ground point in ECEF
-    double lat_rad = ground_lat * DEG_TO_RAD;
-    double lon_rad = ground_lon * DEG_TO_RAD;
-    double Re = 6378137.0;
-
-    Vec3 ground;
-    ground.x = Re * std::cos(lat_rad) * std::cos(lon_rad);
-    ground.y = Re * std::cos(lat_rad) * std::sin(lon_rad);
-    ground.z = Re * std::sin(lat_rad);
-
-    // Vector from ground to satellite
-    Vec3 to_sat;
-    to_sat.x = sat_ecef.x - ground.x;
-    to_sat.y = sat_ecef.y - ground.y;
-    to_sat.z = sat_ecef.z - ground.z;
-
-    // Local up vector (radial from Earth center)
-    double ground_r = ground.norm();
-    Vec3 up;
-    up.x = ground.x / ground_r;
-    up.y = ground.y / ground_r;
-    up.z = ground.z / ground_r;
-
-    // Elevation angle
-    double to_sat_r = to_sat.norm();
-    double dot = (to_sat.x * up.x + to_sat.y * up.y + to_sat.z * up.z);
-    double cos_zenith = dot / to_sat_r;
-    double elevation = 90.0 - std::acos(cos_zenith) * RAD_TO_DEG;
-
-    return elevation >= min_elevation_deg_;
-}
+std::vector<double> GPSPDOP::compute(double time) {
+    std::vector<double> values(grid_.size(), 99.0);
 
-double GPSPDOP::compute_pdop(double lat, double lon, double time,
-                             const std::vector<Vec3>& sat_positions) const {
-    // Collect visible satellites
-    std::vector<Vec3> visible_sats;
-    for (const auto& pos : sat_positions) {
-        if (is_visible(pos, lat, lon)) {
-            visible_sats.push_back(pos);
-        }
+    // All satellite positions, warm-started from the previous call
+    ephemeris_.positions(time, ecef_);
+    const std::vector<Vec3>& ecef = ecef_;
+    if (device_) {
+        device_->evaluate(ecef, values.data());
+        return values;
     }
 
-    // Need at least 4 satellites for PDOP
-    if (visible_sats.size() < 4) {
-        return 99.0;  // Invalid
+    const size_t num_cells = grid_.size();
+    const size_t num_blocks = (num_cells + BLOCK - 1) / BLOCK;
+    auto run_block = [&](size_t block) {
+        size_t begin = block * BLOCK;
+        compute_cells(time, ecef, begin, std::min(begin + BLOCK, num_cells), values.data());
+    };
+
+    if (pool_ && num_blocks > 1) {
+        pool_->parallel_for(num_blocks, run_block);
+    } else {
+        for (size_t block = 0; block < num_blocks; block++) run_block(block);
     }
 
-    // Ground point in ECEF
-    double lat_rad = lat * DEG_TO_RAD;
-    double lon_rad = lon * DEG_TO_RAD;
-    double Re = 6378137.0;
-
-    Vec3 ground;
-    ground.x = Re * std::cos(lat_rad) * std::cos(lon_rad);
-    ground.y = Re * std::cos(lat_rad) * std::sin(lon_rad);
-    ground.z = Re * std::sin(lat_rad);
-
-    // Build geometry matrix (H)
-    // Each row: [dx/r, dy/r, dz/r, 1] where (dx,dy,dz) is unit vector to satellite
-    size_t n = visible_sats.size();
-    std::vector<double> H(n * 4);
-
-    for (size_t i = 0; i < n; i++) {
-        double dx = visible_sats[i].x - ground.x;
-        double dy = visible_sats[i].y - ground.y;
-        double dz = visible_sats[i].z - ground.z;
-        double r = std::sqrt(dx*dx + dy*dy + dz*dz);
+    return values;
+}
 
-        H[i*4 + 0] = dx / r;
-        H[i*4 + 1] = dy / r;
-        H[i*4 + 2] = dz / r;
-        H[i*4 + 3] = 1.0;
+void GPSPDOP::compute_frame(double time, const std::vector<Vec3>& ecef, double* out) const {
+    if (device_) {
+        device_->evaluate(ecef, out);
+    } else {
+        compute_cells(time, ecef, 0, grid_.size(), out);
     }
+}
 
-    // Compute (H'H)^-1 for PDOP
-    // G = H'H is 4x4
-    double G[16] = {0};
-    for (size_t i = 0; i < 4; i++) {
-        for (size_t j = 0; j < 4; j++) {
-            for (size_t k = 0; k < n; k++) {
-                G[i*4 + j] += H[k*4 + i] * H[k*4 + j];
-            }
-        }
+void GPSPDOP::compute_cells(double time, const std::vector<Vec3>& ecef,
+                            size_t cell_begin, size_t cell_end, double* out) const {
+    (void)time;
+    const size_t num_sats = ecef.size();
+    std::vector<double> sx(num_sats), sy(num_sats), sz(num_sats);
+    for (size_t i = 0; i < num_sats; i++) {
+        sx[i] = ecef[i].x;
+        sy[i] = ecef[i].y;
+        sz[i] = ecef[i].z;
     }
 
-    // Invert 4x4 matrix using Gauss-Jordan
-    double inv[16];
-    for (int i = 0; i < 16; i++) inv[i] = (i % 5 == 0) ? 1.0 : 0.0;
-    double temp[16];
-    for (int i = 0; i < 16; i++) temp[i] = G[i];
-
-    for (int col = 0; col < 4; col++) {
-        // Find pivot
-        int pivot = col;
-        for (int row = col + 1; row < 4; row++) {
-            if (std::abs(temp[row*4 + col]) > std::abs(temp[pivot*4 + col])) {
-                pivot = row;
-            }
-        }
-
-        // Swap rows
-        if (pivot != col) {
-            for (int j = 0; j < 4; j++) {
-                std::swap(temp[col*4 + j], temp[pivot*4 + j]);
-                std::swap(inv[col*4 + j], inv[pivot*4 + j]);
+    const double Re = 6378137.0;
+    // elevation >= min  <=>  cos(zenith) >= sin(min)
+    const double min_cos_zenith = std::sin(min_elevation_deg_ * DEG_TO_RAD);
+    const double* ux = grid_.unit_x().data();
+    const double* uy = grid_.unit_y().data();
+    const double* uz = grid_.unit_z().data();
+
+    for (size_t begin = cell_begin; begin < cell_end; begin += BLOCK) {
+        const size_t n = std::min(BLOCK, cell_end - begin);
+        const double* bx = ux + begin;
+        const double* by = uy + begin;
+        const double* bz = uz + begin;
+
+        // G^T G sums: line-of-sight unit vectors e over visible satellites
+        double cnt[BLOCK] = {}, ex[BLOCK] = {}, ey[BLOCK] = {}, ez[BLOCK] = {};
+        double xx[BLOCK] = {}, xy[BLOCK] = {}, xz[BLOCK] = {};
+        double yy[BLOCK] = {}, yz[BLOCK] = {}, zz[BLOCK] = {};
+
+        for (size_t s = 0; s < num_sats; s++) {
+            const double px = sx[s], py = sy[s], pz = sz[s];
+#pragma GCC ivdep
+            for (size_t k = 0; k < n; k++) {
+                const double dx = px - Re * bx[k];
+                const double dy = py - Re * by[k];
+                const double dz = pz - Re * bz[k];
+                const double inv_r = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz);
+                const double lx = dx * inv_r, ly = dy * inv_r, lz = dz * inv_r;
+                const double m = (lx * bx[k] + ly * by[k] + lz * bz[k] >= min_cos_zenith) ? 1.0 : 0.0;
+                cnt[k] += m;
+                ex[k] += m * lx;
+                ey[k] += m * ly;
+                ez[k] += m * lz;
+                xx[k] += m * lx * lx;
+                xy[k] += m * lx * ly;
+                xz[k] += m * lx * lz;
+                yy[k] += m * ly * ly;
+                yz[k] += m * ly * lz;
+                zz[k] += m * lz * lz;
             }
         }
 
-        double diag = temp[col*4 + col];
-        if (std::abs(diag) < 1e-10) {
-            return 99.0;  // Singular matrix
-        }
-
-        // Scale row
-        for (int j = 0; j < 4; j++) {
-            temp[col*4 + j] /= diag;
-            inv[col*4 + j] /= diag;
-        }
-
-        // Eliminate column
-        for (int row = 0; row < 4; row++) {
-            if (row != col) {
-                double factor = temp[row*4 + col];
-                for (int j = 0; j < 4; j++) {
-                    temp[row*4 + j] -= factor * temp[col*4 + j];
-                    inv[row*4 + j] -= factor * inv[col*4 + j];
-                }
-            }
+        // Position block of (G^T G)^-1 = (A - b b^T / n)^-1; PDOP^2 is its
+        // trace, the sum of the Schur complement's diagonal cofactors / det
+#pragma GCC ivdep
+        for (size_t k = 0; k < n; k++) {
+            const double inv_n = 1.0 / std::max(cnt[k], 1.0);
+            const double a = xx[k] - ex[k] * ex[k] * inv_n;
+            const double b = xy[k] - ex[k] * ey[k] * inv_n;
+            const double c = xz[k] - ex[k] * ez[k] * inv_n;
+            const double d = yy[k] - ey[k] * ey[k] * inv_n;
+            const double e = yz[k] - ey[k] * ez[k] * inv_n;
+            const double f = zz[k] - ez[k] * ez[k] * inv_n;
+
+            const double c00 = d * f - e * e;
+            const double c11 = a * f - c * c;
+            const double c22 = a * d - b * b;
+            const double det = a * c00 - b * (b * f - c * e) + c * (b * e - c * d);
+
+            // Fewer than 4 satellites or a degenerate geometry is invalid
+            const bool valid = cnt[k] >= 4.0 && det > 1e-20;
+            const double pdop = std::sqrt(std::max(c00 + c11 + c22, 0.0) / (valid ? det : 1.0));
+            out[begin + k] = valid ? std::min(pdop, 99.0) : 99.0;
         }
     }
-
-    // PDOP = sqrt(trace of position part of inverse)
-    // Position is first 3 diagonal elements
-    double pdop = std::sqrt(inv[0] + inv[5] + inv[10]);
-
-    return std::min(pdop, 99.0);
-}
-
-std::vector<double> GPSPDOP::compute(double time) {
-    std::vector<double> values(grid_.size(), 99.0);
-
-    // Pre-compute all satellite positions
-    std::vector<Vec3> sat_positions(satellites_.size());
-    for (size_t i = 0; i < satellites_.size(); i++) {
-        sat_positions[i] = get_satellite_ecef(satellites_[i], time);
-    }
-
-    // Compute PDOP for each grid cell
-    for (const auto& cell : grid_.cells()) {
-        values[cell.index] = compute_pdop(cell.lat, cell.lon, time, sat_positions);
-    }
-
-    return values;
 }
 
 } // namespace fom
@@ -15,12 +15,18 @@
 #pragma once
 
 #include "figure_of_merit.hpp"
+#include "fom_ephemeris.hpp"
 #include "physics/orbital_elements.hpp"
+#include <memory>
 #include <vector>
 
 namespace sim {
+
+class ThreadPool;
 namespace fom {
 
+class PDOPDevice;
+
 /**
  * GPS Satellite state for PDOP computation
  */
@@ -35,6 +41,18 @@ struct GPSSatellite {
 
 /**
  * GPS PDOP Calculator
+ *
+ * compute() works on blocks of cells: for each satellite, every lane of a
+ * block tests visibility against the cell's cached up vector and adds the
+ * line-of-sight unit vector to the G^T G sums under a mask. The position
+ * block of (G^T G)^-1 is then the inverse of the 3x3 Schur complement
+ * A - b b^T / n, so PDOP comes from its closed-form cofactors. Blocks are
+ * spread over a thread pool.
+ *
+ * On a GPU build with a device present (utils/gpu.hpp), compute() and the
+ * pipeline's compute_frame() run on a PDOPDevice instead, with the grid
+ * resident on the device; frames then agree with the CPU path to float
+ * precision. compute_cells() always runs on the CPU.
  */
 class GPSPDOP : public FigureOfMerit {
 public:
@@ -43,24 +61,33 @@ public:
      * @param grid The spatial grid to compute PDOP over
      * @param satellites Vector of GPS satellites
      * @param min_elevation_deg Minimum elevation angle for visibility (default 5 degrees)
+     * @param num_threads Threads for compute() (0 = hardware concurrency, 1 = serial)
      */
     GPSPDOP(const FOMGrid& grid, const std::vector<GPSSatellite>& satellites,
-            double min_elevation_deg = 5.0);
+            double min_elevation_deg = 5.0, int num_threads = 0);
 
     /**
      * Create from TLE catalog file
      * @param grid The spatial grid
      * @param tle_file Path to TLE file containing GPS satellites
      * @param min_elevation_deg Minimum elevation angle
+     * @param num_threads Threads for compute()
      */
     static GPSPDOP from_tle_file(const FOMGrid& grid, const std::string& tle_file,
-                                  double min_elevation_deg = 5.0);
+                                  double min_elevation_deg = 5.0, int num_threads = 0);
 
     // FigureOfMerit interface
     FOMMetadata get_metadata() const override;
     std::vector<double> compute(double time) override;
     const FOMGrid& get_grid() const override { return grid_; }
 
+    // Shared-state evaluation (FOMPipeline)
+    std::vector<OrbitalElements> shared_state_satellites() const override;
+    void compute_cells(double time, const std::vector<Vec3>& ecef,
+                       size_t begin, size_t end, double* out) const override;
+    bool offloaded() const override { return device_ != nullptr; }
+    void compute_frame(double time, const std::vector<Vec3>& ecef, double* out) const override;
+
     // Accessors
     size_t num_satellites() const { return satellites_.size(); }
     const std::vector<GPSSatellite>& satellites() const { return satellites_; }
@@ -70,16 +97,10 @@ private:
     std::vector<GPSSatellite> satellites_;
     double min_elevation_deg_;
     double epoch_jd_;  // Julian date epoch for propagation
-
-    // Compute satellite ECEF position at time t
-    Vec3 get_satellite_ecef(const GPSSatellite& sat, double t) const;
-
-    // Check if satellite is visible from ground point
-    bool is_visible(const Vec3& sat_ecef, double ground_lat, double ground_lon) const;
-
-    // Compute PDOP at a single grid point
-    double compute_pdop(double lat, double lon, double time,
-                        const std::vector<Vec3>& sat_positions) const;
+    std::shared_ptr<ThreadPool> pool_;  // Null when serial
+    std::shared_ptr<PDOPDevice> device_;   // Null without a GPU
+    ConstellationEphemeris ephemeris_;   // satellites_ in order
+    std::vector<Vec3> ecef_;             // Positions at the last compute()
 };
 
 } // namespace fom
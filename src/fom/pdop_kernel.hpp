@@ -0,0 +1,67 @@
+/**
+ * PDOP kernel — One grid cell's PDOP from satellite ECEF positions
+ *
+ * The per-lane body of GPSPDOP::compute_cells() for a single cell, as a
+ * SIM_HD function for the CUDA backend (fom_device.cu). Same sums and
+ * Schur-complement cofactors as the CPU block loop.
+ */
+
+#pragma once
+
+#include "utils/gpu.hpp"
+#include <cmath>
+
+namespace sim {
+namespace fom {
+
+/**
+ * @param ux,uy,uz       Cell up unit vector
+ * @param sx,sy,sz       Satellite ECEF positions [m]
+ * @param min_cos_zenith sin(minimum elevation)
+ * @return PDOP, or 99 with fewer than 4 visible satellites or a degenerate geometry
+ */
+SIM_HD inline double pdop_cell(double ux, double uy, double uz,
+                               const double* sx, const double* sy, const double* sz,
+                               int num_sats, double min_cos_zenith) {
+    const double Re = 6378137.0;
+    double cnt = 0, ex = 0, ey = 0, ez = 0;
+    double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+
+    for (int s = 0; s < num_sats; s++) {
+        const double dx = sx[s] - Re * ux;
+        const double dy = sy[s] - Re * uy;
+        const double dz = sz[s] - Re * uz;
+        const double inv_r = 1.0 / sqrt(dx * dx + dy * dy + dz * dz);
+        const double lx = dx * inv_r, ly = dy * inv_r, lz = dz * inv_r;
+        if (lx * ux + ly * uy + lz * uz < min_cos_zenith) continue;
+        cnt += 1.0;
+        ex += lx;
+        ey += ly;
+        ez += lz;
+        xx += lx * lx;
+        xy += lx * ly;
+        xz += lx * lz;
+        yy += ly * ly;
+        yz += ly * lz;
+        zz += lz * lz;
+    }
+
+    const double inv_n = 1.0 / fmax(cnt, 1.0);
+    const double a = xx - ex * ex * inv_n;
+    const double b = xy - ex * ey * inv_n;
+    const double c = xz - ex * ez * inv_n;
+    const double d = yy - ey * ey * inv_n;
+    const double e = yz - ey * ez * inv_n;
+    const double f = zz - ez * ez * inv_n;
+
+    const double c00 = d * f - e * e;
+    const double c11 = a * f - c * c;
+    const double c22 = a * d - b * b;
+    const double det = a * c00 - b * (b * f - c * e) + c * (b * e - c * d);
+
+    if (cnt < 4.0 || det <= 1e-20) return 99.0;
+    return fmin(sqrt(fmax(c00 + c11 + c22, 0.0) / det), 99.0);
+}
+
+} // namespace fom
+} // namespace sim
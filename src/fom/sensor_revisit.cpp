@@ -4,6 +4,7 @@
 
 #include "sensor_revisit.hpp"
 #include "physics/gravity_model.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace sim {
@@ -13,6 +14,7 @@ SensorRevisit::SensorRevisit(const FOMGrid& grid, const std::vector<SensorSatell
     : grid_(grid)
     , satellites_(satellites)
 {
+    ephemeris_ = ConstellationEphemeris(SensorRevisit::shared_state_satellites());
     reset_state();
 }
 
@@ -54,117 +56,65 @@ FOMMetadata SensorRevisit::get_metadata() const {
 void SensorRevisit::reset_state() {
     last_seen_times_.assign(grid_.size(), -1.0);  // Never seen
     current_time_ = 0;
+    ephemeris_.reset();
 }
 
 std::pair<double, double> SensorRevisit::get_subsatellite_point(const SensorSatellite& sat, double t) const {
-    // Propagate using Keplerian motion
-    double mu = GravityModel::EARTH_MU;
-    double n = std::sqrt(mu / std::pow(sat.elements.semi_major_axis, 3));
-    double new_M = sat.elements.mean_anomaly + n * t;
-
-    // Normalize mean anomaly
-    while (new_M > 2.0 * PI) new_M -= 2.0 * PI;
-    while (new_M < 0) new_M += 2.0 * PI;
-
-    // Solve Kepler's equation
-    double e = sat.elements.eccentricity;
-    double E = new_M;
-    for (int i = 0; i < 10; i++) {
-        E = new_M + e * std::sin(E);
-    }
-
-    // True anomaly
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
-
-    // Position in orbital plane
-    double r = sat.elements.semi_major_axis * (1 - e * std::cos(E));
-    double x_orb = r * std::cos(nu);
-    double y_orb = r * std::sin(nu);
-
-    // Transform to ECI
-    double i = sat.elements.inclination;
-    double omega = sat.elements.arg_periapsis;
-    double Omega = sat.elements.raan;
-
-    double cos_O = std::cos(Omega), sin_O = std::sin(Omega);
-    double cos_i = std::cos(i), sin_i = std::sin(i);
-    double cos_w = std::cos(omega), sin_w = std::sin(omega);
-
-    Vec3 eci;
-    eci.x = (cos_O * cos_w - sin_O * sin_w * cos_i) * x_orb +
-            (-cos_O * sin_w - sin_O * cos_w * cos_i) * y_orb;
-    eci.y = (sin_O * cos_w + cos_O * sin_w * cos_i) * x_orb +
-            (-sin_O * sin_w + cos_O * cos_w * cos_i) * y_orb;
-    eci.z = (sin_w * sin_i) * x_orb + (cos_w * sin_i) * y_orb;
-
-    // Convert ECI to ECEF (account for Earth rotation)
-    double earth_rotation = t * 7.2921159e-5;
-    double cos_rot = std::cos(earth_rotation);
-    double sin_rot = std::sin(earth_rotation);
-
-    Vec3 ecef;
-    ecef.x = eci.x * cos_rot + eci.y * sin_rot;
-    ecef.y = -eci.x * sin_rot + eci.y * cos_rot;
-    ecef.z = eci.z;
-
-    // Convert ECEF to lat/lon
-    double r_ecef = ecef.norm();
-    double lat = std::asin(ecef.z / r_ecef) * RAD_TO_DEG;
-    double lon = std::atan2(ecef.y, ecef.x) * RAD_TO_DEG;
-
-    return {lat, lon};
+    return subpoint(kepler_ecef(sat.elements, t));
 }
 
-bool SensorRevisit::is_in_footprint(double sat_lat, double sat_lon,
-                                     double ground_lat, double ground_lon,
-                                     double footprint_km) const {
-    double dist = great_circle_distance_km(sat_lat, sat_lon, ground_lat, ground_lon);
-    return dist <= footprint_km;
+std::vector<OrbitalElements> SensorRevisit::shared_state_satellites() const {
+    std::vector<OrbitalElements> elements;
+    for (const auto& sat : satellites_) elements.push_back(sat.elements);
+    return elements;
 }
 
-std::vector<double> SensorRevisit::compute(double time) {
-    std::vector<double> values(grid_.size());
-
+void SensorRevisit::advance(double time, const std::vector<Vec3>& ecef) {
     // Update last seen times for all satellites
-    for (const auto& sat : satellites_) {
-        auto [sat_lat, sat_lon] = get_subsatellite_point(sat, time);
-
-        for (const auto& cell : grid_.cells()) {
-            if (is_in_footprint(sat_lat, sat_lon, cell.lat, cell.lon,
-                               sat.sensor.footprint_radius_km)) {
-                last_seen_times_[cell.index] = time;
-            }
-        }
+    for (size_t s = 0; s < satellites_.size(); s++) {
+        auto [sat_lat, sat_lon] = subpoint(ecef[s]);
+
+        // Only the cells the footprint can reach
+        grid_.for_each_cell_within(sat_lat, sat_lon, satellites_[s].sensor.footprint_radius_km,
+                                   [&](int index) { last_seen_times_[index] = time; });
     }
+    current_time_ = time;
+}
 
+void SensorRevisit::compute_cells(double time, const std::vector<Vec3>& ecef,
+                                  size_t begin, size_t end, double* out) const {
+    (void)ecef;
     // Compute time since last seen
-    for (size_t i = 0; i < grid_.size(); i++) {
+    for (size_t i = begin; i < end; i++) {
         if (last_seen_times_[i] < 0) {
-            values[i] = -1.0;  // Never seen
+            out[i] = -1.0;  // Never seen
         } else {
-            values[i] = time - last_seen_times_[i];
+            out[i] = time - last_seen_times_[i];
         }
     }
+}
+
+std::vector<double> SensorRevisit::compute(double time) {
+    std::vector<double> values(grid_.size());
+
+    ephemeris_.positions(time, ecef_);
+    advance(time, ecef_);
+    compute_cells(time, ecef_, 0, grid_.size(), values.data());
 
-    current_time_ = time;
     return values;
 }
 
-FOMResult SensorRevisit::compute_series(double start_time, double end_time, double time_step) {
+void SensorRevisit::compute_series(double start_time, double end_time, double time_step,
+                                   FOMSink& sink) {
     reset_state();
-
-    FOMResult result;
-    result.metadata = get_metadata();
-    result.grid = grid_;
+    sink.begin(grid_, get_metadata());
 
     // Use smaller internal time step for accuracy, but output at requested rate
     double internal_step = std::min(time_step, 1.0);
     double output_step = time_step;
 
     double next_output = start_time;
+    FOMFrame frame;
 
     for (double t = start_time; t <= end_time; t += internal_step) {
         // Always update state
@@ -172,14 +122,152 @@ FOMResult SensorRevisit::compute_series(double start_time, double end_time, doub
 
         // Output frame at requested intervals
         if (t >= next_output - internal_step/2) {
-            FOMFrame frame(t, grid_.size());
-            frame.values = values;
-            result.frames.push_back(std::move(frame));
+            frame.time = t;
+            frame.values.assign(values.begin(), values.end());
+            sink.consume(frame);
             next_output += output_step;
         }
     }
 
-    return result;
+    sink.end();
+}
+
+std::vector<std::vector<AccessInterval>> SensorRevisit::compute_access_intervals(
+    double start_time, double end_time, double max_step, double max_arc_deg) const {
+
+    std::vector<std::vector<AccessInterval>> intervals(grid_.size());
+    if (end_time <= start_time) return intervals;
+
+    const double* ux = grid_.unit_x().data();
+    const double* uy = grid_.unit_y().data();
+    const double* uz = grid_.unit_z().data();
+
+    auto unit = [&](const SensorSatellite& sat, double t) {
+        auto [lat, lon] = get_subsatellite_point(sat, t);
+        double phi = lat * DEG_TO_RAD, lam = lon * DEG_TO_RAD;
+        return Vec3(std::cos(phi) * std::cos(lam), std::cos(phi) * std::sin(lam), std::sin(phi));
+    };
+
+    for (size_t si = 0; si < satellites_.size(); si++) {
+        const SensorSatellite& sat = satellites_[si];
+        const double theta = sat.sensor.footprint_radius_km / EARTH_RADIUS_KM;
+        if (theta <= 0) continue;
+        const double cos_theta = std::cos(std::min(theta, PI));
+
+        // Step: ground-track rate bounded by the orbital rate plus Earth's
+        double n = std::sqrt(GravityModel::EARTH_MU / std::pow(sat.elements.semi_major_axis, 3));
+        double rate = n * (1.0 + sat.elements.eccentricity) / (1.0 - sat.elements.eccentricity) + 7.2921159e-5;
+        double step = std::min(max_step, max_arc_deg * DEG_TO_RAD / rate);
+        int num_steps = std::max(1, static_cast<int>(std::ceil((end_time - start_time) / step)));
+        step = (end_time - start_time) / num_steps;
+
+        Vec3 u0 = unit(sat, start_time);
+        for (int k = 0; k < num_steps; k++) {
+            const double t0 = start_time + k * step;
+            const Vec3 u1 = unit(sat, t0 + step);
+
+            // Arc basis: a = u0, b toward u1 in the arc's plane
+            double cos_w = u0.x * u1.x + u0.y * u1.y + u0.z * u1.z;
+            Vec3 b(u1.x - cos_w * u0.x, u1.y - cos_w * u0.y, u1.z - cos_w * u0.z);
+            double sin_w = b.norm();
+            double omega = std::atan2(sin_w, cos_w);
+            bool moving = sin_w > 1e-14;
+            if (moving) b = Vec3(b.x / sin_w, b.y / sin_w, b.z / sin_w);
+
+            // Candidates: cells within the footprint of any point on the arc
+            Vec3 mid(u0.x + u1.x, u0.y + u1.y, u0.z + u1.z);
+            double mid_r = mid.norm();
+            double mid_lat = std::asin(std::max(-1.0, std::min(1.0, mid.z / mid_r))) * RAD_TO_DEG;
+            double mid_lon = std::atan2(mid.y, mid.x) * RAD_TO_DEG;
+            double radius_km = (theta + 0.5 * omega) * EARTH_RADIUS_KM + 1e-6;
+
+            grid_.for_each_cell_within(mid_lat, mid_lon, radius_km, [&](int c) {
+                double A = ux[c] * u0.x + uy[c] * u0.y + uz[c] * u0.z;
+                double s0, s1;
+                if (!moving) {
+                    if (A < cos_theta) return;
+                    s0 = 0.0;
+                    s1 = 1.0;
+                } else {
+                    double B = ux[c] * b.x + uy[c] * b.y + uz[c] * b.z;
+                    double R = std::sqrt(A * A + B * B);
+                    if (R < cos_theta) return;
+                    double phase = std::atan2(B, A);
+                    double half = std::acos(std::min(1.0, cos_theta / R));
+                    s0 = std::max(0.0, (phase - half) / omega);
+                    s1 = std::min(1.0, (phase + half) / omega);
+                    if (s0 > s1) return;
+                }
+
+                double t_in = t0 + s0 * step, t_out = t0 + s1 * step;
+                auto& list = intervals[c];
+                if (!list.empty() && list.back().satellite == static_cast<int>(si) &&
+                    list.back().end >= t_in - 1e-9 * step) {
+                    list.back().end = std::max(list.back().end, t_out);
+                } else {
+                    list.push_back({t_in, t_out, static_cast<int>(si)});
+                }
+            });
+
+            u0 = u1;
+        }
+    }
+
+    for (auto& list : intervals) {
+        std::sort(list.begin(), list.end(),
+                  [](const AccessInterval& a, const AccessInterval& b) { return a.start < b.start; });
+    }
+    return intervals;
+}
+
+std::vector<RevisitStatistics> SensorRevisit::compute_revisit_statistics(
+    double start_time, double end_time, double max_step, double max_arc_deg) const {
+
+    auto intervals = compute_access_intervals(start_time, end_time, max_step, max_arc_deg);
+    std::vector<RevisitStatistics> stats(intervals.size());
+    for (size_t c = 0; c < intervals.size(); c++) {
+        stats[c] = revisit_statistics(intervals[c], start_time, end_time);
+    }
+    return stats;
+}
+
+RevisitStatistics SensorRevisit::revisit_statistics(const std::vector<AccessInterval>& intervals,
+                                                    double start_time, double end_time) {
+    const double span = end_time - start_time;
+    RevisitStatistics st;
+    double covered_until = start_time;   // End of coverage so far
+    double gap_sum = 0, wait_integral = 0;
+    int gaps = 0;
+
+    auto close_gap = [&](double gap_end) {
+        double gap = gap_end - covered_until;
+        if (gap <= 0) return;
+        gaps++;
+        gap_sum += gap;
+        wait_integral += 0.5 * gap * gap;
+        st.max_gap = std::max(st.max_gap, gap);
+    };
+
+    // Sorted by start, so the union is one sweep
+    for (const AccessInterval& a : intervals) {
+        double s = std::max(a.start, start_time), e = std::min(a.end, end_time);
+        if (e < s) continue;
+        if (s > covered_until || st.num_accesses == 0) {
+            close_gap(s);
+            st.num_accesses++;
+            st.coverage_time += e - s;
+            covered_until = std::max(covered_until, e);
+        } else if (e > covered_until) {
+            st.coverage_time += e - covered_until;
+            covered_until = e;
+        }
+    }
+    close_gap(end_time);
+
+    st.coverage_fraction = span > 0 ? st.coverage_time / span : 0.0;
+    st.mean_gap = gaps > 0 ? gap_sum / gaps : 0.0;
+    st.mean_response_time = span > 0 ? wait_integral / span : 0.0;
+    return st;
 }
 
 std::vector<std::pair<double, double>> SensorRevisit::compute_ground_track(
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "figure_of_merit.hpp"
+#include "fom_ephemeris.hpp"
 #include "physics/orbital_elements.hpp"
 #include <vector>
 
@@ -51,6 +52,28 @@ struct SensorSatellite {
         : elements(elem), sensor(sens), name(id) {}
 };
 
+/**
+ * One interval during which a cell is inside a satellite's footprint
+ */
+struct AccessInterval {
+    double start;       // [s]
+    double end;         // [s]
+    int satellite;      // Index into SensorRevisit::satellites()
+};
+
+/**
+ * Revisit statistics of one cell over an analysis span, from the union of
+ * all satellites' access intervals
+ */
+struct RevisitStatistics {
+    int num_accesses = 0;            // Merged coverage intervals
+    double coverage_time = 0;        // Total time covered [s]
+    double coverage_fraction = 0;
+    double max_gap = 0;              // Longest uncovered span, edges included [s]
+    double mean_gap = 0;             // Mean uncovered span [s]
+    double mean_response_time = 0;   // Time-averaged wait for the next coverage [s]
+};
+
 /**
  * Sensor Revisit Time Calculator
  *
@@ -87,12 +110,55 @@ public:
      * Override compute_series to properly track state over time
      * The base implementation doesn't maintain state between frames
      */
-    FOMResult compute_series(double start_time, double end_time, double time_step) override;
+    using FigureOfMerit::compute_series;
+    void compute_series(double start_time, double end_time, double time_step,
+                        FOMSink& sink) override;
+
+    // Shared-state evaluation (FOMPipeline)
+    std::vector<OrbitalElements> shared_state_satellites() const override;
+    void reset() override { reset_state(); }
+    void advance(double time, const std::vector<Vec3>& ecef) override;
+    void compute_cells(double time, const std::vector<Vec3>& ecef,
+                       size_t begin, size_t end, double* out) const override;
 
     // Accessors
     size_t num_satellites() const { return satellites_.size(); }
     const std::vector<SensorSatellite>& satellites() const { return satellites_; }
 
+    /**
+     * Access intervals of every cell over [start_time, end_time], by cell
+     * index, sorted by start.
+     *
+     * Event-based instead of sampled: each satellite's sub-point is
+     * sampled every max_step seconds (or less, so that it moves at most
+     * max_arc_deg between samples) and the track between samples is taken
+     * as the great-circle arc joining them. Only cells the spatial index
+     * finds near an arc are visited, and for those the entry and exit
+     * times along the arc are solved in closed form from
+     * c . u(s) = R cos(omega s - phi) = cos(footprint angle).
+     * Intervals of one satellite that meet across samples are joined.
+     */
+    std::vector<std::vector<AccessInterval>> compute_access_intervals(
+        double start_time, double end_time,
+        double max_step = 10.0, double max_arc_deg = 0.5) const;
+
+    /**
+     * Per-cell revisit statistics from the access intervals. Gaps are the
+     * uncovered spans of [start_time, end_time]; the mean response time
+     * integrates the wait until the next access over the span (a trailing
+     * gap counts as ending at end_time).
+     */
+    std::vector<RevisitStatistics> compute_revisit_statistics(
+        double start_time, double end_time,
+        double max_step = 10.0, double max_arc_deg = 0.5) const;
+
+    /**
+     * Revisit statistics of one cell from its access intervals (any
+     * satellites, sorted by start) over [start_time, end_time]
+     */
+    static RevisitStatistics revisit_statistics(const std::vector<AccessInterval>& intervals,
+                                                double start_time, double end_time);
+
     // Get satellite ground track for smart grid creation
     std::vector<std::pair<double, double>> compute_ground_track(
         double start_time, double end_time, double time_step) const;
@@ -104,14 +170,12 @@ private:
     // State tracking for revisit computation
     std::vector<double> last_seen_times_;  // Last time each cell was observed
     double current_time_ = 0;
+    ConstellationEphemeris ephemeris_;     // satellites_ in order
+    std::vector<Vec3> ecef_;
 
     // Get satellite sub-point (lat, lon) at time t
     std::pair<double, double> get_subsatellite_point(const SensorSatellite& sat, double t) const;
 
-    // Check if ground point is within sensor footprint
-    bool is_in_footprint(double sat_lat, double sat_lon, double ground_lat, double ground_lon,
-                         double footprint_km) const;
-
     // Reset state for new computation
     void reset_state();
 };
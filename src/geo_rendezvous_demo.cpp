@@ -8,6 +8,10 @@
 #include "physics/orbital_elements.hpp"
 #include "physics/gravity_model.hpp"
 #include "propagators/rk4_integrator.hpp"
+#include "io/czml_writer.hpp"
+#include "io/trajectory_archive.hpp"
+#include "io/async_output.hpp"
+#include "coordinate/time_utils.hpp"
 
 using namespace sim;
 
@@ -542,6 +546,32 @@ int main(int argc, char* argv[]) {
     chase.trajectory.push_back(chase.state);
     target.trajectory.push_back(target.state);
 
+    // Both vehicles streamed as CZML while they are propagated
+    CzmlOptions czml_options;
+    czml_options.chunk_seconds = 6.0 * 3600.0;
+    czml_options.min_sample_interval = record_interval;
+    czml_options.clock_multiplier = 300.0;
+    CzmlWriter czml("geo_rendezvous.czml", "GEO CW Rendezvous",
+                    TimeUtils::J2000_EPOCH_JD, czml_options);
+    CzmlEntity czml_entity;
+    czml_entity.id = "chase";
+    czml_entity.name = chase.name;
+    czml_entity.rgba = {0, 255, 0, 255};
+    size_t czml_chase = czml.add_entity(czml_entity);
+    czml_entity.id = "target";
+    czml_entity.name = target.name;
+    czml_entity.rgba = {255, 0, 0, 255};
+    size_t czml_target = czml.add_entity(czml_entity);
+    czml.add_sample(czml_chase, 0.0, chase.state.position);
+    czml.add_sample(czml_target, 0.0, target.state.position);
+
+    TrajectoryArchiveOptions archive_options;
+    archive_options.frame = traj::FRAME_ECI;
+    TrajectoryArchiveWriter archive;
+    archive.open("geo_rendezvous.traj", {"chase", "target"}, archive_options);
+    Vec3 archive_pos[2] = {chase.state.position, target.state.position};
+    archive.add_sample(0.0, archive_pos);
+
     struct RICData {
         double time;
         double range;
@@ -587,6 +617,12 @@ int main(int argc, char* argv[]) {
                       << " C=" << ric_at_burn.z/1e3 << " km" << std::endl;
         }
 
+        czml.add_sample(czml_chase, t, chase.state.position);
+        czml.add_sample(czml_target, t, target.state.position);
+        archive_pos[0] = chase.state.position;
+        archive_pos[1] = target.state.position;
+        archive.add_sample(t, archive_pos);
+
         Vec3 ric = compute_ric_position(chase.state, target.state);
         double range = std::sqrt(ric.x*ric.x + ric.y*ric.y + ric.z*ric.z);
 
@@ -618,7 +654,7 @@ int main(int argc, char* argv[]) {
               << ", C=" << final_ric.z/1e3 << " km" << std::endl;
 
     // Export JSON
-    std::ofstream json_file("geo_rendezvous_data.json");
+    AsyncOFStream json_file("geo_rendezvous_data.json");
     json_file << std::fixed << std::setprecision(6);
     json_file << "{\n";
     json_file << "  \"metadata\": {\n";
@@ -681,5 +717,9 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\nExported to: geo_rendezvous_data.json" << std::endl;
 
+    czml.close();
+    std::cout << "Exported to: geo_rendezvous.czml (" << czml.samples_written() << " samples)" << std::endl;
+    if (archive.close()) std::cout << "Exported to: geo_rendezvous.traj" << std::endl;
+
     return 0;
 }
@@ -6,6 +6,7 @@
  */
 
 #include "io/tle_parser.hpp"
+#include "io/async_output.hpp"
 #include "physics/orbital_elements.hpp"
 #include "physics/gravity_model.hpp"
 #include "coordinate/time_utils.hpp"
@@ -84,14 +85,7 @@ OrbitalElements tle_to_elements(const TLE& tle) {
     // Convert mean anomaly to true anomaly via eccentric anomaly
     double M = tle.mean_anomaly * DEG_TO_RAD;
     double e = tle.eccentricity;
-    double E = M;
-    for (int i = 0; i < 10; i++) {
-        E = M + e * std::sin(E);
-    }
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
+    double nu = OrbitalMechanics::mean_to_true_anomaly(M, e);
     elem.true_anomaly = nu;
     return elem;
 }
@@ -107,14 +101,7 @@ StateVector propagate_satellite(const GPSSatellite& sat, double dt_seconds) {
 
     // Convert mean anomaly to true anomaly
     double e = sat.elements.eccentricity;
-    double E = new_M;
-    for (int i = 0; i < 10; i++) {
-        E = new_M + e * std::sin(E);
-    }
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
+    double nu = OrbitalMechanics::mean_to_true_anomaly(new_M, e);
 
     // Create updated elements
     OrbitalElements prop_elem = sat.elements;
@@ -285,7 +272,8 @@ int main(int argc, char* argv[]) {
 
     // Load GPS TLEs
     std::string tle_file = "data/tles/gps.txt";
-    std::vector<TLE> tles = TLEParser::parse_file(tle_file);
+    auto catalog = TLEParser::load_file(tle_file);
+    const std::vector<TLE>& tles = *catalog;
     std::cout << "Loaded " << tles.size() << " GPS satellites\n";
 
     if (tles.empty()) {
@@ -335,7 +323,7 @@ int main(int argc, char* argv[]) {
     std::cout << "Computing PDOP for " << num_steps << " time steps...\n";
 
     // Open output file
-    std::ofstream out("visualization/cesium/gps_pdop_data.json");
+    AsyncOFStream out("visualization/cesium/gps_pdop_data.json");
     out << std::fixed << std::setprecision(4);
 
     out << "{\n";
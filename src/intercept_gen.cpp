@@ -0,0 +1,212 @@
+/**
+ * intercept_gen — Generate direct-ascent intercept tables for mc_engine --wez.
+ *
+ * Searches launch_intercept_demo's two-stage vehicle against circular
+ * orbital threats over a grid of pass geometries (see intercept_table.hpp)
+ * and writes <name>.ixt into the output directory, beside any .wez
+ * tables; a SAM battery whose weapon "wez" is that name engages orbital
+ * targets through it.
+ *
+ * --check K compares the table with K full solves at random geometries,
+ * sites and epochs (refine_intercept seeded by the lookup): how many
+ * converge, how far the solved launch time lands from the table's, and
+ * what a lookup costs against a solve.
+ *
+ * Usage:
+ *   intercept_gen --output <dir> [--name NAME] [--lat DEG] [--threads N]
+ *                 [--max-delay S] [--max-tof S] [--coarse] [--check K]
+ *   intercept_gen --table <file.ixt> --check K
+ */
+
+#include "montecarlo/intercept_table.hpp"
+#include "physics/launch_trajectory_solver.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+using namespace sim::mc;
+
+namespace {
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " --output <dir> [options]\n"
+              << "       " << prog << " --table <file.ixt> --check K\n\n"
+              << "  --output <dir>       Directory for <name>.ixt (created if absent)\n"
+              << "  --name NAME          Table name, the SAM \"wez\" that selects it\n"
+              << "                       (default: direct_ascent)\n"
+              << "  --lat DEG            Site latitude (default: 28.5623, Cape Canaveral)\n"
+              << "  --threads N          Worker threads (default: all cores)\n"
+              << "  --max-delay S        Latest launch searched [s] (default: 1800)\n"
+              << "  --max-tof S          Longest flight searched [s] (default: 1500)\n"
+              << "  --coarse             Small grid (180 cells) for a quick look\n"
+              << "  --table <file>       Check an existing table instead of generating\n"
+              << "  --check K            Compare K random geometries with full solves\n";
+}
+
+// launch_intercept_demo's vehicle
+sim::SolverVehicleConfig demo_vehicle() {
+    sim::SolverVehicleConfig vehicle;
+    vehicle.stages.push_back({20000.0, 280000.0, 4500000.0, 295.0, 320.0});
+    vehicle.stages.push_back({3500.0, 28000.0, 450000.0, 320.0, 355.0});
+    vehicle.payload_mass = 4500.0;
+    vehicle.drag_coefficient = 0.4;
+    vehicle.reference_area = 100.0;
+    return vehicle;
+}
+
+InterceptAxes coarse_axes() {
+    InterceptAxes a;
+    a.altitude = {400000.0, 800000.0};
+    a.cross_range = {-1500000.0, 0.0, 1500000.0};
+    a.time_to_pass = {-300.0, 0.0, 300.0, 600.0, 900.0, 1200.0};
+    a.heading = {0.0, 90.0, 180.0, 270.0, 360.0};
+    return a;
+}
+
+double uniform(std::mt19937& rng, const std::vector<double>& axis) {
+    return std::uniform_real_distribution<double>(axis.front(), axis.back())(rng);
+}
+
+void check(const InterceptTable& table, int samples) {
+    using clock = std::chrono::steady_clock;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const InterceptAxes& axes = table.axes();
+
+    int feasible = 0, converged = 0;
+    double delay_error = 0.0, lookup_s = 0.0, solve_s = 0.0;
+    for (int i = 0; i < samples; i++) {
+        InterceptGeometry g;
+        g.altitude = uniform(rng, axes.altitude);
+        g.cross_range = uniform(rng, axes.cross_range);
+        g.time_to_pass = uniform(rng, axes.time_to_pass);
+        g.heading = uniform(rng, axes.heading);
+        const sim::LaunchSite site{table.weapon().site_latitude, 360.0 * unit(rng) - 180.0, 0.0};
+        const double jd = InterceptTable::REFERENCE_JD + 30.0 * unit(rng);
+        const sim::StateVector threat =
+            intercept_threat_state(site.compute_eci_state(jd).position, g);
+
+        auto t0 = clock::now();
+        const InterceptLookup x = table.lookup(
+            intercept_geometry(site.compute_eci_state(jd).position, threat.position,
+                               threat.velocity));
+        auto t1 = clock::now();
+        lookup_s += std::chrono::duration<double>(t1 - t0).count();
+        if (x.feasibility < InterceptTable::SHOOT_FEASIBILITY) continue;
+        feasible++;
+
+        const sim::LaunchTrajectorySolution sol = refine_intercept(table, site, jd, threat);
+        solve_s += std::chrono::duration<double>(clock::now() - t1).count();
+        if (!sol.converged) continue;
+        converged++;
+        delay_error += std::abs(sol.controls.epoch_offset - x.launch_delay);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Check: " << samples << " geometries, " << feasible << " feasible by the table, "
+              << converged << " confirmed by a full solve\n";
+    if (converged > 0) {
+        std::cout << "  mean |solved - table launch delay|: " << delay_error / converged << " s\n";
+    }
+    std::cout << std::setprecision(2)
+              << "  lookup: " << 1e6 * lookup_s / std::max(samples, 1) << " us"
+              << "   full solve: " << 1e3 * solve_s / std::max(feasible, 1) << " ms\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output_dir, table_path;
+    InterceptWeapon weapon;
+    weapon.name = "direct_ascent";
+    weapon.vehicle = demo_vehicle();
+    int threads = 0;
+    int check_samples = 0;
+    bool coarse = false;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_next = i + 1 < argc;
+            if (arg == "--output" && has_next) {
+                output_dir = argv[++i];
+            } else if (arg == "--name" && has_next) {
+                weapon.name = argv[++i];
+            } else if (arg == "--lat" && has_next) {
+                weapon.site_latitude = std::stod(argv[++i]);
+            } else if (arg == "--threads" && has_next) {
+                threads = std::stoi(argv[++i]);
+            } else if (arg == "--max-delay" && has_next) {
+                weapon.max_delay = std::stod(argv[++i]);
+            } else if (arg == "--max-tof" && has_next) {
+                weapon.max_tof = std::stod(argv[++i]);
+            } else if (arg == "--coarse") {
+                coarse = true;
+            } else if (arg == "--table" && has_next) {
+                table_path = argv[++i];
+            } else if (arg == "--check" && has_next) {
+                check_samples = std::stoi(argv[++i]);
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: bad argument value (" << e.what() << ")\n";
+        return 1;
+    }
+    if (output_dir.empty() == table_path.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (std::abs(weapon.site_latitude) > 80.0 || weapon.max_delay < 0.0 || weapon.max_tof <= 0.0) {
+        std::cerr << "Error: --lat must be within 80 deg, --max-delay >= 0, --max-tof > 0\n";
+        return 1;
+    }
+
+    try {
+        InterceptTable table;
+        if (!table_path.empty()) {
+            table = InterceptTable::read(table_path);
+        } else {
+            if (::mkdir(output_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                std::cerr << "Error: cannot create " << output_dir << "\n";
+                return 1;
+            }
+            const InterceptAxes axes = coarse ? coarse_axes() : InterceptAxes::defaults();
+            auto t0 = std::chrono::steady_clock::now();
+            table = generate_intercept(weapon, axes, threads);
+            double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            size_t feasible = 0;
+            for (size_t a = 0; a < axes.altitude.size(); a++)
+                for (size_t c = 0; c < axes.cross_range.size(); c++)
+                    for (size_t p = 0; p < axes.time_to_pass.size(); p++)
+                        for (size_t h = 0; h < axes.heading.size(); h++) {
+                            InterceptGeometry g{axes.altitude[a], axes.cross_range[c],
+                                                axes.time_to_pass[p], axes.heading[h]};
+                            feasible += table.lookup(g).feasibility >=
+                                        InterceptTable::SHOOT_FEASIBILITY;
+                        }
+            const std::string path = output_dir + "/" + weapon.name + ".ixt";
+            table.write(path);
+            std::cout << weapon.name << ": " << table.cells() << " cells, " << feasible
+                      << " feasible, " << std::fixed << std::setprecision(1) << s << " s -> "
+                      << path << "\n";
+        }
+        if (check_samples > 0) check(table, check_samples);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
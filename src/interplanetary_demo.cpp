@@ -24,6 +24,7 @@
 #include "physics/interplanetary_planner.hpp"
 #include "physics/mars_atmosphere.hpp"
 #include "physics/nbody_gravity.hpp"
+#include "physics/soi_event_calendar.hpp"
 #include "physics/gravity_assist.hpp"
 #include "physics/mission_sequence.hpp"
 #include "physics/celestial_body.hpp"
@@ -377,6 +378,27 @@ int main() {
         std::cout << "and other bodies not captured in the two-body Lambert solution.\n";
     }
 
+    // Mars SOI entry located on the integrator's dense output, then the
+    // switch to a Mars-centered frame at the boundary itself
+    SoiEventCalendar soi_calendar(nbody_config, launch_jd);
+    StateVector cruise = initial_hci;
+    SoiEvent soi_event;
+    if (soi_calendar.propagate_to_next(cruise, tof + 30.0 * 86400.0, adapt_config, &soi_event) &&
+        soi_event.entry) {
+        double soi_jd = launch_jd + soi_event.time / 86400.0;
+        StateVector mars_centered =
+            NBodyGravity::hci_to_body_centered(soi_event.state, soi_event.body, soi_jd);
+        const auto& calendar_stats = soi_calendar.stats();
+        std::cout << "\n" << planet_to_string(soi_event.body) << " SOI entry: day "
+                  << std::setprecision(3) << soi_event.time / 86400.0
+                  << ", r = " << std::setprecision(0) << mars_centered.position.norm() / 1e3
+                  << " km, v = " << std::setprecision(2)
+                  << mars_centered.velocity.norm() / 1e3 << " km/s\n";
+        std::cout << "  " << calendar_stats.checks << " SOI checks over "
+                  << calendar_stats.steps << " steps (" << calendar_stats.skipped
+                  << " body-steps skipped)\n";
+    }
+
     // ═══════════════════════════════════════════════════════════
     // Phase 6: Mars Atmosphere Check
     // ═══════════════════════════════════════════════════════════
@@ -0,0 +1,157 @@
+#include "io/async_output.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace sim {
+
+AsyncFileBuf::~AsyncFileBuf() {
+    close();
+}
+
+bool AsyncFileBuf::open(const std::string& filename, size_t buffer_bytes, size_t num_buffers) {
+    if (is_open()) close();
+
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) return false;
+
+    buffer_bytes_ = buffer_bytes > 0 ? buffer_bytes : DEFAULT_BUFFER_BYTES;
+    ring_.clear();
+    ring_.resize(num_buffers >= 2 ? num_buffers : 2);
+    for (auto& b : ring_) b.data.reset(new char[buffer_bytes_]);
+
+    submitted_.store(0);
+    completed_.store(0);
+    stop_.store(false);
+    failed_.store(false);
+    stats_ = AsyncOutputStats{};
+
+    char* p = current().data.get();
+    setp(p, p + buffer_bytes_);
+    writer_ = std::thread(&AsyncFileBuf::writer_loop, this);
+    return true;
+}
+
+bool AsyncFileBuf::close() {
+    if (!is_open()) return true;
+
+    hand_off();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true);
+    }
+    work_ready_.notify_one();
+    writer_.join();
+
+    bool ok = !failed_.load();
+    if (::close(fd_) != 0) ok = false;
+    fd_ = -1;
+    ring_.clear();
+    setp(nullptr, nullptr);
+    return ok;
+}
+
+void AsyncFileBuf::hand_off() {
+    Buffer& b = current();
+    b.used = static_cast<size_t>(pptr() - pbase());
+    if (b.used > 0) {
+        stats_.bytes += b.used;
+        stats_.buffers++;
+        submitted_.fetch_add(1, std::memory_order_release);
+        // The writer re-checks submitted_ under the mutex before sleeping,
+        // so taking it here cannot lose the wake-up.
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        work_ready_.notify_one();
+
+        // Back-pressure: every buffer is queued or being written
+        const uint64_t size = ring_.size();
+        if (submitted_.load(std::memory_order_relaxed) -
+                completed_.load(std::memory_order_acquire) >= size) {
+            auto t0 = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex_);
+            slot_free_.wait(lock, [&] {
+                return submitted_.load(std::memory_order_relaxed) -
+                           completed_.load(std::memory_order_acquire) < size;
+            });
+            stats_.stalls++;
+            stats_.stall_seconds +=
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+    }
+    char* p = current().data.get();
+    setp(p, p + buffer_bytes_);
+}
+
+void AsyncFileBuf::writer_loop() {
+    for (;;) {
+        uint64_t done = completed_.load(std::memory_order_relaxed);
+        if (done == submitted_.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_ready_.wait(lock, [&] {
+                return stop_.load() || done != submitted_.load(std::memory_order_acquire);
+            });
+            if (done == submitted_.load(std::memory_order_acquire)) return;   // Stopped and drained
+        }
+
+        const Buffer& b = ring_[done % ring_.size()];
+        const char* p = b.data.get();
+        size_t left = b.used;
+        while (left > 0 && !failed_.load(std::memory_order_relaxed)) {
+            ssize_t n = ::write(fd_, p, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                failed_.store(true);
+                break;
+            }
+            p += n;
+            left -= static_cast<size_t>(n);
+        }
+
+        completed_.store(done + 1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        slot_free_.notify_one();
+    }
+}
+
+AsyncFileBuf::int_type AsyncFileBuf::overflow(int_type ch) {
+    if (!is_open()) return traits_type::eof();
+    hand_off();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return failed_.load(std::memory_order_relaxed) ? traits_type::eof()
+                                                   : traits_type::not_eof(ch);
+}
+
+std::streamsize AsyncFileBuf::xsputn(const char* s, std::streamsize n) {
+    if (!is_open()) return 0;
+    std::streamsize written = 0;
+    while (written < n) {
+        std::streamsize room = epptr() - pptr();
+        if (room == 0) {
+            hand_off();
+            continue;
+        }
+        std::streamsize chunk = std::min(room, n - written);
+        std::memcpy(pptr(), s + written, static_cast<size_t>(chunk));
+        pbump(static_cast<int>(chunk));
+        written += chunk;
+    }
+    return failed_.load(std::memory_order_relaxed) ? 0 : written;
+}
+
+int AsyncFileBuf::sync() {
+    if (!is_open()) return -1;
+    hand_off();
+    return failed_.load(std::memory_order_relaxed) ? -1 : 0;
+}
+
+}  // namespace sim
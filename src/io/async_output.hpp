@@ -0,0 +1,151 @@
+/**
+ * Async Output - Double-buffered background file writer
+ *
+ * An ostream (AsyncOFStream) whose bytes are written to disk by a
+ * background thread, so exporters that format into a stream overlap
+ * formatting with I/O instead of blocking in write(2). The caller fills
+ * one buffer while the writer thread drains the others; a buffer is
+ * handed over when it is full, on flush() and on close().
+ *
+ * Hand-off is a bounded single-producer / single-consumer ring of
+ * num_buffers buffers (2 = double buffering) indexed by two atomic
+ * counters; neither side takes a lock unless it must sleep (the writer on
+ * an empty ring, the caller on a full one). A full ring is back-pressure:
+ * the disk is slower than the formatting. Such waits are counted in
+ * stats(), which exporters report with their progress output.
+ *
+ * Bytes reach the file in order and unchanged, so an AsyncOFStream can
+ * stand in for a std::ofstream opened in binary mode.
+ *
+ * Usage:
+ *   AsyncOFStream out("results.json");
+ *   JsonWriter w(out);                 // Or out << ...
+ *   ...
+ *   out.close();                       // Drains; false on write errors
+ *   out.stats().stalls;                // Times the caller waited for the disk
+ */
+
+#ifndef SIM_ASYNC_OUTPUT_HPP
+#define SIM_ASYNC_OUTPUT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim {
+
+struct AsyncOutputStats {
+    uint64_t bytes = 0;            // Handed to the writer thread
+    uint64_t buffers = 0;          // Hand-offs
+    uint64_t stalls = 0;           // Hand-offs that waited for a free buffer
+    double stall_seconds = 0.0;    // Time spent waiting
+};
+
+class AsyncFileBuf : public std::streambuf {
+public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 1 << 20;
+    static constexpr size_t DEFAULT_NUM_BUFFERS = 2;
+
+    AsyncFileBuf() = default;
+    ~AsyncFileBuf() override;
+
+    AsyncFileBuf(const AsyncFileBuf&) = delete;
+    AsyncFileBuf& operator=(const AsyncFileBuf&) = delete;
+
+    /**
+     * Create (truncate) filename and start the writer thread
+     * @return true on success
+     */
+    bool open(const std::string& filename, size_t buffer_bytes = DEFAULT_BUFFER_BYTES,
+              size_t num_buffers = DEFAULT_NUM_BUFFERS);
+
+    /**
+     * Hand over the open buffer, wait for the writer and close the file
+     * @return true if every byte was written
+     */
+    bool close();
+
+    bool is_open() const { return fd_ >= 0; }
+
+    /** Snapshot of the hand-off counters (caller thread) */
+    AsyncOutputStats stats() const { return stats_; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    struct Buffer {
+        std::unique_ptr<char[]> data;
+        size_t used = 0;
+    };
+
+    int fd_ = -1;
+    size_t buffer_bytes_ = 0;
+    std::vector<Buffer> ring_;
+
+    // Ring counters: buffers handed over / written. The caller fills
+    // ring_[submitted_ % size] once submitted_ - completed_ < size.
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> failed_{false};
+
+    std::mutex mutex_;                    // Sleeping only
+    std::condition_variable work_ready_;  // Writer: a buffer was handed over
+    std::condition_variable slot_free_;   // Caller: a buffer was written
+    std::thread writer_;
+
+    AsyncOutputStats stats_;
+
+    Buffer& current() { return ring_[submitted_.load(std::memory_order_relaxed) % ring_.size()]; }
+    void hand_off();       // Submit the current buffer, then wait for a free one
+    void writer_loop();
+};
+
+/** std::ostream over an AsyncFileBuf */
+class AsyncOFStream : public std::ostream {
+public:
+    AsyncOFStream() : std::ostream(&buf_) {}
+    explicit AsyncOFStream(const std::string& filename,
+                           size_t buffer_bytes = AsyncFileBuf::DEFAULT_BUFFER_BYTES,
+                           size_t num_buffers = AsyncFileBuf::DEFAULT_NUM_BUFFERS)
+        : std::ostream(&buf_) {
+        open(filename, buffer_bytes, num_buffers);
+    }
+
+    bool open(const std::string& filename,
+              size_t buffer_bytes = AsyncFileBuf::DEFAULT_BUFFER_BYTES,
+              size_t num_buffers = AsyncFileBuf::DEFAULT_NUM_BUFFERS) {
+        bool ok = buf_.open(filename, buffer_bytes, num_buffers);
+        if (ok) clear();
+        else setstate(std::ios::failbit);
+        return ok;
+    }
+
+    /** @return true if every byte was written */
+    bool close() {
+        bool ok = buf_.close();
+        if (!ok) setstate(std::ios::failbit);
+        return ok;
+    }
+
+    bool is_open() const { return buf_.is_open(); }
+    AsyncOutputStats stats() const { return buf_.stats(); }
+
+private:
+    AsyncFileBuf buf_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_ASYNC_OUTPUT_HPP
@@ -0,0 +1,183 @@
+/**
+ * Catalog Snapshot Implementation
+ */
+
+#include "catalog_snapshot.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace sim {
+
+namespace {
+
+size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+template <typename T>
+void put(std::string& out, const std::vector<T>& column) {
+    out.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    out.resize(padded(out.size()), '\0');
+}
+
+// Reads columns from a loaded file, tracking bounds
+struct Cursor {
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+
+    template <typename T>
+    bool get(std::vector<T>& column, size_t count, bool align = true) {
+        size_t bytes = count * sizeof(T);
+        if (pos + bytes > size) return false;
+        column.resize(count);
+        if (bytes > 0) std::memcpy(column.data(), data + pos, bytes);
+        pos = align ? padded(pos + bytes) : pos + bytes;
+        return true;
+    }
+};
+
+uint64_t fnv1a(const void* data, size_t bytes, uint64_t h = 1469598103934665603ull) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+} // anonymous namespace
+
+void CatalogSnapshot::resize(size_t n) {
+    names.resize(n);
+    norad.resize(n);
+    orbit_type.resize(n);
+    tle_hash.resize(n);
+    lat.resize(n);
+    lon.resize(n);
+    alt.resize(n);
+    elements.resize(snap::NUM_ELEMENTS * n);
+    track.resize(static_cast<size_t>(track_steps) * n * 3);
+}
+
+void CatalogSnapshot::copy_row(size_t i, const CatalogSnapshot& other, size_t j) {
+    const size_t n = size(), m = other.size();
+    names[i] = other.names[j];
+    norad[i] = other.norad[j];
+    orbit_type[i] = other.orbit_type[j];
+    tle_hash[i] = other.tle_hash[j];
+    lat[i] = other.lat[j];
+    lon[i] = other.lon[j];
+    alt[i] = other.alt[j];
+    for (int k = 0; k < snap::NUM_ELEMENTS; k++) elements[k * n + i] = other.elements[k * m + j];
+    for (size_t s = 0; s < track_steps; s++) {
+        for (int c = 0; c < 3; c++) track[(s * n + i) * 3 + c] = other.track[(s * m + j) * 3 + c];
+    }
+}
+
+bool CatalogSnapshot::save(const std::string& filename) const {
+    const size_t n = size();
+
+    std::vector<uint32_t> name_end(n);
+    uint32_t names_bytes = 0;
+    for (size_t i = 0; i < n; i++) {
+        names_bytes += static_cast<uint32_t>(names[i].size());
+        name_end[i] = names_bytes;
+    }
+
+    snap::Header header{};
+    std::memcpy(header.magic, snap::MAGIC, 4);
+    header.version = snap::VERSION;
+    header.count = static_cast<uint32_t>(n);
+    header.track_steps = track_steps;
+    header.epoch_jd = epoch_jd;
+    header.propagate_s = propagate_s;
+    header.track_step_s = track_step_s;
+    header.names_bytes = names_bytes;
+
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.reserve(sizeof(header) + n * (4 + 1 + 8 + 24 + 24 + 4) + names_bytes + track.size() * 4 + 64);
+    put(out, norad);
+    put(out, orbit_type);
+    put(out, tle_hash);
+    put(out, lat);
+    put(out, lon);
+    put(out, alt);
+    put(out, elements);
+    out.append(reinterpret_cast<const char*>(name_end.data()), n * sizeof(uint32_t));
+    for (const auto& name : names) out += name;
+    out.resize(padded(out.size()), '\0');
+    put(out, track);
+
+    const std::string tmp = filename + ".tmp";
+    std::FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CatalogSnapshot::load(const std::string& filename) {
+    *this = CatalogSnapshot();
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if (!file.read(&data[0], static_cast<std::streamsize>(data.size()))) return false;
+
+    snap::Header header;
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, snap::MAGIC, 4) != 0 || header.version != snap::VERSION) {
+        return false;
+    }
+
+    CatalogSnapshot s;
+    s.epoch_jd = header.epoch_jd;
+    s.propagate_s = header.propagate_s;
+    s.track_step_s = header.track_step_s;
+    s.track_steps = header.track_steps;
+
+    const size_t n = header.count;
+    Cursor in{data.data(), data.size(), sizeof(header)};
+    std::vector<uint32_t> name_end;
+    std::vector<char> name_bytes;
+    bool ok = in.get(s.norad, n) && in.get(s.orbit_type, n) && in.get(s.tle_hash, n) &&
+              in.get(s.lat, n) && in.get(s.lon, n) && in.get(s.alt, n) &&
+              in.get(s.elements, snap::NUM_ELEMENTS * n) &&
+              in.get(name_end, n, false) && in.get(name_bytes, header.names_bytes) &&
+              in.get(s.track, static_cast<size_t>(header.track_steps) * n * 3) &&
+              in.pos == data.size();
+    if (!ok) return false;
+
+    s.names.resize(n);
+    uint32_t begin = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (name_end[i] < begin || name_end[i] > header.names_bytes) return false;
+        s.names[i].assign(name_bytes.data() + begin, name_end[i] - begin);
+        begin = name_end[i];
+    }
+
+    *this = std::move(s);
+    return true;
+}
+
+uint64_t CatalogSnapshot::hash(const TLE& tle) {
+    const double reals[] = {
+        tle.epoch_day, tle.mean_motion_derivative, tle.mean_motion_second_derivative,
+        tle.bstar_drag, tle.inclination, tle.raan, tle.eccentricity,
+        tle.arg_perigee, tle.mean_anomaly, tle.mean_motion
+    };
+    const int32_t ints[] = {
+        tle.satellite_number, tle.epoch_year, tle.element_set_number, tle.revolution_number
+    };
+    uint64_t h = fnv1a(tle.name.data(), tle.name.size());
+    h = fnv1a(reals, sizeof(reals), h);
+    return fnv1a(ints, sizeof(ints), h);
+}
+
+}  // namespace sim
@@ -0,0 +1,110 @@
+/**
+ * Catalog Snapshot - Binary satellite catalog export (".bin")
+ *
+ * Typed-array companion to export_all_sats' all_sats.json: one column per
+ * field, every section aligned to 8 bytes so a browser can view each one
+ * as a Float64Array / Float32Array / Int32Array in place
+ * (visualization/cesium/js/catalog_snapshot.js). The file also carries a
+ * hash of every satellite's TLE, so the next export can reuse the rows of
+ * satellites whose elements did not change.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header   snap::Header (64 bytes)
+ *   i32      norad[n]
+ *   u8       orbit_type[n]            0 LEO, 1 MEO, 2 GEO
+ *   u64      tle_hash[n]
+ *   f64      lat[n], lon[n]  [deg], alt[n]  [m]
+ *   f32      elements[6][n]            a [m], e, i, raan, argp, nu [rad]
+ *   u32      name_end[n], then names_bytes bytes; satellite k owns
+ *            [name_end[k-1], name_end[k])
+ *   f32      track[track_steps][n][3]  ECEF [m] at
+ *                                      epoch_jd + (propagate_s + s*step)/86400
+ *
+ * Usage:
+ *   CatalogSnapshot snap;
+ *   if (snap.load("all_sats.bin") && snap.matches(other)) { ... }
+ */
+
+#ifndef SIM_CATALOG_SNAPSHOT_HPP
+#define SIM_CATALOG_SNAPSHOT_HPP
+
+#include "io/tle_parser.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+namespace snap {
+
+constexpr char MAGIC[4] = {'S', 'A', 'T', 'B'};
+constexpr uint32_t VERSION = 1;
+constexpr int NUM_ELEMENTS = 6;
+
+enum OrbitType : uint8_t { LEO = 0, MEO = 1, GEO = 2 };
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t track_steps;     // 0 = no track
+    double   epoch_jd;        // Reference epoch of the exported catalog
+    double   propagate_s;     // Catalog advanced this long before export [s]
+    double   track_step_s;    // Track sample spacing [s]
+    uint32_t names_bytes;
+    uint32_t reserved[5];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "catalog snapshot header layout");
+
+} // namespace snap
+
+struct CatalogSnapshot {
+    double epoch_jd = 0.0;
+    double propagate_s = 0.0;
+    double track_step_s = 0.0;
+    uint32_t track_steps = 0;
+
+    std::vector<std::string> names;
+    std::vector<int32_t> norad;
+    std::vector<uint8_t> orbit_type;
+    std::vector<uint64_t> tle_hash;
+    std::vector<double> lat, lon, alt;
+    std::vector<float> elements;   // [element][satellite]
+    std::vector<float> track;      // [step][satellite][xyz]
+
+    size_t size() const { return norad.size(); }
+
+    /** Size every column for n satellites */
+    void resize(size_t n);
+
+    /** Same epoch, propagation and track sampling (rows are interchangeable) */
+    bool matches(const CatalogSnapshot& other) const {
+        return epoch_jd == other.epoch_jd && propagate_s == other.propagate_s &&
+               track_step_s == other.track_step_s && track_steps == other.track_steps;
+    }
+
+    /** Copy satellite j of other into row i (other must match()) */
+    void copy_row(size_t i, const CatalogSnapshot& other, size_t j);
+
+    /**
+     * Write the snapshot (to "<file>.tmp", then renamed over file)
+     * @return true on success
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * Read a snapshot written by save()
+     * @return true on success; false leaves the snapshot empty
+     */
+    bool load(const std::string& filename);
+
+    /** Hash of a TLE's name and elements (FNV-1a) */
+    static uint64_t hash(const TLE& tle);
+};
+
+}  // namespace sim
+
+#endif  // SIM_CATALOG_SNAPSHOT_HPP
@@ -5,6 +5,7 @@
 #include "checkpoint.hpp"
 #include "json_writer.hpp"
 #include "json_reader.hpp"
+#include "json_stream.hpp"
 #include "core/simulation_engine.hpp"
 #include "entities/entity.hpp"
 #include "entities/satellite.hpp"
@@ -205,9 +206,37 @@ bool Checkpoint::save(const SimulationEngine& engine, const std::string& filenam
 }
 
 bool Checkpoint::load(const std::string& filename, SimulationEngine& engine) {
-    JsonValue root;
+    // Entities are restored as their elements stream past, so the file is
+    // never held as a whole tree; they join the engine after the checks
+    std::vector<std::shared_ptr<Entity>> entities;
+    JsonRootStreamer root;
+    root.stream_array("entities", [&entities](const JsonValue& ej, size_t i) {
+        std::string type = ej["type"].get_string("Entity");
+        int id = ej["id"].get_int(static_cast<int>(i));
+        std::string name = ej["name"].get_string("Unknown");
+
+        auto entity = create_entity(type, id, name);
+        if (!entity) return;
+
+        // Restore state
+        if (ej.has("state")) {
+            entity->set_state(read_state_vector(ej["state"]));
+        }
+
+        // Restore domain
+        entity->set_physics_domain(
+            string_to_domain(ej["domain"].get_string("GROUND")));
+
+        // Type-specific restoration
+        if (ej.has("entity_data")) {
+            entity->deserialize_entity(ej["entity_data"]);
+        }
+
+        entities.push_back(std::move(entity));
+    });
+
     try {
-        root = JsonReader::parse_file(filename);
+        JsonStreamReader::parse_file(filename, root);
     } catch (const std::exception& e) {
         std::cerr << "[Checkpoint] Parse error: " << e.what() << "\n";
         return false;
@@ -232,39 +261,11 @@ bool Checkpoint::load(const std::string& filename, SimulationEngine& engine) {
     // Clear existing entities and load from checkpoint
     // Note: We can't remove entities by ID easily, so we need to access the engine differently.
     // For now, we assume the engine starts fresh for loading.
-
-    // Load entities
-    const auto& entities_json = root["entities"];
-    int loaded = 0;
-    for (size_t i = 0; i < entities_json.size(); i++) {
-        const auto& ej = entities_json[i];
-
-        std::string type = ej["type"].get_string("Entity");
-        int id = ej["id"].get_int(static_cast<int>(i));
-        std::string name = ej["name"].get_string("Unknown");
-
-        auto entity = create_entity(type, id, name);
-        if (!entity) continue;
-
-        // Restore state
-        if (ej.has("state")) {
-            entity->set_state(read_state_vector(ej["state"]));
-        }
-
-        // Restore domain
-        entity->set_physics_domain(
-            string_to_domain(ej["domain"].get_string("GROUND")));
-
-        // Type-specific restoration
-        if (ej.has("entity_data")) {
-            entity->deserialize_entity(ej["entity_data"]);
-        }
-
+    for (auto& entity : entities) {
         engine.add_entity(entity);
-        loaded++;
     }
 
-    std::cout << "[Checkpoint] Loaded " << loaded
+    std::cout << "[Checkpoint] Loaded " << entities.size()
               << " entities from " << filename << "\n";
     return true;
 }
@@ -68,6 +68,14 @@ public:
      */
     static bool load(const std::string& filename, SimulationEngine& engine);
 
+    /**
+     * Entity factory: create an entity from its entity_type() string
+     * (shared with BinaryCheckpoint). Unknown types become CommandModule
+     * placeholders.
+     */
+    static std::shared_ptr<Entity> create_entity(
+        const std::string& type, int id, const std::string& name);
+
 private:
     // Serialize a StateVector to JSON
     static void write_state_vector(JsonWriter& w, const StateVector& s);
@@ -78,10 +86,6 @@ private:
     // Serialize a single entity
     static void write_entity(JsonWriter& w, const Entity& entity);
 
-    // Entity factory: create entity from type string
-    static std::shared_ptr<Entity> create_entity(
-        const std::string& type, int id, const std::string& name);
-
     // Frame name conversions
     static std::string frame_to_string(CoordinateFrame frame);
     static CoordinateFrame string_to_frame(const std::string& s);
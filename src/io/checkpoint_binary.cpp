@@ -0,0 +1,564 @@
+/**
+ * Binary Checkpoint Implementation
+ */
+
+#include "checkpoint_binary.hpp"
+#include "checkpoint.hpp"
+#include "json_reader.hpp"
+#include "json_writer.hpp"
+#include "core/simulation_engine.hpp"
+#include "entities/entity.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim {
+
+// ─────────────────────────────────────────────────────────────
+// Checksums
+// ─────────────────────────────────────────────────────────────
+
+namespace ckpt {
+
+uint32_t crc32(const void* data, size_t bytes, uint32_t crc) {
+    // Slicing-by-8 tables: t[k][b] is the CRC of byte b followed by k zeros
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(8 * 256);
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) t[k * 256 + i] = (t[(k - 1) * 256 + i] >> 8) ^ t[t[(k - 1) * 256 + i] & 0xFF];
+        }
+        return t;
+    }();
+    const uint32_t* t = table.data();
+
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7 * 256 + (lo & 0xFF)] ^ t[6 * 256 + ((lo >> 8) & 0xFF)] ^
+              t[5 * 256 + ((lo >> 16) & 0xFF)] ^ t[4 * 256 + (lo >> 24)] ^
+              t[3 * 256 + (hi & 0xFF)] ^ t[2 * 256 + ((hi >> 8) & 0xFF)] ^
+              t[1 * 256 + ((hi >> 16) & 0xFF)] ^ t[hi >> 24];
+    }
+    for (; bytes > 0; bytes--, p++) crc = t[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+} // namespace ckpt
+
+namespace {
+
+constexpr size_t NUM_STATE_COLUMNS = 14;
+
+uint64_t fnv1a(const void* data, size_t bytes, uint64_t h = 1469598103934665603ull) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// State in column order
+void state_columns(const StateVector& s, double out[NUM_STATE_COLUMNS]) {
+    const double v[NUM_STATE_COLUMNS] = {
+        s.time,
+        s.position.x, s.position.y, s.position.z,
+        s.velocity.x, s.velocity.y, s.velocity.z,
+        s.attitude.w, s.attitude.x, s.attitude.y, s.attitude.z,
+        s.angular_velocity.x, s.angular_velocity.y, s.angular_velocity.z
+    };
+    std::memcpy(out, v, sizeof(v));
+}
+
+StateVector state_from_columns(const double v[NUM_STATE_COLUMNS], CoordinateFrame frame) {
+    StateVector s;
+    s.time = v[0];
+    s.position = Vec3(v[1], v[2], v[3]);
+    s.velocity = Vec3(v[4], v[5], v[6]);
+    s.attitude = Quat(v[7], v[8], v[9], v[10]);
+    s.angular_velocity = Vec3(v[11], v[12], v[13]);
+    s.frame = frame;
+    return s;
+}
+
+// serialize_entity() as compact JSON objects, through one writer
+class EntityDataWriter {
+public:
+    EntityDataWriter() : writer_(os_, JsonWriter::COMPACT) { writer_.set_precision(0); }
+
+    std::string operator()(const Entity& entity) {
+        os_.str(std::string());
+        writer_.begin_object();
+        entity.serialize_entity(writer_);
+        writer_.end_object();   // A complete top-level value is flushed to os_
+        return os_.str();
+    }
+
+private:
+    std::ostringstream os_;
+    JsonWriter writer_;
+};
+
+// Output buffer with 8-byte section padding
+class Buffer {
+public:
+    std::vector<char> bytes;
+
+    template <typename T>
+    void put(const T& v) { put_bytes(&v, sizeof(T)); }
+
+    void put_bytes(const void* data, size_t n) {
+        size_t at = bytes.size();
+        bytes.resize(at + n);
+        if (n > 0) std::memcpy(bytes.data() + at, data, n);
+    }
+
+    void pad() { bytes.resize((bytes.size() + 7) & ~size_t(7), 0); }
+};
+
+// Read-only mapping of a whole file (read into memory when not mappable)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { if (mapping_) munmap(mapping_, size_); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::close(fd);
+                mapping_ = p;
+                size_ = static_cast<size_t>(st.st_size);
+                data_ = static_cast<const char*>(p);
+                return true;
+            }
+        }
+        char chunk[65536];
+        ssize_t n;
+        while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) copy_.insert(copy_.end(), chunk, chunk + n);
+        ::close(fd);
+        data_ = copy_.data();
+        size_ = copy_.size();
+        return n == 0;
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void* mapping_ = nullptr;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<char> copy_;
+};
+
+// Validated sections of one mapped checkpoint
+struct FileView {
+    ckpt::Header header;
+    std::vector<std::string> types;
+    const char* ids = nullptr;           // i32[n]
+    const char* type_index = nullptr;    // u32[n]
+    const char* domains = nullptr;       // u8[n]
+    const char* frames = nullptr;        // u8[n]
+    const char* state = nullptr;         // f64[14][n]
+    const char* name_end = nullptr;      // u32[n]
+    const char* data_end = nullptr;      // u32[n]
+    const char* names = nullptr;
+    const char* data = nullptr;
+    const char* removed = nullptr;       // i32[num_removed]
+
+    template <typename T>
+    static T at(const char* column, size_t i) {
+        T v;
+        std::memcpy(&v, column + i * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    int id(size_t i) const { return at<int32_t>(ids, i); }
+    int removed_id(size_t i) const { return at<int32_t>(removed, i); }
+
+    std::string_view name(size_t i) const {
+        uint32_t begin = i ? at<uint32_t>(name_end, i - 1) : 0;
+        return std::string_view(names + begin, at<uint32_t>(name_end, i) - begin);
+    }
+
+    std::string_view entity_data(size_t i) const {
+        uint32_t begin = i ? at<uint32_t>(data_end, i - 1) : 0;
+        return std::string_view(data + begin, at<uint32_t>(data_end, i) - begin);
+    }
+
+    StateVector state_vector(size_t i) const {
+        size_t n = header.num_entities;
+        double v[NUM_STATE_COLUMNS];
+        for (size_t c = 0; c < NUM_STATE_COLUMNS; c++) {
+            v[c] = at<double>(state, c * n + i);
+        }
+        uint8_t f = at<uint8_t>(frames, i);
+        CoordinateFrame frame = f <= static_cast<uint8_t>(CoordinateFrame::PLANET_CENTERED)
+                                ? static_cast<CoordinateFrame>(f) : CoordinateFrame::J2000_ECI;
+        return state_from_columns(v, frame);
+    }
+
+    PhysicsDomain domain(size_t i) const {
+        uint8_t d = at<uint8_t>(domains, i);
+        return d <= static_cast<uint8_t>(PhysicsDomain::ORBITAL)
+               ? static_cast<PhysicsDomain>(d) : PhysicsDomain::GROUND;
+    }
+};
+
+// Bounds-checked walk over the payload
+class Cursor {
+public:
+    Cursor(const char* begin, const char* end) : p_(begin), end_(end) {}
+
+    const char* take(size_t bytes) {
+        if (static_cast<size_t>(end_ - p_) < bytes) return nullptr;
+        const char* out = p_;
+        p_ += bytes;
+        return out;
+    }
+
+    bool align(const char* base) {
+        size_t off = static_cast<size_t>(p_ - base);
+        return take(((off + 7) & ~size_t(7)) - off) != nullptr;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+bool parse_file(const MappedFile& file, FileView& view, std::string& error) {
+    if (file.size() < sizeof(ckpt::Header)) { error = "truncated header"; return false; }
+    std::memcpy(&view.header, file.data(), sizeof(ckpt::Header));
+    ckpt::Header& h = view.header;
+
+    if (std::memcmp(h.magic, ckpt::MAGIC, 4) != 0) { error = "not a binary checkpoint"; return false; }
+    if (h.version != ckpt::VERSION) {
+        error = "unsupported version " + std::to_string(h.version);
+        return false;
+    }
+    ckpt::Header zeroed = h;
+    zeroed.header_crc = 0;
+    if (ckpt::crc32(&zeroed, sizeof(zeroed)) != h.header_crc) { error = "header checksum mismatch"; return false; }
+    if (h.payload_bytes != file.size() - sizeof(ckpt::Header)) { error = "payload size mismatch"; return false; }
+
+    const char* base = file.data() + sizeof(ckpt::Header);
+    const size_t payload = static_cast<size_t>(h.payload_bytes);
+    if (ckpt::crc32(base, payload) != h.payload_crc) { error = "payload checksum mismatch"; return false; }
+
+    const size_t n = h.num_entities;
+    Cursor cur(base, base + payload);
+    bool ok = true;
+
+    // Type registry
+    view.types.clear();
+    for (uint32_t t = 0; t < h.num_types && ok; t++) {
+        const char* len = cur.take(sizeof(uint32_t));
+        if (!len) { ok = false; break; }
+        uint32_t length = FileView::at<uint32_t>(len, 0);
+        const char* name = cur.take(length);
+        if (!name) { ok = false; break; }
+        view.types.emplace_back(name, length);
+    }
+    ok = ok && cur.align(base);
+
+    // Entity and state columns
+    ok = ok && (view.ids = cur.take(n * sizeof(int32_t)));
+    ok = ok && (view.type_index = cur.take(n * sizeof(uint32_t)));
+    ok = ok && (view.domains = cur.take(n));
+    ok = ok && (view.frames = cur.take(n));
+    ok = ok && cur.align(base);
+    ok = ok && (view.state = cur.take(NUM_STATE_COLUMNS * n * sizeof(double)));
+
+    // Strings
+    ok = ok && (view.name_end = cur.take(n * sizeof(uint32_t)));
+    ok = ok && (view.data_end = cur.take(n * sizeof(uint32_t)));
+    if (ok) {
+        uint32_t name_bytes = n ? FileView::at<uint32_t>(view.name_end, n - 1) : 0;
+        uint32_t data_bytes = n ? FileView::at<uint32_t>(view.data_end, n - 1) : 0;
+        ok = (view.names = cur.take(name_bytes)) && (view.data = cur.take(data_bytes));
+        for (size_t i = 1; i < n && ok; i++) {
+            ok = FileView::at<uint32_t>(view.name_end, i - 1) <= FileView::at<uint32_t>(view.name_end, i) &&
+                 FileView::at<uint32_t>(view.data_end, i - 1) <= FileView::at<uint32_t>(view.data_end, i);
+        }
+    }
+    ok = ok && cur.align(base);
+
+    // Removed ids
+    ok = ok && (view.removed = cur.take(h.num_removed * sizeof(int32_t)));
+
+    for (size_t i = 0; i < n && ok; i++) {
+        ok = FileView::at<uint32_t>(view.type_index, i) < view.types.size();
+    }
+    if (!ok) error = "corrupt section table";
+    return ok;
+}
+
+} // anonymous namespace
+
+// ─────────────────────────────────────────────────────────────
+// Save
+// ─────────────────────────────────────────────────────────────
+
+bool BinaryCheckpoint::save(const SimulationEngine& engine, const std::string& filename) {
+    return write(engine, filename, false);
+}
+
+bool BinaryCheckpoint::save_incremental(const SimulationEngine& engine, const std::string& filename) {
+    return write(engine, filename, have_base_);
+}
+
+bool BinaryCheckpoint::write(const SimulationEngine& engine, const std::string& filename, bool delta) {
+    struct Record {
+        const Entity* entity;
+        uint32_t type;
+        std::string data;
+    };
+
+    const auto& entities = engine.get_all_entities();
+    std::vector<std::string> types;
+    std::unordered_map<std::string, uint32_t> type_ids;
+    std::vector<Record> records;
+    std::unordered_map<int, uint64_t> hashes;
+    hashes.reserve(entities.size());
+    EntityDataWriter entity_data;
+
+    // Records, skipping unchanged entities in a delta
+    for (const auto& e : entities) {
+        std::string type = e->entity_type();
+        std::string data = entity_data(*e);
+        double columns[NUM_STATE_COLUMNS];
+        state_columns(e->get_state(), columns);
+        uint8_t codes[2] = {static_cast<uint8_t>(e->get_physics_domain()),
+                            static_cast<uint8_t>(e->get_state().frame)};
+
+        uint64_t h = fnv1a(type.data(), type.size());
+        h = fnv1a(e->get_name().data(), e->get_name().size() + 1, h);
+        h = fnv1a(columns, sizeof(columns), h);
+        h = fnv1a(codes, sizeof(codes), h);
+        h = fnv1a(data.data(), data.size(), h);
+        hashes[e->get_id()] = h;
+
+        if (delta) {
+            auto it = hashes_.find(e->get_id());
+            if (it != hashes_.end() && it->second == h) continue;
+        }
+
+        auto t = type_ids.find(type);
+        if (t == type_ids.end()) {
+            t = type_ids.emplace(type, static_cast<uint32_t>(types.size())).first;
+            types.push_back(type);
+        }
+        records.push_back({e.get(), t->second, std::move(data)});
+    }
+
+    std::vector<int32_t> removed;
+    if (delta) {
+        for (const auto& [id, h] : hashes_) {
+            if (hashes.find(id) == hashes.end()) removed.push_back(id);
+        }
+        std::sort(removed.begin(), removed.end());
+    }
+
+    // Payload
+    const size_t n = records.size();
+    Buffer buf;
+    buf.bytes.reserve(sizeof(ckpt::Header) + n * (NUM_STATE_COLUMNS * 8 + 48));
+    buf.bytes.resize(sizeof(ckpt::Header), 0);
+
+    for (const auto& t : types) {
+        buf.put(static_cast<uint32_t>(t.size()));
+        buf.put_bytes(t.data(), t.size());
+    }
+    buf.pad();
+
+    for (const auto& r : records) buf.put(static_cast<int32_t>(r.entity->get_id()));
+    for (const auto& r : records) buf.put(r.type);
+    for (const auto& r : records) buf.put(static_cast<uint8_t>(r.entity->get_physics_domain()));
+    for (const auto& r : records) buf.put(static_cast<uint8_t>(r.entity->get_state().frame));
+    buf.pad();
+
+    std::vector<double> columns(NUM_STATE_COLUMNS * n);
+    for (size_t i = 0; i < n; i++) {
+        double v[NUM_STATE_COLUMNS];
+        state_columns(records[i].entity->get_state(), v);
+        for (size_t c = 0; c < NUM_STATE_COLUMNS; c++) columns[c * n + i] = v[c];
+    }
+    buf.put_bytes(columns.data(), columns.size() * sizeof(double));
+
+    uint32_t end = 0;
+    for (const auto& r : records) buf.put(end += static_cast<uint32_t>(r.entity->get_name().size()));
+    end = 0;
+    for (const auto& r : records) buf.put(end += static_cast<uint32_t>(r.data.size()));
+    for (const auto& r : records) buf.put_bytes(r.entity->get_name().data(), r.entity->get_name().size());
+    for (const auto& r : records) buf.put_bytes(r.data.data(), r.data.size());
+    buf.pad();
+
+    buf.put_bytes(removed.data(), removed.size() * sizeof(int32_t));
+
+    // Header
+    uint64_t sequence = have_base_ ? sequence_ + 1 : 0;
+    ckpt::Header h;
+    std::memcpy(h.magic, ckpt::MAGIC, 4);
+    h.version = ckpt::VERSION;
+    h.flags = delta ? ckpt::FLAG_DELTA : 0;
+    h.num_types = static_cast<uint32_t>(types.size());
+    h.sequence = sequence;
+    h.base_sequence = delta ? sequence_ : sequence;
+    h.sim_time = engine.get_simulation_time();
+    h.time_scale = engine.get_time_scale();
+    h.mode = static_cast<uint32_t>(engine.get_mode());
+    h.num_entities = static_cast<uint32_t>(n);
+    h.num_removed = static_cast<uint32_t>(removed.size());
+    h.reserved = 0;
+    h.payload_bytes = buf.bytes.size() - sizeof(ckpt::Header);
+    h.payload_crc = ckpt::crc32(buf.bytes.data() + sizeof(ckpt::Header), h.payload_bytes);
+    h.header_crc = 0;
+    h.header_crc = ckpt::crc32(&h, sizeof(h));
+    std::memcpy(buf.bytes.data(), &h, sizeof(h));
+
+    // One write to a temporary file, then an atomic rename
+    std::string tmp = filename + ".tmp";
+    FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) {
+        std::cerr << "[Checkpoint] Cannot open file for writing: " << tmp << "\n";
+        return false;
+    }
+    bool ok = std::fwrite(buf.bytes.data(), 1, buf.bytes.size(), file) == buf.bytes.size();
+    ok = std::fflush(file) == 0 && ok;
+    ok = ::fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        std::cerr << "[Checkpoint] Write failed: " << filename << "\n";
+        return false;
+    }
+
+    sequence_ = sequence;
+    hashes_ = std::move(hashes);
+    have_base_ = true;
+    last_records_ = n;
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────
+// Load
+// ─────────────────────────────────────────────────────────────
+
+bool BinaryCheckpoint::load(const std::string& filename, SimulationEngine& engine) {
+    return load_series({filename}, engine);
+}
+
+bool BinaryCheckpoint::load_series(const std::vector<std::string>& filenames, SimulationEngine& engine) {
+    if (filenames.empty()) return false;
+
+    std::vector<std::unique_ptr<MappedFile>> files;
+    std::vector<FileView> views(filenames.size());
+    for (size_t f = 0; f < filenames.size(); f++) {
+        files.push_back(std::make_unique<MappedFile>());
+        std::string error;
+        if (!files.back()->open(filenames[f])) {
+            error = "cannot open file";
+        } else if (parse_file(*files.back(), views[f], error)) {
+            const ckpt::Header& h = views[f].header;
+            bool is_delta = (h.flags & ckpt::FLAG_DELTA) != 0;
+            if (f == 0 && is_delta) {
+                error = "series starts with an incremental checkpoint";
+            } else if (f > 0 && (!is_delta || h.base_sequence != views[f - 1].header.sequence)) {
+                error = "not the next checkpoint of the series";
+            }
+        }
+        if (!error.empty()) {
+            std::cerr << "[Checkpoint] " << filenames[f] << ": " << error << "\n";
+            return false;
+        }
+    }
+
+    // Latest record of every live entity, in first-seen order
+    struct Slot {
+        size_t file, record;
+        bool removed;
+    };
+    std::vector<Slot> slots;
+    std::unordered_map<int, size_t> slot_of;
+    for (size_t f = 0; f < views.size(); f++) {
+        const FileView& v = views[f];
+        for (size_t i = 0; i < v.header.num_removed; i++) {
+            auto it = slot_of.find(v.removed_id(i));
+            if (it == slot_of.end()) continue;
+            slots[it->second].removed = true;
+            slot_of.erase(it);
+        }
+        for (size_t i = 0; i < v.header.num_entities; i++) {
+            auto it = slot_of.find(v.id(i));
+            if (it != slot_of.end()) {
+                slots[it->second] = {f, i, false};
+            } else {
+                slot_of.emplace(v.id(i), slots.size());
+                slots.push_back({f, i, false});
+            }
+        }
+    }
+
+    // Entities first, so a failing deserialize leaves the engine untouched
+    std::vector<std::shared_ptr<Entity>> entities;
+    entities.reserve(slot_of.size());
+    try {
+        for (const Slot& s : slots) {
+            if (s.removed) continue;
+            const FileView& v = views[s.file];
+            size_t i = s.record;
+            auto entity = Checkpoint::create_entity(
+                v.types[FileView::at<uint32_t>(v.type_index, i)], v.id(i), std::string(v.name(i)));
+            if (!entity) continue;
+
+            entity->set_state(v.state_vector(i));
+            entity->set_physics_domain(v.domain(i));
+            std::string_view data = v.entity_data(i);
+            if (data != "{}") {
+                entity->deserialize_entity(JsonReader::parse(std::string(data)));
+            }
+            entities.push_back(std::move(entity));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[Checkpoint] Entity data error: " << e.what() << "\n";
+        return false;
+    }
+
+    const ckpt::Header& last = views.back().header;
+    engine.set_simulation_time(last.sim_time);
+    engine.set_mode(last.mode == static_cast<uint32_t>(SimulationMode::SIMULATION_MODE)
+                    ? SimulationMode::SIMULATION_MODE : SimulationMode::MODEL_MODE);
+    engine.set_time_scale(last.time_scale);
+    for (auto& entity : entities) {
+        engine.add_entity(entity);
+    }
+
+    std::cout << "[Checkpoint] Loaded " << entities.size()
+              << " entities from " << filenames.back() << "\n";
+    return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,190 @@
+/**
+ * CZML Streaming Writer Implementation
+ */
+
+#include "czml_writer.hpp"
+#include "coordinate/time_utils.hpp"
+#include <cmath>
+
+namespace sim {
+
+CzmlWriter::CzmlWriter(const std::string& filename, const std::string& name, double epoch_jd,
+                       const CzmlOptions& options)
+    : options_(options), epoch_jd_(epoch_jd) {
+    if (options_.chunk_seconds <= 0.0) options_.chunk_seconds = 3600.0;
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) return;
+    json_.reset(new JsonWriter(file_, JsonWriter::COMPACT));
+    json_->set_precision(options_.precision);
+    epoch_ = TimeUtils::jd_to_iso8601(epoch_jd);
+
+    std::fputs("[\n", file_);
+    json_->begin_object();
+    json_->kv("id", "document");
+    json_->kv("name", name);
+    json_->kv("version", "1.0");
+    json_->end_object();
+}
+
+CzmlWriter::~CzmlWriter() {
+    close();
+}
+
+size_t CzmlWriter::add_entity(const CzmlEntity& entity) {
+    Track track;
+    track.id = entity.id;
+    tracks_.push_back(track);
+    if (!file_) return tracks_.size() - 1;
+
+    auto color = [&](uint8_t alpha) {
+        json_->key("rgba").begin_array();
+        for (int c = 0; c < 3; c++) json_->value(static_cast<int>(entity.rgba[c]));
+        json_->value(static_cast<int>(alpha));
+        json_->end_array();
+    };
+
+    begin_packet(entity.id);
+    json_->kv("name", entity.name.empty() ? entity.id : entity.name);
+    if (!entity.description.empty()) json_->kv("description", entity.description);
+    if (entity.point_size > 0.0) {
+        json_->key("point").begin_object();
+        json_->kv("pixelSize", entity.point_size);
+        json_->key("color").begin_object();
+        color(entity.rgba[3]);
+        json_->end_object();
+        json_->end_object();
+    }
+    if (entity.label) {
+        json_->key("label").begin_object();
+        json_->kv("text", entity.name.empty() ? entity.id : entity.name);
+        json_->kv("font", "11px sans-serif");
+        json_->key("fillColor").begin_object();
+        color(entity.rgba[3]);
+        json_->end_object();
+        json_->key("pixelOffset").begin_object();
+        json_->key("cartesian2").begin_array().value(10.0).value(0.0).end_array();
+        json_->end_object();
+        json_->end_object();
+    }
+    if (entity.path) {
+        json_->key("path").begin_object();
+        json_->kv("width", 1.5);
+        json_->kv("leadTime", entity.lead_time);
+        if (entity.trail_time > 0.0) json_->kv("trailTime", entity.trail_time);
+        json_->key("material").begin_object();
+        json_->key("solidColor").begin_object();
+        json_->key("color").begin_object();
+        color(static_cast<uint8_t>(entity.rgba[3] * 0.6));
+        json_->end_object();
+        json_->end_object();
+        json_->end_object();
+        json_->end_object();
+    }
+    end_packet();
+    return tracks_.size() - 1;
+}
+
+void CzmlWriter::add_sample(size_t entity, double t, const Vec3& position) {
+    if (!file_ || entity >= tracks_.size()) return;
+    Track& track = tracks_[entity];
+
+    int64_t window = static_cast<int64_t>(std::floor(t / options_.chunk_seconds));
+    if (track.has_sample && window != track.window) flush_window(track);
+    track.window = window;
+
+    if (!has_time_) {
+        t_min_ = t_max_ = t;
+        has_time_ = true;
+    }
+    t_min_ = std::min(t_min_, t);
+    t_max_ = std::max(t_max_, t);
+
+    // Thinning: keep a sample once min_sample_interval has passed, and hold
+    // the latest skipped one so a window always ends on its last sample
+    if (track.has_sample && !track.pending.empty() &&
+        t - track.last_t < options_.min_sample_interval) {
+        track.held[0] = t;
+        track.held[1] = position.x;
+        track.held[2] = position.y;
+        track.held[3] = position.z;
+        track.has_held = true;
+        return;
+    }
+    track.pending.insert(track.pending.end(), {t, position.x, position.y, position.z});
+    track.last_t = t;
+    track.has_sample = true;
+    track.has_held = false;
+}
+
+void CzmlWriter::set_fixed_position(size_t entity, const Vec3& ecef) {
+    if (!file_ || entity >= tracks_.size()) return;
+    begin_packet(tracks_[entity].id);
+    json_->key("position").begin_object();
+    json_->key("cartesian").begin_array().value(ecef.x).value(ecef.y).value(ecef.z).end_array();
+    json_->end_object();
+    end_packet();
+}
+
+void CzmlWriter::flush_window(Track& track) {
+    if (track.has_held) {
+        track.pending.insert(track.pending.end(), track.held, track.held + 4);
+        track.last_t = track.held[0];
+        track.has_held = false;
+    }
+    if (track.pending.empty()) return;
+
+    begin_packet(track.id);
+    json_->key("position").begin_object();
+    json_->kv("epoch", epoch_);
+    json_->kv("interpolationAlgorithm", "LAGRANGE");
+    json_->kv("interpolationDegree", options_.interpolation_degree);
+    json_->kv("referenceFrame", options_.inertial ? "INERTIAL" : "FIXED");
+    json_->key("cartesian").begin_array();
+    for (double v : track.pending) json_->value(v);
+    json_->end_array();
+    json_->end_object();
+    end_packet();
+
+    samples_written_ += track.pending.size() / 4;
+    track.pending.clear();
+}
+
+void CzmlWriter::close() {
+    if (!file_) return;
+    for (auto& track : tracks_) flush_window(track);
+
+    // Clock over the sampled span (a later document packet updates the first)
+    begin_packet("document");
+    if (has_time_) {
+        json_->key("clock").begin_object();
+        json_->kv("interval", iso_time(t_min_) + "/" + iso_time(t_max_));
+        json_->kv("currentTime", iso_time(t_min_));
+        json_->kv("multiplier", options_.clock_multiplier);
+        json_->kv("range", "LOOP_STOP");
+        json_->kv("step", "SYSTEM_CLOCK_MULTIPLIER");
+        json_->end_object();
+    }
+    end_packet();
+
+    json_->flush();
+    std::fputs("\n]\n", file_);
+    std::fclose(file_);
+    file_ = nullptr;
+    json_.reset();
+}
+
+void CzmlWriter::begin_packet(const std::string& id) {
+    std::fputs(",\n", file_);
+    json_->begin_object();
+    json_->kv("id", id);
+}
+
+void CzmlWriter::end_packet() {
+    json_->end_object();
+}
+
+std::string CzmlWriter::iso_time(double t) const {
+    return TimeUtils::jd_to_iso8601(epoch_jd_ + t / TimeUtils::SECONDS_PER_DAY);
+}
+
+}  // namespace sim
@@ -0,0 +1,124 @@
+/**
+ * CZML Streaming Writer
+ *
+ * Writes trajectories as CZML while they are being propagated, instead
+ * of collecting them and serializing at the end. Each entity's samples
+ * are held only for the current time window (CzmlOptions::chunk_seconds)
+ * and then written as one packet carrying a compact cartesian array
+ * [t, x, y, z, ...] with Lagrange interpolation hints, so the viewer can
+ * draw smooth paths from sparse samples. Cesium merges the packets of an
+ * entity into one sampled position.
+ *
+ * The file is a CZML array with one packet per line: a document packet,
+ * one packet per entity (static properties), the position chunks in
+ * time order, and a closing document packet with the clock interval.
+ * Viewers can load it whole (Cesium.CzmlDataSource.load) or line by line
+ * as it arrives (js/czml_stream.js).
+ *
+ * Usage:
+ *   CzmlWriter czml("tour.czml", "Satellite Tour", TimeUtils::J2000_EPOCH_JD);
+ *   size_t chase = czml.add_entity({"chase", "Chase Vehicle"});
+ *   for (...) czml.add_sample(chase, t, state.position);
+ *   czml.close();
+ */
+
+#ifndef SIM_CZML_WRITER_HPP
+#define SIM_CZML_WRITER_HPP
+
+#include "core/state_vector.hpp"
+#include "io/json_writer.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/// Options for CzmlWriter
+struct CzmlOptions {
+    double chunk_seconds = 3600.0;        // Time window of one position packet [s]
+    double min_sample_interval = 0.0;     // Samples closer than this are dropped [s]
+    int interpolation_degree = 5;         // Lagrange degree hint
+    bool inertial = true;                 // Positions are ECI (else ECEF)
+    int precision = 10;                   // Significant digits of coordinates
+    double clock_multiplier = 60.0;       // Playback speed of the document clock
+};
+
+/// Static presentation of a CZML entity
+struct CzmlEntity {
+    std::string id;
+    std::string name;
+    std::array<uint8_t, 4> rgba = {255, 255, 255, 255};
+    double point_size = 8.0;              // [px], 0 = no point
+    bool label = true;
+    bool path = true;                     // Draw the trajectory
+    double trail_time = 0.0;              // Path trailing the entity [s], 0 = whole path
+    double lead_time = 0.0;
+    std::string description;              // HTML shown in the info box
+};
+
+class CzmlWriter {
+public:
+    /**
+     * Open a CZML file and write the document packet.
+     * @param epoch_jd Julian date of t = 0 (sample times are seconds from it)
+     */
+    CzmlWriter(const std::string& filename, const std::string& name, double epoch_jd,
+               const CzmlOptions& options = CzmlOptions());
+    ~CzmlWriter();
+
+    CzmlWriter(const CzmlWriter&) = delete;
+    CzmlWriter& operator=(const CzmlWriter&) = delete;
+
+    bool is_open() const { return file_ != nullptr; }
+
+    /** Declare an entity. @return Its handle for add_sample() */
+    size_t add_entity(const CzmlEntity& entity);
+
+    /**
+     * Record an entity's position at t [s from epoch]; times must not
+     * decrease. Also writes the entity's finished windows.
+     */
+    void add_sample(size_t entity, double t, const Vec3& position);
+
+    /** Give an entity a constant Earth-fixed position [m] (no samples) */
+    void set_fixed_position(size_t entity, const Vec3& ecef);
+
+    /** Write the remaining windows and the closing document packet */
+    void close();
+
+    /** Samples written so far (after min_sample_interval thinning) */
+    size_t samples_written() const { return samples_written_; }
+
+private:
+    struct Track {
+        std::string id;
+        std::vector<double> pending;      // t, x, y, z runs of the open window
+        int64_t window = 0;
+        double last_t = 0.0;
+        bool has_sample = false;
+        double held[4] = {0, 0, 0, 0};    // Latest thinned-out sample
+        bool has_held = false;
+    };
+
+    std::FILE* file_ = nullptr;
+    std::unique_ptr<JsonWriter> json_;
+    CzmlOptions options_;
+    std::string epoch_;
+    double epoch_jd_ = 0.0;
+    std::vector<Track> tracks_;
+    double t_min_ = 0.0, t_max_ = 0.0;
+    bool has_time_ = false;
+    size_t samples_written_ = 0;
+
+    void flush_window(Track& track);
+    void begin_packet(const std::string& id);
+    void end_packet();
+    std::string iso_time(double t) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_CZML_WRITER_HPP
@@ -6,8 +6,14 @@
 #include <fstream>
 #include <sstream>
 #include <cctype>
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace sim {
 
@@ -17,28 +23,93 @@ namespace sim {
 
 namespace {
 
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decode the body of a string that contains escapes (validated by the parser)
+std::string decode_escapes(const char* s, size_t n) {
+    std::string result;
+    result.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        char c = s[i];
+        if (c != '\\') {
+            result += c;
+            continue;
+        }
+        char esc = s[++i];
+        switch (esc) {
+            case '"':  result += '"'; break;
+            case '\\': result += '\\'; break;
+            case '/':  result += '/'; break;
+            case 'b':  result += '\b'; break;
+            case 'f':  result += '\f'; break;
+            case 'n':  result += '\n'; break;
+            case 'r':  result += '\r'; break;
+            case 't':  result += '\t'; break;
+            case 'u': {
+                // Unicode escape: \uXXXX — simplified to ASCII
+                unsigned long code = 0;
+                for (int k = 0; k < 4; k++) {
+                    int h = hex_value(s[i + 1 + k]);
+                    if (h < 0) break;
+                    code = code * 16 + h;
+                }
+                i += 4;
+                if (code < 128) {
+                    result += static_cast<char>(code);
+                } else {
+                    // UTF-8 encode (simplified: BMP only)
+                    if (code < 0x800) {
+                        result += static_cast<char>(0xC0 | (code >> 6));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        result += static_cast<char>(0xE0 | (code >> 12));
+                        result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        result += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                }
+                break;
+            }
+        }
+    }
+    return result;
+}
+
 class Parser {
 public:
-    explicit Parser(const std::string& input) : src_(input), pos_(0) {}
+    explicit Parser(JsonDocument& doc)
+        : doc_(doc), src_(doc.data()), size_(doc.size()), pos_(0) {}
 
-    JsonValue parse() {
+    void parse() {
         skip_whitespace();
-        JsonValue val = parse_value();
+        parse_value(doc_.mutable_root());
         skip_whitespace();
-        return val;
     }
 
 private:
-    const std::string& src_;
+    JsonDocument& doc_;
+    const char* src_;
+    size_t size_;
     size_t pos_;
 
+    // Children of the arrays / objects being parsed, moved to the arena
+    // when each one closes
+    std::vector<JsonNode> elements_;
+    std::vector<JsonMember> members_;
+
     char peek() const {
-        if (pos_ >= src_.size()) return '\0';
+        if (pos_ >= size_) return '\0';
         return src_[pos_];
     }
 
     char advance() {
-        if (pos_ >= src_.size()) throw error("Unexpected end of input");
+        if (pos_ >= size_) throw error("Unexpected end of input");
         return src_[pos_++];
     }
 
@@ -49,8 +120,12 @@ private:
         }
     }
 
+    bool match(const char* word, size_t n) const {
+        return pos_ + n <= size_ && std::memcmp(src_ + pos_, word, n) == 0;
+    }
+
     void skip_whitespace() {
-        while (pos_ < src_.size() && std::isspace(static_cast<unsigned char>(src_[pos_]))) {
+        while (pos_ < size_ && std::isspace(static_cast<unsigned char>(src_[pos_]))) {
             pos_++;
         }
     }
@@ -60,85 +135,64 @@ private:
                                   std::to_string(pos_) + ": " + msg);
     }
 
-    JsonValue parse_value() {
+    void parse_value(JsonNode& out) {
         skip_whitespace();
         char c = peek();
 
-        if (c == '"') return parse_string_value();
-        if (c == '{') return parse_object();
-        if (c == '[') return parse_array();
-        if (c == 't' || c == 'f') return parse_bool();
-        if (c == 'n') return parse_null();
-        if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) return parse_number();
+        if (c == '"') return parse_string(out);
+        if (c == '{') return parse_object(out);
+        if (c == '[') return parse_array(out);
+        if (c == 't' || c == 'f') return parse_bool(out);
+        if (c == 'n') return parse_null(out);
+        if (c == '-' || is_digit(c)) return parse_number(out);
 
         throw error(std::string("Unexpected character: '") + c + "'");
     }
 
-    JsonValue parse_string_value() {
-        return JsonValue(parse_string());
-    }
-
-    std::string parse_string() {
+    // String body as a view into the input; escapes are validated here and
+    // decoded when the string is read
+    void parse_string(JsonNode& out) {
         expect('"');
-        std::string result;
+        size_t start = pos_;
+        bool escaped = false;
         while (true) {
-            if (pos_ >= src_.size()) throw error("Unterminated string");
+            if (pos_ >= size_) throw error("Unterminated string");
             char c = src_[pos_++];
 
             if (c == '"') break;
 
             if (c == '\\') {
-                if (pos_ >= src_.size()) throw error("Unterminated escape");
+                if (pos_ >= size_) throw error("Unterminated escape");
+                escaped = true;
                 char esc = src_[pos_++];
                 switch (esc) {
-                    case '"':  result += '"'; break;
-                    case '\\': result += '\\'; break;
-                    case '/':  result += '/'; break;
-                    case 'b':  result += '\b'; break;
-                    case 'f':  result += '\f'; break;
-                    case 'n':  result += '\n'; break;
-                    case 'r':  result += '\r'; break;
-                    case 't':  result += '\t'; break;
-                    case 'u': {
-                        // Unicode escape: \uXXXX — simplified to ASCII
-                        if (pos_ + 4 > src_.size()) throw error("Incomplete \\u escape");
-                        std::string hex = src_.substr(pos_, 4);
+                    case '"': case '\\': case '/': case 'b':
+                    case 'f': case 'n': case 'r': case 't':
+                        break;
+                    case 'u':
+                        if (pos_ + 4 > size_) throw error("Incomplete \\u escape");
                         pos_ += 4;
-                        unsigned long code = std::strtoul(hex.c_str(), nullptr, 16);
-                        if (code < 128) {
-                            result += static_cast<char>(code);
-                        } else {
-                            // UTF-8 encode (simplified: BMP only)
-                            if (code < 0x800) {
-                                result += static_cast<char>(0xC0 | (code >> 6));
-                                result += static_cast<char>(0x80 | (code & 0x3F));
-                            } else {
-                                result += static_cast<char>(0xE0 | (code >> 12));
-                                result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
-                                result += static_cast<char>(0x80 | (code & 0x3F));
-                            }
-                        }
                         break;
-                    }
                     default:
                         throw error(std::string("Unknown escape: \\") + esc);
                 }
-            } else {
-                result += c;
             }
         }
-        return result;
+        out.type = JsonType::STRING;
+        out.escaped = escaped;
+        out.count = static_cast<uint32_t>(pos_ - 1 - start);
+        out.string = src_ + start;
     }
 
-    JsonValue parse_number() {
+    void parse_number(JsonNode& out) {
         size_t start = pos_;
         if (peek() == '-') pos_++;
 
         // Integer part
         if (peek() == '0') {
             pos_++;
-        } else if (std::isdigit(static_cast<unsigned char>(peek()))) {
-            while (std::isdigit(static_cast<unsigned char>(peek()))) pos_++;
+        } else if (is_digit(peek())) {
+            while (is_digit(peek())) pos_++;
         } else {
             throw error("Expected digit in number");
         }
@@ -146,66 +200,83 @@ private:
         // Fractional part
         if (peek() == '.') {
             pos_++;
-            if (!std::isdigit(static_cast<unsigned char>(peek()))) {
+            if (!is_digit(peek())) {
                 throw error("Expected digit after decimal point");
             }
-            while (std::isdigit(static_cast<unsigned char>(peek()))) pos_++;
+            while (is_digit(peek())) pos_++;
         }
 
         // Exponent
         if (peek() == 'e' || peek() == 'E') {
             pos_++;
             if (peek() == '+' || peek() == '-') pos_++;
-            if (!std::isdigit(static_cast<unsigned char>(peek()))) {
+            if (!is_digit(peek())) {
                 throw error("Expected digit in exponent");
             }
-            while (std::isdigit(static_cast<unsigned char>(peek()))) pos_++;
+            while (is_digit(peek())) pos_++;
         }
 
-        std::string numstr = src_.substr(start, pos_ - start);
-        double val = std::strtod(numstr.c_str(), nullptr);
-        return JsonValue(val);
+        double val = 0.0;
+        auto res = std::from_chars(src_ + start, src_ + pos_, val);
+        if (res.ec == std::errc::result_out_of_range) {
+            // Overflow / underflow: strtod's inf or zero
+            std::string numstr(src_ + start, pos_ - start);
+            val = std::strtod(numstr.c_str(), nullptr);
+        }
+        out.type = JsonType::NUMBER;
+        out.number = val;
     }
 
-    JsonValue parse_bool() {
-        if (src_.compare(pos_, 4, "true") == 0) {
+    void parse_bool(JsonNode& out) {
+        if (match("true", 4)) {
             pos_ += 4;
-            return JsonValue(true);
+            out.type = JsonType::BOOL;
+            out.boolean = true;
+            return;
         }
-        if (src_.compare(pos_, 5, "false") == 0) {
+        if (match("false", 5)) {
             pos_ += 5;
-            return JsonValue(false);
+            out.type = JsonType::BOOL;
+            out.boolean = false;
+            return;
         }
         throw error("Expected 'true' or 'false'");
     }
 
-    JsonValue parse_null() {
-        if (src_.compare(pos_, 4, "null") == 0) {
+    void parse_null(JsonNode& out) {
+        if (match("null", 4)) {
             pos_ += 4;
-            return JsonValue();
+            out = JsonNode();
+            return;
         }
         throw error("Expected 'null'");
     }
 
-    JsonValue parse_object() {
+    void parse_object(JsonNode& out) {
         expect('{');
-        JsonValue obj;
-        obj.set_object();
+        const size_t base = members_.size();
+        out.type = JsonType::OBJECT;
 
         skip_whitespace();
         if (peek() == '}') {
             pos_++;
-            return obj;
+            out.count = 0;
+            out.members = nullptr;
+            return;
         }
 
         while (true) {
             skip_whitespace();
-            std::string key = parse_string();
+            JsonNode key;
+            if (peek() != '"') expect('"');
+            parse_string(key);
             skip_whitespace();
             expect(':');
             skip_whitespace();
-            JsonValue val = parse_value();
-            obj.add_member(key, std::move(val));
+            JsonMember member;
+            member.key = intern_key(key);
+            parse_value(member.value);
+            members_.push_back(member);
 
             skip_whitespace();
             if (peek() == ',') {
@@ -217,23 +288,32 @@ private:
 
         skip_whitespace();
         expect('}');
-        return obj;
+
+        size_t unique = members_.size() - base;
+        const JsonMember* stored = doc_.store_members(members_.data() + base, unique);
+        members_.resize(base);
+        out.count = static_cast<uint32_t>(unique);
+        out.members = stored;
     }
 
-    JsonValue parse_array() {
+    void parse_array(JsonNode& out) {
         expect('[');
-        JsonValue arr;
-        arr.set_array();
+        const size_t base = elements_.size();
+        out.type = JsonType::ARRAY;
 
         skip_whitespace();
         if (peek() == ']') {
             pos_++;
-            return arr;
+            out.count = 0;
+            out.elements = nullptr;
+            return;
         }
 
         while (true) {
             skip_whitespace();
-            arr.add_element(parse_value());
+            JsonNode element;
+            parse_value(element);
+            elements_.push_back(element);
 
             skip_whitespace();
             if (peek() == ',') {
@@ -245,30 +325,159 @@ private:
 
         skip_whitespace();
         expect(']');
-        return arr;
+
+        const size_t n = elements_.size() - base;
+        const JsonNode* stored = doc_.store_elements(elements_.data() + base, n);
+        elements_.resize(base);
+        out.count = static_cast<uint32_t>(n);
+        out.elements = stored;
+    }
+
+    // Object keys are compared, so escaped keys are decoded into the arena
+    std::string_view intern_key(const JsonNode& key) {
+        if (!key.escaped) return std::string_view(key.string, key.count);
+        return doc_.store_string(decode_escapes(key.string, key.count));
     }
 };
 
+JsonValue parse_document(std::shared_ptr<JsonDocument> doc) {
+    Parser parser(*doc);
+    parser.parse();
+    const JsonNode* root = doc->root();
+    return JsonValue(std::shared_ptr<const JsonDocument>(std::move(doc)), root);
+}
+
 }  // anonymous namespace
 
 // ═══════════════════════════════════════════════════════════════
-// Public API
+// Document and values
 // ═══════════════════════════════════════════════════════════════
 
-JsonValue JsonReader::parse(const std::string& json) {
-    Parser parser(json);
-    return parser.parse();
+JsonDocument::~JsonDocument() {
+    if (mapping_) munmap(mapping_, mapping_size_);
+    memory_account(MemoryTag::JSON_DOM).release(charged_);
 }
 
-JsonValue JsonReader::parse_file(const std::string& filename) {
+void JsonDocument::set_text(std::string text) {
+    memory_account(MemoryTag::JSON_DOM).charge(text.size());
+    memory_account(MemoryTag::JSON_DOM).release(text_.size());
+    charged_ += text.size() - text_.size();
+    text_ = std::move(text);
+    data_ = text_.data();
+    size_ = text_.size();
+}
+
+void JsonDocument::map_file(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open JSON file: " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::close(fd);
+            mapping_ = p;
+            mapping_size_ = static_cast<size_t>(st.st_size);
+            data_ = static_cast<const char*>(p);
+            size_ = mapping_size_;
+            return;
+        }
+    }
+    ::close(fd);
+
+    // Not mappable (empty, pipe, ...): read it
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open JSON file: " + filename);
     }
-
     std::ostringstream ss;
     ss << file.rdbuf();
-    return parse(ss.str());
+    set_text(ss.str());
+}
+
+const JsonNode* JsonDocument::store_elements(const JsonNode* elements, size_t count) {
+    JsonNode* stored = allocate<JsonNode>(count);
+    std::uninitialized_copy(elements, elements + count, stored);
+    return stored;
+}
+
+const JsonMember* JsonDocument::store_members(JsonMember* members, size_t& count) {
+    // Sorted by key; a repeated key keeps its last value
+    std::stable_sort(members, members + count,
+                     [](const JsonMember& a, const JsonMember& b) { return a.key < b.key; });
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i + 1 < count && members[i + 1].key == members[i].key) continue;
+        members[unique++] = members[i];
+    }
+    count = unique;
+
+    JsonMember* stored = allocate<JsonMember>(unique);
+    std::uninitialized_copy(members, members + unique, stored);
+    return stored;
+}
+
+std::string_view JsonDocument::store_string(std::string_view text) {
+    char* stored = allocate<char>(text.size());
+    std::memcpy(stored, text.data(), text.size());
+    return std::string_view(stored, text.size());
+}
+
+JsonValue::JsonValue(bool v) : type(JsonType::BOOL) {
+    inline_.type = JsonType::BOOL;
+    inline_.boolean = v;
+}
+
+JsonValue::JsonValue(double v) : type(JsonType::NUMBER) {
+    inline_.type = JsonType::NUMBER;
+    inline_.number = v;
+}
+
+JsonValue::JsonValue(const std::string& v) : JsonValue(std::string(v)) {}
+
+JsonValue::JsonValue(std::string&& v) : type(JsonType::STRING) {
+    auto doc = std::make_shared<JsonDocument>();
+    doc->set_text(std::move(v));
+    inline_.type = JsonType::STRING;
+    inline_.count = static_cast<uint32_t>(doc->size());
+    inline_.string = doc->data();
+    doc_ = std::move(doc);
+}
+
+const JsonMember* JsonValue::find(std::string_view key) const {
+    if (type != JsonType::OBJECT) return nullptr;
+    const JsonNode& n = node();
+    const JsonMember* end = n.members + n.count;
+    const JsonMember* it = std::lower_bound(n.members, end, key,
+        [](const JsonMember& m, std::string_view k) { return m.key < k; });
+    return (it != end && it->key == key) ? it : nullptr;
+}
+
+std::string JsonValue::unescape(const JsonNode& n) {
+    if (!n.escaped) return std::string(n.string, n.count);
+    return decode_escapes(n.string, n.count);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Public API
+// ═══════════════════════════════════════════════════════════════
+
+JsonValue JsonReader::parse(const std::string& json) {
+    return parse(std::string(json));
+}
+
+JsonValue JsonReader::parse(std::string&& json) {
+    auto doc = std::make_shared<JsonDocument>();
+    doc->set_text(std::move(json));
+    return parse_document(std::move(doc));
+}
+
+JsonValue JsonReader::parse_file(const std::string& filename) {
+    auto doc = std::make_shared<JsonDocument>();
+    doc->map_file(filename);
+    return parse_document(std::move(doc));
 }
 
 }  // namespace sim
@@ -5,6 +5,15 @@
  * Handles objects, arrays, strings, numbers (including scientific notation),
  * booleans, and null. No external dependencies.
  *
+ * The tree is a compact document: parse_file() memory-maps the input,
+ * nodes are allocated from an arena owned by the document, strings are
+ * views into the input (unescaped when read), objects are flat arrays of
+ * members sorted by key, and numbers are parsed with std::from_chars.
+ * A JsonValue is a handle that shares ownership of its document, so a
+ * subtree stays valid after the root is gone. Arena blocks and owned
+ * input text are charged to MemoryTag::JSON_DOM (mapped input is not:
+ * its pages are file-backed).
+ *
  * Usage:
  *   auto root = JsonReader::parse_file("state.json");
  *   double time = root["sim_time"].as_number();
@@ -14,15 +23,20 @@
 #ifndef SIM_JSON_READER_HPP
 #define SIM_JSON_READER_HPP
 
-#include <string>
-#include <vector>
-#include <unordered_map>
+#include "utils/memory_accounting.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace sim {
 
-enum class JsonType {
+enum class JsonType : uint8_t {
     NIL,
     BOOL,
     NUMBER,
@@ -31,16 +45,49 @@ enum class JsonType {
     ARRAY
 };
 
+struct JsonMember;
+class JsonDocument;
+class JsonObjectRange;
+class JsonArrayRange;
+
+/**
+ * Arena node: scalars inline, strings as (pointer, length) into the input,
+ * arrays and objects as contiguous child / member runs
+ */
+struct JsonNode {
+    JsonType type = JsonType::NIL;
+    bool escaped = false;          // String contains escape sequences
+    uint32_t count = 0;            // String length, array elements, object members
+    union {
+        double number;
+        bool boolean;
+        const char* string;
+        const JsonNode* elements;
+        const JsonMember* members;  // Sorted by key, unique keys
+    };
+
+    JsonNode() : number(0.0) {}
+};
+
+struct JsonMember {
+    std::string_view key;          // Unescaped
+    JsonNode value;
+};
+
 class JsonValue {
 public:
     JsonType type = JsonType::NIL;
 
     // Constructors
     JsonValue() = default;
-    explicit JsonValue(bool v) : type(JsonType::BOOL), bool_val_(v) {}
-    explicit JsonValue(double v) : type(JsonType::NUMBER), num_val_(v) {}
-    explicit JsonValue(const std::string& v) : type(JsonType::STRING), str_val_(v) {}
-    explicit JsonValue(std::string&& v) : type(JsonType::STRING), str_val_(std::move(v)) {}
+    explicit JsonValue(bool v);
+    explicit JsonValue(double v);
+    explicit JsonValue(const std::string& v);
+    explicit JsonValue(std::string&& v);
+
+    // Handle to a node of a parsed document
+    JsonValue(std::shared_ptr<const JsonDocument> doc, const JsonNode* node)
+        : type(node->type), doc_(std::move(doc)), node_(node) {}
 
     // Type checks
     bool is_null()   const { return type == JsonType::NIL; }
@@ -53,95 +100,241 @@ public:
     // Value accessors (throw on type mismatch)
     bool as_bool() const {
         if (type != JsonType::BOOL) throw std::runtime_error("JsonValue: not a bool");
-        return bool_val_;
+        return node().boolean;
     }
 
     double as_number() const {
         if (type != JsonType::NUMBER) throw std::runtime_error("JsonValue: not a number");
-        return num_val_;
+        return node().number;
     }
 
     int as_int() const { return static_cast<int>(as_number()); }
 
-    const std::string& as_string() const {
+    /** Unescaped string (decoded on each call) */
+    std::string as_string() const {
         if (type != JsonType::STRING) throw std::runtime_error("JsonValue: not a string");
-        return str_val_;
+        return unescape(node());
     }
 
+    /**
+     * String without copying: a view into the document when the string has
+     * no escape sequences, otherwise empty (check string_is_raw()).
+     */
+    std::string_view string_view() const {
+        const JsonNode& n = node();
+        if (type != JsonType::STRING || n.escaped) return {};
+        return std::string_view(n.string, n.count);
+    }
+    bool string_is_raw() const { return type == JsonType::STRING && !node().escaped; }
+
     // Safe accessors (return defaults on type mismatch)
-    bool get_bool(bool def = false) const { return is_bool() ? bool_val_ : def; }
-    double get_number(double def = 0.0) const { return is_number() ? num_val_ : def; }
-    int get_int(int def = 0) const { return is_number() ? static_cast<int>(num_val_) : def; }
-    std::string get_string(const std::string& def = "") const { return is_string() ? str_val_ : def; }
+    bool get_bool(bool def = false) const { return is_bool() ? node().boolean : def; }
+    double get_number(double def = 0.0) const { return is_number() ? node().number : def; }
+    int get_int(int def = 0) const { return is_number() ? static_cast<int>(node().number) : def; }
+    std::string get_string(const std::string& def = "") const { return is_string() ? unescape(node()) : def; }
 
     // Object access
-    const JsonValue& operator[](const std::string& key) const {
-        if (type != JsonType::OBJECT) return null_value();
-        auto it = obj_map_.find(key);
-        if (it == obj_map_.end()) return null_value();
-        return it->second;
+    JsonValue operator[](const std::string& key) const { return (*this)[std::string_view(key)]; }
+    JsonValue operator[](const char* key) const { return (*this)[std::string_view(key)]; }
+    JsonValue operator[](std::string_view key) const {
+        const JsonMember* m = find(key);
+        return m ? JsonValue(doc_, &m->value) : JsonValue();
     }
 
-    bool has(const std::string& key) const {
-        if (type != JsonType::OBJECT) return false;
-        return obj_map_.count(key) > 0;
-    }
+    bool has(std::string_view key) const { return find(key) != nullptr; }
 
-    const std::unordered_map<std::string, JsonValue>& as_object() const {
-        return obj_map_;
-    }
+    /** Members in key order, iterated as (key, value) pairs */
+    JsonObjectRange as_object() const;
 
     // Array access
-    const JsonValue& operator[](size_t index) const {
-        if (type != JsonType::ARRAY || index >= arr_val_.size()) return null_value();
-        return arr_val_[index];
+    JsonValue operator[](size_t index) const {
+        if (type != JsonType::ARRAY || index >= node().count) return JsonValue();
+        return JsonValue(doc_, node().elements + index);
+    }
+    JsonValue operator[](int index) const {
+        return index < 0 ? JsonValue() : (*this)[static_cast<size_t>(index)];
     }
 
     size_t size() const {
-        if (type == JsonType::ARRAY) return arr_val_.size();
-        if (type == JsonType::OBJECT) return obj_map_.size();
+        if (type == JsonType::ARRAY || type == JsonType::OBJECT) return node().count;
         return 0;
     }
 
-    const std::vector<JsonValue>& as_array() const {
-        return arr_val_;
-    }
+    /** Elements in order */
+    JsonArrayRange as_array() const;
 
-    // Mutators (for building values during parse)
-    void set_object() { type = JsonType::OBJECT; }
-    void set_array()  { type = JsonType::ARRAY; }
+private:
+    std::shared_ptr<const JsonDocument> doc_;
+    const JsonNode* node_ = nullptr;   // Null for standalone values
+    JsonNode inline_;                  // Standalone scalar / string node
 
-    void add_member(const std::string& key, JsonValue&& val) {
-        obj_map_[key] = std::move(val);
-    }
+    const JsonNode& node() const { return node_ ? *node_ : inline_; }
+    const JsonMember* find(std::string_view key) const;
+    static std::string unescape(const JsonNode& n);
+};
 
-    void add_element(JsonValue&& val) {
-        arr_val_.push_back(std::move(val));
-    }
+/**
+ * Iteration over an object's members or an array's elements; the range
+ * shares ownership of the document
+ */
+class JsonObjectRange {
+public:
+    class iterator {
+    public:
+        iterator(const std::shared_ptr<const JsonDocument>* doc, const JsonMember* m) : doc_(doc), m_(m) {}
+        std::pair<std::string_view, JsonValue> operator*() const {
+            return {m_->key, JsonValue(*doc_, &m_->value)};
+        }
+        iterator& operator++() { ++m_; return *this; }
+        bool operator!=(const iterator& o) const { return m_ != o.m_; }
+        bool operator==(const iterator& o) const { return m_ == o.m_; }
+    private:
+        const std::shared_ptr<const JsonDocument>* doc_;
+        const JsonMember* m_;
+    };
+
+    JsonObjectRange() = default;
+    JsonObjectRange(std::shared_ptr<const JsonDocument> doc, const JsonMember* members, size_t count)
+        : doc_(std::move(doc)), members_(members), count_(count) {}
+
+    iterator begin() const { return iterator(&doc_, members_); }
+    iterator end() const { return iterator(&doc_, members_ + count_); }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    std::shared_ptr<const JsonDocument> doc_;
+    const JsonMember* members_ = nullptr;
+    size_t count_ = 0;
+};
+
+class JsonArrayRange {
+public:
+    class iterator {
+    public:
+        iterator(const std::shared_ptr<const JsonDocument>* doc, const JsonNode* n) : doc_(doc), n_(n) {}
+        JsonValue operator*() const { return JsonValue(*doc_, n_); }
+        iterator& operator++() { ++n_; return *this; }
+        bool operator!=(const iterator& o) const { return n_ != o.n_; }
+        bool operator==(const iterator& o) const { return n_ == o.n_; }
+    private:
+        const std::shared_ptr<const JsonDocument>* doc_;
+        const JsonNode* n_;
+    };
+
+    JsonArrayRange() = default;
+    JsonArrayRange(std::shared_ptr<const JsonDocument> doc, const JsonNode* elements, size_t count)
+        : doc_(std::move(doc)), elements_(elements), count_(count) {}
+
+    iterator begin() const { return iterator(&doc_, elements_); }
+    iterator end() const { return iterator(&doc_, elements_ + count_); }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    JsonValue operator[](size_t i) const { return JsonValue(doc_, elements_ + i); }
 
 private:
-    bool bool_val_ = false;
-    double num_val_ = 0.0;
-    std::string str_val_;
-    std::unordered_map<std::string, JsonValue> obj_map_;
-    std::vector<JsonValue> arr_val_;
-
-    static const JsonValue& null_value() {
-        static JsonValue nil;
-        return nil;
+    std::shared_ptr<const JsonDocument> doc_;
+    const JsonNode* elements_ = nullptr;
+    size_t count_ = 0;
+};
+
+inline JsonObjectRange JsonValue::as_object() const {
+    if (type != JsonType::OBJECT) return JsonObjectRange();
+    return JsonObjectRange(doc_, node().members, node().count);
+}
+
+inline JsonArrayRange JsonValue::as_array() const {
+    if (type != JsonType::ARRAY) return JsonArrayRange();
+    return JsonArrayRange(doc_, node().elements, node().count);
+}
+
+/**
+ * Storage of one parsed document: the input (memory-mapped file or owned
+ * copy), the node arena, and unescaped keys
+ */
+class JsonDocument {
+public:
+    JsonDocument() = default;
+    ~JsonDocument();
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /** Take ownership of text as the input */
+    void set_text(std::string text);
+
+    /** Memory-map a file as the input (reads it when it cannot be mapped) */
+    void map_file(const std::string& filename);
+
+    /** Uninitialized arena storage for n objects of T (T trivially destructible) */
+    template <typename T>
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned arena type");
+        size_t bytes = n * sizeof(T);
+        bytes = (bytes + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        if (bytes > block_left_) {
+            size_t block = std::max(bytes, BLOCK_BYTES);
+            memory_account(MemoryTag::JSON_DOM).charge(block);
+            charged_ += block;
+            blocks_.emplace_back(new std::max_align_t[(block + sizeof(std::max_align_t) - 1) /
+                                                      sizeof(std::max_align_t)]);
+            block_ptr_ = reinterpret_cast<char*>(blocks_.back().get());
+            block_left_ = block;
+        }
+        T* out = reinterpret_cast<T*>(block_ptr_);
+        block_ptr_ += bytes;
+        block_left_ -= bytes;
+        return out;
     }
+
+    /** Copy a finished array's elements into the arena */
+    const JsonNode* store_elements(const JsonNode* elements, size_t count);
+
+    /**
+     * Sort an object's members by key in place, keep the last of repeated
+     * keys, and copy the result into the arena
+     * @param count In: members, out: unique members
+     */
+    const JsonMember* store_members(JsonMember* members, size_t& count);
+
+    /** Copy text into the arena (strings not backed by the input) */
+    std::string_view store_string(std::string_view text);
+
+    const JsonNode* root() const { return &root_; }
+    JsonNode& mutable_root() { return root_; }
+
+private:
+    static constexpr size_t BLOCK_BYTES = 1 << 20;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string text_;               // Owned input (not mapped)
+    void* mapping_ = nullptr;        // mmap base, or null
+    size_t mapping_size_ = 0;
+
+    std::vector<std::unique_ptr<std::max_align_t[]>> blocks_;
+    char* block_ptr_ = nullptr;
+    size_t block_left_ = 0;
+    size_t charged_ = 0;             // Bytes charged to MemoryTag::JSON_DOM
+
+    JsonNode root_;
 };
 
 class JsonReader {
 public:
     /**
-     * Parse a JSON string into a JsonValue tree.
+     * Parse a JSON string into a JsonValue tree (the text is copied into
+     * the document).
      * @throws std::runtime_error on parse errors
      */
     static JsonValue parse(const std::string& json);
+    static JsonValue parse(std::string&& json);
 
     /**
-     * Parse a JSON file into a JsonValue tree.
+     * Parse a JSON file into a JsonValue tree, reading it through a
+     * memory mapping.
      * @throws std::runtime_error on file or parse errors
      */
     static JsonValue parse_file(const std::string& filename);
@@ -0,0 +1,517 @@
+/**
+ * Streaming JSON Reader Implementation
+ */
+
+#include "json_stream.hpp"
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace sim {
+
+// ═══════════════════════════════════════════════════════════════
+// Parser internals
+// ═══════════════════════════════════════════════════════════════
+
+namespace {
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Input as a window that is either the whole text or a refilled buffer
+class Source {
+public:
+    explicit Source(std::string_view text)
+        : data_(text.data()), size_(text.size()) {}
+
+    Source(std::istream& in, size_t buffer_size)
+        : in_(&in), buffer_(buffer_size > 0 ? buffer_size : 1) {
+        data_ = buffer_.data();
+    }
+
+    // Next byte, or '\\0' at the end of input
+    char peek() {
+        if (pos_ == size_ && !refill()) return '\0';
+        return data_[pos_];
+    }
+
+    bool at_end() { return pos_ == size_ && !refill(); }
+
+    char get() { char c = data_[pos_]; pos_++; return c; }
+
+    // Unread bytes of the current window (refilled when empty)
+    std::string_view window() {
+        if (pos_ == size_) refill();
+        return std::string_view(data_ + pos_, size_ - pos_);
+    }
+
+    void skip(size_t n) { pos_ += n; }
+
+    size_t position() const { return offset_ + pos_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    size_t offset_ = 0;          // Input position of data_[0]
+    std::istream* in_ = nullptr;
+    std::vector<char> buffer_;
+
+    bool refill() {
+        if (!in_) return false;
+        offset_ += size_;
+        in_->read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        size_ = static_cast<size_t>(in_->gcount());
+        pos_ = 0;
+        return size_ > 0;
+    }
+};
+
+class StreamParser {
+public:
+    StreamParser(Source& src, JsonHandler& handler) : src_(src), handler_(handler) {}
+
+    void parse() {
+        skip_whitespace();
+        parse_value();
+        skip_whitespace();
+    }
+
+private:
+    Source& src_;
+    JsonHandler& handler_;
+    std::string scratch_;        // Strings that are escaped or span buffers
+    std::string number_;
+
+    char advance() {
+        if (src_.at_end()) throw error("Unexpected end of input");
+        return src_.get();
+    }
+
+    void expect(char c) {
+        char got = advance();
+        if (got != c) {
+            throw error(std::string("Expected '") + c + "', got '" + got + "'");
+        }
+    }
+
+    void skip_whitespace() {
+        while (!src_.at_end() && std::isspace(static_cast<unsigned char>(src_.peek()))) {
+            src_.skip(1);
+        }
+    }
+
+    std::runtime_error error(const std::string& msg) const {
+        return error_at(src_.position(), msg);
+    }
+
+    static std::runtime_error error_at(size_t pos, const std::string& msg) {
+        return std::runtime_error("JSON parse error at position " +
+                                  std::to_string(pos) + ": " + msg);
+    }
+
+    void parse_value() {
+        skip_whitespace();
+        char c = src_.peek();
+
+        if (c == '"') { handler_.string(parse_string()); return; }
+        if (c == '{') return parse_object();
+        if (c == '[') return parse_array();
+        if (c == 't' || c == 'f') return parse_bool();
+        if (c == 'n') return parse_null();
+        if (c == '-' || is_digit(c)) return parse_number();
+
+        throw error(std::string("Unexpected character: '") + c + "'");
+    }
+
+    // Unescaped string; a view into the input window when it is neither
+    // escaped nor split across buffers, else into scratch_
+    std::string_view parse_string() {
+        expect('"');
+        scratch_.clear();
+        bool copied = false;
+
+        while (true) {
+            std::string_view w = src_.window();
+            if (w.empty()) throw error("Unterminated string");
+
+            size_t n = 0;
+            while (n < w.size() && w[n] != '"' && w[n] != '\\') n++;
+
+            if (n < w.size() && w[n] == '"' && !copied) {
+                src_.skip(n + 1);
+                return w.substr(0, n);
+            }
+            scratch_.append(w.data(), n);
+            copied = true;
+            src_.skip(n);
+            if (n == w.size()) continue;
+
+            if (src_.get() == '"') return scratch_;
+
+            // Escape sequence
+            if (src_.at_end()) throw error("Unterminated escape");
+            char esc = src_.get();
+            switch (esc) {
+                case '"':  scratch_ += '"'; break;
+                case '\\': scratch_ += '\\'; break;
+                case '/':  scratch_ += '/'; break;
+                case 'b':  scratch_ += '\b'; break;
+                case 'f':  scratch_ += '\f'; break;
+                case 'n':  scratch_ += '\n'; break;
+                case 'r':  scratch_ += '\r'; break;
+                case 't':  scratch_ += '\t'; break;
+                case 'u': {
+                    // Unicode escape: \uXXXX, as JsonReader (BMP only)
+                    char hex[5] = {0, 0, 0, 0, 0};
+                    for (int k = 0; k < 4; k++) {
+                        if (src_.at_end()) throw error("Incomplete \\u escape");
+                        hex[k] = src_.get();
+                    }
+                    unsigned long code = std::strtoul(hex, nullptr, 16);
+                    if (code < 128) {
+                        scratch_ += static_cast<char>(code);
+                    } else if (code < 0x800) {
+                        scratch_ += static_cast<char>(0xC0 | (code >> 6));
+                        scratch_ += static_cast<char>(0x80 | (code & 0x3F));
+                    } else {
+                        scratch_ += static_cast<char>(0xE0 | (code >> 12));
+                        scratch_ += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                        scratch_ += static_cast<char>(0x80 | (code & 0x3F));
+                    }
+                    break;
+                }
+                default:
+                    throw error(std::string("Unknown escape: \\") + esc);
+            }
+        }
+    }
+
+    void take_digits() {
+        while (is_digit(src_.peek())) number_ += src_.get();
+    }
+
+    void parse_number() {
+        number_.clear();
+        if (src_.peek() == '-') number_ += src_.get();
+
+        // Integer part
+        if (src_.peek() == '0') {
+            number_ += src_.get();
+        } else if (is_digit(src_.peek())) {
+            take_digits();
+        } else {
+            throw error("Expected digit in number");
+        }
+
+        // Fractional part
+        if (src_.peek() == '.') {
+            number_ += src_.get();
+            if (!is_digit(src_.peek())) {
+                throw error("Expected digit after decimal point");
+            }
+            take_digits();
+        }
+
+        // Exponent
+        if (src_.peek() == 'e' || src_.peek() == 'E') {
+            number_ += src_.get();
+            if (src_.peek() == '+' || src_.peek() == '-') number_ += src_.get();
+            if (!is_digit(src_.peek())) {
+                throw error("Expected digit in exponent");
+            }
+            take_digits();
+        }
+
+        double val = 0.0;
+        auto res = std::from_chars(number_.data(), number_.data() + number_.size(), val);
+        if (res.ec == std::errc::result_out_of_range) {
+            val = std::strtod(number_.c_str(), nullptr);
+        }
+        handler_.number(val);
+    }
+
+    bool match(const char* word) {
+        for (const char* w = word; *w; w++) {
+            if (src_.peek() != *w) return false;
+            src_.skip(1);
+        }
+        return true;
+    }
+
+    void parse_bool() {
+        size_t start = src_.position();
+        bool value = src_.peek() == 't';
+        if (!match(value ? "true" : "false")) {
+            throw error_at(start, "Expected 'true' or 'false'");
+        }
+        handler_.boolean(value);
+    }
+
+    void parse_null() {
+        size_t start = src_.position();
+        if (!match("null")) throw error_at(start, "Expected 'null'");
+        handler_.null();
+    }
+
+    void parse_object() {
+        expect('{');
+        handler_.begin_object();
+
+        skip_whitespace();
+        if (src_.peek() == '}') {
+            src_.skip(1);
+            handler_.end_object();
+            return;
+        }
+
+        while (true) {
+            skip_whitespace();
+            handler_.key(parse_string());
+            skip_whitespace();
+            expect(':');
+            skip_whitespace();
+            parse_value();
+
+            skip_whitespace();
+            if (src_.peek() == ',') {
+                src_.skip(1);
+            } else {
+                break;
+            }
+        }
+
+        skip_whitespace();
+        expect('}');
+        handler_.end_object();
+    }
+
+    void parse_array() {
+        expect('[');
+        handler_.begin_array();
+
+        skip_whitespace();
+        if (src_.peek() == ']') {
+            src_.skip(1);
+            handler_.end_array();
+            return;
+        }
+
+        while (true) {
+            skip_whitespace();
+            parse_value();
+
+            skip_whitespace();
+            if (src_.peek() == ',') {
+                src_.skip(1);
+            } else {
+                break;
+            }
+        }
+
+        skip_whitespace();
+        expect(']');
+        handler_.end_array();
+    }
+};
+
+}  // anonymous namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Public API
+// ═══════════════════════════════════════════════════════════════
+
+void JsonStreamReader::parse(std::string_view json, JsonHandler& handler) {
+    Source src(json);
+    StreamParser(src, handler).parse();
+}
+
+void JsonStreamReader::parse_file(const std::string& filename, JsonHandler& handler,
+                                  size_t buffer_size) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open JSON file: " + filename);
+    }
+    Source src(file, buffer_size);
+    StreamParser(src, handler).parse();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// DOM builder
+// ═══════════════════════════════════════════════════════════════
+
+void JsonDomBuilder::reset() {
+    doc_ = std::make_shared<JsonDocument>();
+    stack_.clear();
+    elements_.clear();
+    members_.clear();
+    pending_key_ = {};
+    complete_ = false;
+}
+
+JsonValue JsonDomBuilder::take() {
+    JsonValue value;
+    if (complete_) {
+        const JsonNode* root = doc_->root();
+        value = JsonValue(std::shared_ptr<const JsonDocument>(doc_), root);
+    }
+    reset();
+    return value;
+}
+
+void JsonDomBuilder::add(const JsonNode& node) {
+    if (stack_.empty()) {
+        doc_->mutable_root() = node;
+        complete_ = true;
+    } else if (stack_.back().object) {
+        JsonMember member;
+        member.key = pending_key_;
+        member.value = node;
+        members_.push_back(member);
+    } else {
+        elements_.push_back(node);
+    }
+}
+
+void JsonDomBuilder::begin_object() {
+    stack_.push_back({true, members_.size(), pending_key_});
+}
+
+void JsonDomBuilder::key(std::string_view name) {
+    pending_key_ = doc_->store_string(name);
+}
+
+void JsonDomBuilder::end_object() {
+    size_t base = stack_.back().base;
+    pending_key_ = stack_.back().key;
+    stack_.pop_back();
+    size_t count = members_.size() - base;
+    JsonNode node;
+    node.type = JsonType::OBJECT;
+    node.members = doc_->store_members(members_.data() + base, count);
+    node.count = static_cast<uint32_t>(count);
+    members_.resize(base);
+    add(node);
+}
+
+void JsonDomBuilder::begin_array() {
+    stack_.push_back({false, elements_.size(), pending_key_});
+}
+
+void JsonDomBuilder::end_array() {
+    size_t base = stack_.back().base;
+    pending_key_ = stack_.back().key;
+    stack_.pop_back();
+    size_t count = elements_.size() - base;
+    JsonNode node;
+    node.type = JsonType::ARRAY;
+    node.elements = doc_->store_elements(elements_.data() + base, count);
+    node.count = static_cast<uint32_t>(count);
+    elements_.resize(base);
+    add(node);
+}
+
+void JsonDomBuilder::number(double value) {
+    JsonNode node;
+    node.type = JsonType::NUMBER;
+    node.number = value;
+    add(node);
+}
+
+void JsonDomBuilder::string(std::string_view value) {
+    JsonNode node;
+    node.type = JsonType::STRING;
+    std::string_view stored = doc_->store_string(value);
+    node.string = stored.data();
+    node.count = static_cast<uint32_t>(stored.size());
+    add(node);
+}
+
+void JsonDomBuilder::boolean(bool value) {
+    JsonNode node;
+    node.type = JsonType::BOOL;
+    node.boolean = value;
+    add(node);
+}
+
+void JsonDomBuilder::null() {
+    add(JsonNode());
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Root streamer
+// ═══════════════════════════════════════════════════════════════
+
+void JsonRootStreamer::stream_array(const std::string& key, ElementFn fn) {
+    Stream stream;
+    stream.key = key;
+    stream.fn = std::move(fn);
+    streams_.push_back(std::move(stream));
+}
+
+JsonValue JsonRootStreamer::operator[](std::string_view key) const {
+    for (auto it = members_.rbegin(); it != members_.rend(); ++it) {
+        if (it->first == key) return it->second;
+    }
+    return JsonValue();
+}
+
+bool JsonRootStreamer::streamed(std::string_view key) const {
+    for (const auto& s : streams_) {
+        if (s.key == key && s.seen) return true;
+    }
+    return false;
+}
+
+void JsonRootStreamer::key(std::string_view name) {
+    if (depth_ == 1) {
+        key_.assign(name.data(), name.size());
+    } else {
+        builder_.key(name);
+    }
+}
+
+void JsonRootStreamer::begin(bool object) {
+    if (depth_ == 1 && !object) {
+        for (auto& s : streams_) {
+            if (s.key == key_) {
+                streaming_ = &s;
+                s.seen = true;
+                index_ = 0;
+                depth_++;
+                return;
+            }
+        }
+    }
+    // The root itself is not captured; everything below it is
+    if (depth_ > 0) {
+        if (object) builder_.begin_object();
+        else builder_.begin_array();
+    }
+    depth_++;
+}
+
+void JsonRootStreamer::end(bool object) {
+    depth_--;
+    if (depth_ == 0) return;
+    if (depth_ == 1 && streaming_) {
+        streaming_ = nullptr;
+        return;
+    }
+    if (object) builder_.end_object();
+    else builder_.end_array();
+    deliver();
+}
+
+void JsonRootStreamer::deliver() {
+    if (!builder_.complete()) return;
+    if (streaming_) {
+        JsonValue element = builder_.take();
+        streaming_->fn(element, index_++);
+    } else {
+        members_.emplace_back(key_, builder_.take());
+    }
+}
+
+}  // namespace sim
@@ -0,0 +1,171 @@
+/**
+ * Streaming JSON Reader
+ *
+ * Event-driven (SAX) counterpart of JsonReader for inputs that only need
+ * one forward pass. The input is read through a fixed-size buffer, so
+ * memory use does not depend on the file size, and every value is
+ * reported to a JsonHandler as it is parsed, without a tree.
+ *
+ * Strings and keys are unescaped; the views passed to the handler are
+ * only valid during the call. Grammar and error messages match
+ * JsonReader.
+ *
+ * JsonDomBuilder turns the events of one value back into a JsonValue, and
+ * JsonRootStreamer uses it to walk a root object's large arrays one
+ * element at a time while reading each element through the usual
+ * accessors:
+ *
+ *   JsonRootStreamer root;
+ *   root.stream_array("entities", [&](const JsonValue& e, size_t i) { ... });
+ *   JsonStreamReader::parse_file("state.json", root);
+ *   double time = root["sim_time"].get_number();
+ */
+
+#ifndef SIM_JSON_STREAM_HPP
+#define SIM_JSON_STREAM_HPP
+
+#include "json_reader.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Receives parse events in document order. Defaults ignore the event.
+ */
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+
+    virtual void begin_object() {}
+    virtual void key(std::string_view /*name*/) {}
+    virtual void end_object() {}
+    virtual void begin_array() {}
+    virtual void end_array() {}
+    virtual void number(double /*value*/) {}
+    virtual void string(std::string_view /*value*/) {}
+    virtual void boolean(bool /*value*/) {}
+    virtual void null() {}
+};
+
+class JsonStreamReader {
+public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /**
+     * Parse JSON text, reporting events to handler.
+     * @throws std::runtime_error on parse errors
+     */
+    static void parse(std::string_view json, JsonHandler& handler);
+
+    /**
+     * Parse a JSON file through a buffer of buffer_size bytes.
+     * @throws std::runtime_error on file or parse errors
+     */
+    static void parse_file(const std::string& filename, JsonHandler& handler,
+                           size_t buffer_size = DEFAULT_BUFFER_SIZE);
+};
+
+/**
+ * Builds a JsonValue from the events of one complete value
+ */
+class JsonDomBuilder : public JsonHandler {
+public:
+    JsonDomBuilder() { reset(); }
+
+    void begin_object() override;
+    void key(std::string_view name) override;
+    void end_object() override;
+    void begin_array() override;
+    void end_array() override;
+    void number(double value) override;
+    void string(std::string_view value) override;
+    void boolean(bool value) override;
+    void null() override;
+
+    /** True once a whole value has been received */
+    bool complete() const { return complete_; }
+
+    /** Nesting depth of the value being built (0 outside containers) */
+    size_t depth() const { return stack_.size(); }
+
+    /** The finished value; the builder is reset for the next one */
+    JsonValue take();
+
+    void reset();
+
+private:
+    struct Frame {
+        bool object;
+        size_t base;            // First child in elements_ / members_
+        std::string_view key;   // Key of this container in its parent object
+    };
+
+    std::shared_ptr<JsonDocument> doc_;
+    std::vector<Frame> stack_;
+    std::vector<JsonNode> elements_;
+    std::vector<JsonMember> members_;
+    std::string_view pending_key_;
+    bool complete_ = false;
+
+    void add(const JsonNode& node);
+};
+
+/**
+ * Streams the large arrays of a root object element by element
+ *
+ * Members registered with stream_array() must be arrays; each element is
+ * built as its own small JsonValue, passed to the callback and dropped,
+ * so only one element is held at a time. Every other member of the root
+ * object is captured whole and read back with operator[] after the parse.
+ */
+class JsonRootStreamer : public JsonHandler {
+public:
+    using ElementFn = std::function<void(const JsonValue& element, size_t index)>;
+
+    /** Deliver the elements of root member key to fn */
+    void stream_array(const std::string& key, ElementFn fn);
+
+    /** Captured root member (the last of repeated keys), null if absent */
+    JsonValue operator[](std::string_view key) const;
+
+    /** True if key appeared as an array and its elements were streamed */
+    bool streamed(std::string_view key) const;
+
+    void begin_object() override { begin(true); }
+    void key(std::string_view name) override;
+    void end_object() override { end(true); }
+    void begin_array() override { begin(false); }
+    void end_array() override { end(false); }
+    void number(double value) override { if (depth_ > 0) { builder_.number(value); deliver(); } }
+    void string(std::string_view value) override { if (depth_ > 0) { builder_.string(value); deliver(); } }
+    void boolean(bool value) override { if (depth_ > 0) { builder_.boolean(value); deliver(); } }
+    void null() override { if (depth_ > 0) { builder_.null(); deliver(); } }
+
+private:
+    struct Stream {
+        std::string key;
+        ElementFn fn;
+        bool seen = false;
+    };
+
+    std::vector<Stream> streams_;
+    std::vector<std::pair<std::string, JsonValue>> members_;
+    JsonDomBuilder builder_;
+    std::string key_;              // Current root member
+    Stream* streaming_ = nullptr;  // Array being streamed, if any
+    size_t index_ = 0;
+    size_t depth_ = 0;
+
+    void begin(bool object);
+    void end(bool object);
+    void deliver();
+};
+
+}  // namespace sim
+
+#endif  // SIM_JSON_STREAM_HPP
@@ -1,8 +1,17 @@
 /**
  * Lightweight JSON Writer (header-only)
  *
- * Produces well-formed JSON with optional indentation.
- * No external dependencies — just writes to an ostream.
+ * Produces well-formed JSON with optional indentation; an indent of 0
+ * writes everything on one line (JSON Lines records, IPC frames), and
+ * COMPACT also drops the space after each key's colon.
+ * No external dependencies — writes to an ostream or a C FILE.
+ *
+ * Output is assembled in an internal buffer and handed to the stream in
+ * large writes: whenever the buffer fills, when a top-level value is
+ * complete, on flush() and on destruction. Anything the caller writes to
+ * the same stream between top-level values therefore lands in order.
+ * Numbers are formatted with std::to_chars; doubles keep 15 significant
+ * digits by default, or the shortest round-trip form with precision 0.
  *
  * Usage:
  *   std::ofstream f("out.json");
@@ -19,25 +28,58 @@
 #ifndef SIM_JSON_WRITER_HPP
 #define SIM_JSON_WRITER_HPP
 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <cmath>
-#include <iomanip>
-#include <sstream>
 
 namespace sim {
 
 class JsonWriter {
 public:
+    static constexpr int COMPACT = -1;                 // indent_size: no whitespace at all
+    static constexpr int DEFAULT_PRECISION = 15;       // Significant digits of doubles
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
     explicit JsonWriter(std::ostream& os, int indent_size = 2)
-        : os_(os), indent_size_(indent_size) {}
+        : os_(&os), indent_size_(indent_size), buffer_(new char[BUFFER_SIZE]) {}
+
+    explicit JsonWriter(std::FILE* file, int indent_size = 2)
+        : file_(file), indent_size_(indent_size), buffer_(new char[BUFFER_SIZE]) {}
+
+    ~JsonWriter() { flush(); }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    /**
+     * Significant digits for doubles; 0 writes the shortest form that
+     * reads back to the same value
+     */
+    JsonWriter& set_precision(int digits) {
+        precision_ = digits;
+        return *this;
+    }
+
+    /** Hand the buffered output to the stream */
+    void flush() {
+        if (used_ == 0) return;
+        if (os_) os_->write(buffer_.get(), static_cast<std::streamsize>(used_));
+        else if (file_) std::fwrite(buffer_.get(), 1, used_, file_);
+        used_ = 0;
+    }
 
     // ── Structure ──
 
     JsonWriter& begin_object() {
         if (!expect_value_) write_separator();
-        os_ << '{';
+        put('{');
         expect_value_ = false;
         push_scope(OBJECT);
         return *this;
@@ -46,13 +88,13 @@ public:
     JsonWriter& end_object() {
         pop_scope();
         newline();
-        os_ << '}';
-        return *this;
+        put('}');
+        return finish_value();
     }
 
     JsonWriter& begin_array() {
         if (!expect_value_) write_separator();
-        os_ << '[';
+        put('[');
         expect_value_ = false;
         push_scope(ARRAY);
         return *this;
@@ -61,17 +103,18 @@ public:
     JsonWriter& end_array() {
         pop_scope();
         newline();
-        os_ << ']';
-        return *this;
+        put(']');
+        return finish_value();
     }
 
     // ── Keys (object members) ──
 
     JsonWriter& key(const std::string& k) {
         write_separator();
-        os_ << '"';
+        put('"');
         write_escaped(k);
-        os_ << "\": ";
+        if (indent_size_ < 0) put("\":", 2);
+        else put("\": ", 3);
         expect_value_ = true;
         return *this;
     }
@@ -79,56 +122,52 @@ public:
     // ── Values ──
 
     JsonWriter& value(const std::string& v) {
-        if (!expect_value_) write_separator();
-        os_ << '"';
-        write_escaped(v);
-        os_ << '"';
-        expect_value_ = false;
-        return *this;
+        return value(std::string_view(v));
     }
 
     JsonWriter& value(const char* v) {
-        return value(std::string(v));
+        return value(std::string_view(v));
     }
 
-    JsonWriter& value(int v) {
+    JsonWriter& value(std::string_view v) {
         if (!expect_value_) write_separator();
-        os_ << v;
-        expect_value_ = false;
-        return *this;
+        put('"');
+        write_escaped(v);
+        put('"');
+        return finish_value();
     }
 
-    JsonWriter& value(size_t v) {
-        if (!expect_value_) write_separator();
-        os_ << v;
-        expect_value_ = false;
-        return *this;
-    }
+    JsonWriter& value(int v) { return integer(v); }
+    JsonWriter& value(size_t v) { return integer(v); }
+    JsonWriter& value(int64_t v) { return integer(v); }
 
     JsonWriter& value(double v) {
         if (!expect_value_) write_separator();
         if (std::isnan(v) || std::isinf(v)) {
-            os_ << "null";
+            put("null", 4);
         } else {
             // Use enough precision for scientific data
-            os_ << std::setprecision(15) << v;
+            reserve(32);
+            char* out = buffer_.get() + used_;
+            auto res = precision_ > 0
+                ? std::to_chars(out, out + 32, v, std::chars_format::general, precision_)
+                : std::to_chars(out, out + 32, v);
+            used_ = static_cast<size_t>(res.ptr - buffer_.get());
         }
-        expect_value_ = false;
-        return *this;
+        return finish_value();
     }
 
     JsonWriter& value(bool v) {
         if (!expect_value_) write_separator();
-        os_ << (v ? "true" : "false");
-        expect_value_ = false;
-        return *this;
+        if (v) put("true", 4);
+        else put("false", 5);
+        return finish_value();
     }
 
     JsonWriter& null_value() {
         if (!expect_value_) write_separator();
-        os_ << "null";
-        expect_value_ = false;
-        return *this;
+        put("null", 4);
+        return finish_value();
     }
 
     // ── Convenience: key-value pair ──
@@ -148,11 +187,58 @@ private:
         int count = 0;  // Number of items written at this level
     };
 
-    std::ostream& os_;
+    std::ostream* os_ = nullptr;
+    std::FILE* file_ = nullptr;
     int indent_size_;
+    int precision_ = DEFAULT_PRECISION;
     std::vector<Scope> stack_;
     bool expect_value_ = false;
 
+    std::unique_ptr<char[]> buffer_;
+    size_t used_ = 0;
+
+    // ── Buffer ──
+
+    // Room for n more bytes (n <= BUFFER_SIZE)
+    void reserve(size_t n) {
+        if (used_ + n > BUFFER_SIZE) flush();
+    }
+
+    void put(char c) {
+        reserve(1);
+        buffer_[used_++] = c;
+    }
+
+    void put(const char* s, size_t n) {
+        if (n > BUFFER_SIZE) {
+            flush();
+            if (os_) os_->write(s, static_cast<std::streamsize>(n));
+            else if (file_) std::fwrite(s, 1, n, file_);
+            return;
+        }
+        reserve(n);
+        std::memcpy(buffer_.get() + used_, s, n);
+        used_ += n;
+    }
+
+    template <typename T>
+    JsonWriter& integer(T v) {
+        if (!expect_value_) write_separator();
+        reserve(24);
+        char* out = buffer_.get() + used_;
+        used_ = static_cast<size_t>(std::to_chars(out, out + 24, v).ptr - buffer_.get());
+        return finish_value();
+    }
+
+    // A value is done; a finished document goes out to the stream
+    JsonWriter& finish_value() {
+        expect_value_ = false;
+        if (stack_.empty()) flush();
+        return *this;
+    }
+
+    // ── Layout ──
+
     void push_scope(ScopeType type) {
         stack_.push_back({type, 0});
     }
@@ -172,7 +258,7 @@ private:
         if (!stack_.empty()) {
             auto& scope = stack_.back();
             if (scope.count > 0) {
-                os_ << ',';
+                put(',');
             }
             newline();
             scope.count++;
@@ -180,36 +266,48 @@ private:
     }
 
     void newline() {
-        os_ << '\n';
-        int depth = static_cast<int>(stack_.size());
-        for (int i = 0; i < depth * indent_size_; i++) {
-            os_ << ' ';
-        }
+        if (indent_size_ <= 0) return;
+        size_t spaces = stack_.size() * static_cast<size_t>(indent_size_);
+        if (spaces + 1 > BUFFER_SIZE) spaces = BUFFER_SIZE - 1;
+        reserve(spaces + 1);
+        buffer_[used_++] = '\n';
+        std::memset(buffer_.get() + used_, ' ', spaces);
+        used_ += spaces;
     }
 
-    void write_escaped(const std::string& s) {
-        for (char c : s) {
+    // Runs of characters that need no escaping are copied whole
+    void write_escaped(std::string_view s) {
+        const char* p = s.data();
+        const char* end = p + s.size();
+        while (p < end) {
+            const char* run = p;
+            while (p < end && !needs_escape(*p)) p++;
+            if (p > run) put(run, static_cast<size_t>(p - run));
+            if (p == end) break;
+
+            char c = *p++;
             switch (c) {
-                case '"':  os_ << "\\\""; break;
-                case '\\': os_ << "\\\\"; break;
-                case '\b': os_ << "\\b";  break;
-                case '\f': os_ << "\\f";  break;
-                case '\n': os_ << "\\n";  break;
-                case '\r': os_ << "\\r";  break;
-                case '\t': os_ << "\\t";  break;
-                default:
-                    if (static_cast<unsigned char>(c) < 0x20) {
-                        // Control character — hex escape
-                        char buf[8];
-                        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
-                        os_ << buf;
-                    } else {
-                        os_ << c;
-                    }
+                case '"':  put("\\\"", 2); break;
+                case '\\': put("\\\\", 2); break;
+                case '\b': put("\\b", 2);  break;
+                case '\f': put("\\f", 2);  break;
+                case '\n': put("\\n", 2);  break;
+                case '\r': put("\\r", 2);  break;
+                case '\t': put("\\t", 2);  break;
+                default: {
+                    // Control character — hex escape
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    put(buf, 6);
                     break;
+                }
             }
         }
     }
+
+    static bool needs_escape(char c) {
+        return static_cast<unsigned char>(c) < 0x20 || c == '"' || c == '\\';
+    }
 };
 
 }  // namespace sim
@@ -0,0 +1,160 @@
+#include "io/resource_cache.hpp"
+#include "io/checkpoint_binary.hpp"
+
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace sim {
+
+ResourceCache::ResourceCache() {
+    if (const char* dir = std::getenv("SIM_DATA_CACHE")) dir_ = dir;
+    if (const char* v = std::getenv("SIM_DATA_VERBOSE")) verbose_ = v[0] != '\0' && v[0] != '0';
+}
+
+ResourceCache& ResourceCache::global() {
+    static ResourceCache cache;
+    return cache;
+}
+
+void ResourceCache::set_dir(std::string dir) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dir_ = std::move(dir);
+}
+
+std::string ResourceCache::dir() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dir_;
+}
+
+uint64_t ResourceCache::content_hash(const char* data, size_t size) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; i++) {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+ResourceCache::Source ResourceCache::stat_source(const std::string& path) const {
+    Source s;
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return s;
+    s.valid = true;
+    s.bytes = static_cast<uint64_t>(st.st_size);
+    s.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return s;
+}
+
+std::string ResourceCache::cache_path(const char* kind, const std::string& path) const {
+    // One file per source path; the content hash inside decides validity
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s-%016llx.res", kind,
+                  static_cast<unsigned long long>(content_hash(path.data(), path.size())));
+    return dir_ + "/" + name;
+}
+
+namespace {
+
+bool hash_file(const std::string& path, uint64_t& hash) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    hash = ResourceCache::content_hash(text.data(), text.size());
+    return true;
+}
+
+} // namespace
+
+bool ResourceCache::read_cached(const char* kind, uint32_t version, const std::string& path,
+                                Source& source, std::vector<char>& payload) const {
+    if (dir_.empty() || !source.valid) return false;
+    std::ifstream in(cache_path(kind, path), std::ios::binary);
+    if (!in) return false;
+
+    res::Header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    uint32_t crc = h.header_crc;
+    h.header_crc = 0;
+    if (std::memcmp(h.magic, res::MAGIC, 4) != 0 || h.version != res::VERSION ||
+        h.codec_version != version || ckpt::crc32(&h, sizeof(h)) != crc) {
+        return false;
+    }
+
+    // Same size and mtime: trust the recorded hash; otherwise hash the source
+    if (h.source_bytes != source.bytes || h.source_mtime_ns != source.mtime_ns) {
+        if (!source.hash && !hash_file(path, source.hash)) return false;
+        if (source.hash != h.source_hash) return false;
+    }
+    source.hash = h.source_hash;
+
+    payload.resize(h.payload_bytes);
+    if (!in.read(payload.data(), static_cast<std::streamsize>(payload.size()))) return false;
+    return ckpt::crc32(payload.data(), payload.size()) == h.payload_crc;
+}
+
+void ResourceCache::write_cached(const char* kind, uint32_t version, const std::string& path,
+                                 Source& source, const std::vector<char>& payload) const {
+    if (dir_.empty()) return;
+    if (!source.hash && !hash_file(path, source.hash)) return;
+    ::mkdir(dir_.c_str(), 0755);
+
+    res::Header h{};
+    std::memcpy(h.magic, res::MAGIC, 4);
+    h.version = res::VERSION;
+    h.codec_version = version;
+    h.source_hash = source.hash;
+    h.source_bytes = source.bytes;
+    h.source_mtime_ns = source.mtime_ns;
+    h.payload_bytes = payload.size();
+    h.payload_crc = ckpt::crc32(payload.data(), payload.size());
+    h.header_crc = ckpt::crc32(&h, sizeof(h));
+
+    // Written aside and renamed, so a concurrent reader never sees half a file
+    const std::string file = cache_path(kind, path);
+    const std::string tmp = file + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              (payload.empty() || std::fwrite(payload.data(), payload.size(), 1, f) == 1);
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), file.c_str()) != 0) std::remove(tmp.c_str());
+}
+
+void ResourceCache::record_locked(const ResourceLoad& entry) {
+    loads_.push_back(entry);
+    if (verbose_) {
+        std::fprintf(stderr, "[Data] %s: %zu records from %s %s in %.2f ms\n",
+                     entry.kind.c_str(), entry.records, entry.source.c_str(),
+                     entry.from_cache ? "(cached)" : "(parsed)", entry.seconds * 1e3);
+    }
+}
+
+std::vector<ResourceLoad> ResourceCache::loads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return loads_;
+}
+
+void ResourceCache::write_report(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char line[512];
+    std::snprintf(line, sizeof(line), "%-12s %10s %10s %-7s %s\n",
+                  "dataset", "records", "ms", "from", "source");
+    out << line;
+    for (const ResourceLoad& l : loads_) {
+        std::snprintf(line, sizeof(line), "%-12s %10zu %10.2f %-7s %s\n", l.kind.c_str(),
+                      l.records, l.seconds * 1e3, l.from_cache ? "cache" : "parse",
+                      l.source.c_str());
+        out << line;
+    }
+}
+
+void ResourceCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loaded_.clear();
+}
+
+} // namespace sim
@@ -0,0 +1,290 @@
+/**
+ * ResourceCache - Datasets parsed on first use, parsed form kept on disk
+ *
+ * load<T>(path, parse) returns the dataset at `path` as parsed by `parse`,
+ * shared: a later load of the same path and type returns the same object
+ * without touching the file. With a cache directory (set_dir(), or the
+ * SIM_DATA_CACHE environment variable) the parsed form is also written to
+ * "<dir>/<kind>-<hash>.res", the hash being the FNV-1a of the source bytes,
+ * and read back instead of parsing the next time. The file records the
+ * source's size and modification time, so a warm hit costs one stat() and
+ * one read of the cache file; only when those differ is the source read
+ * and hashed to decide.
+ *
+ * A type opts in by specializing ResourceCodec<T>:
+ *
+ *   template <> struct ResourceCodec<std::vector<TLE>> {
+ *       static constexpr const char* kind = "tle";
+ *       static constexpr uint32_t version = 1;       // bump on layout change
+ *       static void save(ResourceWriter& w, const std::vector<TLE>& v);
+ *       static bool restore(ResourceReader& r, std::vector<TLE>& v);
+ *   };
+ *
+ * LazyResource<T> holds a path and defers load() to its first get(), so
+ * an object whose data may never be needed can be built without it.
+ *
+ * Every load is timed; write_report() lists them (source, records, ms,
+ * parsed or cached), and with set_verbose() (or SIM_DATA_VERBOSE=1) each is
+ * logged as it happens.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header   res::Header (64 bytes, CRC-32 over itself and the payload)
+ *   payload  the codec's save() output
+ */
+
+#ifndef SIM_RESOURCE_CACHE_HPP
+#define SIM_RESOURCE_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sim {
+
+namespace res {
+
+constexpr char MAGIC[4] = {'R', 'S', 'R', 'C'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t codec_version;   // ResourceCodec<T>::version
+    uint32_t reserved0;
+    uint64_t source_hash;     // FNV-1a of the source bytes
+    uint64_t source_bytes;
+    int64_t  source_mtime_ns;
+    uint64_t payload_bytes;
+    uint32_t payload_crc;
+    uint32_t header_crc;      // CRC-32 of the header with this field zero
+    uint32_t reserved[2];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "resource cache header layout");
+
+} // namespace res
+
+/** Appends a codec's fields to a byte buffer */
+class ResourceWriter {
+public:
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() takes plain values");
+        const char* p = reinterpret_cast<const char*>(&value);
+        bytes_.insert(bytes_.end(), p, p + sizeof(T));
+    }
+
+    void put(const std::string& s) {
+        put(static_cast<uint32_t>(s.size()));
+        bytes_.insert(bytes_.end(), s.begin(), s.end());
+    }
+
+    const std::vector<char>& bytes() const { return bytes_; }
+
+private:
+    std::vector<char> bytes_;
+};
+
+/** Reads back what ResourceWriter wrote; every get() fails once past the end */
+class ResourceReader {
+public:
+    ResourceReader(const char* data, size_t size) : p_(data), end_(data + size) {}
+
+    template <typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "get() takes plain values");
+        if (static_cast<size_t>(end_ - p_) < sizeof(T)) return false;
+        std::memcpy(&value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string& s) {
+        uint32_t n = 0;
+        if (!get(n) || static_cast<size_t>(end_ - p_) < n) return false;
+        s.assign(p_, n);
+        p_ += n;
+        return true;
+    }
+
+    bool at_end() const { return p_ == end_; }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+/** Specialize for each cached type (see the file comment) */
+template <typename T>
+struct ResourceCodec;
+
+/** One timed load */
+struct ResourceLoad {
+    std::string kind;
+    std::string source;
+    size_t records = 0;
+    double seconds = 0.0;
+    bool from_cache = false;   // Read from the disk cache instead of parsed
+};
+
+class ResourceCache {
+public:
+    /** The process-wide cache (directory from SIM_DATA_CACHE, logging from SIM_DATA_VERBOSE) */
+    static ResourceCache& global();
+
+    /** Disk cache directory ("" = memory only; created on first store) */
+    void set_dir(std::string dir);
+    std::string dir() const;
+
+    /** Log each load to stderr as it happens */
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
+    /**
+     * The dataset at `path`, parsed by `parse` on the first load in this
+     * process (or read from the disk cache) and shared afterwards.
+     * @param count Records in a dataset, for the report
+     * @throws whatever parse throws
+     */
+    template <typename T>
+    std::shared_ptr<const T> load(const std::string& path,
+                                  const std::function<T(const std::string&)>& parse,
+                                  const std::function<size_t(const T&)>& count = nullptr) {
+        using Codec = ResourceCodec<T>;
+        const std::string key = std::string(Codec::kind) + ":" + path;
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = loaded_.find(key);
+        if (it != loaded_.end()) return std::static_pointer_cast<const T>(it->second);
+
+        const auto start = std::chrono::steady_clock::now();
+        auto value = std::make_shared<T>();
+        Source source = stat_source(path);
+        bool hit = false;
+        std::vector<char> payload;
+        if (read_cached(Codec::kind, Codec::version, path, source, payload)) {
+            ResourceReader r(payload.data(), payload.size());
+            hit = Codec::restore(r, *value) && r.at_end();
+            if (!hit) *value = T();
+        }
+        if (!hit) {
+            *value = parse(path);
+            if (source.valid) {
+                ResourceWriter w;
+                Codec::save(w, *value);
+                write_cached(Codec::kind, Codec::version, path, source, w.bytes());
+            }
+        }
+
+        ResourceLoad entry;
+        entry.kind = Codec::kind;
+        entry.source = path;
+        entry.records = count ? count(*value) : 0;
+        entry.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        entry.from_cache = hit;
+        record_locked(entry);
+
+        loaded_[key] = value;
+        return value;
+    }
+
+    /** Every load so far, in order */
+    std::vector<ResourceLoad> loads() const;
+
+    /** Table of loads (kind, records, ms, parsed/cached, source) */
+    void write_report(std::ostream& out) const;
+
+    /** Drop the in-memory datasets (the disk cache is kept) */
+    void clear();
+
+    /** 64-bit FNV-1a of a byte range */
+    static uint64_t content_hash(const char* data, size_t size);
+
+private:
+    struct Source {
+        bool valid = false;
+        uint64_t bytes = 0;
+        int64_t mtime_ns = 0;
+        uint64_t hash = 0;     // 0 until computed
+    };
+
+    ResourceCache();
+
+    Source stat_source(const std::string& path) const;
+    std::string cache_path(const char* kind, const std::string& path) const;
+    bool read_cached(const char* kind, uint32_t version, const std::string& path,
+                     Source& source, std::vector<char>& payload) const;
+    void write_cached(const char* kind, uint32_t version, const std::string& path,
+                      Source& source, const std::vector<char>& payload) const;
+    void record_locked(const ResourceLoad& entry);
+
+    mutable std::mutex mutex_;
+    std::string dir_;
+    bool verbose_ = false;
+    std::map<std::string, std::shared_ptr<const void>> loaded_;
+    std::vector<ResourceLoad> loads_;
+};
+
+/**
+ * A dataset loaded through ResourceCache::global() on first get().
+ * get() is thread-safe; a failed load throws from every get() until one
+ * succeeds.
+ */
+template <typename T>
+class LazyResource {
+public:
+    using Parser = std::function<T(const std::string&)>;
+
+    LazyResource() = default;
+    LazyResource(std::string path, Parser parse,
+                 std::function<size_t(const T&)> count = nullptr)
+        : state_(std::make_shared<State>()) {
+        state_->path = std::move(path);
+        state_->parse = std::move(parse);
+        state_->count = std::move(count);
+    }
+
+    const T& get() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->value) {
+            state_->value = ResourceCache::global().load<T>(state_->path, state_->parse,
+                                                            state_->count);
+        }
+        return *state_->value;
+    }
+
+    const T& operator*() const { return get(); }
+    const T* operator->() const { return &get(); }
+
+    /** True once loaded */
+    bool loaded() const {
+        if (!state_) return false;
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->value != nullptr;
+    }
+
+    const std::string& path() const { return state_->path; }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::string path;
+        Parser parse;
+        std::function<size_t(const T&)> count;
+        std::shared_ptr<const T> value;
+    };
+    std::shared_ptr<State> state_;   // Shared by copies: one load for all
+};
+
+} // namespace sim
+
+#endif // SIM_RESOURCE_CACHE_HPP
@@ -0,0 +1,230 @@
+/**
+ * TLE Catalog Cache Implementation
+ */
+
+#include "tle_catalog.hpp"
+#include "checkpoint_binary.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim {
+
+namespace {
+
+size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+// Size and modification time [ns] of a file
+bool source_stamp(const std::string& filename, uint64_t& size, int64_t& mtime_ns) {
+    struct stat st;
+    if (::stat(filename.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+template <typename T>
+void append(std::string& out, const T* data, size_t count) {
+    out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+void pad(std::string& out) { out.resize(padded(out.size()), '\0'); }
+
+} // anonymous namespace
+
+TLECatalog TLECatalog::load(const std::string& tle_file, const TLEParseOptions& options,
+                            const std::string& cache_file) {
+    const std::string cache = cache_file.empty() ? tle_file + ".cache" : cache_file;
+
+    TLECatalog catalog;
+    if (catalog.load_cache(tle_file, cache)) {
+        if (options.verbose) {
+            std::cout << "Loaded " << catalog.tles.size() << " TLEs from cache " << cache << std::endl;
+        }
+        return catalog;
+    }
+
+    catalog.tles = TLEParser::parse_file(tle_file, options);
+    const size_t n = catalog.tles.size();
+    catalog.records.resize(n);
+
+    constexpr size_t CHUNK = 256;
+    auto init_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            catalog.records[i] = SGP4Propagator::initialize(catalog.tles[i]);
+        }
+    };
+    if (options.num_threads != 1 && n > CHUNK) {
+        ThreadPool pool(options.num_threads);
+        pool.parallel_for((n + CHUNK - 1) / CHUNK, [&](size_t c) {
+            init_range(c * CHUNK, std::min(n, (c + 1) * CHUNK));
+        });
+    } else {
+        init_range(0, n);
+    }
+
+    if (n > 0) catalog.save_cache(tle_file, cache);
+    return catalog;
+}
+
+bool TLECatalog::save_cache(const std::string& source_file, const std::string& cache_file) const {
+    tlec::Header header{};
+    if (!source_stamp(source_file, header.source_size, header.source_mtime_ns)) return false;
+    if (records.size() != tles.size()) return false;
+
+    const size_t n = tles.size();
+    std::string payload;
+    payload.reserve(n * (sizeof(tlec::Fields) + sizeof(SGP4Record) + 40));
+
+    for (const TLE& t : tles) {
+        tlec::Fields f{};
+        f.satellite_number = t.satellite_number;
+        f.launch_year = t.launch_year;
+        f.launch_number = t.launch_number;
+        f.epoch_year = t.epoch_year;
+        f.ephemeris_type = t.ephemeris_type;
+        f.element_set_number = t.element_set_number;
+        f.revolution_number = t.revolution_number;
+        f.classification = t.classification;
+        f.epoch_day = t.epoch_day;
+        f.mean_motion_derivative = t.mean_motion_derivative;
+        f.mean_motion_second_derivative = t.mean_motion_second_derivative;
+        f.bstar_drag = t.bstar_drag;
+        f.inclination = t.inclination;
+        f.raan = t.raan;
+        f.eccentricity = t.eccentricity;
+        f.arg_perigee = t.arg_perigee;
+        f.mean_anomaly = t.mean_anomaly;
+        f.mean_motion = t.mean_motion;
+        append(payload, &f, 1);
+    }
+
+    std::vector<uint32_t> name_end(n), piece_end(n);
+    uint32_t name_bytes = 0, piece_bytes = 0;
+    for (size_t i = 0; i < n; i++) {
+        name_bytes += static_cast<uint32_t>(tles[i].name.size());
+        piece_bytes += static_cast<uint32_t>(tles[i].launch_piece.size());
+        name_end[i] = name_bytes;
+        piece_end[i] = piece_bytes;
+    }
+    append(payload, name_end.data(), n);
+    append(payload, piece_end.data(), n);
+    for (const TLE& t : tles) payload += t.name;
+    for (const TLE& t : tles) payload += t.launch_piece;
+    pad(payload);
+
+    append(payload, records.data(), n);
+
+    std::memcpy(header.magic, tlec::MAGIC, 4);
+    header.version = tlec::VERSION;
+    header.record_bytes = sizeof(SGP4Record);
+    header.count = static_cast<uint32_t>(n);
+    header.payload_bytes = payload.size();
+    header.payload_crc = ckpt::crc32(payload.data(), payload.size());
+
+    // Temporary file renamed over the cache, so readers never see a partial one
+    const std::string tmp = cache_file + ".tmp";
+    std::FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), cache_file.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TLECatalog::load_cache(const std::string& source_file, const std::string& cache_file) {
+    uint64_t size;
+    int64_t mtime_ns;
+    if (!source_stamp(source_file, size, mtime_ns)) return false;
+
+    std::ifstream file(cache_file, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    tlec::Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (std::memcmp(header.magic, tlec::MAGIC, 4) != 0 || header.version != tlec::VERSION ||
+        header.record_bytes != sizeof(SGP4Record) ||
+        header.source_size != size || header.source_mtime_ns != mtime_ns) {
+        return false;
+    }
+
+    const size_t n = header.count;
+    const size_t fixed = n * sizeof(tlec::Fields) + 2 * n * sizeof(uint32_t);
+    if (header.payload_bytes < fixed + n * sizeof(SGP4Record)) return false;
+
+    std::string payload(header.payload_bytes, '\0');
+    if (!file.read(&payload[0], static_cast<std::streamsize>(payload.size()))) return false;
+    if (ckpt::crc32(payload.data(), payload.size()) != header.payload_crc) return false;
+
+    const char* p = payload.data();
+    const char* name_end_p = p + n * sizeof(tlec::Fields);
+    const char* piece_end_p = name_end_p + n * sizeof(uint32_t);
+    uint32_t name_bytes = 0, piece_bytes = 0;
+    if (n > 0) {
+        std::memcpy(&name_bytes, name_end_p + (n - 1) * sizeof(uint32_t), sizeof(uint32_t));
+        std::memcpy(&piece_bytes, piece_end_p + (n - 1) * sizeof(uint32_t), sizeof(uint32_t));
+    }
+    const size_t records_offset = padded(fixed + name_bytes + piece_bytes);
+    if (records_offset + n * sizeof(SGP4Record) != payload.size()) return false;
+
+    const char* names = p + fixed;
+    const char* pieces = names + name_bytes;
+
+    std::vector<TLE> loaded(n);
+    uint32_t name_begin = 0, piece_begin = 0;
+    for (size_t i = 0; i < n; i++) {
+        tlec::Fields f;
+        std::memcpy(&f, p + i * sizeof(tlec::Fields), sizeof(f));
+        uint32_t name_stop, piece_stop;
+        std::memcpy(&name_stop, name_end_p + i * sizeof(uint32_t), sizeof(uint32_t));
+        std::memcpy(&piece_stop, piece_end_p + i * sizeof(uint32_t), sizeof(uint32_t));
+        if (name_stop < name_begin || name_stop > name_bytes ||
+            piece_stop < piece_begin || piece_stop > piece_bytes) {
+            return false;
+        }
+
+        TLE& t = loaded[i];
+        t.name.assign(names + name_begin, name_stop - name_begin);
+        t.launch_piece.assign(pieces + piece_begin, piece_stop - piece_begin);
+        name_begin = name_stop;
+        piece_begin = piece_stop;
+
+        t.satellite_number = f.satellite_number;
+        t.classification = f.classification;
+        t.launch_year = f.launch_year;
+        t.launch_number = f.launch_number;
+        t.epoch_year = f.epoch_year;
+        t.epoch_day = f.epoch_day;
+        t.mean_motion_derivative = f.mean_motion_derivative;
+        t.mean_motion_second_derivative = f.mean_motion_second_derivative;
+        t.bstar_drag = f.bstar_drag;
+        t.ephemeris_type = f.ephemeris_type;
+        t.element_set_number = f.element_set_number;
+        t.inclination = f.inclination;
+        t.raan = f.raan;
+        t.eccentricity = f.eccentricity;
+        t.arg_perigee = f.arg_perigee;
+        t.mean_anomaly = f.mean_anomaly;
+        t.mean_motion = f.mean_motion;
+        t.revolution_number = f.revolution_number;
+    }
+
+    std::vector<SGP4Record> recs(n);
+    if (n > 0) std::memcpy(recs.data(), p + records_offset, n * sizeof(SGP4Record));
+
+    tles = std::move(loaded);
+    records = std::move(recs);
+    from_cache = true;
+    return true;
+}
+
+}  // namespace sim
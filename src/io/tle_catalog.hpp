@@ -0,0 +1,112 @@
+/**
+ * TLE Catalog Cache
+ *
+ * A parsed TLE catalog together with its SGP4 initialization records,
+ * cached in a binary file next to the source. load() reuses the cache
+ * while the source file's size and modification time match the ones
+ * recorded in it, and otherwise parses the source, runs sgp4init for
+ * every entry and rewrites the cache. A cache that is missing, stale,
+ * corrupt or from another build (record layout) is simply rebuilt, and
+ * a cache that cannot be written is skipped.
+ *
+ * Layout (native byte order, every section padded to 8 bytes):
+ *   header   tlec::Header (64 bytes, CRC-32 of the payload)
+ *   fields   tlec::Fields[n]: the TLE's numeric fields
+ *   strings  u32 name_end[n], u32 piece_end[n], then the bytes; entry i
+ *            owns [end[i-1], end[i]) of the name and launch piece runs
+ *   records  SGP4Record[n] as laid out in memory
+ *
+ * Usage:
+ *   TLECatalog catalog = TLECatalog::load("data/tles/satcat.txt");
+ *   SGP4Batch batch;
+ *   for (const auto& rec : catalog.records) batch.add(rec);
+ */
+
+#ifndef SIM_TLE_CATALOG_HPP
+#define SIM_TLE_CATALOG_HPP
+
+#include "io/tle_parser.hpp"
+#include "propagators/sgp4_propagator.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+namespace tlec {
+
+constexpr char MAGIC[4] = {'T', 'L', 'E', 'C'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t record_bytes;    // sizeof(SGP4Record) of the writer
+    uint32_t count;
+    int64_t  source_mtime_ns; // Source modification time
+    uint64_t source_size;     // Source size [bytes]
+    uint64_t payload_bytes;   // Bytes after the header
+    uint32_t payload_crc;     // CRC-32 of the payload
+    uint32_t reserved[5];
+};
+
+struct Fields {
+    int32_t satellite_number;
+    int32_t launch_year;
+    int32_t launch_number;
+    int32_t epoch_year;
+    int32_t ephemeris_type;
+    int32_t element_set_number;
+    int32_t revolution_number;
+    char    classification;
+    char    pad[3];
+    double  epoch_day;
+    double  mean_motion_derivative;
+    double  mean_motion_second_derivative;
+    double  bstar_drag;
+    double  inclination;
+    double  raan;
+    double  eccentricity;
+    double  arg_perigee;
+    double  mean_anomaly;
+    double  mean_motion;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "TLE cache header layout");
+static_assert(sizeof(Fields) == 112, "TLE cache field layout");
+
+} // namespace tlec
+
+struct TLECatalog {
+    std::vector<TLE> tles;
+    std::vector<SGP4Record> records;   // SGP4Propagator::initialize(tles[i])
+    bool from_cache = false;           // Loaded from the cache file
+
+    /**
+     * Load a TLE file through its cache, rebuilding the cache when it is
+     * missing or stale. options.num_threads also parallelizes sgp4init.
+     * @param cache_file Defaults to "<tle_file>.cache"
+     */
+    static TLECatalog load(const std::string& tle_file,
+                           const TLEParseOptions& options = TLEParseOptions(),
+                           const std::string& cache_file = "");
+
+    /**
+     * Write the cache for a catalog parsed from source_file
+     * @return true on success
+     */
+    bool save_cache(const std::string& source_file, const std::string& cache_file) const;
+
+    /**
+     * Read a cache if it is valid and matches source_file's size and
+     * modification time
+     * @return true on success (catalog replaced)
+     */
+    bool load_cache(const std::string& source_file, const std::string& cache_file);
+};
+
+}  // namespace sim
+
+#endif  // SIM_TLE_CATALOG_HPP
@@ -1,56 +1,226 @@
 #include "io/tle_parser.hpp"
+#include "io/resource_cache.hpp"
+#include "utils/thread_pool.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <stdexcept>
 
 namespace sim {
 
+namespace {
+
+// Field with surrounding blanks and tabs removed (as substr + trim)
+std::string_view field(std::string_view str, int start, int length) {
+    if (static_cast<size_t>(start) > str.size()) {
+        throw std::out_of_range("TLE field past end of line");
+    }
+    std::string_view f = str.substr(start, length);
+    size_t first = f.find_first_not_of(" \t");
+    if (first == std::string_view::npos) return {};
+    size_t last = f.find_last_not_of(" \t");
+    return f.substr(first, last - first + 1);
+}
+
+// std::from_chars with std::stod / std::stoi's optional leading '+'
+template <typename T>
+T parse_number(std::string_view s) {
+    if (s.size() > 1 && s[0] == '+' && s[1] != '-') s.remove_prefix(1);
+    T value{};
+    auto res = std::from_chars(s.data(), s.data() + s.size(), value);
+    if (res.ec != std::errc()) {
+        throw std::invalid_argument("Invalid TLE number '" + std::string(s) + "'");
+    }
+    return value;
+}
+
+using Entry = std::array<std::string_view, 3>;
+
+}  // anonymous namespace
+
 std::vector<TLE> TLEParser::parse_file(const std::string& filename) {
-    std::vector<TLE> tles;
-    std::ifstream file(filename);
+    return parse_file(filename, TLEParseOptions());
+}
+
+std::vector<TLE> TLEParser::parse_file(const std::string& filename, const TLEParseOptions& options) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     
     if (!file.is_open()) {
         std::cerr << "ERROR: Could not open TLE file: " << filename << std::endl;
-        return tles;
+        return {};
     }
-    
-    std::string line0, line1, line2;
-    
-    // Read three lines at a time
-    while (std::getline(file, line0)) {
+
+    // Whole file in one read; entries are parsed from views into it
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&text[0], static_cast<std::streamsize>(text.size()));
+    file.close();
+
+    return parse_text(text, options, filename);
+}
+
+template <>
+struct ResourceCodec<std::vector<TLE>> {
+    static constexpr const char* kind = "tle";
+    static constexpr uint32_t version = 1;
+
+    static void save(ResourceWriter& w, const std::vector<TLE>& tles) {
+        w.put(static_cast<uint64_t>(tles.size()));
+        for (const TLE& t : tles) {
+            w.put(t.name);
+            w.put(t.satellite_number);
+            w.put(t.classification);
+            w.put(t.launch_year);
+            w.put(t.launch_number);
+            w.put(t.launch_piece);
+            w.put(t.epoch_year);
+            w.put(t.epoch_day);
+            w.put(t.mean_motion_derivative);
+            w.put(t.mean_motion_second_derivative);
+            w.put(t.bstar_drag);
+            w.put(t.ephemeris_type);
+            w.put(t.element_set_number);
+            w.put(t.inclination);
+            w.put(t.raan);
+            w.put(t.eccentricity);
+            w.put(t.arg_perigee);
+            w.put(t.mean_anomaly);
+            w.put(t.mean_motion);
+            w.put(t.revolution_number);
+        }
+    }
+
+    static bool restore(ResourceReader& r, std::vector<TLE>& tles) {
+        uint64_t n = 0;
+        if (!r.get(n)) return false;
+        tles.resize(static_cast<size_t>(n));
+        for (TLE& t : tles) {
+            bool ok = r.get(t.name) && r.get(t.satellite_number) && r.get(t.classification) &&
+                      r.get(t.launch_year) && r.get(t.launch_number) && r.get(t.launch_piece) &&
+                      r.get(t.epoch_year) && r.get(t.epoch_day) &&
+                      r.get(t.mean_motion_derivative) &&
+                      r.get(t.mean_motion_second_derivative) && r.get(t.bstar_drag) &&
+                      r.get(t.ephemeris_type) && r.get(t.element_set_number) &&
+                      r.get(t.inclination) && r.get(t.raan) && r.get(t.eccentricity) &&
+                      r.get(t.arg_perigee) && r.get(t.mean_anomaly) && r.get(t.mean_motion) &&
+                      r.get(t.revolution_number);
+            if (!ok) return false;
+        }
+        return true;
+    }
+};
+
+std::shared_ptr<const std::vector<TLE>> TLEParser::load_file(const std::string& filename,
+                                                             const TLEParseOptions& options) {
+    TLEParseOptions quiet = options;
+    quiet.verbose = false;
+    auto tles = ResourceCache::global().load<std::vector<TLE>>(
+        filename,
+        [&quiet](const std::string& path) { return parse_file(path, quiet); },
+        [](const std::vector<TLE>& v) { return v.size(); });
+    if (options.verbose) {
+        std::cout << "Loaded " << tles->size() << " TLEs from " << filename << std::endl;
+    }
+    return tles;
+}
+
+std::vector<TLE> TLEParser::parse_text(std::string_view text, const TLEParseOptions& options,
+                                       const std::string& source) {
+    // Split into three-line entries (lines as std::getline would give them)
+    std::vector<Entry> entries;
+    size_t pos = 0;
+    auto next_line = [&](std::string_view& line) {
+        if (pos >= text.size()) return false;
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        line = text.substr(pos, end - pos);
+        pos = end + 1;
+        return true;
+    };
+
+    Entry entry;
+    while (next_line(entry[0])) {
         // Skip empty lines
-        if (line0.empty() || line0[0] == '#') continue;
-        
+        if (entry[0].empty() || entry[0][0] == '#') continue;
+
         // Read line 1 and line 2
-        if (!std::getline(file, line1) || !std::getline(file, line2)) {
-            std::cerr << "WARNING: Incomplete TLE entry for: " << line0 << std::endl;
+        if (!next_line(entry[1]) || !next_line(entry[2])) {
+            std::cerr << "WARNING: Incomplete TLE entry for: " << entry[0] << std::endl;
             break;
         }
-        
-        // Parse the three-line entry
-        try {
-            TLE tle = parse_three_line(line0, line1, line2);
-            tles.push_back(tle);
-        } catch (const std::exception& e) {
-            std::cerr << "WARNING: Failed to parse TLE for " << line0 
-                      << ": " << e.what() << std::endl;
+        entries.push_back(entry);
+    }
+
+    // Parse in chunks; failures are reported afterwards, in file order
+    const size_t n = entries.size();
+    std::vector<TLE> parsed(n);
+    std::vector<std::string> errors(n);
+    std::vector<char> checksum_ok(n, 1);
+    auto parse_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Entry& e = entries[i];
+            checksum_ok[i] = checksum_valid(e[1]) && checksum_valid(e[2]);
+            try {
+                parsed[i] = parse_three_line(e[0], e[1], e[2]);
+            } catch (const std::exception& ex) {
+                errors[i] = ex.what();
+                if (errors[i].empty()) errors[i] = "parse error";
+            }
         }
+    };
+
+    constexpr size_t CHUNK = 1024;
+    if (options.num_threads != 1 && n > CHUNK) {
+        ThreadPool pool(options.num_threads);
+        size_t chunks = (n + CHUNK - 1) / CHUNK;
+        pool.parallel_for(chunks, [&](size_t c) {
+            parse_range(c * CHUNK, std::min(n, (c + 1) * CHUNK));
+        });
+    } else {
+        parse_range(0, n);
+    }
+
+    // Compact the accepted entries in place
+    size_t kept = 0;
+    size_t bad_checksums = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!errors[i].empty()) {
+            std::cerr << "WARNING: Failed to parse TLE for " << entries[i][0]
+                      << ": " << errors[i] << std::endl;
+            continue;
+        }
+        if (!checksum_ok[i]) {
+            bad_checksums++;
+            if (options.require_checksum) continue;
+        }
+        if (kept != i) parsed[kept] = std::move(parsed[i]);
+        kept++;
+    }
+    parsed.resize(kept);
+    std::vector<TLE>& tles = parsed;
+
+    if (bad_checksums > 0) {
+        std::cerr << "WARNING: " << bad_checksums << " TLE entries in " << source
+                  << " failed the line checksum"
+                  << (options.require_checksum ? " and were skipped" : "") << std::endl;
+    }
+    if (options.verbose) {
+        std::cout << "Loaded " << tles.size() << " TLEs from " << source << std::endl;
     }
-    
-    file.close();
-    std::cout << "Loaded " << tles.size() << " TLEs from " << filename << std::endl;
     return tles;
 }
 
-TLE TLEParser::parse_three_line(const std::string& line0, 
-                                  const std::string& line1, 
-                                  const std::string& line2) {
+TLE TLEParser::parse_three_line(std::string_view line0,
+                                std::string_view line1,
+                                std::string_view line2) {
     TLE tle;
     
     // Line 0: Satellite name
-    tle.name = line0;
     // Trim whitespace
-    tle.name.erase(tle.name.find_last_not_of(" \n\r\t") + 1);
+    size_t name_end = line0.find_last_not_of(" \n\r\t");
+    tle.name = std::string(line0.substr(0, name_end == std::string_view::npos ? 0 : name_end + 1));
     
     // Line 1: Basic orbital elements
     if (line1.length() < 69) {
@@ -61,7 +231,7 @@ TLE TLEParser::parse_three_line(const std::string& line0,
     tle.classification = line1[7];
     tle.launch_year = parse_int(line1, 9, 2);
     tle.launch_number = parse_int(line1, 11, 3);
-    tle.launch_piece = line1.substr(14, 3);
+    tle.launch_piece = std::string(line1.substr(14, 3));
     tle.epoch_year = parse_int(line1, 18, 2);
     tle.epoch_day = parse_decimal(line1, 20, 12);
     tle.mean_motion_derivative = parse_decimal(line1, 33, 10);
@@ -86,46 +256,54 @@ TLE TLEParser::parse_three_line(const std::string& line0,
     return tle;
 }
 
-double TLEParser::parse_decimal(const std::string& str, int start, int length) {
-    std::string substr = str.substr(start, length);
-    // Remove leading/trailing whitespace
-    substr.erase(0, substr.find_first_not_of(" \t"));
-    substr.erase(substr.find_last_not_of(" \t") + 1);
-    
-    if (substr.empty()) return 0.0;
-    return std::stod(substr);
+bool TLEParser::checksum_valid(std::string_view line) {
+    if (line.size() < 69 || line[68] < '0' || line[68] > '9') return false;
+    int sum = 0;
+    for (size_t i = 0; i < 68; i++) {
+        char c = line[i];
+        if (c >= '0' && c <= '9') sum += c - '0';
+        else if (c == '-') sum += 1;
+    }
+    return sum % 10 == line[68] - '0';
+}
+
+double TLEParser::parse_decimal(std::string_view str, int start, int length) {
+    std::string_view f = field(str, start, length);
+    if (f.empty()) return 0.0;
+    return parse_number<double>(f);
 }
 
-double TLEParser::parse_exponential(const std::string& str, int start, int length) {
+double TLEParser::parse_exponential(std::string_view str, int start, int length) {
     // TLE exponential format: -12345-6 means -0.12345e-6
-    std::string substr = str.substr(start, length);
-    
-    // Remove whitespace
-    substr.erase(0, substr.find_first_not_of(" \t"));
-    substr.erase(substr.find_last_not_of(" \t") + 1);
+    std::string_view f = field(str, start, length);
     
-    if (substr.empty() || substr == "00000-0" || substr == "00000+0") return 0.0;
+    if (f.empty() || f == "00000-0" || f == "00000+0") return 0.0;
+    if (f.size() < 2) throw std::invalid_argument("Invalid TLE exponent field");
     
     // Extract sign, mantissa, exponent
-    char sign = (substr[0] == '-') ? '-' : '+';
-    std::string mantissa = substr.substr((substr[0] == '-' || substr[0] == '+') ? 1 : 0, 5);
-    char exp_sign = substr[substr.length() - 2];
-    char exp_digit = substr[substr.length() - 1];
+    char sign = (f[0] == '-') ? '-' : '+';
+    std::string_view mantissa = f.substr((f[0] == '-' || f[0] == '+') ? 1 : 0, 5);
+    char exp_sign = f[f.size() - 2];
+    char exp_digit = f[f.size() - 1];
     
-    // Build proper exponential string
-    std::string value_str = std::string(1, sign) + "0." + mantissa + "e" + exp_sign + exp_digit;
+    // Build proper exponential string: sign "0." mantissa "e" exponent
+    char buf[16];
+    size_t k = 0;
+    buf[k++] = sign;
+    buf[k++] = '0';
+    buf[k++] = '.';
+    for (char c : mantissa) buf[k++] = c;
+    buf[k++] = 'e';
+    buf[k++] = exp_sign;
+    buf[k++] = exp_digit;
     
-    return std::stod(value_str);
+    return parse_number<double>(std::string_view(buf, k));
 }
 
-int TLEParser::parse_int(const std::string& str, int start, int length) {
-    std::string substr = str.substr(start, length);
-    // Remove leading/trailing whitespace
-    substr.erase(0, substr.find_first_not_of(" \t"));
-    substr.erase(substr.find_last_not_of(" \t") + 1);
-    
-    if (substr.empty()) return 0;
-    return std::stoi(substr);
+int TLEParser::parse_int(std::string_view str, int start, int length) {
+    std::string_view f = field(str, start, length);
+    if (f.empty()) return 0;
+    return parse_number<int>(f);
 }
 
 } // namespace sim
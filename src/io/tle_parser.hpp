@@ -1,7 +1,9 @@
 #ifndef TLE_PARSER_HPP
 #define TLE_PARSER_HPP
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <sstream>
@@ -48,8 +50,20 @@ struct TLE {
             revolution_number(0) {}
 };
 
+/**
+ * @brief Options for parsing TLE files
+ */
+struct TLEParseOptions {
+    int num_threads = 1;            // Entries parsed in parallel chunks (0 = all cores)
+    bool require_checksum = false;  // Skip entries whose line checksums fail (else warn)
+    bool verbose = true;            // Print the "Loaded N TLEs" summary
+};
+
 /**
  * @brief Parser for TLE files
+ *
+ * Fields are read in place from their fixed columns (no per-field
+ * strings) with std::from_chars, giving the same values as std::stod.
  */
 class TLEParser {
 public:
@@ -59,6 +73,22 @@ public:
      * @return Vector of parsed TLE structures
      */
     static std::vector<TLE> parse_file(const std::string& filename);
+    static std::vector<TLE> parse_file(const std::string& filename, const TLEParseOptions& options);
+
+    /**
+     * @brief parse_file() through ResourceCache::global(): parsed once per
+     * process, shared afterwards, and with a cache directory read back from
+     * its binary form while the file is unchanged (see resource_cache.hpp)
+     */
+    static std::shared_ptr<const std::vector<TLE>> load_file(
+        const std::string& filename, const TLEParseOptions& options = TLEParseOptions());
+
+    /**
+     * @brief Parse three-line entries from text already in memory
+     * @param source Name used in warnings and the summary
+     */
+    static std::vector<TLE> parse_text(std::string_view text, const TLEParseOptions& options,
+                                       const std::string& source = "<text>");
     
     /**
      * @brief Parse a single three-line TLE entry
@@ -67,14 +97,20 @@ public:
      * @param line2 TLE line 2
      * @return Parsed TLE structure
      */
-    static TLE parse_three_line(const std::string& line0, 
-                                 const std::string& line1, 
-                                 const std::string& line2);
+    static TLE parse_three_line(std::string_view line0,
+                                std::string_view line1,
+                                std::string_view line2);
+
+    /**
+     * @brief Check a TLE line's modulo-10 checksum (column 69: sum of the
+     * digits of columns 1-68, with '-' counting 1)
+     */
+    static bool checksum_valid(std::string_view line);
 
 private:
-    static double parse_decimal(const std::string& str, int start, int length);
-    static double parse_exponential(const std::string& str, int start, int length);
-    static int parse_int(const std::string& str, int start, int length);
+    static double parse_decimal(std::string_view str, int start, int length);
+    static double parse_exponential(std::string_view str, int start, int length);
+    static int parse_int(std::string_view str, int start, int length);
 };
 
 } // namespace sim
@@ -0,0 +1,406 @@
+/**
+ * Trajectory Archive Implementation
+ */
+
+#include "trajectory_archive.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim {
+
+namespace {
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+void put_varint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Quantized position components
+void quantize(const Vec3& p, double quantum, int64_t q[3]) {
+    q[0] = std::llround(p.x / quantum);
+    q[1] = std::llround(p.y / quantum);
+    q[2] = std::llround(p.z / quantum);
+}
+
+} // anonymous namespace
+
+// ─────────────────────────────────────────────────────────────
+// Writer
+// ─────────────────────────────────────────────────────────────
+
+TrajectoryArchiveWriter::~TrajectoryArchiveWriter() {
+    close();
+}
+
+bool TrajectoryArchiveWriter::open(const std::string& filename,
+                                   const std::vector<std::string>& entity_ids,
+                                   const TrajectoryArchiveOptions& options) {
+    close();
+    options_ = options;
+    options_.block_samples = std::max<uint32_t>(1, std::min<uint32_t>(options_.block_samples, 65535));
+    if (!(options_.quantum > 0.0)) options_.quantum = 0.001;
+
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) return false;
+    ok_ = true;
+    offset_ = 0;
+    num_samples_ = 0;
+    num_entities_ = entity_ids.size();
+    windows_.clear();
+    blocks_.clear();
+
+    std::vector<uint32_t> id_end(num_entities_);
+    uint32_t ids_bytes = 0;
+    for (size_t i = 0; i < num_entities_; i++) {
+        ids_bytes += static_cast<uint32_t>(entity_ids[i].size());
+        id_end[i] = ids_bytes;
+    }
+
+    traj::Header header{};
+    std::memcpy(header.magic, traj::MAGIC, 4);
+    header.version = traj::VERSION;
+    header.num_entities = static_cast<uint32_t>(num_entities_);
+    header.block_samples = options_.block_samples;
+    header.quantum = options_.quantum;
+    header.frame = options_.frame;
+    header.ids_bytes = ids_bytes;
+    write(&header, sizeof(header));
+    write(id_end.data(), id_end.size() * sizeof(uint32_t));
+    for (const auto& id : entity_ids) write(id.data(), id.size());
+
+    times_.clear();
+    times_.reserve(options_.block_samples);
+    positions_.assign(static_cast<size_t>(options_.block_samples) * num_entities_, Vec3());
+    first_.assign(num_entities_, 0);
+    count_.assign(num_entities_, 0);
+    closed_.assign(num_entities_, 0);
+    return ok_;
+}
+
+void TrajectoryArchiveWriter::add_sample(double t, const Vec3* positions, const uint8_t* valid) {
+    if (!file_) return;
+    const size_t s = times_.size();
+    times_.push_back(t);
+    std::copy(positions, positions + num_entities_, positions_.begin() + s * num_entities_);
+
+    for (size_t i = 0; i < num_entities_; i++) {
+        if (closed_[i]) continue;
+        bool v = !valid || valid[i];
+        if (!v) {
+            if (count_[i] > 0) closed_[i] = 1;
+        } else if (count_[i] == 0) {
+            first_[i] = static_cast<uint16_t>(s);
+            count_[i] = 1;
+        } else {
+            count_[i]++;
+        }
+    }
+
+    if (times_.size() >= options_.block_samples) flush_window();
+}
+
+void TrajectoryArchiveWriter::flush_window() {
+    if (times_.empty()) return;
+
+    static const char zeros[8] = {};
+    if (offset_ % 8) write(zeros, 8 - offset_ % 8);
+
+    traj::WindowEntry window{};
+    window.offset = offset_;
+    window.t_first = times_.front();
+    window.t_last = times_.back();
+    window.count = static_cast<uint32_t>(times_.size());
+    windows_.push_back(window);
+    write(times_.data(), times_.size() * sizeof(double));
+
+    for (size_t i = 0; i < num_entities_; i++) {
+        traj::BlockEntry block{};
+        if (count_[i] > 0) {
+            scratch_.clear();
+            int64_t prev[3] = {0, 0, 0}, prev2[3] = {0, 0, 0};
+            for (uint32_t k = 0; k < count_[i]; k++) {
+                int64_t q[3];
+                quantize(positions_[(first_[i] + k) * num_entities_ + i], options_.quantum, q);
+                for (int c = 0; c < 3; c++) {
+                    int64_t residual = q[c];
+                    if (k == 1) residual = q[c] - prev[c];
+                    else if (k > 1) residual = q[c] - 2 * prev[c] + prev2[c];
+                    put_varint(scratch_, zigzag(residual));
+                    prev2[c] = prev[c];
+                    prev[c] = q[c];
+                }
+            }
+            block.offset = offset_;
+            block.bytes = static_cast<uint32_t>(scratch_.size());
+            block.first = first_[i];
+            block.count = count_[i];
+            write(scratch_.data(), scratch_.size());
+        }
+        blocks_.push_back(block);
+    }
+
+    num_samples_ += times_.size();
+    times_.clear();
+    std::fill(count_.begin(), count_.end(), 0);
+    std::fill(closed_.begin(), closed_.end(), 0);
+}
+
+bool TrajectoryArchiveWriter::close() {
+    if (!file_) return false;
+    flush_window();
+
+    static const char zeros[8] = {};
+    if (offset_ % 8) write(zeros, 8 - offset_ % 8);
+
+    traj::Footer footer{};
+    footer.index_offset = offset_;
+    footer.num_samples = num_samples_;
+    footer.num_windows = static_cast<uint32_t>(windows_.size());
+    std::memcpy(footer.magic, traj::INDEX_MAGIC, 4);
+    write(windows_.data(), windows_.size() * sizeof(traj::WindowEntry));
+    write(blocks_.data(), blocks_.size() * sizeof(traj::BlockEntry));
+    write(&footer, sizeof(footer));
+
+    bool ok = std::fclose(file_) == 0 && ok_;
+    file_ = nullptr;
+    return ok;
+}
+
+void TrajectoryArchiveWriter::write(const void* data, size_t bytes) {
+    if (bytes == 0) return;
+    if (std::fwrite(data, 1, bytes, file_) != bytes) ok_ = false;
+    offset_ += bytes;
+}
+
+// ─────────────────────────────────────────────────────────────
+// Reader
+// ─────────────────────────────────────────────────────────────
+
+TrajectoryArchive::~TrajectoryArchive() {
+    close();
+}
+
+void TrajectoryArchive::close() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    ids_.clear();
+    windows_ = nullptr;
+    blocks_ = nullptr;
+    num_windows_ = 0;
+    num_samples_ = 0;
+}
+
+bool TrajectoryArchive::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(traj::Header) + sizeof(traj::Footer))) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = static_cast<size_t>(st.st_size);
+
+    auto fail = [this] {
+        close();
+        return false;
+    };
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    traj::Footer footer;
+    std::memcpy(&footer, data_ + size_ - sizeof(footer), sizeof(footer));
+    if (std::memcmp(header_.magic, traj::MAGIC, 4) != 0 || header_.version != traj::VERSION ||
+        std::memcmp(footer.magic, traj::INDEX_MAGIC, 4) != 0 || footer.index_offset % 8 != 0) {
+        return fail();
+    }
+
+    const size_t n = header_.num_entities;
+    const size_t nw = footer.num_windows;
+    const size_t ids_offset = sizeof(traj::Header);
+    const uint64_t data_end = footer.index_offset;
+    if (ids_offset + n * sizeof(uint32_t) + header_.ids_bytes > data_end ||
+        data_end + nw * sizeof(traj::WindowEntry) + nw * n * sizeof(traj::BlockEntry) +
+            sizeof(traj::Footer) != size_) {
+        return fail();
+    }
+
+    ids_.resize(n);
+    const uint8_t* id_bytes = data_ + ids_offset + n * sizeof(uint32_t);
+    uint32_t begin = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t end;
+        std::memcpy(&end, data_ + ids_offset + i * sizeof(uint32_t), sizeof(end));
+        if (end < begin || end > header_.ids_bytes) return fail();
+        ids_[i].assign(reinterpret_cast<const char*>(id_bytes) + begin, end - begin);
+        begin = end;
+    }
+
+    windows_ = reinterpret_cast<const traj::WindowEntry*>(data_ + data_end);
+    blocks_ = reinterpret_cast<const traj::BlockEntry*>(data_ + data_end + nw * sizeof(traj::WindowEntry));
+    for (size_t w = 0; w < nw; w++) {
+        const traj::WindowEntry& window = windows_[w];
+        if (window.offset % 8 != 0 || window.offset + window.count * sizeof(double) > data_end) {
+            return fail();
+        }
+        for (size_t i = 0; i < n; i++) {
+            const traj::BlockEntry& block = blocks_[w * n + i];
+            if (block.count == 0) continue;
+            if (block.offset + block.bytes > data_end || block.first + block.count > window.count) {
+                return fail();
+            }
+        }
+    }
+    num_windows_ = nw;
+    num_samples_ = footer.num_samples;
+    return true;
+}
+
+size_t TrajectoryArchive::find(const std::string& id) const {
+    return static_cast<size_t>(std::find(ids_.begin(), ids_.end(), id) - ids_.begin());
+}
+
+double TrajectoryArchive::start_time() const {
+    return num_windows_ > 0 ? windows_[0].t_first : 0.0;
+}
+
+double TrajectoryArchive::end_time() const {
+    return num_windows_ > 0 ? windows_[num_windows_ - 1].t_last : 0.0;
+}
+
+const double* TrajectoryArchive::window_times(size_t window) const {
+    return reinterpret_cast<const double*>(data_ + windows_[window].offset);
+}
+
+size_t TrajectoryArchive::window_at(double t) const {
+    if (num_windows_ == 0) return 0;
+    size_t lo = 0, hi = num_windows_;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (windows_[mid].t_first <= t) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+bool TrajectoryArchive::read_block(size_t window, size_t entity,
+                                   std::vector<double>& times, std::vector<Vec3>& positions) const {
+    times.clear();
+    positions.clear();
+    if (window >= num_windows_ || entity >= ids_.size()) return false;
+    const traj::BlockEntry& block = blocks_[window * ids_.size() + entity];
+    if (block.count == 0) return true;
+
+    const double* t = window_times(window) + block.first;
+    times.assign(t, t + block.count);
+    positions.resize(block.count);
+
+    const uint8_t* p = data_ + block.offset;
+    const uint8_t* end = p + block.bytes;
+    int64_t prev[3] = {0, 0, 0}, prev2[3] = {0, 0, 0};
+    const double quantum = header_.quantum;
+    for (uint32_t k = 0; k < block.count; k++) {
+        int64_t q[3];
+        for (int c = 0; c < 3; c++) {
+            uint64_t v;
+            if (!get_varint(p, end, v)) return false;
+            int64_t residual = unzigzag(v);
+            if (k == 0) q[c] = residual;
+            else if (k == 1) q[c] = prev[c] + residual;
+            else q[c] = residual + 2 * prev[c] - prev2[c];
+            prev2[c] = prev[c];
+            prev[c] = q[c];
+        }
+        positions[k] = Vec3(q[0] * quantum, q[1] * quantum, q[2] * quantum);
+    }
+    return p == end;
+}
+
+bool TrajectoryArchive::read_range(size_t entity, double t0, double t1,
+                                   std::vector<double>& times, std::vector<Vec3>& positions) const {
+    times.clear();
+    positions.clear();
+    if (num_windows_ == 0 || t1 < t0) return true;
+    std::vector<double> block_times;
+    std::vector<Vec3> block_positions;
+    for (size_t w = window_at(t0); w < num_windows_ && windows_[w].t_first <= t1; w++) {
+        if (!read_block(w, entity, block_times, block_positions)) return false;
+        for (size_t k = 0; k < block_times.size(); k++) {
+            if (block_times[k] < t0 || block_times[k] > t1) continue;
+            times.push_back(block_times[k]);
+            positions.push_back(block_positions[k]);
+        }
+    }
+    return true;
+}
+
+bool TrajectoryArchive::position_at(size_t entity, double t, Vec3& out) const {
+    if (num_windows_ == 0) return false;
+    size_t w = window_at(t);
+
+    // Samples of this window, plus the neighbour's edge sample when t
+    // falls between windows
+    std::vector<double> times, extra_times;
+    std::vector<Vec3> positions, extra_positions;
+    if (!read_block(w, entity, times, positions)) return false;
+    if ((times.empty() || t > times.back()) && w + 1 < num_windows_) {
+        if (!read_block(w + 1, entity, extra_times, extra_positions)) return false;
+        if (!extra_times.empty()) {
+            times.push_back(extra_times.front());
+            positions.push_back(extra_positions.front());
+        }
+    }
+    if ((times.empty() || t < times.front()) && w > 0) {
+        if (!read_block(w - 1, entity, extra_times, extra_positions)) return false;
+        if (!extra_times.empty()) {
+            times.insert(times.begin(), extra_times.back());
+            positions.insert(positions.begin(), extra_positions.back());
+        }
+    }
+    if (times.empty() || t < times.front() || t > times.back()) return false;
+
+    size_t k = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), t) - times.begin());
+    if (k == times.size()) {
+        out = positions.back();
+        return true;
+    }
+    if (k == 0) {
+        out = positions.front();
+        return true;
+    }
+    double span = times[k] - times[k - 1];
+    double f = span > 0.0 ? (t - times[k - 1]) / span : 0.0;
+    const Vec3& a = positions[k - 1];
+    const Vec3& b = positions[k];
+    out = Vec3(a.x + (b.x - a.x) * f, a.y + (b.y - a.y) * f, a.z + (b.z - a.z) * f);
+    return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,271 @@
+/**
+ * Trajectory Archive - Time-indexed binary trajectories (".traj")
+ *
+ * Positions of a fixed set of entities, sampled at common times, stored
+ * so any time window can be read without touching the rest of the file:
+ * samples are grouped into windows of block_samples samples, each window
+ * holds one compressed block per entity, and a fixed-stride index at the
+ * end maps every (window, entity) pair to its bytes. Readers memory-map
+ * the file (TrajectoryArchive) or fetch byte ranges over HTTP
+ * (visualization/cesium/js/trajectory_archive.js).
+ *
+ * Layout (little-endian, as written by the host):
+ *   header   traj::Header (64 bytes)
+ *   ids      u32 id_end[num_entities], then the id bytes, padded to 8
+ *   windows  in time order, each:
+ *              f64 times[count]
+ *              per entity with samples in the window: its block
+ *            (windows start on 8-byte boundaries)
+ *   index    traj::WindowEntry[num_windows]
+ *            traj::BlockEntry[num_windows][num_entities]
+ *   footer   traj::Footer (32 bytes, ends in "TRJI")
+ *
+ * A block holds the entity's contiguous run of samples first .. first +
+ * count - 1 of its window, quantized to `quantum` metres: the first
+ * position, then second differences (q[i] - 2 q[i-1] + q[i-2]; a first
+ * difference for the second sample), each axis as a zigzag varint. Smooth
+ * trajectories thus cost a byte or two per axis per sample. Blocks decode
+ * independently.
+ *
+ * Usage:
+ *   TrajectoryArchiveWriter w;
+ *   w.open("run.traj", ids);
+ *   w.add_sample(t, positions.data());   // Once per sample time
+ *   w.close();
+ *
+ *   EngineTrajectoryRecorder rec;         // Or straight from an engine
+ *   rec.open(engine, "run.traj", 60.0);
+ *   engine.step(dt); rec.update(engine);  // ...
+ *   rec.close();
+ *
+ *   TrajectoryArchive a;
+ *   a.open("run.traj");
+ *   Vec3 p;
+ *   a.position_at(entity, 3.0 * 3600.0, p);
+ */
+
+#ifndef SIM_TRAJECTORY_ARCHIVE_HPP
+#define SIM_TRAJECTORY_ARCHIVE_HPP
+
+#include "core/state_vector.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class SimulationEngine;
+
+namespace traj {
+
+constexpr char MAGIC[4] = {'T', 'R', 'J', 'A'};
+constexpr char INDEX_MAGIC[4] = {'T', 'R', 'J', 'I'};
+constexpr uint32_t VERSION = 1;
+
+enum Frame : uint32_t {
+    FRAME_UNSPECIFIED = 0,
+    FRAME_ECI = 1,
+    FRAME_ECEF = 2
+};
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t num_entities;
+    uint32_t block_samples;   // Samples per window (the last may be short)
+    double   quantum;         // Position resolution [m]
+    uint32_t frame;           // traj::Frame
+    uint32_t ids_bytes;
+    uint32_t reserved[8];
+};
+
+struct WindowEntry {
+    uint64_t offset;          // times[] of the window
+    double   t_first, t_last;
+    uint32_t count;           // Samples in the window
+    uint32_t reserved;
+};
+
+struct BlockEntry {
+    uint64_t offset;          // 0 = no samples in this window
+    uint32_t bytes;
+    uint16_t first;           // First sample of the window covered
+    uint16_t count;
+};
+
+struct Footer {
+    uint64_t index_offset;
+    uint64_t num_samples;     // Sample times in the archive
+    uint32_t num_windows;
+    uint32_t reserved[2];
+    char     magic[4];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "trajectory archive header layout");
+static_assert(sizeof(WindowEntry) == 32, "trajectory archive window entry layout");
+static_assert(sizeof(BlockEntry) == 16, "trajectory archive block entry layout");
+static_assert(sizeof(Footer) == 32, "trajectory archive footer layout");
+
+} // namespace traj
+
+/// Options for TrajectoryArchiveWriter
+struct TrajectoryArchiveOptions {
+    uint32_t block_samples = 256;     // Samples per window (<= 65535)
+    double quantum = 0.001;           // Position resolution [m]
+    traj::Frame frame = traj::FRAME_UNSPECIFIED;
+};
+
+/**
+ * Streaming archive writer: only the open window is held in memory
+ */
+class TrajectoryArchiveWriter {
+public:
+    TrajectoryArchiveWriter() = default;
+    ~TrajectoryArchiveWriter();
+
+    TrajectoryArchiveWriter(const TrajectoryArchiveWriter&) = delete;
+    TrajectoryArchiveWriter& operator=(const TrajectoryArchiveWriter&) = delete;
+
+    /**
+     * Create the archive for entities with the given ids
+     * @return true on success
+     */
+    bool open(const std::string& filename, const std::vector<std::string>& entity_ids,
+              const TrajectoryArchiveOptions& options = TrajectoryArchiveOptions());
+
+    bool is_open() const { return file_ != nullptr; }
+
+    /**
+     * Record every entity's position at time t (non-decreasing).
+     * @param valid Per entity, 0 = no position at this sample (null = all
+     *              valid). Within a window an entity's valid samples must
+     *              be contiguous; valid samples after a gap in the same
+     *              window are dropped.
+     */
+    void add_sample(double t, const Vec3* positions, const uint8_t* valid = nullptr);
+
+    /**
+     * Write the open window and the index, and close the file
+     * @return true if everything was written
+     */
+    bool close();
+
+private:
+    std::FILE* file_ = nullptr;
+    TrajectoryArchiveOptions options_;
+    size_t num_entities_ = 0;
+    uint64_t offset_ = 0;
+    uint64_t num_samples_ = 0;
+    bool ok_ = true;
+
+    // Open window
+    std::vector<double> times_;
+    std::vector<Vec3> positions_;             // [sample][entity]
+    std::vector<uint16_t> first_, count_;     // Per entity run in the window
+    std::vector<uint8_t> closed_;             // Run ended in this window
+
+    std::vector<traj::WindowEntry> windows_;
+    std::vector<traj::BlockEntry> blocks_;    // [window][entity]
+    std::string scratch_;
+
+    void write(const void* data, size_t bytes);
+    void flush_window();
+};
+
+/**
+ * Records a SimulationEngine's entities into an archive, in the manner of
+ * BinaryCheckpoint: the entities present at open() are archived (ids are
+ * their names, or the numeric id when unnamed), one sample per
+ * sample_interval of simulation time. Call update() after each step;
+ * entities removed from the engine stop being sampled.
+ */
+class EngineTrajectoryRecorder {
+public:
+    bool open(const SimulationEngine& engine, const std::string& filename, double sample_interval,
+              const TrajectoryArchiveOptions& options = TrajectoryArchiveOptions());
+
+    /** Sample the engine if sample_interval has elapsed since the last sample */
+    void update(const SimulationEngine& engine);
+
+    bool close() { return writer_.close(); }
+    bool is_open() const { return writer_.is_open(); }
+
+private:
+    TrajectoryArchiveWriter writer_;
+    std::vector<int> entity_ids_;
+    std::vector<Vec3> positions_;
+    std::vector<uint8_t> valid_;
+    double interval_ = 0.0;
+    double next_time_ = 0.0;
+};
+
+/**
+ * Memory-mapped archive reader
+ */
+class TrajectoryArchive {
+public:
+    TrajectoryArchive() = default;
+    ~TrajectoryArchive();
+
+    TrajectoryArchive(const TrajectoryArchive&) = delete;
+    TrajectoryArchive& operator=(const TrajectoryArchive&) = delete;
+
+    /**
+     * Map and validate an archive
+     * @return true on success
+     */
+    bool open(const std::string& filename);
+    void close();
+
+    size_t num_entities() const { return ids_.size(); }
+    const std::string& entity_id(size_t i) const { return ids_[i]; }
+    /** Index of an entity id, or num_entities() */
+    size_t find(const std::string& id) const;
+
+    size_t num_windows() const { return num_windows_; }
+    uint64_t num_samples() const { return num_samples_; }
+    double quantum() const { return header_.quantum; }
+    traj::Frame frame() const { return static_cast<traj::Frame>(header_.frame); }
+    double start_time() const;
+    double end_time() const;
+
+    /** Window holding time t (clamped to the first / last) */
+    size_t window_at(double t) const;
+
+    /**
+     * Decode one entity's samples of a window (empty when it has none)
+     * @return false on a corrupt block
+     */
+    bool read_block(size_t window, size_t entity,
+                    std::vector<double>& times, std::vector<Vec3>& positions) const;
+
+    /** Samples of an entity with t0 <= t <= t1, decoding only the windows involved */
+    bool read_range(size_t entity, double t0, double t1,
+                    std::vector<double>& times, std::vector<Vec3>& positions) const;
+
+    /**
+     * Position at t, linear between the samples around it
+     * @return false outside the entity's samples
+     */
+    bool position_at(size_t entity, double t, Vec3& out) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    traj::Header header_{};
+    std::vector<std::string> ids_;
+    const traj::WindowEntry* windows_ = nullptr;
+    const traj::BlockEntry* blocks_ = nullptr;
+    size_t num_windows_ = 0;
+    uint64_t num_samples_ = 0;
+
+    const double* window_times(size_t window) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_TRAJECTORY_ARCHIVE_HPP
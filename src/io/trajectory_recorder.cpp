@@ -0,0 +1,49 @@
+/**
+ * EngineTrajectoryRecorder Implementation
+ *
+ * Kept apart from trajectory_archive.cpp so that archive users without a
+ * SimulationEngine do not link the engine.
+ */
+
+#include "trajectory_archive.hpp"
+#include "core/simulation_engine.hpp"
+#include <cmath>
+
+namespace sim {
+
+bool EngineTrajectoryRecorder::open(const SimulationEngine& engine, const std::string& filename,
+                                    double sample_interval, const TrajectoryArchiveOptions& options) {
+    const auto& entities = engine.get_all_entities();
+    std::vector<std::string> ids;
+    entity_ids_.clear();
+    for (const auto& e : entities) {
+        entity_ids_.push_back(e->get_id());
+        ids.push_back(e->get_name().empty() ? std::to_string(e->get_id()) : e->get_name());
+    }
+    if (!writer_.open(filename, ids, options)) return false;
+    positions_.assign(ids.size(), Vec3::Zero());
+    valid_.assign(ids.size(), 0);
+    interval_ = sample_interval;
+    next_time_ = engine.get_simulation_time();
+    return true;
+}
+
+void EngineTrajectoryRecorder::update(const SimulationEngine& engine) {
+    if (!writer_.is_open()) return;
+    double t = engine.get_simulation_time();
+    if (t < next_time_) return;
+
+    // Entities keep their order in the engine; match by id, skipping removed ones
+    const auto& entities = engine.get_all_entities();
+    size_t j = 0;
+    for (size_t i = 0; i < entity_ids_.size(); i++) {
+        while (j < entities.size() && entities[j]->get_id() != entity_ids_[i]) j++;
+        valid_[i] = j < entities.size();
+        if (valid_[i]) positions_[i] = entities[j++]->get_state().position;
+        else j = 0;
+    }
+    writer_.add_sample(t, positions_.data(), valid_.data());
+    next_time_ = interval_ > 0.0 ? next_time_ + interval_ * std::floor((t - next_time_) / interval_ + 1.0) : t;
+}
+
+}  // namespace sim
@@ -1,7 +1,7 @@
 /**
  * Launch Profile Sweep
  *
- * Brute-force search over pitch profiles to find one that achieves LEO.
+ * Grid search over pitch profiles to find one that achieves LEO.
  * No solver, no targeting — just propagate and check orbital elements.
  *
  * Sweeps over:
@@ -9,10 +9,14 @@
  *   - S2 turn rate (how quickly to reach horizontal in stage 2)
  *   - S2 propellant (how much of S2 to burn — controls total delta-V)
  *
+ * The grid runs on LaunchSweepEngine: profiles are evaluated in parallel,
+ * abandoned once they impact or run out of energy, and the best cells are
+ * refined. Only the best results are kept for the report.
+ *
  * Reports: SMA, eccentricity, periapsis, apoapsis, altitude at burnout
  */
 
-#include "physics/launch_trajectory_solver.hpp"
+#include "physics/launch_sweep_engine.hpp"
 #include "physics/orbital_elements.hpp"
 #include "coordinate/time_utils.hpp"
 #include <iostream>
@@ -20,6 +24,7 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 static constexpr double PI = 3.14159265358979323846;
 static constexpr double DEG = PI / 180.0;
@@ -38,27 +43,37 @@ struct Result {
     double vel;
 };
 
+// Keep the `limit` lowest-eccentricity results
+static void keep_best(std::vector<Result>& list, const Result& r, size_t limit) {
+    auto pos = std::upper_bound(list.begin(), list.end(), r, [](const Result& a, const Result& b) {
+        return a.ecc < b.ecc;
+    });
+    if (pos - list.begin() >= (long)limit) return;
+    list.insert(pos, r);
+    if (list.size() > limit) list.pop_back();
+}
+
 int main() {
     std::cout << "=== Launch Profile Sweep (3D) ===" << std::endl;
     std::cout << "Finding pitch profiles + S2 propellant that achieve circular LEO\n" << std::endl;
 
-    double epoch_jd = 2460335.0;
     sim::LaunchSite site = sim::LaunchSite::cape_canaveral();
 
     // Azimuth for ~28.5 deg inclination from Cape Canaveral
     double azimuth = 90.0 * DEG;
 
-    std::vector<Result> results;
-
-    // Sweep S2 propellant from 12t to 28t in steps of 2t
-    // Sweep S1_end from 30° to 80° in steps of 5°
-    // Sweep S2_rate from 0.4 to 3.0 in steps of 0.4
-    std::cout << "Sweeping S2_prop=[12t..28t] x S1_end=[30°..80°] x S2_rate=[0.4..3.0]...\n"
-              << std::endl;
+    std::vector<sim::LaunchSweepAxis> axes = {
+        {"s2_prop", 12000.0, 28000.0, 9},
+        {"s1_end", 30.0 * DEG, 80.0 * DEG, 11},
+        {"s2_rate", 0.4, 3.2, 8},
+    };
+    std::cout << "Sweeping S2_prop=[12t..28t] x S1_end=[30°..80°] x S2_rate=[0.4..3.2]"
+              << " + 3 refinement passes...\n" << std::endl;
 
-    for (double s2_prop = 12000.0; s2_prop <= 28000.0; s2_prop += 2000.0) {
-        // Build vehicle with this S2 propellant
-        sim::SolverVehicleConfig vehicle;
+    auto build = [azimuth](const std::vector<double>& p) {
+        double s2_prop = p[0], s1_end = p[1], s2_rate = p[2];
+        sim::LaunchSweepCandidate c;
+        sim::SolverVehicleConfig& vehicle = c.vehicle;
 
         sim::SolverRocketStage s1;
         s1.dry_mass = 20000.0;
@@ -80,69 +95,68 @@ int main() {
         vehicle.drag_coefficient = 0.4;
         vehicle.reference_area = 100.0;
 
-        sim::LaunchSolverConfig config;
-        config.verbose = false;
-        sim::LaunchTrajectorySolver solver(vehicle, site, epoch_jd, config);
-
-        for (double s1_end_deg = 30.0; s1_end_deg <= 80.0; s1_end_deg += 5.0) {
-            for (double s2_rate = 0.4; s2_rate <= 3.2; s2_rate += 0.4) {
-                double s1_end = s1_end_deg * DEG;
-
-                sim::LaunchControls ctrl;
-                ctrl.launch_azimuth = azimuth;
-                ctrl.pitch_s1[0] = 0.05;
-                ctrl.pitch_s1[1] = s1_end - 0.05;
-                ctrl.pitch_s1[2] = 0.0;
-                ctrl.pitch_s2[0] = s1_end;
-                ctrl.pitch_s2[1] = s2_rate;
-                ctrl.pitch_s2[2] = 0.0;
-                ctrl.yaw_s1[0] = 0.0; ctrl.yaw_s1[1] = 0.0;
-                ctrl.yaw_s2[0] = 0.0; ctrl.yaw_s2[1] = 0.0;
-                ctrl.coast_after_burnout = 0.0;
-                ctrl.epoch_offset = 0.0;
-
-                sim::TerminalTarget tgt;
-                tgt.mode = sim::TargetingMode::ORBIT_INSERTION;
-                tgt.target_elements.semi_major_axis = RE + 400000.0;
-                tgt.target_elements.eccentricity = 0.001;
-                tgt.target_elements.inclination = 28.5 * DEG;
-
-                sim::LaunchTrajectorySolution sol = solver.propagate(ctrl, tgt);
-
-                double sma = sol.final_elements.semi_major_axis;
-                double ecc = sol.final_elements.eccentricity;
-                double peri = sma * (1.0 - ecc) - RE;
-                double apo = sma * (1.0 + ecc) - RE;
-
-                Result r;
-                r.s1_end_deg = s1_end_deg;
-                r.s2_rate = s2_rate;
-                r.s2_prop_t = s2_prop / 1000.0;
-                r.sma_km = sma / 1000.0;
-                r.ecc = ecc;
-                r.inc_deg = sol.final_elements.inclination / DEG;
-                r.peri_km = peri / 1000.0;
-                r.apo_km = apo / 1000.0;
-                r.alt_km = sol.final_state.altitude / 1000.0;
-                r.vel = sol.final_state.velocity.norm();
-                results.push_back(r);
-            }
+        sim::LaunchControls& ctrl = c.controls;
+        ctrl.launch_azimuth = azimuth;
+        ctrl.pitch_s1[0] = 0.05;
+        ctrl.pitch_s1[1] = s1_end - 0.05;
+        ctrl.pitch_s1[2] = 0.0;
+        ctrl.pitch_s2[0] = s1_end;
+        ctrl.pitch_s2[1] = s2_rate;
+        ctrl.pitch_s2[2] = 0.0;
+        ctrl.yaw_s1[0] = 0.0; ctrl.yaw_s1[1] = 0.0;
+        ctrl.yaw_s2[0] = 0.0; ctrl.yaw_s2[1] = 0.0;
+        ctrl.coast_after_burnout = 0.0;
+        ctrl.epoch_offset = 0.0;
+        return c;
+    };
+
+    sim::LaunchSweepConfig config;
+    config.epoch_jd = 2460335.0;
+    config.min_perigee_altitude = 150000.0;
+    config.refine_levels = 3;
+    // Refine toward low eccentricity, penalizing perigee below 150 km
+    // (1 per 1000 km) so near-misses still steer the search
+    config.score = [](const sim::LaunchSweepPoint& pt) {
+        double sma_km = pt.elements.semi_major_axis / 1000.0;
+        if (pt.perigee_radius <= 0.0 || sma_km > 8000.0) {
+            return std::numeric_limits<double>::infinity();
         }
-    }
-
-    std::cout << "Total profiles tested: " << results.size() << "\n" << std::endl;
-
-    // Sort by eccentricity and show best with periapsis > 150 km
-    std::vector<Result> good;
-    for (auto& r : results) {
+        double deficit = std::max(0.0, RE + 150000.0 - pt.perigee_radius);
+        return pt.elements.eccentricity + deficit / 1.0e6;
+    };
+
+    std::vector<Result> good, lowest;
+    sim::LaunchSweepEngine engine(site, axes, build, config);
+    engine.run([&](const sim::LaunchSweepPoint& pt) {
+        if (pt.outcome != sim::LaunchScreen::REACHED_END) return;
+
+        double sma = pt.elements.semi_major_axis;
+        double ecc = pt.elements.eccentricity;
+
+        Result r;
+        r.s1_end_deg = pt.params[1] / DEG;
+        r.s2_rate = pt.params[2];
+        r.s2_prop_t = pt.params[0] / 1000.0;
+        r.sma_km = sma / 1000.0;
+        r.ecc = ecc;
+        r.inc_deg = pt.elements.inclination / DEG;
+        r.peri_km = (sma * (1.0 - ecc) - RE) / 1000.0;
+        r.apo_km = (sma * (1.0 + ecc) - RE) / 1000.0;
+        r.alt_km = pt.final_state.altitude / 1000.0;
+        r.vel = pt.final_state.velocity.norm();
+
+        keep_best(lowest, r, 30);
         if (r.peri_km > 150.0 && r.ecc < 0.5 && r.sma_km > 6400.0 && r.sma_km < 8000.0) {
-            good.push_back(r);
+            keep_best(good, r, 40);
         }
-    }
-    std::sort(good.begin(), good.end(), [](const Result& a, const Result& b) {
-        return a.ecc < b.ecc;
     });
 
+    const auto& stats = engine.stats();
+    std::cout << "Total profiles tested: " << stats.evaluated
+              << " (" << stats.impacts << " impacted, " << stats.energy_aborts
+              << " stopped short of orbital energy, " << stats.orbits << " reached orbit)\n"
+              << std::endl;
+
     std::cout << "=== BEST ORBITS (peri>150km, SMA<8000km, sorted by ecc) ===" << std::endl;
     std::cout << std::setw(7) << "S1end"
               << std::setw(7) << "S2rat"
@@ -177,11 +191,7 @@ int main() {
     if (good.empty()) {
         std::cout << "  No matching orbits found!" << std::endl;
         std::cout << "\n  Lowest-ecc results overall:" << std::endl;
-        std::sort(results.begin(), results.end(), [](const Result& a, const Result& b) {
-            return a.ecc < b.ecc;
-        });
-        for (int i = 0; i < 30 && i < (int)results.size(); i++) {
-            auto& r = results[i];
+        for (auto& r : lowest) {
             std::cout << std::fixed
                       << "  S1=" << std::setprecision(0) << r.s1_end_deg << "°"
                       << "  S2rate=" << std::setprecision(1) << r.s2_rate
@@ -83,15 +83,7 @@ StateVector propagate_satellite(const OrbitalElements& initial_elements,
     while (new_M < 0) new_M += 2.0 * PI;
 
     double e = elem.eccentricity;
-    double E = new_M;
-    for (int i = 0; i < 10; i++) {
-        E = new_M + e * std::sin(E);
-    }
-
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
+    double nu = OrbitalMechanics::mean_to_true_anomaly(new_M, e);
 
     elem.true_anomaly = nu;
     elem.mean_anomaly = new_M;
@@ -0,0 +1,590 @@
+/**
+ * mc_bench — Scenario-scale benchmark for the Monte Carlo engine.
+ *
+ * Runs a set of scenarios through MCRunner across thread counts and time
+ * steps and writes one JSON document with, per (scenario, threads, dt):
+ * runs/s, entity-ticks/s, the per-system TickProfiler breakdown, peak RSS
+ * and heap allocations per run. Scenarios are shipped files (--scenario)
+ * or synthetic worlds generated from a size spec (--synthetic):
+ *
+ *   orbital=N    GEO ring of N orbital-combat satellites, two teams, one
+ *                HVA per five, the rest defenders / attackers with KKVs
+ *   aircraft=N   fighters on waypoint patrols, radar and AIM-120/AIM-9
+ *   sams=N       red SAM sites with fire-control radar
+ *   radars=N     red early-warning radars
+ *   events=N     time and proximity triggers (rules changes, no messages)
+ *   seed=S       layout seed
+ *
+ * With no scenario given, three synthetic sizes run. Engine modes under
+ * test are passed through (--cached-kepler, --coast-dt, --lockstep,
+ * --batch-flight, --flight-rk2, --missile-flyout, --swept-contact, --wez, --lod-dt,
+ * --shared-ephemeris, --ephemeris-mb, --tick-threads, --radar-los, --radar-tracks, --comms,
+ * --iads, --ai-decisions, --ai-decision-dt) and apply to every case.
+ *
+ * Measurement notes: allocations count global operator new calls during
+ * the batch (parse excluded) divided by runs; peak RSS is VmHWM after the
+ * case, reset before it where the kernel allows (/proc/self/clear_refs),
+ * otherwise the process high-water mark so far. The profiler adds two
+ * clock reads per system call; --no-profile drops the breakdown.
+ *
+ * Usage:
+ *   mc_bench [--scenario <path>]... [--synthetic SPEC]...
+ *            [--threads 1,2,4] [--dt 0.1,0.05] [--runs N] [--max-time T]
+ *            [--seed S] [--no-profile] [--output <path>] [engine modes]
+ */
+
+#include "montecarlo/mc_runner.hpp"
+#include "montecarlo/scenario_parser.hpp"
+#include "io/json_reader.hpp"
+#include "io/json_writer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ── Allocation counter ──
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using sim::mc::MCConfig;
+using sim::mc::MCRunner;
+using sim::mc::MCWorld;
+using sim::mc::ProfileSystem;
+using sim::mc::TickProfiler;
+
+// ── Process memory ──
+
+/** Try to reset the peak-RSS counter; false if the kernel refuses. */
+bool reset_peak_rss() {
+    std::ofstream f("/proc/self/clear_refs");
+    if (!f) return false;
+    f << "5";
+    return static_cast<bool>(f.flush());
+}
+
+/** VmHWM in KiB (0 when /proc is unavailable). */
+int64_t peak_rss_kb() {
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atoll(line.c_str() + 6);
+    }
+    return 0;
+}
+
+// ── Synthetic scenarios ──
+
+struct SyntheticSpec {
+    int orbital = 0;
+    int aircraft = 0;
+    int sams = 0;
+    int radars = 0;
+    int events = 0;
+    uint32_t seed = 1;
+
+    std::string name() const {
+        std::ostringstream os;
+        os << "synthetic:orbital=" << orbital << ",aircraft=" << aircraft
+           << ",sams=" << sams << ",radars=" << radars << ",events=" << events;
+        return os.str();
+    }
+};
+
+SyntheticSpec parse_spec(const std::string& text) {
+    SyntheticSpec s;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) throw std::runtime_error("Bad synthetic spec item: " + item);
+        std::string k = item.substr(0, eq);
+        int v = std::stoi(item.substr(eq + 1));
+        if (k == "orbital") s.orbital = v;
+        else if (k == "aircraft") s.aircraft = v;
+        else if (k == "sams") s.sams = v;
+        else if (k == "radars") s.radars = v;
+        else if (k == "events") s.events = v;
+        else if (k == "seed") s.seed = static_cast<uint32_t>(v);
+        else throw std::runtime_error("Unknown synthetic spec key: " + k);
+    }
+    return s;
+}
+
+/** Small deterministic generator for layouts (not the sim's RNG). */
+struct Layout {
+    uint32_t state;
+    double uniform(double lo, double hi) {
+        state = state * 1664525u + 1013904223u;
+        return lo + (hi - lo) * (state >> 8) * (1.0 / 16777216.0);
+    }
+};
+
+void write_geo_state(sim::JsonWriter& w, double lat, double lon, double alt,
+                     double speed, double heading) {
+    w.key("initialState").begin_object();
+    w.kv("lat", lat);
+    w.kv("lon", lon);
+    w.kv("alt", alt);
+    w.kv("speed", speed);
+    w.kv("heading", heading);
+    w.kv("gamma", 0.0);
+    w.kv("throttle", 0.8);
+    w.kv("engineOn", true);
+    w.end_object();
+}
+
+void write_radar(sim::JsonWriter& w, double range, double fov) {
+    w.key("sensors").begin_object();
+    w.kv("type", "radar");
+    w.kv("maxRange_m", range);
+    w.kv("fov_deg", fov);
+    w.kv("detectionProbability", 0.9);
+    w.end_object();
+}
+
+/** Scenario JSON text for a synthetic spec. */
+std::string synthetic_scenario(const SyntheticSpec& spec) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, 0);
+    Layout rng{spec.seed};
+    const char* teams[2] = {"blue", "red"};
+
+    // Theatre for the atmospheric entities, blue west of red
+    constexpr double LAT0 = 35.0, LON0 = -117.0;
+
+    w.begin_object();
+    w.key("metadata").begin_object().kv("name", spec.name()).end_object();
+    w.key("entities").begin_array();
+
+    std::vector<std::string> hvas[2];
+    for (int i = 0; i < spec.orbital; i++) {
+        int team = i & 1;
+        int k = i / 2;
+        bool hva = k % 5 == 0;
+        std::string id = std::string(teams[team]) + "-sat-" + std::to_string(k);
+        if (hva) hvas[team].push_back(id);
+
+        w.begin_object();
+        w.kv("id", id);
+        w.kv("name", id);
+        w.kv("type", "satellite");
+        w.kv("team", teams[team]);
+        w.key("initialState").begin_object().end_object();
+        w.key("components").begin_object();
+        w.key("physics").begin_object();
+        w.kv("type", "orbital_2body");
+        w.kv("source", "elements");
+        w.kv("sma", 42164000.0 + rng.uniform(-20000.0, 20000.0));
+        w.kv("ecc", 0.0001);
+        w.kv("inc", rng.uniform(0.0, 0.05));
+        w.kv("raan", 0.0);
+        w.kv("argPerigee", 0.0);
+        // Teams interleave along a 20 degree arc so scans find hostiles
+        w.kv("meanAnomaly", rng.uniform(0.0, 20.0));
+        w.end_object();
+        w.key("ai").begin_object();
+        w.kv("type", "orbital_combat");
+        w.kv("role", hva ? "hva" : (k % 5 < 3 ? "defender" : "attacker"));
+        w.kv("sensorRange", 1000000.0);
+        w.kv("defenseRadius", 500000.0);
+        w.kv("maxAccel", 50.0);
+        w.kv("killRange", 50000.0);
+        w.kv("scanInterval", 1.0);
+        if (!hva && !hvas[team].empty()) w.kv("assignedHvaId", hvas[team].back());
+        w.end_object();
+        if (!hva) {
+            w.key("weapons").begin_object();
+            w.kv("type", "kinetic_kill");
+            w.kv("Pk", 0.7);
+            w.kv("killRange", 50000.0);
+            w.kv("cooldown", 5.0);
+            w.end_object();
+        }
+        w.end_object();
+        w.end_object();
+    }
+
+    for (int i = 0; i < spec.aircraft; i++) {
+        int team = i & 1;
+        std::string id = std::string(teams[team]) + "-ac-" + std::to_string(i / 2);
+        double side = team == 0 ? -1.0 : 1.0;
+        double lat = LAT0 + rng.uniform(-1.5, 1.5);
+        double lon = LON0 + side * rng.uniform(0.5, 2.5);
+
+        w.begin_object();
+        w.kv("id", id);
+        w.kv("name", id);
+        w.kv("type", "aircraft");
+        w.kv("team", teams[team]);
+        write_geo_state(w, lat, lon, rng.uniform(6000.0, 10000.0), 250.0,
+                        team == 0 ? 90.0 : 270.0);
+        w.key("components").begin_object();
+        w.key("physics").begin_object().kv("type", "flight3dof").kv("config", "f16").end_object();
+        w.key("ai").begin_object();
+        w.kv("type", "waypoint_patrol");
+        w.key("waypoints").begin_array();
+        for (int p = 0; p < 4; p++) {
+            w.begin_object();
+            w.kv("lat", lat + rng.uniform(-0.8, 0.8));
+            w.kv("lon", LON0 + side * rng.uniform(0.0, 2.0));
+            w.kv("alt", rng.uniform(6000.0, 10000.0));
+            w.kv("speed", 250.0);
+            w.end_object();
+        }
+        w.end_array();
+        w.kv("loopMode", "cycle");
+        w.end_object();
+        write_radar(w, 150000.0, 120.0);
+        w.key("weapons").begin_object();
+        w.kv("type", "fighter_loadout");
+        w.key("loadout").begin_array();
+        for (const char* round : {"aim120", "aim120", "aim9", "aim9"}) w.value(round);
+        w.end_array();
+        w.end_object();
+        w.end_object();
+        w.end_object();
+    }
+
+    auto ground_site = [&](const std::string& id, bool sam) {
+        w.begin_object();
+        w.kv("id", id);
+        w.kv("name", id);
+        w.kv("type", "ground");
+        w.kv("team", "red");
+        write_geo_state(w, LAT0 + rng.uniform(-2.0, 2.0), LON0 + rng.uniform(0.0, 3.0),
+                        0.0, 0.0, 0.0);
+        w.key("components").begin_object();
+        write_radar(w, sam ? 200000.0 : 300000.0, 360.0);
+        if (sam) {
+            w.key("weapons").begin_object();
+            w.kv("type", "sam_battery");
+            w.kv("maxRange_m", 150000.0);
+            w.kv("minRange_m", 5000.0);
+            w.kv("engagementRules", "weapons_free");
+            w.end_object();
+        }
+        w.end_object();
+        w.end_object();
+    };
+    for (int i = 0; i < spec.sams; i++) ground_site("red-sam-" + std::to_string(i), true);
+    for (int i = 0; i < spec.radars; i++) ground_site("red-ew-" + std::to_string(i), false);
+    w.end_array();
+
+    // Events: alternate time and proximity triggers; actions flip a
+    // SAM's rules (or are no-ops) so the run prints nothing
+    w.key("events").begin_array();
+    for (int i = 0; i < spec.events; i++) {
+        w.begin_object();
+        w.kv("id", "evt-" + std::to_string(i));
+        w.key("trigger").begin_object();
+        if (i % 2 == 0 || spec.aircraft < 2) {
+            w.kv("type", "time");
+            w.kv("time", 10.0 * (i + 1));
+        } else {
+            int a = (i * 7) % spec.aircraft;
+            int b = (a + 1) % spec.aircraft;
+            auto ac_id = [&](int n) {
+                return std::string(teams[n & 1]) + "-ac-" + std::to_string(n / 2);
+            };
+            w.kv("type", "proximity");
+            w.kv("entityA", ac_id(a));
+            w.kv("entityB", ac_id(b));
+            w.kv("range_m", 50000.0);
+        }
+        w.end_object();
+        w.key("action").begin_object();
+        w.kv("type", "set_state");
+        w.kv("entity", spec.sams > 0 ? "red-sam-" + std::to_string(i % spec.sams) : "");
+        w.kv("field", "engagementRules");
+        w.kv("value", i % 4 == 0 ? "weapons_hold" : "weapons_free");
+        w.end_object();
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    return os.str();
+}
+
+// ── Benchmark cases ──
+
+struct Case {
+    std::string name;
+    std::string source;      // "synthetic" or "file"
+    MCWorld prototype;
+};
+
+std::vector<double> parse_list(const std::string& text) {
+    std::vector<double> out;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) out.push_back(std::stod(item));
+    return out;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "Scenarios (default: three synthetic sizes):\n"
+              << "  --scenario <path>    Shipped scenario file (repeatable)\n"
+              << "  --synthetic SPEC     e.g. orbital=200,aircraft=40,sams=8,radars=4,events=20\n"
+              << "                       (repeatable; keys: orbital aircraft sams radars events seed)\n\n"
+              << "Sweep:\n"
+              << "  --threads LIST       Worker thread counts (default: 1)\n"
+              << "  --dt LIST            Time steps in s (default: 0.1)\n"
+              << "  --runs N             Runs per case (default: 20)\n"
+              << "  --max-time T         Sim seconds per run (default: 120)\n"
+              << "  --seed S             Base seed (default: 42)\n"
+              << "  --no-profile         Skip the per-system breakdown\n"
+              << "  --output <path>      Write the report here (default: stdout)\n\n"
+              << "Engine modes (applied to every case):\n"
+              << "  --cached-kepler --coast-dt C --lockstep K --batch-flight --flight-rk2\n"
+              << "  --missile-flyout --swept-contact --wez DIR --lod-dt L --radar-los\n"
+              << "  --radar-tracks --comms --iads --ai-decisions --ai-decision-dt D\n"
+              << "  --shared-ephemeris --ephemeris-mb MB --tick-threads N\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> scenario_paths;
+    std::vector<SyntheticSpec> synthetic;
+    std::vector<double> thread_counts{1};
+    std::vector<double> dts{0.1};
+    MCConfig base;
+    base.num_runs = 20;
+    base.max_sim_time = 120.0;
+    bool profile = true;
+    std::string output_path;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_next = i + 1 < argc;
+            if (arg == "--scenario" && has_next) {
+                scenario_paths.push_back(argv[++i]);
+            } else if (arg == "--synthetic" && has_next) {
+                synthetic.push_back(parse_spec(argv[++i]));
+            } else if (arg == "--threads" && has_next) {
+                thread_counts = parse_list(argv[++i]);
+            } else if (arg == "--dt" && has_next) {
+                dts = parse_list(argv[++i]);
+            } else if (arg == "--runs" && has_next) {
+                base.num_runs = std::stoi(argv[++i]);
+            } else if (arg == "--max-time" && has_next) {
+                base.max_sim_time = std::stod(argv[++i]);
+            } else if (arg == "--seed" && has_next) {
+                base.base_seed = std::stoi(argv[++i]);
+            } else if (arg == "--no-profile") {
+                profile = false;
+            } else if (arg == "--output" && has_next) {
+                output_path = argv[++i];
+            } else if (arg == "--cached-kepler") {
+                base.cached_kepler = true;
+            } else if (arg == "--coast-dt" && has_next) {
+                base.coast_dt = std::stod(argv[++i]);
+                base.cached_kepler = true;
+            } else if (arg == "--lockstep" && has_next) {
+                base.lockstep = std::stoi(argv[++i]);
+                if (base.lockstep > 1) base.cached_kepler = true;
+            } else if (arg == "--batch-flight") {
+                base.batch_flight = true;
+            } else if (arg == "--flight-rk2") {
+                base.flight_rk2 = true;
+            } else if (arg == "--missile-flyout") {
+                base.missile_flyout = true;
+            } else if (arg == "--swept-contact") {
+                base.swept_contact = true;
+            } else if (arg == "--wez" && has_next) {
+                base.wez_dir = argv[++i];
+            } else if (arg == "--lod-dt" && has_next) {
+                base.lod_dt = std::stod(argv[++i]);
+            } else if (arg == "--shared-ephemeris") {
+                base.shared_ephemeris = true;
+            } else if (arg == "--ephemeris-mb" && has_next) {
+                base.ephemeris_mb = std::stod(argv[++i]);
+                base.shared_ephemeris = true;
+            } else if (arg == "--tick-threads" && has_next) {
+                base.tick_threads = std::stoi(argv[++i]);
+            } else if (arg == "--radar-los") {
+                base.radar_los = true;
+            } else if (arg == "--radar-tracks") {
+                base.radar_tracks = true;
+            } else if (arg == "--comms") {
+                base.comms = true;
+            } else if (arg == "--iads") {
+                base.iads = true;
+            } else if (arg == "--ai-decisions") {
+                base.ai_decisions = true;
+            } else if (arg == "--ai-decision-dt" && has_next) {
+                base.ai_decision_dt = std::stod(argv[++i]);
+                base.ai_decisions = true;
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (scenario_paths.empty() && synthetic.empty()) {
+        synthetic.push_back(parse_spec("orbital=40,aircraft=8,sams=2,radars=2,events=4"));
+        synthetic.push_back(parse_spec("orbital=400,aircraft=40,sams=8,radars=4,events=20"));
+        synthetic.push_back(parse_spec("orbital=2000,aircraft=100,sams=20,radars=10,events=50"));
+    }
+
+    // Parse every case up front so parse allocations stay out of the counts
+    std::vector<Case> cases;
+    try {
+        for (const auto& path : scenario_paths) {
+            cases.push_back({path, "file",
+                             sim::mc::ScenarioParser::parse_file(path)});
+        }
+        for (const auto& spec : synthetic) {
+            cases.push_back({spec.name(), "synthetic",
+                             sim::mc::ScenarioParser::parse(
+                                 sim::JsonReader::parse(synthetic_scenario(spec)))});
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Scenario error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::ofstream file_out;
+    if (!output_path.empty()) {
+        file_out.open(output_path);
+        if (!file_out) {
+            std::cerr << "Error: cannot open output file " << output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = output_path.empty() ? std::cout : file_out;
+
+    sim::JsonWriter w(out);
+    w.begin_object();
+    w.kv("bench", "mc_bench");
+    w.key("config").begin_object();
+    w.kv("runs", base.num_runs);
+    w.kv("maxTime", base.max_sim_time);
+    w.kv("seed", base.base_seed);
+    w.kv("cachedKepler", base.cached_kepler);
+    w.kv("coastDt", base.coast_dt);
+    w.kv("lockstep", base.lockstep);
+    w.kv("batchFlight", base.batch_flight);
+    w.kv("flightRk2", base.flight_rk2);
+    w.kv("missileFlyout", base.missile_flyout);
+    w.kv("sweptContact", base.swept_contact);
+    w.kv("wezDir", base.wez_dir);
+    w.kv("lodDt", base.lod_dt);
+    w.kv("sharedEphemeris", base.shared_ephemeris);
+    w.kv("ephemerisMb", base.ephemeris_mb);
+    w.kv("tickThreads", base.tick_threads);
+    w.kv("radarLos", base.radar_los);
+    w.kv("radarTracks", base.radar_tracks);
+    w.kv("comms", base.comms);
+    w.kv("iads", base.iads);
+    w.kv("aiDecisions", base.ai_decisions);
+    w.kv("aiDecisionDt", base.ai_decision_dt);
+    w.end_object();
+    w.key("cases").begin_array();
+
+    for (const Case& c : cases) {
+        for (double threads : thread_counts) {
+            for (double dt : dts) {
+                MCConfig config = base;
+                config.num_threads = static_cast<int>(threads);
+                config.dt = dt;
+
+                std::cerr << "[bench] " << c.name << " threads=" << config.num_threads
+                          << " dt=" << dt << "\n";
+
+                TickProfiler profiler;
+                MCRunner runner(config);
+                if (profile) runner.set_profiler(&profiler);
+
+                const bool peak_reset = reset_peak_rss();
+                const size_t entities = c.prototype.entity_count();
+                int runs = 0;
+                int errors = 0;
+                double entity_ticks = 0.0;
+
+                const uint64_t allocs0 = g_allocations.load(std::memory_order_relaxed);
+                auto t0 = std::chrono::steady_clock::now();
+                runner.run_streaming(c.prototype, [&](sim::mc::RunResult& r) {
+                    runs++;
+                    if (!r.error.empty()) errors++;
+                    entity_ticks += static_cast<double>(entities) *
+                                    std::round(r.sim_time_final / dt);
+                });
+                double wall = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - t0).count();
+                const uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs0;
+
+                w.begin_object();
+                w.kv("name", c.name);
+                w.kv("source", c.source);
+                w.kv("entities", entities);
+                w.kv("threads", config.num_threads);
+                w.kv("dt", dt);
+                w.kv("runs", runs);
+                w.kv("errors", errors);
+                w.kv("wallSeconds", wall);
+                w.kv("runsPerSecond", wall > 0.0 ? runs / wall : 0.0);
+                w.kv("entityTicksPerSecond", wall > 0.0 ? entity_ticks / wall : 0.0);
+                w.kv("allocsPerRun", runs > 0 ? static_cast<double>(allocs) / runs : 0.0);
+                w.kv("peakRssKb", peak_rss_kb());
+                w.kv("peakRssReset", peak_reset);
+
+                if (profile) {
+                    const auto totals = profiler.totals();
+                    const double tick_ns = static_cast<double>(
+                        totals[static_cast<size_t>(ProfileSystem::TICK)].ns);
+                    w.key("systems").begin_array();
+                    for (size_t s = 0; s < TickProfiler::NUM_SYSTEMS; s++) {
+                        const TickProfiler::Totals& t = totals[s];
+                        if (t.calls == 0) continue;
+                        w.begin_object();
+                        w.kv("name", sim::mc::profile_system_name(static_cast<ProfileSystem>(s)));
+                        w.kv("calls", static_cast<int64_t>(t.calls));
+                        w.kv("ms", t.ns * 1e-6);
+                        w.kv("shareOfTick", tick_ns > 0.0 ? t.ns / tick_ns : 0.0);
+                        w.kv("nsPerEntity", t.entities > 0
+                                 ? static_cast<double>(t.ns) / t.entities : 0.0);
+                        w.end_object();
+                    }
+                    w.end_array();
+                }
+                w.end_object();
+            }
+        }
+    }
+
+    w.end_array();
+    w.end_object();
+    out << "\n";
+    return 0;
+}
@@ -6,21 +6,150 @@
  * compatible with the browser MC Analysis panel.
  *
  * Replay mode: single run with trajectory sampling for Cesium playback.
+ * Batch results stream out as runs finish, as JSON or as the columnar
+ * binary format (--format binary); --to-json converts the latter back.
+ * --format store writes an indexed store (.mcrs) instead: survival
+ * bitmaps, sorted death-time columns and engagement rows, which
+ * --store-query filters and aggregates without a re-scan (see
+ * mc_results_store.hpp).
+ * --format aggregate folds runs into survival / kill-chain / timing
+ * statistics as they finish and writes only the summary.
+ * --snapshot-every / --snapshot-interval add the same statistics, as
+ * compact delta "snapshot" lines, to the --progress stream while the
+ * batch runs, whatever the output format (see AggregateSnapshots).
+ * --ci-half-width stops the batch early once the 95% interval of each
+ * --ci-metric (default: HVA survival) is narrow enough; the results carry
+ * a "convergence" section with the achieved precision and run count.
+ * --serve keeps the engine resident on a Unix socket and runs queued jobs
+ * against cached scenario prototypes (see mc_daemon.hpp).
+ * --live runs one simulation in real time (--live-scale) and streams
+ * binary state deltas over WebSocket to live_sim_viewer.html?stream=...,
+ * applying viewers' control and maneuver commands between ticks (see
+ * mc_live_server.hpp).
+ * --doe runs a parameter sweep in-process: the scenario is parsed once and
+ * every (permutation, seed) pair shares one thread pool (see mc_doe.hpp).
+ * --antithetic and --lhs trade independent runs for correlated designs with
+ * the matching estimators in a "varianceReduction" section (see
+ * mc_variance.hpp); --lhs stratifies the scenario's "uncertainties".
+ * --branch-at / --branch-first-draw simulate the shared prefix once and
+ * fork the runs from snapshots of it, level by level (see mc_runner.hpp).
+ * --checkpoint writes the completed run prefix to a sidecar file at
+ * intervals, and --resume restarts a killed batch after it with the same
+ * results as an uninterrupted one (see mc_checkpoint.hpp).
+ * --training writes a --doe sweep's per-permutation metric means as a
+ * surrogate training set, --fit-surrogate fits a Gaussian process to it,
+ * and --surrogate answers --query points from the model in microseconds,
+ * running any point whose predictive std exceeds --max-std for real
+ * against the --doe spec instead (see mc_surrogate.hpp).
+ * --split-target estimates a rare kill probability by multilevel splitting
+ * instead of plain runs (see mc_splitting.hpp).
+ * --run-step-budget / --run-wall-budget stop a run that takes more ticks
+ * or wall time than that, keeping its partial results under a
+ * "Run budget: ..." error; --tail-report prints the slowest runs with
+ * their per-system time and writes them as JSON (see mc_tail_report.hpp).
+ * --profile times every system call of every tick, prints a per-system
+ * summary to stderr and writes a Chrome trace (see mc_profiler.hpp); the
+ * summary also lists current and peak bytes per memory-accounted
+ * subsystem (see utils/memory_accounting.hpp).
+ * --memory-budget caps a subsystem's accounted bytes: allocations past it
+ * fail the run with an error naming the subsystem, and a buffered
+ * --replay whose trajectories would not fit streams instead.
+ * --replay-from re-simulates selected runs of a finished batch (results
+ * JSON or .mcrb) in parallel, each with a ReplayWriter, into a bundle
+ * directory: one replay per run plus bundle.json listing them. --select
+ * filters the runs, --rank orders them and --limit keeps the first N (see
+ * mc_replay_select.hpp); pass the batch's own flags so each re-simulation
+ * is the same run.
+ * --scenario-cache keeps parsed scenarios on disk by content hash, so an
+ * unchanged scenario skips its entity parse (see scenario_cache.hpp).
+ * --shard-listen spreads a batch or --doe sweep over --shard-worker
+ * processes on other nodes and merges their aggregates (see mc_shard.hpp).
+ * --metrics serves Prometheus metrics over HTTP while any mode runs: runs
+ * completed, entity ticks, per-system tick time (every --metrics-sample'th
+ * tick unless --profile times them all), daemon queue depth, shard
+ * progress, IPC bytes and heap size (see distributed/metrics.hpp).
  *
  * Usage:
  *   mc_engine --scenario <path> [--runs N] [--seed S] [--max-time T]
- *             [--dt D] [--output <path>] [--verbose]
+ *             [--dt D] [--threads N] [--numa] [--pin-threads]
+ *             [--cached-kepler] [--coast-dt C]
+ *             [--lockstep K] [--batch-flight] [--flight-rk2] [--missile-flyout]
+ *             [--lod-dt L] [--shared-ephemeris] [--ephemeris-mb MB]
+ *             [--tick-threads N]
+ *             [--swept-contact] [--wez <dir>]
+ *             [--radar-los] [--radar-tracks] [--comms] [--iads]
+ *             [--ai-decisions] [--ai-decision-dt D]
+ *             [--format json|binary|aggregate|store] [--output <path>] [--verbose]
+ *             [--progress [--snapshot-every N] [--snapshot-interval S]]
+ *             [--ci-half-width W] [--ci-metric SPEC]... [--ci-block N]
+ *             [--rng mulberry32|philox] [--antithetic] [--lhs]
+ *             [--branch-at T]... [--branch-fanout F]... [--branch-first-draw]
+ *             [--checkpoint <path>] [--checkpoint-interval S] [--resume]
+ *             [--split-target ID [--split-distance D]...]
+ *             [--run-step-budget N] [--run-wall-budget S]
+ *             [--tail-report <tail.json>] [--tail-runs N]
+ *             [--profile <trace.json>] [--scenario-cache <dir>]
+ *   mc_engine --to-json <results.mcrb> [--output <path>]
+ *   mc_engine --store-query <results.mcrs> [--where EXPR] [--agg A]...
+ *             [--output <path>] [--verbose]
+ *   mc_engine --serve <socket> [--threads N] [--cache-size N]
+ *             [--scenario-cache <dir>] [--verbose]
+ *   mc_engine --doe <spec.json> [--scenario <path>] [--runs N] [--seed S]
+ *             [--threads N] [--output <path>] [--progress]
+ *             [--training <set.json>] [--ci-metric SPEC]...
+ *   mc_engine --fit-surrogate <set.json> [--output <model.json>]
+ *   mc_engine --surrogate <model.json> --query V1,V2,...  [--query ...]
+ *             [--max-std S --doe <spec.json> [--runs N] [--threads N]]
+ *   mc_engine --shard-listen <addr> [--shard-workers N] [--shard-unit N]
+ *             (--scenario <path> | --doe <spec.json>) [batch options]
+ *   mc_engine --shard-worker <addr> [--threads N] [--verbose]
+ *   (any mode) [--metrics <addr>] [--metrics-sample N]
+ *              [--memory-budget [replay|fom_frames|json_dom|mc_entities|ephemeris=]MB]...
  *   mc_engine --replay --scenario <path> [--seed S] [--max-time T]
  *             [--sample-interval I] [--output <path>] [--verbose]
+ *             [--replay-stream] [--replay-chunk K] [--replay-quantum Q]
+ *             [--replay-error E] [--replay-max-gap G] [--archive <path>]
+ *             [--replay-tiles <dir>] [--replay-tile-samples N] [--replay-tile-group N]
+ *             [--profile <trace.json>]
+ *   mc_engine --live <port|addr> --scenario <path> [--seed S] [--max-time T]
+ *             [--dt D] [--live-scale S] [--live-fps F] [--live-tolerance M]
+ *             [--verbose]
+ *   mc_engine --replay-from <results> --scenario <path> --output <dir>
+ *             [--select FILTER]... [--rank KEY] [--limit N] [--threads N]
+ *             [--sample-interval I] [--replay-stream] [batch flags]
  */
 
 #include "montecarlo/mc_runner.hpp"
 #include "montecarlo/mc_results.hpp"
+#include "montecarlo/mc_results_bin.hpp"
+#include "montecarlo/mc_results_store.hpp"
+#include "montecarlo/mc_aggregate.hpp"
+#include "montecarlo/mc_checkpoint.hpp"
+#include "montecarlo/mc_doe.hpp"
+#include "montecarlo/scenario_cache.hpp"
+#include "montecarlo/mc_daemon.hpp"
+#include "montecarlo/mc_live_server.hpp"
+#include "montecarlo/mc_shard.hpp"
+#include "montecarlo/mc_splitting.hpp"
+#include "montecarlo/mc_surrogate.hpp"
+#include "montecarlo/mc_replay_select.hpp"
+#include "montecarlo/scenario_parser.hpp"
+#include "distributed/metrics.hpp"
 #include "io/json_reader.hpp"
+#include "io/async_output.hpp"
+#include "io/json_writer.hpp"
+#include "utils/memory_accounting.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <sys/stat.h>
 
 static void print_usage(const char* prog) {
     std::cerr << "Usage: " << prog << " --scenario <path> [options]\n"
@@ -28,6 +157,24 @@ static void print_usage(const char* prog) {
               << "Modes:\n"
               << "  (default)          Batch Monte Carlo mode\n"
               << "  --replay           Single-run replay mode (trajectory output)\n"
+              << "  --replay-from <path> Replay bundle: re-simulate selected runs of a batch\n"
+              << "                       results file into the --output directory\n"
+              << "  --to-json <path>     Convert binary results to JSON and exit\n"
+              << "  --store-query <path> Query a --format store results file and exit:\n"
+              << "                       --where EXPR selects runs (survived:<id>, lost:<id>,\n"
+              << "                       destroyed:<id>, died:<id><T, t<T, error, ok; '&', '|',\n"
+              << "                       '!'), --agg adds count, survival, deaths:<id>, weapons\n"
+              << "                       or runs[:N] (repeatable)\n"
+              << "  --doe <spec.json>    In-process parameter sweep (see mc_doe.hpp)\n"
+              << "  --fit-surrogate <set.json>  Fit a GP surrogate to a --training set\n"
+              << "  --surrogate <model.json>    Answer --query points from a fitted surrogate\n"
+              << "  --serve <socket>     Resident job daemon on a Unix socket (see mc_daemon.hpp)\n"
+              << "  --live <port|addr>   Stream one real-time run to live_sim_viewer.html over\n"
+              << "                       WebSocket (port, tcp://host:port or tls:// for wss)\n"
+              << "  --shard-listen <addr>  Coordinate a batch or --doe sweep across shard\n"
+              << "                       workers (Unix path, tcp://host:port or tls://host:port);\n"
+              << "                       writes the aggregate document (see mc_shard.hpp)\n"
+              << "  --shard-worker <addr>  Run work units for a shard coordinator\n"
               << "\n"
               << "Options:\n"
               << "  --scenario <path>    Scenario JSON file (required)\n"
@@ -36,14 +183,987 @@ static void print_usage(const char* prog) {
               << "  --max-time T         Max sim time in seconds (default: 600)\n"
               << "  --dt D               Timestep in seconds (default: 0.1)\n"
               << "  --sample-interval I  Replay: seconds between samples (default: 2.0)\n"
-              << "  --output <path>      Output JSON file (default: stdout)\n"
+              << "  --replay-stream      Replay: chunked, delta-encoded replay_v2 (JSON Lines)\n"
+              << "  --replay-chunk K     Replay: samples per streamed chunk (default: 64)\n"
+              << "  --replay-quantum Q   Replay: streamed position resolution in m (default: 1)\n"
+              << "  --replay-error E     Replay: adaptive streaming, keep samples only where\n"
+              << "                       Hermite interpolation errs by > E m; --sample-interval\n"
+              << "                       is then the candidate spacing (e.g. 0.2)\n"
+              << "  --replay-max-gap G   Replay: adaptive, max seconds between kept samples (default: 60)\n"
+              << "  --archive <path>     Replay: also write a time-indexed trajectory archive (.traj)\n"
+              << "  --replay-tiles <dir> Replay: also write multi-resolution time tiles with a\n"
+              << "                       keyframe index (tiles.json manifest); implies --replay-stream\n"
+              << "  --replay-tile-samples N  Replay tiles: samples per tile (default: 256)\n"
+              << "  --replay-tile-group N    Replay tiles: entities per tile file (default: 64)\n"
+              << "  --select F           Bundle: keep runs matching F (all must hold): hva-lost,\n"
+              << "                       lost:<id>, survived:<id>, win:<team>, error, ok\n"
+              << "  --rank K             Bundle: order by duration, engagements, kills,\n"
+              << "                       launches (highest first) or index (default)\n"
+              << "  --limit N            Bundle: replays to write (default: 20)\n"
+              << "  --threads N          Batch: worker threads, 0 = all cores (default: 1)\n"
+              << "  --numa               Keep workers on the caller's NUMA node first; steal\n"
+              << "                       across nodes only when a node runs dry\n"
+              << "  --pin-threads        Also pin each worker to one core (implies --numa)\n"
+              << "  --cached-kepler      Coast orbits on cached elements (faster, not JS-bitwise)\n"
+              << "  --lockstep K         Advance K runs per worker in lockstep, orbits in one\n"
+              << "                       batch (implies --cached-kepler; default: 1)\n"
+              << "  --coast-dt C         Update passive orbits every C s, on demand otherwise\n"
+              << "  --batch-flight       Batch aircraft physics on a tabulated atmosphere\n"
+              << "                       (faster, not bitwise)\n"
+              << "  --flight-rk2         Aircraft take Heun steps, sub-stepped in hard turns\n"
+              << "                       and at high dynamic pressure (not bitwise)\n"
+              << "  --missile-flyout     Fly SAM/A2A shots as PN-guided missiles; hits need\n"
+              << "                       a closest approach inside the fuze radius\n"
+              << "  --swept-contact      Kinetic kills and proximity triggers test the\n"
+              << "                       closest approach over each tick (not bitwise)\n"
+              << "  --wez <dir>          SAM/A2A shots read reach and time of flight from\n"
+              << "                       the WEZ tables in dir (see wez_gen; not bitwise),\n"
+              << "                       orbital targets from its intercept tables\n"
+              << "                       (see intercept_gen)\n"
+              << "  --lod-dt L           Step aircraft outside every hostile envelope once\n"
+              << "                       per L s (per-run error estimate under \"lod\")\n"
+              << "  --shared-ephemeris   Tabulate entities no random draw can move once per\n"
+              << "                       prototype; runs replay them until perturbed\n"
+              << "  --ephemeris-mb MB    Shared ephemeris size cap (default: 256)\n"
+              << "  --tick-threads N     Run each tick's independent systems and entity\n"
+              << "                       chunks on N threads (one large world; bitwise)\n"
+              << "  --radar-los          Geometric radar gates: elevation, FOV and Earth\n"
+              << "                       occlusion as dot products (not bitwise)\n"
+              << "  --radar-tracks       Fuse detections into per-team tracks; SAMs engage\n"
+              << "                       confirmed tracks (not bitwise)\n"
+              << "  --comms              Scenario comm networks: SAMs cue only from radars\n"
+              << "                       routed to them (not bitwise)\n"
+              << "  --iads               Sector operations centres assign SAM targets as\n"
+              << "                       one assignment per decision cycle (not bitwise)\n"
+              << "  --ai-decisions       Re-plan AI at each type's decision rate, phase-\n"
+              << "                       spread; hold the last command between (not bitwise)\n"
+              << "  --ai-decision-dt D   Decision period in s for every AI type (implies\n"
+              << "                       --ai-decisions)\n"
+              << "  --format F           Batch output: json, binary, aggregate or store\n"
+              << "                       (indexed .mcrs for --store-query; default: json)\n"
+              << "  --ci-half-width W    Stop once every metric's 95% CI half-width <= W\n"
+              << "                       (--runs becomes the cap; default: off)\n"
+              << "  --ci-metric SPEC     hva, survival:<id> or win:<team>; repeatable (default: hva)\n"
+              << "  --ci-block N         Runs between convergence checks (default: 100)\n"
+              << "  --rng R              mulberry32 (JS-compatible, default) or philox\n"
+              << "                       (counter-based, per-entity streams)\n"
+              << "  --antithetic         Run seeds in mirrored pairs (1 - u); best with --rng philox\n"
+              << "  --lhs                Latin-hypercube sample the scenario's \"uncertainties\"\n"
+              << "  --branch-at T        Snapshot the batch at T s and fork from there;\n"
+              << "                       repeatable, one tree level each (default: off)\n"
+              << "  --branch-fanout F    Children per snapshot at each --branch-at but the\n"
+              << "                       last; repeatable, in order (default: 1)\n"
+              << "  --branch-first-draw  First branch point: the first tick that draws a\n"
+              << "                       random number (exact; runs unchanged)\n"
+              << "  --checkpoint <path>  Batch: record completed runs here every\n"
+              << "                       --checkpoint-interval s (default: 60)\n"
+              << "  --resume             Batch: skip the runs in the checkpoint (default\n"
+              << "                       checkpoint: <output>.ckpt)\n"
+              << "  --split-target ID    Estimate P(ID destroyed) by multilevel splitting,\n"
+              << "                       --runs trajectories per level (rare events)\n"
+              << "  --split-distance D   Splitting level: nearest armed hostile within D m\n"
+              << "                       of the target; repeatable\n"
+              << "  --training <path>    DOE: also write per-permutation metric means as a\n"
+              << "                       surrogate training set (metrics: --ci-metric)\n"
+              << "  --query V1,V2,...    Surrogate: one value per model parameter; repeatable\n"
+              << "  --max-std S          Surrogate: run queries whose predictive std exceeds S\n"
+              << "                       as real MC (--runs seeds) on the --doe spec\n"
+              << "  --run-step-budget N  Stop a run after N ticks, flagged \"Run budget\" with\n"
+              << "                       its partial results (default: none)\n"
+              << "  --run-wall-budget S  Same after S s of wall time (not reproducible)\n"
+              << "  --tail-report <path> Slowest runs and their per-system time: summary to\n"
+              << "                       stderr, JSON to <path>\n"
+              << "  --tail-runs N        Runs kept by --tail-report (default: 10)\n"
+              << "  --profile <path>     Time each system per tick: summary to stderr,\n"
+              << "                       Chrome trace-event JSON to <path>\n"
+              << "  --metrics <addr>     Serve Prometheus metrics over HTTP on tcp://host:port,\n"
+              << "                       tcp://:port or a Unix socket path\n"
+              << "  --metrics-sample N   Metrics without --profile: time every Nth tick per\n"
+              << "                       thread for per-system tick time (default: 64)\n"
+              << "  --memory-budget [S=]MB  Cap accounted memory of subsystem S (replay,\n"
+              << "                       fom_frames, json_dom, mc_entities, ephemeris; all\n"
+              << "                       if no S);\n"
+              << "                       repeatable. Replay streams when over its budget\n"
+              << "  --live-scale S       Live: sim seconds per wall second, 0 = unpaced (default: 1)\n"
+              << "  --live-fps F         Live: frames per second until a viewer asks (default: 30)\n"
+              << "  --live-tolerance M   Live: dead-reckoning error in m before an entity is\n"
+              << "                       resent, until a viewer asks (default: 10)\n"
+              << "  --cache-size N       Serve: parsed scenarios kept in memory (default: 8)\n"
+              << "  --shard-workers N    Shard: expected workers, sizes the units (default: 1)\n"
+              << "  --shard-unit N       Shard: smallest unit, runs per worker thread (default: 8)\n"
+              << "  --scenario-cache <dir>  Keep parsed scenarios here by content hash\n"
+              << "                       (batch, replay and serve)\n"
+              << "  --output <path>      Output file (default: stdout)\n"
               << "  --verbose            Progress to stderr\n"
               << "  --progress           JSON-Lines progress to stderr (for server)\n"
+              << "  --snapshot-every N   Batch --progress: aggregate snapshot (survival CIs,\n"
+              << "                       kill matrices, time histogram) every N runs\n"
+              << "  --snapshot-interval S  ... and/or every S seconds (default: off)\n"
               << "  --help               Show this message\n";
 }
 
+/**
+ * --profile: summary tables (systems, memory) to stderr, trace-event JSON
+ * to the given path.
+ */
+static bool write_profile(const sim::mc::TickProfiler& profiler, const std::string& path) {
+    profiler.write_summary(std::cerr);
+    std::cerr << "\n";
+    sim::write_memory_summary(std::cerr);
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: cannot open profile output: " << path << "\n";
+        return false;
+    }
+    profiler.write_trace(out);
+    return true;
+}
+
+/**
+ * --tail-report: summary to stderr, slowest runs as JSON to the given path.
+ */
+static bool write_tail_report(const sim::mc::TailReport& tail, const std::string& path) {
+    tail.write_summary(std::cerr);
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: cannot open tail report output: " << path << "\n";
+        return false;
+    }
+    tail.write_json(out);
+    return true;
+}
+
+/**
+ * --metrics: serve the registry on `address`, with per-system tick time
+ * from `profiler` (scaled up by its sampling interval).
+ */
+static std::unique_ptr<sim::distributed::MetricsServer> start_metrics(
+        const std::string& address, const sim::mc::TickProfiler& profiler) {
+    auto& registry = sim::distributed::MetricsRegistry::global();
+    registry.add_collector([&profiler](std::ostream& out) {
+        const auto totals = profiler.totals();
+        const double scale = profiler.sample_every();
+        out << "# HELP mc_system_seconds_total Tick time per system (estimated when sampled)\n"
+            << "# TYPE mc_system_seconds_total counter\n";
+        for (size_t s = 0; s < totals.size(); s++) {
+            out << "mc_system_seconds_total{system=\""
+                << sim::mc::profile_system_name(static_cast<sim::mc::ProfileSystem>(s)) << "\"} "
+                << static_cast<double>(totals[s].ns) * scale * 1e-9 << "\n";
+        }
+        out << "# HELP mc_system_calls_total Calls per system (estimated when sampled)\n"
+            << "# TYPE mc_system_calls_total counter\n";
+        for (size_t s = 0; s < totals.size(); s++) {
+            out << "mc_system_calls_total{system=\""
+                << sim::mc::profile_system_name(static_cast<sim::mc::ProfileSystem>(s)) << "\"} "
+                << static_cast<double>(totals[s].calls) * scale << "\n";
+        }
+    });
+    registry.add_collector([](std::ostream& out) {
+        static const char* SERIES[][3] = {
+            {"sim_memory_bytes", "gauge", "Bytes held per accounted subsystem"},
+            {"sim_memory_peak_bytes", "gauge", "Peak bytes per accounted subsystem"},
+            {"sim_memory_allocations_total", "counter", "Allocations per accounted subsystem"}};
+        for (int k = 0; k < 3; k++) {
+            out << "# HELP " << SERIES[k][0] << " " << SERIES[k][2] << "\n"
+                << "# TYPE " << SERIES[k][0] << " " << SERIES[k][1] << "\n";
+            for (size_t t = 0; t < sim::NUM_MEMORY_TAGS; t++) {
+                const auto tag = static_cast<sim::MemoryTag>(t);
+                const sim::MemoryAccount& a = sim::memory_account(tag);
+                out << SERIES[k][0] << "{subsystem=\"" << sim::memory_tag_name(tag) << "\"} "
+                    << (k == 0 ? a.current() : k == 1 ? a.peak()
+                                             : static_cast<int64_t>(a.allocations())) << "\n";
+            }
+        }
+    });
+    return std::make_unique<sim::distributed::MetricsServer>(registry, address);
+}
+
+/**
+ * Drain a file output; false (with a message) if any write failed.
+ */
+static bool close_output(sim::AsyncOFStream& file, const std::string& path) {
+    if (!file.is_open() || file.close()) return true;
+    std::cerr << "Error: write failed on output file: " << path << "\n";
+    return false;
+}
+
+/**
+ * --progress "done" fields for a file output: how often, and for how long,
+ * result formatting waited on the disk (back-pressure).
+ */
+static void write_output_stats(std::ostream& err, const sim::AsyncOFStream& file,
+                               const std::string& path) {
+    if (path.empty()) return;
+    sim::AsyncOutputStats s = file.stats();
+    err << ",\"outputBytes\":" << s.bytes << ",\"outputStalls\":" << s.stalls
+        << ",\"outputStallSeconds\":" << s.stall_seconds;
+}
+
+/**
+ * --split-target: probability that the target is destroyed, by multilevel
+ * splitting on the distance to its nearest armed hostile (--split-distance
+ * thresholds, then the kill itself); --runs trajectories per level.
+ */
+static int run_split_mode(const sim::mc::MCConfig& config, const sim::mc::MCWorld& prototype,
+                          const std::string& target, std::vector<double> distances,
+                          sim::mc::TickProfiler* profiler) {
+    sim::mc::SplittingSpec spec;
+    try {
+        spec.progress = sim::mc::closing_distance_progress(prototype, target);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::sort(distances.begin(), distances.end(), std::greater<double>());
+    for (double d : distances) spec.thresholds.push_back(-d);
+    spec.thresholds.push_back(std::numeric_limits<double>::infinity());
+    spec.effort = config.num_runs;
+
+    if (config.verbose) {
+        std::cerr << "=== MC Engine (splitting) ===\n"
+                  << "Target: " << target << "\n"
+                  << "Levels: " << spec.thresholds.size() << "\n"
+                  << "Trajectories per level: " << spec.effort << "\n"
+                  << "Threads: " << config.num_threads << "\n\n";
+    }
+
+    sim::mc::MCRunner::ProgressCallback progress_cb = nullptr;
+    if (config.progress) {
+        progress_cb = [](int completed, int total) {
+            std::cerr << "{\"type\":\"run_complete\",\"run\":" << completed
+                      << ",\"total\":" << total << "}\n" << std::flush;
+        };
+    }
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    sim::mc::MCRunner runner(config);
+    runner.set_profiler(profiler);
+    sim::mc::SplittingReport report = runner.run_splitting(prototype, spec, progress_cb);
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    sim::AsyncOFStream file;
+    if (config.output_path.empty()) {
+        sim::mc::write_splitting_json(std::cout, report, config.base_seed, config.max_sim_time);
+    } else {
+        file.open(config.output_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot open output file: " << config.output_path << "\n";
+            return 1;
+        }
+        sim::mc::write_splitting_json(file, report, config.base_seed, config.max_sim_time);
+        if (!close_output(file, config.output_path)) return 1;
+    }
+
+    if (config.verbose) {
+        std::cerr << "\nP(" << target << " destroyed) = " << report.probability
+                  << " (relative error " << report.relative_error << ") from "
+                  << report.sim_seconds << " simulated s in " << elapsed << "s\n";
+    }
+    if (config.progress) {
+        std::cerr << "{\"type\":\"done\",\"mode\":\"splitting\",\"elapsed\":" << elapsed
+                  << "}\n" << std::flush;
+    }
+    return 0;
+}
+
+/**
+ * Parse a DOE spec and its base scenario (--scenario overrides the spec's)
+ * into a prototype world; spec.runs, when set, replaces config.num_runs.
+ */
+static bool load_doe_spec(sim::mc::MCConfig& config, const std::string& doe_path,
+                          sim::mc::DOESpec& spec, sim::mc::MCWorld& prototype) {
+    sim::JsonValue scenario;
+    try {
+        auto slash = doe_path.find_last_of('/');
+        std::string spec_dir = slash == std::string::npos ? "" : doe_path.substr(0, slash);
+        spec = sim::mc::DOESpec::parse(sim::JsonReader::parse_file(doe_path), spec_dir);
+
+        if (!config.scenario_path.empty()) {
+            scenario = sim::JsonReader::parse_file(config.scenario_path);
+        } else if (!spec.scenario_path.empty()) {
+            scenario = sim::JsonReader::parse_file(spec.scenario_path);
+        } else {
+            scenario = spec.scenario;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading DOE spec: " << e.what() << "\n";
+        return false;
+    }
+
+    if (!scenario["entities"].is_array() || scenario["entities"].size() == 0) {
+        std::cerr << "Error: scenario has no entities\n";
+        return false;
+    }
+    if (spec.runs > 0) config.num_runs = spec.runs;
+
+    try {
+        prototype = sim::mc::ScenarioParser::parse(scenario, config.num_threads);
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading scenario: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * --doe: parse the spec and base scenario once, build one prototype per
+ * permutation, and stream the merged results document. With a training
+ * path, also write the sweep's (parameters -> metric means) rows there.
+ */
+static int run_doe_mode(sim::mc::MCConfig config, const std::string& doe_path,
+                        const std::string& training_path, sim::mc::TickProfiler* profiler) {
+    sim::mc::DOESpec spec;
+    sim::mc::MCWorld prototype;
+    if (!load_doe_spec(config, doe_path, spec, prototype)) return 1;
+
+    std::vector<sim::mc::MCWorld> worlds;
+    try {
+        size_t perms = spec.num_permutations();
+        worlds.reserve(perms);
+        for (size_t p = 0; p < perms; p++) {
+            worlds.push_back(spec.make_world(prototype, p));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error building DOE permutations: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Training rows need a metric; "hva" resolves to nothing without HVAs
+    if (!training_path.empty()) {
+        sim::mc::MetricSet metrics(config.ci_metrics);
+        metrics.resolve(prototype);
+        if (metrics.size() == 0) {
+            std::cerr << "Error: --training has no metric to record (the scenario has no HVA); "
+                      << "pass --ci-metric survival:<id>|win:<team>\n";
+            return 1;
+        }
+    }
+
+    if (config.verbose) {
+        std::cerr << "=== MC Engine (DOE) ===\n"
+                  << "Spec: " << doe_path << "\n"
+                  << "Permutations: " << worlds.size() << "\n"
+                  << "Runs per permutation: " << config.num_runs << "\n"
+                  << "Threads: " << config.num_threads << "\n\n";
+    }
+
+    sim::AsyncOFStream file;
+    if (!config.output_path.empty()) {
+        file.open(config.output_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot open output file: " << config.output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = config.output_path.empty() ? std::cout : file;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    sim::mc::MCRunner::ProgressCallback progress_cb = nullptr;
+    if (config.progress) {
+        progress_cb = [](int completed, int total) {
+            std::cerr << "{\"type\":\"run_complete\",\"run\":" << completed
+                      << ",\"total\":" << total << "}\n" << std::flush;
+        };
+    }
+
+    sim::mc::MCRunner runner(config);
+    runner.set_profiler(profiler);
+    sim::mc::DOEResultsWriter writer(out, spec, config.num_runs, config.base_seed,
+                                     config.max_sim_time, config.ci_metrics);
+    std::unique_ptr<sim::mc::SurrogateTrainingCollector> training;
+    if (!training_path.empty()) {
+        std::vector<std::string> names;
+        for (const auto& p : spec.parameters) names.push_back(p.name);
+        std::vector<std::vector<double>> values;
+        for (size_t p = 0; p < worlds.size(); p++) values.push_back(spec.permutation(p));
+        training = std::make_unique<sim::mc::SurrogateTrainingCollector>(
+            names, std::move(values), config.ci_metrics);
+    }
+    runner.run_doe(worlds, [&](int perm, sim::mc::RunResult& r) {
+        if (training) training->add(perm, r);
+        writer.write_run(perm, r);
+    }, progress_cb);
+    writer.finish();
+    if (!close_output(file, config.output_path)) return 1;
+    if (training) {
+        std::ofstream tout(training_path);
+        if (!tout.is_open()) {
+            std::cerr << "Error: cannot open training output: " << training_path << "\n";
+            return 1;
+        }
+        training->finish().write_json(tout);
+    }
+    if (!config.tail_report_path.empty() &&
+        !write_tail_report(runner.tail_report(), config.tail_report_path)) return 1;
+    if (!config.profile_path.empty() && !write_profile(*profiler, config.profile_path)) return 1;
+
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    if (config.verbose) {
+        std::cerr << "DOE complete: " << worlds.size() << " permutations in "
+                  << elapsed << "s\n";
+    }
+    if (config.progress) {
+        std::cerr << "{\"type\":\"done\",\"mode\":\"doe\",\"permutations\":"
+                  << worlds.size() << ",\"elapsed\":" << elapsed;
+        write_output_stats(std::cerr, file, config.output_path);
+        std::cerr << "}\n" << std::flush;
+    }
+    return 0;
+}
+
+/**
+ * --fit-surrogate: fit a Gaussian process to a --training set and write
+ * the model.
+ */
+static int run_fit_mode(const sim::mc::MCConfig& config, const std::string& training_path) {
+    sim::mc::GaussianProcessSurrogate gp;
+    size_t rows = 0;
+    auto t_start = std::chrono::high_resolution_clock::now();
+    try {
+        sim::mc::SurrogateTrainingSet set =
+            sim::mc::SurrogateTrainingSet::parse(sim::JsonReader::parse_file(training_path));
+        rows = set.x.size();
+        gp.fit(set);
+    } catch (const std::exception& e) {
+        std::cerr << "Error fitting surrogate: " << e.what() << "\n";
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    if (config.output_path.empty()) {
+        gp.write_json(std::cout);
+    } else {
+        std::ofstream out(config.output_path);
+        if (!out.is_open()) {
+            std::cerr << "Error: cannot open output file: " << config.output_path << "\n";
+            return 1;
+        }
+        gp.write_json(out);
+    }
+    if (config.verbose) {
+        std::cerr << "Surrogate: " << rows << " rows, " << gp.num_metrics()
+                  << " metrics, fitted in " << elapsed << "s\n";
+    }
+    return 0;
+}
+
+/**
+ * --surrogate: answer each --query from the model. With --doe and
+ * --max-std, a query whose predictive std exceeds the limit on any metric
+ * is run for real instead (num_runs seeds on the spec's scenario with the
+ * query's overrides), and reported with the MC mean and its std error.
+ */
+static int run_surrogate_mode(sim::mc::MCConfig config, const std::string& model_path,
+                              const std::vector<std::string>& query_texts,
+                              double max_std, const std::string& doe_path) {
+    sim::mc::GaussianProcessSurrogate gp;
+    try {
+        gp = sim::mc::GaussianProcessSurrogate::parse(sim::JsonReader::parse_file(model_path));
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading surrogate: " << e.what() << "\n";
+        return 1;
+    }
+
+    const size_t dims = gp.num_parameters();
+    const size_t metrics = gp.num_metrics();
+    std::vector<std::vector<double>> queries;
+    for (const std::string& text : query_texts) {
+        std::vector<double> q;
+        std::stringstream ss(text);
+        std::string item;
+        try {
+            while (std::getline(ss, item, ',')) q.push_back(std::stod(item));
+        } catch (const std::exception&) {
+            q.clear();
+        }
+        if (q.size() != dims) {
+            std::cerr << "Error: --query '" << text << "' needs " << dims
+                      << " comma-separated values\n";
+            return 1;
+        }
+        queries.push_back(std::move(q));
+    }
+
+    std::vector<sim::mc::SurrogatePrediction> pred(queries.size() * metrics);
+    auto t_start = std::chrono::high_resolution_clock::now();
+    for (size_t q = 0; q < queries.size(); q++) {
+        gp.predict(queries[q].data(), &pred[q * metrics]);
+    }
+    double predict_seconds = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    // Fallback: real runs for the queries the model is unsure about
+    std::vector<size_t> fallback;
+    if (max_std > 0.0) {
+        for (size_t q = 0; q < queries.size(); q++) {
+            for (size_t m = 0; m < metrics; m++) {
+                if (pred[q * metrics + m].std > max_std) {
+                    fallback.push_back(q);
+                    break;
+                }
+            }
+        }
+    }
+    std::vector<int> mc_runs(queries.size(), 0);
+    if (!fallback.empty()) {
+        if (doe_path.empty()) {
+            std::cerr << "Error: " << fallback.size()
+                      << " queries exceed --max-std; the fallback needs --doe\n";
+            return 1;
+        }
+        sim::mc::DOESpec spec;
+        sim::mc::MCWorld prototype;
+        if (!load_doe_spec(config, doe_path, spec, prototype)) return 1;
+
+        std::vector<sim::mc::MCWorld> worlds;
+        std::vector<std::vector<double>> values;
+        try {
+            for (size_t q : fallback) {
+                worlds.push_back(spec.make_world(prototype, queries[q]));
+                values.push_back(queries[q]);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error building fallback worlds: " << e.what() << "\n";
+            return 1;
+        }
+
+        std::vector<std::string> specs;
+        for (size_t m = 0; m < metrics; m++) specs.push_back(gp.metric_name(m));
+        sim::mc::SurrogateTrainingCollector collector(gp.parameters(), values, specs);
+        sim::mc::MCRunner runner(config);
+        runner.run_doe(worlds, [&](int perm, sim::mc::RunResult& r) {
+            collector.add(perm, r);
+        });
+
+        // Rows come back in fallback order, minus any point with no scored run
+        sim::mc::SurrogateTrainingSet set = collector.finish();
+        size_t row = 0;
+        for (size_t f = 0; f < fallback.size() && row < set.x.size(); f++) {
+            if (set.x[row] != values[f]) continue;
+            const size_t q = fallback[f];
+            for (size_t m = 0; m < metrics && m < set.y[row].size(); m++) {
+                pred[q * metrics + m].mean = set.y[row][m];
+                pred[q * metrics + m].std = std::sqrt(set.var[row][m]);
+            }
+            mc_runs[q] = set.runs[row];
+            row++;
+        }
+    }
+
+    std::ofstream file;
+    if (!config.output_path.empty()) {
+        file.open(config.output_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot open output file: " << config.output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = config.output_path.empty() ? std::cout : file;
+    sim::JsonWriter w(out);
+    w.begin_object();
+    w.kv("model", model_path);
+    w.kv("maxStd", max_std);
+    w.kv("predictMicros", queries.empty() ? 0.0 : 1e6 * predict_seconds / queries.size());
+    w.key("parameters").begin_array();
+    for (const std::string& name : gp.parameters()) w.value(name);
+    w.end_array();
+    w.key("queries").begin_array();
+    for (size_t q = 0; q < queries.size(); q++) {
+        w.begin_object();
+        w.key("x").begin_array();
+        for (double v : queries[q]) w.value(v);
+        w.end_array();
+        w.kv("source", mc_runs[q] > 0 ? "montecarlo" : "surrogate");
+        if (mc_runs[q] > 0) w.kv("runs", mc_runs[q]);
+        w.key("metrics").begin_array();
+        for (size_t m = 0; m < metrics; m++) {
+            w.begin_object();
+            w.kv("name", gp.metric_name(m));
+            w.kv("mean", pred[q * metrics + m].mean);
+            w.kv("std", pred[q * metrics + m].std);
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    w.flush();
+    out << "\n";
+
+    if (config.verbose) {
+        std::cerr << "Surrogate: " << queries.size() << " queries, " << fallback.size()
+                  << " run by MC\n";
+    }
+    return 0;
+}
+
+static std::string read_text_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) throw std::runtime_error("cannot open " + path);
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+/**
+ * --shard-listen: ship the scenario (or DOE spec) to shard workers, hand
+ * out work units and write the merged aggregate document.
+ */
+static int run_shard_mode(sim::mc::MCConfig config, const std::string& address,
+                          int workers, int unit_runs, const std::string& doe_path) {
+    if (config.antithetic || config.ci_half_width > 0.0) {
+        std::cerr << "Error: --antithetic and --ci-half-width are not supported with --shard-listen\n";
+        return 1;
+    }
+    if (config.branch_on_first_draw || !config.branch_times.empty()) {
+        std::cerr << "Error: --branch-at and --branch-first-draw are not supported with --shard-listen\n";
+        return 1;
+    }
+
+    std::string scenario_text;
+    std::string doe_text;
+    sim::mc::DOESpec spec;
+    sim::mc::VarianceReport variance;
+    try {
+        if (!doe_path.empty()) {
+            doe_text = read_text_file(doe_path);
+            auto slash = doe_path.find_last_of('/');
+            spec = sim::mc::DOESpec::parse(sim::JsonReader::parse(doe_text),
+                                           slash == std::string::npos ? "" : doe_path.substr(0, slash));
+            if (spec.runs > 0) config.num_runs = spec.runs;
+            if (!config.scenario_path.empty()) {
+                scenario_text = read_text_file(config.scenario_path);
+            } else if (!spec.scenario_path.empty()) {
+                scenario_text = read_text_file(spec.scenario_path);
+            }
+            config.lhs = false;
+        } else if (config.scenario_path.empty()) {
+            std::cerr << "Error: --shard-listen needs --scenario or --doe\n";
+            return 1;
+        } else {
+            scenario_text = read_text_file(config.scenario_path);
+        }
+
+        // Validate up front rather than on every worker
+        sim::JsonValue scenario = scenario_text.empty() ? spec.scenario
+                                                        : sim::JsonReader::parse(scenario_text);
+        if (!scenario["entities"].is_array() || scenario["entities"].size() == 0) {
+            std::cerr << "Error: scenario has no entities\n";
+            return 1;
+        }
+        if (config.lhs) {
+            sim::mc::LatinHypercube lhs(scenario["uncertainties"], config.num_runs,
+                                        config.base_seed);
+            variance.method = "lhs";
+            variance.strata = lhs.strata();
+            for (size_t d = 0; d < lhs.dimensions(); d++) {
+                variance.dimensions.push_back(lhs.dimension(d).name);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error loading shard batch: " << e.what() << "\n";
+        return 1;
+    }
+
+    size_t perms = doe_path.empty() ? 1 : spec.num_permutations();
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    std::vector<sim::mc::MCAggregator> aggs;
+    sim::mc::MCShardCoordinator coordinator(config, unit_runs);
+    try {
+        aggs = coordinator.run(address, workers, scenario_text, doe_text, perms);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    sim::AsyncOFStream file;
+    if (!config.output_path.empty()) {
+        file.open(config.output_path);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot open output file: " << config.output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = config.output_path.empty() ? std::cout : file;
+
+    if (doe_path.empty()) {
+        aggs[0].write_json(out, config.num_runs, config.base_seed, nullptr, &variance);
+    } else {
+        // Same outline as the --doe document, with one aggregate per permutation
+        sim::JsonWriter w(out);
+        w.begin_object();
+        w.key("config").begin_object();
+        w.kv("numRuns", config.num_runs);
+        w.kv("baseSeed", config.base_seed);
+        w.kv("maxSimTime", config.max_sim_time);
+        w.kv("numPermutations", perms);
+        w.end_object();
+        w.key("parameters").begin_array();
+        for (const auto& p : spec.parameters) {
+            w.begin_object();
+            w.kv("name", p.name);
+            w.kv("field", p.field);
+            w.key("values").begin_array();
+            for (double v : p.values) w.value(v);
+            w.end_array();
+            w.end_object();
+        }
+        w.end_array();
+        w.key("permutations").begin_array();
+        for (size_t p = 0; p < perms; p++) {
+            std::vector<double> vals = spec.permutation(p);
+            w.begin_object();
+            w.kv("permId", p);
+            w.key("config").begin_object();
+            for (size_t i = 0; i < vals.size(); i++) w.kv(spec.parameters[i].name, vals[i]);
+            w.end_object();
+            w.key("aggregate");
+            aggs[p].write_json(w, config.num_runs, config.base_seed);
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+        out << '\n';
+    }
+    if (!close_output(file, config.output_path)) return 1;
+
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+    if (config.progress) {
+        std::cerr << "{\"type\":\"done\",\"mode\":\"shard\",\"units\":"
+                  << coordinator.units_completed() << ",\"workers\":"
+                  << coordinator.workers_joined() << ",\"lost\":"
+                  << coordinator.workers_lost() << ",\"elapsed\":" << elapsed;
+        write_output_stats(std::cerr, file, config.output_path);
+        std::cerr << "}\n" << std::flush;
+    }
+    return 0;
+}
+
+/**
+ * Switch a replay to streaming when `concurrent` buffered replays of
+ * `prototype` would exceed the replay memory budget.
+ */
+static void stream_over_budget(sim::mc::MCConfig& config, const sim::mc::MCWorld& prototype,
+                               int concurrent) {
+    const int64_t replay_budget = sim::memory_account(sim::MemoryTag::REPLAY).budget();
+    if (replay_budget <= 0 || config.replay_stream || config.replay_error > 0.0) return;
+    const double samples = std::floor(config.max_sim_time / config.sample_interval) + 2.0;
+    const double bytes = concurrent * samples * (sizeof(double) +
+                                                 prototype.entities().size() * sizeof(sim::Vec3));
+    if (bytes > static_cast<double>(replay_budget)) {
+        std::cerr << "Replay needs ~" << bytes / 1048576.0
+                  << " MB of trajectories, over its budget: streaming replay_v2\n";
+        config.replay_stream = true;
+    }
+}
+
+/**
+ * --replay-from: select runs from a batch results file and re-simulate
+ * them in parallel into the bundle directory config.output_path.
+ */
+static int run_replay_bundle_mode(sim::mc::MCConfig config, const sim::mc::MCWorld& prototype,
+                                  const sim::JsonValue& scenario, const std::string& results_path,
+                                  const sim::mc::ReplayQuery& query,
+                                  sim::mc::TickProfiler* profiler) {
+    if (config.output_path.empty()) {
+        std::cerr << "Error: --replay-from needs --output <directory>\n";
+        return 1;
+    }
+    if (!config.replay_archive.empty()) {
+        std::cerr << "Error: --archive is not supported with --replay-from\n";
+        return 1;
+    }
+    if (!config.replay_tiles.empty()) {
+        std::cerr << "Error: --replay-tiles is not supported with --replay-from\n";
+        return 1;
+    }
+
+    sim::mc::ReplaySelection selection;
+    try {
+        selection = sim::mc::select_replays(results_path, query);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Seeds follow from the batch's base seed; a mismatch means different flags
+    config.base_seed = selection.base_seed;
+    config.num_runs = selection.num_runs;
+    for (const auto& run : selection.runs) {
+        int expected = config.base_seed + (config.antithetic ? run.run_index / 2 : run.run_index);
+        if (run.seed != expected) {
+            std::cerr << "Error: run " << run.run_index << " has seed " << run.seed
+                      << ", expected " << expected << " (pass the batch's --antithetic)\n";
+            return 1;
+        }
+    }
+
+    const int n = static_cast<int>(selection.runs.size());
+    stream_over_budget(config, prototype, std::min(n, std::max(config.num_threads, 1)));
+
+    sim::mc::MCRunner runner(config);
+    runner.set_profiler(profiler);
+    std::unique_ptr<sim::mc::LatinHypercube> lhs;
+    if (config.lhs) {
+        try {
+            lhs = std::make_unique<sim::mc::LatinHypercube>(
+                scenario["uncertainties"], config.num_runs, config.base_seed);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in uncertainties: " << e.what() << "\n";
+            return 1;
+        }
+        runner.set_run_setup([&lhs](sim::mc::MCWorld& world, int run_index) {
+            lhs->apply(run_index, world);
+        });
+    }
+
+    const bool stream = config.replay_stream || config.replay_error > 0.0;
+    auto file_name = [&](int i) {
+        return "run_" + std::to_string(selection.runs[i].run_index) + (stream ? ".jsonl" : ".json");
+    };
+
+    if (config.verbose) {
+        std::cerr << "=== Replay Bundle ===\n"
+                  << "Results: " << results_path << " (" << selection.scanned << " runs, "
+                  << selection.matched << " matched)\n"
+                  << "Replays: " << n << " on " << config.num_threads << " threads\n"
+                  << "Output: " << config.output_path << "\n\n";
+    }
+
+    ::mkdir(config.output_path.c_str(), 0755);
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    std::vector<int> indices;
+    for (const auto& run : selection.runs) indices.push_back(run.run_index);
+    sim::mc::MCRunner::ProgressCallback progress_cb = nullptr;
+    if (config.progress) {
+        progress_cb = [](int completed, int total) {
+            std::cerr << "{\"type\":\"replay_complete\",\"replay\":" << completed
+                      << ",\"total\":" << total << "}\n" << std::flush;
+        };
+    }
+    try {
+        runner.run_replays(prototype, indices, [&](size_t i) {
+            std::string path = config.output_path + "/" + file_name(static_cast<int>(i));
+            auto out = std::make_unique<std::ofstream>(path);
+            if (!out->is_open()) throw std::runtime_error("cannot open replay output: " + path);
+            return std::unique_ptr<std::ostream>(std::move(out));
+        }, progress_cb);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    const std::string manifest_path = config.output_path + "/bundle.json";
+    std::ofstream manifest(manifest_path);
+    if (!manifest.is_open()) {
+        std::cerr << "Error: cannot open output file: " << manifest_path << "\n";
+        return 1;
+    }
+    sim::JsonWriter w(manifest);
+    w.begin_object();
+    w.kv("format", "replay_bundle");
+    w.kv("scenario", config.scenario_path);
+    w.kv("results", results_path);
+    w.kv("baseSeed", selection.base_seed);
+    w.kv("numRuns", selection.num_runs);
+    w.kv("scanned", selection.scanned);
+    w.kv("matched", selection.matched);
+    w.key("query").begin_object();
+    w.key("select").begin_array();
+    for (const auto& f : query.filters) w.value(f);
+    w.end_array();
+    w.kv("rank", query.rank);
+    w.kv("limit", query.limit);
+    w.end_object();
+    w.key("replays").begin_array();
+    for (int i = 0; i < n; i++) {
+        const auto& run = selection.runs[i];
+        w.begin_object();
+        w.kv("runIndex", run.run_index);
+        w.kv("seed", run.seed);
+        w.kv("rankValue", run.score);
+        w.kv("simTimeFinal", run.sim_time_final);
+        w.kv("file", file_name(i));
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    manifest << '\n';
+    if (!manifest) {
+        std::cerr << "Error: write failed on output file: " << manifest_path << "\n";
+        return 1;
+    }
+
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+    if (config.progress) {
+        std::cerr << "{\"type\":\"done\",\"mode\":\"replay_bundle\",\"replays\":" << n
+                  << ",\"elapsed\":" << elapsed << "}\n" << std::flush;
+    }
+    if (config.verbose) {
+        std::cerr << n << " replays written to " << config.output_path << " in "
+                  << elapsed << "s\n";
+    }
+    return 0;
+}
+
+/**
+ * --memory-budget: "MB" for every subsystem or "<subsystem>=MB".
+ */
+static bool apply_memory_budget(const std::string& spec) {
+    auto eq = spec.find('=');
+    double mb = 0.0;
+    try {
+        mb = std::stod(eq == std::string::npos ? spec : spec.substr(eq + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (mb <= 0.0) return false;
+    const auto bytes = static_cast<int64_t>(mb * 1048576.0);
+    for (size_t t = 0; t < sim::NUM_MEMORY_TAGS; t++) {
+        const auto tag = static_cast<sim::MemoryTag>(t);
+        if (eq == std::string::npos || spec.compare(0, eq, sim::memory_tag_name(tag)) == 0) {
+            sim::memory_account(tag).set_budget(bytes);
+            if (eq != std::string::npos) return true;
+        }
+    }
+    return eq == std::string::npos;
+}
+
 int main(int argc, char* argv[]) {
     sim::mc::MCConfig config;
+    std::string convert_path;
+    std::string store_path;
+    sim::mc::StoreQuery store_query;
+    std::string doe_path;
+    std::string serve_path;
+    std::string live_address;
+    sim::mc::LiveServerConfig live;
+    std::string shard_listen;
+    std::string shard_worker;
+    std::string split_target;
+    std::vector<double> split_distances;
+    std::string training_path;
+    std::string fit_path;
+    std::string surrogate_path;
+    std::vector<std::string> queries;
+    double max_std = 0.0;
+    int shard_workers = 1;
+    int shard_unit = 8;
+    int cache_size = 8;
+    std::string metrics_address;
+    int metrics_sample = 64;
+    std::string replay_from;
+    sim::mc::ReplayQuery replay_query;
 
     // Parse CLI arguments
     for (int i = 1; i < argc; i++) {
@@ -66,6 +1186,187 @@ int main(int argc, char* argv[]) {
             config.dt = std::stod(argv[++i]);
         } else if (arg == "--sample-interval" && i + 1 < argc) {
             config.sample_interval = std::stod(argv[++i]);
+        } else if (arg == "--replay-stream") {
+            config.replay_stream = true;
+        } else if (arg == "--replay-chunk" && i + 1 < argc) {
+            config.replay_chunk = std::stoi(argv[++i]);
+        } else if (arg == "--replay-quantum" && i + 1 < argc) {
+            config.replay_quantum = std::stod(argv[++i]);
+        } else if (arg == "--replay-error" && i + 1 < argc) {
+            config.replay_error = std::stod(argv[++i]);
+        } else if (arg == "--replay-max-gap" && i + 1 < argc) {
+            config.replay_max_gap = std::stod(argv[++i]);
+        } else if (arg == "--archive" && i + 1 < argc) {
+            config.replay_archive = argv[++i];
+        } else if (arg == "--replay-tiles" && i + 1 < argc) {
+            config.replay_tiles = argv[++i];
+        } else if (arg == "--replay-tile-samples" && i + 1 < argc) {
+            config.replay_tile_samples = std::stoi(argv[++i]);
+        } else if (arg == "--replay-tile-group" && i + 1 < argc) {
+            config.replay_tile_group = std::stoi(argv[++i]);
+        } else if (arg == "--replay-from" && i + 1 < argc) {
+            replay_from = argv[++i];
+        } else if (arg == "--select" && i + 1 < argc) {
+            replay_query.filters.push_back(argv[++i]);
+        } else if (arg == "--rank" && i + 1 < argc) {
+            replay_query.rank = argv[++i];
+        } else if (arg == "--limit" && i + 1 < argc) {
+            replay_query.limit = std::stoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            config.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--numa") {
+            config.placement.numa = true;
+        } else if (arg == "--pin-threads") {
+            config.placement.numa = true;
+            config.placement.pin = true;
+        } else if (arg == "--cached-kepler") {
+            config.cached_kepler = true;
+        } else if (arg == "--lockstep" && i + 1 < argc) {
+            config.lockstep = std::stoi(argv[++i]);
+            if (config.lockstep > 1) config.cached_kepler = true;
+        } else if (arg == "--batch-flight") {
+            config.batch_flight = true;
+        } else if (arg == "--flight-rk2") {
+            config.flight_rk2 = true;
+        } else if (arg == "--missile-flyout") {
+            config.missile_flyout = true;
+        } else if (arg == "--swept-contact") {
+            config.swept_contact = true;
+        } else if (arg == "--wez" && i + 1 < argc) {
+            config.wez_dir = argv[++i];
+        } else if (arg == "--lod-dt" && i + 1 < argc) {
+            config.lod_dt = std::stod(argv[++i]);
+        } else if (arg == "--shared-ephemeris") {
+            config.shared_ephemeris = true;
+        } else if (arg == "--ephemeris-mb" && i + 1 < argc) {
+            config.ephemeris_mb = std::stod(argv[++i]);
+            config.shared_ephemeris = true;
+        } else if (arg == "--tick-threads" && i + 1 < argc) {
+            config.tick_threads = std::stoi(argv[++i]);
+        } else if (arg == "--radar-los") {
+            config.radar_los = true;
+        } else if (arg == "--radar-tracks") {
+            config.radar_tracks = true;
+        } else if (arg == "--comms") {
+            config.comms = true;
+        } else if (arg == "--iads") {
+            config.iads = true;
+        } else if (arg == "--ai-decisions") {
+            config.ai_decisions = true;
+        } else if (arg == "--ai-decision-dt" && i + 1 < argc) {
+            config.ai_decision_dt = std::stod(argv[++i]);
+            config.ai_decisions = true;
+        } else if (arg == "--coast-dt" && i + 1 < argc) {
+            config.coast_dt = std::stod(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            config.output_format = argv[++i];
+        } else if (arg == "--rng" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "philox") {
+                config.rng_mode = sim::mc::RNGMode::PHILOX;
+            } else if (mode == "mulberry32") {
+                config.rng_mode = sim::mc::RNGMode::MULBERRY32;
+            } else {
+                std::cerr << "Error: --rng must be mulberry32 or philox\n\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--antithetic") {
+            config.antithetic = true;
+        } else if (arg == "--lhs") {
+            config.lhs = true;
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            config.checkpoint_path = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            config.checkpoint_interval = std::stod(argv[++i]);
+        } else if (arg == "--resume") {
+            config.resume = true;
+        } else if (arg == "--split-target" && i + 1 < argc) {
+            split_target = argv[++i];
+        } else if (arg == "--split-distance" && i + 1 < argc) {
+            split_distances.push_back(std::stod(argv[++i]));
+        } else if (arg == "--branch-at" && i + 1 < argc) {
+            config.branch_times.push_back(std::stod(argv[++i]));
+        } else if (arg == "--branch-fanout" && i + 1 < argc) {
+            config.branch_fanout.push_back(std::stoi(argv[++i]));
+        } else if (arg == "--branch-first-draw") {
+            config.branch_on_first_draw = true;
+        } else if (arg == "--ci-half-width" && i + 1 < argc) {
+            config.ci_half_width = std::stod(argv[++i]);
+        } else if (arg == "--ci-metric" && i + 1 < argc) {
+            config.ci_metrics.push_back(argv[++i]);
+        } else if (arg == "--ci-block" && i + 1 < argc) {
+            config.ci_block = std::stoi(argv[++i]);
+        } else if (arg == "--snapshot-every" && i + 1 < argc) {
+            config.snapshot_every = std::stoi(argv[++i]);
+        } else if (arg == "--snapshot-interval" && i + 1 < argc) {
+            config.snapshot_interval = std::stod(argv[++i]);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_path = argv[++i];
+        } else if (arg == "--live" && i + 1 < argc) {
+            live_address = argv[++i];
+            if (live_address.find_first_not_of("0123456789") == std::string::npos) {
+                live_address = "tcp://:" + live_address;
+            }
+        } else if (arg == "--live-scale" && i + 1 < argc) {
+            live.time_scale = std::stod(argv[++i]);
+        } else if (arg == "--live-fps" && i + 1 < argc) {
+            live.fps = std::stod(argv[++i]);
+        } else if (arg == "--live-tolerance" && i + 1 < argc) {
+            live.tolerance = std::stod(argv[++i]);
+        } else if (arg == "--shard-listen" && i + 1 < argc) {
+            shard_listen = argv[++i];
+        } else if (arg == "--shard-worker" && i + 1 < argc) {
+            shard_worker = argv[++i];
+        } else if (arg == "--shard-workers" && i + 1 < argc) {
+            shard_workers = std::stoi(argv[++i]);
+        } else if (arg == "--shard-unit" && i + 1 < argc) {
+            shard_unit = std::stoi(argv[++i]);
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            if (!apply_memory_budget(argv[++i])) {
+                std::cerr << "Error: bad --memory-budget: " << argv[i] << "\n\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metrics_address = argv[++i];
+        } else if (arg == "--metrics-sample" && i + 1 < argc) {
+            metrics_sample = std::stoi(argv[++i]);
+        } else if (arg == "--profile" && i + 1 < argc) {
+            config.profile_path = argv[++i];
+        } else if (arg == "--run-step-budget" && i + 1 < argc) {
+            config.run_step_budget = std::stoi(argv[++i]);
+        } else if (arg == "--run-wall-budget" && i + 1 < argc) {
+            config.run_wall_budget = std::stod(argv[++i]);
+        } else if (arg == "--tail-report" && i + 1 < argc) {
+            config.tail_report_path = argv[++i];
+            if (config.tail_runs == 0) config.tail_runs = 10;
+        } else if (arg == "--tail-runs" && i + 1 < argc) {
+            config.tail_runs = std::stoi(argv[++i]);
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            cache_size = std::stoi(argv[++i]);
+        } else if (arg == "--scenario-cache" && i + 1 < argc) {
+            config.scenario_cache = argv[++i];
+        } else if (arg == "--doe" && i + 1 < argc) {
+            doe_path = argv[++i];
+        } else if (arg == "--training" && i + 1 < argc) {
+            training_path = argv[++i];
+        } else if (arg == "--fit-surrogate" && i + 1 < argc) {
+            fit_path = argv[++i];
+        } else if (arg == "--surrogate" && i + 1 < argc) {
+            surrogate_path = argv[++i];
+        } else if (arg == "--query" && i + 1 < argc) {
+            queries.push_back(argv[++i]);
+        } else if (arg == "--max-std" && i + 1 < argc) {
+            max_std = std::stod(argv[++i]);
+        } else if (arg == "--to-json" && i + 1 < argc) {
+            convert_path = argv[++i];
+        } else if (arg == "--store-query" && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (arg == "--where" && i + 1 < argc) {
+            store_query.where = argv[++i];
+        } else if (arg == "--agg" && i + 1 < argc) {
+            store_query.aggregations.push_back(argv[++i]);
         } else if (arg == "--output" && i + 1 < argc) {
             config.output_path = argv[++i];
         } else if (arg == "--verbose" || arg == "-v") {
@@ -79,35 +1380,216 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // ── Conversion mode: binary results → JSON ──
+    if (!convert_path.empty()) {
+        std::ifstream in(convert_path, std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "Error: cannot open results file: " << convert_path << "\n";
+            return 1;
+        }
+        try {
+            if (config.output_path.empty()) {
+                sim::mc::convert_results_binary_to_json(in, std::cout);
+            } else {
+                std::ofstream out(config.output_path);
+                if (!out.is_open()) {
+                    std::cerr << "Error: cannot open output file: "
+                              << config.output_path << "\n";
+                    return 1;
+                }
+                sim::mc::convert_results_binary_to_json(in, out);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error converting results: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // ── Query mode: indexed results store → JSON answer ──
+    if (!store_path.empty()) {
+        try {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            sim::mc::ResultsStore store(store_path);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            if (config.output_path.empty()) {
+                sim::mc::write_store_query(store, store_query, std::cout);
+            } else {
+                std::ofstream out(config.output_path);
+                if (!out.is_open()) {
+                    std::cerr << "Error: cannot open output file: "
+                              << config.output_path << "\n";
+                    return 1;
+                }
+                sim::mc::write_store_query(store, store_query, out);
+            }
+            auto t2 = std::chrono::high_resolution_clock::now();
+            if (config.verbose) {
+                std::cerr << "Store: " << store.num_rows() << " runs, "
+                          << store.entities().size() << " entities, "
+                          << store.num_events() << " engagements; open "
+                          << std::chrono::duration<double, std::milli>(t1 - t0).count()
+                          << " ms, query "
+                          << std::chrono::duration<double, std::milli>(t2 - t1).count()
+                          << " ms\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error querying results store: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // A bad --wez directory fails here, not inside the first runner
+    if (!config.wez_dir.empty()) {
+        try {
+            sim::mc::WEZLibrary::load(config.wez_dir);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: --wez: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    // One profiler for every mode below: full with --profile, else sampled
+    // for --metrics (declared after it, the server stops before it is freed)
+    std::unique_ptr<sim::mc::TickProfiler> profiler;
+    if (!config.profile_path.empty()) {
+        profiler = std::make_unique<sim::mc::TickProfiler>();
+    } else if (!metrics_address.empty()) {
+        profiler = std::make_unique<sim::mc::TickProfiler>(
+            static_cast<uint32_t>(std::max(metrics_sample, 1)));
+    }
+    std::unique_ptr<sim::distributed::MetricsServer> metrics;
+    if (!metrics_address.empty()) {
+        try {
+            metrics = start_metrics(metrics_address, *profiler);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: --metrics: " << e.what() << "\n";
+            return 1;
+        }
+        if (config.verbose) std::cerr << "Metrics on " << metrics_address << "\n";
+    }
+
+    if (!serve_path.empty()) {
+        try {
+            sim::mc::MCDaemon daemon(config, static_cast<size_t>(std::max(cache_size, 1)));
+            daemon.set_profiler(profiler.get());
+            daemon.serve(serve_path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!shard_worker.empty()) {
+        try {
+            sim::mc::MCShardWorker worker(config);
+            worker.set_profiler(profiler.get());
+            worker.run(shard_worker);
+            if (config.verbose) {
+                std::cerr << "[shard-worker] done, " << worker.units_completed() << " units\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!shard_listen.empty()) {
+        return run_shard_mode(config, shard_listen, shard_workers, shard_unit, doe_path);
+    }
+
+    if (!fit_path.empty()) {
+        return run_fit_mode(config, fit_path);
+    }
+
+    if (!surrogate_path.empty()) {
+        return run_surrogate_mode(config, surrogate_path, queries, max_std, doe_path);
+    }
+
+    if (!doe_path.empty()) {
+        return run_doe_mode(config, doe_path, training_path, profiler.get());
+    }
+
+    if (config.output_format != "json" && config.output_format != "binary" &&
+        config.output_format != "aggregate" && config.output_format != "store") {
+        std::cerr << "Error: --format must be json, binary, aggregate or store\n\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
     if (config.scenario_path.empty()) {
         std::cerr << "Error: --scenario is required\n\n";
         print_usage(argv[0]);
         return 1;
     }
 
-    // Load scenario JSON
+    if (config.resume && config.checkpoint_path.empty()) {
+        if (config.output_path.empty()) {
+            std::cerr << "Error: --resume needs --checkpoint or --output\n";
+            return 1;
+        }
+        config.checkpoint_path = config.output_path + ".ckpt";
+    }
+    if (!config.checkpoint_path.empty() && !config.replay_mode &&
+        (config.antithetic || config.ci_half_width > 0.0)) {
+        std::cerr << "Error: --antithetic and --ci-half-width are not supported with --checkpoint\n";
+        return 1;
+    }
+
+    // Load the scenario and parse its prototype world once (through the
+    // scenario cache when enabled)
     sim::JsonValue scenario;
+    sim::mc::MCWorld prototype;
     try {
-        scenario = sim::JsonReader::parse_file(config.scenario_path);
+        if (!config.scenario_cache.empty()) {
+            sim::mc::ScenarioCache cache(config.scenario_cache);
+            sim::mc::LoadedScenario loaded = cache.load_file(config.scenario_path, config.num_threads);
+            scenario = loaded.scenario;
+            prototype = std::move(loaded.world);
+            if (config.verbose) {
+                std::cerr << "Scenario cache " << (loaded.from_cache ? "hit" : "miss") << ": "
+                          << cache.path_for(loaded.hash) << "\n";
+            }
+        } else {
+            scenario = sim::JsonReader::parse_file(config.scenario_path);
+            prototype = sim::mc::ScenarioParser::parse(scenario, config.num_threads);
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error loading scenario: " << e.what() << "\n";
         return 1;
     }
 
     // Validate
-    if (!scenario["entities"].is_array() || scenario["entities"].size() == 0) {
+    if (prototype.entities().empty()) {
         std::cerr << "Error: scenario has no entities\n";
         return 1;
     }
 
-    sim::mc::MCRunner runner(config);
-
-    if (config.replay_mode) {
+    if (!live_address.empty()) {
+        try {
+            sim::mc::MCLiveServer server(config, live);
+            server.set_profiler(profiler.get());
+            server.serve(prototype, live_address);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    } else if (!replay_from.empty()) {
+        int rc = run_replay_bundle_mode(config, prototype, scenario, replay_from, replay_query,
+                                        profiler.get());
+        if (rc != 0) return rc;
+    } else if (!split_target.empty() && !config.replay_mode) {
+        int rc = run_split_mode(config, prototype, split_target, split_distances, profiler.get());
+        if (rc != 0) return rc;
+    } else if (config.replay_mode) {
         // ── Replay mode: single run with trajectory sampling ──
         if (config.verbose) {
             std::cerr << "=== Replay Mode ===\n"
                       << "Scenario: " << config.scenario_path << "\n"
-                      << "Entities: " << scenario["entities"].size() << "\n"
+                      << "Entities: " << prototype.entities().size() << "\n"
                       << "Seed: " << config.base_seed << "\n"
                       << "Max time: " << config.max_sim_time << "s\n"
                       << "Sample interval: " << config.sample_interval << "s\n"
@@ -116,26 +1598,40 @@ int main(int argc, char* argv[]) {
                       << "\n\n";
         }
 
+        // Buffered trajectories over the replay budget: stream them instead
+        stream_over_budget(config, prototype, 1);
+
+        sim::mc::MCRunner runner(config);
+        runner.set_profiler(profiler.get());
+
         auto t_start = std::chrono::high_resolution_clock::now();
 
-        if (config.output_path.empty()) {
-            runner.run_replay(scenario, std::cout);
-        } else {
-            std::ofstream out(config.output_path);
-            if (!out.is_open()) {
-                std::cerr << "Error: cannot open output file: "
-                          << config.output_path << "\n";
-                return 1;
+        sim::AsyncOFStream file;
+        try {
+            if (config.output_path.empty()) {
+                runner.run_replay(prototype, std::cout);
+            } else {
+                file.open(config.output_path);
+                if (!file.is_open()) {
+                    std::cerr << "Error: cannot open output file: "
+                              << config.output_path << "\n";
+                    return 1;
+                }
+                runner.run_replay(prototype, file);
+                if (!close_output(file, config.output_path)) return 1;
             }
-            runner.run_replay(scenario, out);
+        } catch (const sim::MemoryBudgetExceeded& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
         }
 
         auto t_end = std::chrono::high_resolution_clock::now();
         double elapsed = std::chrono::duration<double>(t_end - t_start).count();
 
         if (config.progress) {
-            std::cerr << "{\"type\":\"done\",\"mode\":\"replay\",\"elapsed\":"
-                      << elapsed << "}\n" << std::flush;
+            std::cerr << "{\"type\":\"done\",\"mode\":\"replay\",\"elapsed\":" << elapsed;
+            write_output_stats(std::cerr, file, config.output_path);
+            std::cerr << "}\n" << std::flush;
         }
         if (config.verbose) {
             std::cerr << "\nReplay generated in " << elapsed << "s\n";
@@ -149,8 +1645,9 @@ int main(int argc, char* argv[]) {
         if (config.verbose) {
             std::cerr << "=== MC Engine ===\n"
                       << "Scenario: " << config.scenario_path << "\n"
-                      << "Entities: " << scenario["entities"].size() << "\n"
+                      << "Entities: " << prototype.entities().size() << "\n"
                       << "Runs: " << config.num_runs << "\n"
+                      << "Threads: " << config.num_threads << "\n"
                       << "Base seed: " << config.base_seed << "\n"
                       << "Max time: " << config.max_sim_time << "s\n"
                       << "Timestep: " << config.dt << "s\n"
@@ -158,70 +1655,212 @@ int main(int argc, char* argv[]) {
                       << "\n\n";
         }
 
+        // Latin-hypercube design, checked before any output is written
+        std::unique_ptr<sim::mc::LatinHypercube> lhs;
+        if (config.lhs) {
+            if (!scenario["uncertainties"].is_array() ||
+                scenario["uncertainties"].size() == 0) {
+                std::cerr << "Error: --lhs needs an \"uncertainties\" array in the scenario\n";
+                return 1;
+            }
+            try {
+                lhs = std::make_unique<sim::mc::LatinHypercube>(
+                    scenario["uncertainties"], config.num_runs, config.base_seed);
+            } catch (const std::exception& e) {
+                std::cerr << "Error in uncertainties: " << e.what() << "\n";
+                return 1;
+            }
+        }
+
+        // Open the output first: results stream out as runs complete
+        sim::AsyncOFStream file;
+        if (!config.output_path.empty()) {
+            file.open(config.output_path);
+            if (!file.is_open()) {
+                std::cerr << "Error: cannot open output file: "
+                          << config.output_path << "\n";
+                return 1;
+            }
+        }
+        std::ostream& out = config.output_path.empty() ? std::cout : file;
+
+        std::unique_ptr<sim::mc::ResultsWriter> writer;
+        if (config.output_format == "binary") {
+            writer = std::make_unique<sim::mc::BinaryResultsWriter>(
+                out, config.num_runs, config.base_seed, config.max_sim_time);
+        } else if (config.output_format == "store") {
+            writer = std::make_unique<sim::mc::ResultsStoreWriter>(
+                out, config.num_runs, config.base_seed, config.max_sim_time);
+        } else if (config.output_format == "aggregate") {
+            writer = std::make_unique<sim::mc::AggregateResultsWriter>(
+                out, config.num_runs, config.base_seed, config.max_sim_time);
+        } else {
+            writer = std::make_unique<sim::mc::JsonResultsWriter>(
+                out, config.num_runs, config.base_seed, config.max_sim_time);
+        }
+
+        // Progressive snapshots fold runs into an aggregate of their own,
+        // unless the writer already keeps one
+        std::unique_ptr<sim::mc::AggregateSnapshots> snapshots;
+        std::unique_ptr<sim::mc::MCAggregator> live_agg;
+        if (config.progress && (config.snapshot_every > 0 || config.snapshot_interval > 0.0)) {
+            snapshots = std::make_unique<sim::mc::AggregateSnapshots>(
+                std::cerr, config.snapshot_every, config.snapshot_interval, config.num_runs);
+            if (config.output_format != "aggregate") {
+                live_agg = std::make_unique<sim::mc::MCAggregator>(config.max_sim_time);
+            }
+        }
+
+        int completed_runs = 0;
+        int total_engagements = 0;
+        int total_kills = 0;
+        int errors = 0;
+        auto record = [&](sim::mc::RunResult& r) {
+            completed_runs++;
+            if (!r.error.empty()) {
+                errors++;
+            } else {
+                total_engagements += static_cast<int>(r.engagement_log.size());
+                for (const auto& e : r.engagement_log) {
+                    if (e.result == "KILL") total_kills++;
+                }
+            }
+            writer->write_run(r);
+            if (snapshots) {
+                if (live_agg) live_agg->add(r);
+                snapshots->update(live_agg ? *live_agg :
+                    static_cast<sim::mc::AggregateResultsWriter&>(*writer).aggregator());
+            }
+        };
+
+        // Resumable batch: replay the checkpointed runs, then run the rest
+        std::unique_ptr<sim::mc::BatchCheckpoint> checkpoint;
+        sim::mc::MCConfig run_config = config;
+        int resumed = 0;
+        if (!config.checkpoint_path.empty()) {
+            try {
+                std::ifstream in(config.scenario_path, std::ios::binary);
+                std::stringstream text;
+                text << in.rdbuf();
+                uint64_t hash = sim::mc::ScenarioCache::content_hash(text.str());
+                checkpoint = std::make_unique<sim::mc::BatchCheckpoint>(
+                    config.checkpoint_path, config, hash,
+                    config.output_format != "aggregate", config.checkpoint_interval);
+                if (config.resume) {
+                    resumed = checkpoint->resume(record);
+                } else {
+                    checkpoint->start();
+                }
+                if (config.output_format == "aggregate") {
+                    static_cast<sim::mc::AggregateResultsWriter&>(*writer).merge(
+                        checkpoint->aggregate());
+                    completed_runs = resumed;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return 1;
+            }
+            run_config.first_run += resumed;
+            run_config.num_runs -= resumed;
+            if (config.verbose && resumed > 0) {
+                std::cerr << "Resuming after " << resumed << " checkpointed runs ("
+                          << config.checkpoint_path << ")\n";
+            }
+        }
+
+        sim::mc::MCRunner runner(run_config);
+        runner.set_profiler(profiler.get());
+
+        // Latin-hypercube sample over the declared uncertainties
+        if (lhs) {
+            runner.set_run_setup([&lhs](sim::mc::MCWorld& world, int run_index) {
+                lhs->apply(run_index, world);
+            });
+        }
+
         auto t_start = std::chrono::high_resolution_clock::now();
 
         sim::mc::MCRunner::ProgressCallback progress_cb = nullptr;
         if (config.progress) {
             progress_cb = [&](int completed, int total) {
-                std::cerr << "{\"type\":\"run_complete\",\"run\":" << completed
-                          << ",\"total\":" << total << "}\n" << std::flush;
+                std::cerr << "{\"type\":\"run_complete\",\"run\":" << completed + resumed
+                          << ",\"total\":" << total + resumed << "}\n" << std::flush;
             };
         }
 
-        auto results = runner.run(scenario, progress_cb);
+        if (config.progress && config.ci_half_width > 0.0) {
+            runner.set_convergence_callback([](const sim::mc::ConvergenceReport& c) {
+                std::cerr << "{\"type\":\"convergence\",\"runs\":" << c.runs_completed
+                          << ",\"halfWidth\":" << c.achieved_half_width
+                          << ",\"target\":" << c.target_half_width
+                          << ",\"converged\":" << (c.converged ? "true" : "false")
+                          << "}\n" << std::flush;
+            });
+        }
 
-        auto t_end = std::chrono::high_resolution_clock::now();
-        double elapsed = std::chrono::duration<double>(t_end - t_start).count();
+        try {
+            runner.run_streaming(prototype, [&](sim::mc::RunResult& r) {
+                if (checkpoint) checkpoint->add(r);
+                record(r);
+            }, progress_cb);
+            if (snapshots) {
+                snapshots->finish(live_agg ? *live_agg :
+                    static_cast<sim::mc::AggregateResultsWriter&>(*writer).aggregator());
+            }
+            writer->set_convergence(runner.convergence());
 
-        if (config.verbose) {
-            int total_engagements = 0;
-            int total_kills = 0;
-            int errors = 0;
-            for (const auto& r : results) {
-                if (!r.error.empty()) { errors++; continue; }
-                total_engagements += static_cast<int>(r.engagement_log.size());
-                for (const auto& e : r.engagement_log) {
-                    if (e.result == "KILL") total_kills++;
+            sim::mc::VarianceReport variance = runner.variance();
+            if (lhs) {
+                variance.method = variance.enabled() ? "antithetic+lhs" : "lhs";
+                variance.strata = lhs->strata();
+                for (size_t d = 0; d < lhs->dimensions(); d++) {
+                    variance.dimensions.push_back(lhs->dimension(d).name);
                 }
             }
+            writer->set_variance(variance);
+            writer->finish();
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing results: " << e.what() << "\n";
+            return 1;
+        }
+        if (!close_output(file, config.output_path)) return 1;
+        if (checkpoint) checkpoint->remove();
+        if (!config.tail_report_path.empty() &&
+            !write_tail_report(runner.tail_report(), config.tail_report_path)) return 1;
+
+        auto t_end = std::chrono::high_resolution_clock::now();
+        double elapsed = std::chrono::duration<double>(t_end - t_start).count();
 
+        if (config.verbose) {
             std::cerr << "\n=== Results ===\n"
-                      << "Completed: " << results.size() << " runs in "
+                      << "Completed: " << completed_runs << " runs in "
                       << elapsed << "s\n"
                       << "Errors: " << errors << "\n"
                       << "Total engagements: " << total_engagements << "\n"
                       << "Total kills: " << total_kills << "\n"
                       << "Avg kills/run: "
-                      << (results.size() > 0 ? static_cast<double>(total_kills) / results.size() : 0)
+                      << (completed_runs > 0 ? static_cast<double>(total_kills) / completed_runs : 0)
                       << "\n";
-        }
-
-        // Write output
-        if (config.output_path.empty()) {
-            sim::mc::write_results_json(results, config.num_runs,
-                                        config.base_seed, config.max_sim_time,
-                                        std::cout);
-        } else {
-            std::ofstream out(config.output_path);
-            if (!out.is_open()) {
-                std::cerr << "Error: cannot open output file: "
-                          << config.output_path << "\n";
-                return 1;
+            const auto& conv = runner.convergence();
+            if (conv.enabled) {
+                std::cerr << "Convergence: " << (conv.converged ? "reached" : "not reached")
+                          << " after " << conv.runs_completed << " runs (half-width "
+                          << conv.achieved_half_width << ", target "
+                          << conv.target_half_width << ")\n";
             }
-            sim::mc::write_results_json(results, config.num_runs,
-                                        config.base_seed, config.max_sim_time,
-                                        out);
-            if (config.verbose) {
+            if (!config.output_path.empty()) {
                 std::cerr << "Results written to: " << config.output_path << "\n";
             }
         }
 
         if (config.progress) {
             std::cerr << "{\"type\":\"done\",\"mode\":\"batch\",\"runs\":"
-                      << results.size() << ",\"elapsed\":" << elapsed << "}\n"
-                      << std::flush;
+                      << completed_runs << ",\"elapsed\":" << elapsed;
+            write_output_stats(std::cerr, file, config.output_path);
+            std::cerr << "}\n" << std::flush;
         }
     }
 
+    if (!config.profile_path.empty() && !write_profile(*profiler, config.profile_path)) return 1;
     return 0;
 }
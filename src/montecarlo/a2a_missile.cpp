@@ -1,38 +1,52 @@
 #include "montecarlo/a2a_missile.hpp"
 #include "montecarlo/geo_utils.hpp"
+#include "montecarlo/missile_flyout.hpp"
 #include <cmath>
 #include <algorithm>
 #include <limits>
 
 namespace sim::mc {
 
-// Default weapon specifications — initialized on first update if a2a_specs is empty
-static void ensure_default_specs(MCEntity& e) {
-    if (!e.a2a_specs.empty()) return;
+// Weapon specifications by A2AWeapon (OTHER has none and is never fired)
+static constexpr WeaponSpec A2A_SPECS[static_cast<size_t>(A2AWeapon::OTHER)] = {
+    {A2AWeapon::AIM120, 80000.0, 0.75, 1400.0},
+    {A2AWeapon::AIM9,   18000.0, 0.85,  900.0},
+    {A2AWeapon::R77,    80000.0, 0.70, 1300.0},
+    {A2AWeapon::R73,    18000.0, 0.80,  850.0},
+};
 
-    e.a2a_specs["aim120"] = WeaponSpec{"aim120", 80000.0, 0.75, 1400.0};
-    e.a2a_specs["aim9"]   = WeaponSpec{"aim9",   18000.0, 0.85,  900.0};
-    e.a2a_specs["r77"]    = WeaponSpec{"r77",    80000.0, 0.70, 1300.0};
-    e.a2a_specs["r73"]    = WeaponSpec{"r73",    18000.0, 0.80,  850.0};
+static const WeaponSpec& spec_of(A2AWeapon w) {
+    return A2A_SPECS[static_cast<size_t>(w)];
+}
+
+// Fly-out body: AIM-120-like beyond visual range, AIM-9-like within it
+static bool is_bvr(const WeaponSpec& spec) {
+    return spec.range > 30000.0;
 }
 
 /**
  * Select the best weapon for a given range.
- * Prefers the shortest-range weapon that still covers the target (min-overkill).
- * Returns a reference to the chosen WeaponSpec (must have count > 0 in inventory).
+ * Prefers the shortest-range weapon that still covers the target (min-overkill);
+ * ties go to the lower A2AWeapon. Returns nullptr if nothing in inventory reaches.
+ * With a launch geometry, a weapon with a WEZ table must also reach the
+ * target on at least WEZTable::SHOOT_REACH of its tabulated fly-outs.
  */
-static const WeaponSpec* select_best_weapon(MCEntity& e, double range) {
+static const WeaponSpec* select_best_weapon(const MCEntity& e, double range,
+                                            const MCWorld* world = nullptr,
+                                            const WEZGeometry* geometry = nullptr) {
     const WeaponSpec* best = nullptr;
     double best_range = std::numeric_limits<double>::max();
 
-    for (const auto& [name, count] : e.a2a_inventory) {
-        if (count <= 0) continue;
-
-        auto spec_it = e.a2a_specs.find(name);
-        if (spec_it == e.a2a_specs.end()) continue;
+    auto covers = [&](const WeaponSpec& spec) {
+        const WEZTable* table = geometry ? world->a2a_wez[static_cast<size_t>(spec.type)]
+                                         : nullptr;
+        if (spec.range < range) return false;
+        return !table || table->lookup(*geometry).reach >= WEZTable::SHOOT_REACH;
+    };
 
-        const WeaponSpec& spec = spec_it->second;
-        if (spec.range >= range && spec.range < best_range) {
+    for (const WeaponSpec& spec : A2A_SPECS) {
+        if (e.a2a_inventory[static_cast<size_t>(spec.type)] <= 0) continue;
+        if (spec.range < best_range && covers(spec)) {
             best = &spec;
             best_range = spec.range;
         }
@@ -45,17 +59,38 @@ static const WeaponSpec* select_best_weapon(MCEntity& e, double range) {
  * Check if any weapon remains in inventory.
  */
 static bool has_any_ammo(const MCEntity& e) {
-    for (const auto& [name, count] : e.a2a_inventory) {
+    for (int count : e.a2a_inventory) {
         if (count > 0) return true;
     }
     return false;
 }
 
+double A2AMissile::reach(const MCEntity& e) {
+    double r = 0.0;
+    for (const WeaponSpec& spec : A2A_SPECS) {
+        if (e.a2a_inventory[static_cast<size_t>(spec.type)] > 0) r = std::max(r, spec.range);
+    }
+    return r;
+}
+
+WEZWeapon A2AMissile::wez_weapon(A2AWeapon w) {
+    const WeaponSpec& spec = spec_of(w);
+    WEZWeapon weapon;
+    weapon.name = a2a_weapon_to_string(w);
+    weapon.bvr = is_bvr(spec);
+    weapon.speed = spec.speed;
+    weapon.max_range = spec.range;
+    return weapon;
+}
+
+// Targets the current shooter already engages
+static thread_local EntityMarks engaged;
+
 void A2AMissile::update_all(double dt, MCWorld& world) {
-    for (auto& entity : world.entities()) {
-        if (entity.weapon_type != WeaponType::A2A_MISSILE) continue;
-        if (!entity.active || entity.destroyed) continue;
-        update_entity(entity, dt, world);
+    auto& entities = world.entities();
+    for (uint32_t i : world.with_weapon(WeaponType::A2A_MISSILE)) {
+        if (!world.alive(i)) continue;
+        update_entity(entities[i], dt, world);
     }
 }
 
@@ -63,184 +98,175 @@ void A2AMissile::update_entity(MCEntity& e, double dt, MCWorld& world) {
     // Weapons hold — don't engage
     if (e.engagement_rules == "weapons_hold") return;
 
-    // Initialize default weapon specs if needed
-    ensure_default_specs(e);
-
-    // Winchester check — no weapons left
-    if (!has_any_ammo(e)) return;
+    // Winchester check — no weapons left (fly-out still guides shots in the air)
+    if (!has_any_ammo(e) &&
+        !(world.missiles.enabled && !e.a2a_engagements.empty())) return;
 
-    double self_lat_rad = e.geo_lat * M_PI / 180.0;
-    double self_lon_rad = e.geo_lon * M_PI / 180.0;
+    // Slant ranges from the per-tick frame cache (geodetic fields via ECEF)
+    const uint32_t self = world.index_of(e);
 
-    // ── Advance existing engagements ──
-    for (auto it = e.a2a_engagements.begin(); it != e.a2a_engagements.end(); ) {
-        A2AEngagement& eng = *it;
+    // ── Advance existing engagements (finished ones compacted out in order) ──
+    auto& engagements = e.a2a_engagements;
+    size_t kept = 0;
+    for (size_t k = 0; k < engagements.size(); k++) {
+        A2AEngagement& eng = engagements[k];
+        bool done = false;
 
         eng.phase_timer -= dt;
-        if (eng.phase_timer > 0.0) {
-            ++it;
-            continue;
-        }
+        if (eng.phase_timer <= 0.0) {
+            switch (eng.phase) {
+
+            case 0: {
+                // LOCK → FIRE
+                MCEntity* target = world.get(eng.target);
+                if (!target || !target->active || target->destroyed) {
+                    done = true;
+                    break;
+                }
 
-        switch (eng.phase) {
+                // Check weapon availability
+                int& rounds = e.a2a_inventory[static_cast<size_t>(eng.weapon_type)];
+                if (rounds <= 0) {
+                    done = true;
+                    break;
+                }
 
-        case 0: {
-            // LOCK → FIRE
-            MCEntity* target = world.get_entity(eng.target_id);
-            if (!target || !target->active || target->destroyed) {
-                it = e.a2a_engagements.erase(it);
-                break;
-            }
+                // Decrement inventory
+                rounds--;
+
+                // Log LAUNCH
+                world.log_engagement(e, eng.target, EngagementResult::LAUNCH);
+
+                // Compute TOF (and reach, from the weapon's WEZ table)
+                double range = ecef_range(world.geodetic_ecef(self),
+                                          world.geodetic_ecef(eng.target));
+                const WeaponSpec& spec = spec_of(eng.weapon_type);
+                double tof = range / spec.speed;
+                const WEZTable* table = world.a2a_wez[static_cast<size_t>(eng.weapon_type)];
+                if (table && !world.missiles.enabled) {
+                    WEZLookup w = table->lookup(wez_geometry(world, self, eng.target, range));
+                    tof = w.tof;
+                    eng.reach = w.reach;
+                }
 
-            // Check weapon availability
-            auto inv_it = e.a2a_inventory.find(eng.weapon_type);
-            if (inv_it == e.a2a_inventory.end() || inv_it->second <= 0) {
-                it = e.a2a_engagements.erase(it);
+                eng.phase = 1;
+                eng.phase_timer = tof;
+                if (world.missiles.enabled) {
+                    // Guided shot: poll the body every tick instead
+                    eng.missile = MissileFlyout::launch(world, self, eng.target, is_bvr(spec),
+                                                        spec.speed, spec.range, 1);
+                    eng.phase_timer = 0.0;
+                }
                 break;
             }
 
-            // Decrement inventory
-            inv_it->second--;
+            case 1: {
+                // GUIDE complete → ASSESS
+                MCEntity* target = world.get(eng.target);
+
+                // Fly-out: Pk is rolled only if the body reached the target
+                bool reached = true;
+                if (eng.missile != NO_MISSILE) {
+                    FlyoutStatus status = world.missiles[eng.missile].status;
+                    if (status == FlyoutStatus::FLYING) break;
+                    world.missiles.release(eng.missile);
+                    eng.missile = NO_MISSILE;
+                    reached = status == FlyoutStatus::HIT;
+                }
 
-            // Log LAUNCH
-            e.engagements.push_back(EngagementRecord{
-                eng.target_id,
-                target->name,
-                "LAUNCH",
-                world.sim_time
-            });
+                // Roll Pk
+                double pk = spec_of(eng.weapon_type).pk * eng.reach;
 
-            // Compute TOF
-            double range = slant_range_ecef(
-                self_lat_rad, self_lon_rad, e.geo_alt,
-                target->geo_lat * M_PI / 180.0,
-                target->geo_lon * M_PI / 180.0,
-                target->geo_alt);
-
-            auto spec_it = e.a2a_specs.find(eng.weapon_type);
-            double missile_speed = (spec_it != e.a2a_specs.end())
-                                   ? spec_it->second.speed : 1000.0;
-            double tof = range / missile_speed;
-
-            eng.phase = 1;
-            eng.phase_timer = tof;
-            ++it;
-            break;
-        }
+                bool hit = reached && world.rng.bernoulli(pk, world.index_of(e));
+
+                if (hit && target && target->active && !target->destroyed) {
+                    world.kill(*target);
 
-        case 1: {
-            // GUIDE complete → ASSESS
-            MCEntity* target = world.get_entity(eng.target_id);
-
-            // Roll Pk
-            auto spec_it = e.a2a_specs.find(eng.weapon_type);
-            double pk = (spec_it != e.a2a_specs.end()) ? spec_it->second.pk : 0.5;
-
-            bool hit = world.rng.bernoulli(pk);
-
-            if (hit && target && target->active && !target->destroyed) {
-                target->active = false;
-                target->destroyed = true;
-
-                // Log KILL on shooter
-                e.engagements.push_back(EngagementRecord{
-                    eng.target_id,
-                    target->name,
-                    "KILL",
-                    world.sim_time
-                });
-
-                // Log KILLED_BY on target
-                target->engagements.push_back(EngagementRecord{
-                    e.id,
-                    e.name,
-                    "KILLED_BY",
-                    world.sim_time
-                });
-            } else {
-                // Log MISS
-                e.engagements.push_back(EngagementRecord{
-                    eng.target_id,
-                    target ? target->name : eng.target_id,
-                    "MISS",
-                    world.sim_time
-                });
+                    // Log KILL on shooter
+                    world.log_engagement(e, eng.target, EngagementResult::KILL);
+
+                } else {
+                    // Log MISS
+                    world.log_engagement(e, eng.target, EngagementResult::MISS);
+                }
+
+                eng.phase = 2;
+                eng.phase_timer = 2.0;  // assess time
+                break;
             }
 
-            eng.phase = 2;
-            eng.phase_timer = 2.0;  // assess time
-            ++it;
-            break;
-        }
+            case 2: {
+                // ASSESS complete → remove
+                done = true;
+                break;
+            }
 
-        case 2: {
-            // ASSESS complete → remove
-            it = e.a2a_engagements.erase(it);
-            break;
+            default:
+                done = true;
+                break;
+            }
         }
 
-        default:
-            it = e.a2a_engagements.erase(it);
-            break;
+        if (!done) {
+            if (kept != k) engagements[kept] = eng;
+            kept++;
         }
     }
+    engagements.resize(kept);
 
     // ── Look for new targets ──
 
-    // Helper: check if already engaging a target
-    auto is_engaging = [&](const std::string& target_id) -> bool {
-        for (const auto& eng : e.a2a_engagements) {
-            if (eng.target_id == target_id) return true;
-        }
-        return false;
-    };
+    engaged.reset(world.entities().size());
+    for (const auto& eng : engagements) engaged.set(eng.target);
+    auto is_engaging = [&](EntityHandle target) { return engaged.test(target); };
 
     // Source 1: Own radar detections (if this entity has a radar)
     if (e.has_radar) {
         for (const auto& det : e.radar_detections) {
-            if (is_engaging(det.entity_id)) continue;
+            if (is_engaging(det.entity)) continue;
 
-            MCEntity* target = world.get_entity(det.entity_id);
+            MCEntity* target = world.get(det.entity);
             if (!target || !target->active || target->destroyed) continue;
 
             // Compute range from self to target
-            double range = slant_range_ecef(
-                self_lat_rad, self_lon_rad, e.geo_alt,
-                target->geo_lat * M_PI / 180.0,
-                target->geo_lon * M_PI / 180.0,
-                target->geo_alt);
+            double range = ecef_range(world.geodetic_ecef(self),
+                                      world.geodetic_ecef(det.entity));
 
             // Select best weapon for this range
-            const WeaponSpec* spec = select_best_weapon(e, range);
+            WEZGeometry geometry;
+            if (world.wez) geometry = wez_geometry(world, self, det.entity, range);
+            const WeaponSpec* spec = select_best_weapon(e, range, &world,
+                                                        world.wez ? &geometry : nullptr);
             if (!spec) continue;
 
-            e.a2a_engagements.push_back(A2AEngagement{
-                det.entity_id,
+            engagements.push_back(A2AEngagement{
+                det.entity,
                 0,                  // phase = LOCK
                 e.a2a_lock_time,    // lock time
-                spec->name          // weapon type
+                spec->type          // weapon type
             });
+            engaged.set(det.entity);
         }
     }
 
     // Source 2: Intercept AI target assignment
-    if (e.intercept_state == 1 && !e.intercept_target_id.empty()) {
-        if (!is_engaging(e.intercept_target_id)) {
-            MCEntity* target = world.get_entity(e.intercept_target_id);
+    if (e.intercept_state == 1 && e.intercept_target != NO_ENTITY) {
+        if (!is_engaging(e.intercept_target)) {
+            MCEntity* target = world.get(e.intercept_target);
             if (target && target->active && !target->destroyed) {
-                double range = slant_range_ecef(
-                    self_lat_rad, self_lon_rad, e.geo_alt,
-                    target->geo_lat * M_PI / 180.0,
-                    target->geo_lon * M_PI / 180.0,
-                    target->geo_alt);
+                double range = ecef_range(world.geodetic_ecef(self),
+                                          world.geodetic_ecef(e.intercept_target));
 
-                const WeaponSpec* spec = select_best_weapon(e, range);
+                WEZGeometry geometry;
+                if (world.wez) geometry = wez_geometry(world, self, e.intercept_target, range);
+                const WeaponSpec* spec = select_best_weapon(e, range, &world,
+                                                            world.wez ? &geometry : nullptr);
                 if (spec) {
-                    e.a2a_engagements.push_back(A2AEngagement{
-                        e.intercept_target_id,
+                    engagements.push_back(A2AEngagement{
+                        e.intercept_target,
                         0,                  // phase = LOCK
                         e.a2a_lock_time,
-                        spec->name
+                        spec->type
                     });
                 }
             }
@@ -254,15 +280,12 @@ const WeaponSpec& A2AMissile::select_weapon(MCEntity& e, double range) {
     if (best) return *best;
 
     // Fallback: return any weapon spec that has inventory
-    for (const auto& [name, count] : e.a2a_inventory) {
-        if (count > 0) {
-            auto it = e.a2a_specs.find(name);
-            if (it != e.a2a_specs.end()) return it->second;
-        }
+    for (const WeaponSpec& spec : A2A_SPECS) {
+        if (e.a2a_inventory[static_cast<size_t>(spec.type)] > 0) return spec;
     }
 
     // Last resort: return first spec (should not reach here if has_any_ammo passed)
-    return e.a2a_specs.begin()->second;
+    return A2A_SPECS[0];
 }
 
 } // namespace sim::mc
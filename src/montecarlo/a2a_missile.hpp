@@ -8,6 +8,12 @@ namespace sim::mc {
 class A2AMissile {
 public:
     static void update_all(double dt, MCWorld& world);
+
+    /** Longest range among the rounds `e` still carries (0 if none) [m]. */
+    static double reach(const MCEntity& e);
+
+    /** The body a shot of `w` flies in fly-out mode, for generate_wez() (not OTHER). */
+    static WEZWeapon wez_weapon(A2AWeapon w);
 private:
     static void update_entity(MCEntity& e, double dt, MCWorld& world);
     static const WeaponSpec& select_weapon(MCEntity& e, double range);
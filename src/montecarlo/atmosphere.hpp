@@ -2,7 +2,9 @@
 #define SIM_MC_ATMOSPHERE_HPP
 
 #include <cmath>
+#include <vector>
 #include "core/state_vector.hpp"
+#include "physics/atmosphere_table.hpp"
 
 namespace sim {
 namespace mc {
@@ -171,6 +173,65 @@ inline AtmosphereResult get_atmosphere(double altitude_m) {
     return AtmosphereResult{T, P, rho, a};
 }
 
+// ---------------------------------------------------------------------------
+// Tabulated atmosphere for batched flight (MCConfig::batch_flight).
+// get_atmosphere() on sim::ProfileTable (monotone cubic, 50 m grid, layer
+// boundaries as breakpoints), plus the engine thrust lapse (rho/RHO0)^0.7
+// so the batch kernel needs no pow. Altitudes above TOP fall back to
+// get_atmosphere().
+// ---------------------------------------------------------------------------
+class US76Table {
+public:
+    static constexpr double STEP = 50.0;        // m
+    static constexpr double TOP = 100000.0;     // m, geometric
+
+    struct Sample {
+        double density;
+        double speed_of_sound;
+        double thrust_lapse;
+    };
+
+    static const US76Table& instance() {
+        static const US76Table table;
+        return table;
+    }
+
+    static bool covers(double altitude_m) { return altitude_m < TOP; }
+
+    /** Interpolated sample; altitude_m must satisfy covers(). */
+    Sample lookup(double altitude_m) const {
+        return Sample{density_(altitude_m), speed_of_sound_(altitude_m),
+                      thrust_lapse_(altitude_m)};
+    }
+
+    /** Exact sample, for altitudes the table does not cover. */
+    static Sample evaluate(double altitude_m) {
+        AtmosphereResult r = get_atmosphere(altitude_m);
+        return Sample{r.density, r.speed_of_sound, std::pow(r.density / RHO0, 0.7)};
+    }
+
+private:
+    US76Table()
+        : density_(breaks(), STEP, [](double h) { return evaluate(h).density; }),
+          speed_of_sound_(breaks(), STEP, [](double h) { return evaluate(h).speed_of_sound; }),
+          thrust_lapse_(breaks(), STEP, [](double h) { return evaluate(h).thrust_lapse; }) {}
+
+    // Layer bases and the standard-atmosphere top, as geometric altitudes
+    static std::vector<double> breaks() {
+        std::vector<double> b;
+        for (int i = 0; i < NUM_LAYERS; ++i) {
+            b.push_back(R_EARTH_GEOPOTENTIAL * LAYER_H[i] / (R_EARTH_GEOPOTENTIAL - LAYER_H[i]));
+        }
+        b.push_back(R_EARTH_GEOPOTENTIAL * H_TOP / (R_EARTH_GEOPOTENTIAL - H_TOP));
+        b.push_back(TOP);
+        return b;
+    }
+
+    sim::ProfileTable density_;
+    sim::ProfileTable speed_of_sound_;
+    sim::ProfileTable thrust_lapse_;
+};
+
 } // namespace mc
 } // namespace sim
 
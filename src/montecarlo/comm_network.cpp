@@ -0,0 +1,396 @@
+#include "montecarlo/comm_network.hpp"
+#include "montecarlo/mc_world.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double C_LIGHT = 299792458.0;             // m/s
+
+// Occlusion sphere as RadarSensor's geometric gate: below the lower
+// endpoint's local radius, shrunk with path length for WGS84 flattening
+constexpr double OCCLUSION_SLOPE = 21384.7 / R_EARTH_MEAN;
+constexpr double OCCLUSION_MARGIN = 1.0;            // m
+
+// CommEngine thresholds
+constexpr double MARGIN_EXCELLENT = 20.0;           // dB
+constexpr double MARGIN_GOOD = 10.0;
+constexpr double MARGIN_DEGRADED = 0.0;
+constexpr double JS_KILL = 0.0;                     // J/S dB
+constexpr double JS_DEGRADE = -6.0;
+constexpr double FIBER_MAX_ALT = 1000.0;            // m, both ends
+constexpr double LASER_CLEAR_ALT = 10000.0;         // m, up to 15 dB below
+constexpr double LASER_MAX_PENALTY = 15.0;          // dB
+
+double fspl_db(double d, double freq_hz) {
+    if (d <= 0.0 || freq_hz <= 0.0) return 0.0;
+    return 20.0 * std::log10(d) + 20.0 * std::log10(freq_hz) +
+           20.0 * std::log10(4.0 * M_PI / C_LIGHT);
+}
+
+double norm(const Vec3& v) { return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z); }
+
+// Closest approach of segment a -> b to the Earth's centre
+double closest_to_centre(const Vec3& a, const Vec3& b) {
+    const Vec3 d(b.x - a.x, b.y - a.y, b.z - a.z);
+    const double dd = d.x * d.x + d.y * d.y + d.z * d.z;
+    double s = dd > 0.0 ? -(a.x * d.x + a.y * d.y + a.z * d.z) / dd : 0.0;
+    s = std::min(1.0, std::max(0.0, s));
+    return norm(Vec3(a.x + s * d.x, a.y + s * d.y, a.z + s * d.z));
+}
+
+double altitude(const MCEntity& e, const Vec3& p) {
+    return e.physics_type == PhysicsType::ORBITAL_2BODY ? norm(p) - R_EARTH_MEAN : e.geo_alt;
+}
+
+LinkQuality tier_of_margin(double m) {
+    if (m > MARGIN_EXCELLENT) return LinkQuality::EXCELLENT;
+    if (m > MARGIN_GOOD) return LinkQuality::GOOD;
+    if (m > MARGIN_DEGRADED) return LinkQuality::DEGRADED;
+    return LinkQuality::LOST;
+}
+
+// CommEngine's edge weight; infinite when LOST
+double link_cost(const CommLink& l) {
+    double quality_factor = 1.0, loss = 0.0;
+    switch (l.quality) {
+        case LinkQuality::EXCELLENT: quality_factor = 1.0; loss = 0.001; break;
+        case LinkQuality::GOOD:      quality_factor = 0.8; loss = 0.01;  break;
+        case LinkQuality::DEGRADED:  quality_factor = 0.5; loss = 0.10;  break;
+        case LinkQuality::LOST:      return INF;
+    }
+    if (l.jammed) loss = std::min(1.0, loss + 0.3);
+    return l.latency_ms / quality_factor * (1.0 + loss);
+}
+
+// Route-repair scratch, reused across ticks on each thread
+using HeapEntry = std::pair<double, uint32_t>;
+thread_local std::vector<HeapEntry> heap;
+thread_local std::vector<uint8_t> marks;          // per node, see repair_routes
+thread_local std::vector<uint32_t> walk;
+thread_local std::vector<CommNet::LinkChange> changes;
+
+void heap_push(double d, uint32_t n) {
+    heap.emplace_back(d, n);
+    std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+}
+
+} // namespace
+
+// ── CommNet ──
+
+uint32_t CommNet::add_node(EntityHandle h) {
+    if (node_of_.size() <= h) node_of_.resize(h + 1, NO_ENTITY);
+    if (node_of_[h] == NO_ENTITY) {
+        node_of_[h] = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(h);
+        adj_.emplace_back();
+    }
+    return node_of_[h];
+}
+
+bool CommNet::add_link(const CommLink& l) {
+    if (l.node_a == l.node_b) return false;
+    for (uint32_t k : adj_[l.node_a]) {
+        if (links_[k].other(l.node_a) == l.node_b) return false;
+    }
+    const uint32_t k = static_cast<uint32_t>(links_.size());
+    links_.push_back(l);
+    adj_[l.node_a].push_back(k);
+    adj_[l.node_b].push_back(k);
+    return true;
+}
+
+void CommNet::add_root(EntityHandle h) {
+    const uint32_t n = node_of(h);
+    if (n == NO_ENTITY) return;
+    if (std::find(roots_.begin(), roots_.end(), n) == roots_.end()) roots_.push_back(n);
+}
+
+void CommNet::finalize() {
+    const size_t n = nodes_.size();
+    tree_of_.assign(n, NO_ENTITY);
+    for (size_t t = 0; t < roots_.size(); t++) tree_of_[roots_[t]] = static_cast<uint32_t>(t);
+    dist_.assign(roots_.size() * n, INF);
+    via_.assign(roots_.size() * n, NO_ENTITY);
+    last_pos_.assign(n + jammers_.size(), Vec3(0.0, 0.0, 0.0));
+    speed_.assign(n + jammers_.size(), 0.0);
+    node_alive_.assign(n, 0);
+    started_ = false;
+}
+
+double CommNet::route_cost(EntityHandle from, EntityHandle to) const {
+    const uint32_t a = node_of(from), b = node_of(to);
+    if (a == NO_ENTITY || b == NO_ENTITY || tree_of_[b] == NO_ENTITY) return INF;
+    return dist_[tree_of_[b] * nodes_.size() + a];
+}
+
+double CommNet::route_latency_ms(EntityHandle from, EntityHandle to) const {
+    if (!connected(from, to)) return -1.0;
+    const size_t base = tree_of_[node_of(to)] * nodes_.size();
+    double ms = 0.0;
+    for (uint32_t n = node_of(from); via_[base + n] != NO_ENTITY; ) {
+        const CommLink& l = links_[via_[base + n]];
+        ms += l.latency_ms + l.distance / C_LIGHT * 1000.0;
+        n = l.other(n);
+    }
+    return ms;
+}
+
+void CommNet::settle(size_t t) {
+    double* dist = &dist_[t * nodes_.size()];
+    uint32_t* via = &via_[t * nodes_.size()];
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        const auto [d, n] = heap.back();
+        heap.pop_back();
+        if (d > dist[n]) continue;
+        for (uint32_t k : adj_[n]) {
+            const CommLink& l = links_[k];
+            const uint32_t m = l.other(n);
+            const double nd = d + l.cost;
+            if (nd < dist[m]) {
+                dist[m] = nd;
+                via[m] = k;
+                heap_push(nd, m);
+            }
+        }
+    }
+}
+
+void CommNet::rebuild_routes() {
+    std::fill(dist_.begin(), dist_.end(), INF);
+    std::fill(via_.begin(), via_.end(), NO_ENTITY);
+    for (size_t t = 0; t < roots_.size(); t++) {
+        dist_[t * nodes_.size() + roots_[t]] = 0.0;
+        heap.clear();
+        heap_push(0.0, roots_[t]);
+        settle(t);
+    }
+}
+
+void CommNet::repair_routes(const std::vector<LinkChange>& changed) {
+    enum : uint8_t { UNKNOWN, KEPT, DROPPED };
+    const size_t n = nodes_.size();
+
+    for (size_t t = 0; t < roots_.size(); t++) {
+        double* dist = &dist_[t * n];
+        uint32_t* via = &via_[t * n];
+        heap.clear();
+
+        // Tree links that got worse cut off the subtrees below them
+        bool cut = false;
+        marks.assign(n, UNKNOWN);
+        for (const LinkChange& c : changed) {
+            const CommLink& l = links_[c.link];
+            if (!(l.cost > c.old_cost)) continue;
+            for (uint32_t m : {l.node_a, l.node_b}) {
+                if (via[m] == c.link) {
+                    marks[m] = DROPPED;
+                    cut = true;
+                }
+            }
+        }
+        if (cut) {
+            // A node is dropped if its parent chain reaches a cut node
+            for (uint32_t v = 0; v < n; v++) {
+                uint32_t m = v;
+                walk.clear();
+                while (marks[m] == UNKNOWN && via[m] != NO_ENTITY) {
+                    walk.push_back(m);
+                    m = links_[via[m]].other(m);
+                }
+                const uint8_t result = marks[m] == DROPPED ? DROPPED : KEPT;
+                for (uint32_t w : walk) marks[w] = result;
+                if (marks[m] == UNKNOWN) marks[m] = KEPT;
+            }
+            for (uint32_t v = 0; v < n; v++) {
+                if (marks[v] != DROPPED) continue;
+                dist[v] = INF;
+                via[v] = NO_ENTITY;
+            }
+            // Re-seed the dropped nodes from their kept neighbours
+            for (uint32_t v = 0; v < n; v++) {
+                if (marks[v] != DROPPED) continue;
+                for (uint32_t k : adj_[v]) {
+                    const uint32_t u = links_[k].other(v);
+                    if (marks[u] == DROPPED) continue;
+                    const double nd = dist[u] + links_[k].cost;
+                    if (nd < dist[v]) {
+                        dist[v] = nd;
+                        via[v] = k;
+                    }
+                }
+                if (dist[v] < INF) heap_push(dist[v], v);
+            }
+        }
+
+        // Links that got better relax their endpoints
+        for (const LinkChange& c : changed) {
+            const CommLink& l = links_[c.link];
+            if (!(l.cost < c.old_cost)) continue;
+            for (uint32_t u : {l.node_a, l.node_b}) {
+                const uint32_t v = l.other(u);
+                const double nd = dist[u] + l.cost;
+                if (nd < dist[v]) {
+                    dist[v] = nd;
+                    via[v] = c.link;
+                    heap_push(nd, v);
+                }
+            }
+        }
+        settle(t);
+    }
+}
+
+// ── CommNetwork ──
+
+void CommNetwork::evaluate(CommNet& net, CommLink& l, MCWorld& world) {
+    const double now = world.sim_time;
+    const EntityHandle ha = net.nodes_[l.node_a], hb = net.nodes_[l.node_b];
+
+    // Dead ends wait for a liveness change (update_all forces a check)
+    if (!world.alive(ha) || !world.alive(hb)) {
+        l.quality = LinkQuality::LOST;
+        l.jammed = false;
+        l.cost = INF;
+        l.next_check = INF;
+        return;
+    }
+
+    const Vec3 pa = world.ecef_of(ha), pb = world.ecef_of(hb);
+    const MCEntity& ea = world.entities()[ha];
+    const MCEntity& eb = world.entities()[hb];
+    const double alt_a = altitude(ea, pa), alt_b = altitude(eb, pb);
+    const double d = ecef_range(pa, pb);
+    l.distance = d;
+
+    // Smallest endpoint motion that could change the tier, per source of
+    // motion; times follow at SPEED_MARGIN times the measured speeds
+    const double v_link = CommNet::SPEED_MARGIN * (net.speed_[l.node_a] + net.speed_[l.node_b]);
+    double horizon = net.started_ ? CommNet::MAX_HORIZON : 0.0;
+    auto within = [&](double slack, double speed) {
+        if (speed > 0.0) horizon = std::min(horizon, std::fabs(slack) / speed);
+    };
+    auto altitude_band = [&](double threshold) {
+        within(alt_a - threshold, v_link);
+        within(alt_b - threshold, v_link);
+    };
+
+    LinkQuality q = LinkQuality::LOST;
+    bool jammed = false;
+
+    if (l.kind == LinkKind::FIBER) {
+        if (alt_a <= FIBER_MAX_ALT && alt_b <= FIBER_MAX_ALT) q = LinkQuality::EXCELLENT;
+        altitude_band(FIBER_MAX_ALT);
+    } else {
+        const double r_occ = std::min(norm(pa) - alt_a, norm(pb) - alt_b) - OCCLUSION_MARGIN;
+        const double sphere = std::max(0.0, r_occ - OCCLUSION_SLOPE * d);
+        const double clearance = closest_to_centre(pa, pb) - sphere;
+        within(clearance, v_link);
+        const bool in_range = l.max_range <= 0.0 || d <= l.max_range;
+        if (l.max_range > 0.0) within(d - l.max_range, v_link);
+
+        if (clearance > 0.0 && in_range && l.kind == LinkKind::LASER) {
+            // Penalty tiers 5 / 10 / 15 dB at 2/3, 1/3 and 0 of LASER_CLEAR_ALT
+            const double min_alt = std::min(alt_a, alt_b);
+            const double penalty = min_alt < LASER_CLEAR_ALT
+                ? (LASER_CLEAR_ALT - min_alt) / LASER_CLEAR_ALT * LASER_MAX_PENALTY : 0.0;
+            q = penalty < 5.0 ? LinkQuality::EXCELLENT
+              : penalty < 10.0 ? LinkQuality::GOOD
+              : penalty < 15.0 ? LinkQuality::DEGRADED : LinkQuality::LOST;
+            for (double band : {0.0, 1.0 / 3.0, 2.0 / 3.0}) altitude_band(band * LASER_CLEAR_ALT);
+        } else if (clearance > 0.0 && in_range) {
+            // Margin falls 20 dB per decade of range: tier edges are ranges
+            const double rx_dbw = l.eirp_dbw + l.rx_gain_dbi - fspl_db(d, l.freq_hz);
+            const double margin = rx_dbw + 30.0 - l.rx_sensitivity_dbm;
+            q = tier_of_margin(margin);
+            for (double edge : {MARGIN_DEGRADED, MARGIN_GOOD, MARGIN_EXCELLENT}) {
+                within(d - d * std::pow(10.0, (margin - edge) / 20.0), v_link);
+            }
+
+            // Jammers tuned over the link's band: power at the nearer end
+            double jam_w = 0.0;
+            const double lo = l.freq_hz - 0.5 * l.bandwidth_hz;
+            const double hi = l.freq_hz + 0.5 * l.bandwidth_hz;
+            for (size_t j = 0; j < net.jammers_.size(); j++) {
+                const CommJammer& jam = net.jammers_[j];
+                if (jam.freq_hi_hz < lo || jam.freq_lo_hz > hi) continue;
+                if (!world.alive(jam.entity)) continue;
+                const Vec3 pj = world.ecef_of(jam.entity);
+                const double da = ecef_range(pj, pa), db = ecef_range(pj, pb);
+                const bool near_a = da <= db;
+                const double dj = near_a ? da : db;
+                if (dj > jam.range) {
+                    const double v_end = net.speed_[near_a ? l.node_a : l.node_b];
+                    within(dj - jam.range, CommNet::SPEED_MARGIN *
+                           (net.speed_[net.nodes_.size() + j] + v_end));
+                    continue;
+                }
+                horizon = 0.0;   // in reach: J/S moves with every step
+                if (closest_to_centre(pj, near_a ? pa : pb) <= sphere) continue;
+                jam_w += std::pow(10.0, (jam.power_dbw - fspl_db(dj, l.freq_hz)) / 10.0);
+            }
+            if (jam_w > 0.0) {
+                const double js = 10.0 * std::log10(jam_w) - rx_dbw;
+                if (js > JS_KILL) {
+                    jammed = true;
+                    q = LinkQuality::LOST;
+                } else if (js > JS_DEGRADE) {
+                    jammed = true;
+                    if (q == LinkQuality::EXCELLENT) q = LinkQuality::GOOD;
+                    else if (q == LinkQuality::GOOD) q = LinkQuality::DEGRADED;
+                }
+            }
+        }
+    }
+
+    l.quality = q;
+    l.jammed = jammed;
+    l.cost = link_cost(l);
+    l.next_check = now + horizon;
+}
+
+void CommNetwork::update_all(double dt, MCWorld& world) {
+    CommNet& net = world.comms;
+    if (!net.enabled || net.links_.empty()) return;
+
+    // Endpoint speeds over the last tick; liveness changes force a check
+    const size_t n = net.nodes_.size();
+    for (size_t k = 0; k < net.last_pos_.size(); k++) {
+        const EntityHandle h = k < n ? net.nodes_[k] : net.jammers_[k - n].entity;
+        const Vec3 p = world.ecef_of(h);
+        if (net.started_ && dt > 0.0) net.speed_[k] = ecef_range(p, net.last_pos_[k]) / dt;
+        net.last_pos_[k] = p;
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        const uint8_t alive = world.alive(net.nodes_[node]) ? 1 : 0;
+        if (alive == net.node_alive_[node]) continue;
+        net.node_alive_[node] = alive;
+        for (uint32_t k : net.adj_[node]) net.links_[k].next_check = world.sim_time;
+    }
+
+    changes.clear();
+    for (uint32_t k = 0; k < net.links_.size(); k++) {
+        CommLink& l = net.links_[k];
+        if (net.started_ && world.sim_time < l.next_check) continue;
+        const double old_cost = l.cost;
+        evaluate(net, l, world);
+        if (l.cost != old_cost) changes.push_back({k, old_cost});
+    }
+
+    if (!net.started_) {
+        net.rebuild_routes();
+        net.started_ = true;
+    } else if (!changes.empty()) {
+        net.repair_routes(changes);
+    }
+}
+
+} // namespace sim::mc
@@ -0,0 +1,173 @@
+/**
+ * CommNetwork — Headless comm links and routing (port of CommEngine).
+ *
+ * The scenario's "networks" (mesh, star, multihop or custom topologies,
+ * as CommDesigner writes them) become undirected links between entity
+ * nodes, each with the browser engine's link budget: RF links by free-
+ * space loss against receiver sensitivity, with Earth occlusion, maximum
+ * range and jammer J/S; laser links by LOS and atmospheric path; fiber
+ * between ground nodes. A link's state is its quality tier (EXCELLENT,
+ * GOOD, DEGRADED, LOST) and jammed flag, and its routing cost is the
+ * JS weight latency / quality * (1 + loss) over the fixed latency, so it
+ * only changes when the tier does. Propagation delay is left out of the
+ * cost (it would change every tick) and added when a route is read.
+ *
+ * Link changes are scheduled rather than polled: each evaluation also
+ * returns the smallest endpoint motion that could move the link to
+ * another tier (distance to a range or margin threshold, Earth clearance,
+ * altitude band, jammer reach), and the link is next evaluated when the
+ * endpoints could have covered it at SPEED_MARGIN times their measured
+ * speeds, and at least every MAX_HORIZON s. A link with a jammer in reach
+ * is evaluated every tick.
+ *
+ * Routes are shortest-path trees rooted at every node that carries a
+ * weapon (the shooter end of a sensor-to-shooter chain), kept by dynamic
+ * SSSP: a link whose cost rose only matters to trees that route over it,
+ * which drop the subtree below it and re-seed it from its unaffected
+ * neighbours; a link whose cost fell relaxes its endpoints. One Dijkstra
+ * pass per tree then settles just the nodes whose distance changed.
+ *
+ * With MCConfig::comms, SAMBattery cues only from radars (or tracks last
+ * fed by radars) with a route to the battery. Not bitwise; scenarios
+ * without networks are unaffected.
+ */
+
+#ifndef SIM_MC_COMM_NETWORK_HPP
+#define SIM_MC_COMM_NETWORK_HPP
+
+#include "mc_entity.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace sim::mc {
+
+class MCWorld;
+
+enum class LinkKind : uint8_t { RF, LASER, FIBER };
+enum class LinkQuality : uint8_t { LOST, DEGRADED, GOOD, EXCELLENT };
+
+struct CommLink {
+    uint32_t node_a = 0, node_b = 0;  // CommNet node indices
+
+    LinkKind kind = LinkKind::RF;
+    double max_range = 0.0;           // m, 0 = unlimited
+    double freq_hz = 2.4e9;
+    double bandwidth_hz = 100e6;
+    double eirp_dbw = 30.0;           // transmit power + antenna gain
+    double rx_gain_dbi = 0.0;
+    double rx_sensitivity_dbm = -100.0;
+    double latency_ms = 5.0;          // fixed, with encryption processing
+
+    // State at the last evaluation
+    LinkQuality quality = LinkQuality::LOST;
+    bool jammed = false;
+    double distance = 0.0;            // m
+    double cost = std::numeric_limits<double>::infinity();
+    double next_check = 0.0;          // sim time of the next evaluation
+
+    uint32_t other(uint32_t n) const { return n == node_a ? node_b : node_a; }
+};
+
+/** Noise jammer on an entity (the JS engine's addJammer config). */
+struct CommJammer {
+    EntityHandle entity = NO_ENTITY;
+    double power_dbw = 40.0;
+    double range = 200000.0;          // m
+    double freq_lo_hz = 12.25e9;
+    double freq_hi_hz = 12.75e9;
+};
+
+/**
+ * Per-world comm network state: nodes, links, jammers and the route
+ * trees. Built by ScenarioParser; advanced by CommNetwork::update_all.
+ */
+class CommNet {
+public:
+    bool enabled = false;
+
+    static constexpr double SPEED_MARGIN = 2.0;
+    static constexpr double MAX_HORIZON = 10.0;    // s between evaluations
+
+    /** Changed link and its cost before the change. */
+    struct LinkChange {
+        uint32_t link;
+        double old_cost;
+    };
+
+    /** Node index of entity h, adding it if new. */
+    uint32_t add_node(EntityHandle h);
+    /** Add link l; false (and ignored) if its endpoints are already linked. */
+    bool add_link(const CommLink& l);
+    void add_jammer(const CommJammer& j) { jammers_.push_back(j); }
+    /** Keep a route tree toward entity h's node. */
+    void add_root(EntityHandle h);
+    /** Size the route trees; call once the graph is complete. */
+    void finalize();
+
+    bool has_links() const { return !links_.empty(); }
+    const std::vector<CommLink>& links() const { return links_; }
+
+    /** Node index of entity h, NO_ENTITY if it is on no network. */
+    uint32_t node_of(EntityHandle h) const {
+        return h < node_of_.size() ? node_of_[h] : NO_ENTITY;
+    }
+
+    /**
+     * Routing cost from entity `from` to root entity `to` (infinity with
+     * no route, or if either is off the network or `to` is no root).
+     */
+    double route_cost(EntityHandle from, EntityHandle to) const;
+
+    bool connected(EntityHandle from, EntityHandle to) const {
+        return route_cost(from, to) < std::numeric_limits<double>::infinity();
+    }
+
+    /**
+     * End-to-end latency in ms along the route from `from` to root `to`:
+     * each hop's fixed latency plus propagation at its last evaluation.
+     * Negative with no route.
+     */
+    double route_latency_ms(EntityHandle from, EntityHandle to) const;
+
+private:
+    friend class CommNetwork;
+
+    std::vector<EntityHandle> nodes_;          // [node] -> entity
+    std::vector<uint32_t> node_of_;            // [handle] -> node, NO_ENTITY if none
+    std::vector<std::vector<uint32_t>> adj_;   // [node] -> incident links
+    std::vector<CommLink> links_;
+    std::vector<CommJammer> jammers_;
+
+    // Route trees, one per root, flattened [tree * nodes + node]
+    std::vector<uint32_t> roots_;              // [tree] -> node
+    std::vector<uint32_t> tree_of_;            // [node] -> tree, NO_ENTITY if none
+    std::vector<double> dist_;
+    std::vector<uint32_t> via_;                // link to the parent, NO_ENTITY at the root
+
+    // Tracked motion: nodes, then jammer entities
+    std::vector<Vec3> last_pos_;
+    std::vector<double> speed_;                // m/s over the last tick
+    std::vector<uint8_t> node_alive_;
+    bool started_ = false;
+
+    void rebuild_routes();
+    void repair_routes(const std::vector<LinkChange>& changes);
+    /** Settle tree t from the labels queued in the scratch heap. */
+    void settle(size_t t);
+};
+
+/** Comm network system: link evaluation and route maintenance. */
+class CommNetwork {
+public:
+    static void update_all(double dt, MCWorld& world);
+private:
+    /**
+     * Re-evaluate link l's budget at the world's current geometry and
+     * schedule its next evaluation.
+     */
+    static void evaluate(CommNet& net, CommLink& l, MCWorld& world);
+};
+
+} // namespace sim::mc
+#endif // SIM_MC_COMM_NETWORK_HPP
@@ -1,14 +1,30 @@
 /**
  * EventSystem — Evaluates scenario event triggers and executes actions.
  *
- * Iterates over world.events each tick. For unfired events, checks the
- * trigger condition (time, proximity, detection) and executes the action
- * (message, change_rules, set_state) when triggered.
+ * Triggers are compiled once into world.event_schedule, so a tick only
+ * visits events that could fire: time triggers whose time has come,
+ * proximity pairs whose recheck time has come, and detection triggers whose
+ * sensor swept this tick. Due events are re-checked and fired in event
+ * order, as the per-tick scan did.
+ *
+ * Proximity rechecks are deferred by (distance - range) / closing bound,
+ * where the bound is twice the pair's current speed sum plus
+ * PROXIMITY_SPEED_MARGIN, and never more than PROXIMITY_MAX_DEFER. The
+ * trigger fires on the same tick as a per-tick scan as long as neither
+ * entity out-accelerates that bound within one deferral.
+ *
+ * With world.swept_contact a slant-range pair (at least one end orbital)
+ * that is out of range at a check also fires if its ECEF closest approach
+ * since the previous check (swept_contact.hpp) came within range, so a
+ * fast pass between two checks is not lost. Ground-distance pairs (both
+ * geodetic) are tested at checks only.
  */
 
 #include "event_system.hpp"
 #include "geo_utils.hpp"
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <iostream>
 
 namespace sim::mc {
@@ -16,6 +32,11 @@ namespace sim::mc {
 static constexpr double OMEGA_EARTH = 7.2921159e-5;  // rad/s
 static constexpr double DEG_TO_RAD  = M_PI / 180.0;
 
+static constexpr double PROXIMITY_SPEED_MARGIN = 500.0;  // m/s
+static constexpr double PROXIMITY_MAX_DEFER    = 5.0;    // s
+
+using Entry = EventSchedule::Entry;
+
 // ── ECI → ECEF rotation (GMST = 0 at t = 0) ──
 
 static Vec3 eci_to_ecef(const Vec3& eci, double sim_time) {
@@ -57,65 +78,230 @@ static bool is_geodetic(const MCEntity& e) {
         || e.physics_type == PhysicsType::STATIC;
 }
 
+// ── Helper: ECEF velocity for any entity ──
+
+static Vec3 entity_ecef_velocity(const MCEntity& e, double sim_time) {
+    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+        // d/dt of R(t) r: R (v - omega x r)
+        Vec3 v{e.eci_vel.x + OMEGA_EARTH * e.eci_pos.y,
+               e.eci_vel.y - OMEGA_EARTH * e.eci_pos.x,
+               e.eci_vel.z};
+        return eci_to_ecef(v, sim_time);
+    }
+    if (e.physics_type != PhysicsType::FLIGHT_3DOF) return Vec3{0, 0, 0};
+
+    // Local ENU from speed, heading and flight path angle, rotated to ECEF
+    double lat = e.geo_lat * DEG_TO_RAD, lon = e.geo_lon * DEG_TO_RAD;
+    double horiz = e.flight_speed * std::cos(e.flight_gamma);
+    double ve = horiz * std::sin(e.flight_heading);
+    double vn = horiz * std::cos(e.flight_heading);
+    double vu = e.flight_speed * std::sin(e.flight_gamma);
+    double slat = std::sin(lat), clat = std::cos(lat);
+    double slon = std::sin(lon), clon = std::cos(lon);
+    return Vec3{
+        -slon * ve - slat * clon * vn + clat * clon * vu,
+         clon * ve - slat * slon * vn + clat * slon * vu,
+                           clat * vn + slat * vu
+    };
+}
+
+// ── Helper: upper bound on the entity's Earth-fixed speed ──
+
+static double ecef_speed_bound(const MCEntity& e) {
+    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+        return e.eci_vel.norm() + OMEGA_EARTH * e.eci_pos.norm();
+    }
+    if (e.physics_type == PhysicsType::FLIGHT_3DOF) return std::abs(e.flight_speed);
+    return 0.0;
+}
+
+static void heap_push(std::vector<Entry>& heap, Entry entry) {
+    heap.push_back(entry);
+    std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+// Pop every entry due at `now` onto `due`
+static void heap_drain(std::vector<Entry>& heap, double now, std::vector<uint32_t>& due) {
+    while (!heap.empty() && heap.front().first <= now) {
+        due.push_back(heap.front().second);
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        heap.pop_back();
+    }
+}
+
+static TriggerKind trigger_kind(const std::string& type) {
+    if (type == "time") return TriggerKind::TIME;
+    if (type == "proximity") return TriggerKind::PROXIMITY;
+    if (type == "detection") return TriggerKind::DETECTION;
+    return TriggerKind::NONE;
+}
+
+static ActionKind action_kind(const EventAction& action) {
+    if (action.type == "message") return ActionKind::MESSAGE;
+    if (action.type == "change_rules") return ActionKind::SET_RULES;
+    if (action.type == "set_state") {
+        if (action.field == "engagementRules" || action.field == "engagement_rules") {
+            return ActionKind::SET_RULES;
+        }
+        if (action.field == "active") return ActionKind::SET_ACTIVE;
+        if (action.field == "destroyed") return ActionKind::SET_DESTROYED;
+    }
+    return ActionKind::NONE;
+}
+
 // ══════════════════════════════════════════════════════════════════
 //  Public API
 // ══════════════════════════════════════════════════════════════════
 
+void EventSystem::compile(MCWorld& world) {
+    EventSchedule& sched = world.event_schedule;
+    sched = EventSchedule{};
+
+    for (uint32_t k = 0; k < world.events.size(); k++) {
+        ScenarioEvent& event = world.events[k];
+        event.trigger.kind = trigger_kind(event.trigger.type);
+        event.action.kind = action_kind(event.action);
+        if (event.fired) continue;
+
+        const EventTrigger& trig = event.trigger;
+        switch (trig.kind) {
+            case TriggerKind::TIME:
+                sched.time_heap.push_back({trig.time, k});
+                break;
+            case TriggerKind::PROXIMITY:
+                if (trig.entity_a_h == NO_ENTITY || trig.entity_b_h == NO_ENTITY) break;
+                sched.proximity_heap.push_back({0.0, k});
+                break;
+            case TriggerKind::DETECTION:
+                if (trig.sensor_h == NO_ENTITY) break;
+                sched.detection_watch.push_back({trig.sensor_h, k});
+                break;
+            case TriggerKind::NONE:
+                break;  // never fires
+        }
+    }
+
+    std::make_heap(sched.time_heap.begin(), sched.time_heap.end(), std::greater<Entry>());
+    std::make_heap(sched.proximity_heap.begin(), sched.proximity_heap.end(),
+                   std::greater<Entry>());
+    std::sort(sched.detection_watch.begin(), sched.detection_watch.end());
+}
+
 void EventSystem::update_all(double /*dt*/, MCWorld& world) {
-    for (auto& event : world.events) {
+    EventSchedule& sched = world.event_schedule;
+    auto& due = sched.due;   // detection triggers queued by this tick's sweeps
+    heap_drain(sched.time_heap, world.sim_time, due);
+    heap_drain(sched.proximity_heap, world.sim_time, due);
+    if (due.empty()) return;
+
+    std::sort(due.begin(), due.end());
+    due.erase(std::unique(due.begin(), due.end()), due.end());
+
+    // Earlier actions may change what later triggers see, so re-check in order
+    for (uint32_t k : due) {
+        ScenarioEvent& event = world.events[k];
         if (event.fired) continue;
 
-        if (check_trigger(event.trigger, world)) {
-            execute_action(event.action, world);
-            event.fired = true;
+        if (event.trigger.kind == TriggerKind::PROXIMITY) {
+            double distance = proximity_distance(event.trigger, world);
+            if (world.swept_contact && distance > event.trigger.range &&
+                swept_in_range(event, world)) {
+                distance = event.trigger.range;
+            }
+            if (distance < 0.0 || distance > event.trigger.range) {
+                if (distance < 0.0) event.last_rel.time = -1.0;
+                heap_push(sched.proximity_heap,
+                          {proximity_recheck(event.trigger, distance, world), k});
+                continue;
+            }
+        } else if (!check_trigger(event.trigger, world)) {
+            continue;
         }
+
+        execute_action(event.action, world);
+        event.fired = true;
     }
+    due.clear();
 }
 
 // ══════════════════════════════════════════════════════════════════
 //  Trigger evaluation
 // ══════════════════════════════════════════════════════════════════
 
+double EventSystem::proximity_distance(const EventTrigger& trigger, MCWorld& world) {
+    world.refresh_orbit(trigger.entity_a_h);
+    world.refresh_orbit(trigger.entity_b_h);
+    MCEntity* a = world.get(trigger.entity_a_h);
+    MCEntity* b = world.get(trigger.entity_b_h);
+    if (!a || !b) return -1.0;
+    if (!a->active || a->destroyed) return -1.0;
+    if (!b->active || b->destroyed) return -1.0;
+
+    if (is_geodetic(*a) && is_geodetic(*b)) {
+        // Both geodetic — use haversine (ground distance)
+        return haversine_distance(
+            a->geo_lat * DEG_TO_RAD, a->geo_lon * DEG_TO_RAD,
+            b->geo_lat * DEG_TO_RAD, b->geo_lon * DEG_TO_RAD);
+    }
+    // At least one is orbital — compare ECEF positions (slant range)
+    Vec3 pa = entity_ecef_position(*a, world.sim_time);
+    Vec3 pb = entity_ecef_position(*b, world.sim_time);
+    return euclidean_distance(pa, pb);
+}
+
+bool EventSystem::swept_in_range(ScenarioEvent& event, const MCWorld& world) {
+    const MCEntity* a = world.get(event.trigger.entity_a_h);
+    const MCEntity* b = world.get(event.trigger.entity_b_h);
+    if (is_geodetic(*a) && is_geodetic(*b)) return false;
+
+    RelativeState now{world.sim_time,
+                      entity_ecef_position(*b, world.sim_time) -
+                          entity_ecef_position(*a, world.sim_time),
+                      entity_ecef_velocity(*b, world.sim_time) -
+                          entity_ecef_velocity(*a, world.sim_time)};
+    RelativeState last = event.last_rel;
+    event.last_rel = now;
+    if (last.time < 0.0 || last.time >= now.time) return false;
+
+    ClosestApproach ca;
+    return closest_approach(last, now, ca, event.trigger.range)
+        && ca.distance <= event.trigger.range;
+}
+
+double EventSystem::proximity_recheck(const EventTrigger& trigger, double distance,
+                                      const MCWorld& world) {
+    // A pair with an end down may be revived by any action: check every tick
+    if (distance < 0.0) return world.sim_time;
+
+    const MCEntity* a = world.get(trigger.entity_a_h);
+    const MCEntity* b = world.get(trigger.entity_b_h);
+    double closing = 2.0 * (ecef_speed_bound(*a) + ecef_speed_bound(*b))
+                   + PROXIMITY_SPEED_MARGIN;
+    double defer = std::min((distance - trigger.range) / closing, PROXIMITY_MAX_DEFER);
+    return world.sim_time + defer;
+}
+
 bool EventSystem::check_trigger(const EventTrigger& trigger, MCWorld& world) {
 
     // ── Time trigger ──
-    if (trigger.type == "time") {
+    if (trigger.kind == TriggerKind::TIME) {
         return world.sim_time >= trigger.time;
     }
 
     // ── Proximity trigger ──
-    if (trigger.type == "proximity") {
-        MCEntity* a = world.get_entity(trigger.entity_a);
-        MCEntity* b = world.get_entity(trigger.entity_b);
-        if (!a || !b) return false;
-        if (!a->active || a->destroyed) return false;
-        if (!b->active || b->destroyed) return false;
-
-        double distance = 0.0;
-
-        if (is_geodetic(*a) && is_geodetic(*b)) {
-            // Both geodetic — use haversine (ground distance)
-            distance = haversine_distance(
-                a->geo_lat * DEG_TO_RAD, a->geo_lon * DEG_TO_RAD,
-                b->geo_lat * DEG_TO_RAD, b->geo_lon * DEG_TO_RAD);
-        } else {
-            // At least one is orbital — compare ECEF positions (slant range)
-            Vec3 pa = entity_ecef_position(*a, world.sim_time);
-            Vec3 pb = entity_ecef_position(*b, world.sim_time);
-            distance = euclidean_distance(pa, pb);
-        }
-
-        return distance <= trigger.range;
+    if (trigger.kind == TriggerKind::PROXIMITY) {
+        double distance = proximity_distance(trigger, world);
+        return distance >= 0.0 && distance <= trigger.range;
     }
 
     // ── Detection trigger ──
-    if (trigger.type == "detection") {
-        MCEntity* sensor = world.get_entity(trigger.sensor_entity);
+    if (trigger.kind == TriggerKind::DETECTION) {
+        MCEntity* sensor = world.get(trigger.sensor_h);
         if (!sensor) return false;
         if (!sensor->has_radar) return false;
 
         for (const auto& det : sensor->radar_detections) {
-            if (det.entity_id == trigger.target_entity) {
+            if (det.entity == trigger.target_h) {
                 return true;
             }
         }
@@ -132,33 +318,28 @@ bool EventSystem::check_trigger(const EventTrigger& trigger, MCWorld& world) {
 void EventSystem::execute_action(const EventAction& action, MCWorld& world) {
 
     // ── Message ──
-    if (action.type == "message") {
+    if (action.kind == ActionKind::MESSAGE) {
         // Log to stderr (replay writer can pick up fired events separately)
         std::cerr << "[EVENT] " << action.message << std::endl;
         return;
     }
 
-    // ── Change engagement rules ──
-    if (action.type == "change_rules") {
-        MCEntity* entity = world.get_entity(action.entity_id);
-        if (!entity) return;
-        entity->engagement_rules = action.value;
-        return;
-    }
-
-    // ── Set arbitrary state field ──
-    if (action.type == "set_state") {
-        MCEntity* entity = world.get_entity(action.entity_id);
-        if (!entity) return;
+    MCEntity* entity = world.get(action.entity);
+    if (!entity) return;
 
-        if (action.field == "engagementRules" || action.field == "engagement_rules") {
+    switch (action.kind) {
+        // change_rules, or set_state on engagementRules
+        case ActionKind::SET_RULES:
             entity->engagement_rules = action.value;
-        } else if (action.field == "active") {
-            entity->active = (action.value == "true");
-        } else if (action.field == "destroyed") {
-            entity->destroyed = (action.value == "true");
-        }
-        return;
+            break;
+        case ActionKind::SET_ACTIVE:
+            world.set_active(*entity, action.value == "true");
+            break;
+        case ActionKind::SET_DESTROYED:
+            world.set_destroyed(*entity, action.value == "true");
+            break;
+        default:
+            break;
     }
 }
 
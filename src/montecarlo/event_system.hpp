@@ -7,8 +7,25 @@ namespace sim::mc {
 
 class EventSystem {
 public:
+    /**
+     * Resolve trigger/action kinds and build world.event_schedule.
+     * Called once by ScenarioParser after handles are resolved.
+     */
+    static void compile(MCWorld& world);
+
     static void update_all(double dt, MCWorld& world);
 private:
+    /** Proximity pair separation in meters, or -1 if either end is down. */
+    static double proximity_distance(const EventTrigger& trigger, MCWorld& world);
+    /**
+     * Swept contact for an out-of-range proximity pair with both ends up:
+     * whether its path since the last check came within range. Records
+     * the pair's state for the next check.
+     */
+    static bool swept_in_range(ScenarioEvent& event, const MCWorld& world);
+    /** Earliest time a proximity pair at `distance` could reach range. */
+    static double proximity_recheck(const EventTrigger& trigger, double distance,
+                                    const MCWorld& world);
     static bool check_trigger(const EventTrigger& trigger, MCWorld& world);
     static void execute_action(const EventAction& action, MCWorld& world);
 };
@@ -14,24 +14,53 @@
 #include "montecarlo/geo_utils.hpp"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
 namespace sim::mc {
 
-void Flight3DOF::update_all(double dt, MCWorld& world) {
-    for (auto& e : world.entities()) {
-        if (e.physics_type != PhysicsType::FLIGHT_3DOF) continue;
-        if (!e.active || e.destroyed) continue;
-        update_entity(e, dt);
+namespace {
+
+/** SoA scratch for update_batch, reused across ticks on each thread. */
+struct FlightLanes {
+    std::vector<uint32_t> index;
+    // Gathered state and per-lane constants
+    std::vector<double> V, gamma, mass, wing_area, CL, cd0, induced_k;
+    std::vector<double> sin_alpha, cos_alpha, sin_roll, cos_roll;
+    std::vector<double> sin_gamma, cos_gamma;
+    std::vector<double> density, speed_of_sound, thrust;
+    // Kernel outputs
+    std::vector<double> dHeading, mach;
+    // Gridded wind (MCWorld::wind)
+    std::vector<double> lat, lon, alt, wind_east, wind_north;
+    std::vector<WindGrid::Cursor> cursor;
+
+    void resize(size_t n) {
+        index.resize(n);
+        for (auto* v : {&V, &gamma, &mass, &wing_area, &CL, &cd0, &induced_k,
+                        &sin_alpha, &cos_alpha, &sin_roll, &cos_roll,
+                        &sin_gamma, &cos_gamma, &density, &speed_of_sound,
+                        &thrust, &dHeading, &mach, &lat, &lon, &alt,
+                        &wind_east, &wind_north}) {
+            v->resize(n);
+        }
+        cursor.resize(n);
     }
-}
+};
 
-void Flight3DOF::update_entity(MCEntity& e, double dt) {
-    // ── Atmosphere at current altitude ──
-    auto atmo = get_atmosphere(e.geo_alt);
+thread_local FlightLanes lanes;
 
-    double V       = e.flight_speed;
-    double gamma   = e.flight_gamma;
-    double heading = e.flight_heading;
+constexpr double G = 9.80665;
+constexpr double GAMMA_LIMIT = 80.0 * M_PI / 180.0;
+
+/** State derivatives of update_entity()'s point-mass model */
+struct FlightRates {
+    double dV = 0.0;          // m/s²
+    double dGamma = 0.0;      // rad/s
+    double dHeading = 0.0;    // rad/s
+    double drag_rate = 0.0;   // 1/s, 2D / (mV): how fast drag relaxes the speed
+};
+
+FlightRates rates(const MCEntity& e, const AtmosphereResult& atmo, double V, double gamma) {
     double alpha   = e.flight_alpha;
     double roll    = e.flight_roll;
     double mass    = e.ac_mass;
@@ -67,33 +96,228 @@ void Flight3DOF::update_entity(MCEntity& e, double dt) {
         T = e.flight_throttle * thrust_base * std::pow(density_ratio, 0.7);
     }
 
-    // ── Gravity ──
-    constexpr double g = 9.80665;
-
     // ── Equations of motion ──
-    double dV = (T * std::cos(alpha) - D) / mass - g * std::sin(gamma);
+    FlightRates r;
+    r.dV = (T * std::cos(alpha) - D) / mass - G * std::sin(gamma);
 
-    double dGamma = 0.0;
     if (V > 1.0) {
-        dGamma = (L * std::cos(roll) + T * std::sin(alpha) - mass * g * std::cos(gamma))
-                 / (mass * V);
+        r.dGamma = (L * std::cos(roll) + T * std::sin(alpha) - mass * G * std::cos(gamma))
+                   / (mass * V);
+        r.drag_rate = 2.0 * D / (mass * V);
     }
 
-    double dHeading = 0.0;
     if (V > 1.0 && std::abs(std::cos(gamma)) > 0.01) {
-        dHeading = L * std::sin(roll) / (mass * V * std::cos(gamma));
+        r.dHeading = L * std::sin(roll) / (mass * V * std::cos(gamma));
+    }
+    return r;
+}
+
+/** Carry an aircraft a wind displacement [m] along the ground. */
+void drift(MCEntity& e, double east, double north) {
+    auto [lat, lon] = destination_point(e.geo_lat * M_PI / 180.0, e.geo_lon * M_PI / 180.0,
+                                        std::atan2(east, north),
+                                        std::sqrt(east * east + north * north));
+    e.geo_lat = lat * 180.0 / M_PI;
+    e.geo_lon = lon * 180.0 / M_PI;
+}
+
+} // namespace
+
+void Flight3DOF::update_all(double dt, MCWorld& world) {
+    update_range(dt, world, 0, world.with_physics(PhysicsType::FLIGHT_3DOF).size());
+}
+
+void Flight3DOF::update_range(double dt, MCWorld& world, size_t begin, size_t end) {
+    auto& entities = world.entities();
+    const IndexList& flyers = world.with_physics(PhysicsType::FLIGHT_3DOF);
+    const uint8_t* coarse = world.lod.enabled ? world.lod.coarse.data() : nullptr;
+    for (size_t k = begin; k < end; k++) {
+        uint32_t i = flyers[k];
+        if (!world.alive(i) || (coarse && coarse[k])) continue;
+        if (world.replays(i)) {
+            world.replay(i);
+            continue;
+        }
+        step(world, entities[i], dt);
+        if (world.wind) apply_wind(world, i, dt);
+    }
+}
+
+void Flight3DOF::apply_wind(MCWorld& world, uint32_t index, double dt) {
+    if (!world.wind) return;
+    if (world.wind_cursors.size() < world.entities().size()) {
+        world.wind_cursors.resize(world.entities().size());
+    }
+    MCEntity& e = world.entities()[index];
+    double east, north;
+    world.wind->sample(e.geo_lat, e.geo_lon, e.geo_alt, world.sim_time + world.wind_time_offset,
+                       world.wind_cursors[index], east, north);
+    drift(e, east * dt, north * dt);
+}
+
+void Flight3DOF::update_batch(double dt, MCWorld& world) {
+    auto& entities = world.entities();
+    const IndexList& flyers = world.with_physics(PhysicsType::FLIGHT_3DOF);
+    const US76Table& table = US76Table::instance();
+    FlightLanes& ln = lanes;
+    if (ln.index.size() < flyers.size()) ln.resize(flyers.size());
+
+    // ── Gather: live aircraft into lanes, atmosphere and attitude trig ──
+    const uint8_t* coarse = world.lod.enabled ? world.lod.coarse.data() : nullptr;
+    size_t n = 0;
+    for (size_t lane = 0; lane < flyers.size(); lane++) {
+        uint32_t i = flyers[lane];
+        if (!world.alive(i) || (coarse && coarse[lane])) continue;
+        if (world.replays(i)) {
+            world.replay(i);
+            continue;
+        }
+        const MCEntity& e = entities[i];
+        US76Table::Sample atmo = US76Table::covers(e.geo_alt)
+                                 ? table.lookup(e.geo_alt)
+                                 : US76Table::evaluate(e.geo_alt);
+        ln.index[n]     = i;
+        ln.V[n]         = e.flight_speed;
+        ln.gamma[n]     = e.flight_gamma;
+        ln.mass[n]      = e.ac_mass;
+        ln.wing_area[n] = e.ac_wing_area;
+        ln.CL[n]        = std::clamp(e.ac_cl_alpha * e.flight_alpha, -e.ac_cl_max, e.ac_cl_max);
+        ln.cd0[n]       = e.ac_cd0;
+        ln.induced_k[n] = 1.0 / (M_PI * e.ac_oswald * e.ac_ar);
+        ln.sin_alpha[n] = std::sin(e.flight_alpha);
+        ln.cos_alpha[n] = std::cos(e.flight_alpha);
+        ln.sin_roll[n]  = std::sin(e.flight_roll);
+        ln.cos_roll[n]  = std::cos(e.flight_roll);
+        ln.sin_gamma[n] = std::sin(e.flight_gamma);
+        ln.cos_gamma[n] = std::cos(e.flight_gamma);
+        ln.density[n]   = atmo.density;
+        ln.speed_of_sound[n] = atmo.speed_of_sound;
+
+        double T = 0.0;
+        if (e.flight_engine_on) {
+            double thrust_base = (e.flight_throttle > 0.95) ? e.ac_thrust_ab
+                                                            : e.ac_thrust_mil;
+            T = e.flight_throttle * thrust_base * atmo.thrust_lapse;
+        }
+        ln.thrust[n] = T;
+        if (world.wind) {
+            ln.lat[n] = e.geo_lat;
+            ln.lon[n] = e.geo_lon;
+            ln.alt[n] = e.geo_alt;
+        }
+        n++;
+    }
+
+    // ── Wind: one batched grid query, cursors gathered and scattered ──
+    const bool windy = static_cast<bool>(world.wind);
+    if (windy) {
+        if (world.wind_cursors.size() < entities.size()) world.wind_cursors.resize(entities.size());
+        for (size_t j = 0; j < n; j++) ln.cursor[j] = world.wind_cursors[ln.index[j]];
+        world.wind->sample(n, ln.lat.data(), ln.lon.data(), ln.alt.data(),
+                           world.sim_time + world.wind_time_offset, ln.cursor.data(),
+                           ln.wind_east.data(), ln.wind_north.data());
+        for (size_t j = 0; j < n; j++) world.wind_cursors[ln.index[j]] = ln.cursor[j];
+    }
+
+    // ── Kernel: forces and speed / flight-path integration, branch-free ──
+    constexpr double g = 9.80665;
+    constexpr double gamma_limit = 80.0 * M_PI / 180.0;
+    double* V = ln.V.data();
+    double* gam = ln.gamma.data();
+    double* dHeading = ln.dHeading.data();
+    double* mach_out = ln.mach.data();
+    const double* mass = ln.mass.data();
+    const double* S = ln.wing_area.data();
+    const double* CLs = ln.CL.data();
+    const double* cd0 = ln.cd0.data();
+    const double* k = ln.induced_k.data();
+    const double* sa = ln.sin_alpha.data();
+    const double* ca = ln.cos_alpha.data();
+    const double* sr = ln.sin_roll.data();
+    const double* cr = ln.cos_roll.data();
+    const double* sg = ln.sin_gamma.data();
+    const double* cg = ln.cos_gamma.data();
+    const double* rho = ln.density.data();
+    const double* a = ln.speed_of_sound.data();
+    const double* T = ln.thrust.data();
+
+    // Lanes are distinct vectors: no loop-carried aliasing
+#pragma GCC ivdep
+    for (size_t j = 0; j < n; j++) {
+        double v = V[j];
+        double q = 0.5 * rho[j] * v * v;
+        double CL = CLs[j];
+        double mach = (a[j] > 1.0) ? v / a[j] : 0.0;
+        double dm = mach > 0.85 ? mach - 0.85 : 0.0;
+        double CD = cd0[j] + CL * CL * k[j] + 0.1 * dm * dm;
+        double lift = q * S[j] * CL;
+        double drag = q * S[j] * CD;
+        double m = mass[j];
+
+        double dV = (T[j] * ca[j] - drag) / m - g * sg[j];
+        double dGamma = (v > 1.0)
+            ? (lift * cr[j] + T[j] * sa[j] - m * g * cg[j]) / (m * v) : 0.0;
+        double turn = (v > 1.0 && std::abs(cg[j]) > 0.01)
+            ? lift * sr[j] / (m * v * cg[j]) : 0.0;
+
+        double v_new = v + dV * dt;
+        v_new = v_new < 50.0 ? 50.0 : v_new;
+        double g_new = gam[j] + dGamma * dt;
+        g_new = g_new < -gamma_limit ? -gamma_limit : g_new;
+        g_new = g_new > gamma_limit ? gamma_limit : g_new;
+
+        V[j] = v_new;
+        gam[j] = g_new;
+        dHeading[j] = turn;
+        mach_out[j] = (a[j] > 1.0) ? v_new / a[j] : 0.0;
     }
 
+    // ── Scatter: heading, great-circle position, state back to entities ──
+    for (size_t j = 0; j < n; j++) {
+        MCEntity& e = entities[ln.index[j]];
+        double v = V[j];
+        double gamma = gam[j];
+
+        double heading = std::fmod(e.flight_heading + dHeading[j] * dt, 2.0 * M_PI);
+        if (heading < 0.0) heading += 2.0 * M_PI;
+
+        double dAlt = v * std::sin(gamma) * dt;
+        double dist = v * std::cos(gamma) * dt;
+
+        auto [new_lat_rad, new_lon_rad] = destination_point(
+            e.geo_lat * M_PI / 180.0, e.geo_lon * M_PI / 180.0, heading, dist);
+        e.geo_lat = new_lat_rad * 180.0 / M_PI;
+        e.geo_lon = new_lon_rad * 180.0 / M_PI;
+        if (windy) drift(e, ln.wind_east[j] * dt, ln.wind_north[j] * dt);
+
+        e.geo_alt += dAlt;
+        if (e.geo_alt < 0.0) e.geo_alt = 0.0;
+
+        e.flight_mach    = mach_out[j];
+        e.flight_speed   = v;
+        e.flight_heading = heading;
+        e.flight_gamma   = gamma;
+    }
+}
+
+void Flight3DOF::update_entity(MCEntity& e, double dt) {
+    // ── Atmosphere at current altitude ──
+    auto atmo = get_atmosphere(e.geo_alt);
+
+    double V       = e.flight_speed;
+    double gamma   = e.flight_gamma;
+    double heading = e.flight_heading;
+
+    const FlightRates r = rates(e, atmo, V, gamma);
+
     // ── Integrate ──
-    V       += dV * dt;
-    gamma   += dGamma * dt;
-    heading += dHeading * dt;
+    V       += r.dV * dt;
+    gamma   += r.dGamma * dt;
+    heading += r.dHeading * dt;
 
     // ── Clamp ──
     if (V < 50.0) V = 50.0;
-
-    constexpr double gamma_limit = 80.0 * M_PI / 180.0;
-    gamma = std::clamp(gamma, -gamma_limit, gamma_limit);
+    gamma = std::clamp(gamma, -GAMMA_LIMIT, GAMMA_LIMIT);
 
     // Wrap heading to [0, 2π)
     heading = std::fmod(heading, 2.0 * M_PI);
@@ -125,4 +349,55 @@ void Flight3DOF::update_entity(MCEntity& e, double dt) {
     e.flight_gamma   = gamma;
 }
 
+int Flight3DOF::update_entity_rk2(MCEntity& e, double dt) {
+    // Sub-steps from the rates at the start of the step: enough that no
+    // sub-step turns the velocity by more than MAX_TURN_STEP or lets drag
+    // take more than MAX_DRAG_STEP of the speed
+    FlightRates k1 = rates(e, get_atmosphere(e.geo_alt), e.flight_speed, e.flight_gamma);
+    double turn = std::max(std::abs(k1.dHeading), std::abs(k1.dGamma)) * dt / MAX_TURN_STEP;
+    double stiff = k1.drag_rate * dt / MAX_DRAG_STEP;
+    int n = static_cast<int>(std::ceil(std::max(turn, stiff) - 1e-9));
+    n = std::clamp(n, 1, MAX_SUBSTEPS);
+    const double h = dt / n;
+
+    for (int s = 0; s < n; s++) {
+        if (s > 0) k1 = rates(e, get_atmosphere(e.geo_alt), e.flight_speed, e.flight_gamma);
+        const double V0 = e.flight_speed;
+        const double gamma0 = e.flight_gamma;
+        const double heading0 = e.flight_heading;
+
+        // Heun: Euler predictor, then the mean of both ends' rates
+        double V1 = std::max(V0 + k1.dV * h, 50.0);
+        double gamma1 = std::clamp(gamma0 + k1.dGamma * h, -GAMMA_LIMIT, GAMMA_LIMIT);
+        double alt1 = std::max(e.geo_alt + V0 * std::sin(gamma0) * h, 0.0);
+        const AtmosphereResult atmo1 = get_atmosphere(alt1);
+        const FlightRates k2 = rates(e, atmo1, V1, gamma1);
+
+        double V = std::max(V0 + 0.5 * (k1.dV + k2.dV) * h, 50.0);
+        double gamma = std::clamp(gamma0 + 0.5 * (k1.dGamma + k2.dGamma) * h,
+                                  -GAMMA_LIMIT, GAMMA_LIMIT);
+        double dHeading = 0.5 * (k1.dHeading + k2.dHeading) * h;
+        double heading = std::fmod(heading0 + dHeading, 2.0 * M_PI);
+        if (heading < 0.0) heading += 2.0 * M_PI;
+
+        // Position on the trapezoid of the predictor's velocities, along
+        // the mean heading
+        double dAlt = 0.5 * (V0 * std::sin(gamma0) + V1 * std::sin(gamma1)) * h;
+        double dist = 0.5 * (V0 * std::cos(gamma0) + V1 * std::cos(gamma1)) * h;
+        auto [lat_rad, lon_rad] = destination_point(e.geo_lat * M_PI / 180.0,
+                                                    e.geo_lon * M_PI / 180.0,
+                                                    heading0 + 0.5 * dHeading, dist);
+        e.geo_lat = lat_rad * 180.0 / M_PI;
+        e.geo_lon = lon_rad * 180.0 / M_PI;
+        e.geo_alt += dAlt;
+        if (e.geo_alt < 0.0) e.geo_alt = 0.0;
+
+        e.flight_mach    = (atmo1.speed_of_sound > 1.0) ? V / atmo1.speed_of_sound : 0.0;
+        e.flight_speed   = V;
+        e.flight_heading = heading;
+        e.flight_gamma   = gamma;
+    }
+    return n;
+}
+
 } // namespace sim::mc
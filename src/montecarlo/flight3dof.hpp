@@ -6,6 +6,29 @@
  * update via great-circle navigation.
  *
  * Processes all entities with physics_type == FLIGHT_3DOF.
+ *
+ * update_batch() (MCConfig::batch_flight) is the same model as a batch
+ * kernel: live aircraft are gathered into per-thread SoA lanes, the
+ * atmosphere comes from US76Table, and the force and integration
+ * step runs as one vectorizable loop before the position update is
+ * scattered back. Agrees with update_all() to the table's tolerance,
+ * not bitwise.
+ *
+ * Both skip lanes FlightLOD has marked coarse (MCConfig::lod_dt), and
+ * load aircraft replaying the shared ephemeris (MCWorld::replays) from it.
+ *
+ * With MCWorld::wind set, speed is airspeed: after the air-relative step
+ * the aircraft drifts with the gridded wind (apply_wind), and
+ * update_batch samples the grid for all lanes in one batched query.
+ *
+ * update_entity() is explicit Euler at the world dt, which a hard turn or
+ * a high-q dash at a coarse dt integrates poorly. With MCWorld::flight_rk2
+ * (MCConfig::flight_rk2) aircraft take update_entity_rk2() steps instead:
+ * Heun (RK2) for speed, flight path and heading, the position on the
+ * trapezoid of the step's velocities, and the step split per aircraft
+ * into equal sub-steps when its turn rate or drag relaxation rate would
+ * exceed MAX_TURN_STEP or MAX_DRAG_STEP per step. A cruising aircraft
+ * still takes one step per tick.
  */
 
 #ifndef SIM_MC_FLIGHT3DOF_HPP
@@ -17,9 +40,37 @@ namespace sim::mc {
 
 class Flight3DOF {
 public:
+    static constexpr double MAX_TURN_STEP = 0.05;   // rad of heading or flight path per sub-step
+    static constexpr double MAX_DRAG_STEP = 0.5;    // drag_rate * h, well inside Euler's 2
+    static constexpr int MAX_SUBSTEPS = 8;
+
     static void update_all(double dt, MCWorld& world);
-private:
+    static void update_batch(double dt, MCWorld& world);
+
+    /**
+     * update_all() for entries [begin, end) of with_physics(FLIGHT_3DOF).
+     * Each writes only its own aircraft (and wind cursor, which must
+     * already be sized), so disjoint ranges may run concurrently.
+     */
+    static void update_range(double dt, MCWorld& world, size_t begin, size_t end);
+
+    /** One aircraft, one step of `dt` (FlightLOD takes coarse steps here). */
     static void update_entity(MCEntity& e, double dt);
+
+    /** update_entity() by sub-stepped Heun; returns the sub-steps taken. */
+    static int update_entity_rk2(MCEntity& e, double dt);
+
+    /** The step MCWorld::flight_rk2 selects. */
+    static void step(const MCWorld& world, MCEntity& e, double dt) {
+        if (world.flight_rk2) {
+            update_entity_rk2(e, dt);
+        } else {
+            update_entity(e, dt);
+        }
+    }
+
+    /** Carry entity `index` with MCWorld::wind for `dt` (no-op in still air). */
+    static void apply_wind(MCWorld& world, uint32_t index, double dt);
 };
 
 } // namespace sim::mc
@@ -0,0 +1,174 @@
+#include "montecarlo/flight_lod.hpp"
+#include "montecarlo/a2a_missile.hpp"
+#include "montecarlo/flight3dof.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sim::mc {
+
+namespace {
+
+// Longest single integration step inside a coarse step; the AI's pitch
+// and roll commands are tuned for 0.1 s ticks and go unstable far beyond
+constexpr double MAX_SUBSTEP = 1.0;  // s
+
+/** An entity whose sensors or weapons can reach other entities. */
+struct Party {
+    EntityHandle handle;
+    double reach;            // m
+};
+
+// Scratch reused across classifications on each thread
+thread_local std::vector<Party> parties;
+thread_local std::vector<uint8_t> wanted;
+thread_local IndexList candidates;
+thread_local SpatialGrid grid;
+
+double reach_of(const MCEntity& e) {
+    double r = e.has_radar ? e.radar_max_range : 0.0;
+    switch (e.weapon_type) {
+        case WeaponType::SAM_BATTERY:  r = std::max(r, e.sam_max_range); break;
+        case WeaponType::A2A_MISSILE:  r = std::max(r, A2AMissile::reach(e)); break;
+        case WeaponType::KINETIC_KILL: r = std::max(r, e.weapon_kill_range); break;
+        default: break;
+    }
+    if (e.ai_type == AIType::ORBITAL_COMBAT) r = std::max(r, e.sensor_range);
+    if (e.ai_type == AIType::INTERCEPT) r = std::max(r, e.intercept_engage_range);
+    return r;
+}
+
+double speed_of(const MCEntity& e) {
+    if (e.physics_type == PhysicsType::FLIGHT_3DOF) return e.flight_speed;
+    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+        return std::sqrt(e.eci_vel.x * e.eci_vel.x + e.eci_vel.y * e.eci_vel.y +
+                         e.eci_vel.z * e.eci_vel.z);
+    }
+    return 0.0;
+}
+
+double wrap_pi(double a) {
+    a = std::fmod(a + M_PI, 2.0 * M_PI);
+    if (a < 0.0) a += 2.0 * M_PI;
+    return a - M_PI;
+}
+
+} // namespace
+
+void FlightLOD::update_all(double dt, MCWorld& world) {
+    FlightLODState& lod = world.lod;
+    if (!lod.enabled) return;
+    const IndexList& flyers = world.with_physics(PhysicsType::FLIGHT_3DOF);
+    if (flyers.empty()) return;
+
+    if (world.sim_time >= lod.next_classify) {
+        classify(world, dt);
+        lod.next_classify = world.sim_time + lod.interval - 0.5 * dt;
+    }
+
+    // Coarse lanes fall behind by one tick and step once a full interval is owed
+    const double due = lod.interval - 0.5 * dt;
+    for (size_t k = 0; k < flyers.size(); k++) {
+        if (!world.alive(flyers[k])) continue;
+        if (!lod.coarse[k]) {
+            lod.full_ticks++;
+            continue;
+        }
+        lod.coarse_ticks++;
+        lod.lag[k] += dt;
+        if (lod.lag[k] >= due) step(world, k, dt);
+    }
+}
+
+void FlightLOD::classify(MCWorld& world, double dt) {
+    FlightLODState& lod = world.lod;
+    const auto& entities = world.entities();
+    const auto& teams = world.columns().team;
+    const IndexList& flyers = world.with_physics(PhysicsType::FLIGHT_3DOF);
+    lod.coarse.resize(flyers.size(), 0);
+    lod.lag.resize(flyers.size(), 0.0);
+
+    // Parties and the fastest mover, which bounds closure until the next check
+    parties.clear();
+    double vmax = 0.0;
+    double max_reach = 0.0;
+    for (uint32_t i = 0; i < entities.size(); i++) {
+        if (!world.alive(i)) continue;
+        const MCEntity& e = entities[i];
+        vmax = std::max(vmax, speed_of(e));
+        double r = reach_of(e);
+        if (r > 0.0) {
+            parties.push_back({i, r});
+            max_reach = std::max(max_reach, r);
+        }
+    }
+    const double margin = 3.0 * vmax * lod.interval;
+
+    wanted.assign(entities.size(), 0);
+    grid.build(world.ecef_all(), std::max(max_reach + margin, 1.0));
+    for (const Party& p : parties) {
+        const Vec3& c = world.ecef_of(p.handle);
+        const double r = p.reach + margin;
+        const bool self_flyer = entities[p.handle].physics_type == PhysicsType::FLIGHT_3DOF;
+        grid.query(c, r, candidates);
+        for (uint32_t j : candidates) {
+            if (j == p.handle || !world.alive(j) || teams[j] == teams[p.handle]) continue;
+            if (!self_flyer && entities[j].physics_type != PhysicsType::FLIGHT_3DOF) continue;
+            const Vec3& q = world.ecef_of(j);
+            double dx = q.x - c.x, dy = q.y - c.y, dz = q.z - c.z;
+            if (dx * dx + dy * dy + dz * dz > r * r) continue;
+            wanted[j] = 1;                       // inside p's envelope
+            if (self_flyer) wanted[p.handle] = 1; // p sees a hostile
+        }
+    }
+
+    for (const ScenarioEvent& ev : world.events) {
+        if (ev.fired || ev.trigger.kind != TriggerKind::PROXIMITY) continue;
+        if (ev.trigger.entity_a_h != NO_ENTITY) wanted[ev.trigger.entity_a_h] = 1;
+        if (ev.trigger.entity_b_h != NO_ENTITY) wanted[ev.trigger.entity_b_h] = 1;
+    }
+
+    for (size_t k = 0; k < flyers.size(); k++) {
+        uint32_t i = flyers[k];
+        if (!world.alive(i)) continue;
+        if (wanted[i] && lod.coarse[k]) {
+            if (lod.lag[k] > 0.0) step(world, k, dt);
+            lod.coarse[k] = 0;
+            lod.promotions++;
+        } else if (!wanted[i] && !lod.coarse[k]) {
+            lod.coarse[k] = 1;
+            lod.lag[k] = 0.0;
+            lod.demotions++;
+        }
+    }
+}
+
+void FlightLOD::step(MCWorld& world, size_t lane, double dt) {
+    FlightLODState& lod = world.lod;
+    MCEntity& e = world.entities()[world.with_physics(PhysicsType::FLIGHT_3DOF)[lane]];
+    const double lag = lod.lag[lane];
+    const int n = std::max(1, static_cast<int>(std::ceil(lag / MAX_SUBSTEP - 1e-9)));
+    const double h = lag / n;
+    lod.lag[lane] = 0.0;
+
+    double err = 0.0;
+    for (int s = 0; s < n; s++) {
+        const double V0 = e.flight_speed;
+        const double gamma0 = e.flight_gamma;
+        const double heading0 = e.flight_heading;
+        Flight3DOF::step(world, e, h);
+        Flight3DOF::apply_wind(world, world.with_physics(PhysicsType::FLIGHT_3DOF)[lane], h);
+
+        // Velocity change over the substep, applied h - dt early on average
+        double Vm = 0.5 * (V0 + e.flight_speed);
+        double dV = e.flight_speed - V0;
+        double dn = Vm * (e.flight_gamma - gamma0);
+        double dl = Vm * std::cos(0.5 * (gamma0 + e.flight_gamma)) *
+                    wrap_pi(e.flight_heading - heading0);
+        err += 0.5 * std::sqrt(dV * dV + dn * dn + dl * dl) * std::max(h - dt, 0.0);
+    }
+    lod.error_sum += err;
+    lod.error_max = std::max(lod.error_max, err);
+}
+
+} // namespace sim::mc
@@ -0,0 +1,43 @@
+/**
+ * FlightLOD — Level-of-detail switching for aircraft (MCConfig::lod_dt).
+ *
+ * Every lod_dt seconds the aircraft are classified against the envelopes
+ * of everything that could care about them, found through a SpatialGrid
+ * over ECEF positions:
+ *   - hostile radars, SAM and A2A shooters, kinetic-kill and orbital
+ *     combat units, out to their sensor / weapon reach;
+ *   - the aircraft's own radar and weapons, against any live hostile;
+ *   - unfired proximity triggers naming it.
+ * Each reach is padded by the distance the pair can close before the next
+ * check (both sides at the fastest speed seen, plus one coarse lag). An
+ * aircraft outside all of them is demoted: Flight3DOF skips it and it
+ * takes one Flight3DOF step of its accumulated lag every lod_dt under the
+ * AI's latest commands. One inside is promoted: its lag is stepped off
+ * (state reconstruction) and it rejoins the per-tick update.
+ *
+ * A coarse step integrates the lag in substeps of at most 1 s, each with
+ * the rates at its start; the position error against per-tick steps is
+ * estimated per substep h as 0.5 · |Δv| · (h - dt) and accumulated into
+ * FlightLODState.
+ */
+
+#ifndef SIM_MC_FLIGHT_LOD_HPP
+#define SIM_MC_FLIGHT_LOD_HPP
+
+#include "mc_world.hpp"
+
+namespace sim::mc {
+
+class FlightLOD {
+public:
+    /** Reclassify when due, then advance the coarse lanes. Call before Flight3DOF. */
+    static void update_all(double dt, MCWorld& world);
+
+private:
+    static void classify(MCWorld& world, double dt);
+    static void step(MCWorld& world, size_t lane, double dt);
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_FLIGHT_LOD_HPP
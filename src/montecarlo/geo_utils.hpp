@@ -109,6 +109,18 @@ inline double slant_range_ecef(double lat1, double lon1, double alt1,
     return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
 
+/**
+ * Euclidean distance between two ECEF points, in the same operation order
+ * as slant_range_ecef() (so a cached conversion gives the same bits).
+ */
+inline double ecef_range(const Vec3& p1, const Vec3& p2) {
+    const double dx = p2.x - p1.x;
+    const double dy = p2.y - p1.y;
+    const double dz = p2.z - p1.z;
+
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
 /**
  * Compute destination point given start, bearing, and distance on great circle.
  * @param lat       Start latitude in radians
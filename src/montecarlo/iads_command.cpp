@@ -0,0 +1,179 @@
+#include "montecarlo/iads_command.hpp"
+#include "montecarlo/mc_world.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double MIN_TARGET_ALT = 100.0;   // m, as SAMBattery
+
+struct Threat {
+    EntityHandle entity;
+    Vec3 pos;                  // ECEF, predicted for tracks
+};
+
+// Decision scratch, reused across ticks on each thread
+thread_local EntityMarks engaged;
+thread_local std::vector<Threat> threats;
+thread_local std::vector<EntityHandle> slots;     // battery per free fire channel
+thread_local std::vector<double> cost;            // [row * cols + col], minimised
+thread_local std::vector<double> u, v, min_slack;
+thread_local std::vector<uint32_t> row_of, way;   // [col], 1-based rows, 0 = none
+thread_local std::vector<uint8_t> used;
+
+/**
+ * Hungarian method, shortest augmenting path form, on the rows × cols
+ * matrix in `cost` with rows <= cols: O(rows^2 cols). Leaves the row
+ * matched to each column in row_of[1..cols].
+ */
+void solve_assignment(size_t rows, size_t cols) {
+    u.assign(rows + 1, 0.0);
+    v.assign(cols + 1, 0.0);
+    row_of.assign(cols + 1, 0);
+    way.assign(cols + 1, 0);
+    for (uint32_t i = 1; i <= rows; i++) {
+        row_of[0] = i;
+        size_t j0 = 0;
+        min_slack.assign(cols + 1, INF);
+        used.assign(cols + 1, 0);
+        do {
+            used[j0] = 1;
+            const uint32_t i0 = row_of[j0];
+            double delta = INF;
+            size_t j1 = 0;
+            for (size_t j = 1; j <= cols; j++) {
+                if (used[j]) continue;
+                const double cur = cost[(i0 - 1) * cols + (j - 1)] - u[i0] - v[j];
+                if (cur < min_slack[j]) {
+                    min_slack[j] = cur;
+                    way[j] = static_cast<uint32_t>(j0);
+                }
+                if (min_slack[j] < delta) {
+                    delta = min_slack[j];
+                    j1 = j;
+                }
+            }
+            for (size_t j = 0; j <= cols; j++) {
+                if (used[j]) {
+                    u[row_of[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    min_slack[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (row_of[j0] != 0);
+        do {
+            const size_t j1 = way[j0];
+            row_of[j0] = row_of[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+}
+
+} // namespace
+
+void IADSCommand::update_all(double dt, MCWorld& world) {
+    IADSState& iads = world.iads;
+    if (!iads.enabled) return;
+    for (IADSSector& sector : iads.sectors) {
+        sector.timer -= dt;
+        if (sector.timer > 0.0) continue;
+        sector.timer += sector.decision_interval;
+        decide(sector, world);
+    }
+}
+
+void IADSCommand::decide(IADSSector& sector, MCWorld& world) {
+    if (sector.soc != NO_ENTITY && !world.alive(sector.soc)) return;
+    auto& entities = world.entities();
+    const auto& cols = world.columns();
+
+    // Fire channels the SOC can task, one slot each
+    slots.clear();
+    for (EntityHandle b : sector.batteries) {
+        if (!world.alive(b)) continue;
+        const MCEntity& e = entities[b];
+        if (e.engagement_rules == "weapons_hold") continue;
+        if (sector.soc != NO_ENTITY && world.comms.enabled &&
+            !world.comms.connected(sector.soc, b)) continue;
+
+        int pending = 0;
+        for (const auto& eng : e.sam_engagements) pending += eng.phase < 2 ? 1 : 0;
+        const int salvo = std::max(1, e.sam_salvo_size);
+        const int salvos = (std::max(0, e.sam_missiles_ready - pending * salvo) + salvo - 1) / salvo;
+        const int free = std::min(sector.fire_channels - static_cast<int>(e.sam_engagements.size()),
+                                  salvos);
+        for (int k = 0; k < free; k++) slots.push_back(b);
+    }
+    if (slots.empty()) return;
+
+    // Air picture, less targets the team already engages
+    engaged.reset(entities.size());
+    for (uint32_t s : world.with_weapon(WeaponType::SAM_BATTERY)) {
+        if (cols.team[s] != sector.team) continue;
+        for (const auto& eng : entities[s].sam_engagements) engaged.set(eng.target);
+    }
+    threats.clear();
+    auto add_threat = [&](EntityHandle h, const Vec3& pos) {
+        if (engaged.test(h)) return;
+        const MCEntity* target = world.get(h);
+        if (!target || !target->active || target->destroyed) return;
+        if (target->physics_type == PhysicsType::STATIC) return;
+        if (target->geo_alt < MIN_TARGET_ALT) return;
+        engaged.set(h);
+        threats.push_back({h, pos});
+    };
+    if (world.tracks.enabled) {
+        for (const RadarTrack& t : world.tracks.team(sector.team)) {
+            if (TrackTable::reportable(t, world.sim_time)) {
+                add_threat(t.entity, t.predict(world.sim_time));
+            }
+        }
+    } else {
+        for (EntityHandle r : sector.radars) {
+            if (!world.alive(r)) continue;
+            for (const auto& det : entities[r].radar_detections) {
+                add_threat(det.entity, world.geodetic_ecef(det.entity));
+            }
+        }
+    }
+    if (threats.empty()) return;
+
+    // Threat × slot values as costs; the smaller side indexes rows
+    const bool by_threat = threats.size() <= slots.size();
+    const size_t rows = by_threat ? threats.size() : slots.size();
+    const size_t ncols = by_threat ? slots.size() : threats.size();
+    cost.assign(rows * ncols, 0.0);
+    for (size_t s = 0; s < slots.size(); s++) {
+        const MCEntity& b = entities[slots[s]];
+        const Vec3 at = world.geodetic_ecef(slots[s]);
+        for (size_t t = 0; t < threats.size(); t++) {
+            const double range = ecef_range(at, threats[t].pos);
+            if (range > b.sam_max_range || range < b.sam_min_range) continue;
+            const double value = 2.0 - range / b.sam_max_range;
+            cost[by_threat ? t * ncols + s : s * ncols + t] = -value;
+        }
+    }
+    solve_assignment(rows, ncols);
+
+    for (size_t col = 1; col <= ncols; col++) {
+        if (row_of[col] == 0) continue;
+        const size_t row = row_of[col] - 1;
+        if (!(cost[row * ncols + (col - 1)] < 0.0)) continue;
+        const size_t t = by_threat ? row : col - 1;
+        const size_t s = by_threat ? col - 1 : row;
+        entities[slots[s]].sam_engagements.push_back(SAMEngagement{
+            threats[t].entity,
+            0,      // phase = DETECT
+            1.0,    // detect time
+            0       // missiles_fired
+        });
+    }
+}
+
+} // namespace sim::mc
@@ -0,0 +1,74 @@
+/**
+ * IADSCommand — Sector operations centres with batched weapon-target
+ * assignment for SAM batteries (headless counterpart of iads_engine.js).
+ *
+ * With MCConfig::iads, SAM batteries stop picking their own targets.
+ * Each sector operations centre (SOC) owns a set of batteries and
+ * radars and, once per decision interval, builds its air picture and
+ * assigns threats to batteries in one pass:
+ *   threats    the team's confirmed fused tracks (MCConfig::radar_tracks)
+ *              or else the union of its radars' detections, less any
+ *              target a battery of the team already engages;
+ *   slots      per battery, free fire channels, limited by the salvos
+ *              its magazine still holds after pending engagements;
+ *   value      1 + (1 - range / max range) for a threat inside the
+ *              battery's envelope, so the most threats are covered first
+ *              and then by the nearest batteries; 0 outside;
+ * and solves threat × slot as a linear assignment (Hungarian, shortest
+ * augmenting path). Each positive pair opens a DETECT-phase engagement
+ * that SAMBattery advances through the usual kill chain.
+ *
+ * Sectors come from the scenario's "iads" array:
+ *   { "id", "soc": <entity id>, "batteries": [ids], "radars": [ids],
+ *     "decisionInterval": s (2), "fireChannels": n (4) }
+ * where a missing "batteries" or "radars" list takes every SAM battery
+ * or radar of the SOC's team. Without an "iads" array each team with
+ * SAM batteries gets one sector holding all of them and all its radars.
+ * With MCConfig::comms a SOC tasks only batteries it has a route to. A
+ * sector whose SOC is destroyed assigns nothing; its batteries hold.
+ * Sector decision times are phase-spread over the interval.
+ */
+
+#ifndef SIM_MC_IADS_COMMAND_HPP
+#define SIM_MC_IADS_COMMAND_HPP
+
+#include "mc_entity.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+class MCWorld;
+
+struct IADSSector {
+    std::string id;
+    EntityHandle soc = NO_ENTITY;         // NO_ENTITY: no C2 node (default sectors)
+    uint16_t team = 0;                    // interned team
+    std::vector<EntityHandle> batteries;
+    std::vector<EntityHandle> radars;
+    double decision_interval = 2.0;       // s
+    int fire_channels = 4;                // simultaneous engagements per battery
+    double timer = 0.0;                   // s to the next decision
+};
+
+/** Per-world IADS state: the sectors and which batteries they control. */
+struct IADSState {
+    bool enabled = false;
+    std::vector<IADSSector> sectors;
+    std::vector<uint8_t> controlled;       // [handle] -> battery under a SOC
+
+    bool controls(EntityHandle h) const {
+        return enabled && h < controlled.size() && controlled[h];
+    }
+};
+
+class IADSCommand {
+public:
+    static void update_all(double dt, MCWorld& world);
+private:
+    static void decide(IADSSector& sector, MCWorld& world);
+};
+
+} // namespace sim::mc
+#endif // SIM_MC_IADS_COMMAND_HPP
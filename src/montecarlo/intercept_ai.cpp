@@ -2,7 +2,7 @@
  * InterceptAI — Chase and engage a designated target entity.
  *
  * For each entity with ai_type == INTERCEPT:
- *   1. Resolve target by intercept_target_id
+ *   1. Resolve target by intercept_target (handle resolved at parse time)
  *   2. Compute bearing and distance to target geodetic position
  *   3. Steer toward target (bank, alpha, throttle)
  *   4. Set intercept_state = 1 when within engage range
@@ -18,18 +18,43 @@
 namespace sim::mc {
 
 void InterceptAI::update_all(double dt, MCWorld& world) {
-    for (auto& e : world.entities()) {
-        if (e.ai_type != AIType::INTERCEPT) continue;
-        if (!e.active || e.destroyed) continue;
-        update_entity(e, dt, world);
+    update_range(dt, world, 0, world.with_ai(AIType::INTERCEPT).size());
+}
+
+void InterceptAI::update_range(double dt, MCWorld& world, size_t begin, size_t end) {
+    auto& entities = world.entities();
+    const IndexList& interceptors = world.with_ai(AIType::INTERCEPT);
+    for (size_t k = begin; k < end; k++) {
+        uint32_t i = interceptors[k];
+        if (!world.alive(i) || entities[i].player_controlled) continue;
+        if (world.decisions.due(AIType::INTERCEPT, i)) {
+            update_entity(entities[i], dt, world);
+        } else {
+            hold_entity(entities[i], dt, world);
+        }
+    }
+}
+
+void InterceptAI::converge_roll(MCEntity& e, double dt) {
+    double roll_rate = std::min(dt * 3.0, 1.0);
+    e.flight_roll += (e.ai_roll_cmd - e.flight_roll) * roll_rate;
+}
+
+void InterceptAI::hold_entity(MCEntity& e, double dt, MCWorld& world) {
+    if (e.intercept_target == NO_ENTITY) return;
+    MCEntity* target = world.get(e.intercept_target);
+    if (!target || !target->active || target->destroyed) {
+        e.intercept_state = 0;
+        return;
     }
+    converge_roll(e, dt);
 }
 
 void InterceptAI::update_entity(MCEntity& e, double dt, MCWorld& world) {
     // ── Resolve target ──
-    if (e.intercept_target_id.empty()) return;
+    if (e.intercept_target == NO_ENTITY) return;
 
-    MCEntity* target = world.get_entity(e.intercept_target_id);
+    MCEntity* target = world.get(e.intercept_target);
     if (!target || !target->active || target->destroyed) {
         e.intercept_state = 0;
         return;
@@ -79,11 +104,10 @@ void InterceptAI::update_entity(MCEntity& e, double dt, MCWorld& world) {
     double heading_error = angle_diff(desired_heading, e.flight_heading);
 
     // Roll command: proportional to heading error, max ~40 degrees bank
-    double roll_cmd = std::clamp(heading_error * 2.0, -0.7, 0.7);
+    e.ai_roll_cmd = std::clamp(heading_error * 2.0, -0.7, 0.7);
 
     // Smooth roll convergence
-    double roll_rate = std::min(dt * 3.0, 1.0);
-    e.flight_roll += (roll_cmd - e.flight_roll) * roll_rate;
+    converge_roll(e, dt);
 
     // ── Altitude steering via alpha ──
     double alt_error = desired_alt - e.geo_alt;
@@ -1,14 +1,17 @@
 /**
  * InterceptAI — Chase and engage a designated target entity.
  *
- * Pursuit steering toward a target entity identified by intercept_target_id.
+ * Pursuit steering toward a target entity identified by intercept_target.
  * Sets intercept_state = 1 (engaged) when within intercept_engage_range,
  * signaling the weapon system to fire.
  *
  * Supports pursuit (mode 0), lead pursuit (mode 1), and stern conversion
  * (mode 2) — currently all aliases for pure pursuit.
  *
- * Processes all entities with ai_type == INTERCEPT.
+ * Processes all entities with ai_type == INTERCEPT. With reduced-rate
+ * decisions (MCConfig::ai_decisions) steering and the engagement check
+ * run on decision ticks only; in between the bank keeps converging on the
+ * last roll command.
  */
 
 #ifndef SIM_MC_INTERCEPT_AI_HPP
@@ -20,9 +23,23 @@ namespace sim::mc {
 
 class InterceptAI {
 public:
+    /** Seconds between decisions under MCConfig::ai_decisions. */
+    static constexpr double DECISION_PERIOD = 0.2;   // pursuit steering, 5 Hz
+
     static void update_all(double dt, MCWorld& world);
+
+    /**
+     * Entries [begin, end) of with_ai(INTERCEPT); each writes only its own
+     * aircraft (targets' positions are read), so disjoint ranges may run
+     * concurrently while nothing moves aircraft.
+     */
+    static void update_range(double dt, MCWorld& world, size_t begin, size_t end);
 private:
     static void update_entity(MCEntity& e, double dt, MCWorld& world);
+    /** Between decisions: drop a lost target, carry on with the last command. */
+    static void hold_entity(MCEntity& e, double dt, MCWorld& world);
+    /** Smooth bank convergence on the held roll command. */
+    static void converge_roll(MCEntity& e, double dt);
 };
 
 } // namespace sim::mc
@@ -0,0 +1,639 @@
+#include "montecarlo/intercept_table.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include "montecarlo/mc_world.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+constexpr double MU_EARTH = 3.986004418e14;      // m^3/s^2
+constexpr double OMEGA_EARTH = 7.2921159e-5;     // rad/s, GMST = 0 at t = 0
+constexpr double FAN_BEARING = 30.0 * DEG_TO_RAD;  // fan azimuths tried around the threat's bearing
+constexpr int MAX_SOLVES = 8;                    // per cell
+
+template <typename T>
+void write_pod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+void read_pod(std::istream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    if (!in) throw std::runtime_error("Intercept table: unexpected end of file");
+}
+
+void write_axis(std::ostream& out, const std::vector<double>& axis) {
+    write_pod(out, static_cast<uint32_t>(axis.size()));
+    out.write(reinterpret_cast<const char*>(axis.data()),
+              static_cast<std::streamsize>(axis.size() * sizeof(double)));
+}
+
+std::vector<double> read_axis(std::istream& in) {
+    uint32_t n = 0;
+    read_pod(in, n);
+    if (n == 0 || n > 4096) throw std::runtime_error("Intercept table: bad axis length");
+    std::vector<double> axis(n);
+    in.read(reinterpret_cast<char*>(axis.data()), static_cast<std::streamsize>(n * sizeof(double)));
+    if (!in) throw std::runtime_error("Intercept table: unexpected end of file");
+    return axis;
+}
+
+void check_axis(const std::vector<double>& axis, const char* name) {
+    if (axis.empty()) {
+        throw std::invalid_argument(std::string("Intercept table: empty ") + name + " axis");
+    }
+    for (size_t i = 1; i < axis.size(); i++) {
+        if (!(axis[i] > axis[i - 1])) {
+            throw std::invalid_argument(std::string("Intercept table: ") + name +
+                                        " axis is not increasing");
+        }
+    }
+}
+
+/** Lower cell index and fraction of x on an axis, clamped to its ends */
+struct Bracket {
+    size_t lo = 0;
+    size_t hi = 0;
+    double t = 0.0;
+};
+
+Bracket bracket(const std::vector<double>& axis, double x) {
+    Bracket b;
+    if (axis.size() == 1 || x <= axis.front()) return b;
+    if (x >= axis.back()) {
+        b.lo = b.hi = axis.size() - 1;
+        return b;
+    }
+    b.hi = static_cast<size_t>(std::upper_bound(axis.begin(), axis.end(), x) - axis.begin());
+    b.lo = b.hi - 1;
+    b.t = (x - axis[b.lo]) / (axis[b.hi] - axis[b.lo]);
+    return b;
+}
+
+Vec3 rotate_z(const Vec3& v, double angle) {
+    double c = std::cos(angle), s = std::sin(angle);
+    return Vec3(c * v.x - s * v.y, s * v.x + c * v.y, v.z);
+}
+
+/** Local east, north and up at a site (ECI), on the sphere */
+struct SiteFrame {
+    Vec3 east, north, up;
+
+    explicit SiteFrame(const Vec3& site) {
+        up = normalized(site);
+        east = normalized(cross(Vec3(0.0, 0.0, 1.0), up));
+        north = cross(up, east);
+    }
+
+    Vec3 local(const Vec3& p) const { return Vec3(dot(p, east), dot(p, north), dot(p, up)); }
+};
+
+/** A circular orbit by its pass: position and velocity `t` seconds after the decision */
+struct CircularPass {
+    Vec3 pass;          // unit position at closest approach
+    Vec3 along;         // unit velocity there
+    double radius = 0.0;
+    double speed = 0.0;
+    double time_to_pass = 0.0;
+
+    sim::StateVector at(double t) const {
+        double a = speed / radius * (t - time_to_pass);
+        double c = std::cos(a), s = std::sin(a);
+        sim::StateVector sv;
+        sv.position = radius * (c * pass + s * along);
+        sv.velocity = speed * (c * along - s * pass);
+        return sv;
+    }
+};
+
+CircularPass circular_pass(const Vec3& site_eci, const InterceptGeometry& g) {
+    // The site at closest approach, and the track heading there
+    const SiteFrame f(rotate_z(site_eci, OMEGA_EARTH * g.time_to_pass));
+    const double psi = g.heading * DEG_TO_RAD;
+    const Vec3 heading = std::sin(psi) * f.east + std::cos(psi) * f.north;
+
+    // Orbit normal tilted so the site sits cross_range left of the track
+    const double delta = g.cross_range / R_EARTH_MEAN;
+    const Vec3 normal = std::cos(delta) * cross(f.up, heading) + std::sin(delta) * f.up;
+
+    CircularPass p;
+    p.pass = normalized(f.up - std::sin(delta) * normal);
+    p.along = cross(normal, p.pass);
+    p.radius = R_EARTH_MEAN + g.altitude;
+    p.speed = std::sqrt(MU_EARTH / p.radius);
+    p.time_to_pass = g.time_to_pass;
+    return p;
+}
+
+/** Steering profiles flown once per table, sampled on the TOF_STEP grid */
+struct Fan {
+    static constexpr int AZIMUTHS = 24;
+    static constexpr double S1_RATES[] = {0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3,
+                                          1.4, 1.5};
+    static constexpr double S2_RATES[] = {-0.5, -0.3, -0.1, 0.1, 0.3, 0.5, 0.7, 0.9};
+    static constexpr int PER_AZIMUTH = 12 * 8;
+    static constexpr double KICK = 0.1;   // pitch_s1[0] [rad]
+
+    double first_tof = 0.0;               // time of flight of sample 0
+    int samples = 0;
+    std::vector<sim::LaunchControls> profiles;   // [azimuth][s1][s2]
+    std::vector<Vec3> points;             // [sample][profile], site frame at launch [m]
+    std::vector<uint8_t> valid;           // above ground at the sample
+
+    static sim::LaunchControls profile(int az, int s1, int s2) {
+        sim::LaunchControls c = {};
+        c.launch_azimuth = 2.0 * M_PI * az / AZIMUTHS;
+        c.pitch_s1[0] = KICK;
+        c.pitch_s1[1] = S1_RATES[s1];
+        c.pitch_s2[0] = KICK + S1_RATES[s1];
+        c.pitch_s2[1] = S2_RATES[s2];
+        return c;
+    }
+};
+
+Fan fly_fan(const InterceptWeapon& weapon,
+            const std::shared_ptr<const sim::LaunchPerformance>& performance,
+            sim::ThreadPool& pool) {
+    const sim::LaunchSite site{weapon.site_latitude, 0.0, 0.0};
+    const double burn = performance->total_burn();
+
+    Fan fan;
+    fan.first_tof = std::ceil(burn / InterceptTable::TOF_STEP) * InterceptTable::TOF_STEP;
+    fan.samples = fan.first_tof > weapon.max_tof
+        ? 0 : static_cast<int>((weapon.max_tof - fan.first_tof) / InterceptTable::TOF_STEP) + 1;
+    for (int az = 0; az < Fan::AZIMUTHS; az++) {
+        for (int s1 = 0; s1 < 12; s1++) {
+            for (int s2 = 0; s2 < 8; s2++) fan.profiles.push_back(Fan::profile(az, s1, s2));
+        }
+    }
+    const size_t n = fan.profiles.size();
+    fan.points.assign(static_cast<size_t>(fan.samples) * n, Vec3());
+    fan.valid.assign(static_cast<size_t>(fan.samples) * n, 0);
+    if (fan.samples == 0) return fan;
+
+    sim::LaunchSolverConfig config;
+    config.num_threads = 1;
+    const sim::LaunchTrajectorySolver solver(weapon.vehicle, site, InterceptTable::REFERENCE_JD,
+                                             config, performance);
+    const SiteFrame frame(site.compute_eci_state(InterceptTable::REFERENCE_JD).position);
+    sim::TerminalTarget target;
+    target.mode = sim::TargetingMode::POSITION_INTERCEPT;
+
+    pool.parallel_for(n, [&](size_t p) {
+        sim::LaunchControls c = fan.profiles[p];
+        c.coast_after_burnout = weapon.max_tof - burn;
+        const std::vector<sim::LaunchState> path = solver.propagate(c, target).trajectory;
+        size_t at = 0;
+        for (int k = 0; k < fan.samples; k++) {
+            const double t = fan.first_tof + k * InterceptTable::TOF_STEP;
+            while (at + 1 < path.size() && path[at + 1].time < t) at++;
+            if (at + 1 >= path.size()) break;
+            const sim::LaunchState& a = path[at];
+            const sim::LaunchState& b = path[at + 1];
+            const double span = b.time - a.time;
+            const double w = span > 0.0 ? std::clamp((t - a.time) / span, 0.0, 1.0) : 0.0;
+            const Vec3 r = (1.0 - w) * a.position + w * b.position;
+            const size_t i = static_cast<size_t>(k) * n + p;
+            fan.points[i] = frame.local(r);
+            fan.valid[i] = r.norm() > R_EARTH_MEAN;
+        }
+    });
+    return fan;
+}
+
+/** One launch-delay / time-of-flight candidate of a cell */
+struct Candidate {
+    double delay = 0.0;
+    int sample = 0;
+    size_t profile = 0;
+    double bearing_error = 0.0;   // threat bearing minus the profile's [rad]
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Table
+// ═══════════════════════════════════════════════════════════════
+
+InterceptAxes InterceptAxes::defaults() {
+    InterceptAxes a;
+    a.altitude = {200000.0, 400000.0, 600000.0, 800000.0, 1000000.0, 1200000.0};
+    for (int i = -5; i <= 5; i++) a.cross_range.push_back(500000.0 * i);
+    for (int i = -4; i <= 8; i++) a.time_to_pass.push_back(300.0 * i);
+    for (int i = 0; i <= 12; i++) a.heading.push_back(30.0 * i);
+    return a;
+}
+
+InterceptTable::InterceptTable(const InterceptWeapon& weapon, const InterceptAxes& axes)
+    : weapon_(weapon), axes_(axes) {
+    check_axis(axes_.altitude, "altitude");
+    check_axis(axes_.cross_range, "cross range");
+    check_axis(axes_.time_to_pass, "time to pass");
+    check_axis(axes_.heading, "heading");
+    if (weapon_.vehicle.stages.empty()) {
+        throw std::invalid_argument("Intercept table: vehicle has no stages");
+    }
+    size_t n = axes_.altitude.size() * axes_.cross_range.size() * axes_.time_to_pass.size()
+             * axes_.heading.size();
+    feasibility_.assign(n, 0.0f);
+    delay_.assign(n, 0.0f);
+    tof_.assign(n, 0.0f);
+    steering_.assign(n * STEERING, 0.0f);
+}
+
+void InterceptTable::set(size_t cell, float feasibility, float launch_delay, float tof,
+                         const sim::LaunchControls& controls) {
+    feasibility_[cell] = feasibility;
+    delay_[cell] = launch_delay;
+    tof_[cell] = tof;
+    float* s = &steering_[cell * STEERING];
+    s[0] = static_cast<float>(controls.launch_azimuth);
+    for (int i = 0; i < 3; i++) {
+        s[1 + i] = static_cast<float>(controls.pitch_s1[i]);
+        s[4 + i] = static_cast<float>(controls.pitch_s2[i]);
+    }
+}
+
+InterceptLookup InterceptTable::lookup(const InterceptGeometry& g) const {
+    const Bracket b[4] = {
+        bracket(axes_.altitude, g.altitude),
+        bracket(axes_.cross_range, g.cross_range),
+        bracket(axes_.time_to_pass, g.time_to_pass),
+        bracket(axes_.heading, g.heading),
+    };
+    InterceptLookup out;
+    double feasible_weight = 0.0;
+    for (int corner = 0; corner < 16; corner++) {
+        double w = 1.0;
+        size_t at[4];
+        for (int k = 0; k < 4; k++) {
+            bool upper = corner & (8 >> k);
+            at[k] = upper ? b[k].hi : b[k].lo;
+            w *= upper ? b[k].t : 1.0 - b[k].t;
+        }
+        if (w == 0.0) continue;
+        size_t cell = index(at[0], at[1], at[2], at[3]);
+        out.feasibility += w * feasibility_[cell];
+        if (feasibility_[cell] < SHOOT_FEASIBILITY) continue;
+        feasible_weight += w;
+        out.launch_delay += w * delay_[cell];
+        out.tof += w * tof_[cell];
+    }
+    if (feasible_weight > 0.0) {
+        out.launch_delay /= feasible_weight;
+        out.tof /= feasible_weight;
+    }
+    return out;
+}
+
+sim::LaunchControls InterceptTable::seed(const InterceptGeometry& g) const {
+    const Bracket b[4] = {
+        bracket(axes_.altitude, g.altitude),
+        bracket(axes_.cross_range, g.cross_range),
+        bracket(axes_.time_to_pass, g.time_to_pass),
+        bracket(axes_.heading, g.heading),
+    };
+    double best_weight = -1.0;
+    size_t best = 0;
+    for (int corner = 0; corner < 16; corner++) {
+        double w = 1.0;
+        size_t at[4];
+        for (int k = 0; k < 4; k++) {
+            bool upper = corner & (8 >> k);
+            at[k] = upper ? b[k].hi : b[k].lo;
+            w *= upper ? b[k].t : 1.0 - b[k].t;
+        }
+        size_t cell = index(at[0], at[1], at[2], at[3]);
+        if (feasibility_[cell] >= SHOOT_FEASIBILITY && w > best_weight) {
+            best_weight = w;
+            best = cell;
+        }
+    }
+
+    sim::LaunchControls c = sim::LaunchControls::default_guess(
+        0.0, weapon_.site_latitude * DEG_TO_RAD);
+    if (best_weight < 0.0) return c;
+    const float* s = &steering_[best * STEERING];
+    c.launch_azimuth = s[0];
+    for (int i = 0; i < 3; i++) {
+        c.pitch_s1[i] = s[1 + i];
+        c.pitch_s2[i] = s[4 + i];
+    }
+    c.coast_after_burnout = 0.0;
+    c.epoch_offset = 0.0;
+    return c;
+}
+
+void InterceptTable::write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Intercept table: cannot write " + path);
+
+    out.write(MAGIC, sizeof(MAGIC));
+    write_pod(out, VERSION);
+    write_pod(out, static_cast<uint32_t>(weapon_.name.size()));
+    out.write(weapon_.name.data(), static_cast<std::streamsize>(weapon_.name.size()));
+    write_pod(out, weapon_.site_latitude);
+    write_pod(out, weapon_.max_delay);
+    write_pod(out, weapon_.max_tof);
+    write_pod(out, static_cast<uint32_t>(weapon_.vehicle.stages.size()));
+    for (const sim::SolverRocketStage& s : weapon_.vehicle.stages) {
+        write_pod(out, s.dry_mass);
+        write_pod(out, s.propellant_mass);
+        write_pod(out, s.thrust);
+        write_pod(out, s.isp_sl);
+        write_pod(out, s.isp_vac);
+    }
+    write_pod(out, weapon_.vehicle.payload_mass);
+    write_pod(out, weapon_.vehicle.drag_coefficient);
+    write_pod(out, weapon_.vehicle.reference_area);
+    write_axis(out, axes_.altitude);
+    write_axis(out, axes_.cross_range);
+    write_axis(out, axes_.time_to_pass);
+    write_axis(out, axes_.heading);
+    for (const std::vector<float>* column : {&feasibility_, &delay_, &tof_, &steering_}) {
+        out.write(reinterpret_cast<const char*>(column->data()),
+                  static_cast<std::streamsize>(column->size() * sizeof(float)));
+    }
+    if (!out) throw std::runtime_error("Intercept table: write failed for " + path);
+}
+
+InterceptTable InterceptTable::read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Intercept table: cannot open " + path);
+
+    char magic[4];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("Intercept table: bad magic in " + path);
+    }
+    uint32_t version = 0;
+    read_pod(in, version);
+    if (version != VERSION) {
+        throw std::runtime_error("Intercept table: unsupported version " +
+                                 std::to_string(version) + " in " + path);
+    }
+
+    InterceptWeapon weapon;
+    uint32_t name_length = 0;
+    read_pod(in, name_length);
+    if (name_length > 256) throw std::runtime_error("Intercept table: bad name in " + path);
+    weapon.name.resize(name_length);
+    in.read(&weapon.name[0], name_length);
+    read_pod(in, weapon.site_latitude);
+    read_pod(in, weapon.max_delay);
+    read_pod(in, weapon.max_tof);
+    uint32_t stages = 0;
+    read_pod(in, stages);
+    if (stages == 0 || stages > 4) throw std::runtime_error("Intercept table: bad stage count in " + path);
+    weapon.vehicle.stages.resize(stages);
+    for (sim::SolverRocketStage& s : weapon.vehicle.stages) {
+        read_pod(in, s.dry_mass);
+        read_pod(in, s.propellant_mass);
+        read_pod(in, s.thrust);
+        read_pod(in, s.isp_sl);
+        read_pod(in, s.isp_vac);
+    }
+    read_pod(in, weapon.vehicle.payload_mass);
+    read_pod(in, weapon.vehicle.drag_coefficient);
+    read_pod(in, weapon.vehicle.reference_area);
+
+    InterceptAxes axes;
+    axes.altitude = read_axis(in);
+    axes.cross_range = read_axis(in);
+    axes.time_to_pass = read_axis(in);
+    axes.heading = read_axis(in);
+
+    InterceptTable table(weapon, axes);
+    for (std::vector<float>* column : {&table.feasibility_, &table.delay_, &table.tof_,
+                                       &table.steering_}) {
+        in.read(reinterpret_cast<char*>(column->data()),
+                static_cast<std::streamsize>(column->size() * sizeof(float)));
+    }
+    if (!in) throw std::runtime_error("Intercept table: unexpected end of file in " + path);
+    return table;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Geometry
+// ═══════════════════════════════════════════════════════════════
+
+InterceptGeometry intercept_geometry(const Vec3& site_eci, const Vec3& position,
+                                     const Vec3& velocity) {
+    const Vec3 h = cross(position, velocity);
+    const Vec3 normal = normalized(h);
+    const double radius = position.norm();
+    const double rate = h.norm() / (radius * radius);
+    const Vec3 r_hat = position / radius;
+
+    // Closest approach: where the turning site meets the orbit plane's
+    // meridian, by fixed point (the site turns ~1/16 as fast as LEO)
+    InterceptGeometry g;
+    g.altitude = radius - R_EARTH_MEAN;
+    Vec3 site, pass;
+    for (int i = 0; i < 5; i++) {
+        site = normalized(rotate_z(site_eci, OMEGA_EARTH * g.time_to_pass));
+        pass = normalized(site - dot(site, normal) * normal);
+        g.time_to_pass = std::atan2(dot(cross(r_hat, pass), normal), dot(r_hat, pass)) / rate;
+    }
+    site = normalized(rotate_z(site_eci, OMEGA_EARTH * g.time_to_pass));
+    pass = normalized(site - dot(site, normal) * normal);
+    g.cross_range = R_EARTH_MEAN * std::asin(std::clamp(dot(site, normal), -1.0, 1.0));
+
+    const SiteFrame f(site);
+    const Vec3 along = cross(normal, pass);
+    g.heading = std::atan2(dot(along, f.east), dot(along, f.north)) * RAD_TO_DEG;
+    if (g.heading < 0.0) g.heading += 360.0;
+    return g;
+}
+
+InterceptGeometry intercept_geometry(MCWorld& world, EntityHandle site, EntityHandle threat) {
+    // The battery's ECEF turned into the world's ECI (GMST = OMEGA t)
+    const Vec3& ecef = world.ecef_of(site);
+    const Vec3 site_eci = rotate_z(ecef, OMEGA_EARTH * world.sim_time);
+    world.refresh_orbit(threat);
+    const MCEntity& t = world.entities()[threat];
+    return intercept_geometry(site_eci, t.eci_pos, t.eci_vel);
+}
+
+sim::StateVector intercept_threat_state(const Vec3& site_eci, const InterceptGeometry& g) {
+    return circular_pass(site_eci, g).at(0.0);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Generator
+// ═══════════════════════════════════════════════════════════════
+
+InterceptTable generate_intercept(const InterceptWeapon& weapon, const InterceptAxes& axes,
+                                  int num_threads) {
+    InterceptTable table(weapon, axes);
+    sim::ThreadPool pool(num_threads);
+    const auto performance = sim::LaunchPerformance::build(weapon.vehicle);
+    const double burn = performance->total_burn();
+    const Fan fan = fly_fan(weapon, performance, pool);
+    const size_t per_sample = fan.profiles.size();
+
+    const sim::LaunchSite site{weapon.site_latitude, 0.0, 0.0};
+    const Vec3 site_eci = site.compute_eci_state(InterceptTable::REFERENCE_JD).position;
+
+    sim::LaunchSolverConfig config;
+    config.num_threads = 1;
+    config.max_iterations = 15;
+    for (int i = 0; i < sim::LaunchControls::N_CONTROLS; i++) config.free_controls[i] = false;
+    for (int i = 0; i <= 6; i++) config.free_controls[i] = true;   // azimuth, pitch
+    config.free_controls[12] = true;                               // launch time
+
+    // A heading axis spanning a full turn repeats its first column
+    const size_t n_heading = axes.heading.size();
+    const bool wraps = n_heading > 1 && axes.heading.back() - axes.heading.front() >= 360.0;
+    const size_t solved_headings = wraps ? n_heading - 1 : n_heading;
+    const size_t n_delay = static_cast<size_t>(weapon.max_delay / InterceptTable::DELAY_STEP) + 1;
+
+    // Candidates of one launch delay: the best-matching sample of each run
+    // of fan hits, in time-of-flight order
+    auto candidates = [&](const CircularPass& threat, double delay, std::vector<Candidate>& out) {
+        out.clear();
+        const SiteFrame frame(rotate_z(site_eci, OMEGA_EARTH * delay));
+        Candidate run;
+        double run_best = std::numeric_limits<double>::infinity();
+        for (int k = 0; k < fan.samples; k++) {
+            const double tof = fan.first_tof + k * InterceptTable::TOF_STEP;
+            const Vec3 q = frame.local(threat.at(delay + tof).position);
+            const double bearing = std::atan2(q.x, q.y);
+            double best = std::numeric_limits<double>::infinity();
+            Candidate c;
+            for (int az = 0; az < Fan::AZIMUTHS; az++) {
+                if (std::abs(angle_diff(bearing, 2.0 * M_PI * az / Fan::AZIMUTHS)) > FAN_BEARING) {
+                    continue;
+                }
+                for (int p = 0; p < Fan::PER_AZIMUTH; p++) {
+                    const size_t profile = static_cast<size_t>(az * Fan::PER_AZIMUTH + p);
+                    const size_t i = static_cast<size_t>(k) * per_sample + profile;
+                    if (!fan.valid[i]) continue;
+                    const Vec3& f = fan.points[i];
+                    // Distance with the fan point swung onto the threat's bearing
+                    const double ground = std::hypot(f.x, f.y);
+                    const double dx = q.x - ground * std::sin(bearing);
+                    const double dy = q.y - ground * std::cos(bearing);
+                    const double d = dx * dx + dy * dy + (q.z - f.z) * (q.z - f.z);
+                    if (d < best) {
+                        best = d;
+                        c.profile = profile;
+                        c.bearing_error = angle_diff(bearing, std::atan2(f.x, f.y));
+                    }
+                }
+            }
+            const bool hit = best < InterceptTable::FAN_MARGIN * InterceptTable::FAN_MARGIN;
+            if (hit && best < run_best) {
+                run = c;
+                run.delay = delay;
+                run.sample = k;
+                run_best = best;
+            }
+            if (!hit && run_best < std::numeric_limits<double>::infinity()) {
+                out.push_back(run);
+                run_best = std::numeric_limits<double>::infinity();
+            }
+        }
+        if (run_best < std::numeric_limits<double>::infinity()) out.push_back(run);
+    };
+
+    auto search = [&](size_t row) {
+        const size_t hi = row % solved_headings;
+        const size_t rest = row / solved_headings;
+        const size_t pi = rest % axes.time_to_pass.size();
+        const size_t ci = (rest / axes.time_to_pass.size()) % axes.cross_range.size();
+        const size_t ai = rest / (axes.time_to_pass.size() * axes.cross_range.size());
+        InterceptGeometry g;
+        g.altitude = axes.altitude[ai];
+        g.cross_range = axes.cross_range[ci];
+        g.time_to_pass = axes.time_to_pass[pi];
+        g.heading = axes.heading[hi];
+        const CircularPass threat = circular_pass(site_eci, g);
+
+        std::vector<Candidate> found;
+        int solves = 0;
+        for (size_t di = 0; di < n_delay && solves < MAX_SOLVES; di++) {
+            const double delay = di * InterceptTable::DELAY_STEP;
+            candidates(threat, delay, found);
+            for (const Candidate& c : found) {
+                if (solves++ >= MAX_SOLVES) break;
+                const double tof = fan.first_tof + c.sample * InterceptTable::TOF_STEP;
+                sim::TerminalTarget target;
+                target.mode = sim::TargetingMode::POSITION_INTERCEPT;
+                target.target_state_epoch = threat.at(delay);
+                target.time_of_flight = tof;
+
+                sim::LaunchControls guess = fan.profiles[c.profile];
+                guess.launch_azimuth = std::fmod(guess.launch_azimuth + c.bearing_error + 2.0 * M_PI,
+                                                 2.0 * M_PI);
+                guess.coast_after_burnout = tof - burn;
+                sim::LaunchTrajectorySolver solver(weapon.vehicle, site,
+                                                   InterceptTable::REFERENCE_JD + delay / 86400.0,
+                                                   config, performance);
+                const sim::LaunchTrajectorySolution sol = solver.solve(target, &guess);
+                const double launch = delay + sol.controls.epoch_offset;
+                if (!sol.converged || launch < -1.0 || launch > weapon.max_delay) continue;
+
+                const size_t cell = table.index(ai, ci, pi, hi);
+                table.set(cell, 1.0f, static_cast<float>(std::max(0.0, launch)),
+                          static_cast<float>(tof), sol.controls);
+                if (wraps && hi == 0) {
+                    table.set(table.index(ai, ci, pi, n_heading - 1), 1.0f,
+                              static_cast<float>(std::max(0.0, launch)), static_cast<float>(tof),
+                              sol.controls);
+                }
+                return;
+            }
+        }
+    };
+
+    pool.parallel_for(axes.altitude.size() * axes.cross_range.size() * axes.time_to_pass.size()
+                      * solved_headings, search);
+    return table;
+}
+
+sim::LaunchTrajectorySolution refine_intercept(const InterceptTable& table,
+                                               const sim::LaunchSite& site, double epoch_jd,
+                                               const sim::StateVector& threat) {
+    const InterceptWeapon& weapon = table.weapon();
+    const InterceptGeometry g = intercept_geometry(site.compute_eci_state(epoch_jd).position,
+                                                   threat.position, threat.velocity);
+    const InterceptLookup x = table.lookup(g);
+    if (x.feasibility < InterceptTable::SHOOT_FEASIBILITY) {
+        sim::LaunchTrajectorySolution none;
+        none.converged = false;
+        none.iterations = 0;
+        none.residual_norm = 0.0;
+        none.status = "Outside the intercept table";
+        none.controls = table.seed(g);
+        return none;
+    }
+
+    sim::LaunchSolverConfig config;
+    config.num_threads = 1;
+    for (int i = 0; i < sim::LaunchControls::N_CONTROLS; i++) config.free_controls[i] = false;
+    for (int i = 0; i <= 6; i++) config.free_controls[i] = true;
+    config.free_controls[12] = true;
+    sim::LaunchTrajectorySolver solver(weapon.vehicle, site, epoch_jd, config);
+
+    sim::TerminalTarget target;
+    target.mode = sim::TargetingMode::POSITION_INTERCEPT;
+    target.target_state_epoch = threat;
+    target.time_of_flight = x.tof;
+    sim::LaunchControls guess = table.seed(g);
+    guess.coast_after_burnout = std::max(0.0, x.tof - solver.performance()->total_burn());
+    guess.epoch_offset = x.launch_delay;
+    return solver.solve(target, &guess);
+}
+
+} // namespace sim::mc
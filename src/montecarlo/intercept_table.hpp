@@ -0,0 +1,181 @@
+/**
+ * Intercept tables — precomputed direct-ascent solutions against orbital
+ * threats (".ixt").
+ *
+ * LaunchTrajectorySolver finds the steering that puts a launch vehicle on
+ * a satellite (launch_intercept_demo), but a solve costs tens of
+ * milliseconds and converges only from a nearby start: far too slow and
+ * fragile for an engagement decision inside a Monte Carlo tick.
+ * generate_intercept() runs it offline over a grid of pass geometries for
+ * one vehicle and site latitude and keeps, per cell, whether an intercept
+ * exists, the earliest launch that makes one, its time of flight and the
+ * converged steering. At runtime a battery reads them by quadrilinear
+ * interpolation, O(1) per decision; refine_intercept() turns a lookup into
+ * a full solve, seeded from the table, when an exact trajectory is wanted.
+ *
+ * The threat is taken on a circular orbit, described by its pass over the
+ * site (grid axes, each increasing):
+ *   altitude      orbit altitude over the mean-radius sphere [m]
+ *   cross_range   ground distance from the site to the track at closest
+ *                 approach [m], positive with the site left of the track
+ *   time_to_pass  time until that closest approach [s], negative once past
+ *   heading       track direction at closest approach, seen from the site
+ *                 [deg from north, 0-360]
+ * Site longitude and epoch drop out (the Earth turns uniformly under an
+ * axisymmetric field), so a table serves every site at its latitude.
+ *
+ * Generation. The vehicle burns every stage out and coasts to the
+ * intercept, so the time of flight fixes its coast. A fan of steering
+ * profiles (launch azimuth x stage pitch rates) is flown once. For each
+ * cell the generator walks launch delays from 0 in DELAY_STEP and, per
+ * delay, times of flight in TOF_STEP, until the threat passes within
+ * FAN_MARGIN of a fan trajectory at the same time after launch. That
+ * profile seeds a solve with azimuth, pitch and launch time free (the
+ * target keeps its own timing, see TerminalTarget); the first converged
+ * solve that launches at or after the decision sets the cell. A cell with
+ * none by max_delay is infeasible.
+ *
+ * Lookups blend the 16 corners: feasibility linearly, launch delay and time
+ * of flight over the feasible corners only, so an infeasible neighbour
+ * does not drag them toward 0.
+ *
+ * File layout (little-endian, as written by the host):
+ *   "IXTB" u32 version, u32 name length, name bytes, f64 site latitude,
+ *   f64 max_delay, f64 max_tof, u32 stages, per stage 5 x f64 (dry mass,
+ *   propellant, thrust, Isp sea level, Isp vacuum), f64 payload, f64 drag
+ *   coefficient, f64 reference area, 4 x (u32 n, n x f64) axes,
+ *   cells x f32 feasibility, cells x f32 launch delay, cells x f32 time of
+ *   flight, cells x 7 f32 steering (azimuth, pitch_s1[3], pitch_s2[3])
+ * with cells ordered [altitude][cross_range][time_to_pass][heading].
+ *
+ * WEZLibrary loads the *.ixt files of its directory beside the *.wez ones;
+ * a SAM battery whose weapon "wez" names an intercept table engages
+ * orbital targets through it (see SAMBattery).
+ */
+
+#ifndef SIM_MC_INTERCEPT_TABLE_HPP
+#define SIM_MC_INTERCEPT_TABLE_HPP
+
+#include "mc_entity.hpp"
+#include "physics/launch_trajectory_solver.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+class MCWorld;
+
+/** The interceptor a table describes, and how far its generator searches */
+struct InterceptWeapon {
+    std::string name;                 // table key: SAM "wez" name
+    double site_latitude = 28.5623;   // deg
+    sim::SolverVehicleConfig vehicle;
+    double max_delay = 1800.0;        // latest launch searched [s]
+    double max_tof = 1500.0;          // longest flight searched [s]
+};
+
+struct InterceptAxes {
+    std::vector<double> altitude;
+    std::vector<double> cross_range;
+    std::vector<double> time_to_pass;
+    std::vector<double> heading;
+
+    /** Default grid: LEO altitudes, passes within 2500 km and an hour */
+    static InterceptAxes defaults();
+};
+
+/** Pass geometry, as InterceptAxes */
+struct InterceptGeometry {
+    double altitude = 0.0;
+    double cross_range = 0.0;
+    double time_to_pass = 0.0;
+    double heading = 0.0;
+};
+
+struct InterceptLookup {
+    double feasibility = 0.0;     // [0, 1]
+    double launch_delay = 0.0;    // s from the decision, over the feasible corners
+    double tof = 0.0;             // s from launch
+};
+
+class InterceptTable {
+public:
+    static constexpr char MAGIC[4] = {'I', 'X', 'T', 'B'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr double REFERENCE_JD = 2460335.0;   // generator epoch
+    static constexpr double DELAY_STEP = 30.0;          // launch delay search step [s]
+    static constexpr double TOF_STEP = 10.0;            // time of flight search step [s]
+    static constexpr double FAN_MARGIN = 150000.0;      // seed distance from the fan [m]
+    static constexpr double SHOOT_FEASIBILITY = 0.5;    // engagements start at or above this
+
+    InterceptTable() = default;
+    InterceptTable(const InterceptWeapon& weapon, const InterceptAxes& axes);
+
+    const InterceptWeapon& weapon() const { return weapon_; }
+    const InterceptAxes& axes() const { return axes_; }
+    size_t cells() const { return feasibility_.size(); }
+
+    /** Interpolated feasibility, launch delay and time of flight; clamps to the grid */
+    InterceptLookup lookup(const InterceptGeometry& g) const;
+
+    /**
+     * Steering of the feasible corner nearest `g` (coast and epoch offset
+     * zero), to seed a solve; default_guess if no corner is feasible.
+     */
+    sim::LaunchControls seed(const InterceptGeometry& g) const;
+
+    /** Cell (altitude, cross range, time to pass, heading) */
+    size_t index(size_t alt, size_t cross, size_t pass, size_t heading) const {
+        return ((alt * axes_.cross_range.size() + cross) * axes_.time_to_pass.size() + pass)
+               * axes_.heading.size() + heading;
+    }
+    void set(size_t cell, float feasibility, float launch_delay, float tof,
+             const sim::LaunchControls& controls);
+
+    /** @throws std::runtime_error on I/O failure or a malformed file */
+    void write(const std::string& path) const;
+    static InterceptTable read(const std::string& path);
+
+private:
+    static constexpr int STEERING = 7;   // azimuth, pitch_s1[3], pitch_s2[3]
+
+    InterceptWeapon weapon_;
+    InterceptAxes axes_;
+    std::vector<float> feasibility_;
+    std::vector<float> delay_;
+    std::vector<float> tof_;
+    std::vector<float> steering_;
+};
+
+/** Pass geometry of a threat (ECI state) over a site (ECI position), same instant */
+InterceptGeometry intercept_geometry(const Vec3& site_eci, const Vec3& position,
+                                     const Vec3& velocity);
+
+/** Pass geometry of orbital `threat` over battery `site` in `world` */
+InterceptGeometry intercept_geometry(MCWorld& world, EntityHandle site, EntityHandle threat);
+
+/** The circular-orbit threat state (ECI) with pass geometry `g` over `site_eci` */
+sim::StateVector intercept_threat_state(const Vec3& site_eci, const InterceptGeometry& g);
+
+/**
+ * Search every cell of `axes` for `weapon` (see the file comment),
+ * `num_threads` workers (0 = all cores).
+ */
+InterceptTable generate_intercept(const InterceptWeapon& weapon, const InterceptAxes& axes,
+                                  int num_threads = 0);
+
+/**
+ * Full solve for `threat` (ECI state at epoch_jd) from `site`, seeded with
+ * the table's launch delay, time of flight and steering. The launch time
+ * stays free: the solution's controls.epoch_offset is the launch delay
+ * after epoch_jd, and burn plus coast its time of flight. Not converged
+ * (status says why) if the table finds the geometry infeasible.
+ */
+sim::LaunchTrajectorySolution refine_intercept(const InterceptTable& table,
+                                               const sim::LaunchSite& site, double epoch_jd,
+                                               const sim::StateVector& threat);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_INTERCEPT_TABLE_HPP
@@ -4,6 +4,15 @@
  * Wraps the existing OrbitalMechanics class for tick-based propagation.
  * Mirrors the JS orbital_2body component's propagation logic:
  *   state_to_elements → advance mean anomaly → solve Kepler → elements_to_state
+ *
+ * KeplerBatch is the cached fast path: it keeps perifocal coefficients per
+ * coasting entity in structure-of-arrays form and advances every lane with
+ * one branch-free Newton loop, reloading a lane only after its velocity
+ * changes (MCEntity::orbit_dirty). Lanes may also run behind world time
+ * (multi-rate coasting) and are caught up exactly on demand. In lockstep
+ * mode one batch holds the same orbital entities of K worlds, interleaved
+ * [entity][world], and advance_steps_lockstep() keeps each world's Newton
+ * convergence separate so every world gets the bits it would alone.
  */
 
 #ifndef SIM_MC_KEPLER_PROPAGATOR_HPP
@@ -12,7 +21,10 @@
 #include "mc_entity.hpp"
 #include "physics/orbital_elements.hpp"
 #include "physics/vec3_ops.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace sim::mc {
 
@@ -117,6 +129,213 @@ inline void propagate_kepler(sim::Vec3& pos, sim::Vec3& vel, double dt) {
     }
 }
 
+/**
+ * Cached closed-form Kepler propagation for many elliptic orbits at once.
+ *
+ * Each lane stores the orbit as r = a(cos E - e) P + b sin E Q with P the
+ * periapsis direction and Q = h_hat x P, so a step is an eccentric-anomaly
+ * solve plus a handful of multiply-adds — no element round-trip. Lanes that
+ * are not loaded hold a frozen circular orbit (n = 0) so advance() needs no
+ * per-lane branches.
+ *
+ * Results agree with propagate_kepler() to solver tolerance but are not
+ * bit-identical, so MCRunner only uses it when MCConfig::cached_kepler is set.
+ */
+struct KeplerBatch {
+    std::vector<double> a, e, b, n;        // sma, ecc, semi-minor, mean motion
+    std::vector<double> vmax;              // periapsis speed [m/s]
+    std::vector<double> M, E;              // mean / eccentric anomaly [rad]
+    std::vector<double> px, py, pz;        // periapsis unit vector
+    std::vector<double> qx, qy, qz;        // in-plane normal to P
+    std::vector<double> lag;               // seconds behind world time
+    std::vector<double> step;              // per-lane dt for advance_steps()
+    std::vector<uint8_t> valid;            // lane holds a loaded orbit
+
+    size_t size() const { return valid.size(); }
+
+    /** Resize to `count` lanes, all unloaded. */
+    void reset(size_t count) {
+        for (auto* v : {&a, &e, &b, &n, &vmax, &M, &E, &px, &py, &pz, &qx, &qy, &qz,
+                        &lag, &step}) {
+            v->assign(count, 0.0);
+        }
+        valid.assign(count, 0);
+    }
+
+    /** Mark a lane unloaded (state changed outside the propagator). */
+    void invalidate(size_t k) {
+        valid[k] = 0;
+        n[k] = 0.0;
+        vmax[k] = 0.0;
+        e[k] = 0.0;
+        M[k] = E[k] = 0.0;
+        lag[k] = 0.0;
+    }
+
+    /**
+     * Load lane k from an ECI state. Returns false (lane left unloaded) for
+     * the degenerate, rectilinear and unbound cases that propagate_kepler()
+     * handles by its own fallbacks.
+     */
+    bool load(size_t k, const sim::Vec3& pos, const sim::Vec3& vel) {
+        invalidate(k);
+        constexpr double MU = sim::OrbitalMechanics::MU_EARTH;
+
+        double r_mag = pos.norm();
+        double v_mag = vel.norm();
+        if (r_mag < 1000.0 || v_mag < 0.1) return false;
+
+        sim::Vec3 h = cross(pos, vel);
+        double h_mag = h.norm();
+        if (h_mag < 1e3) return false;
+
+        double energy = 0.5 * v_mag * v_mag - MU / r_mag;
+        double sma = -MU / (2.0 * energy);
+        if (!std::isfinite(sma) || sma <= 0.0) return false;
+
+        // Eccentricity vector points at periapsis
+        double rv = dot(pos, vel);
+        sim::Vec3 ev = (pos * (v_mag * v_mag - MU / r_mag) - vel * rv) * (1.0 / MU);
+        double ecc = ev.norm();
+        if (ecc >= 1.0) return false;
+
+        // Near-circular: periapsis is undefined, measure from the current radius
+        sim::Vec3 p_hat = ecc > 1e-10 ? ev * (1.0 / ecc) : pos * (1.0 / r_mag);
+        if (ecc <= 1e-10) ecc = 0.0;
+        sim::Vec3 q_hat = cross(h * (1.0 / h_mag), p_hat);
+
+        double fac = std::sqrt(1.0 - ecc * ecc);
+        double semi_minor = sma * fac;
+        double E0 = std::atan2(dot(pos, q_hat) / semi_minor,
+                               dot(pos, p_hat) / sma + ecc);
+
+        a[k] = sma;
+        e[k] = ecc;
+        b[k] = semi_minor;
+        n[k] = std::sqrt(MU / (sma * sma * sma));
+        vmax[k] = n[k] * sma * std::sqrt((1.0 + ecc) / (1.0 - ecc));
+        E[k] = E0;
+        M[k] = E0 - ecc * std::sin(E0);
+        px[k] = p_hat.x; py[k] = p_hat.y; pz[k] = p_hat.z;
+        qx[k] = q_hat.x; qy[k] = q_hat.y; qz[k] = q_hat.z;
+        valid[k] = 1;
+        return true;
+    }
+
+    /** Advance every lane by dt seconds (unloaded lanes stay put). */
+    void advance(double dt) {
+        step.assign(size(), dt);
+        advance_steps();
+    }
+
+    /** Advance lane k by step[k] seconds; zero-step lanes stay put. */
+    void advance_steps() {
+        constexpr double TWO_PI = 2.0 * M_PI;
+        const size_t count = size();
+
+        for (size_t k = 0; k < count; k++) {
+            double m = M[k] + n[k] * step[k];
+            m -= TWO_PI * std::floor(m / TWO_PI);
+            // Warm start: E advances at roughly the mean rate for short
+            // steps; long catch-up jumps restart from the usual M + e sin M
+            double shift = m - M[k];
+            M[k] = m;
+            E[k] = std::abs(shift) < 0.5 ? E[k] + shift : m + e[k] * std::sin(m);
+        }
+
+        // Newton on E - e sin E = M, all lanes per iteration
+        for (int iter = 0; iter < 12; iter++) {
+            double worst = 0.0;
+            for (size_t k = 0; k < count; k++) {
+                double f = E[k] - e[k] * std::sin(E[k]) - M[k];
+                double step = f / (1.0 - e[k] * std::cos(E[k]));
+                E[k] -= step;
+                worst = std::max(worst, std::abs(step));
+            }
+            if (worst < 1e-12) break;
+        }
+    }
+
+    /**
+     * advance_steps() over lanes interleaved from K worlds (lane k belongs
+     * to world k % K). Each world stops iterating when its own lanes have
+     * converged, exactly as its own batch would; worlds with live[w] == 0
+     * are left as they are.
+     */
+    void advance_steps_lockstep(size_t K, const uint8_t* live) {
+        constexpr double TWO_PI = 2.0 * M_PI;
+        constexpr size_t MAX_K = 64;
+        const size_t count = size();
+        if (K == 0 || K > MAX_K || count % K != 0) return;
+
+        for (size_t k = 0; k < count; k++) {
+            if (!live[k % K]) continue;
+            double m = M[k] + n[k] * step[k];
+            m -= TWO_PI * std::floor(m / TWO_PI);
+            double shift = m - M[k];
+            M[k] = m;
+            E[k] = std::abs(shift) < 0.5 ? E[k] + shift : m + e[k] * std::sin(m);
+        }
+
+        uint8_t going[MAX_K];
+        for (size_t w = 0; w < K; w++) going[w] = live[w];
+
+        for (int iter = 0; iter < 12; iter++) {
+            double worst[MAX_K] = {};
+            for (size_t base = 0; base < count; base += K) {
+                for (size_t w = 0; w < K; w++) {
+                    if (!going[w]) continue;
+                    size_t k = base + w;
+                    double f = E[k] - e[k] * std::sin(E[k]) - M[k];
+                    double stp = f / (1.0 - e[k] * std::cos(E[k]));
+                    E[k] -= stp;
+                    worst[w] = std::max(worst[w], std::abs(stp));
+                }
+            }
+            bool any = false;
+            for (size_t w = 0; w < K; w++) {
+                if (going[w] && worst[w] < 1e-12) going[w] = 0;
+                any = any || going[w];
+            }
+            if (!any) break;
+        }
+    }
+
+    /** Advance a single lagging lane to world time (on-demand catch-up). */
+    void catch_up(size_t k) {
+        constexpr double TWO_PI = 2.0 * M_PI;
+        double m = M[k] + n[k] * lag[k];
+        m -= TWO_PI * std::floor(m / TWO_PI);
+        double shift = m - M[k];
+        M[k] = m;
+        double ek = std::abs(shift) < 0.5 ? E[k] + shift : m + e[k] * std::sin(m);
+        for (int iter = 0; iter < 12; iter++) {
+            double stp = (ek - e[k] * std::sin(ek) - m) / (1.0 - e[k] * std::cos(ek));
+            ek -= stp;
+            if (std::abs(stp) < 1e-12) break;
+        }
+        E[k] = ek;
+        lag[k] = 0.0;
+    }
+
+    /** ECI state of a loaded lane. */
+    void state(size_t k, sim::Vec3& pos, sim::Vec3& vel) const {
+        double cE = std::cos(E[k]);
+        double sE = std::sin(E[k]);
+        double xp = a[k] * (cE - e[k]);
+        double yp = b[k] * sE;
+        double rate = n[k] / (1.0 - e[k] * cE);   // dE/dt
+        double vxp = -a[k] * sE * rate;
+        double vyp = b[k] * cE * rate;
+        pos = sim::Vec3(xp * px[k] + yp * qx[k],
+                        xp * py[k] + yp * qy[k],
+                        xp * pz[k] + yp * qz[k]);
+        vel = sim::Vec3(vxp * px[k] + vyp * qx[k],
+                        vxp * py[k] + vyp * qy[k],
+                        vxp * pz[k] + vyp * qz[k]);
+    }
+};
+
 } // namespace sim::mc
 
 #endif // SIM_MC_KEPLER_PROPAGATOR_HPP
@@ -1,14 +1,15 @@
 #include "montecarlo/kinetic_kill.hpp"
 #include "physics/vec3_ops.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace sim::mc {
 
 void KineticKill::update_all(double dt, MCWorld& world) {
-    for (auto& entity : world.entities()) {
-        if (!entity.has_weapon) continue;
-        if (!entity.active || entity.destroyed) continue;
-        update_entity(entity, dt, world);
+    auto& entities = world.entities();
+    for (uint32_t i : world.any_weapon()) {
+        if (!world.alive(i)) continue;
+        update_entity(entities[i], dt, world);
     }
 }
 
@@ -19,15 +20,27 @@ void KineticKill::update_entity(MCEntity& entity, double dt, MCWorld& world) {
         if (entity.cooldown_timer <= 0.0) {
             entity.cooldown_timer = 0.0;
         }
+        entity.kk_last_rel.time = -1.0;
         return;
     }
 
-    // Check if AI has designated a target
-    if (entity.kk_target_id.empty()) return;
+    // Check if AI has designated a target. With swept contact the weapon
+    // also watches the target under pursuit: a pass inside the AI's kill
+    // range within the tick designates it, though neither tick end did.
+    EntityHandle target_h = entity.kk_target;
+    const bool designated = target_h != NO_ENTITY;
+    if (!designated && world.swept_contact) target_h = entity.current_target;
+    if (target_h == NO_ENTITY) {
+        entity.kk_last_rel.time = -1.0;
+        return;
+    }
 
-    MCEntity* target = world.get_entity(entity.kk_target_id);
+    world.refresh_orbit(world.index_of(entity));
+    world.refresh_orbit(target_h);
+    MCEntity* target = world.get(target_h);
     if (!target || !target->active || target->destroyed) {
-        entity.kk_target_id.clear();
+        entity.kk_target = NO_ENTITY;
+        entity.kk_last_rel.time = -1.0;
         return;
     }
 
@@ -37,60 +50,54 @@ void KineticKill::update_entity(MCEntity& entity, double dt, MCWorld& world) {
     double dz = target->eci_pos.z - entity.eci_pos.z;
     double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
 
+    // Swept contact: range over the whole tick, stamped at closest approach
+    bool in_range = designated && dist <= entity.weapon_kill_range;
+    double contact_time = world.sim_time;
+    if (world.swept_contact) {
+        const double range = designated ? entity.weapon_kill_range
+                                        : std::min(entity.kill_range, entity.weapon_kill_range);
+        RelativeState now{world.sim_time, Vec3(dx, dy, dz), target->eci_vel - entity.eci_vel};
+        const RelativeState& last = entity.kk_last_rel;
+        ClosestApproach ca;
+        if (entity.kk_last_target == target_h && last.time >= 0.0 && last.time < now.time &&
+            closest_approach(last, now, ca, range) && ca.distance <= range) {
+            in_range = true;
+            contact_time = ca.time;
+        }
+        entity.kk_last_rel = now;
+        entity.kk_last_target = target_h;
+        if (!designated && !in_range) return;
+    }
+
     // Log LAUNCH event when first engaging a new target
-    if (entity.kk_target_id != entity.last_launch_target) {
-        entity.last_launch_target = entity.kk_target_id;
-        entity.engagements.push_back({
-            entity.kk_target_id,
-            target->name,
-            "LAUNCH",
-            world.sim_time
-        });
+    if (target_h != entity.last_launch_target) {
+        entity.last_launch_target = target_h;
+        world.log_engagement(entity, target_h, EngagementResult::LAUNCH, contact_time);
     }
 
     // Check if within kill range
-    if (dist <= entity.weapon_kill_range) {
+    if (in_range) {
         // Pk roll using seeded RNG
-        bool hit = world.rng.bernoulli(entity.pk);
+        bool hit = world.rng.bernoulli(entity.pk, world.index_of(entity));
 
         if (hit) {
             // KILL — mutual destruction
 
             // Destroy target
-            target->active = false;
-            target->destroyed = true;
-
-            // Log KILLED_BY on target
-            target->engagements.push_back({
-                entity.id,
-                entity.name,
-                "KILLED_BY",
-                world.sim_time
-            });
+            world.kill(*target);
 
             // Destroy self (kinetic kill is sacrificial)
-            entity.active = false;
-            entity.destroyed = true;
+            world.kill(entity);
 
-            // Log engagement on attacker
-            entity.engagements.push_back({
-                entity.kk_target_id,
-                target->name,
-                "KILL",
-                world.sim_time
-            });
+            // Log the kill
+            world.log_engagement(entity, world.index_of(*target), EngagementResult::KILL,
+                                 contact_time);
         } else {
-            // MISS — enter cooldown
+            // Log miss, then enter cooldown
+            world.log_engagement(entity, world.index_of(*target), EngagementResult::MISS,
+                                 contact_time);
             entity.cooldown_timer = entity.cooldown_time;
-            entity.kk_target_id.clear();
-
-            // Log miss
-            entity.engagements.push_back({
-                entity.kk_target_id.empty() ? entity.last_launch_target : entity.kk_target_id,
-                target->name,
-                "MISS",
-                world.sim_time
-            });
+            entity.kk_target = NO_ENTITY;
         }
     }
 }
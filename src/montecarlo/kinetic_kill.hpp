@@ -3,6 +3,14 @@
  *
  * Direct port of js/components/weapons/kinetic_kill.js.
  * Uses world.rng for deterministic Pk rolls in MC mode.
+ *
+ * With world.swept_contact (MCConfig::swept_contact) range is tested over
+ * the whole tick: the pair's relative ECI state from the previous tick and
+ * this one bound a Hermite path, and a closest approach inside range
+ * counts, stamping LAUNCH / KILL / MISS with its time. The weapon then also
+ * watches the AI's pursued target, so a pass through kill range between
+ * two ticks engages although the AI saw it at neither. Without it only
+ * tick ends are tested, as in the JS engine.
  */
 
 #ifndef SIM_MC_KINETIC_KILL_HPP
@@ -0,0 +1,467 @@
+#include "montecarlo/mc_aggregate.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sim::mc {
+
+void wilson_interval(int64_t k, int64_t n, double& lo, double& hi) {
+    if (n <= 0) {
+        lo = 0.0;
+        hi = 1.0;
+        return;
+    }
+    constexpr double Z = 1.959963984540054;  // 95% two-sided
+    double nn = static_cast<double>(n);
+    double p = static_cast<double>(k) / nn;
+    double z2 = Z * Z;
+    double denom = 1.0 + z2 / nn;
+    double center = (p + z2 / (2.0 * nn)) / denom;
+    double half = Z * std::sqrt(p * (1.0 - p) / nn + z2 / (4.0 * nn * nn)) / denom;
+    lo = std::max(0.0, center - half);
+    hi = std::min(1.0, center + half);
+}
+
+MCAggregator::MCAggregator(double max_sim_time)
+    : max_sim_time_(max_sim_time > 0.0 ? max_sim_time : 1.0),
+      bin_width_((max_sim_time > 0.0 ? max_sim_time : 1.0) / TIME_BINS),
+      time_bins_(TIME_BINS, 0) {}
+
+void MCAggregator::add(const RunResult& run) {
+    runs_++;
+    if (!run.error.empty()) {
+        errors_++;
+        return;
+    }
+
+    // ── Survival ──
+    for (const auto& [id, surv] : run.entity_survival) {
+        auto it = entities_.find(id);
+        if (it == entities_.end()) {
+            EntityStats s;
+            s.name = surv.name;
+            s.team = surv.team;
+            s.type = surv.type;
+            s.role = surv.role;
+            it = entities_.emplace(id, std::move(s)).first;
+        }
+        if (surv.alive) it->second.survived++;
+        if (surv.destroyed) it->second.destroyed++;
+    }
+
+    // ── Kill chains ──
+    for (const auto& evt : run.engagement_log) {
+        WeaponStats& w = weapons_[evt.weapon_type];
+        if (evt.result == "LAUNCH") {
+            w.launches++;
+        } else if (evt.result == "MISS") {
+            w.misses++;
+        } else if (evt.result == "KILL") {
+            w.kills++;
+            auto victim = run.entity_survival.find(evt.target_id);
+            const std::string& victim_team =
+                victim != run.entity_survival.end() ? victim->second.team : evt.target_id;
+            w.kill_matrix[evt.source_team][victim_team]++;
+        }
+    }
+
+    // ── Time to resolution ──
+    double t = run.sim_time_final;
+    int64_t n = successes();
+    if (n == 1) {
+        t_min_ = t_max_ = t;
+    } else {
+        t_min_ = std::min(t_min_, t);
+        t_max_ = std::max(t_max_, t);
+    }
+    t_sum_ += t;
+    int bin = static_cast<int>(std::floor(t / bin_width_));
+    bin = std::max(0, std::min(TIME_BINS - 1, bin));
+    time_bins_[bin]++;
+}
+
+void MCAggregator::merge(const MCAggregator& other) {
+    int64_t n = successes();
+    int64_t m = other.successes();
+    runs_ += other.runs_;
+    errors_ += other.errors_;
+
+    for (const auto& [id, s] : other.entities_) {
+        auto it = entities_.find(id);
+        if (it == entities_.end()) {
+            entities_.emplace(id, s);
+            continue;
+        }
+        it->second.survived += s.survived;
+        it->second.destroyed += s.destroyed;
+    }
+
+    for (const auto& [type, ws] : other.weapons_) {
+        WeaponStats& w = weapons_[type];
+        w.launches += ws.launches;
+        w.kills += ws.kills;
+        w.misses += ws.misses;
+        for (const auto& [shooter, row] : ws.kill_matrix) {
+            for (const auto& [victim, count] : row) {
+                w.kill_matrix[shooter][victim] += count;
+            }
+        }
+    }
+
+    if (m > 0) {
+        t_min_ = n > 0 ? std::min(t_min_, other.t_min_) : other.t_min_;
+        t_max_ = n > 0 ? std::max(t_max_, other.t_max_) : other.t_max_;
+    }
+    t_sum_ += other.t_sum_;
+    for (int b = 0; b < TIME_BINS; b++) time_bins_[b] += other.time_bins_[b];
+}
+
+void MCAggregator::write_state(sim::JsonWriter& w) const {
+    w.begin_object();
+    w.kv("runs", runs_);
+    w.kv("errors", errors_);
+    w.kv("tSum", t_sum_);
+    w.kv("tMin", t_min_);
+    w.kv("tMax", t_max_);
+
+    w.key("entities").begin_object();
+    for (const auto& [id, s] : entities_) {
+        w.key(id).begin_array();
+        w.value(s.name).value(s.team).value(s.type).value(s.role);
+        w.value(s.survived).value(s.destroyed);
+        w.end_array();
+    }
+    w.end_object();
+
+    w.key("weapons").begin_object();
+    for (const auto& [type, ws] : weapons_) {
+        w.key(type).begin_array();
+        w.value(ws.launches).value(ws.kills).value(ws.misses);
+        w.begin_object();
+        for (const auto& [shooter, row] : ws.kill_matrix) {
+            w.key(shooter).begin_object();
+            for (const auto& [victim, count] : row) w.kv(victim, count);
+            w.end_object();
+        }
+        w.end_object();
+        w.end_array();
+    }
+    w.end_object();
+
+    w.key("bins").begin_array();
+    for (int b = 0; b < TIME_BINS; b++) {
+        if (time_bins_[b] == 0) continue;
+        w.value(b).value(time_bins_[b]);
+    }
+    w.end_array();
+    w.end_object();
+}
+
+MCAggregator MCAggregator::read_state(const sim::JsonValue& state, double max_sim_time) {
+    auto count = [](const sim::JsonValue& v) {
+        return static_cast<int64_t>(v.get_number(0.0));
+    };
+
+    MCAggregator agg(max_sim_time);
+    agg.runs_ = count(state["runs"]);
+    agg.errors_ = count(state["errors"]);
+    agg.t_sum_ = state["tSum"].get_number(0.0);
+    agg.t_min_ = state["tMin"].get_number(0.0);
+    agg.t_max_ = state["tMax"].get_number(0.0);
+
+    if (state["entities"].is_object()) {
+        for (const auto& [id, row] : state["entities"].as_object()) {
+            EntityStats s;
+            s.name = row[0].get_string("");
+            s.team = row[1].get_string("");
+            s.type = row[2].get_string("");
+            s.role = row[3].get_string("");
+            s.survived = count(row[4]);
+            s.destroyed = count(row[5]);
+            agg.entities_.emplace(std::string(id), std::move(s));
+        }
+    }
+
+    if (state["weapons"].is_object()) {
+        for (const auto& [type, row] : state["weapons"].as_object()) {
+            WeaponStats& w = agg.weapons_[std::string(type)];
+            w.launches = count(row[0]);
+            w.kills = count(row[1]);
+            w.misses = count(row[2]);
+            if (!row[3].is_object()) continue;
+            for (const auto& [shooter, victims] : row[3].as_object()) {
+                auto& out = w.kill_matrix[std::string(shooter)];
+                for (const auto& [victim, n] : victims.as_object()) {
+                    out[std::string(victim)] = count(n);
+                }
+            }
+        }
+    }
+
+    const sim::JsonValue& bins = state["bins"];
+    for (size_t i = 0; i + 1 < bins.size(); i += 2) {
+        int b = bins[i].get_int(-1);
+        if (b < 0 || b >= TIME_BINS) throw std::runtime_error("Aggregate state: bad time bin");
+        agg.time_bins_[b] = count(bins[i + 1]);
+    }
+    return agg;
+}
+
+double MCAggregator::time_mean() const {
+    int64_t n = successes();
+    return n > 0 ? t_sum_ / static_cast<double>(n) : 0.0;
+}
+
+double MCAggregator::time_quantile(double q) const {
+    int64_t n = successes();
+    if (n <= 0) return 0.0;
+    q = std::max(0.0, std::min(1.0, q));
+
+    double target = q * static_cast<double>(n);
+    int64_t cum = 0;
+    for (int b = 0; b < TIME_BINS; b++) {
+        int64_t c = time_bins_[b];
+        if (c > 0 && static_cast<double>(cum + c) >= target) {
+            double frac = (target - static_cast<double>(cum)) / static_cast<double>(c);
+            double v = (b + frac) * bin_width_;
+            return std::max(t_min_, std::min(t_max_, v));
+        }
+        cum += c;
+    }
+    return t_max_;
+}
+
+void MCAggregator::write_json(std::ostream& out, int num_runs, int base_seed,
+                              const ConvergenceReport* convergence,
+                              const VarianceReport* variance) const {
+    sim::JsonWriter w(out);
+    write_json(w, num_runs, base_seed, convergence, variance);
+    out << '\n';
+}
+
+void MCAggregator::write_json(sim::JsonWriter& w, int num_runs, int base_seed,
+                              const ConvergenceReport* convergence,
+                              const VarianceReport* variance) const {
+    int64_t n = successes();
+
+    w.begin_object();
+
+    // ── config ──
+    w.key("config").begin_object();
+    w.kv("numRuns", num_runs);
+    w.kv("baseSeed", base_seed);
+    w.kv("maxSimTime", max_sim_time_);
+    w.end_object();
+
+    w.kv("runs", static_cast<size_t>(runs_));
+    w.kv("errors", static_cast<size_t>(errors_));
+
+    // ── entities ──
+    std::vector<const std::string*> ids;
+    ids.reserve(entities_.size());
+    for (const auto& kv : entities_) ids.push_back(&kv.first);
+    std::sort(ids.begin(), ids.end(),
+              [](const std::string* a, const std::string* b) { return *a < *b; });
+
+    w.key("entities").begin_object();
+    for (const std::string* id : ids) {
+        const EntityStats& s = entities_.at(*id);
+        double lo, hi;
+        wilson_interval(s.survived, n, lo, hi);
+
+        w.key(*id).begin_object();
+        w.kv("name", s.name);
+        w.kv("team", s.team);
+        w.kv("type", s.type);
+        if (s.role.empty()) {
+            w.key("role").null_value();
+        } else {
+            w.kv("role", s.role);
+        }
+        w.kv("survived", static_cast<size_t>(s.survived));
+        w.kv("destroyed", static_cast<size_t>(s.destroyed));
+        w.kv("pSurvive", n > 0 ? static_cast<double>(s.survived) / n : 0.0);
+        w.kv("wilsonLow", lo);
+        w.kv("wilsonHigh", hi);
+        w.end_object();
+    }
+    w.end_object();
+
+    // ── weapons ──
+    w.key("weapons").begin_object();
+    for (const auto& [type, ws] : weapons_) {
+        w.key(type).begin_object();
+        w.kv("launches", static_cast<size_t>(ws.launches));
+        w.kv("kills", static_cast<size_t>(ws.kills));
+        w.kv("misses", static_cast<size_t>(ws.misses));
+        w.key("killMatrix").begin_object();
+        for (const auto& [shooter, row] : ws.kill_matrix) {
+            w.key(shooter).begin_object();
+            for (const auto& [victim, count] : row) {
+                w.kv(victim, static_cast<size_t>(count));
+            }
+            w.end_object();
+        }
+        w.end_object();
+        w.end_object();
+    }
+    w.end_object();
+
+    // ── timeFinal ──
+    w.key("timeFinal").begin_object();
+    w.kv("mean", time_mean());
+    w.kv("min", t_min_);
+    w.kv("max", t_max_);
+    w.kv("p05", time_quantile(0.05));
+    w.kv("p25", time_quantile(0.25));
+    w.kv("p50", time_quantile(0.50));
+    w.kv("p75", time_quantile(0.75));
+    w.kv("p95", time_quantile(0.95));
+    w.kv("binWidth", bin_width_);
+    // Trailing empty bins are omitted
+    int last = TIME_BINS - 1;
+    while (last > 0 && time_bins_[last] == 0) last--;
+    w.key("histogram").begin_array();
+    for (int b = 0; b <= last; b++) w.value(static_cast<size_t>(time_bins_[b]));
+    w.end_array();
+    w.end_object();
+
+    if (convergence && convergence->enabled) {
+        w.key("convergence");
+        convergence->write_json(w);
+    }
+    if (variance && variance->enabled()) {
+        w.key("varianceReduction");
+        variance->write_json(w);
+    }
+
+    w.end_object();
+}
+
+AggregateResultsWriter::AggregateResultsWriter(std::ostream& out, int num_runs,
+                                               int base_seed, double max_sim_time)
+    : out_(out), num_runs_(num_runs), base_seed_(base_seed), agg_(max_sim_time) {}
+
+void AggregateResultsWriter::finish() {
+    agg_.write_json(out_, num_runs_, base_seed_, &convergence_, &variance_);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Progressive snapshots
+// ═══════════════════════════════════════════════════════════════
+
+AggregateSnapshots::AggregateSnapshots(std::ostream& out, int every_runs,
+                                       double every_seconds, int total_runs)
+    : out_(out), every_runs_(every_runs), every_seconds_(every_seconds),
+      total_runs_(total_runs), start_(std::chrono::steady_clock::now()),
+      last_time_(start_), last_bins_(SNAPSHOT_BINS, 0) {}
+
+void AggregateSnapshots::update(const MCAggregator& agg) {
+    if (agg.runs() == last_runs_) return;
+    bool due = every_runs_ > 0 && agg.runs() - last_runs_ >= every_runs_;
+    if (!due && every_seconds_ > 0.0) {
+        auto now = std::chrono::steady_clock::now();
+        due = std::chrono::duration<double>(now - last_time_).count() >= every_seconds_;
+    }
+    if (due) write(agg);
+}
+
+void AggregateSnapshots::finish(const MCAggregator& agg) {
+    if (agg.runs() != last_runs_) write(agg);
+}
+
+void AggregateSnapshots::write(const MCAggregator& agg) {
+    auto now = std::chrono::steady_clock::now();
+    const int64_t n = agg.successes();
+
+    sim::JsonWriter w(out_, sim::JsonWriter::COMPACT);
+    w.set_precision(6);
+    w.begin_object();
+    w.kv("type", "snapshot");
+    w.kv("seq", seq_);
+    w.kv("runs", static_cast<size_t>(agg.runs()));
+    w.kv("total", total_runs_);
+    w.kv("errors", static_cast<size_t>(agg.errors()));
+    w.kv("elapsed", std::chrono::duration<double>(now - start_).count());
+
+    std::vector<const std::string*> ids;
+    for (const auto& kv : agg.entities()) ids.push_back(&kv.first);
+    std::sort(ids.begin(), ids.end(),
+              [](const std::string* a, const std::string* b) { return *a < *b; });
+    w.key("entities").begin_object();
+    for (const std::string* id : ids) {
+        const EntityStats& s = agg.entities().at(*id);
+        double lo, hi;
+        wilson_interval(s.survived, n, lo, hi);
+        w.key(*id).begin_object();
+        if (named_.insert(*id).second) {
+            w.kv("name", s.name);
+            w.kv("team", s.team);
+        }
+        w.kv("survived", static_cast<size_t>(s.survived));
+        w.kv("destroyed", static_cast<size_t>(s.destroyed));
+        w.kv("pSurvive", n > 0 ? static_cast<double>(s.survived) / n : 0.0);
+        w.kv("wilsonLow", lo);
+        w.kv("wilsonHigh", hi);
+        w.end_object();
+    }
+    w.end_object();
+
+    w.key("weapons").begin_object();
+    for (const auto& [type, ws] : agg.weapons()) {
+        auto prev = last_weapons_.find(type);
+        if (prev != last_weapons_.end() && prev->second.launches == ws.launches &&
+            prev->second.kills == ws.kills && prev->second.misses == ws.misses &&
+            prev->second.kill_matrix == ws.kill_matrix) {
+            continue;
+        }
+        w.key(type).begin_object();
+        w.kv("launches", static_cast<size_t>(ws.launches));
+        w.kv("kills", static_cast<size_t>(ws.kills));
+        w.kv("misses", static_cast<size_t>(ws.misses));
+        w.key("killMatrix").begin_object();
+        for (const auto& [shooter, row] : ws.kill_matrix) {
+            w.key(shooter).begin_object();
+            for (const auto& [victim, count] : row) w.kv(victim, static_cast<size_t>(count));
+            w.end_object();
+        }
+        w.end_object();
+        w.end_object();
+        last_weapons_[type] = ws;
+    }
+    w.end_object();
+
+    // Fold the aggregate's fine bins into SNAPSHOT_BINS coarse ones
+    static_assert(MCAggregator::TIME_BINS % SNAPSHOT_BINS == 0);
+    const auto& fine = agg.time_bins();
+    const int per_bin = MCAggregator::TIME_BINS / SNAPSHOT_BINS;
+    w.key("timeFinal").begin_object();
+    w.kv("mean", agg.time_mean());
+    w.kv("min", agg.time_min());
+    w.kv("max", agg.time_max());
+    w.kv("p50", agg.time_quantile(0.50));
+    w.kv("p95", agg.time_quantile(0.95));
+    w.kv("binWidth", agg.max_sim_time() / SNAPSHOT_BINS);
+    w.key("bins").begin_array();
+    for (int b = 0; b < SNAPSHOT_BINS; b++) {
+        int64_t count = 0;
+        for (int k = b * per_bin; k < (b + 1) * per_bin; k++) count += fine[k];
+        if (count == last_bins_[b]) continue;
+        w.value(b);
+        w.value(static_cast<size_t>(count));
+        last_bins_[b] = count;
+    }
+    w.end_array();
+    w.end_object();
+
+    w.end_object();
+    w.flush();
+    out_ << '\n' << std::flush;
+
+    seq_++;
+    last_runs_ = agg.runs();
+    last_time_ = now;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,219 @@
+/**
+ * MCAggregator — Online statistics over a stream of MC runs.
+ *
+ * Folds each RunResult into running totals as it finishes, so a batch can
+ * be summarised without retaining per-run results: memory is
+ * O(entities + weapon types x teams^2 + histogram bins), independent of
+ * run count. Reports what the MC Analysis dashboard derives from the full
+ * results document:
+ *   - per-entity survival counts and probability with a 95% Wilson interval
+ *   - kill-chain counts (LAUNCH / KILL / MISS) and kill matrices
+ *     (shooter team x victim team) per weapon type
+ *   - simTimeFinal mean/min/max and quantiles from a fixed-bin histogram
+ *     over [0, max_sim_time]
+ *
+ * Errored runs are counted but excluded from every statistic.
+ *
+ * Aggregates of disjoint run sets merge() into the aggregate of their
+ * union, and write_state() / read_state() carry the raw totals between
+ * processes (MC sharding): counts and the histogram merge exactly, the
+ * time sum to rounding.
+ *
+ * AggregateSnapshots turns a running aggregate into progress lines
+ * (mc_engine --progress with --snapshot-every / --snapshot-interval), so
+ * a dashboard can draw estimates while the batch runs and the user can
+ * stop it once they have settled.
+ */
+
+#ifndef SIM_MC_MC_AGGREGATE_HPP
+#define SIM_MC_MC_AGGREGATE_HPP
+
+#include "mc_results.hpp"
+#include "io/json_reader.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sim::mc {
+
+struct EntityStats {
+    std::string name;
+    std::string team;
+    std::string type;
+    std::string role;
+    int64_t survived = 0;
+    int64_t destroyed = 0;
+};
+
+struct WeaponStats {
+    int64_t launches = 0;
+    int64_t kills = 0;
+    int64_t misses = 0;
+    // kills[shooter team][victim team]
+    std::map<std::string, std::map<std::string, int64_t>> kill_matrix;
+};
+
+/** 95% Wilson score interval for k successes in n trials. */
+void wilson_interval(int64_t k, int64_t n, double& lo, double& hi);
+
+class MCAggregator {
+public:
+    static constexpr int TIME_BINS = 1000;
+
+    explicit MCAggregator(double max_sim_time);
+
+    /** Fold one finished run into the running statistics. */
+    void add(const RunResult& run);
+
+    /** Fold in another aggregator over the same max_sim_time. */
+    void merge(const MCAggregator& other);
+
+    /**
+     * Compact raw state: { "runs", "errors", "tSum", "tMin", "tMax",
+     * "entities": { id: [name, team, type, role, survived, destroyed] },
+     * "weapons": { type: [launches, kills, misses, {shooter: {victim: n}}] },
+     * "bins": [bin, count, ...] } with only the non-empty bins. Write with
+     * precision 0 for an exact round trip of the time sums.
+     */
+    void write_state(sim::JsonWriter& w) const;
+
+    /** Rebuild an aggregator from write_state() output. */
+    static MCAggregator read_state(const sim::JsonValue& state, double max_sim_time);
+
+    int64_t runs() const { return runs_; }
+    int64_t errors() const { return errors_; }
+    int64_t successes() const { return runs_ - errors_; }
+
+    const std::unordered_map<std::string, EntityStats>& entities() const {
+        return entities_;
+    }
+    const std::map<std::string, WeaponStats>& weapons() const { return weapons_; }
+
+    double max_sim_time() const { return max_sim_time_; }
+    /** simTimeFinal counts in TIME_BINS bins over [0, max_sim_time]. */
+    const std::vector<int64_t>& time_bins() const { return time_bins_; }
+
+    double time_mean() const;
+    double time_min() const { return t_min_; }
+    double time_max() const { return t_max_; }
+
+    /** Approximate q-quantile of simTimeFinal (bin-interpolated). */
+    double time_quantile(double q) const;
+
+    /**
+     * Write the aggregate document:
+     * { "config", "runs", "errors", "entities", "weapons", "timeFinal" }
+     * Entities are keyed by ID in sorted order; probabilities use
+     * successful runs as the denominator.
+     */
+    void write_json(std::ostream& out, int num_runs, int base_seed,
+                    const ConvergenceReport* convergence = nullptr,
+                    const VarianceReport* variance = nullptr) const;
+
+    /** Same document as one value of an enclosing writer. */
+    void write_json(sim::JsonWriter& w, int num_runs, int base_seed,
+                    const ConvergenceReport* convergence = nullptr,
+                    const VarianceReport* variance = nullptr) const;
+
+private:
+    double max_sim_time_;
+    double bin_width_;
+
+    int64_t runs_ = 0;
+    int64_t errors_ = 0;
+
+    std::unordered_map<std::string, EntityStats> entities_;
+    std::map<std::string, WeaponStats> weapons_;
+
+    std::vector<int64_t> time_bins_;
+    double t_sum_ = 0.0;
+    double t_min_ = 0.0;
+    double t_max_ = 0.0;
+};
+
+/**
+ * ResultsWriter that aggregates instead of serialising runs; finish()
+ * writes the aggregate document.
+ */
+class AggregateResultsWriter : public ResultsWriter {
+public:
+    AggregateResultsWriter(std::ostream& out, int num_runs, int base_seed,
+                           double max_sim_time);
+
+    void write_run(const RunResult& run) override { agg_.add(run); }
+    /** Fold in runs aggregated elsewhere (e.g. a resumed checkpoint). */
+    void merge(const MCAggregator& part) { agg_.merge(part); }
+    void set_convergence(const ConvergenceReport& report) override {
+        convergence_ = report;
+    }
+    void set_variance(const VarianceReport& report) override { variance_ = report; }
+    void finish() override;
+
+    const MCAggregator& aggregator() const { return agg_; }
+
+private:
+    std::ostream& out_;
+    int num_runs_;
+    int base_seed_;
+    MCAggregator agg_;
+    ConvergenceReport convergence_;
+    VarianceReport variance_;
+};
+
+/**
+ * Progressive snapshots of a running aggregate, one JSON line each:
+ *   { "type": "snapshot", "seq", "runs", "total", "errors", "elapsed",
+ *     "entities": { id: { "survived", "destroyed", "pSurvive",
+ *                         "wilsonLow", "wilsonHigh", ["name", "team"] } },
+ *     "weapons": { type: { "launches", "kills", "misses", "killMatrix" } },
+ *     "timeFinal": { "mean", "min", "max", "p50", "p95", "binWidth",
+ *                    "bins": [bin, count, ...] } }
+ * Each line is a delta against the previous one: "entities" lists every
+ * entity (their intervals move with every run), but name and team only
+ * on an entity's first appearance; "weapons" lists only weapon types
+ * whose counts changed, and "bins" only the changed bins of a
+ * SNAPSHOT_BINS-bin histogram. Every value is cumulative, so a consumer
+ * merges a snapshot by overwriting what it holds, key by key.
+ */
+class AggregateSnapshots {
+public:
+    static constexpr int SNAPSHOT_BINS = 50;
+
+    /**
+     * @param every_runs Snapshot after this many more runs (0: never by count)
+     * @param every_seconds Snapshot once this much wall time has passed (0: never by time)
+     * @param total_runs Batch size, reported as "total"
+     */
+    AggregateSnapshots(std::ostream& out, int every_runs, double every_seconds,
+                       int total_runs);
+
+    /** Call after each run is folded in; writes a snapshot when one is due. */
+    void update(const MCAggregator& agg);
+
+    /** Final snapshot, if any runs came in since the last one. */
+    void finish(const MCAggregator& agg);
+
+private:
+    std::ostream& out_;
+    int every_runs_;
+    double every_seconds_;
+    int total_runs_;
+    int seq_ = 0;
+    int64_t last_runs_ = 0;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point last_time_;
+    std::unordered_set<std::string> named_;           // Entities already sent with names
+    std::map<std::string, WeaponStats> last_weapons_;
+    std::vector<int64_t> last_bins_;
+
+    void write(const MCAggregator& agg);
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_AGGREGATE_HPP
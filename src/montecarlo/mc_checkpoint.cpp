@@ -0,0 +1,175 @@
+#include "montecarlo/mc_checkpoint.hpp"
+#include "io/json_reader.hpp"
+#include "io/json_writer.hpp"
+#include <cstdio>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+std::string hex64(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+
+const char* rng_name(RNGMode mode) {
+    return mode == RNGMode::PHILOX ? "philox" : "mulberry32";
+}
+
+bool file_exists(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fclose(f);
+    return true;
+}
+
+} // namespace
+
+BatchCheckpoint::BatchCheckpoint(const std::string& path, const MCConfig& config,
+                                 uint64_t scenario_hash, bool per_run, double interval)
+    : path_(path), runs_path_(path + ".runs"), config_(config),
+      scenario_hash_(scenario_hash), per_run_(per_run), interval_(interval),
+      aggregate_(config.max_sim_time),
+      last_flush_(std::chrono::steady_clock::now()) {}
+
+void BatchCheckpoint::open_runs(const std::string& file) {
+    runs_writer_.reset();
+    if (runs_.is_open()) runs_.close();
+    runs_.open(file, std::ios::binary | std::ios::trunc);
+    if (!runs_.is_open()) {
+        throw std::runtime_error("cannot open checkpoint run file: " + file);
+    }
+    runs_writer_ = std::make_unique<BinaryResultsWriter>(
+        runs_, config_.num_runs, config_.base_seed, config_.max_sim_time);
+}
+
+void BatchCheckpoint::check_manifest(const sim::JsonValue& m) const {
+    bool same = m["version"].get_int(0) == VERSION &&
+                m["scenario"].get_string() == hex64(scenario_hash_) &&
+                m["runs"].get_int(-1) == config_.num_runs &&
+                m["firstRun"].get_int(-1) == config_.first_run &&
+                m["seed"].get_int(config_.base_seed + 1) == config_.base_seed &&
+                m["maxTime"].get_number(-1.0) == config_.max_sim_time &&
+                m["dt"].get_number(-1.0) == config_.dt &&
+                m["rng"].get_string() == rng_name(config_.rng_mode) &&
+                m["lhs"].get_bool(!config_.lhs) == config_.lhs &&
+                m["perRun"].get_bool(!per_run_) == per_run_;
+    if (!same) {
+        throw std::runtime_error("checkpoint " + path_ + " belongs to a different batch "
+                                 "(scenario, seeds, run range, time step, RNG or format)");
+    }
+    int done = m["completed"].get_int(-1);
+    if (done < 0 || done > config_.num_runs) {
+        throw std::runtime_error("checkpoint " + path_ + " has an invalid run count");
+    }
+}
+
+int BatchCheckpoint::resume(const std::function<void(RunResult&)>& replay) {
+    if (!file_exists(path_)) {
+        start();
+        return 0;
+    }
+
+    sim::JsonValue m = sim::JsonReader::parse_file(path_);
+    check_manifest(m);
+    const int done = m["completed"].get_int(0);
+
+    aggregate_ = MCAggregator(config_.max_sim_time);
+    if (per_run_) {
+        // Copy the stored prefix to a fresh run file, dropping anything
+        // written after the last manifest, then swap it in
+        std::ifstream in(runs_path_, std::ios::binary);
+        if (!in.is_open()) {
+            throw std::runtime_error("cannot open checkpoint run file: " + runs_path_);
+        }
+        BinaryResultsReader reader(in);
+        const std::string tmp = runs_path_ + ".tmp";
+        open_runs(tmp);
+        RunResult run;
+        for (int i = 0; i < done; i++) {
+            if (!reader.next(run)) {
+                throw std::runtime_error("checkpoint run file ends after " +
+                                         std::to_string(i) + " of " +
+                                         std::to_string(done) + " runs");
+            }
+            runs_writer_->write_run(run);
+            replay(run);
+        }
+        runs_.flush();
+        if (!runs_ || std::rename(tmp.c_str(), runs_path_.c_str()) != 0) {
+            throw std::runtime_error("cannot write checkpoint run file: " + runs_path_);
+        }
+    } else {
+        aggregate_ = MCAggregator::read_state(m["state"], config_.max_sim_time);
+    }
+
+    completed_ = done;
+    last_flush_ = std::chrono::steady_clock::now();
+    return done;
+}
+
+void BatchCheckpoint::start() {
+    completed_ = 0;
+    aggregate_ = MCAggregator(config_.max_sim_time);
+    if (per_run_) open_runs(runs_path_);
+    flush();
+}
+
+void BatchCheckpoint::add(const RunResult& run) {
+    if (per_run_) runs_writer_->write_run(run);
+    else aggregate_.add(run);
+    completed_++;
+
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last_flush_).count() >= interval_) flush();
+}
+
+void BatchCheckpoint::flush() {
+    last_flush_ = std::chrono::steady_clock::now();
+
+    // Runs first, so the manifest never counts a run that is not on disk
+    if (per_run_) {
+        runs_.flush();
+        if (!runs_) throw std::runtime_error("cannot write checkpoint run file: " + runs_path_);
+    }
+
+    const std::string tmp = path_ + ".tmp";
+    std::ofstream out(tmp, std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("cannot write checkpoint: " + tmp);
+    {
+        sim::JsonWriter w(out, 0);
+        w.set_precision(0);
+        w.begin_object();
+        w.kv("version", VERSION);
+        w.kv("scenario", hex64(scenario_hash_));
+        w.kv("runs", config_.num_runs);
+        w.kv("firstRun", config_.first_run);
+        w.kv("seed", config_.base_seed);
+        w.kv("maxTime", config_.max_sim_time);
+        w.kv("dt", config_.dt);
+        w.kv("rng", rng_name(config_.rng_mode));
+        w.kv("lhs", config_.lhs);
+        w.kv("perRun", per_run_);
+        w.kv("completed", completed_);
+        if (!per_run_) {
+            w.key("state");
+            aggregate_.write_state(w);
+        }
+        w.end_object();
+    }
+    out.close();
+    if (!out || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("cannot write checkpoint: " + path_);
+    }
+}
+
+void BatchCheckpoint::remove() {
+    runs_writer_.reset();
+    if (runs_.is_open()) runs_.close();
+    std::remove(path_.c_str());
+    if (per_run_) std::remove(runs_path_.c_str());
+}
+
+} // namespace sim::mc
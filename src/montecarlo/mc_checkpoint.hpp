@@ -0,0 +1,114 @@
+/**
+ * BatchCheckpoint — Resumable MC batches.
+ *
+ * MCRunner delivers results in run-index order, so the completed part of
+ * a batch is always a prefix first_run .. first_run + k - 1. The
+ * checkpoint records k and the results of that prefix in a sidecar file,
+ * rewritten every `interval` seconds while the batch runs; a batch
+ * restarted with resume() replays the stored results into its output and
+ * runs only the remaining seeds (MCConfig::first_run += k).
+ *
+ * Files:
+ *   <path>        Manifest, written to "<path>.tmp" and renamed over:
+ *                 { "version", "scenario" (content hash, hex), "runs",
+ *                   "firstRun", "seed", "maxTime", "dt", "rng", "lhs",
+ *                   "perRun", "completed", "state" }
+ *   <path>.runs   Per-run mode: the completed runs as an .mcrb stream
+ *                 (no end record); runs past "completed" are ignored
+ *
+ * Per-run mode backs --format json and binary, whose outputs list every
+ * run; replayed runs come back through BinaryResultsReader, so a resumed
+ * JSON document differs from an uninterrupted one only in entitySurvival
+ * key order (unordered there anyway). Aggregate mode keeps only the MCAggregator state of the prefix
+ * ("state", write_state format), a few KB for any batch size.
+ *
+ * A manifest that describes a different batch (scenario text, seeds,
+ * run range, time step, RNG) is refused rather than merged. Convergence
+ * early stop and antithetic pairing carry estimator state across the
+ * whole batch and are not supported.
+ */
+
+#ifndef SIM_MC_MC_CHECKPOINT_HPP
+#define SIM_MC_MC_CHECKPOINT_HPP
+
+#include "mc_aggregate.hpp"
+#include "mc_results_bin.hpp"
+#include "scenario_parser.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace sim::mc {
+
+class BatchCheckpoint {
+public:
+    static constexpr int VERSION = 1;
+
+    /**
+     * @param path Manifest file
+     * @param config The whole batch (num_runs, first_run as first launched)
+     * @param scenario_hash ScenarioCache::content_hash() of the scenario text
+     * @param per_run Keep every run (json / binary output) instead of the aggregate
+     * @param interval Seconds between checkpoint writes
+     */
+    BatchCheckpoint(const std::string& path, const MCConfig& config,
+                    uint64_t scenario_hash, bool per_run, double interval = 60.0);
+
+    /**
+     * Load an existing checkpoint of this batch and start recording after
+     * it. Per-run mode hands every stored run to `replay`, in order;
+     * aggregate mode loads aggregate(). No checkpoint file = a fresh start.
+     * @return Runs already completed
+     * @throws std::runtime_error if the checkpoint belongs to another batch
+     *         or is unreadable
+     */
+    int resume(const std::function<void(RunResult&)>& replay);
+
+    /** Start recording from an empty batch, discarding any old checkpoint. */
+    void start();
+
+    /** Record the next completed run; writes the checkpoint when due. */
+    void add(const RunResult& run);
+
+    /**
+     * Write the checkpoint now.
+     * @throws std::runtime_error if the manifest cannot be written
+     */
+    void flush();
+
+    /** Delete the checkpoint files (the batch output is complete). */
+    void remove();
+
+    int completed() const { return completed_; }
+    const std::string& path() const { return path_; }
+
+    /** Aggregate of the completed runs (aggregate mode). */
+    const MCAggregator& aggregate() const { return aggregate_; }
+
+private:
+    std::string path_;
+    std::string runs_path_;
+    MCConfig config_;
+    uint64_t scenario_hash_;
+    bool per_run_;
+    double interval_;
+
+    int completed_ = 0;
+    MCAggregator aggregate_;
+    std::ofstream runs_;
+    std::unique_ptr<BinaryResultsWriter> runs_writer_;
+    std::chrono::steady_clock::time_point last_flush_;
+
+    /** Open a new run file at `file` (per-run mode). */
+    void open_runs(const std::string& file);
+
+    /** @throws std::runtime_error if the manifest is not this batch's */
+    void check_manifest(const sim::JsonValue& m) const;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_CHECKPOINT_HPP
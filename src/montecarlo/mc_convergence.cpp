@@ -0,0 +1,131 @@
+#include "montecarlo/mc_convergence.hpp"
+#include "montecarlo/mc_aggregate.hpp"
+#include "montecarlo/mc_world.hpp"
+#include <algorithm>
+
+namespace sim::mc {
+
+MetricSet::MetricSet(const std::vector<std::string>& specs)
+    : specs_(specs.empty() ? std::vector<std::string>{"hva"} : specs) {}
+
+void MetricSet::resolve(const RunResult& run) {
+    std::vector<std::string> hva_ids;
+    for (const auto& [id, surv] : run.entity_survival) {
+        if (surv.role == "hva") hva_ids.push_back(id);
+    }
+    build(std::move(hva_ids));
+}
+
+void MetricSet::resolve(const MCWorld& world) {
+    std::vector<std::string> hva_ids;
+    for (const auto& e : world.entities()) {
+        if (e.role == CombatRole::HVA) hva_ids.push_back(e.id);
+    }
+    build(std::move(hva_ids));
+}
+
+void MetricSet::build(std::vector<std::string> hva_ids) {
+    // One metric per HVA, in ID order for stable output
+    std::sort(hva_ids.begin(), hva_ids.end());
+    for (const auto& spec : specs_) {
+        if (spec == "hva") {
+            for (const auto& id : hva_ids) {
+                metrics_.push_back({Metric::Kind::SURVIVAL, id, "survival:" + id});
+            }
+        } else if (spec.rfind("survival:", 0) == 0) {
+            std::string id = spec.substr(9);
+            metrics_.push_back({Metric::Kind::SURVIVAL, id, spec});
+        } else if (spec.rfind("win:", 0) == 0) {
+            metrics_.push_back({Metric::Kind::WIN, spec.substr(4), spec});
+        }
+    }
+    resolved_ = true;
+}
+
+bool MetricSet::team_wins(const RunResult& run, const std::string& team) {
+    bool any_role = false;
+    for (const auto& kv : run.entity_survival) {
+        if (!kv.second.role.empty()) { any_role = true; break; }
+    }
+
+    bool team_alive = false;
+    bool other_alive = false;
+    for (const auto& [id, surv] : run.entity_survival) {
+        if (any_role && surv.role.empty()) continue;
+        if (!surv.alive) continue;
+        if (surv.team == team) {
+            team_alive = true;
+        } else if (surv.team != "neutral") {
+            other_alive = true;
+        }
+    }
+    return team_alive && !other_alive;
+}
+
+void MetricSet::evaluate(const RunResult& run, std::vector<int8_t>& out) {
+    if (!run.error.empty()) {
+        out.assign(metrics_.size(), -1);
+        return;
+    }
+    if (!resolved_) resolve(run);
+
+    out.resize(metrics_.size());
+    for (size_t i = 0; i < metrics_.size(); i++) {
+        const Metric& m = metrics_[i];
+        if (m.kind == Metric::Kind::SURVIVAL) {
+            auto it = run.entity_survival.find(m.key);
+            out[i] = it == run.entity_survival.end() ? -1 : (it->second.alive ? 1 : 0);
+        } else {
+            out[i] = team_wins(run, m.key) ? 1 : 0;
+        }
+    }
+}
+
+ConvergenceMonitor::ConvergenceMonitor(const std::vector<std::string>& specs,
+                                       double target_half_width, int min_runs)
+    : metrics_(specs),
+      target_(target_half_width),
+      min_runs_(min_runs) {}
+
+void ConvergenceMonitor::add(const RunResult& run) {
+    if (!run.error.empty()) return;
+    metrics_.evaluate(run, outcomes_);
+    tallies_.resize(metrics_.size());
+    runs_++;
+
+    for (size_t i = 0; i < outcomes_.size(); i++) {
+        if (outcomes_[i] < 0) continue;  // unknown entity
+        tallies_[i].trials++;
+        if (outcomes_[i] > 0) tallies_[i].successes++;
+    }
+}
+
+ConvergenceReport ConvergenceMonitor::report() const {
+    ConvergenceReport r;
+    r.enabled = true;
+    r.runs_completed = runs_;
+    r.target_half_width = target_;
+    r.achieved_half_width = 0.0;
+
+    bool all_within = true;
+    bool any_trials = false;
+    for (size_t i = 0; i < tallies_.size(); i++) {
+        const Tally& t = tallies_[i];
+        MetricEstimate est;
+        est.name = metrics_.name(i);
+        est.successes = t.successes;
+        est.trials = t.trials;
+        est.p = t.trials > 0 ? static_cast<double>(t.successes) / t.trials : 0.0;
+        wilson_interval(t.successes, t.trials, est.lo, est.hi);
+        r.achieved_half_width = std::max(r.achieved_half_width, est.half_width());
+        if (t.trials > 0) any_trials = true;
+        if (est.half_width() > target_) all_within = false;
+        r.metrics.push_back(std::move(est));
+    }
+    if (tallies_.empty()) r.achieved_half_width = 1.0;
+
+    r.converged = any_trials && all_within && runs_ >= min_runs_;
+    return r;
+}
+
+} // namespace sim::mc
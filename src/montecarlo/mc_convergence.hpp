@@ -0,0 +1,104 @@
+/**
+ * ConvergenceMonitor — Confidence-interval stopping rule for MC batches.
+ *
+ * Tracks binary per-run outcomes for a set of metrics and reports when the
+ * 95% Wilson interval of every metric is within a target half-width, so
+ * MCRunner can stop a batch early (MCConfig::ci_half_width). Metric specs:
+ *   "hva"             survival of each HVA entity (role "hva"), one metric
+ *                     per HVA found in the first successful run (or in
+ *                     the scenario, with MetricSet::resolve(world))
+ *   "survival:<id>"   survival of one entity
+ *   "win:<team>"      `team` has a survivor and no other non-neutral team
+ *                     does (counting only role-bearing entities when any
+ *                     exist, all entities otherwise)
+ *
+ * Errored runs are ignored. Checks happen once per block of runs
+ * (MCConfig::ci_block) so the stopping point does not depend on the
+ * thread count.
+ */
+
+#ifndef SIM_MC_MC_CONVERGENCE_HPP
+#define SIM_MC_MC_CONVERGENCE_HPP
+
+#include "mc_results.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+class MCWorld;
+
+/**
+ * Binary per-run outcomes for a list of metric specs (see file comment).
+ * Shared by the convergence rule and the variance-reduction estimators.
+ */
+class MetricSet {
+public:
+    /** @param specs Metric specs; empty = {"hva"} */
+    explicit MetricSet(const std::vector<std::string>& specs);
+
+    /**
+     * Outcome of each metric for one run: 1, 0, or -1 if the run errored or
+     * lacks the metric's entity. The first successful run fixes the list.
+     */
+    void evaluate(const RunResult& run, std::vector<int8_t>& out);
+
+    /** Fix the list from a scenario's entities, before any run */
+    void resolve(const MCWorld& world);
+
+    bool resolved() const { return resolved_; }
+    size_t size() const { return metrics_.size(); }
+    const std::string& name(size_t i) const { return metrics_[i].name; }
+
+    /** The "win:<team>" outcome of one run */
+    static bool team_wins(const RunResult& run, const std::string& team);
+
+private:
+    struct Metric {
+        enum class Kind { SURVIVAL, WIN } kind;
+        std::string key;       // entity id or team
+        std::string name;
+    };
+
+    std::vector<std::string> specs_;
+    std::vector<Metric> metrics_;
+    bool resolved_ = false;
+
+    void resolve(const RunResult& run);
+    void build(std::vector<std::string> hva_ids);
+};
+
+class ConvergenceMonitor {
+public:
+    /**
+     * @param specs Metric specs (see file comment); empty = {"hva"}
+     * @param target_half_width Stop once every metric's half-width <= this
+     * @param min_runs Never report convergence before this many successes
+     */
+    ConvergenceMonitor(const std::vector<std::string>& specs,
+                       double target_half_width, int min_runs);
+
+    /** Record one finished run. */
+    void add(const RunResult& run);
+
+    /** Current estimates; converged only if at least one metric resolved. */
+    ConvergenceReport report() const;
+
+private:
+    struct Tally {
+        int64_t successes = 0;
+        int64_t trials = 0;
+    };
+
+    MetricSet metrics_;
+    std::vector<Tally> tallies_;
+    std::vector<int8_t> outcomes_;
+    double target_;
+    int min_runs_;
+    int runs_ = 0;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_CONVERGENCE_HPP
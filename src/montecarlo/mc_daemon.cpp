@@ -0,0 +1,467 @@
+#include "montecarlo/mc_daemon.hpp"
+#include "montecarlo/scenario_cache.hpp"
+#include "montecarlo/mc_runner.hpp"
+#include "montecarlo/mc_results.hpp"
+#include "montecarlo/mc_aggregate.hpp"
+#include "io/json_writer.hpp"
+#include "distributed/metrics.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace sim::mc {
+
+namespace {
+
+struct DaemonMetrics {
+    distributed::Gauge queue_depth;
+    distributed::Counter jobs;
+};
+
+const DaemonMetrics& daemon_metrics() {
+    static const DaemonMetrics m{
+        distributed::MetricsRegistry::global().gauge("mc_daemon_queue_depth",
+                                                     "Jobs waiting to start"),
+        distributed::MetricsRegistry::global().counter("mc_daemon_jobs_total",
+                                                       "Jobs taken off the queue")};
+    return m;
+}
+
+/** Build one message frame with a compact JsonWriter. */
+std::string make_message(const std::function<void(sim::JsonWriter&)>& body) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, 0);
+    w.begin_object();
+    body(w);
+    w.end_object();
+    return os.str();
+}
+
+std::string json_quote(const std::string& s) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, 0);
+    w.value(s);
+    return os.str();
+}
+
+std::string error_message(const std::string& id, const std::string& what) {
+    return make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "error");
+        w.kv("id", id);
+        w.kv("message", what);
+    });
+}
+
+std::string hash_hex(uint64_t h) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h));
+    return buf;
+}
+
+/**
+ * Settings a snapshot tree depends on: two jobs with the same key build
+ * the same tree from the same prototype (run count, threads, output and
+ * convergence settings only shape the forks).
+ */
+std::string tree_key(const MCConfig& c) {
+    std::ostringstream os;
+    os << std::setprecision(17) << c.dt << ' ' << c.max_sim_time << ' ' << c.base_seed << ' '
+       << static_cast<int>(c.rng_mode) << ' ' << c.branch_on_first_draw << " at";
+    for (double t : c.branch_times) os << ' ' << t;
+    os << " fanout";
+    for (int f : c.branch_fanout) os << ' ' << f;
+    os << ' ' << c.cached_kepler << c.coast_dt << ' ' << c.batch_flight << c.flight_rk2
+       << c.missile_flyout << c.swept_contact << ' ' << c.wez_dir << ' ' << c.lod_dt << ' '
+       << c.radar_los << c.radar_tracks << c.comms << c.iads << c.ai_decisions << ' '
+       << c.ai_decision_dt << ' ' << c.run_step_budget << ' ' << c.run_wall_budget << ' '
+       << c.tail_runs;
+    return os.str();
+}
+
+} // namespace
+
+bool MCDaemon::Connection::send(const std::string& msg) {
+    std::lock_guard<std::mutex> lock(send_mutex);
+    return sock.send_frame(msg);
+}
+
+MCDaemon::MCDaemon(const MCConfig& defaults, size_t cache_size)
+    : defaults_(defaults), cache_size_(cache_size > 0 ? cache_size : 1) {}
+
+uint64_t MCDaemon::content_hash(const std::string& text) {
+    return ScenarioCache::content_hash(text);
+}
+
+void MCDaemon::serve(const std::string& socket_path) {
+    // A client hanging up mid-job must not kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+
+    auto listener = std::make_shared<distributed::IPCSocket>(
+        distributed::IPCSocket::listen(socket_path));
+
+    if (defaults_.verbose) {
+        std::cerr << "[serve] listening on " << socket_path << "\n";
+    }
+
+    // Acceptor: one reader thread per client connection
+    std::thread acceptor([this, listener]() {
+        for (;;) {
+            std::shared_ptr<Connection> conn;
+            try {
+                conn = std::make_shared<Connection>();
+                conn->sock = listener->accept();
+            } catch (const std::exception&) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                if (stopping_) return;
+            }
+            std::thread(&MCDaemon::read_loop, this, conn).detach();
+        }
+    });
+
+    // Job loop: FIFO until shutdown and the queue is empty
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) break;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            daemon_metrics().queue_depth.set(static_cast<int64_t>(queue_.size()));
+        }
+        daemon_metrics().jobs.add();
+        run_job(job);
+    }
+
+    // Wake the acceptor out of accept() so it sees stopping_
+    try {
+        distributed::IPCSocket::connect(socket_path);
+    } catch (const std::exception&) {}
+    acceptor.join();
+    listener->close();
+
+    if (defaults_.verbose) {
+        std::cerr << "[serve] shut down\n";
+    }
+}
+
+void MCDaemon::read_loop(std::shared_ptr<Connection> conn) {
+    for (;;) {
+        std::string frame;
+        try {
+            frame = conn->sock.receive_frame();
+        } catch (const std::exception&) {
+            return;  // client closed
+        }
+
+        Job job;
+        try {
+            job.header = sim::JsonReader::parse(frame);
+        } catch (const std::exception& e) {
+            conn->send(error_message("", std::string("Bad request: ") + e.what()));
+            continue;
+        }
+
+        std::string type = job.header["type"].get_string("");
+        if (type == "shutdown") {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+            queue_cv_.notify_all();
+            return;
+        }
+        if (type != "job") {
+            conn->send(error_message("", "Unknown request type: " + type));
+            continue;
+        }
+
+        job.id = job.header["id"].get_string("");
+        try {
+            job.scenario_text = conn->sock.receive_frame();
+        } catch (const std::exception&) {
+            return;
+        }
+        job.conn = conn;
+
+        // Enqueue under the queue lock but acknowledge outside it, so a client
+        // that stops reading cannot stall the job loop or other clients. This
+        // connection's send lock, held across both, keeps "queued" ahead of
+        // the job's "started".
+        std::unique_lock<std::mutex> send_lock(conn->send_mutex);
+        const std::string id = job.id;
+        size_t position = 0;
+        bool accepted = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (!stopping_) {
+                queue_.push_back(std::move(job));
+                position = queue_.size();
+                accepted = true;
+                daemon_metrics().queue_depth.set(static_cast<int64_t>(queue_.size()));
+                queue_cv_.notify_one();
+            }
+        }
+        if (!accepted) {
+            conn->sock.send_frame(error_message(id, "Daemon is shutting down"));
+            continue;
+        }
+        conn->sock.send_frame(make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "queued");
+            w.kv("id", id);
+            w.kv("position", position);
+        }));
+    }
+}
+
+MCConfig MCDaemon::job_config(const sim::JsonValue& h) const {
+    MCConfig c = defaults_;
+    c.num_runs      = h["runs"].get_int(c.num_runs);
+    c.base_seed     = h["seed"].get_int(c.base_seed);
+    c.max_sim_time  = h["maxTime"].get_number(c.max_sim_time);
+    c.dt            = h["dt"].get_number(c.dt);
+    c.num_threads   = h["threads"].get_int(c.num_threads);
+    c.output_format = h["format"].get_string("json");
+    c.cached_kepler = h["cachedKepler"].get_bool(c.cached_kepler);
+    c.coast_dt      = h["coastDt"].get_number(c.coast_dt);
+    c.lockstep      = h["lockstep"].get_int(c.lockstep);
+    if (c.lockstep > 1) c.cached_kepler = true;
+    c.batch_flight  = h["batchFlight"].get_bool(c.batch_flight);
+    c.flight_rk2    = h["flightRk2"].get_bool(c.flight_rk2);
+    c.missile_flyout = h["missileFlyout"].get_bool(c.missile_flyout);
+    c.swept_contact = h["sweptContact"].get_bool(c.swept_contact);
+    c.wez_dir       = h["wezDir"].get_string(c.wez_dir);
+    c.lod_dt        = h["lodDt"].get_number(c.lod_dt);
+    c.shared_ephemeris = h["sharedEphemeris"].get_bool(c.shared_ephemeris);
+    c.ephemeris_mb  = h["ephemerisMb"].get_number(c.ephemeris_mb);
+    c.tick_threads  = static_cast<int>(h["tickThreads"].get_number(c.tick_threads));
+    c.radar_los     = h["radarLos"].get_bool(c.radar_los);
+    c.radar_tracks  = h["radarTracks"].get_bool(c.radar_tracks);
+    c.comms         = h["comms"].get_bool(c.comms);
+    c.iads          = h["iads"].get_bool(c.iads);
+    c.ai_decisions  = h["aiDecisions"].get_bool(c.ai_decisions);
+    c.ai_decision_dt = h["aiDecisionDt"].get_number(c.ai_decision_dt);
+    c.run_step_budget = h["runStepBudget"].get_int(c.run_step_budget);
+    c.run_wall_budget = h["runWallBudget"].get_number(c.run_wall_budget);
+    c.ci_half_width = h["ciHalfWidth"].get_number(c.ci_half_width);
+    c.ci_block      = h["ciBlock"].get_int(c.ci_block);
+    c.antithetic    = h["antithetic"].get_bool(c.antithetic);
+    c.branch_on_first_draw = h["branchFirstDraw"].get_bool(c.branch_on_first_draw);
+    if (h["branchAt"].is_array()) {
+        c.branch_times.clear();
+        for (const auto& t : h["branchAt"].as_array()) c.branch_times.push_back(t.get_number(0.0));
+    }
+    if (h["branchFanout"].is_array()) {
+        c.branch_fanout.clear();
+        for (const auto& f : h["branchFanout"].as_array()) c.branch_fanout.push_back(f.get_int(1));
+    }
+    if (h["rng"].is_string()) {
+        c.rng_mode = h["rng"].as_string() == "philox" ? RNGMode::PHILOX
+                                                      : RNGMode::MULBERRY32;
+    }
+    if (h["ciMetrics"].is_array()) {
+        c.ci_metrics.clear();
+        for (const auto& m : h["ciMetrics"].as_array()) {
+            c.ci_metrics.push_back(m.get_string(""));
+        }
+    }
+    c.verbose = false;
+    c.progress = false;
+    c.output_path.clear();
+    return c;
+}
+
+const MCWorld& MCDaemon::prototype_for(const Job& job, uint64_t& hash, bool& cached) {
+    if (job.scenario_text.empty()) {
+        std::string hex = job.header["scenarioHash"].get_string("");
+        hash = hex.empty() ? 0 : std::stoull(hex, nullptr, 16);
+    } else {
+        hash = content_hash(job.scenario_text);
+    }
+
+    auto it = cache_.find(hash);
+    cached = it != cache_.end();
+    if (!cached) {
+        // Then the on-disk cache, which outlives the daemon
+        MCWorld prototype;
+        sim::JsonValue scenario;
+        ScenarioCache disk(defaults_.scenario_cache);
+        bool on_disk = !defaults_.scenario_cache.empty() && disk.load(hash, prototype, scenario);
+        cached = on_disk;
+        if (!on_disk) {
+            if (job.scenario_text.empty()) {
+                throw std::runtime_error("No scenario sent and hash not cached");
+            }
+            scenario = sim::JsonReader::parse(job.scenario_text);
+            if (!scenario["entities"].is_array() || scenario["entities"].size() == 0) {
+                throw std::runtime_error("Scenario has no entities");
+            }
+            prototype = ScenarioParser::parse(scenario, defaults_.num_threads);
+            if (!defaults_.scenario_cache.empty()) {
+                disk.store(hash, job.scenario_text.size(), prototype, scenario);
+            }
+        }
+
+        return insert(hash, CacheEntry{std::move(prototype), ScenarioDocument(scenario),
+                                       0}).prototype;
+    }
+    it->second.last_used = ++use_clock_;
+    return it->second.prototype;
+}
+
+MCDaemon::CacheEntry& MCDaemon::insert(uint64_t hash, CacheEntry&& entry) {
+    auto it = cache_.find(hash);
+    if (it == cache_.end()) {
+        if (cache_.size() >= cache_size_) {
+            auto oldest = cache_.begin();
+            for (auto c = cache_.begin(); c != cache_.end(); ++c) {
+                if (c->second.last_used < oldest->second.last_used) oldest = c;
+            }
+            cache_.erase(oldest);
+        }
+        it = cache_.emplace(hash, std::move(entry)).first;
+    }
+    it->second.last_used = ++use_clock_;
+    return it->second;
+}
+
+const MCWorld& MCDaemon::patched_prototype(const Job& job, const std::string& tree_key,
+                                           uint64_t& hash, bool& cached, size_t& reparsed,
+                                           std::shared_ptr<const MCRunner::BranchPrefix>& prefix) {
+    std::string hex = job.header["baseHash"].get_string("");
+    uint64_t base_hash = hex.empty() ? 0 : std::stoull(hex, nullptr, 16);
+    auto base = cache_.find(base_hash);
+    if (base == cache_.end()) {
+        throw std::runtime_error("Patch base " + (hex.empty() ? std::string("(none)") : hex) +
+                                 " not cached");
+    }
+    if (base->second.scenario.entity_count() == 0) {
+        throw std::runtime_error("Patch base " + hex + " came from the disk cache without "
+                                 "its entity definitions; send the scenario again");
+    }
+    base->second.last_used = ++use_clock_;
+
+    PatchedScenario patched = apply_scenario_patch(base->second.scenario,
+                                                   base->second.prototype, job.header["patch"]);
+    if (patched.scenario.entity_count() == 0) throw std::runtime_error("Scenario has no entities");
+    hash = content_hash(hex + patched.patch_text);
+    cached = cache_.count(hash) != 0;
+    reparsed = patched.edited.size();
+    if (prefix_ && prefix_hash_ == base_hash && prefix_key_ == tree_key) {
+        prefix = rebase_branch_prefix(*prefix_, base->second.prototype,
+                                      base->second.scenario, patched);
+    }
+    return insert(hash, CacheEntry{std::move(patched.prototype),
+                                   std::move(patched.scenario), 0}).prototype;
+}
+
+void MCDaemon::run_job(Job& job) {
+    Connection& conn = *job.conn;
+    const std::string& id = job.id;
+
+    MCConfig config = job_config(job.header);
+    if (config.output_format != "json" && config.output_format != "aggregate") {
+        conn.send(error_message(id, "format must be json or aggregate"));
+        return;
+    }
+
+    const bool patch = job.header.has("patch");
+    const bool branched = config.branch_on_first_draw || !config.branch_times.empty();
+    const std::string key = branched ? tree_key(config) : std::string();
+    uint64_t hash = 0;
+    bool cached = false;
+    size_t reparsed = 0;
+    std::shared_ptr<const MCRunner::BranchPrefix> prefix;
+    const MCWorld* prototype = nullptr;
+    try {
+        prototype = patch ? &patched_prototype(job, key, hash, cached, reparsed, prefix)
+                          : &prototype_for(job, hash, cached);
+    } catch (const std::exception& e) {
+        conn.send(error_message(id, std::string("Scenario error: ") + e.what()));
+        return;
+    }
+    if (!patch && prefix_ && prefix_hash_ == hash && prefix_key_ == key) prefix = prefix_;
+
+    conn.send(make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "started");
+        w.kv("id", id);
+        w.kv("scenarioHash", hash_hex(hash));
+        w.kv("cached", cached);
+        if (patch) w.kv("reparsed", reparsed);
+        if (branched) w.kv("prefixReused", prefix != nullptr);
+    }));
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    MCRunner runner(config);
+    runner.set_profiler(profiler_);
+    if (branched) {
+        runner.keep_branch_prefix(true);
+        runner.set_branch_prefix(prefix);
+    }
+    MCAggregator agg(config.max_sim_time);
+    bool aggregate = config.output_format == "aggregate";
+    int completed = 0;
+
+    runner.run_streaming(*prototype, [&](RunResult& r) {
+        completed++;
+        if (aggregate) {
+            agg.add(r);
+            return;
+        }
+        conn.send(make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "run");
+            w.kv("id", id);
+            w.key("result");
+            write_run_json(w, r);
+        }));
+    }, [&](int done, int total) {
+        conn.send(make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "run_complete");
+            w.kv("id", id);
+            w.kv("run", done);
+            w.kv("total", total);
+        }));
+    });
+
+    if (branched && runner.branch_prefix()) {
+        prefix_ = runner.branch_prefix();
+        prefix_hash_ = hash;
+        prefix_key_ = key;
+    }
+
+    if (aggregate) {
+        std::ostringstream doc;
+        agg.write_json(doc, config.num_runs, config.base_seed, &runner.convergence(),
+                       &runner.variance());
+        // The aggregate document is rendered by MCAggregator; splice it in
+        conn.send("{\"type\":\"aggregate\",\"id\":" + json_quote(id) +
+                  ",\"result\":" + doc.str() + "}");
+    }
+
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    conn.send(make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "done");
+        w.kv("id", id);
+        w.kv("runs", completed);
+        w.kv("elapsed", elapsed);
+        if (runner.convergence().enabled) {
+            w.key("convergence");
+            runner.convergence().write_json(w);
+        }
+        if (runner.variance().enabled()) {
+            w.key("varianceReduction");
+            runner.variance().write_json(w);
+        }
+    }));
+}
+
+} // namespace sim::mc
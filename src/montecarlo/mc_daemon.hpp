@@ -0,0 +1,176 @@
+/**
+ * MCDaemon — Resident Monte Carlo worker (mc_engine --serve).
+ *
+ * Listens on a Unix domain socket and runs batch jobs from a FIFO queue,
+ * so interactive "tweak and rerun" loops skip process startup and, for an
+ * unchanged scenario, the JSON and scenario parse. Parsed prototypes are
+ * cached by a 64-bit FNV-1a hash of the scenario text (LRU, bounded), and
+ * with --scenario-cache also on disk (ScenarioCache), so a hash-only job
+ * still hits after a restart.
+ *
+ * Transport: the length-prefixed frames of distributed::IPCSocket, one
+ * JSON message per frame.
+ *
+ * Client → daemon:
+ *   job       header frame, then a scenario frame (raw scenario JSON):
+ *             { "type": "job", "id": "j1",
+ *               "runs", "seed", "maxTime", "dt", "threads",
+ *               "format": "json" | "aggregate",
+ *               "cachedKepler", "coastDt", "lockstep", "batchFlight",
+ *               "flightRk2", "missileFlyout", "sweptContact", "wezDir", "lodDt",
+ *               "sharedEphemeris", "ephemerisMb", "tickThreads", "radarLos",
+ *               "radarTracks", "comms", "iads", "aiDecisions", "aiDecisionDt",
+ *               "runStepBudget", "runWallBudget",
+ *               "ciHalfWidth", "ciMetrics": [...], "ciBlock",
+ *               "rng": "mulberry32" | "philox", "antithetic",
+ *               "branchAt": [...], "branchFanout": [...], "branchFirstDraw",
+ *               "scenarioHash": "<hex>",
+ *               "baseHash": "<hex>", "patch": [...] } // all optional but type
+ *             The scenario frame may be empty if scenarioHash names a
+ *             cached prototype, and is ignored with a patch.
+ *   shutdown  { "type": "shutdown" } — finish queued jobs, then exit
+ *
+ * A patch job edits the cached scenario `baseHash` with a JSON Patch
+ * subset instead of sending it again (see scenario_patch.hpp): only the
+ * entity definitions the patch reaches are parsed, the rest of the
+ * prototype is copied from the cached one. The patched scenario is cached
+ * in memory under a hash of the base hash and the patch, which "started"
+ * reports, so patches chain. The base must have been parsed by this daemon (a
+ * disk-cache hit keeps no entity definitions to patch).
+ *
+ * A branched job (branchAt / branchFirstDraw) leaves its snapshot tree's
+ * leaves in the daemon. The next branched job with the same tree settings
+ * (time step, seed, RNG, branch points, world options) forks from them
+ * without simulating the prefix again, if it runs the same scenario or a
+ * patch of it that only touched entities dormant through the prefix
+ * (rebase_branch_prefix()). One tree is kept, the latest.
+ *
+ * Daemon → client, per job (same messages as mc_engine --progress plus
+ * results):
+ *   { "type": "queued", "id", "position" }
+ *   { "type": "started", "id", "scenarioHash", "cached",
+ *     "reparsed"?, "prefixReused"? }    // reparsed: patch jobs' parsed entities
+ *   { "type": "run_complete", "id", "run", "total" }
+ *   { "type": "run", "id", "result": {...} }        // format json, in order
+ *   { "type": "aggregate", "id", "result": {...} }  // format aggregate
+ *   { "type": "done", "id", "runs", "elapsed", "convergence"?,
+ *     "varianceReduction"? }
+ *   { "type": "error", "id", "message" }
+ *
+ * Jobs run one at a time; each uses its own thread count (default: the
+ * daemon's --threads). Queue depth and jobs served are exported as
+ * mc_daemon_* metrics (see distributed/metrics.hpp).
+ */
+
+#ifndef SIM_MC_MC_DAEMON_HPP
+#define SIM_MC_MC_DAEMON_HPP
+
+#include "mc_world.hpp"
+#include "mc_profiler.hpp"
+#include "mc_runner.hpp"
+#include "scenario_patch.hpp"
+#include "scenario_parser.hpp"
+#include "distributed/ipc_socket.hpp"
+#include "io/json_reader.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace sim::mc {
+
+class MCDaemon {
+public:
+    /**
+     * @param defaults Config for fields a job does not set
+     * @param cache_size Parsed prototypes kept (least recently used evicted)
+     */
+    MCDaemon(const MCConfig& defaults, size_t cache_size);
+
+    /**
+     * Serve on `socket_path` until a shutdown request has drained the queue.
+     * @throws std::runtime_error if the socket cannot be created
+     */
+    void serve(const std::string& socket_path);
+
+    /** Profile every job's ticks into `profiler` (null = off). */
+    void set_profiler(TickProfiler* profiler) { profiler_ = profiler; }
+
+    /** 64-bit FNV-1a of a byte string (scenario cache key). */
+    static uint64_t content_hash(const std::string& text);
+
+private:
+    struct Connection {
+        distributed::IPCSocket sock;
+        std::mutex send_mutex;
+
+        /** Thread-safe frame send; false once the client has gone. */
+        bool send(const std::string& msg);
+    };
+
+    struct Job {
+        std::shared_ptr<Connection> conn;
+        sim::JsonValue header;
+        std::string id;
+        std::string scenario_text;
+    };
+
+    struct CacheEntry {
+        MCWorld prototype;
+        ScenarioDocument scenario;   // Its document, as patches edit it
+        uint64_t last_used = 0;
+    };
+
+    MCConfig defaults_;
+    size_t cache_size_;
+    TickProfiler* profiler_ = nullptr;
+
+    // Job queue: filled by connection readers, drained by serve()
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Job> queue_;
+    bool stopping_ = false;
+
+    // Prototype cache, touched only by the job loop
+    std::unordered_map<uint64_t, CacheEntry> cache_;
+    uint64_t use_clock_ = 0;
+
+    // Leaves of the last branched job, its scenario and tree settings
+    std::shared_ptr<const MCRunner::BranchPrefix> prefix_;
+    uint64_t prefix_hash_ = 0;
+    std::string prefix_key_;
+
+    void read_loop(std::shared_ptr<Connection> conn);
+    void run_job(Job& job);
+
+    /**
+     * Cached prototype for the job's scenario, parsing and inserting on a
+     * miss. Sets `hash` and `cached`.
+     * @throws std::runtime_error on a parse error or an unknown hash
+     */
+    const MCWorld& prototype_for(const Job& job, uint64_t& hash, bool& cached);
+
+    /**
+     * Patch job: apply the patch to the cached base scenario and cache the
+     * result. Sets `hash`, `cached` (the result was cached already),
+     * `reparsed`, and `prefix` to the kept branch prefix carried across
+     * the edit if `tree_key` matches and it stands.
+     * @throws std::runtime_error if the base is not cached;
+     *         std::invalid_argument on a bad patch
+     */
+    const MCWorld& patched_prototype(const Job& job, const std::string& tree_key,
+                                     uint64_t& hash, bool& cached, size_t& reparsed,
+                                     std::shared_ptr<const MCRunner::BranchPrefix>& prefix);
+
+    /** Insert into the cache, evicting the least recently used entry if full. */
+    CacheEntry& insert(uint64_t hash, CacheEntry&& entry);
+
+    MCConfig job_config(const sim::JsonValue& header) const;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_DAEMON_HPP
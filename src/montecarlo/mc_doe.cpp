@@ -0,0 +1,347 @@
+#include "montecarlo/mc_doe.hpp"
+#include "montecarlo/mc_variance.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+bool is_orbital_ai(const MCEntity& e) { return e.ai_type == AIType::ORBITAL_COMBAT; }
+bool is_intercept_ai(const MCEntity& e) { return e.ai_type == AIType::INTERCEPT; }
+bool is_kkv(const MCEntity& e) { return e.weapon_type == WeaponType::KINETIC_KILL; }
+bool is_sam(const MCEntity& e) { return e.weapon_type == WeaponType::SAM_BATTERY; }
+bool is_radar(const MCEntity& e) { return e.has_radar; }
+
+/**
+ * Overridable fields, keyed by the scenario component key ScenarioParser
+ * reads them from. `applies` limits an override to entities that parsed
+ * that component, so e.g. "weapons.Pk" leaves SAM sites alone.
+ */
+struct FieldDef {
+    const char* field;
+    bool (*applies)(const MCEntity&);
+    double MCEntity::* real;
+    int MCEntity::* integer;
+};
+
+const FieldDef FIELDS[] = {
+    {"ai.sensorRange",            is_orbital_ai,   &MCEntity::sensor_range,           nullptr},
+    {"ai.defenseRadius",          is_orbital_ai,   &MCEntity::defense_radius,         nullptr},
+    {"ai.maxAccel",               is_orbital_ai,   &MCEntity::max_accel,              nullptr},
+    {"ai.killRange",              is_orbital_ai,   &MCEntity::kill_range,             nullptr},
+    {"ai.scanInterval",           is_orbital_ai,   &MCEntity::scan_interval,          nullptr},
+    {"ai.engageRange",            is_intercept_ai, &MCEntity::intercept_engage_range, nullptr},
+    {"weapons.Pk",                is_kkv,          &MCEntity::pk,                     nullptr},
+    {"weapons.killRange",         is_kkv,          &MCEntity::weapon_kill_range,      nullptr},
+    {"weapons.cooldown",          is_kkv,          &MCEntity::cooldown_time,          nullptr},
+    {"weapons.maxRange",          is_sam,          &MCEntity::sam_max_range,          nullptr},
+    {"weapons.minRange",          is_sam,          &MCEntity::sam_min_range,          nullptr},
+    {"weapons.missileSpeed",      is_sam,          &MCEntity::sam_missile_speed,      nullptr},
+    {"weapons.pkPerMissile",      is_sam,          &MCEntity::sam_pk_per_missile,     nullptr},
+    {"weapons.missiles",          is_sam,          nullptr, &MCEntity::sam_missiles_ready},
+    {"weapons.salvoSize",         is_sam,          nullptr, &MCEntity::sam_salvo_size},
+    {"sensors.maxRange",          is_radar,        &MCEntity::radar_max_range,        nullptr},
+    {"sensors.fov_deg",           is_radar,        &MCEntity::radar_fov_deg,          nullptr},
+    {"sensors.detectionProbability", is_radar,     &MCEntity::radar_p_detect,         nullptr},
+    {"sensors.minElevation_deg",  is_radar,        &MCEntity::radar_min_elev_deg,     nullptr},
+    {"sensors.maxElevation_deg",  is_radar,        &MCEntity::radar_max_elev_deg,     nullptr},
+};
+
+const FieldDef* find_field(const std::string& field) {
+    for (const auto& f : FIELDS) {
+        if (field == f.field) return &f;
+    }
+    return nullptr;
+}
+
+bool selected(const DOEParameter& p, const MCEntity& e) {
+    if (!p.select_id.empty() && e.id != p.select_id) return false;
+    if (!p.select_team.empty() && e.team != p.select_team) return false;
+    if (!p.select_type.empty() && e.type != p.select_type) return false;
+    if (!p.select_role.empty() && role_to_string(e.role) != p.select_role) return false;
+    return true;
+}
+
+/** Field and entity filter shared by DOE parameters and uncertainties. */
+DOEParameter parse_parameter(const sim::JsonValue& pd) {
+    DOEParameter p;
+    p.field = pd["field"].get_string("");
+    p.name = pd["name"].get_string(p.field);
+    if (!find_field(p.field)) {
+        throw std::runtime_error("unknown field '" + p.field + "'");
+    }
+    const auto& sel = pd["select"];
+    p.select_id   = sel["id"].get_string("");
+    p.select_team = sel["team"].get_string("");
+    p.select_type = sel["type"].get_string("");
+    p.select_role = sel["role"].get_string("");
+    return p;
+}
+
+} // namespace
+
+int apply_override(const DOEParameter& p, double value, MCWorld& world) {
+    const FieldDef* f = find_field(p.field);
+    if (!f) throw std::runtime_error("unknown field '" + p.field + "'");
+    int matched = 0;
+    for (auto& e : world.entities()) {
+        if (!f->applies(e) || !selected(p, e)) continue;
+        if (f->real) {
+            e.*(f->real) = value;
+        } else {
+            e.*(f->integer) = static_cast<int>(value);
+        }
+        matched++;
+    }
+    return matched;
+}
+
+DOESpec DOESpec::parse(const sim::JsonValue& doc, const std::string& spec_dir) {
+    if (!doc.is_object()) throw std::runtime_error("DOE spec: not an object");
+
+    DOESpec spec;
+    const auto& scen = doc["scenario"];
+    if (scen.is_object()) {
+        spec.scenario = scen;
+    } else if (scen.is_string()) {
+        spec.scenario_path = scen.as_string();
+        if (!spec_dir.empty() && !spec.scenario_path.empty() &&
+            spec.scenario_path[0] != '/') {
+            spec.scenario_path = spec_dir + "/" + spec.scenario_path;
+        }
+    }
+    spec.runs = doc["runs"].get_int(0);
+
+    const auto& params = doc["parameters"];
+    for (size_t i = 0; i < params.size(); i++) {
+        const auto& pd = params[i];
+        DOEParameter p;
+        try {
+            p = parse_parameter(pd);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("DOE spec: ") + e.what());
+        }
+
+        const auto& vals = pd["values"];
+        for (size_t k = 0; k < vals.size(); k++) {
+            p.values.push_back(vals[k].as_number());
+        }
+        if (p.values.empty()) {
+            throw std::runtime_error("DOE spec: parameter '" + p.name + "' has no values");
+        }
+        spec.parameters.push_back(std::move(p));
+    }
+    return spec;
+}
+
+size_t DOESpec::num_permutations() const {
+    size_t n = 1;
+    for (const auto& p : parameters) n *= p.values.size();
+    return n;
+}
+
+std::vector<double> DOESpec::permutation(size_t perm) const {
+    std::vector<double> vals(parameters.size());
+    for (size_t i = parameters.size(); i-- > 0;) {
+        const auto& values = parameters[i].values;
+        vals[i] = values[perm % values.size()];
+        perm /= values.size();
+    }
+    return vals;
+}
+
+MCWorld DOESpec::make_world(const MCWorld& prototype, size_t perm) const {
+    return make_world(prototype, permutation(perm));
+}
+
+MCWorld DOESpec::make_world(const MCWorld& prototype, const std::vector<double>& vals) const {
+    if (vals.size() != parameters.size()) {
+        throw std::runtime_error("DOE point has " + std::to_string(vals.size()) +
+                                 " values for " + std::to_string(parameters.size()) +
+                                 " parameters");
+    }
+    MCWorld world = prototype;
+
+    for (size_t i = 0; i < parameters.size(); i++) {
+        const DOEParameter& p = parameters[i];
+        if (apply_override(p, vals[i], world) == 0) {
+            throw std::runtime_error("DOE parameter '" + p.name +
+                                     "' matches no entity with " + p.field);
+        }
+    }
+
+    world.refresh_query_ranges();
+    return world;
+}
+
+LatinHypercube::LatinHypercube(const sim::JsonValue& uncertainties, int runs,
+                               int32_t seed)
+    : runs_(std::max(runs, 0)) {
+    for (size_t i = 0; i < uncertainties.size(); i++) {
+        const auto& ud = uncertainties[i];
+        try {
+            dims_.push_back(parse_parameter(ud));
+        } catch (const std::exception& e) {
+            throw std::runtime_error(std::string("uncertainty: ") + e.what());
+        }
+        const auto& range = ud["range"];
+        if (range.size() != 2) {
+            throw std::runtime_error("uncertainty '" + dims_.back().name +
+                                     "': range must be [min, max]");
+        }
+        lo_.push_back(range[0].as_number());
+        hi_.push_back(range[1].as_number());
+    }
+
+    // One independent stratum permutation per dimension (Fisher-Yates on
+    // a counter stream keyed off the batch seed)
+    SimRNG rng;
+    rng.set_mode(RNGMode::PHILOX);
+    rng.set_stream(seed, 0xFFFFFFFFu);
+
+    size_t n = static_cast<size_t>(runs_);
+    values_.resize(n * dims_.size());
+    std::vector<int> strata(n);
+    for (size_t d = 0; d < dims_.size(); d++) {
+        uint32_t owner = static_cast<uint32_t>(d);
+        for (size_t k = 0; k < n; k++) strata[k] = static_cast<int>(k);
+        for (size_t k = n; k > 1; k--) {
+            size_t j = static_cast<size_t>(rng.random_for(owner) * static_cast<double>(k));
+            std::swap(strata[k - 1], strata[std::min(j, k - 1)]);
+        }
+        for (size_t r = 0; r < n; r++) {
+            double u = (strata[r] + rng.random_for(owner)) / static_cast<double>(n);
+            values_[r * dims_.size() + d] = lo_[d] + u * (hi_[d] - lo_[d]);
+        }
+    }
+}
+
+void LatinHypercube::apply(int run_index, MCWorld& world) const {
+    if (run_index < 0 || run_index >= runs_) return;
+    for (size_t d = 0; d < dims_.size(); d++) {
+        double v = values_[static_cast<size_t>(run_index) * dims_.size() + d];
+        if (apply_override(dims_[d], v, world) == 0) {
+            throw std::runtime_error("uncertainty '" + dims_[d].name +
+                                     "' matches no entity with " + dims_[d].field);
+        }
+    }
+    world.refresh_query_ranges();
+}
+
+double LatinHypercube::value(int run_index, size_t dim) const {
+    return values_[static_cast<size_t>(run_index) * dims_.size() + dim];
+}
+
+DOEResultsWriter::DOEResultsWriter(std::ostream& out, const DOESpec& spec,
+                                   int runs_per_perm, int base_seed,
+                                   double max_sim_time,
+                                   const std::vector<std::string>& metric_specs)
+    : out_(out), w_(out), spec_(spec), runs_per_perm_(runs_per_perm),
+      base_seed_(base_seed), max_sim_time_(max_sim_time), metrics_(metric_specs) {
+    w_.begin_object();
+
+    // ── config ──
+    w_.key("config").begin_object();
+    w_.kv("numRuns", runs_per_perm);
+    w_.kv("baseSeed", base_seed);
+    w_.kv("maxSimTime", max_sim_time);
+    w_.kv("numPermutations", spec.num_permutations());
+    w_.end_object();
+
+    // ── parameters ──
+    w_.key("parameters").begin_array();
+    for (const auto& p : spec.parameters) {
+        w_.begin_object();
+        w_.kv("name", p.name);
+        w_.kv("field", p.field);
+        w_.key("values").begin_array();
+        for (double v : p.values) w_.value(v);
+        w_.end_array();
+        w_.end_object();
+    }
+    w_.end_array();
+
+    // ── permutations ──
+    w_.key("permutations").begin_array();
+}
+
+void DOEResultsWriter::open_permutation(int perm) {
+    std::vector<double> vals = spec_.permutation(static_cast<size_t>(perm));
+
+    w_.begin_object();
+    w_.kv("permId", perm);
+    w_.key("config").begin_object();
+    for (size_t i = 0; i < vals.size(); i++) {
+        w_.kv(spec_.parameters[i].name, vals[i]);
+    }
+    w_.end_object();
+
+    w_.key("results").begin_object();
+    w_.key("config").begin_object();
+    w_.kv("numRuns", runs_per_perm_);
+    w_.kv("baseSeed", base_seed_);
+    w_.kv("maxSimTime", max_sim_time_);
+    w_.end_object();
+    w_.key("runs").begin_array();
+}
+
+void DOEResultsWriter::close_permutation() {
+    w_.end_array();   // runs
+    w_.end_object();  // results
+
+    // Common-random-number comparison: every permutation ran the baseline's
+    // seeds, so differences are estimated run by run
+    if (open_perm_ > 0) {
+        std::vector<int8_t> a, b;
+        w_.key("vsBaseline").begin_array();
+        for (size_t m = 0; m < metrics_.size(); m++) {
+            a.clear();
+            b.clear();
+            size_t n = std::min(baseline_.size(), current_.size());
+            for (size_t r = 0; r < n; r++) {
+                a.push_back(m < baseline_[r].size() ? baseline_[r][m] : -1);
+                b.push_back(m < current_[r].size() ? current_[r][m] : -1);
+            }
+            PairedEstimate est = paired_difference(metrics_.name(m), a, b);
+            w_.begin_object();
+            w_.kv("name", est.name);
+            w_.kv("pairs", static_cast<size_t>(est.pairs));
+            w_.kv("diff", est.mean);
+            w_.kv("halfWidth", est.half_width);
+            w_.kv("independentHalfWidth", est.independent_half_width);
+            w_.end_object();
+        }
+        w_.end_array();
+    }
+    current_.clear();
+
+    w_.end_object();  // permutation
+}
+
+void DOEResultsWriter::advance_to(int perm) {
+    // Permutations without runs still get an (empty) entry
+    while (open_perm_ < perm) {
+        if (open_perm_ >= 0) close_permutation();
+        open_permutation(++open_perm_);
+    }
+}
+
+void DOEResultsWriter::write_run(int permutation, const RunResult& run) {
+    advance_to(permutation);
+    write_run_json(w_, run);
+
+    std::vector<int8_t> outcome;
+    metrics_.evaluate(run, outcome);
+    (permutation == 0 ? baseline_ : current_).push_back(std::move(outcome));
+}
+
+void DOEResultsWriter::finish() {
+    advance_to(static_cast<int>(spec_.num_permutations()) - 1);
+    if (open_perm_ >= 0) close_permutation();
+    w_.end_array();
+    w_.end_object();
+    out_ << '\n';
+}
+
+} // namespace sim::mc
@@ -0,0 +1,167 @@
+/**
+ * MC DOE — In-process Design-of-Experiments sweeps.
+ *
+ * A DOE spec names a base scenario and a full-factorial grid of parameter
+ * overrides. The scenario is parsed once; each permutation is a copy of
+ * that prototype with the overrides written straight into the matching
+ * MCEntity fields, so a sweep pays one parse instead of one process per
+ * permutation. MCRunner::run_doe() schedules every (permutation, seed)
+ * pair on one thread pool.
+ *
+ * Spec format:
+ *   {
+ *     "scenario": "path.json" | { ...scenario... },  // --scenario overrides
+ *     "runs": 10,               // seeds per permutation (default: --runs)
+ *     "parameters": [
+ *       { "name": "pk",                     // label (default: field)
+ *         "field": "weapons.Pk",            // scenario component key
+ *         "select": { "team": "red", "role": "attacker" },  // optional
+ *         "values": [0.5, 0.7, 0.9] }
+ *     ]
+ *   }
+ *
+ * Permutations are numbered row-major: the last parameter varies fastest.
+ * "select" matches on id, team, type and role (all given keys must match).
+ * Every permutation runs seeds base_seed .. base_seed + runs - 1, so
+ * permutations are compared on common random numbers.
+ */
+
+#ifndef SIM_MC_MC_DOE_HPP
+#define SIM_MC_MC_DOE_HPP
+
+#include "mc_world.hpp"
+#include "mc_results.hpp"
+#include "mc_convergence.hpp"
+#include "io/json_reader.hpp"
+#include "io/json_writer.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+struct DOEParameter {
+    std::string name;
+    std::string field;       // e.g. "ai.sensorRange", "weapons.Pk"
+    std::string select_id;   // entity filters; empty = any
+    std::string select_team;
+    std::string select_type;
+    std::string select_role;
+    std::vector<double> values;
+};
+
+struct DOESpec {
+    sim::JsonValue scenario;         // inline scenario (null if a path)
+    std::string scenario_path;       // resolved against the spec's directory
+    int runs = 0;                    // 0 = use MCConfig::num_runs
+    std::vector<DOEParameter> parameters;
+
+    /**
+     * Parse a spec document. `spec_dir` resolves a relative scenario path.
+     * @throws std::runtime_error on a malformed spec or unknown field
+     */
+    static DOESpec parse(const sim::JsonValue& doc, const std::string& spec_dir);
+
+    /** Product of the parameter value counts (1 with no parameters). */
+    size_t num_permutations() const;
+
+    /** Value of each parameter in permutation `perm`. */
+    std::vector<double> permutation(size_t perm) const;
+
+    /**
+     * Copy `prototype` and apply permutation `perm`.
+     * @throws std::runtime_error if a parameter selects no entity
+     */
+    MCWorld make_world(const MCWorld& prototype, size_t perm) const;
+
+    /**
+     * Copy `prototype` and apply one value per parameter — any point, not
+     * only a grid permutation (surrogate fallback runs).
+     * @throws std::runtime_error on a size mismatch or an unmatched parameter
+     */
+    MCWorld make_world(const MCWorld& prototype, const std::vector<double>& values) const;
+};
+
+/**
+ * Apply `value` to `p.field` on every entity `p` selects.
+ * Returns the number of entities changed.
+ */
+int apply_override(const DOEParameter& p, double value, MCWorld& world);
+
+/**
+ * Latin-hypercube design over declared scenario uncertainties: each
+ * dimension's [min, max] is cut into one stratum per run and every run
+ * draws one point from a distinct stratum of each dimension (independent
+ * random stratum permutations per dimension). Uncertainties use the DOE
+ * parameter syntax with a range instead of values:
+ *   "uncertainties": [ { "name": "redPk", "field": "weapons.Pk",
+ *                        "select": { "team": "red" }, "range": [0.5, 0.9] } ]
+ */
+class LatinHypercube {
+public:
+    /** @throws std::runtime_error on an unknown field or bad range */
+    LatinHypercube(const sim::JsonValue& uncertainties, int runs, int32_t seed);
+
+    /**
+     * Write run `run_index`'s sample into `world` (MCRunner::RunSetup).
+     * @throws std::runtime_error if an uncertainty selects no entity
+     */
+    void apply(int run_index, MCWorld& world) const;
+
+    size_t dimensions() const { return dims_.size(); }
+    const DOEParameter& dimension(size_t d) const { return dims_[d]; }
+    int strata() const { return runs_; }
+    double value(int run_index, size_t dim) const;
+
+private:
+    int runs_;
+    std::vector<DOEParameter> dims_;
+    std::vector<double> lo_, hi_;
+    std::vector<double> values_;   // runs x dims, row-major
+};
+
+/**
+ * Streams DOE results as one document:
+ *   { "config", "parameters",
+ *     "permutations": [ { "permId", "config": {name: value},
+ *                         "results": { "config", "runs": [...] },
+ *                         "vsBaseline": [...] } ] }
+ * Each "results" object has the shape of the batch results document.
+ * Permutations after the first carry common-random-number paired
+ * differences against permutation 0, one per metric (MetricSet specs,
+ * default HVA survival): { "name", "pairs", "diff", "halfWidth",
+ * "independentHalfWidth" }.
+ * Runs must arrive in (permutation, run) order, as run_doe() delivers them.
+ */
+class DOEResultsWriter {
+public:
+    DOEResultsWriter(std::ostream& out, const DOESpec& spec, int runs_per_perm,
+                     int base_seed, double max_sim_time,
+                     const std::vector<std::string>& metric_specs = {});
+
+    void write_run(int permutation, const RunResult& run);
+    void finish();
+
+private:
+    std::ostream& out_;
+    sim::JsonWriter w_;
+    const DOESpec& spec_;
+    int runs_per_perm_;
+    int base_seed_;
+    double max_sim_time_;
+    int open_perm_ = -1;   // last permutation opened
+
+    // Per-run metric outcomes: permutation 0, and the open permutation
+    MetricSet metrics_;
+    std::vector<std::vector<int8_t>> baseline_;
+    std::vector<std::vector<int8_t>> current_;
+
+    void open_permutation(int perm);
+    void close_permutation();
+    /** Close the open entry and open entries up to `perm`. */
+    void advance_to(int perm);
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_DOE_HPP
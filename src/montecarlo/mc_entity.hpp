@@ -11,10 +11,13 @@
 #ifndef SIM_MC_MC_ENTITY_HPP
 #define SIM_MC_MC_ENTITY_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include "core/state_vector.hpp"
+#include "swept_contact.hpp"
 
 namespace sim::mc {
 
@@ -26,6 +29,7 @@ enum class PhysicsType {
     FLIGHT_3DOF,      // Atmospheric flight (geodetic)
     STATIC            // Ground station, SAM site (fixed geodetic)
 };
+inline constexpr size_t NUM_PHYSICS_TYPES = 4;
 
 enum class AIType {
     NONE,
@@ -33,6 +37,7 @@ enum class AIType {
     WAYPOINT_PATROL,  // Fly waypoint route
     INTERCEPT         // Chase and engage a target entity
 };
+inline constexpr size_t NUM_AI_TYPES = 4;
 
 enum class WeaponType {
     NONE,
@@ -40,6 +45,7 @@ enum class WeaponType {
     SAM_BATTERY,      // Surface-to-air missile
     A2A_MISSILE       // Air-to-air missile
 };
+inline constexpr size_t NUM_WEAPON_TYPES = 4;
 
 enum class CombatRole {
     HVA,
@@ -49,6 +55,7 @@ enum class CombatRole {
     SWEEP,
     NONE
 };
+inline constexpr size_t NUM_COMBAT_ROLES = 6;
 
 inline const char* role_to_string(CombatRole role) {
     switch (role) {
@@ -93,13 +100,60 @@ inline WeaponType string_to_weapon_type(const std::string& s) {
     return WeaponType::NONE;
 }
 
+/**
+ * Air-to-air weapon types; the value indexes MCEntity::a2a_inventory.
+ * OTHER counts loadout entries with no spec (carried, never fired).
+ */
+enum class A2AWeapon : uint8_t { AIM120, AIM9, R77, R73, OTHER, COUNT };
+inline constexpr size_t NUM_A2A_WEAPONS = static_cast<size_t>(A2AWeapon::COUNT);
+
+inline A2AWeapon string_to_a2a_weapon(const std::string& s) {
+    if (s == "aim120") return A2AWeapon::AIM120;
+    if (s == "aim9")   return A2AWeapon::AIM9;
+    if (s == "r77")    return A2AWeapon::R77;
+    if (s == "r73")    return A2AWeapon::R73;
+    return A2AWeapon::OTHER;
+}
+
+inline const char* a2a_weapon_to_string(A2AWeapon w) {
+    switch (w) {
+        case A2AWeapon::AIM120: return "aim120";
+        case A2AWeapon::AIM9:   return "aim9";
+        case A2AWeapon::R77:    return "r77";
+        case A2AWeapon::R73:    return "r73";
+        default:                return "other";
+    }
+}
+
+// ── Entity handles ──
+
+/**
+ * Dense integer handle: the entity's index in MCWorld::entities().
+ * String IDs are resolved to handles once at parse time; all in-sim
+ * targeting uses handles so lookups are array indexing.
+ */
+using EntityHandle = uint32_t;
+inline constexpr EntityHandle NO_ENTITY = UINT32_MAX;
+
 // ── Sub-structs ──
 
+enum class EngagementResult : uint8_t { LAUNCH, KILL, MISS };
+
+inline const char* engagement_result_to_string(EngagementResult r) {
+    switch (r) {
+        case EngagementResult::LAUNCH: return "LAUNCH";
+        case EngagementResult::KILL:   return "KILL";
+        case EngagementResult::MISS:   return "MISS";
+        default:                       return "";
+    }
+}
+
+/** One weapon event on MCWorld::engagement_log, pushed as it happens. */
 struct EngagementRecord {
-    std::string target_id;
-    std::string target_name;
-    std::string result;   // "LAUNCH", "KILL", "MISS", "KILLED_BY"
     double time = 0.0;
+    EntityHandle source = NO_ENTITY;
+    EntityHandle target = NO_ENTITY;
+    EngagementResult result = EngagementResult::LAUNCH;
 };
 
 struct Waypoint {
@@ -110,33 +164,47 @@ struct Waypoint {
 };
 
 struct RadarDetection {
-    std::string entity_id;
+    EntityHandle entity = NO_ENTITY;
     double range = 0.0;      // meters
     double bearing = 0.0;    // radians
     double time = 0.0;
 };
 
 struct SAMEngagement {
-    std::string target_id;
+    EntityHandle target = NO_ENTITY;
     int phase = 0;            // 0=DETECT, 1=TRACK, 2=ENGAGE, 3=ASSESS
     double phase_timer = 0.0;
     int missiles_fired = 0;
+    uint32_t missile = UINT32_MAX;  // MissilePool slot in fly-out mode
+    double reach = 1.0;             // WEZ reach at launch, scales Pk
+    double launch_at = -1.0;        // direct ascent: scheduled launch [sim s], <0 none yet
 };
 
 struct A2AEngagement {
-    std::string target_id;
+    EntityHandle target = NO_ENTITY;
     int phase = 0;            // 0=LOCK, 1=FIRE, 2=GUIDE, 3=ASSESS
     double phase_timer = 0.0;
-    std::string weapon_type;  // "aim120", "aim9", etc.
+    A2AWeapon weapon_type = A2AWeapon::OTHER;
+    uint32_t missile = UINT32_MAX;  // MissilePool slot in fly-out mode
+    double reach = 1.0;             // WEZ reach at launch, scales Pk
+};
+
+struct TargetInfo {
+    EntityHandle entity = NO_ENTITY;
+    double distance = 0.0;   // meters (ECI)
+    CombatRole role = CombatRole::NONE;
 };
 
 struct WeaponSpec {
-    std::string name;
+    A2AWeapon type = A2AWeapon::OTHER;
     double range = 0.0;      // meters
     double pk = 0.0;
     double speed = 0.0;      // m/s (for TOF calculation)
 };
 
+class WEZTable;
+class InterceptTable;
+
 struct MCEntity {
     // ── Identity ──
     std::string id;
@@ -164,6 +232,7 @@ struct MCEntity {
     double raan_rad = 0.0;
     double arg_pe_rad = 0.0;
     double mean_anomaly_rad = 0.0;
+    bool orbit_dirty = false;  // eci_vel changed by thrust; KeplerBatch reloads
 
     // ── Geodetic position (atmospheric / ground entities) ──
     double geo_lat = 0.0;    // degrees
@@ -199,11 +268,19 @@ struct MCEntity {
     bool waypoint_loop = true;
 
     // ── Intercept AI state ──
-    std::string intercept_target_id;
+    std::string intercept_target_id;          // scenario ID (JSON boundary)
+    EntityHandle intercept_target = NO_ENTITY; // resolved at parse time
     int intercept_mode = 0;          // 0=pursuit, 1=lead, 2=stern
     double intercept_engage_range = 0.0;
     int intercept_state = 0;         // 0=navigating, 1=engaged
 
+    // ── Held AI command (reduced-rate decisions, see DecisionSchedule) ──
+    double ai_roll_cmd = 0.0;        // radians, bank the last decision asked for
+    double ai_throttle_rate = 0.0;   // throttle change per second
+
+    // ── Live viewer control (MCLiveServer) ──
+    bool player_controlled = false;  // AI skipped; a viewer sets roll/throttle or thrusts
+
     // ── Radar sensor state ──
     bool has_radar = false;
     double radar_max_range = 300000.0;    // meters
@@ -222,12 +299,14 @@ struct MCEntity {
     int sam_missiles_ready = 8;
     int sam_salvo_size = 2;
     double sam_pk_per_missile = 0.7;
+    std::string sam_wez;                  // WEZ table name ("" = range gate)
+    const WEZTable* sam_wez_table = nullptr;   // resolved per run (MCConfig::wez_dir)
+    const InterceptTable* sam_intercept_table = nullptr;   // same, for orbital targets
     std::vector<SAMEngagement> sam_engagements;
 
     // ── A2A missile state ──
     std::vector<std::string> a2a_loadout;   // ordered list: ["aim120","aim120","aim9","aim9"]
-    std::unordered_map<std::string, int> a2a_inventory; // "aim120" -> count
-    std::unordered_map<std::string, WeaponSpec> a2a_specs; // weapon type -> spec
+    std::array<int, NUM_A2A_WEAPONS> a2a_inventory{};   // rounds by A2AWeapon
     std::vector<A2AEngagement> a2a_engagements;
     double a2a_lock_time = 1.5;
 
@@ -247,19 +326,21 @@ struct MCEntity {
     double kill_range = 50000.0;
     double scan_interval = 1.0;
     double scan_timer = 0.0;
-    std::string assigned_hva_id;
-    std::string current_target;      // entity ID of current target
-    std::string kk_target_id;        // signal to weapon system
+    std::string assigned_hva_id;                // scenario ID (JSON boundary)
+    EntityHandle assigned_hva = NO_ENTITY;      // resolved at parse time
+    EntityHandle current_target = NO_ENTITY;    // current target
+    EntityHandle kk_target = NO_ENTITY;         // signal to weapon system
+    std::vector<TargetInfo> scan_targets;  // last sensor sweep, sorted by distance
 
     // ── Kinetic Kill weapon fields (original) ──
     double pk = 0.7;
     double weapon_kill_range = 50000.0;
     double cooldown_time = 5.0;
     double cooldown_timer = 0.0;
-    std::string last_launch_target;
-
-    // ── Per-entity engagement log ──
-    std::vector<EngagementRecord> engagements;
+    EntityHandle last_launch_target = NO_ENTITY;
+    // Swept contact: the target last ranged, and its state relative to self (ECI)
+    EntityHandle kk_last_target = NO_ENTITY;
+    RelativeState kk_last_rel;
 };
 
 } // namespace sim::mc
@@ -0,0 +1,113 @@
+#include "montecarlo/mc_ephemeris.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace sim::mc {
+
+namespace {
+
+/** Motion independent of every random draw and of every other entity. */
+bool deterministic(const MCEntity& e, bool flight) {
+    if (e.player_controlled) return false;
+    switch (e.physics_type) {
+        case PhysicsType::ORBITAL_2BODY:
+            return e.ai_type == AIType::NONE ||
+                   (e.ai_type == AIType::ORBITAL_COMBAT && e.role == CombatRole::HVA);
+        case PhysicsType::FLIGHT_3DOF:
+            return flight && (e.ai_type == AIType::NONE || e.ai_type == AIType::WAYPOINT_PATROL);
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+std::vector<EntityHandle> SharedEphemeris::select(const MCWorld& prototype, bool flight,
+                                                  size_t steps, size_t budget_bytes) {
+    const auto& entities = prototype.entities();
+
+    // Liveness an event can flip is not the prototype's to promise
+    std::vector<uint8_t> switched(entities.size(), 0);
+    for (const ScenarioEvent& ev : prototype.events) {
+        const EventAction& a = ev.action;
+        if ((a.kind == ActionKind::SET_ACTIVE || a.kind == ActionKind::SET_DESTROYED) &&
+            a.entity < entities.size()) {
+            switched[a.entity] = 1;
+        }
+    }
+
+    std::vector<EntityHandle> out;
+    size_t bytes = 0;
+    for (EntityHandle h = 0; h < entities.size(); h++) {
+        const MCEntity& e = entities[h];
+        if (!prototype.alive(h) || switched[h] || !deterministic(e, flight)) continue;
+        size_t cost = steps * (e.physics_type == PhysicsType::ORBITAL_2BODY
+                               ? sizeof(OrbitSample) : sizeof(FlightSample));
+        if (bytes + cost > budget_bytes) continue;
+        bytes += cost;
+        out.push_back(h);
+    }
+    return out;
+}
+
+SharedEphemeris::SharedEphemeris(const MCWorld& prototype,
+                                 const std::vector<EntityHandle>& entities,
+                                 size_t steps, double dt)
+    : dt_(dt), steps_(steps), entities_(entities) {
+    const auto& all = prototype.entities();
+    slot_.assign(all.size(), NO_ENTITY);
+    flight_.assign(all.size(), 0);
+    uint32_t orbital = 0, flight = 0;
+    for (EntityHandle h : entities_) {
+        if (all[h].physics_type == PhysicsType::ORBITAL_2BODY) {
+            slot_[h] = orbital++;
+        } else {
+            slot_[h] = flight++;
+            flight_[h] = 1;
+        }
+    }
+    orbital_ = orbital;
+    orbit_rows_.resize(steps * orbital);
+    flight_rows_.resize(steps * flight);
+}
+
+void SharedEphemeris::record(size_t step, const MCWorld& world) {
+    const auto& all = world.entities();
+    OrbitSample* orbit_row = orbit_rows_.data() + step * orbital_;
+    FlightSample* flight_row = flight_rows_.data() + step * flight_count();
+    for (EntityHandle h : entities_) {
+        const MCEntity& e = all[h];
+        if (flight_[h]) {
+            flight_row[slot_[h]] = {e.geo_lat, e.geo_lon, e.geo_alt, e.flight_speed,
+                                    e.flight_heading, e.flight_gamma, e.flight_mach};
+        } else {
+            orbit_row[slot_[h]] = {e.eci_pos, e.eci_vel};
+        }
+    }
+}
+
+void SharedEphemeris::replay(double sim_time, EntityHandle h, MCEntity& e) const {
+    // Runs accumulate sim_time exactly as the tabulating pass did
+    const long tick = std::lround(sim_time / dt_);
+    if (tick < 1 || static_cast<size_t>(tick) > steps_) {
+        throw std::out_of_range("SharedEphemeris: no row for t=" + std::to_string(sim_time));
+    }
+    const size_t step = static_cast<size_t>(tick - 1);
+    if (flight_[h]) {
+        const FlightSample& s = flight_rows_[step * flight_count() + slot_[h]];
+        e.geo_lat = s.lat;
+        e.geo_lon = s.lon;
+        e.geo_alt = s.alt;
+        e.flight_speed = s.speed;
+        e.flight_heading = s.heading;
+        e.flight_gamma = s.gamma;
+        e.flight_mach = s.mach;
+    } else {
+        const OrbitSample& s = orbit_rows_[step * orbital_ + slot_[h]];
+        e.eci_pos = s.pos;
+        e.eci_vel = s.vel;
+    }
+}
+
+} // namespace sim::mc
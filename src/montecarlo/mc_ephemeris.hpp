@@ -0,0 +1,105 @@
+/**
+ * SharedEphemeris — Tabulated motion of a prototype's deterministic
+ * entities, shared read-only by every run of a batch
+ * (MCConfig::shared_ephemeris).
+ *
+ * Many entities in a scenario move the same way in every run: orbits with
+ * no combat AI and the HVAs (OrbitalCombatAI leaves them alone), aircraft
+ * with no AI or on waypoint patrol (WaypointPatrolAI reads only the
+ * aircraft itself and draws nothing). select() picks them from the
+ * prototype; MCRunner steps a copy of the prototype with everything else
+ * switched off, through its own AI / orbit / Flight3DOF stages, and
+ * record()s their state after every tick. Runs then copy a row in place
+ * of propagating the entity (MCWorld::replays / replay).
+ *
+ * Only motion is tabulated: a replayed entity keeps its sensors, weapons
+ * and AI state, can be killed (it then stops, as it would), and leaves
+ * the table for good the first time its motion is perturbed, i.e. a burn
+ * sets MCEntity::orbit_dirty or a viewer takes control; it is stepped
+ * live from the tabulated state from then on.
+ *
+ * select() leaves out entities that are not alive at t = 0 and those a
+ * scenario event activates or destroys. Rows are tick-major, so a tick
+ * reads one contiguous row per kind; entities are taken in handle order
+ * until the byte budget is spent, the rest stay live. Storage is charged
+ * to MemoryTag::EPHEMERIS.
+ */
+
+#ifndef SIM_MC_MC_EPHEMERIS_HPP
+#define SIM_MC_MC_EPHEMERIS_HPP
+
+#include "mc_world.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace sim::mc {
+
+class SharedEphemeris {
+public:
+    /** One orbital entity at the end of a tick (ECI). */
+    struct OrbitSample {
+        Vec3 pos;
+        Vec3 vel;
+    };
+
+    /** One aircraft at the end of a tick (the fields Flight3DOF writes). */
+    struct FlightSample {
+        double lat, lon, alt;             // deg, deg, m
+        double speed, heading, gamma;     // m/s, rad, rad
+        double mach;
+    };
+
+    /**
+     * Deterministic entities of `prototype`, ascending by handle, as many
+     * as `steps` rows of fit in `budget_bytes`. Aircraft only with
+     * `flight` (FlightLOD steps them otherwise).
+     */
+    static std::vector<EntityHandle> select(const MCWorld& prototype, bool flight,
+                                            size_t steps, size_t budget_bytes);
+
+    /** Empty table of `steps` rows for the selected `entities`. */
+    SharedEphemeris(const MCWorld& prototype, const std::vector<EntityHandle>& entities,
+                    size_t steps, double dt);
+
+    /** Fill row `step` (the state after tick step + 1) from `world`. */
+    void record(size_t step, const MCWorld& world);
+
+    /**
+     * Copy entity h's tabulated state at world time `sim_time` (the end
+     * of a tick) into e.
+     * @throws std::out_of_range past the last row
+     */
+    void replay(double sim_time, EntityHandle h, MCEntity& e) const;
+
+    bool contains(EntityHandle h) const {
+        return h < slot_.size() && slot_[h] != NO_ENTITY;
+    }
+
+    /** Tabulated entities, ascending by handle. */
+    const std::vector<EntityHandle>& entities() const { return entities_; }
+
+    size_t orbital_count() const { return orbital_; }
+    size_t flight_count() const { return entities_.size() - orbital_; }
+    size_t steps() const { return steps_; }
+    size_t bytes() const {
+        return orbit_rows_.size() * sizeof(OrbitSample) +
+               flight_rows_.size() * sizeof(FlightSample);
+    }
+
+private:
+    template <typename T>
+    using Rows = std::vector<T, TrackedAllocator<T, MemoryTag::EPHEMERIS>>;
+
+    double dt_;
+    size_t steps_;
+    size_t orbital_ = 0;                   // orbital entries of entities_
+    std::vector<EntityHandle> entities_;
+    std::vector<uint32_t> slot_;           // by handle: column in its kind's rows
+    std::vector<uint8_t> flight_;          // by handle: tabulated as an aircraft
+    Rows<OrbitSample> orbit_rows_;         // [step][orbital column]
+    Rows<FlightSample> flight_rows_;       // [step][flight column]
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_EPHEMERIS_HPP
@@ -0,0 +1,551 @@
+#include "mc_live_server.hpp"
+#include "mc_runner.hpp"
+#include "replay_writer.hpp"
+#include "distributed/state_sync.hpp"
+#include "distributed/websocket.hpp"
+#include "io/json_reader.hpp"
+#include "io/json_writer.hpp"
+
+#include <poll.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace sim::mc {
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr double OMEGA_EARTH = 7.2921159e-5;  // rad/s
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+namespace {
+
+std::string make_message(const std::function<void(sim::JsonWriter&)>& body) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, 0);
+    w.begin_object();
+    body(w);
+    w.end_object();
+    return os.str();
+}
+
+std::string ack_message(int seq, int tick) {
+    return make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "ack");
+        w.kv("seq", seq);
+        w.kv("tick", tick);
+    });
+}
+
+std::string error_message(int seq, const std::string& what) {
+    return make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "error");
+        w.kv("seq", seq);
+        w.kv("message", what);
+    });
+}
+
+const char* physics_name(PhysicsType type) {
+    switch (type) {
+        case PhysicsType::ORBITAL_2BODY: return "orbital";
+        case PhysicsType::FLIGHT_3DOF:   return "flight";
+        case PhysicsType::STATIC:        return "static";
+        default:                         return "none";
+    }
+}
+
+Vec3 ecef_velocity(const MCEntity& e, double sim_time) {
+    switch (e.physics_type) {
+        case PhysicsType::ORBITAL_2BODY: {
+            // Rotate into ECEF and remove the frame rotation, omega x r
+            Vec3 v = ReplayWriter::eci_to_ecef(e.eci_vel, sim_time);
+            Vec3 r = ReplayWriter::eci_to_ecef(e.eci_pos, sim_time);
+            return Vec3{v.x + OMEGA_EARTH * r.y, v.y - OMEGA_EARTH * r.x, v.z};
+        }
+        case PhysicsType::FLIGHT_3DOF: {
+            double lat = e.geo_lat * DEG_TO_RAD, lon = e.geo_lon * DEG_TO_RAD;
+            double ve = e.flight_speed * std::cos(e.flight_gamma) * std::sin(e.flight_heading);
+            double vn = e.flight_speed * std::cos(e.flight_gamma) * std::cos(e.flight_heading);
+            double vu = e.flight_speed * std::sin(e.flight_gamma);
+            double sl = std::sin(lat), cl = std::cos(lat);
+            double so = std::sin(lon), co = std::cos(lon);
+            return Vec3{-so * ve - sl * co * vn + cl * co * vu,
+                         co * ve - sl * so * vn + cl * so * vu,
+                         cl * vn + sl * vu};
+        }
+        default:
+            return Vec3{0, 0, 0};
+    }
+}
+
+double seconds(Clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+} // namespace
+
+struct MCLiveServer::Client {
+    uint64_t id = 0;
+    distributed::WebSocket ws;
+    distributed::SyncInterest interest;
+    distributed::DeltaFilter filter;
+    double frame_interval = 1.0 / 30.0;   // [s wall]
+    Clock::time_point next_frame;
+    size_t next_event = 0;                // engagement_log entries sent
+    bool closed = false;
+
+    void send(const std::string& text) {
+        if (!closed && !ws.send_text(text)) closed = true;
+    }
+};
+
+struct MCLiveServer::Command {
+    uint64_t client = 0;
+    int seq = -1;
+    sim::JsonValue msg;
+};
+
+struct MCLiveServer::State {
+    distributed::IPCSocket listener;
+    std::vector<std::unique_ptr<Client>> clients;
+    uint64_t next_client = 1;
+
+    std::multimap<int, Command> queue;                       // By tick, then arrival
+    std::unordered_map<EntityHandle, uint64_t> controller;   // Entity → client
+
+    int tick = 0;
+    double sim_time = 0.0;
+    double time_scale = 1.0;
+    bool paused = false;
+    Clock::time_point anchor_wall;                           // Pacing reference
+    double anchor_sim = 0.0;
+
+    // Frame scratch, records rebuilt once per tick boundary
+    bool records_built = false;
+    std::vector<distributed::wire::StateRecord> records;
+    std::vector<distributed::wire::StateRecord> delta;
+    std::vector<live_wire::EntityRecord> updates;
+    std::vector<uint32_t> removed;
+    std::string frame;
+
+    Client* find(uint64_t id) {
+        for (auto& c : clients) {
+            if (c->id == id) return c.get();
+        }
+        return nullptr;
+    }
+};
+
+MCLiveServer::MCLiveServer(const MCConfig& config, const LiveServerConfig& live)
+    : config_(config), live_(live) {}
+
+MCLiveServer::~MCLiveServer() = default;
+
+void MCLiveServer::serve(const MCWorld& prototype, const std::string& address) {
+    // A viewer closing its tab must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    State s;
+    s.listener = distributed::IPCSocket::listen(address);
+    s.time_scale = live_.time_scale;
+    if (config_.verbose) {
+        std::cerr << "[live] listening on " << address << ", waiting for a viewer\n";
+    }
+    while (s.clients.empty()) accept_clients(s, prototype, -1);
+
+    s.anchor_wall = Clock::now();
+    MCRunner runner(config_);
+    runner.set_profiler(profiler_);
+    runner.run_live(prototype, [&](MCWorld& world, int tick) {
+        return boundary(s, world, tick);
+    });
+
+    // The last boundary sent every viewer a final frame
+    const std::string end = make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "end");
+        w.kv("tick", s.tick);
+        w.kv("simTime", s.sim_time);
+    });
+    for (auto& c : s.clients) {
+        c->send(end);
+        c->ws.close();
+    }
+    s.listener.close();
+    if (config_.verbose) {
+        std::cerr << "[live] run ended at tick " << s.tick << ", " << frames_sent_
+                  << " frames sent\n";
+    }
+}
+
+bool MCLiveServer::boundary(State& s, MCWorld& world, int tick) {
+    s.tick = tick;
+    s.sim_time = world.sim_time;
+    s.records_built = false;
+    const int total_ticks = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    const bool last = tick >= total_ticks;
+
+    for (;;) {
+        accept_clients(s, world, 0);
+        read_clients(s, world);
+        apply_commands(s, world);
+        drop_closed(s, world);
+        if (s.clients.empty()) {
+            if (config_.verbose) std::cerr << "[live] last viewer left at tick " << tick << "\n";
+            return false;
+        }
+
+        Clock::time_point now = Clock::now();
+        send_frames(s, world, now, last);
+        if (last) return false;
+
+        // Wall time at which the world reaches its current sim time
+        double wait = 0.0;
+        if (s.paused) {
+            wait = std::numeric_limits<double>::infinity();
+        } else if (s.time_scale > 0.0) {
+            wait = (world.sim_time - s.anchor_sim) / s.time_scale - seconds(now - s.anchor_wall);
+        }
+        if (wait <= 0.0) break;
+
+        for (auto& c : s.clients) wait = std::min(wait, seconds(c->next_frame - now));
+        wait_clients(s, std::max(wait, 0.0));
+    }
+    return true;
+}
+
+void MCLiveServer::accept_clients(State& s, const MCWorld& world, int timeout_ms) {
+    for (;;) {
+        auto client = std::make_unique<Client>();
+        try {
+            if (!distributed::WebSocket::accept(s.listener, client->ws, timeout_ms,
+                                                live_.handshake_timeout_ms)) {
+                return;
+            }
+        } catch (const std::exception& e) {
+            if (config_.verbose) std::cerr << "[live] rejected a connection: " << e.what() << "\n";
+            continue;
+        }
+        timeout_ms = 0;
+
+        Client& c = *client;
+        c.id = s.next_client++;
+        c.frame_interval = 1.0 / std::max(live_.fps, 1e-3);
+        c.next_frame = Clock::now();
+        c.next_event = world.engagement_log.size();
+        c.interest.position_tolerance = live_.tolerance;
+        c.interest.velocity_tolerance = std::numeric_limits<double>::infinity();
+        c.interest.dead_reckoning = true;
+
+        const auto& entities = world.entities();
+        c.send(make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "hello");
+            w.kv("tick", s.tick);
+            w.kv("simTime", world.sim_time);
+            w.kv("dt", config_.dt);
+            w.kv("maxTime", config_.max_sim_time);
+            w.kv("timeScale", s.time_scale);
+            w.kv("quantum", live_.quantum);
+            w.key("entities").begin_array();
+            for (size_t h = 0; h < entities.size(); h++) {
+                const MCEntity& e = entities[h];
+                w.begin_object();
+                w.kv("h", h);
+                w.kv("id", e.id);
+                w.kv("name", e.name);
+                w.kv("type", e.type);
+                w.kv("team", e.team);
+                w.kv("physics", physics_name(e.physics_type));
+                w.end_object();
+            }
+            w.end_array();
+        }));
+        if (config_.verbose) {
+            std::cerr << "[live] viewer " << c.id << " connected (" << c.ws.path() << ")\n";
+        }
+        s.clients.push_back(std::move(client));
+    }
+}
+
+void MCLiveServer::wait_clients(State& s, double seconds_max) {
+    std::vector<struct pollfd> fds;
+    fds.reserve(s.clients.size() + 1);
+    fds.push_back({s.listener.native_handle(), POLLIN, 0});
+    for (auto& c : s.clients) fds.push_back({c->ws.native_handle(), POLLIN, 0});
+    const int timeout_ms = std::isfinite(seconds_max)
+        ? static_cast<int>(std::ceil(std::min(seconds_max, 1.0) * 1000.0)) : 1000;
+    ::poll(fds.data(), fds.size(), timeout_ms);
+}
+
+void MCLiveServer::read_clients(State& s, MCWorld& world) {
+    std::string text;
+    bool binary = false;
+    for (auto& cp : s.clients) {
+        Client& c = *cp;
+        if (c.closed) continue;
+        try {
+            while (c.ws.receive_ready(text, binary)) {
+                if (!binary) handle_message(s, c, world, text);
+            }
+        } catch (const std::exception&) {
+            c.closed = true;
+        }
+    }
+}
+
+void MCLiveServer::handle_message(State& s, Client& c, MCWorld& world, const std::string& text) {
+    sim::JsonValue msg;
+    try {
+        msg = sim::JsonReader::parse(text);
+    } catch (const std::exception& e) {
+        c.send(error_message(-1, std::string("bad message: ") + e.what()));
+        return;
+    }
+    const std::string type = msg["type"].get_string();
+    const int seq = msg["seq"].get_int(-1);
+
+    if (type == "subscribe") {
+        if (msg["fps"].is_number()) {
+            c.frame_interval = 1.0 / std::clamp(msg["fps"].as_number(), 1e-3, 240.0);
+        }
+        if (msg["tolerance"].is_number()) {
+            c.interest.position_tolerance = std::max(msg["tolerance"].as_number(), 0.0);
+        }
+        if (msg.has("ids")) {
+            c.interest.entity_ids.clear();
+            const sim::JsonValue ids = msg["ids"];
+            for (size_t i = 0; ids[i].is_string(); i++) {
+                const EntityHandle h = world.find_handle(ids[i].as_string());
+                if (h == NO_ENTITY) {
+                    c.send(error_message(seq, "unknown entity " + ids[i].as_string()));
+                    continue;
+                }
+                c.interest.entity_ids.push_back(static_cast<int>(h));
+            }
+        }
+        if (msg.has("box")) {
+            const sim::JsonValue box = msg["box"];
+            c.interest.use_box = box[5].is_number();
+            for (int k = 0; k < 3 && c.interest.use_box; k++) {
+                c.interest.box_min[k] = box[k].as_number();
+                c.interest.box_max[k] = box[k + 3].as_number();
+            }
+        }
+        c.filter.reset();
+        c.next_frame = Clock::now();
+        c.send(ack_message(seq, s.tick));
+    } else if (type == "speed") {
+        if (msg["scale"].is_number()) s.time_scale = std::max(msg["scale"].as_number(), 0.0);
+        if (msg["paused"].is_bool()) s.paused = msg["paused"].as_bool();
+        s.anchor_wall = Clock::now();
+        s.anchor_sim = world.sim_time;
+        c.send(ack_message(seq, s.tick));
+    } else if (type == "control" || type == "maneuver") {
+        Command cmd;
+        cmd.client = c.id;
+        cmd.seq = seq;
+        cmd.msg = msg;
+        s.queue.emplace(std::max(msg["tick"].get_int(s.tick), s.tick), std::move(cmd));
+    } else {
+        c.send(error_message(seq, "unknown message type '" + type + "'"));
+    }
+}
+
+void MCLiveServer::apply_commands(State& s, MCWorld& world) {
+    while (!s.queue.empty() && s.queue.begin()->first <= s.tick) {
+        Command cmd = std::move(s.queue.begin()->second);
+        s.queue.erase(s.queue.begin());
+        Client* c = s.find(cmd.client);
+        if (!c || c->closed) continue;
+
+        const std::string id = cmd.msg["id"].get_string();
+        const EntityHandle h = world.find_handle(id);
+        if (h == NO_ENTITY) {
+            c->send(error_message(cmd.seq, "unknown entity " + id));
+            continue;
+        }
+        MCEntity& e = world.entities()[h];
+        auto owner = s.controller.find(h);
+
+        if (cmd.msg["type"].get_string() == "control") {
+            if (cmd.msg["release"].get_bool(false)) {
+                if (owner != s.controller.end() && owner->second == c->id) {
+                    s.controller.erase(owner);
+                    e.player_controlled = false;
+                }
+            } else if (e.physics_type != PhysicsType::ORBITAL_2BODY &&
+                       e.physics_type != PhysicsType::FLIGHT_3DOF) {
+                c->send(error_message(cmd.seq, id + " cannot be controlled"));
+                continue;
+            } else if (!world.alive(h)) {
+                c->send(error_message(cmd.seq, id + " is destroyed"));
+                continue;
+            } else if (owner != s.controller.end() && owner->second != c->id) {
+                c->send(error_message(cmd.seq, id + " is controlled by another viewer"));
+                continue;
+            } else {
+                s.controller[h] = c->id;
+                e.player_controlled = true;
+            }
+            c->send(ack_message(cmd.seq, s.tick));
+            continue;
+        }
+
+        // Maneuver
+        if (owner == s.controller.end() || owner->second != c->id) {
+            c->send(error_message(cmd.seq, "not in control of " + id));
+            continue;
+        }
+        if (!world.alive(h)) {
+            c->send(error_message(cmd.seq, id + " is destroyed"));
+            continue;
+        }
+        if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+            const sim::JsonValue dv = cmd.msg["dv"];
+            if (!dv[2].is_number()) {
+                c->send(error_message(cmd.seq, "maneuver needs \"dv\": [x, y, z]"));
+                continue;
+            }
+            world.refresh_orbit(h);
+            e.eci_vel.x += dv[0].as_number();
+            e.eci_vel.y += dv[1].as_number();
+            e.eci_vel.z += dv[2].as_number();
+            e.orbit_dirty = true;
+        } else {
+            const sim::JsonValue& m = cmd.msg;
+            if (m["roll"].is_number()) e.flight_roll = std::clamp(m["roll"].as_number(), -1.4, 1.4);
+            if (m["throttle"].is_number()) {
+                e.flight_throttle = std::clamp(m["throttle"].as_number(), 0.0, 1.0);
+            }
+            if (m["alpha"].is_number()) {
+                e.flight_alpha = std::clamp(m["alpha"].as_number(), -e.ac_max_aoa_rad,
+                                            e.ac_max_aoa_rad);
+            }
+        }
+        c->send(ack_message(cmd.seq, s.tick));
+    }
+}
+
+void MCLiveServer::drop_closed(State& s, MCWorld& world) {
+    for (auto it = s.clients.begin(); it != s.clients.end(); ) {
+        if (!(*it)->closed) {
+            ++it;
+            continue;
+        }
+        const uint64_t id = (*it)->id;
+        for (auto c = s.controller.begin(); c != s.controller.end(); ) {
+            if (c->second == id) {
+                world.entities()[c->first].player_controlled = false;
+                c = s.controller.erase(c);
+            } else {
+                ++c;
+            }
+        }
+        (*it)->ws.close();
+        if (config_.verbose) std::cerr << "[live] viewer " << id << " disconnected\n";
+        it = s.clients.erase(it);
+    }
+}
+
+void MCLiveServer::build_records(State& s, MCWorld& world) {
+    using distributed::wire::StateRecord;
+    world.refresh_orbits();
+    const std::vector<Vec3>& ecef = world.ecef_all();
+    const auto& entities = world.entities();
+
+    s.records.resize(entities.size());
+    for (size_t h = 0; h < entities.size(); h++) {
+        const MCEntity& e = entities[h];
+        StateRecord& r = s.records[h];
+        std::memset(&r, 0, sizeof(r));
+        r.entity_id = static_cast<int32_t>(h);
+        r.time = world.sim_time;
+        if (e.physics_type == PhysicsType::NONE || !world.alive(h)) {
+            r.reserved = distributed::wire::RECORD_REMOVED;
+            continue;
+        }
+        const Vec3 v = ecef_velocity(e, world.sim_time);
+        r.state[0] = ecef[h].x;
+        r.state[1] = ecef[h].y;
+        r.state[2] = ecef[h].z;
+        r.state[3] = v.x;
+        r.state[4] = v.y;
+        r.state[5] = v.z;
+    }
+    s.records_built = true;
+}
+
+void MCLiveServer::send_frames(State& s, MCWorld& world, Clock::time_point now, bool force) {
+    for (auto& cp : s.clients) {
+        Client& c = *cp;
+        if (c.closed || (!force && c.next_frame > now)) continue;
+        c.next_frame += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(c.frame_interval));
+        if (c.next_frame <= now) {
+            c.next_frame = now + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(c.frame_interval));
+        }
+
+        // Engagements since this viewer's last frame
+        for (; c.next_event < world.engagement_log.size(); c.next_event++) {
+            const EngagementRecord& eng = world.engagement_log[c.next_event];
+            c.send(make_message([&](sim::JsonWriter& w) {
+                w.kv("type", "event");
+                w.kv("time", eng.time);
+                w.kv("result", engagement_result_to_string(eng.result));
+                w.kv("source", static_cast<int64_t>(eng.source));
+                w.kv("target", eng.target == NO_ENTITY ? int64_t(-1)
+                                                       : static_cast<int64_t>(eng.target));
+            }));
+        }
+
+        if (!s.records_built) build_records(s, world);
+        s.delta.clear();
+        c.filter.filter(c.interest, s.records.data(), s.records.size(), s.delta);
+
+        s.updates.clear();
+        s.removed.clear();
+        const double inv_quantum = 1.0 / live_.quantum;
+        for (const auto& r : s.delta) {
+            if (r.reserved & distributed::wire::RECORD_REMOVED) {
+                s.removed.push_back(static_cast<uint32_t>(r.entity_id));
+                continue;
+            }
+            live_wire::EntityRecord u;
+            u.handle = static_cast<uint32_t>(r.entity_id);
+            for (int k = 0; k < 3; k++) {
+                u.pos[k] = static_cast<int32_t>(std::clamp(std::lround(r.state[k] * inv_quantum),
+                                                           long(INT32_MIN), long(INT32_MAX)));
+                u.vel[k] = static_cast<float>(r.state[k + 3]);
+            }
+            s.updates.push_back(u);
+        }
+
+        live_wire::FrameHeader header;
+        std::memcpy(header.magic, live_wire::FRAME_MAGIC, 4);
+        header.tick = static_cast<uint32_t>(s.tick);
+        header.sim_time = world.sim_time;
+        header.quantum = static_cast<float>(live_.quantum);
+        header.count = static_cast<uint32_t>(s.updates.size());
+        header.removed = static_cast<uint32_t>(s.removed.size());
+        header.record_bytes = sizeof(live_wire::EntityRecord);
+
+        s.frame.assign(reinterpret_cast<const char*>(&header), sizeof(header));
+        s.frame.append(reinterpret_cast<const char*>(s.updates.data()),
+                       s.updates.size() * sizeof(live_wire::EntityRecord));
+        s.frame.append(reinterpret_cast<const char*>(s.removed.data()),
+                       s.removed.size() * sizeof(uint32_t));
+        if (!c.closed && !c.ws.send_binary(s.frame.data(), s.frame.size())) c.closed = true;
+        frames_sent_++;
+    }
+}
+
+} // namespace sim::mc
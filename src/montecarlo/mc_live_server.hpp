@@ -0,0 +1,143 @@
+/**
+ * MCLiveServer — One simulation run natively and streamed to the Cesium
+ * live viewer (mc_engine --live).
+ *
+ * The viewer (visualization/cesium/live_sim_viewer.html?stream=ws://...)
+ * then only renders: the run is MCRunner::run_live() paced against the
+ * wall clock, and each viewer receives binary state deltas over a
+ * WebSocket (distributed::WebSocket; tls:// listens for wss://) at its own
+ * frame rate.
+ *
+ * Deltas: every frame the alive entities' ECEF states go through the
+ * viewer's distributed::DeltaFilter with dead reckoning, so an entity is
+ * sent when it enters the viewer's interest set or when its position has
+ * drifted more than the viewer's tolerance from the last update carried
+ * forward at that update's velocity. Entities that leave the interest set
+ * or are destroyed are sent as removals. Positions are quantized to
+ * int32 multiples of `quantum` metres (+/- 2.1e6 km at 1 m).
+ *
+ * Binary frame (little-endian, as every supported host and browser is):
+ *   live_wire::FrameHeader, `count` live_wire::EntityRecord updates, then
+ *   `removed` uint32 entity handles.
+ *
+ * Server → viewer (text):
+ *   { "type": "hello", "tick", "simTime", "dt", "maxTime", "timeScale",
+ *     "quantum", "entities": [ { "h", "id", "name", "type", "team",
+ *     "physics": "orbital" | "flight" | "static" | "none" }, ... ] }
+ *   { "type": "event", "time", "result": "LAUNCH" | "KILL" | "MISS",
+ *     "source", "target" }                       // engagements, by handle
+ *   { "type": "ack", "seq", "tick" }              // command applied at tick
+ *   { "type": "error", "seq", "message" }
+ *   { "type": "end", "tick", "simTime" }
+ *
+ * Viewer → server (text), each with an optional "seq" echoed back:
+ *   subscribe  { "fps", "ids": ["id", ...], "box": [6] (ECEF min, max [m]),
+ *                "tolerance" [m] }   // all optional; resends everything
+ *   control    { "id", "release": false }   // AI off, the viewer flies it
+ *   maneuver   { "id", "dv": [3] (ECI [m/s]) }               // orbital
+ *              { "id", "roll" [rad], "throttle", "alpha" [rad] }   // flight
+ *   speed      { "scale", "paused" }
+ *
+ * Commands that change the world (control, maneuver) take an optional
+ * "tick": they apply at that tick boundary (one the run has passed, or no
+ * tick, means the next), in (tick, arrival) order, never during a tick.
+ * Frames carry the tick count, so a viewer can aim a command at a tick it
+ * knows every other viewer will see it at. A maneuver needs control of
+ * the entity; control is exclusive and released on disconnect.
+ *
+ * The run starts when the first viewer connects and ends at max_sim_time
+ * or when the last viewer disconnects.
+ */
+
+#ifndef SIM_MC_MC_LIVE_SERVER_HPP
+#define SIM_MC_MC_LIVE_SERVER_HPP
+
+#include "mc_world.hpp"
+#include "mc_profiler.hpp"
+#include "scenario_parser.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace sim::mc {
+
+namespace live_wire {
+
+constexpr char FRAME_MAGIC[4] = {'L', 'S', 'B', '1'};
+
+#pragma pack(push, 1)
+struct FrameHeader {
+    char     magic[4];
+    uint32_t tick;           // Ticks run so far
+    double   sim_time;       // [s]
+    float    quantum;        // Position units [m]
+    uint32_t count;          // EntityRecords that follow
+    uint32_t removed;        // Handles after them
+    uint32_t record_bytes;   // sizeof(EntityRecord)
+};
+
+struct EntityRecord {
+    uint32_t handle;
+    int32_t  pos[3];         // ECEF / quantum
+    float    vel[3];         // ECEF [m/s]
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FrameHeader) == 32, "live frame header layout");
+static_assert(sizeof(EntityRecord) == 28, "live entity record layout");
+
+} // namespace live_wire
+
+struct LiveServerConfig {
+    double time_scale = 1.0;          // Sim seconds per wall second (0 = no pacing)
+    double fps = 30.0;                // Frame rate until a viewer subscribes
+    double tolerance = 10.0;          // Dead-reckoning error until a viewer subscribes [m]
+    double quantum = 1.0;             // Position quantum [m]
+    int handshake_timeout_ms = 2000;
+};
+
+class MCLiveServer {
+public:
+    MCLiveServer(const MCConfig& config, const LiveServerConfig& live = LiveServerConfig());
+    ~MCLiveServer();
+
+    /**
+     * Listen on `address` ("tcp://:8765", or tls:// for wss://), wait for
+     * the first viewer and stream one run of `prototype`.
+     * @throws std::runtime_error if the address cannot be listened on
+     */
+    void serve(const MCWorld& prototype, const std::string& address);
+
+    /** Time the run's ticks into `profiler` (null = off). */
+    void set_profiler(TickProfiler* profiler) { profiler_ = profiler; }
+
+    /** Binary frames sent to all viewers so far. */
+    uint64_t frames_sent() const { return frames_sent_; }
+
+private:
+    struct Client;
+    struct Command;
+    struct State;
+
+    bool boundary(State& s, MCWorld& world, int tick);
+    void accept_clients(State& s, const MCWorld& world, int timeout_ms);
+    void wait_clients(State& s, double seconds_max);
+    void read_clients(State& s, MCWorld& world);
+    void handle_message(State& s, Client& c, MCWorld& world, const std::string& text);
+    void apply_commands(State& s, MCWorld& world);
+    void drop_closed(State& s, MCWorld& world);
+    void build_records(State& s, MCWorld& world);
+    void send_frames(State& s, MCWorld& world, std::chrono::steady_clock::time_point now,
+                     bool force);
+
+    MCConfig config_;
+    LiveServerConfig live_;
+    TickProfiler* profiler_ = nullptr;
+    uint64_t frames_sent_ = 0;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_LIVE_SERVER_HPP
@@ -0,0 +1,185 @@
+#include "montecarlo/mc_profiler.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace sim::mc {
+
+namespace {
+
+std::atomic<uint64_t> next_profiler_id{1};
+
+// Last profiler this thread recorded into, and its buffer there
+struct LocalCache {
+    uint64_t owner = 0;
+    void* buffer = nullptr;
+};
+thread_local LocalCache local_cache;
+
+} // namespace
+
+const char* profile_system_name(ProfileSystem s) {
+    switch (s) {
+        case ProfileSystem::TICK:               return "tick";
+        case ProfileSystem::ORBITAL_COMBAT_AI:  return "OrbitalCombatAI";
+        case ProfileSystem::WAYPOINT_PATROL_AI: return "WaypointPatrolAI";
+        case ProfileSystem::INTERCEPT_AI:       return "InterceptAI";
+        case ProfileSystem::KEPLER:             return "Kepler";
+        case ProfileSystem::FLIGHT_3DOF:        return "Flight3DOF";
+        case ProfileSystem::MISSILE_FLYOUT:     return "MissileFlyout";
+        case ProfileSystem::RADAR:              return "RadarSensor";
+        case ProfileSystem::COMMS:              return "CommNetwork";
+        case ProfileSystem::KINETIC_KILL:       return "KineticKill";
+        case ProfileSystem::IADS:               return "IADSCommand";
+        case ProfileSystem::SAM_BATTERY:        return "SAMBattery";
+        case ProfileSystem::A2A_MISSILE:        return "A2AMissile";
+        case ProfileSystem::EVENTS:             return "EventSystem";
+        default:                                return "unknown";
+    }
+}
+
+TickProfiler::TickProfiler(uint32_t sample_every)
+    : id_(next_profiler_id.fetch_add(1)), sample_every_(std::max<uint32_t>(sample_every, 1)),
+      origin_(Clock::now()) {}
+
+TickProfiler::Buffer& TickProfiler::local() {
+    if (local_cache.owner == id_) return *static_cast<Buffer*>(local_cache.buffer);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffers_.push_back(std::make_unique<Buffer>());
+    Buffer& buf = *buffers_.back();
+    buf.tid = static_cast<int>(buffers_.size());
+    local_cache.owner = id_;
+    local_cache.buffer = &buf;
+    return buf;
+}
+
+void TickProfiler::record(ProfileSystem sys, Clock::time_point start,
+                          Clock::time_point end, uint32_t entities) {
+    Buffer& buf = local();
+    uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+    // Single writer: plain load and store, no read-modify-write
+    SharedTotals& t = buf.totals[static_cast<size_t>(sys)];
+    auto bump = [](std::atomic<uint64_t>& a, uint64_t n) {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    };
+    bump(t.calls, 1);
+    bump(t.ns, ns);
+    bump(t.entities, entities);
+
+    if (sys == ProfileSystem::TICK) buf.ticks++;
+    if (sample_every_ > 1) return;        // sampling keeps totals only
+
+    if (buf.trace.size() < TRACE_EVENTS_PER_THREAD) {
+        uint64_t start_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin_).count());
+        buf.trace.push_back(TraceEvent{start_ns, static_cast<uint32_t>(ns), entities,
+                                       buf.ticks - (sys == ProfileSystem::TICK), sys});
+    } else {
+        buf.dropped++;
+    }
+}
+
+std::array<TickProfiler::Totals, TickProfiler::NUM_SYSTEMS> TickProfiler::totals() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::array<Totals, NUM_SYSTEMS> sum{};
+    for (const auto& buf : buffers_) {
+        for (size_t s = 0; s < NUM_SYSTEMS; s++) {
+            sum[s].calls += buf->totals[s].calls.load(std::memory_order_relaxed);
+            sum[s].ns += buf->totals[s].ns.load(std::memory_order_relaxed);
+            sum[s].entities += buf->totals[s].entities.load(std::memory_order_relaxed);
+        }
+    }
+    return sum;
+}
+
+void TickProfiler::write_summary(std::ostream& out) const {
+    const std::array<Totals, NUM_SYSTEMS> sum = totals();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t dropped = 0;
+    for (const auto& buf : buffers_) dropped += buf->dropped;
+
+    const Totals& tick = sum[static_cast<size_t>(ProfileSystem::TICK)];
+    const double tick_ns = tick.ns > 0 ? static_cast<double>(tick.ns) : 1.0;
+    char line[160];
+
+    std::snprintf(line, sizeof(line),
+                  "=== Tick profile: %llu ticks, %.1f ms on %zu thread(s) ===\n",
+                  static_cast<unsigned long long>(tick.calls), tick.ns * 1e-6,
+                  buffers_.size());
+    out << line;
+    std::snprintf(line, sizeof(line), "%-18s %10s %11s %7s %10s %10s %10s\n",
+                  "system", "calls", "total ms", "% tick", "us/call", "ents/call", "ns/ent");
+    out << line;
+
+    uint64_t tracked_ns = 0;
+    for (size_t s = 1; s < NUM_SYSTEMS; s++) {
+        const Totals& t = sum[s];
+        tracked_ns += t.ns;
+        if (t.calls == 0) continue;
+        double calls = static_cast<double>(t.calls);
+        std::snprintf(line, sizeof(line),
+                      "%-18s %10llu %11.2f %6.1f%% %10.2f %10.1f %10.1f\n",
+                      profile_system_name(static_cast<ProfileSystem>(s)),
+                      static_cast<unsigned long long>(t.calls), t.ns * 1e-6,
+                      100.0 * t.ns / tick_ns, t.ns * 1e-3 / calls, t.entities / calls,
+                      t.entities > 0 ? static_cast<double>(t.ns) / t.entities : 0.0);
+        out << line;
+    }
+
+    // Tick glue: spatial invalidation, orbit catch-up
+    double other_ns = tick.ns > tracked_ns ? static_cast<double>(tick.ns - tracked_ns) : 0.0;
+    std::snprintf(line, sizeof(line), "%-18s %10s %11.2f %6.1f%%\n",
+                  "(untracked)", "", other_ns * 1e-6, 100.0 * other_ns / tick_ns);
+    out << line;
+
+    if (dropped > 0) {
+        out << "(trace capped: " << dropped << " events not in the trace, totals complete)\n";
+    }
+}
+
+void TickProfiler::write_trace(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    sim::JsonWriter w(out, 0);
+    w.begin_object();
+    w.kv("displayTimeUnit", "ms");
+    w.key("traceEvents").begin_array();
+    for (const auto& buf : buffers_) {
+        w.begin_object();
+        w.kv("name", "thread_name");
+        w.kv("ph", "M");
+        w.kv("pid", 0);
+        w.kv("tid", buf->tid);
+        w.key("args").begin_object();
+        w.kv("name", "worker " + std::to_string(buf->tid));
+        w.end_object();
+        w.end_object();
+
+        for (const TraceEvent& e : buf->trace) {
+            w.begin_object();
+            w.kv("name", profile_system_name(e.sys));
+            w.kv("cat", e.sys == ProfileSystem::TICK ? "tick" : "system");
+            w.kv("ph", "X");
+            w.kv("ts", e.start_ns * 1e-3);
+            w.kv("dur", e.dur_ns * 1e-3);
+            w.kv("pid", 0);
+            w.kv("tid", buf->tid);
+            w.key("args").begin_object();
+            w.kv("tick", static_cast<int64_t>(e.tick));
+            w.kv("entities", static_cast<int64_t>(e.entities));
+            w.end_object();
+            w.end_object();
+        }
+    }
+    w.end_array();
+    w.end_object();
+    out << "\n";
+}
+
+} // namespace sim::mc
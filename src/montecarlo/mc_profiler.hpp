@@ -0,0 +1,183 @@
+/**
+ * TickProfiler — Per-system wall time for MCRunner::tick (mc_engine --profile).
+ *
+ * Every system call in a tick is timed with steady_clock into a buffer
+ * owned by the calling thread, so worker threads never contend. Each
+ * record carries the size of the entity list the system walks, which
+ * separates "this system is slow" from "this scenario feeds it many
+ * entities". Two outputs:
+ *   - write_summary(): per-system calls, total time, share of tick time,
+ *     mean time per call, mean entities per call and time per entity
+ *     (totals() returns the same sums for tools such as mc_bench);
+ *   - write_trace(): Chrome trace-event JSON (chrome://tracing, Perfetto),
+ *     one complete ("X") event per tick and per system call, one track per
+ *     thread. Each thread keeps at most TRACE_EVENTS_PER_THREAD events;
+ *     totals always cover every call.
+ *
+ * With no profiler installed a tick pays one null check per system.
+ *
+ * A sampling profiler (sample_every > 1, as mc_engine --metrics installs
+ * for its per-system tick time) times only every Nth tick on each thread
+ * and keeps no trace; other ticks pay a thread-local counter check per
+ * system. Totals are kept in relaxed atomics, so totals() may be read
+ * while workers record (scaled by sample_every() for an estimate).
+ *
+ * RunProfile is the same split kept per run rather than per thread: a
+ * ProfileScope given one adds its call's time to the run's system total,
+ * profiler or not (MCRunner's tail report, see mc_tail_report.hpp).
+ */
+
+#ifndef SIM_MC_MC_PROFILER_HPP
+#define SIM_MC_MC_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace sim::mc {
+
+enum class ProfileSystem : uint8_t {
+    TICK,                // whole tick, including untracked glue
+    ORBITAL_COMBAT_AI,
+    WAYPOINT_PATROL_AI,
+    INTERCEPT_AI,
+    KEPLER,
+    FLIGHT_3DOF,
+    MISSILE_FLYOUT,
+    RADAR,
+    COMMS,
+    KINETIC_KILL,
+    IADS,
+    SAM_BATTERY,
+    A2A_MISSILE,
+    EVENTS,
+    COUNT
+};
+
+const char* profile_system_name(ProfileSystem s);
+
+class TickProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t NUM_SYSTEMS = static_cast<size_t>(ProfileSystem::COUNT);
+    static constexpr size_t TRACE_EVENTS_PER_THREAD = 1u << 18;
+
+    struct Totals {
+        uint64_t calls = 0;
+        uint64_t ns = 0;
+        uint64_t entities = 0;
+    };
+
+    /** @param sample_every Time every Nth tick per thread; > 1 keeps no trace */
+    explicit TickProfiler(uint32_t sample_every = 1);
+
+    uint32_t sample_every() const { return sample_every_; }
+
+    /**
+     * Whether a call of `sys` on this thread is timed: always when every
+     * tick is sampled, else decided per tick by the TICK call.
+     */
+    bool sampling(ProfileSystem sys) {
+        if (sample_every_ == 1) return true;
+        Buffer& buf = local();
+        if (sys == ProfileSystem::TICK) buf.sampled = buf.tick_seq++ % sample_every_ == 0;
+        return buf.sampled;
+    }
+
+    /** Add one timed call to the calling thread's buffer. */
+    void record(ProfileSystem sys, Clock::time_point start, Clock::time_point end,
+                uint32_t entities);
+
+    /** Summary table over all threads. */
+    void write_summary(std::ostream& out) const;
+
+    /** Chrome trace-event JSON over all threads. */
+    void write_trace(std::ostream& out) const;
+
+    /** Per-system totals over all threads, indexed by ProfileSystem. */
+    std::array<Totals, NUM_SYSTEMS> totals() const;
+
+private:
+    struct TraceEvent {
+        uint64_t start_ns;   // since the profiler was created
+        uint32_t dur_ns;
+        uint32_t entities;
+        uint32_t tick;
+        ProfileSystem sys;
+    };
+
+    /** Totals written by the owning thread only, readable by any. */
+    struct SharedTotals {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> ns{0};
+        std::atomic<uint64_t> entities{0};
+    };
+
+    struct Buffer {
+        int tid = 0;
+        uint32_t ticks = 0;      // completed TICK records
+        uint64_t dropped = 0;    // trace events past the cap
+        uint64_t tick_seq = 0;   // ticks seen, sampled or not
+        bool sampled = true;     // current tick is timed
+        std::array<SharedTotals, NUM_SYSTEMS> totals{};
+        std::vector<TraceEvent> trace;
+    };
+
+    Buffer& local();
+
+    const uint64_t id_;                  // tells thread-local caches apart
+    const uint32_t sample_every_;
+    const Clock::time_point origin_;
+    mutable std::mutex mutex_;           // guards buffers_ membership
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+
+/**
+ * One run's cost: ticks taken, wall time, and (with `systems`) time per
+ * system. Travels with the world, so a branched run carries its prefix's.
+ */
+struct RunProfile {
+    bool systems = false;        // ProfileScopes add their time to ns
+    uint64_t ticks = 0;
+    double wall_seconds = 0.0;
+    std::array<uint64_t, TickProfiler::NUM_SYSTEMS> ns{};
+};
+
+/** Times one system call; a no-op when `profiler` and `run` are null. */
+class ProfileScope {
+public:
+    ProfileScope(TickProfiler* profiler, ProfileSystem sys, size_t entities,
+                 RunProfile* run = nullptr)
+        : profiler_(profiler && profiler->sampling(sys) ? profiler : nullptr),
+          run_(run), sys_(sys), entities_(static_cast<uint32_t>(entities)) {
+        if (profiler_ || run_) start_ = TickProfiler::Clock::now();
+    }
+    ~ProfileScope() {
+        if (!profiler_ && !run_) return;
+        TickProfiler::Clock::time_point end = TickProfiler::Clock::now();
+        if (profiler_) profiler_->record(sys_, start_, end, entities_);
+        if (run_) {
+            run_->ns[static_cast<size_t>(sys_)] += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count());
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    TickProfiler* profiler_;
+    RunProfile* run_;
+    ProfileSystem sys_;
+    uint32_t entities_;
+    TickProfiler::Clock::time_point start_;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_PROFILER_HPP
@@ -0,0 +1,135 @@
+#include "montecarlo/mc_replay_select.hpp"
+#include "montecarlo/mc_results_bin.hpp"
+#include "montecarlo/mc_convergence.hpp"
+#include "io/json_reader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+bool has_prefix(const std::string& s, const char* prefix) {
+    return s.rfind(prefix, 0) == 0;
+}
+
+int count_results(const RunResult& run, const char* result) {
+    int n = 0;
+    for (const auto& e : run.engagement_log) {
+        if (e.result == result) n++;
+    }
+    return n;
+}
+
+} // namespace
+
+ReplaySelector::ReplaySelector(const ReplayQuery& query) : query_(query) {
+    for (const auto& f : query_.filters) {
+        bool known = f == "hva-lost" || f == "error" || f == "ok" ||
+                     (has_prefix(f, "lost:") && f.size() > 5) ||
+                     (has_prefix(f, "survived:") && f.size() > 9) ||
+                     (has_prefix(f, "win:") && f.size() > 4);
+        if (!known) throw std::invalid_argument("replay selection: unknown filter '" + f + "'");
+    }
+    const std::string& r = query_.rank;
+    if (r != "index" && r != "duration" && r != "engagements" && r != "kills" && r != "launches") {
+        throw std::invalid_argument("replay selection: unknown rank '" + r + "'");
+    }
+    if (query_.limit < 1) throw std::invalid_argument("replay selection: limit must be >= 1");
+}
+
+bool ReplaySelector::passes(const RunResult& run) const {
+    const bool ok = run.error.empty();
+    for (const auto& f : query_.filters) {
+        if (f == "error") {
+            if (ok) return false;
+            continue;
+        }
+        if (!ok) return false;
+        if (f == "ok") continue;
+
+        if (f == "hva-lost") {
+            bool lost = false;
+            for (const auto& kv : run.entity_survival) {
+                if (kv.second.role == "hva" && !kv.second.alive) { lost = true; break; }
+            }
+            if (!lost) return false;
+        } else if (has_prefix(f, "lost:") || has_prefix(f, "survived:")) {
+            const bool want_alive = has_prefix(f, "survived:");
+            auto it = run.entity_survival.find(f.substr(f.find(':') + 1));
+            if (it == run.entity_survival.end() || it->second.alive != want_alive) return false;
+        } else if (has_prefix(f, "win:")) {
+            if (!MetricSet::team_wins(run, f.substr(4))) return false;
+        }
+    }
+    return true;
+}
+
+double ReplaySelector::score(const RunResult& run) const {
+    const std::string& r = query_.rank;
+    if (r == "duration") return run.sim_time_final;
+    if (r == "engagements") return static_cast<double>(run.engagement_log.size());
+    if (r == "kills") return count_results(run, "KILL");
+    if (r == "launches") return count_results(run, "LAUNCH");
+    return -static_cast<double>(run.run_index);
+}
+
+void ReplaySelector::add(const RunResult& run) {
+    scanned_++;
+    if (!passes(run)) return;
+    matches_.push_back({run.run_index, run.seed, score(run), run.sim_time_final});
+}
+
+std::vector<SelectedRun> ReplaySelector::take() {
+    auto better = [](const SelectedRun& a, const SelectedRun& b) {
+        return a.score > b.score || (a.score == b.score && a.run_index < b.run_index);
+    };
+    const size_t keep = std::min(matches_.size(), static_cast<size_t>(query_.limit));
+    std::partial_sort(matches_.begin(), matches_.begin() + keep, matches_.end(), better);
+    std::vector<SelectedRun> out(matches_.begin(), matches_.begin() + keep);
+    if (query_.rank == "index") {
+        for (auto& s : out) s.score = s.run_index;
+    }
+    return out;
+}
+
+ReplaySelection select_replays(const std::string& results_path, const ReplayQuery& query) {
+    ReplaySelector selector(query);
+    ReplaySelection selection;
+
+    std::ifstream in(results_path, std::ios::binary);
+    if (!in.is_open()) throw std::runtime_error("cannot open results file: " + results_path);
+    char magic[sizeof(mcrb::MAGIC)] = {};
+    in.read(magic, sizeof(magic));
+    const bool binary = in.gcount() == sizeof(magic) &&
+                        std::memcmp(magic, mcrb::MAGIC, sizeof(magic)) == 0;
+
+    if (binary) {
+        in.seekg(0);
+        BinaryResultsReader reader(in);
+        selection.base_seed = reader.base_seed();
+        selection.num_runs = reader.num_runs();
+        RunResult run;
+        while (reader.next(run)) selector.add(run);
+    } else {
+        in.close();
+        sim::JsonValue root = sim::JsonReader::parse_file(results_path);
+        if (!root["runs"].is_array()) {
+            throw std::runtime_error(results_path + " has no \"runs\" array "
+                                     "(aggregate results cannot be replayed)");
+        }
+        selection.base_seed = root["config"]["baseSeed"].get_int();
+        selection.num_runs = root["config"]["numRuns"].get_int();
+        for (const sim::JsonValue& v : root["runs"].as_array()) selector.add(read_run_json(v));
+    }
+
+    if (selector.scanned() == 0) throw std::runtime_error(results_path + " holds no runs");
+    selection.scanned = selector.scanned();
+    selection.matched = selector.matched();
+    selection.runs = selector.take();
+    return selection;
+}
+
+} // namespace sim::mc
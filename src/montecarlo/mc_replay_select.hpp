@@ -0,0 +1,89 @@
+/**
+ * Replay selection — pick runs of a finished batch to re-simulate.
+ *
+ * A batch stores outcomes, not trajectories. To look at the interesting
+ * runs afterwards, select_replays() scans the batch's results file (JSON
+ * or .mcrb; the aggregate format keeps no runs), keeps the runs that pass
+ * every filter, ranks them and returns the top `limit`. MCRunner::
+ * run_replays() then re-simulates just those run indices with a
+ * ReplayWriter attached; with the batch's flags the re-simulation is the
+ * same run, seed for seed.
+ *
+ * Filters (ReplayQuery::filters, all must hold):
+ *   "hva-lost"        some HVA (role "hva") was destroyed
+ *   "lost:<id>"       entity `id` did not survive
+ *   "survived:<id>"   entity `id` survived
+ *   "win:<team>"      `team` won (as the "win:" convergence metric)
+ *   "error" / "ok"    the run errored / did not
+ *
+ * Ranks (ReplayQuery::rank), highest first, ties by run index:
+ *   "duration"     final sim time        "engagements"  engagement events
+ *   "kills"        KILL events           "launches"     LAUNCH events
+ *   "index"        run index, ascending (the default)
+ */
+
+#ifndef SIM_MC_MC_REPLAY_SELECT_HPP
+#define SIM_MC_MC_REPLAY_SELECT_HPP
+
+#include "mc_results.hpp"
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+struct ReplayQuery {
+    std::vector<std::string> filters;
+    std::string rank = "index";
+    int limit = 20;
+};
+
+struct SelectedRun {
+    int run_index = 0;
+    int seed = 0;
+    double score = 0.0;          // rank key
+    double sim_time_final = 0.0;
+};
+
+struct ReplaySelection {
+    int base_seed = 0;
+    int num_runs = 0;            // batch size from the results header
+    int scanned = 0;             // runs read
+    int matched = 0;             // runs passing every filter
+    std::vector<SelectedRun> runs;   // best first, at most limit
+};
+
+/**
+ * Streaming selection: add() every run, then take().
+ * @throws std::invalid_argument on an unknown filter or rank
+ */
+class ReplaySelector {
+public:
+    explicit ReplaySelector(const ReplayQuery& query);
+
+    void add(const RunResult& run);
+
+    /** Matches in rank order, truncated to the limit */
+    std::vector<SelectedRun> take();
+
+    int scanned() const { return scanned_; }
+    int matched() const { return static_cast<int>(matches_.size()); }
+
+private:
+    ReplayQuery query_;
+    std::vector<SelectedRun> matches_;
+    int scanned_ = 0;
+
+    bool passes(const RunResult& run) const;
+    double score(const RunResult& run) const;
+};
+
+/**
+ * Run the query over a results file (JSON or binary by its magic).
+ * @throws std::runtime_error if the file cannot be read or holds no runs
+ * @throws std::invalid_argument on a bad query
+ */
+ReplaySelection select_replays(const std::string& results_path, const ReplayQuery& query);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_REPLAY_SELECT_HPP
@@ -1,82 +1,209 @@
 #include "montecarlo/mc_results.hpp"
-#include "io/json_writer.hpp"
 
 namespace sim::mc {
 
-void write_results_json(const std::vector<RunResult>& results,
-                        int num_runs, int base_seed, double max_sim_time,
-                        std::ostream& out) {
-    sim::JsonWriter w(out);
+void ConvergenceReport::write_json(sim::JsonWriter& w) const {
+    w.begin_object();
+    w.kv("enabled", enabled);
+    w.kv("converged", converged);
+    w.kv("runsCompleted", runs_completed);
+    w.kv("targetHalfWidth", target_half_width);
+    w.kv("achievedHalfWidth", achieved_half_width);
+    w.key("metrics").begin_array();
+    for (const auto& m : metrics) {
+        w.begin_object();
+        w.kv("name", m.name);
+        w.kv("successes", static_cast<size_t>(m.successes));
+        w.kv("trials", static_cast<size_t>(m.trials));
+        w.kv("p", m.p);
+        w.kv("lo", m.lo);
+        w.kv("hi", m.hi);
+        w.kv("halfWidth", m.half_width());
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+}
 
+void VarianceReport::write_json(sim::JsonWriter& w) const {
     w.begin_object();
+    w.kv("method", method);
+    if (method == "lhs") {
+        w.kv("strata", static_cast<size_t>(strata));
+        w.key("dimensions").begin_array();
+        for (const auto& d : dimensions) w.value(d);
+        w.end_array();
+    }
+    if (!metrics.empty()) {
+        w.key("metrics").begin_array();
+        for (const auto& m : metrics) {
+            w.begin_object();
+            w.kv("name", m.name);
+            w.kv("pairs", static_cast<size_t>(m.pairs));
+            w.kv("mean", m.mean);
+            w.kv("halfWidth", m.half_width);
+            w.kv("independentHalfWidth", m.independent_half_width);
+            w.end_object();
+        }
+        w.end_array();
+    }
+    w.end_object();
+}
+
+JsonResultsWriter::JsonResultsWriter(std::ostream& out, int num_runs,
+                                     int base_seed, double max_sim_time)
+    : out_(out), w_(out) {
+    w_.begin_object();
 
     // ── config ──
-    w.key("config").begin_object();
-    w.kv("numRuns", num_runs);
-    w.kv("baseSeed", base_seed);
-    w.kv("maxSimTime", max_sim_time);
-    w.end_object();
+    w_.key("config").begin_object();
+    w_.kv("numRuns", num_runs);
+    w_.kv("baseSeed", base_seed);
+    w_.kv("maxSimTime", max_sim_time);
+    w_.end_object();
 
     // ── runs ──
-    w.key("runs").begin_array();
+    w_.key("runs").begin_array();
+}
 
-    for (const auto& run : results) {
-        w.begin_object();
+void JsonResultsWriter::write_run(const RunResult& run) {
+    write_run_json(w_, run);
+}
 
-        w.kv("runIndex", run.run_index);
-        w.kv("seed", run.seed);
-        w.kv("simTimeFinal", run.sim_time_final);
+void JsonResultsWriter::set_convergence(const ConvergenceReport& report) {
+    convergence_ = report;
+}
 
-        // error: null or string
-        if (run.error.empty()) {
-            w.key("error").null_value();
-        } else {
-            w.kv("error", run.error);
-        }
+void JsonResultsWriter::finish() {
+    w_.end_array();
+    if (convergence_.enabled) {
+        w_.key("convergence");
+        convergence_.write_json(w_);
+    }
+    if (variance_.enabled()) {
+        w_.key("varianceReduction");
+        variance_.write_json(w_);
+    }
+    w_.end_object();
+    out_ << '\n';
+}
 
-        // ── engagementLog ──
-        w.key("engagementLog").begin_array();
-        for (const auto& evt : run.engagement_log) {
-            w.begin_object();
-            w.kv("time", evt.time);
-            w.kv("sourceId", evt.source_id);
-            w.kv("sourceName", evt.source_name);
-            w.kv("sourceTeam", evt.source_team);
-            w.kv("targetId", evt.target_id);
-            w.kv("targetName", evt.target_name);
-            w.kv("result", evt.result);
-            w.kv("weaponType", evt.weapon_type);
-            w.end_object();
-        }
-        w.end_array();
+void write_run_json(sim::JsonWriter& w, const RunResult& run) {
+    w.begin_object();
 
-        // ── entitySurvival ──
-        w.key("entitySurvival").begin_object();
-        for (const auto& [id, surv] : run.entity_survival) {
-            w.key(id).begin_object();
-            w.kv("name", surv.name);
-            w.kv("team", surv.team);
-            w.kv("type", surv.type);
-
-            if (surv.role.empty()) {
-                w.key("role").null_value();
-            } else {
-                w.kv("role", surv.role);
-            }
-
-            w.kv("alive", surv.alive);
-            w.kv("destroyed", surv.destroyed);
-            w.end_object();
-        }
-        w.end_object();
+    w.kv("runIndex", run.run_index);
+    w.kv("seed", run.seed);
+    w.kv("simTimeFinal", run.sim_time_final);
+
+    // error: null or string
+    if (run.error.empty()) {
+        w.key("error").null_value();
+    } else {
+        w.kv("error", run.error);
+    }
 
+    if (run.lod.enabled) {
+        w.key("lod").begin_object();
+        w.kv("fullTicks", run.lod.full_ticks);
+        w.kv("coarseTicks", run.lod.coarse_ticks);
+        w.kv("promotions", run.lod.promotions);
+        w.kv("demotions", run.lod.demotions);
+        w.kv("errorSum", run.lod.error_sum);
+        w.kv("errorMax", run.lod.error_max);
         w.end_object();
     }
 
+    // ── engagementLog ──
+    w.key("engagementLog").begin_array();
+    for (const auto& evt : run.engagement_log) {
+        w.begin_object();
+        w.kv("time", evt.time);
+        w.kv("sourceId", evt.source_id);
+        w.kv("sourceName", evt.source_name);
+        w.kv("sourceTeam", evt.source_team);
+        w.kv("targetId", evt.target_id);
+        w.kv("targetName", evt.target_name);
+        w.kv("result", evt.result);
+        w.kv("weaponType", evt.weapon_type);
+        w.end_object();
+    }
     w.end_array();
 
+    // ── entitySurvival ──
+    w.key("entitySurvival").begin_object();
+    for (const auto& [id, surv] : run.entity_survival) {
+        w.key(id).begin_object();
+        w.kv("name", surv.name);
+        w.kv("team", surv.team);
+        w.kv("type", surv.type);
+
+        if (surv.role.empty()) {
+            w.key("role").null_value();
+        } else {
+            w.kv("role", surv.role);
+        }
+
+        w.kv("alive", surv.alive);
+        w.kv("destroyed", surv.destroyed);
+        w.end_object();
+    }
     w.end_object();
-    out << '\n';
+
+    w.end_object();
+}
+
+RunResult read_run_json(const sim::JsonValue& v) {
+    RunResult run;
+    run.run_index = v["runIndex"].get_int();
+    run.seed = v["seed"].get_int();
+    run.sim_time_final = v["simTimeFinal"].get_number();
+    run.error = v["error"].get_string();
+
+    const sim::JsonValue lod = v["lod"];
+    if (lod.is_object()) {
+        run.lod.enabled = true;
+        run.lod.full_ticks = static_cast<int64_t>(lod["fullTicks"].get_number());
+        run.lod.coarse_ticks = static_cast<int64_t>(lod["coarseTicks"].get_number());
+        run.lod.promotions = static_cast<int64_t>(lod["promotions"].get_number());
+        run.lod.demotions = static_cast<int64_t>(lod["demotions"].get_number());
+        run.lod.error_sum = lod["errorSum"].get_number();
+        run.lod.error_max = lod["errorMax"].get_number();
+    }
+
+    for (const sim::JsonValue& e : v["engagementLog"].as_array()) {
+        EngagementEvent evt;
+        evt.time = e["time"].get_number();
+        evt.source_id = e["sourceId"].get_string();
+        evt.source_name = e["sourceName"].get_string();
+        evt.source_team = e["sourceTeam"].get_string();
+        evt.target_id = e["targetId"].get_string();
+        evt.target_name = e["targetName"].get_string();
+        evt.result = e["result"].get_string();
+        evt.weapon_type = e["weaponType"].get_string();
+        run.engagement_log.push_back(std::move(evt));
+    }
+
+    for (const auto& [id, s] : v["entitySurvival"].as_object()) {
+        EntitySurvival surv;
+        surv.name = s["name"].get_string();
+        surv.team = s["team"].get_string();
+        surv.type = s["type"].get_string();
+        surv.role = s["role"].get_string();
+        surv.alive = s["alive"].get_bool(true);
+        surv.destroyed = s["destroyed"].get_bool();
+        run.entity_survival.emplace(std::string(id), std::move(surv));
+    }
+    return run;
+}
+
+void write_results_json(const std::vector<RunResult>& results,
+                        int num_runs, int base_seed, double max_sim_time,
+                        std::ostream& out) {
+    JsonResultsWriter writer(out, num_runs, base_seed, max_sim_time);
+    for (const auto& run : results) {
+        writer.write_run(run);
+    }
+    writer.finish();
 }
 
 } // namespace sim::mc
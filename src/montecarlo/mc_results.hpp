@@ -3,11 +3,20 @@
  *
  * Output format matches what the browser MCAnalysis.aggregate() expects,
  * so results can be loaded directly into the MC Analysis panel.
+ *
+ * ResultsWriter streams runs out one at a time (MCRunner::run_streaming), so
+ * memory does not grow with run count. JsonResultsWriter produces the JSON
+ * document above; BinaryResultsWriter (mc_results_bin.hpp) a compact
+ * columnar file that converts back to the same JSON.
  */
 
 #ifndef SIM_MC_MC_RESULTS_HPP
 #define SIM_MC_MC_RESULTS_HPP
 
+#include "io/json_writer.hpp"
+#include "io/json_reader.hpp"
+#include "mc_profiler.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -35,6 +44,17 @@ struct EntitySurvival {
     bool destroyed = false;
 };
 
+/** Aircraft level-of-detail accounting for one run (MCConfig::lod_dt). */
+struct LODStats {
+    bool enabled = false;
+    int64_t full_ticks = 0;        // aircraft-ticks at full rate
+    int64_t coarse_ticks = 0;      // aircraft-ticks folded into coarse steps
+    int64_t promotions = 0;
+    int64_t demotions = 0;
+    double error_sum = 0.0;        // estimated position error spent [m]
+    double error_max = 0.0;        // worst single coarse step [m]
+};
+
 struct RunResult {
     int run_index = 0;
     int seed = 0;
@@ -42,8 +62,99 @@ struct RunResult {
     std::vector<EngagementEvent> engagement_log;
     std::unordered_map<std::string, EntitySurvival> entity_survival;
     std::string error;         // empty = success
+    LODStats lod;
+    RunProfile profile;        // cost (MCRunner budgets); not written
+};
+
+struct MetricEstimate {
+    std::string name;          // e.g. "survival:red-hva-001", "win:blue"
+    int64_t successes = 0;
+    int64_t trials = 0;
+    double p = 0.0;
+    double lo = 0.0;           // 95% Wilson bounds
+    double hi = 1.0;
+    double half_width() const { return 0.5 * (hi - lo); }
+};
+
+/**
+ * Early-stop status for a batch (see ConvergenceMonitor). Written as the
+ * top-level "convergence" object of the results JSON when enabled.
+ */
+struct ConvergenceReport {
+    bool enabled = false;
+    bool converged = false;
+    int runs_completed = 0;
+    double target_half_width = 0.0;
+    double achieved_half_width = 1.0;   // worst metric
+    std::vector<MetricEstimate> metrics;
+
+    /** Serialize as a "convergence" value (object). */
+    void write_json(sim::JsonWriter& w) const;
+};
+
+struct PairedEstimate {
+    std::string name;
+    int64_t pairs = 0;
+    double mean = 0.0;                    // estimate (or mean difference)
+    double half_width = 0.0;              // pair-aware 95% half-width
+    double independent_half_width = 0.0;  // same run count, independent
+};
+
+/**
+ * Variance-reduction summary, written as the "varianceReduction" object of
+ * the results JSON when a method is active.
+ */
+struct VarianceReport {
+    std::string method;                   // "antithetic", "lhs"; empty = off
+    int64_t strata = 0;                   // lhs: strata per dimension
+    std::vector<std::string> dimensions;  // lhs: stratified parameters
+    std::vector<PairedEstimate> metrics;  // antithetic estimates
+
+    bool enabled() const { return !method.empty(); }
+    void write_json(sim::JsonWriter& w) const;
+};
+
+/**
+ * Incremental results output: write_run() once per run in run-index order,
+ * then finish(). Destruction without finish() leaves the output truncated.
+ */
+class ResultsWriter {
+public:
+    virtual ~ResultsWriter() = default;
+    virtual void write_run(const RunResult& run) = 0;
+    /** Attach early-stop status; call before finish(). Default: dropped. */
+    virtual void set_convergence(const ConvergenceReport&) {}
+    /** Attach variance-reduction estimates; call before finish(). */
+    virtual void set_variance(const VarianceReport&) {}
+    virtual void finish() = 0;
 };
 
+/**
+ * Streaming JSON output, byte-identical to write_results_json().
+ */
+class JsonResultsWriter : public ResultsWriter {
+public:
+    JsonResultsWriter(std::ostream& out, int num_runs, int base_seed,
+                      double max_sim_time);
+
+    void write_run(const RunResult& run) override;
+    void set_convergence(const ConvergenceReport& report) override;
+    void set_variance(const VarianceReport& report) override { variance_ = report; }
+    void finish() override;
+
+private:
+    std::ostream& out_;
+    sim::JsonWriter w_;
+    ConvergenceReport convergence_;
+    VarianceReport variance_;
+};
+
+/** Serialize one run object (an element of the "runs" array). */
+void write_run_json(sim::JsonWriter& w, const RunResult& run);
+
+/** Inverse of write_run_json(); missing fields keep their defaults. */
+RunResult read_run_json(const sim::JsonValue& run);
+
 /**
  * Write results as JSON consumable by browser MCAnalysis.
  * Format: { "config": {...}, "runs": [...] }
@@ -0,0 +1,273 @@
+#include "montecarlo/mc_results_bin.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+template <typename T>
+void write_pod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Writer
+// ═══════════════════════════════════════════════════════════════
+
+BinaryResultsWriter::BinaryResultsWriter(std::ostream& out, int num_runs,
+                                         int base_seed, double max_sim_time)
+    : out_(out) {
+    out_.write(mcrb::MAGIC, sizeof(mcrb::MAGIC));
+    write_pod(out_, mcrb::VERSION);
+    write_pod(out_, static_cast<int32_t>(num_runs));
+    write_pod(out_, static_cast<int32_t>(base_seed));
+    write_pod(out_, max_sim_time);
+}
+
+uint32_t BinaryResultsWriter::intern(const std::string& s) {
+    auto it = strings_.find(s);
+    if (it != strings_.end()) return it->second;
+
+    uint32_t index = static_cast<uint32_t>(strings_.size());
+    strings_.emplace(s, index);
+
+    out_.put('S');
+    write_pod(out_, static_cast<uint32_t>(s.size()));
+    out_.write(s.data(), static_cast<std::streamsize>(s.size()));
+    return index;
+}
+
+void BinaryResultsWriter::write_entity_table(const RunResult& run) {
+    entity_ids_.clear();
+    for (const auto& kv : run.entity_survival) entity_ids_.push_back(kv.first);
+    std::sort(entity_ids_.begin(), entity_ids_.end());
+
+    std::vector<mcrb::EntityRow> rows;
+    rows.reserve(entity_ids_.size());
+    for (size_t i = 0; i < entity_ids_.size(); i++) {
+        const auto& id = entity_ids_[i];
+        const auto& surv = run.entity_survival.at(id);
+        entity_index_[id] = static_cast<uint32_t>(i);
+        rows.push_back({
+            intern(id),
+            intern(surv.name),
+            intern(surv.team),
+            intern(surv.type),
+            surv.role.empty() ? mcrb::NO_STRING : intern(surv.role)
+        });
+    }
+
+    out_.put('T');
+    write_pod(out_, static_cast<uint32_t>(rows.size()));
+    out_.write(reinterpret_cast<const char*>(rows.data()),
+               static_cast<std::streamsize>(rows.size() * sizeof(mcrb::EntityRow)));
+    have_table_ = true;
+}
+
+void BinaryResultsWriter::write_run(const RunResult& run) {
+    if (!have_table_ && !run.entity_survival.empty()) {
+        write_entity_table(run);
+    }
+
+    // Strings first, so every index in the run record is already defined
+    uint32_t error = run.error.empty() ? mcrb::NO_STRING : intern(run.error);
+
+    rows_.clear();
+    for (const auto& evt : run.engagement_log) {
+        rows_.push_back({
+            evt.time,
+            intern(evt.source_id),
+            intern(evt.source_name),
+            intern(evt.source_team),
+            intern(evt.target_id),
+            intern(evt.target_name),
+            intern(evt.result),
+            intern(evt.weapon_type)
+        });
+    }
+
+    uint32_t words = 0;
+    if (!run.entity_survival.empty()) {
+        if (run.entity_survival.size() != entity_ids_.size()) {
+            throw std::runtime_error("binary results: run " +
+                std::to_string(run.run_index) + " has a different entity set");
+        }
+        words = static_cast<uint32_t>((entity_ids_.size() + 63) / 64);
+        alive_bits_.assign(words, 0);
+        destroyed_bits_.assign(words, 0);
+        for (const auto& [id, surv] : run.entity_survival) {
+            auto it = entity_index_.find(id);
+            if (it == entity_index_.end()) {
+                throw std::runtime_error("binary results: run " +
+                    std::to_string(run.run_index) + " has unknown entity " + id);
+            }
+            uint64_t bit = uint64_t{1} << (it->second % 64);
+            if (surv.alive) alive_bits_[it->second / 64] |= bit;
+            if (surv.destroyed) destroyed_bits_[it->second / 64] |= bit;
+        }
+    }
+
+    mcrb::RunHeader hdr{
+        static_cast<int32_t>(run.run_index),
+        static_cast<int32_t>(run.seed),
+        run.sim_time_final,
+        error,
+        words,
+        static_cast<uint32_t>(rows_.size())
+    };
+
+    out_.put('R');
+    write_pod(out_, hdr);
+    out_.write(reinterpret_cast<const char*>(alive_bits_.data()),
+               static_cast<std::streamsize>(words * sizeof(uint64_t)));
+    out_.write(reinterpret_cast<const char*>(destroyed_bits_.data()),
+               static_cast<std::streamsize>(words * sizeof(uint64_t)));
+    out_.write(reinterpret_cast<const char*>(rows_.data()),
+               static_cast<std::streamsize>(rows_.size() * sizeof(mcrb::EngagementRow)));
+}
+
+void BinaryResultsWriter::finish() {
+    out_.put('E');
+    out_.flush();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Reader
+// ═══════════════════════════════════════════════════════════════
+
+BinaryResultsReader::BinaryResultsReader(std::istream& in)
+    : in_(in) {
+    char magic[4];
+    read_bytes(magic, sizeof(magic));
+    if (std::memcmp(magic, mcrb::MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("binary results: bad magic (not an MCRB file)");
+    }
+
+    uint32_t version;
+    int32_t num_runs, base_seed;
+    read_bytes(&version, sizeof(version));
+    if (version != mcrb::VERSION) {
+        throw std::runtime_error("binary results: unsupported version " +
+                                 std::to_string(version));
+    }
+    read_bytes(&num_runs, sizeof(num_runs));
+    read_bytes(&base_seed, sizeof(base_seed));
+    read_bytes(&max_sim_time_, sizeof(max_sim_time_));
+    num_runs_ = num_runs;
+    base_seed_ = base_seed;
+}
+
+void BinaryResultsReader::read_bytes(void* dst, size_t n) {
+    in_.read(static_cast<char*>(dst), static_cast<std::streamsize>(n));
+    if (static_cast<size_t>(in_.gcount()) != n) {
+        throw std::runtime_error("binary results: unexpected end of file");
+    }
+}
+
+const std::string& BinaryResultsReader::str(uint32_t index) const {
+    if (index >= strings_.size()) {
+        throw std::runtime_error("binary results: bad string index " +
+                                 std::to_string(index));
+    }
+    return strings_[index];
+}
+
+bool BinaryResultsReader::next(RunResult& run) {
+    for (;;) {
+        char tag;
+        read_bytes(&tag, 1);
+
+        if (tag == 'E') return false;
+
+        if (tag == 'S') {
+            uint32_t len;
+            read_bytes(&len, sizeof(len));
+            std::string s(len, '\0');
+            if (len > 0) read_bytes(&s[0], len);
+            strings_.push_back(std::move(s));
+            continue;
+        }
+
+        if (tag == 'T') {
+            uint32_t count;
+            read_bytes(&count, sizeof(count));
+            entities_.resize(count);
+            if (count > 0) read_bytes(entities_.data(), count * sizeof(mcrb::EntityRow));
+            continue;
+        }
+
+        if (tag != 'R') {
+            throw std::runtime_error(std::string("binary results: unknown record '") +
+                                     tag + "'");
+        }
+
+        mcrb::RunHeader hdr;
+        read_bytes(&hdr, sizeof(hdr));
+
+        run = RunResult{};
+        run.run_index = hdr.run_index;
+        run.seed = hdr.seed;
+        run.sim_time_final = hdr.sim_time_final;
+        if (hdr.error != mcrb::NO_STRING) run.error = str(hdr.error);
+
+        if (hdr.words > 0) {
+            if (hdr.words != (entities_.size() + 63) / 64) {
+                throw std::runtime_error("binary results: survival width mismatch");
+            }
+            std::vector<uint64_t> alive(hdr.words), destroyed(hdr.words);
+            read_bytes(alive.data(), hdr.words * sizeof(uint64_t));
+            read_bytes(destroyed.data(), hdr.words * sizeof(uint64_t));
+
+            for (size_t i = 0; i < entities_.size(); i++) {
+                const auto& row = entities_[i];
+                uint64_t bit = uint64_t{1} << (i % 64);
+                EntitySurvival surv;
+                surv.name = str(row.name);
+                surv.team = str(row.team);
+                surv.type = str(row.type);
+                if (row.role != mcrb::NO_STRING) surv.role = str(row.role);
+                surv.alive = (alive[i / 64] & bit) != 0;
+                surv.destroyed = (destroyed[i / 64] & bit) != 0;
+                run.entity_survival.emplace(str(row.id), std::move(surv));
+            }
+        }
+
+        run.engagement_log.reserve(hdr.num_engagements);
+        for (uint32_t k = 0; k < hdr.num_engagements; k++) {
+            mcrb::EngagementRow row;
+            read_bytes(&row, sizeof(row));
+            EngagementEvent evt;
+            evt.time = row.time;
+            evt.source_id = str(row.source_id);
+            evt.source_name = str(row.source_name);
+            evt.source_team = str(row.source_team);
+            evt.target_id = str(row.target_id);
+            evt.target_name = str(row.target_name);
+            evt.result = str(row.result);
+            evt.weapon_type = str(row.weapon_type);
+            run.engagement_log.push_back(std::move(evt));
+        }
+        return true;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Conversion
+// ═══════════════════════════════════════════════════════════════
+
+void convert_results_binary_to_json(std::istream& in, std::ostream& out) {
+    BinaryResultsReader reader(in);
+    JsonResultsWriter writer(out, reader.num_runs(), reader.base_seed(),
+                             reader.max_sim_time());
+    RunResult run;
+    while (reader.next(run)) {
+        writer.write_run(run);
+    }
+    writer.finish();
+}
+
+} // namespace sim::mc
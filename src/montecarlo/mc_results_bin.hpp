@@ -0,0 +1,143 @@
+/**
+ * MCResults binary — Columnar batch results format (".mcrb").
+ *
+ * A compact alternative to the results JSON for large batches. Strings
+ * (entity IDs, names, teams, result codes, errors) are written once to a
+ * string table and referenced by index; each run stores fixed-width
+ * alive/destroyed bitsets over a shared entity table and its engagement
+ * log as fixed-size rows. The file is written incrementally, one run at a
+ * time, so the writer holds only the string table in memory.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header   "MCRB" u32 version, i32 num_runs, i32 base_seed, f64 max_sim_time
+ *   records  u8 tag followed by a payload:
+ *     'S'  string      u32 length, bytes        (ids assigned 0, 1, 2, ...)
+ *     'T'  entities    u32 count, count x EntityRow
+ *     'R'  run         RunHeader, 2 x words x u64 bitsets (alive, destroyed),
+ *                      num_engagements x EngagementRow
+ *     'E'  end of file
+ *
+ * A run with words == 0 carries no survival data (error runs).
+ * BinaryResultsReader reconstructs RunResult values, and
+ * convert_results_binary_to_json() produces the same document as
+ * write_results_json() (up to entitySurvival key order, which is unordered
+ * there too).
+ */
+
+#ifndef SIM_MC_MC_RESULTS_BIN_HPP
+#define SIM_MC_MC_RESULTS_BIN_HPP
+
+#include "mc_results.hpp"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim::mc {
+
+namespace mcrb {
+
+constexpr char MAGIC[4] = {'M', 'C', 'R', 'B'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t NO_STRING = UINT32_MAX;
+
+#pragma pack(push, 1)
+struct EntityRow {
+    uint32_t id;
+    uint32_t name;
+    uint32_t team;
+    uint32_t type;
+    uint32_t role;      // NO_STRING = no role
+};
+
+struct RunHeader {
+    int32_t  run_index;
+    int32_t  seed;
+    double   sim_time_final;
+    uint32_t error;     // NO_STRING = success
+    uint32_t words;     // u64 words per survival bitset
+    uint32_t num_engagements;
+};
+
+struct EngagementRow {
+    double   time;
+    uint32_t source_id;
+    uint32_t source_name;
+    uint32_t source_team;
+    uint32_t target_id;
+    uint32_t target_name;
+    uint32_t result;
+    uint32_t weapon_type;
+};
+#pragma pack(pop)
+
+} // namespace mcrb
+
+class BinaryResultsWriter : public ResultsWriter {
+public:
+    BinaryResultsWriter(std::ostream& out, int num_runs, int base_seed,
+                        double max_sim_time);
+
+    /**
+     * The first run with survival data defines the entity table (sorted by
+     * ID); later runs must report the same entity set.
+     * @throws std::runtime_error if a run's entity set differs
+     */
+    void write_run(const RunResult& run) override;
+    void finish() override;
+
+private:
+    std::ostream& out_;
+    std::unordered_map<std::string, uint32_t> strings_;
+    std::unordered_map<std::string, uint32_t> entity_index_;
+    std::vector<std::string> entity_ids_;
+    bool have_table_ = false;
+
+    // Reused per run
+    std::vector<mcrb::EngagementRow> rows_;
+    std::vector<uint64_t> alive_bits_;
+    std::vector<uint64_t> destroyed_bits_;
+
+    /** String table index, emitting an 'S' record on first use. */
+    uint32_t intern(const std::string& s);
+    void write_entity_table(const RunResult& run);
+};
+
+class BinaryResultsReader {
+public:
+    /** @throws std::runtime_error on a bad magic or unsupported version */
+    explicit BinaryResultsReader(std::istream& in);
+
+    int num_runs() const { return num_runs_; }
+    int base_seed() const { return base_seed_; }
+    double max_sim_time() const { return max_sim_time_; }
+
+    /**
+     * Read the next run. Returns false at the end record.
+     * @throws std::runtime_error on truncated or malformed input
+     */
+    bool next(RunResult& run);
+
+private:
+    std::istream& in_;
+    int num_runs_ = 0;
+    int base_seed_ = 0;
+    double max_sim_time_ = 0.0;
+    std::vector<std::string> strings_;
+    std::vector<mcrb::EntityRow> entities_;
+
+    void read_bytes(void* dst, size_t n);
+    const std::string& str(uint32_t index) const;
+};
+
+/**
+ * Convert a binary results stream to the results JSON document.
+ * Streams run by run, so memory stays flat for any batch size.
+ */
+void convert_results_binary_to_json(std::istream& in, std::ostream& out);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_RESULTS_BIN_HPP
@@ -0,0 +1,660 @@
+#include "montecarlo/mc_results_store.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr uint64_t HEADER_SIZE = sizeof(mcrs::MAGIC) + sizeof(uint32_t) +
+                                 2 * sizeof(int32_t) + sizeof(double);
+
+void set_bit(std::vector<uint64_t>& bits, size_t row) {
+    if (bits.size() <= row / 64) bits.resize(row / 64 + 1, 0);
+    bits[row / 64] |= uint64_t{1} << (row % 64);
+}
+
+bool test_bit(const std::vector<uint64_t>& bits, size_t row) {
+    return (bits[row / 64] >> (row % 64)) & 1;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (;;) {
+        size_t end = s.find(sep, start);
+        parts.push_back(trim(s.substr(start, end - start)));
+        if (end == std::string::npos) return parts;
+        start = end + 1;
+    }
+}
+
+/** "<T", "<=T", ">T" or ">=T" → operator and T. */
+struct Comparison {
+    bool less;
+    bool inclusive;
+    double value;
+};
+
+Comparison parse_comparison(const std::string& text, const std::string& term) {
+    auto bad = [&]() {
+        return std::invalid_argument("results store: bad comparison in filter '" + term + "'");
+    };
+    if (text.empty() || (text[0] != '<' && text[0] != '>')) throw bad();
+    Comparison c{text[0] == '<', text.size() > 1 && text[1] == '=', 0.0};
+    std::string number = trim(text.substr(c.inclusive ? 2 : 1));
+    size_t used = 0;
+    try {
+        c.value = std::stod(number, &used);
+    } catch (const std::exception&) {
+        throw bad();
+    }
+    if (used != number.size()) throw bad();
+    return c;
+}
+
+bool compare(double x, const Comparison& c) {
+    if (c.less) return c.inclusive ? x <= c.value : x < c.value;
+    return c.inclusive ? x >= c.value : x > c.value;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Writer
+// ═══════════════════════════════════════════════════════════════
+
+ResultsStoreWriter::ResultsStoreWriter(std::ostream& out, int num_runs,
+                                       int base_seed, double max_sim_time)
+    : out_(out) {
+    const int32_t runs = num_runs, seed = base_seed;
+    write(mcrs::MAGIC, sizeof(mcrs::MAGIC));
+    write(&mcrs::VERSION, sizeof(mcrs::VERSION));
+    write(&runs, sizeof(runs));
+    write(&seed, sizeof(seed));
+    write(&max_sim_time, sizeof(max_sim_time));
+}
+
+void ResultsStoreWriter::write(const void* data, size_t n) {
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+    pos_ += n;
+}
+
+uint32_t ResultsStoreWriter::intern(const std::string& s) {
+    auto it = string_index_.find(s);
+    if (it != string_index_.end()) return it->second;
+    uint32_t index = static_cast<uint32_t>(strings_.size());
+    string_index_.emplace(s, index);
+    strings_.push_back(s);
+    return index;
+}
+
+void ResultsStoreWriter::define_entities(const RunResult& run) {
+    std::vector<std::string> ids;
+    for (const auto& kv : run.entity_survival) ids.push_back(kv.first);
+    std::sort(ids.begin(), ids.end());
+
+    for (size_t i = 0; i < ids.size(); i++) {
+        const auto& surv = run.entity_survival.at(ids[i]);
+        entity_index_[ids[i]] = static_cast<uint32_t>(i);
+        entities_.push_back({
+            intern(ids[i]),
+            intern(surv.name),
+            intern(surv.team),
+            intern(surv.type),
+            surv.role.empty() ? mcrb::NO_STRING : intern(surv.role)
+        });
+    }
+    alive_.resize(ids.size());
+    destroyed_.resize(ids.size());
+    deaths_.resize(ids.size());
+}
+
+void ResultsStoreWriter::write_run(const RunResult& run) {
+    const size_t row = runs_.size();
+    if (entities_.empty() && !run.entity_survival.empty()) define_entities(run);
+
+    // First KILL of each entity is its death time
+    death_time_.assign(entities_.size(), std::numeric_limits<double>::quiet_NaN());
+    rows_.clear();
+    for (const auto& evt : run.engagement_log) {
+        rows_.push_back({static_cast<uint32_t>(row), {
+            evt.time,
+            intern(evt.source_id),
+            intern(evt.source_name),
+            intern(evt.source_team),
+            intern(evt.target_id),
+            intern(evt.target_name),
+            intern(evt.result),
+            intern(evt.weapon_type)
+        }});
+        if (evt.result != "KILL") continue;
+        auto it = entity_index_.find(evt.target_id);
+        if (it == entity_index_.end()) continue;
+        double& t = death_time_[it->second];
+        if (std::isnan(t) || evt.time < t) t = evt.time;
+    }
+
+    if (!run.entity_survival.empty()) {
+        if (run.entity_survival.size() != entities_.size()) {
+            throw std::runtime_error("results store: run " +
+                std::to_string(run.run_index) + " has a different entity set");
+        }
+        for (const auto& [id, surv] : run.entity_survival) {
+            auto it = entity_index_.find(id);
+            if (it == entity_index_.end()) {
+                throw std::runtime_error("results store: run " +
+                    std::to_string(run.run_index) + " has unknown entity " + id);
+            }
+            if (surv.alive) set_bit(alive_[it->second], row);
+            if (surv.destroyed) set_bit(destroyed_[it->second], row);
+        }
+    }
+    for (size_t e = 0; e < death_time_.size(); e++) {
+        if (!std::isnan(death_time_[e])) {
+            deaths_[e].push_back({death_time_[e], static_cast<uint32_t>(row)});
+        }
+    }
+    if (!run.error.empty()) set_bit(errors_, row);
+
+    runs_.push_back({
+        static_cast<int32_t>(run.run_index),
+        static_cast<int32_t>(run.seed),
+        run.sim_time_final,
+        run.error.empty() ? mcrb::NO_STRING : intern(run.error),
+        static_cast<uint32_t>(rows_.size()),
+        num_events_
+    });
+    write(rows_.data(), rows_.size() * sizeof(mcrs::EventRow));
+    num_events_ += rows_.size();
+}
+
+void ResultsStoreWriter::finish() {
+    mcrs::Footer footer{};
+    std::memcpy(footer.magic, mcrs::MAGIC, sizeof(mcrs::MAGIC));
+    footer.events = HEADER_SIZE;
+    footer.num_events = num_events_;
+    footer.num_strings = static_cast<uint32_t>(strings_.size());
+    footer.num_entities = static_cast<uint32_t>(entities_.size());
+    footer.num_rows = static_cast<uint32_t>(runs_.size());
+    footer.words = static_cast<uint32_t>((runs_.size() + 63) / 64);
+
+    footer.strings = pos_;
+    for (const auto& s : strings_) {
+        uint32_t len = static_cast<uint32_t>(s.size());
+        write(&len, sizeof(len));
+        write(s.data(), s.size());
+    }
+
+    footer.entities = pos_;
+    write(entities_.data(), entities_.size() * sizeof(mcrb::EntityRow));
+
+    footer.runs = pos_;
+    write(runs_.data(), runs_.size() * sizeof(mcrs::RunRow));
+
+    footer.bitmaps = pos_;
+    auto write_bitmap = [&](std::vector<uint64_t>& bits) {
+        bits.resize(footer.words, 0);
+        write(bits.data(), bits.size() * sizeof(uint64_t));
+    };
+    for (size_t e = 0; e < entities_.size(); e++) {
+        write_bitmap(alive_[e]);
+        write_bitmap(destroyed_[e]);
+    }
+    write_bitmap(errors_);
+
+    footer.deaths = pos_;
+    std::vector<uint64_t> offsets{0};
+    for (auto& column : deaths_) {
+        std::stable_sort(column.begin(), column.end(),
+                         [](const mcrs::DeathRow& a, const mcrs::DeathRow& b) {
+                             return a.time < b.time;
+                         });
+        offsets.push_back(offsets.back() + column.size());
+    }
+    write(offsets.data(), offsets.size() * sizeof(uint64_t));
+    for (const auto& column : deaths_) {
+        write(column.data(), column.size() * sizeof(mcrs::DeathRow));
+    }
+
+    write(&footer, sizeof(footer));
+    out_.flush();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Reader
+// ═══════════════════════════════════════════════════════════════
+
+ResultsStore::ResultsStore(const std::string& path)
+    : in_(path, std::ios::binary) {
+    if (!in_.is_open()) {
+        throw std::runtime_error("results store: cannot open " + path);
+    }
+
+    char magic[4];
+    uint32_t version;
+    int32_t num_runs, base_seed;
+    read_at(0, magic, sizeof(magic));
+    if (std::memcmp(magic, mcrs::MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("results store: bad magic (not an MCRS file)");
+    }
+    read_at(sizeof(magic), &version, sizeof(version));
+    if (version != mcrs::VERSION) {
+        throw std::runtime_error("results store: unsupported version " +
+                                 std::to_string(version));
+    }
+    read_at(8, &num_runs, sizeof(num_runs));
+    read_at(12, &base_seed, sizeof(base_seed));
+    read_at(16, &max_sim_time_, sizeof(max_sim_time_));
+    num_runs_ = num_runs;
+    base_seed_ = base_seed;
+
+    in_.seekg(0, std::ios::end);
+    const uint64_t size = static_cast<uint64_t>(in_.tellg());
+    if (size < HEADER_SIZE + sizeof(mcrs::Footer)) {
+        throw std::runtime_error("results store: truncated file (no footer)");
+    }
+    read_at(size - sizeof(mcrs::Footer), &footer_, sizeof(footer_));
+    if (std::memcmp(footer_.magic, mcrs::MAGIC, sizeof(mcrs::MAGIC)) != 0) {
+        throw std::runtime_error("results store: truncated file (no footer)");
+    }
+    const uint64_t events_end =
+        footer_.events + footer_.num_events * sizeof(mcrs::EventRow);
+    if (footer_.events != HEADER_SIZE || events_end != footer_.strings ||
+        footer_.strings > footer_.entities || footer_.entities > footer_.runs ||
+        footer_.runs > footer_.bitmaps || footer_.bitmaps > footer_.deaths ||
+        footer_.deaths > size - sizeof(mcrs::Footer) ||
+        footer_.words != (uint64_t{footer_.num_rows} + 63) / 64) {
+        throw std::runtime_error("results store: inconsistent section offsets");
+    }
+
+    // Strings
+    std::string blob(footer_.entities - footer_.strings, '\0');
+    read_at(footer_.strings, &blob[0], blob.size());
+    size_t p = 0;
+    strings_.reserve(footer_.num_strings);
+    for (uint32_t i = 0; i < footer_.num_strings; i++) {
+        uint32_t len;
+        if (p + sizeof(len) > blob.size()) throw std::runtime_error("results store: bad string table");
+        std::memcpy(&len, blob.data() + p, sizeof(len));
+        p += sizeof(len);
+        if (p + len > blob.size()) throw std::runtime_error("results store: bad string table");
+        strings_.emplace_back(blob.data() + p, len);
+        p += len;
+    }
+
+    // Entities
+    std::vector<mcrb::EntityRow> rows(footer_.num_entities);
+    read_at(footer_.entities, rows.data(), rows.size() * sizeof(mcrb::EntityRow));
+    for (size_t i = 0; i < rows.size(); i++) {
+        StoreEntity e;
+        e.id = str(rows[i].id);
+        e.name = str(rows[i].name);
+        e.team = str(rows[i].team);
+        e.type = str(rows[i].type);
+        if (rows[i].role != mcrb::NO_STRING) e.role = str(rows[i].role);
+        entity_index_[e.id] = i;
+        entities_.push_back(std::move(e));
+    }
+
+    // Runs
+    runs_.resize(footer_.num_rows);
+    read_at(footer_.runs, runs_.data(), runs_.size() * sizeof(mcrs::RunRow));
+    for (const auto& r : runs_) {
+        if (r.first_event + r.num_events > footer_.num_events) {
+            throw std::runtime_error("results store: run " + std::to_string(r.run_index) +
+                                     " has events past the end of the section");
+        }
+    }
+
+    // Bitmaps
+    const size_t bytes = footer_.words * sizeof(uint64_t);
+    uint64_t offset = footer_.bitmaps;
+    auto next_bitmap = [&]() {
+        Bitmap bits(footer_.words);
+        read_at(offset, bits.data(), bytes);
+        offset += bytes;
+        return bits;
+    };
+    for (size_t e = 0; e < entities_.size(); e++) {
+        alive_.push_back(next_bitmap());
+        destroyed_.push_back(next_bitmap());
+    }
+    errors_ = next_bitmap();
+
+    // Death columns
+    death_offsets_.resize(entities_.size() + 1);
+    read_at(footer_.deaths, death_offsets_.data(), death_offsets_.size() * sizeof(uint64_t));
+    if (death_offsets_.front() != 0 ||
+        !std::is_sorted(death_offsets_.begin(), death_offsets_.end())) {
+        throw std::runtime_error("results store: bad death column offsets");
+    }
+    deaths_.resize(death_offsets_.back());
+    read_at(footer_.deaths + death_offsets_.size() * sizeof(uint64_t), deaths_.data(),
+            deaths_.size() * sizeof(mcrs::DeathRow));
+    for (const auto& d : deaths_) {
+        if (d.row >= runs_.size()) throw std::runtime_error("results store: bad death row");
+    }
+}
+
+void ResultsStore::read_at(uint64_t offset, void* dst, size_t n) const {
+    if (n == 0) return;
+    in_.clear();
+    in_.seekg(static_cast<std::streamoff>(offset));
+    in_.read(static_cast<char*>(dst), static_cast<std::streamsize>(n));
+    if (static_cast<size_t>(in_.gcount()) != n) {
+        throw std::runtime_error("results store: unexpected end of file");
+    }
+}
+
+const std::string& ResultsStore::str(uint32_t index) const {
+    if (index >= strings_.size()) {
+        throw std::runtime_error("results store: bad string index " + std::to_string(index));
+    }
+    return strings_[index];
+}
+
+const std::string& ResultsStore::error(size_t row) const {
+    static const std::string none;
+    return runs_[row].error == mcrb::NO_STRING ? none : str(runs_[row].error);
+}
+
+size_t ResultsStore::entity(const std::string& id) const {
+    auto it = entity_index_.find(id);
+    if (it == entity_index_.end()) {
+        throw std::invalid_argument("results store: unknown entity '" + id + "'");
+    }
+    return it->second;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Queries
+// ═══════════════════════════════════════════════════════════════
+
+ResultsStore::Bitmap ResultsStore::all_rows() const {
+    Bitmap bits(footer_.words, ~uint64_t{0});
+    if (runs_.size() % 64 != 0) bits.back() = (uint64_t{1} << (runs_.size() % 64)) - 1;
+    return bits;
+}
+
+ResultsStore::Bitmap ResultsStore::term(const std::string& text) const {
+    if (text.empty()) throw std::invalid_argument("results store: empty filter term");
+    if (text[0] == '!') {
+        Bitmap bits = term(trim(text.substr(1)));
+        Bitmap all = all_rows();
+        for (size_t w = 0; w < bits.size(); w++) bits[w] = ~bits[w] & all[w];
+        return bits;
+    }
+
+    if (text == "all") return all_rows();
+    if (text == "error") return errors_;
+    if (text == "ok") return term("!error");
+
+    auto arg = [&](const char* prefix) -> const char* {
+        size_t n = std::strlen(prefix);
+        return text.compare(0, n, prefix) == 0 ? text.c_str() + n : nullptr;
+    };
+    if (const char* id = arg("survived:")) return alive_[entity(trim(id))];
+    if (const char* id = arg("destroyed:")) return destroyed_[entity(trim(id))];
+    if (const char* id = arg("lost:")) return term("!survived:" + std::string(id));
+
+    if (const char* rest = arg("died:")) {
+        std::string s(rest);
+        size_t op = s.find_first_of("<>");
+        if (op == std::string::npos) {
+            throw std::invalid_argument("results store: filter '" + text +
+                                        "' needs a time bound (died:<id><T)");
+        }
+        size_t e = entity(trim(s.substr(0, op)));
+        Comparison c = parse_comparison(s.substr(op), text);
+
+        // The column is sorted by time: the match is a prefix or a suffix
+        auto first = deaths_.begin() + static_cast<std::ptrdiff_t>(death_offsets_[e]);
+        auto last = deaths_.begin() + static_cast<std::ptrdiff_t>(death_offsets_[e + 1]);
+        auto by_time = [](const mcrs::DeathRow& d, double t) { return d.time < t; };
+        auto after = [](double t, const mcrs::DeathRow& d) { return t < d.time; };
+        auto split_at = (c.less == c.inclusive)
+            ? std::upper_bound(first, last, c.value, after)
+            : std::lower_bound(first, last, c.value, by_time);
+        Bitmap bits(footer_.words, 0);
+        for (auto it = c.less ? first : split_at; it != (c.less ? split_at : last); ++it) {
+            set_bit(bits, it->row);
+        }
+        return bits;
+    }
+
+    if (text[0] == 't' && text.size() > 1 && (text[1] == '<' || text[1] == '>')) {
+        Comparison c = parse_comparison(text.substr(1), text);
+        Bitmap bits(footer_.words, 0);
+        for (size_t r = 0; r < runs_.size(); r++) {
+            if (compare(runs_[r].sim_time_final, c)) set_bit(bits, r);
+        }
+        return bits;
+    }
+
+    throw std::invalid_argument("results store: unknown filter '" + text + "'");
+}
+
+ResultsStore::Bitmap ResultsStore::select(const std::string& where) const {
+    if (trim(where).empty()) return all_rows();
+    Bitmap result(footer_.words, 0);
+    for (const auto& clause : split(where, '|')) {
+        Bitmap bits;
+        for (const auto& t : split(clause, '&')) {
+            Bitmap b = term(t);
+            if (bits.empty()) {
+                bits = std::move(b);
+            } else {
+                for (size_t w = 0; w < bits.size(); w++) bits[w] &= b[w];
+            }
+        }
+        for (size_t w = 0; w < result.size(); w++) result[w] |= bits[w];
+    }
+    return result;
+}
+
+size_t ResultsStore::count(const Bitmap& rows) {
+    size_t n = 0;
+    for (uint64_t w : rows) n += static_cast<size_t>(__builtin_popcountll(w));
+    return n;
+}
+
+size_t ResultsStore::survived(size_t entity, const Bitmap& rows) const {
+    size_t n = 0;
+    for (size_t w = 0; w < rows.size(); w++) {
+        n += static_cast<size_t>(__builtin_popcountll(rows[w] & alive_[entity][w]));
+    }
+    return n;
+}
+
+size_t ResultsStore::destroyed(size_t entity, const Bitmap& rows) const {
+    size_t n = 0;
+    for (size_t w = 0; w < rows.size(); w++) {
+        n += static_cast<size_t>(__builtin_popcountll(rows[w] & destroyed_[entity][w]));
+    }
+    return n;
+}
+
+std::vector<double> ResultsStore::death_times(size_t entity, const Bitmap& rows) const {
+    std::vector<double> times;
+    for (uint64_t i = death_offsets_[entity]; i < death_offsets_[entity + 1]; i++) {
+        if (test_bit(rows, deaths_[i].row)) times.push_back(deaths_[i].time);
+    }
+    return times;
+}
+
+void ResultsStore::for_each_event(
+        const Bitmap& rows,
+        const std::function<void(size_t row, const EngagementEvent&)>& fn) const {
+    constexpr size_t CHUNK = 16384;
+    std::vector<mcrs::EventRow> buf;
+    EngagementEvent evt;
+
+    // Consecutive selected rows have adjacent events: read them as one span
+    size_t r = 0;
+    while (r < runs_.size()) {
+        if (!test_bit(rows, r)) { r++; continue; }
+        size_t end = r;
+        while (end < runs_.size() && test_bit(rows, end)) end++;
+        uint64_t first = runs_[r].first_event;
+        uint64_t last = runs_[end - 1].first_event + runs_[end - 1].num_events;
+        for (uint64_t i = first; i < last; i += CHUNK) {
+            buf.resize(static_cast<size_t>(std::min<uint64_t>(CHUNK, last - i)));
+            read_at(footer_.events + i * sizeof(mcrs::EventRow), buf.data(),
+                    buf.size() * sizeof(mcrs::EventRow));
+            for (const auto& row : buf) {
+                evt.time = row.event.time;
+                evt.source_id = str(row.event.source_id);
+                evt.source_name = str(row.event.source_name);
+                evt.source_team = str(row.event.source_team);
+                evt.target_id = str(row.event.target_id);
+                evt.target_name = str(row.event.target_name);
+                evt.result = str(row.event.result);
+                evt.weapon_type = str(row.event.weapon_type);
+                fn(row.row, evt);
+            }
+        }
+        r = end;
+    }
+}
+
+void write_store_query(const ResultsStore& store, const StoreQuery& query, std::ostream& out) {
+    // Check every aggregation before writing anything
+    std::vector<size_t> death_entities;
+    bool survival = false, weapons = false;
+    int run_limit = -1;
+    for (const auto& agg : query.aggregations) {
+        if (agg == "count") {
+        } else if (agg == "survival") {
+            survival = true;
+        } else if (agg == "weapons") {
+            weapons = true;
+        } else if (agg.compare(0, 7, "deaths:") == 0) {
+            death_entities.push_back(store.entity(agg.substr(7)));
+        } else if (agg == "runs") {
+            run_limit = 20;
+        } else if (agg.compare(0, 5, "runs:") == 0) {
+            try {
+                run_limit = std::stoi(agg.substr(5));
+            } catch (const std::exception&) {
+                run_limit = -1;
+            }
+            if (run_limit < 0) {
+                throw std::invalid_argument("results store: bad run limit in '" + agg + "'");
+            }
+        } else {
+            throw std::invalid_argument("results store: unknown aggregation '" + agg + "'");
+        }
+    }
+
+    const ResultsStore::Bitmap rows = store.select(query.where);
+    const size_t matched = ResultsStore::count(rows);
+    ResultsStore::Bitmap ok_rows = store.select("ok");
+    for (size_t w = 0; w < ok_rows.size(); w++) ok_rows[w] &= rows[w];
+    const size_t ok = ResultsStore::count(ok_rows);   // Matched runs with survival data
+
+    sim::JsonWriter w(out);
+    w.begin_object();
+    w.kv("format", "results_query");
+    w.kv("where", query.where);
+    w.kv("numRuns", store.num_runs());
+    w.kv("storedRuns", store.num_rows());
+    w.kv("matched", matched);
+
+    if (survival) {
+        w.key("survival").begin_array();
+        for (size_t e = 0; e < store.entities().size(); e++) {
+            const auto& ent = store.entities()[e];
+            size_t s = store.survived(e, rows);
+            w.begin_object();
+            w.kv("id", ent.id);
+            w.kv("name", ent.name);
+            w.kv("team", ent.team);
+            w.kv("survived", s);
+            w.kv("destroyed", store.destroyed(e, rows));
+            w.kv("survivalRate", ok > 0 ? static_cast<double>(s) / ok : 0.0);
+            w.end_object();
+        }
+        w.end_array();
+    }
+
+    if (!death_entities.empty()) {
+        w.key("deathTimes").begin_object();
+        for (size_t e : death_entities) {
+            std::vector<double> t = store.death_times(e, rows);
+            auto at = [&](double q) {
+                return t[static_cast<size_t>(q * (t.size() - 1) + 0.5)];
+            };
+            w.key(store.entities()[e].id).begin_object();
+            w.kv("count", t.size());
+            if (!t.empty()) {
+                double sum = 0.0;
+                for (double x : t) sum += x;
+                w.kv("mean", sum / t.size());
+                w.kv("min", t.front());
+                w.kv("p10", at(0.1));
+                w.kv("p50", at(0.5));
+                w.kv("p90", at(0.9));
+                w.kv("max", t.back());
+            }
+            w.end_object();
+        }
+        w.end_object();
+    }
+
+    if (weapons) {
+        struct Counts { int64_t launches = 0, kills = 0, misses = 0; };
+        std::map<std::string, Counts> by_type;
+        store.for_each_event(rows, [&](size_t, const EngagementEvent& evt) {
+            Counts& c = by_type[evt.weapon_type];
+            if (evt.result == "LAUNCH") c.launches++;
+            else if (evt.result == "KILL") c.kills++;
+            else if (evt.result == "MISS") c.misses++;
+        });
+        w.key("weapons").begin_object();
+        for (const auto& [type, c] : by_type) {
+            w.key(type).begin_object();
+            w.kv("launches", c.launches);
+            w.kv("kills", c.kills);
+            w.kv("misses", c.misses);
+            w.end_object();
+        }
+        w.end_object();
+    }
+
+    if (run_limit >= 0) {
+        w.key("runs").begin_array();
+        int listed = 0;
+        for (size_t r = 0; r < store.num_rows() && listed < run_limit; r++) {
+            if (!test_bit(rows, r)) continue;
+            const auto& run = store.run(r);
+            w.begin_object();
+            w.kv("runIndex", run.run_index);
+            w.kv("seed", run.seed);
+            w.kv("simTimeFinal", run.sim_time_final);
+            w.kv("engagements", static_cast<int64_t>(run.num_events));
+            if (run.error != mcrb::NO_STRING) w.kv("error", store.error(r));
+            w.end_object();
+            listed++;
+        }
+        w.end_array();
+    }
+
+    w.end_object();
+    w.flush();
+    out << '\n';
+}
+
+} // namespace sim::mc
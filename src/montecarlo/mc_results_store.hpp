@@ -0,0 +1,227 @@
+/**
+ * MCResults store — Indexed batch results for drill-down queries (".mcrs").
+ *
+ * The results JSON and .mcrb are run-major: asking which runs lost one SAM
+ * site before t = 120 s means reading every run back. The store keeps the
+ * same outcomes column-major with indexes over them, so such questions
+ * touch only the columns they name:
+ *   - per entity, alive and destroyed bitmaps over the stored runs (bit r
+ *     is the r-th run written, its "row");
+ *   - per entity, its death times as (time, row) pairs sorted by time,
+ *     so "died before T" is a binary search and a prefix of the column;
+ *   - per row, run index, seed, final time and error, plus an error bitmap;
+ *   - the engagement rows of all runs, each tagged with its row, grouped
+ *     by row and reached through the run column's offsets.
+ * A death time is the time of the entity's first "KILL" engagement. An
+ * entity destroyed without one (collisions, scripted events) is in the
+ * destroyed bitmap but not in the death column, so died: filters miss it.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header    "MCRS" u32 version, i32 num_runs, i32 base_seed, f64 max_sim_time
+ *   events    num_events x EventRow          (streamed as runs arrive)
+ *   strings   per string: u32 length, bytes  (ids 0, 1, 2, ...)
+ *   entities  num_entities x mcrb::EntityRow (sorted by ID)
+ *   runs      num_rows x RunRow
+ *   bitmaps   per entity: alive, destroyed; then errors (words x u64 each)
+ *   deaths    (num_entities + 1) x u64 offsets, then DeathRow entries
+ *   footer    Footer (section offsets and counts), ends in "MCRS"
+ * Everything after the events is written by finish(), so the writer never
+ * seeks and may write to a pipe; the reader starts from the footer.
+ *
+ * Filters (ResultsStore::select) are terms joined by '&' (and) and '|'
+ * (or, binding looser); a leading '!' negates a term:
+ *   "survived:<id>"   entity alive at the end      "lost:<id>"  not alive
+ *   "destroyed:<id>"  entity destroyed
+ *   "died:<id><T"     first killed before T (also <=, >, >=)
+ *   "t<T"             final sim time below T (also <=, >, >=)
+ *   "error" / "ok"    the run errored / did not    "all"        every run
+ * e.g. "died:sam_2<120 & survived:hva_1 | error".
+ */
+
+#ifndef SIM_MC_MC_RESULTS_STORE_HPP
+#define SIM_MC_MC_RESULTS_STORE_HPP
+
+#include "mc_results_bin.hpp"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim::mc {
+
+namespace mcrs {
+
+constexpr char MAGIC[4] = {'M', 'C', 'R', 'S'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct EventRow {
+    uint32_t row;                 // Stored run the engagement belongs to
+    mcrb::EngagementRow event;
+};
+
+struct RunRow {
+    int32_t  run_index;
+    int32_t  seed;
+    double   sim_time_final;
+    uint32_t error;               // mcrb::NO_STRING = success
+    uint32_t num_events;
+    uint64_t first_event;         // Index into the events section
+};
+
+struct DeathRow {
+    double   time;
+    uint32_t row;
+};
+
+struct Footer {
+    uint64_t events;              // Section offsets from the start of the file
+    uint64_t strings;
+    uint64_t entities;
+    uint64_t runs;
+    uint64_t bitmaps;
+    uint64_t deaths;
+    uint64_t num_events;
+    uint32_t num_strings;
+    uint32_t num_entities;
+    uint32_t num_rows;
+    uint32_t words;               // u64 words per bitmap
+    char     magic[4];
+};
+#pragma pack(pop)
+
+} // namespace mcrs
+
+/**
+ * Writes the store. Holds the run column, bitmaps and death columns in
+ * memory (a few bytes per run and entity); engagement rows go straight out.
+ */
+class ResultsStoreWriter : public ResultsWriter {
+public:
+    ResultsStoreWriter(std::ostream& out, int num_runs, int base_seed,
+                       double max_sim_time);
+
+    /**
+     * The first run with survival data defines the entity table (sorted by
+     * ID); later runs must report the same entity set.
+     * @throws std::runtime_error if a run's entity set differs
+     */
+    void write_run(const RunResult& run) override;
+    void finish() override;
+
+private:
+    std::ostream& out_;
+    uint64_t pos_ = 0;            // Bytes written so far
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, uint32_t> string_index_;
+    std::unordered_map<std::string, uint32_t> entity_index_;
+    std::vector<mcrb::EntityRow> entities_;
+
+    std::vector<mcrs::RunRow> runs_;
+    uint64_t num_events_ = 0;
+    std::vector<std::vector<uint64_t>> alive_;        // Per entity
+    std::vector<std::vector<uint64_t>> destroyed_;
+    std::vector<uint64_t> errors_;
+    std::vector<std::vector<mcrs::DeathRow>> deaths_; // Per entity, in row order
+
+    // Reused per run
+    std::vector<mcrs::EventRow> rows_;
+    std::vector<double> death_time_;
+
+    uint32_t intern(const std::string& s);
+    void write(const void* data, size_t n);
+    void define_entities(const RunResult& run);
+};
+
+struct StoreEntity {
+    std::string id, name, team, type, role;
+};
+
+/**
+ * Read side: loads everything but the engagement rows (read on demand).
+ * Row selections are bitmaps over the stored runs.
+ */
+class ResultsStore {
+public:
+    using Bitmap = std::vector<uint64_t>;
+
+    /** @throws std::runtime_error if the file is missing, truncated or not a store */
+    explicit ResultsStore(const std::string& path);
+
+    int num_runs() const { return num_runs_; }          // Batch size from the header
+    int base_seed() const { return base_seed_; }
+    double max_sim_time() const { return max_sim_time_; }
+    size_t num_rows() const { return runs_.size(); }    // Runs stored
+    uint64_t num_events() const { return footer_.num_events; }
+
+    const std::vector<StoreEntity>& entities() const { return entities_; }
+    const mcrs::RunRow& run(size_t row) const { return runs_[row]; }
+    const std::string& error(size_t row) const;
+
+    /** Entity table index of `id`; @throws std::invalid_argument if unknown */
+    size_t entity(const std::string& id) const;
+
+    /** Rows matching a filter expression; @throws std::invalid_argument on a bad one */
+    Bitmap select(const std::string& where) const;
+
+    static size_t count(const Bitmap& rows);
+    /** Selected rows in which the entity survived / was destroyed. */
+    size_t survived(size_t entity, const Bitmap& rows) const;
+    size_t destroyed(size_t entity, const Bitmap& rows) const;
+
+    /** The entity's death times in the selected rows, ascending. */
+    std::vector<double> death_times(size_t entity, const Bitmap& rows) const;
+
+    /**
+     * Visit the engagements of the selected rows, in row order.
+     * @throws std::runtime_error on a read failure
+     */
+    void for_each_event(const Bitmap& rows,
+                        const std::function<void(size_t row, const EngagementEvent&)>& fn) const;
+
+private:
+    mutable std::ifstream in_;
+    int num_runs_ = 0;
+    int base_seed_ = 0;
+    double max_sim_time_ = 0.0;
+    mcrs::Footer footer_{};
+    std::vector<std::string> strings_;
+    std::vector<StoreEntity> entities_;
+    std::unordered_map<std::string, size_t> entity_index_;
+    std::vector<mcrs::RunRow> runs_;
+    std::vector<Bitmap> alive_, destroyed_;   // Per entity
+    Bitmap errors_;
+    std::vector<uint64_t> death_offsets_;
+    std::vector<mcrs::DeathRow> deaths_;
+
+    const std::string& str(uint32_t index) const;
+    void read_at(uint64_t offset, void* dst, size_t n) const;
+    Bitmap term(const std::string& text) const;
+    Bitmap all_rows() const;
+};
+
+/**
+ * A drill-down query: rows by `where`, then each aggregation over them:
+ *   "count"           matched rows (always reported)
+ *   "survival"        per entity: survived / destroyed counts and rate
+ *   "deaths:<id>"     the entity's death-time count, mean and quantiles
+ *   "weapons"         launches, kills and misses per weapon type
+ *   "runs" / "runs:N" the first N (default 20) matched runs
+ */
+struct StoreQuery {
+    std::string where = "all";
+    std::vector<std::string> aggregations;
+};
+
+/**
+ * Answer a query as a JSON document.
+ * @throws std::invalid_argument on a bad filter or aggregation
+ */
+void write_store_query(const ResultsStore& store, const StoreQuery& query, std::ostream& out);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_RESULTS_STORE_HPP
@@ -9,221 +9,1455 @@
 #include "montecarlo/radar_sensor.hpp"
 #include "montecarlo/sam_battery.hpp"
 #include "montecarlo/a2a_missile.hpp"
+#include "montecarlo/missile_flyout.hpp"
+#include "montecarlo/flight_lod.hpp"
 #include "montecarlo/event_system.hpp"
 #include "montecarlo/geo_utils.hpp"
+#include "utils/thread_pool.hpp"
+#include "distributed/metrics.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 
 namespace sim::mc {
 
+namespace {
+
+struct RunnerMetrics {
+    distributed::Counter runs;
+    distributed::Counter entity_ticks;
+    distributed::Counter over_budget;
+};
+
+const RunnerMetrics& runner_metrics() {
+    static const RunnerMetrics m{
+        distributed::MetricsRegistry::global().counter("mc_runs_completed_total",
+                                                       "Monte Carlo runs completed"),
+        distributed::MetricsRegistry::global().counter("mc_entity_ticks_total",
+                                                       "Entity updates (entities x ticks)"),
+        distributed::MetricsRegistry::global().counter("mc_runs_over_budget_total",
+                                                       "Monte Carlo runs stopped by a run budget")};
+    return m;
+}
+
+// A world's RunProfile when its systems are timed (tail report), else null
+RunProfile* run_profile(MCWorld& world) {
+    return world.run_profile.systems ? &world.run_profile : nullptr;
+}
+
+} // namespace
+
 MCRunner::MCRunner(const MCConfig& config)
-    : config_(config) {}
+    : config_(config) {
+    if (!config_.wez_dir.empty()) wez_ = WEZLibrary::load(config_.wez_dir);
+    if (config_.tick_threads > 1) {
+        build_tick_graph();
+        tick_executor_ = std::make_unique<TickExecutor>(config_.tick_threads);
+        if (config_.verbose) {
+            std::cerr << "Tick graph (" << tick_executor_->threads() << " threads):\n";
+            tick_graph_.describe(std::cerr);
+        }
+    }
+}
 
 std::vector<RunResult> MCRunner::run(const sim::JsonValue& scenario,
                                      ProgressCallback on_progress) {
     std::vector<RunResult> results;
-    results.reserve(config_.num_runs);
+    results.reserve(std::max(config_.num_runs, 0));
+    run_streaming(scenario,
+                  [&](RunResult& r) { results.push_back(std::move(r)); },
+                  on_progress);
+    return results;
+}
 
-    for (int i = 0; i < config_.num_runs; i++) {
-        int seed = config_.base_seed + i;
+std::vector<RunResult> MCRunner::run(const MCWorld& prototype,
+                                     ProgressCallback on_progress) {
+    std::vector<RunResult> results;
+    results.reserve(std::max(config_.num_runs, 0));
+    run_streaming(prototype,
+                  [&](RunResult& r) { results.push_back(std::move(r)); },
+                  on_progress);
+    return results;
+}
+
+void MCRunner::run_streaming(const sim::JsonValue& scenario,
+                             const ResultCallback& on_result,
+                             ProgressCallback on_progress) {
+    // Parse once; every run starts from a copy of this prototype
+    MCWorld prototype;
+    try {
+        prototype = ScenarioParser::parse(scenario);
+    } catch (const std::exception& e) {
+        for (int i = config_.first_run; i < config_.first_run + config_.num_runs; i++) {
+            RunResult r;
+            r.run_index = i;
+            r.seed = run_seed(i);
+            r.error = std::string("Run error: ") + e.what();
+            on_result(r);
+        }
+        return;
+    }
+
+    run_streaming(prototype, on_result, on_progress);
+}
+
+void MCRunner::run_streaming(const MCWorld& prototype,
+                             const ResultCallback& on_result,
+                             ProgressCallback on_progress) {
+    convergence_ = ConvergenceReport{};
+    variance_ = VarianceReport{};
+    monitor_.reset();
+    if (config_.ci_half_width > 0.0) {
+        monitor_ = std::make_unique<ConvergenceMonitor>(
+            config_.ci_metrics, config_.ci_half_width, std::max(config_.ci_block, 1));
+    }
+    std::unique_ptr<AntitheticEstimator> antithetic;
+    if (config_.antithetic) {
+        antithetic = std::make_unique<AntitheticEstimator>(config_.ci_metrics);
+    }
+
+    if (!monitor_ && !antithetic) {
+        run_jobs({&prototype}, on_result, on_progress);
+        return;
+    }
+    run_jobs({&prototype}, [&](RunResult& r) {
+        if (monitor_) monitor_->add(r);
+        if (antithetic) antithetic->add(r);
+        on_result(r);
+    }, on_progress);
+    monitor_.reset();
+    if (antithetic) variance_ = antithetic->report();
+}
+
+int MCRunner::run_seed(int run_index) const {
+    // Antithetic pairs share a seed
+    return config_.base_seed + (config_.antithetic ? run_index / 2 : run_index);
+}
+
+bool MCRunner::block_converged() {
+    if (!monitor_) return false;
+    convergence_ = monitor_->report();
+    if (on_convergence_) on_convergence_(convergence_);
+    return convergence_.converged;
+}
+
+void MCRunner::run_doe(const std::vector<MCWorld>& prototypes,
+                       const DOEResultCallback& on_result,
+                       ProgressCallback on_progress) {
+    // Convergence stopping is per batch; a sweep always runs every pair
+    convergence_ = ConvergenceReport{};
+    monitor_.reset();
+
+    std::vector<const MCWorld*> protos;
+    protos.reserve(prototypes.size());
+    for (const auto& w : prototypes) protos.push_back(&w);
+
+    const int runs = std::max(config_.num_runs, 0);
+    int delivered = 0;
+    run_jobs(protos, [&](RunResult& r) {
+        on_result(delivered / runs, r);
+        delivered++;
+    }, on_progress);
+}
+
+void MCRunner::run_jobs(const std::vector<const MCWorld*>& prototypes,
+                        const ResultCallback& on_result_,
+                        ProgressCallback on_progress) {
+    // Results reach the tail report in delivery order, one at a time
+    tail_ = TailReport(config_.tail_runs);
+    const ResultCallback on_result = !tail_.enabled() ? on_result_
+        : ResultCallback([&](RunResult& r) {
+              tail_.add(r);
+              on_result_(r);
+          });
+
+    if (branching() && prototypes.size() == 1) {
+        run_branched(*prototypes[0], on_result, on_progress);
+        return;
+    }
+
+    // Deterministic motion, tabulated once per prototype for every run
+    struct ReleaseEphemerides {
+        std::vector<std::pair<const MCWorld*, std::shared_ptr<const SharedEphemeris>>>& tables;
+        ~ReleaseEphemerides() { tables.clear(); }
+    } release{ephemerides_};
+    ephemerides_.clear();
+    if (config_.shared_ephemeris && config_.coast_dt <= 0.0 && !run_setup_) {
+        for (const MCWorld* prototype : prototypes) {
+            ephemerides_.emplace_back(prototype, build_ephemeris(*prototype));
+        }
+    }
+
+    if (config_.num_threads != 1 || lockstep_width() > 1) {
+        run_parallel(prototypes, on_result, on_progress);
+        return;
+    }
+
+    const int runs = std::max(config_.num_runs, 0);
+    const int total = runs * static_cast<int>(prototypes.size());
+    const int block = std::max(config_.ci_block, 1);
+
+    // Reused across runs so entity strings/vectors keep their capacity
+    MCWorld world;
+
+    for (int j = 0; j < total; j++) {
+        int i = config_.first_run + j % runs;
+        int seed = run_seed(i);
 
         if (config_.verbose) {
-            std::cerr << "Run " << (i + 1) << "/" << config_.num_runs
+            std::cerr << "Run " << (j + 1) << "/" << total
                       << " (seed=" << seed << ")..." << std::flush;
         }
 
-        RunResult result = run_single(scenario, i, seed);
-        results.push_back(std::move(result));
+        RunResult result = run_single(*prototypes[j / runs], world, i, seed);
 
         if (config_.verbose) {
-            std::cerr << " done (t=" << results.back().sim_time_final
-                      << "s, engagements=" << results.back().engagement_log.size()
+            std::cerr << " done (t=" << result.sim_time_final
+                      << "s, engagements=" << result.engagement_log.size()
                       << ")\n";
         }
 
+        on_result(result);
+
         if (on_progress) {
-            on_progress(i + 1, config_.num_runs);
+            on_progress(j + 1, total);
+        }
+
+        if (monitor_ && ((j + 1) % block == 0 || j + 1 == total)) {
+            if (block_converged()) break;
         }
     }
+}
 
-    return results;
+void MCRunner::run_parallel(const std::vector<const MCWorld*>& prototypes,
+                            const ResultCallback& on_result,
+                            ProgressCallback on_progress) {
+    const int runs = std::max(config_.num_runs, 0);
+    const int total = runs * static_cast<int>(prototypes.size());
+
+    sim::ThreadPool pool(config_.num_threads, config_.placement);
+
+    if (config_.verbose) {
+        std::cerr << "Running " << total << " runs on " << pool.size() << " threads";
+        if (pool.num_nodes() > 1) std::cerr << " across " << pool.num_nodes() << " NUMA nodes";
+        std::cerr << "\n";
+    }
+
+    // One scratch world per participant, reused across that thread's runs;
+    // in lockstep mode a group of K worlds per participant
+    const int K = lockstep_width();
+    std::vector<MCWorld> worlds(K == 1 ? static_cast<size_t>(pool.size()) : 0);
+    std::vector<Lockstep> lockstep(K > 1 ? static_cast<size_t>(pool.size()) : 0);
+
+    // Window of in-flight runs: results are buffered only until every
+    // lower-indexed run in the window has been delivered. With an early
+    // stop the window is one convergence block.
+    const int window = monitor_ ? std::max(config_.ci_block, 1)
+                                : std::max(1, pool.size() * 16) * K;
+    std::vector<RunResult> pending(static_cast<size_t>(std::min(window, total)));
+    std::vector<uint8_t> done(pending.size());
+
+    // Lockstep groups: up to K consecutive runs of one prototype
+    std::vector<std::pair<int, int>> groups;   // (first job, count)
+    std::mutex progress_mutex;
+    int completed = 0;
+
+    for (int base = 0; base < total; base += window) {
+        int count = std::min(window, total - base);
+        std::fill(done.begin(), done.end(), 0);
+        int next_emit = 0;
+
+        groups.clear();
+        for (int job = base; job < base + count; ) {
+            int len = std::min({K, runs - job % runs, base + count - job});
+            groups.emplace_back(job, len);
+            job += len;
+        }
+
+        pool.parallel_for(groups.size(), [&](size_t g, int worker) {
+            const int first = groups[g].first;
+            const int len = groups[g].second;
+            const size_t slot = static_cast<size_t>(first - base);
+
+            // Each slot is written by exactly one thread — no lock needed
+            if (K == 1) {
+                int run_index = config_.first_run + first % runs;
+                pending[slot] = run_single(*prototypes[first / runs], worlds[worker],
+                                           run_index, run_seed(run_index));
+            } else {
+                run_lockstep(*prototypes[first / runs], lockstep[worker],
+                             first, len, &pending[slot]);
+            }
+
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            for (int j = 0; j < len; j++) {
+                size_t k = slot + static_cast<size_t>(j);
+                completed++;
+                done[k] = 1;
+
+                if (config_.verbose) {
+                    std::cerr << "Run " << (first + j + 1) << "/" << total
+                              << " (seed=" << pending[k].seed << ") done (t="
+                              << pending[k].sim_time_final
+                              << "s, engagements=" << pending[k].engagement_log.size()
+                              << ")\n";
+                }
+            }
+
+            // Deliver the contiguous completed prefix
+            while (next_emit < count && done[next_emit]) {
+                on_result(pending[next_emit]);
+                pending[next_emit] = RunResult{};
+                next_emit++;
+            }
+
+            if (on_progress) {
+                on_progress(completed, total);
+            }
+        });
+
+        if (monitor_ && block_converged()) break;
+    }
 }
 
-RunResult MCRunner::run_single(const sim::JsonValue& scenario,
+RunResult MCRunner::run_single(const MCWorld& prototype, MCWorld& world,
                                int run_index, int seed) {
     RunResult result;
     result.run_index = run_index;
     result.seed = seed;
 
     try {
-        // Build fresh world from scenario
-        MCWorld world = ScenarioParser::parse(scenario);
-        world.rng.setSeed(seed);
-        world.sim_time = 0.0;
+        begin_run(prototype, world, run_index, seed);
 
         int total_steps = static_cast<int>(
             std::ceil(config_.max_sim_time / config_.dt));
-        double dt = config_.dt;
+        advance(world, 0, total_steps);
 
-        std::unordered_map<std::string, bool> seen_engagements;
+        end_run(world, result);
 
-        for (int step = 0; step < total_steps; step++) {
-            world.sim_time += dt;
+    } catch (const std::exception& e) {
+        result.error = std::string("Run error: ") + e.what();
+    }
 
-            // System execution order: AI → Physics → Sensors → Weapons → Events
-            tick(world, dt);
+    return result;
+}
 
-            // Collect engagements periodically (every 200 steps like JS)
-            if (step % 200 == 199 || step == total_steps - 1) {
-                collect_engagements(world, world.sim_time,
-                                    result.engagement_log, seen_engagements);
-            }
+void MCRunner::begin_run(const MCWorld& prototype, MCWorld& world,
+                         int run_index, int seed) {
+    // Reset to the parsed initial state. Copy-assignment reuses the
+    // existing element storage, so steady-state runs barely allocate.
+    world = prototype;
+    seed_run(world, run_index, seed);
+    apply_world_options(world);
+    if (run_setup_) run_setup_(world, run_index);
+    world.sim_time = 0.0;
+
+    for (const auto& [proto, table] : ephemerides_) {
+        if (proto != &prototype || !table) continue;
+        world.ephemeris = table;
+        world.on_ephemeris.assign(world.entity_count(), 0);
+        for (EntityHandle h : table->entities()) world.on_ephemeris[h] = 1;
+    }
+}
+
+void MCRunner::seed_run(MCWorld& world, int run_index, int seed) const {
+    world.rng.set_mode(config_.rng_mode);
+    bool mirrored = config_.antithetic && (run_index & 1);
+    world.rng.set_stream(seed, static_cast<uint32_t>(
+        config_.antithetic ? run_index / 2 : run_index));
+    world.rng.set_antithetic(mirrored);
+}
 
-            // Early termination check
-            if (all_combat_resolved(world)) {
-                // Final engagement collection
-                collect_engagements(world, world.sim_time,
-                                    result.engagement_log, seen_engagements);
+void MCRunner::apply_world_options(MCWorld& world) const {
+    world.missiles.enabled = config_.missile_flyout;
+    world.swept_contact = config_.swept_contact;
+    world.flight_rk2 = config_.flight_rk2;
+    world.run_profile = RunProfile{};
+    world.run_profile.systems = config_.tail_runs > 0;
+    world.budget_exceeded.clear();
+    world.lod.enabled = config_.lod_dt > 0.0;
+    world.lod.interval = config_.lod_dt;
+    world.radar_los = config_.radar_los;
+    world.radar_frames.clear();
+    world.tracks.enabled = config_.radar_tracks;
+    world.comms.enabled = config_.comms && world.comms.has_links();
+    world.iads.enabled = config_.iads && !world.iads.sectors.empty();
+
+    // WEZ tables by weapon name (a weapon without one shoots on range alone)
+    world.wez = wez_;
+    for (size_t w = 0; w < NUM_A2A_WEAPONS; w++) {
+        world.a2a_wez[w] = wez_ ? wez_->find(a2a_weapon_to_string(static_cast<A2AWeapon>(w)))
+                                : nullptr;
+    }
+    for (uint32_t i : world.with_weapon(WeaponType::SAM_BATTERY)) {
+        MCEntity& e = world.entities()[i];
+        e.sam_wez_table = wez_ && !e.sam_wez.empty() ? wez_->find(e.sam_wez) : nullptr;
+        e.sam_intercept_table = wez_ && !e.sam_wez.empty() ? wez_->find_intercept(e.sam_wez)
+                                                           : nullptr;
+    }
+
+    // Decision periods in ticks; the tick count itself travels with the
+    // world, so branched runs keep their phase
+    DecisionSchedule& d = world.decisions;
+    d.enabled = config_.ai_decisions;
+    auto ticks = [&](double period) {
+        if (config_.ai_decision_dt > 0.0) period = config_.ai_decision_dt;
+        return static_cast<uint32_t>(std::max(1.0, std::round(period / config_.dt)));
+    };
+    d.period.fill(1);
+    d.period[static_cast<size_t>(AIType::ORBITAL_COMBAT)] = ticks(OrbitalCombatAI::DECISION_PERIOD);
+    d.period[static_cast<size_t>(AIType::WAYPOINT_PATROL)] = ticks(WaypointPatrolAI::DECISION_PERIOD);
+    d.period[static_cast<size_t>(AIType::INTERCEPT)] = ticks(InterceptAI::DECISION_PERIOD);
+}
+
+std::shared_ptr<const SharedEphemeris> MCRunner::build_ephemeris(const MCWorld& prototype) {
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    if (total_steps <= 0) return nullptr;
+    const size_t steps = static_cast<size_t>(total_steps);
+
+    // The table fits the configured cap and what --memory-budget leaves
+    double budget = std::max(config_.ephemeris_mb, 0.0) * 1048576.0;
+    const MemoryAccount& account = memory_account(MemoryTag::EPHEMERIS);
+    if (account.budget() > 0) {
+        const double left = static_cast<double>(account.budget() - account.current());
+        budget = std::min(budget, std::max(left, 0.0));
+    }
+    std::vector<EntityHandle> picked = SharedEphemeris::select(
+        prototype, config_.lod_dt <= 0.0, steps, static_cast<size_t>(budget));
+    if (picked.empty()) return nullptr;
+    auto table = std::make_shared<SharedEphemeris>(prototype, picked, steps, config_.dt);
+
+    // A run of the prototype with only the tabulated entities alive, through
+    // the same AI, orbit and aircraft stages; nothing they do draws or reads
+    // another entity, so every run would move them the same way
+    MCWorld world = prototype;
+    seed_run(world, config_.first_run, run_seed(config_.first_run));
+    apply_world_options(world);
+    world.sim_time = 0.0;
+    std::vector<uint8_t> keep(world.entity_count(), 0);
+    for (EntityHandle h : picked) keep[h] = 1;
+    for (EntityHandle h = 0; h < world.entity_count(); h++) {
+        if (!keep[h] && world.alive(h)) world.set_active(world.entities()[h], false);
+    }
+
+    const double dt = config_.dt;
+    for (size_t step = 0; step < steps; step++) {
+        world.sim_time += dt;
+        tick_ai(world, dt);
+        tick_orbits(world, dt);
+        tick_flight(world, dt);
+        table->record(step, world);
+    }
+
+    if (config_.verbose) {
+        std::cerr << "Shared ephemeris: " << table->orbital_count() << " orbital, "
+                  << table->flight_count() << " aircraft, " << steps << " ticks ("
+                  << table->bytes() / 1048576.0 << " MB)\n";
+    }
+    return table;
+}
+
+bool MCRunner::advance(MCWorld& world, int step, int end_step) {
+    const double dt = config_.dt;
+    RunProfile& cost = world.run_profile;
+    const bool timed = config_.run_wall_budget > 0.0 || cost.systems;
+    TickProfiler::Clock::time_point mark;
+    if (timed) mark = TickProfiler::Clock::now();
+    auto charge_wall = [&] {
+        TickProfiler::Clock::time_point now = TickProfiler::Clock::now();
+        cost.wall_seconds += std::chrono::duration<double>(now - mark).count();
+        mark = now;
+    };
+
+    bool ended = false;
+    for (; step < end_step; step++) {
+        if (config_.run_step_budget > 0 && budget_spent(world)) {
+            ended = true;
+            break;
+        }
+        world.sim_time += dt;
+
+        // System execution order: AI → Physics → Sensors → Weapons → Events
+        tick(world, dt);
+        cost.ticks++;
+
+        // Early termination check
+        if (all_combat_resolved(world)) {
+            ended = true;
+            break;
+        }
+        if (timed && cost.ticks % WALL_CHECK_TICKS == 0) {
+            charge_wall();
+            if (config_.run_wall_budget > 0.0 && budget_spent(world)) {
+                ended = true;
                 break;
             }
         }
+    }
+    if (timed) charge_wall();
+    return ended;
+}
 
-        result.sim_time_final = world.sim_time;
-        result.entity_survival = collect_survival(world);
+bool MCRunner::budget_spent(MCWorld& world) const {
+    const RunProfile& cost = world.run_profile;
+    std::ostringstream what;
+    if (config_.run_step_budget > 0 &&
+        cost.ticks >= static_cast<uint64_t>(config_.run_step_budget)) {
+        what << "step budget of " << config_.run_step_budget << " ticks";
+    } else if (config_.run_wall_budget > 0.0 && cost.wall_seconds > config_.run_wall_budget) {
+        what << "wall-clock budget of " << config_.run_wall_budget << " s";
+    } else {
+        return false;
+    }
+    what << " spent at t=" << world.sim_time << " s (" << cost.ticks << " ticks)";
+    world.budget_exceeded = "Run budget: " + what.str();
+    return true;
+}
 
-    } catch (const std::exception& e) {
-        result.error = std::string("Run error: ") + e.what();
+void MCRunner::end_run(const MCWorld& world, RunResult& result) const {
+    result.sim_time_final = world.sim_time;
+    collect_engagements(world, result.engagement_log);
+    result.entity_survival = collect_survival(world);
+    result.profile = world.run_profile;
+    runner_metrics().runs.add();
+    if (!world.budget_exceeded.empty()) {
+        result.error = world.budget_exceeded;
+        runner_metrics().over_budget.add();
     }
 
-    return result;
+    const FlightLODState& lod = world.lod;
+    if (lod.enabled) {
+        result.lod = LODStats{true, lod.full_ticks, lod.coarse_ticks, lod.promotions,
+                              lod.demotions, lod.error_sum, lod.error_max};
+    }
 }
 
-void MCRunner::tick(MCWorld& world, double dt) {
-    // 1. AI systems
-    OrbitalCombatAI::update_all(dt, world);
-    WaypointPatrolAI::update_all(dt, world);
-    InterceptAI::update_all(dt, world);
+// ---------------------------------------------------------------------------
+// Snapshot-and-branch
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// Stream seed of snapshot `node` after branch point `level` (0 = the
+// root's prefix). A splitmix64 hash, so branch streams stay clear of the
+// base_seed + run seeds the runs themselves use.
+int32_t branch_seed(int base_seed, size_t level, size_t node) {
+    uint64_t z = static_cast<uint64_t>(static_cast<uint32_t>(base_seed)) ^
+                 (static_cast<uint64_t>(level) << 32) ^
+                 (static_cast<uint64_t>(node) * 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return static_cast<int32_t>(z & 0x7FFFFFFFu);
+}
 
-    // 2. Physics systems
-    for (auto& entity : world.entities()) {
-        if (!entity.active || entity.destroyed) continue;
+} // namespace
 
-        switch (entity.physics_type) {
-            case PhysicsType::ORBITAL_2BODY:
-                propagate_kepler(entity.eci_pos, entity.eci_vel, dt);
-                break;
-            case PhysicsType::FLIGHT_3DOF:
-                // Handled by Flight3DOF::update_all below
-                break;
-            case PhysicsType::STATIC:
-            case PhysicsType::NONE:
-                break;
+bool MCRunner::branching() const {
+    return config_.branch_on_first_draw || !config_.branch_times.empty();
+}
+
+std::vector<int> MCRunner::branch_steps(const MCWorld& prototype) {
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    std::vector<int> steps;
+
+    if (config_.branch_on_first_draw) {
+        // Every run is identical until something draws: find the first
+        // tick that does (the snapshot is taken just before it)
+        MCWorld probe;
+        int step = 0;
+        try {
+            probe = prototype;
+            apply_world_options(probe);
+            probe.sim_time = 0.0;
+            for (; step < total_steps; step++) {
+                uint64_t before = probe.rng.draws();
+                probe.sim_time += config_.dt;
+                tick(probe, config_.dt);
+                if (probe.rng.draws() != before) break;
+                if (all_combat_resolved(probe)) {
+                    step = total_steps;
+                    break;
+                }
+            }
+        } catch (const std::exception&) {
+            step = 0;    // every run meets the error itself
         }
+        steps.push_back(step);
     }
-    Flight3DOF::update_all(dt, world);
 
-    // 3. Sensors
-    RadarSensor::update_all(dt, world);
+    for (double t : config_.branch_times) {
+        long k = std::lround(t / config_.dt);
+        int step = static_cast<int>(std::clamp(k, 0L, static_cast<long>(total_steps)));
+        if (!steps.empty()) step = std::max(step, steps.back());
+        steps.push_back(step);
+    }
+    return steps;
+}
 
-    // 4. Weapon systems
-    KineticKill::update_all(dt, world);
-    SAMBattery::update_all(dt, world);
-    A2AMissile::update_all(dt, world);
+std::shared_ptr<MCRunner::BranchPrefix> MCRunner::build_branch_tree(const MCWorld& prototype,
+                                                                   sim::ThreadPool& pool) {
+    const std::vector<int> points = branch_steps(prototype);
 
-    // 5. Events
-    EventSystem::update_all(dt, world);
+    // Root: one world up to the first point, on its own stream
+    BranchLevel level, next;
+    level.worlds.resize(1);
+    level.ended.assign(1, 0);
+    level.error.assign(1, std::string());
+    try {
+        MCWorld& root = level.worlds[0];
+        root = prototype;
+        root.rng.set_mode(config_.rng_mode);
+        root.rng.set_stream(branch_seed(config_.base_seed, 0, 0), 0);
+        root.rng.set_antithetic(false);
+        apply_world_options(root);
+        root.sim_time = 0.0;
+        level.ended[0] = advance(root, 0, points[0]);
+    } catch (const std::exception& e) {
+        level.error[0] = std::string("Run error: ") + e.what();
+    }
+
+    // Inner levels: each snapshot forks its children, which run on to
+    // the next point. Child c descends from snapshot c % parents.
+    for (size_t k = 1; k < points.size(); k++) {
+        const size_t parents = level.worlds.size();
+        const int fanout = k - 1 < config_.branch_fanout.size()
+                               ? std::max(config_.branch_fanout[k - 1], 1) : 1;
+        const size_t n = parents * static_cast<size_t>(fanout);
+        next.worlds.resize(n);
+        next.ended.assign(n, 0);
+        next.error.assign(n, std::string());
+
+        pool.parallel_for(n, [&](size_t c) {
+            const size_t p = c % parents;
+            next.ended[c] = level.ended[p];
+            next.error[c] = level.error[p];
+            if (!next.error[c].empty()) return;
+            MCWorld& world = next.worlds[c];
+            try {
+                world = level.worlds[p];
+                if (next.ended[c]) return;
+                world.rng.set_stream(branch_seed(config_.base_seed, k, c),
+                                     static_cast<uint32_t>(c));
+                next.ended[c] = advance(world, points[k - 1], points[k]);
+            } catch (const std::exception& e) {
+                next.error[c] = std::string("Run error: ") + e.what();
+            }
+        });
+        std::swap(level, next);
+    }
+
+    auto prefix = std::make_shared<BranchPrefix>();
+    prefix->points = points;
+    prefix->worlds = std::move(level.worlds);
+    prefix->ended = std::move(level.ended);
+    prefix->error = std::move(level.error);
+    return prefix;
 }
 
-bool MCRunner::all_combat_resolved(const MCWorld& world) const {
-    // Orbital combat resolution (existing)
-    int blue_hva_alive = 0, red_hva_alive = 0;
-    int blue_combat_alive = 0, red_combat_alive = 0;
-    bool has_orbital_combat = false;
+void MCRunner::run_branched(const MCWorld& prototype,
+                            const ResultCallback& on_result,
+                            ProgressCallback on_progress) {
+    const int runs = std::max(config_.num_runs, 0);
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    const size_t num_points = config_.branch_times.size() + (config_.branch_on_first_draw ? 1 : 0);
+
+    sim::ThreadPool pool(config_.num_threads, config_.placement);
+
+    std::shared_ptr<const BranchPrefix> prefix = std::move(reuse_prefix_);
+    reuse_prefix_.reset();
+    const bool reused = prefix && prefix->points.size() == num_points;
+    if (!reused) prefix = build_branch_tree(prototype, pool);
+    prefix_ = keep_prefix_ ? prefix : nullptr;
+    const BranchPrefix& level = *prefix;
+    const std::vector<int>& points = level.points;
+
+    const size_t leaves = level.worlds.size();
+    if (config_.verbose) {
+        std::cerr << "Branching at step";
+        for (int p : points) std::cerr << " " << p;
+        std::cerr << ": " << leaves << " snapshot" << (leaves == 1 ? "" : "s")
+                  << (reused ? " (reused)" : "")
+                  << ", " << runs << " runs on " << pool.size() << " threads\n";
+    }
+
+    // Runs fork from the last level in windows, as in run_parallel()
+    std::vector<MCWorld> worlds(static_cast<size_t>(pool.size()));
+    const int window = monitor_ ? std::max(config_.ci_block, 1)
+                                : std::max(1, pool.size() * 16);
+    std::vector<RunResult> pending(static_cast<size_t>(std::min(window, runs)));
+    std::vector<uint8_t> done(pending.size());
+    std::mutex progress_mutex;
+    int completed = 0;
+
+    for (int base = 0; base < runs; base += window) {
+        int count = std::min(window, runs - base);
+        std::fill(done.begin(), done.end(), 0);
+        int next_emit = 0;
+
+        pool.parallel_for(static_cast<size_t>(count), [&](size_t slot, int worker) {
+            const int run_index = config_.first_run + base + static_cast<int>(slot);
+            const int pair = config_.antithetic ? run_index / 2 : run_index;
+            const size_t p = static_cast<size_t>(pair) % leaves;
+
+            RunResult& r = pending[slot];
+            r = RunResult{};
+            r.run_index = run_index;
+            r.seed = run_seed(run_index);
+            r.error = level.error[p];
+            if (r.error.empty()) {
+                MCWorld& world = worlds[worker];
+                try {
+                    world = level.worlds[p];
+                    seed_run(world, run_index, r.seed);
+                    if (run_setup_) run_setup_(world, run_index);
+                    if (!level.ended[p]) advance(world, points.back(), total_steps);
+                    end_run(world, r);
+                } catch (const std::exception& e) {
+                    r.error = std::string("Run error: ") + e.what();
+                }
+            }
 
-    // Atmospheric combat resolution
-    int blue_atmo_alive = 0, red_atmo_alive = 0;
-    bool has_atmo_combat = false;
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            completed++;
+            done[slot] = 1;
+            if (config_.verbose) {
+                std::cerr << "Run " << (base + slot + 1) << "/" << runs
+                          << " (seed=" << r.seed << ") done (t=" << r.sim_time_final
+                          << "s, engagements=" << r.engagement_log.size() << ")\n";
+            }
+            while (next_emit < count && done[next_emit]) {
+                on_result(pending[next_emit]);
+                pending[next_emit] = RunResult{};
+                next_emit++;
+            }
+            if (on_progress) on_progress(completed, runs);
+        });
 
-    for (const auto& entity : world.entities()) {
-        bool alive = entity.active && !entity.destroyed;
-
-        // Orbital combat entities (have orbital AI with roles)
-        if (entity.ai_type == AIType::ORBITAL_COMBAT &&
-            entity.role != CombatRole::NONE) {
-            has_orbital_combat = true;
-            if (entity.role == CombatRole::HVA) {
-                if (alive) {
-                    if (entity.team == "blue") blue_hva_alive++;
-                    else if (entity.team == "red") red_hva_alive++;
+        if (monitor_ && block_converged()) break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Multilevel splitting
+// ---------------------------------------------------------------------------
+
+SplittingReport MCRunner::run_splitting(const MCWorld& prototype, const SplittingSpec& spec,
+                                        ProgressCallback on_progress) {
+    SplittingReport report;
+    const size_t effort = static_cast<size_t>(std::max(spec.effort, 1));
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    const double dt = config_.dt;
+    const int total = static_cast<int>(effort * spec.thresholds.size());
+
+    sim::ThreadPool pool(config_.num_threads, config_.placement);
+
+    // Entrance snapshots of the current level; trajectories of the level
+    // run in `next`, and those reaching its threshold become the next
+    // level's entrances
+    std::vector<MCWorld> entrance, next(effort);
+    std::vector<int> entrance_step, next_step(effort);
+    std::vector<uint8_t> outcome(effort);    // 0 missed, 1 reached, 2 error
+    std::vector<double> seconds(effort);
+    std::mutex progress_mutex;
+    int completed = 0;
+
+    for (size_t k = 0; k < spec.thresholds.size(); k++) {
+        const double threshold = spec.thresholds[k];
+
+        pool.parallel_for(effort, [&](size_t j) {
+            MCWorld& world = next[j];
+            int step = 0;
+            outcome[j] = 0;
+            seconds[j] = 0.0;
+            try {
+                if (k == 0) {
+                    int run_index = config_.first_run + static_cast<int>(j);
+                    begin_run(prototype, world, run_index, run_seed(run_index));
+                } else {
+                    size_t src = j % entrance.size();
+                    world = entrance[src];
+                    step = entrance_step[src];
+                    world.rng.set_stream(branch_seed(config_.base_seed, k, j),
+                                         static_cast<uint32_t>(j));
+                    world.rng.set_antithetic(false);
                 }
-            } else {
-                if (alive) {
-                    if (entity.team == "blue") blue_combat_alive++;
-                    else if (entity.team == "red") red_combat_alive++;
+
+                // One tick can carry a trajectory past several thresholds
+                const double t0 = world.sim_time;
+                if (spec.progress(world) >= threshold) {
+                    outcome[j] = 1;
+                } else {
+                    while (step < total_steps) {
+                        world.sim_time += dt;
+                        tick(world, dt);
+                        step++;
+                        if (spec.progress(world) >= threshold) {
+                            outcome[j] = 1;
+                            break;
+                        }
+                        if (all_combat_resolved(world)) break;
+                    }
                 }
+                seconds[j] = world.sim_time - t0;
+                next_step[j] = step;
+            } catch (const std::exception&) {
+                outcome[j] = 2;
             }
-        }
 
-        // Atmospheric combat entities (aircraft with AI or weapons)
-        if (entity.physics_type == PhysicsType::FLIGHT_3DOF &&
-            (entity.has_ai || entity.has_weapon)) {
-            has_atmo_combat = true;
-            if (alive) {
-                if (entity.team == "blue") blue_atmo_alive++;
-                else if (entity.team == "red") red_atmo_alive++;
+            if (on_progress) {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                on_progress(++completed, total);
+            }
+        });
+
+        SplitLevel level;
+        level.threshold = threshold;
+        entrance.clear();
+        entrance_step.clear();
+        for (size_t j = 0; j < effort; j++) {
+            level.sim_seconds += seconds[j];
+            if (outcome[j] == 2) {
+                level.errors++;
+                continue;
+            }
+            level.started++;
+            if (outcome[j] == 1) {
+                level.reached++;
+                entrance.push_back(std::move(next[j]));
+                entrance_step.push_back(next_step[j]);
             }
         }
+        level.probability = level.started > 0
+            ? static_cast<double>(level.reached) / level.started : 0.0;
+        report.levels.push_back(level);
+        report.sim_seconds += level.sim_seconds;
+
+        if (config_.verbose) {
+            std::cerr << "Level " << (k + 1) << "/" << spec.thresholds.size()
+                      << " (threshold " << threshold << "): " << level.reached << "/"
+                      << level.started << " reached, " << level.errors << " errors\n";
+        }
+        if (level.reached == 0) break;
     }
 
-    // Orbital: terminate if all HVAs or all combat units on one side destroyed
-    if (has_orbital_combat) {
-        if (blue_hva_alive == 0 || red_hva_alive == 0) return true;
-        if (blue_combat_alive == 0 || red_combat_alive == 0) return true;
+    // Product estimator; relative variance summed over levels
+    if (report.levels.size() == spec.thresholds.size() && !report.levels.empty() &&
+        report.levels.back().reached > 0) {
+        double p = 1.0;
+        double rel_var = 0.0;
+        for (const SplitLevel& l : report.levels) {
+            p *= l.probability;
+            rel_var += (1.0 - l.probability) / (l.started * l.probability);
+        }
+        report.probability = p;
+        report.relative_error = std::sqrt(rel_var);
+        report.ci_lo = std::max(0.0, p * (1.0 - 1.96 * report.relative_error));
+        report.ci_hi = p * (1.0 + 1.96 * report.relative_error);
+        report.trajectory_weight = p / report.levels.back().reached;
     }
+    return report;
+}
 
-    // Atmospheric: terminate if all aircraft on one side destroyed
-    if (has_atmo_combat) {
-        if (blue_atmo_alive == 0 || red_atmo_alive == 0) return true;
+int MCRunner::lockstep_width() const {
+    // Lockstep lanes always step together, so coasting keeps runs apart
+    if (config_.lockstep <= 1 || config_.coast_dt > 0.0) return 1;
+    return std::min(config_.lockstep, MAX_LOCKSTEP);
+}
+
+void MCRunner::run_lockstep(const MCWorld& prototype, Lockstep& ls,
+                            int first_job, int count, RunResult* out) {
+    const int runs = std::max(config_.num_runs, 1);
+    const size_t K = static_cast<size_t>(count);
+    if (ls.worlds.size() < K) ls.worlds.resize(K);
+    ls.live.assign(K, 0);
+
+    for (size_t w = 0; w < K; w++) {
+        int run_index = config_.first_run + (first_job + static_cast<int>(w)) % runs;
+        RunResult& r = out[w];
+        r = RunResult{};
+        r.run_index = run_index;
+        r.seed = run_seed(run_index);
+        try {
+            begin_run(prototype, ls.worlds[w], run_index, r.seed);
+            ls.live[w] = 1;
+        } catch (const std::exception& e) {
+            r.error = std::string("Run error: ") + e.what();
+        }
     }
+    ls.kepler.reset(prototype.with_physics(PhysicsType::ORBITAL_2BODY).size() * K);
+
+    // A lane that throws ends with an error; the others carry on
+    auto guarded = [&](size_t w, auto&& fn) {
+        try {
+            fn(ls.worlds[w]);
+        } catch (const std::exception& e) {
+            out[w].error = std::string("Run error: ") + e.what();
+            ls.live[w] = 0;
+        }
+    };
+
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    const double dt = config_.dt;
+    size_t live = std::count(ls.live.begin(), ls.live.end(), 1);
+
+    // Lanes share the group's wall time while they run
+    const bool timed = config_.run_wall_budget > 0.0 || config_.tail_runs > 0;
+    TickProfiler::Clock::time_point mark;
+    if (timed) mark = TickProfiler::Clock::now();
+    auto charge_wall = [&] {
+        TickProfiler::Clock::time_point now = TickProfiler::Clock::now();
+        double elapsed = std::chrono::duration<double>(now - mark).count();
+        mark = now;
+        for (size_t w = 0; w < K; w++) {
+            if (ls.live[w]) ls.worlds[w].run_profile.wall_seconds += elapsed;
+        }
+    };
 
-    return false;
+    for (int step = 0; step < total_steps && live > 0; step++) {
+        if (config_.run_step_budget > 0) {
+            for (size_t w = 0; w < K; w++) {
+                if (ls.live[w] && budget_spent(ls.worlds[w])) ls.live[w] = 0;
+            }
+            live = std::count(ls.live.begin(), ls.live.end(), 1);
+            if (live == 0) break;
+        }
+        ProfileScope tick_scope(profiler_, ProfileSystem::TICK,
+                                live * prototype.entities().size());
+        runner_metrics().entity_ticks.add(live * prototype.entities().size());
+
+        // Same order as tick(), each stage across every live lane
+        for (size_t w = 0; w < K; w++) {
+            if (!ls.live[w]) continue;
+            guarded(w, [&](MCWorld& world) {
+                world.sim_time += dt;
+                tick_ai(world, dt);
+            });
+        }
+        propagate_orbits_lockstep(ls, K, dt);
+        for (size_t w = 0; w < K; w++) {
+            if (!ls.live[w]) continue;
+            guarded(w, [&](MCWorld& world) { tick_after_orbits(world, dt); });
+        }
+
+        // Early termination masks the lane out of later ticks
+        const bool check_wall = timed && (step + 1) % WALL_CHECK_TICKS == 0;
+        if (check_wall) charge_wall();
+        live = 0;
+        for (size_t w = 0; w < K; w++) {
+            if (!ls.live[w]) continue;
+            MCWorld& world = ls.worlds[w];
+            world.run_profile.ticks++;
+            if (all_combat_resolved(world) ||
+                (check_wall && config_.run_wall_budget > 0.0 && budget_spent(world))) {
+                ls.live[w] = 0;
+                continue;
+            }
+            live++;
+        }
+    }
+    if (timed) charge_wall();
+
+    for (size_t w = 0; w < K; w++) {
+        if (!out[w].error.empty()) continue;
+        guarded(w, [&](MCWorld& world) { end_run(world, out[w]); });
+    }
 }
 
-void MCRunner::collect_engagements(MCWorld& world, double sim_time,
-                                   std::vector<EngagementEvent>& log,
-                                   std::unordered_map<std::string, bool>& seen) {
-    for (const auto& entity : world.entities()) {
-        for (const auto& eng : entity.engagements) {
-            // Deduplication key
-            std::string key = entity.id + "_" + eng.target_id +
-                              "_" + eng.result + "_" +
-                              std::to_string(eng.time);
+void MCRunner::propagate_orbits_lockstep(Lockstep& ls, size_t K, double dt) {
+    const IndexList& orbital = ls.worlds[0].with_physics(PhysicsType::ORBITAL_2BODY);
+    KeplerBatch& batch = ls.kepler;
+    ProfileScope s(profiler_, ProfileSystem::KEPLER, orbital.size() * K);
+
+    // Lanes load exactly as propagate_orbits_cached() loads its own batch
+    for (size_t k = 0; k < orbital.size(); k++) {
+        uint32_t i = orbital[k];
+        for (size_t w = 0; w < K; w++) {
+            size_t lane = k * K + w;
+            batch.step[lane] = 0.0;
+            if (!ls.live[w]) continue;
+
+            MCWorld& world = ls.worlds[w];
+            MCEntity& e = world.entities()[i];
+            if (!world.alive(i)) {
+                if (batch.valid[lane]) batch.invalidate(lane);
+                continue;
+            }
+            if (world.replays(i)) {
+                world.replay(i);
+                continue;
+            }
+            if (e.orbit_dirty || !batch.valid[lane]) {
+                e.orbit_dirty = false;
+                if (!batch.load(lane, e.eci_pos, e.eci_vel)) {
+                    propagate_kepler(e.eci_pos, e.eci_vel, dt);
+                    world.sync_eci_pos(i);
+                    continue;
+                }
+            }
+            batch.step[lane] = dt;
+        }
+    }
 
-            if (seen.count(key)) continue;
-            seen[key] = true;
+    batch.advance_steps_lockstep(K, ls.live.data());
+
+    for (size_t k = 0; k < orbital.size(); k++) {
+        uint32_t i = orbital[k];
+        for (size_t w = 0; w < K; w++) {
+            size_t lane = k * K + w;
+            if (!batch.valid[lane] || batch.step[lane] == 0.0) continue;
+            MCWorld& world = ls.worlds[w];
+            MCEntity& e = world.entities()[i];
+            batch.state(lane, e.eci_pos, e.eci_vel);
+            world.sync_eci_pos(i);
+        }
+    }
+}
+
+// Mirrors the sweep timer test in RadarSensor::update_all
+static bool radar_sweep_due(const MCWorld& world, double dt) {
+    const auto& entities = world.entities();
+    for (uint32_t i : world.radars()) {
+        const MCEntity& e = entities[i];
+        if (!world.alive(i)) continue;
+        if (e.radar_sweep_timer + dt >= e.radar_sweep_interval) return true;
+    }
+    return false;
+}
 
-            // Filter: only LAUNCH, KILL, MISS (not KILLED_BY — that's the victim side)
-            if (eng.result != "LAUNCH" && eng.result != "KILL" && eng.result != "MISS") {
+void MCRunner::propagate_orbits_cached(MCWorld& world, double dt) {
+    auto& entities = world.entities();
+    const IndexList& orbital = world.with_physics(PhysicsType::ORBITAL_2BODY);
+    KeplerBatch& batch = world.kepler;
+    if (batch.size() != orbital.size()) batch.reset(orbital.size());
+
+    // Passive lanes may skip ticks; stop half a step early so float
+    // accumulation of dt never pushes an update one tick late
+    const double coast_dt = config_.coast_dt - 0.5 * dt;
+    bool lagging = false;
+    double pad = 0.0;
+
+    // (Re)load lanes whose orbit changed; degenerate ones take the slow path
+    for (size_t k = 0; k < orbital.size(); k++) {
+        uint32_t i = orbital[k];
+        MCEntity& e = entities[i];
+        batch.step[k] = 0.0;
+        if (!world.alive(i)) {
+            if (batch.valid[k]) batch.invalidate(k);
+            continue;
+        }
+        if (world.replays(i)) {
+            world.replay(i);
+            continue;
+        }
+        if (e.orbit_dirty || !batch.valid[k]) {
+            e.orbit_dirty = false;
+            if (!batch.load(k, e.eci_pos, e.eci_vel)) {
+                propagate_kepler(e.eci_pos, e.eci_vel, dt);
+                world.sync_eci_pos(i);
                 continue;
             }
+        }
 
-            EngagementEvent evt;
-            evt.time = eng.time;
-            evt.source_id = entity.id;
-            evt.source_name = entity.name;
-            evt.source_team = entity.team;
-            evt.target_id = eng.target_id;
-            evt.target_name = eng.target_name;
-            evt.result = eng.result;
+        bool passive = e.ai_type != AIType::ORBITAL_COMBAT ||
+                       e.role == CombatRole::HVA;
+        double due = batch.lag[k] + dt;
+        if (passive && due < coast_dt) {
+            batch.lag[k] = due;
+            lagging = true;
+            pad = std::max(pad, batch.vmax[k] * due);
+        } else {
+            batch.step[k] = due;
+            batch.lag[k] = 0.0;
+        }
+    }
+
+    batch.advance_steps();
+    world.orbits_lagging = lagging;
+    world.orbit_lag_pad = pad;
+
+    for (size_t k = 0; k < orbital.size(); k++) {
+        if (!batch.valid[k] || batch.step[k] == 0.0) continue;
+        uint32_t i = orbital[k];
+        batch.state(k, entities[i].eci_pos, entities[i].eci_vel);
+        world.sync_eci_pos(i);
+    }
+}
+
+void MCRunner::tick(MCWorld& world, double dt) {
+    ProfileScope tick_scope(profiler_, ProfileSystem::TICK, world.entities().size(),
+                            run_profile(world));
+    runner_metrics().entity_ticks.add(world.entities().size());
+    if (tick_executor_) {
+        // Flight3DOF chunks index the wind cursors; none may resize them
+        if (world.wind && world.wind_cursors.size() < world.entities().size()) {
+            world.wind_cursors.resize(world.entities().size());
+        }
+        if (tick_executor_->try_tick(tick_graph_, world, dt, profiler_)) return;
+    }
+    tick_ai(world, dt);
+    tick_orbits(world, dt);
+    tick_after_orbits(world, dt);
+}
+
+void MCRunner::build_tick_graph() {
+    using namespace tick_data;
+    const bool coasting = config_.coast_dt > 0.0;
+    TickGraph& g = tick_graph_;
+
+    // 1. AI systems: one stage, their entity lists are disjoint
+    TickSystem orbital_ai;
+    orbital_ai.name = "orbital_combat_ai";
+    orbital_ai.entities = EntitySet::ai(AIType::ORBITAL_COMBAT);
+    orbital_ai.reads = LIVENESS | DECISIONS;
+    orbital_ai.writes = ORBIT_POS | ORBIT_VEL | SPATIAL;   // burns, coasting targets, ECI grid
+    orbital_ai.own_reads = AI_STATE;
+    orbital_ai.own_writes = AI_STATE;
+    orbital_ai.run = [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::ORBITAL_COMBAT_AI,
+                       world.with_ai(AIType::ORBITAL_COMBAT).size(), run_profile(world));
+        OrbitalCombatAI::update_all(dt, world);
+    };
+    g.add(std::move(orbital_ai));
+
+    TickSystem patrol;
+    patrol.name = "waypoint_patrol_ai";
+    patrol.profile = ProfileSystem::WAYPOINT_PATROL_AI;
+    patrol.entities = EntitySet::ai(AIType::WAYPOINT_PATROL);
+    patrol.reads = LIVENESS | DECISIONS;
+    patrol.own_reads = FLIGHT_POSE | FLIGHT_CONTROLS | AI_STATE;
+    patrol.own_writes = FLIGHT_CONTROLS | AI_STATE;
+    patrol.size = [](const MCWorld& world) {
+        return world.with_ai(AIType::WAYPOINT_PATROL).size();
+    };
+    patrol.run_range = [](MCWorld& world, double dt, size_t begin, size_t end) {
+        WaypointPatrolAI::update_range(dt, world, begin, end);
+    };
+    g.add(std::move(patrol));
+
+    TickSystem intercept;
+    intercept.name = "intercept_ai";
+    intercept.profile = ProfileSystem::INTERCEPT_AI;
+    intercept.entities = EntitySet::ai(AIType::INTERCEPT);
+    intercept.reads = LIVENESS | DECISIONS | FLIGHT_POSE;   // targets' positions
+    intercept.own_reads = FLIGHT_CONTROLS | AI_STATE;
+    intercept.own_writes = FLIGHT_CONTROLS | AI_STATE;
+    intercept.size = [](const MCWorld& world) { return world.with_ai(AIType::INTERCEPT).size(); };
+    intercept.run_range = [](MCWorld& world, double dt, size_t begin, size_t end) {
+        InterceptAI::update_range(dt, world, begin, end);
+    };
+    g.add(std::move(intercept));
+
+    TickSystem clock;
+    clock.name = "decision_clock";
+    clock.writes = DECISIONS;
+    clock.run = [](MCWorld& world, double) { world.decisions.tick++; };
+    g.add(std::move(clock));
+
+    // 2. Physics systems: per entity unless a batch owns the lanes
+    TickSystem kepler;
+    kepler.name = "kepler";
+    kepler.profile = ProfileSystem::KEPLER;
+    kepler.entities = EntitySet::physics(PhysicsType::ORBITAL_2BODY);
+    kepler.reads = LIVENESS;
+    kepler.size = [](const MCWorld& world) {
+        return world.with_physics(PhysicsType::ORBITAL_2BODY).size();
+    };
+    if (config_.cached_kepler || coasting) {
+        kepler.writes = ORBIT_POS | ORBIT_VEL | SPATIAL;   // KeplerBatch, orbit lag
+        kepler.run = [this](MCWorld& world, double dt) { tick_orbits(world, dt); };
+    } else {
+        kepler.own_reads = ORBIT_POS | ORBIT_VEL;
+        kepler.own_writes = ORBIT_POS | ORBIT_VEL;
+        kepler.run_range = [this](MCWorld& world, double dt, size_t begin, size_t end) {
+            propagate_orbits_range(world, dt, begin, end);
+        };
+    }
+    g.add(std::move(kepler));
+
+    if (config_.lod_dt > 0.0) {
+        TickSystem lod;
+        lod.name = "flight_lod";
+        lod.reads = LIVENESS | ORBIT_POS | FLIGHT_POSE;
+        lod.writes = LOD | FLIGHT_POSE;
+        lod.run = [this](MCWorld& world, double dt) {
+            ProfileScope s(profiler_, ProfileSystem::FLIGHT_3DOF,
+                           world.with_physics(PhysicsType::FLIGHT_3DOF).size(), run_profile(world));
+            FlightLOD::update_all(dt, world);
+        };
+        g.add(std::move(lod));
+    }
+
+    TickSystem flight;
+    flight.name = "flight3dof";
+    flight.profile = ProfileSystem::FLIGHT_3DOF;
+    flight.entities = EntitySet::physics(PhysicsType::FLIGHT_3DOF);
+    flight.reads = LIVENESS | LOD;
+    flight.size = [](const MCWorld& world) {
+        return world.with_physics(PhysicsType::FLIGHT_3DOF).size();
+    };
+    if (config_.batch_flight && !config_.flight_rk2) {
+        flight.reads |= FLIGHT_CONTROLS;
+        flight.writes = FLIGHT_POSE;
+        flight.run = [this](MCWorld& world, double dt) {
+            ProfileScope s(profiler_, ProfileSystem::FLIGHT_3DOF,
+                           world.with_physics(PhysicsType::FLIGHT_3DOF).size(), run_profile(world));
+            Flight3DOF::update_batch(dt, world);
+        };
+    } else {
+        flight.own_reads = FLIGHT_POSE | FLIGHT_CONTROLS;
+        flight.own_writes = FLIGHT_POSE;
+        flight.run_range = [](MCWorld& world, double dt, size_t begin, size_t end) {
+            Flight3DOF::update_range(dt, world, begin, end);
+        };
+    }
+    g.add(std::move(flight));
+
+    // 3-5. Everything after the physics phase reads most of the world and
+    // draws from its RNG stream, changes liveness or logs engagements:
+    // whole systems, in order
+    auto serial = [&](const char* name, std::function<void(MCWorld&, double)> run) {
+        TickSystem s;
+        s.name = name;
+        s.reads = ALL;
+        s.writes = ALL;
+        s.run = std::move(run);
+        g.add(std::move(s));
+    };
+    serial("spatial", [coasting](MCWorld& world, double dt) {
+        world.invalidate_spatial();
+        if (coasting && radar_sweep_due(world, dt)) world.refresh_orbits();
+    });
+    serial("missile_flyout", [this](MCWorld& world, double dt) {
+        if (!world.missiles.enabled) return;
+        ProfileScope s(profiler_, ProfileSystem::MISSILE_FLYOUT,
+                       world.missiles.flying().size(), run_profile(world));
+        MissileFlyout::update_all(dt, world);
+    });
+    serial("radar", [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::RADAR, world.radars().size(), run_profile(world));
+        RadarSensor::update_all(dt, world);
+    });
+    serial("comms", [this](MCWorld& world, double dt) {
+        if (!world.comms.enabled) return;
+        ProfileScope s(profiler_, ProfileSystem::COMMS, world.comms.links().size(),
+                       run_profile(world));
+        CommNetwork::update_all(dt, world);
+    });
+    serial("kinetic_kill", [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::KINETIC_KILL, world.any_weapon().size(),
+                       run_profile(world));
+        KineticKill::update_all(dt, world);
+    });
+    serial("iads", [this](MCWorld& world, double dt) {
+        if (!world.iads.enabled) return;
+        ProfileScope s(profiler_, ProfileSystem::IADS, world.iads.sectors.size(),
+                       run_profile(world));
+        IADSCommand::update_all(dt, world);
+    });
+    serial("sam_battery", [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::SAM_BATTERY,
+                       world.with_weapon(WeaponType::SAM_BATTERY).size(), run_profile(world));
+        SAMBattery::update_all(dt, world);
+    });
+    serial("a2a_missile", [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::A2A_MISSILE,
+                       world.with_weapon(WeaponType::A2A_MISSILE).size(), run_profile(world));
+        A2AMissile::update_all(dt, world);
+    });
+    serial("events", [this](MCWorld& world, double dt) {
+        ProfileScope s(profiler_, ProfileSystem::EVENTS, world.events.size(), run_profile(world));
+        EventSystem::update_all(dt, world);
+    });
+    g.build();
+}
+
+void MCRunner::tick_ai(MCWorld& world, double dt) {
+    TickProfiler* prof = profiler_;
+    RunProfile* run = run_profile(world);
+
+    // 1. AI systems
+    {
+        ProfileScope s(prof, ProfileSystem::ORBITAL_COMBAT_AI,
+                       world.with_ai(AIType::ORBITAL_COMBAT).size(), run);
+        OrbitalCombatAI::update_all(dt, world);
+    }
+    {
+        ProfileScope s(prof, ProfileSystem::WAYPOINT_PATROL_AI,
+                       world.with_ai(AIType::WAYPOINT_PATROL).size(), run);
+        WaypointPatrolAI::update_all(dt, world);
+    }
+    {
+        ProfileScope s(prof, ProfileSystem::INTERCEPT_AI,
+                       world.with_ai(AIType::INTERCEPT).size(), run);
+        InterceptAI::update_all(dt, world);
+    }
+    world.decisions.tick++;
+}
 
-            // Weapon type from entity
-            if (entity.weapon_type == WeaponType::KINETIC_KILL) evt.weapon_type = "KKV";
-            else if (entity.weapon_type == WeaponType::SAM_BATTERY) evt.weapon_type = "SAM";
-            else if (entity.weapon_type == WeaponType::A2A_MISSILE) evt.weapon_type = "A2A";
-            else evt.weapon_type = "UNK";
+void MCRunner::tick_orbits(MCWorld& world, double dt) {
+    const bool coasting = config_.coast_dt > 0.0;
+    RunProfile* run = run_profile(world);
+
+    // 2. Physics systems: orbits
+    {
+        const IndexList& orbital = world.with_physics(PhysicsType::ORBITAL_2BODY);
+        ProfileScope s(profiler_, ProfileSystem::KEPLER, orbital.size(), run);
+        if (config_.cached_kepler || coasting) {
+            propagate_orbits_cached(world, dt);
+        } else {
+            propagate_orbits_range(world, dt, 0, orbital.size());
+        }
+    }
+}
 
-            log.push_back(std::move(evt));
+void MCRunner::propagate_orbits_range(MCWorld& world, double dt, size_t begin, size_t end) {
+    auto& entities = world.entities();
+    const IndexList& orbital = world.with_physics(PhysicsType::ORBITAL_2BODY);
+    for (size_t k = begin; k < end; k++) {
+        uint32_t i = orbital[k];
+        if (!world.alive(i)) continue;
+        if (world.replays(i)) {
+            world.replay(i);
+            continue;
         }
+        propagate_kepler(entities[i].eci_pos, entities[i].eci_vel, dt);
+        world.sync_eci_pos(i);
+    }
+}
+
+void MCRunner::tick_after_orbits(MCWorld& world, double dt) {
+    // Coasting lanes are caught up before any full-world read
+    const bool coasting = config_.coast_dt > 0.0;
+    TickProfiler* prof = profiler_;
+    RunProfile* run = run_profile(world);
+
+    tick_flight(world, dt);
+    world.invalidate_spatial();
+    if (coasting && radar_sweep_due(world, dt)) world.refresh_orbits();
+    if (world.missiles.enabled) {
+        ProfileScope s(prof, ProfileSystem::MISSILE_FLYOUT, world.missiles.flying().size(), run);
+        MissileFlyout::update_all(dt, world);
+    }
+
+    // 3. Sensors
+    {
+        ProfileScope s(prof, ProfileSystem::RADAR, world.radars().size(), run);
+        RadarSensor::update_all(dt, world);
+    }
+    if (world.comms.enabled) {
+        ProfileScope s(prof, ProfileSystem::COMMS, world.comms.links().size(), run);
+        CommNetwork::update_all(dt, world);
+    }
+
+    // 4. Weapon systems
+    {
+        ProfileScope s(prof, ProfileSystem::KINETIC_KILL, world.any_weapon().size(), run);
+        KineticKill::update_all(dt, world);
+    }
+    if (world.iads.enabled) {
+        ProfileScope s(prof, ProfileSystem::IADS, world.iads.sectors.size(), run);
+        IADSCommand::update_all(dt, world);
+    }
+    {
+        ProfileScope s(prof, ProfileSystem::SAM_BATTERY,
+                       world.with_weapon(WeaponType::SAM_BATTERY).size(), run);
+        SAMBattery::update_all(dt, world);
+    }
+    {
+        ProfileScope s(prof, ProfileSystem::A2A_MISSILE,
+                       world.with_weapon(WeaponType::A2A_MISSILE).size(), run);
+        A2AMissile::update_all(dt, world);
+    }
+
+    // 5. Events
+    {
+        ProfileScope s(prof, ProfileSystem::EVENTS, world.events.size(), run);
+        EventSystem::update_all(dt, world);
+    }
+}
+
+void MCRunner::tick_flight(MCWorld& world, double dt) {
+    // 2. Physics systems: aircraft
+    ProfileScope s(profiler_, ProfileSystem::FLIGHT_3DOF,
+                   world.with_physics(PhysicsType::FLIGHT_3DOF).size(), run_profile(world));
+    FlightLOD::update_all(dt, world);
+    if (config_.batch_flight && !config_.flight_rk2) {
+        Flight3DOF::update_batch(dt, world);
+    } else {
+        Flight3DOF::update_all(dt, world);
+    }
+}
+
+bool MCRunner::all_combat_resolved(const MCWorld& world) const {
+    const int blue = world.find_team_id("blue");
+    const int red = world.find_team_id("red");
+
+    // Orbital: terminate if all HVAs or all combat units on one side destroyed
+    if (world.members_in(CombatGroup::ORBITAL_HVA) +
+        world.members_in(CombatGroup::ORBITAL_COMBAT) > 0) {
+        if (world.alive_in(CombatGroup::ORBITAL_HVA, blue) == 0 ||
+            world.alive_in(CombatGroup::ORBITAL_HVA, red) == 0) return true;
+        if (world.alive_in(CombatGroup::ORBITAL_COMBAT, blue) == 0 ||
+            world.alive_in(CombatGroup::ORBITAL_COMBAT, red) == 0) return true;
+    }
+
+    // Atmospheric: terminate if all aircraft on one side destroyed
+    if (world.members_in(CombatGroup::AIRCRAFT) > 0) {
+        if (world.alive_in(CombatGroup::AIRCRAFT, blue) == 0 ||
+            world.alive_in(CombatGroup::AIRCRAFT, red) == 0) return true;
+    }
+
+    // Scenario end conditions, then caller-registered predicates
+    if (world.termination_met()) return true;
+    for (const auto& pred : terminations_) {
+        if (pred(world)) return true;
+    }
+    return false;
+}
+
+void MCRunner::collect_engagements(const MCWorld& world,
+                                   std::vector<EngagementEvent>& log) const {
+    const auto& records = world.engagement_log;
+    log.reserve(log.size() + records.size());
+
+    size_t tick_start = 0;   // first record of the current sim time
+    for (size_t k = 0; k < records.size(); k++) {
+        const EngagementRecord& rec = records[k];
+        if (rec.time != records[tick_start].time) tick_start = k;
+
+        // One event per (source, target, result) and tick: a salvo's
+        // launches report once, as in the JS engine
+        bool duplicate = false;
+        for (size_t j = tick_start; j < k && !duplicate; j++) {
+            duplicate = records[j].source == rec.source &&
+                        records[j].target == rec.target &&
+                        records[j].result == rec.result;
+        }
+        if (duplicate) continue;
+
+        const MCEntity& source = world.entities()[rec.source];
+        const MCEntity* target = world.get(rec.target);
+
+        EngagementEvent evt;
+        evt.time = rec.time;
+        evt.source_id = source.id;
+        evt.source_name = source.name;
+        evt.source_team = source.team;
+        evt.target_id = world.id_of(rec.target);
+        evt.target_name = target ? target->name : evt.target_id;
+        evt.result = engagement_result_to_string(rec.result);
+
+        // Weapon type from entity
+        if (source.weapon_type == WeaponType::KINETIC_KILL) evt.weapon_type = "KKV";
+        else if (source.weapon_type == WeaponType::SAM_BATTERY) evt.weapon_type = "SAM";
+        else if (source.weapon_type == WeaponType::A2A_MISSILE) evt.weapon_type = "A2A";
+        else evt.weapon_type = "UNK";
+
+        log.push_back(std::move(evt));
     }
 }
 
@@ -264,15 +1498,83 @@ static Vec3 entity_ecef(const MCEntity& e, double sim_time) {
 
 void MCRunner::run_replay(const sim::JsonValue& scenario,
                           std::ostream& out) {
-    MCWorld world = ScenarioParser::parse(scenario);
-    world.rng.setSeed(config_.base_seed);
+    run_replay(ScenarioParser::parse(scenario), out);
+}
+
+void MCRunner::run_replay(const MCWorld& prototype, std::ostream& out) {
+    MCWorld world = prototype;
+    world.rng.set_mode(config_.rng_mode);
+    world.rng.set_stream(config_.base_seed, 0);   // same draws as batch run 0
+    world.sim_time = 0.0;
+    record_replay(world, out, config_.replay_archive, true);
+}
+
+void MCRunner::run_replay(const MCWorld& prototype, int run_index, std::ostream& out) {
+    MCWorld world;
+    begin_run(prototype, world, run_index, run_seed(run_index));
+    record_replay(world, out, std::string(), false);
+}
+
+void MCRunner::run_live(const MCWorld& prototype, const TickBoundary& boundary) {
+    MCWorld world = prototype;
+    world.rng.set_mode(config_.rng_mode);
+    world.rng.set_stream(config_.base_seed, 0);
     world.sim_time = 0.0;
 
+    const int total_steps = static_cast<int>(std::ceil(config_.max_sim_time / config_.dt));
+    const double dt = config_.dt;
+    for (int step = 0; boundary(world, step) && step < total_steps; step++) {
+        world.sim_time += dt;
+        tick(world, dt);
+    }
+}
+
+void MCRunner::run_replays(const MCWorld& prototype, const std::vector<int>& run_indices,
+                           const ReplaySink& open, ProgressCallback on_progress) {
+    const int total = static_cast<int>(run_indices.size());
+    std::mutex progress_mutex;
+    int completed = 0;
+
+    sim::ThreadPool pool(config_.num_threads, config_.placement);
+    pool.parallel_for(run_indices.size(), [&](size_t i) {
+        std::unique_ptr<std::ostream> out = open(i);
+        run_replay(prototype, run_indices[i], *out);
+        out.reset();
+        if (on_progress) {
+            std::lock_guard<std::mutex> lock(progress_mutex);
+            on_progress(++completed, total);
+        }
+    });
+}
+
+void MCRunner::record_replay(MCWorld& world, std::ostream& out,
+                             const std::string& archive, bool report) {
     // Save initial entity list (before any mutations)
-    std::vector<MCEntity> initial_entities = world.entities();
+    MCEntityList initial_entities = world.entities();
 
     ReplayWriter writer;
     writer.init(initial_entities, config_.sample_interval);
+    // Tiles stay bounded in memory only next to a streamed replay
+    bool tiles = !config_.replay_tiles.empty();
+    bool stream = config_.replay_stream || config_.replay_error > 0.0 || tiles;
+    if (stream) {
+        writer.begin_stream(out, config_, initial_entities,
+                            config_.replay_chunk, config_.replay_quantum,
+                            config_.replay_error, config_.replay_max_gap);
+    }
+    if (!archive.empty() && !writer.begin_archive(archive, initial_entities)) {
+        std::cerr << "Warning: could not create trajectory archive " << archive << "\n";
+    }
+    if (tiles) {
+        ReplayTileOptions options;
+        options.tile_samples = config_.replay_tile_samples;
+        options.group_size = config_.replay_tile_group;
+        options.quantum = config_.replay_quantum;
+        if (!writer.begin_tiles(config_.replay_tiles, config_, initial_entities, options)) {
+            std::cerr << "Warning: could not create replay tiles in " << config_.replay_tiles << "\n";
+            tiles = false;
+        }
+    }
 
     int total_steps = static_cast<int>(
         std::ceil(config_.max_sim_time / config_.dt));
@@ -281,8 +1583,8 @@ void MCRunner::run_replay(const sim::JsonValue& scenario,
     // Track which entities were alive last step (for death detection)
     std::vector<bool> was_alive(world.entity_count(), true);
 
-    // Track per-entity engagement record counts to detect new events
-    std::vector<size_t> prev_eng_counts(world.entity_count(), 0);
+    // Engagement bus records already turned into replay events
+    size_t next_engagement = 0;
 
     // Initial sample at t=0
     writer.sample(world);
@@ -294,53 +1596,46 @@ void MCRunner::run_replay(const sim::JsonValue& scenario,
         tick(world, dt);
 
         // Sample positions at interval
+        if (writer.due(world.sim_time)) world.refresh_orbits();
         writer.sample(world);
 
-        // Detect deaths and new engagement events
+        // Detect deaths
         const auto& entities = world.entities();
         for (size_t i = 0; i < entities.size(); i++) {
             const auto& e = entities[i];
-
-            // Death detection
             if (was_alive[i] && (e.destroyed || !e.active)) {
                 was_alive[i] = false;
                 writer.record_death(e.id, world.sim_time);
             }
+        }
 
-            // Scan only NEW engagement records (append-only per entity)
-            for (size_t j = prev_eng_counts[i]; j < e.engagements.size(); j++) {
-                const auto& eng = e.engagements[j];
-                if (eng.result != "LAUNCH" && eng.result != "KILL" && eng.result != "MISS") {
-                    continue;
-                }
-
-                // Get source and target positions in ECEF
-                Vec3 source_ecef = entity_ecef(e, world.sim_time);
-
-                Vec3 target_ecef{0, 0, 0};
-                const MCEntity* target = world.get_entity(eng.target_id);
-                if (target) {
-                    target_ecef = entity_ecef(*target, world.sim_time);
-                }
+        // New engagement events since the last step, with ECEF positions
+        for (; next_engagement < world.engagement_log.size(); next_engagement++) {
+            const EngagementRecord& eng = world.engagement_log[next_engagement];
+            const MCEntity& source = entities[eng.source];
 
-                ReplayEvent evt;
-                evt.time = eng.time;
-                evt.type = eng.result;
-                evt.source_id = e.id;
-                evt.target_id = eng.target_id;
-                evt.source_pos = source_ecef;
-                evt.target_pos = target_ecef;
-                writer.record_event(evt);
+            Vec3 target_ecef{0, 0, 0};
+            const MCEntity* target = world.get(eng.target);
+            if (target) {
+                target_ecef = entity_ecef(*target, world.sim_time);
             }
-            prev_eng_counts[i] = e.engagements.size();
+
+            ReplayEvent evt;
+            evt.time = eng.time;
+            evt.type = engagement_result_to_string(eng.result);
+            evt.source_id = source.id;
+            evt.target_id = world.id_of(eng.target);
+            evt.source_pos = entity_ecef(source, world.sim_time);
+            evt.target_pos = target_ecef;
+            writer.record_event(evt);
         }
 
         // Progress reporting
-        if (config_.progress && step % 500 == 499) {
+        if (report && config_.progress && step % 500 == 499) {
             std::cerr << "{\"type\":\"replay_progress\",\"step\":" << (step + 1)
                       << ",\"totalSteps\":" << total_steps
                       << ",\"simTime\":" << world.sim_time << "}\n" << std::flush;
-        } else if (config_.verbose && step % 1000 == 999) {
+        } else if (report && config_.verbose && step % 1000 == 999) {
             std::cerr << "  Step " << (step + 1) << "/" << total_steps
                       << " (t=" << world.sim_time << "s)\n";
         }
@@ -350,7 +1645,7 @@ void MCRunner::run_replay(const sim::JsonValue& scenario,
             // Final sample
             writer.sample(world);
 
-            if (config_.verbose) {
+            if (report && config_.verbose) {
                 std::cerr << "  Combat resolved at t=" << world.sim_time
                           << "s (step " << (step + 1) << ")\n";
             }
@@ -359,7 +1654,17 @@ void MCRunner::run_replay(const sim::JsonValue& scenario,
     }
 
     // Write replay JSON
-    writer.write_json(out, config_, initial_entities);
+    if (stream) {
+        writer.finish_stream(initial_entities);
+    } else {
+        writer.write_json(out, config_, initial_entities);
+    }
+    if (!archive.empty() && !writer.end_archive()) {
+        std::cerr << "Warning: trajectory archive " << archive << " is incomplete\n";
+    }
+    if (tiles && !writer.end_tiles(config_, initial_entities)) {
+        std::cerr << "Warning: replay tiles in " << config_.replay_tiles << " are incomplete\n";
+    }
 }
 
 } // namespace sim::mc
@@ -1,70 +1,455 @@
 /**
  * MCRunner — Batch Monte Carlo orchestrator.
  *
- * Runs N independent simulations with seeded RNG, each creating a fresh
- * world from the scenario JSON. Collects engagements and survival data.
+ * Runs N independent simulations with seeded RNG, each starting from a
+ * copy of a prototype world parsed once from the scenario JSON. Collects
+ * engagements and survival data.
  * Supports early termination when combat is resolved.
+ *
+ * With config.num_threads != 1, runs execute on a work-stealing thread pool.
+ * Results are delivered in run-index order, so output is identical to the
+ * serial path. run_streaming() hands each result to a callback instead of
+ * collecting them, keeping memory flat for very large batches.
+ *
+ * With config.ci_half_width > 0, num_runs is an upper bound: the batch
+ * stops after the first block of config.ci_block runs at which the
+ * ConvergenceMonitor reports every metric within the target half-width.
+ * Blocks are counted in run-index order, so the stopping run is the same
+ * for any thread count.
+ *
+ * With config.antithetic, runs 2k and 2k+1 share a seed and the odd run
+ * draws 1 - u (SimRNG::set_antithetic); run_streaming() then also
+ * produces the pair-aware estimates in variance().
+ *
+ * With config.lockstep = K > 1, each worker advances K runs of the same
+ * prototype in lockstep: every stage of the tick runs across the K worlds,
+ * and their orbits share one interleaved KeplerBatch. A run that ends
+ * early or throws is masked out while the rest of its group finishes.
+ *
+ * With config.shared_ephemeris, run_jobs() first tabulates each
+ * prototype's deterministic entities into a SharedEphemeris (one pass of
+ * the AI, orbit and aircraft stages with everything else switched off),
+ * and every run of that prototype replays them from it (see
+ * mc_ephemeris.hpp).
+ *
+ * With config.branch_times (or branch_on_first_draw), the batch shares
+ * its prefix: one world is simulated to the first branch point and
+ * snapshotted, each snapshot forks branch_fanout children that carry on to
+ * the next point on their own RNG streams, and the runs fork from the last
+ * level's snapshots in turn (run i from snapshot i % count, antithetic
+ * pairs from the same one) with their usual seed. RunSetup is applied at
+ * the fork, so per-run parameters take effect from the last branch point.
+ * Up to the first draw every run is the same, so branching on it alone
+ * reproduces the unbranched batch bit for bit at a fraction of the cost.
+ * A run_doe() sweep over several prototypes ignores branching. With
+ * keep_branch_prefix(), the leaf snapshots outlive the batch
+ * (branch_prefix()), and set_branch_prefix() forks the next batch from
+ * them without simulating the tree again (MCDaemon, after a scenario
+ * edit that cannot reach the prefix; see scenario_patch.hpp).
+ *
+ * run_splitting() estimates rare-event probabilities by multilevel
+ * splitting on an importance function, cloning trajectories from
+ * snapshots taken as they cross successive thresholds.
+ *
+ * run_replays() re-simulates chosen runs of a finished batch with a
+ * ReplayWriter attached, in parallel (see mc_replay_select.hpp).
+ *
+ * With a TickProfiler installed (set_profiler), every system call in
+ * tick() is timed; see mc_profiler.hpp.
+ *
+ * Every run counts its ticks and, under a wall budget or tail report, its
+ * wall time (MCWorld::run_profile). One over config.run_step_budget or
+ * run_wall_budget stops where it is and ends with a "Run budget: ..."
+ * error over its partial results, so a run that never resolves cannot
+ * hold a worker for the whole max_sim_time. With config.tail_runs, the
+ * batch's slowest runs and their per-system time are kept in
+ * tail_report() (see mc_tail_report.hpp). The splitting and replay paths
+ * take neither.
  */
 
 #ifndef SIM_MC_MC_RUNNER_HPP
 #define SIM_MC_MC_RUNNER_HPP
 
 #include "mc_world.hpp"
+#include "mc_ephemeris.hpp"
 #include "mc_results.hpp"
+#include "mc_convergence.hpp"
+#include "mc_variance.hpp"
+#include "mc_profiler.hpp"
+#include "mc_splitting.hpp"
+#include "mc_tail_report.hpp"
+#include "mc_tick_graph.hpp"
 #include "replay_writer.hpp"
 #include "scenario_parser.hpp"
 #include "io/json_reader.hpp"
 #include <vector>
 #include <functional>
+#include <memory>
+#include <ostream>
 
 namespace sim::mc {
 
 class MCRunner {
 public:
+    /**
+     * Progress callback. In threaded mode it is invoked under a lock from
+     * whichever thread finished a run; `completed` is monotonic across threads.
+     */
     using ProgressCallback = std::function<void(int completed, int total)>;
 
+    /**
+     * Result callback for run_streaming(), invoked in run-index order from
+     * one thread at a time. The result may be moved from.
+     */
+    using ResultCallback = std::function<void(RunResult& result)>;
+
+    /** Result callback for run_doe(), tagged with the permutation index. */
+    using DOEResultCallback = std::function<void(int permutation, RunResult& result)>;
+
+    /** Invoked after each convergence check (once per ci_block runs). */
+    using ConvergenceCallback = std::function<void(const ConvergenceReport& report)>;
+
+    /** @throws std::runtime_error if config.wez_dir is set but holds no readable table */
     explicit MCRunner(const MCConfig& config);
 
     /**
      * Run all MC iterations against the given scenario.
+     * The scenario is parsed once into a prototype world; see below.
      * Returns per-run results array ready for JSON serialization.
      */
     std::vector<RunResult> run(const sim::JsonValue& scenario,
                                ProgressCallback on_progress = nullptr);
 
+    /**
+     * Run all MC iterations from an already-parsed prototype world.
+     * Each run copies the prototype and re-seeds its RNG.
+     */
+    std::vector<RunResult> run(const MCWorld& prototype,
+                               ProgressCallback on_progress = nullptr);
+
+    /**
+     * As run(), but each result goes to `on_result` as soon as it and all
+     * lower-indexed runs are done. A scenario parse error yields one
+     * errored result per run, as in run().
+     */
+    void run_streaming(const sim::JsonValue& scenario,
+                       const ResultCallback& on_result,
+                       ProgressCallback on_progress = nullptr);
+    void run_streaming(const MCWorld& prototype,
+                       const ResultCallback& on_result,
+                       ProgressCallback on_progress = nullptr);
+
+    /**
+     * DOE sweep: num_runs seeds against every prototype (one per
+     * permutation, see DOESpec::make_world), all scheduled on one thread
+     * pool. Results arrive in (permutation, run) order; every permutation
+     * uses the same seeds. Progress counts all pairs.
+     */
+    void run_doe(const std::vector<MCWorld>& prototypes,
+                 const DOEResultCallback& on_result,
+                 ProgressCallback on_progress = nullptr);
+
     /**
      * Run a single simulation with trajectory sampling for replay.
-     * Outputs replay JSON directly to the given stream.
+     * Outputs replay JSON directly to the given stream (replay_v2 JSON Lines,
+     * chunk by chunk, with config.replay_stream).
      */
     void run_replay(const sim::JsonValue& scenario, std::ostream& out);
+    void run_replay(const MCWorld& prototype, std::ostream& out);
+
+    /**
+     * Replay of batch run `run_index`: started exactly as run_streaming()
+     * starts it (seed, antithetic mirror, RunSetup, world options), so its
+     * events match that run's results. No archive and no progress output.
+     */
+    void run_replay(const MCWorld& prototype, int run_index, std::ostream& out);
+
+    /**
+     * Called at every tick boundary of run_live(): before each tick and
+     * once after the last, with the ticks run so far. The world may be
+     * changed here, between ticks; returning false ends the run.
+     */
+    using TickBoundary = std::function<bool(MCWorld& world, int tick)>;
+
+    /**
+     * One interactive run for a live viewer (see mc_live_server.hpp),
+     * seeded as run_replay() seeds it. Ends at max_sim_time or when
+     * `boundary` returns false; combat resolution does not end it.
+     */
+    void run_live(const MCWorld& prototype, const TickBoundary& boundary);
+
+    /** Output for the i-th replay of run_replays(), closed when released. */
+    using ReplaySink = std::function<std::unique_ptr<std::ostream>(size_t i)>;
+
+    /**
+     * run_replay(prototype, run_indices[i], *open(i)) for every i, on the
+     * thread pool. `open` and progress are called concurrently.
+     */
+    void run_replays(const MCWorld& prototype, const std::vector<int>& run_indices,
+                     const ReplaySink& open, ProgressCallback on_progress = nullptr);
+
+    /**
+     * Rare-event probability by fixed-effort multilevel splitting (see
+     * mc_splitting.hpp). Level 0 runs are the batch's first spec.effort
+     * runs (seeds, antithetic pairing, RunSetup); later levels clone the
+     * entrance snapshots on fresh RNG streams. Progress counts trajectories
+     * over all levels.
+     */
+    SplittingReport run_splitting(const MCWorld& prototype, const SplittingSpec& spec,
+                                  ProgressCallback on_progress = nullptr);
+
+    void set_convergence_callback(ConvergenceCallback cb) {
+        on_convergence_ = std::move(cb);
+    }
+
+    /** Status from the last convergence check (enabled == false if off). */
+    const ConvergenceReport& convergence() const { return convergence_; }
+
+    /** Antithetic estimates from the last run_streaming() (if enabled). */
+    const VarianceReport& variance() const { return variance_; }
+
+    /**
+     * Per-run world setup, called after the prototype copy and RNG seeding
+     * (e.g. LatinHypercube::apply). Called concurrently in threaded mode.
+     */
+    using RunSetup = std::function<void(MCWorld& world, int run_index)>;
+    void set_run_setup(RunSetup setup) { run_setup_ = std::move(setup); }
+
+    /**
+     * Extra end condition checked after every tick (after the combat and
+     * scenario rules); a run ends at the first tick it returns true. Keep
+     * it O(1) — MCWorld::alive_in() and alive() are. Called concurrently
+     * in threaded mode.
+     */
+    using TerminationPredicate = std::function<bool(const MCWorld& world)>;
+    void add_termination(TerminationPredicate pred) {
+        terminations_.push_back(std::move(pred));
+    }
+
+    /** Time every system call of every tick into `profiler` (null = off). */
+    void set_profiler(TickProfiler* profiler) { profiler_ = profiler; }
+
+    /** Slowest runs of the last batch (MCConfig::tail_runs; else empty). */
+    const TailReport& tail_report() const { return tail_; }
+
+    /** Ticks between wall-clock reads under a wall budget or tail report. */
+    static constexpr uint64_t WALL_CHECK_TICKS = 64;
+
+    /** The last level of a snapshot-and-branch tree, one snapshot per leaf. */
+    struct BranchPrefix {
+        std::vector<int> points;           // branch points [ticks]
+        std::vector<MCWorld> worlds;
+        std::vector<uint8_t> ended;        // run over before the last point
+        std::vector<std::string> error;    // non-empty: the leaf threw
+    };
+
+    /** Keep each branched batch's leaves for branch_prefix() (off by default). */
+    void keep_branch_prefix(bool keep) { keep_prefix_ = keep; }
+
+    /** Leaves of the last branched batch (null if none was kept). */
+    std::shared_ptr<const BranchPrefix> branch_prefix() const { return prefix_; }
+
+    /**
+     * Fork the next branched batch from `prefix` instead of building its
+     * tree. The caller vouches that the leaves are what this config and
+     * prototype would build; ignored if its point count differs.
+     */
+    void set_branch_prefix(std::shared_ptr<const BranchPrefix> prefix) {
+        reuse_prefix_ = std::move(prefix);
+    }
 
 private:
+    static constexpr int MAX_LOCKSTEP = 64;   // KeplerBatch::advance_steps_lockstep
+
+    /** Scratch state of one lockstep group, reused across groups. */
+    struct Lockstep {
+        std::vector<MCWorld> worlds;
+        std::vector<uint8_t> live;    // lane still running
+        KeplerBatch kepler;           // lane = orbital entity * K + world
+    };
+
+    /** Snapshots at one branch point, one per tree node. */
+    struct BranchLevel {
+        std::vector<MCWorld> worlds;
+        std::vector<uint8_t> ended;        // run over before the point
+        std::vector<std::string> error;    // non-empty: the node threw
+    };
+
     MCConfig config_;
+    std::unique_ptr<ConvergenceMonitor> monitor_;
+    ConvergenceReport convergence_;
+    ConvergenceCallback on_convergence_;
+    VarianceReport variance_;
+    RunSetup run_setup_;
+    std::vector<TerminationPredicate> terminations_;
+    TickProfiler* profiler_ = nullptr;
+    std::shared_ptr<const WEZLibrary> wez_;   // config_.wez_dir, loaded once
+    TailReport tail_;
+    bool keep_prefix_ = false;
+    std::shared_ptr<const BranchPrefix> prefix_;         // kept leaves
+    std::shared_ptr<const BranchPrefix> reuse_prefix_;   // next batch forks from these
+
+    // Shared ephemerides of the run_jobs() call in progress, by prototype
+    std::vector<std::pair<const MCWorld*, std::shared_ptr<const SharedEphemeris>>> ephemerides_;
+
+    // MCConfig::tick_threads > 1: tick()'s systems and the pool that runs them
+    TickGraph tick_graph_;
+    std::unique_ptr<TickExecutor> tick_executor_;
+
+    /** Seed of a run: base_seed + run, or + run / 2 for antithetic pairs. */
+    int run_seed(int run_index) const;
 
     /**
-     * Run a single MC iteration.
+     * End-of-block convergence check: refresh convergence_, notify the
+     * callback, and return true if the batch should stop.
      */
-    RunResult run_single(const sim::JsonValue& scenario, int run_index, int seed);
+    bool block_converged();
+
+    /**
+     * Run num_runs seeds against each prototype in turn (job j uses
+     * prototype j / num_runs, run index and seed offset j % num_runs),
+     * delivering results in job order.
+     */
+    void run_jobs(const std::vector<const MCWorld*>& prototypes,
+                  const ResultCallback& on_result,
+                  ProgressCallback on_progress);
+
+    /**
+     * run_jobs() on a thread pool. Jobs are dispatched in windows of a few
+     * per thread so the reorder buffer stays bounded.
+     */
+    void run_parallel(const std::vector<const MCWorld*>& prototypes,
+                      const ResultCallback& on_result,
+                      ProgressCallback on_progress);
+
+    /**
+     * Run a single MC iteration in `world`, which is first reset to the
+     * prototype. Callers pass a long-lived world to recycle its allocations.
+     */
+    RunResult run_single(const MCWorld& prototype, MCWorld& world,
+                         int run_index, int seed);
+
+    /** Reset `world` to the prototype and seed it for one run. */
+    void begin_run(const MCWorld& prototype, MCWorld& world, int run_index, int seed);
+
+    /** Point `world`'s RNG at run `run_index`'s stream. */
+    void seed_run(MCWorld& world, int run_index, int seed) const;
+
+    /**
+     * Tick a seeded world to the end with a ReplayWriter sampling it, then
+     * write the replay (and the trajectory archive, if named). `report`
+     * enables per-step progress output.
+     */
+    void record_replay(MCWorld& world, std::ostream& out,
+                       const std::string& archive, bool report);
+
+    /** Per-batch world switches (missile flyout, LOD, radar kernel). */
+    void apply_world_options(MCWorld& world) const;
+
+    /**
+     * Tabulate `prototype`'s deterministic entities for
+     * config_.max_sim_time (MCConfig::shared_ephemeris); null if none
+     * qualify or fit in the budget.
+     */
+    std::shared_ptr<const SharedEphemeris> build_ephemeris(const MCWorld& prototype);
+
+    /**
+     * Tick `world` through steps [step, end_step), stopping early when
+     * combat resolves or a run budget is spent. @return true if either
+     */
+    bool advance(MCWorld& world, int step, int end_step);
+
+    /**
+     * If `world` has spent a run budget, record which in
+     * world.budget_exceeded. @return true if so
+     */
+    bool budget_spent(MCWorld& world) const;
+
+    /** True if config_ asks for snapshot-and-branch runs. */
+    bool branching() const;
+
+    /**
+     * Branch points as tick counts (see MCConfig::branch_times). A
+     * first-draw point is found by simulating `prototype` until it draws.
+     */
+    std::vector<int> branch_steps(const MCWorld& prototype);
+
+    /** Simulate the snapshot tree level by level, down to its leaves. */
+    std::shared_ptr<BranchPrefix> build_branch_tree(const MCWorld& prototype,
+                                                    sim::ThreadPool& pool);
+
+    /**
+     * run_jobs() for one prototype in snapshot-and-branch mode: build the
+     * snapshot tree (or take set_branch_prefix()'s), then fork every run
+     * from its leaf.
+     */
+    void run_branched(const MCWorld& prototype,
+                      const ResultCallback& on_result,
+                      ProgressCallback on_progress);
+
+    /**
+     * Fill a run's final time, engagements, survival and cost; a run
+     * stopped by a budget gets its error too.
+     */
+    void end_run(const MCWorld& world, RunResult& result) const;
+
+    /** Runs per lockstep group (1 = lockstep off). */
+    int lockstep_width() const;
+
+    /**
+     * Run jobs first_job .. first_job + count - 1 of one prototype in
+     * lockstep, writing their results to out[0 .. count).
+     */
+    void run_lockstep(const MCWorld& prototype, Lockstep& ls,
+                      int first_job, int count, RunResult* out);
+
+    /** Cached Kepler step for the live worlds of a lockstep group. */
+    void propagate_orbits_lockstep(Lockstep& ls, size_t K, double dt);
 
     /**
      * Tick the world one timestep: AI → Physics → Weapons.
+     * Split in three stages so lockstep groups can run each stage across
+     * their worlds: AI, orbits, then aircraft, sensors, weapons and events.
+     * tick_after_orbits() starts with tick_flight().
      */
     void tick(MCWorld& world, double dt);
+    void tick_ai(MCWorld& world, double dt);
+    void tick_orbits(MCWorld& world, double dt);
+    void tick_after_orbits(MCWorld& world, double dt);
+    void tick_flight(MCWorld& world, double dt);
+
+    /**
+     * tick()'s systems in tick order with the data each reads and writes
+     * (MCConfig::tick_threads); whole systems call the same code and
+     * profile scopes as the serial stages.
+     */
+    void build_tick_graph();
+
+    /** Uncached Kepler step of entries [begin, end) of with_physics(ORBITAL_2BODY). */
+    void propagate_orbits_range(MCWorld& world, double dt, size_t begin, size_t end);
+
+    /**
+     * Orbital physics via world.kepler (MCConfig::cached_kepler): reload
+     * lanes after thrust, then advance all coasting orbits in one batch.
+     */
+    void propagate_orbits_cached(MCWorld& world, double dt);
 
     /**
      * Check if combat is resolved (early termination condition).
      * Returns true if all HVAs on one side are destroyed,
-     * or all combat units on one side are destroyed.
+     * or all combat units on one side are destroyed, or a scenario
+     * termination condition or registered predicate holds. O(1) in the
+     * entity count (MCWorld alive counters).
      */
     bool all_combat_resolved(const MCWorld& world) const;
 
     /**
-     * Collect engagement events from entity logs.
-     * Deduplicates using the seen set.
+     * Resolve the world's engagement bus into named result events, once
+     * per run. Repeats of a (source, target, result) within one tick
+     * collapse to one event.
      */
-    void collect_engagements(MCWorld& world, double sim_time,
-                             std::vector<EngagementEvent>& log,
-                             std::unordered_map<std::string, bool>& seen);
+    void collect_engagements(const MCWorld& world,
+                             std::vector<EngagementEvent>& log) const;
 
     /**
      * Collect survival data at end of run.
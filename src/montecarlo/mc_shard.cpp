@@ -0,0 +1,385 @@
+#include "montecarlo/mc_shard.hpp"
+#include "montecarlo/mc_runner.hpp"
+#include "montecarlo/mc_doe.hpp"
+#include "io/json_writer.hpp"
+#include "distributed/metrics.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace sim::mc {
+
+namespace {
+
+struct ShardMetrics {
+    distributed::Gauge pending;
+    distributed::Counter merged;
+};
+
+const ShardMetrics& shard_metrics() {
+    static const ShardMetrics m{
+        distributed::MetricsRegistry::global().gauge("mc_shard_runs_pending",
+                                                     "Runs not yet merged from a worker"),
+        distributed::MetricsRegistry::global().counter("mc_shard_runs_merged_total",
+                                                       "Runs merged from worker results")};
+    return m;
+}
+
+/** Build one message frame with a compact JsonWriter. */
+std::string make_message(const std::function<void(sim::JsonWriter&)>& body) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, 0);
+    w.set_precision(0);
+    w.begin_object();
+    body(w);
+    w.end_object();
+    return os.str();
+}
+
+std::string local_host() {
+    char host[256] = {};
+    if (::gethostname(host, sizeof(host) - 1) != 0) host[0] = '\0';
+    return host;
+}
+
+/** Batch settings a worker takes from the coordinator (threads stay local). */
+MCConfig batch_config(const sim::JsonValue& h, MCConfig c) {
+    c.num_runs       = h["runs"].get_int(c.num_runs);
+    c.base_seed      = h["seed"].get_int(c.base_seed);
+    c.max_sim_time   = h["maxTime"].get_number(c.max_sim_time);
+    c.dt             = h["dt"].get_number(c.dt);
+    c.cached_kepler  = h["cachedKepler"].get_bool(c.cached_kepler);
+    c.coast_dt       = h["coastDt"].get_number(c.coast_dt);
+    c.lockstep       = h["lockstep"].get_int(c.lockstep);
+    c.batch_flight   = h["batchFlight"].get_bool(c.batch_flight);
+    c.flight_rk2     = h["flightRk2"].get_bool(c.flight_rk2);
+    c.missile_flyout = h["missileFlyout"].get_bool(c.missile_flyout);
+    c.swept_contact  = h["sweptContact"].get_bool(c.swept_contact);
+    c.wez_dir        = h["wezDir"].get_string(c.wez_dir);
+    c.lod_dt         = h["lodDt"].get_number(c.lod_dt);
+    c.shared_ephemeris = h["sharedEphemeris"].get_bool(c.shared_ephemeris);
+    c.ephemeris_mb   = h["ephemerisMb"].get_number(c.ephemeris_mb);
+    c.tick_threads   = static_cast<int>(h["tickThreads"].get_number(c.tick_threads));
+    c.radar_los      = h["radarLos"].get_bool(c.radar_los);
+    c.radar_tracks   = h["radarTracks"].get_bool(c.radar_tracks);
+    c.comms          = h["comms"].get_bool(c.comms);
+    c.iads           = h["iads"].get_bool(c.iads);
+    c.ai_decisions   = h["aiDecisions"].get_bool(c.ai_decisions);
+    c.ai_decision_dt = h["aiDecisionDt"].get_number(c.ai_decision_dt);
+    c.run_step_budget = h["runStepBudget"].get_int(c.run_step_budget);
+    c.run_wall_budget = h["runWallBudget"].get_number(c.run_wall_budget);
+    c.lhs            = h["lhs"].get_bool(false);
+    if (h["rng"].is_string()) {
+        c.rng_mode = h["rng"].as_string() == "philox" ? RNGMode::PHILOX
+                                                      : RNGMode::MULBERRY32;
+    }
+    c.antithetic = false;
+    c.ci_half_width = 0.0;
+    c.progress = false;
+    c.output_path.clear();
+    return c;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// MCShardCoordinator
+// ---------------------------------------------------------------------------
+
+MCShardCoordinator::MCShardCoordinator(const MCConfig& config, int unit_runs)
+    : config_(config), unit_runs_(std::max(unit_runs, 1)) {}
+
+bool MCShardCoordinator::take_unit(int threads, Unit& out) {
+    if (!requeued_.empty()) {
+        out = requeued_.front();
+        requeued_.pop_front();
+        return true;
+    }
+    if (next_job_ >= total_jobs_) return false;
+
+    const int64_t runs = std::max(config_.num_runs, 1);
+    int64_t left = total_jobs_ - next_job_;
+    int64_t size = std::max<int64_t>(static_cast<int64_t>(unit_runs_) * threads,
+                                     left / (2 * static_cast<int64_t>(pool_)));
+    // Units never straddle permutations
+    int64_t run = next_job_ % runs;
+    size = std::min(size, runs - run);
+
+    out.id = next_unit_id_++;
+    out.perm = static_cast<int>(next_job_ / runs);
+    out.first = static_cast<int>(run);
+    out.count = static_cast<int>(size);
+    next_job_ += size;
+    return true;
+}
+
+std::vector<MCAggregator> MCShardCoordinator::run(const std::string& address, int workers,
+                                                  const std::string& scenario_text,
+                                                  const std::string& doe_text,
+                                                  size_t permutations) {
+    // A worker hanging up mid-send must not kill the coordinator
+    std::signal(SIGPIPE, SIG_IGN);
+
+    pool_ = std::max(workers, 1);
+    total_jobs_ = static_cast<int64_t>(std::max(config_.num_runs, 0)) *
+                  static_cast<int64_t>(permutations);
+    shard_metrics().pending.set(total_jobs_);
+    aggregates_.assign(permutations, MCAggregator(config_.max_sim_time));
+    scenario_text_ = scenario_text;
+    doe_text_ = doe_text;
+    header_ = make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "batch");
+        w.kv("runs", config_.num_runs);
+        w.kv("seed", config_.base_seed);
+        w.kv("maxTime", config_.max_sim_time);
+        w.kv("dt", config_.dt);
+        w.kv("cachedKepler", config_.cached_kepler);
+        w.kv("coastDt", config_.coast_dt);
+        w.kv("lockstep", config_.lockstep);
+        w.kv("batchFlight", config_.batch_flight);
+        w.kv("flightRk2", config_.flight_rk2);
+        w.kv("missileFlyout", config_.missile_flyout);
+        w.kv("sweptContact", config_.swept_contact);
+        w.kv("wezDir", config_.wez_dir);
+        w.kv("lodDt", config_.lod_dt);
+        w.kv("sharedEphemeris", config_.shared_ephemeris);
+        w.kv("ephemerisMb", config_.ephemeris_mb);
+        w.kv("tickThreads", config_.tick_threads);
+        w.kv("radarLos", config_.radar_los);
+        w.kv("radarTracks", config_.radar_tracks);
+        w.kv("comms", config_.comms);
+        w.kv("iads", config_.iads);
+        w.kv("aiDecisions", config_.ai_decisions);
+        w.kv("aiDecisionDt", config_.ai_decision_dt);
+        w.kv("runStepBudget", config_.run_step_budget);
+        w.kv("runWallBudget", config_.run_wall_budget);
+        w.kv("rng", config_.rng_mode == RNGMode::PHILOX ? "philox" : "mulberry32");
+        w.kv("lhs", config_.lhs);
+    });
+
+    distributed::IPCSocket listener = distributed::IPCSocket::listen(address);
+    if (config_.verbose) {
+        std::cerr << "[shard] listening on " << address << ", " << total_jobs_
+                  << " runs for " << pool_ << " workers\n";
+    }
+
+    // Acceptor: one thread per worker; polls so it notices the end
+    std::vector<std::thread> threads;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished()) break;
+        }
+        auto link = std::make_shared<Link>();
+        if (!listener.accept(link->sock, 200)) continue;
+        threads.emplace_back(&MCShardCoordinator::serve_worker, this, link);
+    }
+    listener.close();
+    for (auto& t : threads) t.join();
+
+    if (config_.verbose) {
+        std::cerr << "[shard] " << units_completed_ << " units from " << workers_joined_
+                  << " workers (" << workers_lost_ << " lost)\n";
+    }
+    return std::move(aggregates_);
+}
+
+void MCShardCoordinator::serve_worker(std::shared_ptr<Link> link) {
+    distributed::IPCSocket& sock = link->sock;
+    try {
+        sim::JsonValue hello = sim::JsonReader::parse(sock.receive_frame());
+        if (hello["type"].get_string("") != "hello") return;
+        link->host = hello["host"].get_string("");
+        link->threads = std::max(hello["threads"].get_int(1), 1);
+        if (!sock.send_frame(header_) || !sock.send_frame(scenario_text_) ||
+            !sock.send_frame(doe_text_)) {
+            return;
+        }
+    } catch (const std::exception&) {
+        return;
+    }
+
+    auto unit_message = [](const Unit& u) {
+        return make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "unit");
+            w.kv("unit", u.id);
+            w.kv("perm", u.perm);
+            w.kv("first", u.first);
+            w.kv("count", u.count);
+        });
+    };
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    workers_joined_++;
+    if (config_.verbose) {
+        std::cerr << "[shard] worker " << link->host << " joined (" << link->threads
+                  << " threads)\n";
+    }
+
+    try {
+        for (;;) {
+            // Keep two units with the worker: one running, one queued behind it
+            Unit u;
+            while (link->outstanding.size() < 2 && take_unit(link->threads, u)) {
+                link->outstanding.push_back(u);
+                lock.unlock();
+                bool sent = sock.send_frame(unit_message(u));
+                lock.lock();
+                if (!sent) throw std::runtime_error("send failed");
+            }
+            if (link->outstanding.empty()) {
+                // Idle: wait for a lost worker's units or for the end
+                cv_.wait(lock, [&] { return finished() || !requeued_.empty(); });
+                if (finished()) break;
+                continue;
+            }
+
+            lock.unlock();
+            sim::JsonValue msg = sim::JsonReader::parse(sock.receive_frame());
+            int id = msg["unit"].get_int(-1);
+            int perm = msg["perm"].get_int(-1);
+            MCAggregator part = MCAggregator::read_state(msg["state"], config_.max_sim_time);
+            lock.lock();
+
+            auto it = std::find_if(link->outstanding.begin(), link->outstanding.end(),
+                                   [&](const Unit& o) { return o.id == id; });
+            if (msg["type"].get_string("") != "result" || it == link->outstanding.end() ||
+                it->perm != perm || part.runs() != it->count) {
+                throw std::runtime_error("unexpected result");
+            }
+            aggregates_[static_cast<size_t>(perm)].merge(part);
+            merged_runs_ += it->count;
+            shard_metrics().merged.add(static_cast<uint64_t>(it->count));
+            shard_metrics().pending.set(total_jobs_ - merged_runs_);
+            units_completed_++;
+            link->outstanding.erase(it);
+            if (finished()) cv_.notify_all();
+        }
+        lock.unlock();
+        sock.send_frame(make_message([](sim::JsonWriter& w) { w.kv("type", "done"); }));
+    } catch (const std::exception& e) {
+        if (!lock.owns_lock()) lock.lock();
+        workers_lost_++;
+        for (const Unit& u : link->outstanding) requeued_.push_back(u);
+        link->outstanding.clear();
+        cv_.notify_all();
+        if (config_.verbose) {
+            std::cerr << "[shard] lost worker " << link->host << ": " << e.what() << "\n";
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// MCShardWorker
+// ---------------------------------------------------------------------------
+
+MCShardWorker::MCShardWorker(const MCConfig& defaults) : defaults_(defaults) {}
+
+void MCShardWorker::run(const std::string& address, int connect_attempts) {
+    distributed::IPCSocket sock;
+    for (int attempt = 1;; attempt++) {
+        try {
+            sock = distributed::IPCSocket::connect(address);
+            break;
+        } catch (const std::exception&) {
+            if (attempt >= connect_attempts) throw;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+
+    int threads = defaults_.num_threads > 0
+        ? defaults_.num_threads
+        : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    sock.send_frame(make_message([&](sim::JsonWriter& w) {
+        w.kv("type", "hello");
+        w.kv("host", local_host());
+        w.kv("threads", threads);
+    }));
+
+    sim::JsonValue header = sim::JsonReader::parse(sock.receive_frame());
+    if (header["type"].get_string("") != "batch") {
+        throw std::runtime_error("Shard coordinator sent no batch");
+    }
+    MCConfig config = batch_config(header, defaults_);
+    std::string scenario_text = sock.receive_frame();
+    std::string doe_text = sock.receive_frame();
+
+    // Parse once; a sweep builds every permutation up front, as --doe does
+    sim::JsonValue scenario;
+    std::vector<MCWorld> worlds;
+    if (doe_text.empty()) {
+        scenario = sim::JsonReader::parse(scenario_text);
+        worlds.push_back(ScenarioParser::parse(scenario, config.num_threads));
+    } else {
+        DOESpec spec = DOESpec::parse(sim::JsonReader::parse(doe_text), "");
+        scenario = scenario_text.empty() ? spec.scenario : sim::JsonReader::parse(scenario_text);
+        MCWorld prototype = ScenarioParser::parse(scenario, config.num_threads);
+        for (size_t p = 0; p < spec.num_permutations(); p++) {
+            worlds.push_back(spec.make_world(prototype, p));
+        }
+    }
+
+    // Strata span the whole batch; a unit draws its own rows
+    std::unique_ptr<LatinHypercube> lhs;
+    if (config.lhs && doe_text.empty()) {
+        lhs = std::make_unique<LatinHypercube>(scenario["uncertainties"], config.num_runs,
+                                               config.base_seed);
+    }
+
+    if (config.verbose) {
+        std::cerr << "[shard-worker] " << worlds.size() << " prototype(s), "
+                  << config.num_runs << " runs each\n";
+    }
+
+    for (;;) {
+        sim::JsonValue msg = sim::JsonReader::parse(sock.receive_frame());
+        std::string type = msg["type"].get_string("");
+        if (type == "done") break;
+        if (type != "unit") continue;
+
+        int perm = msg["perm"].get_int(0);
+        if (perm < 0 || static_cast<size_t>(perm) >= worlds.size()) {
+            throw std::runtime_error("Shard unit names an unknown permutation");
+        }
+
+        MCConfig unit = config;
+        unit.first_run = msg["first"].get_int(0);
+        unit.num_runs = msg["count"].get_int(0);
+        unit.verbose = false;
+        MCRunner runner(unit);
+        runner.set_profiler(profiler_);
+        if (lhs) {
+            runner.set_run_setup([&lhs](MCWorld& world, int run_index) {
+                lhs->apply(run_index, world);
+            });
+        }
+        MCAggregator agg(config.max_sim_time);
+        runner.run_streaming(worlds[static_cast<size_t>(perm)],
+                             [&](RunResult& r) { agg.add(r); });
+
+        std::string result = make_message([&](sim::JsonWriter& w) {
+            w.kv("type", "result");
+            w.kv("unit", msg["unit"].get_int(-1));
+            w.kv("perm", perm);
+            w.kv("runs", unit.num_runs);
+            w.key("state");
+            agg.write_state(w);
+        });
+        if (!sock.send_frame(result)) {
+            throw std::runtime_error("Lost the shard coordinator");
+        }
+        units_completed_++;
+        if (config.verbose) {
+            std::cerr << "[shard-worker] unit " << msg["unit"].get_int(-1) << ": runs "
+                      << unit.first_run << ".." << unit.first_run + unit.num_runs - 1 << "\n";
+        }
+    }
+}
+
+} // namespace sim::mc
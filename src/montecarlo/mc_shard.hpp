@@ -0,0 +1,153 @@
+/**
+ * MC sharding — one batch or DOE sweep spread over worker nodes.
+ *
+ * mc_engine --shard-listen runs the coordinator: it cuts the (permutation,
+ * run) space into work units of consecutive run indices and hands them to
+ * workers (mc_engine --shard-worker) as they ask, so fast nodes simply
+ * take more units. Unit sizes follow guided self-scheduling — half of an
+ * even split of what is left, never below unit_runs per worker thread —
+ * so early units amortize the round trip and the tail stays fine-grained.
+ * Each worker keeps one unit queued behind the running one, hiding the
+ * round trip.
+ *
+ * A worker parses the scenario (and DOE spec) once and runs each unit
+ * through MCRunner with MCConfig::first_run set, so every run keeps the
+ * seed and LHS stratum it has in a single-host batch. Only the unit's
+ * MCAggregator state comes back (MCAggregator::write_state), a few KB
+ * whatever the unit size; the coordinator merges them into the aggregate
+ * document of --format aggregate (per permutation for a sweep).
+ *
+ * Workers may join at any time. A worker that drops has its unfinished
+ * units handed to the others (or to a replacement). Convergence early
+ * stop and antithetic pairing are batch-global and not supported.
+ *
+ * Transport: distributed::IPCSocket frames (Unix path, tcp:// or tls://),
+ * one JSON message per frame.
+ *
+ * Worker → coordinator:
+ *   { "type": "hello", "host", "threads" }
+ *   { "type": "result", "unit", "perm", "runs", "state": {...} }
+ * Coordinator → worker:
+ *   { "type": "batch", "runs", "seed", "maxTime", "dt", "cachedKepler",
+ *     "coastDt", "lockstep", "batchFlight", "flightRk2", "missileFlyout",
+ *     "sweptContact", "wezDir" (a directory on the worker), "lodDt",
+ *     "sharedEphemeris", "ephemerisMb", "tickThreads",
+ *     "radarLos", "radarTracks", "comms", "iads", "aiDecisions", "aiDecisionDt",
+ *     "runStepBudget", "runWallBudget", "rng", "lhs" }, then a scenario frame (raw scenario JSON; empty for a DOE
+ *     spec with an inline scenario) and a DOE spec frame (empty for a
+ *     plain batch)
+ *   { "type": "unit", "unit", "perm", "first", "count" }
+ *   { "type": "done" }
+ */
+
+#ifndef SIM_MC_MC_SHARD_HPP
+#define SIM_MC_MC_SHARD_HPP
+
+#include "mc_aggregate.hpp"
+#include "mc_profiler.hpp"
+#include "scenario_parser.hpp"
+#include "distributed/ipc_socket.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+class MCShardCoordinator {
+public:
+    /**
+     * @param config Batch settings shipped to workers; num_runs is the
+     *               run count per permutation
+     * @param unit_runs Smallest unit, in runs per worker thread
+     */
+    MCShardCoordinator(const MCConfig& config, int unit_runs = 8);
+
+    /**
+     * Serve work units on `address` until every run is merged.
+     * @param workers Expected pool size (sizes the units; more may join)
+     * @param scenario_text Raw scenario JSON (empty: the DOE spec's inline one)
+     * @param doe_text Raw DOE spec JSON (empty: a plain batch)
+     * @param permutations 1, or the DOE spec's permutation count
+     * @return One aggregate per permutation
+     * @throws std::runtime_error if the address cannot be listened on
+     */
+    std::vector<MCAggregator> run(const std::string& address, int workers,
+                                  const std::string& scenario_text,
+                                  const std::string& doe_text, size_t permutations);
+
+    int units_completed() const { return units_completed_; }
+    int workers_joined() const { return workers_joined_; }
+    int workers_lost() const { return workers_lost_; }
+
+private:
+    struct Unit {
+        int id = 0;
+        int perm = 0;
+        int first = 0;
+        int count = 0;
+    };
+
+    struct Link {
+        distributed::IPCSocket sock;
+        std::string host;
+        int threads = 1;
+        std::vector<Unit> outstanding;   // Sent, result not yet merged
+    };
+
+    MCConfig config_;
+    int unit_runs_;
+    int pool_ = 1;
+
+    // Shared with the per-worker threads (guarded by mutex_)
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Unit> requeued_;        // Units of lost workers, served first
+    int64_t next_job_ = 0;             // Next (perm * runs + run) not yet handed out
+    int64_t total_jobs_ = 0;
+    int64_t merged_runs_ = 0;
+    int next_unit_id_ = 0;
+    int units_completed_ = 0;
+    int workers_joined_ = 0;
+    int workers_lost_ = 0;
+    std::vector<MCAggregator> aggregates_;
+
+    std::string header_;
+    std::string scenario_text_;
+    std::string doe_text_;
+
+    void serve_worker(std::shared_ptr<Link> link);
+
+    /** Next unit for a worker with `threads` threads (mutex_ held). */
+    bool take_unit(int threads, Unit& out);
+    bool finished() const { return merged_runs_ >= total_jobs_; }
+};
+
+class MCShardWorker {
+public:
+    /** @param defaults Local settings (threads, verbose); the batch sets the rest */
+    explicit MCShardWorker(const MCConfig& defaults);
+
+    /**
+     * Connect to a coordinator and run units until it says done.
+     * @throws std::runtime_error if it cannot connect or the batch is malformed
+     */
+    void run(const std::string& address, int connect_attempts = 10);
+
+    int units_completed() const { return units_completed_; }
+
+    /** Profile every unit's ticks into `profiler` (null = off). */
+    void set_profiler(TickProfiler* profiler) { profiler_ = profiler; }
+
+private:
+    MCConfig defaults_;
+    TickProfiler* profiler_ = nullptr;
+    int units_completed_ = 0;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_SHARD_HPP
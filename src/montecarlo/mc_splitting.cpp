@@ -0,0 +1,72 @@
+#include "montecarlo/mc_splitting.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sim::mc {
+
+ProgressFunction closing_distance_progress(const MCWorld& prototype,
+                                           const std::string& target_id) {
+    const EntityHandle target = prototype.find_handle(target_id);
+    if (target == NO_ENTITY) {
+        throw std::runtime_error("splitting target '" + target_id + "' not in scenario");
+    }
+
+    return [target](MCWorld& world) {
+        if (!world.alive(target)) return std::numeric_limits<double>::infinity();
+
+        const EntityColumns& cols = world.columns();
+        const uint16_t team = cols.team[target];
+        const Vec3 at = world.ecef_of(target);
+        double best = std::numeric_limits<double>::infinity();
+        for (uint32_t i : world.any_weapon()) {
+            if (!world.alive(i) || cols.team[i] == team) continue;
+            const Vec3& p = world.ecef_of(i);
+            double dx = p.x - at.x, dy = p.y - at.y, dz = p.z - at.z;
+            best = std::min(best, dx * dx + dy * dy + dz * dz);
+        }
+        return -std::sqrt(best);
+    };
+}
+
+void write_splitting_json(std::ostream& out, const SplittingReport& report,
+                          int base_seed, double max_sim_time) {
+    sim::JsonWriter w(out);
+    w.begin_object();
+
+    w.key("config").begin_object();
+    w.kv("method", "fixed-effort splitting");
+    w.kv("seed", base_seed);
+    w.kv("maxTimeSec", max_sim_time);
+    w.end_object();
+
+    w.kv("probability", report.probability);
+    w.kv("relativeError", report.relative_error);
+    w.key("ci95").begin_array();
+    w.value(report.ci_lo);
+    w.value(report.ci_hi);
+    w.end_array();
+    w.kv("trajectoryWeight", report.trajectory_weight);
+    w.kv("simSeconds", report.sim_seconds);
+
+    w.key("levels").begin_array();
+    for (const SplitLevel& l : report.levels) {
+        w.begin_object();
+        w.kv("threshold", l.threshold);
+        w.kv("started", l.started);
+        w.kv("reached", l.reached);
+        w.kv("errors", l.errors);
+        w.kv("probability", l.probability);
+        w.kv("simSeconds", l.sim_seconds);
+        w.end_object();
+    }
+    w.end_array();
+
+    w.end_object();
+    w.flush();
+    out << '\n';
+}
+
+} // namespace sim::mc
@@ -0,0 +1,395 @@
+#include "montecarlo/mc_surrogate.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+// Hyperparameter grid: length scales on the unit cube, and signal
+// variances relative to the variance of the training means
+constexpr double LENGTH_SCALES[] = {0.05, 0.1, 0.2, 0.3, 0.5, 0.75, 1.0, 1.5, 2.5};
+constexpr double SIGNAL_FACTORS[] = {0.1, 0.3, 1.0, 3.0, 10.0};
+constexpr double JITTER = 1e-10;      // Relative diagonal jitter
+
+/** In-place lower Cholesky factor of a row-major n x n matrix; false if not SPD. */
+bool cholesky(std::vector<double>& a, size_t n) {
+    for (size_t j = 0; j < n; j++) {
+        double d = a[j * n + j];
+        for (size_t k = 0; k < j; k++) d -= a[j * n + k] * a[j * n + k];
+        if (!(d > 0.0)) return false;
+        d = std::sqrt(d);
+        a[j * n + j] = d;
+        for (size_t i = j + 1; i < n; i++) {
+            double s = a[i * n + j];
+            for (size_t k = 0; k < j; k++) s -= a[i * n + k] * a[j * n + k];
+            a[i * n + j] = s / d;
+        }
+        for (size_t k = j + 1; k < n; k++) a[j * n + k] = 0.0;
+    }
+    return true;
+}
+
+/** Solve L z = b in place (forward substitution). */
+void solve_lower(const std::vector<double>& l, size_t n, double* b) {
+    for (size_t i = 0; i < n; i++) {
+        double s = b[i];
+        for (size_t k = 0; k < i; k++) s -= l[i * n + k] * b[k];
+        b[i] = s / l[i * n + i];
+    }
+}
+
+/** Solve L^T z = b in place (back substitution). */
+void solve_upper(const std::vector<double>& l, size_t n, double* b) {
+    for (size_t i = n; i-- > 0;) {
+        double s = b[i];
+        for (size_t k = i + 1; k < n; k++) s -= l[k * n + i] * b[k];
+        b[i] = s / l[i * n + i];
+    }
+}
+
+std::vector<double> number_array(const sim::JsonValue& v) {
+    if (!v.is_array()) throw std::runtime_error("surrogate: expected an array");
+    std::vector<double> out(v.size());
+    for (size_t i = 0; i < v.size(); i++) out[i] = v[i].as_number();
+    return out;
+}
+
+std::vector<std::string> string_array(const sim::JsonValue& v) {
+    if (!v.is_array()) throw std::runtime_error("surrogate: expected an array of names");
+    std::vector<std::string> out(v.size());
+    for (size_t i = 0; i < v.size(); i++) out[i] = v[i].as_string();
+    return out;
+}
+
+void write_numbers(sim::JsonWriter& w, const std::string& key, const std::vector<double>& v) {
+    w.key(key).begin_array();
+    for (double d : v) w.value(d);
+    w.end_array();
+}
+
+void write_strings(sim::JsonWriter& w, const std::string& key, const std::vector<std::string>& v) {
+    w.key(key).begin_array();
+    for (const std::string& s : v) w.value(s);
+    w.end_array();
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Training set
+// ═══════════════════════════════════════════════════════════════
+
+void SurrogateTrainingSet::write_json(std::ostream& out) const {
+    sim::JsonWriter w(out);
+    w.set_precision(0);
+    w.begin_object();
+    write_strings(w, "parameters", parameters);
+    write_strings(w, "metrics", metrics);
+    w.key("rows").begin_array();
+    for (size_t r = 0; r < x.size(); r++) {
+        w.begin_object();
+        write_numbers(w, "x", x[r]);
+        write_numbers(w, "y", y[r]);
+        write_numbers(w, "var", var[r]);
+        w.kv("runs", runs[r]);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    w.flush();
+    out << '\n';
+}
+
+SurrogateTrainingSet SurrogateTrainingSet::parse(const sim::JsonValue& doc) {
+    SurrogateTrainingSet set;
+    set.parameters = string_array(doc["parameters"]);
+    set.metrics = string_array(doc["metrics"]);
+    const sim::JsonValue& rows = doc["rows"];
+    if (!rows.is_array()) throw std::runtime_error("surrogate training set: no \"rows\"");
+    for (size_t r = 0; r < rows.size(); r++) {
+        const sim::JsonValue& row = rows[r];
+        set.x.push_back(number_array(row["x"]));
+        set.y.push_back(number_array(row["y"]));
+        set.var.push_back(number_array(row["var"]));
+        set.runs.push_back(row["runs"].get_int(0));
+        if (set.x.back().size() != set.parameters.size() ||
+            set.y.back().size() != set.metrics.size() ||
+            set.var.back().size() != set.metrics.size()) {
+            throw std::runtime_error("surrogate training set: row " + std::to_string(r) +
+                                     " does not match the parameter / metric lists");
+        }
+    }
+    return set;
+}
+
+SurrogateTrainingCollector::SurrogateTrainingCollector(
+    const std::vector<std::string>& parameters,
+    std::vector<std::vector<double>> values,
+    const std::vector<std::string>& metric_specs)
+    : parameters_(parameters), values_(std::move(values)), metrics_(metric_specs),
+      hits_(values_.size()), scored_(values_.size()) {}
+
+void SurrogateTrainingCollector::add(int permutation, const RunResult& run) {
+    if (permutation < 0 || static_cast<size_t>(permutation) >= values_.size()) return;
+    metrics_.evaluate(run, outcome_);
+    if (!metrics_.resolved()) return;
+
+    std::vector<int64_t>& hits = hits_[permutation];
+    std::vector<int64_t>& scored = scored_[permutation];
+    hits.resize(metrics_.size(), 0);
+    scored.resize(metrics_.size(), 0);
+    for (size_t m = 0; m < outcome_.size(); m++) {
+        if (outcome_[m] < 0) continue;
+        scored[m]++;
+        hits[m] += outcome_[m];
+    }
+}
+
+SurrogateTrainingSet SurrogateTrainingCollector::finish() const {
+    SurrogateTrainingSet set;
+    set.parameters = parameters_;
+    for (size_t m = 0; m < metrics_.size(); m++) set.metrics.push_back(metrics_.name(m));
+
+    for (size_t p = 0; p < values_.size(); p++) {
+        const std::vector<int64_t>& scored = scored_[p];
+        if (scored.size() != metrics_.size() || metrics_.size() == 0 ||
+            *std::min_element(scored.begin(), scored.end()) == 0) {
+            continue;
+        }
+        std::vector<double> y, var;
+        for (size_t m = 0; m < metrics_.size(); m++) {
+            double n = static_cast<double>(scored[m]);
+            double mean = hits_[p][m] / n;
+            y.push_back(mean);
+            // Binomial variance of the mean, kept positive at 0 and 1
+            var.push_back((mean * (1.0 - mean) + 0.25 / n) / n);
+        }
+        set.x.push_back(values_[p]);
+        set.y.push_back(std::move(y));
+        set.var.push_back(std::move(var));
+        set.runs.push_back(static_cast<int>(*std::max_element(scored.begin(), scored.end())));
+    }
+    return set;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Gaussian process
+// ═══════════════════════════════════════════════════════════════
+
+void GaussianProcessSurrogate::scale(const double* x, double* u) const {
+    for (size_t d = 0; d < parameters_.size(); d++) {
+        double span = hi_[d] - lo_[d];
+        u[d] = span > 0.0 ? (x[d] - lo_[d]) / span : 0.0;
+    }
+}
+
+void GaussianProcessSurrogate::fit(const SurrogateTrainingSet& data) {
+    const size_t n = data.x.size();
+    const size_t dims = data.parameters.size();
+    if (n == 0) throw std::runtime_error("surrogate: empty training set");
+
+    parameters_ = data.parameters;
+    rows_ = n;
+    lo_.assign(dims, std::numeric_limits<double>::infinity());
+    hi_.assign(dims, -std::numeric_limits<double>::infinity());
+    for (const std::vector<double>& x : data.x) {
+        for (size_t d = 0; d < dims; d++) {
+            lo_[d] = std::min(lo_[d], x[d]);
+            hi_[d] = std::max(hi_[d], x[d]);
+        }
+    }
+    x_.resize(n * dims);
+    for (size_t i = 0; i < n; i++) scale(data.x[i].data(), &x_[i * dims]);
+
+    // Squared distances between training points
+    std::vector<double> dist2(n * n, 0.0);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            double s = 0.0;
+            for (size_t d = 0; d < dims; d++) {
+                double e = x_[i * dims + d] - x_[j * dims + d];
+                s += e * e;
+            }
+            dist2[i * n + j] = dist2[j * n + i] = s;
+        }
+    }
+
+    metrics_.clear();
+    std::vector<double> k(n * n), r(n), alpha(n);
+    for (size_t m = 0; m < data.metrics.size(); m++) {
+        Metric metric;
+        metric.name = data.metrics[m];
+
+        double mean = 0.0;
+        for (size_t i = 0; i < n; i++) mean += data.y[i][m];
+        mean /= n;
+        double spread = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            r[i] = data.y[i][m] - mean;
+            spread += r[i] * r[i];
+        }
+        spread = std::max(spread / n, 1e-4);
+        metric.mean = mean;
+
+        // Grid search on the log marginal likelihood
+        double best = -std::numeric_limits<double>::infinity();
+        for (double l : LENGTH_SCALES) {
+            for (double f : SIGNAL_FACTORS) {
+                const double s2 = f * spread;
+                const double inv = -0.5 / (l * l);
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = 0; j <= i; j++) {
+                        k[i * n + j] = s2 * std::exp(inv * dist2[i * n + j]);
+                    }
+                    k[i * n + i] += std::max(data.var[i][m], 0.0) + JITTER * s2;
+                }
+                if (!cholesky(k, n)) continue;
+
+                std::copy(r.begin(), r.end(), alpha.begin());
+                solve_lower(k, n, alpha.data());
+                double fit = 0.0, logdet = 0.0;
+                for (size_t i = 0; i < n; i++) {
+                    fit += alpha[i] * alpha[i];
+                    logdet += std::log(k[i * n + i]);
+                }
+                double lml = -0.5 * fit - logdet;
+                if (lml > best) {
+                    best = lml;
+                    metric.signal_var = s2;
+                    metric.length_scale = l;
+                    metric.chol = k;
+                    solve_upper(k, n, alpha.data());
+                    metric.alpha = alpha;
+                }
+            }
+        }
+        if (metric.chol.empty()) {
+            throw std::runtime_error("surrogate: no stable fit for metric " + metric.name);
+        }
+        metrics_.push_back(std::move(metric));
+    }
+}
+
+void GaussianProcessSurrogate::predict(const double* x, SurrogatePrediction* out) const {
+    const size_t n = rows_;
+    const size_t dims = parameters_.size();
+    thread_local std::vector<double> u, dist2, v;
+    u.resize(dims);
+    dist2.resize(n);
+    v.resize(n);
+
+    scale(x, u.data());
+    for (size_t i = 0; i < n; i++) {
+        double s = 0.0;
+        for (size_t d = 0; d < dims; d++) {
+            double e = u[d] - x_[i * dims + d];
+            s += e * e;
+        }
+        dist2[i] = s;
+    }
+
+    for (size_t m = 0; m < metrics_.size(); m++) {
+        const Metric& metric = metrics_[m];
+        const double inv = -0.5 / (metric.length_scale * metric.length_scale);
+        double mean = metric.mean;
+        for (size_t i = 0; i < n; i++) {
+            v[i] = metric.signal_var * std::exp(inv * dist2[i]);
+            mean += v[i] * metric.alpha[i];
+        }
+        solve_lower(metric.chol, n, v.data());
+        double var = metric.signal_var;
+        for (size_t i = 0; i < n; i++) var -= v[i] * v[i];
+
+        out[m].mean = std::clamp(mean, 0.0, 1.0);
+        out[m].std = std::sqrt(std::max(var, 0.0));
+    }
+}
+
+void GaussianProcessSurrogate::write_json(std::ostream& out) const {
+    const size_t dims = parameters_.size();
+    sim::JsonWriter w(out);
+    w.set_precision(0);
+    w.begin_object();
+    w.kv("type", "gaussianProcess");
+    write_strings(w, "parameters", parameters_);
+    write_numbers(w, "lo", lo_);
+    write_numbers(w, "hi", hi_);
+    w.key("x").begin_array();
+    for (size_t i = 0; i < rows_; i++) {
+        w.begin_array();
+        for (size_t d = 0; d < dims; d++) w.value(x_[i * dims + d]);
+        w.end_array();
+    }
+    w.end_array();
+
+    w.key("metrics").begin_array();
+    for (const Metric& m : metrics_) {
+        w.begin_object();
+        w.kv("name", m.name);
+        w.kv("mean", m.mean);
+        w.kv("signalVar", m.signal_var);
+        w.kv("lengthScale", m.length_scale);
+        write_numbers(w, "alpha", m.alpha);
+        w.key("chol").begin_array();
+        for (size_t i = 0; i < rows_; i++) {
+            for (size_t j = 0; j <= i; j++) w.value(m.chol[i * rows_ + j]);
+        }
+        w.end_array();
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    w.flush();
+    out << '\n';
+}
+
+GaussianProcessSurrogate GaussianProcessSurrogate::parse(const sim::JsonValue& doc) {
+    if (doc["type"].get_string() != "gaussianProcess") {
+        throw std::runtime_error("surrogate: not a gaussianProcess model");
+    }
+    GaussianProcessSurrogate gp;
+    gp.parameters_ = string_array(doc["parameters"]);
+    gp.lo_ = number_array(doc["lo"]);
+    gp.hi_ = number_array(doc["hi"]);
+    const size_t dims = gp.parameters_.size();
+    const sim::JsonValue& x = doc["x"];
+    if (!x.is_array() || x.size() == 0 || gp.lo_.size() != dims || gp.hi_.size() != dims) {
+        throw std::runtime_error("surrogate: malformed model inputs");
+    }
+    gp.rows_ = x.size();
+    for (size_t i = 0; i < gp.rows_; i++) {
+        std::vector<double> row = number_array(x[i]);
+        if (row.size() != dims) throw std::runtime_error("surrogate: malformed model inputs");
+        gp.x_.insert(gp.x_.end(), row.begin(), row.end());
+    }
+
+    const size_t n = gp.rows_;
+    const sim::JsonValue& metrics = doc["metrics"];
+    if (!metrics.is_array()) throw std::runtime_error("surrogate: no \"metrics\"");
+    for (size_t k = 0; k < metrics.size(); k++) {
+        const sim::JsonValue& mv = metrics[k];
+        Metric m;
+        m.name = mv["name"].get_string();
+        m.mean = mv["mean"].get_number();
+        m.signal_var = mv["signalVar"].get_number();
+        m.length_scale = mv["lengthScale"].get_number(1.0);
+        m.alpha = number_array(mv["alpha"]);
+        std::vector<double> packed = number_array(mv["chol"]);
+        if (m.alpha.size() != n || packed.size() != n * (n + 1) / 2 || !(m.length_scale > 0.0)) {
+            throw std::runtime_error("surrogate: malformed metric " + m.name);
+        }
+        m.chol.assign(n * n, 0.0);
+        size_t at = 0;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j <= i; j++) m.chol[i * n + j] = packed[at++];
+        }
+        gp.metrics_.push_back(std::move(m));
+    }
+    return gp;
+}
+
+} // namespace sim::mc
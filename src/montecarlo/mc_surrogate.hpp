@@ -0,0 +1,135 @@
+/**
+ * MC surrogate — Gaussian-process emulator of DOE sweep outcomes.
+ *
+ * A DOE sweep (mc_doe.hpp) yields, per permutation, the mean of each
+ * binary metric (MetricSet specs: HVA survival, entity survival, team
+ * win) over its runs. SurrogateTrainingSet holds those rows with the
+ * Monte Carlo variance of each mean; GaussianProcessSurrogate fits one GP
+ * per metric and answers new parameter points in microseconds with a
+ * predictive standard deviation, so smooth regions of a design need no
+ * further runs.
+ *
+ * Model, per metric:
+ *   y(x) = m + f(x),  f ~ GP(0, s^2 exp(-|x - x'|^2 / 2 l^2))
+ * with inputs scaled to the unit cube of the training design, m the
+ * training mean, and each observation's noise its own MC variance
+ * (p (1 - p) + 1 / (4 n)) / n, so permutations with few runs count less.
+ * s^2 and l maximise the log marginal likelihood over a fixed grid.
+ * predict() returns the posterior mean, clamped to [0, 1], and the
+ * posterior std of f — the uncertainty of the metric itself, not of one
+ * run. Common random numbers across permutations correlate the noise
+ * between rows; the fit treats it as independent.
+ *
+ * Training set JSON:
+ *   { "parameters": [names], "metrics": [names],
+ *     "rows": [ { "x": [...], "y": [...], "var": [...], "runs": n } ] }
+ * Model JSON:
+ *   { "type": "gaussianProcess", "parameters", "lo", "hi", "x": [[...]],
+ *     "metrics": [ { "name", "mean", "signalVar", "lengthScale",
+ *                    "alpha": [...], "chol": [lower triangle, row-major] } ] }
+ */
+
+#ifndef SIM_MC_MC_SURROGATE_HPP
+#define SIM_MC_MC_SURROGATE_HPP
+
+#include "mc_convergence.hpp"
+#include "mc_results.hpp"
+#include "io/json_reader.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+struct SurrogateTrainingSet {
+    std::vector<std::string> parameters;
+    std::vector<std::string> metrics;
+    std::vector<std::vector<double>> x;     // [row][parameter]
+    std::vector<std::vector<double>> y;     // [row][metric] mean outcome
+    std::vector<std::vector<double>> var;   // [row][metric] variance of the mean
+    std::vector<int> runs;                  // [row] successful runs
+
+    void write_json(std::ostream& out) const;
+
+    /** @throws std::runtime_error on a malformed document */
+    static SurrogateTrainingSet parse(const sim::JsonValue& doc);
+};
+
+/**
+ * Builds a training set from a DOE sweep's results, fed in (permutation,
+ * run) order as MCRunner::run_doe() delivers them.
+ */
+class SurrogateTrainingCollector {
+public:
+    /** @param values Parameter values of each permutation (DOESpec::permutation) */
+    SurrogateTrainingCollector(const std::vector<std::string>& parameters,
+                               std::vector<std::vector<double>> values,
+                               const std::vector<std::string>& metric_specs);
+
+    void add(int permutation, const RunResult& run);
+
+    /** Rows for every permutation with at least one scored run. */
+    SurrogateTrainingSet finish() const;
+
+private:
+    std::vector<std::string> parameters_;
+    std::vector<std::vector<double>> values_;
+    MetricSet metrics_;
+    std::vector<int8_t> outcome_;
+    std::vector<std::vector<int64_t>> hits_;    // [perm][metric]
+    std::vector<std::vector<int64_t>> scored_;  // [perm][metric]
+};
+
+struct SurrogatePrediction {
+    double mean = 0.0;
+    double std = 0.0;
+};
+
+class GaussianProcessSurrogate {
+public:
+    GaussianProcessSurrogate() = default;
+
+    /**
+     * Fit one GP per metric.
+     * @throws std::runtime_error if the set has no rows
+     */
+    void fit(const SurrogateTrainingSet& data);
+
+    size_t num_parameters() const { return parameters_.size(); }
+    size_t num_metrics() const { return metrics_.size(); }
+    const std::vector<std::string>& parameters() const { return parameters_; }
+    const std::string& metric_name(size_t m) const { return metrics_[m].name; }
+
+    /**
+     * Every metric at parameter point x[num_parameters()], into
+     * out[num_metrics()]. Allocation-free after the first call per thread.
+     */
+    void predict(const double* x, SurrogatePrediction* out) const;
+
+    void write_json(std::ostream& out) const;
+
+    /** @throws std::runtime_error on a malformed model */
+    static GaussianProcessSurrogate parse(const sim::JsonValue& doc);
+
+private:
+    struct Metric {
+        std::string name;
+        double mean = 0.0;
+        double signal_var = 0.0;
+        double length_scale = 1.0;
+        std::vector<double> alpha;   // K^-1 (y - mean)
+        std::vector<double> chol;    // Lower Cholesky factor of K, n x n
+    };
+
+    std::vector<std::string> parameters_;
+    std::vector<double> lo_, hi_;      // Training range per parameter
+    std::vector<double> x_;            // Scaled training inputs, [row][parameter]
+    size_t rows_ = 0;
+    std::vector<Metric> metrics_;
+
+    void scale(const double* x, double* u) const;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_SURROGATE_HPP
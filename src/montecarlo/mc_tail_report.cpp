@@ -0,0 +1,135 @@
+#include "montecarlo/mc_tail_report.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace sim::mc {
+
+namespace {
+
+bool slower(const TailRun& a, const TailRun& b) {
+    if (a.profile.wall_seconds != b.profile.wall_seconds) {
+        return a.profile.wall_seconds > b.profile.wall_seconds;
+    }
+    return a.run_index < b.run_index;
+}
+
+// Systems by time, largest first (TICK excluded: it is their sum)
+std::vector<size_t> systems_by_time(const RunProfile& p) {
+    std::vector<size_t> order;
+    for (size_t s = 1; s < TickProfiler::NUM_SYSTEMS; s++) {
+        if (p.ns[s] > 0) order.push_back(s);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&p](size_t a, size_t b) { return p.ns[a] > p.ns[b]; });
+    return order;
+}
+
+} // namespace
+
+void TailReport::add(const RunResult& run) {
+    if (!enabled()) return;
+    walls_.push_back(run.profile.wall_seconds);
+    if (run.error.rfind("Run budget:", 0) == 0) over_budget_++;
+
+    if (heap_.size() == keep_) {
+        // heap_.front() is the fastest kept run
+        const RunProfile& fastest = heap_.front().profile;
+        if (run.profile.wall_seconds <= fastest.wall_seconds) return;
+        std::pop_heap(heap_.begin(), heap_.end(), slower);
+        heap_.pop_back();
+    }
+    TailRun t;
+    t.run_index = run.run_index;
+    t.seed = run.seed;
+    t.sim_time_final = run.sim_time_final;
+    t.engagements = run.engagement_log.size();
+    t.error = run.error;
+    t.profile = run.profile;
+    heap_.push_back(std::move(t));
+    std::push_heap(heap_.begin(), heap_.end(), slower);
+}
+
+double TailReport::wall_percentile(double p) const {
+    if (walls_.empty()) return 0.0;
+    std::vector<double> sorted = walls_;
+    size_t k = static_cast<size_t>(std::clamp(p, 0.0, 1.0) * (sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+}
+
+std::vector<TailRun> TailReport::slowest() const {
+    std::vector<TailRun> runs = heap_;
+    std::sort(runs.begin(), runs.end(), slower);
+    return runs;
+}
+
+void TailReport::write_json(std::ostream& out) const {
+    sim::JsonWriter w(out);
+    w.set_precision(0);
+    w.begin_object();
+    w.kv("runs", runs());
+    w.kv("overBudget", over_budget_);
+    w.key("wallSeconds").begin_object();
+    w.kv("p50", wall_percentile(0.5));
+    w.kv("p90", wall_percentile(0.9));
+    w.kv("p99", wall_percentile(0.99));
+    w.kv("max", wall_percentile(1.0));
+    w.end_object();
+    w.key("slowest").begin_array();
+    for (const TailRun& t : slowest()) {
+        const RunProfile& p = t.profile;
+        w.begin_object();
+        w.kv("run", t.run_index);
+        w.kv("seed", t.seed);
+        w.kv("wallSeconds", p.wall_seconds);
+        w.kv("ticks", static_cast<int64_t>(p.ticks));
+        w.kv("simTimeFinal", t.sim_time_final);
+        w.kv("engagements", t.engagements);
+        if (!t.error.empty()) w.kv("error", t.error);
+        w.key("systemSeconds").begin_object();
+        const uint64_t tick_ns = p.ns[static_cast<size_t>(ProfileSystem::TICK)];
+        if (tick_ns > 0) w.kv("tick", tick_ns * 1e-9);
+        for (size_t s : systems_by_time(p)) {
+            w.kv(profile_system_name(static_cast<ProfileSystem>(s)), p.ns[s] * 1e-9);
+        }
+        w.end_object();
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    w.flush();
+    out << '\n';
+}
+
+void TailReport::write_summary(std::ostream& out) const {
+    char line[200];
+    std::snprintf(line, sizeof(line),
+                  "=== Tail: %d runs, %d over budget; wall p50 %.3f s, p99 %.3f s, "
+                  "max %.3f s ===\n",
+                  runs(), over_budget_, wall_percentile(0.5), wall_percentile(0.99),
+                  wall_percentile(1.0));
+    out << line;
+    std::snprintf(line, sizeof(line), "%8s %11s %9s %9s %10s  %s\n",
+                  "run", "seed", "wall s", "ticks", "sim t", "top systems (% wall)");
+    out << line;
+    for (const TailRun& t : slowest()) {
+        const RunProfile& p = t.profile;
+        std::snprintf(line, sizeof(line), "%8d %11d %9.3f %9llu %10.1f ",
+                      t.run_index, t.seed, p.wall_seconds,
+                      static_cast<unsigned long long>(p.ticks), t.sim_time_final);
+        out << line;
+        const double wall_ns = std::max(p.wall_seconds * 1e9, 1.0);
+        std::vector<size_t> order = systems_by_time(p);
+        for (size_t k = 0; k < order.size() && k < 3; k++) {
+            std::snprintf(line, sizeof(line), " %s %.0f%%",
+                          profile_system_name(static_cast<ProfileSystem>(order[k])),
+                          100.0 * p.ns[order[k]] / wall_ns);
+            out << line;
+        }
+        if (!t.error.empty()) out << "  [" << t.error << "]";
+        out << "\n";
+    }
+}
+
+} // namespace sim::mc
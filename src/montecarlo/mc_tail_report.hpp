@@ -0,0 +1,71 @@
+/**
+ * TailReport — the slowest runs of a batch, for finding what blows up.
+ *
+ * A batch's wall time is set by its tail: one run that never resolves
+ * ticks to max_sim_time and holds its worker long after the rest are done.
+ * MCRunner feeds every delivered result to a TailReport (MCConfig::
+ * tail_runs > 0), which keeps the tail_runs slowest by wall time, each
+ * with its RunProfile — ticks, wall time and time per system — next to the
+ * batch's wall-time percentiles and its count of runs stopped by a budget
+ * (MCConfig::run_step_budget, run_wall_budget). A run whose time sits in
+ * one system points at the scenario feature driving it: a SAM site that
+ * never runs dry, a flyout that never fuzes, an orbit that never closes.
+ *
+ * Per-system times are ProfileScope totals, so they need a run's
+ * RunProfile::systems set (MCRunner sets it whenever tail_runs > 0). A
+ * lockstep group's lanes share its wall time and have no per-run "tick"
+ * total. Wall time, unlike everything else in a result, is not
+ * reproducible.
+ */
+
+#ifndef SIM_MC_MC_TAIL_REPORT_HPP
+#define SIM_MC_MC_TAIL_REPORT_HPP
+
+#include "mc_results.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+struct TailRun {
+    int run_index = 0;
+    int seed = 0;
+    double sim_time_final = 0.0;
+    size_t engagements = 0;
+    std::string error;
+    RunProfile profile;
+};
+
+class TailReport {
+public:
+    /** @param keep Slowest runs kept (0 = off: add() does nothing) */
+    explicit TailReport(int keep = 0) : keep_(keep > 0 ? static_cast<size_t>(keep) : 0) {}
+
+    bool enabled() const { return keep_ > 0; }
+    void add(const RunResult& run);
+
+    int runs() const { return static_cast<int>(walls_.size()); }
+    int over_budget() const { return over_budget_; }
+
+    /** Wall-time percentile over every run added, p in [0, 1] */
+    double wall_percentile(double p) const;
+
+    /** The kept runs, slowest first */
+    std::vector<TailRun> slowest() const;
+
+    void write_json(std::ostream& out) const;
+
+    /** Percentiles and one line per kept run (its top systems) */
+    void write_summary(std::ostream& out) const;
+
+private:
+    size_t keep_;
+    std::vector<TailRun> heap_;      // min-heap on wall time, at most keep_
+    std::vector<double> walls_;      // every run's wall time, in add order
+    int over_budget_ = 0;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_TAIL_REPORT_HPP
@@ -0,0 +1,82 @@
+#include "montecarlo/mc_tick_graph.hpp"
+#include <algorithm>
+
+namespace sim::mc {
+
+bool TickSystem::conflicts(const TickSystem& o) const {
+    const uint32_t mine = reads | writes | own_reads | own_writes;
+    const uint32_t theirs = o.reads | o.writes | o.own_reads | o.own_writes;
+
+    // World-level and any-entity writes meet everything the other touches
+    if ((writes & theirs) || (o.writes & mine)) return true;
+
+    // Own writes meet the other's any-entity reads
+    if ((own_writes & o.reads) || (o.own_writes & reads)) return true;
+
+    // Own data of both only where their entity sets can share an entity
+    if (!entities.overlaps(o.entities)) return false;
+    return (own_writes & (o.own_reads | o.own_writes)) ||
+           (o.own_writes & (own_reads | own_writes));
+}
+
+void TickGraph::build() {
+    std::vector<size_t> stage(systems_.size(), 0);
+    stages_.clear();
+    for (size_t s = 0; s < systems_.size(); s++) {
+        for (size_t t = 0; t < s; t++) {
+            if (systems_[s].conflicts(systems_[t])) stage[s] = std::max(stage[s], stage[t] + 1);
+        }
+        if (stage[s] >= stages_.size()) stages_.resize(stage[s] + 1);
+        stages_[stage[s]].push_back(s);
+    }
+}
+
+void TickGraph::describe(std::ostream& out) const {
+    for (size_t k = 0; k < stages_.size(); k++) {
+        out << "  stage " << k << ":";
+        for (size_t s : stages_[k]) {
+            out << " " << systems_[s].name << (systems_[s].run_range ? "[n]" : "");
+        }
+        out << "\n";
+    }
+}
+
+TickExecutor::TickExecutor(int num_threads) : pool_(num_threads) {}
+
+bool TickExecutor::try_tick(const TickGraph& graph, MCWorld& world, double dt,
+                            TickProfiler* profiler) {
+    std::unique_lock<std::mutex> lock(busy_, std::try_to_lock);
+    if (!lock.owns_lock()) return false;
+
+    const auto& systems = graph.systems();
+    const size_t threads = static_cast<size_t>(pool_.size());
+    for (const auto& stage : graph.stages()) {
+        // Whole systems first, then every per-entity system's chunks
+        items_.clear();
+        for (size_t s : stage) {
+            if (!systems[s].run_range) items_.push_back({static_cast<uint32_t>(s), 0, 0});
+        }
+        for (size_t s : stage) {
+            if (!systems[s].run_range) continue;
+            const size_t n = systems[s].size(world);
+            const size_t chunk = std::max(MIN_CHUNK, (n + 4 * threads - 1) / (4 * threads));
+            for (size_t b = 0; b < n; b += chunk) {
+                items_.push_back({static_cast<uint32_t>(s), b, std::min(n, b + chunk)});
+            }
+        }
+
+        pool_.parallel_for(items_.size(), [&](size_t i) {
+            const Item& item = items_[i];
+            const TickSystem& sys = systems[item.system];
+            if (item.begin == item.end) {
+                sys.run(world, dt);
+            } else {
+                ProfileScope s(profiler, sys.profile, item.end - item.begin);
+                sys.run_range(world, dt, item.begin, item.end);
+            }
+        });
+    }
+    return true;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,151 @@
+/**
+ * TickGraph — One world's tick as a graph of systems, run on a thread pool
+ * (MCConfig::tick_threads).
+ *
+ * Batch threading gives each run a thread, which does nothing for one
+ * very large world (mc_engine --replay or --live on a 10k-entity
+ * scenario). Here each system of MCRunner::tick declares what it reads
+ * and writes as TickData bits, in two scopes:
+ *   - reads / writes: any entity's data, or world-level state;
+ *   - own_reads / own_writes: only the entities the system walks (its
+ *     EntitySet, e.g. with_ai(INTERCEPT)).
+ * Two systems conflict if one writes what the other reads or writes; own
+ * data of two systems on disjoint entity sets (two AI types, two physics
+ * types) never conflicts. build() places every system one stage after the
+ * latest earlier system it conflicts with, so a stage holds systems that
+ * may run in any order, and running the stages in order gives the serial
+ * tick's result bit for bit.
+ *
+ * A per-entity system (each entry of its list touches only its own
+ * entity's data, apart from declared reads) is split into chunks of its
+ * list; all of a stage's chunks and whole systems go to one parallel_for.
+ * Systems that draw from the run's RNG stream, change liveness, log
+ * engagements or rebuild the world's lazy caches (spatial grid, frame
+ * cache) run whole, and since they conflict with each other they keep
+ * their serial order.
+ */
+
+#ifndef SIM_MC_MC_TICK_GRAPH_HPP
+#define SIM_MC_MC_TICK_GRAPH_HPP
+
+#include "mc_world.hpp"
+#include "mc_profiler.hpp"
+#include "utils/thread_pool.hpp"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+/** Data a tick system touches, bit per group of fields. */
+namespace tick_data {
+constexpr uint32_t ORBIT_POS       = 1u << 0;   // eci_pos, the eci_pos column
+constexpr uint32_t ORBIT_VEL       = 1u << 1;   // eci_vel, orbit_dirty, Kepler lanes
+constexpr uint32_t FLIGHT_POSE     = 1u << 2;   // geo_*, speed, heading, gamma, mach
+constexpr uint32_t FLIGHT_CONTROLS = 1u << 3;   // roll, alpha, throttle and their commands
+constexpr uint32_t AI_STATE        = 1u << 4;   // targets, waypoints, scan lists
+constexpr uint32_t DECISIONS       = 1u << 5;   // MCWorld::decisions
+constexpr uint32_t LOD             = 1u << 6;   // MCWorld::lod
+constexpr uint32_t LIVENESS        = 1u << 7;   // active / destroyed, alive counts
+constexpr uint32_t SPATIAL         = 1u << 8;   // ECI / ECEF grids, frame cache, orbit lag
+constexpr uint32_t RNG             = 1u << 9;
+constexpr uint32_t SENSORS         = 1u << 10;  // detections, tracks, comm routes
+constexpr uint32_t WEAPONS         = 1u << 11;  // ammo, engagements, missiles, IADS
+constexpr uint32_t EVENTS          = 1u << 12;  // event schedule, engagement log
+constexpr uint32_t ALL             = (1u << 13) - 1;
+} // namespace tick_data
+
+/** Entities a system walks: a with_ai() or with_physics() list, or all. */
+struct EntitySet {
+    enum class Kind : uint8_t { ALL, AI, PHYSICS };
+    Kind kind = Kind::ALL;
+    uint8_t type = 0;        // AIType or PhysicsType
+
+    static EntitySet ai(AIType t) { return {Kind::AI, static_cast<uint8_t>(t)}; }
+    static EntitySet physics(PhysicsType t) { return {Kind::PHYSICS, static_cast<uint8_t>(t)}; }
+
+    /** True unless both are lists of one kind with different types. */
+    bool overlaps(const EntitySet& o) const {
+        return kind == Kind::ALL || kind != o.kind || type == o.type;
+    }
+};
+
+struct TickSystem {
+    std::string name;
+    ProfileSystem profile = ProfileSystem::TICK;   // what run_range chunks are timed as
+    EntitySet entities;
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+    uint32_t own_reads = 0;
+    uint32_t own_writes = 0;
+
+    /** Entries of the system's list this tick (profiling, chunking). */
+    std::function<size_t(const MCWorld&)> size;
+
+    /** The whole system (used when run_range is empty); times itself. */
+    std::function<void(MCWorld&, double)> run;
+
+    /** Per-entity systems: entries [begin, end) of the list. */
+    std::function<void(MCWorld&, double, size_t, size_t)> run_range;
+
+    bool conflicts(const TickSystem& o) const;
+};
+
+class TickGraph {
+public:
+    /** Append a system; tick order is the order of add(). */
+    void add(TickSystem system) { systems_.push_back(std::move(system)); }
+
+    /** Assign stages (call once after the last add()). */
+    void build();
+
+    const std::vector<TickSystem>& systems() const { return systems_; }
+    /** System indices per stage, in tick order within a stage. */
+    const std::vector<std::vector<size_t>>& stages() const { return stages_; }
+
+    /** One line per stage: its systems, per-entity ones marked "[n]". */
+    void describe(std::ostream& out) const;
+
+private:
+    std::vector<TickSystem> systems_;
+    std::vector<std::vector<size_t>> stages_;
+};
+
+/**
+ * Runs a TickGraph's stages on a pool. One world at a time: a call made
+ * while another is in progress (concurrent batch runs sharing the
+ * runner) returns false without ticking, and the caller ticks serially.
+ */
+class TickExecutor {
+public:
+    /** Entries per chunk floor: smaller chunks cost more to hand out than to run. */
+    static constexpr size_t MIN_CHUNK = 64;
+
+    explicit TickExecutor(int num_threads);
+
+    int threads() const { return pool_.size(); }
+
+    /**
+     * Tick `world` once through `graph`. Each per-entity chunk is one
+     * `profiler` sample (not charged to the world's RunProfile).
+     * @return false if the executor was busy (nothing done)
+     */
+    bool try_tick(const TickGraph& graph, MCWorld& world, double dt, TickProfiler* profiler);
+
+private:
+    struct Item {
+        uint32_t system;
+        size_t begin, end;     // begin == end: the whole system
+    };
+
+    sim::ThreadPool pool_;
+    std::mutex busy_;
+    std::vector<Item> items_;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_TICK_GRAPH_HPP
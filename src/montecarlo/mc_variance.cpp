@@ -0,0 +1,109 @@
+#include "montecarlo/mc_variance.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double Z95 = 1.959963984540054;
+
+/** 95% normal half-width of a mean from sums over n samples. */
+double mean_half_width(double sum, double sum_sq, int64_t n) {
+    if (n < 2) return 1.0;
+    double nn = static_cast<double>(n);
+    double mean = sum / nn;
+    double var = (sum_sq - nn * mean * mean) / (nn - 1.0);
+    return Z95 * std::sqrt(std::max(var, 0.0) / nn);
+}
+
+/** 95% normal half-width of a proportion p over n independent trials. */
+double binomial_half_width(double p, int64_t n) {
+    if (n < 1) return 1.0;
+    return Z95 * std::sqrt(p * (1.0 - p) / static_cast<double>(n));
+}
+
+} // namespace
+
+PairedEstimate paired_difference(const std::string& name,
+                                 const std::vector<int8_t>& a,
+                                 const std::vector<int8_t>& b) {
+    PairedEstimate est;
+    est.name = name;
+
+    double sum = 0.0, sum_sq = 0.0;
+    int64_t n = 0, a_hits = 0, b_hits = 0;
+    size_t count = std::min(a.size(), b.size());
+    for (size_t i = 0; i < count; i++) {
+        if (a[i] < 0 || b[i] < 0) continue;
+        double d = static_cast<double>(b[i] - a[i]);
+        sum += d;
+        sum_sq += d * d;
+        a_hits += a[i];
+        b_hits += b[i];
+        n++;
+    }
+
+    est.pairs = n;
+    if (n == 0) {
+        est.half_width = est.independent_half_width = 1.0;
+        return est;
+    }
+    double nn = static_cast<double>(n);
+    est.mean = sum / nn;
+    est.half_width = mean_half_width(sum, sum_sq, n);
+
+    double pa = a_hits / nn, pb = b_hits / nn;
+    est.independent_half_width =
+        Z95 * std::sqrt(pa * (1.0 - pa) / nn + pb * (1.0 - pb) / nn);
+    return est;
+}
+
+AntitheticEstimator::AntitheticEstimator(const std::vector<std::string>& specs)
+    : metrics_(specs) {}
+
+void AntitheticEstimator::add(const RunResult& run) {
+    metrics_.evaluate(run, outcomes_);
+    moments_.resize(metrics_.size());
+
+    if (!have_first_) {
+        first_ = outcomes_;
+        have_first_ = true;
+        return;
+    }
+    have_first_ = false;
+
+    // A metric resolved by the second run has no first outcome yet
+    first_.resize(outcomes_.size(), -1);
+    for (size_t i = 0; i < outcomes_.size(); i++) {
+        int8_t a = first_[i], b = outcomes_[i];
+        if (a < 0 || b < 0) continue;
+        double m = 0.5 * (a + b);
+        Moments& mo = moments_[i];
+        mo.pairs++;
+        mo.sum += m;
+        mo.sum_sq += m * m;
+        mo.singles += 2;
+        mo.successes += a + b;
+    }
+}
+
+VarianceReport AntitheticEstimator::report() const {
+    VarianceReport r;
+    r.method = "antithetic";
+    for (size_t i = 0; i < moments_.size(); i++) {
+        const Moments& mo = moments_[i];
+        PairedEstimate est;
+        est.name = metrics_.name(i);
+        est.pairs = mo.pairs;
+        est.mean = mo.pairs > 0 ? mo.sum / static_cast<double>(mo.pairs) : 0.0;
+        est.half_width = mean_half_width(mo.sum, mo.sum_sq, mo.pairs);
+        est.independent_half_width = binomial_half_width(
+            mo.singles > 0 ? static_cast<double>(mo.successes) / mo.singles : 0.0,
+            mo.singles);
+        r.metrics.push_back(std::move(est));
+    }
+    return r;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,69 @@
+/**
+ * MC variance reduction — Pair-aware estimators for correlated runs.
+ *
+ * Three sampling designs make runs deliberately correlated so fewer runs
+ * reach a given precision; each needs its own estimator:
+ *   - antithetic pairs (MCConfig::antithetic): runs 2k and 2k+1 share a
+ *     seed and the second draws 1 - u for every u. The estimate averages
+ *     pair means; its interval uses the spread of pair means.
+ *   - common random numbers across DOE permutations: every permutation
+ *     runs the same seeds, so permutation vs. baseline differences are
+ *     estimated from per-run paired differences (paired_difference()).
+ *   - Latin-hypercube stratification (see LatinHypercube in mc_doe.hpp):
+ *     the plain mean is unbiased and the binomial interval is
+ *     conservative, so only the design is reported.
+ *
+ * Both intervals are normal-approximation 95% intervals. Each estimate also
+ * carries the half-width an independent design with the same run count
+ * would give, so the gain can be read straight off the output. The
+ * pairing only survives where the two runs draw in step, which is best
+ * with the per-entity streams of --rng philox.
+ */
+
+#ifndef SIM_MC_MC_VARIANCE_HPP
+#define SIM_MC_MC_VARIANCE_HPP
+
+#include "mc_results.hpp"
+#include "mc_convergence.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+/**
+ * Paired difference mean(b - a) over runs where both outcomes are known
+ * (outcome vectors as from MetricSet::evaluate, -1 = unknown).
+ */
+PairedEstimate paired_difference(const std::string& name,
+                                 const std::vector<int8_t>& a,
+                                 const std::vector<int8_t>& b);
+
+/** Antithetic-pair estimator; runs must be added in run-index order. */
+class AntitheticEstimator {
+public:
+    explicit AntitheticEstimator(const std::vector<std::string>& specs);
+
+    void add(const RunResult& run);
+
+    VarianceReport report() const;
+
+private:
+    struct Moments {
+        int64_t pairs = 0;
+        double sum = 0.0;       // of pair means
+        double sum_sq = 0.0;
+        int64_t singles = 0;    // individual outcomes, for the independent width
+        int64_t successes = 0;
+    };
+
+    MetricSet metrics_;
+    std::vector<Moments> moments_;
+    std::vector<int8_t> first_;   // outcomes of the open pair's first run
+    std::vector<int8_t> outcomes_;
+    bool have_first_ = false;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_MC_VARIANCE_HPP
@@ -1,23 +1,354 @@
 #include "montecarlo/mc_world.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include "montecarlo/mc_ephemeris.hpp"
+#include <algorithm>
 
 namespace sim::mc {
 
 void MCWorld::add_entity(MCEntity&& entity) {
     size_t index = entities_.size();
-    id_to_index_[entity.id] = index;
+    uint32_t idx = static_cast<uint32_t>(index);
+    if (!id_to_index_) {
+        id_to_index_ = std::make_shared<IdIndex>();
+    } else if (id_to_index_.use_count() > 1) {
+        id_to_index_ = std::make_shared<IdIndex>(*id_to_index_);
+    }
+    (*id_to_index_)[entity.id] = index;
+
+    // Hot columns
+    uint8_t alive = (entity.active && !entity.destroyed) ? 1 : 0;
+    uint16_t team = team_id(entity.team);
+    columns_.alive.push_back(alive);
+    columns_.team.push_back(team);
+    columns_.role.push_back(entity.role);
+    columns_.physics.push_back(entity.physics_type);
+    columns_.eci_pos.push_back(entity.eci_pos);
+
+    // Combat groups (same membership rules as MCRunner::all_combat_resolved)
+    uint8_t groups = 0;
+    if (entity.ai_type == AIType::ORBITAL_COMBAT && entity.role != CombatRole::NONE) {
+        groups |= 1u << static_cast<int>(entity.role == CombatRole::HVA
+                                         ? CombatGroup::ORBITAL_HVA
+                                         : CombatGroup::ORBITAL_COMBAT);
+    }
+    if (entity.physics_type == PhysicsType::FLIGHT_3DOF &&
+        (entity.has_ai || entity.has_weapon)) {
+        groups |= 1u << static_cast<int>(CombatGroup::AIRCRAFT);
+    }
+    columns_.combat_groups.push_back(groups);
+    if (alive_by_team_.size() <= team) alive_by_team_.resize(team + 1, {});
+    if (live_by_team_.size() <= team) live_by_team_.resize(team + 1);
+    for (size_t g = 0; g < NUM_COMBAT_GROUPS; g++) {
+        if (groups & (1u << g)) group_members_[g]++;
+    }
+    if (alive) count_alive(idx, 1);
+
+    // Per-type index lists (types never change after parsing)
+    by_physics_[static_cast<size_t>(entity.physics_type)].push_back(idx);
+    by_ai_[static_cast<size_t>(entity.ai_type)].push_back(idx);
+    by_weapon_[static_cast<size_t>(entity.weapon_type)].push_back(idx);
+    if (entity.has_ai) any_ai_.push_back(idx);
+    if (entity.has_weapon) any_weapon_.push_back(idx);
+    if (entity.has_radar) radars_.push_back(idx);
+    kepler_lane_.push_back(entity.physics_type == PhysicsType::ORBITAL_2BODY
+        ? static_cast<uint32_t>(with_physics(PhysicsType::ORBITAL_2BODY).size() - 1)
+        : NO_ENTITY);
+
+    // Grid cell sizes track the largest query radius of each kind
+    if (entity.ai_type == AIType::ORBITAL_COMBAT) {
+        max_scan_range_ = std::max(max_scan_range_, entity.sensor_range);
+    }
+    if (entity.has_radar) {
+        max_radar_range_ = std::max(max_radar_range_, entity.radar_max_range);
+    }
+    eci_grid_valid_ = false;
+
     entities_.push_back(std::move(entity));
 }
 
+void MCWorld::refresh_query_ranges() {
+    max_scan_range_ = 0.0;
+    max_radar_range_ = 0.0;
+    for (const auto& e : entities_) {
+        if (e.ai_type == AIType::ORBITAL_COMBAT) {
+            max_scan_range_ = std::max(max_scan_range_, e.sensor_range);
+        }
+        if (e.has_radar) {
+            max_radar_range_ = std::max(max_radar_range_, e.radar_max_range);
+        }
+    }
+    eci_grid_valid_ = false;
+}
+
+uint16_t MCWorld::team_id(const std::string& team) {
+    for (size_t i = 0; i < team_names_.size(); i++) {
+        if (team_names_[i] == team) return static_cast<uint16_t>(i);
+    }
+    team_names_.push_back(team);
+    return static_cast<uint16_t>(team_names_.size() - 1);
+}
+
+EntityHandle MCWorld::find_handle(const std::string& id) const {
+    if (id.empty()) return NO_ENTITY;
+    if (!id_to_index_) return NO_ENTITY;
+    auto it = id_to_index_->find(id);
+    if (it == id_to_index_->end()) return NO_ENTITY;
+    return static_cast<EntityHandle>(it->second);
+}
+
+const std::string& MCWorld::id_of(EntityHandle h) const {
+    static const std::string none;
+    return h < entities_.size() ? entities_[h].id : none;
+}
+
+int MCWorld::find_team_id(const std::string& team) const {
+    for (size_t i = 0; i < team_names_.size(); i++) {
+        if (team_names_[i] == team) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void MCWorld::query_eci(const Vec3& center, double radius, IndexList& out) {
+    if (!eci_grid_valid_) {
+        eci_grid_.build(columns_.eci_pos, max_scan_range_);
+        eci_grid_pad_ = orbits_lagging ? orbit_lag_pad : 0.0;
+        eci_grid_valid_ = true;
+    }
+    // Lagging lanes sit within the pad of their indexed position; catch up
+    // the candidates so the caller's exact test sees current positions
+    eci_grid_.query(center, radius + eci_grid_pad_, out);
+    if (orbits_lagging) {
+        for (uint32_t j : out) catch_up_orbit(j);
+    }
+}
+
+void MCWorld::catch_up_orbit(EntityHandle h) {
+    uint32_t k = kepler_lane(h);
+    if (k >= kepler.size() || !kepler.valid[k] || kepler.lag[k] == 0.0) return;
+    kepler.catch_up(k);
+    kepler.state(k, entities_[h].eci_pos, entities_[h].eci_vel);
+    sync_eci_pos(h);
+}
+
+const std::vector<Vec3>& MCWorld::ecef_all() {
+    begin_frame();
+    for (uint32_t h = 0; h < entities_.size(); h++) {
+        if (ecef_stamp_[h] != frame_stamp_) compute_ecef(h);
+    }
+    return frame_ecef_;
+}
+
+Vec3 MCWorld::geodetic_ecef(EntityHandle h) {
+    const MCEntity& e = entities_[h];
+    if (e.physics_type != PhysicsType::ORBITAL_2BODY) return ecef_of(h);
+    return geodetic_to_ecef(e.geo_lat * M_PI / 180.0, e.geo_lon * M_PI / 180.0, e.geo_alt);
+}
+
+void MCWorld::resize_frame() {
+    frame_ecef_.resize(entities_.size());
+    frame_geo_.resize(entities_.size());
+    ecef_stamp_.assign(entities_.size(), 0);
+    geo_stamp_.assign(entities_.size(), 0);
+}
+
+void MCWorld::compute_ecef(EntityHandle h) {
+    const MCEntity& e = entities_[h];
+    Vec3& out = frame_ecef_[h];
+    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+        refresh_orbit(h);
+        const Vec3& eci = e.eci_pos;
+        out = Vec3(gmst_cos_ * eci.x + gmst_sin_ * eci.y,
+                   -gmst_sin_ * eci.x + gmst_cos_ * eci.y,
+                   eci.z);
+    } else {
+        out = geodetic_to_ecef(e.geo_lat * M_PI / 180.0, e.geo_lon * M_PI / 180.0, e.geo_alt);
+    }
+    ecef_stamp_[h] = frame_stamp_;
+}
+
+void MCWorld::compute_geodetic(EntityHandle h) {
+    const MCEntity& e = entities_[h];
+    GeoPoint& out = frame_geo_[h];
+    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
+        const Vec3& p = ecef_of(h);
+        double r = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        out.lat_rad = std::asin(p.z / r);
+        out.lon_rad = std::atan2(p.y, p.x);
+        out.alt = r - R_EARTH_MEAN;
+    } else {
+        out.lat_rad = e.geo_lat * M_PI / 180.0;
+        out.lon_rad = e.geo_lon * M_PI / 180.0;
+        out.alt = e.geo_alt;
+    }
+    geo_stamp_[h] = frame_stamp_;
+}
+
+void MCWorld::refresh_orbits() {
+    if (!orbits_lagging) return;
+    const IndexList& orbital = with_physics(PhysicsType::ORBITAL_2BODY);
+    for (size_t k = 0; k < kepler.size(); k++) {
+        if (!kepler.valid[k] || kepler.lag[k] == 0.0) continue;
+        kepler.catch_up(k);
+        uint32_t i = orbital[k];
+        kepler.state(k, entities_[i].eci_pos, entities_[i].eci_vel);
+        sync_eci_pos(i);
+    }
+    orbits_lagging = false;
+    orbit_lag_pad = 0.0;
+    eci_grid_valid_ = false;
+}
+
+void MCWorld::replay(EntityHandle h) {
+    ephemeris->replay(sim_time, h, entities_[h]);
+    if (entities_[h].physics_type == PhysicsType::ORBITAL_2BODY) sync_eci_pos(h);
+}
+
+void MCWorld::count_alive(uint32_t index, int delta) {
+    // Roster: kept in handle order, as a linear scan would visit it
+    IndexList& live = live_by_team_[columns_.team[index]]
+                                   [static_cast<size_t>(columns_.role[index])];
+    auto at = std::lower_bound(live.begin(), live.end(), index);
+    if (delta > 0) {
+        live.insert(at, index);
+    } else if (at != live.end() && *at == index) {
+        live.erase(at);
+    }
+
+    uint8_t groups = columns_.combat_groups[index];
+    if (groups == 0) return;
+    auto& counts = alive_by_team_[columns_.team[index]];
+    for (size_t g = 0; g < NUM_COMBAT_GROUPS; g++) {
+        if (groups & (1u << g)) counts[g] += delta;
+    }
+}
+
+bool MCWorld::termination_met() const {
+    for (const auto& c : termination) {
+        if (c.type == "time") {
+            if (sim_time >= c.time) return true;
+        } else if (c.type == "entityDown") {
+            if (c.entity != NO_ENTITY && !alive(c.entity)) return true;
+        } else if (c.type == "teamEliminated") {
+            bool eliminated = true;
+            for (size_t g = 0; g < NUM_COMBAT_GROUPS && eliminated; g++) {
+                if ((c.group_mask & (1u << g)) &&
+                    alive_in(static_cast<CombatGroup>(g), c.team) > 0) {
+                    eliminated = false;
+                }
+            }
+            if (eliminated) return true;
+        }
+    }
+    return false;
+}
+
+void MCWorld::set_active(MCEntity& e, bool active) {
+    e.active = active;
+    refresh_alive(e);
+}
+
+void MCWorld::set_destroyed(MCEntity& e, bool destroyed) {
+    e.destroyed = destroyed;
+    refresh_alive(e);
+}
+
+void MCWorld::kill(MCEntity& e) {
+    e.active = false;
+    e.destroyed = true;
+    refresh_alive(e);
+}
+
 MCEntity* MCWorld::get_entity(const std::string& id) {
-    auto it = id_to_index_.find(id);
-    if (it == id_to_index_.end()) return nullptr;
+    if (!id_to_index_) return nullptr;
+    auto it = id_to_index_->find(id);
+    if (it == id_to_index_->end()) return nullptr;
     return &entities_[it->second];
 }
 
 const MCEntity* MCWorld::get_entity(const std::string& id) const {
-    auto it = id_to_index_.find(id);
-    if (it == id_to_index_.end()) return nullptr;
+    if (!id_to_index_) return nullptr;
+    auto it = id_to_index_->find(id);
+    if (it == id_to_index_->end()) return nullptr;
     return &entities_[it->second];
 }
 
+// ── TrackTable ──
+
+const RadarTrack* TrackTable::find(uint16_t team, EntityHandle h) const {
+    if (team >= slot_.size() || h >= slot_[team].size()) return nullptr;
+    const uint32_t k = slot_[team][h];
+    return k == NO_ENTITY ? nullptr : &tracks_[team][k];
+}
+
+void TrackTable::update(uint16_t team, EntityHandle h, EntityHandle radar, const Vec3& z,
+                        double time, double sweep_interval) {
+    if (tracks_.size() <= team) {
+        tracks_.resize(team + 1);
+        slot_.resize(team + 1);
+    }
+    auto& slots = slot_[team];
+    if (slots.size() <= h) slots.resize(h + 1, NO_ENTITY);
+    auto& tracks = tracks_[team];
+    if (slots[h] == NO_ENTITY) {
+        slots[h] = static_cast<uint32_t>(tracks.size());
+        tracks.push_back(RadarTrack{});
+        tracks.back().entity = h;
+    }
+
+    RadarTrack& t = tracks[slots[h]];
+    t.source = radar;
+    const double dt = time - t.time;
+    t.stale_after = std::max(t.stale_after, time + MISSED_SWEEPS * sweep_interval);
+
+    if (t.hits == 1) {
+        // Two-point initialisation (a second radar on the first tick adds nothing)
+        if (dt > 0.0) {
+            t.vel = Vec3((z.x - t.pos.x) / dt, (z.y - t.pos.y) / dt, (z.z - t.pos.z) / dt);
+            t.pos = z;
+            t.time = time;
+            t.hits = 2;
+        }
+        return;
+    }
+    if (t.hits > 1) {
+        const Vec3 p = t.predict(time);
+        const double rx = z.x - p.x, ry = z.y - p.y, rz = z.z - p.z;
+        if (rx * rx + ry * ry + rz * rz <= GATE * GATE) {
+            t.pos = Vec3(p.x + ALPHA * rx, p.y + ALPHA * ry, p.z + ALPHA * rz);
+            // Another radar on the same tick refines the position only
+            if (dt > 0.0) {
+                const double g = BETA / dt;
+                t.vel = Vec3(t.vel.x + g * rx, t.vel.y + g * ry, t.vel.z + g * rz);
+            }
+            t.time = time;
+            t.hits++;
+            return;
+        }
+    }
+
+    // First sight, or outside the gate: restart the track here
+    t.pos = z;
+    t.vel = Vec3(0.0, 0.0, 0.0);
+    t.time = time;
+    t.hits = 1;
+}
+
+void TrackTable::prune(double now) {
+    for (size_t team = 0; team < tracks_.size(); team++) {
+        auto& tracks = tracks_[team];
+        auto& slots = slot_[team];
+        size_t kept = 0;
+        for (size_t k = 0; k < tracks.size(); k++) {
+            if (tracks[k].stale_after < now) {
+                slots[tracks[k].entity] = NO_ENTITY;
+                continue;
+            }
+            if (kept != k) tracks[kept] = tracks[k];
+            slots[tracks[kept].entity] = static_cast<uint32_t>(kept);
+            kept++;
+        }
+        tracks.resize(kept);
+    }
+}
+
 } // namespace sim::mc
@@ -2,25 +2,81 @@
  * MCWorld — Entity container for headless Monte Carlo simulation.
  *
  * Holds all entities in a contiguous vector for cache-friendly iteration.
- * Provides O(1) entity lookup by string ID via unordered_map index.
- * Also holds scenario events for trigger/action evaluation.
+ * Provides O(1) entity lookup by string ID via unordered_map index for the
+ * JSON boundary; in-sim references use EntityHandle (the vector index).
+ * Also holds scenario events for trigger/action evaluation and the
+ * engagement event bus weapon systems push to.
+ *
+ * Hot loops avoid walking the full ~100-field MCEntity array: per-type
+ * index lists (built in add_entity, immutable afterwards) select the
+ * entities a system cares about, and EntityColumns mirrors the handful of
+ * fields every O(N) scan reads (alive flag, team, role, ECI position) in
+ * contiguous arrays. Columns stay current because liveness only changes
+ * through set_active()/set_destroyed()/kill() and orbital positions only
+ * change in MCRunner's Kepler loop, which calls sync_eci_pos(). The same
+ * mutators keep per-(team, CombatGroup) alive counts, so combat-resolution
+ * and scenario termination checks are O(1) per tick, and per-(team, role)
+ * live rosters, so a search for friendlies or hostiles of one role touches
+ * only those.
+ *
+ * Range-gated scans go through a SpatialGrid over the eci_pos column,
+ * rebuilt lazily on the first query after invalidate_spatial() (called by
+ * MCRunner after the physics phase). The same call opens a new frame of
+ * the per-tick position cache: ecef_of() and geodetic_of() convert each
+ * entity at most once per tick, with the GMST rotation computed once.
+ *
+ * With multi-rate coasting (MCConfig::coast_dt) passive orbital entities
+ * may run behind world time; code that reads another entity's orbital state
+ * directly calls refresh_orbit() first. query_eci() pads its radius by the
+ * lag bound and catches up the candidates itself; MCRunner calls
+ * refresh_orbits() before radar sweeps and replay samples.
+ *
+ * With a shared ephemeris (MCConfig::shared_ephemeris) the batch's
+ * deterministic entities replay a table instead of being stepped while
+ * replays() holds; their fields are current at every tick all the same.
+ *
+ * Value-semantic: a parsed world serves as an immutable prototype that
+ * MCRunner copy-assigns into a recycled world at the start of each run.
+ * The recycled world keeps its capacity (strings, vectors, columns), and
+ * the parse-time ID index is shared rather than copied, so resetting a
+ * run allocates nothing once a worker's world has warmed up.
  */
 
 #ifndef SIM_MC_MC_WORLD_HPP
 #define SIM_MC_MC_WORLD_HPP
 
 #include "mc_entity.hpp"
+#include "comm_network.hpp"
+#include "iads_command.hpp"
 #include "sim_rng.hpp"
+#include "kepler_propagator.hpp"
+#include "spatial_grid.hpp"
+#include "tactics/missile_guidance.hpp"
+#include "physics/wind_grid.hpp"
+#include "wez_table.hpp"
+#include "mc_profiler.hpp"
+#include "utils/memory_accounting.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
 
 namespace sim::mc {
 
+class SharedEphemeris;
+
 // ── Scenario Events (trigger → action) ──
 
+enum class TriggerKind : uint8_t { NONE, TIME, PROXIMITY, DETECTION };
+enum class ActionKind : uint8_t { NONE, MESSAGE, SET_RULES, SET_ACTIVE, SET_DESTROYED };
+
 struct EventTrigger {
     std::string type;         // "time", "proximity", "detection"
+    TriggerKind kind = TriggerKind::NONE;   // compiled from type
 
     // time trigger
     double time = 0.0;
@@ -33,16 +89,24 @@ struct EventTrigger {
     // detection trigger
     std::string sensor_entity;  // sensorEntityId
     std::string target_entity;  // targetEntityId
+
+    // Handles for the IDs above, resolved by ScenarioParser
+    EntityHandle entity_a_h = NO_ENTITY;
+    EntityHandle entity_b_h = NO_ENTITY;
+    EntityHandle sensor_h = NO_ENTITY;
+    EntityHandle target_h = NO_ENTITY;
 };
 
 struct EventAction {
     std::string type;           // "message", "change_rules", "set_state"
+    ActionKind kind = ActionKind::NONE;     // compiled from type and field
 
     // message
     std::string message;
 
     // change_rules / set_state
     std::string entity_id;
+    EntityHandle entity = NO_ENTITY;  // resolved from entity_id
     std::string field;          // e.g. "engagementRules"
     std::string value;          // e.g. "weapons_free"
 };
@@ -53,8 +117,303 @@ struct ScenarioEvent {
     EventTrigger trigger;
     EventAction action;
     bool fired = false;
+    RelativeState last_rel;   // proximity pair, b - a (ECEF), at the last check
+};
+
+/**
+ * Compiled trigger schedule (EventSystem::compile), so unfired events cost
+ * nothing on ticks where they cannot fire:
+ *   - time triggers wait in a min-heap keyed by trigger time;
+ *   - proximity triggers wait in a min-heap keyed by the earliest time the
+ *     pair could close to range at a conservative closing-speed bound;
+ *   - detection triggers are listed under their sensor, and RadarSensor
+ *     queues them when that sensor completes a sweep.
+ * Due events are re-checked and fired in event order each tick.
+ */
+struct EventSchedule {
+    using Entry = std::pair<double, uint32_t>;   // (time, event index)
+    std::vector<Entry> time_heap;                // std::greater ordering
+    std::vector<Entry> proximity_heap;
+    std::vector<std::pair<EntityHandle, uint32_t>> detection_watch;  // sorted by sensor
+    std::vector<uint32_t> due;                   // queued for this tick
+
+    /** RadarSensor hook: queue events watching `sensor` after its sweep. */
+    void on_sweep(EntityHandle sensor) {
+        auto it = std::lower_bound(detection_watch.begin(), detection_watch.end(),
+                                   std::make_pair(sensor, uint32_t{0}));
+        for (; it != detection_watch.end() && it->first == sensor; ++it) {
+            due.push_back(it->second);
+        }
+    }
+};
+
+// ── Missile fly-out ──
+
+enum class FlyoutStatus : uint8_t { FREE, FLYING, HIT, MISS };
+inline constexpr uint32_t NO_MISSILE = UINT32_MAX;
+
+/** One guided body in flight; a SAM salvo rides one body (`rounds`). */
+struct FlyoutMissile {
+    sim::MissileState state{};
+    EntityHandle shooter = NO_ENTITY;
+    EntityHandle target = NO_ENTITY;
+    int rounds = 1;
+    Vec3 last_rel;                   // target - missile, local ENU (m), last tick
+    double last_range = 0.0;         // |last_rel|, 0 before the first step
+    FlyoutStatus status = FlyoutStatus::FREE;
+};
+
+/**
+ * In-flight missiles with MCConfig::missile_flyout. SAMBattery and
+ * A2AMissile launch a body here instead of waiting out a time-of-flight
+ * timer; MissileFlyout guides the flying ones each tick and marks them
+ * HIT or MISS; the shooter polls its slot, rolls Pk, logs and releases.
+ * Slots come from a free list in storage reserved on the first launch
+ * for every round the scenario carries, so launches do not reallocate
+ * and the entity vector (and every handle) is untouched.
+ */
+class MissilePool {
+public:
+    bool enabled = false;
+    size_t capacity = 0;             // rounds carried at parse time
+
+    uint32_t launch(const FlyoutMissile& m) {
+        if (slots_.capacity() < capacity) slots_.reserve(capacity);
+        uint32_t slot;
+        if (!free_.empty()) {
+            slot = free_.back();
+            free_.pop_back();
+            slots_[slot] = m;
+        } else {
+            slot = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(m);
+        }
+        slots_[slot].status = FlyoutStatus::FLYING;
+        flying_.push_back(slot);
+        return slot;
+    }
+
+    /** Return a resolved slot to the free list. */
+    void release(uint32_t slot) {
+        slots_[slot].status = FlyoutStatus::FREE;
+        free_.push_back(slot);
+    }
+
+    FlyoutMissile& operator[](uint32_t slot) { return slots_[slot]; }
+    const FlyoutMissile& operator[](uint32_t slot) const { return slots_[slot]; }
+
+    /** Slots still FLYING, in launch order; MissileFlyout prunes it. */
+    std::vector<uint32_t>& flying() { return flying_; }
+    const std::vector<uint32_t>& flying() const { return flying_; }
+
+private:
+    std::vector<FlyoutMissile> slots_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> flying_;
+};
+
+// ── Radar geometry ──
+
+/**
+ * Sensor-fixed frame for RadarSensor's geometric kernel
+ * (MCConfig::radar_los): ECEF origin, spherical east / north / up unit
+ * vectors and the radius of the Earth sphere under the sensor, so every
+ * gate is a dot product. Radars that cannot move keep theirs for the run.
+ */
+struct RadarFrame {
+    bool valid = false;
+    Vec3 origin{0, 0, 0};
+    Vec3 east{0, 0, 0};
+    Vec3 north{0, 0, 0};
+    Vec3 up{0, 0, 0};
+    double occlusion_radius = 0.0;   // m, |origin| less the sensor altitude
+};
+
+// ── Fused radar tracks ──
+
+/**
+ * One team's track on one hostile entity (MCConfig::radar_tracks): an
+ * alpha-beta filter over the ECEF positions of every detection the team's
+ * radars report, so consumers see one extrapolable state per target
+ * however many radars hold it.
+ */
+struct RadarTrack {
+    EntityHandle entity = NO_ENTITY;
+    EntityHandle source = NO_ENTITY;  // radar of the last associated detection
+    Vec3 pos{0, 0, 0};            // filtered ECEF position at `time` [m]
+    Vec3 vel{0, 0, 0};            // filtered ECEF velocity [m/s]
+    double time = 0.0;            // sim time of the last associated detection
+    double stale_after = 0.0;     // dropped if not updated by this sim time
+    int hits = 0;                 // detections since (re)initialisation
+
+    /** Extrapolated ECEF position at sim time t. */
+    Vec3 predict(double t) const {
+        const double dt = t - time;
+        return Vec3(pos.x + vel.x * dt, pos.y + vel.y * dt, pos.z + vel.z * dt);
+    }
+};
+
+/**
+ * Per-team track tables, fed by RadarSensor after each tick's sweeps and
+ * read by SAMBattery in place of every friendly radar's detection list.
+ * Detections carry the detected entity, so association is by handle
+ * (each team holds at most one track per entity); a detection further
+ * than GATE from its track's prediction restarts the track. A track is
+ * reported once it has CONFIRM_HITS detections and until MISSED_SWEEPS
+ * sweep intervals of its last detecting radar pass without one.
+ */
+class TrackTable {
+public:
+    bool enabled = false;
+
+    static constexpr int CONFIRM_HITS = 2;
+    static constexpr double MISSED_SWEEPS = 3.0;
+    static constexpr double ALPHA = 0.8;          // position gain
+    static constexpr double BETA = 0.53;          // velocity gain, ~ALPHA^2 / (2 - ALPHA)
+    static constexpr double GATE = 5000.0;        // m
+
+    /** Tracks held by interned team `team`, in creation order. */
+    const std::vector<RadarTrack>& team(uint16_t team) const {
+        static const std::vector<RadarTrack> none;
+        return team < tracks_.size() ? tracks_[team] : none;
+    }
+
+    /** Team `team`'s track on entity h, or null. */
+    const RadarTrack* find(uint16_t team, EntityHandle h) const;
+
+    /** True if the track counts as held at sim time `now`. */
+    static bool reportable(const RadarTrack& t, double now) {
+        return t.hits >= CONFIRM_HITS && now <= t.stale_after;
+    }
+
+    /**
+     * Fold radar's detection of entity h at ECEF `z` into team `team`'s
+     * track on it, creating the track on first sight.
+     */
+    void update(uint16_t team, EntityHandle h, EntityHandle radar, const Vec3& z,
+                double time, double sweep_interval);
+
+    /** Drop tracks whose stale_after has passed (order of the rest kept). */
+    void prune(double now);
+
+private:
+    std::vector<std::vector<RadarTrack>> tracks_;   // [team]
+    std::vector<std::vector<uint32_t>> slot_;       // [team][handle] -> index, NO_ENTITY if none
+};
+
+// ── Aircraft level of detail ──
+
+/**
+ * Per-run level-of-detail state for aircraft (MCConfig::lod_dt), one lane
+ * per with_physics(FLIGHT_3DOF) entry. FlightLOD marks a lane coarse while
+ * the aircraft is outside every hostile sensor / weapon envelope; a coarse
+ * lane skips Flight3DOF and runs behind world time by `lag`, taking one
+ * step of the accumulated lag every `interval` or when it is promoted.
+ */
+struct FlightLODState {
+    bool enabled = false;
+    double interval = 0.0;          // coarse step [s]
+    double next_classify = 0.0;     // sim time of the next envelope check
+    std::vector<uint8_t> coarse;
+    std::vector<double> lag;        // seconds behind world time
+
+    // Accounting, copied into RunResult::lod
+    int64_t full_ticks = 0;         // aircraft-ticks stepped at full rate
+    int64_t coarse_ticks = 0;       // aircraft-ticks folded into coarse steps
+    int64_t promotions = 0;
+    int64_t demotions = 0;
+    double error_sum = 0.0;         // estimated position error of coarse steps [m]
+    double error_max = 0.0;
+};
+
+// ── Reduced-rate AI decisions ──
+
+/**
+ * Decision ticks for the AI systems (MCConfig::ai_decisions). An AI type
+ * with a period of p ticks re-plans entity i on the ticks where
+ * (tick + i) % p == 0, so a large population's decisions spread evenly
+ * over the period instead of landing on one tick; every entity also
+ * decides on the first tick. Between decisions an AI only carries on with
+ * its last command. Disabled = every tick is a decision.
+ */
+struct DecisionSchedule {
+    bool enabled = false;
+    uint32_t tick = 0;                             // AI ticks run so far
+    std::array<uint32_t, NUM_AI_TYPES> period{};   // ticks per decision
+
+    bool due(AIType type, uint32_t index) const {
+        if (!enabled || tick == 0) return true;
+        const uint32_t p = period[static_cast<size_t>(type)];
+        return p <= 1 || (tick + index) % p == 0;
+    }
+};
+
+// ── Combat groups and termination conditions ──
+
+/** Entity groups whose per-team alive counts decide combat resolution. */
+enum class CombatGroup : uint8_t {
+    ORBITAL_HVA,      // orbital-combat AI, role HVA
+    ORBITAL_COMBAT,   // orbital-combat AI, any other role
+    AIRCRAFT,         // FLIGHT_3DOF with AI or weapons
+};
+constexpr size_t NUM_COMBAT_GROUPS = 3;
+
+/**
+ * Scenario end condition (scenario "termination" array), checked each tick
+ * after the built-in combat-resolution rules:
+ *   { "type": "time", "time": T }
+ *   { "type": "entityDown", "entityId": id }
+ *   { "type": "teamEliminated", "team": t, "groups": ["hva"|"combat"|"aircraft"] }
+ * teamEliminated holds once every listed group (default: all) has no
+ * alive member on the team.
+ */
+struct TerminationCondition {
+    std::string type;
+    double time = 0.0;
+    EntityHandle entity = NO_ENTITY;
+    int team = -1;                      // interned team id, -1 = no such team
+    uint8_t group_mask = 0;             // bit per CombatGroup
+};
+
+// ── Structure-of-arrays hot columns ──
+
+using IndexList = std::vector<uint32_t>;
+
+/**
+ * Scratch set of entity handles, cleared in O(1) by bumping an epoch.
+ * Weapon systems keep one per thread to test "already engaging" per
+ * detection without scanning the shooter's engagement list.
+ */
+class EntityMarks {
+public:
+    /** Empty the set, sized for handles below `n`. */
+    void reset(size_t n) {
+        if (stamp_.size() < n) stamp_.resize(n, 0);
+        if (++epoch_ == 0) {
+            std::fill(stamp_.begin(), stamp_.end(), 0);
+            epoch_ = 1;
+        }
+    }
+    void set(EntityHandle h) { stamp_[h] = epoch_; }
+    bool test(EntityHandle h) const { return stamp_[h] == epoch_; }
+
+private:
+    std::vector<uint32_t> stamp_;
+    uint32_t epoch_ = 0;
+};
+
+struct EntityColumns {
+    std::vector<uint8_t>     alive;     // active && !destroyed
+    std::vector<uint16_t>    team;      // interned team id (see MCWorld::team_id)
+    std::vector<CombatRole>  role;
+    std::vector<PhysicsType> physics;
+    std::vector<Vec3>        eci_pos;   // mirrors MCEntity::eci_pos
+    std::vector<uint8_t>     combat_groups;  // bit per CombatGroup
 };
 
+/** Entity array; its storage is charged to MemoryTag::MC_ENTITIES. */
+using MCEntityList = std::vector<MCEntity, TrackedAllocator<MCEntity, MemoryTag::MC_ENTITIES>>;
+
 class MCWorld {
 public:
     MCWorld() = default;
@@ -64,20 +423,333 @@ public:
     MCEntity* get_entity(const std::string& id);
     const MCEntity* get_entity(const std::string& id) const;
 
-    std::vector<MCEntity>& entities() { return entities_; }
-    const std::vector<MCEntity>& entities() const { return entities_; }
+    /** Handle lookup by index; nullptr for NO_ENTITY or out of range. */
+    MCEntity* get(EntityHandle h) {
+        return h < entities_.size() ? &entities_[h] : nullptr;
+    }
+    const MCEntity* get(EntityHandle h) const {
+        return h < entities_.size() ? &entities_[h] : nullptr;
+    }
+
+    /** Resolve a scenario ID to a handle (NO_ENTITY if empty or unknown). */
+    EntityHandle find_handle(const std::string& id) const;
+
+    /** Scenario ID for a handle (empty string for NO_ENTITY). */
+    const std::string& id_of(EntityHandle h) const;
+
+    MCEntityList& entities() { return entities_; }
+    const MCEntityList& entities() const { return entities_; }
 
     size_t entity_count() const { return entities_.size(); }
 
+    /** Handle of an entity (entity must belong to this world). */
+    EntityHandle index_of(const MCEntity& e) const {
+        return static_cast<EntityHandle>(&e - entities_.data());
+    }
+
+    // ── Hot columns and per-type index lists ──
+
+    const EntityColumns& columns() const { return columns_; }
+
+    const IndexList& with_physics(PhysicsType t) const {
+        return by_physics_[static_cast<size_t>(t)];
+    }
+    const IndexList& with_ai(AIType t) const {
+        return by_ai_[static_cast<size_t>(t)];
+    }
+    const IndexList& with_weapon(WeaponType t) const {
+        return by_weapon_[static_cast<size_t>(t)];
+    }
+    const IndexList& any_ai() const { return any_ai_; }
+    const IndexList& any_weapon() const { return any_weapon_; }
+    const IndexList& radars() const { return radars_; }
+
+    bool alive(uint32_t index) const { return columns_.alive[index] != 0; }
+
+    /** Interned id for a team string; unseen teams get a fresh id. */
+    uint16_t team_id(const std::string& team);
+    /** Interned id for a team string, or -1 if no entity is on that team. */
+    int find_team_id(const std::string& team) const;
+
+    /** Alive members of `group` on interned team `team` (0 for -1). */
+    int alive_in(CombatGroup group, int team) const {
+        if (team < 0 || static_cast<size_t>(team) >= alive_by_team_.size()) return 0;
+        return alive_by_team_[team][static_cast<size_t>(group)];
+    }
+    /**
+     * Alive entities on interned team `team` with combat role `role`,
+     * ascending by handle (empty for -1 or an unknown team).
+     */
+    const IndexList& live_members(int team, CombatRole role) const {
+        static const IndexList none;
+        if (team < 0 || static_cast<size_t>(team) >= live_by_team_.size()) return none;
+        return live_by_team_[team][static_cast<size_t>(role)];
+    }
+
+    /** Members of `group` in the world, alive or not. */
+    int members_in(CombatGroup group) const {
+        return group_members_[static_cast<size_t>(group)];
+    }
+
+    /** True once any scenario termination condition holds. */
+    bool termination_met() const;
+
+    // ── Liveness mutators (keep the alive column in sync) ──
+
+    void set_active(MCEntity& e, bool active);
+    void set_destroyed(MCEntity& e, bool destroyed);
+    /** Mark destroyed and inactive. */
+    void kill(MCEntity& e);
+
+    // ── Spatial index ──
+
+    /**
+     * Candidate handles within `radius` of an ECI point, ascending by
+     * handle. A superset: callers still apply their exact range test.
+     */
+    void query_eci(const Vec3& center, double radius, IndexList& out);
+
+    /** Positions moved — rebuild the ECI grid and frame cache on next use. */
+    void invalidate_spatial() {
+        eci_grid_valid_ = false;
+        frame_stamp_++;
+    }
+
+    // ── Per-tick frame cache ──
+
+    /** Geodetic position in radians, as the sensors and weapons use it. */
+    struct GeoPoint {
+        double lat_rad = 0.0;
+        double lon_rad = 0.0;
+        double alt = 0.0;
+    };
+
+    /**
+     * ECEF position at world time: orbital entities rotate ECI by GMST,
+     * the others convert their geodetic fields. Cached until the next
+     * invalidate_spatial() or sim_time change; orbits are caught up first.
+     */
+    const Vec3& ecef_of(EntityHandle h) {
+        begin_frame();
+        if (ecef_stamp_[h] != frame_stamp_) compute_ecef(h);
+        return frame_ecef_[h];
+    }
+
+    /** ecef_of() for every entity, indexed by handle. */
+    const std::vector<Vec3>& ecef_all();
+
+    /**
+     * Geodetic position: orbital entities are placed on the mean-radius
+     * sphere from their ECEF position; the others report their fields.
+     */
+    const GeoPoint& geodetic_of(EntityHandle h) {
+        begin_frame();
+        if (geo_stamp_[h] != frame_stamp_) compute_geodetic(h);
+        return frame_geo_[h];
+    }
+
+    /**
+     * ECEF of the entity's geodetic fields (what slant_range_ecef() sees):
+     * the cached ecef_of() for geodetic entities, converted on the spot for
+     * orbital ones, whose geodetic fields are not kept current.
+     */
+    Vec3 geodetic_ecef(EntityHandle h);
+
+    // ECEF grid scratch, rebuilt by RadarSensor on ticks where a radar sweeps
+    SpatialGrid ecef_grid;
+
+    // Cached-Kepler lanes, one per with_physics(ORBITAL_2BODY) entry
+    KeplerBatch kepler;
+
+    /** Lane of an entity in `kepler` (NO_ENTITY if not orbital). */
+    uint32_t kepler_lane(EntityHandle h) const {
+        return h < kepler_lane_.size() ? kepler_lane_[h] : NO_ENTITY;
+    }
+
+    // Set by MCRunner while any coasting lane runs behind world time, with
+    // a bound on how far such a lane may be from its stored position [m]
+    bool orbits_lagging = false;
+    double orbit_lag_pad = 0.0;
+
+    /** Bring one entity's orbital state up to world time before reading it. */
+    void refresh_orbit(EntityHandle h) {
+        if (orbits_lagging) catch_up_orbit(h);
+    }
+
+    /** Bring every lagging orbital lane up to world time. */
+    void refresh_orbits();
+
+    /** Largest radar range in the world (ECEF grid cell size). */
+    double max_radar_range() const { return max_radar_range_; }
+
+    /**
+     * Recompute the grid cell sizes from current sensor ranges. Call after
+     * editing sensor_range / radar_max_range on a built world (DOE).
+     */
+    void refresh_query_ranges();
+
+    /** Refresh the eci_pos column after an entity's ECI position changed. */
+    void sync_eci_pos(uint32_t index) {
+        columns_.eci_pos[index] = entities_[index].eci_pos;
+    }
+
     double sim_time = 0.0;
     SimRNG rng{42};
 
-    // Scenario events
+    // Scenario events and their compiled schedule
     std::vector<ScenarioEvent> events;
+    EventSchedule event_schedule;
+
+    // Guided missiles in flight (MCConfig::missile_flyout)
+    MissilePool missiles;
+
+    // Aircraft level of detail (MCConfig::lod_dt)
+    FlightLODState lod;
+
+    // Aircraft take sub-stepped Heun steps (MCConfig::flight_rk2)
+    bool flight_rk2 = false;
+
+    // Shared ephemeris (MCConfig::shared_ephemeris; null: none), and per
+    // entity handle 1 while the entity replays it
+    std::shared_ptr<const SharedEphemeris> ephemeris;
+    std::vector<uint8_t> on_ephemeris;
+
+    /**
+     * True while entity h takes this tick's motion from `ephemeris`. The
+     * first time its motion is perturbed (a burn set orbit_dirty, a viewer
+     * took control) it leaves the table for good, and is stepped live
+     * from the state the table left it in.
+     */
+    bool replays(EntityHandle h) {
+        if (h >= on_ephemeris.size() || !on_ephemeris[h]) return false;
+        const MCEntity& e = entities_[h];
+        if (e.orbit_dirty || e.player_controlled) {
+            on_ephemeris[h] = 0;
+            return false;
+        }
+        return true;
+    }
+
+    /** Load entity h's tabulated state at sim_time (replays(h) holds). */
+    void replay(EntityHandle h);
+
+    // AI decision ticks (MCConfig::ai_decisions)
+    DecisionSchedule decisions;
+
+    // Gridded wind for Flight3DOF (null: still air); grid time at sim_time 0,
+    // one cursor per entity index
+    std::shared_ptr<const WindGrid> wind;
+    double wind_time_offset = 0.0;
+    std::vector<WindGrid::Cursor> wind_cursors;
+
+    // Weapon engagement zone tables (MCConfig::wez_dir; null: none),
+    // and the A2A weapons' tables by A2AWeapon, resolved once per run
+    std::shared_ptr<const WEZLibrary> wez;
+    std::array<const WEZTable*, NUM_A2A_WEAPONS> a2a_wez{};
+
+    // Geometric radar gates (MCConfig::radar_los), one frame per radars() entry
+    bool radar_los = false;
+    std::vector<RadarFrame> radar_frames;
+
+    // Fused per-team radar tracks (MCConfig::radar_tracks)
+    TrackTable tracks;
+
+    // Scenario comm networks (MCConfig::comms)
+    CommNet comms;
+
+    // IADS sectors commanding SAM batteries (MCConfig::iads)
+    IADSState iads;
+
+    // Scenario end conditions beyond combat resolution
+    std::vector<TerminationCondition> termination;
+
+    // Kinetic kills and proximity triggers range over each interval, not
+    // only its end (MCConfig::swept_contact)
+    bool swept_contact = false;
+
+    // This run's cost so far (MCConfig run budgets and tail report), and
+    // the budget it overran, if any (ends the run; becomes its error)
+    RunProfile run_profile;
+    std::string budget_exceeded;
+
+    // Append-only engagement event bus, in push order (chronological, but
+    // a swept kill carries its closest-approach time, up to one tick back);
+    // names are resolved only when a run's results are built
+    std::vector<EngagementRecord> engagement_log;
+
+    void log_engagement(const MCEntity& source, EntityHandle target,
+                        EngagementResult result) {
+        engagement_log.push_back({sim_time, index_of(source), target, result});
+    }
+    void log_engagement(const MCEntity& source, EntityHandle target,
+                        EngagementResult result, double time) {
+        engagement_log.push_back({time, index_of(source), target, result});
+    }
 
 private:
-    std::vector<MCEntity> entities_;
-    std::unordered_map<std::string, size_t> id_to_index_;
+    MCEntityList entities_;
+
+    // ID lookup, fixed once parsing is done: worlds copied from a prototype
+    // share it (a refcount instead of a node-by-node hash table copy per
+    // run); add_entity() clones it first if it is shared
+    using IdIndex = std::unordered_map<std::string, size_t>;
+    std::shared_ptr<IdIndex> id_to_index_;
+
+    EntityColumns columns_;
+    std::array<IndexList, NUM_PHYSICS_TYPES> by_physics_;
+    std::array<IndexList, NUM_AI_TYPES> by_ai_;
+    std::array<IndexList, NUM_WEAPON_TYPES> by_weapon_;
+    IndexList any_ai_;
+    IndexList any_weapon_;
+    IndexList radars_;
+    std::vector<uint32_t> kepler_lane_;
+
+    // Frame cache: an entry is current when its stamp equals frame_stamp_
+    static constexpr double OMEGA_EARTH = 7.2921159e-5;  // rad/s, GMST = 0 at t = 0
+    uint32_t frame_stamp_ = 1;
+    double frame_time_ = -1.0;
+    double gmst_cos_ = 1.0;
+    double gmst_sin_ = 0.0;
+    std::vector<Vec3> frame_ecef_;
+    std::vector<GeoPoint> frame_geo_;
+    std::vector<uint32_t> ecef_stamp_;
+    std::vector<uint32_t> geo_stamp_;
+
+    /** Open a new frame if sim_time moved; size the cache to the world. */
+    void begin_frame() {
+        if (frame_time_ != sim_time) {
+            frame_time_ = sim_time;
+            frame_stamp_++;
+            double gmst = OMEGA_EARTH * sim_time;
+            gmst_cos_ = std::cos(gmst);
+            gmst_sin_ = std::sin(gmst);
+        }
+        if (ecef_stamp_.size() != entities_.size()) resize_frame();
+    }
+    void resize_frame();
+    void compute_ecef(EntityHandle h);
+    void compute_geodetic(EntityHandle h);
+    std::vector<std::string> team_names_;
+    std::vector<std::array<int32_t, NUM_COMBAT_GROUPS>> alive_by_team_;
+    std::vector<std::array<IndexList, NUM_COMBAT_ROLES>> live_by_team_;
+    std::array<int32_t, NUM_COMBAT_GROUPS> group_members_{};
+
+    SpatialGrid eci_grid_;
+    bool eci_grid_valid_ = false;
+    double eci_grid_pad_ = 0.0;
+    double max_scan_range_ = 0.0;
+    double max_radar_range_ = 0.0;
+
+    void catch_up_orbit(EntityHandle h);
+
+    void refresh_alive(const MCEntity& e) {
+        uint32_t i = index_of(e);
+        uint8_t alive = (e.active && !e.destroyed) ? 1 : 0;
+        if (alive != columns_.alive[i]) count_alive(i, alive ? 1 : -1);
+        columns_.alive[i] = alive;
+    }
+
+    void count_alive(uint32_t index, int delta);
 };
 
 } // namespace sim::mc
@@ -0,0 +1,150 @@
+#include "montecarlo/missile_flyout.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+constexpr double METERS_PER_DEG = 111132.0;  // update_missile_state's flat Earth
+constexpr double ARMING_TIME = 0.5;          // s, as sim::check_hit
+// Proximity fuze floor: at 0.1 s ticks a body moves ~100 m per step, so the
+// terminal PN error is tens of metres; the warhead Pk roll covers the rest
+constexpr double FUZE_RADIUS = 50.0;         // m
+
+// Target states for the flying slots, reused across ticks on each thread
+thread_local std::vector<sim::GuidanceTarget> targets;
+
+sim::GuidanceTarget guidance_target(MCWorld& world, EntityHandle h) {
+    const MCWorld::GeoPoint& g = world.geodetic_of(h);
+    const MCEntity& e = world.entities()[h];
+    sim::GuidanceTarget t{};
+    t.latitude = g.lat_rad * RAD_TO_DEG;
+    t.longitude = g.lon_rad * RAD_TO_DEG;
+    t.altitude = g.alt;
+    if (e.physics_type == PhysicsType::FLIGHT_3DOF) {
+        t.speed = e.flight_speed;
+        t.heading = e.flight_heading * RAD_TO_DEG;
+        t.flight_path_angle = e.flight_gamma * RAD_TO_DEG;
+    }
+    return t;
+}
+
+// Target relative to missile in the local flat-Earth frame (north, east, up)
+Vec3 relative_enu(const sim::MissileState& m, const sim::GuidanceTarget& t) {
+    double cos_lat = std::cos(m.latitude * M_PI / 180.0);
+    return Vec3((t.latitude - m.latitude) * METERS_PER_DEG,
+                (t.longitude - m.longitude) * METERS_PER_DEG * cos_lat,
+                t.altitude - m.altitude);
+}
+
+// Closest distance to the origin along the segment a -> b
+double segment_miss_distance(const Vec3& a, const Vec3& b) {
+    Vec3 d(b.x - a.x, b.y - a.y, b.z - a.z);
+    double dd = d.x * d.x + d.y * d.y + d.z * d.z;
+    double s = dd > 0.0 ? -(a.x * d.x + a.y * d.y + a.z * d.z) / dd : 0.0;
+    s = s < 0.0 ? 0.0 : (s > 1.0 ? 1.0 : s);
+    Vec3 p(a.x + s * d.x, a.y + s * d.y, a.z + s * d.z);
+    return std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+}
+
+} // namespace
+
+uint32_t MissileFlyout::launch(MCWorld& world, EntityHandle shooter, EntityHandle target,
+                               bool bvr, double speed, double max_range, int rounds) {
+    const MCWorld::GeoPoint from = world.geodetic_of(shooter);
+    const MCWorld::GeoPoint& to = world.geodetic_of(target);
+
+    double heading = great_circle_bearing(from.lat_rad, from.lon_rad,
+                                          to.lat_rad, to.lon_rad) * RAD_TO_DEG;
+    double ground = haversine_distance(from.lat_rad, from.lon_rad, to.lat_rad, to.lon_rad);
+
+    FlyoutMissile m = body(bvr, from.lat_rad * RAD_TO_DEG, from.lon_rad * RAD_TO_DEG, from.alt,
+                           heading, std::atan2(to.alt - from.alt, ground) * RAD_TO_DEG,
+                           speed, max_range);
+    m.state.launcher_id = static_cast<int>(shooter);
+    m.state.target_id = static_cast<int>(target);
+    m.shooter = shooter;
+    m.target = target;
+    m.rounds = rounds;
+    return world.missiles.launch(m);
+}
+
+FlyoutMissile MissileFlyout::body(bool bvr, double lat, double lon, double alt, double heading,
+                                  double flight_path_angle, double speed, double max_range) {
+    FlyoutMissile m;
+    m.state = bvr ? sim::create_bvr_missile(0, 0, 0, lat, lon, alt, heading, speed)
+                  : sim::create_wvr_missile(0, 0, 0, lat, lon, alt, heading, speed);
+    m.state.max_speed = speed;
+    m.state.max_range = max_range;
+    m.state.flight_path_angle = flight_path_angle;
+    m.status = FlyoutStatus::FLYING;
+    return m;
+}
+
+void MissileFlyout::update_all(double dt, MCWorld& world) {
+    MissilePool& pool = world.missiles;
+    auto& flying = pool.flying();
+    if (flying.empty()) return;
+
+    // ── Gather target states; a vanished target ends its body as a MISS ──
+    targets.resize(flying.size());
+    for (size_t k = 0; k < flying.size(); k++) {
+        FlyoutMissile& m = pool[flying[k]];
+        if (!world.alive(m.target)) {
+            m.status = FlyoutStatus::MISS;
+            continue;
+        }
+        targets[k] = guidance_target(world, m.target);
+    }
+
+    // ── Guidance and kinematics ──
+    const sim::GuidanceParams params;
+    for (size_t k = 0; k < flying.size(); k++) {
+        FlyoutMissile& m = pool[flying[k]];
+        if (m.status != FlyoutStatus::FLYING) continue;
+        sim::GuidanceCommand cmd = sim::compute_guidance(m.state, targets[k], params, dt);
+        sim::update_missile_state(m.state, cmd, dt);
+    }
+
+    // ── Endgame; drop resolved bodies from the flying list in order ──
+    size_t kept = 0;
+    for (size_t k = 0; k < flying.size(); k++) {
+        FlyoutMissile& m = pool[flying[k]];
+        if (m.status == FlyoutStatus::FLYING && resolve(m, targets[k])) {
+            flying[kept++] = flying[k];
+        }
+    }
+    flying.resize(kept);
+}
+
+bool MissileFlyout::resolve(FlyoutMissile& m, const sim::GuidanceTarget& t) {
+    const sim::MissileState& s = m.state;
+    const Vec3 rel = relative_enu(s, t);
+    const double range = std::sqrt(rel.x * rel.x + rel.y * rel.y + rel.z * rel.z);
+    const bool armed = s.time_of_flight > ARMING_TIME;
+    const double fuze = std::max(s.lethal_radius, FUZE_RADIUS);
+
+    if (armed && range < fuze) {
+        m.status = FlyoutStatus::HIT;
+        return false;
+    }
+    // Past closest approach, or the seeker lost the target (which also
+    // happens as it flies by): the last step's miss distance decides
+    const bool passed = m.last_range > 0.0 && range > m.last_range;
+    if (passed || sim::check_miss(s, t)) {
+        bool hit = armed && m.last_range > 0.0 &&
+                   segment_miss_distance(m.last_rel, rel) < fuze;
+        m.status = hit ? FlyoutStatus::HIT : FlyoutStatus::MISS;
+        return false;
+    }
+
+    m.last_rel = rel;
+    m.last_range = range;
+    return true;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,52 @@
+/**
+ * MissileFlyout — Guided fly-out of pooled SAM/A2A missiles.
+ *
+ * With MCConfig::missile_flyout, SAMBattery and A2AMissile launch bodies
+ * into MCWorld::missiles instead of resolving a shot after a fixed time
+ * of flight. Each tick the flying bodies are advanced as one batch:
+ * target states are gathered for every live slot, then each body takes
+ * a sim::compute_guidance (proportional navigation) step and
+ * sim::update_missile_state. A body is then marked
+ *   HIT  inside its fuze radius (lethal radius, at least 50 m), or when
+ *        it passes closest approach or loses the seeker with the miss
+ *        distance over the last step inside that radius (the step is far
+ *        longer than the radius at closing speed);
+ *   MISS otherwise once it passes, when sim::check_miss fires (fuel,
+ *        seeker lost, ground) away from the target, or the target is gone.
+ * The shooter polls its slot, rolls Pk per round on a HIT, logs and
+ * releases the slot, so kills and RNG draws stay in shooter order.
+ */
+
+#ifndef SIM_MC_MISSILE_FLYOUT_HPP
+#define SIM_MC_MISSILE_FLYOUT_HPP
+
+#include "mc_world.hpp"
+
+namespace sim::mc {
+
+class MissileFlyout {
+public:
+    static void update_all(double dt, MCWorld& world);
+
+    /**
+     * Launch one body from `shooter` at `target`, pointed along the line
+     * of sight. BVR bodies take AIM-120-like performance, others AIM-9.
+     * @return Pool slot to poll
+     */
+    static uint32_t launch(MCWorld& world, EntityHandle shooter, EntityHandle target,
+                           bool bvr, double speed, double max_range, int rounds);
+
+    /**
+     * The body launch() flies, at a geodetic point (degrees, m) with
+     * heading and flight path angle in degrees. WEZ generation flies the
+     * same bodies offline.
+     */
+    static FlyoutMissile body(bool bvr, double lat, double lon, double alt, double heading,
+                              double flight_path_angle, double speed, double max_range);
+
+    /** Resolve one guided step of `m`; false once it is HIT or MISS. */
+    static bool resolve(FlyoutMissile& m, const sim::GuidanceTarget& t);
+};
+
+} // namespace sim::mc
+#endif // SIM_MC_MISSILE_FLYOUT_HPP
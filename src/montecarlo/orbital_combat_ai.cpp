@@ -6,96 +6,135 @@
 
 namespace sim::mc {
 
-void OrbitalCombatAI::update_all(double dt, MCWorld& world) {
-    // Thread-local target buffer to avoid per-entity allocation
-    static thread_local std::vector<TargetInfo> target_buf;
+namespace {
+
+constexpr uint8_t role_bit(CombatRole r) { return 1u << static_cast<int>(r); }
+
+/** Target roles each scanning role's selector considers; the sweep keeps only these. */
+uint8_t wanted_roles(CombatRole scanner) {
+    switch (scanner) {
+        case CombatRole::DEFENDER:
+            return role_bit(CombatRole::ATTACKER) | role_bit(CombatRole::SWEEP) |
+                   role_bit(CombatRole::ESCORT);
+        case CombatRole::ATTACKER:
+            return role_bit(CombatRole::HVA);
+        case CombatRole::ESCORT:
+            return role_bit(CombatRole::DEFENDER) | role_bit(CombatRole::SWEEP);
+        case CombatRole::SWEEP:
+            return role_bit(CombatRole::ATTACKER) | role_bit(CombatRole::ESCORT);
+        default:
+            return 0;
+    }
+}
 
-    for (auto& entity : world.entities()) {
-        if (!entity.has_ai) continue;
-        if (!entity.active || entity.destroyed) continue;
+} // namespace
+
+void OrbitalCombatAI::update_all(double dt, MCWorld& world) {
+    auto& entities = world.entities();
+    for (uint32_t i : world.with_ai(AIType::ORBITAL_COMBAT)) {
+        if (!world.alive(i)) continue;
+        MCEntity& entity = entities[i];
 
-        // HVAs are passive
-        if (entity.role == CombatRole::HVA) continue;
+        // HVAs are passive; a viewer flies player-controlled entities
+        if (entity.role == CombatRole::HVA || entity.player_controlled) continue;
 
-        // Periodic sensor sweep
+        // Periodic sensor sweep; off decision ticks the sweep waits for
+        // the next one
         entity.scan_timer += dt;
-        if (entity.scan_timer >= entity.scan_interval) {
+        const bool decide = world.decisions.due(AIType::ORBITAL_COMBAT, i);
+        if (decide && entity.scan_timer >= entity.scan_interval) {
             entity.scan_timer = 0.0;
-            target_buf.clear();
-            scan_for_targets(entity, world, target_buf);
+            entity.scan_targets.clear();
+            scan_for_targets(entity, world, entity.scan_targets);
         }
 
+        // Target list persists between sweeps (per entity, as in the JS component)
+        const auto& targets = entity.scan_targets;
+
         // Target selection based on role
-        switch (entity.role) {
-            case CombatRole::DEFENDER:
-                select_target_defender(entity, world, target_buf);
-                break;
-            case CombatRole::ATTACKER:
-                select_target_attacker(entity, target_buf);
-                break;
-            case CombatRole::ESCORT:
-                select_target_escort(entity, dt, world, target_buf);
-                break;
-            case CombatRole::SWEEP:
-                select_target_sweep(entity, target_buf);
-                break;
-            default:
-                break;
+        if (decide) {
+            switch (entity.role) {
+                case CombatRole::DEFENDER:
+                    select_target_defender(entity, world, targets);
+                    break;
+                case CombatRole::ATTACKER:
+                    select_target_attacker(entity, targets);
+                    break;
+                case CombatRole::ESCORT:
+                    select_target_escort(entity, dt, world, targets);
+                    break;
+                case CombatRole::SWEEP:
+                    select_target_sweep(entity, targets);
+                    break;
+                default:
+                    break;
+            }
         }
 
         // Act on current target
-        if (!entity.current_target.empty()) {
-            MCEntity* target = world.get_entity(entity.current_target);
+        if (entity.current_target != NO_ENTITY) {
+            world.refresh_orbit(entity.current_target);
+            MCEntity* target = world.get(entity.current_target);
             if (target && target->active && !target->destroyed) {
                 Vec3 delta = target->eci_pos - entity.eci_pos;
                 double dist = delta.norm();
 
                 if (dist < entity.kill_range) {
                     // Within kill range — signal weapon system
-                    entity.kk_target_id = entity.current_target;
+                    entity.kk_target = entity.current_target;
                 } else {
                     // Close the distance
-                    entity.kk_target_id.clear();
+                    entity.kk_target = NO_ENTITY;
                     apply_thrust(entity, dt, target->eci_pos);
                 }
                 continue;
             }
 
             // Target became invalid
-            entity.current_target.clear();
+            entity.current_target = NO_ENTITY;
         }
 
         // No target
-        entity.kk_target_id.clear();
+        entity.kk_target = NO_ENTITY;
     }
 }
 
 void OrbitalCombatAI::scan_for_targets(MCEntity& entity, MCWorld& world,
                                         std::vector<TargetInfo>& targets) {
-    const auto& my_team = entity.team;
+    const auto& cols = world.columns();
+    const uint32_t self = world.index_of(entity);
+    const uint16_t my_team = cols.team[self];
     const auto& my_pos = entity.eci_pos;
     double sensor_range = entity.sensor_range;
     double sr_sq = sensor_range * sensor_range;
+    const uint8_t wanted = wanted_roles(entity.role);
+    if (wanted == 0) return;
+
+    // Grid candidates arrive in handle order, as a linear scan would visit them
+    static thread_local IndexList candidates;
+    world.query_eci(my_pos, sensor_range, candidates);
 
-    for (const auto& other : world.entities()) {
+    for (uint32_t j : candidates) {
         // Skip self
-        if (other.id == entity.id) continue;
+        if (j == self) continue;
 
         // Skip same team
-        if (other.team == my_team) continue;
+        if (cols.team[j] == my_team) continue;
 
-        // Skip inactive or destroyed
-        if (!other.active || other.destroyed) continue;
+        // Skip inactive or destroyed, and roles the selector ignores
+        if (!cols.alive[j]) continue;
+        if (!(wanted & role_bit(cols.role[j]))) continue;
 
         // Compute ECI distance (squared first for early rejection)
-        double dx = other.eci_pos.x - my_pos.x;
-        double dy = other.eci_pos.y - my_pos.y;
-        double dz = other.eci_pos.z - my_pos.z;
+        const Vec3& p = cols.eci_pos[j];
+        double dx = p.x - my_pos.x;
+        double dy = p.y - my_pos.y;
+        double dz = p.z - my_pos.z;
         double dist_sq = dx * dx + dy * dy + dz * dz;
 
         if (dist_sq <= sr_sq) {
             double dist = std::sqrt(dist_sq);
-            targets.push_back({other.id, dist, other.role});
+            targets.push_back({j, dist, cols.role[j]});
         }
     }
 
@@ -109,19 +148,17 @@ void OrbitalCombatAI::scan_for_targets(MCEntity& entity, MCWorld& world,
 void OrbitalCombatAI::select_target_defender(MCEntity& entity, MCWorld& world,
                                               const std::vector<TargetInfo>& targets) {
     // Get assigned HVA position
-    MCEntity* hva = nullptr;
-    if (!entity.assigned_hva_id.empty()) {
-        hva = world.get_entity(entity.assigned_hva_id);
-    }
+    world.refresh_orbit(entity.assigned_hva);
+    MCEntity* hva = world.get(entity.assigned_hva);
     if (!hva || !hva->active) {
-        entity.current_target.clear();
+        entity.current_target = NO_ENTITY;
         return;
     }
 
     const Vec3& hva_pos = hva->eci_pos;
     double def_radius = entity.defense_radius;
     double def_radius_sq = def_radius * def_radius;
-    std::string best_id;
+    EntityHandle best = NO_ENTITY;
     double best_dist = std::numeric_limits<double>::max();
 
     for (const auto& t : targets) {
@@ -131,7 +168,7 @@ void OrbitalCombatAI::select_target_defender(MCEntity& entity, MCWorld& world,
             t.role != CombatRole::ESCORT) continue;
 
         // Check if enemy is within defense radius of HVA
-        MCEntity* enemy = world.get_entity(t.entity_id);
+        MCEntity* enemy = world.get(t.entity);
         if (!enemy) continue;
 
         double dx = enemy->eci_pos.x - hva_pos.x;
@@ -140,68 +177,68 @@ void OrbitalCombatAI::select_target_defender(MCEntity& entity, MCWorld& world,
         double dist_to_hva_sq = dx * dx + dy * dy + dz * dz;
 
         if (dist_to_hva_sq <= def_radius_sq && t.distance < best_dist) {
-            best_id = t.entity_id;
+            best = t.entity;
             best_dist = t.distance;
         }
     }
 
-    entity.current_target = best_id;
+    entity.current_target = best;
 }
 
 void OrbitalCombatAI::select_target_attacker(MCEntity& entity,
                                               const std::vector<TargetInfo>& targets) {
-    std::string best_id;
+    EntityHandle best = NO_ENTITY;
     double best_dist = std::numeric_limits<double>::max();
 
     for (const auto& t : targets) {
         if (t.role == CombatRole::HVA && t.distance < best_dist) {
-            best_id = t.entity_id;
+            best = t.entity;
             best_dist = t.distance;
         }
     }
 
-    entity.current_target = best_id;
+    entity.current_target = best;
 }
 
 void OrbitalCombatAI::select_target_escort(MCEntity& entity, double dt,
                                             MCWorld& world,
                                             const std::vector<TargetInfo>& targets) {
     // Priority 1: engage enemy defenders or sweeps
-    std::string best_id;
+    EntityHandle best = NO_ENTITY;
     double best_dist = std::numeric_limits<double>::max();
 
     for (const auto& t : targets) {
         if ((t.role == CombatRole::DEFENDER || t.role == CombatRole::SWEEP) &&
             t.distance < best_dist) {
-            best_id = t.entity_id;
+            best = t.entity;
             best_dist = t.distance;
         }
     }
 
-    if (!best_id.empty()) {
-        entity.current_target = best_id;
+    if (best != NO_ENTITY) {
+        entity.current_target = best;
         return;
     }
 
     // Priority 2: drift toward nearest friendly attacker
-    entity.current_target.clear();
+    entity.current_target = NO_ENTITY;
     drift_toward_friendly_attacker(entity, dt, world);
 }
 
 void OrbitalCombatAI::select_target_sweep(MCEntity& entity,
                                            const std::vector<TargetInfo>& targets) {
-    std::string best_id;
+    EntityHandle best = NO_ENTITY;
     double best_dist = std::numeric_limits<double>::max();
 
     for (const auto& t : targets) {
         if ((t.role == CombatRole::ATTACKER || t.role == CombatRole::ESCORT) &&
             t.distance < best_dist) {
-            best_id = t.entity_id;
+            best = t.entity;
             best_dist = t.distance;
         }
     }
 
-    entity.current_target = best_id;
+    entity.current_target = best;
 }
 
 void OrbitalCombatAI::drift_toward_friendly_attacker(MCEntity& entity, double dt,
@@ -209,32 +246,31 @@ void OrbitalCombatAI::drift_toward_friendly_attacker(MCEntity& entity, double dt
     // Only do the expensive scan at scan boundaries
     if (entity.scan_timer > 0.01) return;
 
+    const auto& cols = world.columns();
+    const uint32_t self = world.index_of(entity);
+    const uint16_t my_team = cols.team[self];
     const auto& my_pos = entity.eci_pos;
-    std::string nearest_id;
+    uint32_t nearest = self;
     double nearest_dist = std::numeric_limits<double>::max();
 
-    for (const auto& other : world.entities()) {
-        if (other.id == entity.id) continue;
-        if (other.team != entity.team) continue;
-        if (!other.active || other.destroyed) continue;
-        if (other.role != CombatRole::ATTACKER) continue;
+    for (uint32_t j : world.live_members(my_team, CombatRole::ATTACKER)) {
+        if (j == self) continue;
+        world.refresh_orbit(j);
 
-        double dx = other.eci_pos.x - my_pos.x;
-        double dy = other.eci_pos.y - my_pos.y;
-        double dz = other.eci_pos.z - my_pos.z;
+        const Vec3& p = cols.eci_pos[j];
+        double dx = p.x - my_pos.x;
+        double dy = p.y - my_pos.y;
+        double dz = p.z - my_pos.z;
         double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
 
         if (dist < nearest_dist) {
             nearest_dist = dist;
-            nearest_id = other.id;
+            nearest = j;
         }
     }
 
-    if (!nearest_id.empty()) {
-        MCEntity* friendly = world.get_entity(nearest_id);
-        if (friendly) {
-            apply_thrust_scaled(entity, dt, friendly->eci_pos, 0.3);
-        }
+    if (nearest != self) {
+        apply_thrust_scaled(entity, dt, cols.eci_pos[nearest], 0.3);
     }
 }
 
@@ -250,6 +286,7 @@ void OrbitalCombatAI::apply_thrust(MCEntity& entity, double dt,
     entity.eci_vel.x += delta.x * inv_dist * dv;
     entity.eci_vel.y += delta.y * inv_dist * dv;
     entity.eci_vel.z += delta.z * inv_dist * dv;
+    entity.orbit_dirty = true;
 }
 
 void OrbitalCombatAI::apply_thrust_scaled(MCEntity& entity, double dt,
@@ -265,6 +302,7 @@ void OrbitalCombatAI::apply_thrust_scaled(MCEntity& entity, double dt,
     entity.eci_vel.x += delta.x * inv_dist * dv;
     entity.eci_vel.y += delta.y * inv_dist * dv;
     entity.eci_vel.z += delta.z * inv_dist * dv;
+    entity.orbit_dirty = true;
 }
 
 } // namespace sim::mc
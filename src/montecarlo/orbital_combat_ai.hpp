@@ -6,6 +6,13 @@
  *
  * Roles: HVA (passive), Defender, Attacker, Escort, Sweep.
  * All operate in ECI coordinates, modifying eci_vel in-place.
+ * The sensor sweep is range-gated by MCWorld's ECI grid and keeps only live
+ * hostiles of the roles the entity's selector considers; friendly searches
+ * go through MCWorld::live_members().
+ *
+ * With reduced-rate decisions (MCConfig::ai_decisions) the sweep and the
+ * target selection run only on an entity's decision ticks; in between it
+ * keeps thrusting at, or signalling the kill of, its current target.
  */
 
 #ifndef SIM_MC_ORBITAL_COMBAT_AI_HPP
@@ -17,14 +24,11 @@
 
 namespace sim::mc {
 
-struct TargetInfo {
-    std::string entity_id;
-    double distance;
-    CombatRole role;
-};
-
 class OrbitalCombatAI {
 public:
+    /** Seconds between decisions under MCConfig::ai_decisions. */
+    static constexpr double DECISION_PERIOD = 1.0;
+
     static void update_all(double dt, MCWorld& world);
 
 private:
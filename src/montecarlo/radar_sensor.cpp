@@ -1,58 +1,92 @@
 #include "montecarlo/radar_sensor.hpp"
 #include "montecarlo/geo_utils.hpp"
+#include <algorithm>
 #include <cmath>
 
 namespace sim::mc {
 
-// Earth rotation rate (rad/s) for GMST computation
-static constexpr double OMEGA_EARTH = 7.2921159e-5;
+namespace {
 
-/**
- * Convert ECI position to ECEF via simple GMST rotation.
- * Suitable for short-duration sims where precession/nutation are negligible.
- */
-static Vec3 eci_to_ecef(const Vec3& eci, double sim_time) {
-    double gmst = OMEGA_EARTH * sim_time;
-    double c = std::cos(gmst);
-    double s = std::sin(gmst);
-    return Vec3(
-         c * eci.x + s * eci.y,
-        -s * eci.x + c * eci.y,
-        eci.z
-    );
+// Occlusion sphere shrink per metre of sight line: the largest change in
+// WGS84 geocentric radius per metre of ground track, (a - b) / R
+constexpr double OCCLUSION_SLOPE = 21384.7 / R_EARTH_MEAN;
+
+// Sphere dropped below the sensor so a sensor on it does not occlude itself
+constexpr double OCCLUSION_MARGIN = 1.0;  // m
+
+/** Spherical ENU frame at the radar's ECEF position; no trig. */
+void build_frame(RadarFrame& f, const MCEntity& e, const Vec3& p) {
+    f.origin = p;
+    const double r = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+    const double rh = std::sqrt(p.x * p.x + p.y * p.y);
+    if (r < 1.0) {
+        f.valid = false;
+        return;
+    }
+    f.up = Vec3(p.x / r, p.y / r, p.z / r);
+    // East = z × up; at the poles any horizontal axis will do
+    f.east = rh > 1e-9 ? Vec3(-p.y / rh, p.x / rh, 0.0) : Vec3(0.0, 1.0, 0.0);
+    f.north = Vec3(f.up.y * f.east.z - f.up.z * f.east.y,
+                   f.up.z * f.east.x - f.up.x * f.east.z,
+                   f.up.x * f.east.y - f.up.y * f.east.x);
+    const double alt = e.physics_type == PhysicsType::ORBITAL_2BODY ? r - R_EARTH_MEAN
+                                                                    : e.geo_alt;
+    f.occlusion_radius = std::max(0.0, r - alt - OCCLUSION_MARGIN);
+    f.valid = true;
 }
 
+/** Candidate lanes for one geometric sweep. */
+struct LOSLanes {
+    std::vector<uint32_t> idx;
+    std::vector<double> dx, dy, dz, range;
+    std::vector<uint8_t> pass;
+
+    void resize(size_t n) {
+        idx.resize(n);
+        dx.resize(n);
+        dy.resize(n);
+        dz.resize(n);
+        range.resize(n);
+        pass.resize(n);
+    }
+};
+
+} // namespace
+
 /**
- * Get ECEF position for any entity based on its physics type.
- * Ground/flight entities use geodetic_to_ecef; orbital entities use ECI→ECEF rotation.
+ * Observer's local tangent frame for bearings, from a spherical
+ * approximation of its ECEF position. Built on a sweep's first detection.
  */
-static Vec3 entity_ecef(const MCEntity& e, double sim_time) {
-    if (e.physics_type == PhysicsType::ORBITAL_2BODY) {
-        return eci_to_ecef(e.eci_pos, sim_time);
+struct BearingFrame {
+    bool built = false;
+    bool valid = false;
+    double sin_lat = 0.0, cos_lat = 1.0;
+    double sin_lon = 0.0, cos_lon = 1.0;
+
+    void build(const Vec3& obs) {
+        built = true;
+        double r_obs = std::sqrt(obs.x * obs.x + obs.y * obs.y + obs.z * obs.z);
+        if (r_obs < 1.0) return;
+        double lat = std::asin(obs.z / r_obs);
+        double lon = std::atan2(obs.y, obs.x);
+        sin_lat = std::sin(lat);
+        cos_lat = std::cos(lat);
+        sin_lon = std::sin(lon);
+        cos_lon = std::cos(lon);
+        valid = true;
     }
-    // Ground or flight: convert geodetic (degrees) to ECEF
-    double lat_rad = e.geo_lat * M_PI / 180.0;
-    double lon_rad = e.geo_lon * M_PI / 180.0;
-    return geodetic_to_ecef(lat_rad, lon_rad, e.geo_alt);
-}
+};
 
 /**
  * Compute bearing from observer ECEF position to target ECEF position.
  * Returns bearing in radians [0, 2*pi) from north.
  * Uses a simplified local-tangent-plane projection.
  */
-static double compute_bearing_ecef(const Vec3& obs, const Vec3& tgt) {
-    // Observer geodetic approximation for local frame
-    double r_obs = std::sqrt(obs.x * obs.x + obs.y * obs.y + obs.z * obs.z);
-    if (r_obs < 1.0) return 0.0;
-
-    double lat = std::asin(obs.z / r_obs);
-    double lon = std::atan2(obs.y, obs.x);
-
-    double sin_lat = std::sin(lat);
-    double cos_lat = std::cos(lat);
-    double sin_lon = std::sin(lon);
-    double cos_lon = std::cos(lon);
+static double compute_bearing_ecef(BearingFrame& f, const Vec3& obs, const Vec3& tgt) {
+    if (!f.built) f.build(obs);
+    if (!f.valid) return 0.0;
+    const double sin_lat = f.sin_lat, cos_lat = f.cos_lat;
+    const double sin_lon = f.sin_lon, cos_lon = f.cos_lon;
 
     // Difference vector in ECEF
     double dx = tgt.x - obs.x;
@@ -69,33 +103,86 @@ static double compute_bearing_ecef(const Vec3& obs, const Vec3& tgt) {
 }
 
 void RadarSensor::update_all(double dt, MCWorld& world) {
-    for (auto& entity : world.entities()) {
-        if (!entity.has_radar) continue;
-        if (!entity.active || entity.destroyed) continue;
-        update_entity(entity, dt, world);
+    auto& entities = world.entities();
+
+    const IndexList& radars = world.radars();
+
+    // Pass 1: advance sweep timers, remember which radars sweep this tick
+    // (by radars() lane)
+    static thread_local IndexList sweeping;
+    sweeping.clear();
+    for (uint32_t k = 0; k < radars.size(); k++) {
+        const uint32_t i = radars[k];
+        if (!world.alive(i)) continue;
+        MCEntity& e = entities[i];
+        e.radar_sweep_timer += dt;
+        if (e.radar_sweep_timer < e.radar_sweep_interval) continue;
+        sweeping.push_back(k);
     }
+    if (sweeping.empty()) return;
+
+    // Positions don't change during the sensor phase, so one ECEF grid
+    // serves every sweep this tick
+    world.ecef_grid.build(world.ecef_all(), world.max_radar_range());
+
+    // Pass 2: sweeps in radar order (detection rolls share the world RNG)
+    if (world.radar_los) {
+        if (world.radar_frames.size() != radars.size()) {
+            world.radar_frames.assign(radars.size(), RadarFrame{});
+        }
+        for (uint32_t k : sweeping) {
+            sweep_los(entities[radars[k]], k, world);
+        }
+    } else {
+        for (uint32_t k : sweeping) {
+            sweep(entities[radars[k]], world);
+        }
+    }
+
+    if (world.tracks.enabled) fuse(sweeping, world);
 }
 
-void RadarSensor::update_entity(MCEntity& e, double dt, MCWorld& world) {
-    // Increment sweep timer
-    e.radar_sweep_timer += dt;
-    if (e.radar_sweep_timer < e.radar_sweep_interval) return;
+void RadarSensor::fuse(const IndexList& sweeping, MCWorld& world) {
+    // Fold this tick's detections into each radar's team tracks, in radar
+    // and detection order
+    TrackTable& tracks = world.tracks;
+    tracks.prune(world.sim_time);
+    const auto& cols = world.columns();
+    for (uint32_t k : sweeping) {
+        const uint32_t r = world.radars()[k];
+        const MCEntity& e = world.entities()[r];
+        for (const RadarDetection& det : e.radar_detections) {
+            tracks.update(cols.team[r], det.entity, r, world.geodetic_ecef(det.entity),
+                          det.time, e.radar_sweep_interval);
+        }
+    }
+}
 
+void RadarSensor::sweep(MCEntity& e, MCWorld& world) {
     // New sweep
     e.radar_sweep_timer = 0.0;
     e.radar_detections.clear();
 
-    Vec3 sensor_ecef = entity_ecef(e, world.sim_time);
+    const auto& cols = world.columns();
+    const uint32_t self = world.index_of(e);
+    const uint16_t my_team = cols.team[self];
+    const Vec3 sensor_ecef = world.ecef_of(self);
+    BearingFrame bearing_frame;
+    // Observer uses its own geodetic fields for the elevation test
+    const double lat_rad = e.geo_lat * M_PI / 180.0;
+    const double lon_rad = e.geo_lon * M_PI / 180.0;
+
+    // Candidates arrive in handle order, so RNG draws match a linear scan
+    static thread_local IndexList candidates;
+    world.ecef_grid.query(sensor_ecef, e.radar_max_range, candidates);
 
-    for (auto& target : world.entities()) {
-        // Skip self
-        if (target.id == e.id) continue;
-        // Skip same team
-        if (target.team == e.team) continue;
-        // Skip inactive/destroyed
-        if (!target.active || target.destroyed) continue;
+    for (uint32_t j : candidates) {
+        // Skip self, same team, inactive/destroyed (hot columns only)
+        if (j == self) continue;
+        if (cols.team[j] == my_team) continue;
+        if (!cols.alive[j]) continue;
 
-        Vec3 tgt_ecef = entity_ecef(target, world.sim_time);
+        const Vec3& tgt_ecef = world.ecef_of(j);
 
         // Compute slant range (Euclidean distance in ECEF)
         double dx = tgt_ecef.x - sensor_ecef.x;
@@ -106,45 +193,134 @@ void RadarSensor::update_entity(MCEntity& e, double dt, MCWorld& world) {
         // Range gate
         if (range > e.radar_max_range) continue;
 
-        // Elevation angle check
-        // Use geodetic approximation for the observer
-        double lat_rad = e.geo_lat * M_PI / 180.0;
-        double lon_rad = e.geo_lon * M_PI / 180.0;
-        double tgt_lat_rad, tgt_lon_rad, tgt_alt;
-
-        if (target.physics_type == PhysicsType::ORBITAL_2BODY) {
-            // Approximate geodetic from ECEF for orbital targets
-            double r = std::sqrt(tgt_ecef.x * tgt_ecef.x +
-                                 tgt_ecef.y * tgt_ecef.y +
-                                 tgt_ecef.z * tgt_ecef.z);
-            tgt_lat_rad = std::asin(tgt_ecef.z / r);
-            tgt_lon_rad = std::atan2(tgt_ecef.y, tgt_ecef.x);
-            tgt_alt = r - R_EARTH_MEAN;
-        } else {
-            tgt_lat_rad = target.geo_lat * M_PI / 180.0;
-            tgt_lon_rad = target.geo_lon * M_PI / 180.0;
-            tgt_alt = target.geo_alt;
-        }
-
+        // Elevation angle check (orbital targets: spherical geodetic from ECEF)
+        const MCWorld::GeoPoint& tgt = world.geodetic_of(j);
         double elev = elevation_angle(lat_rad, lon_rad, e.geo_alt,
-                                       tgt_lat_rad, tgt_lon_rad, tgt_alt);
+                                       tgt.lat_rad, tgt.lon_rad, tgt.alt);
 
         if (elev < e.radar_min_elev_deg || elev > e.radar_max_elev_deg) continue;
 
         // Probabilistic detection roll
-        if (!world.rng.bernoulli(e.radar_p_detect)) continue;
+        if (!world.rng.bernoulli(e.radar_p_detect, self)) continue;
 
         // Compute bearing from sensor to target
-        double bearing = compute_bearing_ecef(sensor_ecef, tgt_ecef);
+        double bearing = compute_bearing_ecef(bearing_frame, sensor_ecef, tgt_ecef);
 
         // Detection!
         e.radar_detections.push_back(RadarDetection{
-            target.id,
+            j,
             range,
             bearing,
             world.sim_time
         });
     }
+
+    // Detection triggers watching this sensor re-check against the new list
+    if (!world.event_schedule.detection_watch.empty()) {
+        world.event_schedule.on_sweep(self);
+    }
+}
+
+void RadarSensor::sweep_los(MCEntity& e, size_t lane, MCWorld& world) {
+    e.radar_sweep_timer = 0.0;
+    e.radar_detections.clear();
+
+    const auto& cols = world.columns();
+    const uint32_t self = world.index_of(e);
+    const uint16_t my_team = cols.team[self];
+    const Vec3 sensor_ecef = world.ecef_of(self);
+
+    // Radars that cannot move keep the frame for the run
+    RadarFrame& f = world.radar_frames[lane];
+    if (!f.valid || e.has_physics) build_frame(f, e, sensor_ecef);
+    if (!f.valid) return;
+
+    static thread_local IndexList candidates;
+    world.ecef_grid.query(sensor_ecef, e.radar_max_range, candidates);
+
+    // Gather: hot-column filters, then ECEF deltas into lanes
+    static thread_local LOSLanes lanes;
+    lanes.resize(candidates.size());
+    size_t n = 0;
+    for (uint32_t j : candidates) {
+        if (j == self || cols.team[j] == my_team || !cols.alive[j]) continue;
+        const Vec3& t = world.ecef_of(j);
+        lanes.idx[n] = j;
+        lanes.dx[n] = t.x - sensor_ecef.x;
+        lanes.dy[n] = t.y - sensor_ecef.y;
+        lanes.dz[n] = t.z - sensor_ecef.z;
+        n++;
+    }
+
+    // Per-sweep constants: the only trig in the sweep
+    const double max_r2 = e.radar_max_range * e.radar_max_range;
+    const double sin_min = std::sin(e.radar_min_elev_deg * M_PI / 180.0);
+    const double sin_max = std::sin(e.radar_max_elev_deg * M_PI / 180.0);
+    const bool fov_gate = e.physics_type == PhysicsType::FLIGHT_3DOF &&
+                          e.radar_fov_deg < 360.0;
+    const double cos_half_fov = fov_gate ? std::cos(0.5 * e.radar_fov_deg * M_PI / 180.0)
+                                         : -2.0;
+    const double bore_e = fov_gate ? std::sin(e.flight_heading) : 0.0;
+    const double bore_n = fov_gate ? std::cos(e.flight_heading) : 1.0;
+    const Vec3 o = f.origin, up = f.up, east = f.east, north = f.north;
+    const double o2 = o.x * o.x + o.y * o.y + o.z * o.z;
+    const double r_occ = f.occlusion_radius;
+
+    const double* dx = lanes.dx.data();
+    const double* dy = lanes.dy.data();
+    const double* dz = lanes.dz.data();
+    double* range = lanes.range.data();
+    uint8_t* pass = lanes.pass.data();
+
+    // Gates as dot products, branch-free over the lanes
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        const double r2 = dx[k] * dx[k] + dy[k] * dy[k] + dz[k] * dz[k];
+        const double r = std::sqrt(r2);
+        range[k] = r;
+
+        // Elevation: sin(el) = d·up / |d|
+        const double du = dx[k] * up.x + dy[k] * up.y + dz[k] * up.z;
+        const bool elev_ok = du >= r * sin_min && du <= r * sin_max;
+
+        // Azimuth field of view in the horizontal plane
+        const double de = dx[k] * east.x + dy[k] * east.y + dz[k] * east.z;
+        const double dn = dx[k] * north.x + dy[k] * north.y + dz[k] * north.z;
+        const double dh = std::sqrt(de * de + dn * dn);
+        const bool fov_ok = de * bore_e + dn * bore_n >= cos_half_fov * dh;
+
+        // Earth occlusion: closest approach of the segment to the centre
+        const double od = o.x * dx[k] + o.y * dy[k] + o.z * dz[k];
+        const double s = std::min(1.0, std::max(0.0, r2 > 0.0 ? -od / r2 : 0.0));
+        const double closest2 = o2 + 2.0 * s * od + s * s * r2;
+        const double sphere = std::max(0.0, r_occ - OCCLUSION_SLOPE * r);
+        const bool clear = closest2 >= sphere * sphere;
+
+        pass[k] = static_cast<uint8_t>((r2 <= max_r2) & elev_ok & fov_ok & clear);
+    }
+
+    // Rolls in candidate order, so RNG draws match the scalar scan; the
+    // bearing is computed only for detections
+    for (size_t k = 0; k < n; k++) {
+        if (!pass[k]) continue;
+        if (!world.rng.bernoulli(e.radar_p_detect, self)) continue;
+
+        const double de = dx[k] * east.x + dy[k] * east.y + dz[k] * east.z;
+        const double dn = dx[k] * north.x + dy[k] * north.y + dz[k] * north.z;
+        double bearing = std::atan2(de, dn);
+        if (bearing < 0.0) bearing += 2.0 * M_PI;
+
+        e.radar_detections.push_back(RadarDetection{
+            lanes.idx[k],
+            range[k],
+            bearing,
+            world.sim_time
+        });
+    }
+
+    if (!world.event_schedule.detection_watch.empty()) {
+        world.event_schedule.on_sweep(self);
+    }
 }
 
 } // namespace sim::mc
@@ -5,11 +5,33 @@
 
 namespace sim::mc {
 
+/**
+ * RadarSensor — Sweep-timed radar detection of hostile entities.
+ *
+ * Default gates follow the JS engine: slant range, then an elevation
+ * angle from geodetic fields (haversine ground distance), then the
+ * detection roll; bearings are computed only for detections.
+ *
+ * With MCConfig::radar_los a sweep runs the geometric kernel instead:
+ * each radar has a RadarFrame (built once for radars that cannot move),
+ * the candidates' cached ECEF positions are gathered into lanes, and
+ * range, elevation (sin el = d·up / |d|), azimuth field of view (against
+ * the flight heading, aircraft with fov < 360 only) and Earth occlusion
+ * (the sight line's closest approach to the sphere under the sensor) are
+ * evaluated as dot products in one branch-free loop, with no per-pair
+ * trig. Rolls and bearings (one atan2) follow in candidate order, so RNG
+ * draws keep the scalar sequence. Not bitwise with the default gates.
+ *
+ * With MCConfig::radar_tracks each tick's detections are then fused into
+ * per-team tracks (TrackTable).
+ */
 class RadarSensor {
 public:
     static void update_all(double dt, MCWorld& world);
 private:
-    static void update_entity(MCEntity& e, double dt, MCWorld& world);
+    static void sweep(MCEntity& e, MCWorld& world);
+    static void sweep_los(MCEntity& e, size_t lane, MCWorld& world);
+    static void fuse(const IndexList& sweeping, MCWorld& world);
 };
 
 } // namespace sim::mc
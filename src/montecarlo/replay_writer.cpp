@@ -3,13 +3,16 @@
 #include "io/json_writer.hpp"
 #include <cmath>
 #include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <sys/stat.h>
 
 namespace sim::mc {
 
 static constexpr double OMEGA_EARTH = 7.2921159e-5;  // rad/s
 static constexpr double DEG_TO_RAD = M_PI / 180.0;
 
-void ReplayWriter::init(const std::vector<MCEntity>& entities,
+void ReplayWriter::init(const MCEntityList& entities,
                         double sample_interval) {
     sample_interval_ = sample_interval;
     next_sample_time_ = 0.0;
@@ -22,12 +25,254 @@ void ReplayWriter::init(const std::vector<MCEntity>& entities,
 
     for (size_t i = 0; i < n; i++) {
         positions_[i].clear();
-        positions_[i].reserve(
-            static_cast<size_t>(600.0 / sample_interval) + 10);
         id_to_index_[entities[i].id] = i;
     }
 
     events_.clear();
+    total_kills_ = total_launches_ = 0;
+    stream_ = nullptr;
+    tile_levels_.clear();
+    tile_events_.reset();
+}
+
+void ReplayWriter::begin_stream(std::ostream& out, const MCConfig& config,
+                                const MCEntityList& entities,
+                                int chunk_samples, double quantum,
+                                double error_bound, double max_gap) {
+    stream_ = &out;
+    chunk_samples_ = std::max(chunk_samples, 1);
+    quantum_ = quantum > 0.0 ? quantum : 1.0;
+    chunk_first_ = 0;
+    error_bound_ = std::max(error_bound, 0.0);
+    max_gap_ = max_gap > 0.0 ? max_gap : 60.0;
+    // Velocity resolution fine enough that it adds little Hermite error
+    velocity_quantum_ = quantum_ * 0.01;
+
+    size_t n = entities.size();
+    sample_times_.reserve(static_cast<size_t>(chunk_samples_));
+    tracks_.assign(n, {});
+    for (auto& track : tracks_) {
+        track.reserve(static_cast<size_t>(chunk_samples_) * 3);
+    }
+    last_q_.assign(n, {0, 0, 0});
+    sample_counts_.assign(n, 0);
+    ended_.assign(n, 0);
+    chunk_deaths_.clear();
+    if (error_bound_ > 0.0) {
+        kept_.assign(n, TrackPoint{-1.0, {}, {}});
+        pending_.assign(n, {});
+        track_times_.assign(n, {});
+        track_vel_.assign(n, {});
+        last_qv_.assign(n, {0, 0, 0});
+    }
+
+    // Positions for the batch format are not kept in streaming mode
+    for (auto& p : positions_) Buffer<Vec3>().swap(p);
+
+    sim::JsonWriter w(out, 0);
+    w.begin_object();
+    w.kv("type", "header");
+    w.kv("format", "replay_v2");
+    w.key("config").begin_object();
+    w.kv("seed", config.base_seed);
+    w.kv("duration", config.max_sim_time);
+    w.kv("sampleInterval", config.sample_interval);
+    w.kv("chunkSamples", chunk_samples_);
+    w.kv("quantum", quantum_);
+    if (error_bound_ > 0.0) {
+        w.kv("adaptive", true);
+        w.kv("errorBound", error_bound_);
+        w.kv("maxGap", max_gap_);
+        w.kv("velocityQuantum", velocity_quantum_);
+    }
+    w.end_object();
+
+    w.key("entities").begin_array();
+    for (const auto& e : entities) {
+        w.begin_object();
+        write_entity_meta(w, e);
+        if (e.weapon_type == WeaponType::SAM_BATTERY) {
+            w.kv("maxRange", e.sam_max_range);
+        } else if (e.has_radar) {
+            w.kv("maxRange", e.radar_max_range);
+        }
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    out << '\n' << std::flush;
+}
+
+void ReplayWriter::flush_chunk() {
+    if (sample_times_.empty() && chunk_deaths_.empty() && events_.empty()) return;
+
+    sim::JsonWriter w(*stream_, 0);
+    w.begin_object();
+    w.kv("type", "chunk");
+    w.kv("first", chunk_first_);
+
+    bool adaptive = error_bound_ > 0.0;
+    if (adaptive) {
+        w.kv("candidates", sample_times_.size());
+    } else {
+        w.key("sampleTimes").begin_array();
+        for (double t : sample_times_) w.value(t);
+        w.end_array();
+    }
+
+    w.key("tracks").begin_array();
+    for (auto& track : tracks_) {
+        w.begin_array();
+        for (int64_t v : track) w.value(v);
+        w.end_array();
+        track.clear();
+    }
+    w.end_array();
+
+    if (adaptive) {
+        w.key("trackTimes").begin_array();
+        for (auto& times : track_times_) {
+            w.begin_array();
+            for (double t : times) w.value(t);
+            w.end_array();
+            times.clear();
+        }
+        w.end_array();
+        w.key("trackVelocities").begin_array();
+        for (auto& vel : track_vel_) {
+            w.begin_array();
+            for (int64_t v : vel) w.value(v);
+            w.end_array();
+            vel.clear();
+        }
+        w.end_array();
+    }
+
+    w.key("deaths").begin_array();
+    for (size_t i : chunk_deaths_) {
+        w.begin_object();
+        w.kv("entity", i);
+        w.kv("sample", sample_counts_[i]);
+        w.kv("time", death_times_[i]);
+        w.end_object();
+    }
+    w.end_array();
+
+    std::stable_sort(events_.begin(), events_.end(),
+                     [](const ReplayEvent& a, const ReplayEvent& b) {
+                         return a.time < b.time;
+                     });
+    w.key("events").begin_array();
+    for (const auto& evt : events_) write_event_json(w, evt);
+    w.end_array();
+    w.end_object();
+    *stream_ << '\n' << std::flush;
+
+    chunk_first_ += static_cast<int64_t>(sample_times_.size());
+    if (!sample_times_.empty()) end_time_ = sample_times_.back();
+    sample_times_.clear();
+    chunk_deaths_.clear();
+    events_.clear();
+}
+
+void ReplayWriter::append_position(size_t i, const Vec3& ecef) {
+    std::array<int64_t, 3> q = {std::llround(ecef.x / quantum_),
+                                std::llround(ecef.y / quantum_),
+                                std::llround(ecef.z / quantum_)};
+    // Each chunk opens with an absolute keyframe, then deltas
+    auto& track = tracks_[i];
+    bool keyframe = track.empty();
+    for (int k = 0; k < 3; k++) {
+        track.push_back(keyframe ? q[k] : q[k] - last_q_[i][k]);
+    }
+    last_q_[i] = q;
+    sample_counts_[i]++;
+}
+
+void ReplayWriter::keep(size_t i, const TrackPoint& point) {
+    append_position(i, point.pos);
+    track_times_[i].push_back(point.t);
+
+    std::array<int64_t, 3> q = {std::llround(point.vel.x / velocity_quantum_),
+                                std::llround(point.vel.y / velocity_quantum_),
+                                std::llround(point.vel.z / velocity_quantum_)};
+    auto& vel = track_vel_[i];
+    bool keyframe = vel.empty();
+    for (int k = 0; k < 3; k++) {
+        vel.push_back(keyframe ? q[k] : q[k] - last_qv_[i][k]);
+    }
+    last_qv_[i] = q;
+    kept_[i] = point;
+}
+
+void ReplayWriter::offer(size_t i, const TrackPoint& c) {
+    TrackPoint& k = kept_[i];
+    auto& pending = pending_[i];
+    if (k.t < 0.0) {
+        keep(i, c);   // first point of the track
+        return;
+    }
+
+    if (c.t - k.t > max_gap_ && !pending.empty()) {
+        keep(i, pending.back());
+        pending.clear();
+    }
+    pending.push_back(c);
+
+    // Would the segment kept → c reproduce the candidates in between?
+    size_t n = pending.size() - 1;
+    size_t stride = std::max<size_t>(1, (n + 15) / 16);
+    for (size_t j = 0; j < n; j += stride) {
+        const TrackPoint& p = pending[j];
+        Vec3 h = hermite(k.t, k.pos, k.vel, c.t, c.pos, c.vel, p.t);
+        double dx = h.x - p.pos.x, dy = h.y - p.pos.y, dz = h.z - p.pos.z;
+        if (dx * dx + dy * dy + dz * dz > error_bound_ * error_bound_) {
+            // No: the previous candidate was the last good segment end
+            keep(i, pending[n - 1]);
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(n));
+            return;
+        }
+    }
+}
+
+void ReplayWriter::close_track(size_t i) {
+    if (error_bound_ > 0.0 && !pending_[i].empty()) {
+        keep(i, pending_[i].back());
+        pending_[i].clear();
+    }
+}
+
+Vec3 ReplayWriter::hermite(double t0, const Vec3& p0, const Vec3& v0,
+                           double t1, const Vec3& p1, const Vec3& v1, double t) {
+    double h = t1 - t0;
+    if (h <= 0.0) return p1;
+    double s = (t - t0) / h;
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2 * s3 - 3 * s2 + 1;
+    double h10 = (s3 - 2 * s2 + s) * h;
+    double h01 = -2 * s3 + 3 * s2;
+    double h11 = (s3 - s2) * h;
+    return Vec3{h00 * p0.x + h10 * v0.x + h01 * p1.x + h11 * v1.x,
+                h00 * p0.y + h10 * v0.y + h01 * p1.y + h11 * v1.y,
+                h00 * p0.z + h10 * v0.z + h01 * p1.z + h11 * v1.z};
+}
+
+void ReplayWriter::finish_stream(const MCEntityList& entities) {
+    for (size_t i = 0; i < ended_.size(); i++) {
+        if (!ended_[i]) close_track(i);
+    }
+    flush_chunk();
+
+    sim::JsonWriter w(*stream_, 0);
+    w.begin_object();
+    w.kv("type", "end");
+    w.kv("endTime", end_time_);
+    w.kv("samples", chunk_first_);
+    w.key("summary");
+    write_summary(w, entities);
+    w.end_object();
+    *stream_ << '\n' << std::flush;
+    stream_ = nullptr;
 }
 
 static Vec3 entity_to_ecef(const MCEntity& e, double sim_time) {
@@ -44,6 +289,30 @@ static Vec3 entity_to_ecef(const MCEntity& e, double sim_time) {
     }
 }
 
+static Vec3 entity_ecef_velocity(const MCEntity& e, double sim_time) {
+    switch (e.physics_type) {
+        case PhysicsType::ORBITAL_2BODY: {
+            // Rotate into ECEF and remove the frame rotation, omega x r
+            Vec3 v = ReplayWriter::eci_to_ecef(e.eci_vel, sim_time);
+            Vec3 r = ReplayWriter::eci_to_ecef(e.eci_pos, sim_time);
+            return Vec3{v.x + OMEGA_EARTH * r.y, v.y - OMEGA_EARTH * r.x, v.z};
+        }
+        case PhysicsType::FLIGHT_3DOF: {
+            double lat = e.geo_lat * DEG_TO_RAD, lon = e.geo_lon * DEG_TO_RAD;
+            double ve = e.flight_speed * std::cos(e.flight_gamma) * std::sin(e.flight_heading);
+            double vn = e.flight_speed * std::cos(e.flight_gamma) * std::cos(e.flight_heading);
+            double vu = e.flight_speed * std::sin(e.flight_gamma);
+            double sl = std::sin(lat), cl = std::cos(lat);
+            double so = std::sin(lon), co = std::cos(lon);
+            return Vec3{-so * ve - sl * co * vn + cl * co * vu,
+                         co * ve - sl * so * vn + cl * so * vu,
+                         cl * vn + sl * vu};
+        }
+        default:
+            return Vec3{0, 0, 0};
+    }
+}
+
 bool ReplayWriter::sample(const MCWorld& world) {
     if (world.sim_time < next_sample_time_) return false;
 
@@ -51,6 +320,53 @@ bool ReplayWriter::sample(const MCWorld& world) {
     sample_times_.push_back(t);
 
     const auto& entities = world.entities();
+    if (archive_) {
+        for (size_t i = 0; i < archive_pos_.size() && i < entities.size(); i++) {
+            const auto& e = entities[i];
+            archive_valid_[i] = e.active && !e.destroyed;
+            if (archive_valid_[i]) archive_pos_[i] = entity_to_ecef(e, t);
+        }
+        archive_->add_sample(t, archive_pos_.data(), archive_valid_.data());
+    }
+    if (!tile_levels_.empty()) {
+        for (size_t i = 0; i < tile_pos_.size() && i < entities.size(); i++) {
+            const auto& e = entities[i];
+            tile_valid_[i] = e.active && !e.destroyed;
+            if (tile_valid_[i]) tile_pos_[i] = entity_to_ecef(e, t);
+        }
+        // Level L takes every 4^L-th sample
+        for (size_t l = 0; l < tile_levels_.size(); l++) {
+            if (tile_samples_taken_ % tile_levels_[l].stride == 0) add_tile_row(l, t);
+        }
+        tile_samples_taken_++;
+        tile_end_time_ = t;
+    }
+    if (stream_) {
+        for (size_t i = 0; i < entities.size(); i++) {
+            const auto& e = entities[i];
+            if (ended_[i]) continue;
+            // A track ends at the first sample the entity is down
+            if (!e.active || e.destroyed) {
+                ended_[i] = 1;
+                close_track(i);
+                continue;
+            }
+
+            if (error_bound_ > 0.0) {
+                offer(i, TrackPoint{t, entity_to_ecef(e, t), entity_ecef_velocity(e, t)});
+            } else {
+                append_position(i, entity_to_ecef(e, t));
+            }
+        }
+        next_sample_time_ = t + sample_interval_;
+        if (static_cast<int>(sample_times_.size()) >= chunk_samples_) flush_chunk();
+        return true;
+    }
+
+    if (sample_times_.size() == 1) {
+        // Buffered only: a streamed replay never holds the whole track
+        for (auto& p : positions_) p.reserve(static_cast<size_t>(600.0 / sample_interval_) + 10);
+    }
     for (size_t i = 0; i < entities.size(); i++) {
         const auto& e = entities[i];
         if (e.active && !e.destroyed) {
@@ -68,15 +384,325 @@ bool ReplayWriter::sample(const MCWorld& world) {
     return true;
 }
 
+bool ReplayWriter::begin_archive(const std::string& filename,
+                                 const MCEntityList& entities,
+                                 const TrajectoryArchiveOptions& options) {
+    std::vector<std::string> ids;
+    ids.reserve(entities.size());
+    for (const auto& e : entities) ids.push_back(e.id);
+
+    TrajectoryArchiveOptions archive_options = options;
+    archive_options.frame = traj::FRAME_ECEF;
+    archive_.reset(new TrajectoryArchiveWriter());
+    if (!archive_->open(filename, ids, archive_options)) {
+        archive_.reset();
+        return false;
+    }
+    archive_pos_.assign(entities.size(), Vec3{0, 0, 0});
+    archive_valid_.assign(entities.size(), 0);
+    return true;
+}
+
+bool ReplayWriter::end_archive() {
+    if (!archive_) return false;
+    bool ok = archive_->close();
+    archive_.reset();
+    return ok;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Tiled replay
+// ═══════════════════════════════════════════════════════════════
+
+static constexpr size_t TILE_WRITE_BYTES = 32 * 1024;
+
+template <typename Text>
+static void append_number(Text& text, int64_t v) {
+    char buf[24];
+    auto end = std::to_chars(buf, buf + sizeof(buf), v).ptr;
+    text.insert(text.end(), buf, end);
+}
+
+// Times as JsonWriter writes them (15 significant digits)
+template <typename Text>
+static void append_number(Text& text, double v) {
+    char buf[32];
+    auto end = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::general,
+                             sim::JsonWriter::DEFAULT_PRECISION).ptr;
+    text.insert(text.end(), buf, end);
+}
+
+template <typename Text>
+static void append_text(Text& text, const std::string& s) {
+    text.insert(text.end(), s.begin(), s.end());
+}
+
+bool ReplayWriter::begin_tiles(const std::string& dir, const MCConfig& config,
+                               const MCEntityList& entities,
+                               const ReplayTileOptions& options) {
+    tile_options_ = options;
+    tile_options_.tile_samples = std::max(options.tile_samples, 1);
+    tile_options_.group_size = std::max(options.group_size, 1);
+    tile_options_.keyframe_every = std::max(options.keyframe_every, 1);
+    if (!(tile_options_.quantum > 0.0)) tile_options_.quantum = 1.0;
+    tiles_dir_ = dir;
+    tiles_ok_ = true;
+    tile_samples_taken_ = 0;
+    tile_end_time_ = 0.0;
+
+    ::mkdir(dir.c_str(), 0755);
+    tile_events_.reset(new std::ofstream(dir + "/events.jsonl"));
+    if (!*tile_events_) {
+        tile_events_.reset();
+        return false;
+    }
+
+    // Levels until one tile spans the whole run (at most 12)
+    double interval = sample_interval_ > 0.0 ? sample_interval_ : 1.0;
+    double expected = std::ceil(std::max(config.max_sim_time, 0.0) / interval) + 1.0;
+    size_t num_levels = 1;
+    int64_t stride = 1;
+    while (static_cast<double>(tile_options_.tile_samples) * static_cast<double>(stride) < expected
+           && num_levels < 12) {
+        stride *= 4;
+        num_levels++;
+    }
+
+    size_t n = entities.size();
+    size_t groups = (n + static_cast<size_t>(tile_options_.group_size) - 1)
+                    / static_cast<size_t>(tile_options_.group_size);
+    tile_levels_.assign(num_levels, TileLevel());
+    stride = 1;
+    for (size_t l = 0; l < num_levels; l++, stride *= 4) {
+        TileLevel& lv = tile_levels_[l];
+        lv.stride = stride;
+        lv.pending.assign(groups, {});
+        lv.bytes.assign(groups, 0);
+        lv.keyframe_offsets.assign(groups, {});
+        lv.last_q.assign(n, {0, 0, 0});
+        lv.present.assign(n, 0);
+        ::mkdir((dir + "/" + std::to_string(l)).c_str(), 0755);
+    }
+    tile_pos_.assign(n, Vec3{0, 0, 0});
+    tile_valid_.assign(n, 0);
+    return true;
+}
+
+std::string ReplayWriter::tile_path(size_t level, int64_t tile, size_t group) const {
+    return tiles_dir_ + "/" + std::to_string(level) + "/" + std::to_string(tile) + "-"
+           + std::to_string(group) + ".jsonl";
+}
+
+void ReplayWriter::write_tile_text(size_t level, size_t group) {
+    TileLevel& lv = tile_levels_[level];
+    auto& text = lv.pending[group];
+    if (text.empty()) return;
+    // The tile's first write replaces whatever an earlier run left there
+    std::ofstream f(tile_path(level, lv.tile, group),
+                    lv.bytes[group] == 0 ? std::ios::trunc : std::ios::app);
+    f.write(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!f) tiles_ok_ = false;
+    lv.bytes[group] += text.size();
+    text.clear();
+}
+
+void ReplayWriter::add_tile_row(size_t level, double t) {
+    TileLevel& lv = tile_levels_[level];
+    const int64_t per_tile = tile_options_.tile_samples;
+    int64_t row_index = lv.rows++;
+    int64_t tile = row_index / per_tile;
+    int64_t row = row_index % per_tile;
+    size_t group_size = static_cast<size_t>(tile_options_.group_size);
+    size_t n = tile_pos_.size();
+
+    if (tile != lv.tile) {
+        if (lv.tile >= 0) close_tile(level);
+        lv.tile = tile;
+        lv.t0 = t;
+        lv.keyframes.clear();
+        std::fill(lv.present.begin(), lv.present.end(), 0);
+        for (size_t g = 0; g < lv.pending.size(); g++) {
+            lv.bytes[g] = 0;
+            lv.keyframe_offsets[g].clear();
+            size_t first = g * group_size;
+
+            std::ostringstream header;
+            sim::JsonWriter w(header, sim::JsonWriter::COMPACT);
+            w.begin_object();
+            w.kv("type", "tile");
+            w.kv("level", level);
+            w.kv("tile", tile);
+            w.kv("group", g);
+            w.kv("firstEntity", first);
+            w.kv("entities", std::min(group_size, n - first));
+            w.kv("stride", lv.stride);
+            w.kv("first", tile * per_tile * lv.stride);
+            w.kv("quantum", tile_options_.quantum);
+            w.kv("keyframeEvery", tile_options_.keyframe_every);
+            w.end_object();
+            w.flush();
+            header << '\n';
+            append_text(lv.pending[g], header.str());
+        }
+    }
+    lv.t1 = t;
+    lv.tile_rows = row + 1;
+
+    bool keyframe = row % tile_options_.keyframe_every == 0;
+    if (keyframe) lv.keyframes.emplace_back(row, t);
+    const double q = tile_options_.quantum;
+    for (size_t g = 0; g < lv.pending.size(); g++) {
+        auto& text = lv.pending[g];
+        if (keyframe) lv.keyframe_offsets[g].push_back(lv.bytes[g] + text.size());
+        text.push_back('[');
+        append_number(text, t);
+        size_t end = std::min(n, (g + 1) * group_size);
+        for (size_t i = g * group_size; i < end; i++) {
+            if (!tile_valid_[i]) {
+                append_text(text, ",null");
+                lv.present[i] = 0;
+                continue;
+            }
+            std::array<int64_t, 3> p = {std::llround(tile_pos_[i].x / q),
+                                        std::llround(tile_pos_[i].y / q),
+                                        std::llround(tile_pos_[i].z / q)};
+            bool absolute = keyframe || !lv.present[i];
+            for (int k = 0; k < 3; k++) {
+                text.push_back(',');
+                append_number(text, absolute ? p[k] : p[k] - lv.last_q[i][k]);
+            }
+            lv.last_q[i] = p;
+            lv.present[i] = 1;
+        }
+        text.push_back(']');
+        text.push_back('\n');
+        if (text.size() >= TILE_WRITE_BYTES) write_tile_text(level, g);
+    }
+}
+
+void ReplayWriter::close_tile(size_t level) {
+    TileLevel& lv = tile_levels_[level];
+    for (size_t g = 0; g < lv.pending.size(); g++) {
+        std::ostringstream index;
+        sim::JsonWriter w(index, sim::JsonWriter::COMPACT);
+        w.begin_object();
+        w.kv("type", "index");
+        w.kv("samples", lv.tile_rows);
+        w.kv("t0", lv.t0);
+        w.kv("t1", lv.t1);
+        w.key("keyframes").begin_array();
+        for (size_t k = 0; k < lv.keyframes.size(); k++) {
+            w.begin_array();
+            w.value(lv.keyframes[k].first);
+            w.value(lv.keyframes[k].second);
+            w.value(static_cast<int64_t>(lv.keyframe_offsets[g][k]));
+            w.end_array();
+        }
+        w.end_array();
+        w.end_object();
+        w.flush();
+        index << '\n';
+        append_text(lv.pending[g], index.str());
+        write_tile_text(level, g);
+    }
+    lv.spans.push_back({lv.t0, lv.t1, static_cast<double>(lv.tile_rows)});
+}
+
+bool ReplayWriter::end_tiles(const MCConfig& config, const MCEntityList& entities) {
+    if (tile_levels_.empty()) return false;
+    for (size_t l = 0; l < tile_levels_.size(); l++) {
+        if (tile_levels_[l].tile >= 0) close_tile(l);
+    }
+    tile_events_->flush();
+    if (!*tile_events_) tiles_ok_ = false;
+    tile_events_.reset();
+
+    std::ofstream f(tiles_dir_ + "/tiles.json");
+    {
+        sim::JsonWriter w(f, sim::JsonWriter::COMPACT);
+        w.begin_object();
+        w.kv("format", "replay_tiles_v1");
+        w.key("config").begin_object();
+        w.kv("seed", config.base_seed);
+        w.kv("duration", config.max_sim_time);
+        w.kv("sampleInterval", config.sample_interval);
+        w.kv("quantum", tile_options_.quantum);
+        w.kv("tileSamples", tile_options_.tile_samples);
+        w.kv("groupSize", tile_options_.group_size);
+        w.kv("keyframeEvery", tile_options_.keyframe_every);
+        w.kv("levelFactor", 4);
+        w.end_object();
+        w.kv("samples", tile_samples_taken_);
+        w.kv("endTime", tile_end_time_);
+        w.kv("groups", tile_levels_[0].pending.size());
+
+        w.key("levels").begin_array();
+        for (size_t l = 0; l < tile_levels_.size(); l++) {
+            const TileLevel& lv = tile_levels_[l];
+            w.begin_object();
+            w.kv("level", l);
+            w.kv("stride", lv.stride);
+            w.key("tiles").begin_array();
+            for (const auto& span : lv.spans) {
+                w.begin_array();
+                w.value(span[0]);
+                w.value(span[1]);
+                w.value(static_cast<int64_t>(span[2]));
+                w.end_array();
+            }
+            w.end_array();
+            w.end_object();
+        }
+        w.end_array();
+
+        w.key("entities").begin_array();
+        for (size_t i = 0; i < entities.size(); i++) {
+            const auto& e = entities[i];
+            w.begin_object();
+            write_entity_meta(w, e);
+            if (e.weapon_type == WeaponType::SAM_BATTERY) {
+                w.kv("maxRange", e.sam_max_range);
+            } else if (e.has_radar) {
+                w.kv("maxRange", e.radar_max_range);
+            }
+            if (death_times_[i] < 0) {
+                w.key("deathTime").null_value();
+            } else {
+                w.kv("deathTime", death_times_[i]);
+            }
+            w.end_object();
+        }
+        w.end_array();
+        w.kv("events", "events.jsonl");
+        w.key("summary");
+        write_summary(w, entities);
+        w.end_object();
+    }
+    f << '\n';
+    if (!f) tiles_ok_ = false;
+
+    tile_levels_.clear();
+    return tiles_ok_;
+}
+
 void ReplayWriter::record_death(const std::string& id, double time) {
     auto it = id_to_index_.find(id);
     if (it != id_to_index_.end()) {
         death_times_[it->second] = time;
+        if (stream_) chunk_deaths_.push_back(it->second);
     }
 }
 
 void ReplayWriter::record_event(const ReplayEvent& evt) {
+    if (tile_events_) {
+        sim::JsonWriter w(*tile_events_, sim::JsonWriter::COMPACT);
+        write_event_json(w, evt);
+        w.flush();
+        *tile_events_ << '\n';
+    }
     events_.push_back(evt);
+    if (evt.type == "KILL") total_kills_++;
+    if (evt.type == "LAUNCH") total_launches_++;
 }
 
 Vec3 ReplayWriter::eci_to_ecef(const Vec3& eci, double sim_time) {
@@ -91,7 +717,7 @@ Vec3 ReplayWriter::eci_to_ecef(const Vec3& eci, double sim_time) {
 }
 
 void ReplayWriter::write_json(std::ostream& out, const MCConfig& config,
-                              const std::vector<MCEntity>& entities) {
+                              const MCEntityList& entities) {
     sim::JsonWriter w(out);
 
     w.begin_object();
@@ -122,17 +748,7 @@ void ReplayWriter::write_json(std::ostream& out, const MCConfig& config,
     for (size_t i = 0; i < entities.size(); i++) {
         const auto& e = entities[i];
         w.begin_object();
-        w.kv("id", e.id);
-        w.kv("name", e.name);
-        w.kv("team", e.team);
-        w.kv("type", e.type);
-
-        const char* role_str = role_to_string(e.role);
-        if (role_str[0] != '\0') {
-            w.kv("role", role_str);
-        } else {
-            w.key("role").null_value();
-        }
+        write_entity_meta(w, e);
 
         if (death_times_[i] < 0) {
             w.key("deathTime").null_value();
@@ -172,30 +788,56 @@ void ReplayWriter::write_json(std::ostream& out, const MCConfig& config,
               });
 
     for (const auto& evt : sorted_events) {
-        w.begin_object();
-        w.kv("time", evt.time);
-        w.kv("type", evt.type);
-        w.kv("sourceId", evt.source_id);
-        w.kv("targetId", evt.target_id);
-        w.key("sourcePosition").begin_array();
-        w.value(evt.source_pos.x);
-        w.value(evt.source_pos.y);
-        w.value(evt.source_pos.z);
-        w.end_array();
-        w.key("targetPosition").begin_array();
-        w.value(evt.target_pos.x);
-        w.value(evt.target_pos.y);
-        w.value(evt.target_pos.z);
-        w.end_array();
-        w.end_object();
+        write_event_json(w, evt);
     }
     w.end_array();
 
     // ── summary ──
-    w.key("summary").begin_object();
+    w.key("summary");
+    write_summary(w, entities);
+
+    w.end_object();
+    out << '\n';
+}
+
+void ReplayWriter::write_entity_meta(sim::JsonWriter& w, const MCEntity& e) {
+    w.kv("id", e.id);
+    w.kv("name", e.name);
+    w.kv("team", e.team);
+    w.kv("type", e.type);
+
+    const char* role_str = role_to_string(e.role);
+    if (role_str[0] != '\0') {
+        w.kv("role", role_str);
+    } else {
+        w.key("role").null_value();
+    }
+}
+
+void ReplayWriter::write_event_json(sim::JsonWriter& w, const ReplayEvent& evt) {
+    w.begin_object();
+    w.kv("time", evt.time);
+    w.kv("type", evt.type);
+    w.kv("sourceId", evt.source_id);
+    w.kv("targetId", evt.target_id);
+    w.key("sourcePosition").begin_array();
+    w.value(evt.source_pos.x);
+    w.value(evt.source_pos.y);
+    w.value(evt.source_pos.z);
+    w.end_array();
+    w.key("targetPosition").begin_array();
+    w.value(evt.target_pos.x);
+    w.value(evt.target_pos.y);
+    w.value(evt.target_pos.z);
+    w.end_array();
+    w.end_object();
+}
+
+void ReplayWriter::write_summary(sim::JsonWriter& w,
+                                 const MCEntityList& entities) const {
+    w.begin_object();
     int blue_alive = 0, blue_total = 0;
     int red_alive = 0, red_total = 0;
-    int total_kills = 0, total_launches = 0;
 
     for (size_t i = 0; i < entities.size(); i++) {
         const auto& e = entities[i];
@@ -211,21 +853,13 @@ void ReplayWriter::write_json(std::ostream& out, const MCConfig& config,
         }
     }
 
-    for (const auto& evt : events_) {
-        if (evt.type == "KILL") total_kills++;
-        if (evt.type == "LAUNCH") total_launches++;
-    }
-
     w.kv("blueAlive", blue_alive);
     w.kv("blueTotal", blue_total);
     w.kv("redAlive", red_alive);
     w.kv("redTotal", red_total);
-    w.kv("totalKills", total_kills);
-    w.kv("totalLaunches", total_launches);
+    w.kv("totalKills", total_kills_);
+    w.kv("totalLaunches", total_launches_);
     w.end_object();
-
-    w.end_object();
-    out << '\n';
 }
 
 } // namespace sim::mc
@@ -6,6 +6,64 @@
  * can load for 3D playback with timeline scrubbing.
  *
  * ECI → ECEF conversion uses GMST rotation (GMST=0 at simTime=0).
+ *
+ * Streaming mode (begin_stream) writes replay_v2 instead: JSON Lines,
+ * flushed every `chunk_samples` samples, so memory stays bounded and a
+ * viewer can start playback while the run is still going:
+ *   { "type": "header", "format": "replay_v2", "config", "entities" }
+ *   { "type": "chunk", "first", "sampleTimes": [...],
+ *     "tracks": [[qx,qy,qz, dx,dy,dz, ...], ...],   // one per entity
+ *     "deaths": [{ "entity", "sample", "time" }], "events": [...] }
+ *   { "type": "end", "endTime", "samples", "summary" }
+ * A track holds the entity's ECEF positions for samples first.. of the
+ * chunk in units of config.quantum metres: an absolute keyframe, then
+ * per-sample deltas. Tracks stop at death instead of repeating the last
+ * position; "sample" is the entity's position count (its death index).
+ *
+ * Adaptive mode (error_bound > 0, config.adaptive) decimates each track:
+ * samples become candidates, and a candidate is kept only when cubic
+ * Hermite interpolation between kept points would miss the candidates in
+ * between by more than error_bound metres (checked at up to 16 evenly
+ * spaced candidates), or max_gap seconds have passed. Kept points carry
+ * their own time and ECEF velocity, so chunks then also hold
+ *   "trackTimes": [[t, ...], ...],
+ *   "trackVelocities": [[qvx,qvy,qvz, dvx,dvy,dvz, ...], ...]
+ * (velocity in config.velocityQuantum m/s, keyframe + deltas) and a
+ * "candidates" count in place of "sampleTimes". A kept point is only
+ * written once a later candidate decides it, so tracks lag slightly.
+ *
+ * Alongside either output, begin_archive() also records every sample
+ * into a TrajectoryArchive (io/trajectory_archive.hpp): ECEF, indexed by
+ * time, so a viewer or tool can read any window without the rest.
+ *
+ * begin_tiles() writes a tiled replay into a directory, for scrubbing and
+ * overviews of long runs: the viewer fetches only the resolution the
+ * current timeline window needs. Level L holds every 4^L-th sample, cut
+ * into tiles of tile_samples level samples; levels are added until one
+ * tile spans the whole run, which makes the last level the overview.
+ * Entities are split into groups of group_size (in entity order), and
+ * each (level, tile, group) is a JSON Lines file <level>/<tile>-<group>.jsonl:
+ *   { "type": "tile", "level", "tile", "group", "firstEntity", "entities",
+ *     "stride", "first", "quantum", "keyframeEvery" }
+ *   [t, qx,qy,qz, qx,qy,qz, null, ...]              // one row per sample
+ *   { "type": "index", "samples", "t0", "t1", "keyframes": [[row, t, offset]] }
+ * A row holds the group's ECEF positions in units of quantum metres, null
+ * where an entity is inactive or destroyed. Positions are deltas from the
+ * entity's previous row, except in keyframe rows (every keyframeEvery
+ * rows, starting with row 0) and on an entity's first row after a null,
+ * which are absolute. The index gives each keyframe row's time and byte
+ * offset in the file, so a reader can decode (or range-fetch) from the
+ * keyframe before any time. "first" is the global index of row 0's sample.
+ * Engagement events go to events.jsonl as they are recorded, and
+ * end_tiles() writes the manifest, tiles.json:
+ *   { "format": "replay_tiles_v1", "config", "samples", "endTime",
+ *     "groups", "levels": [{ "level", "stride", "tiles": [[t0, t1, samples]] }],
+ *     "entities": [{ ..., "deathTime" }], "events": "events.jsonl", "summary" }
+ * Only the open tile of each level is buffered, and rows go out to their
+ * files in 32 KiB pieces.
+ *
+ * Buffered samples are charged to MemoryTag::REPLAY
+ * (utils/memory_accounting.hpp).
  */
 
 #ifndef SIM_MC_REPLAY_WRITER_HPP
@@ -13,8 +71,15 @@
 
 #include "mc_world.hpp"
 #include "scenario_parser.hpp"
+#include "io/json_writer.hpp"
+#include "io/trajectory_archive.hpp"
+#include "utils/memory_accounting.hpp"
+#include <array>
+#include <memory>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <fstream>
 #include <ostream>
 #include <unordered_map>
 
@@ -29,6 +94,13 @@ struct ReplayEvent {
     Vec3 target_pos;        // ECEF at event time
 };
 
+struct ReplayTileOptions {
+    int tile_samples = 256;      // Level samples per tile
+    int group_size = 64;         // Entities per tile file
+    int keyframe_every = 32;     // Rows between absolute rows
+    double quantum = 1.0;        // Position resolution [m]
+};
+
 class ReplayWriter {
 public:
     ReplayWriter() = default;
@@ -37,7 +109,7 @@ public:
      * Initialize with entity list and sample interval.
      * Must be called before any sample() calls.
      */
-    void init(const std::vector<MCEntity>& entities, double sample_interval);
+    void init(const MCEntityList& entities, double sample_interval);
 
     /**
      * Sample all entity positions if sim_time >= next_sample_time.
@@ -46,6 +118,9 @@ public:
      */
     bool sample(const MCWorld& world);
 
+    /** True if sample() would take a sample at this time. */
+    bool due(double sim_time) const { return sim_time >= next_sample_time_; }
+
     /**
      * Record an entity death (for truncating position arrays).
      */
@@ -56,11 +131,51 @@ public:
      */
     void record_event(const ReplayEvent& evt);
 
+    /**
+     * Switch to streaming replay_v2 output on `out` and write the header.
+     * Call after init(), before the first sample(). `quantum` is the
+     * position resolution in metres.
+     */
+    void begin_stream(std::ostream& out, const MCConfig& config,
+                      const MCEntityList& entities,
+                      int chunk_samples, double quantum,
+                      double error_bound = 0.0, double max_gap = 60.0);
+
+    /** Streaming: flush the open chunk and write the end record. */
+    void finish_stream(const MCEntityList& entities);
+
+    /**
+     * Also record every sample (ECEF, entities by id) into a trajectory
+     * archive. Call after init(), before the first sample().
+     * @return true if the archive was created
+     */
+    bool begin_archive(const std::string& filename, const MCEntityList& entities,
+                       const TrajectoryArchiveOptions& options = TrajectoryArchiveOptions());
+
+    /** Finish the archive. @return true if it was written completely */
+    bool end_archive();
+
+    /**
+     * Also write a tiled replay into directory `dir` (created if missing).
+     * Call after init(), before the first sample(); config.max_sim_time
+     * and config.sample_interval set the number of levels.
+     * @return true if the directory and event file could be created
+     */
+    bool begin_tiles(const std::string& dir, const MCConfig& config,
+                     const MCEntityList& entities,
+                     const ReplayTileOptions& options = ReplayTileOptions());
+
+    /**
+     * Close the open tiles and write the manifest.
+     * @return true if every tile and the manifest were written
+     */
+    bool end_tiles(const MCConfig& config, const MCEntityList& entities);
+
     /**
      * Write the complete replay JSON to the output stream.
      */
     void write_json(std::ostream& out, const MCConfig& config,
-                    const std::vector<MCEntity>& entities);
+                    const MCEntityList& entities);
 
     /**
      * Convert ECI position to ECEF using GMST rotation.
@@ -68,13 +183,20 @@ public:
      */
     static Vec3 eci_to_ecef(const Vec3& eci, double sim_time);
 
+    /** Cubic Hermite position at time t between two timed ECEF states. */
+    static Vec3 hermite(double t0, const Vec3& p0, const Vec3& v0,
+                        double t1, const Vec3& p1, const Vec3& v1, double t);
+
 private:
+    template <typename T>
+    using Buffer = std::vector<T, TrackedAllocator<T, MemoryTag::REPLAY>>;
+
     double sample_interval_ = 2.0;
     double next_sample_time_ = 0.0;
-    std::vector<double> sample_times_;
+    Buffer<double> sample_times_;
 
     // Per-entity trajectory: indexed by entity order in the entities vector
-    std::vector<std::vector<Vec3>> positions_;   // ECEF positions
+    std::vector<Buffer<Vec3>> positions_;        // ECEF positions
     std::vector<double> death_times_;            // -1 if alive at end
 
     // Entity ID → index mapping
@@ -82,6 +204,79 @@ private:
 
     // Engagement events
     std::vector<ReplayEvent> events_;
+
+    // Streaming mode: only the open chunk is buffered
+    std::ostream* stream_ = nullptr;
+    int chunk_samples_ = 64;
+    double quantum_ = 1.0;
+    int64_t chunk_first_ = 0;                    // global index of chunk sample 0
+    double end_time_ = 0.0;                      // last flushed sample time
+    std::vector<std::vector<int64_t>> tracks_;   // per entity, open chunk
+    std::vector<std::array<int64_t, 3>> last_q_; // last quantized position
+    std::vector<int64_t> sample_counts_;         // positions written per entity
+    std::vector<uint8_t> ended_;                 // track closed
+    std::vector<size_t> chunk_deaths_;           // entity indices
+
+    // Adaptive decimation: last kept point and undecided candidates
+    struct TrackPoint {
+        double t;
+        Vec3 pos;
+        Vec3 vel;
+    };
+    double error_bound_ = 0.0;                   // 0 = every sample kept
+    double max_gap_ = 60.0;
+    double velocity_quantum_ = 0.01;
+    std::vector<TrackPoint> kept_;
+    std::vector<std::vector<TrackPoint>> pending_;
+    std::vector<std::vector<double>> track_times_;
+    std::vector<std::vector<int64_t>> track_vel_;
+    std::vector<std::array<int64_t, 3>> last_qv_;
+    int total_kills_ = 0;
+    int total_launches_ = 0;
+
+    // Trajectory archive (optional)
+    std::unique_ptr<TrajectoryArchiveWriter> archive_;
+    std::vector<Vec3> archive_pos_;
+    std::vector<uint8_t> archive_valid_;
+
+    // Tiled replay (optional): each level's open tile, rows held per group
+    // until they go out to the group's file
+    struct TileLevel {
+        int64_t stride = 1;                      // Global samples per level sample
+        int64_t rows = 0;                        // Level samples so far
+        int64_t tile = -1;                       // Open tile (-1 = none yet)
+        int64_t tile_rows = 0;                   // Rows in the open tile
+        double t0 = 0.0, t1 = 0.0;               // Open tile's time span
+        std::vector<std::array<double, 3>> spans; // Closed tiles: t0, t1, samples
+        std::vector<std::pair<int64_t, double>> keyframes;  // Open tile: row, time
+        std::vector<Buffer<char>> pending;       // Per group, not yet written
+        std::vector<uint64_t> bytes;             // Per group, written to its file
+        std::vector<std::vector<uint64_t>> keyframe_offsets;  // Per group
+        std::vector<std::array<int64_t, 3>> last_q;  // Per entity
+        std::vector<uint8_t> present;            // Per entity, in the previous row
+    };
+    std::string tiles_dir_;
+    ReplayTileOptions tile_options_;
+    std::vector<TileLevel> tile_levels_;
+    int64_t tile_samples_taken_ = 0;
+    double tile_end_time_ = 0.0;
+    bool tiles_ok_ = true;
+    std::vector<Vec3> tile_pos_;
+    std::vector<uint8_t> tile_valid_;
+    std::unique_ptr<std::ofstream> tile_events_;
+
+    void flush_chunk();
+    void add_tile_row(size_t level, double t);
+    void close_tile(size_t level);
+    void write_tile_text(size_t level, size_t group);
+    std::string tile_path(size_t level, int64_t tile, size_t group) const;
+    void append_position(size_t i, const Vec3& ecef);
+    void offer(size_t i, const TrackPoint& candidate);
+    void keep(size_t i, const TrackPoint& point);
+    void close_track(size_t i);
+    void write_summary(sim::JsonWriter& w, const MCEntityList& entities) const;
+    static void write_entity_meta(sim::JsonWriter& w, const MCEntity& e);
+    static void write_event_json(sim::JsonWriter& w, const ReplayEvent& evt);
 };
 
 } // namespace sim::mc
@@ -1,15 +1,24 @@
 #include "montecarlo/sam_battery.hpp"
 #include "montecarlo/geo_utils.hpp"
+#include "montecarlo/missile_flyout.hpp"
 #include <cmath>
 #include <algorithm>
 
 namespace sim::mc {
 
+// Targets the current battery already engages
+static thread_local EntityMarks engaged;
+
+// A direct ascent whose launch time is further off than this holds in
+// TRACK and looks again halfway to it, since the blended table delay drifts
+// as the pass geometry moves across the grid [s]
+static constexpr double LAUNCH_HOLD = 5.0;
+
 void SAMBattery::update_all(double dt, MCWorld& world) {
-    for (auto& entity : world.entities()) {
-        if (entity.weapon_type != WeaponType::SAM_BATTERY) continue;
-        if (!entity.active || entity.destroyed) continue;
-        update_entity(entity, dt, world);
+    auto& entities = world.entities();
+    for (uint32_t i : world.with_weapon(WeaponType::SAM_BATTERY)) {
+        if (!world.alive(i)) continue;
+        update_entity(entities[i], dt, world);
     }
 }
 
@@ -17,172 +26,235 @@ void SAMBattery::update_entity(MCEntity& e, double dt, MCWorld& world) {
     // Weapons hold — don't engage
     if (e.engagement_rules == "weapons_hold") return;
 
-    double sam_lat_rad = e.geo_lat * M_PI / 180.0;
-    double sam_lon_rad = e.geo_lon * M_PI / 180.0;
+    // Slant ranges from the per-tick frame cache (geodetic fields via ECEF)
+    const uint32_t self = world.index_of(e);
 
     // ── Advance existing engagements through the kill chain ──
-    for (auto it = e.sam_engagements.begin(); it != e.sam_engagements.end(); ) {
-        SAMEngagement& eng = *it;
+    // (finished ones are compacted out in order)
+    auto& engagements = e.sam_engagements;
+    size_t kept = 0;
+    for (size_t k = 0; k < engagements.size(); k++) {
+        SAMEngagement& eng = engagements[k];
+        bool done = false;
 
         eng.phase_timer -= dt;
-        if (eng.phase_timer > 0.0) {
-            ++it;
-            continue;
-        }
-
-        // Phase transition
-        switch (eng.phase) {
+        if (eng.phase_timer <= 0.0) {
+            switch (eng.phase) {
 
-        case 0: {
-            // DETECT → TRACK
-            eng.phase = 1;
-            eng.phase_timer = 2.0;
-            ++it;
-            break;
-        }
-
-        case 1: {
-            // TRACK → ENGAGE
-            MCEntity* target = world.get_entity(eng.target_id);
-            if (!target || !target->active || target->destroyed) {
-                it = e.sam_engagements.erase(it);
+            case 0: {
+                // DETECT → TRACK
+                eng.phase = 1;
+                eng.phase_timer = 2.0;
                 break;
             }
-            if (e.sam_missiles_ready <= 0) {
-                it = e.sam_engagements.erase(it);
+
+            case 1: {
+                // TRACK → ENGAGE
+                MCEntity* target = world.get(eng.target);
+                if (!target || !target->active || target->destroyed) {
+                    done = true;
+                    break;
+                }
+                if (e.sam_missiles_ready <= 0) {
+                    done = true;
+                    break;
+                }
+
+                // Direct ascent on an orbital target: launch at the
+                // table's time, resolve after its time of flight
+                const bool ascent = e.sam_intercept_table &&
+                                    target->physics_type == PhysicsType::ORBITAL_2BODY;
+                double tof = 0.0;
+                if (ascent) {
+                    InterceptLookup x = e.sam_intercept_table->lookup(
+                        intercept_geometry(world, self, eng.target));
+                    if (x.feasibility < InterceptTable::SHOOT_FEASIBILITY) {
+                        done = true;
+                        break;
+                    }
+                    // Each look can only bring the launch forward
+                    double launch_at = world.sim_time + x.launch_delay;
+                    if (eng.launch_at >= 0.0) launch_at = std::min(launch_at, eng.launch_at);
+                    eng.launch_at = launch_at;
+                    const double wait = launch_at - world.sim_time;
+                    if (wait > LAUNCH_HOLD) {
+                        eng.phase_timer = std::max(LAUNCH_HOLD, 0.5 * wait);
+                        break;
+                    }
+                    tof = x.tof;
+                    eng.reach = x.feasibility;
+                } else {
+                    // Compute range to target for TOF
+                    double range = ecef_range(world.geodetic_ecef(self),
+                                              world.geodetic_ecef(eng.target));
+
+                    tof = range / e.sam_missile_speed;
+                    if (e.sam_wez_table && !world.missiles.enabled) {
+                        WEZLookup w = e.sam_wez_table->lookup(
+                            wez_geometry(world, self, eng.target, range));
+                        tof = w.tof;
+                        eng.reach = w.reach;
+                    }
+                }
+
+                // Fire salvo
+                eng.missiles_fired = 0;
+                int to_fire = std::min(e.sam_salvo_size, e.sam_missiles_ready);
+                for (int i = 0; i < to_fire; ++i) {
+                    eng.missiles_fired++;
+                    e.sam_missiles_ready--;
+
+                    // Log LAUNCH
+                    world.log_engagement(e, eng.target, EngagementResult::LAUNCH);
+                }
+
+                eng.phase = 2;
+                eng.phase_timer = tof;
+                if (world.missiles.enabled && !ascent) {
+                    // Guided salvo: poll the body every tick instead
+                    eng.missile = MissileFlyout::launch(world, self, eng.target, true,
+                                                        e.sam_missile_speed, e.sam_max_range,
+                                                        eng.missiles_fired);
+                    eng.phase_timer = 0.0;
+                }
                 break;
             }
 
-            // Compute range to target for TOF
-            double range = slant_range_ecef(
-                sam_lat_rad, sam_lon_rad, e.geo_alt,
-                target->geo_lat * M_PI / 180.0,
-                target->geo_lon * M_PI / 180.0,
-                target->geo_alt);
-
-            double tof = range / e.sam_missile_speed;
-
-            // Fire salvo
-            eng.missiles_fired = 0;
-            int to_fire = std::min(e.sam_salvo_size, e.sam_missiles_ready);
-            for (int i = 0; i < to_fire; ++i) {
-                eng.missiles_fired++;
-                e.sam_missiles_ready--;
-
-                // Log LAUNCH
-                e.engagements.push_back(EngagementRecord{
-                    eng.target_id,
-                    target->name,
-                    "LAUNCH",
-                    world.sim_time
-                });
-            }
+            case 2: {
+                // ENGAGE → ASSESS
+                MCEntity* target = world.get(eng.target);
 
-            eng.phase = 2;
-            eng.phase_timer = tof;
-            ++it;
-            break;
-        }
+                // Fly-out: rounds roll Pk only if the body reached the target
+                int rounds = eng.missiles_fired;
+                if (eng.missile != NO_MISSILE) {
+                    FlyoutStatus status = world.missiles[eng.missile].status;
+                    if (status == FlyoutStatus::FLYING) break;
+                    world.missiles.release(eng.missile);
+                    eng.missile = NO_MISSILE;
+                    if (status != FlyoutStatus::HIT) rounds = 0;
+                }
+
+                bool any_hit = false;
+                for (int i = 0; i < rounds; ++i) {
+                    if (world.rng.bernoulli(e.sam_pk_per_missile * eng.reach, world.index_of(e))) {
+                        any_hit = true;
+                    }
+                }
+
+                if (any_hit && target && target->active && !target->destroyed) {
+                    world.kill(*target);
 
-        case 2: {
-            // ENGAGE → ASSESS
-            MCEntity* target = world.get_entity(eng.target_id);
+                    // Log KILL on SAM
+                    world.log_engagement(e, eng.target, EngagementResult::KILL);
 
-            bool any_hit = false;
-            for (int i = 0; i < eng.missiles_fired; ++i) {
-                if (world.rng.bernoulli(e.sam_pk_per_missile)) {
-                    any_hit = true;
+                } else {
+                    // Log MISS
+                    world.log_engagement(e, eng.target, EngagementResult::MISS);
                 }
+
+                eng.phase = 3;
+                eng.phase_timer = 3.0;  // assess time
+                break;
+            }
+
+            case 3: {
+                // ASSESS complete → remove engagement
+                done = true;
+                break;
             }
 
-            if (any_hit && target && target->active && !target->destroyed) {
-                target->active = false;
-                target->destroyed = true;
-
-                // Log KILL on SAM
-                e.engagements.push_back(EngagementRecord{
-                    eng.target_id,
-                    target ? target->name : eng.target_id,
-                    "KILL",
-                    world.sim_time
-                });
-
-                // Log KILLED_BY on target
-                target->engagements.push_back(EngagementRecord{
-                    e.id,
-                    e.name,
-                    "KILLED_BY",
-                    world.sim_time
-                });
-            } else {
-                // Log MISS
-                e.engagements.push_back(EngagementRecord{
-                    eng.target_id,
-                    target ? target->name : eng.target_id,
-                    "MISS",
-                    world.sim_time
-                });
+            default:
+                done = true;
+                break;
             }
+        }
 
-            eng.phase = 3;
-            eng.phase_timer = 3.0;  // assess time
-            ++it;
-            break;
+        if (!done) {
+            if (kept != k) engagements[kept] = eng;
+            kept++;
         }
+    }
+    engagements.resize(kept);
+
+    // ── Look for new targets from same-team radar detections ──
+    // (unless a sector operations centre assigns them, see IADSCommand)
+    if (world.iads.controls(self)) return;
+
+    const auto& cols = world.columns();
+    const uint16_t my_team = cols.team[world.index_of(e)];
+    engaged.reset(world.entities().size());
+    for (const auto& eng : engagements) engaged.set(eng.target);
+
+    auto engage = [&](EntityHandle h) {
+        // Create new engagement at DETECT phase
+        engagements.push_back(SAMEngagement{
+            h,
+            0,      // phase = DETECT
+            1.0,    // detect time
+            0       // missiles_fired
+        });
+        engaged.set(h);
+    };
 
-        case 3: {
-            // ASSESS complete → remove engagement
-            it = e.sam_engagements.erase(it);
-            break;
+    // Candidate h, ranged at its fused track's prediction when there is one
+    auto consider = [&](EntityHandle h, const RadarTrack* track) {
+        // Already engaging this target?
+        if (engaged.test(h)) return;
+
+        MCEntity* target = world.get(h);
+        if (!target || !target->active || target->destroyed) return;
+
+        // Skip ground/static targets (SAMs shouldn't waste missiles on buildings)
+        if (target->physics_type == PhysicsType::STATIC) return;
+
+        // Orbital targets of a direct-ascent battery: the intercept table
+        // replaces the range gates
+        if (e.sam_intercept_table && target->physics_type == PhysicsType::ORBITAL_2BODY) {
+            if (e.sam_intercept_table->lookup(intercept_geometry(world, self, h)).feasibility <
+                InterceptTable::SHOOT_FEASIBILITY) return;
+            engage(h);
+            return;
         }
+        if (target->geo_alt < 100.0) return;
+
+        // Compute slant range from SAM to target
+        const Vec3 at = track ? track->predict(world.sim_time) : world.geodetic_ecef(h);
+        double range = ecef_range(world.geodetic_ecef(self), at);
+
+        if (range > e.sam_max_range || range < e.sam_min_range) return;
+
+        // Inside the envelope, but out of kinematic reach for this geometry
+        if (e.sam_wez_table &&
+            e.sam_wez_table->lookup(wez_geometry(world, self, h, range)).reach <
+                WEZTable::SHOOT_REACH) return;
 
-        default:
-            it = e.sam_engagements.erase(it);
-            break;
+        engage(h);
+    };
+
+    // Off-board cues need a comm route from the radar to this battery
+    const bool routed = world.comms.enabled;
+    auto cued = [&](EntityHandle radar) {
+        return !routed || radar == self || world.comms.connected(radar, self);
+    };
+
+    // Fused team tracks: one candidate per target, at its predicted position
+    if (world.tracks.enabled) {
+        for (const RadarTrack& t : world.tracks.team(my_team)) {
+            if (!TrackTable::reportable(t, world.sim_time)) continue;
+            if (!cued(t.source)) continue;
+            consider(t.entity, &t);
         }
+        return;
     }
 
-    // ── Look for new targets from same-team radar detections ──
-    for (const auto& radar_entity : world.entities()) {
-        if (!radar_entity.has_radar) continue;
-        if (radar_entity.team != e.team) continue;
-        if (!radar_entity.active || radar_entity.destroyed) continue;
+    for (uint32_t r : world.radars()) {
+        if (cols.team[r] != my_team) continue;
+        if (!cols.alive[r]) continue;
+        if (!cued(r)) continue;
+        const MCEntity& radar_entity = world.entities()[r];
 
         for (const auto& det : radar_entity.radar_detections) {
-            // Already engaging this target?
-            bool already = false;
-            for (const auto& eng : e.sam_engagements) {
-                if (eng.target_id == det.entity_id) {
-                    already = true;
-                    break;
-                }
-            }
-            if (already) continue;
-
-            // Get target entity to check range from THIS SAM
-            MCEntity* target = world.get_entity(det.entity_id);
-            if (!target || !target->active || target->destroyed) continue;
-
-            // Skip ground/static targets (SAMs shouldn't waste missiles on buildings)
-            if (target->physics_type == PhysicsType::STATIC) continue;
-            if (target->geo_alt < 100.0) continue;
-
-            // Compute slant range from SAM to target
-            double range = slant_range_ecef(
-                sam_lat_rad, sam_lon_rad, e.geo_alt,
-                target->geo_lat * M_PI / 180.0,
-                target->geo_lon * M_PI / 180.0,
-                target->geo_alt);
-
-            if (range > e.sam_max_range || range < e.sam_min_range) continue;
-
-            // Create new engagement at DETECT phase
-            e.sam_engagements.push_back(SAMEngagement{
-                det.entity_id,
-                0,      // phase = DETECT
-                1.0,    // detect time
-                0       // missiles_fired
-            });
+            consider(det.entity, nullptr);
         }
     }
 }
@@ -0,0 +1,272 @@
+#include "montecarlo/scenario_cache.hpp"
+#include "montecarlo/scenario_parser.hpp"
+#include "io/checkpoint_binary.hpp"
+#include "io/json_writer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <type_traits>
+
+namespace sim::mc {
+
+namespace {
+
+// ── Entity records ──
+
+struct RecordWriter {
+    std::string& out;
+
+    template <typename T>
+    void operator()(const T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "scalar field");
+        out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+    void operator()(const std::string& s) {
+        (*this)(static_cast<uint32_t>(s.size()));
+        out.append(s);
+    }
+    void operator()(const std::vector<std::string>& v) {
+        (*this)(static_cast<uint32_t>(v.size()));
+        for (const auto& s : v) (*this)(s);
+    }
+    void operator()(const std::vector<Waypoint>& v) {
+        (*this)(static_cast<uint32_t>(v.size()));
+        out.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(Waypoint));
+    }
+};
+
+struct RecordReader {
+    const char* p;
+    const char* end;
+    bool ok = true;
+
+    bool take(void* dst, size_t bytes) {
+        if (!ok || static_cast<size_t>(end - p) < bytes) return ok = false;
+        std::memcpy(dst, p, bytes);
+        p += bytes;
+        return true;
+    }
+    template <typename T>
+    void operator()(T& v) {
+        static_assert(std::is_trivially_copyable<T>::value, "scalar field");
+        take(&v, sizeof(T));
+    }
+    void operator()(std::string& s) {
+        uint32_t n = 0;
+        if (!take(&n, sizeof(n)) || static_cast<size_t>(end - p) < n) { ok = false; return; }
+        s.assign(p, n);
+        p += n;
+    }
+    void operator()(std::vector<std::string>& v) {
+        uint32_t n = 0;
+        if (!take(&n, sizeof(n)) || static_cast<size_t>(end - p) < n * sizeof(uint32_t)) {
+            ok = false;
+            return;
+        }
+        v.resize(n);
+        for (auto& s : v) (*this)(s);
+    }
+    void operator()(std::vector<Waypoint>& v) {
+        uint32_t n = 0;
+        if (!take(&n, sizeof(n)) || static_cast<size_t>(end - p) < n * sizeof(Waypoint)) {
+            ok = false;
+            return;
+        }
+        v.resize(n);
+        take(v.data(), n * sizeof(Waypoint));
+    }
+};
+
+/**
+ * Every MCEntity field a parse can set, in record order. Runtime state and
+ * entity handles are left out; a field added to MCEntity that the parser
+ * fills must be added here (and VERSION bumped).
+ */
+template <typename IO, typename E>
+void transfer(IO& io, E& e) {
+    io(e.id); io(e.name); io(e.type); io(e.team);
+    io(e.active); io(e.destroyed);
+    io(e.physics_type); io(e.ai_type); io(e.weapon_type);
+    io(e.eci_pos); io(e.eci_vel);
+    io(e.sma); io(e.ecc); io(e.inc_rad); io(e.raan_rad); io(e.arg_pe_rad);
+    io(e.mean_anomaly_rad); io(e.orbit_dirty);
+    io(e.geo_lat); io(e.geo_lon); io(e.geo_alt);
+    io(e.flight_speed); io(e.flight_heading); io(e.flight_gamma); io(e.flight_roll);
+    io(e.flight_alpha); io(e.flight_mach); io(e.flight_throttle); io(e.flight_engine_on);
+    io(e.ac_mass); io(e.ac_wing_area); io(e.ac_ar); io(e.ac_cd0); io(e.ac_oswald);
+    io(e.ac_cl_alpha); io(e.ac_cl_max); io(e.ac_thrust_mil); io(e.ac_thrust_ab);
+    io(e.ac_max_g); io(e.ac_max_aoa_rad);
+    io(e.waypoints); io(e.waypoint_index); io(e.waypoint_loop);
+    io(e.intercept_target_id); io(e.intercept_mode); io(e.intercept_engage_range);
+    io(e.intercept_state);
+    io(e.has_radar); io(e.radar_max_range); io(e.radar_fov_deg); io(e.radar_min_elev_deg);
+    io(e.radar_max_elev_deg); io(e.radar_sweep_interval); io(e.radar_sweep_timer);
+    io(e.radar_p_detect);
+    io(e.sam_max_range); io(e.sam_min_range); io(e.sam_missile_speed);
+    io(e.sam_missiles_ready); io(e.sam_salvo_size); io(e.sam_pk_per_missile);
+    io(e.a2a_loadout); io(e.a2a_inventory); io(e.a2a_lock_time);
+    io(e.engagement_rules);
+    io(e.has_physics); io(e.has_ai); io(e.has_weapon);
+    io(e.role); io(e.sensor_range); io(e.defense_radius); io(e.max_accel);
+    io(e.kill_range); io(e.scan_interval); io(e.scan_timer); io(e.assigned_hva_id);
+    io(e.pk); io(e.weapon_kill_range); io(e.cooldown_time); io(e.cooldown_timer);
+}
+
+// ── Extras: JsonValue back to compact JSON ──
+
+void write_value(sim::JsonWriter& w, const sim::JsonValue& v) {
+    switch (v.type) {
+        case sim::JsonType::NIL:    w.null_value(); break;
+        case sim::JsonType::BOOL:   w.value(v.as_bool()); break;
+        case sim::JsonType::NUMBER: w.value(v.as_number()); break;
+        case sim::JsonType::STRING: w.value(v.as_string()); break;
+        case sim::JsonType::ARRAY:
+            w.begin_array();
+            for (const auto& e : v.as_array()) write_value(w, e);
+            w.end_array();
+            break;
+        case sim::JsonType::OBJECT:
+            w.begin_object();
+            for (const auto& [k, e] : v.as_object()) {
+                w.key(std::string(k));
+                write_value(w, e);
+            }
+            w.end_object();
+            break;
+    }
+}
+
+// Whole file in one read; false if it cannot be opened
+bool read_file(const std::string& path, std::string& out) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    struct stat st;
+    bool ok = ::fstat(::fileno(f), &st) == 0;
+    if (ok) {
+        out.resize(static_cast<size_t>(st.st_size));
+        ok = std::fread(&out[0], 1, out.size(), f) == out.size();
+    }
+    std::fclose(f);
+    return ok;
+}
+
+uint32_t header_crc(scache::Header h) {
+    h.header_crc = 0;
+    return sim::ckpt::crc32(&h, sizeof(h));
+}
+
+} // anonymous namespace
+
+uint64_t ScenarioCache::content_hash(std::string_view text) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string ScenarioCache::path_for(uint64_t hash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mcsc", static_cast<unsigned long long>(hash));
+    return dir_.empty() ? std::string(name) : dir_ + "/" + name;
+}
+
+bool ScenarioCache::store(uint64_t hash, size_t source_bytes, const MCWorld& world,
+                          const sim::JsonValue& scenario) const {
+    std::string payload;
+    RecordWriter out{payload};
+    for (const auto& e : world.entities()) transfer(out, e);
+
+    std::ostringstream extras;
+    {
+        sim::JsonWriter w(extras, sim::JsonWriter::COMPACT);
+        w.set_precision(0);   // Shortest round-trip form
+        w.begin_object();
+        for (const auto& [k, v] : scenario.as_object()) {
+            if (k == "entities") continue;
+            w.key(std::string(k));
+            write_value(w, v);
+        }
+        w.end_object();
+    }
+    std::string extras_text = extras.str();
+    payload += extras_text;
+
+    scache::Header h{};
+    std::memcpy(h.magic, scache::MAGIC, 4);
+    h.version = scache::VERSION;
+    h.source_hash = hash;
+    h.source_bytes = source_bytes;
+    h.num_entities = static_cast<uint32_t>(world.entities().size());
+    h.extras_bytes = static_cast<uint32_t>(extras_text.size());
+    h.payload_bytes = payload.size();
+    h.payload_crc = sim::ckpt::crc32(payload.data(), payload.size());
+    h.header_crc = header_crc(h);
+
+    if (!dir_.empty()) ::mkdir(dir_.c_str(), 0755);
+    std::string file = path_for(hash);
+    std::string tmp = file + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), file.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ScenarioCache::load(uint64_t hash, MCWorld& world, sim::JsonValue& scenario) const {
+    std::string data;
+    if (!read_file(path_for(hash), data) || data.size() < sizeof(scache::Header)) return false;
+
+    scache::Header h;
+    std::memcpy(&h, data.data(), sizeof(h));
+    if (std::memcmp(h.magic, scache::MAGIC, 4) != 0 || h.version != scache::VERSION ||
+        h.source_hash != hash || h.header_crc != header_crc(h) ||
+        h.payload_bytes != data.size() - sizeof(h) || h.extras_bytes > h.payload_bytes) {
+        return false;
+    }
+    const char* payload = data.data() + sizeof(h);
+    if (sim::ckpt::crc32(payload, h.payload_bytes) != h.payload_crc) return false;
+
+    RecordReader in_records{payload, payload + (h.payload_bytes - h.extras_bytes)};
+    MCEntityList entities(h.num_entities);
+    for (auto& e : entities) transfer(in_records, e);
+    if (!in_records.ok || in_records.p != in_records.end) return false;
+
+    try {
+        scenario = sim::JsonReader::parse(std::string(in_records.end, h.extras_bytes));
+    } catch (const std::exception&) {
+        return false;
+    }
+    world = ScenarioParser::assemble(std::move(entities), scenario);
+    return true;
+}
+
+LoadedScenario ScenarioCache::load_file(const std::string& path, int num_threads) const {
+    std::string text;
+    if (!read_file(path, text)) throw std::runtime_error("Cannot open scenario file: " + path);
+
+    LoadedScenario s;
+    s.hash = content_hash(text);
+    if (load(s.hash, s.world, s.scenario)) {
+        s.from_cache = true;
+        return s;
+    }
+
+    size_t bytes = text.size();
+    s.scenario = sim::JsonReader::parse(std::move(text));
+    s.world = ScenarioParser::parse(s.scenario, num_threads);
+    if (s.scenario["entities"].is_array() && s.scenario["entities"].size() > 0) {
+        store(s.hash, bytes, s.world, s.scenario);
+    }
+    return s;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,113 @@
+/**
+ * ScenarioCache — Parsed scenarios on disk, keyed by content hash.
+ *
+ * Saves the parse-time state of a scenario's entities in a compact binary
+ * record per entity, plus the scenario's other top-level fields (events,
+ * termination, uncertainties, ...) as compact JSON, so a scenario seen
+ * before is rebuilt without parsing its entity definitions. Files are
+ * "<dir>/<hash>.mcsc", the hash being content_hash() of the scenario text
+ * (the daemon's prototype key), so mc_engine and the daemon share one
+ * directory.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header    scache::Header (64 bytes, CRC-32 over itself and the payload)
+ *   entities  num_entities records; strings and vectors as u32 count then
+ *             the elements, scalars as their bytes (transfer() order)
+ *   extras    extras_bytes of JSON: the top-level object without "entities"
+ *
+ * Runtime state (timers, engagements, detections) is not stored: it is at
+ * its defaults after a parse. Handles between entities are resolved again
+ * when the world is assembled.
+ *
+ * Usage:
+ *   ScenarioCache cache("/tmp/mc_cache");
+ *   LoadedScenario s = cache.load_file("arena.json");
+ *   runner.run(s.world);                 // s.from_cache on a hit
+ */
+
+#ifndef SIM_MC_SCENARIO_CACHE_HPP
+#define SIM_MC_SCENARIO_CACHE_HPP
+
+#include "mc_world.hpp"
+#include "io/json_reader.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sim::mc {
+
+namespace scache {
+
+constexpr char MAGIC[4] = {'M', 'C', 'S', 'C'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint64_t source_hash;     // content hash of the scenario text
+    uint64_t source_bytes;
+    uint32_t num_entities;
+    uint32_t extras_bytes;
+    uint64_t payload_bytes;   // Bytes after the header
+    uint32_t payload_crc;     // CRC-32 of the payload
+    uint32_t header_crc;      // CRC-32 of the header with this field zero
+    uint32_t reserved[4];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "scenario cache header layout");
+
+} // namespace scache
+
+/** A scenario ready to run, however it was obtained */
+struct LoadedScenario {
+    MCWorld world;
+    sim::JsonValue scenario;   // Top-level fields (without "entities" on a cache hit)
+    uint64_t hash = 0;         // Content hash of the scenario text
+    bool from_cache = false;
+};
+
+class ScenarioCache {
+public:
+    /** @param dir Cache directory (created on first store) */
+    explicit ScenarioCache(std::string dir) : dir_(std::move(dir)) {}
+
+    const std::string& dir() const { return dir_; }
+
+    /** 64-bit FNV-1a of a byte string */
+    static uint64_t content_hash(std::string_view text);
+
+    /** Cache file of a content hash */
+    std::string path_for(uint64_t hash) const;
+
+    /**
+     * Rebuild a cached scenario.
+     * @param world    Out: assembled world
+     * @param scenario Out: top-level fields other than "entities"
+     * @return false if not cached or the file is invalid
+     */
+    bool load(uint64_t hash, MCWorld& world, sim::JsonValue& scenario) const;
+
+    /**
+     * Store a parsed scenario under its content hash.
+     * @param world    ScenarioParser::parse() of scenario
+     * @return true on success
+     */
+    bool store(uint64_t hash, size_t source_bytes, const MCWorld& world,
+               const sim::JsonValue& scenario) const;
+
+    /**
+     * Read a scenario file: rebuilt from the cache when it holds the
+     * file's content hash, otherwise parsed (on num_threads) and stored.
+     * @throws std::runtime_error on file or parse errors
+     */
+    LoadedScenario load_file(const std::string& path, int num_threads = 1) const;
+
+private:
+    std::string dir_;
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_SCENARIO_CACHE_HPP
@@ -2,24 +2,85 @@
 #include "montecarlo/kepler_propagator.hpp"
 #include "montecarlo/aircraft_configs.hpp"
 #include "montecarlo/geo_utils.hpp"
+#include "montecarlo/event_system.hpp"
+#include "montecarlo/scenario_schema.hpp"
+#include "io/json_stream.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 
 namespace sim::mc {
 
-MCWorld ScenarioParser::parse(const sim::JsonValue& scenario) {
-    MCWorld world;
-
+MCWorld ScenarioParser::parse(const sim::JsonValue& scenario, int num_threads) {
     // Parse entities array
     const auto& entities = scenario["entities"];
-    if (!entities.is_array()) return world;
+    if (!entities.is_array()) return MCWorld();
+
+    // Definitions are independent: parse them in chunks across threads,
+    // then add them in scenario order
+    MCEntityList parsed(entities.size());
+    auto defs = entities.as_array();
+    size_t chunks = (parsed.size() + PARSE_CHUNK - 1) / PARSE_CHUNK;
+    auto parse_chunk = [&](size_t c) {
+        size_t end = std::min(parsed.size(), (c + 1) * PARSE_CHUNK);
+        for (size_t i = c * PARSE_CHUNK; i < end; i++) parsed[i] = parse_entity(defs[i]);
+    };
+    if (num_threads != 1 && chunks > 1) {
+        sim::ThreadPool pool(num_threads);
+        pool.parallel_for(chunks, parse_chunk);
+    } else {
+        for (size_t c = 0; c < chunks; c++) parse_chunk(c);
+    }
+
+    return assemble(std::move(parsed), scenario);
+}
+
+MCWorld ScenarioParser::assemble(MCEntityList&& entities, const sim::JsonValue& scenario) {
+    MCWorld world;
+    for (auto& ent : entities) world.add_entity(std::move(ent));
+    finish(world, scenario["events"], scenario["termination"]);
+    parse_comms(world, scenario["networks"], scenario["jammers"]);
+    parse_iads(world, scenario["iads"]);
+    return world;
+}
+
+MCWorld ScenarioParser::parse_file(const std::string& path) {
+    MCWorld world;
 
-    for (size_t i = 0; i < entities.size(); i++) {
-        MCEntity ent = parse_entity(entities[i]);
-        world.add_entity(std::move(ent));
+    // Entities are parsed as their elements stream past; events,
+    // termination, comm networks and IADS sectors are small and captured
+    // whole
+    sim::JsonRootStreamer root;
+    root.stream_array("entities", [&world](const sim::JsonValue& def, size_t) {
+        world.add_entity(parse_entity(def));
+    });
+    sim::JsonStreamReader::parse_file(path, root);
+    if (!root.streamed("entities")) return MCWorld();
+
+    finish(world, root["events"], root["termination"]);
+    parse_comms(world, root["networks"], root["jammers"]);
+    parse_iads(world, root["iads"]);
+    return world;
+}
+
+void ScenarioParser::finish(MCWorld& world, const sim::JsonValue& events,
+                            const sim::JsonValue& termination) {
+    // Resolve cross-entity references to dense handles; size the missile
+    // pool for every round carried
+    for (auto& ent : world.entities()) {
+        ent.intercept_target = world.find_handle(ent.intercept_target_id);
+        ent.assigned_hva = world.find_handle(ent.assigned_hva_id);
+        if (ent.weapon_type == WeaponType::SAM_BATTERY) {
+            world.missiles.capacity += static_cast<size_t>(std::max(ent.sam_missiles_ready, 0));
+        } else if (ent.weapon_type == WeaponType::A2A_MISSILE) {
+            for (int rounds : ent.a2a_inventory) {
+                world.missiles.capacity += static_cast<size_t>(std::max(rounds, 0));
+            }
+        }
     }
 
     // Parse events array
-    const auto& events = scenario["events"];
     if (events.is_array()) {
         for (size_t i = 0; i < events.size(); i++) {
             const auto& ev = events[i];
@@ -72,14 +133,368 @@ MCWorld ScenarioParser::parse(const sim::JsonValue& scenario) {
                     act["value"].get_string(""));
             }
 
+            se.trigger.entity_a_h = world.find_handle(se.trigger.entity_a);
+            se.trigger.entity_b_h = world.find_handle(se.trigger.entity_b);
+            se.trigger.sensor_h   = world.find_handle(se.trigger.sensor_entity);
+            se.trigger.target_h   = world.find_handle(se.trigger.target_entity);
+            se.action.entity      = world.find_handle(se.action.entity_id);
+
             world.events.push_back(std::move(se));
         }
     }
+    EventSystem::compile(world);
+
+    // Parse termination conditions
+    if (termination.is_array()) {
+        for (size_t i = 0; i < termination.size(); i++) {
+            const auto& tc = termination[i];
+            TerminationCondition cond;
+            cond.type = tc["type"].get_string("");
+
+            if (cond.type == "time") {
+                cond.time = tc["time"].get_number(0.0);
+
+            } else if (cond.type == "entityDown") {
+                cond.entity = world.find_handle(tc["entityId"].get_string(
+                    tc["entity"].get_string("")));
+
+            } else if (cond.type == "teamEliminated") {
+                cond.team = world.find_team_id(tc["team"].get_string(""));
+                const auto& groups = tc["groups"];
+                if (groups.is_array()) {
+                    for (size_t g = 0; g < groups.size(); g++) {
+                        std::string name = groups[g].get_string("");
+                        if (name == "hva") {
+                            cond.group_mask |= 1u << static_cast<int>(CombatGroup::ORBITAL_HVA);
+                        } else if (name == "combat") {
+                            cond.group_mask |= 1u << static_cast<int>(CombatGroup::ORBITAL_COMBAT);
+                        } else if (name == "aircraft") {
+                            cond.group_mask |= 1u << static_cast<int>(CombatGroup::AIRCRAFT);
+                        }
+                    }
+                } else {
+                    cond.group_mask = (1u << NUM_COMBAT_GROUPS) - 1;
+                }
+            } else {
+                continue;
+            }
+            world.termination.push_back(std::move(cond));
+        }
+    }
+}
 
-    return world;
+void ScenarioParser::parse_comms(MCWorld& world, const sim::JsonValue& networks,
+                                 const sim::JsonValue& jammers) {
+    if (!networks.is_array()) return;
+    CommNet& net = world.comms;
+
+    for (size_t n = 0; n < networks.size(); n++) {
+        const auto& def = networks[n];
+        const auto& cfg = def["config"];
+
+        // RF config in CommEngine's field names, or the builder's MHz ones
+        CommLink proto;
+        const std::string kind = cfg["linkType"].get_string("rf");
+        proto.kind = kind == "laser" ? LinkKind::LASER
+                   : kind == "fiber" ? LinkKind::FIBER : LinkKind::RF;
+        proto.max_range = cfg["maxRange_m"].get_number(0.0);
+        proto.freq_hz = cfg["frequency_ghz"].get_number(
+            cfg["frequency_mhz"].get_number(2400.0) / 1000.0) * 1e9;
+        proto.bandwidth_hz = cfg["bandwidth_mbps"].get_number(cfg["bandwidth_mhz"].get_number(
+            cfg["dataRate_mbps"].get_number(100.0))) * 1e6;
+        proto.eirp_dbw = cfg["power_dbw"].get_number(cfg["txPower_dbw"].get_number(10.0)) +
+                         cfg["antenna_gain_dbi"].get_number(20.0);
+        proto.rx_gain_dbi = cfg["rx_antenna_gain_dbi"].get_number(0.0);
+        proto.rx_sensitivity_dbm = cfg["receiver_sensitivity_dbm"].get_number(-100.0);
+
+        // Encryption processing latency (AES128 / AES256 / Type1; true = AES256)
+        std::string enc = cfg["encryption"].get_bool(false) ? "AES256"
+                        : cfg["encryption"].get_string("none");
+        std::transform(enc.begin(), enc.end(), enc.begin(), ::toupper);
+        proto.latency_ms = cfg["latency_ms"].get_number(5.0) +
+                           (enc == "AES128" ? 2.0 : enc == "AES256" ? 5.0 : enc == "TYPE1" ? 10.0 : 0.0);
+
+        auto link = [&](const std::string& a, const std::string& b) {
+            EntityHandle ha = world.find_handle(a), hb = world.find_handle(b);
+            if (ha == NO_ENTITY || hb == NO_ENTITY) return;
+            CommLink l = proto;
+            l.node_a = net.add_node(ha);
+            l.node_b = net.add_node(hb);
+            net.add_link(l);
+        };
+
+        // Topology as CommEngine._buildLinkGraph; the first network to link
+        // a pair keeps it
+        const auto& members = def["members"];
+        std::vector<std::string> ids;
+        for (size_t m = 0; members.is_array() && m < members.size(); m++) {
+            ids.push_back(members[m].get_string(""));
+        }
+        const std::string type = def["type"].get_string("mesh");
+        if (type == "star") {
+            const std::string hub = def["hub"].get_string(ids.empty() ? "" : ids[0]);
+            for (const auto& id : ids) {
+                if (id != hub) link(hub, id);
+            }
+        } else if (type == "multihop") {
+            const auto& path = def["path"];
+            std::vector<std::string> hops = ids;
+            if (path.is_array()) {
+                hops.clear();
+                for (size_t m = 0; m < path.size(); m++) hops.push_back(path[m].get_string(""));
+            }
+            for (size_t m = 0; m + 1 < hops.size(); m++) link(hops[m], hops[m + 1]);
+        } else if (type == "custom") {
+            const auto& defs = def["links"];
+            for (size_t k = 0; defs.is_array() && k < defs.size(); k++) {
+                link(defs[k]["from"].get_string(""), defs[k]["to"].get_string(""));
+            }
+        } else {
+            for (size_t i = 0; i < ids.size(); i++) {
+                for (size_t j = i + 1; j < ids.size(); j++) link(ids[i], ids[j]);
+            }
+        }
+    }
+
+    // Jammers as CommEngine.addJammer configs
+    for (size_t k = 0; jammers.is_array() && k < jammers.size(); k++) {
+        const auto& def = jammers[k];
+        CommJammer j;
+        j.entity = world.find_handle(def["entityId"].get_string(def["id"].get_string("")));
+        if (j.entity == NO_ENTITY || !def["active"].get_bool(true)) continue;
+        j.power_dbw = def["power_dbw"].get_number(j.power_dbw);
+        j.range = def["range_m"].get_number(j.range);
+        const double f = def["targetFreq_ghz"].get_number(12.5) * 1e9;
+        const double bw = def["bandwidth_ghz"].get_number(0.5) * 1e9;
+        j.freq_lo_hz = f - 0.5 * bw;
+        j.freq_hi_hz = f + 0.5 * bw;
+        net.add_jammer(j);
+    }
+
+    // Route trees toward every networked shooter
+    for (EntityHandle h = 0; h < world.entities().size(); h++) {
+        if (world.entities()[h].weapon_type != WeaponType::NONE) net.add_root(h);
+    }
+    net.finalize();
 }
 
-static void apply_aircraft_config(MCEntity& ent, const std::string& config_name) {
+void ScenarioParser::parse_iads(MCWorld& world, const sim::JsonValue& iads) {
+    IADSState& state = world.iads;
+    const auto& team = world.columns().team;
+    const IndexList& sams = world.with_weapon(WeaponType::SAM_BATTERY);
+
+    // Listed entities, or every SAM battery / radar of the team
+    auto members = [&](const sim::JsonValue& ids, const IndexList& all, uint16_t t,
+                       std::vector<EntityHandle>& out) {
+        if (!ids.is_array()) {
+            for (uint32_t h : all) {
+                if (team[h] == t) out.push_back(h);
+            }
+            return;
+        }
+        for (size_t k = 0; k < ids.size(); k++) {
+            EntityHandle h = world.find_handle(ids[k].get_string(""));
+            if (h != NO_ENTITY) out.push_back(h);
+        }
+    };
+
+    if (iads.is_array()) {
+        for (size_t k = 0; k < iads.size(); k++) {
+            const auto& def = iads[k];
+            IADSSector sector;
+            sector.id = def["id"].get_string("sector_" + std::to_string(k));
+            sector.soc = world.find_handle(def["soc"].get_string(""));
+            if (sector.soc == NO_ENTITY) continue;
+            sector.team = team[sector.soc];
+            sector.decision_interval = std::max(def["decisionInterval"].get_number(2.0), 1e-3);
+            sector.fire_channels = static_cast<int>(def["fireChannels"].get_number(4.0));
+            members(def["batteries"], sams, sector.team, sector.batteries);
+            members(def["radars"], world.radars(), sector.team, sector.radars);
+            state.sectors.push_back(std::move(sector));
+        }
+    } else {
+        for (uint32_t h : sams) {
+            bool seen = false;
+            for (const auto& sector : state.sectors) seen = seen || sector.team == team[h];
+            if (seen) continue;
+            IADSSector sector;
+            sector.id = world.entities()[h].team;
+            sector.team = team[h];
+            for (uint32_t b : sams) {
+                if (team[b] == sector.team) sector.batteries.push_back(b);
+            }
+            for (uint32_t r : world.radars()) {
+                if (team[r] == sector.team) sector.radars.push_back(r);
+            }
+            state.sectors.push_back(std::move(sector));
+        }
+    }
+
+    // Phase-spread first decisions; mark the commanded batteries
+    state.controlled.assign(world.entities().size(), 0);
+    for (size_t k = 0; k < state.sectors.size(); k++) {
+        IADSSector& sector = state.sectors[k];
+        sector.timer = sector.decision_interval * static_cast<double>(k) /
+                       static_cast<double>(state.sectors.size());
+        for (EntityHandle b : sector.batteries) {
+            if (world.entities()[b].weapon_type == WeaponType::SAM_BATTERY) state.controlled[b] = 1;
+        }
+    }
+}
+
+namespace {
+
+using EntitySchema = FieldSchema<MCEntity>;
+
+// Component "type" strings to discriminators
+template <typename E>
+struct TypeName {
+    std::string_view name;
+    E value;
+};
+
+template <typename E, size_t N>
+E lookup_type(const TypeName<E> (&table)[N], std::string_view name, E fallback) {
+    for (const auto& t : table) {
+        if (t.name == name) return t.value;
+    }
+    return fallback;
+}
+
+constexpr TypeName<PhysicsType> PHYSICS_TYPES[] = {
+    {"orbital_2body", PhysicsType::ORBITAL_2BODY},
+    {"flight3dof",    PhysicsType::FLIGHT_3DOF},
+};
+
+constexpr TypeName<AIType> AI_TYPES[] = {
+    {"orbital_combat",  AIType::ORBITAL_COMBAT},
+    {"waypoint_patrol", AIType::WAYPOINT_PATROL},
+    {"intercept",       AIType::INTERCEPT},
+};
+
+constexpr TypeName<WeaponType> WEAPON_TYPES[] = {
+    {"kinetic_kill",    WeaponType::KINETIC_KILL},
+    {"sam_battery",     WeaponType::SAM_BATTERY},
+    {"fighter_loadout", WeaponType::A2A_MISSILE},
+    {"a2a_missile",     WeaponType::A2A_MISSILE},
+};
+
+/**
+ * String member of obj as a view into the document; unescaped into
+ * scratch when it has escape sequences. def when absent or not a string.
+ */
+std::string_view string_field(const sim::JsonValue& obj, std::string_view key,
+                              std::string& scratch, std::string_view def = {}) {
+    sim::JsonValue v = obj[key];
+    if (!v.is_string()) return def;
+    if (v.string_is_raw()) return v.string_view();
+    scratch = v.as_string();
+    return scratch;
+}
+
+// Orbital elements of an orbital_2body "elements" source (angles in degrees)
+struct OrbitDef {
+    double sma = 42164000.0;
+    double ecc = 0.0001;
+    double inc = 0.001;
+    double raan = 0.0;
+    double arg_perigee = 0.0;
+    double mean_anomaly = 0.0;
+};
+
+const FieldSchema<OrbitDef>& orbit_schema() {
+    using S = FieldSchema<OrbitDef>;
+    static const S schema = {
+        S::number("sma", &OrbitDef::sma),
+        S::number("ecc", &OrbitDef::ecc),
+        S::number("inc", &OrbitDef::inc),
+        S::number("raan", &OrbitDef::raan),
+        S::number("argPerigee", &OrbitDef::arg_perigee),
+        S::number("meanAnomaly", &OrbitDef::mean_anomaly),
+    };
+    return schema;
+}
+
+const FieldSchema<Waypoint>& waypoint_schema() {
+    using S = FieldSchema<Waypoint>;
+    static const S schema = {
+        S::number("lat", &Waypoint::lat),
+        S::number("lon", &Waypoint::lon),
+        S::number("alt", &Waypoint::alt),
+        S::number("speed", &Waypoint::speed),
+    };
+    return schema;
+}
+
+const EntitySchema& initial_state_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("lat", &MCEntity::geo_lat),
+        EntitySchema::number("lon", &MCEntity::geo_lon),
+        EntitySchema::number("alt", &MCEntity::geo_alt),
+        EntitySchema::number("speed", &MCEntity::flight_speed),
+        EntitySchema::degrees("heading", &MCEntity::flight_heading),
+        EntitySchema::degrees("gamma", &MCEntity::flight_gamma),
+        EntitySchema::number("throttle", &MCEntity::flight_throttle),
+        EntitySchema::boolean("engineOn", &MCEntity::flight_engine_on),
+    };
+    return schema;
+}
+
+const EntitySchema& orbital_combat_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("sensorRange", &MCEntity::sensor_range),
+        EntitySchema::number("defenseRadius", &MCEntity::defense_radius),
+        EntitySchema::number("maxAccel", &MCEntity::max_accel),
+        EntitySchema::number("killRange", &MCEntity::kill_range),
+        EntitySchema::number("scanInterval", &MCEntity::scan_interval),
+    };
+    return schema;
+}
+
+const EntitySchema& intercept_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("engageRange", &MCEntity::intercept_engage_range),
+        EntitySchema::number("engageRange_m", &MCEntity::intercept_engage_range),
+    };
+    return schema;
+}
+
+const EntitySchema& radar_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("maxRange", &MCEntity::radar_max_range),
+        EntitySchema::number("maxRange_m", &MCEntity::radar_max_range),
+        EntitySchema::number("fov_deg", &MCEntity::radar_fov_deg),
+        EntitySchema::number("detectionProbability", &MCEntity::radar_p_detect),
+        EntitySchema::number("minElevation_deg", &MCEntity::radar_min_elev_deg),
+        EntitySchema::number("maxElevation_deg", &MCEntity::radar_max_elev_deg),
+    };
+    return schema;
+}
+
+const EntitySchema& kinetic_kill_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("Pk", &MCEntity::pk),
+        EntitySchema::number("killRange", &MCEntity::weapon_kill_range),
+        EntitySchema::number("cooldown", &MCEntity::cooldown_time),
+    };
+    return schema;
+}
+
+const EntitySchema& sam_battery_schema() {
+    static const EntitySchema schema = {
+        EntitySchema::number("maxRange", &MCEntity::sam_max_range),
+        EntitySchema::number("maxRange_m", &MCEntity::sam_max_range),
+        EntitySchema::number("minRange", &MCEntity::sam_min_range),
+        EntitySchema::number("minRange_m", &MCEntity::sam_min_range),
+        EntitySchema::number("missileSpeed", &MCEntity::sam_missile_speed),
+        EntitySchema::integer("missiles", &MCEntity::sam_missiles_ready),
+        EntitySchema::integer("salvoSize", &MCEntity::sam_salvo_size),
+        EntitySchema::number("pkPerMissile", &MCEntity::sam_pk_per_missile),
+    };
+    return schema;
+}
+
+void apply_aircraft_config(MCEntity& ent, const std::string& config_name) {
     const auto& cfg = get_aircraft_config(config_name);
     ent.ac_mass       = cfg.mass_loaded;
     ent.ac_wing_area  = cfg.wing_area;
@@ -95,58 +510,48 @@ static void apply_aircraft_config(MCEntity& ent, const std::string& config_name)
     ent.ac_max_aoa_rad = cfg.max_aoa_rad;
 }
 
+} // anonymous namespace
+
 MCEntity ScenarioParser::parse_entity(const sim::JsonValue& def) {
     MCEntity ent;
+    std::string scratch;
 
     // ── Identity ──
     ent.id   = def["id"].get_string("");
     ent.name = def["name"].get_string(ent.id);
     ent.type = def["type"].get_string("satellite");
     ent.team = def["team"].get_string("");
+    ent.active = def["active"].get_bool(true);   // false: held back until a set_state event
 
     // ── Initial State (for atmospheric / ground entities) ──
-    const auto& state = def["initialState"];
-    if (!state.is_null()) {
-        ent.geo_lat       = state["lat"].get_number(0.0);
-        ent.geo_lon       = state["lon"].get_number(0.0);
-        ent.geo_alt       = state["alt"].get_number(0.0);
-        ent.flight_speed   = state["speed"].get_number(0.0);
-        ent.flight_heading = state["heading"].get_number(0.0) * M_PI / 180.0; // deg→rad
-        ent.flight_gamma   = state["gamma"].get_number(0.0) * M_PI / 180.0;
-        ent.flight_throttle = state["throttle"].get_number(0.8);
-        ent.flight_engine_on = state["engineOn"].get_bool(true);
-    }
+    initial_state_schema().apply(def["initialState"], ent);
 
     // ── Components ──
-    const auto& components = def["components"];
+    const auto components = def["components"];
 
     // ── Physics ──
-    if (components.has("physics")) {
-        const auto& phys = components["physics"];
-        std::string phys_type = phys["type"].get_string("");
+    const auto phys = components["physics"];
+    if (phys.is_object()) {
+        PhysicsType phys_type = lookup_type(PHYSICS_TYPES, string_field(phys, "type", scratch),
+                                            PhysicsType::NONE);
 
-        if (phys_type == "orbital_2body") {
+        if (phys_type == PhysicsType::ORBITAL_2BODY) {
             ent.physics_type = PhysicsType::ORBITAL_2BODY;
             ent.has_physics = true;
 
-            std::string source = phys["source"].get_string("elements");
-            if (source == "elements") {
-                double sma    = phys["sma"].get_number(42164000.0);
-                double ecc    = phys["ecc"].get_number(0.0001);
-                double inc    = phys["inc"].get_number(0.001);
-                double raan   = phys["raan"].get_number(0.0);
-                double argpe  = phys["argPerigee"].get_number(0.0);
-                double ma     = phys["meanAnomaly"].get_number(0.0);
-                init_from_elements(ent, sma, ecc, inc, raan, argpe, ma);
+            if (string_field(phys, "source", scratch, "elements") == "elements") {
+                OrbitDef orbit;
+                orbit_schema().apply(phys, orbit);
+                init_from_elements(ent, orbit.sma, orbit.ecc, orbit.inc, orbit.raan,
+                                   orbit.arg_perigee, orbit.mean_anomaly);
             }
 
-        } else if (phys_type == "flight3dof") {
+        } else if (phys_type == PhysicsType::FLIGHT_3DOF) {
             ent.physics_type = PhysicsType::FLIGHT_3DOF;
             ent.has_physics = true;
 
             // Apply aircraft config
-            std::string config_name = phys["config"].get_string("f16");
-            apply_aircraft_config(ent, config_name);
+            apply_aircraft_config(ent, std::string(string_field(phys, "config", scratch, "f16")));
         }
     }
 
@@ -158,69 +563,58 @@ MCEntity ScenarioParser::parse_entity(const sim::JsonValue& def) {
     }
 
     // ── AI ──
-    if (components.has("ai")) {
-        const auto& ai = components["ai"];
-        std::string ai_type = ai["type"].get_string("");
+    const auto ai = components["ai"];
+    if (ai.is_object()) {
+        AIType ai_type = lookup_type(AI_TYPES, string_field(ai, "type", scratch), AIType::NONE);
 
-        if (ai_type == "orbital_combat") {
+        if (ai_type == AIType::ORBITAL_COMBAT) {
             ent.ai_type = AIType::ORBITAL_COMBAT;
             ent.has_ai = true;
 
-            std::string role_str = ai["role"].get_string("attacker");
-            ent.role = string_to_role(role_str);
-
-            ent.sensor_range   = ai["sensorRange"].get_number(1000000.0);
-            ent.defense_radius = ai["defenseRadius"].get_number(500000.0);
-            ent.max_accel      = ai["maxAccel"].get_number(50.0);
-            ent.kill_range     = ai["killRange"].get_number(50000.0);
-            ent.scan_interval  = ai["scanInterval"].get_number(1.0);
+            ent.role = string_to_role(std::string(string_field(ai, "role", scratch, "attacker")));
+            orbital_combat_schema().apply(ai, ent);
 
             if (ai.has("assignedHvaId")) {
                 ent.assigned_hva_id = ai["assignedHvaId"].get_string("");
             }
 
-        } else if (ai_type == "waypoint_patrol") {
+        } else if (ai_type == AIType::WAYPOINT_PATROL) {
             ent.ai_type = AIType::WAYPOINT_PATROL;
             ent.has_ai = true;
 
             // Parse waypoints array
-            const auto& wps = ai["waypoints"];
+            const auto wps = ai["waypoints"];
             if (wps.is_array()) {
-                for (size_t i = 0; i < wps.size(); i++) {
+                ent.waypoints.reserve(wps.size());
+                for (const auto& w : wps.as_array()) {
                     Waypoint wp;
-                    wp.lat   = wps[i]["lat"].get_number(0.0);
-                    wp.lon   = wps[i]["lon"].get_number(0.0);
-                    wp.alt   = wps[i]["alt"].get_number(0.0);
-                    wp.speed = wps[i]["speed"].get_number(0.0);
+                    waypoint_schema().apply(w, wp);
                     ent.waypoints.push_back(wp);
                 }
             }
 
-            std::string loop = ai["loopMode"].get_string("cycle");
+            std::string_view loop = string_field(ai, "loopMode", scratch, "cycle");
             ent.waypoint_loop = (loop == "cycle" || loop == "loop");
 
-        } else if (ai_type == "intercept") {
+        } else if (ai_type == AIType::INTERCEPT) {
             ent.ai_type = AIType::INTERCEPT;
             ent.has_ai = true;
 
             ent.intercept_target_id = ai["targetId"].get_string("");
 
-            std::string mode = ai["mode"].get_string("pursuit");
+            std::string_view mode = string_field(ai, "mode", scratch, "pursuit");
             if (mode == "pursuit")   ent.intercept_mode = 0;
             else if (mode == "lead") ent.intercept_mode = 1;
             else if (mode == "stern") ent.intercept_mode = 2;
 
-            ent.intercept_engage_range = ai["engageRange_m"].get_number(
-                ai["engageRange"].get_number(0.0));
+            intercept_schema().apply(ai, ent);
         }
     }
 
     // ── Control: player_input → auto-assign waypoint_patrol AI ──
-    if (components.has("control")) {
-        const auto& ctrl = components["control"];
-        std::string ctrl_type = ctrl["type"].get_string("");
-
-        if (ctrl_type == "player_input" && ent.ai_type == AIType::NONE) {
+    const auto ctrl = components["control"];
+    if (ctrl.is_object()) {
+        if (string_field(ctrl, "type", scratch) == "player_input" && ent.ai_type == AIType::NONE) {
             // Auto-assign waypoint patrol: racetrack orbit pattern
             ent.ai_type = AIType::WAYPOINT_PATROL;
             ent.has_ai = true;
@@ -261,18 +655,11 @@ MCEntity ScenarioParser::parse_entity(const sim::JsonValue& def) {
     }
 
     // ── Sensors ──
-    if (components.has("sensors")) {
-        const auto& sens = components["sensors"];
-        std::string sens_type = sens["type"].get_string("");
-
-        if (sens_type == "radar") {
+    const auto sens = components["sensors"];
+    if (sens.is_object()) {
+        if (string_field(sens, "type", scratch) == "radar") {
             ent.has_radar = true;
-            ent.radar_max_range     = sens["maxRange_m"].get_number(
-                sens["maxRange"].get_number(300000.0));
-            ent.radar_fov_deg       = sens["fov_deg"].get_number(360.0);
-            ent.radar_p_detect      = sens["detectionProbability"].get_number(0.9);
-            ent.radar_min_elev_deg  = sens["minElevation_deg"].get_number(-5.0);
-            ent.radar_max_elev_deg  = sens["maxElevation_deg"].get_number(80.0);
+            radar_schema().apply(sens, ent);
 
             // Convert scan rate to interval (if provided)
             double scan_rate = sens["scanRate_dps"].get_number(0.0);
@@ -283,47 +670,41 @@ MCEntity ScenarioParser::parse_entity(const sim::JsonValue& def) {
     }
 
     // ── Weapons ──
-    if (components.has("weapons")) {
-        const auto& wpn = components["weapons"];
-        std::string wpn_type = wpn["type"].get_string("");
+    const auto wpn = components["weapons"];
+    if (wpn.is_object()) {
+        WeaponType wpn_type = lookup_type(WEAPON_TYPES, string_field(wpn, "type", scratch),
+                                          WeaponType::NONE);
 
-        if (wpn_type == "kinetic_kill") {
+        if (wpn_type == WeaponType::KINETIC_KILL) {
             ent.weapon_type = WeaponType::KINETIC_KILL;
             ent.has_weapon = true;
-            ent.pk               = wpn["Pk"].get_number(0.7);
-            ent.weapon_kill_range = wpn["killRange"].get_number(50000.0);
-            ent.cooldown_time    = wpn["cooldown"].get_number(5.0);
+            kinetic_kill_schema().apply(wpn, ent);
 
-        } else if (wpn_type == "sam_battery") {
+        } else if (wpn_type == WeaponType::SAM_BATTERY) {
             ent.weapon_type = WeaponType::SAM_BATTERY;
             ent.has_weapon = true;
-            ent.sam_max_range     = wpn["maxRange_m"].get_number(
-                wpn["maxRange"].get_number(150000.0));
-            ent.sam_min_range     = wpn["minRange_m"].get_number(
-                wpn["minRange"].get_number(5000.0));
-            ent.sam_missile_speed = wpn["missileSpeed"].get_number(1200.0);
-            ent.sam_missiles_ready = wpn["missiles"].get_int(8);
-            ent.sam_salvo_size    = wpn["salvoSize"].get_int(2);
-            ent.sam_pk_per_missile = wpn["pkPerMissile"].get_number(0.7);
+            sam_battery_schema().apply(wpn, ent);
+            ent.sam_wez = std::string(string_field(wpn, "wez", scratch));
 
             // Engagement rules from weapons component
-            std::string rules = wpn["engagementRules"].get_string("");
+            std::string_view rules = string_field(wpn, "engagementRules", scratch);
             if (!rules.empty()) {
-                ent.engagement_rules = rules;
+                ent.engagement_rules = std::string(rules);
             }
 
-        } else if (wpn_type == "fighter_loadout" || wpn_type == "a2a_missile") {
+        } else if (wpn_type == WeaponType::A2A_MISSILE) {
             ent.weapon_type = WeaponType::A2A_MISSILE;
             ent.has_weapon = true;
 
             // Parse loadout array
-            const auto& loadout = wpn["loadout"];
+            const auto loadout = wpn["loadout"];
             if (loadout.is_array()) {
-                for (size_t i = 0; i < loadout.size(); i++) {
-                    std::string weapon_name = loadout[i].get_string("");
+                for (const auto& item : loadout.as_array()) {
+                    std::string weapon_name = item.get_string("");
                     if (!weapon_name.empty()) {
                         ent.a2a_loadout.push_back(weapon_name);
-                        ent.a2a_inventory[weapon_name]++;
+                        ent.a2a_inventory[static_cast<size_t>(
+                            string_to_a2a_weapon(weapon_name))]++;
                     }
                 }
             }
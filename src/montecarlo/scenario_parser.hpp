@@ -3,6 +3,11 @@
  *
  * Reads the same JSON format produced by the browser scenario builder.
  * Handles orbital_2body physics, orbital_combat AI, and kinetic_kill weapons.
+ *
+ * Flat numeric fields are read through FieldSchema tables (one merge pass
+ * over each component's sorted members, see scenario_schema.hpp), and
+ * component type strings through small name tables. Parsed scenarios can
+ * be kept on disk by ScenarioCache (scenario_cache.hpp).
  */
 
 #ifndef SIM_MC_SCENARIO_PARSER_HPP
@@ -10,39 +15,266 @@
 
 #include "mc_world.hpp"
 #include "io/json_reader.hpp"
+#include "utils/thread_pool.hpp"
 #include <string>
+#include <vector>
 
 namespace sim::mc {
 
 struct MCConfig {
     int num_runs = 100;
     int base_seed = 42;
+    // Index of this batch's first run: a shard of a larger batch runs
+    // first_run .. first_run + num_runs - 1 and so keeps that batch's
+    // seeds, antithetic pairing and LHS strata (see mc_shard.hpp)
+    int first_run = 0;
     double max_sim_time = 600.0;
     double dt = 0.1;                // matches JS HEADLESS_DT
     std::string scenario_path;
     std::string output_path;        // empty = stdout
+    std::string output_format = "json";  // batch: "json", "binary" (.mcrb),
+                                         // "aggregate" (summary only) or
+                                         // "store" (indexed .mcrs)
     bool verbose = false;
 
     // Replay mode: single run with trajectory sampling
     bool replay_mode = false;
     double sample_interval = 2.0;   // seconds between position samples
+    // Streaming replay_v2 (see ReplayWriter): chunk length in samples and
+    // position quantum in metres
+    bool replay_stream = false;
+    int replay_chunk = 64;
+    double replay_quantum = 1.0;
+    // Adaptive replay: keep a sample only where Hermite interpolation from
+    // the kept ones would be off by more than replay_error m (0 = off;
+    // implies replay_stream), and at least every replay_max_gap s
+    double replay_error = 0.0;
+    double replay_max_gap = 60.0;
+    // Replay: also write a time-indexed trajectory archive here (empty = off)
+    std::string replay_archive;
+    // Replay: also write a tiled, multi-resolution replay into this
+    // directory (empty = off; implies replay_stream), with tiles of
+    // replay_tile_samples samples and replay_tile_group entities per file
+    std::string replay_tiles;
+    int replay_tile_samples = 256;
+    int replay_tile_group = 64;
+
+    // Parsed scenarios kept on disk by content hash (ScenarioCache, shared
+    // by mc_engine and --serve; empty = off)
+    std::string scenario_cache;
 
     // Progress reporting: JSON-Lines to stderr for server consumption
     bool progress = false;
+    // Batch: with progress, aggregate snapshot lines every N runs and/or
+    // every S seconds of wall time (AggregateSnapshots; 0 = off)
+    int snapshot_every = 0;
+    double snapshot_interval = 0.0;
+
+    // Batch parallelism: worker threads for independent runs (0 = all cores)
+    int num_threads = 1;
+    // Their NUMA grouping and CPU pinning (--numa, --pin-threads)
+    sim::ThreadPlacement placement;
+
+    // Coast orbits on cached elements (KeplerBatch) instead of the JS-parity
+    // element round-trip each tick; agrees to solver tolerance, not bitwise
+    bool cached_kepler = false;
+
+    // Multi-rate: passive orbital entities (no combat AI, or HVAs) coast up
+    // to this many seconds between updates and are caught up exactly when a
+    // scan, sweep, weapon or event reads them; 0 = every tick. Needs the
+    // closed-form lanes, so it implies cached_kepler.
+    double coast_dt = 0.0;
+
+    // Lockstep: each worker advances this many consecutive runs of one
+    // prototype tick by tick, with their orbits in one interleaved
+    // KeplerBatch ([entity][run]). Implies cached_kepler (results match it
+    // bit for bit); ignored when coast_dt > 0. 1 = one run at a time.
+    int lockstep = 1;
+
+    // Snapshot-and-branch: the batch simulates once up to the first branch
+    // point, snapshots the world, and forks from it, level by level, with a
+    // fresh RNG stream per branch. branch_times are the branch points [s],
+    // increasing; with branch_on_first_draw the first point is instead the
+    // first tick that draws a random number, and branch_times lists only
+    // the later ones. branch_fanout[k] is the number of children of each
+    // snapshot at point k (one entry per point but the last; the last
+    // point's snapshots share the num_runs runs in turn). No points = off.
+    // Lockstep is not used while branching.
+    std::vector<double> branch_times;
+    std::vector<int> branch_fanout;
+    bool branch_on_first_draw = false;
+
+    // Aircraft through Flight3DOF::update_batch: SoA lanes and a tabulated
+    // atmosphere; agrees to table tolerance (~1e-7 in density), not bitwise
+    bool batch_flight = false;
+
+    // Aircraft integrate by Heun (RK2) and split a step into sub-steps
+    // while turning hard or at high dynamic pressure (see Flight3DOF), so
+    // a coarse dt stays usable; takes precedence over batch_flight. Not
+    // bitwise
+    bool flight_rk2 = false;
+
+    // SAM and A2A shots fly as pooled, PN-guided bodies (MissileFlyout)
+    // and hit only on closest approach inside the fuze radius, instead
+    // of resolving after range / speed seconds
+    bool missile_flyout = false;
+
+    // Kinetic kills and proximity triggers test each interval's closest
+    // approach (cubic Hermite between the checks' relative states) instead
+    // of the range at its end, so a fast pass cannot tunnel through a tick;
+    // kills are stamped at closest approach. Not bitwise
+    bool swept_contact = false;
+
+    // Weapon engagement zone tables (see wez_table.hpp): a directory of
+    // .wez files. A2A weapons and SAM batteries with a table also hold
+    // fire inside their range where its reach is below
+    // WEZTable::SHOOT_REACH, resolve after the tabulated time of flight,
+    // and scale Pk by the reach. Empty = off; not bitwise
+    std::string wez_dir;
+
+    // Aircraft level of detail: outside every hostile sensor / weapon
+    // envelope (plus a closing margin) an aircraft takes one Flight3DOF
+    // step every lod_dt seconds, and is caught up and stepped every tick
+    // again once it nears one. Error estimates land in RunResult::lod.
+    // 0 = off.
+    double lod_dt = 0.0;
+
+    // Shared ephemeris (see SharedEphemeris): entities whose motion no
+    // random draw can change (orbits with no combat AI or HVAs, aircraft
+    // with no AI or on waypoint patrol) are propagated once per prototype
+    // into a read-only table every run replays; one leaves it for live
+    // propagation when a burn or a viewer first moves it. The table holds
+    // at most ephemeris_mb; entities past it stay live. Not used with
+    // coast_dt, branching or a run setup (LHS); aircraft stay live with
+    // lod_dt. Bitwise except with cached_kepler, whose Newton iterations
+    // are shared by the lanes of a batch.
+    bool shared_ephemeris = false;
+    double ephemeris_mb = 256.0;
+
+    // Intra-run parallelism (see TickGraph): one world's tick runs as a
+    // graph of systems on a pool of tick_threads, per-entity systems (AI,
+    // Kepler, Flight3DOF) in chunks, independent ones side by side. Meant
+    // for one large world (--replay, --live); concurrent batch runs tick
+    // serially. Bitwise. 1 = off.
+    int tick_threads = 1;
+
+    // Reduced-rate AI decisions (see DecisionSchedule): each AI type
+    // re-plans once per its declared period (OrbitalCombatAI, InterceptAI,
+    // WaypointPatrolAI::DECISION_PERIOD, or ai_decision_dt for all when
+    // > 0), entities phase-offset across the period's ticks, and only
+    // continues its last command in between; not bitwise
+    bool ai_decisions = false;
+    double ai_decision_dt = 0.0;
+
+    // RadarSensor's geometric kernel: dot-product elevation, field-of-view
+    // and Earth-occlusion gates on precomputed sensor frames instead of the
+    // JS engine's geodetic elevation angle; not bitwise
+    bool radar_los = false;
+
+    // Radar track fusion (see TrackTable): detections feed per-team
+    // alpha-beta tracks each tick, and SAM batteries pick targets from
+    // their team's confirmed tracks instead of every friendly radar's
+    // detection list; not bitwise
+    bool radar_tracks = false;
+
+    // Scenario comm networks (see comm_network.hpp): link budgets and
+    // routes kept per tick, and SAM batteries cue only from radars with a
+    // route to them; not bitwise
+    bool comms = false;
+
+    // IADS command (see iads_command.hpp): sector operations centres
+    // assign threats to SAM batteries as one assignment problem per
+    // decision cycle instead of each battery engaging all it sees; not
+    // bitwise
+    bool iads = false;
+
+    // Convergence early stop: when ci_half_width > 0, num_runs is a cap and
+    // the batch ends after the first block of ci_block runs at which every
+    // metric's 95% interval half-width is <= ci_half_width
+    // (see ConvergenceMonitor for metric specs; empty = HVA survival)
+    double ci_half_width = 0.0;
+    std::vector<std::string> ci_metrics;
+    int ci_block = 100;
+
+    // Random draws: the JS-compatible mulberry32 stream, or counter-based
+    // Philox streams addressed per entity (see SimRNG)
+    RNGMode rng_mode = RNGMode::MULBERRY32;
+
+    // Variance reduction: antithetic seed pairs (runs 2k, 2k+1), and Latin-
+    // hypercube stratification over the scenario's "uncertainties"
+    bool antithetic = false;
+    bool lhs = false;
+
+    // Resumable batches (see BatchCheckpoint): the completed run prefix is
+    // written to checkpoint_path every checkpoint_interval s, and with
+    // resume a batch restarts after the runs recorded there (empty = off)
+    std::string checkpoint_path;
+    double checkpoint_interval = 60.0;
+    bool resume = false;
+
+    // Per-system tick profile: Chrome trace written here, summary to
+    // stderr (empty = off; see TickProfiler)
+    std::string profile_path;
+
+    // Per-run budgets: a run that takes more than run_step_budget ticks or
+    // run_wall_budget seconds of wall time (checked every
+    // MCRunner::WALL_CHECK_TICKS ticks) stops there and reports its partial
+    // state with a "Run budget: ..." error. The step budget is
+    // deterministic, the wall budget is not. 0 = none.
+    int run_step_budget = 0;
+    double run_wall_budget = 0.0;
+
+    // Tail report: the batch's tail_runs slowest runs by wall time, with
+    // their per-system time (see TailReport), written to tail_report_path
+    // (0 / empty = off)
+    int tail_runs = 0;
+    std::string tail_report_path;
 };
 
 class ScenarioParser {
 public:
     /**
      * Parse a scenario JSON value and build a fresh MCWorld.
-     * Called once per MC run to get a clean initial state.
+     * MCRunner calls this once per batch and copies the result per run.
+     * @param num_threads Entity definitions are parsed in chunks on this
+     *                    many threads (0 = all cores); the world is the same
+     */
+    static MCWorld parse(const sim::JsonValue& scenario, int num_threads = 1);
+
+    /**
+     * Parse a scenario file without building its document: entity
+     * definitions are streamed one at a time (JsonRootStreamer), so memory
+     * stays bounded by the largest entity. Same result as
+     * parse(JsonReader::parse_file(path)).
+     * @throws std::runtime_error on file or parse errors
      */
-    static MCWorld parse(const sim::JsonValue& scenario);
+    static MCWorld parse_file(const std::string& path);
 
     /**
      * Parse a single entity definition from the scenario JSON.
      */
     static MCEntity parse_entity(const sim::JsonValue& entity_def);
+
+    /**
+     * Build a world from parsed entities (in scenario order) and the
+     * scenario's "events", "termination", "networks", "jammers" and
+     * "iads" (ScenarioCache restores).
+     */
+    static MCWorld assemble(MCEntityList&& entities, const sim::JsonValue& scenario);
+
+private:
+    static constexpr size_t PARSE_CHUNK = 256;   // Entity definitions per parallel task
+
+    // Cross-entity references, missile pool, events and termination
+    static void finish(MCWorld& world, const sim::JsonValue& events,
+                       const sim::JsonValue& termination);
+
+    // Comm network links (CommDesigner "networks") and noise jammers
+    static void parse_comms(MCWorld& world, const sim::JsonValue& networks,
+                            const sim::JsonValue& jammers);
+
+    // IADS sectors ("iads"), or one per team with SAM batteries
+    static void parse_iads(MCWorld& world, const sim::JsonValue& iads);
 };
 
 } // namespace sim::mc
@@ -0,0 +1,456 @@
+#include "montecarlo/scenario_patch.hpp"
+#include "io/json_writer.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sim::mc {
+
+namespace {
+
+using Node = ScenarioDocument::Node;
+
+// ═══════════════════════════════════════════════════════════════
+// Document elements
+// ═══════════════════════════════════════════════════════════════
+
+bool is_container(const Node& n) {
+    return n.expanded || n.source.is_object() || n.source.is_array();
+}
+
+/** Turn a view into members or items, each a view of its own. */
+void expand(Node& n) {
+    if (n.expanded) return;
+    n.expanded = true;
+    n.is_object = n.source.is_object();
+    if (n.is_object) {
+        for (const auto& [k, v] : n.source.as_object()) {
+            n.members.emplace_back(std::string(k), Node(v));
+        }
+    } else {
+        for (const auto& v : n.source.as_array()) n.items.emplace_back(v);
+    }
+    n.source = sim::JsonValue();
+}
+
+Node* member(Node& n, const std::string& key) {
+    for (auto& [k, m] : n.members) {
+        if (k == key) return &m;
+    }
+    return nullptr;
+}
+
+const Node* member(const Node& n, const std::string& key) {
+    for (const auto& [k, m] : n.members) {
+        if (k == key) return &m;
+    }
+    return nullptr;
+}
+
+void write_value(sim::JsonWriter& w, const sim::JsonValue& v) {
+    switch (v.type) {
+        case sim::JsonType::NIL:    w.null_value(); break;
+        case sim::JsonType::BOOL:   w.value(v.as_bool()); break;
+        case sim::JsonType::NUMBER: w.value(v.as_number()); break;
+        case sim::JsonType::STRING: w.value(v.as_string()); break;
+        case sim::JsonType::ARRAY:
+            w.begin_array();
+            for (const auto& e : v.as_array()) write_value(w, e);
+            w.end_array();
+            break;
+        case sim::JsonType::OBJECT:
+            w.begin_object();
+            for (const auto& [k, e] : v.as_object()) {
+                w.key(std::string(k));
+                write_value(w, e);
+            }
+            w.end_object();
+            break;
+    }
+}
+
+void write_node(sim::JsonWriter& w, const Node& n) {
+    if (!n.expanded) {
+        write_value(w, n.source);
+    } else if (n.is_object) {
+        w.begin_object();
+        for (const auto& [k, m] : n.members) {
+            w.key(k);
+            write_node(w, m);
+        }
+        w.end_object();
+    } else {
+        w.begin_array();
+        for (const auto& item : n.items) write_node(w, item);
+        w.end_array();
+    }
+}
+
+/** Compact JSON with shortest round-trip numbers. */
+template <typename Fn>
+std::string compact(Fn&& write) {
+    std::ostringstream os;
+    sim::JsonWriter w(os, sim::JsonWriter::COMPACT);
+    w.set_precision(0);
+    write(w);
+    w.flush();
+    return os.str();
+}
+
+/** The element as a JSON value; an expanded one is written out and read back. */
+sim::JsonValue value_of(const Node& n) {
+    if (!n.expanded) return n.source;
+    return sim::JsonReader::parse(compact([&](sim::JsonWriter& w) { write_node(w, n); }));
+}
+
+/** True if the string `id` appears anywhere in `v`. */
+bool mentions_value(const sim::JsonValue& v, const std::string& id) {
+    switch (v.type) {
+        case sim::JsonType::STRING: return v.as_string() == id;
+        case sim::JsonType::ARRAY:
+            for (const auto& e : v.as_array()) {
+                if (mentions_value(e, id)) return true;
+            }
+            return false;
+        case sim::JsonType::OBJECT:
+            for (const auto& [k, e] : v.as_object()) {
+                if (mentions_value(e, id)) return true;
+            }
+            return false;
+        default: return false;
+    }
+}
+
+bool mentions_node(const Node& n, const std::string& id) {
+    if (!n.expanded) return mentions_value(n.source, id);
+    for (const auto& [k, m] : n.members) {
+        if (mentions_node(m, id)) return true;
+    }
+    for (const auto& item : n.items) {
+        if (mentions_node(item, id)) return true;
+    }
+    return false;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Patch ops
+// ═══════════════════════════════════════════════════════════════
+
+/** JSON pointer reference tokens ("" = the whole document). */
+std::vector<std::string> split_pointer(const std::string& path) {
+    std::vector<std::string> tokens;
+    if (path.empty()) return tokens;
+    if (path[0] != '/') throw std::invalid_argument("patch path must start with '/': " + path);
+    size_t start = 1;
+    while (true) {
+        size_t end = path.find('/', start);
+        std::string raw = path.substr(start, end == std::string::npos ? std::string::npos
+                                                                        : end - start);
+        std::string token;
+        for (size_t i = 0; i < raw.size(); i++) {
+            if (raw[i] == '~' && i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1')) {
+                token += raw[i + 1] == '0' ? '~' : '/';
+                i++;
+            } else if (raw[i] == '~') {
+                throw std::invalid_argument("bad '~' escape in patch path: " + path);
+            } else {
+                token += raw[i];
+            }
+        }
+        tokens.push_back(std::move(token));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    return tokens;
+}
+
+/** Array index token; `size` is allowed only where an add may append. */
+size_t array_index(const std::string& token, size_t size, bool append, const std::string& path) {
+    if (append && token == "-") return size;
+    bool digits = !token.empty() && token.size() <= 9 && (token == "0" || token[0] != '0');
+    for (char c : token) digits = digits && c >= '0' && c <= '9';
+    size_t index = digits ? std::stoul(token) : size + 1;
+    if (index > size || (!append && index == size)) {
+        throw std::invalid_argument("patch path index out of range: " + path);
+    }
+    return index;
+}
+
+enum class Op { ADD, REMOVE, REPLACE };
+
+/**
+ * Apply one op to the document; returns the array index the last token
+ * resolved to (0 for an object member).
+ * @throws std::invalid_argument if the path does not resolve
+ */
+size_t apply_op(Node& root, Op op, const std::vector<std::string>& tokens,
+                const sim::JsonValue& value, const std::string& path) {
+    if (tokens.empty()) {
+        if (op == Op::REMOVE) throw std::invalid_argument("cannot remove the whole scenario");
+        root = Node(value);
+        return 0;
+    }
+
+    Node* parent = &root;
+    for (size_t t = 0; t + 1 < tokens.size(); t++) {
+        if (!is_container(*parent)) {
+            throw std::invalid_argument("patch path does not resolve: " + path);
+        }
+        expand(*parent);
+        if (parent->is_object) {
+            parent = member(*parent, tokens[t]);
+            if (!parent) throw std::invalid_argument("patch path does not resolve: " + path);
+        } else {
+            parent = &parent->items[array_index(tokens[t], parent->items.size(), false, path)];
+        }
+    }
+    if (!is_container(*parent)) {
+        throw std::invalid_argument("patch path does not resolve: " + path);
+    }
+    expand(*parent);
+
+    const std::string& last = tokens.back();
+    if (parent->is_object) {
+        auto& members = parent->members;
+        auto it = members.begin();
+        while (it != members.end() && it->first != last) ++it;
+        if (it == members.end()) {
+            if (op != Op::ADD) throw std::invalid_argument("patch path does not resolve: " + path);
+            members.emplace_back(last, Node(value));
+        } else if (op == Op::REMOVE) {
+            members.erase(it);
+        } else {
+            it->second = Node(value);
+        }
+        return 0;
+    }
+
+    auto& items = parent->items;
+    size_t i = array_index(last, items.size(), op == Op::ADD, path);
+    if (op == Op::ADD) {
+        items.insert(items.begin() + static_cast<std::ptrdiff_t>(i), Node(value));
+    } else if (op == Op::REMOVE) {
+        items.erase(items.begin() + static_cast<std::ptrdiff_t>(i));
+    } else {
+        items[i] = Node(value);
+    }
+    return i;
+}
+
+/** Fields that place an entity in the world's index lists and columns. */
+bool same_indexing(const MCEntity& a, const MCEntity& b) {
+    return a.id == b.id && a.team == b.team && a.role == b.role &&
+           a.physics_type == b.physics_type && a.ai_type == b.ai_type &&
+           a.weapon_type == b.weapon_type && a.has_ai == b.has_ai &&
+           a.has_weapon == b.has_weapon && a.has_radar == b.has_radar &&
+           a.sam_wez == b.sam_wez;   // The leaves' WEZ table pointer stays valid
+}
+
+bool dormant(const MCEntity& e) { return !e.active && !e.destroyed; }
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// ScenarioDocument
+// ═══════════════════════════════════════════════════════════════
+
+size_t ScenarioDocument::entity_count() const {
+    if (!root_.expanded) {
+        const sim::JsonValue defs = root_.source["entities"];
+        return defs.is_array() ? defs.size() : 0;
+    }
+    const Node* defs = member(root_, "entities");
+    if (!defs) return 0;
+    if (!defs->expanded) return defs->source.is_array() ? defs->source.size() : 0;
+    return defs->is_object ? 0 : defs->items.size();
+}
+
+sim::JsonValue ScenarioDocument::entity(size_t i) const {
+    if (!root_.expanded) return root_.source["entities"][i];
+    const Node* defs = member(root_, "entities");
+    if (!defs) return sim::JsonValue();
+    if (!defs->expanded) return defs->source[i];
+    return i < defs->items.size() ? value_of(defs->items[i]) : sim::JsonValue();
+}
+
+sim::JsonValue ScenarioDocument::sections() const {
+    if (!root_.expanded) return root_.source;    // assemble() skips the entities
+    return sim::JsonReader::parse(compact([&](sim::JsonWriter& w) {
+        w.begin_object();
+        for (const auto& [k, m] : root_.members) {
+            if (k == "entities") continue;
+            w.key(k);
+            write_node(w, m);
+        }
+        w.end_object();
+    }));
+}
+
+bool ScenarioDocument::mentions(const std::string& id, size_t self) const {
+    if (!root_.expanded) {
+        if (!root_.source.is_object()) return false;
+        for (const auto& [k, section] : root_.source.as_object()) {
+            if (k == "events") continue;
+            if (k != "entities") {
+                if (mentions_value(section, id)) return true;
+                continue;
+            }
+            for (size_t i = 0; i < section.size(); i++) {
+                if (i != self && mentions_value(section[i], id)) return true;
+            }
+        }
+        return false;
+    }
+    for (const auto& [k, section] : root_.members) {
+        if (k == "events") continue;
+        if (k != "entities") {
+            if (mentions_node(section, id)) return true;
+            continue;
+        }
+        for (size_t i = 0; i < entity_count(); i++) {
+            if (i != self && mentions_value(entity(i), id)) return true;
+        }
+    }
+    return false;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Patch and rebuild
+// ═══════════════════════════════════════════════════════════════
+
+PatchedScenario apply_scenario_patch(const ScenarioDocument& scenario, const MCWorld& base,
+                                     const sim::JsonValue& patch) {
+    if (!patch.is_array()) throw std::invalid_argument("patch must be an array of ops");
+
+    // origin[i]: base entity that new entity i is a copy of, or -1 if its
+    // definition was touched (and must be parsed again)
+    std::vector<long> origin(scenario.entity_count());
+    for (size_t i = 0; i < origin.size(); i++) origin[i] = static_cast<long>(i);
+
+    PatchedScenario out;
+    out.scenario = scenario;
+    Node& root = out.scenario.root_;
+    for (const auto& entry : patch.as_array()) {
+        const std::string name = entry["op"].get_string("");
+        const std::string path = entry["path"].get_string("");
+        Op op;
+        if (name == "add") op = Op::ADD;
+        else if (name == "remove") op = Op::REMOVE;
+        else if (name == "replace") op = Op::REPLACE;
+        else throw std::invalid_argument("unsupported patch op \"" + name + "\"");
+        if (!entry["path"].is_string()) throw std::invalid_argument("patch op without a path");
+        if (op != Op::REMOVE && !entry.has("value")) {
+            throw std::invalid_argument("patch " + name + " without a value: " + path);
+        }
+
+        const std::vector<std::string> tokens = split_pointer(path);
+        const size_t index = apply_op(root, op, tokens, entry["value"], path);
+
+        // Track which entity definitions the op reached
+        if (tokens.empty() || tokens[0] != "entities") {
+            out.structural = true;
+            if (tokens.empty()) origin.assign(origin.size(), -1);
+        } else if (tokens.size() == 1) {
+            out.structural = true;
+            origin.assign(origin.size(), -1);
+        } else if (tokens.size() == 2 && op != Op::REPLACE) {
+            out.structural = true;
+            const size_t i = std::min(index, origin.size());
+            if (op == Op::ADD) {
+                origin.insert(origin.begin() + static_cast<std::ptrdiff_t>(i), -1);
+            } else if (i < origin.size()) {
+                origin.erase(origin.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+        } else {
+            // The path resolved, so tokens[1] is an index into the entities
+            const size_t i = std::stoul(tokens[1]);
+            if (i < origin.size()) origin[i] = -1;
+        }
+    }
+    out.patch_text = compact([&](sim::JsonWriter& w) { write_value(w, patch); });
+
+    // A whole-document edit may leave a different entity count than the
+    // ops tracked; then everything is parsed again
+    const size_t count = out.scenario.entity_count();
+    if (origin.size() != count) origin.assign(count, -1);
+
+    // Edited definitions are read back once, and stay views from then on
+    Node* defs = root.expanded ? member(root, "entities") : nullptr;
+    MCEntityList entities;
+    entities.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (origin[i] >= 0 && static_cast<size_t>(origin[i]) < base.entities().size()) {
+            entities.push_back(base.entities()[static_cast<size_t>(origin[i])]);
+            continue;
+        }
+        sim::JsonValue def = out.scenario.entity(i);
+        if (defs && defs->expanded) defs->items[i] = Node(def);
+        entities.push_back(ScenarioParser::parse_entity(def));
+        out.edited.push_back(static_cast<uint32_t>(i));
+    }
+    if (root.expanded) {
+        for (auto& [k, m] : root.members) {
+            if (k != "entities" && m.expanded) m = Node(value_of(m));
+        }
+    }
+    out.prototype = ScenarioParser::assemble(std::move(entities), out.scenario.sections());
+    return out;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Branch prefix across an edit
+// ═══════════════════════════════════════════════════════════════
+
+std::shared_ptr<const MCRunner::BranchPrefix> rebase_branch_prefix(
+    const MCRunner::BranchPrefix& prefix, const MCWorld& base,
+    const ScenarioDocument& base_scenario, const PatchedScenario& patched) {
+    if (patched.structural) return nullptr;
+    const MCWorld& proto = patched.prototype;
+    if (proto.entities().size() != base.entities().size()) return nullptr;
+
+    for (uint32_t i : patched.edited) {
+        const MCEntity& before = base.entities()[i];
+        const MCEntity& after = proto.entities()[i];
+        if (!dormant(before) || !dormant(after) || !same_indexing(before, after)) return nullptr;
+        if (base_scenario.mentions(after.id, i) || patched.scenario.mentions(after.id, i)) {
+            return nullptr;
+        }
+        for (const MCWorld& leaf : prefix.worlds) {
+            if (!dormant(leaf.entities()[i])) return nullptr;
+        }
+
+        // Triggers read their entities' positions every check; an action
+        // touches its entity only when it fires
+        for (size_t k = 0; k < proto.events.size(); k++) {
+            const EventTrigger& t = proto.events[k].trigger;
+            if (t.entity_a_h == i || t.entity_b_h == i || t.sensor_h == i || t.target_h == i) {
+                return nullptr;
+            }
+            if (proto.events[k].action.entity != i) continue;
+            for (const MCWorld& leaf : prefix.worlds) {
+                if (k >= leaf.events.size() || leaf.events[k].fired) return nullptr;
+            }
+        }
+    }
+
+    auto out = std::make_shared<MCRunner::BranchPrefix>(prefix);
+    for (MCWorld& leaf : out->worlds) {
+        for (uint32_t i : patched.edited) {
+            MCEntity& e = leaf.entities()[i];
+            const WEZTable* wez = e.sam_wez_table;   // Set by the runner's world options
+            const InterceptTable* intercept = e.sam_intercept_table;
+            e = proto.entities()[i];
+            e.sam_wez_table = wez;
+            e.sam_intercept_table = intercept;
+            e.orbit_dirty = true;                    // Reload its Kepler lane
+            leaf.sync_eci_pos(i);
+        }
+        leaf.missiles.capacity = proto.missiles.capacity;
+        leaf.refresh_query_ranges();
+        leaf.invalidate_spatial();
+    }
+    return out;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,121 @@
+/**
+ * Scenario patches — Incremental edits to a parsed scenario (MCDaemon).
+ *
+ * A "tweak and rerun" loop changes one SAM's range or one aircraft's
+ * loadout between batches, yet sending the edited scenario re-parses all
+ * of it. A patch names the edit instead, as a JSON Patch (RFC 6902)
+ * subset:
+ *   [{ "op": "replace", "path": "/entities/3/components/weapons/maxRange_m",
+ *      "value": 90000 },
+ *    { "op": "add", "path": "/entities/-", "value": { ... } },
+ *    { "op": "remove", "path": "/events/0" }]
+ * Ops are "add", "remove" and "replace", applied in order. Paths are JSON
+ * pointers ("~1" for '/', "~0" for '~'); "-" appends to an array.
+ *
+ * apply_scenario_patch() edits the scenario document (ScenarioDocument,
+ * which leaves the untouched parts unread) and rebuilds the prototype from
+ * the one parsed before the edit: entity definitions the patch did not
+ * reach are copied as parsed, and only the touched or added ones are read
+ * back and go through ScenarioParser::parse_entity. ScenarioParser::assemble
+ * then re-derives everything that spans entities (handles, missile pool,
+ * events, comm networks, IADS), which is cheap beside the per-entity
+ * parse. The result is what ScenarioParser::parse gives for the patched
+ * document.
+ *
+ * rebase_branch_prefix() carries a snapshot-and-branch prefix across an
+ * edit. The prefix stands if every edited entity was dormant through it:
+ * inactive and not destroyed in the old prototype, the new one and every
+ * leaf, with the same ID, team, role and physics/AI/weapon types, named
+ * by no other entity, network or IADS sector and by no event trigger, and
+ * the subject of no event that has fired in any leaf. Ticks skip such an
+ * entity and nothing else reads it, so the leaves only need its new
+ * record. An entity defined with "active": false and activated by a time
+ * event after the last branch point is the usual case.
+ */
+
+#ifndef SIM_MC_SCENARIO_PATCH_HPP
+#define SIM_MC_SCENARIO_PATCH_HPP
+
+#include "mc_world.hpp"
+#include "mc_runner.hpp"
+#include "io/json_reader.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim::mc {
+
+struct PatchedScenario;
+
+/**
+ * A scenario document open to patches. Parts no patch has reached stay
+ * views into the JSON they were parsed from, so a patch costs the path it
+ * walks; a copy shares them.
+ */
+class ScenarioDocument {
+public:
+    ScenarioDocument() = default;
+    explicit ScenarioDocument(sim::JsonValue scenario) : root_(std::move(scenario)) {}
+
+    /** Entity definitions (0 if there is no entity array). */
+    size_t entity_count() const;
+
+    /** Entity definition i. */
+    sim::JsonValue entity(size_t i) const;
+
+    /** The document without its entities, as ScenarioParser::assemble reads it. */
+    sim::JsonValue sections() const;
+
+    /** True if the string `id` appears outside entity definition `self` and the events. */
+    bool mentions(const std::string& id, size_t self) const;
+
+    // Document element: a JSON value, or once a patch reaches into it, its
+    // members or items as elements of their own
+    struct Node {
+        sim::JsonValue source;    // Used until expanded
+        bool expanded = false;
+        bool is_object = false;
+        std::vector<std::pair<std::string, Node>> members;
+        std::vector<Node> items;
+
+        Node() = default;
+        explicit Node(sim::JsonValue v) : source(std::move(v)) {}
+    };
+
+private:
+    Node root_;
+
+    friend PatchedScenario apply_scenario_patch(const ScenarioDocument&, const MCWorld&,
+                                                const sim::JsonValue&);
+};
+
+struct PatchedScenario {
+    ScenarioDocument scenario;         // The patched document
+    std::string patch_text;            // The patch as compact JSON
+    MCWorld prototype;
+    std::vector<uint32_t> edited;      // Entities parsed again, by new index
+    bool structural = false;           // Entities added, removed or replaced whole,
+                                       // or anything outside /entities/<i> edited
+};
+
+/**
+ * Apply `patch` to `scenario`, whose parsed prototype is `base`.
+ * @throws std::invalid_argument on a malformed op or a path that does not
+ *         resolve; std::runtime_error if an edited entity fails to parse
+ */
+PatchedScenario apply_scenario_patch(const ScenarioDocument& scenario, const MCWorld& base,
+                                     const sim::JsonValue& patch);
+
+/**
+ * The leaves of `prefix` (built from `base`) with the patch applied, or
+ * null if the edit may have changed the prefix (see the file comment).
+ * `base_scenario` is the document before the patch.
+ */
+std::shared_ptr<const MCRunner::BranchPrefix> rebase_branch_prefix(
+    const MCRunner::BranchPrefix& prefix, const MCWorld& base,
+    const ScenarioDocument& base_scenario, const PatchedScenario& patched);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_SCENARIO_PATCH_HPP
@@ -0,0 +1,100 @@
+/**
+ * FieldSchema — Table-driven extraction of flat JSON object fields.
+ *
+ * A schema maps JSON keys to members of a struct once; apply() then walks
+ * an object's members, which JsonDocument keeps sorted by key, alongside
+ * the key-sorted table in a single merge pass, instead of one keyed lookup
+ * (and one JsonValue handle) per field.
+ *
+ * A member whose key is absent, or whose value has the wrong JSON type, is
+ * left untouched, so the struct's initializers are the scenario defaults.
+ * Two keys may feed one member (a unit-suffixed key and its legacy
+ * spelling, "maxRange_m" / "maxRange"): the suffixed key sorts after the
+ * legacy one and so wins when both are present, as in
+ *   m = obj["maxRange_m"].get_number(obj["maxRange"].get_number(m));
+ *
+ * Usage:
+ *   static const FieldSchema<Waypoint> schema = {
+ *       FieldSchema<Waypoint>::number("lat", &Waypoint::lat), ...
+ *   };
+ *   schema.apply(def, waypoint);
+ */
+
+#ifndef SIM_MC_SCENARIO_SCHEMA_HPP
+#define SIM_MC_SCENARIO_SCHEMA_HPP
+
+#include "io/json_reader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+namespace sim::mc {
+
+template <typename T>
+class FieldSchema {
+public:
+    enum class Kind : uint8_t {
+        NUMBER,    // double
+        DEGREES,   // double, stored in radians
+        INT,       // int, truncated like JsonValue::get_int
+        BOOL
+    };
+
+    struct Field {
+        std::string_view key;
+        Kind kind = Kind::NUMBER;
+        double T::* number = nullptr;
+        int T::* integer = nullptr;
+        bool T::* boolean = nullptr;
+    };
+
+    static Field number(std::string_view key, double T::* m) { return {key, Kind::NUMBER, m}; }
+    static Field degrees(std::string_view key, double T::* m) { return {key, Kind::DEGREES, m}; }
+    static Field integer(std::string_view key, int T::* m) { return {key, Kind::INT, nullptr, m}; }
+    static Field boolean(std::string_view key, bool T::* m) {
+        return {key, Kind::BOOL, nullptr, nullptr, m};
+    }
+
+    FieldSchema(std::initializer_list<Field> fields) : fields_(fields) {
+        std::stable_sort(fields_.begin(), fields_.end(),
+                         [](const Field& a, const Field& b) { return a.key < b.key; });
+    }
+
+    /** Assign every field of `object` the schema knows (no-op unless an object) */
+    void apply(const sim::JsonValue& object, T& out) const {
+        if (!object.is_object()) return;
+        auto f = fields_.begin();
+        for (const auto& [key, value] : object.as_object()) {
+            while (f != fields_.end() && f->key < key) ++f;
+            if (f == fields_.end()) return;
+            for (auto g = f; g != fields_.end() && g->key == key; ++g) assign(*g, value, out);
+        }
+    }
+
+private:
+    std::vector<Field> fields_;   // Sorted by key
+
+    static void assign(const Field& f, const sim::JsonValue& v, T& out) {
+        switch (f.kind) {
+            case Kind::NUMBER:
+                if (v.is_number()) out.*f.number = v.as_number();
+                break;
+            case Kind::DEGREES:
+                if (v.is_number()) out.*f.number = v.as_number() * M_PI / 180.0;
+                break;
+            case Kind::INT:
+                if (v.is_number()) out.*f.integer = v.as_int();
+                break;
+            case Kind::BOOL:
+                if (v.is_bool()) out.*f.boolean = v.as_bool();
+                break;
+        }
+    }
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_SCENARIO_SCHEMA_HPP
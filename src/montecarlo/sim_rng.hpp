@@ -5,7 +5,15 @@
  * Given the same seed, produces identical sequences to the JS version,
  * enabling cross-validation between browser and C++ MC runners.
  *
- * Header-only. No dependencies beyond <cstdint> and <cmath>.
+ * Counter mode (RNGMode::PHILOX) replaces the single stream with
+ * Philox4x32-10 draws addressed by (seed, run, owner entity, per-owner
+ * draw counter). A draw's value then depends only on who draws and how
+ * many times that entity has drawn, not on the global interleaving, so
+ * results stay bit-identical however runs or entities are scheduled, and
+ * adjacent seeds give uncorrelated streams. The mulberry32 stream remains
+ * the default for JS cross-validation.
+ *
+ * Header-only. No dependencies beyond <cstdint>, <cmath> and <vector>.
  */
 
 #ifndef SIM_MC_SIM_RNG_HPP
@@ -13,9 +21,41 @@
 
 #include <cstdint>
 #include <cmath>
+#include <vector>
 
 namespace sim::mc {
 
+enum class RNGMode {
+    MULBERRY32,   // single JS-compatible stream (default)
+    PHILOX        // counter-based, addressed per entity
+};
+
+/**
+ * Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as
+ * 1, 2, 3", SC'11): a keyed bijection on 128-bit counters.
+ */
+struct Philox4x32 {
+    uint32_t v[4];
+
+    static Philox4x32 generate(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                               uint32_t k0, uint32_t k1) {
+        constexpr uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+        constexpr uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+        for (int round = 0; round < 10; round++) {
+            if (round > 0) { k0 += W0; k1 += W1; }
+            uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+            uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+            uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+            uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+        }
+        return {{c0, c1, c2, c3}};
+    }
+};
+
 class SimRNG {
 public:
     explicit SimRNG(int32_t seed = 42)
@@ -30,6 +70,7 @@ public:
      */
     double random() {
         // JS: this._state += 0x6D2B79F5  (with |0 coercion to signed 32-bit)
+        draws_++;
         state_ += 0x6D2B79F5;
         uint32_t t = static_cast<uint32_t>(state_);
 
@@ -43,11 +84,33 @@ public:
         return static_cast<double>((t ^ (t >> 14))) / 4294967296.0;
     }
 
+    /**
+     * Next float in [0, 1) drawn for entity `owner`. Mulberry32 mode
+     * ignores the owner and continues the single stream; counter mode
+     * returns Philox(seed, run, owner, n) for the owner's n-th draw.
+     */
+    double random_for(uint32_t owner) {
+        if (mode_ == RNGMode::MULBERRY32) return antithetic_ ? 1.0 - random() : random();
+        if (owner >= counters_.size()) counters_.resize(static_cast<size_t>(owner) + 1, 0);
+        draws_++;
+        Philox4x32 r = Philox4x32::generate(counters_[owner]++, owner, 0, 0,
+                                            static_cast<uint32_t>(seed_), run_);
+        // 53-bit mantissa from two words
+        uint64_t bits = (static_cast<uint64_t>(r.v[0] >> 5) << 26) | (r.v[1] >> 6);
+        double u = static_cast<double>(bits) / 9007199254740992.0;
+        return antithetic_ ? 1.0 - u : u;
+    }
+
     /** Bernoulli trial: returns true with probability p. */
     bool bernoulli(double p) {
         return random() < p;
     }
 
+    /** Bernoulli trial drawn for entity `owner` (see random_for). */
+    bool bernoulli(double p, uint32_t owner) {
+        return random_for(owner) < p;
+    }
+
     /** Uniform float in [min, max). */
     double uniform(double a, double b) {
         return a + random() * (b - a);
@@ -68,11 +131,35 @@ public:
     void setSeed(int32_t seed) {
         seed_ = seed;
         state_ = seed ? seed : 1;
+        counters_.assign(counters_.size(), 0);
+    }
+
+    /**
+     * Seed for one run of a batch. Mulberry32 uses `seed` alone (the JS
+     * convention of base_seed + run); counter mode keys on (seed, run).
+     */
+    void set_stream(int32_t seed, uint32_t run) {
+        setSeed(seed);
+        run_ = run;
     }
 
+    RNGMode mode() const { return mode_; }
+    void set_mode(RNGMode mode) { mode_ = mode; }
+
+    /** Antithetic: random_for() returns 1 - u in place of each u. */
+    void set_antithetic(bool on) { antithetic_ = on; }
+
+    /** Draws made in either mode since construction (not reset by seeding). */
+    uint64_t draws() const { return draws_; }
+
 private:
     int32_t seed_;
     int32_t state_;
+    RNGMode mode_ = RNGMode::MULBERRY32;
+    bool antithetic_ = false;
+    uint32_t run_ = 0;
+    uint64_t draws_ = 0;
+    std::vector<uint32_t> counters_;   // counter mode: draws per owner
 
     /**
      * Emulate JavaScript Math.imul: 32-bit integer multiplication.
@@ -0,0 +1,126 @@
+/**
+ * SpatialGrid — Uniform 3D grid for range-gated neighbour queries.
+ *
+ * Points are bucketed into cubic cells and stored as a (cell key, index)
+ * array sorted by key, so a build is one sort and a query is one binary
+ * search per overlapped cell — no per-cell allocations. Queries return a
+ * superset of the points within range, in ascending index order, so callers
+ * apply their exact range test and see candidates in the same order as a
+ * linear scan would (important where a scan consumes RNG draws).
+ *
+ * Header-only. Coordinates are in whatever frame the caller builds with
+ * (MCWorld uses ECI; RadarSensor uses ECEF).
+ */
+
+#ifndef SIM_MC_SPATIAL_GRID_HPP
+#define SIM_MC_SPATIAL_GRID_HPP
+
+#include "core/state_vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace sim::mc {
+
+class SpatialGrid {
+public:
+    /**
+     * Rebuild from a position array (index i = entity handle i).
+     * Non-finite positions are skipped — they can never pass a range test.
+     * @param cell_size Cell edge length [m]; queries are cheapest when it
+     *                  is close to the typical query radius.
+     */
+    void build(const std::vector<Vec3>& positions, double cell_size) {
+        cell_ = cell_size > 0.0 ? cell_size : 1.0;
+        inv_cell_ = 1.0 / cell_;
+
+        entries_.clear();
+        entries_.reserve(positions.size());
+        uint32_t n = static_cast<uint32_t>(positions.size());
+        for (uint32_t i = 0; i < n; i++) {
+            const Vec3& p = positions[i];
+            if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+                continue;
+            }
+            entries_.push_back({key(cell_of(p.x), cell_of(p.y), cell_of(p.z)), i});
+        }
+        std::sort(entries_.begin(), entries_.end(),
+                  [](const Entry& a, const Entry& b) {
+                      return a.key != b.key ? a.key < b.key : a.index < b.index;
+                  });
+    }
+
+    /**
+     * Append every indexed point whose cell overlaps the cube
+     * [center - radius, center + radius] to `out`, ascending by index.
+     * Falls back to all indices when the cube spans more cells than points.
+     */
+    void query(const Vec3& center, double radius, std::vector<uint32_t>& out) const {
+        out.clear();
+        if (entries_.empty()) return;
+
+        int64_t x0 = cell_of(center.x - radius), x1 = cell_of(center.x + radius);
+        int64_t y0 = cell_of(center.y - radius), y1 = cell_of(center.y + radius);
+        int64_t z0 = cell_of(center.z - radius), z1 = cell_of(center.z + radius);
+
+        double cells = static_cast<double>(x1 - x0 + 1) *
+                       static_cast<double>(y1 - y0 + 1) *
+                       static_cast<double>(z1 - z0 + 1);
+        if (!std::isfinite(radius) || cells > static_cast<double>(entries_.size())) {
+            for (const auto& en : entries_) out.push_back(en.index);
+            std::sort(out.begin(), out.end());
+            return;
+        }
+
+        for (int64_t x = x0; x <= x1; x++) {
+            for (int64_t y = y0; y <= y1; y++) {
+                for (int64_t z = z0; z <= z1; z++) {
+                    uint64_t k = key(x, y, z);
+                    auto it = std::lower_bound(
+                        entries_.begin(), entries_.end(), k,
+                        [](const Entry& en, uint64_t kk) { return en.key < kk; });
+                    for (; it != entries_.end() && it->key == k; ++it) {
+                        out.push_back(it->index);
+                    }
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    bool empty() const { return entries_.empty(); }
+    double cell_size() const { return cell_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    // 21 bits per axis; cell coordinates are clamped to the representable
+    // range, which is monotone and therefore never drops a candidate.
+    static constexpr int64_t AXIS_LIMIT = (int64_t{1} << 20) - 1;
+
+    std::vector<Entry> entries_;
+    double cell_ = 1.0;
+    double inv_cell_ = 1.0;
+
+    int64_t cell_of(double v) const {
+        double c = std::floor(v * inv_cell_);
+        if (!(c > -AXIS_LIMIT)) return -AXIS_LIMIT;   // also catches NaN
+        if (c > AXIS_LIMIT) return AXIS_LIMIT;
+        return static_cast<int64_t>(c);
+    }
+
+    static uint64_t key(int64_t x, int64_t y, int64_t z) {
+        constexpr uint64_t MASK = (uint64_t{1} << 21) - 1;
+        return ((static_cast<uint64_t>(x + AXIS_LIMIT) & MASK) << 42) |
+               ((static_cast<uint64_t>(y + AXIS_LIMIT) & MASK) << 21) |
+               (static_cast<uint64_t>(z + AXIS_LIMIT) & MASK);
+    }
+};
+
+} // namespace sim::mc
+
+#endif // SIM_MC_SPATIAL_GRID_HPP
@@ -17,14 +17,34 @@
 namespace sim::mc {
 
 void WaypointPatrolAI::update_all(double dt, MCWorld& world) {
-    for (auto& e : world.entities()) {
-        if (e.ai_type != AIType::WAYPOINT_PATROL) continue;
-        if (!e.active || e.destroyed) continue;
-        if (e.waypoints.empty()) continue;
-        update_entity(e, dt);
+    update_range(dt, world, 0, world.with_ai(AIType::WAYPOINT_PATROL).size());
+}
+
+void WaypointPatrolAI::update_range(double dt, MCWorld& world, size_t begin, size_t end) {
+    auto& entities = world.entities();
+    const IndexList& patrols = world.with_ai(AIType::WAYPOINT_PATROL);
+    for (size_t k = begin; k < end; k++) {
+        uint32_t i = patrols[k];
+        if (!world.alive(i)) continue;
+        MCEntity& e = entities[i];
+        if (e.waypoints.empty() || e.player_controlled) continue;
+        if (world.decisions.due(AIType::WAYPOINT_PATROL, i)) {
+            update_entity(e, dt);
+        } else {
+            follow_commands(e, dt);
+        }
     }
 }
 
+void WaypointPatrolAI::follow_commands(MCEntity& e, double dt) {
+    // Smooth roll convergence
+    double roll_rate = std::min(dt * 3.0, 1.0);
+    e.flight_roll += (e.ai_roll_cmd - e.flight_roll) * roll_rate;
+
+    e.flight_throttle += e.ai_throttle_rate * dt;
+    e.flight_throttle = std::clamp(e.flight_throttle, 0.3, 1.0);
+}
+
 void WaypointPatrolAI::update_entity(MCEntity& e, double dt) {
     // ── Current waypoint ──
     const Waypoint& wp = e.waypoints[e.waypoint_index];
@@ -48,11 +68,7 @@ void WaypointPatrolAI::update_entity(MCEntity& e, double dt) {
     double heading_error = angle_diff(desired_heading, e.flight_heading);
 
     // Roll command: proportional to heading error, max ~40 degrees bank
-    double roll_cmd = std::clamp(heading_error * 2.0, -0.7, 0.7);
-
-    // Smooth roll convergence
-    double roll_rate = std::min(dt * 3.0, 1.0);
-    e.flight_roll += (roll_cmd - e.flight_roll) * roll_rate;
+    e.ai_roll_cmd = std::clamp(heading_error * 2.0, -0.7, 0.7);
 
     // ── Altitude steering via alpha ──
     double alt_error = desired_alt - e.geo_alt;
@@ -60,11 +76,13 @@ void WaypointPatrolAI::update_entity(MCEntity& e, double dt) {
 
     // ── Speed control via throttle ──
     if (e.flight_speed < desired_speed * 0.95) {
-        e.flight_throttle += 0.1 * dt;
+        e.ai_throttle_rate = 0.1;
     } else if (e.flight_speed > desired_speed * 1.05) {
-        e.flight_throttle -= 0.1 * dt;
+        e.ai_throttle_rate = -0.1;
+    } else {
+        e.ai_throttle_rate = 0.0;
     }
-    e.flight_throttle = std::clamp(e.flight_throttle, 0.3, 1.0);
+    follow_commands(e, dt);
 
     // ── Waypoint arrival check ──
     if (distance < 2000.0) {
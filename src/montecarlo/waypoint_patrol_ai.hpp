@@ -4,7 +4,10 @@
  * Controls flight_roll, flight_alpha, and flight_throttle to steer
  * toward each waypoint in sequence. Advances on arrival within 2 km.
  *
- * Processes all entities with ai_type == WAYPOINT_PATROL.
+ * Processes all entities with ai_type == WAYPOINT_PATROL. With reduced-
+ * rate decisions (MCConfig::ai_decisions) the route geometry and arrival
+ * check run on decision ticks only; in between the bank and throttle keep
+ * following the last commands.
  */
 
 #ifndef SIM_MC_WAYPOINT_PATROL_AI_HPP
@@ -16,9 +19,20 @@ namespace sim::mc {
 
 class WaypointPatrolAI {
 public:
+    /** Seconds between decisions under MCConfig::ai_decisions. */
+    static constexpr double DECISION_PERIOD = 0.3;   // route steering, ~3 Hz
+
     static void update_all(double dt, MCWorld& world);
+
+    /**
+     * Entries [begin, end) of with_ai(WAYPOINT_PATROL); each touches only
+     * its own aircraft, so disjoint ranges may run concurrently.
+     */
+    static void update_range(double dt, MCWorld& world, size_t begin, size_t end);
 private:
     static void update_entity(MCEntity& e, double dt);
+    /** Roll convergence and throttle ramp toward the held commands. */
+    static void follow_commands(MCEntity& e, double dt);
 };
 
 } // namespace sim::mc
@@ -0,0 +1,407 @@
+#include "montecarlo/wez_table.hpp"
+#include "montecarlo/geo_utils.hpp"
+#include "montecarlo/missile_flyout.hpp"
+#include "montecarlo/mc_world.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <stdexcept>
+
+namespace sim::mc {
+
+namespace {
+
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+constexpr double METERS_PER_DEG = 111132.0;  // update_missile_state's flat Earth
+constexpr double G0 = 9.80665;
+constexpr int VARIANTS = 3;                  // straight, break left, break right
+
+template <typename T>
+void write_pod(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+void read_pod(std::istream& in, T& v) {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+    if (!in) throw std::runtime_error("WEZ table: unexpected end of file");
+}
+
+void write_axis(std::ostream& out, const std::vector<double>& axis) {
+    write_pod(out, static_cast<uint32_t>(axis.size()));
+    out.write(reinterpret_cast<const char*>(axis.data()),
+              static_cast<std::streamsize>(axis.size() * sizeof(double)));
+}
+
+std::vector<double> read_axis(std::istream& in) {
+    uint32_t n = 0;
+    read_pod(in, n);
+    if (n == 0 || n > 4096) throw std::runtime_error("WEZ table: bad axis length");
+    std::vector<double> axis(n);
+    in.read(reinterpret_cast<char*>(axis.data()), static_cast<std::streamsize>(n * sizeof(double)));
+    if (!in) throw std::runtime_error("WEZ table: unexpected end of file");
+    return axis;
+}
+
+void check_axis(const std::vector<double>& axis, const char* name) {
+    if (axis.empty()) {
+        throw std::invalid_argument(std::string("WEZ table: empty ") + name + " axis");
+    }
+    for (size_t i = 1; i < axis.size(); i++) {
+        if (!(axis[i] > axis[i - 1])) {
+            throw std::invalid_argument(std::string("WEZ table: ") + name +
+                                        " axis is not increasing");
+        }
+    }
+}
+
+/** Lower cell index and fraction of x on an axis, clamped to its ends */
+struct Bracket {
+    size_t lo = 0;
+    size_t hi = 0;
+    double t = 0.0;
+};
+
+Bracket bracket(const std::vector<double>& axis, double x) {
+    Bracket b;
+    if (axis.size() == 1 || x <= axis.front()) return b;
+    if (x >= axis.back()) {
+        b.lo = b.hi = axis.size() - 1;
+        return b;
+    }
+    b.hi = static_cast<size_t>(std::upper_bound(axis.begin(), axis.end(), x) - axis.begin());
+    b.lo = b.hi - 1;
+    b.t = (x - axis[b.lo]) / (axis[b.hi] - axis[b.lo]);
+    return b;
+}
+
+/** One fly-out of a generator row */
+struct Shot {
+    FlyoutMissile missile;
+    sim::GuidanceTarget target{};
+    double turn = 0.0;       // deg/s, signed; 0 once dragging
+    bool done = false;
+};
+
+// Advance a constant-speed level target one STEP on the flat Earth; a
+// breaking target turns until it flies directly away from the shooter
+// at the origin
+void advance_target(Shot& s) {
+    sim::GuidanceTarget& t = s.target;
+    if (s.turn != 0.0) {
+        double away = std::atan2(t.longitude * std::cos(t.latitude * M_PI / 180.0),
+                                 t.latitude) * RAD_TO_DEG;
+        double left = angle_diff(away / RAD_TO_DEG, t.heading / RAD_TO_DEG) * RAD_TO_DEG;
+        double step = s.turn * WEZTable::STEP;
+        if (std::abs(left) <= std::abs(step)) {
+            t.heading = away;
+            s.turn = 0.0;
+        } else {
+            t.heading += std::copysign(std::abs(step), left);
+        }
+        t.heading = std::fmod(t.heading + 360.0, 360.0);
+    }
+    double h = t.heading / RAD_TO_DEG;
+    double d = t.speed * WEZTable::STEP;
+    t.latitude += d * std::cos(h) / METERS_PER_DEG;
+    t.longitude += d * std::sin(h) / (METERS_PER_DEG * std::cos(t.latitude * M_PI / 180.0));
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════════════
+// Table
+// ═══════════════════════════════════════════════════════════════
+
+WEZAxes WEZAxes::defaults(const WEZWeapon& weapon) {
+    WEZAxes a;
+    const int n_range = 24;
+    const double r0 = 500.0, r1 = 1.25 * weapon.max_range;
+    for (int i = 0; i < n_range; i++) a.range.push_back(r0 + (r1 - r0) * i / (n_range - 1));
+    for (int i = 0; i <= 8; i++) a.aspect.push_back(22.5 * i);
+    a.altitude = weapon.surface
+        ? std::vector<double>{500.0, 2000.0, 5000.0, 10000.0, 15000.0, 20000.0}
+        : std::vector<double>{1000.0, 3000.0, 6000.0, 9000.0, 12000.0, 15000.0};
+    a.target_speed = {150.0, 250.0, 350.0, 450.0, 600.0};
+    return a;
+}
+
+WEZTable::WEZTable(const WEZWeapon& weapon, const WEZAxes& axes)
+    : weapon_(weapon), axes_(axes) {
+    check_axis(axes_.range, "range");
+    check_axis(axes_.aspect, "aspect");
+    check_axis(axes_.altitude, "altitude");
+    check_axis(axes_.target_speed, "target speed");
+    size_t n = axes_.range.size() * axes_.aspect.size() * axes_.altitude.size()
+             * axes_.target_speed.size();
+    reach_.assign(n, 0.0f);
+    tof_.assign(n, 0.0f);
+}
+
+WEZLookup WEZTable::lookup(const WEZGeometry& g) const {
+    const Bracket b[4] = {
+        bracket(axes_.altitude, g.altitude),
+        bracket(axes_.target_speed, g.target_speed),
+        bracket(axes_.aspect, g.aspect),
+        bracket(axes_.range, g.range),
+    };
+    WEZLookup out;
+    for (int corner = 0; corner < 16; corner++) {
+        double w = 1.0;
+        size_t at[4];
+        for (int k = 0; k < 4; k++) {
+            bool upper = corner & (8 >> k);
+            at[k] = upper ? b[k].hi : b[k].lo;
+            w *= upper ? b[k].t : 1.0 - b[k].t;
+        }
+        if (w == 0.0) continue;
+        size_t cell = index(at[0], at[1], at[2], at[3]);
+        out.reach += w * reach_[cell];
+        out.tof += w * tof_[cell];
+    }
+    return out;
+}
+
+void WEZTable::write(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("WEZ table: cannot write " + path);
+
+    out.write(MAGIC, sizeof(MAGIC));
+    write_pod(out, VERSION);
+    write_pod(out, static_cast<uint32_t>(weapon_.name.size()));
+    out.write(weapon_.name.data(), static_cast<std::streamsize>(weapon_.name.size()));
+    write_pod(out, static_cast<uint8_t>(weapon_.bvr));
+    write_pod(out, static_cast<uint8_t>(weapon_.surface));
+    write_pod(out, weapon_.speed);
+    write_pod(out, weapon_.max_range);
+    write_axis(out, axes_.range);
+    write_axis(out, axes_.aspect);
+    write_axis(out, axes_.altitude);
+    write_axis(out, axes_.target_speed);
+    out.write(reinterpret_cast<const char*>(reach_.data()),
+              static_cast<std::streamsize>(reach_.size() * sizeof(float)));
+    out.write(reinterpret_cast<const char*>(tof_.data()),
+              static_cast<std::streamsize>(tof_.size() * sizeof(float)));
+    if (!out) throw std::runtime_error("WEZ table: write failed for " + path);
+}
+
+WEZTable WEZTable::read(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("WEZ table: cannot open " + path);
+
+    char magic[4];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, MAGIC, sizeof(magic)) != 0) {
+        throw std::runtime_error("WEZ table: bad magic in " + path);
+    }
+    uint32_t version = 0;
+    read_pod(in, version);
+    if (version != VERSION) {
+        throw std::runtime_error("WEZ table: unsupported version " +
+                                 std::to_string(version) + " in " + path);
+    }
+
+    WEZWeapon weapon;
+    uint32_t name_length = 0;
+    read_pod(in, name_length);
+    if (name_length > 256) throw std::runtime_error("WEZ table: bad name in " + path);
+    weapon.name.resize(name_length);
+    in.read(&weapon.name[0], name_length);
+    uint8_t bvr = 0, surface = 0;
+    read_pod(in, bvr);
+    read_pod(in, surface);
+    weapon.bvr = bvr != 0;
+    weapon.surface = surface != 0;
+    read_pod(in, weapon.speed);
+    read_pod(in, weapon.max_range);
+
+    WEZAxes axes;
+    axes.range = read_axis(in);
+    axes.aspect = read_axis(in);
+    axes.altitude = read_axis(in);
+    axes.target_speed = read_axis(in);
+
+    WEZTable table(weapon, axes);
+    const auto bytes = static_cast<std::streamsize>(table.cells() * sizeof(float));
+    in.read(reinterpret_cast<char*>(table.reach_.data()), bytes);
+    in.read(reinterpret_cast<char*>(table.tof_.data()), bytes);
+    if (!in) throw std::runtime_error("WEZ table: unexpected end of file in " + path);
+    return table;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Library
+// ═══════════════════════════════════════════════════════════════
+
+std::shared_ptr<const WEZLibrary> WEZLibrary::load(const std::string& dir) {
+    DIR* d = ::opendir(dir.c_str());
+    if (!d) throw std::runtime_error("WEZ tables: cannot open directory " + dir);
+    std::vector<std::string> files, intercepts;
+    while (const dirent* entry = ::readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() <= 4) continue;
+        if (name.compare(name.size() - 4, 4, ".wez") == 0) files.push_back(name);
+        if (name.compare(name.size() - 4, 4, ".ixt") == 0) intercepts.push_back(name);
+    }
+    ::closedir(d);
+    if (files.empty() && intercepts.empty()) {
+        throw std::runtime_error("WEZ tables: no .wez or .ixt file in " + dir);
+    }
+
+    // Sorted, so a duplicate name is reported the same way on every host
+    std::sort(files.begin(), files.end());
+    std::sort(intercepts.begin(), intercepts.end());
+    auto library = std::make_shared<WEZLibrary>();
+    auto check_unique = [&](const std::string& weapon) {
+        if (library->find(weapon) || library->find_intercept(weapon)) {
+            throw std::runtime_error("WEZ tables: weapon '" + weapon +
+                                     "' tabulated twice in " + dir);
+        }
+    };
+    for (const std::string& name : files) {
+        WEZTable table = WEZTable::read(dir + "/" + name);
+        check_unique(table.weapon().name);
+        library->add(std::move(table));
+    }
+    for (const std::string& name : intercepts) {
+        InterceptTable table = InterceptTable::read(dir + "/" + name);
+        check_unique(table.weapon().name);
+        library->add(std::move(table));
+    }
+    return library;
+}
+
+void WEZLibrary::add(WEZTable table) {
+    std::string name = table.weapon().name;
+    tables_[name] = std::make_unique<WEZTable>(std::move(table));
+}
+
+void WEZLibrary::add(InterceptTable table) {
+    std::string name = table.weapon().name;
+    intercepts_[name] = std::make_unique<InterceptTable>(std::move(table));
+}
+
+const WEZTable* WEZLibrary::find(const std::string& name) const {
+    auto it = tables_.find(name);
+    return it == tables_.end() ? nullptr : it->second.get();
+}
+
+const InterceptTable* WEZLibrary::find_intercept(const std::string& name) const {
+    auto it = intercepts_.find(name);
+    return it == intercepts_.end() ? nullptr : it->second.get();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Runtime geometry
+// ═══════════════════════════════════════════════════════════════
+
+WEZGeometry wez_geometry(MCWorld& world, EntityHandle shooter, EntityHandle target,
+                         double range) {
+    const MCWorld::GeoPoint from = world.geodetic_of(shooter);
+    const MCWorld::GeoPoint to = world.geodetic_of(target);
+    const MCEntity& t = world.entities()[target];
+
+    WEZGeometry g;
+    g.range = range;
+    g.altitude = to.alt;
+    if (t.physics_type == PhysicsType::FLIGHT_3DOF) {
+        double back = great_circle_bearing(to.lat_rad, to.lon_rad, from.lat_rad, from.lon_rad);
+        g.aspect = std::abs(angle_diff(t.flight_heading, back)) * RAD_TO_DEG;
+        g.target_speed = t.flight_speed;
+    }
+    return g;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Generator
+// ═══════════════════════════════════════════════════════════════
+
+WEZTable generate_wez(const WEZWeapon& weapon, const WEZAxes& axes, int num_threads) {
+    WEZTable table(weapon, axes);
+    const size_t n_range = axes.range.size();
+    const size_t n_aspect = axes.aspect.size();
+    const size_t n_speed = axes.target_speed.size();
+    const size_t rows = axes.altitude.size() * n_speed * n_aspect;
+
+    // One row = every range cell of one (altitude, speed, aspect), each
+    // flown against the three target variants as one guidance batch
+    auto fly_row = [&](size_t row) {
+        const size_t ai = row / (n_speed * n_aspect);
+        const size_t si = (row / n_aspect) % n_speed;
+        const size_t ki = row % n_aspect;
+        const double alt = axes.altitude[ai];
+        const double speed = axes.target_speed[si];
+        const double launch_alt = weapon.surface ? 0.0 : alt;
+        const double dz = alt - launch_alt;
+        const double turn_rate = speed > 0.0
+            ? WEZTable::TURN_G * G0 / speed * RAD_TO_DEG : 0.0;   // deg/s
+
+        std::vector<Shot> shots(n_range * VARIANTS);
+        for (size_t r = 0; r < n_range; r++) {
+            const double range = axes.range[r];
+            const bool reachable = range > std::abs(dz);
+            const double ground = reachable ? std::sqrt(range * range - dz * dz) : 0.0;
+            for (int v = 0; v < VARIANTS; v++) {
+                Shot& s = shots[r * VARIANTS + v];
+                s.done = !reachable;
+                s.missile = MissileFlyout::body(weapon.bvr, 0.0, 0.0, launch_alt, 0.0,
+                                                std::atan2(dz, ground) * RAD_TO_DEG,
+                                                weapon.speed, weapon.max_range);
+                s.target.latitude = ground / METERS_PER_DEG;
+                s.target.longitude = 0.0;
+                s.target.altitude = alt;
+                s.target.speed = speed;
+                s.target.heading = std::fmod(180.0 + axes.aspect[ki], 360.0);
+                s.target.flight_path_angle = 0.0;
+                s.turn = v == 0 ? 0.0 : (v == 1 ? -turn_rate : turn_rate);
+            }
+        }
+
+        const sim::GuidanceParams params;
+        sim::GuidanceBatch batch;
+        batch.resize(shots.size());
+        size_t flying = 0;
+        for (const Shot& s : shots) flying += !s.done;
+        while (flying > 0) {
+            for (size_t i = 0; i < shots.size(); i++) {
+                Shot& s = shots[i];
+                if (s.done) continue;
+                advance_target(s);
+                batch.set(i, s.missile.state, s.target, params);
+            }
+            sim::compute_guidance(batch);
+            for (size_t i = 0; i < shots.size(); i++) {
+                Shot& s = shots[i];
+                if (s.done) continue;
+                sim::update_missile_state(s.missile.state, batch.command(i), WEZTable::STEP);
+                if (!MissileFlyout::resolve(s.missile, s.target)) {
+                    s.done = true;
+                    flying--;
+                }
+            }
+        }
+
+        for (size_t r = 0; r < n_range; r++) {
+            int hits = 0;
+            double tof = 0.0;
+            for (int v = 0; v < VARIANTS; v++) {
+                const FlyoutMissile& m = shots[r * VARIANTS + v].missile;
+                if (m.status != FlyoutStatus::HIT) continue;
+                hits++;
+                tof += m.state.time_of_flight;
+            }
+            tof = hits > 0 ? tof / hits : axes.range[r] / weapon.speed;
+            table.set(table.index(ai, si, ki, r), static_cast<float>(hits) / VARIANTS,
+                      static_cast<float>(tof));
+        }
+    };
+
+    sim::ThreadPool pool(num_threads);
+    pool.parallel_for(rows, fly_row);
+    return table;
+}
+
+} // namespace sim::mc
@@ -0,0 +1,159 @@
+/**
+ * WEZ tables — precomputed weapon engagement zones for SAM and A2A shots.
+ *
+ * Without them SAMBattery and A2AMissile shoot on a range gate and resolve
+ * a shot after range / speed seconds with the weapon's flat Pk, whatever
+ * the geometry; --missile-flyout flies every shot instead, which costs a
+ * guided body per tick. A WEZ table sits between the two: generate_wez()
+ * flies the same MissileFlyout bodies offline over a grid of launch
+ * geometries, and at runtime a shot reads its kinematic reach (the
+ * fraction of fly-outs that ended HIT) and time of flight from the table
+ * by quadrilinear interpolation, O(1) per decision.
+ *
+ * Grid axes (each increasing):
+ *   range         slant range at launch [m]
+ *   aspect        target heading against the target-to-shooter line [deg]:
+ *                 0 = nose on (hot), 180 = tail on (cold)
+ *   altitude      target altitude [m]; an air-launched weapon launches
+ *                 level with the target, a surface-launched one from 0 m
+ *   target_speed  [m/s]
+ * The missile's own speed is the weapon's (MissileFlyout bodies ignore the
+ * shooter's velocity), so aspect and target speed fix the closure rate.
+ * Each cell flies three targets: one holding its course, and two breaking
+ * left and right at TURN_G until they fly directly away from the shooter.
+ *
+ * File layout (little-endian, as written by the host):
+ *   "WEZT" u32 version, u32 name length, name bytes, u8 bvr, u8 surface,
+ *   f64 speed, f64 max_range, 4 x (u32 n, n x f64) axes,
+ *   cells x f32 reach, cells x f32 time of flight
+ * with cells ordered [altitude][target_speed][aspect][range].
+ *
+ * WEZLibrary loads every *.wez file in a directory, and the intercept
+ * tables (*.ixt, intercept_table.hpp) beside them; MCConfig::wez_dir
+ * hands one to the runner, and A2A weapons find their table by loadout
+ * name ("aim120", ...), SAM batteries by their weapon's "wez" name. The
+ * scenario's range gates still apply: the table only withholds shots
+ * inside them (reach below SHOOT_REACH) and sets TOF and the Pk scale.
+ * With --missile-flyout the bodies themselves decide reach and TOF.
+ */
+
+#ifndef SIM_MC_WEZ_TABLE_HPP
+#define SIM_MC_WEZ_TABLE_HPP
+
+#include "mc_entity.hpp"
+#include "intercept_table.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim::mc {
+
+class MCWorld;
+
+/** The weapon a table describes, as MissileFlyout::launch() would fly it */
+struct WEZWeapon {
+    std::string name;             // table key: A2A loadout name or SAM "wez"
+    bool bvr = true;              // AIM-120-like body, else AIM-9-like
+    bool surface = false;         // launched from the ground (SAM)
+    double speed = 1400.0;        // m/s
+    double max_range = 80000.0;   // m
+};
+
+struct WEZAxes {
+    std::vector<double> range;
+    std::vector<double> aspect;
+    std::vector<double> altitude;
+    std::vector<double> target_speed;
+
+    /** Default grid for a weapon: ranges to 1.25 x max_range */
+    static WEZAxes defaults(const WEZWeapon& weapon);
+};
+
+/** Launch geometry, as WEZAxes */
+struct WEZGeometry {
+    double range = 0.0;
+    double aspect = 0.0;
+    double altitude = 0.0;
+    double target_speed = 0.0;
+};
+
+struct WEZLookup {
+    double reach = 0.0;           // fraction of fly-outs that hit, [0, 1]
+    double tof = 0.0;             // s, mean over the hits
+};
+
+class WEZTable {
+public:
+    static constexpr char MAGIC[4] = {'W', 'E', 'Z', 'T'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr double TURN_G = 5.0;        // break-turn target load [g]
+    static constexpr double STEP = 0.1;          // fly-out step [s], the MC default dt
+    static constexpr double SHOOT_REACH = 0.5;   // shots are taken at or above this reach
+
+    WEZTable() = default;
+    WEZTable(const WEZWeapon& weapon, const WEZAxes& axes);
+
+    const WEZWeapon& weapon() const { return weapon_; }
+    const WEZAxes& axes() const { return axes_; }
+    size_t cells() const { return reach_.size(); }
+
+    /** Interpolated reach and time of flight; geometry clamps to the grid */
+    WEZLookup lookup(const WEZGeometry& g) const;
+
+    /** Cell (altitude, speed, aspect, range) */
+    size_t index(size_t alt, size_t speed, size_t aspect, size_t range) const {
+        return ((alt * axes_.target_speed.size() + speed) * axes_.aspect.size() + aspect)
+               * axes_.range.size() + range;
+    }
+    void set(size_t cell, float reach, float tof) {
+        reach_[cell] = reach;
+        tof_[cell] = tof;
+    }
+
+    /** @throws std::runtime_error on I/O failure or a malformed file */
+    void write(const std::string& path) const;
+    static WEZTable read(const std::string& path);
+
+private:
+    WEZWeapon weapon_;
+    WEZAxes axes_;
+    std::vector<float> reach_;
+    std::vector<float> tof_;
+};
+
+/** Tables by weapon name; immutable once loaded, shared by every run */
+class WEZLibrary {
+public:
+    /**
+     * @throws std::runtime_error if the directory holds no .wez or .ixt
+     *         file, or one fails to read
+     */
+    static std::shared_ptr<const WEZLibrary> load(const std::string& dir);
+
+    void add(WEZTable table);
+    void add(InterceptTable table);
+    const WEZTable* find(const std::string& name) const;
+    const InterceptTable* find_intercept(const std::string& name) const;
+    size_t size() const { return tables_.size() + intercepts_.size(); }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<WEZTable>> tables_;
+    std::unordered_map<std::string, std::unique_ptr<InterceptTable>> intercepts_;
+};
+
+/** Launch geometry from shooter to target in `world`, at slant `range` */
+WEZGeometry wez_geometry(MCWorld& world, EntityHandle shooter, EntityHandle target,
+                         double range);
+
+/**
+ * Fly every cell of `axes` for `weapon` (three target variants per cell),
+ * `num_threads` workers (0 = all cores), each stepping its rows of cells
+ * as one GuidanceBatch.
+ */
+WEZTable generate_wez(const WEZWeapon& weapon, const WEZAxes& axes, int num_threads = 0);
+
+} // namespace sim::mc
+
+#endif // SIM_MC_WEZ_TABLE_HPP
@@ -0,0 +1,284 @@
+/**
+ * Tabulated Aerodynamic Database Implementation
+ */
+
+#include "physics/aero_database.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace sim {
+
+namespace {
+
+bool inside(const AeroDatabase::Cursor& c, const double x[], int n) {
+    for (int a = 0; a < n; a++) {
+        if (x[a] < c.lo[a] || x[a] > c.hi[a]) return false;
+    }
+    return true;
+}
+
+/// Bounds-checked sequential reader over a file image
+struct Reader {
+    const std::vector<uint8_t>& buf;
+    size_t pos = 0;
+
+    bool read(void* dst, size_t bytes) {
+        if (bytes > buf.size() - pos) return false;
+        std::memcpy(dst, buf.data() + pos, bytes);
+        pos += bytes;
+        return true;
+    }
+};
+
+} // namespace
+
+void AeroDatabase::clear() {
+    spec_ = AeroTableSpec();
+    data_.clear();
+    stride_ = 0;
+    moments_ = MomentColumns();
+    ninterp_ = 0;
+}
+
+bool AeroDatabase::validate(const AeroTableSpec& spec, size_t values) const {
+    if (spec.axes.empty() || spec.axes.size() > static_cast<size_t>(MAX_AXES)) return false;
+    if (spec.breakpoints.size() != spec.axes.size()) return false;
+    if (spec.coefficients.empty() || spec.coefficients.size() > MAX_COEFFICIENTS) return false;
+
+    bool seen[MAX_AXES] = {};
+    for (size_t a = 0; a < spec.axes.size(); a++) {
+        int axis = static_cast<int>(spec.axes[a]);
+        if (axis < 0 || axis >= MAX_AXES || seen[axis]) return false;
+        seen[axis] = true;
+
+        const std::vector<double>& b = spec.breakpoints[a];
+        if (b.empty() || !std::isfinite(b[0])) return false;
+        for (size_t k = 1; k < b.size(); k++) {
+            if (!(b[k] > b[k - 1]) || !std::isfinite(b[k])) return false;
+        }
+    }
+    for (const std::string& name : spec.coefficients) {
+        if (name.empty() || name.size() >= aero::NAME_LENGTH) return false;
+    }
+    return values == spec.values();
+}
+
+bool AeroDatabase::assign(const AeroTableSpec& spec, const std::vector<double>& data) {
+    clear();
+    if (!validate(spec, data.size())) return false;
+    spec_ = spec;
+
+    const size_t ncoef = spec_.coefficients.size();
+    const size_t nodes = spec_.nodes();
+    stride_ = (ncoef + 3) & ~size_t(3);
+    data_.assign(nodes * stride_, 0.0);
+    for (size_t k = 0; k < nodes; k++) {
+        std::copy(data.begin() + k * ncoef, data.begin() + (k + 1) * ncoef,
+                  data_.begin() + k * stride_);
+    }
+
+    // Axes with a single breakpoint drop out of the interpolation
+    size_t node_stride = stride_;
+    for (int a = static_cast<int>(spec_.axes.size()) - 1; a >= 0; a--) {
+        size_t n = spec_.breakpoints[a].size();
+        if (n > 1) {
+            interp_axis_[ninterp_] = a;
+            source_[ninterp_] = static_cast<int>(spec_.axes[a]);
+            node_stride_[ninterp_] = node_stride;
+            ninterp_++;
+        }
+        node_stride *= n;
+    }
+
+    moments_.Cl = column("Cl");
+    moments_.Cm = column("Cm");
+    moments_.Cn = column("Cn");
+    moments_.Cl_p = column("Cl_p");
+    moments_.Cm_q = column("Cm_q");
+    moments_.Cn_r = column("Cn_r");
+    return true;
+}
+
+int AeroDatabase::column(const std::string& name) const {
+    for (size_t k = 0; k < spec_.coefficients.size(); k++) {
+        if (spec_.coefficients[k] == name) return static_cast<int>(k);
+    }
+    return -1;
+}
+
+bool AeroDatabase::open(const std::string& filename) {
+    clear();
+
+    FILE* f = std::fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    std::vector<uint8_t> buf;
+    uint8_t chunk[65536];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        buf.insert(buf.end(), chunk, chunk + got);
+    }
+    std::fclose(f);
+
+    Reader in{buf};
+    aero::Header h;
+    if (!in.read(&h, sizeof(h))) return false;
+    if (std::memcmp(h.magic, aero::MAGIC, 4) != 0 || h.version != aero::VERSION ||
+        h.naxes == 0 || h.naxes > static_cast<uint32_t>(MAX_AXES) ||
+        h.ncoef == 0 || h.ncoef > MAX_COEFFICIENTS) {
+        return false;
+    }
+
+    uint32_t axis[MAX_AXES], size[MAX_AXES];
+    if (!in.read(axis, h.naxes * sizeof(uint32_t)) || !in.read(size, h.naxes * sizeof(uint32_t))) {
+        return false;
+    }
+
+    AeroTableSpec spec;
+    size_t nodes = 1;
+    for (uint32_t a = 0; a < h.naxes; a++) {
+        if (axis[a] >= static_cast<uint32_t>(MAX_AXES) || size[a] == 0 ||
+            size[a] > buf.size() / sizeof(double)) {
+            return false;
+        }
+        spec.axes.push_back(static_cast<AeroAxis>(axis[a]));
+        spec.breakpoints.emplace_back(size[a]);
+        if (!in.read(spec.breakpoints.back().data(), size[a] * sizeof(double))) return false;
+        nodes *= size[a];
+        if (nodes > buf.size() / sizeof(double)) return false;
+    }
+    for (uint32_t k = 0; k < h.ncoef; k++) {
+        char name[aero::NAME_LENGTH + 1] = {};
+        if (!in.read(name, aero::NAME_LENGTH)) return false;
+        spec.coefficients.emplace_back(name);
+    }
+
+    std::vector<double> data(nodes * h.ncoef);
+    if (!in.read(data.data(), data.size() * sizeof(double))) return false;
+    return assign(spec, data);
+}
+
+bool AeroDatabase::write(const std::string& filename, const AeroTableSpec& spec,
+                         const std::vector<double>& data) {
+    if (data.size() != spec.values() || spec.axes.size() != spec.breakpoints.size()) return false;
+
+    aero::Header h{};
+    std::memcpy(h.magic, aero::MAGIC, 4);
+    h.version = aero::VERSION;
+    h.naxes = static_cast<uint32_t>(spec.axes.size());
+    h.ncoef = static_cast<uint32_t>(spec.coefficients.size());
+
+    std::vector<uint32_t> axis, size;
+    for (size_t a = 0; a < spec.axes.size(); a++) {
+        axis.push_back(static_cast<uint32_t>(spec.axes[a]));
+        size.push_back(static_cast<uint32_t>(spec.breakpoints[a].size()));
+    }
+
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(axis.data(), sizeof(uint32_t), axis.size(), f) == axis.size() &&
+              std::fwrite(size.data(), sizeof(uint32_t), size.size(), f) == size.size();
+    for (size_t a = 0; ok && a < spec.breakpoints.size(); a++) {
+        const std::vector<double>& b = spec.breakpoints[a];
+        ok = std::fwrite(b.data(), sizeof(double), b.size(), f) == b.size();
+    }
+    for (size_t k = 0; ok && k < spec.coefficients.size(); k++) {
+        char name[aero::NAME_LENGTH] = {};
+        std::strncpy(name, spec.coefficients[k].c_str(), aero::NAME_LENGTH - 1);
+        ok = std::fwrite(name, 1, aero::NAME_LENGTH, f) == aero::NAME_LENGTH;
+    }
+    ok = ok && std::fwrite(data.data(), sizeof(double), data.size(), f) == data.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// ---------------------------------------------------------------------------
+// Lookup
+// ---------------------------------------------------------------------------
+
+void AeroDatabase::locate(const double x[], Cursor& c) const {
+    for (int j = 0; j < ninterp_; j++) {
+        const std::vector<double>& b = spec_.breakpoints[interp_axis_[j]];
+        const int32_t n = static_cast<int32_t>(b.size());
+        int32_t k;
+        if (c.valid) {
+            // Flight conditions change slowly: walk from the last cell
+            k = std::clamp(c.index[j], 0, n - 2);
+            while (k > 0 && x[j] < b[k]) k--;
+            while (k < n - 2 && x[j] > b[k + 1]) k++;
+        } else {
+            k = static_cast<int32_t>(std::upper_bound(b.begin(), b.end(), x[j]) - b.begin()) - 1;
+            k = std::clamp(k, 0, n - 2);
+        }
+        c.index[j] = k;
+        c.lo[j] = b[k];
+        c.hi[j] = b[k + 1];
+        c.offset[j][0] = k * node_stride_[j];
+        c.offset[j][1] = (k + 1) * node_stride_[j];
+    }
+    c.valid = true;
+}
+
+void AeroDatabase::evaluate(const AeroCondition& condition, Cursor& c, double* out) const {
+    const size_t ncoef = spec_.coefficients.size();
+    if (data_.empty()) {
+        std::fill(out, out + ncoef, 0.0);
+        return;
+    }
+
+    const double field[MAX_AXES] = {
+        condition.mach, condition.alpha, condition.beta,
+        condition.elevator, condition.aileron, condition.rudder
+    };
+    double x[MAX_AXES] = {};
+    for (int j = 0; j < ninterp_; j++) {
+        const std::vector<double>& b = spec_.breakpoints[interp_axis_[j]];
+        x[j] = std::clamp(field[source_[j]], b.front(), b.back());
+    }
+    if (!c.valid || !inside(c, x, ninterp_)) locate(x, c);
+
+    // Corner weights and offsets, one axis at a time
+    double weight[1 << MAX_AXES];
+    size_t offset[1 << MAX_AXES];
+    weight[0] = 1.0;
+    offset[0] = 0;
+    int corners = 1;
+    for (int j = 0; j < ninterp_; j++) {
+        double f = (x[j] - c.lo[j]) / (c.hi[j] - c.lo[j]);
+        for (int k = 0; k < corners; k++) {
+            weight[corners + k] = weight[k] * f;
+            offset[corners + k] = offset[k] + c.offset[j][1];
+            weight[k] *= 1.0 - f;
+            offset[k] += c.offset[j][0];
+        }
+        corners *= 2;
+    }
+
+    // Blend all coefficients of each cell corner at once (stride_ is a
+    // multiple of 4, so the inner block maps onto vector lanes)
+    double acc[MAX_COEFFICIENTS] = {};
+    const size_t stride = stride_;
+    for (int k = 0; k < corners; k++) {
+        const double wk = weight[k];
+        if (wk == 0.0) continue;
+        const double* node = data_.data() + offset[k];
+        for (size_t i = 0; i < stride; i += 4) {
+            acc[i] += wk * node[i];
+            acc[i + 1] += wk * node[i + 1];
+            acc[i + 2] += wk * node[i + 2];
+            acc[i + 3] += wk * node[i + 3];
+        }
+    }
+    std::copy(acc, acc + ncoef, out);
+}
+
+void AeroDatabase::evaluate(size_t n, const AeroCondition* conditions, Cursor* cursors,
+                            double* out) const {
+    const size_t ncoef = spec_.coefficients.size();
+    for (size_t i = 0; i < n; i++) {
+        evaluate(conditions[i], cursors[i], out + i * ncoef);
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,178 @@
+/**
+ * Tabulated Aerodynamic Database - N-D coefficient tables for 6DOF flight
+ *
+ * Coefficients tabulated over up to six flight-condition axes (Mach,
+ * alpha, beta, elevator, aileron, rudder), as produced by wind-tunnel or
+ * DATCOM builds. Every coefficient in a database shares one grid, and the
+ * nodes store their coefficients contiguously (padded to a multiple of 4),
+ * so one bracket search and one set of weights serve all of them and the
+ * blend of each cell corner is a single contiguous multiply-add that the
+ * compiler vectorizes.
+ *
+ * Layout (".aero", little-endian, as written by the host):
+ *   header   aero::Header (32 bytes)
+ *   axes     u32 axis[naxes]           AeroAxis, outermost first
+ *            u32 size[naxes]           Breakpoints per axis
+ *            f64 breakpoints[sum size] Increasing per axis [rad, or Mach]
+ *   names    char[16] per coefficient  NUL-padded, e.g. "Cm", "Cl_p"
+ *   data     f64 [size0]...[sizeN-1][ncoef]
+ *
+ * Lookups are multilinear over the axes with more than one breakpoint.
+ * Queries outside the grid are clamped to its edges (no extrapolation).
+ * A Cursor kept per aircraft caches the enclosing cell: while the flight
+ * condition stays inside it a lookup is only the weights and the corner
+ * blend, and when it leaves, each axis walks from the previous cell.
+ *
+ * Moment coefficients recognised by Aerodynamics6DOF (any may be absent):
+ *   Cl, Cm, Cn         Static roll / pitch / yaw, including control effects
+ *   Cl_p, Cm_q, Cn_r   Rate damping [per nondimensional rate]
+ *
+ * Usage:
+ *   auto db = std::make_shared<AeroDatabase>();
+ *   db->open("f16_moments.aero");
+ *   AeroDatabase::Cursor c;
+ *   std::vector<double> coef(db->num_coefficients());
+ *   db->evaluate(condition, c, coef.data());
+ *
+ * A database is immutable once loaded and may be shared across threads;
+ * cursors belong to one caller and one database.
+ */
+
+#ifndef SIM_AERO_DATABASE_HPP
+#define SIM_AERO_DATABASE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+namespace aero {
+
+constexpr char MAGIC[4] = {'A', 'E', 'R', 'O'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t NAME_LENGTH = 16;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t naxes;
+    uint32_t ncoef;
+    uint32_t reserved[4];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 32, "aero database header layout");
+
+} // namespace aero
+
+/// Table dimension
+enum class AeroAxis : uint32_t {
+    MACH,
+    ALPHA,      // [rad]
+    BETA,       // [rad]
+    ELEVATOR,   // [rad]
+    AILERON,    // [rad]
+    RUDDER,     // [rad]
+    COUNT
+};
+
+/// Flight condition at which the tables are evaluated
+struct AeroCondition {
+    double mach = 0.0;
+    double alpha = 0.0;      // [rad]
+    double beta = 0.0;       // [rad]
+    double elevator = 0.0;   // [rad]
+    double aileron = 0.0;    // [rad]
+    double rudder = 0.0;     // [rad]
+};
+
+/// Table geometry and coefficient names
+struct AeroTableSpec {
+    std::vector<AeroAxis> axes;                      // Outermost first, each at most once
+    std::vector<std::vector<double>> breakpoints;    // Per axis, increasing
+    std::vector<std::string> coefficients;           // Names, < 16 characters
+
+    size_t nodes() const {
+        size_t n = 1;
+        for (const auto& b : breakpoints) n *= b.size();
+        return n;
+    }
+    size_t values() const { return nodes() * coefficients.size(); }
+};
+
+class AeroDatabase {
+public:
+    static constexpr int MAX_AXES = static_cast<int>(AeroAxis::COUNT);
+    static constexpr size_t MAX_COEFFICIENTS = 32;
+
+    /// Cached enclosing cell of one moving flight condition
+    struct Cursor {
+        bool valid = false;
+        double lo[MAX_AXES], hi[MAX_AXES];   // Cell bounds per interpolated axis
+        size_t offset[MAX_AXES][2];          // Data offsets of the two nodes per axis
+        int32_t index[MAX_AXES];             // Lower breakpoint per axis
+    };
+
+    /// Columns of the moment coefficients (-1 = not tabulated)
+    struct MomentColumns {
+        int Cl = -1, Cm = -1, Cn = -1;
+        int Cl_p = -1, Cm_q = -1, Cn_r = -1;
+    };
+
+    AeroDatabase() = default;
+
+    /** Read a .aero file. @return false if missing or malformed (database left empty) */
+    bool open(const std::string& filename);
+
+    /**
+     * Use in-memory tables, laid out as the file's data section.
+     * @return false if data's size or the spec is inconsistent
+     */
+    bool assign(const AeroTableSpec& spec, const std::vector<double>& data);
+
+    void clear();
+    bool is_loaded() const { return !data_.empty(); }
+    const AeroTableSpec& spec() const { return spec_; }
+    size_t num_coefficients() const { return spec_.coefficients.size(); }
+
+    /** Column of a named coefficient, -1 if absent */
+    int column(const std::string& name) const;
+
+    const MomentColumns& moment_columns() const { return moments_; }
+
+    /** Write a .aero file. @return true on success */
+    static bool write(const std::string& filename, const AeroTableSpec& spec,
+                      const std::vector<double>& data);
+
+    /**
+     * Every coefficient at a flight condition, in spec order, into
+     * out[num_coefficients()]. Zero if no tables are loaded.
+     */
+    void evaluate(const AeroCondition& condition, Cursor& cursor, double* out) const;
+
+    /** Batched evaluate of n conditions, one cursor each, out[n][num_coefficients()] */
+    void evaluate(size_t n, const AeroCondition* conditions, Cursor* cursors,
+                  double* out) const;
+
+private:
+    AeroTableSpec spec_;
+    std::vector<double> data_;                // [node][stride_]
+    size_t stride_ = 0;                       // Coefficients per node, padded
+    MomentColumns moments_;
+
+    // Interpolated axes (more than one breakpoint)
+    int ninterp_ = 0;
+    int interp_axis_[MAX_AXES];               // Index into spec_.axes
+    int source_[MAX_AXES];                    // Condition field per interpolated axis
+    size_t node_stride_[MAX_AXES];            // Data stride per interpolated axis
+
+    bool validate(const AeroTableSpec& spec, size_t values) const;
+    void locate(const double x[], Cursor& cursor) const;
+};
+
+} // namespace sim
+
+#endif // SIM_AERO_DATABASE_HPP
@@ -4,6 +4,7 @@
 
 #include "aerobraking.hpp"
 #include "atmosphere_model.hpp"
+#include "atmosphere_table.hpp"
 #include "gravity_model.hpp"
 #include "propagators/rk4_integrator.hpp"
 #include <cmath>
@@ -147,7 +148,7 @@ AerobrakePassResult AerobrakingCalculator::simulate_pass(
         }
 
         // Compute current conditions
-        double rho = AtmosphereModel::get_density_extended(altitude);
+        double rho = AtmosphereTable::earth().density(altitude);
         double q = AtmosphereModel::dynamic_pressure(velocity, altitude);
         double heat_flux = AtmosphereModel::compute_heat_flux(
             velocity, altitude, vehicle.nose_radius);
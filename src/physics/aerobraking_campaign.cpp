@@ -0,0 +1,258 @@
+/**
+ * Aerobraking Campaign Simulator Implementation
+ */
+
+#include "aerobraking_campaign.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace sim {
+
+// Earth parameters (as in AerobrakingCalculator)
+static constexpr double EARTH_MU = 3.986004418e14;
+static constexpr double EARTH_RADIUS = 6378137.0;
+static constexpr double PI = 3.14159265358979323846;
+static constexpr double PASS_TIME_LIMIT = 600.0;   // simulate_pass stops a pass here
+
+// ============================================================
+// AerobrakeSurrogate
+// ============================================================
+
+bool AerobrakeSurrogate::entry_state(double perigee_altitude, double entry_velocity,
+                                     StateVector& out) {
+    double r_e = EARTH_RADIUS + AerobrakingCalculator::ENTRY_INTERFACE;
+    double r_p = EARTH_RADIUS + perigee_altitude;
+    double inv_a = 2.0 / r_e - entry_velocity * entry_velocity / EARTH_MU;
+    if (!(inv_a > 0.0) || !(r_p < r_e)) return false;
+
+    double a = 1.0 / inv_a;
+    double e = 1.0 - r_p / a;
+    if (!(e > 0.0)) return false;
+    double p = a * (1.0 - e * e);
+    double cos_nu = (p / r_e - 1.0) / e;
+    if (std::abs(cos_nu) > 1.0) return false;
+    double nu = -std::acos(cos_nu);   // Descending toward periapsis
+
+    double v_scale = std::sqrt(EARTH_MU / p);
+    out = StateVector();
+    out.position = Vec3(r_e * std::cos(nu), r_e * std::sin(nu), 0.0);
+    out.velocity = Vec3(-v_scale * std::sin(nu), v_scale * (e + std::cos(nu)), 0.0);
+    return true;
+}
+
+std::shared_ptr<const AerobrakeSurrogate> AerobrakeSurrogate::fit(
+    const AerobrakeVehicle& vehicle,
+    const AerobrakeSurrogateGrid& grid,
+    int num_threads) {
+
+    std::shared_ptr<AerobrakeSurrogate> s(new AerobrakeSurrogate());
+    s->vehicle_ = vehicle;
+    s->grid_ = grid;
+    s->grid_.perigee_nodes = std::max(2, grid.perigee_nodes);
+    s->grid_.velocity_nodes = std::max(2, grid.velocity_nodes);
+
+    const AerobrakeSurrogateGrid& g = s->grid_;
+    size_t n = static_cast<size_t>(g.perigee_nodes) * g.velocity_nodes;
+    s->nodes_.resize(n);
+
+    auto simulate = [&](size_t k) {
+        int i = static_cast<int>(k / g.velocity_nodes);
+        int j = static_cast<int>(k % g.velocity_nodes);
+        double hp = g.perigee_min + (g.perigee_max - g.perigee_min) * i / (g.perigee_nodes - 1);
+        double ve = g.entry_velocity_min +
+                    (g.entry_velocity_max - g.entry_velocity_min) * j / (g.velocity_nodes - 1);
+
+        Prediction& p = s->nodes_[k];
+        StateVector entry;
+        if (!entry_state(hp, ve, entry)) {
+            p.delta_v_loss = std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+        AerobrakePassResult r = AerobrakingCalculator::simulate_pass(entry, vehicle, g.dt);
+        if (r.min_altitude <= 0.0 || r.pass_duration >= PASS_TIME_LIMIT) {
+            // Impact or capture: no smooth pass to interpolate
+            p.delta_v_loss = std::numeric_limits<double>::quiet_NaN();
+            return;
+        }
+        p.delta_v_loss = r.delta_v_loss;
+        p.total_heat_load = r.total_heat_load;
+        p.max_heat_flux = r.max_heat_flux;
+        p.max_g_load = r.max_g_load;
+        p.max_dynamic_pressure = r.max_dynamic_pressure;
+        p.pass_duration = r.pass_duration;
+        p.perigee_change = r.new_perigee - hp;
+    };
+
+    if (num_threads != 1 && n > 1) {
+        ThreadPool pool(num_threads);
+        pool.parallel_for(n, simulate);
+    } else {
+        for (size_t k = 0; k < n; k++) simulate(k);
+    }
+    return s;
+}
+
+bool AerobrakeSurrogate::predict(double perigee_altitude, double entry_velocity,
+                                 Prediction& out) const {
+    const AerobrakeSurrogateGrid& g = grid_;
+    double u = (perigee_altitude - g.perigee_min) / (g.perigee_max - g.perigee_min) *
+               (g.perigee_nodes - 1);
+    double w = (entry_velocity - g.entry_velocity_min) /
+               (g.entry_velocity_max - g.entry_velocity_min) * (g.velocity_nodes - 1);
+    if (!(u >= 0.0 && u <= g.perigee_nodes - 1 && w >= 0.0 && w <= g.velocity_nodes - 1)) {
+        return false;
+    }
+
+    int i = std::min(static_cast<int>(u), g.perigee_nodes - 2);
+    int j = std::min(static_cast<int>(w), g.velocity_nodes - 2);
+    double fu = u - i;
+    double fw = w - j;
+
+    const Prediction& p00 = nodes_[static_cast<size_t>(i) * g.velocity_nodes + j];
+    const Prediction& p01 = nodes_[static_cast<size_t>(i) * g.velocity_nodes + j + 1];
+    const Prediction& p10 = nodes_[static_cast<size_t>(i + 1) * g.velocity_nodes + j];
+    const Prediction& p11 = nodes_[static_cast<size_t>(i + 1) * g.velocity_nodes + j + 1];
+    if (std::isnan(p00.delta_v_loss) || std::isnan(p01.delta_v_loss) ||
+        std::isnan(p10.delta_v_loss) || std::isnan(p11.delta_v_loss)) {
+        return false;
+    }
+
+    auto lerp = [&](double Prediction::*field) {
+        double lo = p00.*field + fw * (p01.*field - p00.*field);
+        double hi = p10.*field + fw * (p11.*field - p10.*field);
+        return lo + fu * (hi - lo);
+    };
+    out.delta_v_loss = lerp(&Prediction::delta_v_loss);
+    out.total_heat_load = lerp(&Prediction::total_heat_load);
+    out.max_heat_flux = lerp(&Prediction::max_heat_flux);
+    out.max_g_load = lerp(&Prediction::max_g_load);
+    out.max_dynamic_pressure = lerp(&Prediction::max_dynamic_pressure);
+    out.pass_duration = lerp(&Prediction::pass_duration);
+    out.perigee_change = lerp(&Prediction::perigee_change);
+    return true;
+}
+
+// ============================================================
+// AerobrakeCampaign
+// ============================================================
+
+AerobrakeCampaign::AerobrakeCampaign(std::shared_ptr<const AerobrakeSurrogate> surrogate,
+                                     const AerobrakeCampaignConfig& config)
+    : surrogate_(std::move(surrogate)), config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+AerobrakeCampaign::~AerobrakeCampaign() = default;
+
+bool AerobrakeCampaign::near_constraint(const AerobrakeSurrogate::Prediction& p) const {
+    double m = config_.constraint_margin;
+    return (config_.max_heat_flux > 0.0 && p.max_heat_flux >= m * config_.max_heat_flux) ||
+           (config_.max_heat_load > 0.0 && p.total_heat_load >= m * config_.max_heat_load) ||
+           (config_.max_g_load > 0.0 && p.max_g_load >= m * config_.max_g_load);
+}
+
+AerobrakeTrialResult AerobrakeCampaign::run_trial(int trial) const {
+    AerobrakeTrialResult result;
+    std::mt19937_64 rng(config_.seed + static_cast<uint64_t>(trial));
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    double apogee = config_.initial_apogee + config_.apogee_sigma * normal(rng);
+    double perigee = config_.initial_perigee + config_.perigee_sigma * normal(rng);
+    const double r_e = EARTH_RADIUS + AerobrakingCalculator::ENTRY_INTERFACE;
+
+    while (result.passes < config_.max_passes) {
+        if (apogee <= config_.target_apogee) {
+            result.reached_target = true;
+            break;
+        }
+        perigee += config_.pass_perigee_sigma * normal(rng);
+        if (perigee >= AerobrakingCalculator::ENTRY_INTERFACE) break;   // Left the atmosphere
+
+        double a = EARTH_RADIUS + 0.5 * (apogee + perigee);
+        double entry_velocity = std::sqrt(EARTH_MU * (2.0 / r_e - 1.0 / a));
+
+        // Surrogate pass unless off the grid or near a limit
+        AerobrakeSurrogate::Prediction p;
+        bool surrogate_pass = surrogate_->predict(perigee, entry_velocity, p) && !near_constraint(p);
+        double duration;
+        double new_apogee, new_perigee;
+        if (surrogate_pass) {
+            double v_exit = entry_velocity - p.delta_v_loss;
+            double energy = 0.5 * v_exit * v_exit - EARTH_MU / r_e;
+            if (!(energy < 0.0)) break;   // Escaped
+            double a_new = -EARTH_MU / (2.0 * energy);
+            new_perigee = perigee + p.perigee_change;
+            new_apogee = 2.0 * a_new - 2.0 * EARTH_RADIUS - new_perigee;
+
+            duration = p.pass_duration;
+            result.total_delta_v += p.delta_v_loss;
+            result.total_heat_load += p.total_heat_load;
+            result.peak_heat_flux = std::max(result.peak_heat_flux, p.max_heat_flux);
+            result.peak_g_load = std::max(result.peak_g_load, p.max_g_load);
+        } else {
+            StateVector entry;
+            if (!AerobrakeSurrogate::entry_state(perigee, entry_velocity, entry)) break;
+            AerobrakePassResult r = AerobrakingCalculator::simulate_pass(
+                entry, surrogate_->vehicle(), surrogate_->grid().dt);
+            result.full_fidelity_passes++;
+
+            new_apogee = r.new_apogee;
+            new_perigee = r.new_perigee;
+            duration = r.pass_duration;
+            result.total_delta_v += r.delta_v_loss;
+            result.total_heat_load += r.total_heat_load;
+            result.peak_heat_flux = std::max(result.peak_heat_flux, r.max_heat_flux);
+            result.peak_g_load = std::max(result.peak_g_load, r.max_g_load);
+
+            if ((config_.max_heat_flux > 0.0 && r.max_heat_flux > config_.max_heat_flux) ||
+                (config_.max_heat_load > 0.0 && r.total_heat_load > config_.max_heat_load) ||
+                (config_.max_g_load > 0.0 && r.max_g_load > config_.max_g_load)) {
+                result.constraint_violated = true;
+            }
+            if (r.min_altitude <= 0.0) {
+                result.passes++;
+                result.elapsed_time += duration;
+                result.impacted = true;
+                break;
+            }
+        }
+
+        result.passes++;
+        result.elapsed_time += duration;
+        if (new_apogee < new_perigee) std::swap(new_apogee, new_perigee);
+        apogee = new_apogee;
+        perigee = new_perigee;
+        if (perigee <= 0.0) {
+            result.impacted = true;
+            break;
+        }
+
+        // Exo-atmospheric coast to the next entry: one period of the new
+        // orbit less the time spent below the interface
+        if (apogee > config_.target_apogee) {
+            double a_new = EARTH_RADIUS + 0.5 * (apogee + perigee);
+            double period = 2.0 * PI * std::sqrt(a_new * a_new * a_new / EARTH_MU);
+            result.elapsed_time += std::max(0.0, period - duration);
+        }
+    }
+
+    if (apogee <= config_.target_apogee) result.reached_target = true;
+    result.final_apogee = apogee;
+    result.final_perigee = perigee;
+    return result;
+}
+
+std::vector<AerobrakeTrialResult> AerobrakeCampaign::run(int trials) const {
+    std::vector<AerobrakeTrialResult> results(static_cast<size_t>(std::max(0, trials)));
+    auto one = [&](size_t k) { results[k] = run_trial(static_cast<int>(k)); };
+    if (pool_ && results.size() > 1) pool_->parallel_for(results.size(), one);
+    else for (size_t k = 0; k < results.size(); k++) one(k);
+    return results;
+}
+
+}  // namespace sim
@@ -0,0 +1,162 @@
+/**
+ * Aerobraking Campaign Simulator
+ *
+ * Runs whole aerobraking campaigns (hundreds of passes, thousands of
+ * dispersed trials) without integrating every pass in full.
+ *
+ * A pass-level surrogate is fitted once per vehicle from full
+ * AerobrakingCalculator::simulate_pass runs. The runs sit on a grid of
+ * periapsis altitude x entry-interface velocity. Each node stores the
+ * pass's velocity loss, heat load, peak heat flux, peak g and dynamic
+ * pressure, duration, and osculating perigee change. Campaign passes
+ * interpolate these bilinearly.
+ *
+ * Between passes the orbit coasts analytically. The elapsed time is the
+ * Kepler period less the pass duration, and the apsides change only
+ * through the pass. After a surrogate pass, the exit speed (entry minus
+ * the velocity loss) fixes the new energy at the interface, and the
+ * perigee shift fixes the new periapsis radius.
+ *
+ * A pass runs at full fidelity instead in three cases:
+ * - it leaves the surrogate grid;
+ * - it touches a node whose fit pass impacted or did not exit;
+ * - a predicted peak is within constraint_margin of its limit. The
+ * constraint decisions therefore always come from the full model.
+ *
+ * Trials disperse the initial apsides and add a Gaussian periapsis error
+ * before every pass (navigation and atmosphere variability). Trials run
+ * in parallel, each with its own RNG stream (seed + trial index), so the
+ * results do not depend on the thread count.
+ *
+ * The surrogate's geometry is equatorial and ballistic with the nominal
+ * AtmosphereTable::earth() density, as in simulate_pass.
+ */
+
+#ifndef SIM_AEROBRAKING_CAMPAIGN_HPP
+#define SIM_AEROBRAKING_CAMPAIGN_HPP
+
+#include "physics/aerobraking.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+struct AerobrakeSurrogateGrid {
+    double perigee_min = 80000.0;        // [m] altitude
+    double perigee_max = 118000.0;
+    int perigee_nodes = 20;
+    double entry_velocity_min = 7900.0;  // [m/s] at ENTRY_INTERFACE
+    double entry_velocity_max = 10900.0;
+    int velocity_nodes = 31;
+    double dt = 0.1;                     // simulate_pass step [s]
+};
+
+/**
+ * Pass outcome tables over (periapsis altitude, entry velocity)
+ */
+class AerobrakeSurrogate {
+public:
+    struct Prediction {
+        double delta_v_loss;             // [m/s]
+        double total_heat_load;          // [J/m^2]
+        double max_heat_flux;            // [W/m^2]
+        double max_g_load;               // [g]
+        double max_dynamic_pressure;     // [Pa]
+        double pass_duration;            // [s]
+        double perigee_change;           // New perigee - old perigee [m]
+    };
+
+    /**
+     * Fit by full simulation at every grid node
+     * @param num_threads 0 = hardware concurrency, 1 = serial
+     */
+    static std::shared_ptr<const AerobrakeSurrogate> fit(
+        const AerobrakeVehicle& vehicle,
+        const AerobrakeSurrogateGrid& grid = AerobrakeSurrogateGrid(),
+        int num_threads = 0);
+
+    /**
+     * Equatorial state at ENTRY_INTERFACE, descending, on the orbit with
+     * the given perigee altitude and interface speed
+     * @return false if that orbit does not reach the interface
+     */
+    static bool entry_state(double perigee_altitude, double entry_velocity, StateVector& out);
+
+    /// Interpolated prediction; false outside the grid
+    bool predict(double perigee_altitude, double entry_velocity, Prediction& out) const;
+
+    const AerobrakeSurrogateGrid& grid() const { return grid_; }
+    const AerobrakeVehicle& vehicle() const { return vehicle_; }
+
+private:
+    AerobrakeVehicle vehicle_;
+    AerobrakeSurrogateGrid grid_;
+    std::vector<Prediction> nodes_;      // [perigee][velocity]
+
+    AerobrakeSurrogate() = default;
+};
+
+struct AerobrakeCampaignConfig {
+    double initial_apogee = 50000e3;     // [m] altitude
+    double initial_perigee = 100000.0;   // [m] altitude
+    double target_apogee = 2000e3;       // [m] campaign ends at or below this
+    int max_passes = 1000;
+
+    // Per-pass limits; 0 = unconstrained
+    double max_heat_flux = 0.0;          // [W/m^2]
+    double max_heat_load = 0.0;          // [J/m^2]
+    double max_g_load = 0.0;             // [g]
+    double constraint_margin = 0.8;      // Full fidelity above this fraction of a limit
+
+    // Dispersions (1-sigma)
+    double apogee_sigma = 0.0;           // [m]
+    double perigee_sigma = 0.0;          // [m] initial
+    double pass_perigee_sigma = 0.0;     // [m] added before every pass
+
+    uint64_t seed = 1;
+    int num_threads = 0;                 // 0 = hardware concurrency, 1 = serial
+};
+
+struct AerobrakeTrialResult {
+    bool reached_target = false;
+    bool constraint_violated = false;    // A full-fidelity pass exceeded a limit
+    bool impacted = false;
+    int passes = 0;
+    int full_fidelity_passes = 0;
+
+    double final_apogee = 0.0;           // [m] altitude
+    double final_perigee = 0.0;
+    double elapsed_time = 0.0;           // [s] first entry to last exit
+    double total_delta_v = 0.0;          // [m/s] summed velocity loss
+    double total_heat_load = 0.0;        // [J/m^2]
+    double peak_heat_flux = 0.0;         // [W/m^2]
+    double peak_g_load = 0.0;            // [g]
+};
+
+class AerobrakeCampaign {
+public:
+    AerobrakeCampaign(std::shared_ptr<const AerobrakeSurrogate> surrogate,
+                      const AerobrakeCampaignConfig& config = AerobrakeCampaignConfig());
+    ~AerobrakeCampaign();
+
+    /// One trial (trial 0 with zero sigmas is the nominal campaign)
+    AerobrakeTrialResult run_trial(int trial) const;
+
+    /// Trials 0..trials-1 in parallel
+    std::vector<AerobrakeTrialResult> run(int trials) const;
+
+private:
+    std::shared_ptr<const AerobrakeSurrogate> surrogate_;
+    AerobrakeCampaignConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+
+    /// Whether a predicted pass comes within constraint_margin of a limit
+    bool near_constraint(const AerobrakeSurrogate::Prediction& p) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_AEROBRAKING_CAMPAIGN_HPP
@@ -57,6 +57,64 @@ AeroMoments Aerodynamics6DOF::compute_aero_moments(
     return moments;
 }
 
+AeroMoments Aerodynamics6DOF::compute_aero_moments(
+    const AeroDatabase& db, AeroDatabase::Cursor& cursor,
+    double mach, double alpha, double beta,
+    const Vec3& omega,
+    double q_bar, double V,
+    const ControlSurfaces& controls,
+    const MomentCoefficients& geometry) {
+
+    AeroMoments moments{0.0, 0.0, 0.0};
+    if (V < 1.0 || q_bar < 0.1) {
+        return moments;
+    }
+
+    AeroCondition condition;
+    condition.mach = mach;
+    condition.alpha = alpha;
+    condition.beta = beta;
+    condition.elevator = controls.elevator;
+    condition.aileron = controls.aileron;
+    condition.rudder = controls.rudder;
+
+    double coef[AeroDatabase::MAX_COEFFICIENTS];
+    db.evaluate(condition, cursor, coef);
+    const AeroDatabase::MomentColumns& col = db.moment_columns();
+    auto get = [&coef](int k) { return k >= 0 ? coef[k] : 0.0; };
+
+    double S = geometry.wing_area;
+    double b = geometry.wing_span;
+    double c = geometry.mean_chord;
+    double b_2V = b / (2.0 * V);
+    double c_2V = c / (2.0 * V);
+
+    moments.L = q_bar * S * b * (get(col.Cl) + get(col.Cl_p) * omega.x * b_2V);
+    moments.M = q_bar * S * c * (get(col.Cm) + get(col.Cm_q) * omega.y * c_2V);
+    moments.N = q_bar * S * b * (get(col.Cn) + get(col.Cn_r) * omega.z * b_2V);
+    return moments;
+}
+
+void Aerodynamics6DOF::compute_aero_moments(
+    size_t n,
+    const AeroDatabase& db, AeroDatabase::Cursor* cursors,
+    const AeroCondition* conditions,
+    const Vec3* omega,
+    const double* q_bar, const double* V,
+    const MomentCoefficients& geometry,
+    AeroMoments* out) {
+
+    for (size_t i = 0; i < n; i++) {
+        const AeroCondition& ci = conditions[i];
+        ControlSurfaces controls;
+        controls.elevator = ci.elevator;
+        controls.aileron = ci.aileron;
+        controls.rudder = ci.rudder;
+        out[i] = compute_aero_moments(db, cursors[i], ci.mach, ci.alpha, ci.beta,
+                                      omega[i], q_bar[i], V[i], controls, geometry);
+    }
+}
+
 Vec3 Aerodynamics6DOF::compute_angular_acceleration(
     const Vec3& omega,
     const AeroMoments& moments,
@@ -116,6 +174,15 @@ void Aerodynamics6DOF::step_rotation(
         alpha, beta, state.angular_velocity,
         q_bar, V, controls, moment_config);
 
+    step_rotation(state, moments, inertia, dt);
+}
+
+void Aerodynamics6DOF::step_rotation(
+    StateVector& state,
+    const AeroMoments& moments,
+    const InertiaMatrix& inertia,
+    double dt) {
+
     // 2. Euler's equation → angular acceleration
     Vec3 alpha_dot = compute_angular_acceleration(
         state.angular_velocity, moments, inertia);
@@ -8,12 +8,16 @@
  *
  * The 3DOF translational equations (V, gamma, heading) remain unchanged.
  * This layer adds: moments → angular rates → attitude quaternion.
+ *
+ * Moments come either from the linear derivatives in MomentCoefficients
+ * or from an AeroDatabase of tabulated coefficients.
  */
 
 #ifndef SIM_AERODYNAMICS_6DOF_HPP
 #define SIM_AERODYNAMICS_6DOF_HPP
 
 #include "core/state_vector.hpp"
+#include "physics/aero_database.hpp"
 #include "physics/vec3_ops.hpp"
 
 namespace sim {
@@ -134,6 +138,40 @@ public:
         const ControlSurfaces& controls,
         const MomentCoefficients& config);
 
+    /**
+     * Compute aerodynamic moments from tabulated coefficients
+     *
+     * Each moment coefficient is its static table (Cl, Cm, Cn, including
+     * control effects) plus its damping table times the nondimensional
+     * rate (Cl_p p b/2V, Cm_q q c/2V, Cn_r r b/2V). Absent tables count as
+     * zero. Reference area and lengths come from `geometry`.
+     *
+     * @param db Coefficient tables
+     * @param cursor Cached table cell for this aircraft
+     * @param mach Mach number
+     * @param geometry Reference geometry (derivatives are ignored)
+     */
+    static AeroMoments compute_aero_moments(
+        const AeroDatabase& db, AeroDatabase::Cursor& cursor,
+        double mach, double alpha, double beta,
+        const Vec3& omega,
+        double q_bar, double V,
+        const ControlSurfaces& controls,
+        const MomentCoefficients& geometry);
+
+    /**
+     * Batched tabulated moments for a fleet sharing one database
+     * (one cursor per aircraft; alpha, beta and deflections from conditions)
+     */
+    static void compute_aero_moments(
+        size_t n,
+        const AeroDatabase& db, AeroDatabase::Cursor* cursors,
+        const AeroCondition* conditions,
+        const Vec3* omega,
+        const double* q_bar, const double* V,
+        const MomentCoefficients& geometry,
+        AeroMoments* out);
+
     /**
      * Euler's equation: dω/dt = I⁻¹(M - ω × Iω)
      *
@@ -178,6 +216,15 @@ public:
         const MomentCoefficients& moment_config,
         const InertiaMatrix& inertia,
         double dt);
+
+    /**
+     * 6DOF rotational step from already computed moments (steps 2-4)
+     */
+    static void step_rotation(
+        StateVector& state,
+        const AeroMoments& moments,
+        const InertiaMatrix& inertia,
+        double dt);
 };
 
 }  // namespace sim
@@ -0,0 +1,251 @@
+/**
+ * Explicit Ascent Guidance Implementation
+ */
+
+#include "physics/ascent_guidance.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double MAX_RADIAL_FRACTION = 0.95;   // Keep some thrust horizontal
+
+Vec3 scaled(const Vec3& v, double s) { return Vec3(v.x * s, v.y * s, v.z * s); }
+
+Vec3 unit(const Vec3& v) { return scaled(v, 1.0 / v.norm()); }
+
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+/**
+ * Thrust-acceleration integrals of one burn of length T from the rocket
+ * equation, a(s) = ve / (tau - s):
+ *   L = int a ds, J = int a s ds, K = int a s^2 ds over [0, T]
+ */
+struct BurnIntegrals {
+    double L, J, K;
+
+    BurnIntegrals(double ve, double tau, double T) {
+        L = -ve * std::log(1.0 - T / tau);
+        J = tau * L - ve * T;
+        K = tau * J - 0.5 * ve * T * T;
+    }
+};
+
+/// One remaining burn on the guidance timeline
+struct Segment {
+    double start;     // From now [s]
+    double duration;  // [s]
+    double ve;        // [m/s]
+    double tau;       // Time to burn the stage's whole mass [s]
+};
+
+}  // namespace
+
+AscentTarget AscentTarget::circular(double radius, double inclination_deg,
+                                    const Vec3& position, const Vec3& velocity, double mu) {
+    AscentTarget target;
+    target.radius = radius;
+    target.radial_velocity = 0.0;
+    target.horizontal_velocity = std::sqrt(mu / radius);
+
+    // Normal (sin i cos p, sin i sin p, cos i) perpendicular to the position
+    const double inc = inclination_deg * PI / 180.0;
+    const double rho = std::hypot(position.x, position.y);
+    const double lon = std::atan2(position.y, position.x);
+    const double arg = std::sin(inc) * rho > 0.0
+        ? -std::cos(inc) * position.z / (std::sin(inc) * rho) : 0.0;
+    const double offset = std::acos(std::max(-1.0, std::min(1.0, arg)));
+
+    // Of the two planes, the one running along the horizontal velocity
+    const Vec3 r_hat = unit(position);
+    double best = -2.0;
+    for (double phi : {lon + offset, lon - offset}) {
+        const Vec3 n(std::sin(inc) * std::cos(phi), std::sin(inc) * std::sin(phi), std::cos(inc));
+        const Vec3 downrange = cross(n, r_hat);
+        const double along = downrange.x * velocity.x + downrange.y * velocity.y +
+                             downrange.z * velocity.z;
+        if (along > best) {
+            best = along;
+            target.plane_normal = unit(n);
+        }
+    }
+    return target;
+}
+
+AscentGuidance::AscentGuidance(const AscentTarget& target, const AscentGuidanceConfig& config)
+    : target_(target), config_(config) {}
+
+void AscentGuidance::update(const Vec3& position, const Vec3& velocity, double t,
+                            const std::vector<GuidanceStage>& stages) {
+    if (terminal_ || stages.empty()) return;
+    const double mu = config_.mu;
+
+    // Target-plane frame at the vehicle
+    const Vec3& normal = target_.plane_normal;
+    const double r = position.norm();
+    const Vec3 r_hat = scaled(position, 1.0 / r);
+    const Vec3 downrange = unit(cross(normal, r_hat));
+    const double vr = velocity.x * r_hat.x + velocity.y * r_hat.y + velocity.z * r_hat.z;
+    const double vt = velocity.x * downrange.x + velocity.y * downrange.y + velocity.z * downrange.z;
+    const double pn = position.x * normal.x + position.y * normal.y + position.z * normal.z;
+    const double vn = velocity.x * normal.x + velocity.y * normal.y + velocity.z * normal.z;
+
+    const double rt = target_.radius;
+    const double vrt = target_.radial_velocity;
+    const double vtt = target_.horizontal_velocity;
+
+    std::vector<Segment> burns;
+    burns.reserve(stages.size());
+    for (const auto& s : stages) {
+        const double ve = s.exhaust_velocity;
+        burns.push_back({0.0, s.burn_time, ve, s.mass * ve / s.thrust});
+    }
+
+    // Time to go carried from the last cycle; on the first, from the speed
+    // still to gain
+    double T = time_to_go_ - (t - last_update_);
+    if (updates_ == 0) {
+        double dv = std::hypot(vtt - vt, vrt - vr);
+        T = 0.0;
+        for (size_t i = 0; i < burns.size(); i++) {
+            const Segment& b = burns[i];
+            const double full = BurnIntegrals(b.ve, b.tau, b.duration).L;
+            if (dv <= full || i + 1 == burns.size()) {
+                T += b.tau * (1.0 - std::exp(-dv / b.ve));
+                break;
+            }
+            dv -= full;
+            T += b.duration;
+        }
+    }
+
+    // Burn timeline for T: whole stages, then the one that ends it
+    auto timeline = [&](double total) {
+        std::vector<Segment> out;
+        double start = 0.0;
+        for (size_t i = 0; i < burns.size(); i++) {
+            Segment b = burns[i];
+            b.start = start;
+            const bool last = i + 1 == burns.size();
+            if (start + b.duration >= total || last) {
+                b.duration = std::min(std::max(total - start, 1e-3), 0.999 * b.tau);
+                out.push_back(b);
+                break;
+            }
+            out.push_back(b);
+            start += b.duration;
+        }
+        return out;
+    };
+
+    // Radial channel: A and B for the target radius and radial velocity
+    std::vector<Segment> segs = timeline(T);
+    T = segs.back().start + segs.back().duration;
+    double m11 = 0.0, m12 = 0.0, m21 = 0.0, m22 = 0.0;
+    for (const Segment& s : segs) {
+        const BurnIntegrals I(s.ve, s.tau, s.duration);
+        const double d = T - s.start;
+        m11 += I.L;
+        m12 += I.J + s.start * I.L;
+        m21 += d * I.L - I.J;
+        m22 += s.start * d * I.L + (d - s.start) * I.J - I.K;
+    }
+    const double rhs1 = vrt - vr;
+    const double rhs2 = rt - r - vr * T;
+    const double det = m11 * m22 - m12 * m21;
+    if (!(std::fabs(det) > 0.0) || T < config_.terminal_time) {
+        terminal_ = true;
+        return;
+    }
+    const double A = (rhs1 * m22 - m12 * rhs2) / det;
+    const double B = (m11 * rhs2 - m21 * rhs1) / det;
+
+    // Normal channel, the same system: reach the target plane at rest in it
+    const double nrhs1 = -vn;
+    const double nrhs2 = -pn - vn * T;
+    const double D = (nrhs1 * m22 - m12 * nrhs2) / det;
+    const double E = (m11 * nrhs2 - m21 * nrhs1) / det;
+
+    // Gravity less centrifugal acceleration, per unit thrust acceleration
+    const Segment& end = segs.back();
+    const double a_now = stages.front().thrust / stages.front().mass;
+    const double a_end = end.ve / (end.tau - end.duration);
+    const double c0 = (mu / (r * r) - vt * vt / r) / a_now;
+    const double ct = (mu / (rt * rt) - vtt * vtt / rt) / a_end;
+
+    // Horizontal fraction f(t) = 1 - fr^2/2 as a quadratic in t
+    const double fr0 = A + c0;
+    const double frt = A + B * T + ct;
+    const double frd = (frt - fr0) / T;
+    const double f0 = 1.0 - 0.5 * fr0 * fr0;
+    const double f1 = -fr0 * frd;
+    const double f2 = -0.5 * frd * frd;
+
+    // Time to go: the angular momentum still to gain, from the stages that
+    // burn out, then the last burn's length
+    const double need = (rt * vtt - r * vt) / (0.5 * (r + rt));
+    double gained = 0.0, start = 0.0, T_new = T;
+    saturated_ = false;
+    for (size_t i = 0; i < burns.size(); i++) {
+        const Segment& b = burns[i];
+        const double g0 = f0 + start * (f1 + start * f2);
+        const double g1 = f1 + 2.0 * f2 * start;
+        const double Ts = std::min(std::max(T - start, 0.0), 0.999 * b.tau);
+        double dv = (need - gained + b.ve * Ts * (g1 + f2 * b.tau) + 0.5 * f2 * b.ve * Ts * Ts) /
+                    (g0 + g1 * b.tau + f2 * b.tau * b.tau);
+        const BurnIntegrals full(b.ve, b.tau, b.duration);
+        const bool last = i + 1 == burns.size();
+        if (dv <= full.L || last) {
+            saturated_ = dv > full.L;
+            dv = std::max(dv, 0.0);
+            T_new = start + std::min(b.tau * (1.0 - std::exp(-dv / b.ve)), 0.999 * b.tau);
+            break;
+        }
+        gained += g0 * full.L + g1 * full.J + f2 * full.K;
+        start += b.duration;
+    }
+
+    a_ = A;
+    b_ = B;
+    c0_ = c0;
+    ct_ = ct;
+    d_ = D;
+    e_ = E;
+    time_to_go_ = T_new;
+    last_update_ = t;
+    updates_++;
+    if (T_new < config_.terminal_time) terminal_ = true;
+}
+
+Vec3 AscentGuidance::steer(const Vec3& position, double t) const {
+    const Vec3 r_hat = unit(position);
+    if (updates_ == 0) return r_hat;
+    const Vec3& normal = target_.plane_normal;
+    const Vec3 downrange = unit(cross(normal, r_hat));
+
+    const double dt = t - last_update_;
+    const double blend = time_to_go_ > 0.0 ? std::min(std::max(dt / time_to_go_, 0.0), 1.0) : 1.0;
+    double fr = a_ + b_ * dt + c0_ + (ct_ - c0_) * blend;
+    fr = std::max(-MAX_RADIAL_FRACTION, std::min(MAX_RADIAL_FRACTION, fr));
+    const double fh_max = config_.max_normal_fraction;
+    const double fh = std::max(-fh_max, std::min(fh_max, d_ + e_ * dt));
+    const double ft = std::sqrt(std::max(0.0, 1.0 - fr * fr - fh * fh));
+    return Vec3(fr * r_hat.x + fh * normal.x + ft * downrange.x,
+                fr * r_hat.y + fh * normal.y + ft * downrange.y,
+                fr * r_hat.z + fh * normal.z + ft * downrange.z);
+}
+
+double AscentGuidance::energy_to_go(const Vec3& position, const Vec3& velocity) const {
+    const double v2 = velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z;
+    const double energy = 0.5 * v2 - config_.mu / position.norm();
+    const double vt2 = target_.horizontal_velocity * target_.horizontal_velocity +
+                       target_.radial_velocity * target_.radial_velocity;
+    return 0.5 * vt2 - config_.mu / target_.radius - energy;
+}
+
+} // namespace sim
@@ -0,0 +1,129 @@
+/**
+ * Explicit Ascent Guidance — closed-loop steering to orbit insertion
+ *
+ * LaunchTrajectorySolver finds an ascent by propagating the whole flight
+ * and Newton-iterating on the steering: exact, but milliseconds per solve
+ * and only from a nearby start. AscentGuidance instead re-plans from the
+ * vehicle's current state every guidance cycle, in closed form, in the
+ * manner of the Shuttle's Powered Explicit Guidance (PEG):
+ *
+ *   - In the plane of the target orbit, the radial thrust fraction is
+ *     linear in time, fr(t) = A + B t + C(t). C(t) cancels gravity less
+ *     centrifugal acceleration, blended from now to burnout. A and B put
+ *     the vehicle at the target radius and radial velocity after the time
+ *     to go T. The rocket equation integrates each remaining stage's
+ *     thrust acceleration in closed form, so A and B come from a 2x2
+ *     linear solve.
+ *   - T follows from the angular momentum still to gain, delivered by the
+ *     horizontal thrust component. The earlier stages burn out fully and
+ *     the last stage's burn is the unknown.
+ *   - Out of plane, the normal thrust fraction is linear in time too,
+ *     fh(t) = D + E t, from the same 2x2 system: it brings the position
+ *     and velocity normal to the target plane to zero at burnout.
+ *
+ * One update re-solves A, B and T from the previous T, so the guidance
+ * converges over its first few cycles and then tracks. Between updates,
+ * steer() extrapolates the last solution. Within terminal_time of
+ * burnout, updates stop (the solution turns singular as T -> 0) and the
+ * vehicle flies the last steering until cutoff() reports the target
+ * orbital energy. An update costs well under a microsecond, so any number
+ * of vehicles, dispersed per run, can fly it live.
+ *
+ * The laws assume vacuum and a spherical Earth. Engage them once the
+ * vehicle is out of the dense atmosphere, after an open-loop vertical
+ * rise and pitch-over.
+ */
+
+#ifndef ASCENT_GUIDANCE_HPP
+#define ASCENT_GUIDANCE_HPP
+
+#include "core/state_vector.hpp"
+#include <vector>
+
+namespace sim {
+
+/// Insertion conditions, in the target orbit plane
+struct AscentTarget {
+    double radius = 0.0;              // [m]
+    double radial_velocity = 0.0;     // [m/s]
+    double horizontal_velocity = 0.0; // [m/s]
+    Vec3 plane_normal;                // Unit angular momentum of the target orbit (ECI)
+
+    /**
+     * Circular orbit of the given radius and inclination whose plane
+     * contains `position` and runs along the horizontal part of
+     * `velocity`. Above the inclination's latitude, the nearest reachable
+     * plane is used.
+     */
+    static AscentTarget circular(double radius, double inclination_deg,
+                                 const Vec3& position, const Vec3& velocity,
+                                 double mu = 3.986004418e14);
+};
+
+/// One remaining stage, as guidance sees it
+struct GuidanceStage {
+    double thrust;                    // [N]
+    double exhaust_velocity;          // Isp g0 [m/s]
+    double mass;                      // At its ignition, or now for the burning stage [kg]
+    double burn_time;                 // Remaining burn [s]
+};
+
+struct AscentGuidanceConfig {
+    double period = 1.0;              // Guidance cycle [s]
+    double terminal_time = 5.0;       // Stop updating this close to burnout [s]
+    double max_normal_fraction = 0.3; // Out-of-plane thrust fraction limit
+    double mu = 3.986004418e14;       // [m^3/s^2]
+};
+
+class AscentGuidance {
+public:
+    AscentGuidance() = default;
+    AscentGuidance(const AscentTarget& target, const AscentGuidanceConfig& config = AscentGuidanceConfig());
+
+    /**
+     * One guidance cycle at time t: re-solve the steering from the state
+     * and the remaining stages (burning stage first). Does nothing inside
+     * the terminal phase.
+     */
+    void update(const Vec3& position, const Vec3& velocity, double t,
+                const std::vector<GuidanceStage>& stages);
+
+    /** True when the next guidance cycle is due at time t */
+    bool due(double t) const { return !terminal_ && t >= last_update_ + config_.period; }
+
+    /** Unit thrust direction (ECI) at time t, from the last update */
+    Vec3 steer(const Vec3& position, double t) const;
+
+    /** Specific orbital energy still to gain to reach the target's [J/kg] */
+    double energy_to_go(const Vec3& position, const Vec3& velocity) const;
+
+    /** True once the orbital energy reaches the target's: cut the engines */
+    bool cutoff(const Vec3& position, const Vec3& velocity) const {
+        return energy_to_go(position, velocity) <= 0.0;
+    }
+
+    /// Time to go from the last update [s]
+    double time_to_go() const { return time_to_go_; }
+    /// The last update's solution needed more burn than the last stage holds
+    bool saturated() const { return saturated_; }
+    bool terminal() const { return terminal_; }
+    int updates() const { return updates_; }
+    const AscentTarget& target() const { return target_; }
+
+private:
+    AscentTarget target_;
+    AscentGuidanceConfig config_;
+
+    double a_ = 0.0, b_ = 0.0;         // Radial steering: fr = A + B t + C(t)
+    double c0_ = 0.0, ct_ = 0.0;       // Gravity less centrifugal term, now and at burnout
+    double time_to_go_ = 0.0;
+    double last_update_ = -1e300;
+    double d_ = 0.0, e_ = 0.0;         // Out-of-plane steering: fh = D + E t
+    bool saturated_ = false;
+    bool terminal_ = false;
+    int updates_ = 0;
+};
+
+} // namespace sim
+
+#endif // ASCENT_GUIDANCE_HPP
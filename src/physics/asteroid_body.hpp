@@ -11,6 +11,7 @@
 
 #include "core/state_vector.hpp"
 #include "celestial_body.hpp"
+#include "kepler_solver.hpp"
 #include <string>
 #include <cmath>
 
@@ -110,19 +111,14 @@ inline AsteroidElements bennu() {
 // ─────────────────────────────────────────────────────────────
 
 /**
- * Solve Kepler's equation for eccentric anomaly
+ * Solve Kepler's equation for eccentric anomaly in [0, 2 pi]
+ * (kepler::eccentric_anomaly; tol is unused)
  */
 inline double asteroid_solve_kepler(double M, double e, double tol = 1e-12) {
-    M = std::fmod(M, 2.0 * 3.14159265358979323846);
-    if (M < 0.0) M += 2.0 * 3.14159265358979323846;
-
-    double E = (e < 0.8) ? M : 3.14159265358979323846;
-    for (int i = 0; i < 50; ++i) {
-        double dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
-        E -= dE;
-        if (std::fabs(dE) < tol) break;
-    }
-    return E;
+    (void)tol;
+    M = std::fmod(M, kepler::TWO_PI);
+    if (M < 0.0) M += kepler::TWO_PI;
+    return kepler::eccentric_anomaly(M, e);
 }
 
 /**
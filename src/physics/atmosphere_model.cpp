@@ -1,4 +1,5 @@
 #include "physics/atmosphere_model.hpp"
+#include "physics/atmosphere_table.hpp"
 #include <cmath>
 #include <algorithm>
 
@@ -109,8 +110,8 @@ double AtmosphereModel::get_density(double altitude) {
 
 Vec3 AtmosphereModel::compute_drag(const Vec3& velocity, double altitude,
                                    double Cd, double area) {
-    // Use extended density model for aerobraking in upper atmosphere
-    double rho = get_density_extended(altitude);
+    // Extended density model (tabulated) for aerobraking in upper atmosphere
+    double rho = AtmosphereTable::earth().density(altitude);
 
     if (rho < 1e-15) {
         return Vec3(0, 0, 0);  // No atmosphere
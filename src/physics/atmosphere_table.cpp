@@ -0,0 +1,108 @@
+#include "physics/atmosphere_table.hpp"
+#include "physics/mars_atmosphere.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr double TABLE_STEP = 50.0;  // m
+
+// Fritsch-Carlson end slope from the first two secants
+double pchip_end_slope(double d0, double d1) {
+    double m = 0.5 * (3.0 * d0 - d1);
+    if (m * d0 <= 0.0) return 0.0;
+    if (d0 * d1 < 0.0 && std::abs(m) > std::abs(3.0 * d0)) return 3.0 * d0;
+    return m;
+}
+
+AtmosphereState mars_state(double altitude) {
+    MarsAtmosphereState s = MarsAtmosphereModel::get_atmosphere(altitude);
+    return AtmosphereState{s.density, s.pressure, s.temperature, s.speed_of_sound};
+}
+
+} // namespace
+
+ProfileTable::ProfileTable(const std::vector<double>& breaks, double step,
+                           const std::function<double(double)>& f) {
+    std::vector<double> d;
+    for (size_t b = 0; b + 1 < breaks.size(); b++) {
+        const double base = breaks[b];
+        const double top = breaks[b + 1];
+        const int cells = std::max(1, static_cast<int>(std::ceil((top - base) / step - 1e-9)));
+        const double dx = (top - base) / cells;
+
+        Segment seg{base, top, 1.0 / dx, nodes_.size(), cells};
+        for (int k = 0; k <= cells; k++) {
+            double h = base + k * dx;
+            if (k == 0 && b > 0) h = std::nextafter(base, top);  // one-sided above a break
+            if (k == cells) h = top;
+            nodes_.push_back(Node{f(h), 0.0});
+        }
+
+        // Secants per cell, then shape-preserving slopes
+        Node* y = &nodes_[seg.first];
+        d.resize(cells);
+        for (int k = 0; k < cells; k++) d[k] = y[k + 1].value - y[k].value;
+
+        if (cells == 1) {
+            y[0].slope = y[1].slope = d[0];
+        } else {
+            y[0].slope = pchip_end_slope(d[0], d[1]);
+            y[cells].slope = pchip_end_slope(d[cells - 1], d[cells - 2]);
+            for (int k = 1; k < cells; k++) {
+                double a = d[k - 1], c = d[k];
+                y[k].slope = (a * c > 0.0) ? 2.0 * a * c / (a + c) : 0.0;
+            }
+        }
+        segments_.push_back(seg);
+    }
+
+    double shortest = breaks.back() - breaks.front();
+    for (size_t b = 0; b + 1 < breaks.size(); b++) {
+        shortest = std::min(shortest, breaks[b + 1] - breaks[b]);
+    }
+    const double bucket = std::min(step, shortest);
+    const size_t buckets = static_cast<size_t>(std::ceil((breaks.back() - breaks.front()) / bucket)) + 1;
+    lo_ = breaks.front();
+    inv_bucket_ = 1.0 / bucket;
+    directory_.resize(buckets);
+    uint16_t seg = 0;
+    for (size_t k = 0; k < buckets; k++) {
+        double edge = lo_ + k * bucket;
+        while (seg + 1u < segments_.size() && edge > segments_[seg].top) seg++;
+        directory_[k] = seg;
+    }
+}
+
+AtmosphereTable::AtmosphereTable(const std::vector<double>& breaks, double step,
+                                 DensityFn exact_density, StateFn exact_state)
+    : ceiling_(breaks.back()),
+      exact_density_(exact_density),
+      exact_state_(exact_state),
+      density_(breaks, step, exact_density),
+      state_density_(breaks, step, [=](double h) { return exact_state(h).density; }),
+      pressure_(breaks, step, [=](double h) { return exact_state(h).pressure; }),
+      temperature_(breaks, step, [=](double h) { return exact_state(h).temperature; }),
+      speed_of_sound_(breaks, step, [=](double h) { return exact_state(h).speed_of_sound; }) {}
+
+const AtmosphereTable& AtmosphereTable::earth() {
+    // US76 layer tops, get_density's 50 km switch, where the mesosphere
+    // temperature floor takes over, the thermosphere model
+    static const AtmosphereTable table(
+        {0.0, 11000.0, 20000.0, 32000.0, 47000.0, 50000.0,
+         47000.0 + (270.65 - 186.87) / 0.0028, 84852.0,
+         AtmosphereModel::KARMAN_LINE, AtmosphereModel::AEROBRAKING_LIMIT},
+        TABLE_STEP, &AtmosphereModel::get_density_extended, &AtmosphereModel::get_atmosphere);
+    return table;
+}
+
+const AtmosphereTable& AtmosphereTable::mars() {
+    static const AtmosphereTable table(
+        {0.0, 7000.0, 80000.0, 200000.0},
+        TABLE_STEP, &MarsAtmosphereModel::get_density, &mars_state);
+    return table;
+}
+
+} // namespace sim
@@ -0,0 +1,173 @@
+#ifndef ATMOSPHERE_TABLE_HPP
+#define ATMOSPHERE_TABLE_HPP
+
+#include "physics/atmosphere_model.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sim {
+
+/**
+ * @brief Tabulated profile f(h) with monotone cubic interpolation
+ *
+ * f is sampled on a uniform grid inside each interval between consecutive
+ * breakpoints and interpolated with Fritsch-Carlson (PCHIP) Hermite
+ * cubics, so the table never overshoots the samples and keeps f's
+ * monotonicity. Place breakpoints where f jumps or kinks (layer
+ * boundaries): each interval is tabulated on its own, starting from the
+ * value just above its lower break. Queries clamp to the table's range.
+ */
+class ProfileTable {
+public:
+    ProfileTable() = default;
+
+    /**
+     * @brief Sample f between breakpoints
+     * @param breaks Strictly increasing altitudes; the first and last bound the table [m]
+     * @param step Target grid spacing inside each interval [m]
+     * @param f Profile to tabulate
+     */
+    ProfileTable(const std::vector<double>& breaks, double step,
+                 const std::function<double(double)>& f);
+
+    double lo() const { return segments_.empty() ? 0.0 : segments_.front().base; }
+    double hi() const { return segments_.empty() ? 0.0 : segments_.back().top; }
+
+    /**
+     * @brief Interpolated value at altitude h, clamped to [lo(), hi()]
+     */
+    double operator()(double h) const {
+        // Directory bucket -> first segment that can hold h, at most one step on
+        double bx = (h - lo_) * inv_bucket_;
+        size_t bucket = bx > 0.0 ? static_cast<size_t>(bx) : 0;
+        if (bucket >= directory_.size()) bucket = directory_.size() - 1;
+        const Segment* s = &segments_[directory_[bucket]];
+        if (h > s->top && s != &segments_.back()) ++s;
+
+        double x = (h - s->base) * s->inv_step;
+        if (x < 0.0) x = 0.0;
+        int i = static_cast<int>(x);
+        if (i > s->cells - 1) i = s->cells - 1;
+        double t = x - i;
+        if (t > 1.0) t = 1.0;
+
+        const Node& a = nodes_[s->first + i];
+        const Node& b = nodes_[s->first + i + 1];
+        double t2 = t * t;
+        double u = 1.0 - t;
+        return (1.0 + 2.0 * t) * u * u * a.value + t * u * u * a.slope +
+               t2 * (3.0 - 2.0 * t) * b.value - t2 * u * b.slope;
+    }
+
+    /**
+     * @brief Batch query: out[k] = (*this)(h[k]) for k < n
+     */
+    void operator()(const double* h, double* out, size_t n) const {
+        for (size_t k = 0; k < n; k++) out[k] = (*this)(h[k]);
+    }
+
+private:
+    struct Node {
+        double value;
+        double slope;   // df/dh scaled by the cell width
+    };
+
+    struct Segment {
+        double base;
+        double top;
+        double inv_step;
+        size_t first;   // index of the segment's first node
+        int cells;
+    };
+
+    std::vector<Segment> segments_;
+    std::vector<Node> nodes_;
+
+    // Segment of each bucket's lower edge; buckets are no wider than the
+    // shortest segment, so a bucket spans at most one break
+    double lo_ = 0.0;
+    double inv_bucket_ = 0.0;
+    std::vector<uint16_t> directory_;
+};
+
+/**
+ * @brief Shared, precomputed atmosphere lookup for one planet
+ *
+ * Built once on first use from the exact model and then served from
+ * ProfileTables (50 m grid, layer boundaries as breakpoints; relative
+ * error about 1e-7 against the model). Use it on hot paths (drag in
+ * propagation loops, debris, launch); AtmosphereModel and
+ * MarsAtmosphereModel remain the exact reference.
+ *
+ *   Earth: density() follows AtmosphereModel::get_density_extended,
+ *          state() follows AtmosphereModel::get_atmosphere.
+ *   Mars:  density() follows MarsAtmosphereModel::get_density,
+ *          state() follows MarsAtmosphereModel::get_atmosphere.
+ *
+ * Above ceiling() both fall back to the exact model.
+ */
+class AtmosphereTable {
+public:
+    static const AtmosphereTable& earth();
+    static const AtmosphereTable& mars();
+
+    /** @brief Top of the tabulated range [m] */
+    double ceiling() const { return ceiling_; }
+
+    /**
+     * @brief Air density at altitude [kg/m^3]
+     * @param altitude Geometric altitude [m]
+     */
+    double density(double altitude) const {
+        return altitude <= ceiling_ ? density_(altitude) : exact_density_(altitude);
+    }
+
+    /**
+     * @brief Batch density: rho[k] = density(altitude[k]) for k < n
+     */
+    void density(const double* altitude, double* rho, size_t n) const {
+        for (size_t k = 0; k < n; k++) rho[k] = density(altitude[k]);
+    }
+
+    /**
+     * @brief Full atmospheric state at altitude
+     * @param altitude Geometric altitude [m]
+     */
+    AtmosphereState state(double altitude) const {
+        if (altitude > ceiling_) return exact_state_(altitude);
+        return AtmosphereState{state_density_(altitude), pressure_(altitude),
+                               temperature_(altitude), speed_of_sound_(altitude)};
+    }
+
+    /**
+     * @brief Batch speed of sound: a[k] at altitude[k] for k < n [m/s]
+     */
+    void speed_of_sound(const double* altitude, double* a, size_t n) const {
+        for (size_t k = 0; k < n; k++) {
+            a[k] = altitude[k] <= ceiling_ ? speed_of_sound_(altitude[k])
+                                           : exact_state_(altitude[k]).speed_of_sound;
+        }
+    }
+
+private:
+    using DensityFn = double (*)(double);
+    using StateFn = AtmosphereState (*)(double);
+
+    AtmosphereTable(const std::vector<double>& breaks, double step,
+                    DensityFn exact_density, StateFn exact_state);
+
+    double ceiling_;
+    DensityFn exact_density_;
+    StateFn exact_state_;
+    ProfileTable density_;
+    ProfileTable state_density_;
+    ProfileTable pressure_;
+    ProfileTable temperature_;
+    ProfileTable speed_of_sound_;
+};
+
+} // namespace sim
+
+#endif // ATMOSPHERE_TABLE_HPP
@@ -0,0 +1,499 @@
+/**
+ * Dense Linear Algebra — small fixed-capacity matrices and damped least squares
+ *
+ * The Newton/Levenberg-Marquardt solvers work on Jacobians of at most a
+ * few rows by at most 13 columns (LaunchControls::N_CONTROLS). FixedMatrix
+ * holds such a matrix in one std::array sized for the capacity, with the
+ * live size chosen at run time, so a solve allocates nothing and rows are
+ * contiguous (row-major, stride MaxCols).
+ *
+ * damped_least_squares(J, r, lambda, dx) returns the Levenberg-Marquardt
+ * step minimizing |J dx - r|^2 + lambda |dx|^2 by one of:
+ *
+ *   NORMAL  Normal equations solved by LU with partial pivoting:
+ *           (J^T J + lambda I) dx = J^T r for more rows than columns,
+ *           dx = J^T (J J^T + lambda I)^-1 r for fewer. A square J is
+ *           solved directly and lambda is not applied. Cheapest; squares
+ *           the condition number.
+ *   QR      Householder QR of [J; sqrt(lambda) I], or of J^T for the
+ *           minimum-norm solution when lambda = 0 and J is wide.
+ *   SVD     Singular values filtered as s / (s^2 + lambda); rank-deficient
+ *           directions (s below ~1e-15 s_max) are dropped when lambda = 0.
+ *
+ * With SIM_HAVE_EIGEN (Eigen3 found by CMake) QR and SVD run on Eigen's
+ * ColPivHouseholderQR / HouseholderQR and JacobiSVD over fixed-capacity Eigen
+ * types, so they stay off the heap; otherwise on the Householder and
+ * one-sided Jacobi kernels below. NORMAL is always the local LU, which
+ * reproduces the solvers' original elimination operation for operation.
+ */
+
+#ifndef SIM_DENSE_LINALG_HPP
+#define SIM_DENSE_LINALG_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef SIM_HAVE_EIGEN
+// GCC 12 flags Eigen 3.4's triangular matrix-vector kernel (reached from
+// JacobiSVD's QR preconditioner) as maybe-uninitialized; it is not
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <Eigen/Dense>
+#pragma GCC diagnostic pop
+#endif
+
+namespace sim {
+namespace linalg {
+
+enum class LeastSquares { NORMAL, QR, SVD };
+
+/** Pivots (and R diagonals) below this leave their unknown at zero */
+constexpr double PIVOT_TOL = 1e-15;
+
+/**
+ * Vector of up to MaxSize doubles on the stack
+ */
+template <int MaxSize>
+class FixedVector {
+public:
+    static constexpr int CAPACITY = MaxSize;
+
+    FixedVector() = default;
+    explicit FixedVector(int n) { resize(n); }
+
+    /** Copy of v. @throws std::invalid_argument if v exceeds the capacity */
+    static FixedVector from(const std::vector<double>& v) {
+        FixedVector out(static_cast<int>(v.size()));
+        std::copy(v.begin(), v.end(), out.a_.begin());
+        return out;
+    }
+
+    /** Resize and zero. @throws std::invalid_argument beyond the capacity */
+    void resize(int n) {
+        if (n < 0 || n > MaxSize) {
+            throw std::invalid_argument("FixedVector: size exceeds capacity");
+        }
+        size_ = n;
+        a_.fill(0.0);
+    }
+
+    int size() const { return size_; }
+    double& operator[](int i) { return a_[i]; }
+    double operator[](int i) const { return a_[i]; }
+    double* data() { return a_.data(); }
+    const double* data() const { return a_.data(); }
+
+    std::vector<double> to_vector() const { return std::vector<double>(a_.begin(), a_.begin() + size_); }
+
+private:
+    std::array<double, MaxSize> a_{};
+    int size_ = 0;
+};
+
+/**
+ * Row-major matrix of up to MaxRows x MaxCols on the stack
+ */
+template <int MaxRows, int MaxCols>
+class FixedMatrix {
+public:
+    static constexpr int MAX_ROWS = MaxRows;
+    static constexpr int MAX_COLS = MaxCols;
+
+    FixedMatrix() = default;
+    FixedMatrix(int rows, int cols) { resize(rows, cols); }
+
+    /** Resize and zero. @throws std::invalid_argument beyond the capacity */
+    void resize(int rows, int cols) {
+        if (rows < 0 || cols < 0 || rows > MaxRows || cols > MaxCols) {
+            throw std::invalid_argument("FixedMatrix: size exceeds capacity");
+        }
+        rows_ = rows;
+        cols_ = cols;
+        a_.fill(0.0);
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    double& operator()(int i, int j) { return a_[i * MaxCols + j]; }
+    double operator()(int i, int j) const { return a_[i * MaxCols + j]; }
+    double* row(int i) { return a_.data() + i * MaxCols; }
+    const double* row(int i) const { return a_.data() + i * MaxCols; }
+
+    void swap_rows(int i, int k) {
+        std::swap_ranges(row(i), row(i) + cols_, row(k));
+    }
+
+private:
+    std::array<double, MaxRows * MaxCols> a_{};
+    int rows_ = 0, cols_ = 0;
+};
+
+// ═══════════════════════════════════════════════════════════════
+// LU
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * Solve the square system A x = b (A, b are working copies) by Gaussian
+ * elimination with partial pivoting. A pivot below PIVOT_TOL skips its
+ * column, and back substitution leaves that unknown at zero.
+ */
+template <int MR, int MC, int MB, int MX>
+void lu_solve(FixedMatrix<MR, MC> A, FixedVector<MB> b, FixedVector<MX>& x) {
+    const int n = A.cols();
+    x.resize(n);
+
+    for (int col = 0; col < n; col++) {
+        int max_row = col;
+        double max_val = std::abs(A(col, col));
+        for (int row = col + 1; row < A.rows(); row++) {
+            if (std::abs(A(row, col)) > max_val) {
+                max_val = std::abs(A(row, col));
+                max_row = row;
+            }
+        }
+        if (max_row != col) {
+            A.swap_rows(col, max_row);
+            std::swap(b[col], b[max_row]);
+        }
+
+        if (std::abs(A(col, col)) < PIVOT_TOL) continue;
+
+        for (int row = col + 1; row < A.rows(); row++) {
+            double factor = A(row, col) / A(col, col);
+            for (int k = col; k < n; k++) A(row, k) -= factor * A(col, k);
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        if (std::abs(A(i, i)) < PIVOT_TOL) { x[i] = 0.0; continue; }
+        double sum = b[i];
+        for (int j = i + 1; j < n; j++) sum -= A(i, j) * x[j];
+        x[i] = sum / A(i, i);
+    }
+}
+
+namespace detail {
+
+// ═══════════════════════════════════════════════════════════════
+// Normal equations
+// ═══════════════════════════════════════════════════════════════
+
+template <int MR, int MC>
+void normal_solve(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+                  double damping, FixedVector<MC>& dx) {
+    const int M = J.rows(), N = J.cols();
+
+    if (M == N) {
+        lu_solve(J, r, dx);
+    } else if (M < N) {
+        // Minimum norm: dx = J^T (J J^T + lambda I)^-1 r
+        FixedMatrix<MR, MR> JJT(M, M);
+        for (int i = 0; i < M; i++) {
+            for (int k = 0; k < M; k++) {
+                double sum = 0.0;
+                for (int j = 0; j < N; j++) sum += J(i, j) * J(k, j);
+                JJT(i, k) = sum;
+            }
+        }
+        for (int i = 0; i < M; i++) JJT(i, i) += damping;
+
+        FixedVector<MR> y;
+        lu_solve(JJT, r, y);
+
+        dx.resize(N);
+        for (int j = 0; j < N; j++) {
+            double sum = 0.0;
+            for (int i = 0; i < M; i++) sum += J(i, j) * y[i];
+            dx[j] = sum;
+        }
+    } else {
+        // (J^T J + lambda I) dx = J^T r
+        FixedMatrix<MC, MC> JTJ(N, N);
+        FixedVector<MC> JTr(N);
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < M; k++) sum += J(k, i) * J(k, j);
+                JTJ(i, j) = sum;
+            }
+            double sum = 0.0;
+            for (int k = 0; k < M; k++) sum += J(k, i) * r[k];
+            JTr[i] = sum;
+        }
+        for (int i = 0; i < N; i++) JTJ(i, i) += damping;
+
+        lu_solve(JTJ, JTr, dx);
+    }
+}
+
+#ifdef SIM_HAVE_EIGEN
+
+// ═══════════════════════════════════════════════════════════════
+// QR / SVD on Eigen (fixed capacity, no heap)
+// ═══════════════════════════════════════════════════════════════
+
+template <int MR, int MC>
+using EigenAugmented = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, MR + MC, MC>;
+template <int MR>
+using EigenVector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, MR>;
+
+template <int MR, int MC>
+void qr_solve(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+              double damping, FixedVector<MC>& dx) {
+    const int M = J.rows(), N = J.cols();
+    dx.resize(N);
+
+    if (M >= N || damping > 0.0) {
+        // min |[J; s I] dx - [r; 0]|, rank-revealing
+        const int rows = damping > 0.0 ? M + N : M;
+        EigenAugmented<MR, MC> A = EigenAugmented<MR, MC>::Zero(rows, N);
+        EigenVector<MR + MC> b = EigenVector<MR + MC>::Zero(rows);
+        for (int i = 0; i < M; i++) {
+            for (int j = 0; j < N; j++) A(i, j) = J(i, j);
+            b(i) = r[i];
+        }
+        for (int i = M; i < rows; i++) A(i, i - M) = std::sqrt(damping);
+
+        Eigen::ColPivHouseholderQR<EigenAugmented<MR, MC>> qr(A);
+        qr.setThreshold(PIVOT_TOL);
+        EigenVector<MC> x = qr.solve(b);
+        for (int j = 0; j < N; j++) dx[j] = x(j);
+        return;
+    }
+
+    // Wide and undamped: J^T = Q R, dx = Q [R^-T r; 0]
+    using Transposed = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, MC, MR>;
+    Transposed At(N, M);
+    EigenVector<MC> y = EigenVector<MC>::Zero(N);
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) At(j, i) = J(i, j);
+        y(i) = r[i];
+    }
+    Eigen::HouseholderQR<Transposed> qr(At);
+    qr.matrixQR().topLeftCorner(M, M).template triangularView<Eigen::Upper>()
+        .transpose().solveInPlace(y.head(M));
+    y = qr.householderQ() * y;
+    for (int j = 0; j < N; j++) dx[j] = y(j);
+}
+
+template <int MR, int MC>
+void svd_solve(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+               double damping, FixedVector<MC>& dx) {
+    using Mat = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, MR, MC>;
+    const int M = std::min(J.rows(), MR), N = std::min(J.cols(), MC);
+
+    Mat A(M, N);
+    EigenVector<MR> b(M);
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) A(i, j) = J(i, j);
+        b(i) = r[i];
+    }
+
+    Eigen::JacobiSVD<Mat> svd(A, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const auto& sigma = svd.singularValues();
+    const double cutoff = sigma.size() > 0 ? PIVOT_TOL * sigma(0) : 0.0;
+
+    dx.resize(N);
+    for (int k = 0; k < sigma.size(); k++) {
+        const double s = sigma(k);
+        if (damping <= 0.0 && s <= cutoff) continue;
+        double ub = 0.0;
+        for (int i = 0; i < M; i++) ub += svd.matrixU()(i, k) * b(i);
+        const double c = s * ub / (s * s + damping);
+        for (int j = 0; j < N; j++) dx[j] += c * svd.matrixV()(j, k);
+    }
+}
+
+#else
+
+// ═══════════════════════════════════════════════════════════════
+// QR / SVD fallbacks
+// ═══════════════════════════════════════════════════════════════
+
+/**
+ * Householder triangularization of the tall A (rows >= cols) in place,
+ * applying the same reflections to b when given
+ */
+template <int R, int C, int B>
+void householder(FixedMatrix<R, C>& A, FixedVector<B>* b) {
+    const int m = A.rows(), n = A.cols();
+    for (int k = 0; k < n; k++) {
+        double norm2 = 0.0;
+        for (int i = k; i < m; i++) norm2 += A(i, k) * A(i, k);
+        double norm = std::sqrt(norm2);
+        if (norm < PIVOT_TOL) continue;
+
+        // v = x + sign(x0) |x| e0, stored in place below the diagonal
+        double alpha = A(k, k) > 0.0 ? -norm : norm;
+        double v0 = A(k, k) - alpha;
+        double vnorm2 = norm2 - A(k, k) * A(k, k) + v0 * v0;
+        A(k, k) = v0;
+
+        for (int j = k + 1; j < n; j++) {
+            double dot = 0.0;
+            for (int i = k; i < m; i++) dot += A(i, k) * A(i, j);
+            double f = 2.0 * dot / vnorm2;
+            for (int i = k; i < m; i++) A(i, j) -= f * A(i, k);
+        }
+        if (b) {
+            double dot = 0.0;
+            for (int i = k; i < m; i++) dot += A(i, k) * (*b)[i];
+            double f = 2.0 * dot / vnorm2;
+            for (int i = k; i < m; i++) (*b)[i] -= f * A(i, k);
+        }
+
+        A(k, k) = alpha;
+        for (int i = k + 1; i < m; i++) A(i, k) = 0.0;
+    }
+}
+
+template <int MR, int MC>
+void qr_solve(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+              double damping, FixedVector<MC>& dx) {
+    const int M = J.rows(), N = J.cols();
+    const double s = std::sqrt(std::max(damping, 0.0));
+    dx.resize(N);
+
+    if (M >= N || damping > 0.0) {
+        // min |[J; s I] dx - [r; 0]|: R dx = (Q^T [r; 0])_top
+        const int rows = damping > 0.0 ? M + N : M;
+        FixedMatrix<MR + MC, MC> A(rows, N);
+        FixedVector<MR + MC> b(rows);
+        for (int i = 0; i < M; i++) {
+            for (int j = 0; j < N; j++) A(i, j) = J(i, j);
+            b[i] = r[i];
+        }
+        for (int i = M; i < rows; i++) A(i, i - M) = s;
+
+        householder(A, &b);
+        for (int i = N - 1; i >= 0; i--) {
+            if (std::abs(A(i, i)) < PIVOT_TOL) { dx[i] = 0.0; continue; }
+            double sum = b[i];
+            for (int j = i + 1; j < N; j++) sum -= A(i, j) * dx[j];
+            dx[i] = sum / A(i, i);
+        }
+        return;
+    }
+
+    // Wide and undamped: J^T = Q R, so J J^T = R^T R and dx = J^T (R^T R)^-1 r
+    FixedMatrix<MC, MR> At(N, M);
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) At(j, i) = J(i, j);
+    }
+    householder<MC, MR, 1>(At, nullptr);
+
+    FixedVector<MR> y(M);
+    for (int i = 0; i < M; i++) {
+        if (std::abs(At(i, i)) < PIVOT_TOL) { y[i] = 0.0; continue; }
+        double sum = r[i];
+        for (int k = 0; k < i; k++) sum -= At(k, i) * y[k];
+        y[i] = sum / At(i, i);
+    }
+    for (int i = M - 1; i >= 0; i--) {
+        if (std::abs(At(i, i)) < PIVOT_TOL) { y[i] = 0.0; continue; }
+        double sum = y[i];
+        for (int k = i + 1; k < M; k++) sum -= At(i, k) * y[k];
+        y[i] = sum / At(i, i);
+    }
+    for (int j = 0; j < N; j++) {
+        double sum = 0.0;
+        for (int i = 0; i < M; i++) sum += J(i, j) * y[i];
+        dx[j] = sum;
+    }
+}
+
+/**
+ * One-sided Jacobi (Hestenes): rotate the columns of A = J until they are
+ * mutually orthogonal, accumulating V, so J = A V^T with s_k = |a_k|
+ */
+template <int MR, int MC>
+void svd_solve(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+               double damping, FixedVector<MC>& dx) {
+    const int M = J.rows(), N = J.cols();
+    FixedMatrix<MR, MC> A = J;
+    FixedMatrix<MC, MC> V(N, N);
+    for (int j = 0; j < N; j++) V(j, j) = 1.0;
+
+    for (int sweep = 0; sweep < 60; sweep++) {
+        bool rotated = false;
+        for (int p = 0; p < N - 1; p++) {
+            for (int q = p + 1; q < N; q++) {
+                double app = 0.0, aqq = 0.0, apq = 0.0;
+                for (int i = 0; i < M; i++) {
+                    app += A(i, p) * A(i, p);
+                    aqq += A(i, q) * A(i, q);
+                    apq += A(i, p) * A(i, q);
+                }
+                if (std::abs(apq) <= 1e-15 * std::sqrt(app * aqq)) continue;
+                rotated = true;
+
+                double zeta = (aqq - app) / (2.0 * apq);
+                double t = (zeta >= 0.0 ? 1.0 : -1.0) /
+                           (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / std::sqrt(1.0 + t * t), s = c * t;
+                for (int i = 0; i < M; i++) {
+                    double ap = A(i, p), aq = A(i, q);
+                    A(i, p) = c * ap - s * aq;
+                    A(i, q) = s * ap + c * aq;
+                }
+                for (int i = 0; i < N; i++) {
+                    double vp = V(i, p), vq = V(i, q);
+                    V(i, p) = c * vp - s * vq;
+                    V(i, q) = s * vp + c * vq;
+                }
+            }
+        }
+        if (!rotated) break;
+    }
+
+    // dx = sum_k v_k (a_k . r) / (s_k^2 + lambda), with a_k = s_k u_k
+    FixedVector<MC> s2(N);
+    double s2_max = 0.0;
+    for (int k = 0; k < N; k++) {
+        for (int i = 0; i < M; i++) s2[k] += A(i, k) * A(i, k);
+        s2_max = std::max(s2_max, s2[k]);
+    }
+    const double cutoff = PIVOT_TOL * PIVOT_TOL * s2_max;
+
+    dx.resize(N);
+    for (int k = 0; k < N; k++) {
+        if (damping <= 0.0 && s2[k] <= cutoff) continue;
+        if (s2[k] + damping <= 0.0) continue;
+        double ar = 0.0;
+        for (int i = 0; i < M; i++) ar += A(i, k) * r[i];
+        double c = ar / (s2[k] + damping);
+        for (int j = 0; j < N; j++) dx[j] += c * V(j, k);
+    }
+}
+
+#endif // SIM_HAVE_EIGEN
+
+} // namespace detail
+
+/**
+ * Levenberg-Marquardt step: dx minimizing |J dx - r|^2 + damping |dx|^2
+ * (see the file comment for the methods)
+ */
+template <int MR, int MC>
+void damped_least_squares(const FixedMatrix<MR, MC>& J, const FixedVector<MR>& r,
+                          double damping, FixedVector<MC>& dx,
+                          LeastSquares method = LeastSquares::NORMAL) {
+    if (r.size() != J.rows()) {
+        throw std::invalid_argument("damped_least_squares: residual size differs from Jacobian rows");
+    }
+    switch (method) {
+        case LeastSquares::QR:  detail::qr_solve(J, r, damping, dx); break;
+        case LeastSquares::SVD: detail::svd_solve(J, r, damping, dx); break;
+        default:                detail::normal_solve(J, r, damping, dx); break;
+    }
+}
+
+} // namespace linalg
+} // namespace sim
+
+#endif // SIM_DENSE_LINALG_HPP
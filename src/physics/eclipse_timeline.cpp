@@ -0,0 +1,144 @@
+/**
+ * Eclipse Timeline Implementation
+ */
+
+#include "eclipse_timeline.hpp"
+#include "celestial_body.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+// Cubic Hermite position between two reference samples
+Vec3 hermite_position(const StateVector& a, const StateVector& b, double t) {
+    double h = b.time - a.time;
+    double s = (t - a.time) / h;
+    double s2 = s * s;
+    double s3 = s2 * s;
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = (s3 - 2.0 * s2 + s) * h;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = (s3 - s2) * h;
+    return Vec3(h00 * a.position.x + h10 * a.velocity.x + h01 * b.position.x + h11 * b.velocity.x,
+                h00 * a.position.y + h10 * a.velocity.y + h01 * b.position.y + h11 * b.velocity.y,
+                h00 * a.position.z + h10 * a.velocity.z + h01 * b.position.z + h11 * b.velocity.z);
+}
+
+} // namespace
+
+double EclipseTimeline::shadow_function(const Vec3& pos_eci, const Vec3& sun_pos_eci) {
+    double sun_dist = sun_pos_eci.norm();
+    if (sun_dist < 1.0) return pos_eci.norm() - EARTH_RADIUS;
+
+    double inv_sun_dist = 1.0 / sun_dist;
+    double proj = (pos_eci.x * sun_pos_eci.x + pos_eci.y * sun_pos_eci.y +
+                   pos_eci.z * sun_pos_eci.z) * inv_sun_dist;
+
+    // Day side: distance from the Earth's surface (equals the night-side
+    // value at proj = 0, where the perpendicular distance is |r|)
+    if (proj >= 0.0) return pos_eci.norm() - EARTH_RADIUS;
+
+    Vec3 perp{
+        pos_eci.x - proj * sun_pos_eci.x * inv_sun_dist,
+        pos_eci.y - proj * sun_pos_eci.y * inv_sun_dist,
+        pos_eci.z - proj * sun_pos_eci.z * inv_sun_dist
+    };
+    return perp.norm() - EARTH_RADIUS;
+}
+
+std::shared_ptr<const EclipseTimeline> EclipseTimeline::predict(
+    const std::vector<StateVector>& reference,
+    double epoch_jd,
+    int substeps,
+    double time_tolerance) {
+
+    std::shared_ptr<EclipseTimeline> tl(new EclipseTimeline());
+    tl->epoch_jd_ = epoch_jd;
+    if (reference.empty()) return tl;
+    tl->start_ = reference.front().time;
+    tl->end_ = reference.back().time;
+    substeps = std::max(1, substeps);
+
+    // Shadow function along sample interval [a, b]
+    auto g_at = [&](const StateVector& a, const StateVector& b, double t) {
+        Vec3 pos = t <= a.time ? a.position : t >= b.time ? b.position : hermite_position(a, b, t);
+        return shadow_function(pos, EphemerisCache::sun_eci(epoch_jd + t / 86400.0));
+    };
+
+    // Illinois regula falsi on a bracketing pair
+    auto refine = [&](const StateVector& a, const StateVector& b,
+                      double t_lo, double g_lo, double t_hi, double g_hi) {
+        int side = 0;
+        for (int iter = 0; iter < 100 && t_hi - t_lo > time_tolerance; iter++) {
+            double t = (t_lo * g_hi - t_hi * g_lo) / (g_hi - g_lo);
+            if (!(t > t_lo && t < t_hi)) t = 0.5 * (t_lo + t_hi);
+            double g = g_at(a, b, t);
+            if ((g < 0.0) == (g_lo < 0.0)) {
+                t_lo = t;
+                g_lo = g;
+                if (side == -1) g_hi *= 0.5;
+                side = -1;
+            } else {
+                t_hi = t;
+                g_hi = g;
+                if (side == +1) g_lo *= 0.5;
+                side = +1;
+            }
+        }
+        return 0.5 * (t_lo + t_hi);
+    };
+
+    double g_prev = shadow_function(reference.front().position,
+                                    EphemerisCache::sun_eci(epoch_jd + tl->start_ / 86400.0));
+    bool shadow = g_prev < 0.0;
+    double entry = tl->start_;
+
+    for (size_t i = 0; i + 1 < reference.size(); i++) {
+        const StateVector& a = reference[i];
+        const StateVector& b = reference[i + 1];
+        double h = b.time - a.time;
+        if (!(h > 0.0)) continue;
+
+        double t_prev = a.time;
+        for (int k = 1; k <= substeps; k++) {
+            double t = k == substeps ? b.time : a.time + h * k / substeps;
+            double g = g_at(a, b, t);
+            if ((g < 0.0) != shadow) {
+                double crossing = refine(a, b, t_prev, g_prev, t, g);
+                if (shadow) {
+                    tl->intervals_.push_back(EclipseInterval{entry, crossing});
+                } else {
+                    entry = crossing;
+                }
+                shadow = !shadow;
+            }
+            t_prev = t;
+            g_prev = g;
+        }
+    }
+    if (shadow) tl->intervals_.push_back(EclipseInterval{entry, tl->end_});
+    return tl;
+}
+
+bool EclipseTimeline::in_shadow(double t) const {
+    auto it = std::upper_bound(intervals_.begin(), intervals_.end(), t,
+                               [](double v, const EclipseInterval& e) { return v < e.entry; });
+    if (it == intervals_.begin()) return false;
+    --it;
+    return t < it->exit;
+}
+
+std::vector<double> EclipseTimeline::boundaries() const {
+    std::vector<double> out;
+    out.reserve(2 * intervals_.size());
+    for (const EclipseInterval& e : intervals_) {
+        if (e.entry > start_) out.push_back(e.entry);
+        if (e.exit < end_) out.push_back(e.exit);
+    }
+    return out;
+}
+
+}  // namespace sim
@@ -0,0 +1,88 @@
+/**
+ * Eclipse Timeline
+ *
+ * Predicted Earth-shadow intervals along a reference trajectory. The SRP
+ * force model can look these up instead of running the shadow geometry in
+ * every derivative call, and the interval boundaries are the times where
+ * SRP switches on and off. AdaptiveIntegrator::propagate can take them as
+ * breakpoints and end a step exactly on each one.
+ *
+ * The shadow is SolarRadiationPressure's cylindrical model, so the umbra
+ * and penumbra share one boundary. The crossing function is the signed
+ * distance from the shadow cylinder: perpendicular distance from the
+ * Earth-Sun line minus the Earth radius on the night side, and |r| minus
+ * the Earth radius on the day side. It is continuous where the two
+ * halves meet and negative only in shadow.
+ *
+ * predict() runs on a sampled reference trajectory, such as the output of
+ * AdaptiveIntegrator::propagate with a sample_interval. Positions between
+ * samples come from cubic Hermite interpolation on position and velocity.
+ * Each sample interval is scanned in `substeps` pieces for a sign change,
+ * and every crossing is refined by Illinois regula falsi against
+ * EphemerisCache::sun_eci. An eclipse shorter than one scan piece can be
+ * missed.
+ *
+ * Times are seconds since epoch_jd, the convention of
+ * OrbitalPerturbations::make_derivative_function. The timeline is
+ * immutable and is shared read-only across threads.
+ */
+
+#ifndef SIM_ECLIPSE_TIMELINE_HPP
+#define SIM_ECLIPSE_TIMELINE_HPP
+
+#include "core/state_vector.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+struct EclipseInterval {
+    double entry;   // Shadow entry [s since epoch]
+    double exit;    // Shadow exit [s since epoch]
+};
+
+class EclipseTimeline {
+public:
+    /**
+     * Shadow intervals along a reference trajectory
+     *
+     * @param reference States in ascending time (seconds since epoch_jd)
+     * @param epoch_jd Julian Date at time 0
+     * @param substeps Scan pieces per reference interval
+     * @param time_tolerance Root bracket width [s]
+     */
+    static std::shared_ptr<const EclipseTimeline> predict(
+        const std::vector<StateVector>& reference,
+        double epoch_jd,
+        int substeps = 4,
+        double time_tolerance = 1e-3);
+
+    /** Signed distance from the shadow cylinder [m]; negative in shadow */
+    static double shadow_function(const Vec3& pos_eci, const Vec3& sun_pos_eci);
+
+    /** Whether t lies inside the predicted span */
+    bool covers(double t) const { return t >= start_ && t <= end_; }
+
+    /** Predicted shadow state at t (intervals are [entry, exit)) */
+    bool in_shadow(double t) const;
+
+    /** Entry and exit times inside the span, ascending (integrator breakpoints) */
+    std::vector<double> boundaries() const;
+
+    const std::vector<EclipseInterval>& intervals() const { return intervals_; }
+    double epoch_jd() const { return epoch_jd_; }
+    double start() const { return start_; }
+    double end() const { return end_; }
+
+private:
+    std::vector<EclipseInterval> intervals_;   // Ascending, disjoint
+    double epoch_jd_ = 0.0;
+    double start_ = 0.0;
+    double end_ = 0.0;
+
+    EclipseTimeline() = default;
+};
+
+}  // namespace sim
+
+#endif  // SIM_ECLIPSE_TIMELINE_HPP
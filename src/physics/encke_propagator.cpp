@@ -0,0 +1,149 @@
+/**
+ * Encke Propagator Implementation
+ */
+
+#include "physics/encke_propagator.hpp"
+#include "physics/gravity_utils.hpp"
+#include "physics/kepler_fg.hpp"
+#include "propagators/integrator_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+// Everything in the config except the central term
+Vec3 perturbing_acceleration(OrbitalPerturbations::AccelerationKernel accel,
+                             const Vec3& r, const Vec3& v, const PerturbationConfig& config,
+                             double mu, double jd) {
+    Vec3 total = accel(r, v, config, jd);
+    Vec3 central = gravity::two_body_acceleration(r, mu);
+    return Vec3(total.x - central.x, total.y - central.y, total.z - central.z);
+}
+
+} // namespace
+
+bool EnckePropagator::kepler_fg(const Vec3& r0, const Vec3& v0, double dt, double mu,
+                                Vec3& r, Vec3& v) {
+    double pr[3] = {r0.x, r0.y, r0.z};
+    double pv[3] = {v0.x, v0.y, v0.z};
+    if (!kepler_fg_inplace(pr, pv, dt, mu)) return false;
+    r = Vec3(pr[0], pr[1], pr[2]);
+    v = Vec3(pv[0], pv[1], pv[2]);
+    return true;
+}
+
+EnckePropagator::EnckePropagator(const StateVector& initial,
+                                 const PerturbationConfig& perturbations,
+                                 double epoch_jd,
+                                 const EnckeConfig& config)
+    : perturbations_(perturbations),
+      accel_(OrbitalPerturbations::acceleration_kernel(perturbations)),
+      config_(config), epoch_jd_(epoch_jd),
+      mu_(gravity::BodyConstants::EARTH.mu), template_(initial),
+      t_(initial.time), dt_next_(std::min(60.0, config.adaptive.dt_max)) {
+    rectify(initial.position, initial.velocity);
+}
+
+void EnckePropagator::rectify(const Vec3& r, const Vec3& v) {
+    t_ref_ = t_;
+    r_ref_ = r;
+    v_ref_ = v;
+    delta_r_ = Vec3(0.0, 0.0, 0.0);
+    delta_v_ = Vec3(0.0, 0.0, 0.0);
+}
+
+StateVector EnckePropagator::state() const {
+    Vec3 rho = r_ref_, rho_v = v_ref_;
+    kepler_fg(r_ref_, v_ref_, t_ - t_ref_, mu_, rho, rho_v);
+    StateVector out = template_;
+    out.position = Vec3(rho.x + delta_r_.x, rho.y + delta_r_.y, rho.z + delta_r_.z);
+    out.velocity = Vec3(rho_v.x + delta_v_.x, rho_v.y + delta_v_.y, rho_v.z + delta_v_.z);
+    out.time = t_;
+    return out;
+}
+
+void EnckePropagator::cowell_step(double dt) {
+    StateVector s = state();
+    auto rhs = [&](double t, const std::array<double, 6>& y, std::array<double, 6>& dydt) {
+        rhs_calls_++;
+        Vec3 a = accel_(Vec3(y[0], y[1], y[2]), Vec3(y[3], y[4], y[5]), perturbations_,
+                        epoch_jd_ + t / 86400.0);
+        dydt = {y[3], y[4], y[5], a.x, a.y, a.z};
+    };
+    OrbitState6 y{t_, {s.position.x, s.position.y, s.position.z,
+                       s.velocity.x, s.velocity.y, s.velocity.z}};
+    FixedStep<6> r = dopri5_step(y, dt, rhs, config_.adaptive);
+    t_ = r.state.t;
+    dt_next_ = r.dt_next;
+    steps_++;
+    rectify(Vec3(r.state.y[0], r.state.y[1], r.state.y[2]),
+            Vec3(r.state.y[3], r.state.y[4], r.state.y[5]));
+}
+
+StateVector EnckePropagator::propagate(double duration) {
+    const double t_end = t_ + duration;
+
+    // δ'' from the deviation and the reference at t
+    bool bound = true;
+    auto rhs = [&](double t, const std::array<double, 6>& y, std::array<double, 6>& dydt) {
+        rhs_calls_++;
+        Vec3 rho, rho_v;
+        if (!kepler_fg(r_ref_, v_ref_, t - t_ref_, mu_, rho, rho_v)) {
+            bound = false;
+            dydt = {};
+            return;
+        }
+        const Vec3 d(y[0], y[1], y[2]);
+        const Vec3 r(rho.x + d.x, rho.y + d.y, rho.z + d.z);
+        const Vec3 v(rho_v.x + y[3], rho_v.y + y[4], rho_v.z + y[5]);
+
+        const double r2 = dot(r, r);
+        const double q = dot(d, Vec3(d.x - 2.0 * r.x, d.y - 2.0 * r.y, d.z - 2.0 * r.z)) / r2;
+        const double fq = q * (3.0 + 3.0 * q + q * q) / (1.0 + std::pow(1.0 + q, 1.5));
+        const double rho_n = rho.norm();
+        const double k = -mu_ / (rho_n * rho_n * rho_n);
+
+        Vec3 ap = perturbing_acceleration(accel_, r, v, perturbations_, mu_,
+                                          epoch_jd_ + t / 86400.0);
+        dydt = {y[3], y[4], y[5],
+                k * (d.x + fq * r.x) + ap.x,
+                k * (d.y + fq * r.y) + ap.y,
+                k * (d.z + fq * r.z) + ap.z};
+    };
+
+    while (t_ < t_end && steps_ < config_.adaptive.max_steps) {
+        double dt_try = std::min(dt_next_, t_end - t_);
+        if (dt_try < 1e-10) break;
+
+        bound = true;
+        OrbitState6 y{t_, {delta_r_.x, delta_r_.y, delta_r_.z,
+                           delta_v_.x, delta_v_.y, delta_v_.z}};
+        FixedStep<6> r = dopri5_step(y, dt_try, rhs, config_.adaptive);
+        if (!bound) {
+            cowell_step(dt_try);
+            continue;
+        }
+        t_ = r.state.t;
+        dt_next_ = r.dt_next;
+        steps_++;
+        delta_r_ = Vec3(r.state.y[0], r.state.y[1], r.state.y[2]);
+        delta_v_ = Vec3(r.state.y[3], r.state.y[4], r.state.y[5]);
+
+        // Re-osculate once the deviation stops being small
+        Vec3 rho, rho_v;
+        kepler_fg(r_ref_, v_ref_, t_ - t_ref_, mu_, rho, rho_v);
+        if (delta_r_.norm() > config_.rectify_ratio * rho.norm()) {
+            StateVector s = state();
+            rectify(s.position, s.velocity);
+            rectifications_++;
+        }
+    }
+
+    return state();
+}
+
+}  // namespace sim
@@ -0,0 +1,99 @@
+/**
+ * Encke Propagator
+ *
+ * Integrates only the deviation δ = r - ρ of the true orbit from an
+ * osculating Keplerian reference ρ(t), instead of the full acceleration
+ * (Cowell). δ'' is the perturbing acceleration plus the small
+ * differential gravity
+ *
+ *   δ'' = -(μ / ρ³) (δ + f(q) r) + a_p,   q = δ·(δ - 2r) / r²
+ *
+ * with Battin's f(q) = (1+q)^{3/2} - 1 written free of cancellation. The
+ * integrator no longer has to resolve the two-body term, so near-Keplerian
+ * LEO/GEO orbits take steps set by the perturbations alone.
+ *
+ * The reference is advanced in closed form with the f and g functions
+ * of Kepler's equation in eccentric-anomaly differences, which has no
+ * circular or equatorial singularities. When |δ| / |ρ| exceeds
+ * EnckeConfig::rectify_ratio the reference is re-osculated to the
+ * current state and δ restarts at zero.
+ *
+ * Steps are Dormand-Prince 4(5). DOP853's blended error estimate
+ * under-reports the error of the deviation equation (δ starts each arc
+ * at zero), so it is not offered here.
+ *
+ * Perturbations come from OrbitalPerturbations (everything except the
+ * central term of the given PerturbationConfig). Hyperbolic states fall
+ * back to Cowell for the affected step.
+ */
+
+#ifndef SIM_ENCKE_PROPAGATOR_HPP
+#define SIM_ENCKE_PROPAGATOR_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/orbital_perturbations.hpp"
+#include "propagators/adaptive_integrator.hpp"
+
+namespace sim {
+
+struct EnckeConfig {
+    double rectify_ratio = 1e-3;     // Re-osculate when |δ| / |ρ| exceeds this
+
+    // Tolerances apply to δ, so absolute position error remains ~abs_tolerance
+    AdaptiveConfig adaptive{0.1, 3600.0, 1e-3, 1e-12, 0.9, 1000000};
+};
+
+class EnckePropagator {
+public:
+    /**
+     * @param initial ECI state; state.time is seconds since epoch_jd
+     * @param perturbations Force model (its central term is the reference)
+     * @param epoch_jd Julian date at state.time == 0
+     */
+    EnckePropagator(const StateVector& initial,
+                    const PerturbationConfig& perturbations,
+                    double epoch_jd,
+                    const EnckeConfig& config = EnckeConfig{});
+
+    /** Advance by duration seconds; returns the new state. */
+    StateVector propagate(double duration);
+
+    /** Current true state (reference + deviation). */
+    StateVector state() const;
+
+    int rectifications() const { return rectifications_; }
+    long rhs_calls() const { return rhs_calls_; }
+    long steps() const { return steps_; }
+
+    /**
+     * Two-body state dt seconds after (r0, v0) via f and g functions.
+     * @return false if the orbit is not elliptical (r, v untouched)
+     */
+    static bool kepler_fg(const Vec3& r0, const Vec3& v0, double dt, double mu,
+                          Vec3& r, Vec3& v);
+
+private:
+    PerturbationConfig perturbations_;
+    OrbitalPerturbations::AccelerationKernel accel_;   // Chosen once for perturbations_
+    EnckeConfig config_;
+    double epoch_jd_;
+    double mu_;
+
+    StateVector template_;      // Attitude and frame carried through
+    double t_ref_;              // Reference epoch [s]
+    Vec3 r_ref_, v_ref_;        // Osculating state at t_ref_
+    double t_;                  // Current time [s]
+    Vec3 delta_r_, delta_v_;    // Deviation at t_
+    double dt_next_;
+
+    int rectifications_ = 0;
+    long rhs_calls_ = 0;
+    long steps_ = 0;
+
+    void rectify(const Vec3& r, const Vec3& v);
+    void cowell_step(double dt);
+};
+
+}  // namespace sim
+
+#endif  // SIM_ENCKE_PROPAGATOR_HPP
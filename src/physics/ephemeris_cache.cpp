@@ -0,0 +1,187 @@
+#include "physics/ephemeris_cache.hpp"
+#include "physics/lunar_ephemeris.hpp"
+#include "physics/solar_ephemeris.hpp"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace sim {
+
+namespace {
+
+constexpr int DEGREE = 15;
+constexpr int NCOEF = DEGREE + 1;
+constexpr double PI = 3.14159265358979323846;
+
+// Bodies: the planets by enum value, then the geocentric Moon and Sun
+constexpr int MOON = PLANET_COUNT;
+constexpr int SUN = PLANET_COUNT + 1;
+constexpr int NUM_BODIES = PLANET_COUNT + 2;
+
+struct Segment {
+    double mid;        // Segment centre [JD]
+    double inv_half;   // 1 / half-length [1/day]
+    std::array<std::array<double, NCOEF>, 3> c;
+};
+
+Vec3 exact(int body, double jd) {
+    if (body == MOON) return LunarEphemeris::get_moon_position_eci(jd);
+    if (body == SUN) return SolarEphemeris::get_sun_position_eci(jd);
+    return PlanetaryEphemeris::get_position_hci(static_cast<Planet>(body), jd);
+}
+
+// Segment length [days]: short enough that degree 15 converges to the
+// analytic model's rounding (about 1/7 of the fastest period in the body)
+double span_days(int body) {
+    switch (body) {
+        case MOON:                              return 4.0;
+        case SUN:                               return 32.0;
+        case static_cast<int>(Planet::MERCURY): return 8.0;
+        case static_cast<int>(Planet::VENUS):   return 16.0;
+        case static_cast<int>(Planet::EARTH):   return 32.0;
+        case static_cast<int>(Planet::MARS):    return 32.0;
+        default:                                return 64.0;
+    }
+}
+
+class BodyFit {
+public:
+    explicit BodyFit(int body) : body_(body), span_(span_days(body)) {}
+
+    const Segment& segment(double jd) {
+        const int64_t key = static_cast<int64_t>(std::floor((jd - LunarEphemeris::J2000_EPOCH) / span_));
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = segments_.find(key);
+        if (it == segments_.end()) {
+            it = segments_.emplace(key, fit(key)).first;
+        }
+        return *it->second;
+    }
+
+    double span() const { return span_; }
+
+private:
+    int body_;
+    double span_;
+    std::mutex mutex_;
+    std::unordered_map<int64_t, std::unique_ptr<Segment>> segments_;
+
+    std::unique_ptr<Segment> fit(int64_t key) const {
+        auto seg = std::make_unique<Segment>();
+        const double start = LunarEphemeris::J2000_EPOCH + key * span_;
+        seg->mid = start + 0.5 * span_;
+        seg->inv_half = 2.0 / span_;
+
+        // Samples at the Chebyshev nodes, then the discrete cosine transform
+        std::array<Vec3, NCOEF> f;
+        for (int k = 0; k < NCOEF; k++) {
+            double x = std::cos(PI * (k + 0.5) / NCOEF);
+            f[k] = exact(body_, seg->mid + x * 0.5 * span_);
+        }
+        for (int j = 0; j < NCOEF; j++) {
+            double sx = 0.0, sy = 0.0, sz = 0.0;
+            for (int k = 0; k < NCOEF; k++) {
+                double w = std::cos(PI * j * (k + 0.5) / NCOEF);
+                sx += f[k].x * w;
+                sy += f[k].y * w;
+                sz += f[k].z * w;
+            }
+            double scale = (j == 0 ? 1.0 : 2.0) / NCOEF;
+            seg->c[0][j] = sx * scale;
+            seg->c[1][j] = sy * scale;
+            seg->c[2][j] = sz * scale;
+        }
+        return seg;
+    }
+};
+
+BodyFit& body_fit(int body) {
+    static std::array<std::unique_ptr<BodyFit>, NUM_BODIES> fits = [] {
+        std::array<std::unique_ptr<BodyFit>, NUM_BODIES> a;
+        for (int b = 0; b < NUM_BODIES; b++) a[b] = std::make_unique<BodyFit>(b);
+        return a;
+    }();
+    return *fits[body];
+}
+
+// Last segment this thread used per body: hits skip the lock
+thread_local std::array<const Segment*, NUM_BODIES> last_segment{};
+
+const Segment& lookup(int body, double jd, double& x) {
+    const Segment* s = last_segment[body];
+    if (s) {
+        x = (jd - s->mid) * s->inv_half;
+        if (x >= -1.0 && x < 1.0) return *s;
+    }
+    s = &body_fit(body).segment(jd);
+    last_segment[body] = s;
+    x = (jd - s->mid) * s->inv_half;
+    return *s;
+}
+
+// Clenshaw: sum c_j T_j(x)
+double chebyshev(const std::array<double, NCOEF>& c, double x) {
+    double b1 = 0.0, b2 = 0.0;
+    const double x2 = 2.0 * x;
+    for (int j = DEGREE; j >= 1; j--) {
+        double b0 = c[j] + x2 * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return c[0] + x * b1 - b2;
+}
+
+// d/dx of sum c_j T_j(x), via U_{j-1}: T_j' = j U_{j-1}
+double chebyshev_derivative(const std::array<double, NCOEF>& c, double x) {
+    double b1 = 0.0, b2 = 0.0;
+    const double x2 = 2.0 * x;
+    for (int j = DEGREE; j >= 1; j--) {
+        double b0 = j * c[j] + x2 * b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return b1;
+}
+
+Vec3 position(int body, double jd) {
+    double x;
+    const Segment& s = lookup(body, jd, x);
+    return Vec3(chebyshev(s.c[0], x), chebyshev(s.c[1], x), chebyshev(s.c[2], x));
+}
+
+} // namespace
+
+Vec3 EphemerisCache::moon_eci(double jd) {
+    return position(MOON, jd);
+}
+
+Vec3 EphemerisCache::sun_eci(double jd) {
+    return position(SUN, jd);
+}
+
+Vec3 EphemerisCache::planet_hci(Planet planet, double jd) {
+    return position(static_cast<int>(planet), jd);
+}
+
+Vec3 EphemerisCache::planet_velocity_hci(Planet planet, double jd) {
+    double x;
+    const Segment& s = lookup(static_cast<int>(planet), jd, x);
+    const double per_second = s.inv_half / 86400.0;   // dx/dt
+    return Vec3(chebyshev_derivative(s.c[0], x) * per_second,
+                chebyshev_derivative(s.c[1], x) * per_second,
+                chebyshev_derivative(s.c[2], x) * per_second);
+}
+
+void EphemerisCache::prefit(double jd_start, double jd_end) {
+    for (int b = 0; b < NUM_BODIES; b++) {
+        BodyFit& fit = body_fit(b);
+        for (double jd = jd_start; jd < jd_end + fit.span(); jd += fit.span()) {
+            fit.segment(std::min(jd, jd_end));
+        }
+    }
+}
+
+} // namespace sim
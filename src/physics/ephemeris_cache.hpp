@@ -0,0 +1,47 @@
+#ifndef SIM_EPHEMERIS_CACHE_HPP
+#define SIM_EPHEMERIS_CACHE_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/planetary_ephemeris.hpp"
+
+namespace sim {
+
+/**
+ * @brief Piecewise Chebyshev fits of the analytic ephemerides
+ *
+ * Each body's position is fitted on fixed-length segments of Julian date
+ * (degree 15 per axis, sampled at Chebyshev nodes of the analytic model)
+ * the first time any thread asks for a date inside the segment; later
+ * queries are a Clenshaw recurrence, with no Kepler solve or series trig.
+ * Segments are immutable once built and never freed, so reads need no
+ * lock after a per-thread segment hit; a miss takes one mutex.
+ *
+ * Fit error against the analytic models is at their rounding level: a few
+ * centimeters for the Moon, under 1.5 m at planetary distances (about
+ * 1e-11 relative), far below the models' own accuracy.
+ *
+ * Shared by OrbitalPerturbations (third body, SRP), NBodyGravity and the
+ * interplanetary planner; call prefit() to pay for a mission window up
+ * front instead of on the first integration steps.
+ */
+class EphemerisCache {
+public:
+    /** Moon position, Earth-centered J2000 [m] (LunarEphemeris). */
+    static Vec3 moon_eci(double jd);
+
+    /** Sun position, Earth-centered J2000 [m] (SolarEphemeris). */
+    static Vec3 sun_eci(double jd);
+
+    /** Planet position, heliocentric J2000 [m] (PlanetaryEphemeris). */
+    static Vec3 planet_hci(Planet planet, double jd);
+
+    /** Planet velocity from the fit's derivative, heliocentric J2000 [m/s]. */
+    static Vec3 planet_velocity_hci(Planet planet, double jd);
+
+    /** Build every body's segments covering [jd_start, jd_end]. */
+    static void prefit(double jd_start, double jd_end);
+};
+
+} // namespace sim
+
+#endif // SIM_EPHEMERIS_CACHE_HPP
@@ -0,0 +1,351 @@
+/**
+ * Flyby Sequence Search Implementation
+ */
+
+#include "physics/flyby_sequence_search.hpp"
+#include "physics/celestial_body.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/gravity_assist.hpp"
+#include "physics/interplanetary_planner.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/// A partial tour on the date grid
+struct Tour {
+    std::vector<Planet> bodies;
+    std::vector<int> dates;             // Grid indices
+    double cost = 0.0;                  // Delta-V so far [m/s]
+    Vec3 v_inf_in;                      // Arrival v-inf at the last body (flybys only)
+};
+
+bool tour_less(const Tour& a, const Tour& b) {
+    if (a.cost != b.cost) return a.cost < b.cost;
+    if (a.bodies != b.bodies) return a.bodies < b.bodies;
+    return a.dates < b.dates;
+}
+
+/// Mean orbit radius, as a circle [m]
+double orbit_radius(Planet p) {
+    return PlanetaryConstants::get(p).sma_au * AU;
+}
+
+/**
+ * Whether a tangential departure from `from`'s circular orbit at up to
+ * v_inf can reach `to`'s orbit radius
+ */
+bool tisserand_reachable(Planet from, Planet to, double v_inf) {
+    if (from == to) return true;
+    const double r = orbit_radius(from);
+    const double target = orbit_radius(to);
+    const double vc = std::sqrt(SUN_MU / r);
+    auto other_apsis = [r](double s) {
+        const double d = 2.0 * SUN_MU - s * s * r;
+        return d > 0.0 ? s * s * r * r / d : INF;
+    };
+    const double aphelion = other_apsis(vc + v_inf);
+    const double perihelion = v_inf >= vc ? 0.0 : other_apsis(vc - v_inf);
+    return target >= perihelion && target <= aphelion;
+}
+
+/** Leg time-of-flight range [days]: around Hohmann, or around a period for a return */
+void tof_range(Planet from, Planet to, double& lo, double& hi) {
+    const double r1 = orbit_radius(from), r2 = orbit_radius(to);
+    if (from == to) {
+        const double period = 2.0 * PI * std::sqrt(r1 * r1 * r1 / SUN_MU) / 86400.0;
+        lo = 0.5 * period;
+        hi = 2.2 * period;
+    } else {
+        const double a = 0.5 * (r1 + r2);
+        const double hohmann = PI * std::sqrt(a * a * a / SUN_MU) / 86400.0;
+        lo = 0.3 * hohmann;
+        hi = 2.5 * hohmann;
+    }
+}
+
+/**
+ * Delta-V of a flyby joining v_in to v_out (v-inf mismatch plus any turn
+ * beyond the minimum periapsis, as compute_total_dv); INF if infeasible
+ */
+double flyby_cost(Planet body, const Vec3& v_in, const Vec3& v_out, double min_altitude) {
+    const PlanetaryConstants& pc = PlanetaryConstants::get(body);
+    const double min_rp = pc.radius + min_altitude;
+    const double in = v_in.norm(), out = v_out.norm();
+    if (!GravityAssist::is_feasible(in, out, min_rp, pc.mu)) return INF;
+
+    double dv = std::abs(out - in);
+    const double cos_turn = std::max(-1.0, std::min(1.0, dot(v_in, v_out) / (in * out)));
+    const double turn = std::acos(cos_turn);
+    const double v_avg = 0.5 * (in + out);
+    if (GravityAssist::periapsis_for_turn_angle(v_avg, turn, pc.mu) < min_rp) {
+        const double max_turn = 2.0 * std::asin(1.0 / (1.0 + min_rp * v_avg * v_avg / pc.mu));
+        if (turn > max_turn) dv += 2.0 * v_avg * std::sin(0.5 * (turn - max_turn));
+    }
+    return dv;
+}
+
+}  // namespace
+
+FlybySequenceSearch::FlybySequenceSearch(Planet departure, Planet target,
+                                         const SequenceSearchConfig& config)
+    : departure_(departure), target_(target), config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+FlybySequenceSearch::~FlybySequenceSearch() = default;
+
+std::vector<SequenceCandidate> FlybySequenceSearch::search(double launch_start_jd,
+                                                           double launch_end_jd) {
+    stats_ = SequenceSearchStats();
+    cells_.clear();
+    std::vector<SequenceCandidate> ranked;
+    const double step = config_.date_step;
+    if (!(step > 0.0) || launch_end_jd < launch_start_jd) return ranked;
+
+    auto run = [this](size_t count, const std::function<void(size_t)>& fn) {
+        if (pool_ && count > 1) {
+            pool_->parallel_for(count, fn);
+        } else {
+            for (size_t i = 0; i < count; i++) fn(i);
+        }
+    };
+    auto jd_of = [&](int index) { return launch_start_jd + index * step; };
+
+    const int launches = static_cast<int>(std::floor((launch_end_jd - launch_start_jd) / step)) + 1;
+    const int max_span = static_cast<int>(std::floor(config_.max_tof_days / step));
+    EphemerisCache::prefit(launch_start_jd, jd_of(launches + max_span));
+
+    // Grid offsets tried per (from, to) leg
+    std::map<std::pair<Planet, Planet>, std::vector<int>> offsets;
+    auto leg_offsets = [&](Planet from, Planet to) -> const std::vector<int>& {
+        auto it = offsets.find({from, to});
+        if (it != offsets.end()) return it->second;
+        double lo, hi;
+        tof_range(from, to, lo, hi);
+        lo = std::max(lo, config_.min_leg_days);
+        const int first = static_cast<int>(std::ceil(lo / step));
+        const int last = static_cast<int>(std::floor(hi / step));
+        const int count = last - first + 1;
+        const int stride = std::max(1, (count + std::max(1, config_.tof_steps) - 1) /
+                                           std::max(1, config_.tof_steps));
+        std::vector<int>& list = offsets[{from, to}];
+        for (int k = first; k <= last; k += stride) list.push_back(k);
+        return list;
+    };
+
+    std::vector<Tour> beam(launches);
+    for (int k = 0; k < launches; k++) {
+        beam[k].bodies = {departure_};
+        beam[k].dates = {k};
+    }
+
+    std::map<std::vector<Planet>, Tour> complete;   // Best tour per sequence
+    auto bound = [&] {
+        if (complete.size() < static_cast<size_t>(std::max(1, config_.results))) return INF;
+        std::vector<double> costs;
+        for (const auto& c : complete) costs.push_back(c.second.cost);
+        std::nth_element(costs.begin(), costs.begin() + (config_.results - 1), costs.end());
+        return costs[config_.results - 1];
+    };
+
+    struct Request {
+        uint64_t key;
+        Planet from, to;
+        int depart, arrive;
+        bool operator<(const Request& o) const { return key < o.key; }
+        bool operator==(const Request& o) const { return key == o.key; }
+    };
+
+    for (int level = 0; level <= config_.max_flybys && !beam.empty(); level++) {
+        stats_.levels++;
+        stats_.expanded += beam.size();
+        const bool flybys_left = level < config_.max_flybys;
+
+        // Next bodies of each tour that pass the Tisserand bound
+        std::vector<std::vector<Planet>> next(beam.size());
+        std::vector<Request> missing;
+        for (size_t t = 0; t < beam.size(); t++) {
+            const Tour& tour = beam[t];
+            const Planet from = tour.bodies.back();
+            const double v_inf = tour.bodies.size() == 1
+                ? config_.max_launch_v_inf : tour.v_inf_in.norm() + config_.max_flyby_dv;
+            std::vector<Planet> options;
+            if (flybys_left) options = config_.flyby_bodies;
+            if (std::find(options.begin(), options.end(), target_) == options.end()) {
+                options.push_back(target_);
+            }
+            for (Planet to : options) {
+                if (!tisserand_reachable(from, to, v_inf)) {
+                    stats_.tisserand_pruned++;
+                    continue;
+                }
+                next[t].push_back(to);
+                const int depart = tour.dates.back();
+                for (int off : leg_offsets(from, to)) {
+                    const int arrive = depart + off;
+                    if (arrive - tour.dates.front() > max_span) break;
+                    const uint64_t k = key(from, to, depart, arrive);
+                    if (cells_.count(k)) {
+                        stats_.cache_hits++;
+                    } else {
+                        missing.push_back({k, from, to, depart, arrive});
+                    }
+                }
+            }
+        }
+
+        // Solve the missing porkchop cells
+        std::sort(missing.begin(), missing.end());
+        stats_.cache_hits += missing.size();
+        missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+        stats_.cache_hits -= missing.size();
+        std::vector<C3Result> solved(missing.size());
+        run(missing.size(), [&](size_t i) {
+            const Request& r = missing[i];
+            solved[i] = InterplanetaryPlanner::compute_transfer(
+                r.from, r.to, jd_of(r.depart), jd_of(r.arrive),
+                config_.departure_parking_alt, config_.arrival_parking_alt);
+        });
+        for (size_t i = 0; i < missing.size(); i++) cells_.emplace(missing[i].key, solved[i]);
+        stats_.lambert_solves += missing.size();
+
+        // Expand every tour against the cached cells
+        std::vector<std::vector<Tour>> children(beam.size()), finished(beam.size());
+        std::vector<size_t> rejected(beam.size(), 0);
+        run(beam.size(), [&](size_t t) {
+            const Tour& tour = beam[t];
+            const Planet from = tour.bodies.back();
+            const int depart = tour.dates.back();
+            const Vec3 v_from = tour.bodies.size() == 1
+                ? Vec3::Zero() : EphemerisCache::planet_velocity_hci(from, jd_of(depart));
+            for (Planet to : next[t]) {
+                for (int off : leg_offsets(from, to)) {
+                    const int arrive = depart + off;
+                    if (arrive - tour.dates.front() > max_span) break;
+                    const C3Result& cell = cells_.at(key(from, to, depart, arrive));
+                    if (!cell.valid) continue;
+
+                    double cost;
+                    if (tour.bodies.size() == 1) {
+                        if (cell.v_inf_departure > config_.max_launch_v_inf) {
+                            rejected[t]++;
+                            continue;
+                        }
+                        const PlanetaryConstants& pc = PlanetaryConstants::get(from);
+                        cost = InterplanetaryPlanner::departure_delta_v(
+                            cell.c3_departure, pc.radius + config_.departure_parking_alt, pc.mu);
+                    } else {
+                        cost = flyby_cost(from, tour.v_inf_in, cell.v_departure_hci - v_from,
+                                          config_.min_flyby_altitude);
+                        if (!(cost <= config_.max_flyby_dv)) {
+                            rejected[t]++;
+                            continue;
+                        }
+                    }
+
+                    Tour child;
+                    child.bodies = tour.bodies;
+                    child.bodies.push_back(to);
+                    child.dates = tour.dates;
+                    child.dates.push_back(arrive);
+                    child.cost = tour.cost + cost;
+                    if (to == target_) {
+                        const PlanetaryConstants& pc = PlanetaryConstants::get(to);
+                        child.cost += InterplanetaryPlanner::capture_delta_v(
+                            cell.v_inf_arrival, pc.radius + config_.arrival_parking_alt, pc.mu);
+                        finished[t].push_back(std::move(child));
+                    } else {
+                        child.v_inf_in = cell.v_arrival_hci -
+                            EphemerisCache::planet_velocity_hci(to, jd_of(arrive));
+                        children[t].push_back(std::move(child));
+                    }
+                }
+            }
+        });
+
+        std::vector<Tour> pool;
+        for (size_t t = 0; t < beam.size(); t++) {
+            stats_.flyby_pruned += rejected[t];
+            for (Tour& done : finished[t]) {
+                auto it = complete.find(done.bodies);
+                if (it == complete.end() || tour_less(done, it->second)) {
+                    complete[done.bodies] = done;
+                }
+            }
+            for (Tour& child : children[t]) pool.push_back(std::move(child));
+        }
+
+        // Next beam: cheapest first, capped per sequence and in total
+        std::sort(pool.begin(), pool.end(), tour_less);
+        const double limit = bound();
+        std::map<std::vector<Planet>, int> per_sequence;
+        std::set<std::tuple<std::vector<Planet>, int, int>> seen;
+        beam.clear();
+        for (Tour& tour : pool) {
+            if (tour.cost >= limit) {
+                stats_.bound_pruned++;
+                continue;
+            }
+            if (static_cast<int>(beam.size()) >= config_.beam_width) break;
+            const int bin = static_cast<int>(tour.v_inf_in.norm() / config_.v_inf_bin);
+            if (!seen.emplace(tour.bodies, tour.dates.back(), bin).second) continue;
+            int& count = per_sequence[tour.bodies];
+            if (count >= config_.beam_per_sequence) continue;
+            count++;
+            beam.push_back(std::move(tour));
+        }
+    }
+    stats_.sequences = complete.size();
+
+    // Rank, then refine each sequence's dates
+    std::vector<Tour> best;
+    for (auto& c : complete) best.push_back(c.second);
+    std::sort(best.begin(), best.end(), tour_less);
+    if (best.size() > static_cast<size_t>(std::max(0, config_.results))) {
+        best.resize(std::max(0, config_.results));
+    }
+
+    ranked.resize(best.size());
+    run(best.size(), [&](size_t i) {
+        SequenceCandidate& c = ranked[i];
+        c.bodies = best[i].bodies;
+        c.grid_delta_v = best[i].cost;
+        for (int d : best[i].dates) c.dates_jd.push_back(jd_of(d));
+        c.total_delta_v = MissionDesigner::compute_total_dv(
+            c.bodies, c.dates_jd, config_.departure_parking_alt, config_.arrival_parking_alt);
+        if (config_.optimize_dates && c.bodies.size() >= 3) {
+            const std::vector<double> dates =
+                MissionDesigner::optimize_dates(c.bodies, c.dates_jd).epoch_jd;
+            const double dv = MissionDesigner::compute_total_dv(
+                c.bodies, dates, config_.departure_parking_alt, config_.arrival_parking_alt);
+            if (dv < c.total_delta_v) {
+                c.dates_jd = dates;
+                c.total_delta_v = dv;
+            }
+        }
+        c.mission = MissionDesigner::build_mission(c.bodies, c.dates_jd,
+                                                   config_.departure_parking_alt,
+                                                   config_.arrival_parking_alt);
+    });
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const SequenceCandidate& a, const SequenceCandidate& b) {
+                         return a.total_delta_v < b.total_delta_v;
+                     });
+    return ranked;
+}
+
+}  // namespace sim
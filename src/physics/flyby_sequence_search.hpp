@@ -0,0 +1,124 @@
+/**
+ * Flyby Sequence Search
+ *
+ * Finds gravity-assist sequences (VEEGA-like tours) from a departure
+ * planet to a target, rather than evaluating one user-chosen
+ * body_sequence with MissionDesigner::build_mission.
+ *
+ * Sequences grow breadth-first, one encounter per level, as a beam of
+ * partial tours with dates. Encounter dates lie on a common grid of
+ * date_step days from the launch window start, so every leg is one
+ * (from, to, departure date, arrival date) cell of a porkchop. Cells are
+ * Lambert-solved by InterplanetaryPlanner::compute_transfer once and
+ * cached for the whole search. At each level:
+ *
+ *   1. Tisserand bound: a leg from body A can only reach body B if B's
+ *      orbit radius lies between the perihelion and aphelion of a
+ *      tangential departure from A's circular orbit at the largest v-inf
+ *      available there: max_launch_v_inf at launch, or the arrival v-inf
+ *      plus max_flyby_dv at a flyby. Pairs outside are never solved.
+ *   2. The cells the beam needs that are not cached are solved in parallel.
+ *   3. Expansion (in parallel over partial tours, merged in tour order):
+ *      a flyby is rejected by GravityAssist::is_feasible or when its
+ *      v-inf mismatch plus unreachable turn (costed as compute_total_dv
+ *      does) exceeds max_flyby_dv; a launch above max_launch_v_inf is
+ *      rejected too.
+ *   4. Tours reaching the target are complete. The rest form the next
+ *      beam, cheapest first: at most beam_per_sequence tours per body
+ *      sequence, one per (sequence, last date, arrival v-inf bin), and
+ *      beam_width in total. Partial tours already costlier than the
+ *      results-th best complete sequence are dropped (costs only grow).
+ *
+ * Each sequence's best grid tour is then refined by
+ * MissionDesigner::optimize_dates (in parallel) and ranked by
+ * compute_total_dv. Planet orbits are treated as circular and coplanar in
+ * the Tisserand bound only; legs are zero-revolution prograde Lambert
+ * arcs, so resonant same-body returns need a tof away from whole periods.
+ * Results do not depend on the thread count.
+ */
+
+#ifndef SIM_FLYBY_SEQUENCE_SEARCH_HPP
+#define SIM_FLYBY_SEQUENCE_SEARCH_HPP
+
+#include "physics/mission_sequence.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+struct SequenceSearchConfig {
+    std::vector<Planet> flyby_bodies = {Planet::VENUS, Planet::EARTH, Planet::MARS,
+                                        Planet::JUPITER};
+    int max_flybys = 3;
+    double date_step = 5.0;             // Encounter date grid [days]
+    int tof_steps = 60;                 // Times of flight tried per leg, at most
+    double min_leg_days = 20.0;
+    double max_tof_days = 3650.0;       // Whole tour
+    double max_launch_v_inf = 5000.0;   // [m/s]
+    double max_flyby_dv = 500.0;        // Powered flyby allowance per encounter [m/s]
+    double min_flyby_altitude = 200e3;  // [m]
+    double departure_parking_alt = 200e3;
+    double arrival_parking_alt = 200e3;
+    int beam_width = 1000;              // Partial tours kept per level
+    int beam_per_sequence = 200;        // Of those, sharing one body sequence
+    double v_inf_bin = 500.0;           // One tour per (sequence, last date, v-inf bin) [m/s]
+    int results = 10;                   // Ranked sequences returned
+    bool optimize_dates = true;         // Refine each result with optimize_dates
+    int num_threads = 0;                // 0 = hardware concurrency, 1 = serial
+};
+
+struct SequenceCandidate {
+    std::vector<Planet> bodies;
+    std::vector<double> dates_jd;       // Optimized when optimize_dates is set
+    double grid_delta_v = 0.0;          // Best tour on the date grid [m/s]
+    double total_delta_v = 0.0;         // compute_total_dv at dates_jd [m/s]
+    MissionSequence mission;
+};
+
+struct SequenceSearchStats {
+    size_t levels = 0;
+    size_t expanded = 0;                // Partial tours expanded
+    size_t tisserand_pruned = 0;        // (tour, next body) pairs never solved
+    size_t flyby_pruned = 0;            // Legs rejected at the flyby or launch
+    size_t bound_pruned = 0;            // Partial tours dropped by the cost bound
+    size_t lambert_solves = 0;          // Cache misses
+    size_t cache_hits = 0;
+    size_t sequences = 0;               // Distinct complete sequences found
+};
+
+class FlybySequenceSearch {
+public:
+    FlybySequenceSearch(Planet departure, Planet target,
+                        const SequenceSearchConfig& config = SequenceSearchConfig());
+    ~FlybySequenceSearch();
+
+    /**
+     * Search sequences launching in [launch_start_jd, launch_end_jd]
+     * @return Up to config.results sequences, lowest total delta-V first
+     */
+    std::vector<SequenceCandidate> search(double launch_start_jd, double launch_end_jd);
+
+    const SequenceSearchStats& stats() const { return stats_; }
+
+private:
+    Planet departure_;
+    Planet target_;
+    SequenceSearchConfig config_;
+    std::unordered_map<uint64_t, C3Result> cells_;   // Porkchop cells by key()
+    SequenceSearchStats stats_;
+    std::shared_ptr<ThreadPool> pool_;               // Null when serial
+
+    static uint64_t key(Planet from, Planet to, int depart, int arrive) {
+        return (static_cast<uint64_t>(from) << 60) | (static_cast<uint64_t>(to) << 56) |
+               (static_cast<uint64_t>(depart) << 28) | static_cast<uint64_t>(arrive);
+    }
+};
+
+}  // namespace sim
+
+#endif  // SIM_FLYBY_SEQUENCE_SEARCH_HPP
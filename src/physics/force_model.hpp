@@ -0,0 +1,195 @@
+/**
+ * Force Model — PerturbationConfig presets compiled into fixed kernels
+ *
+ * Each perturbation term is a policy type in sim::forces whose add()
+ * accumulates its acceleration. ForceModel<Terms...> is two-body gravity
+ * plus exactly those terms, summed in the order
+ * OrbitalPerturbations::compute_total_acceleration uses, with no flag
+ * tests: a preset compiles to one straight-line, fully inlined kernel.
+ * compute_total_acceleration itself is the generic path over the same
+ * policies, so a matching instantiation agrees with it to rounding (the
+ * compiler may contract multiply-adds differently once the terms are
+ * inlined together; ~1e-15 relative).
+ *
+ *   Preset                          Model
+ *   two_body_only                   TwoBodyForces
+ *   j2_only                         J2Forces
+ *   full_harmonics                  ZonalForces
+ *   geo_satellite                   GEOForces
+ *   full_fidelity, leo_satellite    FullForces
+ *
+ * dispatch_force_model(config, fn) calls fn once with the model whose
+ * term set equals the config's flags (and which has no gravity field or
+ * grid), or with GenericForceModel otherwise. Term parameters (drag
+ * coefficients, SRP parameters, eclipse timeline) are still read from the
+ * config at run time.
+ */
+
+#ifndef SIM_FORCE_MODEL_HPP
+#define SIM_FORCE_MODEL_HPP
+
+#include "physics/orbital_perturbations.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "physics/celestial_body.hpp"
+#include "physics/eclipse_timeline.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/gravity_utils.hpp"
+#include "physics/solar_radiation_pressure.hpp"
+#include <utility>
+
+namespace sim {
+
+namespace forces {
+
+inline void accumulate(Vec3& a, const Vec3& t) {
+    a.x += t.x;
+    a.y += t.y;
+    a.z += t.z;
+}
+
+struct J2 {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::j2;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig&, double, Vec3& a) {
+        const auto& earth = gravity::BodyConstants::EARTH;
+        accumulate(a, gravity::j2_perturbation(r, earth.mu, earth.j2, earth.radius));
+    }
+};
+
+struct J3 {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::j3;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig&, double, Vec3& a) {
+        const auto& earth = gravity::BodyConstants::EARTH;
+        accumulate(a, gravity::j3_perturbation(r, earth.mu, earth.j3, earth.radius));
+    }
+};
+
+struct J4 {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::j4;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig&, double, Vec3& a) {
+        const auto& earth = gravity::BodyConstants::EARTH;
+        accumulate(a, gravity::j4_perturbation(r, earth.mu, earth.j4, earth.radius));
+    }
+};
+
+struct Moon {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::moon;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig&, double jd, Vec3& a) {
+        accumulate(a, gravity::third_body_perturbation(r, EphemerisCache::moon_eci(jd), MOON_MU));
+    }
+};
+
+struct Sun {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::sun;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig&, double jd, Vec3& a) {
+        accumulate(a, gravity::third_body_perturbation(r, EphemerisCache::sun_eci(jd), SUN_MU));
+    }
+};
+
+/** SRP, with the shadow state from the eclipse timeline inside its span */
+inline Vec3 srp_acceleration(const Vec3& position, const PerturbationConfig& config, double jd) {
+    Vec3 sun_pos = EphemerisCache::sun_eci(jd);
+    if (config.eclipses) {
+        const EclipseTimeline& tl = *config.eclipses;
+        double t = (jd - tl.epoch_jd()) * 86400.0;
+        if (tl.covers(t)) {
+            return SolarRadiationPressure::compute_acceleration(
+                position, sun_pos, config.srp_params, tl.in_shadow(t));
+        }
+    }
+    return SolarRadiationPressure::compute_acceleration(position, sun_pos, config.srp_params);
+}
+
+struct SRP {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::srp;
+    static void add(const Vec3& r, const Vec3&, const PerturbationConfig& c, double jd, Vec3& a) {
+        accumulate(a, srp_acceleration(r, c, jd));
+    }
+};
+
+/** Drag in a co-rotating atmosphere below 200 km */
+struct Drag {
+    static constexpr bool PerturbationConfig::*flag = &PerturbationConfig::drag;
+    static void add(const Vec3& r, const Vec3& v, const PerturbationConfig& c, double, Vec3& a) {
+        double alt = r.norm() - EARTH_RADIUS;
+        if (!(alt > 0.0 && alt < 200000.0)) return;
+
+        // v_rel = v_inertial - omega_earth x r
+        Vec3 v_rel{v.x + EARTH_OMEGA * r.y, v.y - EARTH_OMEGA * r.x, v.z};
+        double v_mag = v_rel.norm();
+        if (!(v_mag > 1.0)) return;
+        double rho = AtmosphereTable::earth().density(alt);
+        if (!(rho > 1e-20)) return;
+
+        // a_drag = -0.5 * rho * v^2 * Cd * A / m * v_hat
+        double bc_inv = c.drag_cd * c.drag_area / c.drag_mass;
+        double drag_mag = 0.5 * rho * v_mag * v_mag * bc_inv;
+        double inv_v = 1.0 / v_mag;
+        a.x -= drag_mag * v_rel.x * inv_v;
+        a.y -= drag_mag * v_rel.y * inv_v;
+        a.z -= drag_mag * v_rel.z * inv_v;
+    }
+};
+
+} // namespace forces
+
+/** Two-body gravity plus exactly Terms, in compute_total_acceleration order */
+template <typename... Terms>
+struct ForceModel {
+    static Vec3 acceleration(const Vec3& r, [[maybe_unused]] const Vec3& v,
+                             [[maybe_unused]] const PerturbationConfig& c,
+                             [[maybe_unused]] double jd) {
+        Vec3 a = gravity::two_body_acceleration(r, gravity::BodyConstants::EARTH.mu);
+        (Terms::add(r, v, c, jd, a), ...);
+        return a;
+    }
+
+    static constexpr bool has([[maybe_unused]] bool PerturbationConfig::*flag) {
+        return ((Terms::flag == flag) || ...);
+    }
+
+    /** Whether this model computes exactly what the config asks for */
+    static bool matches(const PerturbationConfig& c) {
+        if (c.gravity_field || c.gravity_grid) return false;
+        for (bool PerturbationConfig::*f : {&PerturbationConfig::j2, &PerturbationConfig::j3,
+                                            &PerturbationConfig::j4, &PerturbationConfig::moon,
+                                            &PerturbationConfig::sun, &PerturbationConfig::srp,
+                                            &PerturbationConfig::drag}) {
+            if (c.*f != has(f)) return false;
+        }
+        return true;
+    }
+};
+
+/** Any config, with its runtime flag tests */
+struct GenericForceModel {
+    static Vec3 acceleration(const Vec3& r, const Vec3& v, const PerturbationConfig& c,
+                             double jd) {
+        return OrbitalPerturbations::compute_total_acceleration(r, v, c, jd);
+    }
+};
+
+using TwoBodyForces = ForceModel<>;
+using J2Forces = ForceModel<forces::J2>;
+using ZonalForces = ForceModel<forces::J2, forces::J3, forces::J4>;
+using GEOForces = ForceModel<forces::J2, forces::J3, forces::J4,
+                             forces::Moon, forces::Sun, forces::SRP>;
+using FullForces = ForceModel<forces::J2, forces::J3, forces::J4,
+                              forces::Moon, forces::Sun, forces::SRP, forces::Drag>;
+
+/**
+ * Call fn(Model{}) with the compiled model matching config, or with
+ * GenericForceModel; every branch must return the same type.
+ */
+template <typename Fn>
+decltype(auto) dispatch_force_model(const PerturbationConfig& config, Fn&& fn) {
+    if (TwoBodyForces::matches(config)) return std::forward<Fn>(fn)(TwoBodyForces{});
+    if (J2Forces::matches(config)) return std::forward<Fn>(fn)(J2Forces{});
+    if (ZonalForces::matches(config)) return std::forward<Fn>(fn)(ZonalForces{});
+    if (GEOForces::matches(config)) return std::forward<Fn>(fn)(GEOForces{});
+    if (FullForces::matches(config)) return std::forward<Fn>(fn)(FullForces{});
+    return std::forward<Fn>(fn)(GenericForceModel{});
+}
+
+} // namespace sim
+
+#endif // SIM_FORCE_MODEL_HPP
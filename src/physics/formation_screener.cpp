@@ -0,0 +1,411 @@
+/**
+ * Formation Screener Implementation
+ */
+
+#include "physics/formation_screener.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr int TCA_ITERATIONS = 12;      // Lockstep Newton steps per batch
+constexpr double END_TOLERANCE = 1e-6;  // A TCA this close to an arc end is on it [s]
+
+/// Range of cos over [lo, hi]
+void cos_range(double lo, double hi, double& cmin, double& cmax) {
+    const double c_lo = std::cos(lo), c_hi = std::cos(hi);
+    cmin = std::min(c_lo, c_hi);
+    cmax = std::max(c_lo, c_hi);
+    constexpr double TWO_PI = 2.0 * M_PI;
+    if (std::floor(hi / TWO_PI) >= std::ceil(lo / TWO_PI)) {
+        cmax = 1.0;                     // A multiple of 2 pi inside
+    }
+    if (std::floor((hi - M_PI) / TWO_PI) >= std::ceil((lo - M_PI) / TWO_PI)) {
+        cmin = -1.0;                    // An odd multiple of pi inside
+    }
+}
+
+/**
+ * Box of c0 + c1 s + a cos(n s) + b sin(n s) over s in [0, span], per
+ * axis: the linear and harmonic ranges added, which contains the curve.
+ */
+void arc_box(const double* c0, const double* c1, const double* a, const double* b,
+             double n, double span, double* lo, double* hi) {
+    for (int k = 0; k < 3; k++) {
+        const double l0 = c0[k], l1 = c0[k] + c1[k] * span;
+        const double amp = std::hypot(a[k], b[k]);
+        double cmin = 1.0, cmax = 1.0;
+        if (amp > 0.0) {
+            // a cos(x) + b sin(x) = amp cos(x - phase)
+            const double phase = std::atan2(b[k], a[k]);
+            cos_range(-phase, n * span - phase, cmin, cmax);
+        }
+        lo[k] = std::min(l0, l1) + amp * cmin;
+        hi[k] = std::max(l0, l1) + amp * cmax;
+    }
+}
+
+/// The coefficients re-referenced to start `shift` seconds later
+void shift_coefficients(double* c0, const double* c1, double* a, double* b,
+                        double n, double shift) {
+    const double c = std::cos(n * shift), s = std::sin(n * shift);
+    for (int k = 0; k < 3; k++) {
+        c0[k] += c1[k] * shift;
+        const double ak = a[k], bk = b[k];
+        a[k] = ak * c + bk * s;
+        b[k] = bk * c - ak * s;
+    }
+}
+
+}  // namespace
+
+/// Relative arc of two plans over their common span
+struct FormationScreener::Candidate {
+    uint32_t first, second;
+    double t0, span;
+    double c0[3], c1[3], a[3], b[3];
+
+    void eval(double n, double s, double* r, double* dr, double* ddr) const {
+        const double c = std::cos(n * s), sn = std::sin(n * s);
+        for (int k = 0; k < 3; k++) {
+            const double h = a[k] * c + b[k] * sn;
+            r[k] = c0[k] + c1[k] * s + h;
+            dr[k] = c1[k] + n * (b[k] * c - a[k] * sn);
+            ddr[k] = -n * n * h;
+        }
+    }
+
+    /// g(s) = r . r' (half the derivative of the squared range)
+    double g(double n, double s) const {
+        double r[3], dr[3], ddr[3];
+        eval(n, s, r, dr, ddr);
+        return r[0] * dr[0] + r[1] * dr[1] + r[2] * dr[2];
+    }
+};
+
+FormationScreener::FormationScreener(const FormationConfig& config)
+    : config_(config) {}
+
+FormationScreener::Tree FormationScreener::build(const FormationPlan& plan) const {
+    const ProxOpsTrajectory& traj = plan.trajectory;
+    if (traj.waypoints.size() != traj.transfer_times.size()) {
+        throw std::invalid_argument("FormationScreener: plan has " +
+                                    std::to_string(traj.waypoints.size()) + " waypoints but " +
+                                    std::to_string(traj.transfer_times.size()) +
+                                    " transfer times");
+    }
+
+    Tree tree;
+    const double n = n_;
+    auto hold = [&](double t0, double t1, const Vec3& p) {
+        if (!(t1 > t0)) return;
+        Arc arc{t0, t1, {p.x, p.y, p.z}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+        tree.arcs.push_back(arc);
+    };
+
+    Vec3 pos = plan.start;
+    double t = std::max(plan.start_time, 0.0);
+    hold(0.0, t, pos);
+    for (size_t k = 0; k < traj.waypoints.size(); k++) {
+        const Vec3& wp = traj.waypoints[k].position;
+        const double tof = traj.transfer_times[k];
+        if (tof > 0.0) {
+            // Leaves pos at rest with the transfer's first burn
+            const Vec3 v = ProximityOps::cw_transfer(pos, wp, tof, n).first;
+            Arc arc;
+            arc.t0 = t;
+            arc.c0[0] = 4.0 * pos.x + 2.0 * v.y / n;
+            arc.c1[0] = 0.0;
+            arc.a[0] = -3.0 * pos.x - 2.0 * v.y / n;
+            arc.b[0] = v.x / n;
+            arc.c0[1] = pos.y - 2.0 * v.x / n;
+            arc.c1[1] = -6.0 * n * pos.x - 3.0 * v.y;
+            arc.a[1] = 2.0 * v.x / n;
+            arc.b[1] = 6.0 * pos.x + 4.0 * v.y / n;
+            arc.c0[2] = 0.0;
+            arc.c1[2] = 0.0;
+            arc.a[2] = pos.z;
+            arc.b[2] = v.z / n;
+
+            const int pieces = std::max(1, static_cast<int>(std::ceil(tof / config_.arc_step)));
+            const double step = tof / pieces;
+            for (int p = 0; p < pieces; p++) {
+                arc.t1 = p + 1 == pieces ? t + tof : arc.t0 + step;
+                tree.arcs.push_back(arc);
+                shift_coefficients(arc.c0, arc.c1, arc.a, arc.b, n, step);
+                arc.t0 = arc.t1;
+            }
+            t += tof;
+        }
+        pos = wp;
+        const double dwell = traj.waypoints[k].hold_time;
+        if (dwell > 0.0) {
+            hold(t, t + dwell, pos);
+            t += dwell;
+        }
+    }
+    tree.end = t;
+    hold(t, INF, pos);
+
+    // Balanced tree over the arcs, root first
+    tree.nodes.reserve(2 * tree.arcs.size());
+    auto make = [&](auto& self, int32_t lo, int32_t hi) -> int32_t {
+        const int32_t index = static_cast<int32_t>(tree.nodes.size());
+        tree.nodes.push_back(Node{});
+        Node node;
+        node.t0 = tree.arcs[lo].t0;
+        node.t1 = tree.arcs[hi - 1].t1;
+        if (hi - lo == 1) {
+            const Arc& arc = tree.arcs[lo];
+            // The never-ending hold is a point; bound coasts over their span
+            const double span = std::isfinite(arc.t1) ? arc.t1 - arc.t0 : 0.0;
+            arc_box(arc.c0, arc.c1, arc.a, arc.b, n, span, node.lo, node.hi);
+            node.left = node.right = -1;
+            node.arc = lo;
+        } else {
+            const int32_t mid = lo + (hi - lo) / 2;
+            node.left = self(self, lo, mid);
+            node.right = self(self, mid, hi);
+            node.arc = -1;
+            const Node& l = tree.nodes[node.left];
+            const Node& r = tree.nodes[node.right];
+            for (int k = 0; k < 3; k++) {
+                node.lo[k] = std::min(l.lo[k], r.lo[k]);
+                node.hi[k] = std::max(l.hi[k], r.hi[k]);
+            }
+        }
+        tree.nodes[index] = node;
+        return index;
+    };
+    make(make, 0, static_cast<int32_t>(tree.arcs.size()));
+    return tree;
+}
+
+void FormationScreener::set_plans(const std::vector<FormationPlan>& plans, double n) {
+    if (!(n > 0.0)) throw std::invalid_argument("FormationScreener: mean motion must be positive");
+    n_ = n;
+    trees_.clear();
+    trees_.reserve(plans.size());
+    for (const auto& plan : plans) trees_.push_back(build(plan));
+}
+
+void FormationScreener::replace(size_t i, const FormationPlan& plan) {
+    if (i >= trees_.size()) throw std::out_of_range("FormationScreener::replace: no plan " +
+                                                    std::to_string(i));
+    trees_[i] = build(plan);
+}
+
+double FormationScreener::horizon() const {
+    if (config_.horizon > 0.0) return config_.horizon;
+    double end = 0.0;
+    for (const auto& tree : trees_) end = std::max(end, tree.end);
+    return end;
+}
+
+RelativeState FormationScreener::state(size_t i, double t) const {
+    const std::vector<Arc>& arcs = trees_.at(i).arcs;
+    auto it = std::upper_bound(arcs.begin(), arcs.end(), t,
+                               [](double time, const Arc& arc) { return time < arc.t0; });
+    const Arc& arc = it == arcs.begin() ? arcs.front() : *(it - 1);
+    const double s = t - arc.t0;
+    const double c = std::cos(n_ * s), sn = std::sin(n_ * s);
+    double r[3], v[3];
+    for (int k = 0; k < 3; k++) {
+        r[k] = arc.c0[k] + arc.c1[k] * s + arc.a[k] * c + arc.b[k] * sn;
+        v[k] = arc.c1[k] + n_ * (arc.b[k] * c - arc.a[k] * sn);
+    }
+    RelativeState out;
+    out.position = Vec3(r[0], r[1], r[2]);
+    out.velocity = Vec3(v[0], v[1], v[2]);
+    return out;
+}
+
+void FormationScreener::descend(size_t i, size_t j, double horizon, std::vector<Candidate>& out) {
+    const Tree& ti = trees_[i];
+    const Tree& tj = trees_[j];
+    const double dist = config_.threshold;
+    const double n = n_;
+
+    // Depth-first; the stack never holds more than both trees' depths
+    struct Pair { int32_t a, b; };
+    Pair stack[128];
+    int top = 0;
+    stack[top++] = {0, 0};
+    while (top > 0) {
+        const Pair p = stack[--top];
+        const Node& a = ti.nodes[p.a];
+        const Node& b = tj.nodes[p.b];
+        stats_.node_pairs++;
+
+        const double t0 = std::max(a.t0, b.t0);
+        const double t1 = std::min({a.t1, b.t1, horizon});
+        if (!(t1 > t0)) continue;
+        double gap2 = 0.0;
+        for (int k = 0; k < 3; k++) {
+            const double gap = std::max({0.0, a.lo[k] - b.hi[k], b.lo[k] - a.hi[k]});
+            gap2 += gap * gap;
+        }
+        if (gap2 > dist * dist) continue;
+
+        const bool a_leaf = a.arc >= 0, b_leaf = b.arc >= 0;
+        if (!a_leaf || !b_leaf) {
+            // Split the node with the longer span (inner nodes before leaves)
+            const bool split_a = !a_leaf && (b_leaf || a.t1 - a.t0 >= b.t1 - b.t0);
+            if (split_a) {
+                stack[top++] = {a.right, p.b};
+                stack[top++] = {a.left, p.b};
+            } else {
+                stack[top++] = {p.a, b.right};
+                stack[top++] = {p.a, b.left};
+            }
+            continue;
+        }
+
+        // Arc pair: relative arc over the common span
+        stats_.leaf_pairs++;
+        Arc x = ti.arcs[a.arc], y = tj.arcs[b.arc];
+        shift_coefficients(x.c0, x.c1, x.a, x.b, n, t0 - x.t0);
+        shift_coefficients(y.c0, y.c1, y.a, y.b, n, t0 - y.t0);
+        Candidate c;
+        c.first = static_cast<uint32_t>(std::min(i, j));
+        c.second = static_cast<uint32_t>(std::max(i, j));
+        c.t0 = t0;
+        c.span = t1 - t0;
+        for (int k = 0; k < 3; k++) {
+            c.c0[k] = y.c0[k] - x.c0[k];
+            c.c1[k] = y.c1[k] - x.c1[k];
+            c.a[k] = y.a[k] - x.a[k];
+            c.b[k] = y.b[k] - x.b[k];
+        }
+
+        double lo[3], hi[3];
+        arc_box(c.c0, c.c1, c.a, c.b, n, c.span, lo, hi);
+        double near2 = 0.0;
+        for (int k = 0; k < 3; k++) {
+            const double d = std::max({0.0, lo[k], -hi[k]});
+            near2 += d * d;
+        }
+        if (near2 > dist * dist) {
+            stats_.time_rejects++;
+            continue;
+        }
+        out.push_back(c);
+    }
+}
+
+std::vector<FormationConflict> FormationScreener::refine(std::vector<Candidate>& candidates) {
+    const size_t m = candidates.size();
+    const double n = n_;
+    stats_.refined += m;
+
+    // Minimum of each arc: an end where the range grows away from it, else
+    // the root of g inside, found by all candidates' Newton steps in turn
+    std::vector<double> s(m), lo(m), hi(m);
+    std::vector<unsigned char> interior(m);
+    for (size_t k = 0; k < m; k++) {
+        const Candidate& c = candidates[k];
+        const double g0 = c.g(n, 0.0), g1 = c.g(n, c.span);
+        interior[k] = g0 < 0.0 && g1 > 0.0;
+        lo[k] = 0.0;
+        hi[k] = c.span;
+        s[k] = interior[k] ? c.span * g0 / (g0 - g1) : (g0 >= 0.0 ? 0.0 : c.span);
+    }
+    for (int it = 0; it < TCA_ITERATIONS; it++) {
+        for (size_t k = 0; k < m; k++) {
+            if (!interior[k]) continue;
+            double r[3], dr[3], ddr[3];
+            candidates[k].eval(n, s[k], r, dr, ddr);
+            const double g = r[0] * dr[0] + r[1] * dr[1] + r[2] * dr[2];
+            const double dg = dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2] +
+                              r[0] * ddr[0] + r[1] * ddr[1] + r[2] * ddr[2];
+            if (g < 0.0) lo[k] = s[k]; else hi[k] = s[k];
+            double next = s[k] - g / dg;
+            if (!(next > lo[k] && next < hi[k])) next = 0.5 * (lo[k] + hi[k]);
+            s[k] = next;
+        }
+    }
+
+    struct Minimum {
+        FormationConflict conflict;
+        double t0, t1;
+        bool at_start, at_end;        // On an end of its arc
+    };
+    std::vector<Minimum> minima;
+    const double dist = config_.threshold;
+    for (size_t k = 0; k < m; k++) {
+        const Candidate& c = candidates[k];
+        double r[3], dr[3], ddr[3];
+        c.eval(n, s[k], r, dr, ddr);
+        const double miss = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        if (miss > dist) continue;
+        const double speed = std::sqrt(dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2]);
+        minima.push_back({{c.first, c.second, c.t0 + s[k], miss, speed}, c.t0, c.t0 + c.span,
+                          s[k] <= END_TOLERANCE, s[k] >= c.span - END_TOLERANCE});
+    }
+
+    // An end minimum is a local one only if the neighbouring arc pair does
+    // not keep closing; two that meet at a boundary are the same point
+    std::sort(minima.begin(), minima.end(), [](const Minimum& x, const Minimum& y) {
+        if (x.conflict.first != y.conflict.first) return x.conflict.first < y.conflict.first;
+        if (x.conflict.second != y.conflict.second) return x.conflict.second < y.conflict.second;
+        return x.t0 < y.t0;
+    });
+    std::vector<unsigned char> keep(minima.size(), 1);
+    for (size_t k = 1; k < minima.size(); k++) {
+        const Minimum& prev = minima[k - 1];
+        const Minimum& cur = minima[k];
+        if (prev.conflict.first != cur.conflict.first ||
+            prev.conflict.second != cur.conflict.second || cur.t0 > prev.t1) {
+            continue;
+        }
+        if (cur.at_start) {
+            keep[k] = 0;
+        } else if (prev.at_end) {
+            keep[k - 1] = 0;
+        }
+    }
+    std::vector<FormationConflict> result;
+    for (size_t k = 0; k < minima.size(); k++) {
+        if (keep[k]) result.push_back(minima[k].conflict);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const FormationConflict& x, const FormationConflict& y) { return x.tca < y.tca; });
+    stats_.conflicts = result.size();
+    return result;
+}
+
+std::vector<FormationConflict> FormationScreener::screen() {
+    stats_ = FormationStats();
+    stats_.plans = trees_.size();
+    for (const auto& tree : trees_) stats_.arcs += tree.arcs.size();
+    const double end = horizon();
+
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < trees_.size(); i++) {
+        for (size_t j = i + 1; j < trees_.size(); j++) descend(i, j, end, candidates);
+    }
+    return refine(candidates);
+}
+
+std::vector<FormationConflict> FormationScreener::screen(size_t i) {
+    if (i >= trees_.size()) throw std::out_of_range("FormationScreener::screen: no plan " +
+                                                    std::to_string(i));
+    stats_ = FormationStats();
+    stats_.plans = trees_.size();
+    for (const auto& tree : trees_) stats_.arcs += tree.arcs.size();
+    const double end = horizon();
+
+    std::vector<Candidate> candidates;
+    for (size_t j = 0; j < trees_.size(); j++) {
+        if (j != i) descend(i, j, end, candidates);
+    }
+    return refine(candidates);
+}
+
+}  // namespace sim
@@ -0,0 +1,145 @@
+/**
+ * Formation Screener — pairwise closest approach of ProximityOps plans
+ *
+ * Screens the planned trajectories of many chasers around one target
+ * against each other, all in the target's RIC frame, and reports every
+ * encounter closer than a threshold.
+ *
+ * Each plan is turned into analytic segments. A leg is the CW transfer
+ * ProximityOps planned: it leaves the previous waypoint at rest with
+ * cw_transfer's first burn, coasts on the CW solution and stops at the
+ * waypoint. Holds are station-kept at the waypoint. The chaser is parked
+ * at its start before start_time and at its last waypoint after the plan
+ * ends. A coast, split into arcs of at most arc_step, is exact per axis:
+ *
+ *   p(t) = c0 + c1 t + a cos(n t) + b sin(n t)
+ *
+ * which bounds each arc in closed form, and the difference of two arcs
+ * has the same form.
+ *
+ *   1. Bounding volumes: per plan, a binary tree over its arcs in time
+ *      order, each node holding its time span and the box of its arcs.
+ *   2. Dual-tree descent per plan pair: node pairs whose time spans
+ *      overlap and whose boxes come within the threshold are split, the
+ *      longer span first, down to arc pairs.
+ *   3. Time filter: the box of the relative arc over the common span
+ *      must reach the threshold sphere.
+ *   4. TCA: the surviving arc pairs are refined together, a fixed number
+ *      of bracketed Newton steps on d/dt |r_rel|^2 = 0 in lockstep.
+ *
+ * Every local minimum of range below the threshold is reported once,
+ * including one on an arc boundary (a burn, or where a coast is split).
+ *
+ * set_plans() builds every tree. replace() rebuilds one, so a replanned
+ * chaser is rescreened against the rest with screen(i). Times are seconds
+ * from the formation epoch; screening covers [0, horizon].
+ */
+
+#ifndef SIM_FORMATION_SCREENER_HPP
+#define SIM_FORMATION_SCREENER_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/proximity_ops.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sim {
+
+/// One chaser's plan, as ProximityOps builds it
+struct FormationPlan {
+    Vec3 start;                       // RIC position before the first leg [m]
+    ProxOpsTrajectory trajectory;     // Legs flown from start
+    double start_time = 0.0;          // First burn, from the formation epoch [s]
+};
+
+struct FormationConfig {
+    double threshold = 100.0;         // Reported miss distance [m]
+    double arc_step = 120.0;          // Longest coast arc per tree leaf [s]
+    double horizon = 0.0;             // Screen until [s]; 0 = the last plan's end
+};
+
+/// One encounter between two plans
+struct FormationConflict {
+    size_t first;                     // Plan indices, first < second
+    size_t second;
+    double tca;                       // Time of closest approach [s]
+    double miss_distance;             // [m]
+    double relative_speed;            // [m/s]
+};
+
+struct FormationStats {
+    size_t plans = 0;
+    size_t arcs = 0;
+    size_t node_pairs = 0;            // Node pairs tested in the descent
+    size_t leaf_pairs = 0;            // Arc pairs the descent reached
+    size_t time_rejects = 0;
+    size_t refined = 0;               // TCA searches run
+    size_t conflicts = 0;
+};
+
+class FormationScreener {
+public:
+    explicit FormationScreener(const FormationConfig& config = FormationConfig());
+
+    /**
+     * Build the arcs and trees of every plan about a target of mean
+     * motion n [rad/s].
+     * @throws std::invalid_argument if a plan's waypoints and transfer
+     *         times differ in number, or n is not positive
+     */
+    void set_plans(const std::vector<FormationPlan>& plans, double n);
+
+    /** Replace plan i and rebuild its tree only */
+    void replace(size_t i, const FormationPlan& plan);
+
+    /** Every pair of plans; conflicts by TCA */
+    std::vector<FormationConflict> screen();
+
+    /** Plan i against every other plan; conflicts by TCA */
+    std::vector<FormationConflict> screen(size_t i);
+
+    /** Modelled RIC state of plan i at time t [s] */
+    RelativeState state(size_t i, double t) const;
+
+    /** End of the screened span [s] */
+    double horizon() const;
+
+    size_t size() const { return trees_.size(); }
+    const FormationStats& stats() const { return stats_; }
+
+private:
+    /// p(t0 + s) = c0 + c1 s + a cos(n s) + b sin(n s), per RIC axis, s in [0, t1 - t0]
+    struct Arc {
+        double t0, t1;
+        double c0[3], c1[3], a[3], b[3];
+    };
+
+    struct Node {
+        double t0, t1;
+        double lo[3], hi[3];
+        int32_t left, right;          // Children, or -1 at a leaf
+        int32_t arc;                  // Leaf arc, or -1
+    };
+
+    struct Tree {
+        std::vector<Arc> arcs;        // In time order; the last one never ends
+        std::vector<Node> nodes;      // nodes[0] is the root
+        double end = 0.0;             // Plan end [s]
+    };
+
+    struct Candidate;                 // Arc pair for the TCA search
+
+    Tree build(const FormationPlan& plan) const;
+    void descend(size_t i, size_t j, double horizon, std::vector<Candidate>& out);
+    std::vector<FormationConflict> refine(std::vector<Candidate>& candidates);
+
+    FormationConfig config_;
+    double n_ = 0.0;
+    std::vector<Tree> trees_;
+    FormationStats stats_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_FORMATION_SCREENER_HPP
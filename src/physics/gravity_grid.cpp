@@ -0,0 +1,169 @@
+/**
+ * Gravity Interpolation Grid Implementation
+ */
+
+#include "physics/gravity_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t MAX_ERROR_SAMPLES = 200000;
+
+// Cubic Lagrange weights over nodes first..first+3 for grid coordinate f
+// in [0, cells]; returns first
+int stencil(double f, int cells, double w[4]) {
+    int first = std::min(std::max(static_cast<int>(f) - 1, 0), cells - 3);
+    double t = f - first;
+    double t1 = t - 1.0, t2 = t - 2.0, t3 = t - 3.0;
+    w[0] = -t1 * t2 * t3 / 6.0;
+    w[1] = t * t2 * t3 / 2.0;
+    w[2] = -t * t1 * t3 / 2.0;
+    w[3] = t * t1 * t2 / 6.0;
+    return first;
+}
+
+} // namespace
+
+GravityGrid::GravityGrid(const GravityGridConfig& config, int na, int nr)
+    : r_min_(config.r_min), r_max_(config.r_max),
+      q_span_(1.0 - config.r_min / config.r_max), na_(na), nr_(nr) {
+    nodes_.resize(6 * static_cast<size_t>(nr_ + 1) * (na_ + 1) * (na_ + 1));
+}
+
+GravityGrid GravityGrid::build(const Field& f, const GravityGridConfig& config) {
+    int na = std::max(3, config.initial_angular);
+    int nr = std::max(3, config.initial_radial);
+    for (;;) {
+        GravityGrid grid(config, na, nr);
+        grid.sample(f);
+        grid.max_error_ = grid.measure_error(f);
+        if (grid.max_error_ <= config.tolerance) return grid;
+
+        int next_na = std::min(na * 2, config.max_angular);
+        int next_nr = std::min(nr * 2, config.max_radial);
+        if (next_na == na && next_nr == nr) return grid;  // At the size limit
+        na = next_na;
+        nr = next_nr;
+    }
+}
+
+Vec3 GravityGrid::node_position(int face, double u, double v, double r) const {
+    Vec3 d;
+    switch (face) {
+        case 0:  d = Vec3( 1.0, u, v); break;
+        case 1:  d = Vec3(-1.0, u, v); break;
+        case 2:  d = Vec3(u,  1.0, v); break;
+        case 3:  d = Vec3(u, -1.0, v); break;
+        case 4:  d = Vec3(u, v,  1.0); break;
+        default: d = Vec3(u, v, -1.0); break;
+    }
+    double s = r / d.norm();
+    return Vec3(d.x * s, d.y * s, d.z * s);
+}
+
+void GravityGrid::sample(const Field& f) {
+    for (int face = 0; face < 6; face++) {
+        for (int k = 0; k <= nr_; k++) {
+            double r = r_min_ / (1.0 - q_span_ * k / nr_);
+            double scale = std::pow(r / r_min_, 4);
+            for (int j = 0; j <= na_; j++) {
+                double v = -1.0 + 2.0 * j / na_;
+                for (int i = 0; i <= na_; i++) {
+                    double u = -1.0 + 2.0 * i / na_;
+                    Vec3 a = f(node_position(face, u, v, r));
+                    nodes_[index(face, k, j, i)] = Node{a.x * scale, a.y * scale, a.z * scale};
+                }
+            }
+        }
+    }
+}
+
+double GravityGrid::measure_error(const Field& f) const {
+    const size_t cells = 6 * static_cast<size_t>(nr_) * na_ * na_;
+    const size_t stride = std::max<size_t>(1, cells / MAX_ERROR_SAMPLES);
+
+    double worst = 0.0;
+    size_t c = 0;
+    for (int face = 0; face < 6; face++) {
+        for (int k = 0; k < nr_; k++) {
+            double r = r_min_ / (1.0 - q_span_ * (k + 0.5) / nr_);
+            for (int j = 0; j < na_; j++) {
+                double v = -1.0 + 2.0 * (j + 0.5) / na_;
+                for (int i = 0; i < na_; i++, c++) {
+                    if (c % stride != 0) continue;
+                    double u = -1.0 + 2.0 * (i + 0.5) / na_;
+                    Vec3 p = node_position(face, u, v, r);
+                    Vec3 exact = f(p);
+                    Vec3 interp;
+                    lookup(p, interp);
+                    double dx = interp.x - exact.x, dy = interp.y - exact.y, dz = interp.z - exact.z;
+                    worst = std::max(worst, std::sqrt(dx * dx + dy * dy + dz * dz));
+                }
+            }
+        }
+    }
+    return worst;
+}
+
+bool GravityGrid::lookup(const Vec3& p, Vec3& accel) const {
+    const double r2 = p.x * p.x + p.y * p.y + p.z * p.z;
+    if (r2 < r_min_ * r_min_ || r2 > r_max_ * r_max_) return false;
+
+    // Face from the dominant axis; (u, v) in [-1, 1]
+    const double ax = std::fabs(p.x), ay = std::fabs(p.y), az = std::fabs(p.z);
+    int face;
+    double u, v;
+    if (ax >= ay && ax >= az) {
+        face = p.x >= 0.0 ? 0 : 1;
+        u = p.y / ax;
+        v = p.z / ax;
+    } else if (ay >= az) {
+        face = p.y >= 0.0 ? 2 : 3;
+        u = p.x / ay;
+        v = p.z / ay;
+    } else {
+        face = p.z >= 0.0 ? 4 : 5;
+        u = p.x / az;
+        v = p.y / az;
+    }
+
+    const double r = std::sqrt(r2);
+    const double q = r_min_ / r;
+    const double s = (1.0 - q) / q_span_ * nr_;
+    const double fu = (u + 1.0) * 0.5 * na_;
+    const double fv = (v + 1.0) * 0.5 * na_;
+
+    // 4-node stencils, shifted inward at the edges
+    double wk[4], wj[4], wi[4];
+    const int k = stencil(s, nr_, wk);
+    const int j = stencil(fv, na_, wj);
+    const int i = stencil(fu, na_, wi);
+
+    const size_t row = na_ + 1;
+    const size_t plane = row * row;
+    const Node* base = &nodes_[index(face, k, j, i)];
+
+    double x = 0.0, y = 0.0, z = 0.0;
+    for (int dk = 0; dk < 4; dk++) {
+        for (int dj = 0; dj < 4; dj++) {
+            const Node* n = base + dk * plane + dj * row;
+            const double w = wk[dk] * wj[dj];
+            for (int di = 0; di < 4; di++) {
+                x += w * wi[di] * n[di].x;
+                y += w * wi[di] * n[di].y;
+                z += w * wi[di] * n[di].z;
+            }
+        }
+    }
+
+    // Undo the (r / r_min)^4 node scaling
+    const double q2 = q * q;
+    const double unscale = q2 * q2;
+    accel = Vec3(x * unscale, y * unscale, z * unscale);
+    return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,90 @@
+/**
+ * Gravity Interpolation Grid
+ *
+ * Tabulates a perturbing acceleration over a spherical shell so repeated
+ * evaluations near the same body (MC batches, trajectory optimization)
+ * cost a table lookup instead of a harmonic series.
+ *
+ * The shell is meshed as a gnomonic cubed sphere: six faces, each an
+ * n x n grid in (u, v) = tangent-plane coordinates, times radial levels
+ * spaced uniformly in 1/r. Node values are scaled by (r / r_min)^4 to
+ * remove the dominant J2 falloff before tricubic (4x4x4 Lagrange)
+ * interpolation. A lookup picks the face from the largest position
+ * component, so it needs one sqrt and no trig.
+ *
+ * build() refines the mesh until the interpolation error measured at
+ * cell centers is below the configured tolerance (or the size limits are
+ * hit; max_error() reports what was achieved). The grid is immutable
+ * once built and is shared read-only across threads.
+ */
+
+#ifndef SIM_GRAVITY_GRID_HPP
+#define SIM_GRAVITY_GRID_HPP
+
+#include "core/state_vector.hpp"
+#include <functional>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Shell extent, resolution limits and target accuracy for a GravityGrid
+ */
+struct GravityGridConfig {
+    double r_min = 6378137.0 + 100000.0;    // Inner radius [m]
+    double r_max = 6378137.0 + 2000000.0;   // Outer radius [m]
+    double tolerance = 1e-7;                // Max interpolation error [m/s^2]
+
+    int initial_angular = 8;                // Cells per face edge to start from (>= 3)
+    int initial_radial = 4;                 // Radial cells to start from (>= 3)
+    int max_angular = 128;                  // 128 x 32 is about 80 MB
+    int max_radial = 32;
+};
+
+class GravityGrid {
+public:
+    /// Acceleration sampled at grid nodes (same frame as lookups)
+    using Field = std::function<Vec3(const Vec3&)>;
+
+    /**
+     * Sample `f` over the configured shell, refining until the measured
+     * error meets config.tolerance or the resolution limits.
+     */
+    static GravityGrid build(const Field& f, const GravityGridConfig& config);
+
+    /**
+     * Interpolated acceleration at `position`.
+     * @return false (and `accel` untouched) outside the shell
+     */
+    bool lookup(const Vec3& position, Vec3& accel) const;
+
+    /** Largest error measured at cell centers during build [m/s^2] */
+    double max_error() const { return max_error_; }
+    int angular_cells() const { return na_; }
+    int radial_cells() const { return nr_; }
+    double r_min() const { return r_min_; }
+    double r_max() const { return r_max_; }
+    size_t memory_bytes() const { return nodes_.size() * sizeof(Node); }
+
+private:
+    struct Node { double x, y, z; };
+
+    double r_min_ = 0.0, r_max_ = 0.0;
+    double q_span_ = 0.0;       // 1 - r_min / r_max
+    int na_ = 0, nr_ = 0;
+    double max_error_ = 0.0;
+    std::vector<Node> nodes_;   // [face][radial][v][u], scaled by (r / r_min)^4
+
+    GravityGrid(const GravityGridConfig& config, int na, int nr);
+    void sample(const Field& f);
+    double measure_error(const Field& f) const;
+
+    size_t index(int face, int k, int j, int i) const {
+        return ((static_cast<size_t>(face) * (nr_ + 1) + k) * (na_ + 1) + j) * (na_ + 1) + i;
+    }
+    Vec3 node_position(int face, double u, double v, double r) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_GRAVITY_GRID_HPP
@@ -235,6 +235,45 @@ inline void gravity_gradient(const Vec3& position, double mu, double G[3][3]) {
     G[2][2] = -mu / r3 * (1.0 - 3.0 * position.z * position.z / r2);
 }
 
+/**
+ * Add the J2 contribution to a gravity gradient matrix
+ *
+ * Jacobian of j2_perturbation() with respect to position. Zero inside the
+ * body, matching j2_perturbation().
+ *
+ * @param position Position relative to body center [m]
+ * @param mu Gravitational parameter [m³/s²]
+ * @param j2 J2 oblateness coefficient
+ * @param radius Body equatorial radius [m]
+ * @param G In/out 3x3 gradient matrix [1/s²]
+ */
+inline void add_j2_gravity_gradient(const Vec3& position, double mu, double j2,
+                                    double radius, double G[3][3]) {
+    double r = position.norm();
+    if (r < radius) return;
+
+    double r2 = r * r;
+    double r7 = r2 * r2 * r2 * r;
+    double r9 = r7 * r2;
+    double z = position.z;
+    double z2 = z * z;
+    double c = 1.5 * j2 * mu * radius * radius;
+    const double p[3] = {position.x, position.y, position.z};
+
+    // a_i = c * p_i * g_i with g = 5z²/r⁷ - k/r⁵ (k = 1 for x, y; 3 for z)
+    double g_xy = 5.0 * z2 / r7 - r2 / r7;
+    double g_z = 5.0 * z2 / r7 - 3.0 * r2 / r7;
+    for (int i = 0; i < 3; i++) {
+        double g = (i < 2) ? g_xy : g_z;
+        double k = (i < 2) ? 5.0 : 15.0;   // -d(k/r⁵)/dr contributes k/r⁷ * p_j
+        for (int j = 0; j < 3; j++) {
+            double dg = (k / r7 - 35.0 * z2 / r9) * p[j];
+            if (j == 2) dg += 10.0 * z / r7;
+            G[i][j] += c * ((i == j ? g : 0.0) + p[i] * dg);
+        }
+    }
+}
+
 /**
  * Compute third-body perturbation
  *
@@ -13,6 +13,8 @@
  */
 
 #include "interplanetary_planner.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/porkchop_engine.hpp"
 #include "vec3_ops.hpp"
 #include <cmath>
 #include <algorithm>
@@ -83,10 +85,10 @@ C3Result InterplanetaryPlanner::compute_transfer(Planet departure, Planet arriva
     }
 
     // Get planet positions and velocities at departure and arrival
-    Vec3 r1 = PlanetaryEphemeris::get_position_hci(departure, launch_jd);
-    Vec3 r2 = PlanetaryEphemeris::get_position_hci(arrival, arrival_jd);
-    Vec3 v_planet_dep = PlanetaryEphemeris::get_velocity_hci(departure, launch_jd);
-    Vec3 v_planet_arr = PlanetaryEphemeris::get_velocity_hci(arrival, arrival_jd);
+    Vec3 r1 = EphemerisCache::planet_hci(departure, launch_jd);
+    Vec3 r2 = EphemerisCache::planet_hci(arrival, arrival_jd);
+    Vec3 v_planet_dep = EphemerisCache::planet_velocity_hci(departure, launch_jd);
+    Vec3 v_planet_arr = EphemerisCache::planet_velocity_hci(arrival, arrival_jd);
 
     // Solve Lambert's problem with solar gravitational parameter
     LambertSolution lambert = ManeuverPlanner::solve_lambert(r1, r2, tof, SUN_MU, true);
@@ -142,47 +144,10 @@ std::vector<PorkchopPoint> InterplanetaryPlanner::generate_porkchop(
     double launch_jd_start, double launch_jd_end, int launch_steps,
     double arrival_jd_start, double arrival_jd_end, int arrival_steps) {
 
-    std::vector<PorkchopPoint> grid;
-    grid.reserve(static_cast<size_t>(launch_steps) * static_cast<size_t>(arrival_steps));
-
-    double launch_step = (launch_steps > 1) ?
-        (launch_jd_end - launch_jd_start) / (launch_steps - 1) : 0.0;
-    double arrival_step = (arrival_steps > 1) ?
-        (arrival_jd_end - arrival_jd_start) / (arrival_steps - 1) : 0.0;
-
-    // Row-major order: arrival row (outer), launch column (inner)
-    for (int j = 0; j < arrival_steps; ++j) {
-        double arr_jd = arrival_jd_start + j * arrival_step;
-
-        for (int i = 0; i < launch_steps; ++i) {
-            double lnch_jd = launch_jd_start + i * launch_step;
-
-            PorkchopPoint pt;
-            pt.launch_jd = lnch_jd;
-            pt.arrival_jd = arr_jd;
-
-            // Skip points where arrival is at or before launch
-            if (arr_jd <= lnch_jd) {
-                pt.c3_departure = 0.0;
-                pt.c3_arrival = 0.0;
-                pt.total_delta_v = 0.0;
-                pt.valid = false;
-                grid.push_back(pt);
-                continue;
-            }
-
-            C3Result transfer = compute_transfer(departure, arrival, lnch_jd, arr_jd);
-
-            pt.c3_departure = transfer.c3_departure;
-            pt.c3_arrival = transfer.c3_arrival;
-            pt.total_delta_v = transfer.total_delta_v;
-            pt.valid = transfer.valid;
-
-            grid.push_back(pt);
-        }
-    }
-
-    return grid;
+    // Ephemeris per distinct date, rows in parallel, warm-started Lambert
+    PorkchopEngine engine(departure, arrival);
+    return engine.generate(launch_jd_start, launch_jd_end, launch_steps,
+                           arrival_jd_start, arrival_jd_end, arrival_steps).points;
 }
 
 // ─────────────────────────────────────────────────────────────
@@ -209,12 +174,12 @@ MissionLeg InterplanetaryPlanner::build_leg(Planet departure, Planet arrival,
     }
 
     // Get departure position and planet velocity
-    Vec3 r1 = PlanetaryEphemeris::get_position_hci(departure, launch_jd);
-    Vec3 v_planet_dep = PlanetaryEphemeris::get_velocity_hci(departure, launch_jd);
-    Vec3 v_planet_arr = PlanetaryEphemeris::get_velocity_hci(arrival, arrival_jd);
+    Vec3 r1 = EphemerisCache::planet_hci(departure, launch_jd);
+    Vec3 v_planet_dep = EphemerisCache::planet_velocity_hci(departure, launch_jd);
+    Vec3 v_planet_arr = EphemerisCache::planet_velocity_hci(arrival, arrival_jd);
 
     // Solve Lambert to get transfer orbit velocities
-    Vec3 r2 = PlanetaryEphemeris::get_position_hci(arrival, arrival_jd);
+    Vec3 r2 = EphemerisCache::planet_hci(arrival, arrival_jd);
     LambertSolution lambert = ManeuverPlanner::solve_lambert(r1, r2, tof, SUN_MU, true);
     if (!lambert.valid) {
         return leg;
@@ -310,9 +275,9 @@ Vec3 InterplanetaryPlanner::compute_departure_asymptote(Planet departure, Planet
     }
 
     // Get departure planet state
-    Vec3 r1 = PlanetaryEphemeris::get_position_hci(departure, launch_jd);
-    Vec3 r2 = PlanetaryEphemeris::get_position_hci(arrival, arrival_jd);
-    Vec3 v_planet_dep = PlanetaryEphemeris::get_velocity_hci(departure, launch_jd);
+    Vec3 r1 = EphemerisCache::planet_hci(departure, launch_jd);
+    Vec3 r2 = EphemerisCache::planet_hci(arrival, arrival_jd);
+    Vec3 v_planet_dep = EphemerisCache::planet_velocity_hci(departure, launch_jd);
 
     // Solve Lambert
     LambertSolution lambert = ManeuverPlanner::solve_lambert(r1, r2, tof, SUN_MU, true);
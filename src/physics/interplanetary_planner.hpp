@@ -14,6 +14,7 @@
 #define SIM_INTERPLANETARY_PLANNER_HPP
 
 #include "core/state_vector.hpp"
+#include "core/trajectory.hpp"
 #include "planetary_ephemeris.hpp"
 #include "maneuver_planner.hpp"
 #include "celestial_body.hpp"
@@ -62,7 +63,7 @@ struct MissionLeg {
     Vec3 v_inf_departure;
     Vec3 v_inf_arrival;
     double delta_v;
-    std::vector<StateVector> trajectory;  // Sampled HCI states along the arc
+    Trajectory trajectory;                // Sampled HCI states along the arc
 };
 
 /**
@@ -101,7 +102,8 @@ public:
      * Sweeps launch and arrival dates in a grid, computing C3 and total
      * delta-V at each point. Results are stored in row-major order
      * (launch date varies fastest). Points where arrival_jd <= launch_jd
-     * are skipped (marked invalid).
+     * are skipped (marked invalid). Runs on a default PorkchopEngine; use
+     * one directly to reuse its threads or refine around the minimum.
      *
      * @param departure        Departure planet
      * @param arrival          Arrival planet
@@ -0,0 +1,60 @@
+/**
+ * Kepler f and g — Two-body state transition on plain doubles
+ *
+ * The kernel behind EnckePropagator::kepler_fg(), written against raw
+ * components so the CUDA batch propagator (kepler_device.cu) runs the
+ * same expressions as the CPU path.
+ */
+
+#ifndef SIM_KEPLER_FG_HPP
+#define SIM_KEPLER_FG_HPP
+
+#include "utils/gpu.hpp"
+#include <cmath>
+
+namespace sim {
+
+/**
+ * Advance (r, v) by dt seconds of two-body motion under mu, in place.
+ * @return false if the orbit is not elliptical (r, v untouched)
+ */
+SIM_HD inline bool kepler_fg_inplace(double r[3], double v[3], double dt, double mu) {
+    const double r0n = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+    const double alpha = 2.0 / r0n - (v[0] * v[0] + v[1] * v[1] + v[2] * v[2]) / mu;   // 1 / a
+    if (alpha <= 0.0) return false;
+    const double a = 1.0 / alpha;
+    const double sqrt_a = sqrt(a);
+    const double n = sqrt(mu * alpha * alpha * alpha);
+    const double sigma0 = (r[0] * v[0] + r[1] * v[1] + r[2] * v[2]) / sqrt(mu);
+    const double k = 1.0 - r0n / a;
+
+    // n dt = dE + sigma0 / sqrt(a) (1 - cos dE) - (1 - r0/a) sin dE
+    const double m = n * dt;
+    double dE = m;
+    for (int i = 0; i < 50; i++) {
+        const double s = sin(dE), c = cos(dE);
+        const double F = dE + sigma0 / sqrt_a * (1.0 - c) - k * s - m;
+        const double dF = 1.0 + sigma0 / sqrt_a * s - k * c;
+        const double step = F / dF;
+        dE -= step;
+        if (fabs(step) < 1e-14 * fmax(1.0, fabs(dE))) break;
+    }
+
+    const double s = sin(dE), c = cos(dE);
+    const double rn = a + (r0n - a) * c + sigma0 * sqrt_a * s;
+    const double f = 1.0 - a / r0n * (1.0 - c);
+    const double g = a * sigma0 / sqrt(mu) * (1.0 - c) + r0n * sqrt(a / mu) * s;
+    const double fdot = -sqrt(mu * a) / (rn * r0n) * s;
+    const double gdot = 1.0 - a / rn * (1.0 - c);
+
+    const double r0[3] = {r[0], r[1], r[2]};
+    for (int j = 0; j < 3; j++) {
+        r[j] = f * r0[j] + g * v[j];
+        v[j] = fdot * r0[j] + gdot * v[j];
+    }
+    return true;
+}
+
+} // namespace sim
+
+#endif // SIM_KEPLER_FG_HPP
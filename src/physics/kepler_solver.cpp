@@ -0,0 +1,142 @@
+#include "physics/kepler_solver.hpp"
+#include "physics/vec3_simd.hpp"
+#include <algorithm>
+
+namespace sim {
+namespace kepler {
+
+namespace {
+
+using simd::DoubleN;
+using simd::MaskN;
+constexpr int LANES = simd::NATIVE_LANES;
+using D = DoubleN<LANES>;
+using Bits = typename simd::Lanes<LANES>::Mask;
+using Raw = typename D::Raw;
+
+/** Round to nearest integer (|x| < 2^51) */
+inline D round_nearest(D x) {
+    const double shift = 6755399441055744.0;   // 1.5 * 2^52
+    return (x + shift) - shift;
+}
+
+/** Cube root of x > 0: exponent-divided starter, two Halley steps (~1e-12) */
+inline D cbrt_positive(D x) {
+    Bits bits = (Bits)x.v;
+    Bits guess = bits / 3 + 0x2A9F7893782DA1CELL;
+    D y((Raw)guess);
+    for (int i = 0; i < 2; i++) {
+        D y3 = y * y * y;
+        y = y * (y3 + 2.0 * x) / (2.0 * y3 + x);
+    }
+    return y;
+}
+
+/**
+ * sin and cos of x with |x| < ~4 (fdlibm kernels after a two-constant
+ * Cody-Waite reduction), and x - sin x, exact in the first octant
+ */
+inline void sincos_small(D x, D& s, D& c, D& x_minus_s) {
+    const D k = round_nearest(x * (2.0 / PI));
+    const D r = (x - k * 1.57079632673412561417e+00) - k * 6.07710050650619224932e-11;
+    const D z = r * r;
+
+    const D ps = -1.66666666666666324348e-01 +
+                 z * (8.33333333332248946124e-03 +
+                 z * (-1.98412698298579493134e-04 +
+                 z * (2.75573137070700676789e-06 +
+                 z * (-2.50507602534068634195e-08 +
+                 z * 1.58969099521155010221e-10))));
+    const D rz = r * z;
+    const D sr = r + rz * ps;
+
+    const D pc = 4.16666666666666019037e-02 +
+                 z * (-1.38888888888741095749e-03 +
+                 z * (2.48015872894767294178e-05 +
+                 z * (-2.75573143513906633035e-07 +
+                 z * (2.08757232129817482790e-09 +
+                 z * -1.13596475577881948265e-11))));
+    const D hz = 0.5 * z;
+    const D w = 1.0 - hz;
+    const D cr = w + (((1.0 - w) - hz) + z * z * pc);
+
+    // Quadrant k mod 4: (s, c) -> (c, -s) -> (-s, -c) -> (-c, s)
+    Bits q = __builtin_convertvector(k.v, Bits) & 3;
+    MaskN<LANES> swap{(q & 1) != 0};
+    MaskN<LANES> neg_s{(q & 2) != 0};
+    MaskN<LANES> neg_c{((q + 1) & 2) != 0};
+    D s0 = simd::select(swap, cr, sr);
+    D c0 = simd::select(swap, sr, cr);
+    s = simd::select(neg_s, -s0, s0);
+    c = simd::select(neg_c, -c0, c0);
+
+    MaskN<LANES> first{q == 0};
+    x_minus_s = simd::select(first, -(rz * ps), x - s);
+}
+
+/** One packet of the scalar eccentric_anomaly() */
+inline D solve(D M, D e, D& sin_E, D& cos_E) {
+    const D k = round_nearest(M * (1.0 / TWO_PI));
+    const D m_signed = M - k * TWO_PI;
+    const MaskN<LANES> negative = m_signed < D(0.0);
+    const D sign = simd::select(negative, D(-1.0), D(1.0));
+    const D m = simd::abs(m_signed);
+    const MaskN<LANES> zero = m == D(0.0);
+
+    const D alpha = (3.0 * PI * PI + 1.6 * PI * (PI - m) / (1.0 + e)) * (1.0 / (PI * PI - 6.0));
+    const D d = 3.0 * (1.0 - e) + alpha * e;
+    const D q = 2.0 * alpha * d * (1.0 - e) - m * m;
+    const D r = 3.0 * alpha * d * (d - 1.0 + e) * m + m * m * m;
+    D w = cbrt_positive(simd::select(zero, D(1.0), simd::abs(r) + simd::sqrt(q * q * q + r * r)));
+    w = w * w;
+    const D E1 = simd::select(zero, D(0.0), (2.0 * r * w / (w * w + w * q + q * q) + m) / d);
+
+    D s, c, x_minus_s;
+    sincos_small(E1, s, c, x_minus_s);
+    const D f0 = (1.0 - e) * E1 + e * x_minus_s - m;
+    const D f1 = 1.0 - e * c;
+    const D f2 = e * s;
+    const D f3 = 1.0 - f1;
+    const D d3 = -f0 / (f1 - 0.5 * f0 * f2 / f1);
+    const D d4 = -f0 / (f1 + 0.5 * d3 * f2 + d3 * d3 * f3 * (1.0 / 6.0));
+    const D d5 = -f0 / (f1 + 0.5 * d4 * f2 + d4 * d4 * f3 * (1.0 / 6.0) -
+                        d4 * d4 * d4 * f2 * (1.0 / 24.0));
+
+    const D dd = d5 * d5;
+    const D sd = d5 * (1.0 - dd * (1.0 / 6.0) * (1.0 - dd * (1.0 / 20.0)));
+    const D cd = 1.0 - dd * 0.5 * (1.0 - dd * (1.0 / 12.0) * (1.0 - dd * (1.0 / 30.0)));
+    sin_E = sign * (s * cd + c * sd);
+    cos_E = c * cd - s * sd;
+    return sign * (E1 + d5) + k * TWO_PI;
+}
+
+template <typename EccAt>
+void solve_all(const double* M, EccAt ecc_at, double* E, size_t n, double* sin_E, double* cos_E) {
+    double e_lanes[LANES];
+    for (size_t i = 0; i < n; i += LANES) {
+        const int count = static_cast<int>(std::min<size_t>(LANES, n - i));
+        for (int j = 0; j < count; j++) e_lanes[j] = ecc_at(i + j);
+        D m = count == LANES ? D::load(M + i) : D::load_partial(M + i, count);
+        D e = D::load_partial(e_lanes, count);
+        D s, c;
+        D x = solve(m, e, s, c);
+        x.store_partial(E + i, count);
+        if (sin_E) s.store_partial(sin_E + i, count);
+        if (cos_E) c.store_partial(cos_E + i, count);
+    }
+}
+
+} // namespace
+
+void eccentric_anomalies(const double* M, const double* e, double* E, size_t n,
+                         double* sin_E, double* cos_E) {
+    solve_all(M, [e](size_t i) { return e[i]; }, E, n, sin_E, cos_E);
+}
+
+void eccentric_anomalies(const double* M, double e, double* E, size_t n,
+                         double* sin_E, double* cos_E) {
+    solve_all(M, [e](size_t) { return e; }, E, n, sin_E, cos_E);
+}
+
+} // namespace kepler
+} // namespace sim
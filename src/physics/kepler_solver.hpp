@@ -0,0 +1,192 @@
+/**
+ * Kepler Solver — one solver for Kepler's equation, scalar and batch
+ *
+ * Elliptic (0 <= e < 1), E - e sin E = M: Markley's cubic starter
+ * (Celest. Mech. 63, 1995) followed by one fifth-order correction. With
+ * M reduced to [-pi, pi] the result is within ~1e-15 rad of the root for
+ * every e < 1 and M, with no iteration: one sin/cos pair, one cube root
+ * and one square root. The residual E - e sin E - M is evaluated as
+ * (1 - e) E + e (E - sin E), with E - sin E from its series for small E,
+ * so e near 1 at small M does not lose the root to cancellation.
+ *
+ * Hyperbolic (e > 1), e sinh H - H = M: the smaller of two upper bounds on
+ * the root (the root of the cubic truncation, and asinh((M + that) / e))
+ * starts Halley's method, which then descends monotonically; three
+ * corrections at most reach ~1e-15 relative over 1 < e < 1e4.
+ *
+ * Parabolic (e = 1): Barker's equation D + D^3 / 3 = M, closed form.
+ *
+ * Every function keeps the revolution of M: eccentric_anomaly(M + 2 pi k)
+ * = eccentric_anomaly(M) + 2 pi k. The scalar functions are SIM_HD so
+ * device kernels can share them. eccentric_anomalies() is the batch entry
+ * point: the same method on simd::DoubleN packets with a polynomial
+ * sin/cos, optionally returning sin E and cos E for the caller.
+ */
+
+#ifndef SIM_KEPLER_SOLVER_HPP
+#define SIM_KEPLER_SOLVER_HPP
+
+#include "utils/gpu.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace sim {
+namespace kepler {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double TWO_PI = 2.0 * PI;
+
+/** x - sin x without cancellation for small x */
+SIM_HD inline double x_minus_sin(double x, double sin_x) {
+    if (fabs(x) > 0.5) return x - sin_x;
+    const double x2 = x * x;
+    double term = x * x2 / 6.0, sum = term;
+    for (int k = 2; k < 12; k++) {
+        term *= -x2 / ((2.0 * k) * (2.0 * k + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+/** sinh x - x without cancellation for small x */
+SIM_HD inline double sinh_minus_x(double x) {
+    if (fabs(x) > 0.5) return sinh(x) - x;
+    const double x2 = x * x;
+    double term = x * x2 / 6.0, sum = term;
+    for (int k = 2; k < 12; k++) {
+        term *= x2 / ((2.0 * k) * (2.0 * k + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Eccentric anomaly E with E - e sin E = M (0 <= e < 1), and its sine
+ * and cosine (from the starter rotated by the correction, not recomputed)
+ */
+SIM_HD inline double eccentric_anomaly(double M, double e, double& sin_E, double& cos_E) {
+    const double k = nearbyint(M / TWO_PI);
+    const double m_signed = M - k * TWO_PI;
+    const double sign = m_signed < 0.0 ? -1.0 : 1.0;
+    const double m = fabs(m_signed);
+    if (m == 0.0) {
+        sin_E = 0.0;
+        cos_E = 1.0;
+        return k * TWO_PI;
+    }
+
+    // Markley's starter on [0, pi]
+    const double alpha = (3.0 * PI * PI + 1.6 * PI * (PI - m) / (1.0 + e)) / (PI * PI - 6.0);
+    const double d = 3.0 * (1.0 - e) + alpha * e;
+    const double q = 2.0 * alpha * d * (1.0 - e) - m * m;
+    const double r = 3.0 * alpha * d * (d - 1.0 + e) * m + m * m * m;
+    double w = cbrt(fabs(r) + sqrt(q * q * q + r * r));
+    w *= w;
+    const double E1 = (2.0 * r * w / (w * w + w * q + q * q) + m) / d;
+
+    // Fifth-order correction
+    const double s = sin(E1), c = cos(E1);
+    const double f0 = (1.0 - e) * E1 + e * x_minus_sin(E1, s) - m;
+    const double f1 = 1.0 - e * c;
+    const double f2 = e * s;
+    const double f3 = 1.0 - f1;
+    const double d3 = -f0 / (f1 - 0.5 * f0 * f2 / f1);
+    const double d4 = -f0 / (f1 + 0.5 * d3 * f2 + d3 * d3 * f3 / 6.0);
+    const double d5 = -f0 / (f1 + 0.5 * d4 * f2 + d4 * d4 * f3 / 6.0 - d4 * d4 * d4 * f2 / 24.0);
+
+    // sin/cos(E1 + d5), d5 small
+    const double d2 = d5 * d5;
+    const double sd = d5 * (1.0 - d2 / 6.0 * (1.0 - d2 / 20.0));
+    const double cd = 1.0 - d2 / 2.0 * (1.0 - d2 / 12.0 * (1.0 - d2 / 30.0));
+    sin_E = sign * (s * cd + c * sd);
+    cos_E = c * cd - s * sd;
+    return sign * (E1 + d5) + k * TWO_PI;
+}
+
+SIM_HD inline double eccentric_anomaly(double M, double e) {
+    double s, c;
+    return eccentric_anomaly(M, e, s, c);
+}
+
+/**
+ * Newton refinement of E - e sin E = M from a close guess (a warm start
+ * from a previous epoch), until the residual is within tolerance
+ */
+SIM_HD inline double refine_eccentric_anomaly(double M, double e, double E, double& sin_E,
+                                              double& cos_E, double tolerance = 1e-12,
+                                              int max_iterations = 16) {
+    for (int i = 0; i < max_iterations; i++) {
+        sin_E = sin(E);
+        cos_E = cos(E);
+        const double f = E - e * sin_E - M;
+        if (fabs(f) <= tolerance) return E;
+        E -= f / (1.0 - e * cos_E);
+    }
+    sin_E = sin(E);
+    cos_E = cos(E);
+    return E;
+}
+
+/** Hyperbolic anomaly H with e sinh H - H = M (e > 1) */
+SIM_HD inline double hyperbolic_anomaly(double M, double e) {
+    const double sign = M < 0.0 ? -1.0 : 1.0;
+    const double m = fabs(M);
+    if (m == 0.0) return 0.0;
+
+    // Upper bounds: root of (e - 1) H + e H^3 / 6 = m, then asinh((m + H) / e)
+    const double p = 6.0 * (e - 1.0) / e;
+    const double q = 3.0 * m / e;
+    const double disc = sqrt(q * q + p * p * p / 27.0);
+    double H = cbrt(q + disc) + cbrt(q - disc);
+    H = fmin(H, asinh((m + H) / e));
+
+    // Halley, monotone from above
+    for (int i = 0; i < 8; i++) {
+        const double f = (e - 1.0) * H + e * sinh_minus_x(H) - m;
+        const double f1 = e * cosh(H) - 1.0;
+        const double f2 = e * sinh(H);
+        const double dH = -f / (f1 - 0.5 * f * f2 / f1);
+        H += dH;
+        if (fabs(dH) <= 1e-9 * fmax(1.0, H)) break;
+    }
+    return sign * H;
+}
+
+/** D = tan(nu / 2) with D + D^3 / 3 = M (parabolic) */
+SIM_HD inline double parabolic_anomaly(double M) {
+    const double w = cbrt(1.5 * M + sqrt(1.0 + 2.25 * M * M));
+    return w - 1.0 / w;
+}
+
+/** True anomaly from the eccentric anomaly (elliptic) */
+SIM_HD inline double true_from_eccentric(double E, double e) {
+    return 2.0 * atan2(sqrt(1.0 + e) * sin(E / 2.0), sqrt(1.0 - e) * cos(E / 2.0));
+}
+
+/**
+ * True anomaly for mean anomaly M: elliptic, parabolic (M as in Barker's
+ * equation) or hyperbolic by e
+ */
+SIM_HD inline double true_anomaly(double M, double e) {
+    if (e < 1.0) return true_from_eccentric(eccentric_anomaly(M, e), e);
+    if (e == 1.0) return 2.0 * atan(parabolic_anomaly(M));
+    const double H = hyperbolic_anomaly(M, e);
+    return 2.0 * atan(sqrt((e + 1.0) / (e - 1.0)) * tanh(H / 2.0));
+}
+
+/**
+ * Batch elliptic solve: E[i] for (M[i], e[i]), i < n, with sin E and
+ * cos E into sin_E / cos_E when those are non-null. Agrees with the
+ * scalar eccentric_anomaly() to ~1e-15 rad.
+ */
+void eccentric_anomalies(const double* M, const double* e, double* E, size_t n,
+                         double* sin_E = nullptr, double* cos_E = nullptr);
+
+/** Batch elliptic solve with one eccentricity for every element */
+void eccentric_anomalies(const double* M, double e, double* E, size_t n,
+                         double* sin_E = nullptr, double* cos_E = nullptr);
+
+} // namespace kepler
+} // namespace sim
+
+#endif // SIM_KEPLER_SOLVER_HPP
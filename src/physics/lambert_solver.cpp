@@ -0,0 +1,315 @@
+/**
+ * Lambert Solver Implementation
+ *
+ * Notation follows Izzo (2015): lambda is the geometry parameter
+ * (|lambda| = sqrt(1 - c / s), negative past 180 deg of transfer angle),
+ * T = sqrt(2 mu / s^3) tof the non-dimensional time, and x the iteration
+ * variable (x < 1 elliptic, x = 1 parabolic, x > 1 hyperbolic).
+ */
+
+#include "physics/lambert_solver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t BLOCK = 64;
+constexpr double PI = 3.14159265358979323846;
+constexpr double SINGLE_REV_TOL = 1e-5;   // Householder step; cubic convergence
+constexpr double MULTI_REV_TOL = 1e-8;
+
+double hypergeometric_f(double z, double tol) {
+    double sj = 1.0, cj = 1.0, err = 1.0;
+    for (int j = 0; err > tol && j < 1000; j++) {
+        double cj1 = cj * (3.0 + j) * (1.0 + j) / (2.5 + j) * z / (j + 1);
+        sj += cj1;
+        err = std::fabs(cj1);
+        cj = cj1;
+    }
+    return sj;
+}
+
+/// Non-dimensional time of flight at x (Lagrange's expression)
+double x2tof_lagrange(double x, int n, double lambda) {
+    double a = 1.0 / (1.0 - x * x);
+    if (a > 0.0) {
+        double alfa = 2.0 * std::acos(x);
+        double beta = 2.0 * std::asin(std::sqrt(lambda * lambda / a));
+        if (lambda < 0.0) beta = -beta;
+        return a * std::sqrt(a) * ((alfa - std::sin(alfa)) - (beta - std::sin(beta)) +
+                                   2.0 * PI * n) / 2.0;
+    }
+    double alfa = 2.0 * std::acosh(x);
+    double beta = 2.0 * std::asinh(std::sqrt(-lambda * lambda / a));
+    if (lambda < 0.0) beta = -beta;
+    return -a * std::sqrt(-a) * ((beta - std::sinh(beta)) - (alfa - std::sinh(alfa))) / 2.0;
+}
+
+/// Non-dimensional time of flight at x: Battin near x = 1, Lagrange
+/// close to it, Lancaster elsewhere
+double x2tof(double x, int n, double lambda) {
+    const double dist = std::fabs(x - 1.0);
+    if (dist < 0.2 && dist > 0.01) return x2tof_lagrange(x, n, lambda);
+
+    double k = lambda * lambda;
+    double e = x * x - 1.0;
+    double rho = std::fabs(e);
+    double z = std::sqrt(1.0 + k * e);
+    if (dist < 0.01) {
+        double eta = z - lambda * x;
+        double s1 = 0.5 * (1.0 - lambda - x * eta);
+        double q = 4.0 / 3.0 * hypergeometric_f(s1, 1e-11);
+        return (eta * eta * eta * q + 4.0 * lambda * eta) / 2.0 + n * PI / std::pow(rho, 1.5);
+    }
+    double y = std::sqrt(rho);
+    double g = x * z - lambda * e;
+    double d = (e < 0.0) ? n * PI + std::acos(g) : std::log(y * (z - lambda * x) + g);
+    return (x - lambda * z - d / y) / e;
+}
+
+/// First three derivatives of T(x)
+void dtdx(double x, double t, double lambda, double& dt, double& ddt, double& dddt) {
+    double l2 = lambda * lambda;
+    double l3 = l2 * lambda;
+    double umx2 = 1.0 - x * x;
+    double y = std::sqrt(1.0 - l2 * umx2);
+    double y2 = y * y;
+    double y3 = y2 * y;
+    dt = (3.0 * t * x - 2.0 + 2.0 * l3 * x / y) / umx2;
+    ddt = (3.0 * t + 5.0 * x * dt + 2.0 * (1.0 - l2) * l3 / y3) / umx2;
+    dddt = (7.0 * x * ddt + 8.0 * dt - 6.0 * (1.0 - l2) * l2 * l3 * x / y3 / y2) / umx2;
+}
+
+/// Third-order Householder iterations on T(x) = t; returns the count
+int householder(double t, double& x, int n, double lambda, double eps, int max_iter) {
+    int it = 0;
+    double err = 1.0;
+    while (err > eps && it < max_iter) {
+        double tof = x2tof(x, n, lambda);
+        double dt, ddt, dddt;
+        dtdx(x, tof, lambda, dt, ddt, dddt);
+        double delta = tof - t;
+        double dt2 = dt * dt;
+        double x_new = x - delta * (dt2 - delta * ddt / 2.0) /
+                       (dt * (dt2 - delta * ddt) + dddt * delta * delta / 6.0);
+        err = std::fabs(x - x_new);
+        x = x_new;
+        it++;
+    }
+    return it;
+}
+
+/// Most revolutions feasible at non-dimensional time t (Halley search
+/// for the minimum time of the highest candidate branch)
+int max_revs(double t, double lambda) {
+    int n_max = static_cast<int>(t / PI);
+    if (n_max <= 0) return 0;
+    double t00 = std::acos(lambda) + lambda * std::sqrt(1.0 - lambda * lambda);
+    if (t >= t00 + n_max * PI) return n_max;
+
+    double x_old = 0.0, t_min = t00 + n_max * PI;
+    for (int it = 0; it < 13; it++) {
+        double dt, ddt, dddt;
+        dtdx(x_old, t_min, lambda, dt, ddt, dddt);
+        double x_new = (dt != 0.0) ? x_old - dt * ddt / (ddt * ddt - dt * dddt / 2.0) : x_old;
+        bool done = std::fabs(x_old - x_new) < 1e-13;
+        x_old = x_new;
+        t_min = x2tof(x_old, n_max, lambda);
+        if (done) break;
+    }
+    return t_min > t ? n_max - 1 : n_max;
+}
+
+/// Izzo's initial guess for branch (n, right)
+double initial_guess(double t, double lambda, int n, bool right) {
+    if (n == 0) {
+        double l2 = lambda * lambda;
+        double l3 = lambda * l2;
+        double t00 = std::acos(lambda) + lambda * std::sqrt(1.0 - l2);
+        double t1 = 2.0 / 3.0 * (1.0 - l3);
+        if (t >= t00) return -(t - t00) / (t - t00 + 4.0);
+        if (t <= t1) return t1 * (t1 - t) / (2.0 / 5.0 * (1.0 - l2 * l3) * t) + 1.0;
+        return std::pow(t / t00, 0.69314718055994529 / std::log(t1 / t00)) - 1.0;
+    }
+    double tmp = right ? std::pow(8.0 * t / (n * PI), 2.0 / 3.0)
+                       : std::pow((n * PI + PI) / (8.0 * t), 2.0 / 3.0);
+    return (tmp - 1.0) / (tmp + 1.0);
+}
+
+/**
+ * Solve n <= BLOCK problems from SoA inputs. x is in/out.
+ */
+void solve_block(size_t n, const LambertOptions& opt,
+                 const double* r1x, const double* r1y, const double* r1z,
+                 const double* r2x, const double* r2y, const double* r2z,
+                 const double* tof, double* x,
+                 double* v1x, double* v1y, double* v1z,
+                 double* v2x, double* v2y, double* v2z,
+                 int* iterations, unsigned char* valid) {
+    double lam[BLOCK], tn[BLOCK], gam[BLOCK], rho[BLOCK], sig[BLOCK];
+    double inv_r1[BLOCK], inv_r2[BLOCK], ok[BLOCK];
+    double i1x[BLOCK], i1y[BLOCK], i1z[BLOCK], i2x[BLOCK], i2y[BLOCK], i2z[BLOCK];
+    double t1x[BLOCK], t1y[BLOCK], t1z[BLOCK], t2x[BLOCK], t2y[BLOCK], t2z[BLOCK];
+
+    const double mu = opt.mu;
+    const double dir = opt.prograde ? 1.0 : -1.0;
+
+    // Geometry: lambda, T and the radial / transverse unit vectors
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        double R1 = std::sqrt(r1x[k] * r1x[k] + r1y[k] * r1y[k] + r1z[k] * r1z[k]);
+        double R2 = std::sqrt(r2x[k] * r2x[k] + r2y[k] * r2y[k] + r2z[k] * r2z[k]);
+        double dx = r2x[k] - r1x[k], dy = r2y[k] - r1y[k], dz = r2z[k] - r1z[k];
+        double c = std::sqrt(dx * dx + dy * dy + dz * dz);
+        double s = 0.5 * (c + R1 + R2);
+
+        double a1 = 1.0 / std::max(R1, 1e-300), a2 = 1.0 / std::max(R2, 1e-300);
+        double ux = r1x[k] * a1, uy = r1y[k] * a1, uz = r1z[k] * a1;
+        double wx = r2x[k] * a2, wy = r2y[k] * a2, wz = r2z[k] * a2;
+
+        // Unit normal; sin(theta) = |ir1 x ir2|
+        double hx = uy * wz - uz * wy, hy = uz * wx - ux * wz, hz = ux * wy - uy * wx;
+        double hn = std::sqrt(hx * hx + hy * hy + hz * hz);
+        ok[k] = (hn > 1e-12 && tof[k] > 0.0 && R1 > 0.0 && R2 > 0.0) ? 1.0 : 0.0;
+        double ih = 1.0 / std::max(hn, 1e-300);
+        hx *= ih; hy *= ih; hz *= ih;
+
+        // Past 180 deg (or retrograde) lambda and the transverse axes flip
+        double sgn = (hz < 0.0 ? -1.0 : 1.0) * dir;
+        lam[k] = sgn * std::sqrt(std::max(0.0, 1.0 - c / s));
+        t1x[k] = sgn * (hy * uz - hz * uy);
+        t1y[k] = sgn * (hz * ux - hx * uz);
+        t1z[k] = sgn * (hx * uy - hy * ux);
+        t2x[k] = sgn * (hy * wz - hz * wy);
+        t2y[k] = sgn * (hz * wx - hx * wz);
+        t2z[k] = sgn * (hx * wy - hy * wx);
+        i1x[k] = ux; i1y[k] = uy; i1z[k] = uz;
+        i2x[k] = wx; i2y[k] = wy; i2z[k] = wz;
+
+        tn[k] = std::sqrt(2.0 * mu / (s * s * s)) * tof[k];
+        gam[k] = std::sqrt(mu * s / 2.0);
+        rho[k] = (R1 - R2) / std::max(c, 1e-300);
+        sig[k] = std::sqrt(std::max(0.0, 1.0 - rho[k] * rho[k]));
+        inv_r1[k] = a1;
+        inv_r2[k] = a2;
+    }
+
+    // Householder iterations, one lane at a time
+    const int revs = std::max(0, opt.revolutions);
+    const bool right = opt.branch == LambertBranch::RIGHT;
+    const double eps = revs == 0 ? SINGLE_REV_TOL : MULTI_REV_TOL;
+    for (size_t k = 0; k < n; k++) {
+        iterations[k] = 0;
+        if (ok[k] == 0.0 || (revs > 0 && max_revs(tn[k], lam[k]) < revs)) {
+            x[k] = std::numeric_limits<double>::quiet_NaN();
+            continue;
+        }
+        double xk = x[k];
+        bool warm = std::isfinite(xk) && xk > -1.0 && (revs == 0 || xk < 1.0);
+        if (!warm) xk = initial_guess(tn[k], lam[k], revs, right);
+        iterations[k] = householder(tn[k], xk, revs, lam[k], eps, opt.max_iterations);
+        x[k] = xk;
+    }
+
+    // Velocities from x
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        double l = lam[k];
+        double l2 = l * l;
+        double xk = x[k];
+        double y = std::sqrt(1.0 - l2 + l2 * xk * xk);
+        double vr1 = gam[k] * ((l * y - xk) - rho[k] * (l * y + xk)) * inv_r1[k];
+        double vr2 = -gam[k] * ((l * y - xk) + rho[k] * (l * y + xk)) * inv_r2[k];
+        double vt = gam[k] * sig[k] * (y + l * xk);
+        double vt1 = vt * inv_r1[k], vt2 = vt * inv_r2[k];
+        v1x[k] = vr1 * i1x[k] + vt1 * t1x[k];
+        v1y[k] = vr1 * i1y[k] + vt1 * t1y[k];
+        v1z[k] = vr1 * i1z[k] + vt1 * t1z[k];
+        v2x[k] = vr2 * i2x[k] + vt2 * t2x[k];
+        v2y[k] = vr2 * i2y[k] + vt2 * t2y[k];
+        v2z[k] = vr2 * i2z[k] + vt2 * t2z[k];
+    }
+
+    for (size_t k = 0; k < n; k++) {
+        valid[k] = std::isfinite(v1x[k] + v1y[k] + v1z[k] + v2x[k] + v2y[k] + v2z[k]) ? 1 : 0;
+    }
+}
+
+} // namespace
+
+// ============================================================
+// LambertBatch
+// ============================================================
+
+void LambertBatch::resize(size_t n) {
+    for (auto* v : {&r1x, &r1y, &r1z, &r2x, &r2y, &r2z, &tof,
+                    &v1x, &v1y, &v1z, &v2x, &v2y, &v2z}) {
+        v->resize(n, 0.0);
+    }
+    x.resize(n, std::numeric_limits<double>::quiet_NaN());
+    iterations.resize(n, 0);
+    valid.resize(n, 0);
+}
+
+void LambertBatch::set(size_t i, const Vec3& r1, const Vec3& r2, double time_of_flight) {
+    r1x[i] = r1.x; r1y[i] = r1.y; r1z[i] = r1.z;
+    r2x[i] = r2.x; r2y[i] = r2.y; r2z[i] = r2.z;
+    tof[i] = time_of_flight;
+}
+
+// ============================================================
+// LambertSolver
+// ============================================================
+
+LambertSolution LambertSolver::solve(const Vec3& r1, const Vec3& r2, double tof,
+                                     const LambertOptions& options, double* x_warm) {
+    double x = x_warm ? *x_warm : std::numeric_limits<double>::quiet_NaN();
+    double v1[3], v2[3];
+    int iterations;
+    unsigned char ok;
+    solve_block(1, options, &r1.x, &r1.y, &r1.z, &r2.x, &r2.y, &r2.z, &tof, &x,
+                &v1[0], &v1[1], &v1[2], &v2[0], &v2[1], &v2[2], &iterations, &ok);
+
+    LambertSolution result;
+    result.valid = ok != 0;
+    result.v1 = result.valid ? Vec3(v1[0], v1[1], v1[2]) : Vec3::Zero();
+    result.v2 = result.valid ? Vec3(v2[0], v2[1], v2[2]) : Vec3::Zero();
+    result.delta_v1 = 0.0;
+    result.delta_v2 = 0.0;
+    result.total_delta_v = 0.0;
+    result.tof = tof;
+    if (x_warm && result.valid) *x_warm = x;
+    return result;
+}
+
+void LambertSolver::solve(LambertBatch& batch, const LambertOptions& options) {
+    const size_t n = batch.size();
+    for (size_t b = 0; b < n; b += BLOCK) {
+        const size_t m = std::min(BLOCK, n - b);
+        solve_block(m, options,
+                    &batch.r1x[b], &batch.r1y[b], &batch.r1z[b],
+                    &batch.r2x[b], &batch.r2y[b], &batch.r2z[b],
+                    &batch.tof[b], &batch.x[b],
+                    &batch.v1x[b], &batch.v1y[b], &batch.v1z[b],
+                    &batch.v2x[b], &batch.v2y[b], &batch.v2z[b],
+                    &batch.iterations[b], &batch.valid[b]);
+    }
+}
+
+int LambertSolver::max_revolutions(const Vec3& r1, const Vec3& r2, double tof,
+                                   double mu, bool prograde) {
+    double R1 = r1.norm(), R2 = r2.norm();
+    double c = Vec3(r2.x - r1.x, r2.y - r1.y, r2.z - r1.z).norm();
+    double s = 0.5 * (c + R1 + R2);
+    if (tof <= 0.0 || R1 <= 0.0 || R2 <= 0.0) return 0;
+
+    double hz = r1.x * r2.y - r1.y * r2.x;
+    double sgn = (hz < 0.0 ? -1.0 : 1.0) * (prograde ? 1.0 : -1.0);
+    double lambda = sgn * std::sqrt(std::max(0.0, 1.0 - c / s));
+    return max_revs(std::sqrt(2.0 * mu / (s * s * s)) * tof, lambda);
+}
+
+}  // namespace sim
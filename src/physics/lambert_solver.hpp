@@ -0,0 +1,96 @@
+/**
+ * Lambert Solver (Izzo 2015)
+ *
+ * Boundary-value solver for two-body transfers: given r1, r2 and a time of
+ * flight, find the terminal velocities. Follows D. Izzo, "Revisiting
+ * Lambert's problem" (CMDA 121, 2015): the problem is reduced to the
+ * geometry parameter lambda and a non-dimensional time T, and T(x) is
+ * inverted by third-order Householder iterations from Izzo's initial
+ * guesses (two or three iterations to machine precision on the single
+ * revolution branch). T(x) switches between Battin's series near x = 1,
+ * Lagrange's expression, and Lancaster's form elsewhere.
+ *
+ * Multi-revolution transfers (N complete turns) have a left and a right
+ * solution when T exceeds the branch minimum T_min(N); below it the
+ * problem is infeasible and the result is invalid.
+ *
+ * The batch API takes structure-of-arrays inputs and works through them
+ * in blocks: the geometry setup and the velocity reconstruction are
+ * branch-free lane loops the compiler vectorizes; the Householder
+ * iteration itself runs per lane. x is in/out, so a sweep can warm-start
+ * each problem from a neighbor's solution.
+ */
+
+#ifndef SIM_LAMBERT_SOLVER_HPP
+#define SIM_LAMBERT_SOLVER_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/maneuver_planner.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace sim {
+
+enum class LambertBranch {
+    LEFT,    // Multi-rev solution with the smaller x (longer semi-major axis)
+    RIGHT
+};
+
+struct LambertOptions {
+    double mu = OrbitalMechanics::MU_EARTH;
+    bool prograde = true;          // Transfer angular momentum along +z
+    int revolutions = 0;           // Complete revolutions N
+    LambertBranch branch = LambertBranch::LEFT;   // Used when revolutions > 0
+    int max_iterations = 15;
+};
+
+/**
+ * Lambert problems in structure-of-arrays form. Inputs r1, r2 [m] and
+ * tof [s]; x is the warm start on input (NaN = Izzo's initial guess) and
+ * the converged value on output.
+ */
+struct LambertBatch {
+    std::vector<double> r1x, r1y, r1z;
+    std::vector<double> r2x, r2y, r2z;
+    std::vector<double> tof;
+    std::vector<double> x;
+
+    std::vector<double> v1x, v1y, v1z;     // Departure velocity [m/s]
+    std::vector<double> v2x, v2y, v2z;     // Arrival velocity [m/s]
+    std::vector<int> iterations;
+    std::vector<unsigned char> valid;
+
+    /** Resize every array; new x entries are NaN (no warm start) */
+    void resize(size_t n);
+    size_t size() const { return tof.size(); }
+
+    void set(size_t i, const Vec3& r1, const Vec3& r2, double time_of_flight);
+    Vec3 v1(size_t i) const { return Vec3(v1x[i], v1y[i], v1z[i]); }
+    Vec3 v2(size_t i) const { return Vec3(v2x[i], v2y[i], v2z[i]); }
+};
+
+class LambertSolver {
+public:
+    /**
+     * Solve one problem.
+     * @param x_warm If non-null: warm start (ignored when not finite) on
+     *               input, converged x on output
+     */
+    static LambertSolution solve(const Vec3& r1, const Vec3& r2, double tof,
+                                 const LambertOptions& options = LambertOptions(),
+                                 double* x_warm = nullptr);
+
+    /** Solve every problem in the batch with the same options */
+    static void solve(LambertBatch& batch, const LambertOptions& options = LambertOptions());
+
+    /**
+     * Most complete revolutions a transfer between r1 and r2 can make in
+     * tof (0 if only the direct transfer exists).
+     */
+    static int max_revolutions(const Vec3& r1, const Vec3& r2, double tof,
+                               double mu, bool prograde = true);
+};
+
+}  // namespace sim
+
+#endif  // SIM_LAMBERT_SOLVER_HPP
@@ -0,0 +1,71 @@
+/**
+ * Precomputed Launch Vehicle Performance Tables
+ */
+
+#include "launch_performance.hpp"
+#include "launch_trajectory_solver.hpp"
+#include <cmath>
+
+namespace sim {
+
+static constexpr double ISP_TRANSITION_TOP = 40000.0;  // SolverRocketStage::effective_isp [m]
+
+/// Nodes f(k * step), k = 0..n, as (value, slope to the next node)
+template <typename F>
+static std::vector<LaunchPerformance::Cell> tabulate(int n, double step, F f) {
+    std::vector<LaunchPerformance::Cell> t(n + 1);
+    for (int k = 0; k <= n; k++) t[k].value = f(k * step);
+    for (int k = 0; k < n; k++) t[k].slope = t[k + 1].value - t[k].value;
+    t[n].slope = 0.0;
+    return t;
+}
+
+std::shared_ptr<const LaunchPerformance> LaunchPerformance::build(
+    const SolverVehicleConfig& vehicle, double altitude_step, double mach_step) {
+
+    std::shared_ptr<LaunchPerformance> table(new LaunchPerformance());
+
+    // Altitude grid: a whole number of cells up to the top of the Isp transition
+    int n_alt = static_cast<int>(std::ceil(ISP_TRANSITION_TOP / std::max(altitude_step, 1.0)));
+    double h_step = ISP_TRANSITION_TOP / n_alt;
+    table->inv_altitude_step_ = 1.0 / h_step;
+    table->altitude_top_ = ISP_TRANSITION_TOP;
+
+    for (const auto& s : vehicle.stages) {
+        Stage stage;
+        stage.thrust = s.thrust;
+        stage.burn_150km = s.burn_duration(150000.0);
+        stage.isp = tabulate(n_alt, h_step, [&](double h) { return s.effective_isp(h); });
+        stage.mdot = tabulate(n_alt, h_step, [&](double h) { return s.mass_flow_rate(h); });
+        table->stages_.push_back(std::move(stage));
+        table->total_burn_ += s.burn_duration(80000.0);
+    }
+    if (!vehicle.stages.empty()) {
+        table->stage1_burn_ = vehicle.stages[0].burn_duration(30000.0);
+    }
+
+    // Drag: piecewise linear through the (Mach, Cd) breakpoints, resampled
+    const auto& curve = vehicle.drag_curve;
+    if (curve.size() < 2) {
+        double cd = curve.empty() ? vehicle.drag_coefficient : curve[0].second;
+        table->drag_.push_back({cd, 0.0});
+        return table;
+    }
+
+    double mach_top = curve.back().first;
+    int n_mach = std::max(1, static_cast<int>(std::ceil(mach_top / std::max(mach_step, 1e-3))));
+    double m_step = mach_top / n_mach;
+    table->inv_mach_step_ = 1.0 / m_step;
+    table->mach_top_ = mach_top;
+    table->drag_ = tabulate(n_mach, m_step, [&](double mach) {
+        if (mach <= curve.front().first) return curve.front().second;
+        size_t i = 1;
+        while (i < curve.size() - 1 && curve[i].first < mach) i++;
+        double m0 = curve[i - 1].first, m1 = curve[i].first;
+        double f = (m1 > m0) ? (mach - m0) / (m1 - m0) : 1.0;
+        return curve[i - 1].second + f * (curve[i].second - curve[i - 1].second);
+    });
+    return table;
+}
+
+} // namespace sim
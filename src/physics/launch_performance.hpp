@@ -0,0 +1,134 @@
+/**
+ * Precomputed Launch Vehicle Performance Tables
+ *
+ * Per-stage thrust, Isp and mass flow against altitude, and drag
+ * coefficient against Mach, tabulated once per SolverVehicleConfig so the
+ * trajectory solver's derivative evaluations (four per RK4 step, plus the
+ * variational partials) are a clamp, a truncation and a fused
+ * multiply-add instead of Isp interpolation and a division each.
+ *
+ * Altitude tables run from sea level to the top of the Isp transition
+ * (40 km, where SolverRocketStage::effective_isp reaches vacuum) with
+ * linear interpolation; above it the vacuum values are the last node.
+ * Isp is linear there, so its table is exact; mass flow T / (Isp g0)
+ * deviates by about 1e-7 relative on the default 100 m grid. Each cell
+ * stores value and slope, so the solver's partials use the table's own
+ * derivative and the variational Jacobian stays the exact tangent.
+ *
+ * Thrust is the stage's vacuum reference at every altitude (the solver's
+ * model has no back-pressure loss); it is tabulated alongside for
+ * completeness. With no drag curve, Cd is drag_coefficient exactly.
+ *
+ * A table is immutable once built and is shared (shared_ptr<const>) by
+ * every solver instance of the same vehicle, including the parallel
+ * starts of solve_multi_start and the cells of solve_window.
+ */
+
+#ifndef LAUNCH_PERFORMANCE_HPP
+#define LAUNCH_PERFORMANCE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+struct SolverVehicleConfig;
+
+class LaunchPerformance {
+public:
+    /// Value and slope (per unit of the table axis) of one cell
+    struct Cell {
+        double value;
+        double slope;
+    };
+
+    /**
+     * @param altitude_step Altitude grid spacing [m]
+     * @param mach_step Mach grid spacing of the drag table
+     */
+    static std::shared_ptr<const LaunchPerformance> build(const SolverVehicleConfig& vehicle,
+                                                          double altitude_step = 100.0,
+                                                          double mach_step = 0.05);
+
+    size_t stage_count() const { return stages_.size(); }
+
+    /// [N]
+    double thrust(int stage) const { return stages_[stage].thrust; }
+
+    /// [s]
+    double isp(int stage, double altitude) const {
+        return interpolate(stages_[stage].isp, altitude * inv_altitude_step_);
+    }
+
+    /// [kg/s]
+    double mass_flow(int stage, double altitude) const {
+        return interpolate(stages_[stage].mdot, altitude * inv_altitude_step_);
+    }
+
+    /// d(mass flow)/d(altitude) [kg/s/m]; zero outside the Isp transition
+    double mass_flow_slope(int stage, double altitude) const {
+        if (altitude <= 0.0 || altitude >= altitude_top_) return 0.0;
+        const auto& t = stages_[stage].mdot;
+        return t[cell_index(t, altitude * inv_altitude_step_)].slope * inv_altitude_step_;
+    }
+
+    /// Steering segment timing: stage 1 burn at 30 km, upper stages at 150 km [s]
+    double stage1_burn() const { return stage1_burn_; }
+    double upper_stage_burn(int stage) const { return stages_[stage].burn_150km; }
+
+    /// Sum of the stage burn durations at 80 km: the nominal powered flight time [s]
+    double total_burn() const { return total_burn_; }
+
+    /// Whether Cd varies with Mach (drag_curve was given)
+    bool has_drag_curve() const { return drag_.size() > 1; }
+
+    /// Drag coefficient at Mach number
+    double drag_coefficient(double mach) const {
+        return interpolate(drag_, mach * inv_mach_step_);
+    }
+
+    /// dCd/dMach
+    double drag_coefficient_slope(double mach) const {
+        if (!has_drag_curve() || mach <= 0.0 || mach >= mach_top_) return 0.0;
+        return drag_[cell_index(drag_, mach * inv_mach_step_)].slope * inv_mach_step_;
+    }
+
+private:
+    struct Stage {
+        double thrust;
+        double burn_150km;
+        std::vector<Cell> isp;    // Node k at altitude k * step; top node has zero slope
+        std::vector<Cell> mdot;
+    };
+
+    std::vector<Stage> stages_;
+    std::vector<Cell> drag_;
+    double inv_altitude_step_ = 0.0;
+    double altitude_top_ = 0.0;
+    double inv_mach_step_ = 0.0;
+    double mach_top_ = 0.0;
+    double stage1_burn_ = 0.0;
+    double total_burn_ = 0.0;
+
+    LaunchPerformance() = default;
+
+    /// Node at or below grid coordinate x, clamped to the table
+    static size_t cell_index(const std::vector<Cell>& t, double x) {
+        double hi = static_cast<double>(t.size() - 1);
+        return static_cast<size_t>(std::min(std::max(x, 0.0), hi));
+    }
+
+    /// Clamped linear interpolation at grid coordinate x
+    static double interpolate(const std::vector<Cell>& t, double x) {
+        double hi = static_cast<double>(t.size() - 1);
+        x = std::min(std::max(x, 0.0), hi);
+        size_t i = static_cast<size_t>(x);
+        return t[i].value + (x - static_cast<double>(i)) * t[i].slope;
+    }
+};
+
+} // namespace sim
+
+#endif // LAUNCH_PERFORMANCE_HPP
@@ -0,0 +1,177 @@
+/**
+ * Launch Profile Sweep Engine Implementation
+ */
+
+#include "physics/launch_sweep_engine.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace sim {
+
+LaunchSweepEngine::LaunchSweepEngine(const LaunchSite& site,
+                                     std::vector<LaunchSweepAxis> axes,
+                                     Builder builder,
+                                     const LaunchSweepConfig& config)
+    : site_(site), axes_(std::move(axes)), builder_(std::move(builder)), config_(config) {
+    for (auto& axis : axes_) axis.points = std::max(1, axis.points);
+    config_.refine_levels = std::max(0, config_.refine_levels);
+    config_.batch_size = std::max<std::size_t>(1, config_.batch_size);
+    config_.solver.num_threads = 1;
+    config_.solver.verbose = false;
+}
+
+std::vector<double> LaunchSweepEngine::params_at(const Lattice& q) const {
+    std::vector<double> params(axes_.size());
+    for (size_t a = 0; a < axes_.size(); a++) {
+        const auto& axis = axes_[a];
+        long span = static_cast<long>(axis.points - 1) * fine_scale();
+        params[a] = span > 0 ?
+            axis.min + (axis.max - axis.min) * static_cast<double>(q[a]) / span : axis.min;
+    }
+    return params;
+}
+
+double LaunchSweepEngine::default_score(const LaunchSweepPoint& point) const {
+    double min_perigee = OrbitalMechanics::R_EARTH + config_.min_perigee_altitude;
+    if (point.outcome != LaunchScreen::REACHED_END || point.perigee_radius < min_perigee) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return point.elements.eccentricity;
+}
+
+LaunchSweepPoint LaunchSweepEngine::evaluate(const Lattice& q, int level) const {
+    LaunchSweepPoint point;
+    point.params = params_at(q);
+    point.level = level;
+    point.perigee_radius = 0.0;
+    point.apogee_radius = 0.0;
+
+    LaunchSweepCandidate candidate = builder_(point.params);
+    LaunchTrajectorySolver solver(candidate.vehicle, site_, config_.epoch_jd, config_.solver);
+    point.outcome = solver.propagate_screened(
+        candidate.controls, OrbitalMechanics::R_EARTH + config_.min_perigee_altitude,
+        point.final_state);
+
+    if (point.outcome == LaunchScreen::REACHED_END) {
+        StateVector sv;
+        sv.position = point.final_state.position;
+        sv.velocity = point.final_state.velocity;
+        point.elements = OrbitalMechanics::state_to_elements(sv);
+        double a = point.elements.semi_major_axis;
+        double e = point.elements.eccentricity;
+        if (a > 0.0 && e < 1.0) {
+            point.perigee_radius = a * (1.0 - e);
+            point.apogee_radius = a * (1.0 + e);
+        }
+    }
+
+    point.score = config_.score ? config_.score(point) : default_score(point);
+    return point;
+}
+
+void LaunchSweepEngine::rank(const LaunchSweepPoint& point, const Lattice& q) {
+    if (!std::isfinite(point.score) || config_.refine_count <= 0) return;
+    auto worse = [](const Ranked& a, const Ranked& b) { return a.score < b.score; };
+    if ((int)best_.size() < config_.refine_count) {
+        best_.push_back(Ranked{point.score, q});
+        std::push_heap(best_.begin(), best_.end(), worse);
+    } else if (point.score < best_.front().score) {
+        std::pop_heap(best_.begin(), best_.end(), worse);
+        best_.back() = Ranked{point.score, q};
+        std::push_heap(best_.begin(), best_.end(), worse);
+    }
+}
+
+std::size_t LaunchSweepEngine::run(const Sink& sink) {
+    stats_ = LaunchSweepStats();
+    best_.clear();
+
+    const size_t n_axes = axes_.size();
+    const long scale = fine_scale();
+    const double min_perigee = OrbitalMechanics::R_EARTH + config_.min_perigee_altitude;
+
+    ThreadPool pool(config_.num_threads);
+    std::vector<Lattice> pending;
+    std::vector<LaunchSweepPoint> results;
+    int level = 0;
+
+    auto flush = [&]() {
+        if (pending.empty()) return;
+        results.assign(pending.size(), LaunchSweepPoint());
+        pool.parallel_for(pending.size(), [&](size_t i) {
+            results[i] = evaluate(pending[i], level);
+        });
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& point = results[i];
+            stats_.evaluated++;
+            if (point.outcome == LaunchScreen::IMPACT) stats_.impacts++;
+            if (point.outcome == LaunchScreen::INSUFFICIENT_ENERGY) stats_.energy_aborts++;
+            if (point.perigee_radius >= min_perigee) stats_.orbits++;
+            rank(point, pending[i]);
+            if (sink) sink(point);
+        }
+        pending.clear();
+    };
+    auto submit = [&](Lattice q) {
+        pending.push_back(std::move(q));
+        if (pending.size() >= config_.batch_size) flush();
+    };
+
+    // Base grid, row-major (last axis fastest)
+    size_t total = 1;
+    for (const auto& axis : axes_) total *= static_cast<size_t>(axis.points);
+    for (size_t flat = 0; flat < total; flat++) {
+        Lattice q(n_axes);
+        size_t rem = flat;
+        for (size_t a = n_axes; a-- > 0;) {
+            size_t n = static_cast<size_t>(axes_[a].points);
+            q[a] = static_cast<long>(rem % n) * scale;
+            rem /= n;
+        }
+        submit(std::move(q));
+    }
+    flush();
+
+    // Refinement: neighbors of the best points at half the previous spacing
+    std::vector<size_t> swept;
+    for (size_t a = 0; a < n_axes; a++) {
+        if (axes_[a].points > 1) swept.push_back(a);
+    }
+    size_t n_offsets = 1;
+    for (size_t k = 0; k < swept.size(); k++) n_offsets *= 3;
+
+    std::set<Lattice> visited;
+    for (level = 1; level <= config_.refine_levels; level++) {
+        const long step = scale >> level;
+        std::vector<Ranked> parents = best_;
+        std::sort(parents.begin(), parents.end(), [](const Ranked& a, const Ranked& b) {
+            return a.score < b.score || (a.score == b.score && a.q < b.q);
+        });
+
+        for (const auto& parent : parents) {
+            for (size_t code = 0; code < n_offsets; code++) {
+                Lattice child = parent.q;
+                bool moved = false, inside = true;
+                size_t c = code;
+                for (size_t a : swept) {
+                    long offset = static_cast<long>(c % 3) - 1;
+                    c /= 3;
+                    child[a] += offset * step;
+                    moved = moved || offset != 0;
+                    long limit = static_cast<long>(axes_[a].points - 1) * scale;
+                    inside = inside && child[a] >= 0 && child[a] <= limit;
+                }
+                if (!moved || !inside) continue;
+                if (visited.insert(child).second) submit(std::move(child));
+            }
+        }
+        flush();
+    }
+
+    return stats_.evaluated;
+}
+
+}  // namespace sim
@@ -0,0 +1,131 @@
+/**
+ * Launch Profile Sweep Engine
+ *
+ * Grid search over launch parameters (vehicle sizing, steering profile)
+ * without a solver: each point is propagated open-loop and classified by
+ * the orbit it reaches.
+ *
+ * Points are evaluated in parallel batches. A propagation stops as soon
+ * as the candidate impacts or can no longer reach the minimum perigee
+ * (LaunchTrajectorySolver::propagate_screened), so hopeless profiles are
+ * cheap. Results are streamed to a sink in a deterministic order; the
+ * engine itself only keeps the few best points it will refine.
+ *
+ * Refinement: after the base grid, each pass takes the refine_count best
+ * points found so far and evaluates their neighbors at half the previous
+ * spacing (3^d - 1 per point over the d swept axes).
+ */
+
+#ifndef SIM_LAUNCH_SWEEP_ENGINE_HPP
+#define SIM_LAUNCH_SWEEP_ENGINE_HPP
+
+#include "physics/launch_trajectory_solver.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/**
+ * One swept parameter: `points` values evenly spaced over [min, max]
+ * (points = 1 holds it at min)
+ */
+struct LaunchSweepAxis {
+    std::string name;
+    double min;
+    double max;
+    int points;
+};
+
+/** Vehicle and open-loop controls for one parameter tuple */
+struct LaunchSweepCandidate {
+    SolverVehicleConfig vehicle;
+    LaunchControls controls;
+};
+
+/**
+ * Evaluated sweep point
+ */
+struct LaunchSweepPoint {
+    std::vector<double> params;     // One value per axis
+    int level;                      // 0 = base grid, k = k-th refinement pass
+    LaunchScreen outcome;
+    LaunchState final_state;
+    OrbitalElements elements;       // Valid when outcome == REACHED_END
+    double perigee_radius;          // [m] (0 unless REACHED_END and bound)
+    double apogee_radius;           // [m]
+    double score;                   // Lower is better; infinity = not a candidate
+};
+
+struct LaunchSweepConfig {
+    double min_perigee_altitude = 150000.0;  // Orbit threshold above the equatorial radius [m]
+    double epoch_jd = 2460335.0;
+    int refine_levels = 0;                   // Refinement passes after the base grid
+    int refine_count = 8;                    // Best points refined per pass
+    std::size_t batch_size = 256;            // Points evaluated per parallel batch
+    int num_threads = 0;                     // 0 = hardware concurrency
+    LaunchSolverConfig solver;               // Integration step sizes
+
+    /// Score for refinement ranking; default is the eccentricity of orbits
+    /// whose perigee clears min_perigee_altitude (infinity otherwise)
+    std::function<double(const LaunchSweepPoint&)> score;
+};
+
+/**
+ * Running totals over a sweep
+ */
+struct LaunchSweepStats {
+    std::size_t evaluated = 0;
+    std::size_t impacts = 0;
+    std::size_t energy_aborts = 0;
+    std::size_t orbits = 0;          // Bound, perigee above the threshold
+};
+
+class LaunchSweepEngine {
+public:
+    /// Maps a parameter tuple (one value per axis) to a candidate.
+    /// Called concurrently; must not modify shared state.
+    using Builder = std::function<LaunchSweepCandidate(const std::vector<double>& params)>;
+
+    /// Receives every evaluated point, on the calling thread, in order
+    using Sink = std::function<void(const LaunchSweepPoint&)>;
+
+    LaunchSweepEngine(const LaunchSite& site,
+                      std::vector<LaunchSweepAxis> axes,
+                      Builder builder,
+                      const LaunchSweepConfig& config = LaunchSweepConfig());
+
+    /**
+     * Evaluate the base grid, then the refinement passes.
+     * @return Number of points evaluated
+     */
+    std::size_t run(const Sink& sink);
+
+    const LaunchSweepStats& stats() const { return stats_; }
+
+private:
+    using Lattice = std::vector<long>;   // Point on the finest refinement lattice
+
+    struct Ranked {
+        double score;
+        Lattice q;
+    };
+
+    LaunchSite site_;
+    std::vector<LaunchSweepAxis> axes_;
+    Builder builder_;
+    LaunchSweepConfig config_;
+    LaunchSweepStats stats_;
+    std::vector<Ranked> best_;           // Max-heap on score, refine_count entries
+
+    long fine_scale() const { return 1L << config_.refine_levels; }
+    std::vector<double> params_at(const Lattice& q) const;
+    LaunchSweepPoint evaluate(const Lattice& q, int level) const;
+    double default_score(const LaunchSweepPoint& point) const;
+    void rank(const LaunchSweepPoint& point, const Lattice& q);
+};
+
+}  // namespace sim
+
+#endif  // SIM_LAUNCH_SWEEP_ENGINE_HPP
@@ -1,20 +1,23 @@
 /**
  * Nonlinear Launch-to-Intercept/Rendezvous Trajectory Solver
  *
- * Implementation of Newton-Raphson differential correction with numerical
- * Jacobian for launch trajectory optimization.
+ * Implementation of Newton-Raphson differential correction with finite
+ * difference or variational Jacobians for launch trajectory optimization.
  */
 
 #include "launch_trajectory_solver.hpp"
 #include "physics/gravity_utils.hpp"
 #include "physics/atmosphere_model.hpp"
+#include "physics/atmosphere_table.hpp"
 #include "physics/maneuver_planner.hpp"
 #include "coordinate/frame_transformer.hpp"
 #include "coordinate/time_utils.hpp"
+#include "utils/thread_pool.hpp"
 #include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <random>
 
 namespace sim {
 
@@ -169,6 +172,8 @@ int TerminalTarget::num_constraints() const {
 
 LaunchSolverConfig::LaunchSolverConfig()
     : max_iterations(30)
+    , jacobian(LaunchJacobian::VARIATIONAL)
+    , linear_solver(linalg::LeastSquares::NORMAL)
     , fd_step_size(5e-4)
     , convergence_tol(100.0)
     , use_line_search(true)
@@ -176,6 +181,7 @@ LaunchSolverConfig::LaunchSolverConfig()
     , line_search_max(8)
     , atmo_step_size(0.5)
     , vacuum_step_size(5.0)
+    , num_threads(0)
     , verbose(false)
 {
     // Default: free all controls except epoch_offset
@@ -201,9 +207,14 @@ LaunchTrajectorySolver::LaunchTrajectorySolver(
     const SolverVehicleConfig& vehicle,
     const LaunchSite& site,
     double epoch_jd,
-    const LaunchSolverConfig& config)
+    const LaunchSolverConfig& config,
+    std::shared_ptr<const LaunchPerformance> performance)
     : vehicle_(vehicle), site_(site), epoch_jd_(epoch_jd), config_(config)
+    , performance_(performance ? std::move(performance) : LaunchPerformance::build(vehicle))
 {
+    if (config_.jacobian == LaunchJacobian::FINITE_DIFFERENCE && config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
 }
 
 // ============================================================
@@ -224,6 +235,12 @@ Vec3 LaunchTrajectorySolver::earth_relative_velocity(
     return v_rel;
 }
 
+double LaunchTrajectorySolver::speed_of_sound(double altitude) const {
+    double a;
+    AtmosphereTable::earth().speed_of_sound(&altitude, &a, 1);
+    return a;
+}
+
 std::vector<double> LaunchTrajectorySolver::pack_free_controls(
     const LaunchControls& controls) const {
     double all[LaunchControls::N_CONTROLS];
@@ -257,11 +274,16 @@ void LaunchTrajectorySolver::unpack_free_controls(
 void LaunchTrajectorySolver::evaluate_steering(
     const LaunchState& state,
     const LaunchControls& controls,
-    double& pitch, double& yaw) const {
+    double& pitch, double& yaw,
+    double* dpitch, double* dyaw) const {
 
     double alt = state.altitude;
     double t = state.time;
 
+    if (dpitch) {
+        for (int i = 0; i < NC; i++) dpitch[i] = dyaw[i] = 0.0;
+    }
+
     // Vertical ascent phase
     if (alt < GRAVITY_TURN_START_ALT) {
         pitch = 0.0;
@@ -270,7 +292,7 @@ void LaunchTrajectorySolver::evaluate_steering(
     }
 
     // Estimate stage burn durations for segment timing
-    double t_s1_burn = vehicle_.stages[0].burn_duration(30000.0);
+    double t_s1_burn = performance_->stage1_burn();
     double t_turn_start = 10.0; // approximate time to reach 1km
 
     if (state.stage_index == 0 && state.engines_on) {
@@ -281,36 +303,52 @@ void LaunchTrajectorySolver::evaluate_steering(
         pitch = controls.pitch_s1[0] + controls.pitch_s1[1] * tau
                 + controls.pitch_s1[2] * tau * tau;
         yaw = controls.yaw_s1[0] + controls.yaw_s1[1] * tau;
+        if (dpitch) {
+            dpitch[1] = 1.0; dpitch[2] = tau; dpitch[3] = tau * tau;
+            dyaw[7] = 1.0; dyaw[8] = tau;
+        }
     }
     else if (state.stage_index >= 1 && state.engines_on) {
         // Stage 2+: normalize time within this stage's burn
         double t_s2_start = t_s1_burn;
-        double t_s2_burn = vehicle_.stages[std::min(state.stage_index,
-                           (int)vehicle_.stages.size() - 1)].burn_duration(150000.0);
+        double t_s2_burn = performance_->upper_stage_burn(std::min(state.stage_index,
+                           (int)vehicle_.stages.size() - 1));
         double tau = (t - t_s2_start) / t_s2_burn;
         if (tau < 0.0) tau = 0.0;
         if (tau > 1.0) tau = 1.0;
         pitch = controls.pitch_s2[0] + controls.pitch_s2[1] * tau
                 + controls.pitch_s2[2] * tau * tau;
         yaw = controls.yaw_s2[0] + controls.yaw_s2[1] * tau;
+        if (dpitch) {
+            dpitch[4] = 1.0; dpitch[5] = tau; dpitch[6] = tau * tau;
+            dyaw[9] = 1.0; dyaw[10] = tau;
+        }
     }
     else {
         // Coast: no thrust, but return last angles
         pitch = controls.pitch_s2[0] + controls.pitch_s2[1] + controls.pitch_s2[2];
         yaw = 0.0;
+        if (dpitch) dpitch[4] = dpitch[5] = dpitch[6] = 1.0;
     }
 
     // Clamp pitch to [0, pi/2]
+    bool clamped = pitch < 0.0 || pitch > PI / 2.0;
     if (pitch < 0.0) pitch = 0.0;
     if (pitch > PI / 2.0) pitch = PI / 2.0;
+    if (clamped && dpitch) {
+        for (int i = 0; i < NC; i++) dpitch[i] = 0.0;
+    }
 }
 
 Vec3 LaunchTrajectorySolver::compute_thrust_direction(
     const LaunchState& state,
-    const LaunchControls& controls) const {
+    const LaunchControls& controls,
+    ThrustPartials* partials) const {
 
     double pitch, yaw;
-    evaluate_steering(state, controls, pitch, yaw);
+    double dpitch[NC], dyaw[NC];
+    evaluate_steering(state, controls, pitch, yaw,
+                      partials ? dpitch : nullptr, partials ? dyaw : nullptr);
 
     Vec3 pos = state.position;
     Vec3 vel = state.velocity;
@@ -326,6 +364,11 @@ Vec3 LaunchTrajectorySolver::compute_thrust_direction(
     Vec3 d_hat, c_hat;
     double v_mag = vel.norm();
 
+    // Frame quantities kept for the partials
+    bool velocity_frame = false;
+    double vh_mag = 0.0, e_mag = 1.0;
+    Vec3 east, north;
+
     if (v_mag > 500.0 && state.altitude > GRAVITY_TURN_START_ALT) {
         // Use velocity-based frame once velocity is established
         // Horizontal component of velocity
@@ -334,11 +377,12 @@ Vec3 LaunchTrajectorySolver::compute_thrust_direction(
         v_horiz.x = vel.x - v_radial * r_hat.x;
         v_horiz.y = vel.y - v_radial * r_hat.y;
         v_horiz.z = vel.z - v_radial * r_hat.z;
-        double vh_mag = v_horiz.norm();
+        vh_mag = v_horiz.norm();
         if (vh_mag > 1.0) {
             d_hat.x = v_horiz.x / vh_mag;
             d_hat.y = v_horiz.y / vh_mag;
             d_hat.z = v_horiz.z / vh_mag;
+            velocity_frame = true;
         } else {
             // Fallback to azimuth-based
             goto azimuth_frame;
@@ -350,15 +394,13 @@ Vec3 LaunchTrajectorySolver::compute_thrust_direction(
         double e_x = -pos.y;
         double e_y =  pos.x;
         double e_z = 0.0;
-        double e_mag = std::sqrt(e_x * e_x + e_y * e_y);
+        e_mag = std::sqrt(e_x * e_x + e_y * e_y);
         if (e_mag < 1.0) { e_x = 0.0; e_y = 1.0; e_mag = 1.0; }
-        Vec3 east;
         east.x = e_x / e_mag;
         east.y = e_y / e_mag;
         east.z = e_z / e_mag;
 
         // North = r_hat x east
-        Vec3 north;
         north.x = r_hat.y * east.z - r_hat.z * east.y;
         north.y = r_hat.z * east.x - r_hat.x * east.z;
         north.z = r_hat.x * east.y - r_hat.y * east.x;
@@ -394,6 +436,86 @@ Vec3 LaunchTrajectorySolver::compute_thrust_direction(
         t_dir.z /= t_mag;
     }
 
+    if (partials) {
+        // r_hat, d_hat, c_hat are orthonormal, so t_dir is already unit and
+        // each partial is the derivative of the unnormalized combination.
+        const double rh[3] = {r_hat.x, r_hat.y, r_hat.z};
+        const double dh[3] = {d_hat.x, d_hat.y, d_hat.z};
+        const double ch[3] = {c_hat.x, c_hat.y, c_hat.z};
+        const double vv[3] = {vel.x, vel.y, vel.z};
+        const double eh[3] = {east.x, east.y, east.z};
+        const double nh[3] = {north.x, north.y, north.z};
+        auto cross = [](const double a[3], const double b[3], double out[3]) {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        };
+        // d(u / |u|) = (du - u_hat (u_hat . du)) / |u|
+        auto unit_derivative = [](const double u_hat[3], const double du[3], double norm,
+                                  double out[3]) {
+            double p = u_hat[0] * du[0] + u_hat[1] * du[1] + u_hat[2] * du[2];
+            for (int i = 0; i < 3; i++) out[i] = (du[i] - u_hat[i] * p) / norm;
+        };
+        double sin_az = std::sin(controls.launch_azimuth);
+        double cos_az = std::cos(controls.launch_azimuth);
+
+        // Directional derivative along each state axis
+        for (int k = 0; k < 6; k++) {
+            double dr[3] = {0.0, 0.0, 0.0}, dv[3] = {0.0, 0.0, 0.0};
+            if (k < 3) dr[k] = 1.0; else dv[k - 3] = 1.0;
+
+            double drh[3];
+            unit_derivative(rh, dr, r_mag, drh);
+
+            double ddh[3];
+            if (velocity_frame) {
+                double v_radial = vv[0] * rh[0] + vv[1] * rh[1] + vv[2] * rh[2];
+                double dv_radial = dv[0] * rh[0] + dv[1] * rh[1] + dv[2] * rh[2] +
+                                   vv[0] * drh[0] + vv[1] * drh[1] + vv[2] * drh[2];
+                double du[3];
+                for (int i = 0; i < 3; i++) du[i] = dv[i] - dv_radial * rh[i] - v_radial * drh[i];
+                unit_derivative(dh, du, vh_mag, ddh);
+            } else {
+                double deh[3] = {0.0, 0.0, 0.0};
+                if (e_mag > 1.0) {
+                    const double de_raw[3] = {-dr[1], dr[0], 0.0};
+                    unit_derivative(eh, de_raw, e_mag, deh);
+                }
+                double dn1[3], dn2[3];
+                cross(drh, eh, dn1);
+                cross(rh, deh, dn2);
+                for (int i = 0; i < 3; i++) ddh[i] = sin_az * deh[i] + cos_az * (dn1[i] + dn2[i]);
+            }
+
+            double dc1[3], dc2[3];
+            cross(drh, dh, dc1);
+            cross(rh, ddh, dc2);
+            for (int i = 0; i < 3; i++) {
+                partials->d_state[i][k] = cp * drh[i] +
+                    sp * (cy * ddh[i] + sy * (dc1[i] + dc2[i]));
+            }
+        }
+
+        // Steering angles, and azimuth through the launch frame
+        double t_pitch[3], t_yaw[3], t_az[3] = {0.0, 0.0, 0.0};
+        for (int i = 0; i < 3; i++) {
+            t_pitch[i] = -sp * rh[i] + cp * (cy * dh[i] + sy * ch[i]);
+            t_yaw[i] = sp * (-sy * dh[i] + cy * ch[i]);
+        }
+        if (!velocity_frame) {
+            double dd_az[3], dc_az[3];
+            for (int i = 0; i < 3; i++) dd_az[i] = cos_az * eh[i] - sin_az * nh[i];
+            cross(rh, dd_az, dc_az);
+            for (int i = 0; i < 3; i++) t_az[i] = sp * (cy * dd_az[i] + sy * dc_az[i]);
+        }
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < NC; j++) {
+                partials->d_controls[i][j] = t_pitch[i] * dpitch[j] + t_yaw[i] * dyaw[j];
+            }
+            partials->d_controls[i][0] += t_az[i];
+        }
+    }
+
     return t_dir;
 }
 
@@ -419,14 +541,10 @@ LaunchTrajectorySolver::compute_derivatives(
     // 2. Thrust
     Vec3 a_thrust = {0.0, 0.0, 0.0};
     if (state.engines_on && state.stage_index < (int)vehicle_.stages.size()) {
-        const auto& stage = vehicle_.stages[state.stage_index];
-        double alt = state.altitude;
-        if (alt < 0.0) alt = 0.0;
-        double isp = stage.effective_isp(alt);
-        double mdot = stage.thrust / (isp * G0);
+        double mdot = performance_->mass_flow(state.stage_index, state.altitude);
 
         Vec3 t_dir = compute_thrust_direction(state, controls);
-        double a_mag = stage.thrust / mass;
+        double a_mag = performance_->thrust(state.stage_index) / mass;
 
         a_thrust.x = a_mag * t_dir.x;
         a_thrust.y = a_mag * t_dir.y;
@@ -440,12 +558,14 @@ LaunchTrajectorySolver::compute_derivatives(
     double alt = state.altitude;
     if (alt >= 0.0 && alt < 200000.0) {
         Vec3 v_rel = earth_relative_velocity(pos, vel);
-        double rho = AtmosphereModel::get_density_extended(alt);
+        double rho = AtmosphereTable::earth().density(alt);
         if (rho > 1e-15) {
             double v_rel_mag = v_rel.norm();
             if (v_rel_mag > 1.0) {
+                double mach = performance_->has_drag_curve() ?
+                    v_rel_mag / speed_of_sound(alt) : 0.0;
                 double drag_factor = 0.5 * rho * v_rel_mag *
-                    vehicle_.drag_coefficient * vehicle_.reference_area / mass;
+                    performance_->drag_coefficient(mach) * vehicle_.reference_area / mass;
                 a_drag.x = -drag_factor * v_rel.x;
                 a_drag.y = -drag_factor * v_rel.y;
                 a_drag.z = -drag_factor * v_rel.z;
@@ -568,20 +688,189 @@ LaunchState LaunchTrajectorySolver::rk4_step(
     // Compute dynamic pressure
     Vec3 v_rel = earth_relative_velocity(result.position, result.velocity);
     double rho = (result.altitude >= 0.0 && result.altitude < 200000.0) ?
-        AtmosphereModel::get_density_extended(result.altitude) : 0.0;
+        AtmosphereTable::earth().density(result.altitude) : 0.0;
     result.dynamic_pressure = 0.5 * rho * (v_rel.x * v_rel.x +
         v_rel.y * v_rel.y + v_rel.z * v_rel.z);
 
     return result;
 }
 
+// ============================================================
+// Variational Equations
+// ============================================================
+
+LaunchTrajectorySolver::LaunchDerivatives
+LaunchTrajectorySolver::derivative_partials(
+    const LaunchState& state,
+    const LaunchControls& controls,
+    double A[NX][NX], double B[NX][NC]) const {
+
+    LaunchDerivatives d = compute_derivatives(state, controls);
+
+    for (int i = 0; i < NX; i++) {
+        for (int j = 0; j < NX; j++) A[i][j] = 0.0;
+        for (int j = 0; j < NC; j++) B[i][j] = 0.0;
+    }
+
+    // dr/dt = v
+    for (int i = 0; i < 3; i++) A[i][3 + i] = 1.0;
+
+    Vec3 pos = state.position;
+    double mass = state.mass;
+    double r_mag = pos.norm();
+    const double r_hat[3] = {pos.x / r_mag, pos.y / r_mag, pos.z / r_mag};
+
+    // 1. Gravity (two-body + J2)
+    const auto& earth = gravity::BodyConstants::EARTH;
+    double G[3][3];
+    gravity::gravity_gradient(pos, earth.mu, G);
+    gravity::add_j2_gravity_gradient(pos, earth.mu, earth.j2, earth.radius, G);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) A[3 + i][j] += G[i][j];
+    }
+
+    // 2. Thrust: a = T/m * dir(r, v, controls), mdot = T / (Isp(alt) g0)
+    if (state.engines_on && state.stage_index < (int)vehicle_.stages.size()) {
+        double a_mag = performance_->thrust(state.stage_index) / mass;
+
+        ThrustPartials tp;
+        Vec3 t_dir = compute_thrust_direction(state, controls, &tp);
+        const double dir[3] = {t_dir.x, t_dir.y, t_dir.z};
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 6; j++) A[3 + i][j] += a_mag * tp.d_state[i][j];
+            for (int j = 0; j < NC; j++) B[3 + i][j] += a_mag * tp.d_controls[i][j];
+            A[3 + i][6] -= a_mag * dir[i] / mass;
+        }
+
+        // Mass flow varies with altitude below 40 km (table slope)
+        double dmr_dalt = -performance_->mass_flow_slope(state.stage_index, state.altitude);
+        if (dmr_dalt != 0.0) {
+            for (int j = 0; j < 3; j++) A[6][j] += dmr_dalt * r_hat[j];
+        }
+    }
+
+    // 3. Atmospheric drag: a = -k rho(alt) |w| w / m, w = v - omega x r
+    double alt = state.altitude;
+    if (alt >= 0.0 && alt < 200000.0) {
+        Vec3 v_rel = earth_relative_velocity(pos, state.velocity);
+        const auto& atmosphere = AtmosphereTable::earth();
+        double rho = atmosphere.density(alt);
+        double w_mag = v_rel.norm();
+        if (rho > 1e-15 && w_mag > 1.0) {
+            const double w[3] = {v_rel.x, v_rel.y, v_rel.z};
+            bool curve = performance_->has_drag_curve();
+            double a_sound = curve ? speed_of_sound(alt) : 1.0;
+            double mach = curve ? w_mag / a_sound : 0.0;
+            double k = 0.5 * performance_->drag_coefficient(mach) * vehicle_.reference_area / mass;
+
+            // d(a)/d(w) = -k rho (|w| I + w w^T / |w|), plus the Cd(Mach)
+            // term -k' rho w w^T / a with the speed of sound held fixed
+            double k_mach = 0.5 * performance_->drag_coefficient_slope(mach) *
+                            vehicle_.reference_area / mass / a_sound;
+            double D[3][3];
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    D[i][j] = -k * rho * ((i == j ? w_mag : 0.0) + w[i] * w[j] / w_mag)
+                              - k_mach * rho * w[i] * w[j];
+                }
+            }
+
+            // Density gradient of the (C1) table
+            double h_lo = std::max(0.0, alt - 1.0);
+            double drho_dalt = (atmosphere.density(alt + 1.0) - atmosphere.density(h_lo)) /
+                               (alt + 1.0 - h_lo);
+
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) A[3 + i][3 + j] += D[i][j];
+                // dw/dr: w_x = v_x + omega y, w_y = v_y - omega x
+                A[3 + i][0] -= D[i][1] * EARTH_OMEGA;
+                A[3 + i][1] += D[i][0] * EARTH_OMEGA;
+                for (int j = 0; j < 3; j++) {
+                    A[3 + i][j] -= k * drho_dalt * w_mag * w[i] * r_hat[j];
+                }
+                A[3 + i][6] += k * rho * w_mag * w[i] / mass;
+            }
+        }
+    }
+
+    return d;
+}
+
+void LaunchTrajectorySolver::rk4_sensitivity_step(
+    const LaunchState& state,
+    const LaunchControls& controls,
+    double dt,
+    Sensitivity& S) const {
+
+    // Stage states exactly as rk4_step builds them
+    auto stage_state = [&](const LaunchState& vel_source, const LaunchDerivatives& k, double h) {
+        LaunchState s = state;
+        s.position.x = state.position.x + vel_source.velocity.x * h;
+        s.position.y = state.position.y + vel_source.velocity.y * h;
+        s.position.z = state.position.z + vel_source.velocity.z * h;
+        s.velocity.x = state.velocity.x + k.acceleration.x * h;
+        s.velocity.y = state.velocity.y + k.acceleration.y * h;
+        s.velocity.z = state.velocity.z + k.acceleration.z * h;
+        s.mass = state.mass + k.mass_rate * h;
+        s.time = state.time + h;
+        s.altitude = eci_altitude(s.position);
+        return s;
+    };
+
+    // K = A * S_stage + B, then S_next_stage = S + h * K
+    double A[NX][NX], B[NX][NC];
+    Sensitivity K[4], Si;
+    auto tangent = [&](const Sensitivity& in, Sensitivity& out) {
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < NC; j++) {
+                double sum = B[i][j];
+                for (int k = 0; k < NX; k++) sum += A[i][k] * in.s[k][j];
+                out.s[i][j] = sum;
+            }
+        }
+    };
+    auto advance = [&](const Sensitivity& k, double h) {
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < NC; j++) Si.s[i][j] = S.s[i][j] + h * k.s[i][j];
+        }
+    };
+
+    LaunchDerivatives k1 = derivative_partials(state, controls, A, B);
+    tangent(S, K[0]);
+
+    LaunchState s2 = stage_state(state, k1, dt * 0.5);
+    LaunchDerivatives k2 = derivative_partials(s2, controls, A, B);
+    advance(K[0], dt * 0.5);
+    tangent(Si, K[1]);
+
+    LaunchState s3 = stage_state(s2, k2, dt * 0.5);
+    LaunchDerivatives k3 = derivative_partials(s3, controls, A, B);
+    advance(K[1], dt * 0.5);
+    tangent(Si, K[2]);
+
+    LaunchState s4 = stage_state(s3, k3, dt);
+    derivative_partials(s4, controls, A, B);
+    advance(K[2], dt);
+    tangent(Si, K[3]);
+
+    for (int i = 0; i < NX; i++) {
+        for (int j = 0; j < NC; j++) {
+            S.s[i][j] += (dt / 6.0) * (K[0].s[i][j] + 2.0 * K[1].s[i][j] +
+                                       2.0 * K[2].s[i][j] + K[3].s[i][j]);
+        }
+    }
+}
+
 // ============================================================
 // Trajectory Propagation with Staging
 // ============================================================
 
 LaunchState LaunchTrajectorySolver::propagate_trajectory(
     const LaunchControls& controls,
-    std::vector<LaunchState>* trajectory) const {
+    std::vector<LaunchState>* trajectory,
+    Sensitivity* sensitivity,
+    Screen* screen) const {
 
     // Initialize from launch site
     double actual_epoch = epoch_jd_ + controls.epoch_offset / 86400.0;
@@ -604,10 +893,7 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
     }
 
     // Estimate total propagation time
-    double t_burn_total = 0.0;
-    for (const auto& s : vehicle_.stages) {
-        t_burn_total += s.burn_duration(80000.0); // rough avg altitude
-    }
+    double t_burn_total = performance_->total_burn();
     double t_end = t_burn_total + controls.coast_after_burnout;
 
     if (trajectory) {
@@ -615,8 +901,50 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
         trajectory->push_back(state);
     }
 
+    // Sensitivities: only the epoch offset moves the initial state (the site
+    // rotates with the Earth). fuel_sens tracks d(fuel of current stage).
+    Sensitivity* S = sensitivity;
+    double fuel_sens[NC] = {};
+    if (S) {
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < NC; j++) S->s[i][j] = 0.0;
+        }
+        S->s[0][12] = -EARTH_OMEGA * state.position.y;
+        S->s[1][12] =  EARTH_OMEGA * state.position.x;
+        S->s[3][12] = -EARTH_OMEGA * state.velocity.y;
+        S->s[4][12] =  EARTH_OMEGA * state.velocity.x;
+    }
+
+    // Sensitivity to a step whose length depends on the controls:
+    // S += sign * f(end state) * d(length)/d(controls)
+    auto add_length_sensitivity = [&](const LaunchState& end, const double* dlen, double sign) {
+        LaunchDerivatives f = compute_derivatives(end, controls);
+        const double fv[NX] = {end.velocity.x, end.velocity.y, end.velocity.z,
+                               f.acceleration.x, f.acceleration.y, f.acceleration.z,
+                               f.mass_rate};
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < NC; j++) S->s[i][j] += sign * fv[i] * dlen[j];
+        }
+    };
+
+    if (screen) screen->outcome = LaunchScreen::REACHED_END;
+
     double t = 0.0;
     while (t < t_end) {
+        if (screen && t > 0.0) {
+            double v_radial = (state.position.x * state.velocity.x +
+                               state.position.y * state.velocity.y +
+                               state.position.z * state.velocity.z) / state.position.norm();
+            if (state.altitude < 0.0 && v_radial < 0.0) {
+                screen->outcome = LaunchScreen::IMPACT;
+                break;
+            }
+            if (max_reachable_energy(state) < screen->min_energy) {
+                screen->outcome = LaunchScreen::INSUFFICIENT_ENERGY;
+                break;
+            }
+        }
+
         // Adaptive step size
         double dt = (state.altitude < 100000.0) ?
             config_.atmo_step_size : config_.vacuum_step_size;
@@ -625,25 +953,42 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
 
         // Check if staging will occur this step
         if (state.engines_on && state.stage_index < (int)vehicle_.stages.size()) {
-            const auto& stage = vehicle_.stages[state.stage_index];
-            double alt = (state.altitude < 0.0) ? 0.0 : state.altitude;
-            double mdot = stage.mass_flow_rate(alt);
+            double mdot = performance_->mass_flow(state.stage_index, state.altitude);
             double fuel = state.fuel_remaining[state.stage_index];
 
             if (mdot > 0.0 && fuel > 0.0) {
                 double t_to_burnout = fuel / mdot;
                 if (t_to_burnout < dt) {
+                    // d(t_to_burnout): fuel, and mdot through Isp(altitude)
+                    double dtb[NC] = {};
+                    if (S) {
+                        double dmdot_dalt = performance_->mass_flow_slope(state.stage_index,
+                                                                          state.altitude);
+                        double r_mag = state.position.norm();
+                        const double r_hat[3] = {state.position.x / r_mag,
+                                                 state.position.y / r_mag,
+                                                 state.position.z / r_mag};
+                        for (int j = 0; j < NC; j++) {
+                            double dalt = r_hat[0] * S->s[0][j] + r_hat[1] * S->s[1][j] +
+                                          r_hat[2] * S->s[2][j];
+                            dtb[j] = (fuel_sens[j] - t_to_burnout * dmdot_dalt * dalt) / mdot;
+                        }
+                    }
+
                     // Stage will run out during this step - split at boundary
                     // First: propagate to burnout
                     if (t_to_burnout > 1e-6) {
+                        if (S) rk4_sensitivity_step(state, controls, t_to_burnout, *S);
                         state = rk4_step(state, controls, t_to_burnout);
                         t += t_to_burnout;
+                        if (S) add_length_sensitivity(state, dtb, 1.0);
                     }
 
                     // Staging event
                     state.fuel_remaining[state.stage_index] = 0.0;
                     state.mass -= vehicle_.stages[state.stage_index].dry_mass;
                     state.stage_index++;
+                    for (int j = 0; j < NC; j++) fuel_sens[j] = 0.0;
 
                     if (state.stage_index >= (int)vehicle_.stages.size()) {
                         state.engines_on = false;
@@ -654,8 +999,10 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
                     // Propagate remainder of original step
                     double dt_remain = dt - t_to_burnout;
                     if (dt_remain > 1e-6) {
+                        if (S) rk4_sensitivity_step(state, controls, dt_remain, *S);
                         state = rk4_step(state, controls, dt_remain);
                         t += dt_remain;
+                        if (S) add_length_sensitivity(state, dtb, -1.0);
                     }
 
                     if (trajectory) trajectory->push_back(state);
@@ -665,6 +1012,11 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
         }
 
         // Normal step
+        double mass_sens[NC] = {};
+        if (S) {
+            for (int j = 0; j < NC; j++) mass_sens[j] = S->s[6][j];
+            rk4_sensitivity_step(state, controls, dt, *S);
+        }
         LaunchState new_state = rk4_step(state, controls, dt);
 
         // Update fuel tracking
@@ -675,6 +1027,9 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
             if (new_state.fuel_remaining[state.stage_index] < 0.0) {
                 new_state.fuel_remaining[state.stage_index] = 0.0;
             }
+            if (S) {
+                for (int j = 0; j < NC; j++) fuel_sens[j] += S->s[6][j] - mass_sens[j];
+            }
         }
 
         state = new_state;
@@ -686,16 +1041,60 @@ LaunchState LaunchTrajectorySolver::propagate_trajectory(
         if (state.altitude < -100000.0) break;
     }
 
+    // The last step ends at t_end, which moves one-for-one with the coast time
+    if (S) {
+        double dcoast[NC] = {};
+        dcoast[11] = 1.0;
+        add_length_sensitivity(state, dcoast, 1.0);
+    }
+
     return state;
 }
 
+double LaunchTrajectorySolver::max_reachable_energy(const LaunchState& state) const {
+    // Ideal vacuum delta-v left in the current and later stages
+    double dv = 0.0;
+    if (state.engines_on) {
+        double m = state.mass;
+        for (int i = state.stage_index; i < (int)vehicle_.stages.size(); i++) {
+            const auto& stage = vehicle_.stages[i];
+            double fuel = (i == state.stage_index && i < 4) ?
+                state.fuel_remaining[i] : stage.propellant_mass;
+            if (fuel > 0.0 && m > fuel) dv += stage.isp_vac * G0 * std::log(m / (m - fuel));
+            m -= fuel + stage.dry_mass;
+        }
+    }
+
+    // dE/dt <= |a_thrust| |v|, and above the polar radius R_p |v| never
+    // exceeds u = sqrt(2 (E + mu / R_p)), so du/dt <= |a_thrust|
+    constexpr double POLAR_RADIUS = 6356752.3;
+    double r = state.position.norm();
+    double v = state.velocity.norm();
+    double energy = 0.5 * v * v - MU / r;
+    if (dv <= 0.0) return energy;
+    double u = std::sqrt(std::max(0.0, 2.0 * (energy + MU / POLAR_RADIUS))) + dv;
+    return 0.5 * u * u - MU / POLAR_RADIUS;
+}
+
+LaunchScreen LaunchTrajectorySolver::propagate_screened(
+    const LaunchControls& controls,
+    double min_perigee_radius,
+    LaunchState& final_state) const {
+
+    Screen screen;
+    screen.min_energy = -MU / (2.0 * min_perigee_radius);
+    final_state = propagate_trajectory(controls, nullptr, nullptr, &screen);
+    return screen.outcome;
+}
+
 // ============================================================
 // Constraint Residuals
 // ============================================================
 
 std::vector<double> LaunchTrajectorySolver::compute_residuals(
     const LaunchState& final_state,
-    const TerminalTarget& target) const {
+    const TerminalTarget& target,
+    double epoch_offset) const {
 
     std::vector<double> r;
 
@@ -729,8 +1128,7 @@ std::vector<double> LaunchTrajectorySolver::compute_residuals(
         }
 
         case TargetingMode::POSITION_INTERCEPT: {
-            StateVector target_final = propagate_target(target.target_state_epoch,
-                                                         target.time_of_flight);
+            StateVector target_final = target_at_intercept(target, epoch_offset);
             r.push_back(final_state.position.x - target_final.position.x);
             r.push_back(final_state.position.y - target_final.position.y);
             r.push_back(final_state.position.z - target_final.position.z);
@@ -738,8 +1136,7 @@ std::vector<double> LaunchTrajectorySolver::compute_residuals(
         }
 
         case TargetingMode::FULL_RENDEZVOUS: {
-            StateVector target_final = propagate_target(target.target_state_epoch,
-                                                         target.time_of_flight);
+            StateVector target_final = target_at_intercept(target, epoch_offset);
             // Position residuals [m]
             r.push_back(final_state.position.x - target_final.position.x);
             r.push_back(final_state.position.y - target_final.position.y);
@@ -763,6 +1160,11 @@ std::vector<double> LaunchTrajectorySolver::compute_residuals(
 // Target Propagation
 // ============================================================
 
+StateVector LaunchTrajectorySolver::target_at_intercept(const TerminalTarget& target,
+                                                        double epoch_offset) const {
+    return propagate_target(target.target_state_epoch, target.time_of_flight + epoch_offset);
+}
+
 StateVector LaunchTrajectorySolver::propagate_target(
     const StateVector& target, double dt) const {
 
@@ -824,22 +1226,24 @@ StateVector LaunchTrajectorySolver::propagate_target(
 }
 
 // ============================================================
-// Numerical Jacobian
+// Jacobian
 // ============================================================
 
 void LaunchTrajectorySolver::compute_jacobian(
     const LaunchControls& controls,
     const TerminalTarget& target,
     const std::vector<double>& r_nominal,
-    std::vector<std::vector<double>>& jacobian) const {
+    JacobianMatrix& jacobian) const {
+
+    if (config_.jacobian == LaunchJacobian::VARIATIONAL) {
+        compute_variational_jacobian(controls, target, jacobian);
+        return;
+    }
 
     int n_constraints = (int)r_nominal.size();
     int n_free = config_.num_free_controls();
 
-    jacobian.resize(n_constraints);
-    for (int i = 0; i < n_constraints; i++) {
-        jacobian[i].resize(n_free);
-    }
+    jacobian.resize(n_constraints, n_free);
 
     std::vector<double> x0 = pack_free_controls(controls);
 
@@ -867,7 +1271,10 @@ void LaunchTrajectorySolver::compute_jacobian(
         10.0,  // [12] epoch_offset [s]
     };
 
-    for (int j = 0; j < n_free; j++) {
+    // Columns are independent propagations writing disjoint entries
+    auto column = [&](size_t col) {
+        int j = static_cast<int>(col);
+
         // Perturbation size: relative with per-control floor
         int full_idx = free_to_full[j];
         double floor_val = FD_FLOORS[full_idx];
@@ -882,117 +1289,112 @@ void LaunchTrajectorySolver::compute_jacobian(
 
         // Propagate perturbed trajectory
         LaunchState final_pert = propagate_trajectory(c_pert);
-        std::vector<double> r_pert = compute_residuals(final_pert, target);
+        std::vector<double> r_pert = compute_residuals(final_pert, target, c_pert.epoch_offset);
 
         // Finite difference
         for (int i = 0; i < n_constraints; i++) {
-            jacobian[i][j] = (r_pert[i] - r_nominal[i]) / h;
+            jacobian(i, j) = (r_pert[i] - r_nominal[i]) / h;
         }
+    };
+
+    if (pool_) {
+        pool_->parallel_for(static_cast<size_t>(n_free), column);
+    } else {
+        for (int j = 0; j < n_free; j++) column(static_cast<size_t>(j));
     }
 }
 
-// ============================================================
-// Linear System Solver
-// ============================================================
-
-std::vector<double> LaunchTrajectorySolver::solve_linear_system(
-    const std::vector<std::vector<double>>& J,
-    const std::vector<double>& r,
-    int M, int N,
-    double damping) const {
-
-    std::vector<double> dx(N, 0.0);
-
-    if (M == N) {
-        // Square system: Gaussian elimination with partial pivoting
-        std::vector<std::vector<double>> A(M, std::vector<double>(N + 1));
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) A[i][j] = J[i][j];
-            A[i][N] = r[i];
-        }
-
-        for (int col = 0; col < N; col++) {
-            // Partial pivoting
-            int max_row = col;
-            double max_val = std::abs(A[col][col]);
-            for (int row = col + 1; row < M; row++) {
-                if (std::abs(A[row][col]) > max_val) {
-                    max_val = std::abs(A[row][col]);
-                    max_row = row;
-                }
-            }
-            if (max_row != col) std::swap(A[col], A[max_row]);
-
-            if (std::abs(A[col][col]) < 1e-15) continue;
-
-            for (int row = col + 1; row < M; row++) {
-                double factor = A[row][col] / A[col][col];
-                for (int k = col; k <= N; k++) {
-                    A[row][k] -= factor * A[col][k];
-                }
-            }
+void LaunchTrajectorySolver::compute_variational_jacobian(
+    const LaunchControls& controls,
+    const TerminalTarget& target,
+    JacobianMatrix& jacobian) const {
+
+    Sensitivity S;
+    LaunchState final_state = propagate_trajectory(controls, nullptr, &S);
+    std::vector<std::array<double, 6>> R = residual_state_partials(final_state, target);
+
+    // J = d(residual)/d(final r, v) * d(final r, v)/d(free controls)
+    jacobian.resize(static_cast<int>(R.size()), config_.num_free_controls());
+    for (int i = 0; i < static_cast<int>(R.size()); i++) {
+        int j = 0;
+        for (int c = 0; c < NC; c++) {
+            if (!config_.free_controls[c]) continue;
+            double sum = 0.0;
+            for (int k = 0; k < 6; k++) sum += R[i][k] * S.s[k][c];
+            jacobian(i, j++) = sum;
         }
+    }
 
-        // Back substitution
-        for (int i = N - 1; i >= 0; i--) {
-            if (std::abs(A[i][i]) < 1e-15) { dx[i] = 0.0; continue; }
-            double sum = A[i][N];
-            for (int j = i + 1; j < N; j++) sum -= A[i][j] * dx[j];
-            dx[i] = sum / A[i][i];
+    // A later launch also moves the intercept later along the target's path
+    if (config_.free_controls[12] && target.mode != TargetingMode::ORBIT_INSERTION) {
+        StateVector tf = target_at_intercept(target, controls.epoch_offset);
+        Vec3 a = gravity::body_acceleration(tf.position, gravity::BodyConstants::EARTH, true);
+        const double rate[6] = {tf.velocity.x, tf.velocity.y, tf.velocity.z, a.x, a.y, a.z};
+        int j = 0;
+        for (int c = 0; c < 12; c++) j += config_.free_controls[c];
+        for (int i = 0; i < static_cast<int>(R.size()); i++) {
+            for (int k = 0; k < 6; k++) jacobian(i, j) -= R[i][k] * rate[k];
         }
     }
-    else if (M < N) {
-        // Underdetermined: minimum-norm solution via J^T * (J*J^T)^{-1} * r
-        // Compute JJT = J * J^T (M x M)
-        std::vector<std::vector<double>> JJT(M, std::vector<double>(M, 0.0));
-        for (int i = 0; i < M; i++) {
-            for (int k = 0; k < M; k++) {
-                double sum = 0.0;
-                for (int j = 0; j < N; j++) {
-                    sum += J[i][j] * J[k][j];
-                }
-                JJT[i][k] = sum;
-            }
-        }
+}
 
-        // Add Levenberg-Marquardt / Tikhonov regularization
-        for (int i = 0; i < M; i++) JJT[i][i] += damping;
+std::vector<std::array<double, 6>> LaunchTrajectorySolver::residual_state_partials(
+    const LaunchState& final_state,
+    const TerminalTarget& target) const {
 
-        // Solve JJT * y = r (M x M system)
-        std::vector<double> y = solve_linear_system(JJT, r, M, M, 0.0);
+    std::vector<std::array<double, 6>> R;
 
-        // dx = J^T * y
-        for (int j = 0; j < N; j++) {
-            double sum = 0.0;
-            for (int i = 0; i < M; i++) {
-                sum += J[i][j] * y[i];
+    if (target.mode == TargetingMode::ORBIT_INSERTION) {
+        // Element residuals: central differences of the (cheap) terminal map
+        static constexpr double STEP[6] = {1.0, 1.0, 1.0, 1e-3, 1e-3, 1e-3};
+        for (int k = 0; k < 6; k++) {
+            LaunchState plus = final_state, minus = final_state;
+            double* p = (k < 3) ? &plus.position.x : &plus.velocity.x;
+            double* m = (k < 3) ? &minus.position.x : &minus.velocity.x;
+            p[k % 3] += STEP[k];
+            m[k % 3] -= STEP[k];
+            std::vector<double> r_plus = compute_residuals(plus, target);
+            std::vector<double> r_minus = compute_residuals(minus, target);
+            if (R.empty()) R.assign(r_plus.size(), std::array<double, 6>{});
+            for (size_t i = 0; i < r_plus.size(); i++) {
+                R[i][k] = (r_plus[i] - r_minus[i]) / (2.0 * STEP[k]);
             }
-            dx[j] = sum;
         }
+        return R;
     }
-    else {
-        // Overdetermined: least-squares via (J^T*J)*dx = J^T*r
-        std::vector<std::vector<double>> JTJ(N, std::vector<double>(N, 0.0));
-        std::vector<double> JTr(N, 0.0);
-
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                double sum = 0.0;
-                for (int k = 0; k < M; k++) sum += J[k][i] * J[k][j];
-                JTJ[i][j] = sum;
-            }
-            double sum = 0.0;
-            for (int k = 0; k < M; k++) sum += J[k][i] * r[k];
-            JTr[i] = sum;
+
+    // Intercept/rendezvous residuals are linear in the final state
+    for (int i = 0; i < 3; i++) {
+        std::array<double, 6> row{};
+        row[i] = 1.0;
+        R.push_back(row);
+    }
+    if (target.mode == TargetingMode::FULL_RENDEZVOUS) {
+        double a_target = target.target_elements.semi_major_axis;
+        if (a_target < 1e6) a_target = EARTH_RADIUS + 400000.0;
+        double T_scale = std::sqrt(a_target * a_target * a_target / MU);
+        for (int i = 0; i < 3; i++) {
+            std::array<double, 6> row{};
+            row[3 + i] = T_scale;
+            R.push_back(row);
         }
+    }
+    return R;
+}
 
-        // Add Levenberg-Marquardt / Tikhonov regularization
-        for (int i = 0; i < N; i++) JTJ[i][i] += damping;
+// ============================================================
+// Linear System Solver
+// ============================================================
 
-        dx = solve_linear_system(JTJ, JTr, N, N);
-    }
+std::vector<double> LaunchTrajectorySolver::solve_linear_system(
+    const JacobianMatrix& J,
+    const std::vector<double>& r,
+    double damping) const {
 
-    return dx;
+    linalg::FixedVector<NC> dx;
+    linalg::damped_least_squares(J, linalg::FixedVector<MAX_RESIDUALS>::from(r),
+                                 damping, dx, config_.linear_solver);
+    return dx.to_vector();
 }
 
 // ============================================================
@@ -1212,8 +1614,7 @@ LaunchControls LaunchTrajectorySolver::generate_initial_guess(
         LaunchState insertion = propagate_trajectory(guess);
 
         // Use Lambert to find required velocity at insertion point
-        StateVector target_final = propagate_target(target.target_state_epoch,
-                                                     target.time_of_flight);
+        StateVector target_final = target_at_intercept(target, guess.epoch_offset);
 
         double coast_tof = target.time_of_flight - insertion.time;
         if (coast_tof > 60.0) {
@@ -1294,7 +1695,8 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
         LaunchState final_state = propagate_trajectory(controls);
 
         // Compute residuals
-        std::vector<double> residuals = compute_residuals(final_state, target);
+        std::vector<double> residuals = compute_residuals(final_state, target,
+                                                          controls.epoch_offset);
 
         // Compute residual norm
         double r_norm = 0.0;
@@ -1354,8 +1756,7 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
             // Compute errors for intercept/rendezvous
             if (target.mode == TargetingMode::POSITION_INTERCEPT ||
                 target.mode == TargetingMode::FULL_RENDEZVOUS) {
-                StateVector tf = propagate_target(target.target_state_epoch,
-                                                   target.time_of_flight);
+                StateVector tf = target_at_intercept(target, controls.epoch_offset);
                 Vec3 dr;
                 dr.x = final_state.position.x - tf.position.x;
                 dr.y = final_state.position.y - tf.position.y;
@@ -1376,18 +1777,25 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
         }
 
         // Compute Jacobian
-        std::vector<std::vector<double>> J;
+        JacobianMatrix J;
         compute_jacobian(controls, target, residuals, J);
 
+        // A free launch time is stepped in units of EPOCH_SCALE seconds, or
+        // the minimum-norm step would move the (radian) steering instead
+        int epoch_col = -1;
+        if (config_.free_controls[12]) {
+            epoch_col = n_free - 1;
+            for (int i = 0; i < n_constraints; i++) J(i, epoch_col) *= EPOCH_SCALE;
+        }
+
         // Levenberg-Marquardt: try solving with current lambda,
         // increase damping if step doesn't improve, decrease if it does
         bool step_accepted = false;
 
         for (int lm_trial = 0; lm_trial < 10 && !step_accepted; lm_trial++) {
             // Solve damped linear system
-            std::vector<double> dx = solve_linear_system(J, residuals,
-                                                          n_constraints, n_free,
-                                                          lm_lambda);
+            std::vector<double> dx = solve_linear_system(J, residuals, lm_lambda);
+            if (epoch_col >= 0) dx[epoch_col] *= EPOCH_SCALE;
 
             // Test the correction
             LaunchControls c_test = controls;
@@ -1401,7 +1809,7 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
                 continue;
             }
 
-            std::vector<double> r_test = compute_residuals(fs_test, target);
+            std::vector<double> r_test = compute_residuals(fs_test, target, c_test.epoch_offset);
             double r_test_norm = 0.0;
             for (double ri : r_test) r_test_norm += ri * ri;
             r_test_norm = std::sqrt(r_test_norm);
@@ -1424,7 +1832,7 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
             std::vector<double> gradient(n_free, 0.0);
             for (int j = 0; j < n_free; j++) {
                 for (int i = 0; i < n_constraints; i++) {
-                    gradient[j] += J[i][j] * residuals[i];
+                    gradient[j] += J(i, j) * residuals[i];
                 }
             }
             double g_norm = 0.0;
@@ -1433,6 +1841,7 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
             if (g_norm > 1e-10) {
                 double grad_step = 0.005;
                 for (double& g : gradient) g *= grad_step / g_norm;
+                if (epoch_col >= 0) gradient[epoch_col] *= EPOCH_SCALE;
                 apply_correction(controls, gradient, 1.0);
             }
             if (config_.verbose) {
@@ -1492,8 +1901,7 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
     if (!solution.converged) {
         if (target.mode == TargetingMode::POSITION_INTERCEPT ||
             target.mode == TargetingMode::FULL_RENDEZVOUS) {
-            StateVector tf = propagate_target(target.target_state_epoch,
-                                               target.time_of_flight);
+            StateVector tf = target_at_intercept(target, solution.controls.epoch_offset);
             Vec3 dr;
             dr.x = solution.final_state.position.x - tf.position.x;
             dr.y = solution.final_state.position.y - tf.position.y;
@@ -1511,6 +1919,175 @@ LaunchTrajectorySolution LaunchTrajectorySolver::solve(
     return solution;
 }
 
+// ============================================================
+// Multi-Start
+// ============================================================
+
+LaunchTrajectorySolution LaunchTrajectorySolver::solve_multi_start(
+    const TerminalTarget& target,
+    int num_starts,
+    const LaunchControls* initial_guess) {
+
+    if (num_starts <= 1) return solve(target, initial_guess);
+
+    LaunchControls base = initial_guess ?
+        *initial_guess : generate_initial_guess(target);
+
+    // Seed spread per control (1-sigma), roughly a third of apply_correction's
+    // per-iteration step limits
+    static constexpr double SPREAD[LaunchControls::N_CONTROLS] = {
+        0.03,                 // azimuth [rad]
+        0.01, 0.05, 0.05,     // pitch_s1
+        0.05, 0.15, 0.15,     // pitch_s2
+        0.01, 0.01,           // yaw_s1
+        0.01, 0.01,           // yaw_s2
+        60.0,                 // coast [s]
+        20.0,                 // epoch offset [s]
+    };
+
+    std::vector<LaunchControls> seeds(num_starts, base);
+    for (int k = 1; k < num_starts; k++) {
+        std::mt19937 rng(static_cast<unsigned>(k));
+        std::normal_distribution<double> normal(0.0, 1.0);
+        double x[LaunchControls::N_CONTROLS];
+        seeds[k].to_array(x);
+        for (int i = 0; i < LaunchControls::N_CONTROLS; i++) {
+            if (config_.free_controls[i]) x[i] += SPREAD[i] * normal(rng);
+        }
+        seeds[k].from_array(x);
+        // Zero correction: only clamps to the physical bounds
+        apply_correction(seeds[k], std::vector<double>(config_.num_free_controls(), 0.0), 1.0);
+    }
+
+    // Each start runs serially inside; the starts share one pool
+    LaunchSolverConfig start_config = config_;
+    start_config.num_threads = 1;
+    start_config.verbose = false;
+
+    std::vector<LaunchTrajectorySolution> results(num_starts);
+    auto run = [&](size_t k) {
+        LaunchTrajectorySolver start(vehicle_, site_, epoch_jd_, start_config, performance_);
+        results[k] = start.solve(target, &seeds[k]);
+    };
+    if (config_.num_threads == 1) {
+        for (int k = 0; k < num_starts; k++) run(static_cast<size_t>(k));
+    } else {
+        ThreadPool pool(std::min(config_.num_threads > 0 ? config_.num_threads
+                                                         : ThreadPool::hardware_threads(),
+                                 num_starts));
+        pool.parallel_for(static_cast<size_t>(num_starts), run);
+    }
+
+    // Prefer converged, then smallest residual; ties keep the lower index
+    int best = 0;
+    for (int k = 1; k < num_starts; k++) {
+        const auto& a = results[k];
+        const auto& b = results[best];
+        if (a.converged != b.converged) {
+            if (a.converged) best = k;
+        } else if (a.residual_norm < b.residual_norm) {
+            best = k;
+        }
+    }
+
+    if (config_.verbose) {
+        int n_converged = 0;
+        for (const auto& r : results) n_converged += r.converged ? 1 : 0;
+        std::cout << "Multi-start: " << n_converged << "/" << num_starts
+                  << " converged, best start " << best
+                  << " |r|=" << std::scientific << std::setprecision(3)
+                  << results[best].residual_norm << std::defaultfloat << std::endl;
+    }
+
+    return results[best];
+}
+
+// ============================================================
+// Launch Window
+// ============================================================
+
+std::vector<LaunchWindowEntry> LaunchTrajectorySolver::solve_window(
+    const std::vector<TerminalTarget>& targets,
+    const std::vector<double>& epochs_jd) {
+
+    const int n_targets = static_cast<int>(targets.size());
+    const int n_epochs = static_cast<int>(epochs_jd.size());
+    std::vector<LaunchWindowEntry> table(targets.size() * epochs_jd.size());
+    if (table.empty()) return table;
+
+    LaunchSolverConfig cell_config = config_;
+    cell_config.num_threads = 1;
+    cell_config.verbose = false;
+
+    auto solve_cell = [&](int t, int e, int warm) {
+        LaunchWindowEntry& entry = table[t * n_epochs + e];
+        entry.target_index = t;
+        entry.epoch_index = e;
+        entry.epoch_jd = epochs_jd[e];
+        entry.seeded_from = -1;
+
+        LaunchTrajectorySolver solver(vehicle_, site_, epochs_jd[e], cell_config, performance_);
+        if (warm >= 0) {
+            entry.solution = solver.solve(targets[t], &table[warm].solution.controls);
+            entry.seeded_from = warm;
+        }
+        if (warm < 0 || !entry.solution.converged) {
+            LaunchTrajectorySolution cold = solver.solve(targets[t]);
+            if (warm < 0 || cold.converged ||
+                cold.residual_norm < entry.solution.residual_norm) {
+                entry.solution = std::move(cold);
+                entry.seeded_from = -1;
+            }
+        }
+        entry.solution.trajectory.clear();
+        entry.solution.trajectory.shrink_to_fit();
+    };
+
+    // Nearest converged entry before position k of a chain, -1 if none
+    auto nearest = [&](int k, auto index_of) {
+        for (int j = k - 1; j >= 0; j--) {
+            if (table[index_of(j)].solution.converged) return index_of(j);
+        }
+        return -1;
+    };
+
+    // First epoch: one chain down the targets
+    auto first_epoch = [&](int t) { return t * n_epochs; };
+    for (int t = 0; t < n_targets; t++) {
+        solve_cell(t, 0, nearest(t, first_epoch));
+    }
+
+    // Remaining epochs: one independent chain per target
+    auto chain = [&](size_t t) {
+        auto along = [&](int e) { return static_cast<int>(t) * n_epochs + e; };
+        for (int e = 1; e < n_epochs; e++) {
+            solve_cell(static_cast<int>(t), e, nearest(e, along));
+        }
+    };
+    if (n_epochs > 1) {
+        if (config_.num_threads == 1 || n_targets == 1) {
+            for (int t = 0; t < n_targets; t++) chain(static_cast<size_t>(t));
+        } else {
+            ThreadPool pool(std::min(config_.num_threads > 0 ? config_.num_threads
+                                                             : ThreadPool::hardware_threads(),
+                                     n_targets));
+            pool.parallel_for(targets.size(), chain);
+        }
+    }
+
+    if (config_.verbose) {
+        int n_converged = 0, n_warm = 0;
+        for (const auto& entry : table) {
+            n_converged += entry.solution.converged ? 1 : 0;
+            n_warm += entry.seeded_from >= 0 ? 1 : 0;
+        }
+        std::cout << "Launch window: " << n_converged << "/" << table.size()
+                  << " converged (" << n_warm << " from warm starts)" << std::endl;
+    }
+
+    return table;
+}
+
 // ============================================================
 // Evaluate (propagate without solving)
 // ============================================================
@@ -1526,7 +2103,8 @@ LaunchTrajectorySolution LaunchTrajectorySolver::propagate(
 
     solution.final_state = propagate_trajectory(controls, &solution.trajectory);
 
-    std::vector<double> residuals = compute_residuals(solution.final_state, target);
+    std::vector<double> residuals = compute_residuals(solution.final_state, target,
+                                                      controls.epoch_offset);
     double r_norm = 0.0;
     for (double ri : residuals) r_norm += ri * ri;
     solution.residual_norm = std::sqrt(r_norm);
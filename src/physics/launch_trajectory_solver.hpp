@@ -8,7 +8,11 @@
  * Dynamics: two-body + J2 gravity, atmospheric drag with Earth-relative
  * velocity, thrust with altitude-dependent Isp, mass depletion, staging.
  *
- * All propagation in ECI frame. Numerical Jacobian via finite differences.
+ * All propagation in ECI frame. The Jacobian comes either from forward
+ * finite differences (one propagation per free control) or from the
+ * variational equations: d[r, v, m]/d(controls) integrated alongside the
+ * trajectory with analytic partials of gravity, J2, drag and thrust, so a
+ * single pass yields every column.
  */
 
 #ifndef LAUNCH_TRAJECTORY_SOLVER_HPP
@@ -16,11 +20,18 @@
 
 #include "core/state_vector.hpp"
 #include "physics/orbital_elements.hpp"
+#include "physics/launch_performance.hpp"
+#include "physics/dense_linalg.hpp"
+#include <array>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <string>
 
 namespace sim {
 
+class ThreadPool;
+
 // ============================================================
 // Vehicle Configuration
 // ============================================================
@@ -65,6 +76,9 @@ struct SolverVehicleConfig {
     double drag_coefficient;    // Cd
     double reference_area;      // m^2
 
+    /// Optional Cd(Mach) breakpoints {Mach, Cd}, ascending; empty = constant drag_coefficient
+    std::vector<std::pair<double, double>> drag_curve;
+
     /** Total vehicle mass (all stages + payload) */
     double total_mass() const {
         double m = payload_mass;
@@ -193,7 +207,9 @@ struct TerminalTarget {
     bool constrain_raan;   // default false
     bool constrain_argp;   // default false
 
-    // POSITION_INTERCEPT / FULL_RENDEZVOUS: target satellite state at launch epoch
+    // POSITION_INTERCEPT / FULL_RENDEZVOUS: target satellite state at the
+    // nominal launch epoch. The intercept is time_of_flight after the actual
+    // launch, so with epoch_offset free the solver also picks the launch time.
     StateVector target_state_epoch;
     double time_of_flight;     // Desired TOF from launch to intercept [s]
 
@@ -211,8 +227,15 @@ struct TerminalTarget {
 // Solver Configuration
 // ============================================================
 
+enum class LaunchJacobian {
+    FINITE_DIFFERENCE,  // Forward differences, one propagation per free control
+    VARIATIONAL         // Sensitivities propagated with the trajectory (one pass)
+};
+
 struct LaunchSolverConfig {
     int max_iterations;
+    LaunchJacobian jacobian;     // How the Newton Jacobian is formed
+    linalg::LeastSquares linear_solver;  // How the damped Newton step is solved
     double fd_step_size;         // Relative FD perturbation
     double convergence_tol;      // Residual norm threshold
     bool use_line_search;
@@ -220,6 +243,7 @@ struct LaunchSolverConfig {
     int line_search_max;         // Max backtracking steps
     double atmo_step_size;       // Integration step in atmosphere [s]
     double vacuum_step_size;     // Integration step in vacuum [s]
+    int num_threads;             // FD Jacobian columns in parallel (0 = hardware, 1 = serial)
     bool verbose;
 
     // Which controls are free for optimization
@@ -253,8 +277,30 @@ struct LaunchTrajectorySolution {
     // Terminal state
     LaunchState final_state;
     OrbitalElements final_elements;
-    double final_position_error;
-    double final_velocity_error;
+    double final_position_error = 0.0;   // Left at 0 outside intercept modes
+    double final_velocity_error = 0.0;
+};
+
+/**
+ * Outcome of a screened propagation (see propagate_screened)
+ */
+enum class LaunchScreen {
+    REACHED_END,         // Propagated to the end of the profile
+    IMPACT,              // Descended below the surface
+    INSUFFICIENT_ENERGY  // Cannot reach the minimum perigee even with all remaining delta-v
+};
+
+/**
+ * One cell of a launch-window sweep: targets[target_index] launched at
+ * epochs_jd[epoch_index]. The trajectory is not kept (solution.trajectory
+ * is empty); controls, losses and terminal state are.
+ */
+struct LaunchWindowEntry {
+    int target_index;
+    int epoch_index;
+    double epoch_jd;
+    int seeded_from;        // Entry index of the warm start (-1 = Lambert guess)
+    LaunchTrajectorySolution solution;
 };
 
 // ============================================================
@@ -264,20 +310,54 @@ struct LaunchTrajectorySolution {
 /**
  * Nonlinear launch-to-intercept trajectory solver.
  *
- * Uses Newton-Raphson with numerical Jacobian (finite differences) to solve
- * for launch control parameters that satisfy terminal constraints.
+ * Uses Newton-Raphson (Levenberg-Marquardt damped) to solve for launch
+ * control parameters that satisfy terminal constraints.
  */
 class LaunchTrajectorySolver {
 public:
+    /**
+     * @param performance Tables for this vehicle (LaunchPerformance::build);
+     *                    built here when null
+     */
     LaunchTrajectorySolver(const SolverVehicleConfig& vehicle,
                             const LaunchSite& site,
                             double epoch_jd,
-                            const LaunchSolverConfig& config = LaunchSolverConfig());
+                            const LaunchSolverConfig& config = LaunchSolverConfig(),
+                            std::shared_ptr<const LaunchPerformance> performance = nullptr);
+
+    const std::shared_ptr<const LaunchPerformance>& performance() const { return performance_; }
 
     /** Solve the trajectory optimization problem */
     LaunchTrajectorySolution solve(const TerminalTarget& target,
                                     const LaunchControls* initial_guess = nullptr);
 
+    /**
+     * Run num_starts independent solves in parallel (config num_threads)
+     * from perturbed copies of the initial guess; start 0 is unperturbed.
+     * Starts are seeded deterministically, so the result is reproducible.
+     *
+     * @return The converged solution with the smallest residual, or the
+     *         smallest-residual attempt if none converged
+     */
+    LaunchTrajectorySolution solve_multi_start(const TerminalTarget& target,
+                                                int num_starts,
+                                                const LaunchControls* initial_guess = nullptr);
+
+    /**
+     * Solve every (target, epoch) pair of a launch window by continuation.
+     * Targets should be ordered so neighbors are close (e.g. a sweep in
+     * inclination or RAAN), and epochs ascending.
+     *
+     * The first epoch is solved down the target list, then each target's
+     * epoch chain runs in parallel (config num_threads). Each cell starts
+     * from the nearest converged cell before it in its chain, and falls
+     * back to the Lambert guess if that warm start fails.
+     *
+     * @return targets.size() x epochs_jd.size() entries, row-major by target
+     */
+    std::vector<LaunchWindowEntry> solve_window(const std::vector<TerminalTarget>& targets,
+                                                const std::vector<double>& epochs_jd);
+
     /** Generate initial guess from Lambert solution */
     LaunchControls generate_initial_guess(const TerminalTarget& target) const;
 
@@ -285,11 +365,27 @@ public:
     LaunchTrajectorySolution propagate(const LaunchControls& controls,
                                         const TerminalTarget& target) const;
 
+    /**
+     * Propagate without recording the trajectory, stopping as soon as the
+     * candidate cannot reach an orbit with perigee radius min_perigee_radius:
+     * on impact, or when the specific energy, raised by every remaining
+     * vacuum delta-v applied along the velocity, stays below
+     * -mu / (2 min_perigee_radius). The energy bound ignores drag, so it
+     * never rejects a profile that could make orbit.
+     *
+     * @param final_state State where propagation stopped
+     */
+    LaunchScreen propagate_screened(const LaunchControls& controls,
+                                    double min_perigee_radius,
+                                    LaunchState& final_state) const;
+
 private:
     SolverVehicleConfig vehicle_;
     LaunchSite site_;
     double epoch_jd_;
     LaunchSolverConfig config_;
+    std::shared_ptr<const LaunchPerformance> performance_;
+    std::shared_ptr<ThreadPool> pool_;   // FD Jacobian columns (null when serial)
 
     // --- Propagation ---
 
@@ -298,9 +394,42 @@ private:
         double mass_rate;   // kg/s (negative during burn)
     };
 
-    /** Full trajectory propagation */
+    static constexpr int NX = 7;                          // [r, v, m]
+    static constexpr double EPOCH_SCALE = 100.0;          // Newton unit of epoch_offset [s]
+    static constexpr int NC = LaunchControls::N_CONTROLS;
+    static constexpr int MAX_RESIDUALS = 6;                // Full rendezvous
+
+    using JacobianMatrix = linalg::FixedMatrix<MAX_RESIDUALS, NC>;
+
+    /** d[r, v, m] / d(control) for every control, carried with the state */
+    struct Sensitivity {
+        double s[NX][NC];
+    };
+
+    /** Analytic partials of the thrust direction */
+    struct ThrustPartials {
+        double d_state[3][6];       // d(dir) / d[r, v]
+        double d_controls[3][NC];   // d(dir) / d(control)
+    };
+
+    /// Early-exit test for propagate_screened
+    struct Screen {
+        double min_energy;      // -mu / (2 min perigee radius) [J/kg]
+        LaunchScreen outcome;
+    };
+
+    /**
+     * Full trajectory propagation
+     * @param sensitivity If non-null, receives d(final [r, v, m]) / d(controls)
+     * @param screen If non-null, stop once the candidate cannot make orbit
+     */
     LaunchState propagate_trajectory(const LaunchControls& controls,
-                                      std::vector<LaunchState>* trajectory = nullptr) const;
+                                      std::vector<LaunchState>* trajectory = nullptr,
+                                      Sensitivity* sensitivity = nullptr,
+                                      Screen* screen = nullptr) const;
+
+    /** Upper bound on the specific energy reachable from state [J/kg] */
+    double max_reachable_energy(const LaunchState& state) const;
 
     /** Single RK4 step for 7-element state (pos, vel, mass) */
     LaunchState rk4_step(const LaunchState& state,
@@ -311,34 +440,67 @@ private:
     LaunchDerivatives compute_derivatives(const LaunchState& state,
                                            const LaunchControls& controls) const;
 
+    /**
+     * compute_derivatives() plus its Jacobians: A = df/d[r, v, m] and
+     * B = df/d(controls), f = [v, a, mdot]
+     */
+    LaunchDerivatives derivative_partials(const LaunchState& state,
+                                           const LaunchControls& controls,
+                                           double A[NX][NX], double B[NX][NC]) const;
+
+    /**
+     * Advance a sensitivity across rk4_step(state, controls, dt): the exact
+     * tangent of the RK4 map, built from the same stage states.
+     */
+    void rk4_sensitivity_step(const LaunchState& state,
+                              const LaunchControls& controls,
+                              double dt, Sensitivity& sensitivity) const;
+
     // --- Steering ---
 
-    /** Compute thrust direction unit vector in ECI */
+    /**
+     * Compute thrust direction unit vector in ECI
+     * @param partials If non-null, receives its derivatives
+     */
     Vec3 compute_thrust_direction(const LaunchState& state,
-                                   const LaunchControls& controls) const;
+                                   const LaunchControls& controls,
+                                   ThrustPartials* partials = nullptr) const;
 
-    /** Evaluate pitch and yaw from control polynomials */
+    /**
+     * Evaluate pitch and yaw from control polynomials
+     * @param dpitch, dyaw If non-null, receive d(angle)/d(control) [NC]
+     */
     void evaluate_steering(const LaunchState& state,
                            const LaunchControls& controls,
-                           double& pitch, double& yaw) const;
+                           double& pitch, double& yaw,
+                           double* dpitch = nullptr, double* dyaw = nullptr) const;
 
     // --- Targeting ---
 
-    /** Compute residual vector for current state vs target */
+    /** Compute residual vector for current state vs target (launched epoch_offset late) */
     std::vector<double> compute_residuals(const LaunchState& final_state,
-                                           const TerminalTarget& target) const;
+                                           const TerminalTarget& target,
+                                           double epoch_offset = 0.0) const;
 
-    /** Compute numerical Jacobian via forward finite differences */
+    /** Compute Jacobian of residuals w.r.t. free controls (config_.jacobian) */
     void compute_jacobian(const LaunchControls& controls,
                            const TerminalTarget& target,
                            const std::vector<double>& residuals_nominal,
-                           std::vector<std::vector<double>>& jacobian) const;
+                           JacobianMatrix& jacobian) const;
+
+    /** Jacobian from one propagation of the variational equations */
+    void compute_variational_jacobian(const LaunchControls& controls,
+                                       const TerminalTarget& target,
+                                       JacobianMatrix& jacobian) const;
 
-    /** Solve linear system J*dx = r (handles square, over/underdetermined) */
+    /** d(residuals) / d(final [r, v]), one row per residual */
+    std::vector<std::array<double, 6>> residual_state_partials(
+        const LaunchState& final_state, const TerminalTarget& target) const;
+
+    /** Damped step J*dx = r (square, over/underdetermined; config_.linear_solver) */
     std::vector<double> solve_linear_system(
-        const std::vector<std::vector<double>>& J,
+        const JacobianMatrix& J,
         const std::vector<double>& r,
-        int num_rows, int num_cols,
         double damping = 1e-8) const;
 
     /** Apply correction to controls with optional scaling */
@@ -351,6 +513,9 @@ private:
     /** Propagate target satellite under J2 gravity */
     StateVector propagate_target(const StateVector& target, double dt) const;
 
+    /** Target state time_of_flight after a launch epoch_offset from nominal */
+    StateVector target_at_intercept(const TerminalTarget& target, double epoch_offset) const;
+
     // --- Utilities ---
 
     std::vector<double> pack_free_controls(const LaunchControls& controls) const;
@@ -360,6 +525,9 @@ private:
     double eci_altitude(const Vec3& position) const;
 
     Vec3 earth_relative_velocity(const Vec3& position, const Vec3& velocity) const;
+
+    /** Speed of sound for the Cd(Mach) table; only called when it has a curve [m/s] */
+    double speed_of_sound(double altitude) const;
 };
 
 } // namespace sim
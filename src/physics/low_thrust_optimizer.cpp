@@ -0,0 +1,810 @@
+/**
+ * Low-Thrust Trajectory Optimizer Implementation
+ *
+ * Sims-Flanagan multiple shooting solved by SQP: banded KKT solve,
+ * active-set throttle bound, partitioned BFGS on the defects' curvature,
+ * l1-merit line search and energy-to-propellant continuation.
+ */
+
+#include "low_thrust_optimizer.hpp"
+#include "vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace sim {
+
+// -----------------------------------------------------------------
+// Constants
+// -----------------------------------------------------------------
+
+static constexpr double PI = 3.14159265358979323846;
+static constexpr int NX = 7;                           // Node state [r, v, m]
+static constexpr int NU = 3;                           // Throttle vector
+static constexpr double THROTTLE_SMOOTHING = 1e-4;     // |u| in the mass equation
+
+// -----------------------------------------------------------------
+// Kepler propagation (universal variables, Vallado Alg. 8)
+// -----------------------------------------------------------------
+
+static void stumpff(double psi, double& c2, double& c3) {
+    if (psi > 1e-6) {
+        double s = std::sqrt(psi);
+        c2 = (1.0 - std::cos(s)) / psi;
+        c3 = (s - std::sin(s)) / (s * psi);
+    } else if (psi < -1e-6) {
+        double s = std::sqrt(-psi);
+        c2 = (1.0 - std::cosh(s)) / psi;
+        c3 = (std::sinh(s) - s) / (s * -psi);
+    } else {
+        c2 = 0.5 - psi / 24.0 + psi * psi / 720.0;
+        c3 = 1.0 / 6.0 - psi / 120.0 + psi * psi / 5040.0;
+    }
+}
+
+bool LowThrustOptimizer::kepler_propagate(Vec3& position, Vec3& velocity, double dt, double mu) {
+    if (dt == 0.0) return true;
+
+    double r0 = position.norm();
+    double v0_sq = dot(velocity, velocity);
+    double rv = dot(position, velocity);
+    double sqrt_mu = std::sqrt(mu);
+    double alpha = 2.0 / r0 - v0_sq / mu;   // 1/a
+
+    // Initial universal anomaly
+    double chi;
+    if (alpha > 1e-12) {
+        chi = sqrt_mu * dt * alpha;
+    } else if (alpha < -1e-12) {
+        double a = 1.0 / alpha;
+        double sgn = dt > 0.0 ? 1.0 : -1.0;
+        double arg = (-2.0 * mu * alpha * dt) /
+                     (rv + sgn * std::sqrt(-mu * a) * (1.0 - r0 * alpha));
+        chi = (arg > 0.0) ? sgn * std::sqrt(-a) * std::log(arg) : sqrt_mu * dt / r0;
+    } else {
+        chi = sqrt_mu * dt / r0;
+    }
+
+    double c2 = 0.5, c3 = 1.0 / 6.0, psi = 0.0, r = r0;
+    bool converged = false;
+    for (int it = 0; it < 60; it++) {
+        psi = chi * chi * alpha;
+        stumpff(psi, c2, c3);
+        r = chi * chi * c2 + rv / sqrt_mu * chi * (1.0 - psi * c3) + r0 * (1.0 - psi * c2);
+        double f = chi * chi * chi * c3 + rv / sqrt_mu * chi * chi * c2 +
+                   r0 * chi * (1.0 - psi * c3) - sqrt_mu * dt;
+        double dchi = f / r;
+        chi -= dchi;
+        if (std::abs(dchi) <= 1e-14 * (1.0 + std::abs(chi))) {
+            converged = true;
+            break;
+        }
+    }
+
+    psi = chi * chi * alpha;
+    stumpff(psi, c2, c3);
+    r = chi * chi * c2 + rv / sqrt_mu * chi * (1.0 - psi * c3) + r0 * (1.0 - psi * c2);
+
+    double f = 1.0 - chi * chi * c2 / r0;
+    double g = dt - chi * chi * chi * c3 / sqrt_mu;
+    double gdot = 1.0 - chi * chi * c2 / r;
+    double fdot = sqrt_mu / (r * r0) * chi * (psi * c3 - 1.0);
+
+    Vec3 p = position * f + velocity * g;
+    Vec3 v = position * fdot + velocity * gdot;
+    position = p;
+    velocity = v;
+    return converged;
+}
+
+// -----------------------------------------------------------------
+// Banded LU (partial pivoting), the KKT solve
+// -----------------------------------------------------------------
+
+namespace {
+
+/**
+ * n x n matrix with kl sub- and ku super-diagonals, stored with kl extra
+ * super-diagonals for pivoting fill (LAPACK gbtrf layout, row-wise)
+ */
+class BandedMatrix {
+public:
+    BandedMatrix(int n, int kl, int ku)
+        : n_(n), kl_(kl), ku_(ku), width_(2 * kl + ku + 1),
+          data_(static_cast<size_t>(n) * width_, 0.0), pivot_(n, 0) {}
+
+    double& at(int i, int j) { return data_[static_cast<size_t>(i) * width_ + (j - i + kl_)]; }
+
+    /** Factor in place. @return false on a zero pivot */
+    bool factor() {
+        for (int k = 0; k < n_; k++) {
+            int last_row = std::min(n_ - 1, k + kl_);
+            int last_col = std::min(n_ - 1, k + kl_ + ku_);
+
+            int p = k;
+            double best = std::abs(at(k, k));
+            for (int i = k + 1; i <= last_row; i++) {
+                double a = std::abs(at(i, k));
+                if (a > best) { best = a; p = i; }
+            }
+            if (best == 0.0) return false;
+            pivot_[k] = p;
+            if (p != k) {
+                for (int j = k; j <= last_col; j++) std::swap(at(k, j), at(p, j));
+            }
+
+            double inv = 1.0 / at(k, k);
+            for (int i = k + 1; i <= last_row; i++) {
+                double l = at(i, k) * inv;
+                if (l == 0.0) continue;
+                at(i, k) = l;
+                for (int j = k + 1; j <= last_col; j++) at(i, j) -= l * at(k, j);
+            }
+        }
+        return true;
+    }
+
+    /** Solve in place after factor() */
+    void solve(std::vector<double>& b) {
+        for (int k = 0; k < n_; k++) {
+            if (pivot_[k] != k) std::swap(b[k], b[pivot_[k]]);
+            int last_row = std::min(n_ - 1, k + kl_);
+            for (int i = k + 1; i <= last_row; i++) b[i] -= at(i, k) * b[k];
+        }
+        for (int k = n_ - 1; k >= 0; k--) {
+            int last_col = std::min(n_ - 1, k + kl_ + ku_);
+            double s = b[k];
+            for (int j = k + 1; j <= last_col; j++) s -= at(k, j) * b[j];
+            b[k] = s / at(k, k);
+        }
+    }
+
+private:
+    int n_, kl_, ku_, width_;
+    std::vector<double> data_;
+    std::vector<int> pivot_;
+};
+
+// -----------------------------------------------------------------
+// Transcription (canonical units: length |r0|, mu = 1, mass m0)
+// -----------------------------------------------------------------
+
+struct Transcription {
+    int n;                  // Segments
+    double h;               // Segment duration
+    double thrust;          // Max thrust at 1 AU (or everywhere), canonical
+    double exhaust;         // Isp g0, canonical
+    bool solar_scaling;
+    double length_unit;     // [m]
+    double arrival[6];      // Fixed final r, v
+
+    // Unknowns: node states 1..n-1, final mass, throttles 0..n-1
+    std::vector<double> x;  // Node k at x[NX * k], k = 0..n (node 0 fixed)
+    std::vector<double> u;  // Segment k at u[NU * k]
+
+    double thrust_at(double r) const {
+        if (!solar_scaling) return thrust;
+        double r_au = r * length_unit / AU;
+        if (r_au < 0.1) r_au = 0.1;
+        return thrust / (r_au * r_au);
+    }
+
+    /** Segment map F(node, throttle) -> end state; dm_max receives the propellant at full throttle */
+    void propagate(const double* node, const double* throttle, double* out, double& dm_max) const {
+        Vec3 r(node[0], node[1], node[2]);
+        Vec3 v(node[3], node[4], node[5]);
+        double m = node[6];
+
+        LowThrustOptimizer::kepler_propagate(r, v, 0.5 * h, 1.0);
+
+        double t = thrust_at(r.norm());
+        double dv_max = t * h / m;
+        dm_max = t * h / exhaust;
+        double q = throttle[0] * throttle[0] + throttle[1] * throttle[1] + throttle[2] * throttle[2];
+        double s = std::sqrt(q + THROTTLE_SMOOTHING * THROTTLE_SMOOTHING) - THROTTLE_SMOOTHING;
+
+        v.x += dv_max * throttle[0];
+        v.y += dv_max * throttle[1];
+        v.z += dv_max * throttle[2];
+        m -= dm_max * s;
+
+        LowThrustOptimizer::kepler_propagate(r, v, 0.5 * h, 1.0);
+
+        out[0] = r.x; out[1] = r.y; out[2] = r.z;
+        out[3] = v.x; out[4] = v.y; out[5] = v.z;
+        out[6] = m;
+    }
+
+    /** Node the segment k defect compares against */
+    void next_node(int k, double* out) const {
+        if (k < n - 1) {
+            for (int i = 0; i < NX; i++) out[i] = x[NX * (k + 1) + i];
+        } else {
+            for (int i = 0; i < 6; i++) out[i] = arrival[i];
+            out[6] = x[NX * n + 6];
+        }
+    }
+};
+
+/// Per-segment evaluation: defect, weights and Jacobian blocks
+struct SegmentEval {
+    double c[NX];
+    double dm_max;
+    double jx[NX][NX];      // d(end) / d(node k), k > 0
+    double ju[NX][NU];      // d(end) / d(throttle k)
+};
+
+/// Throttle objective phi(u): (1 - tau) |u|^2 + tau (sqrt(|u|^2 + eps^2) - eps)
+struct ThrottleCost {
+    double tau;             // 0 = energy, 1 = smoothed |u| (propellant)
+    double eps;
+
+    double value(const double* u) const {
+        double q = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+        return (1.0 - tau) * q + tau * (std::sqrt(q + eps * eps) - eps);
+    }
+
+    void derivatives(const double* u, double g[NU], double H[NU][NU]) const {
+        double q = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+        double s = std::sqrt(q + eps * eps);
+        for (int i = 0; i < NU; i++) {
+            g[i] = (1.0 - tau) * 2.0 * u[i] + (tau > 0.0 ? tau * u[i] / s : 0.0);
+            for (int j = 0; j < NU; j++) {
+                double d = (i == j) ? 1.0 : 0.0;
+                H[i][j] = (1.0 - tau) * 2.0 * d +
+                          (tau > 0.0 ? tau * (d / s - u[i] * u[j] / (s * s * s)) : 0.0);
+            }
+        }
+    }
+};
+
+}  // namespace
+
+// -----------------------------------------------------------------
+// LowThrustOptimizer
+// -----------------------------------------------------------------
+
+LowThrustOptimizer::LowThrustOptimizer(const LowThrustOptimizerConfig& config)
+    : config_(config) {}
+
+LowThrustSolution LowThrustOptimizer::solve(const LowThrustTransferProblem& problem,
+                                            const LowThrustSolution* initial_guess) const {
+    LowThrustSolution sol;
+    const int n = std::max(1, config_.segments);
+
+    // --- Canonical units ---
+    const double L = problem.departure.position.norm();
+    const double T = std::sqrt(L * L * L / problem.mu);
+    const double V = L / T;
+    const double M = problem.engine.mass_initial;
+    if (!(L > 0.0) || !(problem.time_of_flight > 0.0) || !(M > 0.0)) {
+        sol.status = "Invalid problem";
+        return sol;
+    }
+
+    Transcription tr;
+    tr.n = n;
+    tr.h = problem.time_of_flight / T / n;
+    tr.thrust = problem.engine.thrust / (M * V / T);
+    tr.exhaust = problem.engine.isp * G0 / V;
+    tr.solar_scaling = problem.engine.solar_scaling;
+    tr.length_unit = L;
+    const Vec3 r1 = problem.arrival.position * (1.0 / L);
+    const Vec3 v1 = problem.arrival.velocity * (1.0 / V);
+    tr.arrival[0] = r1.x; tr.arrival[1] = r1.y; tr.arrival[2] = r1.z;
+    tr.arrival[3] = v1.x; tr.arrival[4] = v1.y; tr.arrival[5] = v1.z;
+
+    tr.x.assign(static_cast<size_t>(NX) * (n + 1), 0.0);
+    tr.u.assign(static_cast<size_t>(NU) * n, 0.0);
+
+    const Vec3 r0 = problem.departure.position * (1.0 / L);
+    const Vec3 v0 = problem.departure.velocity * (1.0 / V);
+
+    // --- Initial guess ---
+    bool warm = initial_guess && (int)initial_guess->nodes.size() == n + 1 &&
+                (int)initial_guess->masses.size() == n + 1 &&
+                (int)initial_guess->impulses.size() == n;
+    if (warm) {
+        for (int k = 0; k <= n; k++) {
+            const StateVector& s = initial_guess->nodes[k];
+            double* xk = &tr.x[NX * k];
+            xk[0] = s.position.x / L; xk[1] = s.position.y / L; xk[2] = s.position.z / L;
+            xk[3] = s.velocity.x / V; xk[4] = s.velocity.y / V; xk[5] = s.velocity.z / V;
+            xk[6] = initial_guess->masses[k] / M;
+        }
+    } else {
+        // Shape-based spiral: radius and orbit normal interpolated, in-plane
+        // angle following the local mean motion, stretched to the arrival
+        // angle plus whole revolutions
+        Vec3 h0 = normalized(cross(r0, v0));
+        Vec3 h1 = normalized(cross(r1, v1));
+        double ra = r0.norm(), rb = r1.norm();
+        Vec3 ref0 = normalized(r0);
+
+        auto plane_ref = [&](const Vec3& h) {
+            Vec3 p = ref0 - h * dot(ref0, h);
+            double pn = p.norm();
+            return pn > 1e-9 ? p * (1.0 / pn) : normalized(cross(h, Vec3(0, 0, 1)));
+        };
+        auto slerp = [&](double s) {
+            double c = std::max(-1.0, std::min(1.0, dot(h0, h1)));
+            double ang = std::acos(c);
+            if (ang < 1e-9) return h0;
+            return (h0 * std::sin((1.0 - s) * ang) + h1 * std::sin(s * ang)) *
+                   (1.0 / std::sin(ang));
+        };
+
+        Vec3 ref1 = plane_ref(h1);
+        double theta1 = std::atan2(dot(cross(h1, ref1), r1), dot(ref1, r1));
+        if (theta1 < 0.0) theta1 += 2.0 * PI;
+
+        // Mean-motion sweep of the interpolated radius, node by node
+        double tof = tr.h * n;
+        auto radius = [&](double s) { return ra + (rb - ra) * s; };
+        std::vector<double> sweep(n + 1, 0.0);
+        for (int k = 0; k < n; k++) {
+            double r = radius((k + 0.5) / n);
+            sweep[k + 1] = sweep[k] + tr.h / std::sqrt(r * r * r);
+        }
+        int revs = config_.revolutions;
+        if (revs < 0) {
+            revs = std::max(0, static_cast<int>(std::lround((sweep[n] - theta1) / (2.0 * PI))));
+        }
+        double scale = (theta1 + 2.0 * PI * revs) / sweep[n];
+
+        for (int k = 1; k < n; k++) {
+            double s = static_cast<double>(k) / n;
+            Vec3 hk = slerp(s);
+            Vec3 refk = plane_ref(hk);
+            double th = sweep[k] * scale;
+            double r = radius(s);
+            Vec3 dir = refk * std::cos(th) + cross(hk, refk) * std::sin(th);
+            Vec3 pos = dir * r;
+            Vec3 vel = cross(hk, dir) * (scale / std::sqrt(r)) + dir * ((rb - ra) / tof);
+            double* xk = &tr.x[NX * k];
+            xk[0] = pos.x; xk[1] = pos.y; xk[2] = pos.z;
+            xk[3] = vel.x; xk[4] = vel.y; xk[5] = vel.z;
+        }
+    }
+    tr.x[0] = r0.x; tr.x[1] = r0.y; tr.x[2] = r0.z;
+    tr.x[3] = v0.x; tr.x[4] = v0.y; tr.x[5] = v0.z;
+    tr.x[6] = 1.0;
+
+    // Throttle from the velocity jump between neighbouring half-arcs, masses forward
+    for (int k = 0; k < n; k++) {
+        double* xk = &tr.x[NX * k];
+        double next[NX];
+        if (k == n - 1) {
+            for (int i = 0; i < 6; i++) next[i] = tr.arrival[i];
+        } else {
+            for (int i = 0; i < 6; i++) next[i] = tr.x[NX * (k + 1) + i];
+        }
+        Vec3 pa(xk[0], xk[1], xk[2]), va(xk[3], xk[4], xk[5]);
+        Vec3 pb(next[0], next[1], next[2]), vb(next[3], next[4], next[5]);
+        kepler_propagate(pa, va, 0.5 * tr.h, 1.0);
+        kepler_propagate(pb, vb, -0.5 * tr.h, 1.0);
+
+        double t = tr.thrust_at(pa.norm());
+        double dv_max = t * tr.h / xk[6];
+        Vec3 du = (vb - va) * (1.0 / dv_max);
+        if (warm) {
+            const Vec3& imp = initial_guess->impulses[k];
+            du = imp * (1.0 / (V * dv_max));
+        }
+        double un = du.norm();
+        if (un > 1.0) du = du * (1.0 / un);
+        tr.u[NU * k] = du.x; tr.u[NU * k + 1] = du.y; tr.u[NU * k + 2] = du.z;
+
+        double end[NX], dm_max;
+        tr.propagate(xk, &tr.u[NU * k], end, dm_max);
+        if (!warm || k == n - 1) tr.x[NX * (k + 1) + 6] = end[6];
+    }
+
+    // --- Continuation: energy optimum, then |u| with shrinking smoothing ---
+    std::vector<ThrottleCost> stages;
+    stages.push_back({0.0, 0.0});
+    if (config_.objective == LowThrustObjective::MINIMUM_PROPELLANT) {
+        stages.push_back({1.0, 1e-1});
+        stages.push_back({1.0, 1e-2});
+        stages.push_back({1.0, 1e-3});
+    }
+
+    // --- KKT layout: per segment [x_k (k > 0), u_k, eta_k, lambda_k], then m_n.
+    // eta_k multiplies the throttle bound |u_k|^2 <= 1 while segment k is in
+    // the active set, and is a decoupled zero otherwise ---
+    std::vector<int> off(n + 1);
+    int dim = 0;
+    for (int k = 0; k < n; k++) {
+        off[k] = dim;
+        dim += (k > 0 ? NX : 0) + NU + 1 + NX;
+    }
+    off[n] = dim;
+    dim += 1;
+    auto xi = [&](int k) { return off[k]; };
+    auto ui = [&](int k) { return off[k] + (k > 0 ? NX : 0); };
+    auto ei = [&](int k) { return ui(k) + NU; };
+    auto li = [&](int k) { return ei(k) + 1; };
+    const int mi = off[n];
+    const int band = 2 * NX + NU + 1;      // Bounds |i - j| of every entry
+
+    std::unique_ptr<ThreadPool> pool;
+    if (config_.num_threads != 1 && n > 1) pool = std::make_unique<ThreadPool>(config_.num_threads);
+    auto for_segments = [&](const std::function<void(size_t)>& fn) {
+        if (pool) pool->parallel_for(static_cast<size_t>(n), fn);
+        else for (int k = 0; k < n; k++) fn(static_cast<size_t>(k));
+    };
+
+    std::vector<SegmentEval> ev(n);
+    auto evaluate_defects = [&](const Transcription& t, std::vector<SegmentEval>& out) {
+        for_segments([&](size_t kk) {
+            int k = static_cast<int>(kk);
+            double end[NX], next[NX];
+            t.propagate(&t.x[NX * k], &t.u[NU * k], end, out[k].dm_max);
+            t.next_node(k, next);
+            for (int i = 0; i < NX; i++) out[k].c[i] = end[i] - next[i];
+        });
+    };
+    auto max_defect = [&](const std::vector<SegmentEval>& e) {
+        double m = 0.0;
+        for (const auto& s : e) {
+            for (int i = 0; i < NX; i++) {
+                if (!std::isfinite(s.c[i])) return std::numeric_limits<double>::infinity();
+                m = std::max(m, std::abs(s.c[i]));
+            }
+        }
+        return m;
+    };
+    auto l1_defect = [&](const std::vector<SegmentEval>& e) {
+        double m = 0.0;
+        for (const auto& s : e) for (int i = 0; i < NX; i++) m += std::abs(s.c[i]);
+        return m;
+    };
+    auto objective = [&](const Transcription& t, const ThrottleCost& cost,
+                         const std::vector<SegmentEval>& weights) {
+        double f = 0.0;
+        for (int k = 0; k < n; k++) f += weights[k].dm_max * cost.value(&t.u[NU * k]);
+        return f;
+    };
+
+    // Partitioned quasi-Newton Hessian of the constraint term lambda^T c:
+    // one damped-BFGS block per segment over its own [x_k, u_k]
+    constexpr int NB = NX + NU;
+    std::vector<std::array<double, NB * NB>> hess(n);
+    for (auto& b : hess) {
+        b.fill(0.0);
+        for (int i = 0; i < NB; i++) b[i * NB + i] = 1e-6;
+    }
+    std::vector<SegmentEval> prev_ev;
+    std::vector<double> prev_x, prev_u, lambda(static_cast<size_t>(NX) * n, 0.0);
+    std::vector<char> active(n, 0);
+    std::vector<SegmentEval> trial_ev(n);
+
+    const double fd = config_.fd_step;
+    double nu = 1.0;            // Merit penalty
+    double prox = 1e-4;         // Proximal weight on every unknown (adaptive damping)
+    int iter = 0;
+    size_t stage_index = warm ? stages.size() - 1 : 0;   // A warm start skips the continuation
+    bool failed = false;
+
+    while (stage_index < stages.size() && iter < config_.max_iterations) {
+        const ThrottleCost& cost = stages[stage_index];
+
+        // Defects and Jacobian blocks (central differences, one segment each)
+        for_segments([&](size_t kk) {
+            int k = static_cast<int>(kk);
+            SegmentEval& e = ev[k];
+            double node[NX], thr[NU], plus[NX], minus[NX], next[NX], dm;
+            for (int i = 0; i < NX; i++) node[i] = tr.x[NX * k + i];
+            for (int i = 0; i < NU; i++) thr[i] = tr.u[NU * k + i];
+
+            double end[NX];
+            tr.propagate(node, thr, end, e.dm_max);
+            tr.next_node(k, next);
+            for (int i = 0; i < NX; i++) e.c[i] = end[i] - next[i];
+
+            if (k > 0) {
+                for (int j = 0; j < NX; j++) {
+                    double saved = node[j];
+                    node[j] = saved + fd; tr.propagate(node, thr, plus, dm);
+                    node[j] = saved - fd; tr.propagate(node, thr, minus, dm);
+                    node[j] = saved;
+                    for (int i = 0; i < NX; i++) e.jx[i][j] = (plus[i] - minus[i]) / (2.0 * fd);
+                }
+            }
+            for (int j = 0; j < NU; j++) {
+                double saved = thr[j];
+                thr[j] = saved + fd; tr.propagate(node, thr, plus, dm);
+                thr[j] = saved - fd; tr.propagate(node, thr, minus, dm);
+                thr[j] = saved;
+                for (int i = 0; i < NX; i++) e.ju[i][j] = (plus[i] - minus[i]) / (2.0 * fd);
+            }
+        });
+
+        // Damped BFGS: s = step of [x_k, u_k], y = change of J_k^T lambda_k
+        if (!prev_ev.empty()) {
+            for_segments([&](size_t kk) {
+                int k = static_cast<int>(kk);
+                double sv[NB], yv[NB], bs[NB];
+                for (int j = 0; j < NB; j++) {
+                    bool is_x = j < NX;
+                    if (is_x && k == 0) { sv[j] = 0.0; yv[j] = 0.0; continue; }
+                    sv[j] = is_x ? tr.x[NX * k + j] - prev_x[NX * k + j]
+                                 : tr.u[NU * k + j - NX] - prev_u[NU * k + j - NX];
+                    double y = 0.0;
+                    for (int r = 0; r < NX; r++) {
+                        double dj = is_x ? ev[k].jx[r][j] - prev_ev[k].jx[r][j]
+                                         : ev[k].ju[r][j - NX] - prev_ev[k].ju[r][j - NX];
+                        y += dj * lambda[NX * k + r];
+                    }
+                    yv[j] = y;
+                }
+                auto& B = hess[k];
+                double sbs = 0.0, sy = 0.0;
+                for (int i = 0; i < NB; i++) {
+                    bs[i] = 0.0;
+                    for (int j = 0; j < NB; j++) bs[i] += B[i * NB + j] * sv[j];
+                    sbs += sv[i] * bs[i];
+                    sy += sv[i] * yv[i];
+                }
+                if (!(sbs > 1e-300)) return;
+                if (sy < 0.2 * sbs) {   // Powell damping keeps B positive definite
+                    double theta = 0.8 * sbs / (sbs - sy);
+                    for (int i = 0; i < NB; i++) yv[i] = theta * yv[i] + (1.0 - theta) * bs[i];
+                    sy = 0.2 * sbs;
+                }
+                for (int i = 0; i < NB; i++) {
+                    for (int j = 0; j < NB; j++) {
+                        B[i * NB + j] += yv[i] * yv[j] / sy - bs[i] * bs[j] / sbs;
+                    }
+                }
+            });
+        }
+
+        // KKT system [H A^T; A 0] [dz; multipliers] = [-g; -constraints]
+        BandedMatrix K(dim, band, band);
+        std::vector<double> rhs(dim, 0.0);
+        auto assemble = [&]() {
+            K = BandedMatrix(dim, band, band);
+            std::fill(rhs.begin(), rhs.end(), 0.0);
+            for (int k = 0; k < n; k++) {
+                const SegmentEval& e = ev[k];
+                const double* u = &tr.u[NU * k];
+                const auto& B = hess[k];
+                double g[NU], H[NU][NU];
+                cost.derivatives(u, g, H);
+
+                if (k > 0) {
+                    for (int i = 0; i < NX; i++) {
+                        K.at(xi(k) + i, xi(k) + i) += prox;
+                        for (int j = 0; j < NX; j++) K.at(xi(k) + i, xi(k) + j) += B[i * NB + j];
+                        for (int j = 0; j < NU; j++) {
+                            K.at(xi(k) + i, ui(k) + j) += B[i * NB + NX + j];
+                            K.at(ui(k) + j, xi(k) + i) += B[(NX + j) * NB + i];
+                        }
+                    }
+                }
+                for (int i = 0; i < NU; i++) {
+                    rhs[ui(k) + i] = -e.dm_max * g[i];
+                    for (int j = 0; j < NU; j++) {
+                        K.at(ui(k) + i, ui(k) + j) += e.dm_max * H[i][j] + B[(NX + i) * NB + NX + j];
+                    }
+                    K.at(ui(k) + i, ui(k) + i) += prox;
+                }
+
+                // Throttle bound, linearized: 2 u . du = 1 - |u|^2
+                if (active[k]) {
+                    rhs[ei(k)] = 1.0 - (u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+                    for (int j = 0; j < NU; j++) {
+                        K.at(ei(k), ui(k) + j) = 2.0 * u[j];
+                        K.at(ui(k) + j, ei(k)) = 2.0 * u[j];
+                    }
+                } else {
+                    K.at(ei(k), ei(k)) = 1.0;
+                }
+
+                for (int r = 0; r < NX; r++) {
+                    int row = li(k) + r;
+                    rhs[row] = -e.c[r];
+                    if (k > 0) {
+                        for (int j = 0; j < NX; j++) {
+                            K.at(row, xi(k) + j) = e.jx[r][j];
+                            K.at(xi(k) + j, row) = e.jx[r][j];
+                        }
+                    }
+                    for (int j = 0; j < NU; j++) {
+                        K.at(row, ui(k) + j) = e.ju[r][j];
+                        K.at(ui(k) + j, row) = e.ju[r][j];
+                    }
+                    int next = (k < n - 1) ? xi(k + 1) + r : (r == 6 ? mi : -1);
+                    if (next >= 0) {
+                        K.at(row, next) = -1.0;
+                        K.at(next, row) = -1.0;
+                    }
+                }
+            }
+            K.at(mi, mi) += prox;
+        };
+
+        // Active set: add segments whose step leaves the unit ball, drop
+        // those whose bound multiplier turns negative, and re-solve
+        bool singular = false;
+        for (int pass = 0; pass < 20; pass++) {
+            assemble();
+            if (!K.factor()) { singular = true; break; }
+            K.solve(rhs);
+
+            bool changed = false;
+            for (int k = 0; k < n; k++) {
+                const double* u = &tr.u[NU * k];
+                const double* d = &rhs[ui(k)];
+                if (active[k]) {
+                    if (rhs[ei(k)] < 0.0) { active[k] = 0; changed = true; }
+                } else {
+                    double q0 = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+                    double q1 = 0.0;
+                    for (int i = 0; i < NU; i++) q1 += (u[i] + d[i]) * (u[i] + d[i]);
+                    if (q1 > 1.0 + 1e-9 && q0 > 0.25) { active[k] = 1; changed = true; }
+                }
+            }
+            if (!changed) break;
+        }
+        if (singular) {
+            sol.status = "Singular KKT system";
+            failed = true;
+            break;
+        }
+
+        // Merit: f + nu |c|_1; nu dominates the multipliers
+        double lambda_max = 0.0;
+        for (int k = 0; k < n; k++) {
+            for (int r = 0; r < NX; r++) {
+                lambda[NX * k + r] = rhs[li(k) + r];
+                lambda_max = std::max(lambda_max, std::abs(rhs[li(k) + r]));
+            }
+        }
+        nu = std::max(nu, 1.1 * lambda_max);
+
+        const double f0 = objective(tr, cost, ev);
+        const double c0 = l1_defect(ev);
+        double slope = -nu * c0;
+        double du_max = 0.0;
+        for (int k = 0; k < n; k++) {
+            double g[NU], H[NU][NU];
+            cost.derivatives(&tr.u[NU * k], g, H);
+            for (int i = 0; i < NU; i++) {
+                slope += ev[k].dm_max * g[i] * rhs[ui(k) + i];
+                du_max = std::max(du_max, std::abs(rhs[ui(k) + i]));
+            }
+        }
+
+        // Backtracking line search on the merit, throttles projected back
+        // into the unit ball, with one second-order correction of the full
+        // step (the defects' curvature along a long spiral otherwise rejects
+        // good steps near the solution)
+        Transcription trial = tr;
+        const double phi0 = f0 + nu * c0;
+        auto try_step = [&](double alpha, const std::vector<double>* correction) {
+            for (int k = 0; k < n; k++) {
+                if (k > 0) {
+                    for (int i = 0; i < NX; i++) {
+                        double d = alpha * rhs[xi(k) + i] + (correction ? (*correction)[xi(k) + i] : 0.0);
+                        trial.x[NX * k + i] = tr.x[NX * k + i] + d;
+                    }
+                }
+                double q = 0.0;
+                for (int i = 0; i < NU; i++) {
+                    double d = alpha * rhs[ui(k) + i] + (correction ? (*correction)[ui(k) + i] : 0.0);
+                    trial.u[NU * k + i] = tr.u[NU * k + i] + d;
+                    q += trial.u[NU * k + i] * trial.u[NU * k + i];
+                }
+                if (q > 1.0) {
+                    double s = 1.0 / std::sqrt(q);
+                    for (int i = 0; i < NU; i++) trial.u[NU * k + i] *= s;
+                }
+            }
+            trial.x[NX * n + 6] = tr.x[NX * n + 6] + alpha * rhs[mi] +
+                                  (correction ? (*correction)[mi] : 0.0);
+            evaluate_defects(trial, trial_ev);
+            double phi = objective(trial, cost, ev) + nu * l1_defect(trial_ev);
+            double noise = 1e-13 * (std::abs(phi0) + 1.0);
+            return std::isfinite(phi) && phi <= phi0 + 1e-4 * alpha * std::min(slope, 0.0) + noise;
+        };
+
+        double alpha = 1.0;
+        bool accepted = try_step(alpha, nullptr);
+        if (!accepted) {
+            std::vector<double> correction(dim, 0.0);
+            for (int k = 0; k < n; k++) {
+                for (int r = 0; r < NX; r++) correction[li(k) + r] = -trial_ev[k].c[r];
+            }
+            K.solve(correction);
+            accepted = try_step(alpha, &correction);
+        }
+        while (!accepted && alpha > 1e-10) {
+            alpha *= 0.5;
+            accepted = try_step(alpha, nullptr);
+        }
+        iter++;
+        prox = (accepted && alpha == 1.0) ? std::max(1e-12, 0.25 * prox) : std::min(1e6, 4.0 * prox);
+
+        if (!accepted) {
+            // No descent left: the stage is done if it is feasible
+            if (max_defect(ev) <= config_.feasibility_tol) {
+                stage_index++;
+                continue;
+            }
+            sol.status = "Line search failed";
+            failed = true;
+            break;
+        }
+
+        prev_ev = ev;
+        prev_x = tr.x;
+        prev_u = tr.u;
+        tr.x.swap(trial.x);
+        tr.u.swap(trial.u);
+        double defect = max_defect(trial_ev);
+
+        if (config_.verbose) {
+            int saturated = 0;
+            for (char a : active) saturated += a;
+            std::cout << "  LT iter " << std::setw(3) << iter << " stage " << stage_index
+                      << "  defect=" << std::scientific << std::setprecision(3) << defect
+                      << "  |du|=" << alpha * du_max << "  alpha=" << std::defaultfloat
+                      << alpha << "  active=" << saturated << "  m_f="
+                      << std::setprecision(6) << tr.x[NX * n + 6] * M << " kg" << std::endl;
+        }
+
+        if (defect <= config_.feasibility_tol && alpha * du_max <= config_.optimality_tol) {
+            stage_index++;
+        }
+    }
+
+    // --- Result (SI) ---
+    evaluate_defects(tr, ev);
+    sol.iterations = iter;
+    sol.max_defect = max_defect(ev);
+    sol.converged = !failed && stage_index >= stages.size() &&
+                    sol.max_defect <= config_.feasibility_tol;
+    if (sol.status.empty()) {
+        sol.status = sol.converged ? "Converged" : "Max iterations";
+    }
+
+    sol.nodes.resize(n + 1);
+    sol.masses.resize(n + 1);
+    for (int k = 0; k <= n; k++) {
+        double node[NX];
+        if (k == n) tr.next_node(n - 1, node);
+        else for (int i = 0; i < NX; i++) node[i] = tr.x[NX * k + i];
+        StateVector& s = sol.nodes[k];
+        s.position = Vec3(node[0], node[1], node[2]) * L;
+        s.velocity = Vec3(node[3], node[4], node[5]) * V;
+        s.time = problem.departure.time + k * tr.h * T;
+        s.frame = problem.departure.frame;
+        sol.masses[k] = node[6] * M;
+    }
+
+    sol.impulses.resize(n);
+    sol.throttle.resize(n);
+    for (int k = 0; k < n; k++) {
+        Vec3 r(tr.x[NX * k], tr.x[NX * k + 1], tr.x[NX * k + 2]);
+        Vec3 v(tr.x[NX * k + 3], tr.x[NX * k + 4], tr.x[NX * k + 5]);
+        kepler_propagate(r, v, 0.5 * tr.h, 1.0);
+        double dv_max = tr.thrust_at(r.norm()) * tr.h / tr.x[NX * k + 6];
+        Vec3 u(tr.u[NU * k], tr.u[NU * k + 1], tr.u[NU * k + 2]);
+        sol.impulses[k] = u * (dv_max * V);
+        sol.throttle[k] = u.norm();
+        sol.delta_v += sol.impulses[k].norm();
+    }
+    sol.final_mass = sol.masses[n];
+    sol.propellant_mass = M - sol.final_mass;
+    return sol;
+}
+
+}  // namespace sim
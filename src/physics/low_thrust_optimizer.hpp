@@ -0,0 +1,122 @@
+/**
+ * Low-Thrust Trajectory Optimizer (Sims-Flanagan transcription)
+ *
+ * Designs fixed-time low-thrust transfers between two states about one
+ * central body, in place of hand-tuned loops of
+ * LowThrustPropagator::propagate_segment calls.
+ *
+ * The flight time is cut into N equal segments. Each segment is a Kepler
+ * arc with one impulse at its midpoint, bounded by what the engine can
+ * deliver over the segment: |dv_k| <= T(r_k) dt / m_k, propellant
+ * T(r_k) dt / (Isp g0) per unit throttle (Sims & Flanagan, AAS 99-338).
+ * Thrust scales as 1/r^2 in AU when LowThrustConfig::solar_scaling is set
+ * (heliocentric problems).
+ *
+ * Transcription is multiple shooting: the state [r, v, m] at every node
+ * and a throttle vector u_k (|u_k| <= 1) per segment are the unknowns,
+ * and each segment contributes a 7-element defect between its propagated
+ * end state and the next node. A segment's defect depends only on its
+ * own node and control, so the Jacobian is block-bidiagonal. Blocks are
+ * central finite differences of one segment, computed for all segments in
+ * parallel. Each SQP iteration solves the KKT system as one banded LU
+ * (bandwidth 17, independent of N), so an iteration costs O(N). The
+ * curvature of the defects enters through one damped-BFGS block per
+ * segment; saturated segments hold |u_k| = 1 through an active set.
+ *
+ * Objectives: minimum energy (sum of dm_k |u_k|^2), or minimum propellant
+ * (sum of dm_k |u_k|), reached by continuation from the energy optimum
+ * through a smoothed |u|. Converged means every stage of the
+ * continuation met feasibility_tol; a problem the engine cannot fly in
+ * time_of_flight ends in "Line search failed" with the defects left.
+ *
+ * Usage:
+ *   LowThrustTransferProblem p;
+ *   p.departure = leo; p.arrival = geo; p.time_of_flight = 30 * 86400.0;
+ *   p.mu = OrbitalMechanics::MU_EARTH; p.engine = LowThrustConfig::hall_thruster();
+ *   p.engine.solar_scaling = false;
+ *   LowThrustOptimizerConfig cfg; cfg.segments = 200;
+ *   LowThrustSolution s = LowThrustOptimizer(cfg).solve(p);
+ */
+
+#ifndef SIM_LOW_THRUST_OPTIMIZER_HPP
+#define SIM_LOW_THRUST_OPTIMIZER_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/low_thrust.hpp"
+#include "physics/orbital_elements.hpp"
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Fixed-time transfer between two states relative to the central body
+ */
+struct LowThrustTransferProblem {
+    StateVector departure;              // Position / velocity at t = 0 [m, m/s]
+    StateVector arrival;                // Required position / velocity at time_of_flight
+    double time_of_flight = 0.0;        // [s]
+    double mu = OrbitalMechanics::MU_EARTH;
+    LowThrustConfig engine = LowThrustConfig::hall_thruster();   // mass_initial = wet mass
+};
+
+enum class LowThrustObjective {
+    MINIMUM_ENERGY,        // Smooth: sum dm_k |u_k|^2
+    MINIMUM_PROPELLANT     // Sum dm_k |u_k| (bang-bang throttle)
+};
+
+struct LowThrustOptimizerConfig {
+    int segments = 40;
+    LowThrustObjective objective = LowThrustObjective::MINIMUM_PROPELLANT;
+    int max_iterations = 300;           // SQP iterations over the whole continuation
+    double feasibility_tol = 1e-9;      // Max defect, canonical units (length |r0|, mass m0)
+    double optimality_tol = 1e-6;       // Max throttle change of a converged step
+    double fd_step = 1e-6;              // Central-difference step, canonical units
+    int revolutions = -1;               // Initial guess revolutions (-1 = from mean motion)
+    int num_threads = 0;                // Segment evaluation (0 = hardware, 1 = serial)
+    bool verbose = false;
+};
+
+struct LowThrustSolution {
+    bool converged = false;
+    int iterations = 0;
+    double max_defect = 0.0;            // Canonical units
+    std::string status;
+
+    double final_mass = 0.0;            // [kg]
+    double propellant_mass = 0.0;       // [kg]
+    double delta_v = 0.0;               // Sum of segment impulses [m/s]
+
+    std::vector<StateVector> nodes;     // N + 1 node states (time from departure)
+    std::vector<double> masses;         // N + 1 node masses [kg]
+    std::vector<Vec3> impulses;         // Per segment dv at the midpoint [m/s]
+    std::vector<double> throttle;       // Per segment |u| in [0, 1]
+};
+
+class LowThrustOptimizer {
+public:
+    explicit LowThrustOptimizer(const LowThrustOptimizerConfig& config = LowThrustOptimizerConfig());
+
+    /**
+     * Solve the transfer.
+     * @param initial_guess Previous solution of the same segment count to
+     *                      start from (nodes, masses, impulses); otherwise
+     *                      a shape-based spiral guess is used. A warm
+     *                      start solves the final objective directly
+     */
+    LowThrustSolution solve(const LowThrustTransferProblem& problem,
+                            const LowThrustSolution* initial_guess = nullptr) const;
+
+    /**
+     * Two-body propagation by universal variables (elliptic and hyperbolic)
+     * @return false if Kepler's equation did not converge
+     */
+    static bool kepler_propagate(Vec3& position, Vec3& velocity, double dt, double mu);
+
+private:
+    LowThrustOptimizerConfig config_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_LOW_THRUST_OPTIMIZER_HPP
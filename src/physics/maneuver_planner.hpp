@@ -81,12 +81,15 @@ public:
      * @param tof Time of flight [s]
      * @param mu Gravitational parameter
      * @param prograde True for prograde transfer
+     * @param x_warm If non-null, the Izzo iteration variable x to start from
+     *               (e.g. a neighboring solution's); receives the converged x
      * @return Lambert solution
      */
     static LambertSolution solve_lambert(const Vec3& r1, const Vec3& r2,
                                          double tof,
                                          double mu = OrbitalMechanics::MU_EARTH,
-                                         bool prograde = true);
+                                         bool prograde = true,
+                                         double* x_warm = nullptr);
 
     /**
      * @brief Plan rendezvous from chaser to target
@@ -0,0 +1,292 @@
+/**
+ * Mean Element Propagator Implementation
+ */
+
+#include "physics/mean_element_propagator.hpp"
+#include "physics/gravity_utils.hpp"
+#include "physics/kepler_solver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+
+namespace {
+
+constexpr double TWO_PI = kepler::TWO_PI;
+
+bool elliptic(const EquinoctialElements& e) {
+    return e.a > 0.0 && e.eccentricity() < 1.0 && std::isfinite(e.lambda) &&
+           std::isfinite(e.p) && std::isfinite(e.q);
+}
+
+double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+// Equinoctial frame f, g from the node vector
+void equinoctial_frame(double p, double q, Vec3& f, Vec3& g) {
+    const double s = 1.0 / (1.0 + p * p + q * q);
+    f = Vec3((1.0 - p * p + q * q) * s, 2.0 * p * q * s, -2.0 * p * s);
+    g = Vec3(2.0 * p * q * s, (1.0 + p * p - q * q) * s, 2.0 * q * s);
+}
+
+// Element vector (a, h, k, p, q, λ)
+std::array<double, 6> as_array(const EquinoctialElements& e) {
+    return {e.a, e.h, e.k, e.p, e.q, e.lambda};
+}
+
+EquinoctialElements from_array(const std::array<double, 6>& y) {
+    EquinoctialElements e;
+    e.a = y[0];
+    e.h = y[1];
+    e.k = y[2];
+    e.p = y[3];
+    e.q = y[4];
+    e.lambda = y[5];
+    return e;
+}
+
+} // namespace
+
+double EquinoctialElements::eccentricity() const { return std::sqrt(h * h + k * k); }
+
+double EquinoctialElements::inclination() const {
+    return 2.0 * std::atan(std::sqrt(p * p + q * q));
+}
+
+EquinoctialElements EquinoctialElements::from_state(const Vec3& r, const Vec3& v, double mu) {
+    EquinoctialElements e;
+    const double rn = r.norm();
+    e.a = 1.0 / (2.0 / rn - dot(v, v) / mu);
+
+    const Vec3 hv = cross(r, v);
+    const double hn = hv.norm();
+    const Vec3 w(hv.x / hn, hv.y / hn, hv.z / hn);
+    e.p = w.x / (1.0 + w.z);
+    e.q = -w.y / (1.0 + w.z);
+
+    Vec3 f, g;
+    equinoctial_frame(e.p, e.q, f, g);
+    const Vec3 vxh = cross(v, hv);
+    const Vec3 ecc(vxh.x / mu - r.x / rn, vxh.y / mu - r.y / rn, vxh.z / mu - r.z / rn);
+    e.k = dot(ecc, f);
+    e.h = dot(ecc, g);
+
+    // Eccentric longitude F from the in-plane coordinates
+    const double x1 = dot(r, f), y1 = dot(r, g);
+    const double root = std::sqrt(1.0 - e.h * e.h - e.k * e.k);
+    const double beta = 1.0 / (1.0 + root);
+    const double hk = e.h * e.k * beta;
+    const double cos_f = e.k + ((1.0 - e.k * e.k * beta) * x1 - hk * y1) / (e.a * root);
+    const double sin_f = e.h + ((1.0 - e.h * e.h * beta) * y1 - hk * x1) / (e.a * root);
+    const double big_f = std::atan2(sin_f, cos_f);
+    e.lambda = std::remainder(big_f + e.h * std::cos(big_f) - e.k * std::sin(big_f), TWO_PI);
+    return e;
+}
+
+void EquinoctialElements::to_state(double mu, Vec3& r, Vec3& v) const {
+    // λ = F + h cos F - k sin F is Kepler's equation in E = F - ϖ
+    const double e = eccentricity();
+    const double varpi = std::atan2(h, k);
+    double sin_e, cos_e;
+    const double ecc_anomaly = kepler::eccentric_anomaly(lambda - varpi, e, sin_e, cos_e);
+    const double big_f = ecc_anomaly + varpi;
+    const double sf = std::sin(big_f), cf = std::cos(big_f);
+
+    const double beta = 1.0 / (1.0 + std::sqrt(1.0 - h * h - k * k));
+    const double hk = h * k * beta;
+    const double x1 = a * ((1.0 - h * h * beta) * cf + hk * sf - k);
+    const double y1 = a * ((1.0 - k * k * beta) * sf + hk * cf - h);
+
+    const double n = std::sqrt(mu / (a * a * a));
+    const double rn = a * (1.0 - k * cf - h * sf);
+    const double c = n * a * a / rn;
+    const double vx1 = c * (hk * cf - (1.0 - h * h * beta) * sf);
+    const double vy1 = c * ((1.0 - k * k * beta) * cf - hk * sf);
+
+    Vec3 f, g;
+    equinoctial_frame(p, q, f, g);
+    r = Vec3(x1 * f.x + y1 * g.x, x1 * f.y + y1 * g.y, x1 * f.z + y1 * g.z);
+    v = Vec3(vx1 * f.x + vy1 * g.x, vx1 * f.y + vy1 * g.y, vx1 * f.z + vy1 * g.z);
+}
+
+MeanElementPropagator::MeanElementPropagator(const StateVector& initial,
+                                             const PerturbationConfig& perturbations,
+                                             double epoch_jd,
+                                             const MeanElementConfig& config)
+    : perturbations_(perturbations),
+      accel_(OrbitalPerturbations::acceleration_kernel(perturbations)),
+      config_(config), epoch_jd_(epoch_jd),
+      mu_(gravity::BodyConstants::EARTH.mu), template_(initial), t_(initial.time) {
+    if (config_.quadrature_nodes < 8 || config_.quadrature_nodes % 2 != 0) {
+        throw std::invalid_argument(
+            "MeanElementPropagator: quadrature_nodes must be even and >= 8");
+    }
+    EquinoctialElements osc = EquinoctialElements::from_state(initial.position,
+                                                              initial.velocity, mu_);
+    if (!elliptic(osc)) {
+        throw std::invalid_argument("MeanElementPropagator: orbit is not elliptic");
+    }
+    mean_ = config_.short_periodics ? to_mean(osc, t_) : osc;
+    if (!elliptic(mean_)) {
+        throw std::invalid_argument(
+            "MeanElementPropagator: no mean elements (perturbations too strong to average)");
+    }
+}
+
+MeanElementPropagator::Rates MeanElementPropagator::osculating_rates(
+    const Vec3& r, const Vec3& v, double t) const {
+    rhs_calls_++;
+    const Vec3 total = accel_(r, v, perturbations_, epoch_jd_ + t / 86400.0);
+    const Vec3 central = gravity::two_body_acceleration(r, mu_);
+    const Vec3 ap(total.x - central.x, total.y - central.y, total.z - central.z);
+    const double an = ap.norm();
+    if (!(an > 0.0)) return Rates{};
+
+    // (∂E/∂v)·a_p by central difference along a_p, a 1e-6 relative change in v
+    const double eps = 1e-6 * v.norm() / an;
+    const Vec3 dv(eps * ap.x, eps * ap.y, eps * ap.z);
+    const Rates up = as_array(EquinoctialElements::from_state(
+        r, Vec3(v.x + dv.x, v.y + dv.y, v.z + dv.z), mu_));
+    const Rates down = as_array(EquinoctialElements::from_state(
+        r, Vec3(v.x - dv.x, v.y - dv.y, v.z - dv.z), mu_));
+    Rates out;
+    for (int i = 0; i < 5; i++) out[i] = (up[i] - down[i]) / (2.0 * eps);
+    out[5] = std::remainder(up[5] - down[5], TWO_PI) / (2.0 * eps);
+    return out;
+}
+
+MeanElementPropagator::Rates MeanElementPropagator::node_rates(
+    const EquinoctialElements& m, double t, std::vector<Rates>& nodes) const {
+    const int count = config_.quadrature_nodes;
+    nodes.resize(count);
+    Rates mean{};
+    EquinoctialElements node = m;
+    for (int j = 0; j < count; j++) {
+        node.lambda = m.lambda + TWO_PI * j / count;
+        Vec3 r, v;
+        node.to_state(mu_, r, v);
+        nodes[j] = osculating_rates(r, v, t);
+        for (int i = 0; i < 6; i++) mean[i] += nodes[j][i];
+    }
+    for (int i = 0; i < 6; i++) mean[i] /= count;
+    return mean;
+}
+
+MeanElementPropagator::Rates MeanElementPropagator::mean_rates(
+    const EquinoctialElements& m, double t) const {
+    std::vector<Rates> nodes;
+    Rates rates = node_rates(m, t, nodes);
+    rates[5] += std::sqrt(mu_ / (m.a * m.a * m.a));
+    return rates;
+}
+
+MeanElementPropagator::Rates MeanElementPropagator::short_periodics(
+    const EquinoctialElements& m, double t) const {
+    std::vector<Rates> nodes;
+    const Rates mean = node_rates(m, t, nodes);
+    const int count = static_cast<int>(nodes.size());
+    const double n = std::sqrt(mu_ / (m.a * m.a * m.a));
+
+    // Fourier coefficients A_k, B_k of each rate's periodic part; at θ = 0
+    // its integral over θ / n is -Σ B_k / (k n). λ adds the integral of
+    // -(3 n / 2a) η_a, which at θ = 0 is (3 / 2a n) Σ A_k(a) / k²
+    Rates eta{};
+    double lambda_from_a = 0.0;
+    for (int harmonic = 1; harmonic < count / 2; harmonic++) {
+        Rates a_coef{}, b_coef{};
+        for (int j = 0; j < count; j++) {
+            const double angle = TWO_PI * harmonic * j / count;
+            const double c = std::cos(angle), s = std::sin(angle);
+            for (int i = 0; i < 6; i++) {
+                const double periodic = nodes[j][i] - mean[i];
+                a_coef[i] += periodic * c;
+                b_coef[i] += periodic * s;
+            }
+        }
+        for (int i = 0; i < 6; i++) {
+            eta[i] -= 2.0 / count * b_coef[i] / (harmonic * n);
+        }
+        lambda_from_a += 2.0 / count * a_coef[0] / (double(harmonic) * harmonic);
+    }
+    eta[5] += 1.5 / (m.a * n) * lambda_from_a;
+    return eta;
+}
+
+EquinoctialElements MeanElementPropagator::to_mean(const EquinoctialElements& osc,
+                                                   double t) const {
+    const Rates target = as_array(osc);
+    Rates y = target;
+    for (int it = 0; it < config_.mean_iterations; it++) {
+        const Rates eta = short_periodics(from_array(y), t);
+        for (int i = 0; i < 6; i++) y[i] = target[i] - eta[i];
+    }
+    EquinoctialElements m = from_array(y);
+    m.lambda = std::remainder(m.lambda, TWO_PI);
+    return m;
+}
+
+EquinoctialElements MeanElementPropagator::osculating_elements() const {
+    if (!config_.short_periodics) return mean_;
+    const Rates eta = short_periodics(mean_, t_);
+    Rates y = as_array(mean_);
+    for (int i = 0; i < 6; i++) y[i] += eta[i];
+    EquinoctialElements osc = from_array(y);
+    osc.lambda = std::remainder(osc.lambda, TWO_PI);
+    return osc;
+}
+
+StateVector MeanElementPropagator::state() const {
+    StateVector out = template_;
+    osculating_elements().to_state(mu_, out.position, out.velocity);
+    out.time = t_;
+    return out;
+}
+
+StateVector MeanElementPropagator::mean_state() const {
+    StateVector out = template_;
+    mean_.to_state(mu_, out.position, out.velocity);
+    out.time = t_;
+    return out;
+}
+
+StateVector MeanElementPropagator::propagate(double duration) {
+    const double t_end = t_ + duration;
+    auto rates = [&](double t, const Rates& y) { return mean_rates(from_array(y), t); };
+
+    // RK4 on (a, h, k, p, q, λ); λ runs unwrapped within a step
+    while (t_ < t_end) {
+        const double dt = std::min(config_.step, t_end - t_);
+        if (dt < 1e-9) break;
+        const Rates y = as_array(mean_);
+        auto add = [&](const Rates& k, double s) {
+            Rates out;
+            for (int i = 0; i < 6; i++) out[i] = y[i] + s * k[i];
+            return out;
+        };
+        const Rates k1 = rates(t_, y);
+        const Rates k2 = rates(t_ + 0.5 * dt, add(k1, 0.5 * dt));
+        const Rates k3 = rates(t_ + 0.5 * dt, add(k2, 0.5 * dt));
+        const Rates k4 = rates(t_ + dt, add(k3, dt));
+        Rates next;
+        for (int i = 0; i < 6; i++) {
+            next[i] = y[i] + dt / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+        EquinoctialElements m = from_array(next);
+        if (!elliptic(m)) {
+            throw std::runtime_error("MeanElementPropagator: mean elements not elliptic at t=" +
+                                     std::to_string(t_ + dt) + " s (decayed, or step too long)");
+        }
+        m.lambda = std::remainder(m.lambda, TWO_PI);
+        mean_ = m;
+        t_ += dt;
+        steps_++;
+    }
+    return state();
+}
+
+}  // namespace sim
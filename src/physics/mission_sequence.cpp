@@ -10,10 +10,13 @@
 #include "gravity_assist.hpp"
 #include "planetary_ephemeris.hpp"
 #include "celestial_body.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "utils/thread_pool.hpp"
 #include <cmath>
 #include <fstream>
 #include <algorithm>
 #include <limits>
+#include <random>
 
 namespace sim {
 
@@ -264,6 +267,135 @@ MissionSequence MissionDesigner::optimize_dates(
     return build_mission(bodies, dates);
 }
 
+// ─────────────────────────────────────────────────────────────
+// Global date optimizer (differential evolution + local polish)
+// ─────────────────────────────────────────────────────────────
+
+MissionSequence MissionDesigner::optimize_dates_global(
+    const std::vector<Planet>& bodies,
+    const std::vector<double>& initial_dates_jd,
+    const TourOptimizerConfig& config)
+{
+    const size_t n = initial_dates_jd.size();
+    if (bodies.size() < 2 || bodies.size() != n) {
+        return build_mission(bodies, initial_dates_jd);
+    }
+
+    std::vector<size_t> free_idx;
+    for (size_t i = 0; i < n; i++) {
+        if (config.free_endpoints || (i > 0 && i + 1 < n)) free_idx.push_back(i);
+    }
+    if (free_idx.empty()) {
+        return build_mission(bodies, initial_dates_jd);
+    }
+
+    const size_t dim = free_idx.size();
+    const int pop = config.population > 0 ?
+        std::max(config.population, 4) : std::max(20, 10 * static_cast<int>(dim));
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<double> lo(dim), hi(dim);
+    for (size_t k = 0; k < dim; k++) {
+        lo[k] = initial_dates_jd[free_idx[k]] - config.epoch_window;
+        hi[k] = initial_dates_jd[free_idx[k]] + config.epoch_window;
+    }
+
+    auto to_dates = [&](const std::vector<double>& x) {
+        std::vector<double> dates = initial_dates_jd;
+        for (size_t k = 0; k < dim; k++) dates[free_idx[k]] = x[k];
+        return dates;
+    };
+    auto cost = [&](const std::vector<double>& x) {
+        std::vector<double> dates = to_dates(x);
+        for (size_t i = 1; i < n; i++) {
+            if (dates[i] - dates[i - 1] < config.min_leg_days) return inf;
+        }
+        return compute_total_dv(bodies, dates);
+    };
+
+    // All random draws happen on this thread, so results do not depend
+    // on the thread count
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> pick(0, pop - 1);
+    std::uniform_int_distribution<size_t> pick_dim(0, dim - 1);
+
+    std::vector<std::vector<double>> members(pop, std::vector<double>(dim));
+    std::vector<std::vector<double>> trials(pop, std::vector<double>(dim));
+    std::vector<double> f(pop), f_trial(pop);
+
+    for (size_t k = 0; k < dim; k++) members[0][k] = initial_dates_jd[free_idx[k]];
+    for (int i = 1; i < pop; i++) {
+        for (size_t k = 0; k < dim; k++) members[i][k] = lo[k] + (hi[k] - lo[k]) * unit(rng);
+    }
+
+    ThreadPool pool(config.num_threads);
+    pool.parallel_for(static_cast<size_t>(pop), [&](size_t i) { f[i] = cost(members[i]); });
+
+    for (int gen = 0; gen < config.generations; gen++) {
+        for (int i = 0; i < pop; i++) {
+            int r1, r2, r3;
+            do { r1 = pick(rng); } while (r1 == i);
+            do { r2 = pick(rng); } while (r2 == i || r2 == r1);
+            do { r3 = pick(rng); } while (r3 == i || r3 == r1 || r3 == r2);
+            size_t forced = pick_dim(rng);
+
+            for (size_t k = 0; k < dim; k++) {
+                double v = members[i][k];
+                if (k == forced || unit(rng) < config.crossover) {
+                    v = members[r1][k] +
+                        config.differential_weight * (members[r2][k] - members[r3][k]);
+                    // Out of bounds: halfway between the parent and the bound
+                    if (v < lo[k]) v = 0.5 * (lo[k] + members[i][k]);
+                    if (v > hi[k]) v = 0.5 * (hi[k] + members[i][k]);
+                }
+                trials[i][k] = v;
+            }
+        }
+
+        pool.parallel_for(static_cast<size_t>(pop), [&](size_t i) { f_trial[i] = cost(trials[i]); });
+
+        for (int i = 0; i < pop; i++) {
+            if (f_trial[i] <= f[i]) {
+                members[i].swap(trials[i]);
+                f[i] = f_trial[i];
+            }
+        }
+    }
+
+    // Polish the best distinct members with the coordinate-descent search
+    std::vector<int> order(pop);
+    for (int i = 0; i < pop; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return f[a] < f[b] || (f[a] == f[b] && a < b);
+    });
+
+    std::vector<std::vector<double>> seeds;
+    for (int i : order) {
+        if ((int)seeds.size() >= std::max(1, config.polish_candidates)) break;
+        if (!std::isfinite(f[i])) break;
+        std::vector<double> dates = to_dates(members[i]);
+        if (std::find(seeds.begin(), seeds.end(), dates) == seeds.end()) seeds.push_back(dates);
+    }
+
+    std::vector<double> polished_dv(seeds.size());
+    pool.parallel_for(seeds.size(), [&](size_t s) {
+        if (bodies.size() >= 3) seeds[s] = optimize_dates(bodies, seeds[s]).epoch_jd;
+        polished_dv[s] = compute_total_dv(bodies, seeds[s]);
+    });
+
+    std::vector<double> best_dates = initial_dates_jd;
+    double best_dv = compute_total_dv(bodies, initial_dates_jd);
+    for (size_t s = 0; s < seeds.size(); s++) {
+        if (polished_dv[s] < best_dv) {
+            best_dv = polished_dv[s];
+            best_dates = seeds[s];
+        }
+    }
+
+    return build_mission(bodies, best_dates);
+}
+
 // ─────────────────────────────────────────────────────────────
 // Encounter summaries
 // ─────────────────────────────────────────────────────────────
@@ -518,7 +650,7 @@ double MissionDesigner::compute_total_dv(
 
         // Direction mismatch: compute turn angle
         // Get v_inf vectors
-        Vec3 dep_vel = PlanetaryEphemeris::get_velocity_hci(bodies[i], dates_jd[i]);
+        Vec3 dep_vel = EphemerisCache::planet_velocity_hci(bodies[i], dates_jd[i]);
         Vec3 v_inf_in_vec(
             transfers[i - 1].v_arrival_hci.x - dep_vel.x,
             transfers[i - 1].v_arrival_hci.y - dep_vel.y,
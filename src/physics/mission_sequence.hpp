@@ -71,6 +71,22 @@ struct EncounterSummary {
     double periapsis_alt; // m (flyby periapsis altitude, 0 for endpoints)
 };
 
+/**
+ * Settings for MissionDesigner::optimize_dates_global
+ */
+struct TourOptimizerConfig {
+    int population = 0;                 // 0 = 10 per free epoch (at least 20)
+    int generations = 150;
+    double differential_weight = 0.7;   // DE mutation scale F
+    double crossover = 0.9;             // DE crossover probability CR
+    double epoch_window = 60.0;         // Search +/- days around each initial epoch
+    double min_leg_days = 10.0;         // Shortest leg allowed
+    bool free_endpoints = false;        // Also move the departure and arrival epochs
+    int polish_candidates = 3;          // Best members refined by optimize_dates
+    unsigned seed = 1;                  // Same seed, same result
+    int num_threads = 0;                // 0 = hardware concurrency
+};
+
 // -----------------------------------------------------------------
 // Mission Designer
 // -----------------------------------------------------------------
@@ -118,6 +134,22 @@ public:
         const std::vector<double>& initial_dates_jd,
         int max_iterations = 100);
 
+    /**
+     * Global search over encounter dates, then local polish.
+     *
+     * Differential evolution (rand/1/bin) over the free epochs, each within
+     * epoch_window of its initial value; the initial dates are a member of
+     * the first generation. Each generation's trials are evaluated in
+     * parallel with compute_total_dv (patched-conic cost only). The best
+     * polish_candidates members are then refined by optimize_dates.
+     *
+     * @return Best mission found (never worse than initial_dates_jd)
+     */
+    static MissionSequence optimize_dates_global(
+        const std::vector<Planet>& bodies,
+        const std::vector<double>& initial_dates_jd,
+        const TourOptimizerConfig& config = TourOptimizerConfig());
+
     /**
      * Generate encounter summaries for reporting
      */
@@ -6,6 +6,8 @@
 
 #include "multi_body_gravity.hpp"
 #include "physics/gravity_utils.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/lunar_ephemeris.hpp"
 #include <cmath>
 
 namespace sim {
@@ -173,4 +175,132 @@ Vec3 MultiBodyGravity::vel_mci_to_eci(const Vec3& vel_mci, const Vec3& moon_vel_
     };
 }
 
+// ============================================================================
+// HierarchicalGravity
+// ============================================================================
+
+namespace {
+
+inline void accumulate(Vec3& a, const Vec3& b) {
+    a.x += b.x;
+    a.y += b.y;
+    a.z += b.z;
+}
+
+} // namespace
+
+HierarchicalGravity::HierarchicalGravity(const HierarchicalGravityConfig& config)
+    : config_(config) {}
+
+void HierarchicalGravity::classify(const StateVector& craft, const StateVector& moon) {
+    moon_pos_ = moon.position;
+    moon_vel_ = moon.velocity;
+    sun_pos_ = Vec3();
+    select_terms(craft.position, false);
+}
+
+void HierarchicalGravity::classify(const StateVector& craft, const StateVector& moon,
+                                   const Vec3& sun_pos_eci) {
+    moon_pos_ = moon.position;
+    moon_vel_ = moon.velocity;
+    sun_pos_ = sun_pos_eci;
+    select_terms(craft.position, config_.include_sun);
+}
+
+void HierarchicalGravity::classify_at(const StateVector& craft, double jd) {
+    StateVector moon;
+    moon.time = craft.time;
+    moon.position = EphemerisCache::moon_eci(jd);
+    moon.velocity = LunarEphemeris::get_moon_velocity_eci(jd);
+    classify(craft, moon, EphemerisCache::sun_eci(jd));
+}
+
+void HierarchicalGravity::select_terms(const Vec3& pos_eci, bool have_sun) {
+    double d = moon_pos_.norm();
+    double k = d > 1.0 ? -(EARTH_MU + MOON_MU) / (d * d * d) : 0.0;
+    moon_acc_ = Vec3(k * moon_pos_.x, k * moon_pos_.y, k * moon_pos_.z);
+
+    // Primary, keeping the previous one inside the hysteresis band
+    Vec3 rel = MultiBodyGravity::eci_to_mci(pos_eci, moon_pos_);
+    double dist_to_moon = rel.norm();
+    if (dist_to_moon < MOON_SOI * (1.0 - SOI_HYSTERESIS)) {
+        primary_ = PrimaryBody::MOON;
+    } else if (dist_to_moon > MOON_SOI * (1.0 + SOI_HYSTERESIS)) {
+        primary_ = PrimaryBody::EARTH;
+    }
+
+    // Terms below tolerance of the primary's point-mass pull are dropped
+    double r = pos_eci.norm();
+    double primary_pull = primary_ == PrimaryBody::EARTH
+        ? EARTH_MU / (r * r) : MOON_MU / (dist_to_moon * dist_to_moon);
+    double threshold = config_.relative_tolerance * primary_pull;
+    auto significant = [threshold](const Vec3& term) { return term.norm() > threshold; };
+
+    if (primary_ == PrimaryBody::EARTH) {
+        phase_ = r < config_.near_earth_radius ? TrajectoryPhase::NEAR_EARTH
+                                               : TrajectoryPhase::TRANSLUNAR;
+        earth_j2_ = config_.include_earth_j2 &&
+            significant(gravity::j2_perturbation(pos_eci, EARTH_MU, EARTH_J2, EARTH_RADIUS));
+        moon_j2_ = false;
+        third_body_ = significant(gravity::third_body_perturbation(pos_eci, moon_pos_, MOON_MU));
+    } else {
+        phase_ = TrajectoryPhase::LUNAR_SOI;
+        Vec3 earth_from_moon(-moon_pos_.x, -moon_pos_.y, -moon_pos_.z);
+        moon_j2_ = config_.include_moon_j2 &&
+            significant(gravity::j2_perturbation(rel, MOON_MU, MOON_J2, MOON_RADIUS));
+        third_body_ = significant(gravity::third_body_perturbation(rel, earth_from_moon, EARTH_MU));
+        earth_j2_ = config_.include_earth_j2 &&
+            significant(gravity::j2_perturbation(pos_eci, EARTH_MU, EARTH_J2, EARTH_RADIUS));
+    }
+
+    sun_ = have_sun && significant(gravity::third_body_perturbation(pos_eci, sun_pos_, SUN_MU));
+}
+
+Vec3 HierarchicalGravity::moon_position(double dt) const {
+    double h = 0.5 * dt * dt;
+    return Vec3(moon_pos_.x + moon_vel_.x * dt + moon_acc_.x * h,
+                moon_pos_.y + moon_vel_.y * dt + moon_acc_.y * h,
+                moon_pos_.z + moon_vel_.z * dt + moon_acc_.z * h);
+}
+
+Vec3 HierarchicalGravity::acceleration(const Vec3& pos_eci, double dt) const {
+    Vec3 accel;
+
+    if (primary_ == PrimaryBody::EARTH) {
+        accel = gravity::two_body_acceleration(pos_eci, EARTH_MU);
+        if (earth_j2_) {
+            accumulate(accel, gravity::j2_perturbation(pos_eci, EARTH_MU, EARTH_J2, EARTH_RADIUS));
+        }
+        if (third_body_) {
+            accumulate(accel, gravity::third_body_perturbation(pos_eci, moon_position(dt), MOON_MU));
+        }
+    } else {
+        Vec3 moon = moon_position(dt);
+        Vec3 rel = MultiBodyGravity::eci_to_mci(pos_eci, moon);
+        accel = gravity::two_body_acceleration(rel, MOON_MU);
+        if (moon_j2_) {
+            accumulate(accel, gravity::j2_perturbation(rel, MOON_MU, MOON_J2, MOON_RADIUS));
+        }
+        if (third_body_) {
+            Vec3 earth_from_moon(-moon.x, -moon.y, -moon.z);
+            accumulate(accel, gravity::third_body_perturbation(rel, earth_from_moon, EARTH_MU));
+        }
+
+        // Moon's own geocentric acceleration (frame of integration is ECI)
+        double d = moon.norm();
+        if (d > 1.0) {
+            double k = -(EARTH_MU + MOON_MU) / (d * d * d);
+            accumulate(accel, Vec3(k * moon.x, k * moon.y, k * moon.z));
+        }
+        if (earth_j2_) {
+            accumulate(accel, gravity::j2_perturbation(pos_eci, EARTH_MU, EARTH_J2, EARTH_RADIUS));
+        }
+    }
+
+    if (sun_) {
+        accumulate(accel, gravity::third_body_perturbation(pos_eci, sun_pos_, SUN_MU));
+    }
+    return accel;
+}
+
 }  // namespace sim
@@ -3,6 +3,10 @@
  *
  * Handles gravitational acceleration from multiple bodies (Earth, Moon)
  * with sphere of influence (SOI) detection for patched conic transitions.
+ *
+ * HierarchicalGravity moves the SOI test and force-model selection out of
+ * the derivative: it classifies the trajectory phase once per accepted
+ * step and evaluates only the terms that matter there.
  */
 
 #ifndef SIM_MULTI_BODY_GRAVITY_HPP
@@ -158,6 +162,113 @@ private:
     static constexpr double SOI_HYSTERESIS = 0.05;  // 5% hysteresis to prevent oscillation
 };
 
+/**
+ * Trajectory phase for the hierarchical force model
+ */
+enum class TrajectoryPhase {
+    NEAR_EARTH,   // Earth primary, inside near_earth_radius
+    TRANSLUNAR,   // Earth primary, beyond near_earth_radius
+    LUNAR_SOI     // Moon primary
+};
+
+struct HierarchicalGravityConfig {
+    double relative_tolerance = 1e-8;     // Drop terms below this fraction of the primary's pull
+    double near_earth_radius = 100000e3;  // [m] NEAR_EARTH / TRANSLUNAR split
+    bool include_earth_j2 = true;
+    bool include_moon_j2 = true;
+    bool include_sun = true;              // Only when classify() is given a Sun position
+};
+
+/**
+ * Phase-classified Earth-Moon(-Sun) gravity
+ *
+ * classify() runs once per accepted step. It settles the primary (Moon SOI
+ * with the same hysteresis as determine_primary, but remembering the
+ * previous primary inside the band), the phase, and which optional terms
+ * to keep. Each candidate term is evaluated once at the classification
+ * state and kept only if it exceeds relative_tolerance times the primary's
+ * point-mass pull:
+ *
+ *     Earth primary: Earth point mass, [Earth J2], [Moon], [Sun]
+ *     Moon primary:  Moon point mass, [Moon J2], [Earth tide], [Earth J2], [Sun]
+ *
+ * acceleration() then evaluates only those terms. Ephemerides are not
+ * queried per call: the Moon is extrapolated from its classification state
+ * under Earth-Moon two-body gravity, and the Sun is held fixed over the
+ * step (it moves ~1e-5 of its distance per minute).
+ *
+ * The result is the geocentric (ECI) acceleration with the indirect terms
+ * for the Earth's own acceleration, so it can be integrated directly in
+ * either phase. With Earth primary it equals compute_acceleration (plus
+ * the Sun); inside the SOI the same sum is regrouped Moon-centred, as the
+ * Moon's pull plus the Earth's tide on the spacecraft relative to the
+ * Moon plus the Moon's own geocentric acceleration.
+ */
+class HierarchicalGravity {
+public:
+    explicit HierarchicalGravity(
+        const HierarchicalGravityConfig& config = HierarchicalGravityConfig());
+
+    /**
+     * Classify at the start of a step
+     *
+     * @param craft Spacecraft ECI state (time is the step start)
+     * @param moon Moon ECI state at craft.time
+     */
+    void classify(const StateVector& craft, const StateVector& moon);
+
+    /** Classify with the Sun as a candidate term (sun_pos_eci at craft.time) */
+    void classify(const StateVector& craft, const StateVector& moon, const Vec3& sun_pos_eci);
+
+    /** Classify with Moon and Sun from the ephemerides at Julian Date jd */
+    void classify_at(const StateVector& craft, double jd);
+
+    /**
+     * ECI acceleration with the terms chosen by the last classify()
+     *
+     * @param pos_eci Position in ECI (m)
+     * @param dt Time since the classification state (s)
+     */
+    Vec3 acceleration(const Vec3& pos_eci, double dt) const;
+
+    /** Moon ECI position extrapolated dt past the classification state */
+    Vec3 moon_position(double dt) const;
+
+    PrimaryBody primary() const { return primary_; }
+    TrajectoryPhase phase() const { return phase_; }
+
+    /** Seed the primary carried through the SOI hysteresis band */
+    void set_primary(PrimaryBody body) { primary_ = body; }
+
+    // Terms kept by the last classify()
+    bool uses_earth_j2() const { return earth_j2_; }
+    bool uses_moon_j2() const { return moon_j2_; }
+    bool uses_third_body() const { return third_body_; }   // Moon (Earth primary) or Earth tide (Moon primary)
+    bool uses_sun() const { return sun_; }
+
+    const HierarchicalGravityConfig& config() const { return config_; }
+
+private:
+    static constexpr double SOI_HYSTERESIS = 0.05;
+
+    HierarchicalGravityConfig config_;
+    PrimaryBody primary_ = PrimaryBody::EARTH;
+    TrajectoryPhase phase_ = TrajectoryPhase::NEAR_EARTH;
+
+    bool earth_j2_ = false;
+    bool moon_j2_ = false;
+    bool third_body_ = false;
+    bool sun_ = false;
+
+    // Ephemeris at classification
+    Vec3 moon_pos_;
+    Vec3 moon_vel_;
+    Vec3 moon_acc_;
+    Vec3 sun_pos_;
+
+    void select_terms(const Vec3& pos_eci, bool have_sun);
+};
+
 /**
  * String representation of primary body
  */
@@ -169,6 +280,18 @@ inline const char* primary_body_to_string(PrimaryBody body) {
     }
 }
 
+/**
+ * String representation of trajectory phase
+ */
+inline const char* trajectory_phase_to_string(TrajectoryPhase phase) {
+    switch (phase) {
+        case TrajectoryPhase::NEAR_EARTH: return "Near-Earth";
+        case TrajectoryPhase::TRANSLUNAR: return "Translunar";
+        case TrajectoryPhase::LUNAR_SOI: return "Lunar SOI";
+        default: return "Unknown";
+    }
+}
+
 }  // namespace sim
 
 #endif  // SIM_MULTI_BODY_GRAVITY_HPP
@@ -10,6 +10,7 @@
  */
 
 #include "nbody_gravity.hpp"
+#include "physics/ephemeris_cache.hpp"
 #include "physics/gravity_utils.hpp"
 #include <cmath>
 
@@ -100,7 +101,7 @@ Vec3 NBodyGravity::compute_acceleration_hci(
     // ── 2. Each configured body ──
     for (const auto& entry : config.bodies) {
         const auto& pc = PlanetaryConstants::get(entry.planet);
-        Vec3 body_pos = PlanetaryEphemeris::get_position_hci(entry.planet, jd);
+        Vec3 body_pos = EphemerisCache::planet_hci(entry.planet, jd);
 
         // Vector from body to spacecraft
         Vec3 r_rel{
@@ -164,6 +165,29 @@ NBodyGravity::make_derivative_function(
     };
 }
 
+AccelerationFunction NBodyGravity::make_acceleration_function(
+    const NBodyConfig& config,
+    double epoch_jd) {
+
+    return [config, epoch_jd](double t, const Vec3& r, const Vec3&) {
+        return compute_acceleration_hci(r, epoch_jd + t / 86400.0, config);
+    };
+}
+
+StateVector NBodyGravity::propagate_cruise(
+    const StateVector& state_hci,
+    double duration,
+    const NBodyConfig& config,
+    double epoch_jd,
+    const IntegratorOptions& options,
+    IntegratorStats* stats) {
+
+    IntegratorOptions o = options;
+    o.velocity_dependent = false;
+    return OrbitIntegrator::propagate(state_hci, duration,
+                                      make_acceleration_function(config, epoch_jd), o, stats);
+}
+
 // =================================================================
 // SOI transition detection
 // =================================================================
@@ -186,7 +210,7 @@ std::pair<bool, Planet> NBodyGravity::check_soi_transition(
         const auto& pc = PlanetaryConstants::get(planet);
         if (pc.soi_radius <= 0.0) continue;
 
-        Vec3 body_pos = PlanetaryEphemeris::get_position_hci(planet, jd);
+        Vec3 body_pos = EphemerisCache::planet_hci(planet, jd);
         Vec3 r_rel{
             pos_hci.x - body_pos.x,
             pos_hci.y - body_pos.y,
@@ -203,7 +227,7 @@ std::pair<bool, Planet> NBodyGravity::check_soi_transition(
     if (current_primary != Planet::MERCURY) {  // use as proxy for "not Sun"
         const auto& pc = PlanetaryConstants::get(current_primary);
         if (pc.soi_radius > 0.0) {
-            Vec3 body_pos = PlanetaryEphemeris::get_position_hci(current_primary, jd);
+            Vec3 body_pos = EphemerisCache::planet_hci(current_primary, jd);
             Vec3 r_rel{
                 pos_hci.x - body_pos.x,
                 pos_hci.y - body_pos.y,
@@ -230,8 +254,8 @@ StateVector NBodyGravity::hci_to_body_centered(
     Planet body,
     double jd) {
 
-    Vec3 body_pos = PlanetaryEphemeris::get_position_hci(body, jd);
-    Vec3 body_vel = PlanetaryEphemeris::get_velocity_hci(body, jd);
+    Vec3 body_pos = EphemerisCache::planet_hci(body, jd);
+    Vec3 body_vel = EphemerisCache::planet_velocity_hci(body, jd);
 
     StateVector state_bc = state_hci;
     state_bc.position.x -= body_pos.x;
@@ -250,8 +274,8 @@ StateVector NBodyGravity::body_centered_to_hci(
     Planet body,
     double jd) {
 
-    Vec3 body_pos = PlanetaryEphemeris::get_position_hci(body, jd);
-    Vec3 body_vel = PlanetaryEphemeris::get_velocity_hci(body, jd);
+    Vec3 body_pos = EphemerisCache::planet_hci(body, jd);
+    Vec3 body_vel = EphemerisCache::planet_velocity_hci(body, jd);
 
     StateVector state_hci = state_bc;
     state_hci.position.x += body_pos.x;
@@ -6,7 +6,8 @@
  * Uses PlanetaryEphemeris for body positions at each time step.
  *
  * Designed for interplanetary trajectory propagation with the
- * AdaptiveIntegrator (Dormand-Prince 4(5)).
+ * AdaptiveIntegrator (Dormand-Prince 4(5)), or any OrbitIntegrator method
+ * via make_acceleration_function() / propagate_cruise().
  *
  * Features:
  *   - Configurable body list with optional J2 for each body
@@ -22,6 +23,7 @@
 #include "core/state_vector.hpp"
 #include "planetary_ephemeris.hpp"
 #include "celestial_body.hpp"
+#include "propagators/orbit_integrator.hpp"
 #include <vector>
 #include <functional>
 #include <utility>
@@ -113,11 +115,34 @@ public:
     static std::function<StateVector(const StateVector&)>
     make_derivative_function(const NBodyConfig& config, double epoch_jd);
 
+    /**
+     * Acceleration model for OrbitIntegrator: t is seconds since epoch_jd.
+     * Velocity-independent, so symplectic and RKN methods apply.
+     */
+    static AccelerationFunction make_acceleration_function(
+        const NBodyConfig& config, double epoch_jd);
+
+    /**
+     * Propagate an HCI cruise state (state.time = seconds since epoch_jd).
+     * Defaults to 6th order Yoshida with a 1 day step, whose energy error
+     * stays bounded over months; pass DOP853 options near flybys.
+     */
+    static StateVector propagate_cruise(
+        const StateVector& state_hci,
+        double duration,
+        const NBodyConfig& config,
+        double epoch_jd,
+        const IntegratorOptions& options =
+            IntegratorOptions::fixed(IntegrationMethod::YOSHIDA6, 86400.0),
+        IntegratorStats* stats = nullptr);
+
     /**
      * Check whether the spacecraft has crossed a sphere-of-influence boundary.
      *
      * Compares the spacecraft's distance to each configured body against
-     * that body's SOI radius (from PlanetaryConstants).
+     * that body's SOI radius (from PlanetaryConstants). To find crossings
+     * during a propagation, SoiEventCalendar (soi_event_calendar.hpp)
+     * locates them on the integrator's dense output instead.
      *
      * @param pos_hci         Spacecraft position in HCI [m]
      * @param jd              Current Julian Date
@@ -1,9 +1,12 @@
 #include "physics/nonlinear_rendezvous.hpp"
 #include "physics/gravity_utils.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
 #include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <memory>
 
 namespace sim {
 
@@ -33,8 +36,10 @@ void NonlinearRendezvousSolver::compute_gravity_gradient(const Vec3& pos, double
     // Use consolidated gravity gradient utility
     gravity::gravity_gradient(pos, force_config_.mu, G);
 
-    // Note: J2 contribution to gradient could be added for higher fidelity
-    // but is omitted as it adds significant complexity for marginal benefit
+    if (force_config_.include_j2) {
+        gravity::add_j2_gravity_gradient(
+            pos, force_config_.mu, force_config_.j2, force_config_.body_radius, G);
+    }
 }
 
 ExtendedState NonlinearRendezvousSolver::rk4_step_extended(const ExtendedState& es, double dt) const {
@@ -210,7 +215,7 @@ std::vector<double> NonlinearRendezvousSolver::compute_residuals(
     return r;
 }
 
-std::vector<std::vector<double>> NonlinearRendezvousSolver::extract_jacobian(
+NonlinearRendezvousSolver::JacobianMatrix NonlinearRendezvousSolver::extract_jacobian(
     const STM& phi, bool match_velocity) const {
 
     // For single impulse at t=0, control variables are delta-V components (dv_x, dv_y, dv_z)
@@ -221,12 +226,12 @@ std::vector<std::vector<double>> NonlinearRendezvousSolver::extract_jacobian(
     int n_constraints = match_velocity ? 6 : 3;
     int n_controls = 3;  // dv_x, dv_y, dv_z
 
-    std::vector<std::vector<double>> J(n_constraints, std::vector<double>(n_controls));
+    JacobianMatrix J(n_constraints, n_controls);
 
     // Position sensitivity to initial velocity: rows 0-2, cols 3-5 of STM
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
-            J[i][j] = phi(i, j + 3);
+            J(i, j) = phi(i, j + 3);
         }
     }
 
@@ -234,7 +239,7 @@ std::vector<std::vector<double>> NonlinearRendezvousSolver::extract_jacobian(
     if (match_velocity) {
         for (int i = 0; i < 3; i++) {
             for (int j = 0; j < 3; j++) {
-                J[i + 3][j] = phi(i + 3, j + 3);
+                J(i + 3, j) = phi(i + 3, j + 3);
             }
         }
     }
@@ -243,75 +248,13 @@ std::vector<std::vector<double>> NonlinearRendezvousSolver::extract_jacobian(
 }
 
 std::vector<double> NonlinearRendezvousSolver::solve_linear_system(
-    const std::vector<std::vector<double>>& J,
+    const JacobianMatrix& J,
     const std::vector<double>& r) const {
 
-    int m = J.size();     // Number of constraints (rows)
-    int n = J[0].size();  // Number of controls (cols)
-
-    std::vector<double> dx(n, 0.0);
-
-    if (m == n) {
-        // Square system: direct solve using Gaussian elimination
-        std::vector<std::vector<double>> A = J;
-        std::vector<double> b = r;
-
-        // Forward elimination with partial pivoting
-        for (int k = 0; k < n; k++) {
-            // Find pivot
-            int max_row = k;
-            double max_val = std::abs(A[k][k]);
-            for (int i = k + 1; i < n; i++) {
-                if (std::abs(A[i][k]) > max_val) {
-                    max_val = std::abs(A[i][k]);
-                    max_row = i;
-                }
-            }
-
-            // Swap rows
-            std::swap(A[k], A[max_row]);
-            std::swap(b[k], b[max_row]);
-
-            // Eliminate
-            for (int i = k + 1; i < n; i++) {
-                double factor = A[i][k] / A[k][k];
-                for (int j = k; j < n; j++) {
-                    A[i][j] -= factor * A[k][j];
-                }
-                b[i] -= factor * b[k];
-            }
-        }
-
-        // Back substitution
-        for (int i = n - 1; i >= 0; i--) {
-            dx[i] = b[i];
-            for (int j = i + 1; j < n; j++) {
-                dx[i] -= A[i][j] * dx[j];
-            }
-            dx[i] /= A[i][i];
-        }
-    } else if (m > n) {
-        // Overdetermined: least squares via normal equations
-        // J^T * J * dx = J^T * r
-        std::vector<std::vector<double>> JTJ(n, std::vector<double>(n, 0.0));
-        std::vector<double> JTr(n, 0.0);
-
-        for (int i = 0; i < n; i++) {
-            for (int j = 0; j < n; j++) {
-                for (int k = 0; k < m; k++) {
-                    JTJ[i][j] += J[k][i] * J[k][j];
-                }
-            }
-            for (int k = 0; k < m; k++) {
-                JTr[i] += J[k][i] * r[k];
-            }
-        }
-
-        // Solve JTJ * dx = JTr (recursive call with square system)
-        dx = solve_linear_system(JTJ, JTr);
-    }
-
-    return dx;
+    // Square: direct LU; overdetermined: least squares via normal equations
+    linalg::FixedVector<3> dx;
+    linalg::damped_least_squares(J, linalg::FixedVector<6>::from(r), 0.0, dx);
+    return dx.to_vector();
 }
 
 Vec3 NonlinearRendezvousSolver::cw_initial_guess(
@@ -362,6 +305,176 @@ Vec3 NonlinearRendezvousSolver::cw_initial_guess(
     return dv_guess;
 }
 
+bool NonlinearRendezvousSolver::solve_multiple_shooting(
+    const StateVector& chaser,
+    const StateVector& target_final,
+    double tof,
+    bool match_velocity,
+    Vec3& dv,
+    int& iterations) const {
+
+    const int M = solver_config_.shooting_segments;
+    const double h = tof / M;
+    const int n_term = match_velocity ? 6 : 3;
+
+    auto to_array = [](const StateVector& s, double out[6]) {
+        out[0] = s.position.x; out[1] = s.position.y; out[2] = s.position.z;
+        out[3] = s.velocity.x; out[4] = s.velocity.y; out[5] = s.velocity.z;
+    };
+    auto add_scaled = [](StateVector& s, const double d[6], double scale) {
+        s.position.x += scale * d[0]; s.position.y += scale * d[1]; s.position.z += scale * d[2];
+        s.velocity.x += scale * d[3]; s.velocity.y += scale * d[4]; s.velocity.z += scale * d[5];
+    };
+
+    std::unique_ptr<ThreadPool> pool;
+    if (solver_config_.num_threads != 1) pool.reset(new ThreadPool(solver_config_.num_threads));
+    auto for_each_arc = [&](const std::function<void(size_t)>& fn) {
+        if (pool) pool->parallel_for(static_cast<size_t>(M), fn);
+        else for (int k = 0; k < M; k++) fn(static_cast<size_t>(k));
+    };
+
+    // Nodes 1..M-1 seeded on the chaser's coast with the guess burn: the
+    // first Newton step is then the single-shooting step, and later steps
+    // free the nodes from the coast
+    std::vector<StateVector> nodes(M);
+    {
+        StateVector c = chaser;
+        c.velocity.x += dv.x; c.velocity.y += dv.y; c.velocity.z += dv.z;
+        for (int k = 1; k < M; k++) {
+            c = propagate_target(c, h);
+            nodes[k] = c;
+        }
+    }
+    auto arc_start = [&](int k, const Vec3& burn) {
+        if (k > 0) return nodes[k];
+        StateVector s = chaser;
+        s.velocity.x += burn.x; s.velocity.y += burn.y; s.velocity.z += burn.z;
+        return s;
+    };
+
+    // Defect of arc k: end state minus next node (terminal: minus target)
+    std::vector<std::array<double, 6>> defects(M);
+    auto defect_of = [&](int k, const StateVector& end, double out[6]) {
+        double e[6], next[6];
+        to_array(end, e);
+        to_array(k < M - 1 ? nodes[k + 1] : target_final, next);
+        for (int i = 0; i < 6; i++) out[i] = e[i] - next[i];
+        if (k == M - 1 && !match_velocity) out[3] = out[4] = out[5] = 0.0;
+    };
+    // Merit: squared defects with velocities scaled by the arc time [m^2]
+    auto merit = [&]() {
+        double m = 0.0;
+        for (const auto& d : defects) {
+            for (int i = 0; i < 6; i++) m += (i < 3 ? d[i] * d[i] : d[i] * d[i] * h * h);
+        }
+        return m;
+    };
+
+    std::vector<ExtendedState> arcs(M);
+    bool converged = false;
+    iterations = 0;
+    for (int iter = 0; iter < solver_config_.max_iterations; iter++) {
+        iterations = iter + 1;
+        for_each_arc([&](size_t kk) {
+            int k = static_cast<int>(kk);
+            arcs[k] = propagate_with_stm(arc_start(k, dv), h);
+            defect_of(k, arcs[k].state, defects[k].data());
+        });
+
+        double max_pos = 0.0, max_vel = 0.0;
+        for (const auto& d : defects) {
+            max_pos = std::max(max_pos, std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+            max_vel = std::max(max_vel, std::sqrt(d[3] * d[3] + d[4] * d[4] + d[5] * d[5]));
+        }
+        if (solver_config_.verbose) {
+            std::cout << "MS iter " << iter << ": max defect = " << max_pos / 1000.0
+                      << " km, " << max_vel << " m/s, dv_mag = " << dv.norm() << " m/s" << std::endl;
+        }
+        if (max_pos < solver_config_.position_tol && max_vel < solver_config_.velocity_tol) {
+            converged = true;
+            break;
+        }
+
+        // Condense dS_k = P_k ddv + q_k through dX_{k+1} = Phi_k dS_k + d_k
+        // (the burn enters the first arc's velocity only)
+        std::vector<std::array<double, 18>> P(M);
+        std::vector<std::array<double, 6>> q(M);
+        for (int i = 0; i < 6; i++) {
+            q[0][i] = 0.0;
+            for (int j = 0; j < 3; j++) P[0][i * 3 + j] = (i == j + 3) ? 1.0 : 0.0;
+        }
+        for (int k = 0; k + 1 < M; k++) {
+            const STM& phi = arcs[k].phi;
+            for (int i = 0; i < 6; i++) {
+                double qi = defects[k][i];
+                for (int l = 0; l < 6; l++) qi += phi(i, l) * q[k][l];
+                q[k + 1][i] = qi;
+                for (int j = 0; j < 3; j++) {
+                    double pij = 0.0;
+                    for (int l = 0; l < 6; l++) pij += phi(i, l) * P[k][l * 3 + j];
+                    P[k + 1][i * 3 + j] = pij;
+                }
+            }
+        }
+
+        // Terminal: r + S Phi (P ddv + q) = 0
+        const STM& phi_f = arcs[M - 1].phi;
+        JacobianMatrix J(n_term, 3);
+        std::vector<double> rhs(n_term, 0.0);
+        for (int i = 0; i < n_term; i++) {
+            double r = defects[M - 1][i];
+            for (int l = 0; l < 6; l++) r += phi_f(i, l) * q[M - 1][l];
+            rhs[i] = -r;
+            for (int j = 0; j < 3; j++) {
+                for (int l = 0; l < 6; l++) J(i, j) += phi_f(i, l) * P[M - 1][l * 3 + j];
+            }
+        }
+        std::vector<double> ddv = solve_linear_system(J, rhs);
+
+        std::vector<std::array<double, 6>> dnode(M);
+        for (int k = 1; k < M; k++) {
+            for (int i = 0; i < 6; i++) {
+                double v = q[k][i];
+                for (int j = 0; j < 3; j++) v += P[k][i * 3 + j] * ddv[j];
+                dnode[k][i] = v;
+            }
+        }
+
+        // Backtracking on the squared defects
+        double alpha = 1.0;
+        std::vector<StateVector> base = nodes;
+        Vec3 dv_base = dv;
+        double merit_curr = merit();
+        bool accepted = !solver_config_.use_line_search;
+        for (int ls = 0; ls < 10; ls++) {
+            for (int k = 1; k < M; k++) {
+                nodes[k] = base[k];
+                add_scaled(nodes[k], dnode[k].data(), alpha);
+            }
+            dv.x = dv_base.x + alpha * ddv[0];
+            dv.y = dv_base.y + alpha * ddv[1];
+            dv.z = dv_base.z + alpha * ddv[2];
+            if (accepted) break;
+
+            for_each_arc([&](size_t kk) {
+                int k = static_cast<int>(kk);
+                defect_of(k, propagate_target(arc_start(k, dv), h), defects[k].data());
+            });
+            if (merit() < merit_curr) {
+                accepted = true;
+                break;
+            }
+            alpha *= solver_config_.line_search_alpha;
+        }
+
+        // Stalled: the caller falls back to single shooting
+        double step = alpha * std::sqrt(ddv[0] * ddv[0] + ddv[1] * ddv[1] + ddv[2] * ddv[2]);
+        if (!accepted || step < 1e-9) break;
+    }
+
+    return converged;
+}
+
 RendezvousSolution NonlinearRendezvousSolver::solve_single_impulse(
     const StateVector& chaser,
     const StateVector& target,
@@ -389,9 +502,20 @@ RendezvousSolution NonlinearRendezvousSolver::solve_single_impulse(
                   << ") m/s, mag = " << dv.norm() << " m/s" << std::endl;
     }
 
+    // Multiple shooting brings the burn into the single-shooting basin; if
+    // it stalls, single shooting restarts from the original guess
+    int shooting_iterations = 0;
+    if (solver_config_.shooting_segments > 1) {
+        Vec3 dv_ms = dv;
+        if (solve_multiple_shooting(chaser, target_final, tof, match_velocity,
+                                    dv_ms, shooting_iterations)) {
+            dv = dv_ms;
+        }
+    }
+
     // Newton-Raphson iteration
     for (int iter = 0; iter < solver_config_.max_iterations; iter++) {
-        solution.iterations = iter + 1;
+        solution.iterations = shooting_iterations + iter + 1;
 
         // Apply delta-V to chaser
         StateVector chaser_post_burn = chaser;
@@ -435,7 +559,7 @@ RendezvousSolution NonlinearRendezvousSolver::solve_single_impulse(
         }
 
         // Extract Jacobian and solve for correction
-        std::vector<std::vector<double>> J = extract_jacobian(es.phi, match_velocity);
+        JacobianMatrix J = extract_jacobian(es.phi, match_velocity);
         std::vector<double> correction = solve_linear_system(J, residuals);
 
         // Line search (optional damping)
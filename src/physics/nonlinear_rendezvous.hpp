@@ -2,6 +2,7 @@
 #define NONLINEAR_RENDEZVOUS_HPP
 
 #include "core/state_vector.hpp"
+#include "physics/dense_linalg.hpp"
 #include <vector>
 #include <functional>
 #include <array>
@@ -95,11 +96,14 @@ struct SolverConfig {
     double step_size;           // Integration step [s]
     bool use_line_search;       // Damped Newton
     double line_search_alpha;   // Step size reduction factor
+    int shooting_segments;      // Multiple-shooting arcs (1 = single shooting)
+    int num_threads;            // Arc propagation threads (0 = hardware, 1 = serial)
     bool verbose;
 
     SolverConfig() : max_iterations(50), position_tol(1.0), velocity_tol(0.01),
                      step_size(60.0), use_line_search(true),
-                     line_search_alpha(0.5), verbose(false) {}  // 50 iterations default
+                     line_search_alpha(0.5), shooting_segments(1), num_threads(0),
+                     verbose(false) {}  // 50 iterations default
 };
 
 /**
@@ -107,6 +111,15 @@ struct SolverConfig {
  *
  * Solves spacecraft intercept/rendezvous using differential correction
  * (Newton-Raphson shooting) under full nonlinear dynamics.
+ *
+ * With shooting_segments > 1 the first burn is found by multiple shooting
+ * first: the transfer is cut into equal arcs whose initial states are
+ * free (seeded on the chaser's coast), and every arc is propagated with
+ * its STM concurrently. The Newton step on the burn and all node states is
+ * exact (arc STMs) and is solved by condensing the block-bidiagonal defect
+ * system onto the burn, O(arcs). A converged burn is then refined by
+ * single shooting against one continuous propagation; if multiple
+ * shooting stalls, single shooting starts from the original guess.
  */
 class NonlinearRendezvousSolver {
 public:
@@ -153,6 +166,9 @@ public:
     Vec3 cw_initial_guess(const StateVector& chaser, const StateVector& target, double tof);
 
 private:
+    /** Terminal constraints (position, optionally velocity) by delta-V components */
+    using JacobianMatrix = linalg::FixedMatrix<6, 3>;
+
     ForceModelConfig force_config_;
     SolverConfig solver_config_;
 
@@ -187,20 +203,29 @@ private:
     /**
      * @brief Extract Jacobian from STM for the constraint mapping
      */
-    std::vector<std::vector<double>> extract_jacobian(
-        const STM& phi, bool match_velocity) const;
+    JacobianMatrix extract_jacobian(const STM& phi, bool match_velocity) const;
 
     /**
      * @brief Solve linear system (Jacobian \ residuals)
      */
     std::vector<double> solve_linear_system(
-        const std::vector<std::vector<double>>& J,
+        const JacobianMatrix& J,
         const std::vector<double>& r) const;
 
     /**
      * @brief Propagate target to future time
      */
     StateVector propagate_target(const StateVector& target, double dt) const;
+
+    /**
+     * @brief Multiple-shooting correction of the first burn
+     * @param dv Burn guess, replaced by the corrected burn
+     * @param iterations Newton iterations used
+     * @return true if every arc defect met the tolerances
+     */
+    bool solve_multiple_shooting(const StateVector& chaser, const StateVector& target_final,
+                                 double tof, bool match_velocity, Vec3& dv,
+                                 int& iterations) const;
 };
 
 } // namespace sim
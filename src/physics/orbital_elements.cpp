@@ -1,4 +1,5 @@
 #include "physics/orbital_elements.hpp"
+#include "physics/kepler_solver.hpp"
 #include <cmath>
 #include <stdexcept>
 
@@ -194,22 +195,8 @@ double OrbitalMechanics::escape_velocity(double radius, double mu) {
     return std::sqrt(2.0 * mu / radius);
 }
 
-double OrbitalMechanics::solve_kepler(double M, double e, double tolerance) {
-    // Newton-Raphson iteration for Kepler's equation: M = E - e*sin(E)
-    double E = M;  // Initial guess
-
-    for (int iter = 0; iter < 50; iter++) {
-        double f = E - e * std::sin(E) - M;
-        double fp = 1.0 - e * std::cos(E);
-        double delta = f / fp;
-        E -= delta;
-
-        if (std::abs(delta) < tolerance) {
-            break;
-        }
-    }
-
-    return E;
+double OrbitalMechanics::solve_kepler(double M, double e, double /*tolerance*/) {
+    return kepler::eccentric_anomaly(M, e);
 }
 
 double OrbitalMechanics::true_to_eccentric_anomaly(double nu, double e) {
@@ -234,8 +221,7 @@ double OrbitalMechanics::true_to_mean_anomaly(double nu, double e) {
 }
 
 double OrbitalMechanics::mean_to_true_anomaly(double M, double e) {
-    double E = solve_kepler(M, e);
-    return eccentric_to_true_anomaly(E, e);
+    return kepler::true_anomaly(M, e);
 }
 
 double OrbitalMechanics::propagate_mean_anomaly(double M0, double n, double dt) {
@@ -83,10 +83,10 @@ public:
     static double escape_velocity(double radius, double mu = MU_EARTH);
 
     /**
-     * @brief Solve Kepler's equation for eccentric anomaly
+     * @brief Solve Kepler's equation for eccentric anomaly (kepler::eccentric_anomaly)
      * @param mean_anomaly Mean anomaly [rad]
      * @param eccentricity Eccentricity
-     * @param tolerance Convergence tolerance
+     * @param tolerance Unused; the solver converges to ~1e-15 rad
      * @return Eccentric anomaly [rad]
      */
     static double solve_kepler(double mean_anomaly, double eccentricity,
@@ -108,7 +108,7 @@ public:
     static double true_to_mean_anomaly(double true_anomaly, double eccentricity);
 
     /**
-     * @brief Convert mean anomaly to true anomaly
+     * @brief Convert mean anomaly to true anomaly (elliptic, parabolic or hyperbolic)
      */
     static double mean_to_true_anomaly(double mean_anomaly, double eccentricity);
 
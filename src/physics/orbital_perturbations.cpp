@@ -3,8 +3,13 @@
  */
 
 #include "orbital_perturbations.hpp"
+#include "physics/force_model.hpp"
 #include "physics/gravity_utils.hpp"
 #include "physics/atmosphere_model.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "physics/eclipse_timeline.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/gravity_grid.hpp"
 #include "physics/lunar_ephemeris.hpp"
 #include "physics/solar_ephemeris.hpp"
 #include "physics/solar_radiation_pressure.hpp"
@@ -14,6 +19,60 @@ namespace sim {
 
 static const Vec3 ZERO_VEC{0.0, 0.0, 0.0};
 
+// Field harmonics at the configured (or altitude-derived) truncation
+static Vec3 field_acceleration(const Vec3& position, const PerturbationConfig& config,
+                               double jd) {
+    const GravityField& field = *config.gravity_field;
+    int degree = config.field_degree > 0
+        ? config.field_degree
+        : field.degree_for_radius(position.norm(), config.field_tolerance);
+    int order = config.field_order >= 0 ? config.field_order : degree;
+    return field.acceleration_inertial(position, GravityField::gmst(jd), degree, order);
+}
+
+// Field harmonics in the body frame, or the enabled zonal terms (axisymmetric)
+static Vec3 body_fixed_harmonics(const Vec3& r, const PerturbationConfig& config) {
+    const auto& earth = gravity::BodyConstants::EARTH;
+    if (config.gravity_field) {
+        const GravityField& field = *config.gravity_field;
+        int degree = config.field_degree > 0
+            ? config.field_degree
+            : field.degree_for_radius(r.norm(), config.field_tolerance);
+        int order = config.field_order >= 0 ? config.field_order : degree;
+        return field.acceleration(r, degree, order);
+    }
+    Vec3 a{0.0, 0.0, 0.0};
+    auto add = [&a](const Vec3& t) { a.x += t.x; a.y += t.y; a.z += t.z; };
+    if (config.j2) add(gravity::j2_perturbation(r, earth.mu, earth.j2, earth.radius));
+    if (config.j3) add(gravity::j3_perturbation(r, earth.mu, earth.j3, earth.radius));
+    if (config.j4) add(gravity::j4_perturbation(r, earth.mu, earth.j4, earth.radius));
+    return a;
+}
+
+// Tabulated harmonics; false outside the grid shell
+static bool grid_acceleration(const Vec3& position, const PerturbationConfig& config,
+                              double jd, Vec3& accel) {
+    const GravityGrid& grid = *config.gravity_grid;
+    if (!config.gravity_field) return grid.lookup(position, accel);
+
+    const double g = GravityField::gmst(jd);
+    const double c = std::cos(g), s = std::sin(g);
+    Vec3 rb{c * position.x + s * position.y, -s * position.x + c * position.y, position.z};
+    Vec3 ab;
+    if (!grid.lookup(rb, ab)) return false;
+    accel = Vec3{c * ab.x - s * ab.y, s * ab.x + c * ab.y, ab.z};
+    return true;
+}
+
+std::shared_ptr<const GravityGrid> OrbitalPerturbations::build_harmonics_grid(
+    const PerturbationConfig& config,
+    const GravityGridConfig& grid_config) {
+    PerturbationConfig sampled = config;
+    sampled.gravity_grid.reset();
+    return std::make_shared<const GravityGrid>(GravityGrid::build(
+        [sampled](const Vec3& r) { return body_fixed_harmonics(r, sampled); }, grid_config));
+}
+
 Vec3 OrbitalPerturbations::compute_total_acceleration(
     const Vec3& position,
     const Vec3& velocity,
@@ -25,90 +84,37 @@ Vec3 OrbitalPerturbations::compute_total_acceleration(
     // Central body (always included)
     Vec3 accel = gravity::two_body_acceleration(position, earth.mu);
 
-    // J2 oblateness
-    if (config.j2) {
-        Vec3 a_j2 = gravity::j2_perturbation(position, earth.mu, earth.j2, earth.radius);
-        accel.x += a_j2.x;
-        accel.y += a_j2.y;
-        accel.z += a_j2.z;
-    }
-
-    // J3 pear-shaped asymmetry
-    if (config.j3) {
-        Vec3 a_j3 = gravity::j3_perturbation(position, earth.mu, earth.j3, earth.radius);
-        accel.x += a_j3.x;
-        accel.y += a_j3.y;
-        accel.z += a_j3.z;
-    }
-
-    // J4 higher-order oblateness
-    if (config.j4) {
-        Vec3 a_j4 = gravity::j4_perturbation(position, earth.mu, earth.j4, earth.radius);
-        accel.x += a_j4.x;
-        accel.y += a_j4.y;
-        accel.z += a_j4.z;
-    }
-
-    // Lunar third-body perturbation
-    if (config.moon) {
-        Vec3 moon_pos = LunarEphemeris::get_moon_position_eci(jd);
-        Vec3 a_moon = gravity::third_body_perturbation(position, moon_pos, MOON_MU);
-        accel.x += a_moon.x;
-        accel.y += a_moon.y;
-        accel.z += a_moon.z;
+    // Tabulated harmonics inside the grid shell; exact terms elsewhere
+    bool gridded = false;
+    if (config.gravity_grid) {
+        Vec3 a_grid;
+        gridded = grid_acceleration(position, config, jd, a_grid);
+        if (gridded) {
+            accel.x += a_grid.x;
+            accel.y += a_grid.y;
+            accel.z += a_grid.z;
+        }
     }
-
-    // Solar third-body perturbation
-    if (config.sun) {
-        Vec3 sun_pos = SolarEphemeris::get_sun_position_eci(jd);
-        Vec3 a_sun = gravity::third_body_perturbation(position, sun_pos, SUN_MU);
-        accel.x += a_sun.x;
-        accel.y += a_sun.y;
-        accel.z += a_sun.z;
+    const bool zonals = !config.gravity_field && !gridded;
+
+    // Spherical-harmonic field supersedes the zonal terms
+    if (config.gravity_field && !gridded) {
+        Vec3 a_field = field_acceleration(position, config, jd);
+        accel.x += a_field.x;
+        accel.y += a_field.y;
+        accel.z += a_field.z;
     }
 
-    // Solar radiation pressure
-    if (config.srp) {
-        Vec3 sun_pos = SolarEphemeris::get_sun_position_eci(jd);
-        Vec3 a_srp = SolarRadiationPressure::compute_acceleration(
-            position, sun_pos, config.srp_params);
-        accel.x += a_srp.x;
-        accel.y += a_srp.y;
-        accel.z += a_srp.z;
-    }
-
-    // Atmospheric drag
-    if (config.drag) {
-        double alt = position.norm() - EARTH_RADIUS;
-        if (alt > 0.0 && alt < 200000.0) {  // Below 200 km atmosphere limit
-            // Atmosphere co-rotates with Earth
-            // v_rel = v_inertial - omega_earth x r
-            Vec3 v_atm{
-                -EARTH_OMEGA * position.y,
-                 EARTH_OMEGA * position.x,
-                 0.0
-            };
-            Vec3 v_rel{
-                velocity.x - v_atm.x,
-                velocity.y - v_atm.y,
-                velocity.z - v_atm.z
-            };
-
-            double v_mag = v_rel.norm();
-            if (v_mag > 1.0) {
-                double rho = AtmosphereModel::get_density_extended(alt);
-                if (rho > 1e-20) {
-                    // a_drag = -0.5 * rho * v^2 * Cd * A / m * v_hat
-                    double bc_inv = config.drag_cd * config.drag_area / config.drag_mass;
-                    double drag_mag = 0.5 * rho * v_mag * v_mag * bc_inv;
-                    double inv_v = 1.0 / v_mag;
-                    accel.x -= drag_mag * v_rel.x * inv_v;
-                    accel.y -= drag_mag * v_rel.y * inv_v;
-                    accel.z -= drag_mag * v_rel.z * inv_v;
-                }
-            }
-        }
+    // The remaining terms are the ForceModel policies (force_model.hpp)
+    if (zonals) {
+        if (config.j2) forces::J2::add(position, velocity, config, jd, accel);
+        if (config.j3) forces::J3::add(position, velocity, config, jd, accel);
+        if (config.j4) forces::J4::add(position, velocity, config, jd, accel);
     }
+    if (config.moon) forces::Moon::add(position, velocity, config, jd, accel);
+    if (config.sun) forces::Sun::add(position, velocity, config, jd, accel);
+    if (config.srp) forces::SRP::add(position, velocity, config, jd, accel);
+    if (config.drag) forces::Drag::add(position, velocity, config, jd, accel);
 
     return accel;
 }
@@ -136,11 +142,26 @@ OrbitalPerturbations::make_derivative_function(
     const PerturbationConfig& config,
     double epoch_jd) {
 
-    return [config, epoch_jd](const StateVector& state) -> StateVector {
-        // Convert simulation time to Julian Date
-        double jd = epoch_jd + state.time / 86400.0;
-        return compute_derivatives(state, config, jd);
-    };
+    return dispatch_force_model(config, [&](auto model) {
+        using Model = decltype(model);
+        return std::function<StateVector(const StateVector&)>(
+            [config, epoch_jd](const StateVector& state) -> StateVector {
+                // Convert simulation time to Julian Date
+                double jd = epoch_jd + state.time / 86400.0;
+                StateVector deriv;
+                deriv.velocity = state.velocity;
+                deriv.position = Model::acceleration(state.position, state.velocity, config, jd);
+                deriv.time = 1.0;
+                return deriv;
+            });
+    });
+}
+
+OrbitalPerturbations::AccelerationKernel
+OrbitalPerturbations::acceleration_kernel(const PerturbationConfig& config) {
+    return dispatch_force_model(config, [](auto model) -> AccelerationKernel {
+        return &decltype(model)::acceleration;
+    });
 }
 
 PerturbationBreakdown OrbitalPerturbations::compute_breakdown(
@@ -156,20 +177,22 @@ PerturbationBreakdown OrbitalPerturbations::compute_breakdown(
     bd.central_body = gravity::two_body_acceleration(position, earth.mu);
 
     // Harmonics
-    bd.j2 = config.j2 ? gravity::j2_perturbation(position, earth.mu, earth.j2, earth.radius) : ZERO_VEC;
-    bd.j3 = config.j3 ? gravity::j3_perturbation(position, earth.mu, earth.j3, earth.radius) : ZERO_VEC;
-    bd.j4 = config.j4 ? gravity::j4_perturbation(position, earth.mu, earth.j4, earth.radius) : ZERO_VEC;
+    const bool zonals = !config.gravity_field;
+    bd.j2 = config.j2 && zonals ? gravity::j2_perturbation(position, earth.mu, earth.j2, earth.radius) : ZERO_VEC;
+    bd.j3 = config.j3 && zonals ? gravity::j3_perturbation(position, earth.mu, earth.j3, earth.radius) : ZERO_VEC;
+    bd.j4 = config.j4 && zonals ? gravity::j4_perturbation(position, earth.mu, earth.j4, earth.radius) : ZERO_VEC;
+    bd.field = zonals ? ZERO_VEC : field_acceleration(position, config, jd);
 
     // Third bodies
     if (config.moon) {
-        Vec3 moon_pos = LunarEphemeris::get_moon_position_eci(jd);
+        Vec3 moon_pos = EphemerisCache::moon_eci(jd);
         bd.moon = gravity::third_body_perturbation(position, moon_pos, MOON_MU);
     } else {
         bd.moon = ZERO_VEC;
     }
 
     if (config.sun) {
-        Vec3 sun_pos = SolarEphemeris::get_sun_position_eci(jd);
+        Vec3 sun_pos = EphemerisCache::sun_eci(jd);
         bd.sun = gravity::third_body_perturbation(position, sun_pos, SUN_MU);
     } else {
         bd.sun = ZERO_VEC;
@@ -177,52 +200,22 @@ PerturbationBreakdown OrbitalPerturbations::compute_breakdown(
 
     // SRP
     if (config.srp) {
-        Vec3 sun_pos = SolarEphemeris::get_sun_position_eci(jd);
-        bd.srp = SolarRadiationPressure::compute_acceleration(
-            position, sun_pos, config.srp_params);
+        bd.srp = forces::srp_acceleration(position, config, jd);
     } else {
         bd.srp = ZERO_VEC;
     }
 
     // Drag
     bd.drag = ZERO_VEC;
-    if (config.drag) {
-        double alt = position.norm() - EARTH_RADIUS;
-        if (alt > 0.0 && alt < 200000.0) {
-            Vec3 v_atm{
-                -EARTH_OMEGA * position.y,
-                 EARTH_OMEGA * position.x,
-                 0.0
-            };
-            Vec3 v_rel{
-                velocity.x - v_atm.x,
-                velocity.y - v_atm.y,
-                velocity.z - v_atm.z
-            };
-            double v_mag = v_rel.norm();
-            if (v_mag > 1.0) {
-                double rho = AtmosphereModel::get_density_extended(alt);
-                if (rho > 1e-20) {
-                    double bc_inv = config.drag_cd * config.drag_area / config.drag_mass;
-                    double drag_mag = 0.5 * rho * v_mag * v_mag * bc_inv;
-                    double inv_v = 1.0 / v_mag;
-                    bd.drag = Vec3{
-                        -drag_mag * v_rel.x * inv_v,
-                        -drag_mag * v_rel.y * inv_v,
-                        -drag_mag * v_rel.z * inv_v
-                    };
-                }
-            }
-        }
-    }
+    if (config.drag) forces::Drag::add(position, velocity, config, jd, bd.drag);
 
     // Total
     bd.total = Vec3{
-        bd.central_body.x + bd.j2.x + bd.j3.x + bd.j4.x +
+        bd.central_body.x + bd.j2.x + bd.j3.x + bd.j4.x + bd.field.x +
         bd.moon.x + bd.sun.x + bd.srp.x + bd.drag.x,
-        bd.central_body.y + bd.j2.y + bd.j3.y + bd.j4.y +
+        bd.central_body.y + bd.j2.y + bd.j3.y + bd.j4.y + bd.field.y +
         bd.moon.y + bd.sun.y + bd.srp.y + bd.drag.y,
-        bd.central_body.z + bd.j2.z + bd.j3.z + bd.j4.z +
+        bd.central_body.z + bd.j2.z + bd.j3.z + bd.j4.z + bd.field.z +
         bd.moon.z + bd.sun.z + bd.srp.z + bd.drag.z
     };
 
@@ -7,8 +7,11 @@
  * Perturbations available:
  *   - Central body (two-body gravity)
  *   - J2, J3, J4 zonal harmonics
+ *   - Full degree/order geopotential (GravityField; replaces J2-J4)
+ *   - Optional GravityGrid table of the harmonic terms
  *   - Third-body: Moon, Sun
- *   - Solar radiation pressure (cannonball + shadow)
+ *   - Solar radiation pressure (cannonball + shadow; optional
+ *     EclipseTimeline of predicted shadow intervals)
  *   - Atmospheric drag (LEO, co-rotating atmosphere)
  */
 
@@ -17,10 +20,15 @@
 
 #include "core/state_vector.hpp"
 #include "physics/solar_radiation_pressure.hpp"
+#include "physics/gravity_grid.hpp"
+#include "physics/spherical_harmonics.hpp"
 #include <functional>
+#include <memory>
 
 namespace sim {
 
+class EclipseTimeline;
+
 /**
  * Configuration for which perturbations to include.
  * Each flag can be independently toggled.
@@ -31,6 +39,15 @@ struct PerturbationConfig {
     bool j3 = false;
     bool j4 = false;
 
+    // Spherical-harmonic field; when set it replaces j2/j3/j4
+    std::shared_ptr<const GravityField> gravity_field;
+    int field_degree = 0;            // 0 = truncate by altitude
+    int field_order = -1;            // -1 = same as degree
+    double field_tolerance = 1e-9;   // Altitude truncation threshold [m/s^2]
+
+    // Interpolated harmonics (build_harmonics_grid); exact terms outside its shell
+    std::shared_ptr<const GravityGrid> gravity_grid;
+
     // Third-body effects
     bool moon = false;
     bool sun = false;
@@ -42,6 +59,10 @@ struct PerturbationConfig {
     // SRP parameters
     SRPParameters srp_params = SRPParameters::default_satellite();
 
+    // Predicted shadow intervals (EclipseTimeline::predict); the geometric
+    // shadow test runs outside its span
+    std::shared_ptr<const EclipseTimeline> eclipses;
+
     // Drag parameters
     double drag_cd = 2.2;       // Drag coefficient
     double drag_area = 10.0;    // Cross-sectional area [m^2]
@@ -115,6 +136,7 @@ struct PerturbationBreakdown {
     Vec3 j2;
     Vec3 j3;
     Vec3 j4;
+    Vec3 field;     // GravityField harmonics (J2-J4 are zero when used)
     Vec3 moon;
     Vec3 sun;
     Vec3 srp;
@@ -159,11 +181,22 @@ public:
         const PerturbationConfig& config,
         double jd);
 
+    using AccelerationKernel = Vec3 (*)(const Vec3& position, const Vec3& velocity,
+                                        const PerturbationConfig& config, double jd);
+
+    /**
+     * compute_total_acceleration for this config's flags: the compiled
+     * ForceModel of its preset when there is one (see force_model.hpp),
+     * else compute_total_acceleration itself. Same results to rounding.
+     */
+    static AccelerationKernel acceleration_kernel(const PerturbationConfig& config);
+
     /**
      * Create a derivative function lambda for RK4Integrator::step()
      *
      * Captures config and epoch_jd. The lambda converts state.time
-     * (seconds since epoch) to Julian Date for ephemeris lookups.
+     * (seconds since epoch) to Julian Date for ephemeris lookups, and
+     * calls the compiled ForceModel of the config's preset if it has one.
      *
      * @param config Perturbation configuration
      * @param epoch_jd Julian Date at simulation time = 0
@@ -172,8 +205,18 @@ public:
     static std::function<StateVector(const StateVector&)>
     make_derivative_function(const PerturbationConfig& config, double epoch_jd);
 
+    /**
+     * Tabulate this config's harmonic terms (gravity_field, else enabled
+     * J2-J4) for PerturbationConfig::gravity_grid. The grid is sampled in
+     * the body frame; assign it to configs with the same harmonic settings.
+     */
+    static std::shared_ptr<const GravityGrid> build_harmonics_grid(
+        const PerturbationConfig& config,
+        const GravityGridConfig& grid_config);
+
     /**
      * Compute individual perturbation accelerations for diagnostics
+     * (harmonics always evaluated exactly)
      */
     static PerturbationBreakdown compute_breakdown(
         const Vec3& position,
@@ -16,6 +16,7 @@
  */
 
 #include "planetary_ephemeris.hpp"
+#include "physics/kepler_solver.hpp"
 #include <cmath>
 #include <stdexcept>
 
@@ -152,16 +153,8 @@ double PlanetaryEphemeris::solve_kepler(double M, double e, double tol) {
     M = std::fmod(M, TWO_PI);
     if (M < 0.0) M += TWO_PI;
 
-    // Initial guess
-    double E = (e < 0.8) ? M : PI;
-
-    // Newton-Raphson iteration
-    for (int iter = 0; iter < 50; ++iter) {
-        double dE = (E - e * std::sin(E) - M) / (1.0 - e * std::cos(E));
-        E -= dE;
-        if (std::fabs(dE) < tol) break;
-    }
-    return E;
+    (void)tol;
+    return kepler::eccentric_anomaly(M, e);
 }
 
 // ─────────────────────────────────────────────────────────────
@@ -205,7 +205,8 @@ private:
     static Vec3 ecliptic_to_equatorial(double x_ecl, double y_ecl, double z_ecl);
 
     /**
-     * Solve Kepler's equation M = E - e*sin(E)
+     * Solve Kepler's equation M = E - e*sin(E) for E in [0, 2 pi]
+     * (kepler::eccentric_anomaly; tol is unused)
      */
     static double solve_kepler(double M, double e, double tol = 1e-12);
 };
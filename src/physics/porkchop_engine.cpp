@@ -0,0 +1,167 @@
+/**
+ * Porkchop Engine Implementation
+ */
+
+#include "physics/porkchop_engine.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/lambert_solver.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t ROWS_PER_TASK = 8;
+
+std::vector<double> linspace(double start, double end, int steps) {
+    std::vector<double> v(std::max(steps, 0));
+    double step = (steps > 1) ? (end - start) / (steps - 1) : 0.0;
+    for (int i = 0; i < steps; i++) v[i] = start + i * step;
+    return v;
+}
+
+} // namespace
+
+int PorkchopGrid::min_c3_index() const {
+    int best = -1;
+    double best_c3 = std::numeric_limits<double>::infinity();
+    for (size_t k = 0; k < points.size(); k++) {
+        if (points[k].valid && points[k].c3_departure < best_c3) {
+            best_c3 = points[k].c3_departure;
+            best = static_cast<int>(k);
+        }
+    }
+    return best;
+}
+
+PorkchopEngine::PorkchopEngine(Planet departure, Planet arrival, const PorkchopConfig& config)
+    : departure_(departure), arrival_(arrival), config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+PorkchopGrid PorkchopEngine::generate(double launch_jd_start, double launch_jd_end,
+                                      int launch_steps,
+                                      double arrival_jd_start, double arrival_jd_end,
+                                      int arrival_steps) const {
+    return generate(linspace(launch_jd_start, launch_jd_end, launch_steps),
+                    linspace(arrival_jd_start, arrival_jd_end, arrival_steps));
+}
+
+PorkchopGrid PorkchopEngine::generate(const std::vector<double>& launch_jd,
+                                      const std::vector<double>& arrival_jd) const {
+    PorkchopGrid grid;
+    grid.launch_jd = launch_jd;
+    grid.arrival_jd = arrival_jd;
+    const size_t n_launch = launch_jd.size();
+    const size_t n_arrival = arrival_jd.size();
+    grid.points.resize(n_launch * n_arrival);
+
+    // Planet states once per date
+    std::vector<Vec3> r_dep(n_launch), v_dep(n_launch);
+    for (size_t i = 0; i < n_launch; i++) {
+        r_dep[i] = EphemerisCache::planet_hci(departure_, launch_jd[i]);
+        v_dep[i] = EphemerisCache::planet_velocity_hci(departure_, launch_jd[i]);
+    }
+    std::vector<Vec3> r_arr(n_arrival), v_arr(n_arrival);
+    for (size_t j = 0; j < n_arrival; j++) {
+        r_arr[j] = EphemerisCache::planet_hci(arrival_, arrival_jd[j]);
+        v_arr[j] = EphemerisCache::planet_velocity_hci(arrival_, arrival_jd[j]);
+    }
+
+    const PlanetaryConstants& dep_const = PlanetaryConstants::get(departure_);
+    const PlanetaryConstants& arr_const = PlanetaryConstants::get(arrival_);
+    const double r_park_dep = dep_const.radius + config_.departure_parking_alt;
+    const double r_park_arr = arr_const.radius + config_.arrival_parking_alt;
+
+    LambertOptions options;
+    options.mu = SUN_MU;
+
+    // A run of arrival rows solved one batch per row; each row's Lambert x
+    // warm-starts the next row's cells in the same launch column
+    auto rows = [&](size_t task) {
+        const size_t j_begin = task * ROWS_PER_TASK;
+        const size_t j_end = std::min(n_arrival, j_begin + ROWS_PER_TASK);
+        LambertBatch batch;
+        batch.resize(n_launch);
+        for (size_t j = j_begin; j < j_end; j++) {
+            for (size_t i = 0; i < n_launch; i++) {
+                batch.set(i, r_dep[i], r_arr[j], (arrival_jd[j] - launch_jd[i]) * 86400.0);
+            }
+            LambertSolver::solve(batch, options);
+
+            for (size_t i = 0; i < n_launch; i++) {
+                PorkchopPoint& pt = grid.points[j * n_launch + i];
+                pt.launch_jd = launch_jd[i];
+                pt.arrival_jd = arrival_jd[j];
+                pt.c3_departure = 0.0;
+                pt.c3_arrival = 0.0;
+                pt.total_delta_v = 0.0;
+                pt.valid = batch.valid[i] != 0;
+                if (!pt.valid) continue;
+
+                double v_inf_dep = (batch.v1(i) - v_dep[i]).norm();
+                double v_inf_arr = (batch.v2(i) - v_arr[j]).norm();
+                pt.c3_departure = v_inf_dep * v_inf_dep / 1e6;
+                pt.c3_arrival = v_inf_arr * v_inf_arr / 1e6;
+                pt.total_delta_v =
+                    InterplanetaryPlanner::departure_delta_v(pt.c3_departure, r_park_dep, dep_const.mu) +
+                    InterplanetaryPlanner::capture_delta_v(v_inf_arr, r_park_arr, arr_const.mu);
+            }
+        }
+    };
+
+    const size_t n_tasks = (n_arrival + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    if (pool_ && n_tasks > 1) {
+        pool_->parallel_for(n_tasks, rows);
+    } else {
+        for (size_t t = 0; t < n_tasks; t++) rows(t);
+    }
+
+    return grid;
+}
+
+std::vector<PorkchopGrid> PorkchopEngine::generate_refined(
+    double launch_jd_start, double launch_jd_end, int launch_steps,
+    double arrival_jd_start, double arrival_jd_end, int arrival_steps) const {
+
+    std::vector<PorkchopGrid> grids;
+    grids.push_back(generate(launch_jd_start, launch_jd_end, launch_steps,
+                             arrival_jd_start, arrival_jd_end, arrival_steps));
+
+    const int span = std::max(1, config_.refine_span);
+    const int factor = std::max(2, config_.refine_factor);
+
+    // Zoom window [center - span * step, center + span * step], kept
+    // inside the requested window
+    auto zoom = [&](const std::vector<double>& dates, size_t k,
+                    double lo, double hi) {
+        if (dates.size() < 2) return dates;
+        double step = dates[1] - dates[0];
+        double start = std::max(lo, dates[k] - span * step);
+        double end = std::min(hi, dates[k] + span * step);
+        int steps = static_cast<int>(std::lround((end - start) / step * factor)) + 1;
+        return linspace(start, end, std::max(steps, 2));
+    };
+
+    for (int level = 0; level < config_.refine_levels; level++) {
+        const PorkchopGrid& prev = grids.back();
+        int best = prev.min_c3_index();
+        if (best < 0) break;
+        size_t col = static_cast<size_t>(best) % prev.launch_jd.size();
+        size_t row = static_cast<size_t>(best) / prev.launch_jd.size();
+
+        std::vector<double> launch = zoom(prev.launch_jd, col, launch_jd_start, launch_jd_end);
+        std::vector<double> arrival = zoom(prev.arrival_jd, row, arrival_jd_start, arrival_jd_end);
+        grids.push_back(generate(launch, arrival));
+    }
+
+    return grids;
+}
+
+}  // namespace sim
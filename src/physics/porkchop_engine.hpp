@@ -0,0 +1,97 @@
+/**
+ * Porkchop Engine
+ *
+ * Batch porkchop-plot generation for InterplanetaryPlanner.
+ *
+ * Planet states are looked up once per distinct launch and arrival date
+ * (not once per cell). Each arrival row is one LambertSolver batch; runs
+ * of rows are solved in parallel, and within a run each cell's Izzo x
+ * warm-starts the cell one row further on in the same launch column.
+ *
+ * generate_refined() zooms in on the departure-C3 minimum: each pass
+ * regrids the cells around the previous pass's minimum at a finer date
+ * spacing, so a sharp minimum can be located without a dense full grid.
+ *
+ * An engine owns its worker pool; calls on one engine must not overlap.
+ */
+
+#ifndef SIM_PORKCHOP_ENGINE_HPP
+#define SIM_PORKCHOP_ENGINE_HPP
+
+#include "physics/interplanetary_planner.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+/**
+ * @brief Porkchop grid over launch (columns) x arrival (rows) dates
+ */
+struct PorkchopGrid {
+    std::vector<double> launch_jd;
+    std::vector<double> arrival_jd;
+    std::vector<PorkchopPoint> points;  // Row-major (arrival row, launch col)
+
+    const PorkchopPoint& at(int row, int col) const {
+        return points[static_cast<size_t>(row) * launch_jd.size() + col];
+    }
+
+    /** Index of the valid point with the lowest departure C3 (-1 if none) */
+    int min_c3_index() const;
+};
+
+struct PorkchopConfig {
+    double departure_parking_alt = 200e3;  // [m]
+    double arrival_parking_alt = 200e3;    // [m]
+    int num_threads = 0;                   // 0 = hardware concurrency, 1 = serial
+
+    // generate_refined()
+    int refine_levels = 2;                 // Passes after the coarse grid
+    int refine_span = 2;                   // Cells refined on each side of the minimum
+    int refine_factor = 4;                 // Subdivisions per cell on each pass
+};
+
+class PorkchopEngine {
+public:
+    PorkchopEngine(Planet departure, Planet arrival,
+                   const PorkchopConfig& config = PorkchopConfig());
+
+    /**
+     * @brief Evaluate a porkchop grid
+     *
+     * Same grid layout and invalid-point rules as
+     * InterplanetaryPlanner::generate_porkchop.
+     */
+    PorkchopGrid generate(double launch_jd_start, double launch_jd_end, int launch_steps,
+                          double arrival_jd_start, double arrival_jd_end,
+                          int arrival_steps) const;
+
+    /** Evaluate a grid over explicit (ascending) date lists */
+    PorkchopGrid generate(const std::vector<double>& launch_jd,
+                          const std::vector<double>& arrival_jd) const;
+
+    /**
+     * @brief Coarse grid plus refine_levels zoom passes around the C3 minimum
+     *
+     * Each pass spans refine_span cells on either side of the previous
+     * minimum at 1/refine_factor of the previous spacing. Passes stop early
+     * if a grid has no valid point.
+     *
+     * @return Grids from coarsest to finest
+     */
+    std::vector<PorkchopGrid> generate_refined(
+        double launch_jd_start, double launch_jd_end, int launch_steps,
+        double arrival_jd_start, double arrival_jd_end, int arrival_steps) const;
+
+private:
+    Planet departure_;
+    Planet arrival_;
+    PorkchopConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+};
+
+}  // namespace sim
+
+#endif  // SIM_PORKCHOP_ENGINE_HPP
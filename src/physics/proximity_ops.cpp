@@ -121,11 +121,9 @@ RelativeState ProximityOps::propagate_cw(const RelativeState& initial,
     return result;
 }
 
-std::pair<Vec3, Vec3> ProximityOps::cw_transfer(const Vec3& r0, const Vec3& rf,
-                                                 double tof, double n) {
-    // Use CWTargeting's STM for the underlying CW math
-    CWStateMatrix m = CWTargeting::compute_state_matrix(n, tof);
-
+/// cw_transfer through precomputed matrices for the time of flight
+static std::pair<Vec3, Vec3> cw_transfer_with(const CWStateMatrix& m,
+                                              const Vec3& r0, const Vec3& rf) {
     // Solve: rf = Phi_rr * r0 + Phi_rv * v0
     // =>     Phi_rv * v0 = rf - Phi_rr * r0
     Vec3 rhs;
@@ -141,23 +139,27 @@ std::pair<Vec3, Vec3> ProximityOps::cw_transfer(const Vec3& r0, const Vec3& rf,
     v0.y = (-m.Phi_rv[1][0] * rhs.x + m.Phi_rv[0][0] * rhs.y) / det;
     v0.z = rhs.z / m.Phi_rv[2][2];
 
-    // Final velocity from CW propagation
-    RelativeState initial;
-    initial.position = r0;
-    initial.velocity = v0;
-    RelativeState final_state = propagate_cw(initial, n, tof);
+    // Final velocity from CW propagation (same matrices)
+    Vec3 r_final, v_final;
+    CWTargeting::apply_state_matrix(m, r0, v0, r_final, v_final);
 
     // dv1 = required initial velocity (assumes starting from rest)
     // dv2 = stop burn at arrival
     Vec3 dv1 = v0;
     Vec3 dv2;
-    dv2.x = -final_state.velocity.x;
-    dv2.y = -final_state.velocity.y;
-    dv2.z = -final_state.velocity.z;
+    dv2.x = -v_final.x;
+    dv2.y = -v_final.y;
+    dv2.z = -v_final.z;
 
     return std::make_pair(dv1, dv2);
 }
 
+std::pair<Vec3, Vec3> ProximityOps::cw_transfer(const Vec3& r0, const Vec3& rf,
+                                                 double tof, double n) {
+    // Use CWTargeting's STM for the underlying CW math
+    return cw_transfer_with(CWTargeting::compute_state_matrix(n, tof), r0, rf);
+}
+
 ProxOpsTrajectory ProximityOps::plan_circumnavigation(const Vec3& start_pos,
                                                        double radius,
                                                        int num_waypoints,
@@ -173,6 +175,9 @@ ProxOpsTrajectory ProximityOps::plan_circumnavigation(const Vec3& start_pos,
     double orbital_period = TWO_PI / n;
     double leg_time = orbital_period / num_waypoints;
 
+    // Every leg has the same time of flight: one set of CW matrices
+    CWStateMatrix leg_matrix = CWTargeting::compute_state_matrix(n, leg_time);
+
     Vec3 current_pos = start_pos;
 
     for (int i = 0; i < num_waypoints; i++) {
@@ -188,7 +193,7 @@ ProxOpsTrajectory ProximityOps::plan_circumnavigation(const Vec3& start_pos,
         traj.waypoints.push_back(wp);
 
         // Compute transfer to this waypoint
-        auto [dv1, dv2] = cw_transfer(current_pos, wp.position, leg_time, n);
+        auto [dv1, dv2] = cw_transfer_with(leg_matrix, current_pos, wp.position);
 
         // Combined delta-V for this leg
         Vec3 leg_dv;
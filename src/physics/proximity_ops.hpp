@@ -3,6 +3,7 @@
 
 #include "core/state_vector.hpp"
 #include "targeting/cw_targeting.hpp"
+#include <tuple>
 #include <vector>
 
 namespace sim {
@@ -0,0 +1,561 @@
+/**
+ * Small-Body Catalog Implementation
+ */
+
+#include "small_body_catalog.hpp"
+#include "kepler_solver.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double TWO_PI = 2.0 * PI;
+constexpr double J2000_JD = 2451545.0;
+constexpr double GOLDEN = 0.38196601125010515;   // 2 - phi
+
+constexpr size_t BLOCK = 256;                    // Bodies per Kepler block
+
+constexpr int CELL_BITS = 21;
+constexpr int64_t CELL_OFFSET = int64_t(1) << (CELL_BITS - 1);
+constexpr uint64_t CELL_MASK = (uint64_t(1) << CELL_BITS) - 1;
+
+// Cubic Hermite position between two trajectory samples
+Vec3 hermite_position(const StateVector& a, const StateVector& b, double t) {
+    double h = b.time - a.time;
+    if (!(h > 0.0)) return a.position;
+    double s = (t - a.time) / h;
+    double s2 = s * s;
+    double s3 = s2 * s;
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = (s3 - 2.0 * s2 + s) * h;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = (s3 - s2) * h;
+    return Vec3(h00 * a.position.x + h10 * a.velocity.x + h01 * b.position.x + h11 * b.velocity.x,
+                h00 * a.position.y + h10 * a.velocity.y + h01 * b.position.y + h11 * b.velocity.y,
+                h00 * a.position.z + h10 * a.velocity.z + h01 * b.position.z + h11 * b.velocity.z);
+}
+
+// Trajectory position at t (clamped to its span), from the bracketing samples
+Vec3 path_position(const std::vector<StateVector>& traj, double t) {
+    if (t <= traj.front().time) return traj.front().position;
+    if (t >= traj.back().time) return traj.back().position;
+    auto it = std::upper_bound(traj.begin(), traj.end(), t,
+                               [](double v, const StateVector& s) { return v < s.time; });
+    size_t k = static_cast<size_t>(it - traj.begin());
+    return hermite_position(traj[k - 1], traj[k], t);
+}
+
+struct Box {
+    double lo[3] = {std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity(),
+                    std::numeric_limits<double>::infinity()};
+    double hi[3] = {-std::numeric_limits<double>::infinity(),
+                    -std::numeric_limits<double>::infinity(),
+                    -std::numeric_limits<double>::infinity()};
+
+    void add(const Vec3& p) {
+        const double v[3] = {p.x, p.y, p.z};
+        for (int a = 0; a < 3; a++) {
+            lo[a] = std::min(lo[a], v[a]);
+            hi[a] = std::max(hi[a], v[a]);
+        }
+    }
+    void pad(double m) {
+        for (int a = 0; a < 3; a++) {
+            lo[a] -= m;
+            hi[a] += m;
+        }
+    }
+    // Distance from a point [m]
+    double distance(double x, double y, double z) const {
+        const double v[3] = {x, y, z};
+        double d2 = 0.0;
+        for (int a = 0; a < 3; a++) {
+            double d = std::max({lo[a] - v[a], v[a] - hi[a], 0.0});
+            d2 += d * d;
+        }
+        return std::sqrt(d2);
+    }
+};
+
+double distance(const Vec3& a, const Vec3& b) {
+    double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // anonymous namespace
+
+// ============================================================
+// Catalog contents
+// ============================================================
+
+SmallBodyCatalog::SmallBodyCatalog(int num_threads, const SmallBodyIndexConfig& index)
+    : index_config_(index) {
+    if (num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(num_threads);
+    }
+}
+
+SmallBodyCatalog::~SmallBodyCatalog() = default;
+
+void SmallBodyCatalog::reserve(size_t n) {
+    for (auto* v : {&epoch_, &sma_, &ecc_, &inc_, &raan_, &argp_, &m0_,
+                    &n_, &px_, &py_, &pz_, &qx_, &qy_, &qz_, &v_peri_}) {
+        v->reserve(n);
+    }
+    number_.reserve(n);
+    radius_.reserve(n);
+}
+
+void SmallBodyCatalog::clear() {
+    for (auto* v : {&epoch_, &sma_, &ecc_, &inc_, &raan_, &argp_, &m0_,
+                    &n_, &px_, &py_, &pz_, &qx_, &qy_, &qz_, &v_peri_}) {
+        v->clear();
+    }
+    number_.clear();
+    radius_.clear();
+    slices_.clear();
+}
+
+size_t SmallBodyCatalog::add(const AsteroidElements& el, uint32_t number) {
+    if (!(el.sma > 0.0) || !(el.ecc >= 0.0 && el.ecc < 1.0)) {
+        throw std::invalid_argument("SmallBodyCatalog::add: orbit must be elliptic");
+    }
+    size_t i = size();
+    number_.push_back(number);
+    epoch_.push_back(el.epoch_jd);
+    sma_.push_back(el.sma);
+    ecc_.push_back(el.ecc);
+    inc_.push_back(el.inc);
+    raan_.push_back(el.raan);
+    argp_.push_back(el.arg_pe);
+    m0_.push_back(el.mean_anomaly);
+    radius_.push_back(static_cast<float>(el.radius));
+    derive(i);
+    slices_.clear();
+    return i;
+}
+
+void SmallBodyCatalog::derive(size_t i) {
+    n_.resize(size());
+    for (auto* v : {&px_, &py_, &pz_, &qx_, &qy_, &qz_, &v_peri_}) v->resize(size());
+
+    const double a = sma_[i];
+    const double e = ecc_[i];
+    const double b = a * std::sqrt(1.0 - e * e);
+    n_[i] = std::sqrt(SUN_MU / (a * a * a));
+    v_peri_[i] = std::sqrt(SUN_MU / a * (1.0 + e) / (1.0 - e));
+
+    const double cO = std::cos(raan_[i]), sO = std::sin(raan_[i]);
+    const double cw = std::cos(argp_[i]), sw = std::sin(argp_[i]);
+    const double ci = std::cos(inc_[i]), si = std::sin(inc_[i]);
+
+    // Perifocal axes in the ecliptic frame (as asteroid_position_hci)
+    const double P[3] = {cw * cO - sw * sO * ci, cw * sO + sw * cO * ci, sw * si};
+    const double Q[3] = {-sw * cO - cw * sO * ci, -sw * sO + cw * cO * ci, cw * si};
+
+    // Ecliptic -> equatorial
+    const double ce = std::cos(OBLIQUITY_J2000), se = std::sin(OBLIQUITY_J2000);
+    px_[i] = a * P[0];
+    py_[i] = a * (P[1] * ce - P[2] * se);
+    pz_[i] = a * (P[1] * se + P[2] * ce);
+    qx_[i] = b * Q[0];
+    qy_[i] = b * (Q[1] * ce - Q[2] * se);
+    qz_[i] = b * (Q[1] * se + Q[2] * ce);
+}
+
+AsteroidElements SmallBodyCatalog::elements(size_t i) const {
+    return AsteroidElements{std::to_string(number_[i]), epoch_[i], sma_[i], ecc_[i],
+                            inc_[i], raan_[i], argp_[i], m0_[i], 0.0,
+                            static_cast<double>(radius_[i])};
+}
+
+// ============================================================
+// Propagation
+// ============================================================
+
+void SmallBodyCatalog::eccentric_anomalies(double jd, size_t begin, size_t end, double* E,
+                                           double* sin_E, double* cos_E) const {
+    const size_t count = end - begin;
+    const double* m0 = m0_.data() + begin;
+    const double* n = n_.data() + begin;
+    const double* epoch = epoch_.data() + begin;
+    const double* ecc = ecc_.data() + begin;
+
+    double M[BLOCK];
+    for (size_t off = 0; off < count; off += BLOCK) {
+        const size_t len = std::min(BLOCK, count - off);
+
+        for (size_t j = 0; j < len; j++) {
+            double m = m0[off + j] + n[off + j] * ((jd - epoch[off + j]) * 86400.0);
+            m -= TWO_PI * std::floor(m / TWO_PI);
+            M[j] = m;
+        }
+        kepler::eccentric_anomalies(M, ecc + off, E + off, len,
+                                    sin_E ? sin_E + off : nullptr, cos_E ? cos_E + off : nullptr);
+    }
+}
+
+Vec3 SmallBodyCatalog::position(size_t i, double jd) const {
+    double E, s, cE;
+    eccentric_anomalies(jd, i, i + 1, &E, &s, &cE);
+    const double c = cE - ecc_[i];
+    return Vec3(px_[i] * c + qx_[i] * s, py_[i] * c + qy_[i] * s, pz_[i] * c + qz_[i] * s);
+}
+
+StateVector SmallBodyCatalog::state(size_t i, double jd) const {
+    double E, sE, cE;
+    eccentric_anomalies(jd, i, i + 1, &E, &sE, &cE);
+    const double c = cE - ecc_[i];
+    const double E_dot = n_[i] / (1.0 - ecc_[i] * cE);
+
+    StateVector st;
+    st.position = Vec3(px_[i] * c + qx_[i] * sE, py_[i] * c + qy_[i] * sE,
+                       pz_[i] * c + qz_[i] * sE);
+    st.velocity = Vec3((qx_[i] * cE - px_[i] * sE) * E_dot,
+                       (qy_[i] * cE - py_[i] * sE) * E_dot,
+                       (qz_[i] * cE - pz_[i] * sE) * E_dot);
+    st.frame = CoordinateFrame::HELIOCENTRIC_J2000;
+    st.time = (jd - J2000_JD) * 86400.0;
+    return st;
+}
+
+void SmallBodyCatalog::positions(double jd, std::vector<double>& x, std::vector<double>& y,
+                                 std::vector<double>& z) const {
+    const size_t n = size();
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+
+    // Shards of whole blocks; E is staged in x, sin E in y, cos E in z
+    const size_t shard = 16 * BLOCK;
+    auto run = [&](size_t k) {
+        const size_t begin = k * shard;
+        const size_t end = std::min(n, begin + shard);
+        eccentric_anomalies(jd, begin, end, x.data() + begin, y.data() + begin, z.data() + begin);
+        for (size_t i = begin; i < end; i++) {
+            const double c = z[i] - ecc_[i];
+            const double s = y[i];
+            x[i] = px_[i] * c + qx_[i] * s;
+            y[i] = py_[i] * c + qy_[i] * s;
+            z[i] = pz_[i] * c + qz_[i] * s;
+        }
+    };
+    const size_t shards = (n + shard - 1) / shard;
+    if (pool_ && shards > 1) pool_->parallel_for(shards, run);
+    else for (size_t k = 0; k < shards; k++) run(k);
+}
+
+// ============================================================
+// Time-sliced spatial index
+// ============================================================
+
+double SmallBodyCatalog::slice_start(int64_t k) const {
+    return J2000_JD + static_cast<double>(k) * index_config_.slice_days;
+}
+
+uint64_t SmallBodyCatalog::cell_key(double x, double y, double z) const {
+    const double inv = 1.0 / index_config_.cell_size;
+    auto axis = [&](double v) {
+        int64_t c = static_cast<int64_t>(std::floor(v * inv)) + CELL_OFFSET;
+        c = std::min<int64_t>(std::max<int64_t>(c, 0), static_cast<int64_t>(CELL_MASK));
+        return static_cast<uint64_t>(c);
+    };
+    return (axis(x) << (2 * CELL_BITS)) | (axis(y) << CELL_BITS) | axis(z);
+}
+
+void SmallBodyCatalog::build_slice(int64_t k, Slice& out) const {
+    const size_t n = size();
+    const double half = 0.5 * index_config_.slice_days;
+    const double mid = slice_start(k) + half;
+    const double half_s = half * 86400.0;
+
+    std::vector<double> E(n), sin_E(n), cos_E(n);
+    eccentric_anomalies(mid, 0, n, E.data(), sin_E.data(), cos_E.data());
+
+    std::vector<std::pair<uint64_t, uint32_t>> keyed(n);
+    for (size_t i = 0; i < n; i++) {
+        const double c = cos_E[i] - ecc_[i];
+        const double s = sin_E[i];
+        keyed[i] = {cell_key(px_[i] * c + qx_[i] * s, py_[i] * c + qy_[i] * s,
+                             pz_[i] * c + qz_[i] * s),
+                    static_cast<uint32_t>(i)};
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    out = Slice();
+    out.body.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t b = keyed[i].second;
+        const double slack = v_peri_[b] * half_s;
+        if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+            out.cell_key.push_back(keyed[i].first);
+            out.cell_begin.push_back(static_cast<uint32_t>(i));
+            out.cell_slack.push_back(0.0f);
+        }
+        // Rounded up so the float never undercuts the body's bound
+        float& cs = out.cell_slack.back();
+        cs = std::max(cs, std::nextafter(static_cast<float>(slack),
+                                         std::numeric_limits<float>::infinity()));
+        out.max_slack = std::max(out.max_slack, static_cast<double>(cs));
+        out.body[i] = b;
+    }
+    out.cell_begin.push_back(static_cast<uint32_t>(n));
+}
+
+void SmallBodyCatalog::build_index(double jd_start, double jd_end) {
+    const double w = index_config_.slice_days;
+    const int64_t k0 = static_cast<int64_t>(std::floor((jd_start - J2000_JD) / w));
+    const int64_t k1 = static_cast<int64_t>(std::floor((jd_end - J2000_JD) / w));
+
+    std::vector<std::pair<int64_t, Slice*>> missing;
+    for (int64_t k = k0; k <= k1; k++) {
+        if (slices_.find(k) == slices_.end()) missing.push_back({k, &slices_[k]});
+    }
+
+    auto build = [&](size_t m) { build_slice(missing[m].first, *missing[m].second); };
+    if (pool_ && missing.size() > 1) pool_->parallel_for(missing.size(), build);
+    else for (size_t m = 0; m < missing.size(); m++) build(m);
+}
+
+std::vector<SmallBodyEncounter> SmallBodyCatalog::query(
+    const std::vector<StateVector>& trajectory, double epoch_jd, double radius) {
+
+    std::vector<SmallBodyEncounter> hits;
+    if (trajectory.empty() || size() == 0) return hits;
+
+    const double t_first = trajectory.front().time;
+    const double t_last = trajectory.back().time;
+    build_index(epoch_jd + t_first / 86400.0, epoch_jd + t_last / 86400.0);
+
+    const double w = index_config_.slice_days;
+    const double cs = index_config_.cell_size;
+    const int64_t k0 = static_cast<int64_t>(std::floor((epoch_jd + t_first / 86400.0 - J2000_JD) / w));
+    const int64_t k1 = static_cast<int64_t>(std::floor((epoch_jd + t_last / 86400.0 - J2000_JD) / w));
+
+    // Candidate bodies and the trajectory time window that flagged them
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> win_lo(size(), INF), win_hi(size(), -INF);
+    std::vector<uint32_t> candidates;
+
+    for (int64_t k = k0; k <= k1; k++) {
+        const Slice& sl = slices_.at(k);
+        const double t_lo = std::max(t_first, (slice_start(k) - epoch_jd) * 86400.0);
+        const double t_hi = std::min(t_last, (slice_start(k) + w - epoch_jd) * 86400.0);
+        if (t_lo > t_hi) continue;
+
+        // Path box over the slice, padded for the Hermite bulge off the chords
+        Box path;
+        path.add(path_position(trajectory, t_lo));
+        path.add(path_position(trajectory, t_hi));
+        double bulge = 0.0;
+        for (size_t s = 0; s + 1 < trajectory.size(); s++) {
+            const StateVector& a = trajectory[s];
+            const StateVector& b = trajectory[s + 1];
+            if (b.time < t_lo || a.time > t_hi) continue;
+            if (a.time >= t_lo) path.add(a.position);
+            double dv = distance(a.velocity, b.velocity);
+            bulge = std::max(bulge, dv * (b.time - a.time) / 8.0);
+        }
+        path.pad(bulge);
+
+        const double reach = radius + sl.max_slack;
+        int64_t lo[3], hi[3];
+        size_t range = 1;
+        for (int a = 0; a < 3; a++) {
+            lo[a] = static_cast<int64_t>(std::floor((path.lo[a] - reach) / cs)) + CELL_OFFSET;
+            hi[a] = static_cast<int64_t>(std::floor((path.hi[a] + reach) / cs)) + CELL_OFFSET;
+            lo[a] = std::max<int64_t>(lo[a], 0);
+            hi[a] = std::min<int64_t>(hi[a], static_cast<int64_t>(CELL_MASK));
+            range *= static_cast<size_t>(std::max<int64_t>(0, hi[a] - lo[a] + 1));
+        }
+
+        auto visit_cell = [&](size_t c) {
+            const uint64_t key = sl.cell_key[c];
+            const double ix = static_cast<double>(static_cast<int64_t>(key >> (2 * CELL_BITS)) - CELL_OFFSET);
+            const double iy = static_cast<double>(static_cast<int64_t>((key >> CELL_BITS) & CELL_MASK) - CELL_OFFSET);
+            const double iz = static_cast<double>(static_cast<int64_t>(key & CELL_MASK) - CELL_OFFSET);
+
+            // Cell box against the path box
+            double d2 = 0.0;
+            const double clo[3] = {ix * cs, iy * cs, iz * cs};
+            for (int a = 0; a < 3; a++) {
+                double d = std::max({clo[a] - path.hi[a], path.lo[a] - (clo[a] + cs), 0.0});
+                d2 += d * d;
+            }
+            if (std::sqrt(d2) > radius + sl.cell_slack[c]) return;
+
+            const double mid = slice_start(k) + 0.5 * w;
+            const double half_s = 0.5 * w * 86400.0;
+            for (uint32_t j = sl.cell_begin[c]; j < sl.cell_begin[c + 1]; j++) {
+                const uint32_t b = sl.body[j];
+                Vec3 p = position(b, mid);
+                if (path.distance(p.x, p.y, p.z) > radius + v_peri_[b] * half_s) continue;
+                if (win_lo[b] == INF) candidates.push_back(b);
+                win_lo[b] = std::min(win_lo[b], t_lo);
+                win_hi[b] = std::max(win_hi[b], t_hi);
+            }
+        };
+
+        if (range < sl.cell_key.size()) {
+            for (int64_t ix = lo[0]; ix <= hi[0]; ix++) {
+                for (int64_t iy = lo[1]; iy <= hi[1]; iy++) {
+                    const uint64_t base = (static_cast<uint64_t>(ix) << (2 * CELL_BITS)) |
+                                          (static_cast<uint64_t>(iy) << CELL_BITS);
+                    auto first = std::lower_bound(sl.cell_key.begin(), sl.cell_key.end(),
+                                                  base | static_cast<uint64_t>(lo[2]));
+                    for (auto it = first; it != sl.cell_key.end() &&
+                                          *it <= (base | static_cast<uint64_t>(hi[2])); ++it) {
+                        visit_cell(static_cast<size_t>(it - sl.cell_key.begin()));
+                    }
+                }
+            }
+        } else {
+            for (size_t c = 0; c < sl.cell_key.size(); c++) visit_cell(c);
+        }
+    }
+
+    // Exact closest approach of every candidate over its window
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<SmallBodyEncounter> found(candidates.size());
+    auto refine = [&](size_t m) {
+        const uint32_t b = candidates[m];
+        auto dist_at = [&](double t) {
+            return distance(path_position(trajectory, t), position(b, epoch_jd + t / 86400.0));
+        };
+
+        // Samples inside the window, plus one either side
+        auto first = std::lower_bound(trajectory.begin(), trajectory.end(), win_lo[b],
+                                      [](const StateVector& s, double v) { return s.time < v; });
+        size_t s0 = static_cast<size_t>(first - trajectory.begin());
+        s0 = s0 > 0 ? s0 - 1 : 0;
+        size_t best = s0;
+        double best_d = INF;
+        for (size_t s = s0; s < trajectory.size(); s++) {
+            double d = distance(trajectory[s].position,
+                                position(b, epoch_jd + trajectory[s].time / 86400.0));
+            if (d < best_d) {
+                best_d = d;
+                best = s;
+            }
+            if (trajectory[s].time > win_hi[b]) break;
+        }
+
+        // Golden section between the neighbouring samples
+        double a = trajectory[best > 0 ? best - 1 : 0].time;
+        double c = trajectory[std::min(best + 1, trajectory.size() - 1)].time;
+        double best_t = trajectory[best].time;
+        if (c > a) {
+            double x1 = a + GOLDEN * (c - a), x2 = c - GOLDEN * (c - a);
+            double f1 = dist_at(x1), f2 = dist_at(x2);
+            for (int it = 0; it < 60 && c - a > 1e-3; it++) {
+                if (f1 < f2) {
+                    c = x2; x2 = x1; f2 = f1;
+                    x1 = a + GOLDEN * (c - a); f1 = dist_at(x1);
+                } else {
+                    a = x1; x1 = x2; f1 = f2;
+                    x2 = c - GOLDEN * (c - a); f2 = dist_at(x2);
+                }
+            }
+            double t = 0.5 * (a + c);
+            double d = dist_at(t);
+            if (d < best_d) {
+                best_d = d;
+                best_t = t;
+            }
+        }
+        found[m] = SmallBodyEncounter{b, number_[b], epoch_jd + best_t / 86400.0, best_d};
+    };
+    if (pool_ && candidates.size() > 1) pool_->parallel_for(candidates.size(), refine);
+    else for (size_t m = 0; m < candidates.size(); m++) refine(m);
+
+    for (const SmallBodyEncounter& e : found) {
+        if (e.distance <= radius) hits.push_back(e);
+    }
+    std::sort(hits.begin(), hits.end(), [](const SmallBodyEncounter& p, const SmallBodyEncounter& q) {
+        return p.distance < q.distance || (p.distance == q.distance && p.index < q.index);
+    });
+    return hits;
+}
+
+// ============================================================
+// Binary file
+// ============================================================
+
+bool SmallBodyCatalog::save(const std::string& filename) const {
+    const size_t n = size();
+    sbc::Header header{};
+    std::memcpy(header.magic, sbc::MAGIC, 4);
+    header.version = sbc::VERSION;
+    header.count = static_cast<uint32_t>(n);
+
+    std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.reserve(sizeof(header) + n * (4 + 8 * sbc::NUM_ELEMENTS + 4));
+    auto put = [&out](const auto& column) {
+        out.append(reinterpret_cast<const char*>(column.data()),
+                   column.size() * sizeof(column[0]));
+    };
+    put(number_);
+    for (const auto* col : {&epoch_, &sma_, &ecc_, &inc_, &raan_, &argp_, &m0_}) put(*col);
+    put(radius_);
+
+    const std::string tmp = filename + ".tmp";
+    std::FILE* file = std::fopen(tmp.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SmallBodyCatalog::load(const std::string& filename) {
+    clear();
+
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if (!file.read(&data[0], static_cast<std::streamsize>(data.size()))) return false;
+
+    sbc::Header header;
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, sbc::MAGIC, 4) != 0 || header.version != sbc::VERSION) {
+        return false;
+    }
+    const size_t n = header.count;
+    if (data.size() != sizeof(header) + n * (4 + 8 * sbc::NUM_ELEMENTS + 4)) return false;
+
+    size_t pos = sizeof(header);
+    auto get = [&](auto& column) {
+        column.resize(n);
+        std::memcpy(column.data(), data.data() + pos, n * sizeof(column[0]));
+        pos += n * sizeof(column[0]);
+    };
+    get(number_);
+    for (auto* col : {&epoch_, &sma_, &ecc_, &inc_, &raan_, &argp_, &m0_}) get(*col);
+    get(radius_);
+
+    for (size_t i = 0; i < n; i++) {
+        if (!(sma_[i] > 0.0) || !(ecc_[i] >= 0.0 && ecc_[i] < 1.0)) {
+            clear();
+            return false;
+        }
+    }
+    for (size_t i = 0; i < n; i++) derive(i);
+    return true;
+}
+
+}  // namespace sim
@@ -0,0 +1,186 @@
+/**
+ * Small-Body Catalog
+ *
+ * Catalog-scale asteroid set (the ~600k numbered asteroids) for flyby
+ * screening. asteroid_body.hpp propagates one AsteroidElements at a time;
+ * this holds every body's elements in structure-of-arrays form.
+ *
+ * Each body stores its orbit as perifocal basis vectors scaled by a and b,
+ * already rotated to equatorial J2000. A position is then one Kepler solve
+ * plus two multiply-adds per axis:
+ *
+ *     r = a (cos E - e) P + b sin E Q
+ *
+ * positions() solves the whole catalog in blocks with the batch
+ * kepler::eccentric_anomalies, which also returns sin E and cos E. Blocks
+ * are sharded across threads.
+ *
+ * query() finds bodies that pass within a radius of a trajectory, using a
+ * time-sliced spatial index. Each slice (slice_days long, aligned to J2000)
+ * buckets every body's position at the slice midpoint into cubic cells of
+ * cell_size. A body stays within v_peri * slice_days / 2 of its bucketed
+ * position during the slice, where v_peri is its perihelion speed, so a
+ * body is a candidate when its bucketed position lies within radius plus that
+ * bound of the trajectory's bounding box over the slice. Candidates are
+ * then checked exactly at every trajectory sample. The closest approach is
+ * refined by golden-section search on the Hermite-interpolated path.
+ * Slices are built on first use and kept (about 4 bytes per body per
+ * slice).
+ *
+ * Binary file (".sbc", little-endian, as written by the host):
+ *   header   sbc::Header (32 bytes)
+ *   u32      number[n]                Catalog number (0 = unnumbered)
+ *   f64      elements[7][n]           epoch_jd, a [m], e, i, raan, argp, M [rad]
+ *   f32      radius[n]                [m], 0 = unknown
+ *
+ * Usage:
+ *   SmallBodyCatalog cat;
+ *   cat.load("numbered.sbc");
+ *   auto hits = cat.query(leg.trajectory, leg.departure_jd, 0.05 * AU);
+ */
+
+#ifndef SIM_SMALL_BODY_CATALOG_HPP
+#define SIM_SMALL_BODY_CATALOG_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/asteroid_body.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+namespace sbc {
+
+constexpr char MAGIC[4] = {'S', 'B', 'C', 'T'};
+constexpr uint32_t VERSION = 1;
+constexpr int NUM_ELEMENTS = 7;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved[5];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 32, "small-body catalog header layout");
+
+} // namespace sbc
+
+struct SmallBodyEncounter {
+    size_t index;        // Catalog index
+    uint32_t number;     // Catalog number
+    double jd;           // Time of closest approach
+    double distance;     // [m]
+};
+
+struct SmallBodyIndexConfig {
+    double slice_days = 10.0;           // Index time slice [days]
+    double cell_size = 0.1 * AU;        // Spatial cell edge [m]
+};
+
+class SmallBodyCatalog {
+public:
+    /** @param num_threads 0 = hardware concurrency, 1 = serial */
+    explicit SmallBodyCatalog(int num_threads = 0,
+                              const SmallBodyIndexConfig& index = SmallBodyIndexConfig());
+    ~SmallBodyCatalog();
+
+    void reserve(size_t n);
+
+    /** Remove every body and index slice */
+    void clear();
+
+    /**
+     * Add a body (elliptic: 0 <= e < 1, a > 0)
+     * @return Its catalog index
+     */
+    size_t add(const AsteroidElements& elements, uint32_t number = 0);
+
+    size_t size() const { return number_.size(); }
+    uint32_t number(size_t i) const { return number_[i]; }
+
+    /** Elements of body i (name is its number, mu is 0) */
+    AsteroidElements elements(size_t i) const;
+
+    /** Heliocentric J2000 equatorial position of body i [m] */
+    Vec3 position(size_t i, double jd) const;
+
+    /** Heliocentric J2000 equatorial state of body i (analytic velocity) */
+    StateVector state(size_t i, double jd) const;
+
+    /** Every body's position at jd, per axis [m] */
+    void positions(double jd, std::vector<double>& x, std::vector<double>& y,
+                   std::vector<double>& z) const;
+
+    /**
+     * Bodies within `radius` of a trajectory, nearest first
+     *
+     * @param trajectory HCI states in ascending time, seconds since epoch_jd
+     *                   (e.g. MissionLeg::trajectory)
+     * @param epoch_jd Julian Date at trajectory time 0
+     * @param radius Encounter distance [m]
+     */
+    std::vector<SmallBodyEncounter> query(const std::vector<StateVector>& trajectory,
+                                          double epoch_jd, double radius);
+
+    /** Build the index slices covering [jd_start, jd_end] ahead of queries */
+    void build_index(double jd_start, double jd_end);
+
+    size_t index_slices() const { return slices_.size(); }
+
+    /**
+     * Write the catalog (to "<file>.tmp", then renamed over file)
+     * @return true on success
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * Read a catalog written by save(), replacing the current contents
+     * @return true on success; false leaves the catalog empty
+     */
+    bool load(const std::string& filename);
+
+private:
+    /// One index slice: bodies sorted by cell key
+    struct Slice {
+        std::vector<uint64_t> cell_key;     // Ascending, unique
+        std::vector<uint32_t> cell_begin;   // Into body, size cell_key + 1
+        std::vector<float> cell_slack;      // Max body slack in the cell [m]
+        std::vector<uint32_t> body;
+        double max_slack = 0.0;             // Over all cells [m]
+    };
+
+    SmallBodyIndexConfig index_config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+
+    // Source elements (file columns)
+    std::vector<uint32_t> number_;
+    std::vector<double> epoch_, sma_, ecc_, inc_, raan_, argp_, m0_;
+    std::vector<float> radius_;
+
+    // Derived per body
+    std::vector<double> n_;                  // Mean motion [rad/s]
+    std::vector<double> px_, py_, pz_;       // a * P (equatorial)
+    std::vector<double> qx_, qy_, qz_;       // b * Q (equatorial)
+    std::vector<double> v_peri_;             // Perihelion speed [m/s]
+
+    std::map<int64_t, Slice> slices_;        // By slice number from J2000
+
+    void derive(size_t i);
+    void eccentric_anomalies(double jd, size_t begin, size_t end, double* E,
+                             double* sin_E = nullptr, double* cos_E = nullptr) const;
+    void build_slice(int64_t k, Slice& out) const;
+    double slice_start(int64_t k) const;
+    uint64_t cell_key(double x, double y, double z) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_SMALL_BODY_CATALOG_HPP
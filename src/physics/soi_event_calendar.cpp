@@ -0,0 +1,268 @@
+/**
+ * SOI Event Calendar Implementation
+ *
+ * Dormand-Prince steps go straight through dopri5_step() with an N-body
+ * functor; after each accepted step only the bodies whose check time has
+ * come are sampled on the interpolant.
+ */
+
+#include "physics/soi_event_calendar.hpp"
+#include "physics/celestial_body.hpp"
+#include "physics/ephemeris_cache.hpp"
+#include "physics/vec3_ops.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+Vec3 position(const OrbitState6& s) { return Vec3(s.y[0], s.y[1], s.y[2]); }
+Vec3 velocity(const OrbitState6& s) { return Vec3(s.y[3], s.y[4], s.y[5]); }
+
+// Periapsis radius of the osculating conic about mu
+double periapsis(const Vec3& r, const Vec3& v, double mu) {
+    const double h2 = dot(cross(r, v), cross(r, v));
+    const double energy = 0.5 * dot(v, v) - mu / r.norm();
+    const double e = std::sqrt(std::max(0.0, 1.0 + 2.0 * energy * h2 / (mu * mu)));
+    return h2 / (mu * (1.0 + e));
+}
+
+// Largest speed on the osculating conic about mu: at periapsis, or at
+// r_min if the periapsis lies below it
+double peak_speed(const Vec3& r, const Vec3& v, double mu, double r_min) {
+    const double rn = r.norm();
+    const double v2 = dot(v, v);
+    const double rp = std::max(periapsis(r, v, mu), r_min);
+    if (rp >= rn) return std::sqrt(v2);
+    return std::sqrt(v2 + 2.0 * mu * (1.0 / rp - 1.0 / rn));
+}
+
+} // namespace
+
+SoiEventCalendar::SoiEventCalendar(const NBodyConfig& config, double epoch_jd,
+                                   const SoiCalendarConfig& calendar)
+    : config_(config), epoch_jd_(epoch_jd), calendar_(calendar) {
+    for (const auto& entry : config_.bodies) {
+        const auto& pc = PlanetaryConstants::get(entry.planet);
+        if (pc.soi_radius <= 0.0) continue;
+        Watch w;
+        w.planet = entry.planet;
+        w.mu = pc.mu;
+        w.radius = pc.radius;
+        w.soi = pc.soi_radius;
+        w.perihelion = 0.7 * pc.sma_au * AU;
+        watch_.push_back(w);
+        pull_ += pc.mu / (pc.soi_radius * pc.soi_radius);
+    }
+}
+
+OrbitState6 SoiEventCalendar::at(double t) const {
+    return (t >= dense_.t0 || !have_prev_) ? dense_.at(t) : prev_.at(t);
+}
+
+double SoiEventCalendar::event(const Watch& w, const OrbitState6& s) const {
+    const Vec3 body = EphemerisCache::planet_hci(w.planet, epoch_jd_ + s.t / 86400.0);
+    return (position(s) - body).norm() - w.soi;
+}
+
+double SoiEventCalendar::check_interval(const Watch& w, const OrbitState6& s, double g) const {
+    const double jd = epoch_jd_ + s.t / 86400.0;
+    const Vec3 r = position(s);
+    const Vec3 v = velocity(s);
+
+    double v0;          // Closing speed now
+    double accel = 0.0; // Bound on its rate of change
+    if (w.inside) {
+        // Exit: the relative speed here bounds it at every larger distance
+        v0 = (v - EphemerisCache::planet_velocity_hci(w.planet, jd)).norm();
+    } else {
+        const Vec3 vw = EphemerisCache::planet_velocity_hci(w.planet, jd);
+        double q;
+        if (primary_ >= 0) {
+            // Entry from inside another SOI: that body's motion plus the
+            // fastest the spacecraft moves about it
+            const Watch& p = watch_[primary_];
+            const Vec3 rp = r - EphemerisCache::planet_hci(p.planet, jd);
+            const Vec3 vp = EphemerisCache::planet_velocity_hci(p.planet, jd);
+            v0 = (vp - vw).norm() + peak_speed(rp, v - vp, p.mu, p.radius);
+            q = p.perihelion;
+        } else {
+            v0 = (v - vw).norm();
+            q = std::max(periapsis(r, v, SUN_MU), SUN_RADIUS);
+        }
+        // Sun on each at its closest, plus every planet at its SOI edge
+        accel = SUN_MU / (q * q) + SUN_MU / (w.perihelion * w.perihelion) + pull_;
+    }
+
+    // Earliest |g| can be closed: v0 t + accel t^2 / 2 = |g|
+    const double d = std::max(std::fabs(g), calendar_.min_check_distance);
+    v0 *= calendar_.speed_margin;
+    accel *= calendar_.speed_margin;
+    const double dt = 2.0 * d / (v0 + std::sqrt(v0 * v0 + 2.0 * accel * d) + 1e-12);
+    return std::min(dt, calendar_.max_check_interval);
+}
+
+void SoiEventCalendar::start(const OrbitState6& s) {
+    primary_ = -1;
+    for (size_t i = 0; i < watch_.size(); i++) {
+        Watch& w = watch_[i];
+        w.last_t = s.t;
+        w.last_g = event(w, s);
+        w.inside = w.last_g < 0.0;
+        if (w.inside && primary_ < 0) primary_ = static_cast<int>(i);
+    }
+    for (auto& w : watch_) w.next_t = s.t + check_interval(w, s, w.last_g);
+
+    end_ = s;
+    started_ = true;
+    dt_ = 0.0;
+    have_dense_ = false;
+    have_prev_ = false;
+}
+
+bool SoiEventCalendar::propagate_to_next(StateVector& state_hci, double duration,
+                                         const AdaptiveConfig& config, SoiEvent* event_out) {
+    OrbitState6 s{state_hci.time, {state_hci.position.x, state_hci.position.y,
+                                   state_hci.position.z, state_hci.velocity.x,
+                                   state_hci.velocity.y, state_hci.velocity.z}};
+    if (!started_ || s.t != end_.t || s.y != end_.y) start(s);
+    if (dt_ <= 0.0) dt_ = std::max(std::min(duration * 0.001, config.dt_max), config.dt_min);
+
+    auto rhs = [this](double t, const std::array<double, 6>& y, std::array<double, 6>& dydt) {
+        const Vec3 a = NBodyGravity::compute_acceleration_hci(
+            Vec3(y[0], y[1], y[2]), epoch_jd_ + t / 86400.0, config_);
+        dydt = {y[3], y[4], y[5], a.x, a.y, a.z};
+    };
+
+    // Crosses between w's last check and tc (where it reads g), on the
+    // new side of the boundary
+    auto locate = [&](const Watch& w, double tc, double g, OrbitState6& root) {
+        const double t_valid = have_prev_ ? prev_.t0 : dense_.t0;
+        double ta = w.last_t, ga = w.last_g;
+        double tb = tc, gb = g;
+        root = at(tb);
+        if (ta < t_valid) {
+            // Past the interpolants (a floored check interval); the crossing
+            // is no later than t_valid if the sign has flipped already
+            ta = t_valid;
+            ga = event(w, at(ta));
+            if ((ga < 0.0) != w.inside) {
+                root = at(ta);
+                return ta;
+            }
+        }
+        int side = 0;
+        for (int i = 0; i < 100 && tb - ta > calendar_.root_tolerance; i++) {
+            double t = (ta * gb - tb * ga) / (gb - ga);
+            if (!(t > ta && t < tb)) t = 0.5 * (ta + tb);
+            const OrbitState6 st = at(t);
+            const double gt = event(w, st);
+            if ((gt < 0.0) != w.inside) {
+                tb = t;
+                gb = gt;
+                root = st;
+                if (side == -1) ga *= 0.5;
+                side = -1;
+            } else {
+                ta = t;
+                ga = gt;
+                if (side == 1) gb *= 0.5;
+                side = 1;
+            }
+        }
+        return tb;
+    };
+
+    const double t_end = s.t + duration;
+    int hit = -1;
+    double hit_t = 0.0;
+    OrbitState6 hit_s;
+    int steps = 0;
+    while (s.t < t_end && steps < config.max_steps) {
+        const double dt_try = std::min(dt_, t_end - s.t);
+        if (dt_try < 1e-10) break;
+
+        prev_ = dense_;
+        have_prev_ = have_dense_;
+        FixedStep<6> r = dopri5_step(s, dt_try, rhs, config, &dense_);
+        have_dense_ = true;
+        dt_ = r.dt_next;
+        steps++;
+        stats_.steps++;
+        const double t1 = r.state.t;
+
+        for (size_t i = 0; i < watch_.size(); i++) {
+            Watch& w = watch_[i];
+            if (w.next_t > t1) {
+                stats_.skipped++;
+                continue;
+            }
+            while (w.next_t <= t1) {
+                const double tc = std::max(w.next_t, s.t);
+                const OrbitState6 sc = tc == t1 ? r.state : at(tc);
+                const double g = event(w, sc);
+                stats_.checks++;
+                if ((g < 0.0) != w.inside) {
+                    OrbitState6 root;
+                    const double tr = locate(w, tc, g, root);
+                    if (hit < 0 || tr < hit_t) {
+                        hit = static_cast<int>(i);
+                        hit_t = tr;
+                        hit_s = root;
+                    }
+                    break;
+                }
+                w.last_t = tc;
+                w.last_g = g;
+                w.next_t = tc + check_interval(w, sc, g);
+            }
+        }
+
+        if (hit >= 0) break;
+        s = r.state;
+    }
+
+    if (hit >= 0) {
+        Watch& w = watch_[hit];
+        w.inside = !w.inside;
+        if (w.inside) {
+            primary_ = hit;
+        } else if (primary_ == hit) {
+            primary_ = -1;
+        }
+        w.last_t = hit_t;
+        w.last_g = event(w, hit_s);
+        w.next_t = hit_t + check_interval(w, hit_s, w.last_g);
+        s = hit_s;
+        stats_.events++;
+    }
+
+    end_ = s;
+    state_hci.position = position(s);
+    state_hci.velocity = velocity(s);
+    state_hci.time = s.t;
+    state_hci.frame = CoordinateFrame::HELIOCENTRIC_J2000;
+
+    if (hit >= 0 && event_out) {
+        event_out->time = s.t;
+        event_out->body = watch_[hit].planet;
+        event_out->entry = watch_[hit].inside;
+        event_out->state = state_hci;
+    }
+    return hit >= 0;
+}
+
+std::vector<SoiEvent> SoiEventCalendar::propagate(StateVector& state_hci, double duration,
+                                                  const AdaptiveConfig& config) {
+    std::vector<SoiEvent> events;
+    const double t_end = state_hci.time + duration;
+    SoiEvent e;
+    while (state_hci.time < t_end &&
+           propagate_to_next(state_hci, t_end - state_hci.time, config, &e)) {
+        events.push_back(e);
+    }
+    return events;
+}
+
+}  // namespace sim
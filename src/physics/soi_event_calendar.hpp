@@ -0,0 +1,144 @@
+/**
+ * SOI Event Calendar
+ *
+ * Locates sphere-of-influence entries and exits during an N-body
+ * propagation without scanning every body after every step, as polling
+ * NBodyGravity::check_soi_transition does.
+ *
+ * Each watched body keeps its own next check time. A check samples the
+ * event function g = |r - r_body| - r_soi at one time, on the step's dense
+ * output and the cached ephemeris. The next check is the earliest time
+ * the closing speed could cover |g|: with closing speed v0 now and a bound
+ * A on its rate of change, g keeps its sign until
+ *
+ *     t + 2 |g| / (v0 + sqrt(v0^2 + 2 A |g|))
+ *
+ * and a body whose check time lies past the end of a step is not looked
+ * at during it. The bounds are two-body estimates:
+ *
+ *   entry    v0 is the speed relative to the body (from inside another
+ *            SOI: that body's relative speed plus the periapsis speed about
+ *            it). A is the Sun's pull on the spacecraft at the perihelion
+ *            of its osculating orbit and on the body at 0.7 a (e <= 0.25),
+ *            plus every watched planet's pull at its SOI edge.
+ *   exit     v0 is the speed relative to the primary here, which energy
+ *            conservation caps at every larger distance; A = 0.
+ *
+ * speed_margin scales both for the perturbations the estimates leave out.
+ * Checks are at least the time to cover min_check_distance apart, so a
+ * grazing pass that stays that close to the boundary can be missed, and
+ * at most max_check_interval apart.
+ *
+ * A sign change between two checks is refined by Illinois regula falsi
+ * on the Dormand-Prince interpolant (the current step's or the one
+ * before), with no extra force evaluations. Propagation stops at the
+ * earliest crossing, so a frame switch through hci_to_body_centered
+ * happens at the boundary itself.
+ */
+
+#ifndef SIM_SOI_EVENT_CALENDAR_HPP
+#define SIM_SOI_EVENT_CALENDAR_HPP
+
+#include "physics/nbody_gravity.hpp"
+#include "propagators/adaptive_integrator.hpp"
+#include "propagators/integrator_kernels.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace sim {
+
+/// One SOI boundary crossing
+struct SoiEvent {
+    double time = 0.0;                  // Seconds since epoch_jd
+    Planet body = Planet::EARTH;
+    bool entry = false;                 // Entered body's SOI (else left it)
+    StateVector state;                  // HCI state at the crossing
+};
+
+struct SoiCalendarConfig {
+    double speed_margin = 1.25;         // Multiplies the closing speed and its rate bound
+    double min_check_distance = 1e3;    // Smallest |g| a check interval is based on [m]
+    double max_check_interval = 30.0 * 86400.0;  // [s]
+    double root_tolerance = 1e-3;       // Crossing time [s]
+};
+
+struct SoiCalendarStats {
+    size_t steps = 0;                   // Accepted integrator steps
+    size_t checks = 0;                  // Event function evaluations, root finding excluded
+    size_t skipped = 0;                 // (step, body) pairs with no check
+    size_t events = 0;
+};
+
+class SoiEventCalendar {
+public:
+    /**
+     * Watch the SOIs of config.bodies; gravity is config's, and state
+     * times are seconds since epoch_jd as in make_derivative_function()
+     */
+    SoiEventCalendar(const NBodyConfig& config, double epoch_jd,
+                     const SoiCalendarConfig& calendar = SoiCalendarConfig());
+
+    /**
+     * Propagate an HCI state by Dormand-Prince until the next SOI crossing
+     * or for duration, whichever comes first. The step size and check
+     * times carry over when state_hci is the one the last call returned;
+     * any other state (after a maneuver, say) starts afresh.
+     *
+     * @param state_hci Advanced in place, to the crossing if one was found
+     * @param event Receives the crossing (optional)
+     * @return Whether a crossing ended the propagation
+     */
+    bool propagate_to_next(StateVector& state_hci, double duration,
+                           const AdaptiveConfig& config, SoiEvent* event = nullptr);
+
+    /**
+     * propagate_to_next() repeatedly over the whole duration
+     * @return Every crossing, in time order
+     */
+    std::vector<SoiEvent> propagate(StateVector& state_hci, double duration,
+                                    const AdaptiveConfig& config);
+
+    /// Whether the last state was inside a watched SOI, and which
+    /// (config.central_body when heliocentric)
+    bool in_soi() const { return primary_ >= 0; }
+    Planet primary() const { return in_soi() ? watch_[primary_].planet : config_.central_body; }
+
+    const SoiCalendarStats& stats() const { return stats_; }
+
+private:
+    struct Watch {
+        Planet planet;
+        double mu;
+        double radius;
+        double soi;
+        double perihelion;              // Closest approach to the Sun, bound [m]
+        bool inside = false;
+        double last_t = 0.0;            // Last check
+        double last_g = 0.0;
+        double next_t = 0.0;            // Next check
+    };
+
+    NBodyConfig config_;
+    double epoch_jd_;
+    SoiCalendarConfig calendar_;
+    std::vector<Watch> watch_;
+    double pull_ = 0.0;                 // Sum of mu / r_soi^2 over watch_ [m/s^2]
+    int primary_ = -1;                  // Index in watch_, -1 heliocentric
+    OrbitState6 end_;                   // State the last call returned
+    bool started_ = false;
+    double dt_ = 0.0;                   // Next step size
+    Dopri5Dense<6> dense_;              // Last step, which covers end_
+    Dopri5Dense<6> prev_;               // Step before it
+    bool have_dense_ = false;
+    bool have_prev_ = false;
+    SoiCalendarStats stats_;
+
+    void start(const OrbitState6& s);
+    OrbitState6 at(double t) const;
+    double event(const Watch& w, const OrbitState6& s) const;
+    double check_interval(const Watch& w, const OrbitState6& s, double g) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_SOI_EVENT_CALENDAR_HPP
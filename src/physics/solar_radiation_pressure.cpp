@@ -11,9 +11,16 @@ Vec3 SolarRadiationPressure::compute_acceleration(
     const Vec3& pos_eci,
     const Vec3& sun_pos_eci,
     const SRPParameters& params) {
+    return compute_acceleration(pos_eci, sun_pos_eci, params, is_in_shadow(pos_eci, sun_pos_eci));
+}
+
+Vec3 SolarRadiationPressure::compute_acceleration(
+    const Vec3& pos_eci,
+    const Vec3& sun_pos_eci,
+    const SRPParameters& params,
+    bool in_shadow) {
 
-    // Check shadow first
-    if (is_in_shadow(pos_eci, sun_pos_eci)) {
+    if (in_shadow) {
         return Vec3{0.0, 0.0, 0.0};
     }
 
@@ -55,6 +55,16 @@ public:
         const Vec3& sun_pos_eci,
         const SRPParameters& params);
 
+    /**
+     * SRP acceleration with the shadow state supplied by the caller
+     * (e.g. an EclipseTimeline lookup) instead of the geometric test
+     */
+    static Vec3 compute_acceleration(
+        const Vec3& pos_eci,
+        const Vec3& sun_pos_eci,
+        const SRPParameters& params,
+        bool in_shadow);
+
     /**
      * Check if spacecraft is in Earth's cylindrical shadow
      *
@@ -0,0 +1,211 @@
+/**
+ * Spherical-Harmonic Gravity Field Implementation
+ */
+
+#include "physics/spherical_harmonics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr int STACK_DEGREE = 24;  // 2 x 351 doubles of scratch
+
+// Fortran exponents ("1.0D-06") as C doubles
+double parse_number(std::string token) {
+    std::replace(token.begin(), token.end(), 'D', 'E');
+    std::replace(token.begin(), token.end(), 'd', 'e');
+    return std::stod(token);
+}
+
+} // namespace
+
+GravityField::GravityField(double mu, double radius, int max_degree)
+    : mu_(mu), radius_(radius), max_degree_(std::max(max_degree, 2)) {
+    const int N = max_degree_;
+    const std::size_t coef = tri(N + 1, 0);
+    const std::size_t rec = tri(N + 2, 0);
+    c_.assign(coef, 0.0);
+    s_.assign(coef, 0.0);
+    fa_.assign(coef, 0.0);
+    fb_.assign(coef, 0.0);
+    fz_.assign(coef, 0.0);
+    rec_a_.assign(rec, 0.0);
+    rec_b_.assign(rec, 0.0);
+    sect_.assign(N + 3, 0.0);
+    degree_scale_.assign(N + 1, 0.0);
+
+    // Normalized Cunningham recursion factors (rows up to N + 1)
+    for (int m = 1; m <= N + 2; m++) {
+        sect_[m] = m == 1 ? std::sqrt(3.0) : std::sqrt((2.0 * m + 1.0) / (2.0 * m));
+    }
+    for (int n = 1; n <= N + 1; n++) {
+        for (int m = 0; m < n; m++) {
+            const double dn = n, dm = m;
+            rec_a_[tri(n, m)] = std::sqrt((2 * dn + 1) * (2 * dn - 1) / ((dn - dm) * (dn + dm)));
+            if (n >= m + 2) {
+                rec_b_[tri(n, m)] = std::sqrt((2 * dn + 1) * (dn + dm - 1) * (dn - dm - 1) /
+                                              ((2 * dn - 3) * (dn + dm) * (dn - dm)));
+            }
+        }
+    }
+
+    // Acceleration terms use V̄ of degree n + 1; fold in N(n,m)/N(n+1,k)
+    // and the Montenbruck & Gill weights (1/2, factorial ratios)
+    for (int n = 2; n <= N; n++) {
+        const double dn = n;
+        const double g = (2 * dn + 1) / (2 * dn + 3);
+        fa_[tri(n, 0)] = std::sqrt(0.5 * g * (dn + 1) * (dn + 2));
+        fz_[tri(n, 0)] = std::sqrt(g * (dn + 1) * (dn + 1));
+        for (int m = 1; m <= n; m++) {
+            const double dm = m;
+            const double norm_prev = m == 1 ? 2.0 : 1.0;
+            const std::size_t k = tri(n, m);
+            fa_[k] = 0.5 * std::sqrt(g * (dn + dm + 1) * (dn + dm + 2));
+            fb_[k] = 0.5 * std::sqrt(norm_prev * g * (dn - dm + 1) * (dn - dm + 2));
+            fz_[k] = std::sqrt(g * (dn - dm + 1) * (dn + dm + 1));
+        }
+    }
+}
+
+GravityField GravityField::load(const std::string& filename, int max_degree,
+                                double mu, double radius) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open gravity field file: " + filename);
+    }
+
+    struct Row { int n, m; double c, s; };
+    std::vector<Row> rows;
+    int top = 0;
+    bool in_header = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ls(line);
+        std::string first;
+        if (!(ls >> first)) continue;
+
+        // ICGEM: header keys until end_of_head, then "gfc n m C S ..." rows
+        if (first == "product_type" || first == "modelname" || first == "begin_of_head") {
+            in_header = true;
+        }
+        if (in_header) {
+            std::string value;
+            if (first == "earth_gravity_constant" && ls >> value) mu = parse_number(value);
+            if (first == "radius" && ls >> value) radius = parse_number(value);
+            if (first == "end_of_head") in_header = false;
+            continue;
+        }
+
+        std::string sn, sm, sc, ss;
+        if (first == "gfc" || first == "gfct") {
+            if (!(ls >> sn >> sm >> sc >> ss)) continue;
+        } else {
+            sn = first;
+            if (!(ls >> sm >> sc >> ss)) continue;
+        }
+        Row row;
+        try {
+            row = Row{std::stoi(sn), std::stoi(sm), parse_number(sc), parse_number(ss)};
+        } catch (const std::exception&) {
+            continue;  // Comment or unrecognized line
+        }
+        if (row.n < 2 || row.m > row.n) continue;  // Central and degree-1 terms are not used
+        if (max_degree >= 0 && row.n > max_degree) continue;
+        top = std::max(top, row.n);
+        rows.push_back(row);
+    }
+
+    if (rows.empty()) {
+        throw std::runtime_error("No gravity coefficients in: " + filename);
+    }
+
+    GravityField field(mu, radius, top);
+    for (const Row& row : rows) {
+        field.c_[tri(row.n, row.m)] = row.c;
+        field.s_[tri(row.n, row.m)] = row.s;
+    }
+    for (int n = 2; n <= top; n++) field.update_degree_scale(n);
+    return field;
+}
+
+GravityField GravityField::from_zonals(double mu, double radius, const std::vector<double>& j) {
+    GravityField field(mu, radius, static_cast<int>(j.size()) + 1);
+    for (size_t i = 0; i < j.size(); i++) {
+        const int n = static_cast<int>(i) + 2;
+        field.set_coefficient(n, 0, -j[i] / std::sqrt(2.0 * n + 1.0), 0.0);
+    }
+    return field;
+}
+
+void GravityField::set_coefficient(int n, int m, double c, double s) {
+    if (n < 2 || n > max_degree_ || m < 0 || m > n) {
+        throw std::out_of_range("Gravity coefficient outside field degree");
+    }
+    c_[tri(n, m)] = c;
+    s_[tri(n, m)] = m == 0 ? 0.0 : s;
+    update_degree_scale(n);
+}
+
+void GravityField::update_degree_scale(int n) {
+    double sum = 0.0;
+    for (int m = 0; m <= n; m++) {
+        sum += c_[tri(n, m)] * c_[tri(n, m)] + s_[tri(n, m)] * s_[tri(n, m)];
+    }
+    degree_scale_[n] = (n + 1) * std::sqrt(sum);
+}
+
+int GravityField::degree_for_radius(double r, double tolerance) const {
+    // |a_n| ~ mu/r^2 (R/r)^n (n+1) RMS_n
+    const double q = radius_ / r;
+    double term = mu_ / (r * r) * q;
+    int degree = 0;
+    for (int n = 2; n <= max_degree_; n++) {
+        term *= q;
+        if (term * degree_scale_[n] > tolerance) degree = n;
+    }
+    return degree;
+}
+
+Vec3 GravityField::acceleration(const Vec3& r_body, int degree, int order) const {
+    degree = std::min(degree, max_degree_);
+    if (degree < 2) return Vec3(0.0, 0.0, 0.0);
+    order = std::max(0, std::min(order, degree));
+
+    // Low degrees fit on the stack; the rest grow a per-thread buffer once
+    if (degree <= STACK_DEGREE) {
+        std::array<double, scratch_size(STACK_DEGREE)> v, w;
+        return evaluate<0>(r_body, degree, order, v.data(), w.data());
+    }
+    thread_local std::vector<double> v, w;
+    const std::size_t need = scratch_size(degree);
+    if (v.size() < need) {
+        v.resize(need);
+        w.resize(need);
+    }
+    return evaluate<0>(r_body, degree, order, v.data(), w.data());
+}
+
+Vec3 GravityField::acceleration_inertial(const Vec3& r_inertial, double rotation_angle,
+                                         int degree, int order) const {
+    const double c = std::cos(rotation_angle);
+    const double s = std::sin(rotation_angle);
+    Vec3 rb(c * r_inertial.x + s * r_inertial.y,
+            -s * r_inertial.x + c * r_inertial.y,
+            r_inertial.z);
+    Vec3 ab = acceleration(rb, degree, order);
+    return Vec3(c * ab.x - s * ab.y, s * ab.x + c * ab.y, ab.z);
+}
+
+double GravityField::gmst(double jd) {
+    double deg = std::fmod(280.46061837 + 360.98564736629 * (jd - 2451545.0), 360.0);
+    if (deg < 0.0) deg += 360.0;
+    return deg * PI / 180.0;
+}
+
+}  // namespace sim
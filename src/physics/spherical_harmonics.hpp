@@ -0,0 +1,204 @@
+/**
+ * Spherical-Harmonic Gravity Field
+ *
+ * Degree/order geopotential from fully normalized coefficients
+ * (C̄nm, S̄nm), e.g. EGM96/EGM2008 as distributed in ICGEM .gfc or the
+ * plain "n m C S" ASCII tables.
+ *
+ * Evaluation is the Cunningham V/W recursion (Montenbruck & Gill §3.2)
+ * carried out on normalized V̄nm = Nnm Vnm, so it stays in range to high
+ * degree. All recursion and acceleration factors are precomputed when
+ * the field is built; an evaluation is O(N·M) multiply-adds in scratch
+ * that is allocated once per thread (one sqrt, no trig).
+ *
+ * The acceleration returned excludes the central (n = 0) term, like
+ * gravity::j2_perturbation: callers add the two-body term themselves.
+ *
+ * degree_for_radius() truncates per altitude: terms whose estimated
+ * magnitude at that radius falls below a tolerance are dropped, so a GEO
+ * object evaluates a handful of degrees where a LEO one needs dozens.
+ * acceleration_fixed<N>() compiles the recursion with constant bounds
+ * and stack scratch for a fixed truncation.
+ */
+
+#ifndef SIM_SPHERICAL_HARMONICS_HPP
+#define SIM_SPHERICAL_HARMONICS_HPP
+
+#include "core/state_vector.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class GravityField {
+public:
+    GravityField() = default;
+
+    /**
+     * Empty field (all coefficients zero) up to max_degree.
+     * @param mu Gravitational parameter the coefficients refer to [m^3/s^2]
+     * @param radius Reference radius [m]
+     */
+    GravityField(double mu, double radius, int max_degree);
+
+    /**
+     * Load normalized coefficients from an ICGEM .gfc file, or from a plain
+     * table of "n m C S [sigmaC sigmaS]" rows (Fortran 'D' exponents
+     * accepted). Rows above max_degree are skipped.
+     *
+     * @param mu, radius Used for plain tables; .gfc headers override them
+     * @param max_degree Truncate at load (-1 = file's full degree)
+     * @throws std::runtime_error if the file cannot be read or has no rows
+     */
+    static GravityField load(const std::string& filename, int max_degree = -1,
+                             double mu = 3.986004418e14, double radius = 6378137.0);
+
+    /** Zonal-only field from unnormalized J2..Jn (J[0] = J2). */
+    static GravityField from_zonals(double mu, double radius, const std::vector<double>& j);
+
+    /** Set one normalized coefficient pair. */
+    void set_coefficient(int n, int m, double c, double s);
+    double c(int n, int m) const { return c_[tri(n, m)]; }
+    double s(int n, int m) const { return s_[tri(n, m)]; }
+
+    double mu() const { return mu_; }
+    double radius() const { return radius_; }
+    int max_degree() const { return max_degree_; }
+
+    /**
+     * Highest degree whose estimated acceleration at radius r exceeds
+     * tolerance (from each degree's coefficient RMS).
+     * @return Degree in [2, max_degree], or 0 if no term reaches tolerance
+     */
+    int degree_for_radius(double r, double tolerance) const;
+
+    /**
+     * Non-central acceleration at a body-fixed position.
+     * @param degree, order Truncation (clamped to the field; order <= degree)
+     * @return Body-fixed acceleration [m/s^2]
+     */
+    Vec3 acceleration(const Vec3& r_body, int degree, int order) const;
+
+    /**
+     * As acceleration(), for an inertial position with the body rotated by
+     * `rotation_angle` about z (GMST for Earth).
+     * @return Inertial acceleration [m/s^2]
+     */
+    Vec3 acceleration_inertial(const Vec3& r_inertial, double rotation_angle,
+                               int degree, int order) const;
+
+    /** Fixed-truncation kernel, N <= max_degree(); full order. */
+    template <int N>
+    Vec3 acceleration_fixed(const Vec3& r_body) const {
+        static_assert(N >= 2, "degree must be at least 2");
+        std::array<double, scratch_size(N)> v, w;
+        return evaluate<N>(r_body, N, N, v.data(), w.data());
+    }
+
+    /** Greenwich mean sidereal angle at a Julian date (IAU 1982) [rad] */
+    static double gmst(double jd);
+
+    /** Scratch entries evaluate() needs for a degree (V, W up to N + 1) */
+    static constexpr std::size_t scratch_size(int degree) {
+        return static_cast<std::size_t>(degree + 2) * (degree + 3) / 2;
+    }
+
+private:
+    double mu_ = 0.0;
+    double radius_ = 1.0;
+    int max_degree_ = 0;
+
+    // Packed lower-triangular (n, m) storage, index n(n+1)/2 + m.
+    // Coefficients and acceleration factors up to max_degree, recursion
+    // factors up to max_degree + 1.
+    std::vector<double> c_, s_;
+    std::vector<double> rec_a_, rec_b_;         // Vertical recursion
+    std::vector<double> sect_;                  // Sectoral recursion, per m
+    std::vector<double> fa_, fb_, fz_;          // V̄(n+1) -> acceleration scale
+    std::vector<double> degree_scale_;          // (n+1) * RMS of degree n
+
+    static std::size_t tri(int n, int m) {
+        return static_cast<std::size_t>(n) * (n + 1) / 2 + m;
+    }
+
+    void update_degree_scale(int n);
+
+    /**
+     * Recursion and summation. NMAX > 0 fixes the degree bound at compile
+     * time (acceleration_fixed); 0 uses `degree`.
+     */
+    template <int NMAX>
+    Vec3 evaluate(const Vec3& r, int degree, int order, double* v, double* w) const;
+};
+
+template <int NMAX>
+inline Vec3 GravityField::evaluate(const Vec3& r, int degree, int order,
+                                   double* v, double* w) const {
+    const int n_max = NMAX > 0 ? NMAX : degree;
+    const int m_max = NMAX > 0 ? NMAX : order;
+    const double R = radius_;
+    const double r2 = r.x * r.x + r.y * r.y + r.z * r.z;
+    const double inv_r2 = 1.0 / r2;
+    const double x0 = R * r.x * inv_r2;
+    const double y0 = R * r.y * inv_r2;
+    const double z0 = R * r.z * inv_r2;
+    const double rho2 = R * R * inv_r2;
+
+    // V̄, W̄ by column m, up to degree n_max + 1 and order m_max + 1
+    v[0] = R / std::sqrt(r2);
+    w[0] = 0.0;
+    for (int m = 0; m <= m_max + 1; m++) {
+        const std::size_t mm = tri(m, m);
+        if (m > 0) {
+            const std::size_t pp = tri(m - 1, m - 1);
+            v[mm] = sect_[m] * (x0 * v[pp] - y0 * w[pp]);
+            w[mm] = sect_[m] * (x0 * w[pp] + y0 * v[pp]);
+        }
+        if (m + 1 <= n_max + 1) {
+            const std::size_t k = tri(m + 1, m);
+            v[k] = rec_a_[k] * z0 * v[mm];
+            w[k] = rec_a_[k] * z0 * w[mm];
+        }
+        for (int n = m + 2; n <= n_max + 1; n++) {
+            const std::size_t k = tri(n, m);
+            const std::size_t k1 = tri(n - 1, m);
+            const std::size_t k2 = tri(n - 2, m);
+            v[k] = rec_a_[k] * z0 * v[k1] - rec_b_[k] * rho2 * v[k2];
+            w[k] = rec_a_[k] * z0 * w[k1] - rec_b_[k] * rho2 * w[k2];
+        }
+    }
+
+    double ax = 0.0, ay = 0.0, az = 0.0;
+    for (int n = 2; n <= n_max; n++) {
+        const std::size_t up = tri(n + 1, 0);   // Row n + 1
+        const std::size_t k0 = tri(n, 0);
+
+        // m = 0
+        {
+            const double cn = c_[k0];
+            ax -= cn * fa_[k0] * v[up + 1];
+            ay -= cn * fa_[k0] * w[up + 1];
+            az -= cn * fz_[k0] * v[up];
+        }
+        const int m_top = n < m_max ? n : m_max;
+        for (int m = 1; m <= m_top; m++) {
+            const std::size_t k = k0 + m;
+            const double cnm = c_[k], snm = s_[k];
+            const double vp = v[up + m + 1], wp = w[up + m + 1];
+            const double vm = v[up + m - 1], wm = w[up + m - 1];
+            ax += fa_[k] * (-cnm * vp - snm * wp) + fb_[k] * (cnm * vm + snm * wm);
+            ay += fa_[k] * (-cnm * wp + snm * vp) + fb_[k] * (-cnm * wm + snm * vm);
+            az -= fz_[k] * (cnm * v[up + m] + snm * w[up + m]);
+        }
+    }
+
+    const double scale = mu_ / (R * R);
+    return Vec3(ax * scale, ay * scale, az * scale);
+}
+
+}  // namespace sim
+
+#endif  // SIM_SPHERICAL_HARMONICS_HPP
@@ -16,6 +16,10 @@ static constexpr double RE_A2 = RE_A * RE_A;
 static constexpr double RE_B2 = RE_B * RE_B;
 static constexpr double DEG = 3.14159265358979323846 / 180.0;
 
+// Batch visibility
+static constexpr size_t BLOCK = 64;            // Targets per culling block
+static constexpr double CULL_MARGIN = 1e-9;    // Keeps boundary targets for the exact check
+
 // ─────────────────────────────────────────────────────────────
 // Private helpers
 // ─────────────────────────────────────────────────────────────
@@ -358,4 +362,144 @@ std::vector<GroundFootprint> SyntheticCamera::compute_coverage_strip(
     return strip;
 }
 
+CameraPose SyntheticCamera::prepare_pose(
+    const Vec3& position,
+    const Quat& attitude,
+    const Vec3& velocity,
+    const CameraConfig& config,
+    double jd) {
+
+    CameraPose pose;
+    pose.position = position;
+    pose.attitude = attitude;
+    pose.velocity = velocity;
+    pose.config = config;
+    pose.jd = jd;
+
+    double gmst = TimeUtils::compute_gmst(jd);
+    pose.cos_gmst = std::cos(gmst);
+    pose.sin_gmst = std::sin(gmst);
+    auto to_ecef = [&](const Vec3& v) {
+        return Vec3{
+            v.x * pose.cos_gmst + v.y * pose.sin_gmst,
+           -v.x * pose.sin_gmst + v.y * pose.cos_gmst,
+            v.z
+        };
+    };
+
+    // FOV frame as in is_target_visible, body → ECI → ECEF
+    Vec3 bore = boresight_body(config);
+    Vec3 ref{1.0, 0.0, 0.0};
+    if (std::abs(dot(bore, ref)) > 0.99) ref = Vec3{0.0, 1.0, 0.0};
+    Vec3 right = normalized(cross(bore, ref));
+    Vec3 up = normalized(cross(right, bore));
+
+    pose.position_ecef = to_ecef(position);
+    pose.boresight_ecef = to_ecef(quat_rotate(attitude, bore));
+    pose.right_ecef = to_ecef(quat_rotate(attitude, right));
+    pose.up_ecef = to_ecef(quat_rotate(attitude, up));
+
+    double cone = std::max(config.fov_cross_track, config.fov_along_track) * 0.5 * 1.2;
+    pose.cos_cone = cone < 3.14159265358979323846 ? std::cos(cone) : -1.0;
+    pose.tan_half_cross = std::tan(config.fov_cross_track * 0.5);
+    pose.tan_half_along = std::tan(config.fov_along_track * 0.5);
+
+    pose.footprint = compute_footprint(position, attitude, velocity, config, jd);
+    return pose;
+}
+
+size_t SyntheticCamera::visible_targets(
+    const CameraPose& pose,
+    const double* x, const double* y, const double* z,
+    size_t count,
+    std::vector<size_t>& visible,
+    std::vector<VisibilityResult>* results) {
+
+    visible.clear();
+    if (results) results->clear();
+
+    const double cx = pose.position_ecef.x, cy = pose.position_ecef.y, cz = pose.position_ecef.z;
+    const double bx = pose.boresight_ecef.x, by = pose.boresight_ecef.y, bz = pose.boresight_ecef.z;
+    const double rx = pose.right_ecef.x, ry = pose.right_ecef.y, rz = pose.right_ecef.z;
+    const double ux = pose.up_ecef.x, uy = pose.up_ecef.y, uz = pose.up_ecef.z;
+    const double c2 = cx * cx + cy * cy + cz * cz;
+    const double cone = pose.cos_cone - CULL_MARGIN;
+    const double cone2 = cone * cone;
+    const bool obtuse = cone < 0.0;
+    const double tc = (pose.tan_half_cross + CULL_MARGIN) * (1.0 + CULL_MARGIN);
+    const double ta = (pose.tan_half_along + CULL_MARGIN) * (1.0 + CULL_MARGIN);
+    const double tc2 = tc * tc, ta2 = ta * ta;
+    const double limb2 = (RE_A * 0.99) * (RE_A * 0.99) * (1.0 - CULL_MARGIN);
+    const double limb_gap = c2 - limb2;
+    const double min_range2 = (1.0 - CULL_MARGIN) * (1.0 - CULL_MARGIN);
+
+    unsigned char keep[BLOCK];
+    for (size_t begin = 0; begin < count; begin += BLOCK) {
+        const size_t n = std::min(BLOCK, count - begin);
+        const double* px = x + begin;
+        const double* py = y + begin;
+        const double* pz = z + begin;
+
+        // Frustum and limb culling, squared so the lanes need no sqrt or
+        // division: cone, rectangle, and whether the closest approach to
+        // the Earth centre lies between camera and target below the limb
+        #pragma GCC ivdep
+        for (size_t i = 0; i < n; i++) {
+            double dx = px[i] - cx, dy = py[i] - cy, dz = pz[i] - cz;
+            double range2 = dx * dx + dy * dy + dz * dz;
+            double along_bore = dx * bx + dy * by + dz * bz;
+            double cross_c = dx * rx + dy * ry + dz * rz;
+            double along_c = dx * ux + dy * uy + dz * uz;
+            double closest = -(cx * dx + cy * dy + cz * dz);   // t_closest × range
+
+            // along_bore >= cone × range, by the sign of each side
+            bool ahead = along_bore >= 0.0;
+            double ab2 = along_bore * along_bore;
+            bool in_cone = (ahead & (obtuse | (ab2 >= cone2 * range2))) |
+                           (!ahead & obtuse & (ab2 <= cone2 * range2));
+            bool occluded = (closest > 0.0) & (closest < range2) &
+                            (limb_gap * range2 < closest * closest);
+
+            bool in = (range2 >= min_range2) & in_cone &
+                      (cross_c * cross_c <= tc2 * range2) &
+                      (along_c * along_c <= ta2 * range2) & !occluded;
+            keep[i] = in;
+        }
+
+        // Exact check of the survivors (target back to ECI)
+        for (size_t i = 0; i < n; i++) {
+            if (!keep[i]) continue;
+            Vec3 target_eci{
+                px[i] * pose.cos_gmst - py[i] * pose.sin_gmst,
+                px[i] * pose.sin_gmst + py[i] * pose.cos_gmst,
+                pz[i]
+            };
+            VisibilityResult vis = is_target_visible(
+                pose.position, pose.attitude, pose.velocity, target_eci, pose.config);
+            if (!vis.is_visible) continue;
+            visible.push_back(begin + i);
+            if (results) results->push_back(vis);
+        }
+    }
+
+    return visible.size();
+}
+
+std::vector<size_t> SyntheticCamera::visible_targets(
+    const CameraPose& pose,
+    const std::vector<Vec3>& targets_ecef) {
+
+    const size_t n = targets_ecef.size();
+    std::vector<double> x(n), y(n), z(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = targets_ecef[i].x;
+        y[i] = targets_ecef[i].y;
+        z[i] = targets_ecef[i].z;
+    }
+
+    std::vector<size_t> visible;
+    visible_targets(pose, x.data(), y.data(), z.data(), n, visible);
+    return visible;
+}
+
 }  // namespace sim
@@ -9,6 +9,7 @@
  * - Ground sample distance (GSD) from altitude and pixel pitch
  * - Target visibility check (within FOV cone + line of sight)
  * - Coverage strip computation along an orbit arc
+ * - Batch visibility of many ECEF ground targets against one camera pose
  */
 
 #ifndef SIM_SYNTHETIC_CAMERA_HPP
@@ -89,6 +90,33 @@ struct VisibilityResult {
     double fov_y;            // Normalized position in FOV (-1 to +1 along-track)
 };
 
+/**
+ * One camera pose prepared for batch target tests
+ *
+ * The FOV frustum is rotated into ECEF once, so fixed ground targets need
+ * no per-pose transformation, and the footprint of the pose is computed
+ * once and reused by every query.
+ */
+struct CameraPose {
+    Vec3 position;           // Camera position in ECI [m]
+    Quat attitude;           // Body→ECI
+    Vec3 velocity;           // ECI [m/s]
+    CameraConfig config;
+    double jd;
+    double cos_gmst, sin_gmst;
+
+    // Frustum in ECEF
+    Vec3 position_ecef;
+    Vec3 boresight_ecef;     // Unit boresight
+    Vec3 right_ecef;         // Unit cross-track axis
+    Vec3 up_ecef;            // Unit along-track axis
+    double cos_cone;         // Cosine of the coarse cone (1.2 × max half-FOV)
+    double tan_half_cross;
+    double tan_half_along;
+
+    GroundFootprint footprint;   // compute_footprint() for this pose
+};
+
 // ═══════════════════════════════════════════════════════════════
 // Synthetic Camera Class
 // ═══════════════════════════════════════════════════════════════
@@ -166,6 +194,52 @@ public:
         const CameraConfig& config,
         double epoch_jd);
 
+    /**
+     * Prepare a camera pose for batch visibility queries.
+     *
+     * @param position  Camera position in ECI [m]
+     * @param attitude  Camera attitude quaternion (body→ECI)
+     * @param velocity  Camera velocity in ECI [m/s]
+     * @param config    Camera configuration
+     * @param jd        Julian date (for ECI→ECEF rotation)
+     * @return Pose with its ECEF frustum and footprint
+     */
+    static CameraPose prepare_pose(
+        const Vec3& position,
+        const Quat& attitude,
+        const Vec3& velocity,
+        const CameraConfig& config,
+        double jd);
+
+    /**
+     * Visibility of many targets given in ECEF against one pose.
+     *
+     * Targets are culled in blocks against the frustum and the Earth limb
+     * with a few dot products each, branch-free over the block; only the
+     * survivors get the exact is_target_visible() check, so the visible
+     * set is the same as calling it for every target.
+     *
+     * @param pose     Prepared camera pose
+     * @param x,y,z    Target ECEF coordinates [m], count each
+     * @param count    Number of targets
+     * @param visible  Output: indices of the visible targets, ascending
+     * @param results  Optional output: visibility result per visible target
+     * @return Number of visible targets
+     */
+    static size_t visible_targets(
+        const CameraPose& pose,
+        const double* x, const double* y, const double* z,
+        size_t count,
+        std::vector<size_t>& visible,
+        std::vector<VisibilityResult>* results = nullptr);
+
+    /**
+     * Indices of the visible targets among ECEF positions.
+     */
+    static std::vector<size_t> visible_targets(
+        const CameraPose& pose,
+        const std::vector<Vec3>& targets_ecef);
+
 private:
     /**
      * Ray-Earth intersection.
@@ -0,0 +1,336 @@
+#include "physics/tour_optimizer.hpp"
+#include "physics/lambert_solver.hpp"
+#include "physics/low_thrust_optimizer.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/// Coplanar circular Hohmann delta-V between radii a1 and a2
+double hohmann_delta_v(double a1, double a2, double mu) {
+    double v1 = std::sqrt(mu / a1);
+    double v2 = std::sqrt(mu / a2);
+    double s = a1 + a2;
+    return std::abs(v1 * (std::sqrt(2.0 * a2 / s) - 1.0)) +
+           std::abs(v2 * (1.0 - std::sqrt(2.0 * a1 / s)));
+}
+
+/// Partial tour in the beam
+struct Tour {
+    std::vector<int> sequence;
+    std::vector<double> hop_delta_v;
+    std::vector<uint64_t> visited;      // Bit per candidate
+    double delta_v = 0.0;
+
+    bool has(int i) const { return (visited[i >> 6] >> (i & 63)) & 1u; }
+    void mark(int i) { visited[i >> 6] |= uint64_t(1) << (i & 63); }
+};
+
+/// Cheaper first, then the lexicographically smaller index sequence
+bool tour_less(const Tour& a, const Tour& b) {
+    if (a.delta_v != b.delta_v) return a.delta_v < b.delta_v;
+    return a.sequence < b.sequence;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// Construction
+// ---------------------------------------------------------------------------
+
+TourOptimizer::TourOptimizer(std::vector<TourCandidate> candidates,
+                             const TourOptimizerConfig& config)
+    : candidates_(std::move(candidates)), config_(config) {
+    if (!(config_.hop_time > 0.0)) {
+        throw std::invalid_argument("TourOptimizer: hop_time must be positive");
+    }
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+
+    // Plane index: inclination, RAAN and its J2 secular rate per candidate
+    planes_.resize(candidates_.size());
+    for (size_t i = 0; i < candidates_.size(); i++) {
+        const StateVector& s = candidates_[i].state;
+        Vec3 h = cross(s.position, s.velocity);
+        double r = s.position.norm();
+        double v2 = dot(s.velocity, s.velocity);
+        double a = 1.0 / (2.0 / r - v2 / config_.mu);
+
+        Plane& p = planes_[i];
+        p.inclination = std::acos(std::max(-1.0, std::min(1.0, h.z / h.norm())));
+        p.raan = std::atan2(h.x, -h.y);
+        p.semi_major_axis = a > 0.0 ? a : r;
+        p.speed = std::sqrt(config_.mu / p.semi_major_axis);
+        p.raan_rate = 0.0;
+        if (config_.include_j2_drift) {
+            double e2 = std::max(0.0, 1.0 - dot(h, h) / (config_.mu * p.semi_major_axis));
+            double semi_latus = p.semi_major_axis * (1.0 - e2);
+            double n = p.speed / p.semi_major_axis;
+            double ratio = config_.body_radius / semi_latus;
+            p.raan_rate = -1.5 * n * config_.j2 * ratio * ratio * std::cos(p.inclination);
+        }
+    }
+
+    by_inclination_.resize(candidates_.size());
+    for (size_t i = 0; i < by_inclination_.size(); i++) by_inclination_[i] = static_cast<int>(i);
+    std::sort(by_inclination_.begin(), by_inclination_.end(), [&](int a, int b) {
+        if (planes_[a].inclination != planes_[b].inclination) {
+            return planes_[a].inclination < planes_[b].inclination;
+        }
+        return a < b;
+    });
+}
+
+TourOptimizer::~TourOptimizer() = default;
+
+// ---------------------------------------------------------------------------
+// Cost cache
+// ---------------------------------------------------------------------------
+
+void TourOptimizer::ensure_states(int level) {
+    while (static_cast<int>(states_.size()) <= level) {
+        double t = static_cast<double>(states_.size()) * config_.hop_time;
+        states_.emplace_back(candidates_.size());
+        std::vector<StateVector>& out = states_.back();
+
+        auto propagate = [&](size_t i) {
+            StateVector s = candidates_[i].state;
+            if (t > 0.0) LowThrustOptimizer::kepler_propagate(s.position, s.velocity, t, config_.mu);
+            s.time = candidates_[i].state.time + t;
+            out[i] = s;
+        };
+        if (pool_ && candidates_.size() > 1) pool_->parallel_for(candidates_.size(), propagate);
+        else for (size_t i = 0; i < candidates_.size(); i++) propagate(i);
+    }
+}
+
+void TourOptimizer::prune(int hop, int from, std::vector<int>& out) const {
+    out.clear();
+    const Plane& src = planes_[from];
+    double budget = config_.delta_v_budget;
+    double t = static_cast<double>(hop) * config_.hop_time;
+
+    // Turning the plane by theta at speed v costs at least 2 v sin(theta / 2);
+    // the inclination difference bounds theta from below
+    double max_angle = budget >= 2.0 * src.speed ? PI
+                     : 2.0 * std::asin(budget / (2.0 * src.speed));
+    auto lo = std::lower_bound(by_inclination_.begin(), by_inclination_.end(),
+                               src.inclination - max_angle,
+                               [&](int i, double inc) { return planes_[i].inclination < inc; });
+    double raan_from = src.raan + src.raan_rate * t;
+
+    for (auto it = lo; it != by_inclination_.end(); ++it) {
+        int j = *it;
+        const Plane& dst = planes_[j];
+        if (dst.inclination > src.inclination + max_angle) break;
+        if (j == from) continue;
+
+        double dr = dst.raan + dst.raan_rate * t - raan_from;
+        double cos_angle = std::cos(src.inclination) * std::cos(dst.inclination) +
+                           std::sin(src.inclination) * std::sin(dst.inclination) * std::cos(dr);
+        double angle = std::acos(std::max(-1.0, std::min(1.0, cos_angle)));
+        double v_min = std::min(src.speed, dst.speed);
+        double plane_dv = 2.0 * v_min * std::sin(0.5 * angle);
+        double shape_dv = hohmann_delta_v(src.semi_major_axis, dst.semi_major_axis, config_.mu);
+        if (std::max(plane_dv, shape_dv) > budget) continue;
+
+        out.push_back(j);
+    }
+    std::sort(out.begin(), out.end());
+}
+
+size_t TourOptimizer::build_row(int hop, int from, CostRow& row) const {
+    std::vector<int> targets;
+    prune(hop, from, targets);
+    size_t m = targets.size();
+    row.to.clear();
+    row.cost.clear();
+    if (m == 0) return 0;
+
+    const StateVector& s0 = states_[hop][from];
+    const std::vector<StateVector>& arrive = states_[hop + 1];
+    double tof = config_.hop_time;
+
+    LambertOptions options;
+    options.mu = config_.mu;
+    options.prograde = cross(s0.position, s0.velocity).z >= 0.0;
+
+    std::vector<double> best(m, INF);
+    std::vector<int> max_revs(m, 0);
+    for (size_t k = 0; k < m; k++) {
+        max_revs[k] = std::min(config_.max_revolutions,
+                               LambertSolver::max_revolutions(s0.position, arrive[targets[k]].position,
+                                                              tof, config_.mu, options.prograde));
+    }
+
+    // One batch per (revolutions, branch) over the pairs that admit it
+    size_t solves = 0;
+    LambertBatch batch;
+    std::vector<size_t> lane_pair;
+    for (int revs = 0; revs <= config_.max_revolutions; revs++) {
+        for (int b = 0; b < (revs == 0 ? 1 : 2); b++) {
+            lane_pair.clear();
+            for (size_t k = 0; k < m; k++) {
+                if (max_revs[k] >= revs) lane_pair.push_back(k);
+            }
+            if (lane_pair.empty()) continue;
+
+            batch = LambertBatch();
+            batch.resize(lane_pair.size());
+            for (size_t l = 0; l < lane_pair.size(); l++) {
+                batch.set(l, s0.position, arrive[targets[lane_pair[l]]].position, tof);
+            }
+            options.revolutions = revs;
+            options.branch = b == 0 ? LambertBranch::LEFT : LambertBranch::RIGHT;
+            LambertSolver::solve(batch, options);
+            solves += lane_pair.size();
+
+            for (size_t l = 0; l < lane_pair.size(); l++) {
+                if (!batch.valid[l]) continue;
+                size_t k = lane_pair[l];
+                double dv = (batch.v1(l) - s0.velocity).norm() +
+                            (arrive[targets[k]].velocity - batch.v2(l)).norm();
+                if (std::isfinite(dv)) best[k] = std::min(best[k], dv);
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    for (size_t k = 0; k < m; k++) {
+        if (best[k] <= config_.delta_v_budget) order.push_back(k);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (best[a] != best[b]) return best[a] < best[b];
+        return targets[a] < targets[b];
+    });
+    for (size_t k : order) {
+        row.to.push_back(targets[k]);
+        row.cost.push_back(best[k]);
+    }
+    return solves;
+}
+
+void TourOptimizer::ensure_rows(int hop, const std::vector<int>& sources) {
+    ensure_states(hop + 1);
+
+    std::vector<int> missing;
+    for (int from : sources) {
+        if (rows_.find(row_key(hop, from)) == rows_.end()) missing.push_back(from);
+    }
+    if (missing.empty()) return;
+
+    std::vector<CostRow> built(missing.size());
+    std::vector<size_t> solves(missing.size(), 0);
+    auto fill = [&](size_t k) { solves[k] = build_row(hop, missing[k], built[k]); };
+    if (pool_ && missing.size() > 1) pool_->parallel_for(missing.size(), fill);
+    else for (size_t k = 0; k < missing.size(); k++) fill(k);
+
+    for (size_t k = 0; k < missing.size(); k++) {
+        lambert_solves_ += solves[k];
+        rows_.emplace(row_key(hop, missing[k]), std::move(built[k]));
+    }
+}
+
+double TourOptimizer::transfer_cost(int hop, int from, int to) {
+    ensure_rows(hop, {from});
+    const CostRow& row = rows_.at(row_key(hop, from));
+    for (size_t k = 0; k < row.to.size(); k++) {
+        if (row.to[k] == to) return row.cost[k];
+    }
+    return INF;
+}
+
+// ---------------------------------------------------------------------------
+// Beam search
+// ---------------------------------------------------------------------------
+
+TourResult TourOptimizer::solve(int start) {
+    TourResult result;
+    if (start < 0 || start >= static_cast<int>(candidates_.size())) return result;
+    size_t solves_before = lambert_solves_;
+
+    Tour root;
+    root.sequence.push_back(start);
+    root.visited.assign((candidates_.size() + 63) / 64, 0);
+    root.mark(start);
+
+    std::vector<Tour> beam{root};
+    Tour best = root;
+    size_t branching = static_cast<size_t>(std::max(1, config_.max_branching));
+
+    for (int hop = 0; hop < config_.max_hops; hop++) {
+        std::vector<int> sources;
+        for (const Tour& t : beam) sources.push_back(t.sequence.back());
+        std::sort(sources.begin(), sources.end());
+        sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+        ensure_rows(hop, sources);
+
+        // Children of every tour, in parallel (each writes its own slot)
+        std::vector<std::vector<Tour>> children(beam.size());
+        auto expand = [&](size_t b) {
+            const Tour& t = beam[b];
+            const CostRow& row = rows_.at(row_key(hop, t.sequence.back()));
+            for (size_t k = 0; k < row.to.size() && children[b].size() < branching; k++) {
+                int j = row.to[k];
+                if (t.has(j)) continue;
+                double dv = t.delta_v + row.cost[k];
+                if (dv > config_.delta_v_budget) break;   // Row is ascending
+
+                Tour c = t;
+                c.sequence.push_back(j);
+                c.hop_delta_v.push_back(row.cost[k]);
+                c.mark(j);
+                c.delta_v = dv;
+                children[b].push_back(std::move(c));
+            }
+        };
+        if (pool_ && beam.size() > 1) pool_->parallel_for(beam.size(), expand);
+        else for (size_t b = 0; b < beam.size(); b++) expand(b);
+        result.tours_expanded += beam.size();
+
+        std::vector<Tour> next;
+        for (auto& group : children) {
+            for (auto& c : group) next.push_back(std::move(c));
+        }
+        if (next.empty()) break;
+
+        // Merge tours at the same satellite with the same visited set
+        std::sort(next.begin(), next.end(), [](const Tour& a, const Tour& b) {
+            if (a.sequence.back() != b.sequence.back()) return a.sequence.back() < b.sequence.back();
+            if (a.visited != b.visited) return a.visited < b.visited;
+            return tour_less(a, b);
+        });
+        auto same_state = [](const Tour& a, const Tour& b) {
+            return a.sequence.back() == b.sequence.back() && a.visited == b.visited;
+        };
+        next.erase(std::unique(next.begin(), next.end(), same_state), next.end());
+
+        std::sort(next.begin(), next.end(), tour_less);
+        if (next.size() > static_cast<size_t>(std::max(1, config_.beam_width))) {
+            next.resize(static_cast<size_t>(std::max(1, config_.beam_width)));
+        }
+        beam = std::move(next);
+        best = beam.front();
+    }
+
+    result.found = best.sequence.size() > 1;
+    result.sequence = best.sequence;
+    result.hop_delta_v = best.hop_delta_v;
+    result.total_delta_v = best.delta_v;
+    result.duration = static_cast<double>(best.hop_delta_v.size()) * config_.hop_time;
+    result.cost_rows = rows_.size();
+    result.lambert_solves = lambert_solves_ - solves_before;
+    return result;
+}
+
+}  // namespace sim
@@ -0,0 +1,155 @@
+/**
+ * Multi-Target Inspection Tour Optimizer
+ *
+ * Orders rendezvous with many candidate satellites under a delta-V budget.
+ * This replaces "fly to the nearest unvisited target" (sat_tour_demo's
+ * longitude walk) with a beam search over whole tours.
+ *
+ * Hop k leaves at k * hop_time and arrives one hop_time later: the tour
+ * schedule is fixed, as in the demo. A hop's cost is the two-impulse
+ * Lambert delta-V |v1 - v_from| + |v_to - v2| between the two satellites'
+ * two-body states at those times. The cheapest of every feasible
+ * revolution count and branch is used.
+ *
+ * Costs are cached per (hop index, source) row. A row is filled only the
+ * first time the beam leaves that satellite at that hop. Rows missing at a
+ * level are solved in parallel, each as structure-of-arrays LambertSolver
+ * batches over the row's surviving targets. The cache persists across
+ * solve() calls on the same optimizer.
+ *
+ * Pruning uses an inclination / RAAN index. Any transfer has to turn the
+ * orbit plane by at least the angle between the two orbit normals, which
+ * costs about 2 v sin(angle / 2) at the slower circular speed of the
+ * pair. Candidates are sorted by inclination, so a
+ * source scans only the inclination band the budget allows. Each
+ * surviving pair is then checked against the plane angle at the
+ * departure time, with RAAN advanced at the J2 secular rate when
+ * include_j2_drift is set. The pair is also checked against the Hohmann
+ * cost of the semi-major axis change. The optional J2 drift only sharpens
+ * the pruning; hop costs remain two-body.
+ *
+ * The beam keeps the beam_width cheapest partial tours per hop count.
+ * Tours that end on the same satellite with the same visited set are
+ * merged. Expansions run across threads; ties break on the tour's index
+ * sequence, so the result does not depend on the thread count. The
+ * returned tour visits the most targets within budget, at the lowest
+ * total delta-V among those.
+ *
+ * Usage:
+ *   TourOptimizerConfig cfg; cfg.hop_time = 4.33 * 3600.0; cfg.delta_v_budget = 2000.0;
+ *   TourOptimizer opt(candidates, cfg);
+ *   TourResult tour = opt.solve(start_index);
+ */
+
+#ifndef SIM_TOUR_OPTIMIZER_HPP
+#define SIM_TOUR_OPTIMIZER_HPP
+
+#include "core/state_vector.hpp"
+#include "physics/orbital_elements.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+struct TourCandidate {
+    std::string name;
+    int id = 0;
+    StateVector state;                  // Inertial state at tour start (t = 0)
+};
+
+struct TourOptimizerConfig {
+    double hop_time = 4.33 * 3600.0;    // Transfer time of every hop [s]
+    double delta_v_budget = 2000.0;     // Whole-tour budget [m/s]
+    int max_hops = 30;                  // Targets visited after the start
+    int beam_width = 256;               // Partial tours kept per hop count
+    int max_branching = 16;             // Cheapest next hops expanded per tour
+
+    double mu = OrbitalMechanics::MU_EARTH;
+    int max_revolutions = 3;            // Lambert revolutions tried per hop
+    bool include_j2_drift = false;      // RAAN drift in the pruning index
+    double j2 = 1.08262668e-3;
+    double body_radius = 6378137.0;     // [m]
+
+    int num_threads = 0;                // 0 = hardware concurrency, 1 = serial
+};
+
+struct TourResult {
+    bool found = false;                 // At least one hop fits the budget
+    std::vector<int> sequence;          // Candidate indices, start first
+    std::vector<double> hop_delta_v;    // One per hop [m/s]
+    double total_delta_v = 0.0;         // [m/s]
+    double duration = 0.0;              // [s]
+
+    size_t cost_rows = 0;               // Cost rows in the cache afterwards
+    size_t lambert_solves = 0;          // Lambert problems solved by this call
+    size_t tours_expanded = 0;
+};
+
+class TourOptimizer {
+public:
+    TourOptimizer(std::vector<TourCandidate> candidates,
+                  const TourOptimizerConfig& config = TourOptimizerConfig());
+    ~TourOptimizer();
+
+    /** Best tour from candidate `start` (already visited) */
+    TourResult solve(int start);
+
+    /**
+     * Cost of hop `hop` (departing at hop * hop_time) from candidate
+     * `from` to `to` [m/s]; +inf if pruned or no Lambert branch is
+     * feasible. Fills the row on a cache miss.
+     */
+    double transfer_cost(int hop, int from, int to);
+
+    size_t size() const { return candidates_.size(); }
+    const TourCandidate& candidate(size_t i) const { return candidates_[i]; }
+
+private:
+    struct Plane {
+        double inclination;             // [rad]
+        double raan;                    // At t = 0 [rad]
+        double raan_rate;               // [rad/s]
+        double semi_major_axis;         // [m]
+        double speed;                   // Circular speed at semi_major_axis [m/s]
+    };
+
+    /// Reachable targets of one (hop, source), ascending cost
+    struct CostRow {
+        std::vector<int> to;
+        std::vector<double> cost;
+    };
+
+    std::vector<TourCandidate> candidates_;
+    TourOptimizerConfig config_;
+    std::vector<Plane> planes_;
+    std::vector<int> by_inclination_;   // Candidate indices, ascending inclination
+    std::vector<std::vector<StateVector>> states_;   // [level][candidate] at level * hop_time
+    std::unordered_map<uint64_t, CostRow> rows_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+    size_t lambert_solves_ = 0;
+
+    static uint64_t row_key(int hop, int from) {
+        return (static_cast<uint64_t>(hop) << 32) | static_cast<uint32_t>(from);
+    }
+
+    /// Two-body states of every candidate at levels 0..level
+    void ensure_states(int level);
+
+    /// Index pass: targets of `from` at hop `hop` that survive pruning
+    void prune(int hop, int from, std::vector<int>& out) const;
+
+    /// Fill one row (thread-safe: touches only `row`); returns Lambert solves
+    size_t build_row(int hop, int from, CostRow& row) const;
+
+    /// Make sure every (hop, source) row exists, building missing ones in parallel
+    void ensure_rows(int hop, const std::vector<int>& sources);
+};
+
+}  // namespace sim
+
+#endif  // SIM_TOUR_OPTIMIZER_HPP
@@ -0,0 +1,435 @@
+/**
+ * Vec3 Packets — N-lane vectors for batch kernels
+ *
+ * DoubleN<N> holds N doubles as one GCC/Clang vector-extension value, so
+ * arithmetic and comparisons compile to whole SSE/AVX2/AVX-512 (or wasm
+ * SIMD128) registers when N matches the target (NATIVE_LANES) and to
+ * register pairs or scalar code otherwise: the same source builds
+ * everywhere, and a target without SIMD gets NATIVE_LANES = 1. MaskN<N>
+ * is the per-lane result of a comparison (all bits set or clear) for
+ * select(). sqrt() uses the target's vector square root where the width
+ * allows; everything else is plain operators the compiler maps directly.
+ *
+ * Vec3xN<N> is N Vec3s as three DoubleN (x, y, z), with the vec3_ops.hpp
+ * operations lane-wise: arithmetic, dot, cross, norm, rsqrt, select.
+ * Lane results are IEEE-identical to the scalar operations on each Vec3
+ * (no reassociation), except where the compiler contracts a multiply-add.
+ *
+ * Vec3Array is the structure-of-arrays container the packets load from
+ * and store to, with gather/scatter against arrays of Vec3 (optionally
+ * through an index list) and partial loads/stores for the tail.
+ *
+ *   Vec3Array r;
+ *   r.gather(positions.data(), positions.size());
+ *   for (size_t i = 0; i < r.size(); i += NATIVE_LANES) {
+ *       auto p = r.load_partial<NATIVE_LANES>(i);
+ *       DoubleN<NATIVE_LANES> rn = norm(p);
+ *       ...
+ *   }
+ */
+
+#ifndef SIM_VEC3_SIMD_HPP
+#define SIM_VEC3_SIMD_HPP
+
+#include "core/state_vector.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace sim {
+namespace simd {
+
+#if defined(__AVX512F__)
+constexpr int NATIVE_LANES = 8;
+#elif defined(__AVX__)
+constexpr int NATIVE_LANES = 4;
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(__wasm_simd128__)
+constexpr int NATIVE_LANES = 2;
+#else
+constexpr int NATIVE_LANES = 1;
+#endif
+
+// ═══════════════════════════════════════════════════════════════
+// Lanes
+// ═══════════════════════════════════════════════════════════════
+
+/** Vector-extension register types per lane count */
+template <int N>
+struct Lanes;
+
+#define SIM_SIMD_LANES(N)                                                              \
+    template <>                                                                        \
+    struct Lanes<N> {                                                                  \
+        typedef double Double __attribute__((vector_size(N * sizeof(double))));        \
+        typedef int64_t Mask __attribute__((vector_size(N * sizeof(int64_t))));        \
+    };
+SIM_SIMD_LANES(1)
+SIM_SIMD_LANES(2)
+SIM_SIMD_LANES(4)
+SIM_SIMD_LANES(8)
+SIM_SIMD_LANES(16)
+#undef SIM_SIMD_LANES
+
+template <int N>
+struct MaskN {
+    typedef typename Lanes<N>::Mask Raw;
+    Raw v;
+
+    bool operator[](int k) const { return v[k] != 0; }
+
+    bool any() const {
+        for (int k = 0; k < N; k++) if (v[k]) return true;
+        return false;
+    }
+    bool all() const {
+        for (int k = 0; k < N; k++) if (!v[k]) return false;
+        return true;
+    }
+
+    /** Lane k set for k < count */
+    static MaskN first(int count) {
+        MaskN m;
+        for (int k = 0; k < N; k++) m.v[k] = k < count ? -1 : 0;
+        return m;
+    }
+};
+
+template <int N> inline MaskN<N> operator&(MaskN<N> a, MaskN<N> b) { return {a.v & b.v}; }
+template <int N> inline MaskN<N> operator|(MaskN<N> a, MaskN<N> b) { return {a.v | b.v}; }
+template <int N> inline MaskN<N> operator!(MaskN<N> a) { return {~a.v}; }
+
+template <int N>
+struct DoubleN {
+    typedef typename Lanes<N>::Double Raw;
+    Raw v;
+
+    DoubleN() : v(Raw{}) {}
+    DoubleN(double s) : v(Raw{} + s) {}
+    DoubleN(Raw r) : v(r) {}
+
+    static DoubleN load(const double* p) {
+        DoubleN r;
+        std::memcpy(&r.v, p, sizeof(Raw));
+        return r;
+    }
+    void store(double* p) const { std::memcpy(p, &v, sizeof(Raw)); }
+
+    /** First `count` lanes from p, the rest zero */
+    static DoubleN load_partial(const double* p, int count) {
+        DoubleN r;
+        for (int k = 0; k < count && k < N; k++) r.v[k] = p[k];
+        return r;
+    }
+    void store_partial(double* p, int count) const {
+        for (int k = 0; k < count && k < N; k++) p[k] = v[k];
+    }
+
+    double operator[](int k) const { return v[k]; }
+    void set(int k, double s) { v[k] = s; }
+
+    DoubleN& operator+=(DoubleN b) { v += b.v; return *this; }
+    DoubleN& operator-=(DoubleN b) { v -= b.v; return *this; }
+    DoubleN& operator*=(DoubleN b) { v *= b.v; return *this; }
+    DoubleN& operator/=(DoubleN b) { v /= b.v; return *this; }
+};
+
+template <int N> inline DoubleN<N> operator+(DoubleN<N> a, DoubleN<N> b) { return a.v + b.v; }
+template <int N> inline DoubleN<N> operator-(DoubleN<N> a, DoubleN<N> b) { return a.v - b.v; }
+template <int N> inline DoubleN<N> operator*(DoubleN<N> a, DoubleN<N> b) { return a.v * b.v; }
+template <int N> inline DoubleN<N> operator/(DoubleN<N> a, DoubleN<N> b) { return a.v / b.v; }
+template <int N> inline DoubleN<N> operator-(DoubleN<N> a) { return -a.v; }
+
+template <int N> inline DoubleN<N> operator+(DoubleN<N> a, double s) { return a.v + s; }
+template <int N> inline DoubleN<N> operator-(DoubleN<N> a, double s) { return a.v - s; }
+template <int N> inline DoubleN<N> operator*(DoubleN<N> a, double s) { return a.v * s; }
+template <int N> inline DoubleN<N> operator/(DoubleN<N> a, double s) { return a.v / s; }
+template <int N> inline DoubleN<N> operator+(double s, DoubleN<N> a) { return s + a.v; }
+template <int N> inline DoubleN<N> operator-(double s, DoubleN<N> a) { return s - a.v; }
+template <int N> inline DoubleN<N> operator*(double s, DoubleN<N> a) { return s * a.v; }
+template <int N> inline DoubleN<N> operator/(double s, DoubleN<N> a) { return s / a.v; }
+
+template <int N> inline MaskN<N> operator<(DoubleN<N> a, DoubleN<N> b) { return {a.v < b.v}; }
+template <int N> inline MaskN<N> operator<=(DoubleN<N> a, DoubleN<N> b) { return {a.v <= b.v}; }
+template <int N> inline MaskN<N> operator>(DoubleN<N> a, DoubleN<N> b) { return {a.v > b.v}; }
+template <int N> inline MaskN<N> operator>=(DoubleN<N> a, DoubleN<N> b) { return {a.v >= b.v}; }
+template <int N> inline MaskN<N> operator==(DoubleN<N> a, DoubleN<N> b) { return {a.v == b.v}; }
+template <int N> inline MaskN<N> operator!=(DoubleN<N> a, DoubleN<N> b) { return {a.v != b.v}; }
+
+/** Lane-wise m ? a : b */
+template <int N>
+inline DoubleN<N> select(MaskN<N> m, DoubleN<N> a, DoubleN<N> b) {
+    return DoubleN<N>(m.v ? a.v : b.v);
+}
+
+template <int N> inline DoubleN<N> min(DoubleN<N> a, DoubleN<N> b) { return select(b < a, b, a); }
+template <int N> inline DoubleN<N> max(DoubleN<N> a, DoubleN<N> b) { return select(a < b, b, a); }
+template <int N> inline DoubleN<N> abs(DoubleN<N> a) { return select(a < DoubleN<N>(0.0), -a, a); }
+
+/** Lane-wise square root (correctly rounded, as std::sqrt) */
+template <int N>
+inline DoubleN<N> sqrt(DoubleN<N> a) {
+    typedef typename DoubleN<N>::Raw Raw;
+#if defined(__AVX512F__)
+    if constexpr (N == 8) return DoubleN<N>((Raw)_mm512_maskz_sqrt_pd(0xFF, (__m512d)a.v));
+#endif
+#if defined(__AVX__)
+    if constexpr (N == 4) return DoubleN<N>((Raw)_mm256_sqrt_pd((__m256d)a.v));
+#endif
+#if defined(__SSE2__)
+    if constexpr (N == 2) return DoubleN<N>((Raw)_mm_sqrt_pd((__m128d)a.v));
+#elif defined(__wasm_simd128__)
+    if constexpr (N == 2) return DoubleN<N>((Raw)wasm_f64x2_sqrt((v128_t)a.v));
+#endif
+    if constexpr (N > NATIVE_LANES) {
+        // Wider than a register: one native square root per half
+        DoubleN<N / 2> lo, hi;
+        std::memcpy(&lo.v, &a.v, sizeof(lo.v));
+        std::memcpy(&hi.v, reinterpret_cast<const char*>(&a.v) + sizeof(lo.v), sizeof(hi.v));
+        lo = sqrt(lo);
+        hi = sqrt(hi);
+        DoubleN<N> r;
+        std::memcpy(&r.v, &lo.v, sizeof(lo.v));
+        std::memcpy(reinterpret_cast<char*>(&r.v) + sizeof(lo.v), &hi.v, sizeof(hi.v));
+        return r;
+    } else {
+        DoubleN<N> r;
+        for (int k = 0; k < N; k++) r.v[k] = std::sqrt(a.v[k]);
+        return r;
+    }
+}
+
+/** Lane-wise 1 / sqrt(a), full precision */
+template <int N>
+inline DoubleN<N> rsqrt(DoubleN<N> a) {
+    return 1.0 / sqrt(a);
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Vec3 packets
+// ═══════════════════════════════════════════════════════════════
+
+template <int N>
+struct Vec3xN {
+    DoubleN<N> x, y, z;
+
+    Vec3xN() = default;
+    Vec3xN(DoubleN<N> x_, DoubleN<N> y_, DoubleN<N> z_) : x(x_), y(y_), z(z_) {}
+    /** Every lane v */
+    explicit Vec3xN(const Vec3& v) : x(v.x), y(v.y), z(v.z) {}
+
+    Vec3 lane(int k) const { return Vec3(x[k], y[k], z[k]); }
+    void set_lane(int k, const Vec3& v) {
+        x.set(k, v.x);
+        y.set(k, v.y);
+        z.set(k, v.z);
+    }
+
+    Vec3xN& operator+=(const Vec3xN& b) { x += b.x; y += b.y; z += b.z; return *this; }
+    Vec3xN& operator-=(const Vec3xN& b) { x -= b.x; y -= b.y; z -= b.z; return *this; }
+};
+
+template <int N>
+inline Vec3xN<N> operator+(const Vec3xN<N>& a, const Vec3xN<N>& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+template <int N>
+inline Vec3xN<N> operator-(const Vec3xN<N>& a, const Vec3xN<N>& b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+template <int N>
+inline Vec3xN<N> operator-(const Vec3xN<N>& a) {
+    return {-a.x, -a.y, -a.z};
+}
+
+template <int N>
+inline Vec3xN<N> operator*(DoubleN<N> s, const Vec3xN<N>& v) {
+    return {s * v.x, s * v.y, s * v.z};
+}
+
+template <int N>
+inline Vec3xN<N> operator*(const Vec3xN<N>& v, DoubleN<N> s) {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+template <int N>
+inline Vec3xN<N> operator*(double s, const Vec3xN<N>& v) {
+    return {s * v.x, s * v.y, s * v.z};
+}
+
+template <int N>
+inline Vec3xN<N> operator*(const Vec3xN<N>& v, double s) {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+template <int N>
+inline Vec3xN<N> operator/(const Vec3xN<N>& v, DoubleN<N> s) {
+    DoubleN<N> inv = 1.0 / s;
+    return {v.x * inv, v.y * inv, v.z * inv};
+}
+
+template <int N>
+inline DoubleN<N> dot(const Vec3xN<N>& a, const Vec3xN<N>& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template <int N>
+inline Vec3xN<N> cross(const Vec3xN<N>& a, const Vec3xN<N>& b) {
+    return {a.y * b.z - a.z * b.y,
+            a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x};
+}
+
+template <int N>
+inline DoubleN<N> norm2(const Vec3xN<N>& v) {
+    return v.x * v.x + v.y * v.y + v.z * v.z;
+}
+
+template <int N>
+inline DoubleN<N> norm(const Vec3xN<N>& v) {
+    return sqrt(norm2(v));
+}
+
+/** Lanes scaled to unit length; zero where the norm is below 1e-15 (as normalized()) */
+template <int N>
+inline Vec3xN<N> normalized(const Vec3xN<N>& v) {
+    DoubleN<N> n = norm(v);
+    MaskN<N> tiny = n < DoubleN<N>(1e-15);
+    DoubleN<N> inv = select(tiny, DoubleN<N>(0.0), 1.0 / n);
+    return {v.x * inv, v.y * inv, v.z * inv};
+}
+
+/** Lane-wise m ? a : b */
+template <int N>
+inline Vec3xN<N> select(MaskN<N> m, const Vec3xN<N>& a, const Vec3xN<N>& b) {
+    return {select(m, a.x, b.x), select(m, a.y, b.y), select(m, a.z, b.z)};
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Structure-of-arrays storage
+// ═══════════════════════════════════════════════════════════════
+
+class Vec3Array {
+public:
+    Vec3Array() = default;
+    explicit Vec3Array(size_t n) : x_(n, 0.0), y_(n, 0.0), z_(n, 0.0) {}
+
+    size_t size() const { return x_.size(); }
+    bool empty() const { return x_.empty(); }
+
+    void resize(size_t n) {
+        x_.resize(n, 0.0);
+        y_.resize(n, 0.0);
+        z_.resize(n, 0.0);
+    }
+    void reserve(size_t n) {
+        x_.reserve(n);
+        y_.reserve(n);
+        z_.reserve(n);
+    }
+    void clear() { resize(0); }
+
+    void push_back(const Vec3& v) {
+        x_.push_back(v.x);
+        y_.push_back(v.y);
+        z_.push_back(v.z);
+    }
+
+    Vec3 get(size_t i) const { return Vec3(x_[i], y_[i], z_[i]); }
+    void set(size_t i, const Vec3& v) {
+        x_[i] = v.x;
+        y_[i] = v.y;
+        z_[i] = v.z;
+    }
+
+    double* x() { return x_.data(); }
+    double* y() { return y_.data(); }
+    double* z() { return z_.data(); }
+    const double* x() const { return x_.data(); }
+    const double* y() const { return y_.data(); }
+    const double* z() const { return z_.data(); }
+
+    /** Replace the contents with src[0..n) */
+    void gather(const Vec3* src, size_t n) {
+        resize(n);
+        for (size_t i = 0; i < n; i++) {
+            x_[i] = src[i].x;
+            y_[i] = src[i].y;
+            z_[i] = src[i].z;
+        }
+    }
+
+    /** Replace the contents with src[index[0..n)] */
+    void gather(const Vec3* src, const uint32_t* index, size_t n) {
+        resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const Vec3& v = src[index[i]];
+            x_[i] = v.x;
+            y_[i] = v.y;
+            z_[i] = v.z;
+        }
+    }
+
+    /** dst[i] = element i, for every element */
+    void scatter(Vec3* dst) const {
+        for (size_t i = 0; i < size(); i++) dst[i] = Vec3(x_[i], y_[i], z_[i]);
+    }
+
+    /** dst[index[i]] = element i, for every element */
+    void scatter(Vec3* dst, const uint32_t* index) const {
+        for (size_t i = 0; i < size(); i++) dst[index[i]] = Vec3(x_[i], y_[i], z_[i]);
+    }
+
+    /** Elements i..i+N (all must exist) */
+    template <int N>
+    Vec3xN<N> load(size_t i) const {
+        return {DoubleN<N>::load(&x_[i]), DoubleN<N>::load(&y_[i]), DoubleN<N>::load(&z_[i])};
+    }
+
+    /** Elements i..i+N, lanes past the end zero */
+    template <int N>
+    Vec3xN<N> load_partial(size_t i) const {
+        if (i + N <= size()) return load<N>(i);
+        const int count = i < size() ? static_cast<int>(size() - i) : 0;
+        return {DoubleN<N>::load_partial(x_.data() + i, count),
+                DoubleN<N>::load_partial(y_.data() + i, count),
+                DoubleN<N>::load_partial(z_.data() + i, count)};
+    }
+
+    template <int N>
+    void store(size_t i, const Vec3xN<N>& v) {
+        v.x.store(&x_[i]);
+        v.y.store(&y_[i]);
+        v.z.store(&z_[i]);
+    }
+
+    /** Store the lanes that fall inside the array */
+    template <int N>
+    void store_partial(size_t i, const Vec3xN<N>& v) {
+        if (i + N <= size()) {
+            store<N>(i, v);
+            return;
+        }
+        const int count = i < size() ? static_cast<int>(size() - i) : 0;
+        v.x.store_partial(x_.data() + i, count);
+        v.y.store_partial(y_.data() + i, count);
+        v.z.store_partial(z_.data() + i, count);
+    }
+
+private:
+    std::vector<double> x_, y_, z_;
+};
+
+}  // namespace simd
+}  // namespace sim
+
+#endif  // SIM_VEC3_SIMD_HPP
@@ -0,0 +1,249 @@
+/**
+ * Gridded Wind Field Implementation
+ */
+
+#include "physics/wind_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim {
+
+namespace {
+
+/// Cell of a uniformly spaced axis holding x (already clamped to the axis)
+void uniform_cell(double x, double x0, double d, uint32_t n, bool wraps,
+                  uint32_t& i0, uint32_t& i1, double& lo, double& hi) {
+    if (n < 2) {
+        i0 = i1 = 0;
+        lo = hi = x0;
+        return;
+    }
+    int64_t last = wraps ? n - 1 : n - 2;
+    int64_t i = std::clamp(static_cast<int64_t>(std::floor((x - x0) / d)), int64_t(0), last);
+    i0 = static_cast<uint32_t>(i);
+    i1 = (i0 + 1) % n;
+    lo = x0 + i * d;
+    hi = lo + d;
+}
+
+bool inside(const WindGrid::Cursor& c, const double x[4]) {
+    for (int a = 0; a < 4; a++) {
+        if (x[a] < c.lo[a] || x[a] > c.hi[a]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+WindGrid::~WindGrid() {
+    close();
+}
+
+void WindGrid::close() {
+    if (mapping_) munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    owned_.clear();
+    data_ = nullptr;
+}
+
+bool WindGrid::validate(const WindGridSpec& spec, size_t values) const {
+    if (spec.nlat == 0 || spec.nlon == 0 || spec.ntime == 0 || spec.altitudes.empty()) return false;
+    if (!(spec.dlat > 0.0) || !(spec.dlon > 0.0) || !(spec.dtime > 0.0)) return false;
+    for (size_t k = 1; k < spec.altitudes.size(); k++) {
+        if (!(spec.altitudes[k] > spec.altitudes[k - 1])) return false;
+    }
+    return values == spec.values();
+}
+
+bool WindGrid::assign(const WindGridSpec& spec, std::vector<float> uv) {
+    close();
+    if (!validate(spec, uv.size())) return false;
+    spec_ = spec;
+    owned_ = std::move(uv);
+    data_ = owned_.data();
+    lon_wraps_ = std::abs(spec_.nlon * spec_.dlon - 360.0) < 1e-6;
+    return true;
+}
+
+bool WindGrid::open(const std::string& filename) {
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(wind::Header))) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    mapping_ = p;
+    mapping_size_ = static_cast<size_t>(st.st_size);
+    const uint8_t* base = static_cast<const uint8_t*>(p);
+
+    wind::Header h;
+    std::memcpy(&h, base, sizeof(h));
+    const size_t levels_end = sizeof(wind::Header) + size_t(h.nalt) * sizeof(double);
+    if (std::memcmp(h.magic, wind::MAGIC, 4) != 0 || h.version != wind::VERSION ||
+        h.data_offset % 8 != 0 || h.data_offset < levels_end || h.data_offset > mapping_size_) {
+        close();
+        return false;
+    }
+
+    WindGridSpec spec;
+    spec.lat0 = h.lat0;    spec.dlat = h.dlat;    spec.nlat = h.nlat;
+    spec.lon0 = h.lon0;    spec.dlon = h.dlon;    spec.nlon = h.nlon;
+    spec.time0 = h.time0;  spec.dtime = h.dtime;  spec.ntime = h.ntime;
+    spec.altitudes.resize(h.nalt);
+    std::memcpy(spec.altitudes.data(), base + sizeof(wind::Header), h.nalt * sizeof(double));
+
+    size_t values = (mapping_size_ - h.data_offset) / sizeof(float);
+    if (!validate(spec, std::min(values, spec.values()))) {
+        close();
+        return false;
+    }
+    spec_ = std::move(spec);
+    data_ = reinterpret_cast<const float*>(base + h.data_offset);
+    lon_wraps_ = std::abs(spec_.nlon * spec_.dlon - 360.0) < 1e-6;
+    return true;
+}
+
+bool WindGrid::write(const std::string& filename, const WindGridSpec& spec,
+                     const std::vector<float>& uv) {
+    if (uv.size() != spec.values()) return false;
+
+    wind::Header h{};
+    std::memcpy(h.magic, wind::MAGIC, 4);
+    h.version = wind::VERSION;
+    h.nlat = spec.nlat;    h.nlon = spec.nlon;
+    h.nalt = static_cast<uint32_t>(spec.altitudes.size());
+    h.ntime = spec.ntime;
+    h.lat0 = spec.lat0;    h.dlat = spec.dlat;
+    h.lon0 = spec.lon0;    h.dlon = spec.dlon;
+    h.time0 = spec.time0;  h.dtime = spec.dtime;
+    h.data_offset = sizeof(wind::Header) + spec.altitudes.size() * sizeof(double);
+
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              std::fwrite(spec.altitudes.data(), sizeof(double), spec.altitudes.size(), f) ==
+                  spec.altitudes.size() &&
+              std::fwrite(uv.data(), sizeof(float), uv.size(), f) == uv.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// ---------------------------------------------------------------------------
+// Lookup
+// ---------------------------------------------------------------------------
+
+void WindGrid::clamp_point(double& lat, double& lon, double& alt, double& time) const {
+    lat = std::clamp(lat, spec_.lat0, spec_.lat0 + (spec_.nlat - 1) * spec_.dlat);
+    if (lon_wraps_) {
+        lon = spec_.lon0 + std::fmod(std::fmod(lon - spec_.lon0, 360.0) + 360.0, 360.0);
+    } else {
+        lon = std::clamp(lon, spec_.lon0, spec_.lon0 + (spec_.nlon - 1) * spec_.dlon);
+    }
+    alt = std::clamp(alt, spec_.altitudes.front(), spec_.altitudes.back());
+    time = std::clamp(time, spec_.time0, spec_.time0 + (spec_.ntime - 1) * spec_.dtime);
+}
+
+void WindGrid::locate(double lat, double lon, double alt, double time, Cursor& c) const {
+    const size_t nlon = spec_.nlon;
+    const size_t level_stride = nlon * spec_.nlat;
+    const size_t time_stride = level_stride * spec_.altitudes.size();
+    uint32_t i0, i1;
+
+    uniform_cell(lat, spec_.lat0, spec_.dlat, spec_.nlat, false, i0, i1, c.lo[0], c.hi[0]);
+    c.offset[0][0] = i0 * nlon;
+    c.offset[0][1] = i1 * nlon;
+
+    uniform_cell(lon, spec_.lon0, spec_.dlon, spec_.nlon, lon_wraps_, i0, i1, c.lo[1], c.hi[1]);
+    c.offset[1][0] = i0;
+    c.offset[1][1] = i1;
+
+    const std::vector<double>& levels = spec_.altitudes;
+    const int32_t nalt = static_cast<int32_t>(levels.size());
+    if (nalt < 2) {
+        c.level = 0;
+        c.lo[2] = c.hi[2] = levels[0];
+        c.offset[2][0] = c.offset[2][1] = 0;
+    } else {
+        int32_t k;
+        if (c.valid) {
+            // Aircraft change altitude slowly: walk from the last level
+            k = std::clamp(c.level, 0, nalt - 2);
+            while (k > 0 && alt < levels[k]) k--;
+            while (k < nalt - 2 && alt > levels[k + 1]) k++;
+        } else {
+            k = static_cast<int32_t>(std::upper_bound(levels.begin(), levels.end(), alt) -
+                                     levels.begin()) - 1;
+            k = std::clamp(k, 0, nalt - 2);
+        }
+        c.level = k;
+        c.lo[2] = levels[k];
+        c.hi[2] = levels[k + 1];
+        c.offset[2][0] = k * level_stride;
+        c.offset[2][1] = (k + 1) * level_stride;
+    }
+
+    uniform_cell(time, spec_.time0, spec_.dtime, spec_.ntime, false, i0, i1, c.lo[3], c.hi[3]);
+    c.offset[3][0] = i0 * time_stride;
+    c.offset[3][1] = i1 * time_stride;
+    c.valid = true;
+}
+
+void WindGrid::sample(double lat, double lon, double alt, double time, Cursor& c,
+                      double& east, double& north) const {
+    if (!data_) {
+        east = north = 0.0;
+        return;
+    }
+    clamp_point(lat, lon, alt, time);
+    const double x[4] = {lat, lon, alt, time};
+    if (!c.valid || !inside(c, x)) locate(lat, lon, alt, time, c);
+
+    double w[4][2];
+    for (int a = 0; a < 4; a++) {
+        double span = c.hi[a] - c.lo[a];
+        double f = span > 0.0 ? (x[a] - c.lo[a]) / span : 0.0;
+        w[a][0] = 1.0 - f;
+        w[a][1] = f;
+    }
+
+    double e = 0.0, n = 0.0;
+    for (int t = 0; t < 2; t++) {
+        for (int k = 0; k < 2; k++) {
+            double wtk = w[3][t] * w[2][k];
+            size_t otk = c.offset[3][t] + c.offset[2][k];
+            for (int j = 0; j < 2; j++) {
+                double wj = wtk * w[0][j];
+                size_t oj = otk + c.offset[0][j];
+                for (int i = 0; i < 2; i++) {
+                    const float* uv = data_ + 2 * (oj + c.offset[1][i]);
+                    double wi = wj * w[1][i];
+                    e += wi * uv[0];
+                    n += wi * uv[1];
+                }
+            }
+        }
+    }
+    east = e;
+    north = n;
+}
+
+void WindGrid::sample(size_t n, const double* lat, const double* lon, const double* alt,
+                      double time, Cursor* cursors, double* east, double* north) const {
+    for (size_t i = 0; i < n; i++) {
+        sample(lat[i], lon[i], alt[i], time, cursors[i], east[i], north[i]);
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,141 @@
+/**
+ * Gridded Wind Field - 4D (latitude, longitude, altitude, time) winds
+ *
+ * East/north wind components on a regular latitude/longitude grid,
+ * arbitrary (increasing) altitude levels and evenly spaced time slices,
+ * as produced by regridding GFS-style model output. Files (".wind") are
+ * memory-mapped read-only, so a multi-gigabyte field costs only the pages
+ * aircraft actually fly through, and one mapping is shared by every
+ * reader (and every process) of the file.
+ *
+ * Layout (little-endian, as written by the host):
+ *   header   wind::Header (96 bytes)
+ *   levels   f64 altitudes[nalt] [m MSL]
+ *   data     f32 [ntime][nalt][nlat][nlon][2] = (east, north) [m/s],
+ *            starting at header.data_offset (8-byte aligned)
+ *
+ * Lookups are quadrilinear: trilinear in space on the two bracketing time
+ * slices, then linear in time. Queries outside the grid are clamped to
+ * its edges; a grid spanning 360 degrees of longitude wraps. A Cursor
+ * kept per aircraft caches the enclosing cell (bounds and data offsets):
+ * while the aircraft stays inside it a lookup is 16 weighted loads, and
+ * when it leaves, the altitude search walks from the previous level.
+ *
+ * Usage:
+ *   auto grid = std::make_shared<WindGrid>();
+ *   grid->open("gfs_2026101400.wind");
+ *   WindGrid::Cursor c;
+ *   double east, north;
+ *   grid->sample(lat, lon, alt, t, c, east, north);
+ *
+ * A grid is immutable once opened and may be shared across threads;
+ * cursors belong to one caller and one grid.
+ */
+
+#ifndef SIM_WIND_GRID_HPP
+#define SIM_WIND_GRID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+namespace wind {
+
+constexpr char MAGIC[4] = {'W', 'N', 'D', 'G'};
+constexpr uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct Header {
+    char     magic[4];
+    uint32_t version;
+    uint32_t nlat, nlon, nalt, ntime;
+    double   lat0, dlat;      // First latitude and spacing [deg]
+    double   lon0, dlon;      // First longitude and spacing [deg]
+    double   time0, dtime;    // First slice and spacing [s]
+    uint64_t data_offset;
+    uint32_t reserved[4];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 96, "wind grid header layout");
+
+} // namespace wind
+
+/// Grid geometry (altitudes must increase; dlat, dlon, dtime > 0)
+struct WindGridSpec {
+    double lat0 = -90.0, dlat = 1.0;
+    uint32_t nlat = 181;
+    double lon0 = 0.0, dlon = 1.0;
+    uint32_t nlon = 360;
+    std::vector<double> altitudes = {0.0};
+    double time0 = 0.0, dtime = 3600.0;
+    uint32_t ntime = 1;
+
+    size_t values() const {
+        return size_t(2) * ntime * altitudes.size() * nlat * nlon;
+    }
+};
+
+class WindGrid {
+public:
+    /// Cached enclosing cell of one moving query point
+    struct Cursor {
+        bool valid = false;
+        double lo[4], hi[4];      // Cell bounds: lat, lon, alt, time
+        size_t offset[4][2];      // Data offsets of the two nodes per axis
+        int32_t level = 0;        // Lower altitude level
+    };
+
+    WindGrid() = default;
+    ~WindGrid();
+
+    WindGrid(const WindGrid&) = delete;
+    WindGrid& operator=(const WindGrid&) = delete;
+
+    /** Map a .wind file. @return false if missing or malformed */
+    bool open(const std::string& filename);
+
+    /**
+     * Use an in-memory field, laid out as the file's data section.
+     * @return false if uv's size or the spec is inconsistent
+     */
+    bool assign(const WindGridSpec& spec, std::vector<float> uv);
+
+    void close();
+    bool is_open() const { return data_ != nullptr; }
+    const WindGridSpec& spec() const { return spec_; }
+
+    /** Write a .wind file. @return true on success */
+    static bool write(const std::string& filename, const WindGridSpec& spec,
+                      const std::vector<float>& uv);
+
+    /**
+     * Wind at a point [deg, deg, m MSL, s] as east / north components
+     * [m/s]. Zero if no grid is loaded.
+     */
+    void sample(double lat, double lon, double alt, double time, Cursor& cursor,
+                double& east, double& north) const;
+
+    /** Batched sample of n points at one time, one cursor per point */
+    void sample(size_t n, const double* lat, const double* lon, const double* alt,
+                double time, Cursor* cursors, double* east, double* north) const;
+
+private:
+    WindGridSpec spec_;
+    bool lon_wraps_ = false;
+    const float* data_ = nullptr;
+    std::vector<float> owned_;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    bool validate(const WindGridSpec& spec, size_t values) const;
+    void clamp_point(double& lat, double& lon, double& alt, double& time) const;
+    void locate(double lat, double lon, double alt, double time, Cursor& cursor) const;
+};
+
+} // namespace sim
+
+#endif // SIM_WIND_GRID_HPP
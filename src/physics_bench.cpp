@@ -0,0 +1,604 @@
+/**
+ * physics_bench — Micro-benchmarks for the core physics kernels.
+ *
+ * Times single calls of the kernels the engines spend their time in and
+ * writes one JSON document with, per kernel: ns/op (median, min and max
+ * over the samples) and, where the kernel allows, hardware counters per
+ * op. Kernels:
+ *
+ *   kepler.propagate             mc::propagate_kepler, LEO to GEO, 60 s
+ *   kepler.solve                 kepler::eccentric_anomaly, e in [0, 0.99)
+ *   kepler.batch64               kepler::eccentric_anomalies, 64 per op
+ *   elements.state_to_elements   OrbitalMechanics::state_to_elements
+ *   elements.elements_to_state   OrbitalMechanics::elements_to_state
+ *   gravity.j2                   GravityModel::compute_with_j2
+ *   perturbations.<preset>       OrbitalPerturbations::compute_total_acceleration
+ *                                for each PerturbationConfig preset
+ *   forces.<preset>              The same through acceleration_kernel (the
+ *                                preset's compiled ForceModel)
+ *   rk4.step                     RK4Integrator::step, J2 derivatives
+ *   adaptive.step                AdaptiveIntegrator::step, J2, earth_orbit()
+ *   lambert.solve                ManeuverPlanner::solve_lambert, cold start
+ *   frames.ecef_to_geodetic      FrameTransformer::ecef_to_geodetic
+ *   atmosphere.{model,extended,table}_density
+ *   atmosphere.{model,table}_state
+ *   camera.is_target_visible     SyntheticCamera::is_target_visible
+ *   formation.screen50           FormationScreener::screen, 50 chasers closing on
+ *                                one target by V-bar and R-bar approaches
+ *   formation.replan             FormationScreener::replace + screen(i), one
+ *                                chaser of the 50 replanned
+ *   ascent.guidance_update       AscentGuidance cold start + steer, two-stage
+ *                                vehicle mid-ascent to a 300 km orbit
+ *
+ * Every kernel cycles through a fixed, seeded set of inputs so results
+ * are repeatable across commits and the compiler cannot hoist the call;
+ * each op's result feeds a sink. A sample is a batch sized to about
+ * --min-time ms (calibrated once per kernel after a warm-up); ns/op is
+ * the median of --samples batches.
+ *
+ * Hardware counters (cycles, instructions, branch misses, L1D read
+ * misses) come from perf_event_open on Linux, counting this thread in
+ * user space only. Where the syscall is refused (perf_event_paranoid,
+ * containers, other platforms) the report says so and carries ns only.
+ *
+ * Usage:
+ *   physics_bench [--filter SUBSTR]... [--samples N] [--min-time MS]
+ *                 [--seed S] [--no-counters] [--list] [--output <path>]
+ */
+
+#include "core/state_vector.hpp"
+#include "coordinate/frame_transformer.hpp"
+#include "io/json_writer.hpp"
+#include "montecarlo/kepler_propagator.hpp"
+#include "physics/ascent_guidance.hpp"
+#include "physics/atmosphere_model.hpp"
+#include "physics/atmosphere_table.hpp"
+#include "physics/formation_screener.hpp"
+#include "physics/gravity_model.hpp"
+#include "physics/kepler_solver.hpp"
+#include "physics/maneuver_planner.hpp"
+#include "physics/orbital_elements.hpp"
+#include "physics/orbital_perturbations.hpp"
+#include "physics/synthetic_camera.hpp"
+#include "propagators/adaptive_integrator.hpp"
+#include "propagators/rk4_integrator.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using sim::Vec3;
+using sim::StateVector;
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t NUM_INPUTS = 256;      // inputs per kernel, cycled
+constexpr double PI = 3.14159265358979323846;
+constexpr double R_EARTH = sim::OrbitalMechanics::R_EARTH;
+
+/** Results land here so no call can be dropped as dead code. */
+volatile double g_sink = 0.0;
+
+// ── Hardware counters ──
+
+struct CounterSpec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+/**
+ * Group of perf counters on the calling thread. open() fails softly: a
+ * counter the kernel refuses is left out, and with none open the group
+ * is unavailable and stop() reads nothing.
+ */
+class PerfCounters {
+public:
+    static constexpr size_t MAX = 4;
+
+    bool open() {
+#ifdef __linux__
+        const CounterSpec specs[MAX] = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"branchMisses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {"l1dReadMisses", PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                 (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        };
+        for (const CounterSpec& s : specs) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = s.type;
+            attr.config = s.config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            const int fd = static_cast<int>(
+                syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fd < 0) continue;
+            fds_[count_] = fd;
+            names_[count_] = s.name;
+            count_++;
+        }
+#endif
+        return count_ > 0;
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (size_t i = 0; i < count_; i++) close(fds_[i]);
+#endif
+    }
+
+    size_t size() const { return count_; }
+    const char* name(size_t i) const { return names_[i]; }
+
+    void start() {
+#ifdef __linux__
+        for (size_t i = 0; i < count_; i++) {
+            ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /** Stop counting and read the values since start(). */
+    std::array<uint64_t, MAX> stop() {
+        std::array<uint64_t, MAX> v{};
+#ifdef __linux__
+        for (size_t i = 0; i < count_; i++) ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+        for (size_t i = 0; i < count_; i++) {
+            uint64_t value = 0;
+            if (read(fds_[i], &value, sizeof(value)) == sizeof(value)) v[i] = value;
+        }
+#endif
+        return v;
+    }
+
+private:
+    std::array<int, MAX> fds_{};
+    std::array<const char*, MAX> names_{};
+    size_t count_ = 0;
+};
+
+// ── Inputs ──
+
+/** Seeded orbits from LEO to GEO, moderate eccentricity, any plane. */
+std::vector<sim::OrbitalElements> make_orbits(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> alt(300e3, 36000e3);
+    std::uniform_real_distribution<double> ecc(0.0, 0.2);
+    std::uniform_real_distribution<double> inc(0.0, PI);
+    std::uniform_real_distribution<double> ang(0.0, 2.0 * PI);
+    std::vector<sim::OrbitalElements> out(NUM_INPUTS);
+    for (auto& el : out) {
+        el = sim::OrbitalElements{};
+        el.eccentricity = ecc(rng);
+        // Keep perigee above 200 km
+        const double rp = R_EARTH + alt(rng);
+        el.semi_major_axis = std::max(rp, R_EARTH + 200e3) / (1.0 - el.eccentricity);
+        el.inclination = inc(rng);
+        el.raan = ang(rng);
+        el.arg_periapsis = ang(rng);
+        el.true_anomaly = ang(rng);
+        el.mean_anomaly = el.true_anomaly;
+    }
+    return out;
+}
+
+std::vector<StateVector> make_states(const std::vector<sim::OrbitalElements>& orbits) {
+    std::vector<StateVector> out;
+    out.reserve(orbits.size());
+    for (const auto& el : orbits) out.push_back(sim::OrbitalMechanics::elements_to_state(el));
+    return out;
+}
+
+double sum(const Vec3& v) { return v.x + v.y + v.z; }
+
+// ── Kernels ──
+
+struct Kernel {
+    std::string name;
+    std::string group;
+    std::function<double(size_t)> op;   // one call on input i, returns a sink value
+};
+
+std::vector<Kernel> make_kernels(uint32_t seed) {
+    auto orbits = std::make_shared<std::vector<sim::OrbitalElements>>(make_orbits(seed));
+    auto states = std::make_shared<std::vector<StateVector>>(make_states(*orbits));
+
+    std::mt19937 rng(seed ^ 0x9e3779b9u);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Geodetic positions, sea level to LEO, for the frame and atmosphere kernels
+    auto ecef = std::make_shared<std::vector<Vec3>>();
+    auto alts = std::make_shared<std::vector<double>>();
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        const double lat = (unit(rng) - 0.5) * PI;
+        const double lon = (unit(rng) - 0.5) * 2.0 * PI;
+        const double h = unit(rng) * 400e3;
+        const double r = R_EARTH + h;
+        ecef->push_back(Vec3(r * std::cos(lat) * std::cos(lon),
+                             r * std::cos(lat) * std::sin(lon),
+                             r * std::sin(lat) * (1.0 - sim::FrameTransformer::WGS84_F)));
+        alts->push_back(unit(rng) * 150e3);
+    }
+
+    // Lambert pairs: a state and the same orbit 1/4 to 3/4 of a period later
+    struct LambertCase {
+        Vec3 r1, r2;
+        double tof;
+    };
+    auto lamberts = std::make_shared<std::vector<LambertCase>>();
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        const auto& el = (*orbits)[i];
+        const double period = 2.0 * PI * std::sqrt(std::pow(el.semi_major_axis, 3) /
+                                                     sim::OrbitalMechanics::MU_EARTH);
+        Vec3 pos = (*states)[i].position;
+        Vec3 vel = (*states)[i].velocity;
+        const double tof = period * (0.25 + 0.5 * unit(rng));
+        const Vec3 r1 = pos;
+        sim::mc::propagate_kepler(pos, vel, tof);
+        lamberts->push_back({r1, pos, tof});
+    }
+
+    // Camera over a nadir target, offset up to a few FOV widths
+    struct CameraCase {
+        Vec3 pos, vel, target;
+    };
+    auto cameras = std::make_shared<std::vector<CameraCase>>();
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        const StateVector& s = (*states)[i];
+        const double r = s.position.norm();
+        const Vec3 nadir(s.position.x / r * R_EARTH, s.position.y / r * R_EARTH,
+                         s.position.z / r * R_EARTH);
+        const double off = (unit(rng) - 0.5) * 0.1 * (r - R_EARTH);
+        cameras->push_back({s.position, s.velocity,
+                            Vec3(nadir.x + off, nadir.y - off, nadir.z)});
+    }
+    const sim::CameraConfig camera = sim::CameraConfig::recon_default();
+
+    // Kepler's equation over the whole elliptic range
+    auto anomalies = std::make_shared<std::vector<double>>();
+    auto eccs = std::make_shared<std::vector<double>>();
+    for (size_t i = 0; i < NUM_INPUTS + 64; i++) {
+        anomalies->push_back((unit(rng) - 0.5) * 2.0 * PI);
+        eccs->push_back(0.99 * unit(rng));
+    }
+
+    const double jd = 2460000.5;
+    std::vector<Kernel> k;
+
+    k.push_back({"kepler.propagate", "orbit", [states](size_t i) {
+        Vec3 pos = (*states)[i].position;
+        Vec3 vel = (*states)[i].velocity;
+        sim::mc::propagate_kepler(pos, vel, 60.0);
+        return pos.x + vel.y;
+    }});
+    k.push_back({"kepler.solve", "orbit", [anomalies, eccs](size_t i) {
+        return sim::kepler::eccentric_anomaly((*anomalies)[i], (*eccs)[i]);
+    }});
+    k.push_back({"kepler.batch64", "orbit", [anomalies, eccs](size_t i) {
+        double E[64];
+        sim::kepler::eccentric_anomalies(anomalies->data() + i, eccs->data() + i, E, 64);
+        return E[0] + E[63];
+    }});
+    k.push_back({"elements.state_to_elements", "orbit", [states](size_t i) {
+        const auto el = sim::OrbitalMechanics::state_to_elements((*states)[i]);
+        return el.semi_major_axis + el.true_anomaly;
+    }});
+    k.push_back({"elements.elements_to_state", "orbit", [orbits](size_t i) {
+        return sum(sim::OrbitalMechanics::elements_to_state((*orbits)[i]).position);
+    }});
+    k.push_back({"gravity.j2", "gravity", [states](size_t i) {
+        return sum(sim::GravityModel::compute_with_j2((*states)[i].position));
+    }});
+
+    const std::pair<const char*, sim::PerturbationConfig> presets[] = {
+        {"two_body_only", sim::PerturbationConfig::two_body_only()},
+        {"j2_only", sim::PerturbationConfig::j2_only()},
+        {"full_harmonics", sim::PerturbationConfig::full_harmonics()},
+        {"full_fidelity", sim::PerturbationConfig::full_fidelity()},
+        {"leo_satellite", sim::PerturbationConfig::leo_satellite(500.0, 10.0, 2.2)},
+        {"geo_satellite", sim::PerturbationConfig::geo_satellite(3000.0, 40.0, 1.5)},
+    };
+    for (const auto& [name, config] : presets) {
+        k.push_back({std::string("perturbations.") + name, "perturbations",
+                     [states, config = config, jd](size_t i) {
+            const StateVector& s = (*states)[i];
+            return sum(sim::OrbitalPerturbations::compute_total_acceleration(
+                s.position, s.velocity, config, jd + i * 1e-3));
+        }});
+    }
+    for (const auto& [name, config] : presets) {
+        const auto kernel = sim::OrbitalPerturbations::acceleration_kernel(config);
+        k.push_back({std::string("forces.") + name, "perturbations",
+                     [states, config = config, kernel, jd](size_t i) {
+            const StateVector& s = (*states)[i];
+            return sum(kernel(s.position, s.velocity, config, jd + i * 1e-3));
+        }});
+    }
+
+    const auto j2_rhs = [](const StateVector& s) {
+        return sim::GravityModel::compute_derivatives(s, true);
+    };
+    k.push_back({"rk4.step", "integrator", [states, j2_rhs](size_t i) {
+        return sum(sim::RK4Integrator::step((*states)[i], 10.0, j2_rhs).position);
+    }});
+    const sim::AdaptiveConfig adaptive = sim::AdaptiveConfig::earth_orbit();
+    k.push_back({"adaptive.step", "integrator", [states, j2_rhs, adaptive](size_t i) {
+        const auto step = sim::AdaptiveIntegrator::step((*states)[i], 60.0, j2_rhs, adaptive);
+        return sum(step.state.position) + step.dt_next;
+    }});
+
+    k.push_back({"lambert.solve", "maneuver", [lamberts](size_t i) {
+        const auto& c = (*lamberts)[i];
+        const auto sol = sim::ManeuverPlanner::solve_lambert(c.r1, c.r2, c.tof);
+        return sum(sol.v1) + (sol.valid ? 1.0 : 0.0);
+    }});
+
+    k.push_back({"frames.ecef_to_geodetic", "frames", [ecef](size_t i) {
+        const auto g = sim::FrameTransformer::ecef_to_geodetic((*ecef)[i]);
+        return g.latitude + g.altitude;
+    }});
+
+    k.push_back({"atmosphere.model_density", "atmosphere", [alts](size_t i) {
+        return sim::AtmosphereModel::get_density((*alts)[i]);
+    }});
+    k.push_back({"atmosphere.extended_density", "atmosphere", [alts](size_t i) {
+        return sim::AtmosphereModel::get_density_extended((*alts)[i]);
+    }});
+    k.push_back({"atmosphere.table_density", "atmosphere", [alts](size_t i) {
+        return sim::AtmosphereTable::earth().density((*alts)[i]);
+    }});
+    k.push_back({"atmosphere.model_state", "atmosphere", [alts](size_t i) {
+        const auto a = sim::AtmosphereModel::get_atmosphere((*alts)[i]);
+        return a.density + a.speed_of_sound;
+    }});
+    k.push_back({"atmosphere.table_state", "atmosphere", [alts](size_t i) {
+        const auto a = sim::AtmosphereTable::earth().state((*alts)[i]);
+        return a.density + a.speed_of_sound;
+    }});
+
+    k.push_back({"camera.is_target_visible", "sensors", [cameras, camera](size_t i) {
+        const auto& c = (*cameras)[i];
+        const auto v = sim::SyntheticCamera::is_target_visible(
+            c.pos, sim::Quat::Identity(), c.vel, c.target, camera);
+        return v.slant_range + (v.is_visible ? 1.0 : 0.0);
+    }});
+
+    // Fifty chasers from a 2 km ring to 100-300 m, staggered starts
+    const double n_target = std::sqrt(sim::OrbitalMechanics::MU_EARTH / std::pow(R_EARTH + 400e3, 3));
+    auto plans = std::make_shared<std::vector<sim::FormationPlan>>();
+    for (int c = 0; c < 50; c++) {
+        const double angle = 2.0 * PI * c / 50.0;
+        sim::FormationPlan plan;
+        plan.start = Vec3(2000.0 * std::sin(angle), 2000.0 * std::cos(angle), 200.0 * unit(rng) - 100.0);
+        plan.start_time = 600.0 * unit(rng);
+        const double final_range = 100.0 + 200.0 * unit(rng);
+        plan.trajectory = c % 2 == 0
+            ? sim::ProximityOps::plan_vbar_approach(plan.start, final_range, 0.5, n_target)
+            : sim::ProximityOps::plan_rbar_approach(plan.start, final_range, 0.5, n_target);
+        plans->push_back(plan);
+    }
+    auto formation = std::make_shared<sim::FormationScreener>();
+    formation->set_plans(*plans, n_target);
+    k.push_back({"formation.screen50", "proximity", [formation](size_t) {
+        const auto conflicts = formation->screen();
+        return static_cast<double>(conflicts.size()) +
+               (conflicts.empty() ? 0.0 : conflicts.front().tca);
+    }});
+    k.push_back({"formation.replan", "proximity", [formation, plans](size_t i) {
+        const size_t c = i % plans->size();
+        sim::FormationPlan plan = (*plans)[c];
+        plan.start_time += 30.0 * static_cast<double>(i % 7);
+        formation->replace(c, plan);
+        const auto conflicts = formation->screen(c);
+        return static_cast<double>(conflicts.size());
+    }});
+
+    // Mid-ascent states in the equatorial plane, 80-250 km, upper stage burning
+    struct AscentCase { Vec3 pos, vel; std::vector<sim::GuidanceStage> stages; };
+    auto ascents = std::make_shared<std::vector<AscentCase>>();
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        const double r = R_EARTH + 80e3 + 170e3 * unit(rng);
+        const double ve = 355.0 * 9.80665;
+        const double mass = 8000.0 + 28000.0 * unit(rng);
+        ascents->push_back({Vec3(r, 0.0, 0.0), Vec3(200.0 + 1300.0 * unit(rng), 3000.0 + 4000.0 * unit(rng),
+                                                   50.0 * unit(rng) - 25.0),
+                            {{450000.0, ve, mass, (mass - 8000.0) * ve / 450000.0}}});
+    }
+    const sim::AscentTarget ascent_target{R_EARTH + 300e3, 0.0,
+                                          std::sqrt(sim::OrbitalMechanics::MU_EARTH / (R_EARTH + 300e3)),
+                                          Vec3(0.0, 0.0, 1.0)};
+    k.push_back({"ascent.guidance_update", "guidance", [ascents, ascent_target](size_t i) {
+        const auto& c = (*ascents)[i];
+        sim::AscentGuidance guidance(ascent_target);
+        guidance.update(c.pos, c.vel, 0.0, c.stages);
+        return guidance.time_to_go() + sum(guidance.steer(c.pos, 0.5));
+    }});
+
+    return k;
+}
+
+// ── Measurement ──
+
+/** Run `iters` ops of k, cycling through its inputs; returns seconds. */
+double run_batch(const Kernel& k, uint64_t iters) {
+    double acc = 0.0;
+    const auto t0 = Clock::now();
+    for (uint64_t n = 0; n < iters; n++) acc += k.op(n % NUM_INPUTS);
+    const double s = std::chrono::duration<double>(Clock::now() - t0).count();
+    g_sink = g_sink + acc;
+    return s;
+}
+
+/** Ops per batch so one batch takes about min_time_s (at least NUM_INPUTS). */
+uint64_t calibrate(const Kernel& k, double min_time_s) {
+    uint64_t iters = NUM_INPUTS;
+    for (;;) {
+        const double s = run_batch(k, iters);
+        if (s >= min_time_s * 0.5 || iters >= (uint64_t{1} << 32)) {
+            const double scaled = iters * (min_time_s / std::max(s, 1e-9));
+            return std::max<uint64_t>(NUM_INPUTS, static_cast<uint64_t>(scaled));
+        }
+        iters *= 4;
+    }
+}
+
+bool matches(const std::string& name, const std::vector<std::string>& filters) {
+    if (filters.empty()) return true;
+    for (const auto& f : filters) {
+        if (name.find(f) != std::string::npos) return true;
+    }
+    return false;
+}
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "  --filter SUBSTR      Run kernels whose name contains SUBSTR (repeatable)\n"
+              << "  --samples N          Timed batches per kernel (default: 9)\n"
+              << "  --min-time MS        Target batch duration (default: 50)\n"
+              << "  --seed S             Input seed (default: 42)\n"
+              << "  --no-counters        Skip the perf_event_open hardware counters\n"
+              << "  --list               Print kernel names and exit\n"
+              << "  --output <path>      Write the report here (default: stdout)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> filters;
+    int samples = 9;
+    double min_time_ms = 50.0;
+    uint32_t seed = 42;
+    bool counters = true;
+    bool list = false;
+    std::string output_path;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_next = i + 1 < argc;
+            if (arg == "--filter" && has_next) {
+                filters.push_back(argv[++i]);
+            } else if (arg == "--samples" && has_next) {
+                samples = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--min-time" && has_next) {
+                min_time_ms = std::max(0.1, std::stod(argv[++i]));
+            } else if (arg == "--seed" && has_next) {
+                seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--no-counters") {
+                counters = false;
+            } else if (arg == "--list") {
+                list = true;
+            } else if (arg == "--output" && has_next) {
+                output_path = argv[++i];
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    const std::vector<Kernel> kernels = make_kernels(seed);
+    if (list) {
+        for (const Kernel& k : kernels) std::cout << k.name << "\n";
+        return 0;
+    }
+
+    PerfCounters perf;
+    const bool have_counters = counters && perf.open();
+
+    std::ofstream file_out;
+    if (!output_path.empty()) {
+        file_out.open(output_path);
+        if (!file_out) {
+            std::cerr << "Error: cannot open output file " << output_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = output_path.empty() ? std::cout : file_out;
+
+    sim::JsonWriter w(out);
+    w.begin_object();
+    w.kv("bench", "physics_bench");
+    w.key("config").begin_object();
+    w.kv("samples", samples);
+    w.kv("minTimeMs", min_time_ms);
+    w.kv("seed", static_cast<int64_t>(seed));
+    w.kv("inputs", static_cast<int64_t>(NUM_INPUTS));
+    w.kv("counters", have_counters);
+    w.end_object();
+    w.key("kernels").begin_array();
+
+    for (const Kernel& k : kernels) {
+        if (!matches(k.name, filters)) continue;
+        std::cerr << "[bench] " << k.name << "\n";
+
+        run_batch(k, NUM_INPUTS);   // warm caches and lazy tables
+        const uint64_t iters = calibrate(k, min_time_ms * 1e-3);
+
+        std::vector<double> ns(samples);
+        std::array<std::vector<double>, PerfCounters::MAX> per_op;
+        for (int s = 0; s < samples; s++) {
+            if (have_counters) perf.start();
+            const double secs = run_batch(k, iters);
+            if (have_counters) {
+                const auto v = perf.stop();
+                for (size_t c = 0; c < perf.size(); c++) {
+                    per_op[c].push_back(static_cast<double>(v[c]) / iters);
+                }
+            }
+            ns[s] = secs * 1e9 / iters;
+        }
+        auto median = [](std::vector<double> x) {
+            std::sort(x.begin(), x.end());
+            const size_t m = x.size() / 2;
+            return x.size() % 2 ? x[m] : 0.5 * (x[m - 1] + x[m]);
+        };
+
+        w.begin_object();
+        w.kv("name", k.name);
+        w.kv("group", k.group);
+        w.kv("opsPerSample", static_cast<int64_t>(iters));
+        w.kv("nsPerOp", median(ns));
+        w.kv("nsPerOpMin", *std::min_element(ns.begin(), ns.end()));
+        w.kv("nsPerOpMax", *std::max_element(ns.begin(), ns.end()));
+        if (have_counters) {
+            w.key("perOp").begin_object();
+            for (size_t c = 0; c < perf.size(); c++) w.kv(perf.name(c), median(per_op[c]));
+            w.end_object();
+        }
+        w.end_object();
+    }
+
+    w.end_array();
+    w.end_object();
+    out << "\n";
+    return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * Access Planner Implementation
+ */
+
+#include "propagators/access_planner.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG = PI / 180.0;
+constexpr double WGS84_A = 6378137.0;
+constexpr double WGS84_E2 = 6.69437999014e-3;
+constexpr double EARTH_RATE = 360.98564736629 * DEG / 86400.0;   // GMST rate [rad/s]
+constexpr double CONE_PAD = 0.5 * DEG;   // Geodetic vs geocentric normal, altitude
+
+/** Greenwich mean sidereal angle at a Julian date [rad] (as GravityField::gmst) */
+double gmst(double jd) {
+    double deg = std::fmod(280.46061837 + 360.98564736629 * (jd - 2451545.0), 360.0);
+    if (deg < 0.0) deg += 360.0;
+    return deg * DEG;
+}
+
+/// A station in the Earth-fixed frame
+struct Site {
+    double p[3];          // Position [m]
+    double up[3];         // Ellipsoid normal
+    double dir[3];        // Geocentric unit vector
+    double radius;        // Geocentric radius [m]
+    double sin_mask;
+    double cos_mask;
+    double mask;          // [rad]
+};
+
+Site make_site(const GroundStation& gs) {
+    Site s;
+    const double lat = gs.latitude * DEG, lon = gs.longitude * DEG;
+    const double sl = std::sin(lat), cl = std::cos(lat);
+    const double N = WGS84_A / std::sqrt(1.0 - WGS84_E2 * sl * sl);
+    s.p[0] = (N + gs.altitude) * cl * std::cos(lon);
+    s.p[1] = (N + gs.altitude) * cl * std::sin(lon);
+    s.p[2] = (N * (1.0 - WGS84_E2) + gs.altitude) * sl;
+    s.up[0] = cl * std::cos(lon);
+    s.up[1] = cl * std::sin(lon);
+    s.up[2] = sl;
+    s.radius = std::sqrt(s.p[0] * s.p[0] + s.p[1] * s.p[1] + s.p[2] * s.p[2]);
+    for (int k = 0; k < 3; k++) s.dir[k] = s.p[k] / s.radius;
+    s.mask = gs.min_elevation * DEG;
+    s.sin_mask = std::sin(s.mask);
+    s.cos_mask = std::cos(s.mask);
+    return s;
+}
+
+/// One satellite's Hermite segment over a grid interval, in ECI
+struct Segment {
+    double p0[3], m0[3], p1[3], m1[3];   // Endpoints and tangents (velocity * h)
+    double theta0;                       // GMST at s = 0
+    double h;                            // Interval length [s]
+
+    /** Earth-fixed position at s in [0, 1] */
+    void ecef(double s, double out[3]) const {
+        const double s2 = s * s, s3 = s2 * s;
+        const double h00 = 2 * s3 - 3 * s2 + 1, h10 = s3 - 2 * s2 + s;
+        const double h01 = -2 * s3 + 3 * s2, h11 = s3 - s2;
+        double r[3];
+        for (int k = 0; k < 3; k++) {
+            r[k] = h00 * p0[k] + h10 * m0[k] + h01 * p1[k] + h11 * m1[k];
+        }
+        const double th = theta0 + EARTH_RATE * s * h;
+        const double c = std::cos(th), sn = std::sin(th);
+        out[0] = c * r[0] + sn * r[1];
+        out[1] = -sn * r[0] + c * r[1];
+        out[2] = r[2];
+    }
+};
+
+/** sin(elevation) - sin(mask) of an Earth-fixed position */
+double visibility(const Site& site, const double r[3]) {
+    const double d[3] = {r[0] - site.p[0], r[1] - site.p[1], r[2] - site.p[2]};
+    const double len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+    if (!(len > 0.0)) return -1.0;
+    return (d[0] * site.up[0] + d[1] * site.up[1] + d[2] * site.up[2]) / len - site.sin_mask;
+}
+
+/** Root of f in [a, b] (f(a), f(b) of opposite sign) by Illinois regula falsi */
+template <typename F>
+double illinois(const F& f, double a, double b, double fa, double fb, double tol) {
+    int side = 0;
+    for (int it = 0; it < 100 && b - a > tol; it++) {
+        const double c = (a * fb - b * fa) / (fb - fa);
+        const double fc = f(c);
+        if ((fc > 0.0) == (fb > 0.0)) {
+            b = c;
+            fb = fc;
+            if (side == -1) fa *= 0.5;
+            side = -1;
+        } else {
+            a = c;
+            fa = fc;
+            if (side == 1) fb *= 0.5;
+            side = 1;
+        }
+        if (fc == 0.0) return c;
+    }
+    return 0.5 * (a + b);
+}
+
+/** Maximum of a unimodal f on [a, b] by golden-section search; returns its argument */
+template <typename F>
+double golden_max(const F& f, double a, double b, double tol) {
+    const double g = 0.5 * (std::sqrt(5.0) - 1.0);
+    double c = b - g * (b - a), d = a + g * (b - a);
+    double fc = f(c), fd = f(d);
+    while (b - a > tol) {
+        if (fc > fd) {
+            b = d; d = c; fd = fc;
+            c = b - g * (b - a); fc = f(c);
+        } else {
+            a = c; c = d; fc = fd;
+            d = a + g * (b - a); fd = f(d);
+        }
+    }
+    return 0.5 * (a + b);
+}
+
+struct WorkerResult {
+    std::vector<AccessWindow> found;
+    AccessStats counts;
+};
+
+} // namespace
+
+AccessPlanner::AccessPlanner(std::vector<GroundStation> stations, const AccessConfig& config)
+    : stations_(std::move(stations)), config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+std::vector<AccessWindow> AccessPlanner::plan(size_t num_satellites, const Sampler& sampler,
+                                              double start_jd, double end_jd) {
+    stats_ = AccessStats();
+    stats_.satellites = num_satellites;
+    stats_.stations = stations_.size();
+    std::vector<AccessWindow> result;
+    const double span = (end_jd - start_jd) * 86400.0;
+    if (num_satellites == 0 || stations_.empty() || !(span > 0.0) || !(config_.step > 0.0)) {
+        return result;
+    }
+
+    const size_t n = num_satellites;
+    const size_t m = stations_.size();
+    const int substeps = std::max(1, config_.substeps);
+    const int n_intervals = static_cast<int>(std::ceil(span / config_.step - 1e-9));
+
+    std::vector<Site> sites;
+    sites.reserve(m);
+    for (const auto& gs : stations_) sites.push_back(make_site(gs));
+
+    // Open window of each (satellite, station), row per satellite; NaN rise = closed
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> rise(n * m, nan), peak(n * m, -2.0), peak_t(n * m, 0.0);
+
+    ConjunctionSnapshot snap[2];
+    for (auto& s : snap) {
+        for (auto* v : {&s.x, &s.y, &s.z, &s.vx, &s.vy, &s.vz}) v->assign(n, 0.0);
+    }
+    sampler(start_jd, snap[0]);
+
+    const size_t n_workers = pool_ ? static_cast<size_t>(pool_->size()) : 1;
+    std::vector<WorkerResult> workers(n_workers);
+
+    auto emit = [&](WorkerResult& out, size_t i, size_t k, double set_t) {
+        const size_t slot = i * m + k;
+        AccessWindow w;
+        w.satellite = i;
+        w.station = k;
+        w.rise_jd = start_jd + rise[slot] / 86400.0;
+        w.set_jd = start_jd + set_t / 86400.0;
+        const double sin_el = std::min(1.0, std::max(-1.0, peak[slot] + sites[k].sin_mask));
+        w.max_elevation = std::asin(sin_el) / DEG;
+        w.max_elevation_jd = start_jd + peak_t[slot] / 86400.0;
+        out.found.push_back(w);
+        rise[slot] = nan;
+        peak[slot] = -2.0;
+    };
+
+    for (int iv = 0; iv < n_intervals; iv++) {
+        const double t0 = iv * config_.step;
+        const double t1 = std::min(span, (iv + 1) * config_.step);
+        const double h = t1 - t0;
+        const int a = iv & 1, b = a ^ 1;
+        const ConjunctionSnapshot& A = snap[a];
+        const ConjunctionSnapshot& B = snap[b];
+        sampler(start_jd + t1 / 86400.0, snap[b]);
+        const double theta0 = gmst(start_jd + t0 / 86400.0);
+
+        auto process = [&](size_t i, int worker) {
+            WorkerResult& out = workers[static_cast<size_t>(worker)];
+            const double ra = std::sqrt(A.x[i] * A.x[i] + A.y[i] * A.y[i] + A.z[i] * A.z[i]);
+            const double rb = std::sqrt(B.x[i] * B.x[i] + B.y[i] * B.y[i] + B.z[i] * B.z[i]);
+            const bool valid = ra >= 1.0 && rb >= 1.0 &&
+                               std::isfinite(ra + rb + A.vx[i] + A.vy[i] + A.vz[i] +
+                                             B.vx[i] + B.vy[i] + B.vz[i]);
+            if (!valid) {
+                // No trajectory this interval: close what was open at its start
+                for (size_t k = 0; k < m; k++) {
+                    if (!std::isnan(rise[i * m + k])) emit(out, i, k, t0);
+                }
+                return;
+            }
+
+            Segment seg;
+            seg.p0[0] = A.x[i]; seg.p0[1] = A.y[i]; seg.p0[2] = A.z[i];
+            seg.p1[0] = B.x[i]; seg.p1[1] = B.y[i]; seg.p1[2] = B.z[i];
+            seg.m0[0] = A.vx[i] * h; seg.m0[1] = A.vy[i] * h; seg.m0[2] = A.vz[i] * h;
+            seg.m1[0] = B.vx[i] * h; seg.m1[1] = B.vy[i] * h; seg.m1[2] = B.vz[i] * h;
+            seg.theta0 = theta0;
+            seg.h = h;
+
+            double samples[64][3];
+            const int S = std::min(substeps, 63);
+            for (int j = 0; j <= S; j++) seg.ecef(static_cast<double>(j) / S, samples[j]);
+
+            // Largest angle the sub-satellite point can move in one step
+            const double va = std::sqrt(A.vx[i] * A.vx[i] + A.vy[i] * A.vy[i] + A.vz[i] * A.vz[i]);
+            const double vb = std::sqrt(B.vx[i] * B.vx[i] + B.vy[i] * B.vy[i] + B.vz[i] * B.vz[i]);
+            const double sweep = 1.5 * std::max(va / ra, vb / rb) * h + EARTH_RATE * h + CONE_PAD;
+            const double r_max = std::max(ra, rb);
+
+            for (size_t k = 0; k < m; k++) {
+                const Site& site = sites[k];
+                const size_t slot = i * m + k;
+                const bool open = !std::isnan(rise[slot]);
+                out.counts.pair_intervals++;
+
+                if (!open) {
+                    const double cone = std::acos(std::min(1.0, site.radius * site.cos_mask / r_max)) -
+                                        site.mask + sweep;
+                    if (cone < PI) {
+                        const double* q = samples[0];
+                        const double cos_angle = (q[0] * site.dir[0] + q[1] * site.dir[1] +
+                                                  q[2] * site.dir[2]) / ra;
+                        if (cos_angle < std::cos(cone)) {
+                            out.counts.cone_rejects++;
+                            continue;
+                        }
+                    }
+                }
+
+                auto f = [&](double s) {
+                    double r[3];
+                    seg.ecef(s, r);
+                    return visibility(site, r);
+                };
+                double fs[64] = {};
+                for (int j = 0; j <= S; j++) fs[j] = visibility(site, samples[j]);
+
+                // Reconcile with the state carried from the previous interval
+                bool vis = fs[0] > 0.0;
+                if (vis && !open) {
+                    rise[slot] = t0;
+                } else if (!vis && open) {
+                    emit(out, i, k, t0);
+                }
+
+                // Peak first: a set found below closes the window with it
+                int best = -1;
+                for (int j = 0; j <= S; j++) {
+                    if (fs[j] > 0.0 && (best < 0 || fs[j] > fs[best])) best = j;
+                }
+                if (best >= 0) {
+                    const double lo = static_cast<double>(std::max(0, best - 1)) / S;
+                    const double hi = static_cast<double>(std::min(S, best + 1)) / S;
+                    double s = golden_max(f, lo, hi, config_.time_tolerance / h);
+                    double fv = f(s);
+                    if (fv < fs[best]) {
+                        s = static_cast<double>(best) / S;
+                        fv = fs[best];
+                    }
+                    if (fv > peak[slot]) {
+                        peak[slot] = fv;
+                        peak_t[slot] = t0 + s * h;
+                    }
+                }
+
+                for (int j = 1; j <= S; j++) {
+                    if ((fs[j] > 0.0) == vis) continue;
+                    const double s0 = static_cast<double>(j - 1) / S;
+                    const double s1 = static_cast<double>(j) / S;
+                    const double s = illinois(f, s0, s1, fs[j - 1], fs[j], config_.time_tolerance / h);
+                    out.counts.crossings++;
+                    vis = fs[j] > 0.0;
+                    if (vis) {
+                        rise[slot] = t0 + s * h;
+                    } else {
+                        emit(out, i, k, t0 + s * h);
+                    }
+                }
+            }
+        };
+
+        if (pool_) {
+            pool_->parallel_for(n, process);
+        } else {
+            for (size_t i = 0; i < n; i++) process(i, 0);
+        }
+        stats_.intervals++;
+    }
+
+    // Windows still open at the end of the span
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = 0; k < m; k++) {
+            if (!std::isnan(rise[i * m + k])) emit(workers[0], i, k, span);
+        }
+    }
+
+    for (auto& w : workers) {
+        result.insert(result.end(), w.found.begin(), w.found.end());
+        stats_.pair_intervals += w.counts.pair_intervals;
+        stats_.cone_rejects += w.counts.cone_rejects;
+        stats_.crossings += w.counts.crossings;
+    }
+    std::sort(result.begin(), result.end(), [](const AccessWindow& x, const AccessWindow& y) {
+        if (x.rise_jd != y.rise_jd) return x.rise_jd < y.rise_jd;
+        return x.station != y.station ? x.station < y.station : x.satellite < y.satellite;
+    });
+    stats_.windows = result.size();
+    return result;
+}
+
+AccessTimeline::AccessTimeline(std::vector<AccessWindow> windows)
+    : windows_(std::move(windows)) {
+    std::stable_sort(windows_.begin(), windows_.end(),
+                     [](const AccessWindow& x, const AccessWindow& y) { return x.rise_jd < y.rise_jd; });
+
+    max_set_.resize(windows_.size());
+    build(0, windows_.size());
+
+    for (size_t w = 0; w < windows_.size(); w++) {
+        const size_t k = windows_[w].station;
+        if (k >= by_station_.size()) by_station_.resize(k + 1);
+        by_station_[k].push_back(static_cast<uint32_t>(w));
+    }
+}
+
+double AccessTimeline::build(size_t lo, size_t hi) {
+    if (lo >= hi) return -std::numeric_limits<double>::infinity();
+    const size_t mid = lo + (hi - lo) / 2;
+    max_set_[mid] = std::max(windows_[mid].set_jd, std::max(build(lo, mid), build(mid + 1, hi)));
+    return max_set_[mid];
+}
+
+template <typename Visit>
+void AccessTimeline::stab(size_t lo, size_t hi, double begin_jd, double end_jd, Visit& visit) const {
+    if (lo >= hi) return;
+    const size_t mid = lo + (hi - lo) / 2;
+    if (max_set_[mid] <= begin_jd) return;   // Everything here has set
+    stab(lo, mid, begin_jd, end_jd, visit);
+    const AccessWindow& w = windows_[mid];
+    // A point query takes rise == jd, a range query stops at its open end
+    const bool after = end_jd > begin_jd ? w.rise_jd >= end_jd : w.rise_jd > end_jd;
+    if (after) return;   // Nor does anything to the right
+    if (w.set_jd > begin_jd) visit(w);
+    stab(mid + 1, hi, begin_jd, end_jd, visit);
+}
+
+std::vector<const AccessWindow*> AccessTimeline::visible_at(double jd, size_t station) const {
+    std::vector<const AccessWindow*> out;
+    auto visit = [&](const AccessWindow& w) {
+        if (station == ANY || w.station == station) out.push_back(&w);
+    };
+    stab(0, windows_.size(), jd, jd, visit);
+    return out;
+}
+
+std::vector<const AccessWindow*> AccessTimeline::overlapping(double begin_jd, double end_jd) const {
+    std::vector<const AccessWindow*> out;
+    if (!(end_jd > begin_jd)) return out;
+    auto visit = [&](const AccessWindow& w) { out.push_back(&w); };
+    stab(0, windows_.size(), begin_jd, end_jd, visit);
+    return out;
+}
+
+const AccessWindow* AccessTimeline::next_contact(size_t station, double jd) const {
+    if (station >= by_station_.size()) return nullptr;
+    const auto& list = by_station_[station];
+    auto it = std::lower_bound(list.begin(), list.end(), jd,
+                               [&](uint32_t w, double t) { return windows_[w].rise_jd < t; });
+    return it == list.end() ? nullptr : &windows_[*it];
+}
+
+const AccessWindow* AccessTimeline::next_contact(size_t station, size_t satellite, double jd) const {
+    if (station >= by_station_.size()) return nullptr;
+    const auto& list = by_station_[station];
+    auto it = std::lower_bound(list.begin(), list.end(), jd,
+                               [&](uint32_t w, double t) { return windows_[w].rise_jd < t; });
+    for (; it != list.end(); ++it) {
+        if (windows_[*it].satellite == satellite) return &windows_[*it];
+    }
+    return nullptr;
+}
+
+}  // namespace sim
@@ -0,0 +1,153 @@
+/**
+ * Access Planner — satellite-to-ground-station contact windows
+ *
+ * Finds every interval in which a satellite stands above a station's
+ * elevation mask, for many satellites against many stations, from the same
+ * samplers ConjunctionScreener uses (SGP4Batch through sgp4_sampler, a
+ * CatalogPropagator, or any caller-supplied one).
+ *
+ * Every satellite is sampled on a coarse time grid. Between two samples
+ * its path is the cubic Hermite interpolant of the sampled positions and
+ * velocities, rotated into the Earth-fixed frame by GMST. Per grid
+ * interval and pair:
+ *
+ *   1. Visibility cone: a satellite at radius r is above elevation e only
+ *      within the Earth-central angle acos(R cos e / r) - e of the station.
+ *      The pair is skipped when the angle at the start of the interval
+ *      exceeds that cone plus the largest angle the satellite and the
+ *      Earth can turn in one step.
+ *   2. Crossings: sin(elevation) - sin(mask) is scanned in `substeps`
+ *      pieces for sign changes, and each is refined by Illinois regula
+ *      falsi to `time_tolerance`. A pass shorter than one scan piece can
+ *      be missed.
+ *   3. Peak: the highest scan sample of a visible interval is refined by
+ *      golden-section search on the interpolant.
+ *
+ * Stations are WGS84 geodetic; elevation is measured from the ellipsoid
+ * normal. A window already open at start_jd or still open at end_jd is
+ * clipped to the span. Satellites are processed in parallel, each owning
+ * its row of open windows; results are sorted by rise time.
+ *
+ * AccessTimeline indexes a window set for time queries: an interval tree
+ * (windows sorted by rise, each implicit-tree node carrying its subtree's
+ * latest set) answers "visible at t" and "overlapping [a, b)" in
+ * O(log n + k), and per-station rise lists answer "next contact".
+ */
+
+#ifndef SIM_ACCESS_PLANNER_HPP
+#define SIM_ACCESS_PLANNER_HPP
+
+#include "propagators/conjunction_screener.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+struct GroundStation {
+    std::string name;
+    double latitude = 0.0;            // Geodetic [deg]
+    double longitude = 0.0;           // [deg]
+    double altitude = 0.0;            // Above the ellipsoid [m]
+    double min_elevation = 10.0;      // Elevation mask [deg]
+};
+
+struct AccessConfig {
+    double step = 60.0;               // Coarse grid step [s]
+    int substeps = 4;                 // Scan pieces per grid step (1-63)
+    double time_tolerance = 1e-3;     // Rise/set root bracket width [s]
+    int num_threads = 0;              // 0 = hardware concurrency, 1 = serial
+};
+
+/// One contact
+struct AccessWindow {
+    size_t satellite;                 // Sampler object index
+    size_t station;                   // Index into the station list
+    double rise_jd;
+    double set_jd;
+    double max_elevation;             // [deg]
+    double max_elevation_jd;
+
+    double duration() const { return (set_jd - rise_jd) * 86400.0; }   // [s]
+};
+
+struct AccessStats {
+    size_t satellites = 0;
+    size_t stations = 0;
+    size_t intervals = 0;
+    size_t pair_intervals = 0;        // Satellite-station pairs tested per interval, summed
+    size_t cone_rejects = 0;
+    size_t crossings = 0;             // Rise and set roots refined
+    size_t windows = 0;
+};
+
+class AccessPlanner {
+public:
+    using Sampler = ConjunctionScreener::Sampler;
+
+    explicit AccessPlanner(std::vector<GroundStation> stations,
+                           const AccessConfig& config = AccessConfig());
+
+    /**
+     * Access windows of num_satellites sampled objects over [start_jd, end_jd].
+     * Positions must be TEME or true-of-date ECI (GMST takes them to ECEF).
+     * @return Windows by rise time
+     */
+    std::vector<AccessWindow> plan(size_t num_satellites, const Sampler& sampler,
+                                   double start_jd, double end_jd);
+
+    const std::vector<GroundStation>& stations() const { return stations_; }
+    const AccessStats& stats() const { return stats_; }
+
+private:
+    std::vector<GroundStation> stations_;
+    AccessConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+    AccessStats stats_;
+};
+
+/**
+ * Access windows indexed by time. Immutable once built; queries are
+ * thread-safe and return windows in rise order.
+ */
+class AccessTimeline {
+public:
+    static constexpr size_t ANY = SIZE_MAX;
+
+    AccessTimeline() = default;
+    explicit AccessTimeline(std::vector<AccessWindow> windows);
+
+    /** Windows with rise <= jd < set (of one station, or of all) */
+    std::vector<const AccessWindow*> visible_at(double jd, size_t station = ANY) const;
+
+    /** Windows intersecting [begin_jd, end_jd) */
+    std::vector<const AccessWindow*> overlapping(double begin_jd, double end_jd) const;
+
+    /** First window of a station rising at or after jd; nullptr if none */
+    const AccessWindow* next_contact(size_t station, double jd) const;
+
+    /** First window of a satellite-station pair rising at or after jd */
+    const AccessWindow* next_contact(size_t station, size_t satellite, double jd) const;
+
+    const std::vector<AccessWindow>& windows() const { return windows_; }
+    size_t size() const { return windows_.size(); }
+
+private:
+    std::vector<AccessWindow> windows_;             // By rise
+    std::vector<double> max_set_;                   // Latest set in each node's subtree
+    std::vector<std::vector<uint32_t>> by_station_; // Window indices by rise
+
+    /** Fill max_set_ for the node of [lo, hi); returns its value */
+    double build(size_t lo, size_t hi);
+
+    template <typename Visit>
+    void stab(size_t lo, size_t hi, double begin_jd, double end_jd, Visit& visit) const;
+};
+
+}  // namespace sim
+
+#endif  // SIM_ACCESS_PLANNER_HPP
@@ -8,59 +8,64 @@
  */
 
 #include "adaptive_integrator.hpp"
+#include "integrator_kernels.hpp"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 namespace sim {
 
-// ─────────────────────────────────────────────────────────────
-// Helpers
-// ─────────────────────────────────────────────────────────────
+namespace {
+
+using Dense6 = Dopri5Dense<6>;
+
+// Dormand-Prince step over StateVector, also returning the dense output.
+// Stages carry the caller's attitude and frame; angular_velocity of the
+// derivative holds dv/dt. Stage times are clamped to [t_lo, t_hi]
+IntegrationStep dense_step(const StateVector& state, double dt_try,
+                           const AdaptiveIntegrator::DerivativeFunction& compute_derivatives,
+                           const AdaptiveConfig& config, Dense6* dense,
+                           double t_lo = -std::numeric_limits<double>::infinity(),
+                           double t_hi = std::numeric_limits<double>::infinity()) {
+    StateVector stage = state;
+    auto rhs = [&](double t, const std::array<double, 6>& y, std::array<double, 6>& dydt) {
+        stage.position = Vec3(y[0], y[1], y[2]);
+        stage.velocity = Vec3(y[3], y[4], y[5]);
+        stage.time = std::min(std::max(t, t_lo), t_hi);
+        StateVector d = compute_derivatives(stage);
+        dydt = {d.velocity.x, d.velocity.y, d.velocity.z,
+                d.angular_velocity.x, d.angular_velocity.y, d.angular_velocity.z};
+    };
+
+    OrbitState6 s{state.time, {state.position.x, state.position.y, state.position.z,
+                               state.velocity.x, state.velocity.y, state.velocity.z}};
+    FixedStep<6> r = dopri5_step(s, dt_try, rhs, config, dense);
+
+    StateVector out = state;
+    out.position = Vec3(r.state.y[0], r.state.y[1], r.state.y[2]);
+    out.velocity = Vec3(r.state.y[3], r.state.y[4], r.state.y[5]);
+    out.time = r.state.t;
+    return IntegrationStep{out, r.dt_used, r.dt_next, r.error_estimate};
+}
 
-StateVector AdaptiveIntegrator::add_states(const StateVector& base,
-                                            const StateVector& deriv,
-                                            double h) {
-    StateVector result = base;
-    result.position.x += h * deriv.velocity.x;
-    result.position.y += h * deriv.velocity.y;
-    result.position.z += h * deriv.velocity.z;
-    result.velocity.x += h * deriv.angular_velocity.x;  // angular_velocity stores dv/dt
-    result.velocity.y += h * deriv.angular_velocity.y;
-    result.velocity.z += h * deriv.angular_velocity.z;
-    return result;
+// Interpolated state at t, attitude and frame from `like`
+StateVector interpolate(const Dense6& dense, const StateVector& like, double t) {
+    OrbitState6 y = dense.at(t);
+    StateVector out = like;
+    out.position = Vec3(y.y[0], y.y[1], y.y[2]);
+    out.velocity = Vec3(y.y[3], y.y[4], y.y[5]);
+    out.time = t;
+    return out;
 }
 
-double AdaptiveIntegrator::compute_error(const StateVector& y4, const StateVector& y5,
-                                          const AdaptiveConfig& config) {
-    // Error in position components (primary metric for orbit propagation)
-    double scale_x = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.position.x), std::fabs(y5.position.x));
-    double scale_y = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.position.y), std::fabs(y5.position.y));
-    double scale_z = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.position.z), std::fabs(y5.position.z));
-
-    double ex = (y5.position.x - y4.position.x) / scale_x;
-    double ey = (y5.position.y - y4.position.y) / scale_y;
-    double ez = (y5.position.z - y4.position.z) / scale_z;
-
-    // Also include velocity error
-    double vscale_x = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.velocity.x), std::fabs(y5.velocity.x));
-    double vscale_y = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.velocity.y), std::fabs(y5.velocity.y));
-    double vscale_z = config.abs_tolerance + config.rel_tolerance *
-        std::max(std::fabs(y4.velocity.z), std::fabs(y5.velocity.z));
-
-    double evx = (y5.velocity.x - y4.velocity.x) / vscale_x;
-    double evy = (y5.velocity.y - y4.velocity.y) / vscale_y;
-    double evz = (y5.velocity.z - y4.velocity.z) / vscale_z;
-
-    // RMS error (6 components)
-    return std::sqrt((ex*ex + ey*ey + ez*ez + evx*evx + evy*evy + evz*evz) / 6.0);
+double initial_step(double duration, const AdaptiveConfig& config) {
+    double dt = std::min(duration * 0.001, config.dt_max);
+    return std::max(dt, config.dt_min);
 }
 
+} // namespace
+
 // ─────────────────────────────────────────────────────────────
 // Single adaptive step
 // ─────────────────────────────────────────────────────────────
@@ -70,130 +75,7 @@ IntegrationStep AdaptiveIntegrator::step(
     double dt_try,
     DerivativeFunction compute_derivatives,
     const AdaptiveConfig& config) {
-
-    double h = dt_try;
-    StateVector y = state;
-
-    for (int attempts = 0; attempts < 100; ++attempts) {
-        // Clamp step size
-        h = std::max(h, config.dt_min);
-        h = std::min(h, config.dt_max);
-
-        // ── Stage 1 (evaluate at current state) ──
-        StateVector k1 = compute_derivatives(y);
-
-        // ── Stage 2 ──
-        StateVector y2 = y;
-        y2.position.x = y.position.x + h * a21 * k1.velocity.x;
-        y2.position.y = y.position.y + h * a21 * k1.velocity.y;
-        y2.position.z = y.position.z + h * a21 * k1.velocity.z;
-        y2.velocity.x = y.velocity.x + h * a21 * k1.angular_velocity.x;
-        y2.velocity.y = y.velocity.y + h * a21 * k1.angular_velocity.y;
-        y2.velocity.z = y.velocity.z + h * a21 * k1.angular_velocity.z;
-        y2.time = y.time + h * c2;
-        StateVector k2 = compute_derivatives(y2);
-
-        // ── Stage 3 ──
-        StateVector y3 = y;
-        y3.position.x = y.position.x + h * (a31 * k1.velocity.x + a32 * k2.velocity.x);
-        y3.position.y = y.position.y + h * (a31 * k1.velocity.y + a32 * k2.velocity.y);
-        y3.position.z = y.position.z + h * (a31 * k1.velocity.z + a32 * k2.velocity.z);
-        y3.velocity.x = y.velocity.x + h * (a31 * k1.angular_velocity.x + a32 * k2.angular_velocity.x);
-        y3.velocity.y = y.velocity.y + h * (a31 * k1.angular_velocity.y + a32 * k2.angular_velocity.y);
-        y3.velocity.z = y.velocity.z + h * (a31 * k1.angular_velocity.z + a32 * k2.angular_velocity.z);
-        y3.time = y.time + h * c3;
-        StateVector k3 = compute_derivatives(y3);
-
-        // ── Stage 4 ──
-        StateVector y4s = y;
-        y4s.position.x = y.position.x + h * (a41 * k1.velocity.x + a42 * k2.velocity.x + a43 * k3.velocity.x);
-        y4s.position.y = y.position.y + h * (a41 * k1.velocity.y + a42 * k2.velocity.y + a43 * k3.velocity.y);
-        y4s.position.z = y.position.z + h * (a41 * k1.velocity.z + a42 * k2.velocity.z + a43 * k3.velocity.z);
-        y4s.velocity.x = y.velocity.x + h * (a41 * k1.angular_velocity.x + a42 * k2.angular_velocity.x + a43 * k3.angular_velocity.x);
-        y4s.velocity.y = y.velocity.y + h * (a41 * k1.angular_velocity.y + a42 * k2.angular_velocity.y + a43 * k3.angular_velocity.y);
-        y4s.velocity.z = y.velocity.z + h * (a41 * k1.angular_velocity.z + a42 * k2.angular_velocity.z + a43 * k3.angular_velocity.z);
-        y4s.time = y.time + h * c4;
-        StateVector k4 = compute_derivatives(y4s);
-
-        // ── Stage 5 ──
-        StateVector y5s = y;
-        y5s.position.x = y.position.x + h * (a51*k1.velocity.x + a52*k2.velocity.x + a53*k3.velocity.x + a54*k4.velocity.x);
-        y5s.position.y = y.position.y + h * (a51*k1.velocity.y + a52*k2.velocity.y + a53*k3.velocity.y + a54*k4.velocity.y);
-        y5s.position.z = y.position.z + h * (a51*k1.velocity.z + a52*k2.velocity.z + a53*k3.velocity.z + a54*k4.velocity.z);
-        y5s.velocity.x = y.velocity.x + h * (a51*k1.angular_velocity.x + a52*k2.angular_velocity.x + a53*k3.angular_velocity.x + a54*k4.angular_velocity.x);
-        y5s.velocity.y = y.velocity.y + h * (a51*k1.angular_velocity.y + a52*k2.angular_velocity.y + a53*k3.angular_velocity.y + a54*k4.angular_velocity.y);
-        y5s.velocity.z = y.velocity.z + h * (a51*k1.angular_velocity.z + a52*k2.angular_velocity.z + a53*k3.angular_velocity.z + a54*k4.angular_velocity.z);
-        y5s.time = y.time + h * c5;
-        StateVector k5 = compute_derivatives(y5s);
-
-        // ── Stage 6 ──
-        StateVector y6s = y;
-        y6s.position.x = y.position.x + h * (a61*k1.velocity.x + a62*k2.velocity.x + a63*k3.velocity.x + a64*k4.velocity.x + a65*k5.velocity.x);
-        y6s.position.y = y.position.y + h * (a61*k1.velocity.y + a62*k2.velocity.y + a63*k3.velocity.y + a64*k4.velocity.y + a65*k5.velocity.y);
-        y6s.position.z = y.position.z + h * (a61*k1.velocity.z + a62*k2.velocity.z + a63*k3.velocity.z + a64*k4.velocity.z + a65*k5.velocity.z);
-        y6s.velocity.x = y.velocity.x + h * (a61*k1.angular_velocity.x + a62*k2.angular_velocity.x + a63*k3.angular_velocity.x + a64*k4.angular_velocity.x + a65*k5.angular_velocity.x);
-        y6s.velocity.y = y.velocity.y + h * (a61*k1.angular_velocity.y + a62*k2.angular_velocity.y + a63*k3.angular_velocity.y + a64*k4.angular_velocity.y + a65*k5.angular_velocity.y);
-        y6s.velocity.z = y.velocity.z + h * (a61*k1.angular_velocity.z + a62*k2.angular_velocity.z + a63*k3.angular_velocity.z + a64*k4.angular_velocity.z + a65*k5.angular_velocity.z);
-        y6s.time = y.time + h;
-        StateVector k6 = compute_derivatives(y6s);
-
-        // ── 5th order solution (y_5) ──
-        StateVector y5_result = y;
-        y5_result.position.x = y.position.x + h * (b1*k1.velocity.x + b3*k3.velocity.x + b4*k4.velocity.x + b5*k5.velocity.x + b6*k6.velocity.x);
-        y5_result.position.y = y.position.y + h * (b1*k1.velocity.y + b3*k3.velocity.y + b4*k4.velocity.y + b5*k5.velocity.y + b6*k6.velocity.y);
-        y5_result.position.z = y.position.z + h * (b1*k1.velocity.z + b3*k3.velocity.z + b4*k4.velocity.z + b5*k5.velocity.z + b6*k6.velocity.z);
-        y5_result.velocity.x = y.velocity.x + h * (b1*k1.angular_velocity.x + b3*k3.angular_velocity.x + b4*k4.angular_velocity.x + b5*k5.angular_velocity.x + b6*k6.angular_velocity.x);
-        y5_result.velocity.y = y.velocity.y + h * (b1*k1.angular_velocity.y + b3*k3.angular_velocity.y + b4*k4.angular_velocity.y + b5*k5.angular_velocity.y + b6*k6.angular_velocity.y);
-        y5_result.velocity.z = y.velocity.z + h * (b1*k1.angular_velocity.z + b3*k3.angular_velocity.z + b4*k4.angular_velocity.z + b5*k5.angular_velocity.z + b6*k6.angular_velocity.z);
-        y5_result.time = y.time + h;
-
-        // ── Stage 7 (FSAL: k7 = f(y5_result), reused as k1 of next step) ──
-        StateVector k7 = compute_derivatives(y5_result);
-
-        // ── 4th order solution (y_4) for error estimate ──
-        StateVector y4_result = y;
-        y4_result.position.x = y.position.x + h * (bs1*k1.velocity.x + bs3*k3.velocity.x + bs4*k4.velocity.x + bs5*k5.velocity.x + bs6*k6.velocity.x + bs7*k7.velocity.x);
-        y4_result.position.y = y.position.y + h * (bs1*k1.velocity.y + bs3*k3.velocity.y + bs4*k4.velocity.y + bs5*k5.velocity.y + bs6*k6.velocity.y + bs7*k7.velocity.y);
-        y4_result.position.z = y.position.z + h * (bs1*k1.velocity.z + bs3*k3.velocity.z + bs4*k4.velocity.z + bs5*k5.velocity.z + bs6*k6.velocity.z + bs7*k7.velocity.z);
-        y4_result.velocity.x = y.velocity.x + h * (bs1*k1.angular_velocity.x + bs3*k3.angular_velocity.x + bs4*k4.angular_velocity.x + bs5*k5.angular_velocity.x + bs6*k6.angular_velocity.x + bs7*k7.angular_velocity.x);
-        y4_result.velocity.y = y.velocity.y + h * (bs1*k1.angular_velocity.y + bs3*k3.angular_velocity.y + bs4*k4.angular_velocity.y + bs5*k5.angular_velocity.y + bs6*k6.angular_velocity.y + bs7*k7.angular_velocity.y);
-        y4_result.velocity.z = y.velocity.z + h * (bs1*k1.angular_velocity.z + bs3*k3.angular_velocity.z + bs4*k4.angular_velocity.z + bs5*k5.angular_velocity.z + bs6*k6.angular_velocity.z + bs7*k7.angular_velocity.z);
-
-        // ── Error estimate ──
-        double error = compute_error(y4_result, y5_result, config);
-
-        if (error <= 1.0) {
-            // Step accepted — compute next step size
-            double dt_next;
-            if (error < 1e-30) {
-                dt_next = h * 5.0;  // Error negligible, grow aggressively
-            } else {
-                // Optimal step factor for 5th order method: (1/error)^(1/5)
-                dt_next = h * config.safety_factor * std::pow(1.0 / error, 0.2);
-            }
-            dt_next = std::min(dt_next, config.dt_max);
-            dt_next = std::max(dt_next, config.dt_min);
-
-            // Don't grow more than 5x per step
-            dt_next = std::min(dt_next, h * 5.0);
-
-            return IntegrationStep{y5_result, h, dt_next, error};
-        }
-
-        // Step rejected — reduce step size and retry
-        double factor = config.safety_factor * std::pow(1.0 / error, 0.25);
-        factor = std::max(factor, 0.1);  // Don't shrink more than 10x
-        h *= factor;
-
-        if (h < config.dt_min) {
-            // Step size underflow — accept with minimum step
-            y5_result.time = y.time + config.dt_min;
-            return IntegrationStep{y5_result, config.dt_min, config.dt_min, error};
-        }
-    }
-
-    // Should not reach here
-    return IntegrationStep{state, dt_try, dt_try, 1e10};
+    return dense_step(state, dt_try, compute_derivatives, config, nullptr);
 }
 
 // ─────────────────────────────────────────────────────────────
@@ -206,35 +88,75 @@ std::vector<StateVector> AdaptiveIntegrator::propagate(
     DerivativeFunction compute_derivatives,
     const AdaptiveConfig& config,
     double sample_interval) {
+    return propagate(initial, duration, compute_derivatives, config, sample_interval, {});
+}
 
+std::vector<StateVector> AdaptiveIntegrator::propagate(
+    const StateVector& initial,
+    double duration,
+    DerivativeFunction compute_derivatives,
+    const AdaptiveConfig& config,
+    double sample_interval,
+    const std::vector<double>& breakpoints) {
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
     std::vector<StateVector> trajectory;
     StateVector current = initial;
     double t_end = initial.time + duration;
-    double dt = std::min(duration * 0.001, config.dt_max);  // Initial step guess
-    dt = std::max(dt, config.dt_min);
+    double dt = initial_step(duration, config);
 
-    double next_sample = initial.time;
+    int next_index = 1;
     if (sample_interval > 0.0) {
         trajectory.push_back(initial);
-        next_sample += sample_interval;
     }
 
+    size_t next_bp = 0;
+    bool on_breakpoint = false;
+
+    Dense6 dense;
     int step_count = 0;
     while (current.time < t_end && step_count < config.max_steps) {
-        // Don't overshoot end time
-        double dt_try = std::min(dt, t_end - current.time);
+        // Breakpoints already reached (or within rounding of the current time)
+        while (next_bp < breakpoints.size() && breakpoints[next_bp] - current.time < 1e-10) {
+            if (breakpoints[next_bp] > current.time - 1e-10) on_breakpoint = true;
+            next_bp++;
+        }
+        bool stop_on_bp = next_bp < breakpoints.size() && breakpoints[next_bp] < t_end;
+        double t_stop = stop_on_bp ? breakpoints[next_bp] : t_end;
+
+        // Don't overshoot end time or the next breakpoint
+        double dt_try = std::min(dt, t_stop - current.time);
         if (dt_try < 1e-10) break;
+        bool to_bp = stop_on_bp && dt_try == t_stop - current.time;
+
+        double t_lo = on_breakpoint ? current.time + BREAKPOINT_OFFSET : -INF;
+        double t_hi = to_bp ? t_stop - BREAKPOINT_OFFSET : INF;
+        if (t_lo > t_hi) t_lo = t_hi = 0.5 * (current.time + t_stop);
 
-        auto result = step(current, dt_try, compute_derivatives, config);
+        StateVector start = current;
+        auto result = dense_step(current, dt_try, compute_derivatives, config, &dense, t_lo, t_hi);
         current = result.state;
-        dt = result.dt_next;
         step_count++;
+        on_breakpoint = false;
+
+        if (to_bp && result.dt_used == dt_try) {
+            // Landed on the breakpoint; the clipped step says nothing about
+            // the step size beyond it
+            current.time = t_stop;
+            on_breakpoint = true;
+            next_bp++;
+            dt = std::max(dt, result.dt_next);
+        } else {
+            dt = result.dt_next;
+        }
 
-        // Sample at uniform intervals
+        // Uniform samples inside this step, from its interpolant
         if (sample_interval > 0.0) {
-            while (next_sample <= current.time && next_sample <= t_end) {
-                trajectory.push_back(current);  // Nearest-neighbor for now
-                next_sample += sample_interval;
+            for (;;) {
+                double t = initial.time + next_index * sample_interval;
+                if (t > current.time || t > t_end) break;
+                trajectory.push_back(t == current.time ? current : interpolate(dense, start, t));
+                next_index++;
             }
         }
     }
@@ -251,6 +173,51 @@ std::vector<StateVector> AdaptiveIntegrator::propagate(
     return trajectory;
 }
 
+std::vector<StateVector> AdaptiveIntegrator::propagate_to_times(
+    const StateVector& initial,
+    const std::vector<double>& times,
+    DerivativeFunction compute_derivatives,
+    const AdaptiveConfig& config) {
+
+    std::vector<StateVector> out;
+    out.reserve(times.size());
+    size_t next = 0;
+    while (next < times.size() && times[next] <= initial.time) {
+        out.push_back(initial);
+        next++;
+    }
+    if (next == times.size()) return out;
+
+    StateVector current = initial;
+    const double t_end = times.back();
+    double dt = initial_step(t_end - initial.time, config);
+
+    Dense6 dense;
+    int step_count = 0;
+    while (next < times.size() && step_count < config.max_steps) {
+        double dt_try = std::min(dt, t_end - current.time);
+        if (dt_try < 1e-10) break;
+
+        StateVector start = current;
+        auto result = dense_step(current, dt_try, compute_derivatives, config, &dense);
+        current = result.state;
+        dt = result.dt_next;
+        step_count++;
+
+        while (next < times.size() && times[next] <= current.time) {
+            const double t = times[next++];
+            out.push_back(t == current.time ? current : interpolate(dense, start, t));
+        }
+    }
+    // Remaining times within rounding of the last step end
+    while (next < times.size() && times[next] - current.time < 1e-10) {
+        out.push_back(current);
+        next++;
+    }
+
+    return out;
+}
+
 StateVector AdaptiveIntegrator::propagate_until(
     const StateVector& initial,
     DerivativeFunction compute_derivatives,
@@ -260,22 +227,100 @@ StateVector AdaptiveIntegrator::propagate_until(
 
     StateVector current = initial;
     double t_end = initial.time + max_duration;
-    double dt = std::min(max_duration * 0.001, config.dt_max);
-    dt = std::max(dt, config.dt_min);
+    double dt = initial_step(max_duration, config);
 
+    Dense6 dense;
     int step_count = 0;
     while (current.time < t_end && step_count < config.max_steps) {
         double dt_try = std::min(dt, t_end - current.time);
         if (dt_try < 1e-10) break;
 
-        auto result = step(current, dt_try, compute_derivatives, config);
+        StateVector start = current;
+        auto result = dense_step(current, dt_try, compute_derivatives, config, &dense);
         current = result.state;
         dt = result.dt_next;
         step_count++;
 
         if (stop_condition(current)) {
-            return current;
+            // First true time inside the step
+            double lo = start.time, hi = current.time;
+            StateVector found = current;
+            for (int i = 0; i < 60 && hi - lo > 1e-6; i++) {
+                double mid = 0.5 * (lo + hi);
+                StateVector s = interpolate(dense, start, mid);
+                if (stop_condition(s)) {
+                    hi = mid;
+                    found = s;
+                } else {
+                    lo = mid;
+                }
+            }
+            return found;
+        }
+    }
+
+    return current;
+}
+
+StateVector AdaptiveIntegrator::propagate_to_event(
+    const StateVector& initial,
+    DerivativeFunction compute_derivatives,
+    std::function<double(const StateVector&)> event,
+    const AdaptiveConfig& config,
+    double max_duration,
+    int direction,
+    bool* found) {
+
+    if (found) *found = false;
+    StateVector current = initial;
+    double t_end = initial.time + max_duration;
+    double dt = initial_step(max_duration, config);
+    double g_prev = event(initial);
+
+    Dense6 dense;
+    int step_count = 0;
+    while (current.time < t_end && step_count < config.max_steps) {
+        double dt_try = std::min(dt, t_end - current.time);
+        if (dt_try < 1e-10) break;
+
+        StateVector start = current;
+        auto result = dense_step(current, dt_try, compute_derivatives, config, &dense);
+        current = result.state;
+        dt = result.dt_next;
+        step_count++;
+
+        const double g = event(current);
+        const bool rising = g_prev < 0.0 && g >= 0.0;
+        const bool falling = g_prev > 0.0 && g <= 0.0;
+        if ((rising && direction >= 0) || (falling && direction <= 0)) {
+            // Illinois regula falsi on the interpolant
+            double ta = start.time, ga = g_prev;
+            double tb = current.time, gb = g;
+            StateVector root = current;
+            int side = 0;
+            for (int i = 0; i < 60 && tb - ta > 1e-6; i++) {
+                double t = (ta * gb - tb * ga) / (gb - ga);
+                if (!(t > ta && t < tb)) t = 0.5 * (ta + tb);
+                StateVector s = interpolate(dense, start, t);
+                double gt = event(s);
+                root = s;
+                if (gt == 0.0) break;
+                if ((gt > 0.0) == (gb > 0.0)) {
+                    tb = t;
+                    gb = gt;
+                    if (side == -1) ga *= 0.5;
+                    side = -1;
+                } else {
+                    ta = t;
+                    ga = gt;
+                    if (side == 1) gb *= 0.5;
+                    side = 1;
+                }
+            }
+            if (found) *found = true;
+            return root;
         }
+        g_prev = g;
     }
 
     return current;
@@ -47,7 +47,12 @@ struct AdaptiveConfig {
     }
 };
 
-/// Dormand-Prince 4(5) adaptive integrator
+/**
+ * Dormand-Prince 4(5) adaptive integrator.
+ *
+ * std::function wrapper over dopri5_step() (integrator_kernels.hpp);
+ * hot loops should call the kernel with their own RHS functor instead.
+ */
 class AdaptiveIntegrator {
 public:
     using DerivativeFunction = std::function<StateVector(const StateVector&)>;
@@ -64,7 +69,8 @@ public:
 
     /**
      * Propagate from initial state for given duration.
-     * If sample_interval > 0, returns states at uniform intervals (interpolated).
+     * If sample_interval > 0, returns states at uniform intervals, taken
+     * from each step's dense output (the step size is not capped).
      * If sample_interval == 0, returns only the final state.
      */
     static std::vector<StateVector> propagate(
@@ -74,9 +80,43 @@ public:
         const AdaptiveConfig& config,
         double sample_interval = 0.0);
 
+    /**
+     * propagate() that ends a step exactly on every breakpoint: ascending
+     * times where the derivative is discontinuous, such as
+     * EclipseTimeline::boundaries(). No step straddles a switch, so
+     * the switch causes no rejected steps.
+     *
+     * Stage times that fall on a breakpoint are evaluated
+     * BREAKPOINT_OFFSET inside the step. A force looked up by time then
+     * sees the step's own side of the switch. The offset is needed because
+     * the lookups go through a Julian date, which resolves only about 40 us.
+     */
+    static std::vector<StateVector> propagate(
+        const StateVector& initial,
+        double duration,
+        DerivativeFunction compute_derivatives,
+        const AdaptiveConfig& config,
+        double sample_interval,
+        const std::vector<double>& breakpoints);
+
+    static constexpr double BREAKPOINT_OFFSET = 1e-3;   // [s]
+
+    /**
+     * States at arbitrary output times (ascending, >= initial.time),
+     * interpolated from each step's dense output. Times past the
+     * integration limit (max_steps) are omitted.
+     */
+    static std::vector<StateVector> propagate_to_times(
+        const StateVector& initial,
+        const std::vector<double>& times,
+        DerivativeFunction compute_derivatives,
+        const AdaptiveConfig& config);
+
     /**
      * Propagate until a stop condition is met.
-     * Returns the state at which stop_condition returned true.
+     * Returns the state at which stop_condition first becomes true, located
+     * by bisection on the step's dense output (no extra derivative calls);
+     * or the state at max_duration.
      */
     static StateVector propagate_until(
         const StateVector& initial,
@@ -85,74 +125,26 @@ public:
         const AdaptiveConfig& config,
         double max_duration = 365.25 * 86400.0);
 
-private:
-    // ── Dormand-Prince coefficients (Butcher tableau) ──
-    // 7-stage embedded pair, FSAL property
-
-    // Time fractions
-    static constexpr double c2 = 1.0/5.0;
-    static constexpr double c3 = 3.0/10.0;
-    static constexpr double c4 = 4.0/5.0;
-    static constexpr double c5 = 8.0/9.0;
-    // c6 = 1, c7 = 1
-
-    // Stage coefficients (a_ij)
-    static constexpr double a21 = 1.0/5.0;
-    static constexpr double a31 = 3.0/40.0;
-    static constexpr double a32 = 9.0/40.0;
-    static constexpr double a41 = 44.0/45.0;
-    static constexpr double a42 = -56.0/15.0;
-    static constexpr double a43 = 32.0/9.0;
-    static constexpr double a51 = 19372.0/6561.0;
-    static constexpr double a52 = -25360.0/2187.0;
-    static constexpr double a53 = 64448.0/6561.0;
-    static constexpr double a54 = -212.0/729.0;
-    static constexpr double a61 = 9017.0/3168.0;
-    static constexpr double a62 = -355.0/33.0;
-    static constexpr double a63 = 46732.0/5247.0;
-    static constexpr double a64 = 49.0/176.0;
-    static constexpr double a65 = -5103.0/18656.0;
-    static constexpr double a71 = 35.0/384.0;
-    // a72 = 0
-    static constexpr double a73 = 500.0/1113.0;
-    static constexpr double a74 = 125.0/192.0;
-    static constexpr double a75 = -2187.0/6784.0;
-    static constexpr double a76 = 11.0/84.0;
-
-    // 5th order weights (b_i) — same as a7i (FSAL)
-    static constexpr double b1 = 35.0/384.0;
-    // b2 = 0
-    static constexpr double b3 = 500.0/1113.0;
-    static constexpr double b4 = 125.0/192.0;
-    static constexpr double b5 = -2187.0/6784.0;
-    static constexpr double b6 = 11.0/84.0;
-    // b7 = 0
-
-    // 4th order weights for error estimate (b*_i)
-    static constexpr double bs1 = 5179.0/57600.0;
-    // bs2 = 0
-    static constexpr double bs3 = 7571.0/16695.0;
-    static constexpr double bs4 = 393.0/640.0;
-    static constexpr double bs5 = -92097.0/339200.0;
-    static constexpr double bs6 = 187.0/2100.0;
-    static constexpr double bs7 = 1.0/40.0;
-
-    // Error coefficients: e_i = b_i - b*_i
-    static constexpr double e1 = b1 - bs1;   // 71/57600
-    static constexpr double e3 = b3 - bs3;   // -71/16695
-    static constexpr double e4 = b4 - bs4;   // 71/1920
-    static constexpr double e5 = b5 - bs5;   // -17253/339200
-    static constexpr double e6 = b6 - bs6;   // 22/525
-    static constexpr double e7 = -bs7;        // -1/40
-
-    // Helper: add scaled state vectors
-    static StateVector add_states(const StateVector& base,
-                                   const StateVector& deriv,
-                                   double scale);
-
-    // Helper: estimate error from two solutions
-    static double compute_error(const StateVector& y4, const StateVector& y5,
-                                 const AdaptiveConfig& config);
+    /**
+     * Propagate to the first zero crossing of event(state), e.g.
+     *   altitude:   |r| - R - h
+     *   periapsis:  r . v           (direction +1)
+     *   SOI exit:   |r - r_body| - r_soi
+     * located on the dense output by Illinois regula falsi.
+     *
+     * @param direction +1 rising only, -1 falling only, 0 either
+     * @param found Set to whether a crossing was found (optional)
+     * @return State at the crossing, or at max_duration
+     */
+    static StateVector propagate_to_event(
+        const StateVector& initial,
+        DerivativeFunction compute_derivatives,
+        std::function<double(const StateVector&)> event,
+        const AdaptiveConfig& config,
+        double max_duration = 365.25 * 86400.0,
+        int direction = 0,
+        bool* found = nullptr);
+
 };
 
 }  // namespace sim
@@ -0,0 +1,256 @@
+/**
+ * Catalog Propagator Implementation
+ *
+ * Blocks of BLOCK objects are loaded into stack arrays and stepped
+ * together: every RK4 stage is a loop over the block's lanes with no
+ * branches (the inside-the-body cut-offs are masks), which the compiler
+ * vectorizes.
+ */
+
+#include "propagators/catalog_propagator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t BLOCK = 64;
+
+/// Zonal-harmonic coefficients folded with mu and powers of R
+struct ZonalTerms {
+    double mu;
+    double radius;
+    double j2c;   // 1.5 J2 mu R^2
+    double j3c;   // -2.5 J3 mu R^3
+    double j4c;   // 15/8 J4 mu R^4
+
+    explicit ZonalTerms(const CatalogConfig& c) {
+        const double R = c.body.radius;
+        mu = c.body.mu;
+        radius = R;
+        j2c = c.use_j2 ? 1.5 * c.body.j2 * mu * R * R : 0.0;
+        j3c = c.use_j3 ? -2.5 * c.body.j3 * mu * R * R * R : 0.0;
+        j4c = c.use_j4 ? (15.0 / 8.0) * c.body.j4 * mu * R * R * R * R : 0.0;
+    }
+};
+
+/// a(p) for n lanes
+inline void accel_block(const ZonalTerms& g, size_t n,
+                        const double* x, const double* y, const double* z,
+                        double* ax, double* ay, double* az) {
+#pragma GCC ivdep
+    for (size_t k = 0; k < n; k++) {
+        const double r2_raw = x[k] * x[k] + y[k] * y[k] + z[k] * z[k];
+        const double r2 = std::max(r2_raw, 1.0);
+        const double r = std::sqrt(r2);
+        const double point = r2_raw >= 1.0 ? 1.0 : 0.0;       // two_body: r >= 1
+        const double outside = r >= g.radius ? 1.0 : 0.0;     // zonals: r >= R
+
+        const double inv_r2 = 1.0 / r2;
+        const double r3 = r2 * r;
+        const double r5 = r3 * r2;
+        const double r7 = r5 * r2;
+        const double zk = z[k];
+        const double z2 = zk * zk;
+        const double z2r2 = z2 * inv_r2;
+
+        // Two-body
+        const double c0 = -g.mu / r3 * point;
+
+        // J2: (5z^2/r^2 - 1) on x, y; (5z^2/r^2 - 3) on z
+        const double c2 = g.j2c / r5 * outside;
+        const double zf = 5.0 * z2r2;
+
+        // J3: (3z - 7z^3/r^2) on x, y
+        const double c3 = g.j3c / r7 * outside;
+        const double t3 = 3.0 * zk - 7.0 * zk * z2r2;
+
+        // J4
+        const double c4 = g.j4c / r7 * outside;
+        const double z4r4 = z2r2 * z2r2;
+        const double f4 = 1.0 - 14.0 * z2r2 + 21.0 * z4r4;
+
+        const double horiz = c0 + c2 * (zf - 1.0) + c3 * t3 + c4 * f4;
+        ax[k] = horiz * x[k];
+        ay[k] = horiz * y[k];
+        az[k] = c0 * zk + c2 * zk * (zf - 3.0)
+              + c3 * (6.0 * z2 - 7.0 * z2 * z2r2 - 0.6 * r2)
+              + c4 * zk * (5.0 - (70.0 / 3.0) * z2r2 + 21.0 * z4r4);
+    }
+}
+
+}  // namespace
+
+CatalogPropagator::CatalogPropagator(const CatalogConfig& config)
+    : config_(config) {}
+
+void CatalogPropagator::reserve(size_t n) {
+    for (auto* v : {&x_, &y_, &z_, &vx_, &vy_, &vz_}) v->reserve(n);
+}
+
+size_t CatalogPropagator::add(const Vec3& position, const Vec3& velocity) {
+    x_.push_back(position.x);
+    y_.push_back(position.y);
+    z_.push_back(position.z);
+    vx_.push_back(velocity.x);
+    vy_.push_back(velocity.y);
+    vz_.push_back(velocity.z);
+    return x_.size() - 1;
+}
+
+StateVector CatalogPropagator::state(size_t i) const {
+    StateVector s;
+    s.position = Vec3(x_[i], y_[i], z_[i]);
+    s.velocity = Vec3(vx_[i], vy_[i], vz_[i]);
+    s.time = time_;
+    s.frame = CoordinateFrame::J2000_ECI;
+    return s;
+}
+
+void CatalogPropagator::positions_xyz(std::vector<double>& out) const {
+    const size_t n = size();
+    out.resize(3 * n);
+    for (size_t i = 0; i < n; i++) {
+        out[3 * i]     = x_[i];
+        out[3 * i + 1] = y_[i];
+        out[3 * i + 2] = z_[i];
+    }
+}
+
+void CatalogPropagator::propagate(double duration) {
+    if (duration <= 0.0) return;
+    const double max_step = config_.max_step > 0.0 ? config_.max_step : duration;
+    const int steps = std::max(1, static_cast<int>(std::ceil(duration / max_step - 1e-9)));
+    const double h = duration / steps;
+    const size_t n = size();
+
+    // Shard whole blocks across threads
+    size_t threads = config_.num_threads > 0
+        ? static_cast<size_t>(config_.num_threads)
+        : std::max(1u, std::thread::hardware_concurrency());
+    const size_t blocks = (n + BLOCK - 1) / BLOCK;
+    threads = std::max<size_t>(1, std::min(threads, blocks));
+
+    double* const s[6] = {x_.data(), y_.data(), z_.data(), vx_.data(), vy_.data(), vz_.data()};
+    if (threads == 1) {
+        propagate_range(config_, s, 0, n, steps, h);
+    } else {
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; t++) {
+            size_t begin = std::min(n, (blocks * t / threads) * BLOCK);
+            size_t end = std::min(n, (blocks * (t + 1) / threads) * BLOCK);
+            pool.emplace_back(&CatalogPropagator::propagate_range, std::cref(config_), s,
+                              begin, end, steps, h);
+        }
+        for (auto& th : pool) th.join();
+    }
+    time_ += duration;
+}
+
+void CatalogPropagator::propagate_arrays(const CatalogConfig& config, size_t n,
+                                         double* x, double* y, double* z,
+                                         double* vx, double* vy, double* vz,
+                                         double duration) {
+    if (duration <= 0.0 || n == 0) return;
+    const double max_step = config.max_step > 0.0 ? config.max_step : duration;
+    const int steps = std::max(1, static_cast<int>(std::ceil(duration / max_step - 1e-9)));
+    double* const s[6] = {x, y, z, vx, vy, vz};
+    propagate_range(config, s, 0, n, steps, duration / steps);
+}
+
+void CatalogPropagator::propagate_range(const CatalogConfig& config, double* const* s,
+                                        size_t begin, size_t end, int steps, double h) {
+    double* x = s[0];
+    double* y = s[1];
+    double* z = s[2];
+    double* vx = s[3];
+    double* vy = s[4];
+    double* vz = s[5];
+    const ZonalTerms g(config);
+    const double half = h / 2.0;
+    const double sixth = h / 6.0;
+
+    // Block state and stage scratch
+    double px[BLOCK], py[BLOCK], pz[BLOCK], qx[BLOCK], qy[BLOCK], qz[BLOCK];
+    double sx[BLOCK], sy[BLOCK], sz[BLOCK], svx[BLOCK], svy[BLOCK], svz[BLOCK];
+    double ax[BLOCK], ay[BLOCK], az[BLOCK];
+    double dpx[BLOCK], dpy[BLOCK], dpz[BLOCK], dvx[BLOCK], dvy[BLOCK], dvz[BLOCK];
+
+    for (size_t b = begin; b < end; b += BLOCK) {
+        const size_t n = std::min(BLOCK, end - b);
+        std::copy_n(&x[b], n, px);
+        std::copy_n(&y[b], n, py);
+        std::copy_n(&z[b], n, pz);
+        std::copy_n(&vx[b], n, qx);
+        std::copy_n(&vy[b], n, qy);
+        std::copy_n(&vz[b], n, qz);
+
+        for (int s = 0; s < steps; s++) {
+            // k1: v0, a(p0); stage 2 state p0 + v0 h/2, v0 + a h/2
+            accel_block(g, n, px, py, pz, ax, ay, az);
+#pragma GCC ivdep
+            for (size_t k = 0; k < n; k++) {
+                dpx[k] = qx[k]; dpy[k] = qy[k]; dpz[k] = qz[k];
+                dvx[k] = ax[k]; dvy[k] = ay[k]; dvz[k] = az[k];
+                sx[k] = px[k] + qx[k] * half;
+                sy[k] = py[k] + qy[k] * half;
+                sz[k] = pz[k] + qz[k] * half;
+                svx[k] = qx[k] + ax[k] * half;
+                svy[k] = qy[k] + ay[k] * half;
+                svz[k] = qz[k] + az[k] * half;
+            }
+
+            // k2, then stage 3 state
+            accel_block(g, n, sx, sy, sz, ax, ay, az);
+#pragma GCC ivdep
+            for (size_t k = 0; k < n; k++) {
+                dpx[k] += 2.0 * svx[k]; dpy[k] += 2.0 * svy[k]; dpz[k] += 2.0 * svz[k];
+                dvx[k] += 2.0 * ax[k]; dvy[k] += 2.0 * ay[k]; dvz[k] += 2.0 * az[k];
+                sx[k] = px[k] + svx[k] * half;
+                sy[k] = py[k] + svy[k] * half;
+                sz[k] = pz[k] + svz[k] * half;
+                svx[k] = qx[k] + ax[k] * half;
+                svy[k] = qy[k] + ay[k] * half;
+                svz[k] = qz[k] + az[k] * half;
+            }
+
+            // k3, then stage 4 state
+            accel_block(g, n, sx, sy, sz, ax, ay, az);
+#pragma GCC ivdep
+            for (size_t k = 0; k < n; k++) {
+                dpx[k] += 2.0 * svx[k]; dpy[k] += 2.0 * svy[k]; dpz[k] += 2.0 * svz[k];
+                dvx[k] += 2.0 * ax[k]; dvy[k] += 2.0 * ay[k]; dvz[k] += 2.0 * az[k];
+                sx[k] = px[k] + svx[k] * h;
+                sy[k] = py[k] + svy[k] * h;
+                sz[k] = pz[k] + svz[k] * h;
+                svx[k] = qx[k] + ax[k] * h;
+                svy[k] = qy[k] + ay[k] * h;
+                svz[k] = qz[k] + az[k] * h;
+            }
+
+            // k4 and combine
+            accel_block(g, n, sx, sy, sz, ax, ay, az);
+#pragma GCC ivdep
+            for (size_t k = 0; k < n; k++) {
+                px[k] += sixth * (dpx[k] + svx[k]);
+                py[k] += sixth * (dpy[k] + svy[k]);
+                pz[k] += sixth * (dpz[k] + svz[k]);
+                qx[k] += sixth * (dvx[k] + ax[k]);
+                qy[k] += sixth * (dvy[k] + ay[k]);
+                qz[k] += sixth * (dvz[k] + az[k]);
+            }
+        }
+
+        std::copy_n(px, n, &x[b]);
+        std::copy_n(py, n, &y[b]);
+        std::copy_n(pz, n, &z[b]);
+        std::copy_n(qx, n, &vx[b]);
+        std::copy_n(qy, n, &vy[b]);
+        std::copy_n(qz, n, &vz[b]);
+    }
+}
+
+}  // namespace sim
@@ -0,0 +1,342 @@
+/**
+ * Collision Probability Implementation
+ */
+
+#include "propagators/collision_probability.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t L = CollisionProbability::LANES;
+constexpr int NY = 42;                  // State (6) + STM (36, row-major)
+using Lanes = double[NY][L];            // [component][object]
+
+constexpr double PI = 3.14159265358979323846;
+
+// 8-point Gauss-Legendre on [-1, 1]
+constexpr double GL_X[8] = {-0.9602898564975363, -0.7966664774136267, -0.5255324099163290,
+                            -0.1834346424956498,  0.1834346424956498,  0.5255324099163290,
+                             0.7966664774136267,  0.9602898564975363};
+constexpr double GL_W[8] = {0.1012285362903763, 0.2223810344533745, 0.3137066458778873,
+                            0.3626837833783620, 0.3626837833783620, 0.3137066458778873,
+                            0.2223810344533745, 0.1012285362903763};
+
+/**
+ * Variational equations for n lanes: d/dt (r, v) = (v, a(r)) and
+ * dPhi/dt = [[0, I], [G, 0]] Phi, with G = da/dr (two-body, plus J2 when
+ * cj = 1.5 J2 mu R^2 is non-zero). G is symmetric; six entries per lane.
+ */
+void derivatives(size_t n, double mu, double cj, const Lanes& y, Lanes& f) {
+    alignas(64) double G[6][L];        // xx, xy, xz, yy, yz, zz
+#pragma GCC ivdep
+    for (size_t l = 0; l < n; l++) {
+        const double x = y[0][l], yy = y[1][l], z = y[2][l];
+        const double r2 = x * x + yy * yy + z * z;
+        const double ir2 = 1.0 / r2;
+        const double ir3 = ir2 / std::sqrt(r2);
+        const double ir5 = ir3 * ir2;
+        const double ir7 = ir5 * ir2;
+        const double z2 = z * z;
+
+        // a_i = -mu p_i / r^3 + cj p_i g_i, g = 5 z^2 / r^7 - m / r^5 (m = 1 for x, y; 3 for z)
+        const double g_xy = 5.0 * z2 * ir7 - ir5;
+        const double g_z = g_xy - 2.0 * ir5;
+        f[0][l] = y[3][l];
+        f[1][l] = y[4][l];
+        f[2][l] = y[5][l];
+        f[3][l] = (-mu * ir3 + cj * g_xy) * x;
+        f[4][l] = (-mu * ir3 + cj * g_xy) * yy;
+        f[5][l] = (-mu * ir3 + cj * g_z) * z;
+
+        // d g_i / d p_j = k_i p_j (+ 10 z / r^7 for j = z), k = 5 m / r^7 - 35 z^2 / r^9
+        const double k_xy = 5.0 * ir7 - 35.0 * z2 * ir7 * ir2;
+        const double k_z = k_xy + 10.0 * ir7;
+        const double m3 = 3.0 * mu * ir5;
+        G[0][l] = m3 * x * x - mu * ir3 + cj * (g_xy + x * x * k_xy);
+        G[1][l] = (m3 + cj * k_xy) * x * yy;
+        G[2][l] = (m3 + cj * k_z) * x * z;
+        G[3][l] = m3 * yy * yy - mu * ir3 + cj * (g_xy + yy * yy * k_xy);
+        G[4][l] = (m3 + cj * k_z) * yy * z;
+        G[5][l] = m3 * z2 - mu * ir3 + cj * (g_z + z2 * (k_z + 10.0 * ir7));
+    }
+
+    for (int j = 0; j < 6; j++) {
+#pragma GCC ivdep
+        for (size_t l = 0; l < n; l++) {
+            const double p0 = y[6 + j][l], p1 = y[12 + j][l], p2 = y[18 + j][l];
+            f[6 + j][l] = y[24 + j][l];
+            f[12 + j][l] = y[30 + j][l];
+            f[18 + j][l] = y[36 + j][l];
+            f[24 + j][l] = G[0][l] * p0 + G[1][l] * p1 + G[2][l] * p2;
+            f[30 + j][l] = G[1][l] * p0 + G[3][l] * p1 + G[4][l] * p2;
+            f[36 + j][l] = G[2][l] * p0 + G[4][l] * p1 + G[5][l] * p2;
+        }
+    }
+}
+
+// out = y + h * k, lane by lane
+void axpy(size_t n, const Lanes& y, const double* h, const Lanes& k, Lanes& out) {
+    for (int c = 0; c < NY; c++) {
+#pragma GCC ivdep
+        for (size_t l = 0; l < n; l++) out[c][l] = y[c][l] + h[l] * k[c][l];
+    }
+}
+
+double sq(double x) { return x * x; }
+
+}  // namespace
+
+CollisionProbability::CollisionProbability(const PcConfig& config)
+    : config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+void CollisionProbability::propagate(size_t n, Vec3* pos, Vec3* vel, Covariance6* cov,
+                                     const double* dt) const {
+    n = std::min(n, L);
+    Matrix6 phi[L];
+    propagate_stm(n, pos, vel, phi, dt);
+
+    // P = Phi P0 Phi^T
+    for (size_t l = 0; l < n; l++) {
+        if (dt[l] == 0.0) continue;
+        double phi_p[36];
+        const Covariance6& p0 = cov[l];
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < 6; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < 6; k++) sum += phi[l][i * 6 + k] * p0[k * 6 + j];
+                phi_p[i * 6 + j] = sum;
+            }
+        }
+        Covariance6 p1;
+        for (int i = 0; i < 6; i++) {
+            for (int j = 0; j < 6; j++) {
+                double sum = 0.0;
+                for (int k = 0; k < 6; k++) sum += phi_p[i * 6 + k] * phi[l][j * 6 + k];
+                p1[i * 6 + j] = sum;
+            }
+        }
+        // Symmetrize away round-off
+        for (int i = 0; i < 6; i++) {
+            for (int j = i + 1; j < 6; j++) {
+                p1[i * 6 + j] = p1[j * 6 + i] = 0.5 * (p1[i * 6 + j] + p1[j * 6 + i]);
+            }
+        }
+        cov[l] = p1;
+    }
+}
+
+void CollisionProbability::propagate_stm(size_t n, Vec3* pos, Vec3* vel, Matrix6* phi,
+                                         const double* dt) const {
+    n = std::min(n, L);
+    double max_dt = 0.0;
+    for (size_t l = 0; l < n; l++) {
+        max_dt = std::max(max_dt, std::abs(dt[l]));
+        for (int i = 0; i < 36; i++) phi[l][i] = (i % 7 == 0) ? 1.0 : 0.0;
+    }
+    if (max_dt == 0.0) return;
+
+    // One step count for the block; each lane steps dt / steps
+    const long steps = std::max(1L, static_cast<long>(std::ceil(max_dt / config_.max_step)));
+    double h[L], half[L];
+    for (size_t l = 0; l < n; l++) {
+        h[l] = dt[l] / static_cast<double>(steps);
+        half[l] = 0.5 * h[l];
+    }
+    const double cj = config_.include_j2
+        ? 1.5 * config_.j2 * config_.mu * config_.radius * config_.radius : 0.0;
+
+    alignas(64) Lanes y, tmp, k1, k2, k3, k4;
+    for (size_t l = 0; l < n; l++) {
+        y[0][l] = pos[l].x; y[1][l] = pos[l].y; y[2][l] = pos[l].z;
+        y[3][l] = vel[l].x; y[4][l] = vel[l].y; y[5][l] = vel[l].z;
+        for (int i = 0; i < 36; i++) y[6 + i][l] = phi[l][i];
+    }
+
+    for (long s = 0; s < steps; s++) {
+        derivatives(n, config_.mu, cj, y, k1);
+        axpy(n, y, half, k1, tmp);
+        derivatives(n, config_.mu, cj, tmp, k2);
+        axpy(n, y, half, k2, tmp);
+        derivatives(n, config_.mu, cj, tmp, k3);
+        axpy(n, y, h, k3, tmp);
+        derivatives(n, config_.mu, cj, tmp, k4);
+        for (int c = 0; c < NY; c++) {
+#pragma GCC ivdep
+            for (size_t l = 0; l < n; l++) {
+                y[c][l] += h[l] / 6.0 * (k1[c][l] + 2.0 * (k2[c][l] + k3[c][l]) + k4[c][l]);
+            }
+        }
+    }
+
+    for (size_t l = 0; l < n; l++) {
+        pos[l] = Vec3(y[0][l], y[1][l], y[2][l]);
+        vel[l] = Vec3(y[3][l], y[4][l], y[5][l]);
+        for (int i = 0; i < 36; i++) phi[l][i] = y[6 + i][l];
+    }
+}
+
+double CollisionProbability::pc_2d(double xm, double zm, double sx, double sz, double R,
+                                   PcMethod method) {
+    if (R <= 0.0 || !(sx > 0.0) || !(sz > 0.0)) return 0.0;
+
+    if (method == PcMethod::ALFANO) {
+        // x = R sin(phi): the disk's chord at x is |z| <= R cos(phi)
+        const int panels = static_cast<int>(std::clamp(std::ceil(2.0 * R / sx), 2.0, 256.0));
+        const double width = PI / panels;
+        const double iz = 1.0 / (std::sqrt(2.0) * sz);
+        double sum = 0.0;
+        for (int p = 0; p < panels; p++) {
+            const double mid = -0.5 * PI + (p + 0.5) * width;
+            for (int k = 0; k < 8; k++) {
+                const double phi = mid + 0.5 * width * GL_X[k];
+                const double c = std::cos(phi);
+                const double x = R * std::sin(phi);
+                const double chord = R * c;
+                sum += GL_W[k] * (std::erf((zm + chord) * iz) - std::erf((zm - chord) * iz))
+                     * std::exp(-0.5 * sq((x - xm) / sx)) * chord;
+            }
+        }
+        return std::clamp(sum * 0.5 * width / (std::sqrt(8.0 * PI) * sx), 0.0, 1.0);
+    }
+
+    // FOSTER: Gauss-Legendre panels in radius, trapezoid (periodic) in angle
+    const double smin = std::min(sx, sz);
+    const int panels = static_cast<int>(std::clamp(std::ceil(2.0 * R / smin), 1.0, 64.0));
+    const int angles = static_cast<int>(std::clamp(std::ceil(16.0 * R / smin), 32.0, 2048.0));
+    thread_local std::vector<double> cs, sn;
+    cs.resize(static_cast<size_t>(angles));
+    sn.resize(static_cast<size_t>(angles));
+    for (int m = 0; m < angles; m++) {
+        cs[m] = std::cos(2.0 * PI * m / angles);
+        sn[m] = std::sin(2.0 * PI * m / angles);
+    }
+    const double ix2 = 1.0 / (sx * sx), iz2 = 1.0 / (sz * sz);
+    const double width = R / panels;
+    double sum = 0.0;
+    for (int p = 0; p < panels; p++) {
+        for (int k = 0; k < 8; k++) {
+            const double r = (p + 0.5 * (1.0 + GL_X[k])) * width;
+            double ring = 0.0;
+            for (int m = 0; m < angles; m++) {
+                ring += std::exp(-0.5 * (sq(r * cs[m] - xm) * ix2 + sq(r * sn[m] - zm) * iz2));
+            }
+            sum += GL_W[k] * 0.5 * width * r * ring * (2.0 * PI / angles);
+        }
+    }
+    return std::clamp(sum / (2.0 * PI * sx * sz), 0.0, 1.0);
+}
+
+PcResult CollisionProbability::encounter_pc(const Vec3& rel_pos, const Vec3& rel_vel,
+                                            const std::array<double, 9>& cov,
+                                            double hard_body_radius, PcMethod method) {
+    PcResult out;
+    out.miss_distance = rel_pos.norm();
+    out.relative_speed = rel_vel.norm();
+    if (!(out.relative_speed > 0.0)) return out;
+
+    // Encounter frame: y along the relative velocity, x along the miss
+    // vector's component normal to it, z = y x x
+    const Vec3 ey = rel_vel / out.relative_speed;
+    Vec3 ex = rel_pos - dot(rel_pos, ey) * ey;
+    double n = ex.norm();
+    if (n < 1e-9 * std::max(out.miss_distance, 1.0)) {
+        // Head-on through the origin: any normal will do
+        ex = std::abs(ey.x) < 0.9 ? cross(ey, Vec3(1, 0, 0)) : cross(ey, Vec3(0, 1, 0));
+        n = ex.norm();
+    }
+    ex = ex / n;
+    const Vec3 ez = cross(ey, ex);
+
+    auto quad = [&cov](const Vec3& a, const Vec3& b) {
+        const double av[3] = {a.x, a.y, a.z}, bv[3] = {b.x, b.y, b.z};
+        double s = 0.0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) s += av[i] * cov[i * 3 + j] * bv[j];
+        }
+        return s;
+    };
+    const double cxx = quad(ex, ex), cxz = quad(ex, ez), czz = quad(ez, ez);
+    const double xm = dot(rel_pos, ex), zm = dot(rel_pos, ez);
+
+    // Principal axes of the projected covariance
+    const double mean = 0.5 * (cxx + czz);
+    const double rad = std::sqrt(0.25 * sq(cxx - czz) + cxz * cxz);
+    const double l1 = mean + rad, l2 = mean - rad;
+    if (!(l2 > 0.0) || !std::isfinite(l1)) return out;
+    const double theta = 0.5 * std::atan2(2.0 * cxz, cxx - czz);
+    const double c = std::cos(theta), s = std::sin(theta);
+    const double xp = xm * c + zm * s;
+    const double zp = -xm * s + zm * c;
+
+    out.sigma_major = std::sqrt(l1);
+    out.sigma_minor = std::sqrt(l2);
+    out.mahalanobis = std::sqrt(xp * xp / l1 + zp * zp / l2);
+    out.pc = pc_2d(xp, zp, out.sigma_major, out.sigma_minor, hard_body_radius, method);
+    out.valid = true;
+    return out;
+}
+
+std::vector<PcResult> CollisionProbability::compute(const std::vector<PcEvent>& events) {
+    const size_t n = events.size();
+    std::vector<PcResult> results(n);
+
+    // Blocks of events with similar |dt| share a step count
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&events](size_t a, size_t b) {
+        return std::abs(events[a].dt) < std::abs(events[b].dt);
+    });
+
+    constexpr size_t PER_BLOCK = L / 2;
+    const size_t blocks = (n + PER_BLOCK - 1) / PER_BLOCK;
+    auto run_block = [&](size_t b) {
+        const size_t first = b * PER_BLOCK;
+        const size_t count = std::min(PER_BLOCK, n - first);
+        Vec3 pos[L], vel[L];
+        Covariance6 cov[L];
+        double dt[L] = {};
+        for (size_t k = 0; k < count; k++) {
+            const PcEvent& e = events[order[first + k]];
+            for (size_t side = 0; side < 2; side++) {
+                const PcObject& o = side == 0 ? e.primary : e.secondary;
+                pos[2 * k + side] = o.position;
+                vel[2 * k + side] = o.velocity;
+                cov[2 * k + side] = o.covariance;
+                dt[2 * k + side] = e.dt;
+            }
+        }
+        propagate(2 * count, pos, vel, cov, dt);
+
+        for (size_t k = 0; k < count; k++) {
+            std::array<double, 9> combined;
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    combined[i * 3 + j] = cov[2 * k][i * 6 + j] + cov[2 * k + 1][i * 6 + j];
+                }
+            }
+            const PcEvent& e = events[order[first + k]];
+            results[order[first + k]] = encounter_pc(pos[2 * k + 1] - pos[2 * k],
+                                                     vel[2 * k + 1] - vel[2 * k], combined,
+                                                     e.hard_body_radius, config_.method);
+        }
+    };
+
+    if (pool_) {
+        pool_->parallel_for(blocks, run_block);
+    } else {
+        for (size_t b = 0; b < blocks; b++) run_block(b);
+    }
+    return results;
+}
+
+}  // namespace sim
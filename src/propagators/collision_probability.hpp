@@ -0,0 +1,136 @@
+/**
+ * Collision Probability — batched Pc for screened conjunctions
+ *
+ * ConjunctionScreener finds close approaches; this turns each into a
+ * probability of collision. An event carries both objects' states and
+ * 6x6 position-velocity covariances at a common epoch (an orbit
+ * determination or CDM epoch) and the time from there to TCA:
+ *
+ *   1. Propagation: state and state transition matrix Phi integrate
+ *      together (RK4 on the variational equations, two-body plus J2
+ *      gravity gradient) to TCA, and P(TCA) = Phi P Phi^T. Objects are
+ *      stepped in blocks of LANES as structure-of-arrays lanes, each with
+ *      its own step (dt / the block's step count), so the inner loops run
+ *      across objects and vectorize. An event already at TCA (dt = 0)
+ *      skips this.
+ *   2. Encounter plane: the plane normal to the relative velocity at TCA.
+ *      The combined position covariance (the objects' errors taken as
+ *      independent) is projected onto it and diagonalized; the miss
+ *      vector is expressed on its principal axes.
+ *   3. 2D Pc (short-encounter assumption: straight-line relative motion,
+ *      constant covariance through the encounter), the integral of the
+ *      projected Gaussian over the hard-body disk of the combined radius:
+ *        FOSTER  the 2D integral in polar coordinates about the disk
+ *                (Gauss-Legendre in radius, trapezoid in angle)
+ *        ALFANO  Alfano's 1D form, the error function across the disk
+ *                integrated along it (Gauss-Legendre in x = R sin phi)
+ *      Node counts grow with R / sigma so a disk wide against the
+ *      covariance is still resolved.
+ *
+ * compute() runs a batch (thousands of events per screening run) on a
+ * thread pool, one block of events per task. States are inertial, in one
+ * frame with the J2 axis along z (SGP4's TEME is close enough for the
+ * covariance).
+ */
+
+#ifndef SIM_COLLISION_PROBABILITY_HPP
+#define SIM_COLLISION_PROBABILITY_HPP
+
+#include "core/state_vector.hpp"
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+/// 6x6 covariance, row-major over (x, y, z, vx, vy, vz) [m^2, m^2/s, m^2/s^2]
+using Covariance6 = std::array<double, 36>;
+
+/// 6x6 state transition matrix d(state)/d(state0), row-major
+using Matrix6 = std::array<double, 36>;
+
+enum class PcMethod { FOSTER, ALFANO };
+
+struct PcConfig {
+    PcMethod method = PcMethod::FOSTER;
+    bool include_j2 = true;           // J2 in the state and the STM
+    double mu = 3.986004418e14;       // [m^3/s^2]
+    double j2 = 1.08262668e-3;
+    double radius = 6378137.0;        // J2 reference radius [m]
+    double max_step = 10.0;           // RK4 step bound for propagation [s]
+    int num_threads = 0;              // 0 = hardware concurrency, 1 = serial
+};
+
+/// One object of an event, at the event's covariance epoch
+struct PcObject {
+    Vec3 position;                    // [m]
+    Vec3 velocity;                    // [m/s]
+    Covariance6 covariance{};
+};
+
+struct PcEvent {
+    PcObject primary;
+    PcObject secondary;
+    double dt = 0.0;                  // Covariance epoch to TCA [s] (either sign)
+    double hard_body_radius = 10.0;   // Combined radius [m]
+};
+
+struct PcResult {
+    double pc = 0.0;
+    double miss_distance = 0.0;       // At TCA [m]
+    double relative_speed = 0.0;      // [m/s]
+    double sigma_major = 0.0;         // Encounter-plane 1-sigma axes [m]
+    double sigma_minor = 0.0;
+    double mahalanobis = 0.0;         // Miss distance in sigmas
+    bool valid = false;               // False: degenerate geometry or covariance
+};
+
+class CollisionProbability {
+public:
+    static constexpr size_t LANES = 16;   // Objects per propagation block
+
+    explicit CollisionProbability(const PcConfig& config = PcConfig());
+
+    /** Pc of every event, in order */
+    std::vector<PcResult> compute(const std::vector<PcEvent>& events);
+
+    /**
+     * Encounter-plane Pc for relative state `rel_pos`, `rel_vel`
+     * (secondary - primary, at TCA) with combined 3x3 position covariance
+     * `cov` (row-major)
+     */
+    static PcResult encounter_pc(const Vec3& rel_pos, const Vec3& rel_vel,
+                                 const std::array<double, 9>& cov,
+                                 double hard_body_radius, PcMethod method);
+
+    /**
+     * 2D Pc of a disk of radius R at the origin under a Gaussian centred at
+     * (xm, zm) with principal 1-sigma axes sx, sz along x and z
+     */
+    static double pc_2d(double xm, double zm, double sx, double sz, double R,
+                        PcMethod method);
+
+    /**
+     * Propagate `n` objects by their own `dt`: states in place, and
+     * covariances to Phi P Phi^T. At most LANES objects.
+     */
+    void propagate(size_t n, Vec3* pos, Vec3* vel, Covariance6* cov, const double* dt) const;
+
+    /**
+     * Propagate `n` objects by their own `dt` (either sign, 0 allowed):
+     * states in place, and each object's state transition matrix over its
+     * dt into `phi`. At most LANES objects.
+     */
+    void propagate_stm(size_t n, Vec3* pos, Vec3* vel, Matrix6* phi, const double* dt) const;
+
+private:
+    PcConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+};
+
+}  // namespace sim
+
+#endif  // SIM_COLLISION_PROBABILITY_HPP
@@ -0,0 +1,384 @@
+/**
+ * Conjunction Screener Implementation
+ */
+
+#include "propagators/conjunction_screener.hpp"
+#include "propagators/catalog_propagator.hpp"
+#include "propagators/sgp4_propagator.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t PAIR_CHUNK = 256;      // Hash entries per parallel task
+
+/// Osculating conic of every object at one sample (per-axis buffers)
+struct Conics {
+    std::vector<unsigned char> valid;
+    std::vector<double> hx, hy, hz;     // Unit angular momentum
+    std::vector<double> ex, ey, ez;     // Eccentricity vector
+    std::vector<double> p;              // Semi-latus rectum [m]
+    std::vector<double> rp, ra;         // Perigee / apogee radius [m]
+
+    void resize(size_t n) {
+        valid.resize(n);
+        for (auto* v : {&hx, &hy, &hz, &ex, &ey, &ez, &p, &rp, &ra}) v->resize(n);
+    }
+};
+
+void compute_conics(const ConjunctionSnapshot& s, double mu, Conics& c) {
+    const size_t n = s.x.size();
+    c.resize(n);
+    const double inf = std::numeric_limits<double>::infinity();
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        const double x = s.x[i], y = s.y[i], z = s.z[i];
+        const double vx = s.vx[i], vy = s.vy[i], vz = s.vz[i];
+        const double r = std::sqrt(x * x + y * y + z * z);
+        const double hx = y * vz - z * vy, hy = z * vx - x * vz, hz = x * vy - y * vx;
+        const double h = std::sqrt(hx * hx + hy * hy + hz * hz);
+        const double ih = 1.0 / std::max(h, 1e-300);
+        const double ir = 1.0 / std::max(r, 1e-300);
+
+        // e = (v x h) / mu - r_hat
+        const double ex = (vy * hz - vz * hy) / mu - x * ir;
+        const double ey = (vz * hx - vx * hz) / mu - y * ir;
+        const double ez = (vx * hy - vy * hx) / mu - z * ir;
+        const double e = std::sqrt(ex * ex + ey * ey + ez * ez);
+        const double p = h * h / mu;
+
+        c.hx[i] = hx * ih; c.hy[i] = hy * ih; c.hz[i] = hz * ih;
+        c.ex[i] = ex; c.ey[i] = ey; c.ez[i] = ez;
+        c.p[i] = p;
+        c.rp[i] = p / (1.0 + e);
+        c.ra[i] = e < 1.0 ? p / (1.0 - e) : inf;
+        c.valid[i] = (r >= 1.0 && h > 0.0 && std::isfinite(r + vx + vy + vz)) ? 1 : 0;
+    }
+}
+
+/**
+ * Orbit-path filter: false if the two conics stay more than `margin`
+ * apart radially at both mutual nodes, widened by the radial change over
+ * the angular window in which an approach within `dist` can happen.
+ */
+bool orbit_paths_meet(const Conics& c, size_t i, size_t j, double dist, double margin) {
+    double nx = c.hy[i] * c.hz[j] - c.hz[i] * c.hy[j];
+    double ny = c.hz[i] * c.hx[j] - c.hx[i] * c.hz[j];
+    double nz = c.hx[i] * c.hy[j] - c.hy[i] * c.hx[j];
+    const double sin_rel = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (sin_rel < 1e-9) return true;
+    nx /= sin_rel; ny /= sin_rel; nz /= sin_rel;
+
+    // Radius and |dr/dtheta| of conic k in the in-plane direction u
+    auto radius = [&](size_t k, double ux, double uy, double uz, double& r, double& slope) {
+        double ecos = c.ex[k] * ux + c.ey[k] * uy + c.ez[k] * uz;
+        double wx = c.hy[k] * uz - c.hz[k] * uy;
+        double wy = c.hz[k] * ux - c.hx[k] * uz;
+        double wz = c.hx[k] * uy - c.hy[k] * ux;
+        double esin = c.ex[k] * wx + c.ey[k] * wy + c.ez[k] * wz;
+        double denom = 1.0 + ecos;
+        if (denom < 1e-3) return false;             // Toward a hyperbolic asymptote
+        r = c.p[k] / denom;
+        slope = std::fabs(r * r * esin / c.p[k]);
+        return true;
+    };
+
+    for (double sign : {1.0, -1.0}) {
+        double ri, rj, si, sj;
+        if (!radius(i, sign * nx, sign * ny, sign * nz, ri, si) ||
+            !radius(j, sign * nx, sign * ny, sign * nz, rj, sj)) {
+            return true;
+        }
+        double window = dist / (std::min(ri, rj) * sin_rel);
+        if (!(window < 0.5)) return true;           // Near-coplanar (or sin_rel = 0)
+        double delta = std::asin(window);
+        if (std::fabs(ri - rj) <= dist + margin + (si + sj) * delta) return true;
+    }
+    return false;
+}
+
+/// Relative cubic r(s) = a + b s + c s^2 + d s^3, s in [0, 1]
+struct RelativeCubic {
+    double a[3], b[3], c[3], d[3];
+
+    void eval(double s, double* r, double* dr, double* ddr) const {
+        for (int k = 0; k < 3; k++) {
+            r[k] = a[k] + s * (b[k] + s * (c[k] + s * d[k]));
+            dr[k] = b[k] + s * (2.0 * c[k] + 3.0 * s * d[k]);
+            ddr[k] = 2.0 * c[k] + 6.0 * s * d[k];
+        }
+    }
+
+    /// g(s) = r . r' (half the derivative of the squared range)
+    double g(double s) const {
+        double r[3], dr[3], ddr[3];
+        eval(s, r, dr, ddr);
+        return r[0] * dr[0] + r[1] * dr[1] + r[2] * dr[2];
+    }
+};
+
+/// Root of g in [0, 1) given g(0) < 0 <= g(1): Newton inside a bisection bracket
+double closest_approach(const RelativeCubic& cubic) {
+    double lo = 0.0, hi = 1.0;
+    double g_lo = cubic.g(0.0), g_hi = cubic.g(1.0);
+    double s = g_lo / (g_lo - g_hi);
+    for (int it = 0; it < 40; it++) {
+        double r[3], dr[3], ddr[3];
+        cubic.eval(s, r, dr, ddr);
+        double g = r[0] * dr[0] + r[1] * dr[1] + r[2] * dr[2];
+        double dg = dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2] +
+                    r[0] * ddr[0] + r[1] * ddr[1] + r[2] * ddr[2];
+        if (g < 0.0) lo = s; else hi = s;
+
+        double next = s - g / dg;
+        if (!(next > lo && next < hi)) next = 0.5 * (lo + hi);
+        if (std::fabs(next - s) < 1e-12) { s = next; break; }
+        s = next;
+    }
+    return s;
+}
+
+struct WorkerResult {
+    std::vector<Conjunction> found;
+    ConjunctionStats counts;
+};
+
+} // namespace
+
+ConjunctionScreener::ConjunctionScreener(const ConjunctionConfig& config)
+    : config_(config) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+std::vector<Conjunction> ConjunctionScreener::screen(size_t num_objects, const Sampler& sampler,
+                                                     double start_jd, double end_jd) {
+    stats_ = ConjunctionStats();
+    stats_.objects = num_objects;
+    std::vector<Conjunction> result;
+    const double span = (end_jd - start_jd) * 86400.0;
+    if (num_objects < 2 || !(span > 0.0) || !(config_.step > 0.0)) return result;
+
+    const size_t n = num_objects;
+    const double dist = config_.threshold;
+    const double margin = config_.pad;
+    const int n_intervals = static_cast<int>(std::ceil(span / config_.step - 1e-9));
+
+    ConjunctionSnapshot snap[2];
+    Conics conic[2];
+    for (auto& s : snap) {
+        for (auto* v : {&s.x, &s.y, &s.z, &s.vx, &s.vy, &s.vz}) v->assign(n, 0.0);
+    }
+    sampler(start_jd, snap[0]);
+    compute_conics(snap[0], config_.mu, conic[0]);
+
+    // Per-interval scratch
+    std::vector<double> lox(n), loy(n), loz(n), hix(n), hiy(n), hiz(n);
+    std::vector<int64_t> cx(n), cy(n), cz(n);
+    struct Entry { uint64_t key; uint32_t index; };
+    std::vector<Entry> entries;
+    entries.reserve(n);
+
+    const size_t n_workers = pool_ ? static_cast<size_t>(pool_->size()) : 1;
+    std::vector<WorkerResult> workers(n_workers);
+
+    constexpr int64_t AXIS_LIMIT = (int64_t{1} << 20) - 1;
+    auto key_of = [](int64_t x, int64_t y, int64_t z) {
+        constexpr uint64_t MASK = (uint64_t{1} << 21) - 1;
+        return ((static_cast<uint64_t>(x + AXIS_LIMIT) & MASK) << 42) |
+               ((static_cast<uint64_t>(y + AXIS_LIMIT) & MASK) << 21) |
+               (static_cast<uint64_t>(z + AXIS_LIMIT) & MASK);
+    };
+
+    for (int iv = 0; iv < n_intervals; iv++) {
+        const double t0 = iv * config_.step;
+        const double t1 = std::min(span, (iv + 1) * config_.step);
+        const double h = t1 - t0;
+        const int a = iv & 1, b = a ^ 1;
+        const ConjunctionSnapshot& A = snap[a];
+        const ConjunctionSnapshot& B = snap[b];
+
+        sampler(start_jd + t1 / 86400.0, snap[b]);
+        compute_conics(snap[b], config_.mu, conic[b]);
+        const Conics& C = conic[a];
+
+        // Bezier control-point boxes of each object's Hermite segment
+        const double third = h / 3.0;
+        double max_extent = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double p0[3] = {A.x[i], A.y[i], A.z[i]};
+            double p3[3] = {B.x[i], B.y[i], B.z[i]};
+            double p1[3] = {p0[0] + A.vx[i] * third, p0[1] + A.vy[i] * third, p0[2] + A.vz[i] * third};
+            double p2[3] = {p3[0] - B.vx[i] * third, p3[1] - B.vy[i] * third, p3[2] - B.vz[i] * third};
+            double lo[3], hi[3];
+            for (int k = 0; k < 3; k++) {
+                lo[k] = std::min(std::min(p0[k], p1[k]), std::min(p2[k], p3[k]));
+                hi[k] = std::max(std::max(p0[k], p1[k]), std::max(p2[k], p3[k]));
+            }
+            lox[i] = lo[0]; loy[i] = lo[1]; loz[i] = lo[2];
+            hix[i] = hi[0]; hiy[i] = hi[1]; hiz[i] = hi[2];
+            if (conic[a].valid[i] && conic[b].valid[i]) {
+                max_extent = std::max(max_extent, std::max(hi[0] - lo[0],
+                                      std::max(hi[1] - lo[1], hi[2] - lo[2])));
+            }
+        }
+
+        // Hash by box center; overlapping boxes sit in adjacent cells
+        const double inv_cell = 1.0 / std::max(1.0, max_extent + dist);
+        auto cell_of = [&](double v) {
+            double c = std::floor(v * inv_cell);
+            return static_cast<int64_t>(std::max<double>(-AXIS_LIMIT, std::min<double>(AXIS_LIMIT, c)));
+        };
+        entries.clear();
+        for (size_t i = 0; i < n; i++) {
+            if (!conic[a].valid[i] || !conic[b].valid[i]) continue;
+            cx[i] = cell_of(0.5 * (lox[i] + hix[i]));
+            cy[i] = cell_of(0.5 * (loy[i] + hiy[i]));
+            cz[i] = cell_of(0.5 * (loz[i] + hiz[i]));
+            entries.push_back({key_of(cx[i], cy[i], cz[i]), static_cast<uint32_t>(i)});
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry& x, const Entry& y) {
+            return x.key != y.key ? x.key < y.key : x.index < y.index;
+        });
+
+        auto test_pair = [&](size_t i, size_t j, WorkerResult& out) {
+            // Box overlap within the threshold
+            if (lox[i] - dist > hix[j] || lox[j] - dist > hix[i] ||
+                loy[i] - dist > hiy[j] || loy[j] - dist > hiy[i] ||
+                loz[i] - dist > hiz[j] || loz[j] - dist > hiz[i]) {
+                return;
+            }
+            out.counts.grid_pairs++;
+
+            if (config_.apogee_perigee_filter &&
+                std::max(C.rp[i], C.rp[j]) - std::min(C.ra[i], C.ra[j]) > dist + margin) {
+                out.counts.apogee_perigee_rejects++;
+                return;
+            }
+            if (config_.orbit_path_filter && !orbit_paths_meet(C, i, j, dist, margin)) {
+                out.counts.orbit_path_rejects++;
+                return;
+            }
+
+            // Relative Hermite cubic and its control-point box
+            RelativeCubic cubic;
+            double d0[3] = {A.x[i] - A.x[j], A.y[i] - A.y[j], A.z[i] - A.z[j]};
+            double d1[3] = {B.x[i] - B.x[j], B.y[i] - B.y[j], B.z[i] - B.z[j]};
+            double w0[3] = {(A.vx[i] - A.vx[j]) * h, (A.vy[i] - A.vy[j]) * h, (A.vz[i] - A.vz[j]) * h};
+            double w1[3] = {(B.vx[i] - B.vx[j]) * h, (B.vy[i] - B.vy[j]) * h, (B.vz[i] - B.vz[j]) * h};
+            bool reaches = true;
+            for (int k = 0; k < 3; k++) {
+                cubic.a[k] = d0[k];
+                cubic.b[k] = w0[k];
+                cubic.c[k] = 3.0 * (d1[k] - d0[k]) - 2.0 * w0[k] - w1[k];
+                cubic.d[k] = 2.0 * (d0[k] - d1[k]) + w0[k] + w1[k];
+                double q1 = d0[k] + w0[k] / 3.0, q2 = d1[k] - w1[k] / 3.0;
+                double lo = std::min(std::min(d0[k], q1), std::min(q2, d1[k]));
+                double hi = std::max(std::max(d0[k], q1), std::max(q2, d1[k]));
+                reaches = reaches && lo <= dist && hi >= -dist;
+            }
+            // Range minimum inside [0, 1): closing at the start, not at the end
+            double g0 = d0[0] * w0[0] + d0[1] * w0[1] + d0[2] * w0[2];
+            double g1 = d1[0] * w1[0] + d1[1] * w1[1] + d1[2] * w1[2];
+            if (!reaches || !(g0 < 0.0 && g1 >= 0.0)) {
+                out.counts.time_rejects++;
+                return;
+            }
+
+            out.counts.refined++;
+            double s = closest_approach(cubic);
+            double r[3], dr[3], ddr[3];
+            cubic.eval(s, r, dr, ddr);
+            double miss = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+            if (miss > dist) return;
+
+            Conjunction cj;
+            cj.primary = i;
+            cj.secondary = j;
+            cj.tca_jd = start_jd + (t0 + s * h) / 86400.0;
+            cj.miss_distance = miss;
+            cj.relative_speed = std::sqrt(dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2]) / h;
+            out.found.push_back(cj);
+        };
+
+        auto scan = [&](size_t chunk, int worker) {
+            WorkerResult& out = workers[static_cast<size_t>(worker)];
+            const size_t e_end = std::min(entries.size(), (chunk + 1) * PAIR_CHUNK);
+            for (size_t e = chunk * PAIR_CHUNK; e < e_end; e++) {
+                const size_t i = entries[e].index;
+                // z is the low field of the key: each (dx, dy) column of
+                // three cells is one contiguous key range
+                for (int64_t dx = -1; dx <= 1; dx++) {
+                    for (int64_t dy = -1; dy <= 1; dy++) {
+                        uint64_t k_lo = key_of(cx[i] + dx, cy[i] + dy, cz[i] - 1);
+                        uint64_t k_hi = key_of(cx[i] + dx, cy[i] + dy, cz[i] + 1);
+                        auto it = std::lower_bound(
+                            entries.begin(), entries.end(), k_lo,
+                            [](const Entry& en, uint64_t kk) { return en.key < kk; });
+                        for (; it != entries.end() && it->key <= k_hi; ++it) {
+                            if (it->index > i) test_pair(i, it->index, out);
+                        }
+                    }
+                }
+            }
+        };
+
+        const size_t chunks = (entries.size() + PAIR_CHUNK - 1) / PAIR_CHUNK;
+        if (pool_) {
+            pool_->parallel_for(chunks, scan);
+        } else {
+            for (size_t c = 0; c < chunks; c++) scan(c, 0);
+        }
+        stats_.intervals++;
+    }
+
+    for (auto& w : workers) {
+        result.insert(result.end(), w.found.begin(), w.found.end());
+        stats_.grid_pairs += w.counts.grid_pairs;
+        stats_.apogee_perigee_rejects += w.counts.apogee_perigee_rejects;
+        stats_.orbit_path_rejects += w.counts.orbit_path_rejects;
+        stats_.time_rejects += w.counts.time_rejects;
+        stats_.refined += w.counts.refined;
+    }
+    std::sort(result.begin(), result.end(), [](const Conjunction& x, const Conjunction& y) {
+        if (x.tca_jd != y.tca_jd) return x.tca_jd < y.tca_jd;
+        return x.primary != y.primary ? x.primary < y.primary : x.secondary < y.secondary;
+    });
+    stats_.conjunctions = result.size();
+    return result;
+}
+
+ConjunctionScreener::Sampler ConjunctionScreener::sgp4_sampler(SGP4Batch& batch, int num_threads) {
+    return [&batch, num_threads](double jd, ConjunctionSnapshot& out) {
+        batch.evaluate(jd, num_threads);
+        const size_t n = batch.size();
+        std::copy_n(batch.x(), n, out.x.begin());
+        std::copy_n(batch.y(), n, out.y.begin());
+        std::copy_n(batch.z(), n, out.z.begin());
+        std::copy_n(batch.vx(), n, out.vx.begin());
+        std::copy_n(batch.vy(), n, out.vy.begin());
+        std::copy_n(batch.vz(), n, out.vz.begin());
+    };
+}
+
+ConjunctionScreener::Sampler ConjunctionScreener::catalog_sampler(CatalogPropagator& catalog,
+                                                                  double epoch_jd) {
+    return [&catalog, epoch_jd](double jd, ConjunctionSnapshot& out) {
+        catalog.propagate((jd - epoch_jd) * 86400.0 - catalog.time());
+        const size_t n = catalog.size();
+        std::copy_n(catalog.x(), n, out.x.begin());
+        std::copy_n(catalog.y(), n, out.y.begin());
+        std::copy_n(catalog.z(), n, out.z.begin());
+        std::copy_n(catalog.vx(), n, out.vx.begin());
+        std::copy_n(catalog.vy(), n, out.vy.begin());
+        std::copy_n(catalog.vz(), n, out.vz.begin());
+    };
+}
+
+}  // namespace sim
@@ -0,0 +1,125 @@
+/**
+ * Conjunction Screener — all-vs-all close-approach screening
+ *
+ * Screens a set of objects (a TLE catalog through SGP4Batch, numerically
+ * propagated fields through CatalogPropagator, or any caller-supplied
+ * sampler) for close approaches over a time span.
+ *
+ * Every object is sampled on a coarse time grid. Between two samples its
+ * path is the cubic Hermite interpolant of the sampled positions and
+ * velocities, contained in the bounding box of its Bezier control points.
+ * Per grid interval:
+ *
+ *   1. Spatial hash: boxes are bucketed by center into cubic cells one
+ *      box-size (plus the threshold) wide, so only objects in adjacent
+ *      cells can overlap. Overlapping pairs are candidates.
+ *   2. Apogee-perigee filter: the radial bands [perigee, apogee] of the
+ *      two osculating orbits must come within threshold + pad.
+ *   3. Orbit-path filter (Hoots et al., 1984): a close approach of two
+ *      inclined orbits happens near their mutual line of nodes, so the
+ *      orbit radii at one of the two nodes must agree to within threshold
+ *      + pad plus the radial change over the node window. Near-coplanar
+ *      pairs pass.
+ *   4. Time filter: the relative Hermite curve's control-point box must
+ *      reach the threshold sphere, and the range rate must change sign in
+ *      the interval (a local minimum of range).
+ *   5. TCA: safeguarded Newton on d/ds |r_rel(s)|^2 = 0 along the
+ *      relative Hermite cubic.
+ *
+ * Filters 2-3 use the osculating conics at the start of the interval,
+ * which the objects follow closely for one grid step. Sampling, the hash
+ * pass and the pair filters are multi-threaded; results are sorted by TCA.
+ *
+ * Positions must all be in one frame (SGP4 gives TEME; CatalogPropagator
+ * its ECI frame). An object whose sample is non-finite or at the origin
+ * (SGP4Batch's error output) is skipped for the intervals that touch it.
+ */
+
+#ifndef SIM_CONJUNCTION_SCREENER_HPP
+#define SIM_CONJUNCTION_SCREENER_HPP
+
+#include "core/state_vector.hpp"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+class SGP4Batch;
+class CatalogPropagator;
+
+struct ConjunctionConfig {
+    double threshold = 5000.0;        // Reported miss distance [m]
+    double step = 60.0;               // Coarse grid step [s]
+    double pad = 2000.0;              // Margin on the orbit filters [m]
+    bool apogee_perigee_filter = true;
+    bool orbit_path_filter = true;
+    double mu = 3.986004418e14;       // For the osculating conics [m^3/s^2]
+    int num_threads = 0;              // 0 = hardware concurrency, 1 = serial
+};
+
+/// One close approach
+struct Conjunction {
+    size_t primary;                   // Object indices, primary < secondary
+    size_t secondary;
+    double tca_jd;                    // Time of closest approach
+    double miss_distance;             // [m]
+    double relative_speed;            // [m/s]
+};
+
+struct ConjunctionStats {
+    size_t objects = 0;
+    size_t intervals = 0;
+    size_t grid_pairs = 0;             // Overlapping boxes from the hash
+    size_t apogee_perigee_rejects = 0;
+    size_t orbit_path_rejects = 0;
+    size_t time_rejects = 0;
+    size_t refined = 0;               // TCA searches run
+    size_t conjunctions = 0;
+};
+
+/// States of every object at one sample time (per-axis buffers)
+struct ConjunctionSnapshot {
+    std::vector<double> x, y, z;      // [m]
+    std::vector<double> vx, vy, vz;   // [m/s]
+};
+
+class ConjunctionScreener {
+public:
+    /**
+     * Fills `out` (already sized to the object count) with every object's
+     * state at `jd`. Called with increasing jd.
+     */
+    using Sampler = std::function<void(double jd, ConjunctionSnapshot& out)>;
+
+    explicit ConjunctionScreener(const ConjunctionConfig& config = ConjunctionConfig());
+
+    /**
+     * Screen num_objects objects over [start_jd, end_jd].
+     * @return Close approaches within the threshold, by TCA
+     */
+    std::vector<Conjunction> screen(size_t num_objects, const Sampler& sampler,
+                                    double start_jd, double end_jd);
+
+    const ConjunctionStats& stats() const { return stats_; }
+
+    /** Sampler over an SGP4Batch (evaluated with num_threads threads) */
+    static Sampler sgp4_sampler(SGP4Batch& batch, int num_threads = 0);
+
+    /**
+     * Sampler over a CatalogPropagator whose time 0 is epoch_jd; the
+     * catalog is propagated forward to each sample time.
+     */
+    static Sampler catalog_sampler(CatalogPropagator& catalog, double epoch_jd);
+
+private:
+    ConjunctionConfig config_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+    ConjunctionStats stats_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_CONJUNCTION_SCREENER_HPP
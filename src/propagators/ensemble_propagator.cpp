@@ -0,0 +1,296 @@
+/**
+ * Ensemble Propagator Implementation
+ */
+
+#include "propagators/ensemble_propagator.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace sim {
+
+namespace {
+
+constexpr int N = 6;
+
+/// Count, mean and co-moment sums of a set of members (Chan et al. merge)
+struct Moments {
+    double count = 0.0;
+    std::array<double, N> mean{};
+    std::array<double, N * N> m2{};
+
+    void merge(const Moments& o) {
+        if (o.count == 0.0) return;
+        if (count == 0.0) {
+            *this = o;
+            return;
+        }
+        const double total = count + o.count;
+        std::array<double, N> delta;
+        for (int i = 0; i < N; i++) delta[i] = o.mean[i] - mean[i];
+        const double f = count * o.count / total;
+        for (int i = 0; i < N; i++) {
+            for (int j = 0; j < N; j++) m2[i * N + j] += o.m2[i * N + j] + delta[i] * delta[j] * f;
+        }
+        for (int i = 0; i < N; i++) mean[i] += delta[i] * o.count / total;
+        count = total;
+    }
+};
+
+/// Moments of members [begin, end) of the per-axis arrays (two-pass)
+Moments block_moments(const std::vector<double>* s, size_t begin, size_t end) {
+    Moments m;
+    m.count = static_cast<double>(end - begin);
+    if (end == begin) return m;
+    for (int i = 0; i < N; i++) {
+        double sum = 0.0;
+        for (size_t k = begin; k < end; k++) sum += s[i][k];
+        m.mean[i] = sum / m.count;
+    }
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            double sum = 0.0;
+            const double mi = m.mean[i], mj = m.mean[j];
+            for (size_t k = begin; k < end; k++) sum += (s[i][k] - mi) * (s[j][k] - mj);
+            m.m2[i * N + j] = m.m2[j * N + i] = sum;
+        }
+    }
+    return m;
+}
+
+/// Lower Cholesky factor of a symmetric 6x6. @throws if not positive definite
+std::array<double, N * N> cholesky(const Covariance6& a) {
+    std::array<double, N * N> l{};
+    for (int j = 0; j < N; j++) {
+        double d = a[j * N + j];
+        for (int k = 0; k < j; k++) d -= l[j * N + k] * l[j * N + k];
+        if (!(d > 0.0)) {
+            throw std::invalid_argument("EnsemblePropagator: covariance is not positive definite");
+        }
+        l[j * N + j] = std::sqrt(d);
+        for (int i = j + 1; i < N; i++) {
+            double v = a[i * N + j];
+            for (int k = 0; k < j; k++) v -= l[i * N + k] * l[j * N + k];
+            l[i * N + j] = v / l[j * N + j];
+        }
+    }
+    return l;
+}
+
+uint64_t splitmix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/// Standard normal quantile: Acklam's rational approximation, one Halley step
+double normal_quantile(double p) {
+    if (p <= 0.0) return -INFINITY;
+    if (p >= 1.0) return INFINITY;
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                               -2.759285104469687e+02, 1.383577518672690e+02,
+                               -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                               -1.556989798598866e+02, 6.680131188771972e+01,
+                               -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                               -2.400758277161838e+00, -2.549732539343734e+00,
+                                4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                               2.445134137142996e+00, 3.754408661907416e+00};
+    double x;
+    if (p < 0.02425 || p > 1.0 - 0.02425) {
+        const double q = std::sqrt(-2.0 * std::log(p < 0.5 ? p : 1.0 - p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        if (p > 0.5) x = -x;
+    } else {
+        const double q = p - 0.5, r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+    const double e = 0.5 * std::erfc(-x / std::sqrt(2.0)) - p;
+    const double u = e * std::sqrt(2.0 * M_PI) * std::exp(0.5 * x * x);
+    return x - u / (1.0 + 0.5 * x * u);
+}
+
+}  // namespace
+
+EnsemblePropagator::EnsemblePropagator(const EnsembleConfig& config)
+    : config_(config) {
+    const CatalogConfig dynamics = config_.dynamics;
+    propagate_ = [dynamics](size_t n, double* const* s, double t0, double t1) {
+        CatalogPropagator::propagate_arrays(dynamics, n, s[0], s[1], s[2], s[3], s[4], s[5],
+                                            t1 - t0);
+    };
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+void EnsemblePropagator::sigma_points(const EnsembleState& mean, const Covariance6& cov,
+                                      std::vector<EnsembleState>& points,
+                                      std::vector<double>& wm, std::vector<double>& wc) const {
+    const double a = config_.alpha;
+    const double lambda = a * a * (N + config_.kappa) - N;
+    Covariance6 scaled;
+    for (int i = 0; i < N * N; i++) scaled[i] = (N + lambda) * cov[i];
+    const std::array<double, N * N> l = cholesky(scaled);
+
+    points.assign(2 * N + 1, mean);
+    wm.assign(2 * N + 1, 0.5 / (N + lambda));
+    wc = wm;
+    wm[0] = lambda / (N + lambda);
+    wc[0] = wm[0] + (1.0 - a * a + config_.beta);
+    for (int j = 0; j < N; j++) {
+        for (int i = 0; i < N; i++) {
+            points[1 + j][i] += l[i * N + j];
+            points[1 + N + j][i] -= l[i * N + j];
+        }
+    }
+}
+
+std::vector<EnsembleStats> EnsemblePropagator::propagate(const EnsembleState& mean,
+                                                         const Covariance6& cov,
+                                                         const std::vector<double>& times,
+                                                         const StatsCallback& on_stats) {
+    if (config_.mode == EnsembleMode::UNSCENTED) {
+        std::vector<EnsembleState> points;
+        std::vector<double> wm, wc;
+        sigma_points(mean, cov, points, wm, wc);
+        return run(std::move(points), wm, wc, times, on_stats);
+    }
+
+    const std::array<double, N * N> l = cholesky(cov);
+    std::mt19937_64 rng(config_.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<EnsembleState> members(config_.samples);
+    for (EnsembleState& m : members) {
+        double u[N];
+        for (int i = 0; i < N; i++) u[i] = normal(rng);
+        for (int i = 0; i < N; i++) {
+            double v = mean[i];
+            for (int k = 0; k <= i; k++) v += l[i * N + k] * u[k];
+            m[i] = v;
+        }
+    }
+    return run(std::move(members), {}, {}, times, on_stats);
+}
+
+std::vector<EnsembleStats> EnsemblePropagator::propagate(const std::vector<EnsembleState>& samples,
+                                                         const std::vector<double>& times,
+                                                         const StatsCallback& on_stats) {
+    return run(samples, {}, {}, times, on_stats);
+}
+
+std::vector<EnsembleStats> EnsemblePropagator::run(std::vector<EnsembleState> members,
+                                                   const std::vector<double>& wm,
+                                                   const std::vector<double>& wc,
+                                                   const std::vector<double>& times,
+                                                   const StatsCallback& on_stats) {
+    const size_t count = members.size();
+    const bool weighted = !wm.empty();
+
+    // Per-axis buffers; members are dropped once copied in
+    std::vector<double> s[N];
+    for (int i = 0; i < N; i++) {
+        s[i].resize(count);
+        for (size_t k = 0; k < count; k++) s[i][k] = members[k][i];
+    }
+    members = {};
+
+    // Quantile subset: the members with the smallest index hashes
+    std::vector<size_t> kept(count);
+    std::iota(kept.begin(), kept.end(), size_t{0});
+    if (!weighted && count > config_.quantile_sample) {
+        auto key = [this](size_t k) { return splitmix64(config_.seed ^ k); };
+        std::nth_element(kept.begin(), kept.begin() + config_.quantile_sample, kept.end(),
+                         [&key](size_t a, size_t b) { return key(a) < key(b); });
+        kept.resize(config_.quantile_sample);
+        std::sort(kept.begin(), kept.end());
+    }
+
+    const size_t block = std::max<size_t>(config_.block, 1);
+    const size_t blocks = (count + block - 1) / block;
+    std::vector<Moments> moments(blocks);
+    std::vector<EnsembleStats> out;
+    out.reserve(times.size());
+    double t_prev = 0.0;
+
+    for (double t : times) {
+        if (t < t_prev) throw std::invalid_argument("EnsemblePropagator: times must increase");
+        auto step_block = [&](size_t b) {
+            const size_t begin = b * block;
+            const size_t n = std::min(block, count - begin);
+            double* const ptr[N] = {s[0].data() + begin, s[1].data() + begin, s[2].data() + begin,
+                                    s[3].data() + begin, s[4].data() + begin, s[5].data() + begin};
+            if (t > t_prev) propagate_(n, ptr, t_prev, t);
+            if (!weighted) moments[b] = block_moments(s, begin, begin + n);
+        };
+        if (pool_) {
+            pool_->parallel_for(blocks, step_block);
+        } else {
+            for (size_t b = 0; b < blocks; b++) step_block(b);
+        }
+        t_prev = t;
+
+        EnsembleStats stats;
+        stats.time = t;
+        stats.members = count;
+        if (weighted) {
+            for (int i = 0; i < N; i++) {
+                double v = 0.0;
+                for (size_t k = 0; k < count; k++) v += wm[k] * s[i][k];
+                stats.mean[i] = v;
+            }
+            for (int i = 0; i < N; i++) {
+                for (int j = i; j < N; j++) {
+                    double v = 0.0;
+                    for (size_t k = 0; k < count; k++) {
+                        v += wc[k] * (s[i][k] - stats.mean[i]) * (s[j][k] - stats.mean[j]);
+                    }
+                    stats.covariance[i * N + j] = stats.covariance[j * N + i] = v;
+                }
+            }
+            for (double q : config_.quantiles) {
+                const double z = normal_quantile(q);
+                EnsembleState e;
+                for (int i = 0; i < N; i++) {
+                    e[i] = stats.mean[i] + z * std::sqrt(std::max(stats.covariance[i * N + i], 0.0));
+                }
+                stats.quantiles.push_back(e);
+            }
+        } else {
+            Moments total;
+            for (const Moments& m : moments) total.merge(m);
+            stats.mean = total.mean;
+            const double dof = std::max(total.count - 1.0, 1.0);
+            for (int i = 0; i < N * N; i++) stats.covariance[i] = total.m2[i] / dof;
+
+            std::vector<double> values(kept.size());
+            stats.quantiles.assign(config_.quantiles.size(), EnsembleState{});
+            for (int i = 0; i < N && !kept.empty(); i++) {
+                for (size_t k = 0; k < kept.size(); k++) values[k] = s[i][kept[k]];
+                std::sort(values.begin(), values.end());
+                for (size_t q = 0; q < config_.quantiles.size(); q++) {
+                    // Linear interpolation between order statistics
+                    const double pos = std::clamp(config_.quantiles[q], 0.0, 1.0) *
+                                       static_cast<double>(values.size() - 1);
+                    const size_t lo = static_cast<size_t>(pos);
+                    const size_t hi = std::min(lo + 1, values.size() - 1);
+                    stats.quantiles[q][i] = values[lo] + (pos - lo) * (values[hi] - values[lo]);
+                }
+            }
+        }
+
+        if (on_stats) on_stats(stats);
+        out.push_back(std::move(stats));
+    }
+    return out;
+}
+
+}  // namespace sim
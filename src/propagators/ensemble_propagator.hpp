@@ -0,0 +1,122 @@
+/**
+ * Ensemble Propagator — uncertainty propagation by sigma points or samples
+ *
+ * Propagates a distribution of states instead of one: a mean and 6x6
+ * covariance (as Covariance6 in collision_probability.hpp), or a caller's
+ * sample set. The members are held as structure-of-arrays buffers and
+ * advanced together by a batch propagator, CatalogPropagator::
+ * propagate_arrays() by default (two-body + zonals, blocked RK4), or any
+ * BatchPropagate over the same buffers. Modes:
+ *
+ *   UNSCENTED    2n + 1 = 13 sigma points m +- columns of chol((n +
+ *                lambda) P), lambda = alpha^2 (n + kappa) - n; mean and
+ *                covariance are the weighted sums (Julier / Wan-van der
+ *                Merwe weights), quantiles the Gaussian ones of that
+ *                mean and covariance.
+ *   MONTE_CARLO  `samples` draws m + L u, P = L L^T, u standard normal
+ *                from a seeded generator; mean, covariance and quantiles
+ *                of the members.
+ *
+ * Statistics are produced epoch by epoch, each handed to the callback
+ * as soon as every member has reached it; no member trajectory is kept.
+ * Members are processed in blocks of `block` on the thread pool. Each
+ * block's moments are merged in block order (Chan et al.), so the
+ * result does not depend on the thread count. Quantiles come from a
+ * bottom-k sample: the `quantile_sample` members with the smallest hash
+ * of their index, the same subset at every epoch and for any thread
+ * count (exact when the ensemble is no larger).
+ *
+ * State order is (x, y, z, vx, vy, vz) in the propagator's frame [m, m/s].
+ */
+
+#ifndef SIM_ENSEMBLE_PROPAGATOR_HPP
+#define SIM_ENSEMBLE_PROPAGATOR_HPP
+
+#include "propagators/catalog_propagator.hpp"
+#include "propagators/collision_probability.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+using EnsembleState = std::array<double, 6>;
+
+enum class EnsembleMode { UNSCENTED, MONTE_CARLO };
+
+struct EnsembleConfig {
+    EnsembleMode mode = EnsembleMode::MONTE_CARLO;
+    size_t samples = 1000;                 // MONTE_CARLO members
+    uint64_t seed = 1;
+    double alpha = 1.0;                    // UNSCENTED spread
+    double beta = 2.0;                     // UNSCENTED prior (2 = Gaussian)
+    double kappa = 0.0;
+    std::vector<double> quantiles = {0.05, 0.5, 0.95};
+    size_t quantile_sample = 4096;         // Members kept for quantiles
+    size_t block = 256;                    // Members per parallel task
+    CatalogConfig dynamics;                // Default propagator
+    int num_threads = 0;                   // 0 = hardware concurrency, 1 = serial
+};
+
+/// Ensemble statistics at one epoch
+struct EnsembleStats {
+    double time = 0.0;                     // [s] from the initial epoch
+    size_t members = 0;
+    EnsembleState mean{};
+    Covariance6 covariance{};
+    std::vector<EnsembleState> quantiles;  // One per EnsembleConfig::quantiles
+};
+
+class EnsemblePropagator {
+public:
+    /**
+     * Advance n members held in per-axis arrays s[0..5] from t0 to t1 [s].
+     * Called concurrently on disjoint blocks.
+     */
+    using BatchPropagate = std::function<void(size_t n, double* const* s, double t0, double t1)>;
+
+    /** Receives each epoch's statistics as soon as they are complete */
+    using StatsCallback = std::function<void(const EnsembleStats&)>;
+
+    explicit EnsemblePropagator(const EnsembleConfig& config = EnsembleConfig());
+
+    /** Replace the default CatalogPropagator dynamics */
+    void set_propagator(BatchPropagate propagate) { propagate_ = std::move(propagate); }
+
+    /**
+     * Propagate the distribution (mean, cov) through `times` (increasing,
+     * >= 0, seconds from the mean's epoch).
+     * @throws std::invalid_argument if cov is not positive definite
+     */
+    std::vector<EnsembleStats> propagate(const EnsembleState& mean, const Covariance6& cov,
+                                         const std::vector<double>& times,
+                                         const StatsCallback& on_stats = nullptr);
+
+    /** Propagate a caller's sample set (MONTE_CARLO statistics) */
+    std::vector<EnsembleStats> propagate(const std::vector<EnsembleState>& samples,
+                                         const std::vector<double>& times,
+                                         const StatsCallback& on_stats = nullptr);
+
+    /** Sigma points and their mean / covariance weights for (mean, cov) */
+    void sigma_points(const EnsembleState& mean, const Covariance6& cov,
+                      std::vector<EnsembleState>& points, std::vector<double>& wm,
+                      std::vector<double>& wc) const;
+
+private:
+    EnsembleConfig config_;
+    BatchPropagate propagate_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+
+    std::vector<EnsembleStats> run(std::vector<EnsembleState> members,
+                                   const std::vector<double>& wm, const std::vector<double>& wc,
+                                   const std::vector<double>& times,
+                                   const StatsCallback& on_stats);
+};
+
+}  // namespace sim
+
+#endif  // SIM_ENSEMBLE_PROPAGATOR_HPP
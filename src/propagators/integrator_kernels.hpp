@@ -0,0 +1,417 @@
+/**
+ * Integrator Kernels — header-only RK4, Dormand-Prince 4(5) and 8(5,3) steps
+ *
+ * Templated on the state width and on the right-hand side functor, so a
+ * gravity/perturbation RHS is inlined into the stages instead of being
+ * called through std::function, and stages are fixed-size arrays instead
+ * of full StateVectors (no attitude, frame or heap traffic).
+ *
+ * RHS signature:
+ *   void f(double t, const std::array<double, N>& y, std::array<double, N>& dydt)
+ *
+ * State layouts used in the tree:
+ *   OrbitState6   x, y, z, vx, vy, vz
+ *   OrbitState7   x, y, z, vx, vy, vz, mass   (as LaunchState carries it)
+ *
+ * RK4Integrator and AdaptiveIntegrator are thin std::function wrappers
+ * over these kernels. The stage arithmetic is the same as theirs was;
+ * results can differ in the last bits where the compiler fuses
+ * multiply-adds differently.
+ */
+
+#ifndef SIM_INTEGRATOR_KERNELS_HPP
+#define SIM_INTEGRATOR_KERNELS_HPP
+
+#include "propagators/adaptive_integrator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace sim {
+
+/// Minimal integrator state: time plus N components
+template <std::size_t N>
+struct FixedState {
+    double t = 0.0;
+    std::array<double, N> y{};
+};
+
+using OrbitState6 = FixedState<6>;
+using OrbitState7 = FixedState<7>;
+
+/// Result of a single adaptive kernel step (see IntegrationStep)
+template <std::size_t N>
+struct FixedStep {
+    FixedState<N> state;
+    double dt_used;
+    double dt_next;
+    double error_estimate;
+};
+
+/**
+ * Classic RK4 step.
+ *
+ * @param s Current state
+ * @param dt Time step [s]
+ * @param f Right-hand side functor
+ * @return State at s.t + dt
+ */
+template <std::size_t N, class Rhs>
+inline FixedState<N> rk4_step(const FixedState<N>& s, double dt, Rhs&& f) {
+    using Y = std::array<double, N>;
+    const double half = dt / 2.0;
+    Y k1, k2, k3, k4, tmp;
+
+    f(s.t, s.y, k1);
+    for (std::size_t i = 0; i < N; i++) tmp[i] = s.y[i] + k1[i] * half;
+    f(s.t + half, tmp, k2);
+    for (std::size_t i = 0; i < N; i++) tmp[i] = s.y[i] + k2[i] * half;
+    f(s.t + half, tmp, k3);
+    for (std::size_t i = 0; i < N; i++) tmp[i] = s.y[i] + k3[i] * dt;
+    f(s.t + dt, tmp, k4);
+
+    FixedState<N> out;
+    out.t = s.t + dt;
+    for (std::size_t i = 0; i < N; i++) {
+        out.y[i] = s.y[i] + dt * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]) / 6.0;
+    }
+    return out;
+}
+
+/// Dormand-Prince 4(5) Butcher tableau
+namespace dopri5 {
+    constexpr double c2 = 1.0/5.0;
+    constexpr double c3 = 3.0/10.0;
+    constexpr double c4 = 4.0/5.0;
+    constexpr double c5 = 8.0/9.0;
+
+    constexpr double a21 = 1.0/5.0;
+    constexpr double a31 = 3.0/40.0;
+    constexpr double a32 = 9.0/40.0;
+    constexpr double a41 = 44.0/45.0;
+    constexpr double a42 = -56.0/15.0;
+    constexpr double a43 = 32.0/9.0;
+    constexpr double a51 = 19372.0/6561.0;
+    constexpr double a52 = -25360.0/2187.0;
+    constexpr double a53 = 64448.0/6561.0;
+    constexpr double a54 = -212.0/729.0;
+    constexpr double a61 = 9017.0/3168.0;
+    constexpr double a62 = -355.0/33.0;
+    constexpr double a63 = 46732.0/5247.0;
+    constexpr double a64 = 49.0/176.0;
+    constexpr double a65 = -5103.0/18656.0;
+
+    // 5th order weights (FSAL: equal to the 7th stage row)
+    constexpr double b1 = 35.0/384.0;
+    constexpr double b3 = 500.0/1113.0;
+    constexpr double b4 = 125.0/192.0;
+    constexpr double b5 = -2187.0/6784.0;
+    constexpr double b6 = 11.0/84.0;
+
+    // 4th order weights for the error estimate
+    constexpr double bs1 = 5179.0/57600.0;
+    constexpr double bs3 = 7571.0/16695.0;
+    constexpr double bs4 = 393.0/640.0;
+    constexpr double bs5 = -92097.0/339200.0;
+    constexpr double bs6 = 187.0/2100.0;
+    constexpr double bs7 = 1.0/40.0;
+
+    // Dense output (Hairer, Norsett & Wanner, CONTD5)
+    constexpr double d1 = -12715105075.0/11282082432.0;
+    constexpr double d3 = 87487479700.0/32700410799.0;
+    constexpr double d4 = -10690763975.0/1880347072.0;
+    constexpr double d5 = 701980252875.0/199316789632.0;
+    constexpr double d6 = -1453857185.0/822651844.0;
+    constexpr double d7 = 69997945.0/29380423.0;
+}  // namespace dopri5
+
+/**
+ * Continuous 4th-order extension of one accepted Dormand-Prince step,
+ * built from the step's own stages (no extra RHS calls). Valid on
+ * [t0, t0 + h].
+ */
+template <std::size_t N>
+struct Dopri5Dense {
+    double t0 = 0.0;
+    double h = 0.0;
+    std::array<std::array<double, N>, 5> r{};
+
+    /** Interpolated state at time t */
+    FixedState<N> at(double t) const {
+        const double th = (t - t0) / h;
+        const double th1 = 1.0 - th;
+        FixedState<N> out;
+        out.t = t;
+        for (std::size_t i = 0; i < N; i++) {
+            out.y[i] = r[0][i] + th * (r[1][i] + th1 * (r[2][i] + th * (r[3][i] + th1 * r[4][i])));
+        }
+        return out;
+    }
+};
+
+/**
+ * RMS of the 4th/5th order difference, each component scaled by
+ * abs_tolerance + rel_tolerance * max(|y4|, |y5|).
+ */
+template <std::size_t N>
+inline double dopri5_error(const std::array<double, N>& y4, const std::array<double, N>& y5,
+                           const AdaptiveConfig& config) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < N; i++) {
+        double scale = config.abs_tolerance + config.rel_tolerance *
+            std::max(std::fabs(y4[i]), std::fabs(y5[i]));
+        double e = (y5[i] - y4[i]) / scale;
+        sum += e * e;
+    }
+    return std::sqrt(sum / static_cast<double>(N));
+}
+
+/**
+ * Single Dormand-Prince 4(5) adaptive step: attempts dt_try, shrinking and
+ * retrying while the error norm exceeds 1. Same control law as
+ * AdaptiveIntegrator::step.
+ *
+ * @param dense If non-null, receives the accepted step's interpolant
+ */
+template <std::size_t N, class Rhs>
+inline FixedStep<N> dopri5_step(const FixedState<N>& s, double dt_try, Rhs&& f,
+                                const AdaptiveConfig& config,
+                                Dopri5Dense<N>* dense = nullptr) {
+    using namespace dopri5;
+    using Y = std::array<double, N>;
+    const Y& y = s.y;
+    double h = dt_try;
+    Y k1, k2, k3, k4, k5, k6, k7, tmp, y5, y4;
+
+    // Stage 1 does not depend on h
+    f(s.t, y, k1);
+
+    for (int attempts = 0; attempts < 100; ++attempts) {
+        h = std::max(h, config.dt_min);
+        h = std::min(h, config.dt_max);
+
+        for (std::size_t i = 0; i < N; i++) tmp[i] = y[i] + h * a21 * k1[i];
+        f(s.t + h * c2, tmp, k2);
+        for (std::size_t i = 0; i < N; i++) tmp[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+        f(s.t + h * c3, tmp, k3);
+        for (std::size_t i = 0; i < N; i++) {
+            tmp[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+        }
+        f(s.t + h * c4, tmp, k4);
+        for (std::size_t i = 0; i < N; i++) {
+            tmp[i] = y[i] + h * (a51*k1[i] + a52*k2[i] + a53*k3[i] + a54*k4[i]);
+        }
+        f(s.t + h * c5, tmp, k5);
+        for (std::size_t i = 0; i < N; i++) {
+            tmp[i] = y[i] + h * (a61*k1[i] + a62*k2[i] + a63*k3[i] + a64*k4[i] + a65*k5[i]);
+        }
+        f(s.t + h, tmp, k6);
+
+        for (std::size_t i = 0; i < N; i++) {
+            y5[i] = y[i] + h * (b1*k1[i] + b3*k3[i] + b4*k4[i] + b5*k5[i] + b6*k6[i]);
+        }
+
+        // FSAL stage
+        f(s.t + h, y5, k7);
+        for (std::size_t i = 0; i < N; i++) {
+            y4[i] = y[i] + h * (bs1*k1[i] + bs3*k3[i] + bs4*k4[i] + bs5*k5[i] + bs6*k6[i] + bs7*k7[i]);
+        }
+
+        double error = dopri5_error(y4, y5, config);
+
+        // Every attempt overwrites it; the returned one is the last
+        if (dense) {
+            dense->t0 = s.t;
+            dense->h = h;
+            for (std::size_t i = 0; i < N; i++) {
+                const double ydiff = y5[i] - y[i];
+                const double bspl = h * k1[i] - ydiff;
+                dense->r[0][i] = y[i];
+                dense->r[1][i] = ydiff;
+                dense->r[2][i] = bspl;
+                dense->r[3][i] = ydiff - h * k7[i] - bspl;
+                dense->r[4][i] = h * (d1*k1[i] + d3*k3[i] + d4*k4[i] + d5*k5[i] + d6*k6[i] + d7*k7[i]);
+            }
+        }
+
+        if (error <= 1.0) {
+            double dt_next;
+            if (error < 1e-30) {
+                dt_next = h * 5.0;
+            } else {
+                dt_next = h * config.safety_factor * std::pow(1.0 / error, 0.2);
+            }
+            dt_next = std::min(dt_next, config.dt_max);
+            dt_next = std::max(dt_next, config.dt_min);
+            dt_next = std::min(dt_next, h * 5.0);
+            return FixedStep<N>{FixedState<N>{s.t + h, y5}, h, dt_next, error};
+        }
+
+        double factor = config.safety_factor * std::pow(1.0 / error, 0.25);
+        factor = std::max(factor, 0.1);
+        h *= factor;
+
+        if (h < config.dt_min) {
+            // Step size underflow: accept the last solution at the minimum step
+            return FixedStep<N>{FixedState<N>{s.t + config.dt_min, y5},
+                                config.dt_min, config.dt_min, error};
+        }
+    }
+
+    return FixedStep<N>{s, dt_try, dt_try, 1e10};
+}
+
+/// Dormand-Prince 8(5,3) tableau (Hairer, Norsett & Wanner, DOP853)
+namespace dop853 {
+    constexpr int STAGES = 12;
+
+    constexpr double c[STAGES] = {
+        0.0,
+        0.526001519587677318785587544488e-01,
+        0.789002279381515978178381316732e-01,
+        0.118350341907227396726757197510,
+        0.281649658092772603273242802490,
+        0.333333333333333333333333333333,
+        0.25,
+        0.307692307692307692307692307692,
+        0.651282051282051282051282051282,
+        0.6,
+        0.857142857142857142857142857142,
+        1.0
+    };
+
+    // Strictly lower triangular; zero entries omitted by the stage loop
+    constexpr double a[STAGES][STAGES - 1] = {
+        {},
+        {5.26001519587677318785587544488e-2},
+        {1.97250569845378994544595329183e-2, 5.91751709536136983633785987549e-2},
+        {2.95875854768068491816892993775e-2, 0.0, 8.87627564304205475450678981324e-2},
+        {2.41365134159266685502369798665e-1, 0.0, -8.84549479328286085344864962717e-1,
+         9.24834003261792003115737966543e-1},
+        {3.7037037037037037037037037037e-2, 0.0, 0.0, 1.70828608729473871279604482173e-1,
+         1.25467687566822425016691814123e-1},
+        {3.7109375e-2, 0.0, 0.0, 1.70252211019544039314978060272e-1,
+         6.02165389804559606850219397283e-2, -1.7578125e-2},
+        {3.70920001185047927108779319836e-2, 0.0, 0.0, 1.70383925712239993810214054705e-1,
+         1.07262030446373284651809199168e-1, -1.53194377486244017527936158236e-2,
+         8.27378916381402288758473766002e-3},
+        {6.24110958716075717114429577812e-1, 0.0, 0.0, -3.36089262944694129406857109825,
+         -8.68219346841726006818189891453e-1, 2.75920996994467083049415600797e1,
+         2.01540675504778934086186788979e1, -4.34898841810699588477366255144e1},
+        {4.77662536438264365890433908527e-1, 0.0, 0.0, -2.48811461997166764192642586468,
+         -5.90290826836842996371446475743e-1, 2.12300514481811942347288949897e1,
+         1.52792336328824235832596922938e1, -3.32882109689848629194453265587e1,
+         -2.03312017085086261358222928593e-2},
+        {-9.3714243008598732571704021658e-1, 0.0, 0.0, 5.18637242884406370830023853209,
+         1.09143734899672957818500254654, -8.14978701074692612513997267357,
+         -1.85200656599969598641566180701e1, 2.27394870993505042818970056734e1,
+         2.49360555267965238987089396762, -3.0467644718982195003823669022},
+        {2.27331014751653820792359768449, 0.0, 0.0, -1.05344954667372501984066689879e1,
+         -2.00087205822486249909675718444, -1.79589318631187989172765950534e1,
+         2.79488845294199600508499808837e1, -2.85899827713502369474065508674,
+         -8.87285693353062954433549289258, 1.23605671757943030647266201528e1,
+         6.43392746015763530355970484046e-1}
+    };
+
+    // 8th order weights
+    constexpr double b[STAGES] = {
+        5.42937341165687622380535766363e-2, 0.0, 0.0, 0.0, 0.0,
+        4.45031289275240888144113950566, 1.89151789931450038304281599044,
+        -5.8012039600105847814672114227, 3.1116436695781989440891606237e-1,
+        -1.52160949662516078556178806805e-1, 2.01365400804030348374776537501e-1,
+        4.47106157277725905176885569043e-2
+    };
+
+    // 5th order error weights (b - b5)
+    constexpr double e5[STAGES] = {
+        0.1312004499419488073250102996e-1, 0.0, 0.0, 0.0, 0.0,
+        -0.1225156446376204440720569753e+1, -0.4957589496572501915214079952,
+        0.1664377182454986536961530415e+1, -0.3503288487499736816886487290,
+        0.3341791187130174790297318841, 0.8192320648511571246570742613e-1,
+        -0.2235530786388629525884427845e-1
+    };
+
+    // 3rd order error: b . k - (bhh1 k1 + bhh2 k9 + bhh3 k12)
+    constexpr double bhh1 = 0.244094488188976377952755905512;
+    constexpr double bhh2 = 0.733846688281611857341361741547;
+    constexpr double bhh3 = 0.220588235294117647058823529412e-01;
+}  // namespace dop853
+
+/**
+ * Single DOP853 adaptive step. 12 RHS calls per attempt; the error norm
+ * is Hairer's blend of the 5th and 3rd order estimates, which stays
+ * reliable at the large steps the 8th order solution allows. Same
+ * acceptance/retry structure as dopri5_step, with 1/8 exponents.
+ */
+template <std::size_t N, class Rhs>
+inline FixedStep<N> dop853_step(const FixedState<N>& s, double dt_try, Rhs&& f,
+                                const AdaptiveConfig& config) {
+    using namespace dop853;
+    using Y = std::array<double, N>;
+    const Y& y = s.y;
+    double h = dt_try;
+    Y k[STAGES], tmp, y8;
+
+    f(s.t, y, k[0]);
+
+    for (int attempts = 0; attempts < 100; ++attempts) {
+        h = std::max(h, config.dt_min);
+        h = std::min(h, config.dt_max);
+
+        for (int st = 1; st < STAGES; st++) {
+            for (std::size_t i = 0; i < N; i++) {
+                double acc = 0.0;
+                for (int j = 0; j < st; j++) acc += a[st][j] * k[j][i];
+                tmp[i] = y[i] + h * acc;
+            }
+            f(s.t + c[st] * h, tmp, k[st]);
+        }
+
+        double err5 = 0.0, err3 = 0.0;
+        for (std::size_t i = 0; i < N; i++) {
+            double inc = 0.0, e = 0.0;
+            for (int j = 0; j < STAGES; j++) {
+                inc += b[j] * k[j][i];
+                e += e5[j] * k[j][i];
+            }
+            y8[i] = y[i] + h * inc;
+            const double sk = config.abs_tolerance + config.rel_tolerance *
+                std::max(std::fabs(y[i]), std::fabs(y8[i]));
+            const double e3 = inc - bhh1 * k[0][i] - bhh2 * k[8][i] - bhh3 * k[11][i];
+            err5 += (e / sk) * (e / sk);
+            err3 += (e3 / sk) * (e3 / sk);
+        }
+        double deno = err5 + 0.01 * err3;
+        if (deno <= 0.0) deno = 1.0;
+        const double error = std::fabs(h) * err5 / std::sqrt(static_cast<double>(N) * deno);
+
+        if (error <= 1.0) {
+            double dt_next;
+            if (error < 1e-30) {
+                dt_next = h * 6.0;
+            } else {
+                dt_next = h * config.safety_factor * std::pow(1.0 / error, 0.125);
+            }
+            dt_next = std::min(dt_next, config.dt_max);
+            dt_next = std::max(dt_next, config.dt_min);
+            dt_next = std::min(dt_next, h * 6.0);
+            return FixedStep<N>{FixedState<N>{s.t + h, y8}, h, dt_next, error};
+        }
+
+        double factor = config.safety_factor * std::pow(1.0 / error, 0.125);
+        factor = std::max(factor, 0.1);
+        h *= factor;
+
+        if (h < config.dt_min) {
+            return FixedStep<N>{FixedState<N>{s.t + config.dt_min, y8},
+                                config.dt_min, config.dt_min, error};
+        }
+    }
+
+    return FixedStep<N>{s, dt_try, dt_try, 1e10};
+}
+
+}  // namespace sim
+
+#endif  // SIM_INTEGRATOR_KERNELS_HPP
@@ -0,0 +1,509 @@
+/**
+ * Orbit Determination Implementation
+ */
+
+#include "propagators/orbit_determination.hpp"
+#include "physics/vec3_ops.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+
+namespace {
+
+constexpr double OMEGA_EARTH = 7.2921159e-5;   // [rad/s], GMST = 0 at t = 0
+constexpr double PI = 3.14159265358979323846;
+
+void identity(Matrix6& m) {
+    for (int i = 0; i < 36; i++) m[i] = (i % 7 == 0) ? 1.0 : 0.0;
+}
+
+/// In-place lower Cholesky factor of a symmetric 6x6; false if not positive definite
+bool cholesky(double a[36]) {
+    for (int j = 0; j < 6; j++) {
+        double d = a[j * 6 + j];
+        for (int k = 0; k < j; k++) d -= a[j * 6 + k] * a[j * 6 + k];
+        if (!(d > 0.0)) return false;
+        a[j * 6 + j] = std::sqrt(d);
+        for (int i = j + 1; i < 6; i++) {
+            double v = a[i * 6 + j];
+            for (int k = 0; k < j; k++) v -= a[i * 6 + k] * a[j * 6 + k];
+            a[i * 6 + j] = v / a[j * 6 + j];
+        }
+    }
+    return true;
+}
+
+/// Solve L L^T x = b in place
+void cholesky_solve(const double l[36], double b[6]) {
+    for (int i = 0; i < 6; i++) {
+        double v = b[i];
+        for (int k = 0; k < i; k++) v -= l[i * 6 + k] * b[k];
+        b[i] = v / l[i * 6 + i];
+    }
+    for (int i = 5; i >= 0; i--) {
+        double v = b[i];
+        for (int k = i + 1; k < 6; k++) v -= l[k * 6 + i] * b[k];
+        b[i] = v / l[i * 6 + i];
+    }
+}
+
+/// Inverse of a symmetric positive definite 6x6; false if it is not
+bool invert(const double a[36], double out[36]) {
+    double l[36];
+    std::copy(a, a + 36, l);
+    if (!cholesky(l)) return false;
+    for (int j = 0; j < 6; j++) {
+        double col[6] = {};
+        col[j] = 1.0;
+        cholesky_solve(l, col);
+        for (int i = 0; i < 6; i++) out[i * 6 + j] = col[i];
+    }
+    return true;
+}
+
+bool has_apriori(const Covariance6& p) {
+    for (int i = 0; i < 6; i++) {
+        if (p[i * 7] > 0.0) return true;
+    }
+    return false;
+}
+
+/// Types whose partials touch only position
+bool position_only(OdMeasurement type) {
+    return type != OdMeasurement::RANGE_RATE;
+}
+
+}  // namespace
+
+BatchOrbitDetermination::BatchOrbitDetermination(std::vector<Vec3> stations,
+                                                 const OdConfig& config)
+    : stations_(std::move(stations)), config_(config),
+      dynamics_([&config] {
+          PcConfig pc;
+          pc.include_j2 = config.include_j2;
+          pc.max_step = config.max_step;
+          pc.num_threads = 1;
+          return pc;
+      }()) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+double BatchOrbitDetermination::residual(OdMeasurement type, double observed, double computed) {
+    double r = observed - computed;
+    if (type == OdMeasurement::AZIMUTH || type == OdMeasurement::RIGHT_ASCENSION) {
+        r = std::remainder(r, 2.0 * PI);
+    }
+    return r;
+}
+
+double BatchOrbitDetermination::observe(const OdObservation& obs, const Vec3& position,
+                                        const Vec3& velocity, double* partials) const {
+    // Station in the inertial frame at the observation time
+    const Vec3& site = stations_.at(static_cast<size_t>(obs.station));
+    const double theta = OMEGA_EARTH * obs.time;
+    const double c = std::cos(theta), s = std::sin(theta);
+    const Vec3 R(c * site.x - s * site.y, s * site.x + c * site.y, site.z);
+    const Vec3 V(-OMEGA_EARTH * R.y, OMEGA_EARTH * R.x, 0.0);
+
+    const Vec3 rho = position - R;
+    const Vec3 rho_dot = velocity - V;
+    const double range = rho.norm();
+    const Vec3 u = rho / range;
+
+    double h[6] = {};
+    double value = 0.0;
+    switch (obs.type) {
+        case OdMeasurement::RANGE:
+            value = range;
+            h[0] = u.x; h[1] = u.y; h[2] = u.z;
+            break;
+
+        case OdMeasurement::RANGE_RATE: {
+            value = dot(u, rho_dot);
+            const Vec3 d = (rho_dot - u * value) / range;
+            h[0] = d.x; h[1] = d.y; h[2] = d.z;
+            h[3] = u.x; h[4] = u.y; h[5] = u.z;
+            break;
+        }
+
+        case OdMeasurement::AZIMUTH:
+        case OdMeasurement::ELEVATION: {
+            // Geocentric east-north-up at the station
+            const Vec3 up = R / R.norm();
+            Vec3 east(-up.y, up.x, 0.0);
+            east = east / east.norm();
+            const Vec3 north = cross(up, east);
+            const double e = dot(rho, east), n = dot(rho, north), z = dot(rho, up);
+            const double horiz2 = e * e + n * n;
+            const double horiz = std::sqrt(horiz2);
+            Vec3 d;
+            if (obs.type == OdMeasurement::AZIMUTH) {
+                value = std::atan2(e, n);
+                if (value < 0.0) value += 2.0 * PI;
+                d = (east * n - north * e) / horiz2;
+            } else {
+                value = std::atan2(z, horiz);
+                d = (up * horiz2 - (east * e + north * n) * z) / (range * range * horiz);
+            }
+            h[0] = d.x; h[1] = d.y; h[2] = d.z;
+            break;
+        }
+
+        case OdMeasurement::RIGHT_ASCENSION:
+        case OdMeasurement::DECLINATION: {
+            const double xy2 = rho.x * rho.x + rho.y * rho.y;
+            const double xy = std::sqrt(xy2);
+            if (obs.type == OdMeasurement::RIGHT_ASCENSION) {
+                value = std::atan2(rho.y, rho.x);
+                if (value < 0.0) value += 2.0 * PI;
+                h[0] = -rho.y / xy2;
+                h[1] = rho.x / xy2;
+            } else {
+                value = std::atan2(rho.z, xy);
+                const double k = 1.0 / (range * range * xy);
+                h[0] = -rho.x * rho.z * k;
+                h[1] = -rho.y * rho.z * k;
+                h[2] = xy2 * k;
+            }
+            break;
+        }
+    }
+    if (partials) std::copy(h, h + 6, partials);
+    return value;
+}
+
+void BatchOrbitDetermination::fit_block(const std::vector<OdProblem>& problems,
+                                        const size_t* index, size_t n,
+                                        std::vector<OdResult>& results) const {
+    // Per lane: observations in time order, grouped by distinct time
+    struct Lane {
+        const OdProblem* problem;
+        std::vector<size_t> order;
+        std::vector<size_t> group;        // First row of each distinct time, plus end
+        Vec3 position, velocity;          // Reference epoch state
+        double apriori_info[36];
+        bool apriori = false;
+        bool done = false;
+        double rms = std::numeric_limits<double>::infinity();
+        OdResult result;
+    };
+    std::vector<Lane> lanes(n);
+    size_t rounds = 0;
+    for (size_t l = 0; l < n; l++) {
+        Lane& lane = lanes[l];
+        const OdProblem& p = problems[index[l]];
+        lane.problem = &p;
+        lane.order.resize(p.observations.size());
+        std::iota(lane.order.begin(), lane.order.end(), size_t{0});
+        std::stable_sort(lane.order.begin(), lane.order.end(), [&p](size_t a, size_t b) {
+            return p.observations[a].time < p.observations[b].time;
+        });
+        for (size_t k = 0; k < lane.order.size(); k++) {
+            if (k == 0 || p.observations[lane.order[k]].time != p.observations[lane.order[k - 1]].time) {
+                lane.group.push_back(k);
+            }
+        }
+        rounds = std::max(rounds, lane.group.size());
+        lane.group.push_back(lane.order.size());
+        lane.position = p.position;
+        lane.velocity = p.velocity;
+        lane.apriori = has_apriori(p.apriori) && invert(p.apriori.data(), lane.apriori_info);
+        lane.result.id = p.id;
+        lane.result.epoch = p.epoch;
+        lane.done = p.observations.empty();
+    }
+
+    Vec3 pos[LANES], vel[LANES];
+    Matrix6 step[LANES], phi[LANES];
+    double dt[LANES], t[LANES];
+    double info[LANES][36], normal[LANES][6], chi2[LANES];
+
+    for (int iter = 1; iter <= config_.max_iterations; iter++) {
+        bool any = false;
+        for (size_t l = 0; l < n; l++) {
+            Lane& lane = lanes[l];
+            pos[l] = lane.position;
+            vel[l] = lane.velocity;
+            t[l] = lane.problem->epoch;
+            identity(phi[l]);
+            std::fill(normal[l], normal[l] + 6, 0.0);
+            std::fill(info[l], info[l] + 36, 0.0);
+            chi2[l] = 0.0;
+            if (lane.done) continue;
+            any = true;
+            lane.result.used = lane.result.rejected = 0;
+            if (!lane.apriori) continue;
+
+            // A priori information about the first guess
+            const OdProblem& p = *lane.problem;
+            const double dx[6] = {p.position.x - lane.position.x, p.position.y - lane.position.y,
+                                  p.position.z - lane.position.z, p.velocity.x - lane.velocity.x,
+                                  p.velocity.y - lane.velocity.y, p.velocity.z - lane.velocity.z};
+            for (int i = 0; i < 36; i++) info[l][i] = lane.apriori_info[i];
+            for (int i = 0; i < 6; i++) {
+                for (int j = 0; j < 6; j++) normal[l][i] += lane.apriori_info[i * 6 + j] * dx[j];
+            }
+        }
+        if (!any) break;
+
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t l = 0; l < n; l++) {
+                const Lane& lane = lanes[l];
+                const bool active = !lane.done && r + 1 < lane.group.size();
+                dt[l] = active
+                    ? lane.problem->observations[lane.order[lane.group[r]]].time - t[l] : 0.0;
+            }
+            dynamics_.propagate_stm(n, pos, vel, step, dt);
+
+            for (size_t l = 0; l < n; l++) {
+                Lane& lane = lanes[l];
+                if (lane.done || r + 1 >= lane.group.size()) continue;
+                t[l] += dt[l];
+
+                // Phi(t, t0) = Phi(t, t_prev) Phi(t_prev, t0)
+                Matrix6 chained;
+                for (int i = 0; i < 6; i++) {
+                    for (int j = 0; j < 6; j++) {
+                        double sum = 0.0;
+                        for (int k = 0; k < 6; k++) sum += step[l][i * 6 + k] * phi[l][k * 6 + j];
+                        chained[i * 6 + j] = sum;
+                    }
+                }
+                phi[l] = chained;
+
+                for (size_t k = lane.group[r]; k < lane.group[r + 1]; k++) {
+                    const OdObservation& obs = lane.problem->observations[lane.order[k]];
+                    double h[6];
+                    const double res = residual(obs.type, obs.value, observe(obs, pos[l], vel[l], h));
+                    const double w = 1.0 / (obs.sigma * obs.sigma);
+                    if (iter > 1 && config_.outlier_sigma > 0.0 &&
+                        std::abs(res) > config_.outlier_sigma * obs.sigma * std::max(lane.rms, 1.0)) {
+                        lane.result.rejected++;
+                        continue;
+                    }
+
+                    // H = h Phi; position-only rows skip the velocity half of h
+                    const int nh = position_only(obs.type) ? 3 : 6;
+                    double H[6];
+                    for (int j = 0; j < 6; j++) {
+                        double sum = 0.0;
+                        for (int i = 0; i < nh; i++) sum += h[i] * phi[l][i * 6 + j];
+                        H[j] = sum;
+                    }
+                    for (int i = 0; i < 6; i++) {
+                        const double wh = w * H[i];
+                        for (int j = i; j < 6; j++) info[l][i * 6 + j] += wh * H[j];
+                        normal[l][i] += wh * res;
+                    }
+                    chi2[l] += w * res * res;
+                    lane.result.used++;
+                }
+            }
+        }
+
+        // Solve each lane's normal equations
+        for (size_t l = 0; l < n; l++) {
+            Lane& lane = lanes[l];
+            if (lane.done) continue;
+            OdResult& out = lane.result;
+            out.iterations = iter;
+            for (int i = 0; i < 6; i++) {
+                for (int j = 0; j < i; j++) info[l][i * 6 + j] = info[l][j * 6 + i];
+            }
+            double factor[36];
+            std::copy(info[l], info[l] + 36, factor);
+            if (!cholesky(factor)) {
+                lane.done = true;                 // Unobservable with these rows
+                continue;
+            }
+            double dx[6];
+            std::copy(normal[l], normal[l] + 6, dx);
+            cholesky_solve(factor, dx);
+            lane.position = lane.position + Vec3(dx[0], dx[1], dx[2]);
+            lane.velocity = lane.velocity + Vec3(dx[3], dx[4], dx[5]);
+            lane.rms = out.used > 0 ? std::sqrt(chi2[l] / out.used) : 0.0;
+            out.rms = lane.rms;
+            out.position = lane.position;
+            out.velocity = lane.velocity;
+            invert(info[l], out.covariance.data());
+            if (Vec3(dx[0], dx[1], dx[2]).norm() < config_.tolerance) {
+                out.converged = true;
+                lane.done = true;
+            }
+        }
+    }
+
+    for (size_t l = 0; l < n; l++) results[index[l]] = lanes[l].result;
+}
+
+std::vector<OdResult> BatchOrbitDetermination::fit(const std::vector<OdProblem>& problems) const {
+    std::vector<OdResult> results(problems.size());
+    if (problems.empty()) return results;
+
+    // Similar observation counts share a block, so lanes finish together
+    std::vector<size_t> index(problems.size());
+    std::iota(index.begin(), index.end(), size_t{0});
+    std::stable_sort(index.begin(), index.end(), [&problems](size_t a, size_t b) {
+        return problems[a].observations.size() < problems[b].observations.size();
+    });
+
+    const size_t blocks = (problems.size() + LANES - 1) / LANES;
+    auto block = [&](size_t b) {
+        const size_t first = b * LANES;
+        fit_block(problems, index.data() + first, std::min(LANES, problems.size() - first), results);
+    };
+    if (pool_ && blocks > 1) {
+        pool_->parallel_for(blocks, block);
+    } else {
+        for (size_t b = 0; b < blocks; b++) block(b);
+    }
+    return results;
+}
+
+OdResult BatchOrbitDetermination::fit(const OdProblem& problem) const {
+    return fit(std::vector<OdProblem>{problem}).front();
+}
+
+std::vector<OdResult> BatchOrbitDetermination::filter(const std::vector<OdProblem>& problems) const {
+    for (const OdProblem& p : problems) {
+        if (!has_apriori(p.apriori)) {
+            throw std::invalid_argument("BatchOrbitDetermination::filter: problem " +
+                                        std::to_string(p.id) + " has no a priori covariance");
+        }
+    }
+
+    std::vector<OdResult> results(problems.size());
+    auto one = [&](size_t k) {
+        const OdProblem& p = problems[k];
+        std::vector<size_t> order(p.observations.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&p](size_t a, size_t b) {
+            return p.observations[a].time < p.observations[b].time;
+        });
+
+        OrbitTracker tracker(*this, p.epoch, p.position, p.velocity, p.apriori);
+        OdResult& out = results[k];
+        out.id = p.id;
+        double chi2 = 0.0;
+        for (size_t i : order) {
+            const OdObservation& obs = p.observations[i];
+            tracker.predict(obs.time);
+            const double res = residual(obs.type, obs.value,
+                                        observe(obs, tracker.position(), tracker.velocity(), nullptr));
+            if (tracker.update(obs)) {
+                chi2 += res * res / (obs.sigma * obs.sigma);
+                out.used++;
+            } else {
+                out.rejected++;
+            }
+        }
+        out.converged = true;
+        out.iterations = 1;
+        out.epoch = tracker.time();
+        out.position = tracker.position();
+        out.velocity = tracker.velocity();
+        out.covariance = tracker.covariance();
+        out.rms = out.used > 0 ? std::sqrt(chi2 / out.used) : 0.0;
+    };
+    if (pool_ && problems.size() > 1) {
+        pool_->parallel_for(problems.size(), one);
+    } else {
+        for (size_t k = 0; k < problems.size(); k++) one(k);
+    }
+    return results;
+}
+
+OrbitTracker::OrbitTracker(const BatchOrbitDetermination& od, double time, const Vec3& position,
+                           const Vec3& velocity, const Covariance6& covariance)
+    : od_(od), time_(time), position_(position), velocity_(velocity), covariance_(covariance) {}
+
+void OrbitTracker::predict(double time) {
+    double dt = time - time_;
+    if (dt == 0.0) return;
+    Matrix6 phi;
+    od_.dynamics().propagate_stm(1, &position_, &velocity_, &phi, &dt);
+    time_ = time;
+
+    // P = Phi P Phi^T + Q (white acceleration noise)
+    double phi_p[36];
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < 6; k++) sum += phi[i * 6 + k] * covariance_[k * 6 + j];
+            phi_p[i * 6 + j] = sum;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < 6; k++) sum += phi_p[i * 6 + k] * phi[j * 6 + k];
+            covariance_[i * 6 + j] = sum;
+        }
+    }
+    const double q = od_.config().process_noise;
+    if (q > 0.0) {
+        const double a = std::abs(dt);
+        for (int i = 0; i < 3; i++) {
+            covariance_[i * 7] += q * a * a * a / 3.0;
+            covariance_[(i + 3) * 7] += q * a;
+            covariance_[i * 6 + i + 3] += q * a * a / 2.0;
+            covariance_[(i + 3) * 6 + i] += q * a * a / 2.0;
+        }
+    }
+}
+
+bool OrbitTracker::update(const OdObservation& obs) {
+    predict(obs.time);
+    double h[6];
+    const double computed = od_.observe(obs, position_, velocity_, h);
+    const double res = BatchOrbitDetermination::residual(obs.type, obs.value, computed);
+
+    // Innovation variance and gate
+    double ph[6];
+    for (int i = 0; i < 6; i++) {
+        double sum = 0.0;
+        for (int j = 0; j < 6; j++) sum += covariance_[i * 6 + j] * h[j];
+        ph[i] = sum;
+    }
+    const double r = obs.sigma * obs.sigma;
+    double s = r;
+    for (int i = 0; i < 6; i++) s += h[i] * ph[i];
+    const double gate = od_.config().outlier_sigma;
+    if (gate > 0.0 && res * res > gate * gate * s) return false;
+
+    double k[6];
+    for (int i = 0; i < 6; i++) k[i] = ph[i] / s;
+    position_ = position_ + Vec3(k[0], k[1], k[2]) * res;
+    velocity_ = velocity_ + Vec3(k[3], k[4], k[5]) * res;
+
+    // Joseph form: (I - K h) P (I - K h)^T + K r K^T
+    double a[36], ap[36];
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) a[i * 6 + j] = (i == j ? 1.0 : 0.0) - k[i] * h[j];
+    }
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) {
+            double sum = 0.0;
+            for (int m = 0; m < 6; m++) sum += a[i * 6 + m] * covariance_[m * 6 + j];
+            ap[i * 6 + j] = sum;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        for (int j = i; j < 6; j++) {
+            double sum = k[i] * r * k[j];
+            for (int m = 0; m < 6; m++) sum += ap[i * 6 + m] * a[j * 6 + m];
+            covariance_[i * 6 + j] = covariance_[j * 6 + i] = sum;
+        }
+    }
+    return true;
+}
+
+}  // namespace sim
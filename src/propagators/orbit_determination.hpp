@@ -0,0 +1,177 @@
+/**
+ * Orbit Determination — batch least squares and EKF from tracking data
+ *
+ * Fits orbits to radar and optical observations from ground stations, for
+ * catalog maintenance runs that need thousands of fits per simulated day.
+ *
+ * Observations are scalars: range, range rate, azimuth, elevation
+ * (radar), or topocentric right ascension and declination (optical). Each
+ * has its own time, station and sigma; a radar track is simply range, az
+ * and el rows at one time. Stations are Earth-fixed and rotate into the
+ * inertial frame with GMST = 0 at t = 0 (as MCWorld). There is no light
+ * time or refraction.
+ *
+ * Dynamics and partials come from CollisionProbability::propagate_stm():
+ * two-body plus J2, integrated with the state transition matrix.
+ *
+ *   Batch  Gauss-Newton on the epoch state (Tapley, Schutz & Born 4.6).
+ *          Each iteration propagates the reference orbit through the
+ *          object's observation times, chaining Phi(t_k, t0). Each row's
+ *          partials H = h(x) Phi are accumulated into the normal equations.
+ *          Range, azimuth / elevation and RA / Dec rows depend only on
+ *          position, so they use the top three rows of Phi. Only the upper
+ *          triangle of the 6x6 information matrix is accumulated. An a
+ *          priori covariance adds its information. After the first
+ *          iteration, rows beyond outlier_sigma (in sigmas, scaled by the
+ *          previous weighted RMS) are edited out.
+ *   Filter Extended Kalman filter for continuous tracking (OrbitTracker):
+ *          predict with the STM plus state noise compensation (white
+ *          acceleration of process_noise PSD), then a scalar Joseph-form
+ *          update per observation with the same innovation gate.
+ *
+ * fit() takes many independent objects. Objects are sorted by observation
+ * count and fitted in blocks of LANES, whose orbits and STMs propagate
+ * together as vector lanes (each lane to its own next time). Blocks are
+ * spread over a thread pool, and each object's result does not depend on
+ * the thread count.
+ */
+
+#ifndef SIM_ORBIT_DETERMINATION_HPP
+#define SIM_ORBIT_DETERMINATION_HPP
+
+#include "propagators/collision_probability.hpp"
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+enum class OdMeasurement {
+    RANGE,               // [m]
+    RANGE_RATE,          // [m/s]
+    AZIMUTH,             // [rad] from north through east
+    ELEVATION,           // [rad] above the station's geocentric horizon
+    RIGHT_ASCENSION,     // [rad] topocentric, inertial frame
+    DECLINATION          // [rad]
+};
+
+struct OdObservation {
+    double time = 0.0;                 // [s]
+    int station = 0;                   // Index into the stations
+    OdMeasurement type = OdMeasurement::RANGE;
+    double value = 0.0;
+    double sigma = 1.0;                // Same units as value
+};
+
+/// One object to fit
+struct OdProblem {
+    int id = 0;
+    double epoch = 0.0;                // Solve-for epoch [s]
+    Vec3 position;                     // A priori / initial guess at epoch [m]
+    Vec3 velocity;                     // [m/s]
+    Covariance6 apriori{};             // All zero: no a priori information
+    std::vector<OdObservation> observations;
+};
+
+struct OdConfig {
+    bool include_j2 = true;
+    double max_step = 30.0;            // RK4 step bound [s]
+    int max_iterations = 10;
+    double tolerance = 1e-3;           // Converged below this position correction [m]
+    double outlier_sigma = 0.0;        // Innovation / residual gate; 0 = keep all
+    double process_noise = 0.0;        // Filter acceleration PSD [m^2/s^3]
+    int num_threads = 0;               // 0 = hardware concurrency, 1 = serial
+};
+
+struct OdResult {
+    int id = 0;
+    bool converged = false;
+    int iterations = 0;
+    double epoch = 0.0;                // Of the state below [s]
+    Vec3 position;
+    Vec3 velocity;
+    Covariance6 covariance{};
+    double rms = 0.0;                  // Weighted RMS of the used residuals
+    size_t used = 0;
+    size_t rejected = 0;
+};
+
+class BatchOrbitDetermination {
+public:
+    static constexpr size_t LANES = CollisionProbability::LANES;
+
+    /**
+     * @param stations Earth-fixed station positions [m]
+     */
+    explicit BatchOrbitDetermination(std::vector<Vec3> stations,
+                                     const OdConfig& config = OdConfig());
+
+    /** Batch least-squares fits, in input order */
+    std::vector<OdResult> fit(const std::vector<OdProblem>& problems) const;
+    OdResult fit(const OdProblem& problem) const;
+
+    /**
+     * EKF passes from each problem's a priori (required) through its
+     * observations in time order; the result is at the last observation
+     * @throws std::invalid_argument if a problem has no a priori covariance
+     */
+    std::vector<OdResult> filter(const std::vector<OdProblem>& problems) const;
+
+    /**
+     * Predicted observation for a state, and its partials d/d(position,
+     * velocity) in `partials` (may be null)
+     */
+    double observe(const OdObservation& obs, const Vec3& position, const Vec3& velocity,
+                   double* partials) const;
+
+    /// Observation minus prediction; angles wrapped to (-pi, pi]
+    static double residual(OdMeasurement type, double observed, double computed);
+
+    const OdConfig& config() const { return config_; }
+    const CollisionProbability& dynamics() const { return dynamics_; }
+
+private:
+    std::vector<Vec3> stations_;
+    OdConfig config_;
+    CollisionProbability dynamics_;      // Serial; STM propagation only
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+
+    void fit_block(const std::vector<OdProblem>& problems, const size_t* index, size_t n,
+                   std::vector<OdResult>& results) const;
+};
+
+/**
+ * Sequential (EKF) orbit estimate for one object, updated as observations
+ * arrive in time order
+ */
+class OrbitTracker {
+public:
+    OrbitTracker(const BatchOrbitDetermination& od, double time, const Vec3& position,
+                 const Vec3& velocity, const Covariance6& covariance);
+
+    /** Propagate state and covariance (with process noise) to `time` */
+    void predict(double time);
+
+    /**
+     * Predict to the observation's time and apply it
+     * @return false if the innovation gate rejected it
+     */
+    bool update(const OdObservation& obs);
+
+    double time() const { return time_; }
+    const Vec3& position() const { return position_; }
+    const Vec3& velocity() const { return velocity_; }
+    const Covariance6& covariance() const { return covariance_; }
+
+private:
+    const BatchOrbitDetermination& od_;
+    double time_;
+    Vec3 position_;
+    Vec3 velocity_;
+    Covariance6 covariance_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_ORBIT_DETERMINATION_HPP
@@ -0,0 +1,297 @@
+/**
+ * Orbit Integrator Implementation
+ */
+
+#include "orbit_integrator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+using Y6 = std::array<double, 6>;
+
+// Counting first-order RHS over an acceleration model
+struct Rhs6 {
+    const AccelerationFunction& accel;
+    long& calls;
+    void operator()(double t, const Y6& y, Y6& dydt) const {
+        calls++;
+        Vec3 a = accel(t, Vec3(y[0], y[1], y[2]), Vec3(y[3], y[4], y[5]));
+        dydt = {y[3], y[4], y[5], a.x, a.y, a.z};
+    }
+};
+
+template <class Stepper>
+OrbitState6 adaptive_loop(const OrbitState6& initial, double duration,
+                          const AdaptiveConfig& config, long& steps, Stepper&& step) {
+    OrbitState6 s = initial;
+    const double t_end = initial.t + duration;
+    double dt = std::max(std::min(duration * 0.001, config.dt_max), config.dt_min);
+    for (int n = 0; s.t < t_end && n < config.max_steps; n++) {
+        double dt_try = std::min(dt, t_end - s.t);
+        if (dt_try < 1e-10) break;
+        FixedStep<6> r = step(s, dt_try);
+        s = r.state;
+        dt = r.dt_next;
+        steps++;
+    }
+    return s;
+}
+
+// One DOP853 step of exactly h (tolerances ignored)
+OrbitState6 dop853_fixed(const OrbitState6& s, double h, const Rhs6& f) {
+    AdaptiveConfig c;
+    c.dt_min = c.dt_max = h;
+    return dop853_step(s, h, f, c).state;
+}
+
+// Runge-Kutta-Nystrom 4th order (Nystrom's scheme) for r'' = a(t, r, v)
+OrbitState6 rkn4_step(const OrbitState6& s, double h, const AccelerationFunction& accel,
+                      bool velocity_dependent, long& calls) {
+    const Vec3 r(s.y[0], s.y[1], s.y[2]);
+    const Vec3 v(s.y[3], s.y[4], s.y[5]);
+    const double h2 = h * h;
+
+    Vec3 k1 = accel(s.t, r, v);
+    Vec3 rm(r.x + 0.5 * h * v.x + h2 / 8.0 * k1.x,
+            r.y + 0.5 * h * v.y + h2 / 8.0 * k1.y,
+            r.z + 0.5 * h * v.z + h2 / 8.0 * k1.z);
+    Vec3 k2 = accel(s.t + 0.5 * h, rm,
+                    Vec3(v.x + 0.5 * h * k1.x, v.y + 0.5 * h * k1.y, v.z + 0.5 * h * k1.z));
+    Vec3 k3 = velocity_dependent
+        ? accel(s.t + 0.5 * h, rm,
+                Vec3(v.x + 0.5 * h * k2.x, v.y + 0.5 * h * k2.y, v.z + 0.5 * h * k2.z))
+        : k2;
+    Vec3 k4 = accel(s.t + h,
+                    Vec3(r.x + h * v.x + 0.5 * h2 * k3.x,
+                         r.y + h * v.y + 0.5 * h2 * k3.y,
+                         r.z + h * v.z + 0.5 * h2 * k3.z),
+                    Vec3(v.x + h * k3.x, v.y + h * k3.y, v.z + h * k3.z));
+    calls += velocity_dependent ? 4 : 3;
+
+    OrbitState6 out;
+    out.t = s.t + h;
+    out.y = {
+        r.x + h * v.x + h2 / 6.0 * (k1.x + k2.x + k3.x),
+        r.y + h * v.y + h2 / 6.0 * (k1.y + k2.y + k3.y),
+        r.z + h * v.z + h2 / 6.0 * (k1.z + k2.z + k3.z),
+        v.x + h / 6.0 * (k1.x + 2.0 * k2.x + 2.0 * k3.x + k4.x),
+        v.y + h / 6.0 * (k1.y + 2.0 * k2.y + 2.0 * k3.y + k4.y),
+        v.z + h / 6.0 * (k1.z + 2.0 * k2.z + 2.0 * k3.z + k4.z)
+    };
+    return out;
+}
+
+// Yoshida (1990) composition weights of the 2nd order leapfrog
+constexpr double Y4_W1 = 1.35120719195965763405;      // 1 / (2 - 2^(1/3))
+constexpr double Y4_W0 = -1.70241438391931526810;     // 1 - 2 w1
+constexpr double YOSHIDA4[] = {Y4_W1, Y4_W0, Y4_W1};
+
+constexpr double Y6_W1 = -1.17767998417887;
+constexpr double Y6_W2 = 0.235573213359357;
+constexpr double Y6_W3 = 0.784513610477560;
+constexpr double Y6_W0 = 1.0 - 2.0 * (Y6_W1 + Y6_W2 + Y6_W3);
+constexpr double YOSHIDA6[] = {Y6_W3, Y6_W2, Y6_W1, Y6_W0, Y6_W1, Y6_W2, Y6_W3};
+
+// Drift-kick-drift substeps; time drifts with position
+template <std::size_t K>
+OrbitState6 yoshida_step(const OrbitState6& s, double h, const double (&w)[K],
+                         const AccelerationFunction& accel, long& calls) {
+    OrbitState6 out = s;
+    Vec3 r(s.y[0], s.y[1], s.y[2]);
+    Vec3 v(s.y[3], s.y[4], s.y[5]);
+    double t = s.t;
+    for (std::size_t i = 0; i < K; i++) {
+        const double c = w[i] * h;
+        r = Vec3(r.x + 0.5 * c * v.x, r.y + 0.5 * c * v.y, r.z + 0.5 * c * v.z);
+        t += 0.5 * c;
+        Vec3 a = accel(t, r, v);
+        v = Vec3(v.x + c * a.x, v.y + c * a.y, v.z + c * a.z);
+        r = Vec3(r.x + 0.5 * c * v.x, r.y + 0.5 * c * v.y, r.z + 0.5 * c * v.z);
+        t += 0.5 * c;
+    }
+    calls += static_cast<long>(K);
+    out.t = s.t + h;
+    out.y = {r.x, r.y, r.z, v.x, v.y, v.z};
+    return out;
+}
+
+// Adams-Bashforth / Adams-Moulton weights on f(n-i) / f(n+1-i) from the
+// backward-difference coefficients
+constexpr int ABM_ORDER = 8;
+
+struct AdamsWeights {
+    double ab[ABM_ORDER];
+    double am[ABM_ORDER];
+};
+
+const AdamsWeights& adams_weights() {
+    static const AdamsWeights w = [] {
+        const double gamma[ABM_ORDER] = {
+            1.0, 1.0 / 2.0, 5.0 / 12.0, 3.0 / 8.0, 251.0 / 720.0, 95.0 / 288.0,
+            19087.0 / 60480.0, 5257.0 / 17280.0
+        };
+        const double gamma_star[ABM_ORDER] = {
+            1.0, -1.0 / 2.0, -1.0 / 12.0, -1.0 / 24.0, -19.0 / 720.0, -3.0 / 160.0,
+            -863.0 / 60480.0, -275.0 / 24192.0
+        };
+        AdamsWeights out{};
+        for (int i = 0; i < ABM_ORDER; i++) {
+            double binom = 1.0;  // C(j, i), j starting at i
+            double sign = (i % 2 == 0) ? 1.0 : -1.0;
+            for (int j = i; j < ABM_ORDER; j++) {
+                out.ab[i] += sign * binom * gamma[j];
+                out.am[i] += sign * binom * gamma_star[j];
+                binom = binom * (j + 1) / (j + 1 - i);
+            }
+        }
+        return out;
+    }();
+    return w;
+}
+
+OrbitState6 abm8(const OrbitState6& initial, int n_steps, double h, const Rhs6& f, long& steps) {
+    const AdamsWeights& w = adams_weights();
+
+    // f history, newest first
+    Y6 hist[ABM_ORDER]{};
+    OrbitState6 s = initial;
+    f(s.t, s.y, hist[0]);
+
+    // Start-up: DOP853 steps of the same size
+    int n = 0;
+    for (; n < std::min(ABM_ORDER - 1, n_steps); n++) {
+        s = dop853_fixed(s, h, f);
+        for (int i = ABM_ORDER - 1; i > 0; i--) hist[i] = hist[i - 1];
+        f(s.t, s.y, hist[0]);
+        steps++;
+    }
+
+    Y6 pred, fp;
+    for (; n < n_steps; n++) {
+        // Predict
+        for (int c = 0; c < 6; c++) {
+            double acc = 0.0;
+            for (int i = 0; i < ABM_ORDER; i++) acc += w.ab[i] * hist[i][c];
+            pred[c] = s.y[c] + h * acc;
+        }
+        // Evaluate, correct
+        f(s.t + h, pred, fp);
+        for (int c = 0; c < 6; c++) {
+            double acc = w.am[0] * fp[c];
+            for (int i = 1; i < ABM_ORDER; i++) acc += w.am[i] * hist[i - 1][c];
+            s.y[c] += h * acc;
+        }
+        s.t += h;
+        // Evaluate
+        for (int i = ABM_ORDER - 1; i > 0; i--) hist[i] = hist[i - 1];
+        f(s.t, s.y, hist[0]);
+        steps++;
+    }
+    return s;
+}
+
+} // namespace
+
+OrbitState6 OrbitIntegrator::propagate(
+    const OrbitState6& initial,
+    double duration,
+    const AccelerationFunction& accel,
+    const IntegratorOptions& options,
+    IntegratorStats* stats) {
+
+    IntegratorStats local;
+    IntegratorStats& st = stats ? *stats : local;
+    if (duration <= 0.0) return initial;
+
+    Rhs6 f{accel, st.rhs_calls};
+    const AdaptiveConfig& config = options.adaptive;
+
+    switch (options.method) {
+        case IntegrationMethod::DOPRI5:
+            return adaptive_loop(initial, duration, config, st.steps,
+                [&](const OrbitState6& s, double dt) { return dopri5_step(s, dt, f, config); });
+        case IntegrationMethod::DOP853:
+            return adaptive_loop(initial, duration, config, st.steps,
+                [&](const OrbitState6& s, double dt) { return dop853_step(s, dt, f, config); });
+        default:
+            break;
+    }
+
+    const int n_steps = std::max(1, static_cast<int>(std::ceil(duration / options.step - 1e-9)));
+    const double h = duration / n_steps;
+
+    if (options.method == IntegrationMethod::ABM8) {
+        return abm8(initial, n_steps, h, f, st.steps);
+    }
+
+    OrbitState6 s = initial;
+    for (int n = 0; n < n_steps; n++) {
+        switch (options.method) {
+            case IntegrationMethod::RK4:
+                s = rk4_step(s, h, f);
+                break;
+            case IntegrationMethod::RKN4:
+                s = rkn4_step(s, h, accel, options.velocity_dependent, st.rhs_calls);
+                break;
+            case IntegrationMethod::YOSHIDA4:
+                s = yoshida_step(s, h, YOSHIDA4, accel, st.rhs_calls);
+                break;
+            default:
+                s = yoshida_step(s, h, YOSHIDA6, accel, st.rhs_calls);
+                break;
+        }
+        st.steps++;
+    }
+    // Land exactly on the end time
+    s.t = initial.t + duration;
+    return s;
+}
+
+StateVector OrbitIntegrator::propagate(
+    const StateVector& initial,
+    double duration,
+    const AccelerationFunction& accel,
+    const IntegratorOptions& options,
+    IntegratorStats* stats) {
+
+    OrbitState6 s{initial.time, {initial.position.x, initial.position.y, initial.position.z,
+                                 initial.velocity.x, initial.velocity.y, initial.velocity.z}};
+    OrbitState6 r = propagate(s, duration, accel, options, stats);
+
+    StateVector out = initial;
+    out.position = Vec3(r.y[0], r.y[1], r.y[2]);
+    out.velocity = Vec3(r.y[3], r.y[4], r.y[5]);
+    out.time = r.t;
+    return out;
+}
+
+const char* OrbitIntegrator::method_name(IntegrationMethod method) {
+    switch (method) {
+        case IntegrationMethod::RK4:      return "rk4";
+        case IntegrationMethod::DOPRI5:   return "dopri5";
+        case IntegrationMethod::DOP853:   return "dop853";
+        case IntegrationMethod::RKN4:     return "rkn4";
+        case IntegrationMethod::YOSHIDA4: return "yoshida4";
+        case IntegrationMethod::YOSHIDA6: return "yoshida6";
+        case IntegrationMethod::ABM8:     return "abm8";
+    }
+    return "unknown";
+}
+
+bool OrbitIntegrator::parse_method(const std::string& name, IntegrationMethod& method) {
+    for (IntegrationMethod m : {IntegrationMethod::RK4, IntegrationMethod::DOPRI5,
+                                IntegrationMethod::DOP853, IntegrationMethod::RKN4,
+                                IntegrationMethod::YOSHIDA4, IntegrationMethod::YOSHIDA6,
+                                IntegrationMethod::ABM8}) {
+        if (name == method_name(m)) {
+            method = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace sim
@@ -1,60 +1,33 @@
 #include "propagators/rk4_integrator.hpp"
+#include "propagators/integrator_kernels.hpp"
 
 namespace sim {
 
 StateVector RK4Integrator::step(const StateVector& state, 
                                  double dt, 
                                  DerivativeFunction compute_derivatives) {
-    // Classic RK4: y(t+dt) = y(t) + (k1 + 2*k2 + 2*k3 + k4) / 6
-    
-    // k1 = f(t, y)
-    StateVector k1 = compute_derivatives(state);
-    
-    // k2 = f(t + dt/2, y + k1*dt/2)
-    StateVector state_k2 = add_scaled(state, k1, dt / 2.0);
-    StateVector k2 = compute_derivatives(state_k2);
-    
-    // k3 = f(t + dt/2, y + k2*dt/2)
-    StateVector state_k3 = add_scaled(state, k2, dt / 2.0);
-    StateVector k3 = compute_derivatives(state_k3);
-    
-    // k4 = f(t + dt, y + k3*dt)
-    StateVector state_k4 = add_scaled(state, k3, dt);
-    StateVector k4 = compute_derivatives(state_k4);
-    
-    // Combine: new_state = state + dt * (k1 + 2*k2 + 2*k3 + k4) / 6
+    // Classic RK4 via the kernel; intermediate stages carry the caller's
+    // attitude and frame so the derivative function sees what it used to
+    StateVector stage = state;
+    auto rhs = [&](double t, const std::array<double, 6>& y, std::array<double, 6>& dydt) {
+        stage.position = Vec3(y[0], y[1], y[2]);
+        stage.velocity = Vec3(y[3], y[4], y[5]);
+        stage.time = t;
+        StateVector d = compute_derivatives(stage);
+        // For derivatives, velocity is stored in velocity field, acceleration in position field
+        dydt = {d.velocity.x, d.velocity.y, d.velocity.z,
+                d.position.x, d.position.y, d.position.z};
+    };
+
+    OrbitState6 s{state.time, {state.position.x, state.position.y, state.position.z,
+                               state.velocity.x, state.velocity.y, state.velocity.z}};
+    OrbitState6 out = rk4_step(s, dt, rhs);
+
     StateVector new_state = state;
-    
-    new_state.position.x += dt * (k1.velocity.x + 2*k2.velocity.x + 2*k3.velocity.x + k4.velocity.x) / 6.0;
-    new_state.position.y += dt * (k1.velocity.y + 2*k2.velocity.y + 2*k3.velocity.y + k4.velocity.y) / 6.0;
-    new_state.position.z += dt * (k1.velocity.z + 2*k2.velocity.z + 2*k3.velocity.z + k4.velocity.z) / 6.0;
-    
-    // For derivatives, velocity is stored in velocity field, acceleration in position field
-    new_state.velocity.x += dt * (k1.position.x + 2*k2.position.x + 2*k3.position.x + k4.position.x) / 6.0;
-    new_state.velocity.y += dt * (k1.position.y + 2*k2.position.y + 2*k3.position.y + k4.position.y) / 6.0;
-    new_state.velocity.z += dt * (k1.position.z + 2*k2.position.z + 2*k3.position.z + k4.position.z) / 6.0;
-    
-    new_state.time += dt;
-    
+    new_state.position = Vec3(out.y[0], out.y[1], out.y[2]);
+    new_state.velocity = Vec3(out.y[3], out.y[4], out.y[5]);
+    new_state.time = out.t;
     return new_state;
 }
 
-StateVector RK4Integrator::add_scaled(const StateVector& s1, const StateVector& s2, double scale) {
-    StateVector result = s1;
-    
-    // Add scaled velocity (for position update)
-    result.position.x += s2.velocity.x * scale;
-    result.position.y += s2.velocity.y * scale;
-    result.position.z += s2.velocity.z * scale;
-    
-    // Add scaled acceleration (stored in position field of derivative, for velocity update)
-    result.velocity.x += s2.position.x * scale;
-    result.velocity.y += s2.position.y * scale;
-    result.velocity.z += s2.position.z * scale;
-    
-    result.time += scale;
-    
-    return result;
-}
-
 } // namespace sim
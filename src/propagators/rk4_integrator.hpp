@@ -11,6 +11,9 @@ namespace sim {
  * 
  * Provides accurate numerical integration for orbital dynamics
  * Much more stable than simple Euler integration
+ *
+ * std::function wrapper over rk4_step() (integrator_kernels.hpp); hot
+ * loops should call the kernel with their own RHS functor instead.
  */
 class RK4Integrator {
 public:
@@ -34,9 +37,6 @@ public:
                            double dt, 
                            DerivativeFunction compute_derivatives);
 
-private:
-    // Helper to add two state vectors (for RK4 intermediate steps)
-    static StateVector add_scaled(const StateVector& s1, const StateVector& s2, double scale);
 };
 
 } // namespace sim
@@ -0,0 +1,416 @@
+/**
+ * Sensor Tasking Implementation
+ */
+
+#include "propagators/sensor_tasking.hpp"
+#include "physics/kepler_fg.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEG = PI / 180.0;
+constexpr double WGS84_A = 6378137.0;
+constexpr double WGS84_E2 = 6.69437999014e-3;
+constexpr double MU = 3.986004418e14;
+constexpr uint32_t NONE = UINT32_MAX;
+
+/** Greenwich mean sidereal angle at a Julian date [rad] (as AccessPlanner) */
+double gmst(double jd) {
+    double deg = std::fmod(280.46061837 + 360.98564736629 * (jd - 2451545.0), 360.0);
+    if (deg < 0.0) deg += 360.0;
+    return deg * DEG;
+}
+
+void site_ecef(const GroundStation& gs, double p[3]) {
+    const double lat = gs.latitude * DEG, lon = gs.longitude * DEG;
+    const double sl = std::sin(lat), cl = std::cos(lat);
+    const double N = WGS84_A / std::sqrt(1.0 - WGS84_E2 * sl * sl);
+    p[0] = (N + gs.altitude) * cl * std::cos(lon);
+    p[1] = (N + gs.altitude) * cl * std::sin(lon);
+    p[2] = (N * (1.0 - WGS84_E2) + gs.altitude) * sl;
+}
+
+void normalize(double a[3]) {
+    const double len = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    for (int k = 0; k < 3; k++) a[k] /= len;
+}
+
+void cross(const double a[3], const double b[3], double out[3]) {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+double dot(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/**
+ * Position rows of the Clohessy-Wiltshire transition matrix over t at mean
+ * motion n, RIC [radial, in-track, cross-track]
+ */
+void cw_position_rows(double n, double t, double phi[3][6]) {
+    const double nt = n * t, s = std::sin(nt), c = std::cos(nt);
+    const double rows[3][6] = {
+        {4.0 - 3.0 * c, 0.0, 0.0, s / n, 2.0 * (1.0 - c) / n, 0.0},
+        {6.0 * (s - nt), 1.0, 0.0, -2.0 * (1.0 - c) / n, (4.0 * s - 3.0 * nt) / n, 0.0},
+        {0.0, 0.0, c, 0.0, 0.0, s / n}};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 6; j++) phi[i][j] = rows[i][j];
+    }
+}
+
+/// One possible track, with its whitened measurement rows in the epoch RIC frame
+struct Candidate {
+    uint32_t object;
+    uint32_t sensor;
+    uint32_t slot;
+    int rows;                 // 3 radar, 2 optical; 0 = unusable
+    double jd;
+    double h[3][6];
+};
+
+/// Lazy greedy heap entry
+struct Entry {
+    double gain;
+    uint32_t candidate;
+    uint32_t version;         // Object version the gain was evaluated at
+};
+
+/// Max-heap order; ties go to the lower candidate index
+bool heap_less(const Entry& a, const Entry& b) {
+    return a.gain < b.gain || (a.gain == b.gain && a.candidate > b.candidate);
+}
+
+/** H P and S = I + H P H^T, S factored in place (lower Cholesky) */
+void innovation(const Candidate& c, const Covariance6& P, double hp[3][6], double S[3][3]) {
+    const int m = c.rows;
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < 6; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < 6; k++) sum += c.h[i][k] * P[k * 6 + j];
+            hp[i][j] = sum;
+        }
+    }
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j <= i; j++) {
+            double sum = (i == j) ? 1.0 : 0.0;
+            for (int k = 0; k < 6; k++) sum += hp[i][k] * c.h[j][k];
+            S[i][j] = sum;
+        }
+    }
+    for (int j = 0; j < m; j++) {
+        double d = S[j][j];
+        for (int k = 0; k < j; k++) d -= S[j][k] * S[j][k];
+        S[j][j] = std::sqrt(std::max(d, 1.0));   // S >= I
+        for (int i = j + 1; i < m; i++) {
+            double v = S[i][j];
+            for (int k = 0; k < j; k++) v -= S[i][k] * S[j][k];
+            S[i][j] = v / S[j][j];
+        }
+    }
+}
+
+/** Weighted information gain (1/2) log det(I + H P H^T) [nats] */
+double gain(const Candidate& c, const Covariance6& P, double priority) {
+    double hp[3][6], S[3][3];
+    innovation(c, P, hp, S);
+    double log_det = 0.0;
+    for (int i = 0; i < c.rows; i++) log_det += std::log(S[i][i]);
+    return priority * log_det;             // sum log diag(L) = (1/2) log det S
+}
+
+/** P <- P - (H P)^T S^-1 (H P) */
+void absorb(const Candidate& c, Covariance6& P) {
+    double hp[3][6], S[3][3];
+    innovation(c, P, hp, S);
+    const int m = c.rows;
+    double x[3][6];                        // L^-1 H P
+    for (int j = 0; j < 6; j++) {
+        for (int i = 0; i < m; i++) {
+            double v = hp[i][j];
+            for (int k = 0; k < i; k++) v -= S[i][k] * x[k][j];
+            x[i][j] = v / S[i][i];
+        }
+    }
+    for (int a = 0; a < 6; a++) {
+        for (int b = a; b < 6; b++) {
+            double sum = 0.0;
+            for (int i = 0; i < m; i++) sum += x[i][a] * x[i][b];
+            P[a * 6 + b] -= sum;
+            P[b * 6 + a] = P[a * 6 + b];
+        }
+    }
+}
+
+/** Mean 1-sigma position after t under the CW transition */
+double position_sigma(const Covariance6& P, double n, double t) {
+    double phi[3][6];
+    cw_position_rows(n, t, phi);
+    double trace = 0.0;
+    for (int i = 0; i < 3; i++) {
+        for (int a = 0; a < 6; a++) {
+            for (int b = 0; b < 6; b++) trace += phi[i][a] * P[a * 6 + b] * phi[i][b];
+        }
+    }
+    return std::sqrt(std::max(trace, 0.0));
+}
+
+}  // namespace
+
+SensorTasker::SensorTasker(std::vector<TaskingSensor> sensors, const TaskingConfig& config)
+    : sensors_(std::move(sensors)), config_(config),
+      access_([this] {
+          std::vector<GroundStation> sites;
+          for (const auto& s : sensors_) sites.push_back(s.site);
+          return sites;
+      }(), [&config] {
+          AccessConfig access = config.access;
+          access.num_threads = config.num_threads;
+          return access;
+      }()) {
+    if (config_.num_threads != 1) {
+        pool_ = std::make_shared<ThreadPool>(config_.num_threads);
+    }
+}
+
+SensorTasker::~SensorTasker() = default;
+
+std::vector<TaskingAssignment> SensorTasker::plan(const std::vector<TaskingObject>& objects,
+                                                  const Sampler& sampler,
+                                                  double start_jd, double end_jd) {
+    const size_t num_objects = objects.size();
+    stats_ = TaskingStats();
+    covariances_.resize(num_objects);
+    for (size_t i = 0; i < num_objects; i++) covariances_[i] = objects[i].covariance;
+    std::vector<TaskingAssignment> schedule;
+    const double span = (end_jd - start_jd) * 86400.0;
+    if (num_objects == 0 || sensors_.empty() || !(span > 0.0)) return schedule;
+
+    auto run = [this](size_t count, const std::function<void(size_t)>& fn) {
+        if (pool_ && count > 1) {
+            pool_->parallel_for(count, fn);
+        } else {
+            for (size_t i = 0; i < count; i++) fn(i);
+        }
+    };
+
+    // 1. Access windows, caching snapshots on the way
+    std::vector<ConjunctionSnapshot> cache;
+    std::vector<double> cache_t;
+    const double cache_step = config_.cache_step > 0.0 ? config_.cache_step : span;
+    auto caching = [&](double jd, ConjunctionSnapshot& out) {
+        sampler(jd, out);
+        const double t = (jd - start_jd) * 86400.0;
+        if (cache_t.empty() || t >= cache_t.back() + cache_step - 1e-6) {
+            cache.push_back(out);
+            cache_t.push_back(t);
+        }
+    };
+    const std::vector<AccessWindow> windows = access_.plan(num_objects, caching, start_jd, end_jd);
+    stats_.windows = windows.size();
+    if (cache.empty()) return schedule;
+
+    // Mean motion of each object, from the first snapshot
+    std::vector<double> mean_motion(num_objects);
+    const ConjunctionSnapshot& first = cache.front();
+    for (size_t i = 0; i < num_objects; i++) {
+        const double r = std::sqrt(first.x[i] * first.x[i] + first.y[i] * first.y[i] +
+                                   first.z[i] * first.z[i]);
+        const double v2 = first.vx[i] * first.vx[i] + first.vy[i] * first.vy[i] +
+                          first.vz[i] * first.vz[i];
+        const double inv_a = 2.0 / r - v2 / MU;
+        mean_motion[i] = inv_a > 0.0 ? std::sqrt(MU * inv_a * inv_a * inv_a) : 1e-9;
+    }
+
+    // 2. Candidates: times per window, then their rows in parallel
+    const int per_window = std::max(1, config_.samples_per_window);
+    std::vector<Candidate> candidates;
+    candidates.reserve(windows.size() * per_window);
+    for (const AccessWindow& w : windows) {
+        for (int j = 0; j < per_window; j++) {
+            Candidate c;
+            c.object = static_cast<uint32_t>(w.satellite);
+            c.sensor = static_cast<uint32_t>(w.station);
+            c.jd = per_window == 1 ? w.max_elevation_jd
+                                   : w.rise_jd + (j + 0.5) / per_window * (w.set_jd - w.rise_jd);
+            const double track = sensors_[w.station].track_time;
+            c.slot = static_cast<uint32_t>(track > 0.0 ? (c.jd - start_jd) * 86400.0 / track : 0.0);
+            c.rows = 0;
+            candidates.push_back(c);
+        }
+    }
+
+    std::vector<double> sites(3 * sensors_.size());
+    for (size_t k = 0; k < sensors_.size(); k++) site_ecef(sensors_[k].site, &sites[3 * k]);
+
+    const size_t CHUNK = 1024;
+    run((candidates.size() + CHUNK - 1) / CHUNK, [&](size_t chunk) {
+        const size_t end = std::min(candidates.size(), (chunk + 1) * CHUNK);
+        for (size_t ci = chunk * CHUNK; ci < end; ci++) {
+            Candidate& c = candidates[ci];
+            const size_t i = c.object;
+            const TaskingSensor& sensor = sensors_[c.sensor];
+            const double t = (c.jd - start_jd) * 86400.0;
+
+            // Object state from the nearest cached snapshot
+            size_t k = std::upper_bound(cache_t.begin(), cache_t.end(), t) - cache_t.begin();
+            if (k == cache_t.size() || (k > 0 && t - cache_t[k - 1] < cache_t[k] - t)) k--;
+            const ConjunctionSnapshot& snap = cache[k];
+            double r[3] = {snap.x[i], snap.y[i], snap.z[i]};
+            double v[3] = {snap.vx[i], snap.vy[i], snap.vz[i]};
+            if (!kepler_fg_inplace(r, v, t - cache_t[k], MU)) continue;
+
+            // Line of sight from the site, in ECI
+            const double th = gmst(c.jd), ct = std::cos(th), st = std::sin(th);
+            const double* p = &sites[3 * c.sensor];
+            double los[3] = {r[0] - (ct * p[0] - st * p[1]), r[1] - (st * p[0] + ct * p[1]),
+                             r[2] - p[2]};
+            const double range = std::sqrt(dot(los, los));
+            normalize(los);
+            double e1[3];
+            const double z[3] = {0.0, 0.0, 1.0}, x[3] = {1.0, 0.0, 0.0};
+            cross(std::abs(los[2]) < 0.9 ? z : x, los, e1);
+            normalize(e1);
+            double e2[3];
+            cross(los, e1, e2);
+
+            double rows[3][3];
+            int m = 0;
+            if (sensor.type == SensorType::RADAR) {
+                for (int a = 0; a < 3; a++) rows[m][a] = los[a] / sensor.range_sigma;
+                m++;
+            }
+            for (int a = 0; a < 3; a++) rows[m][a] = e1[a] / (range * sensor.angle_sigma);
+            for (int a = 0; a < 3; a++) rows[m + 1][a] = e2[a] / (range * sensor.angle_sigma);
+            m += 2;
+
+            // RIC at t, then back to start_jd
+            double R[3] = {r[0], r[1], r[2]}, C[3], I[3];
+            normalize(R);
+            cross(r, v, C);
+            normalize(C);
+            cross(C, R, I);
+            double phi[3][6];
+            cw_position_rows(mean_motion[i], t, phi);
+            for (int row = 0; row < m; row++) {
+                const double ric[3] = {dot(rows[row], R), dot(rows[row], I), dot(rows[row], C)};
+                for (int j = 0; j < 6; j++) {
+                    c.h[row][j] = ric[0] * phi[0][j] + ric[1] * phi[1][j] + ric[2] * phi[2][j];
+                }
+            }
+            c.rows = m;
+        }
+    });
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                    [](const Candidate& c) { return c.rows == 0; }),
+                     candidates.end());
+    stats_.candidates = candidates.size();
+
+    // 3. Lazy greedy, one heap per sensor
+    const size_t m = sensors_.size();
+    std::vector<std::vector<Entry>> heaps(m);
+    for (size_t ci = 0; ci < candidates.size(); ci++) {
+        heaps[candidates[ci].sensor].push_back({0.0, static_cast<uint32_t>(ci), NONE});
+    }
+    std::vector<std::vector<int>> occupancy(m);
+    for (size_t k = 0; k < m; k++) {
+        const double track = sensors_[k].track_time;
+        occupancy[k].assign(track > 0.0 ? static_cast<size_t>(span / track) + 1 : 1, 0);
+    }
+    std::vector<uint32_t> version(num_objects, 0);
+    std::vector<size_t> evaluations(m, 0);
+
+    run(m, [&](size_t k) {
+        for (Entry& e : heaps[k]) {
+            const Candidate& c = candidates[e.candidate];
+            e.gain = gain(c, covariances_[c.object], objects[c.object].priority);
+            e.version = 0;
+        }
+        evaluations[k] += heaps[k].size();
+        std::make_heap(heaps[k].begin(), heaps[k].end(), heap_less);
+    });
+
+    std::vector<Entry> proposal(m);
+    std::vector<size_t> order(m);
+    std::vector<size_t> touched(num_objects, SIZE_MAX);   // Round of the last commit
+    for (size_t round = 0;; round++) {
+        run(m, [&](size_t k) {
+            std::vector<Entry>& heap = heaps[k];
+            const TaskingSensor& sensor = sensors_[k];
+            proposal[k].candidate = NONE;
+            while (!heap.empty()) {
+                const Entry top = heap.front();
+                const Candidate& c = candidates[top.candidate];
+                std::pop_heap(heap.begin(), heap.end(), heap_less);
+                heap.pop_back();
+                if (occupancy[k][std::min<size_t>(c.slot, occupancy[k].size() - 1)] >=
+                    sensor.capacity) {
+                    continue;
+                }
+                if (top.gain < config_.min_gain) {    // Upper bound of everything left
+                    heap.clear();
+                    break;
+                }
+                if (top.version == version[c.object]) {
+                    proposal[k] = top;
+                    break;
+                }
+                Entry fresh = {gain(c, covariances_[c.object], objects[c.object].priority),
+                               top.candidate, version[c.object]};
+                evaluations[k]++;
+                heap.push_back(fresh);
+                std::push_heap(heap.begin(), heap.end(), heap_less);
+            }
+        });
+
+        order.clear();
+        for (size_t k = 0; k < m; k++) {
+            if (proposal[k].candidate != NONE) order.push_back(k);
+        }
+        if (order.empty()) break;
+        stats_.rounds++;
+        std::stable_sort(order.begin(), order.end(), [&proposal](size_t a, size_t b) {
+            return heap_less(proposal[b], proposal[a]);
+        });
+
+        for (size_t k : order) {
+            const Entry& e = proposal[k];
+            const Candidate& c = candidates[e.candidate];
+            if (touched[c.object] == round) {        // Stale now; an upper bound
+                heaps[k].push_back(e);
+                std::push_heap(heaps[k].begin(), heaps[k].end(), heap_less);
+                continue;
+            }
+            absorb(c, covariances_[c.object]);
+            version[c.object]++;
+            touched[c.object] = round;
+            occupancy[k][std::min<size_t>(c.slot, occupancy[k].size() - 1)]++;
+            schedule.push_back({c.object, c.sensor, c.jd, e.gain});
+            stats_.information_gain += e.gain;
+        }
+    }
+
+    for (size_t k = 0; k < m; k++) stats_.evaluations += evaluations[k];
+    stats_.assignments = schedule.size();
+    for (size_t i = 0; i < num_objects; i++) {
+        stats_.initial_sigma += position_sigma(objects[i].covariance, mean_motion[i], span);
+        stats_.final_sigma += position_sigma(covariances_[i], mean_motion[i], span);
+    }
+    stats_.initial_sigma /= num_objects;
+    stats_.final_sigma /= num_objects;
+
+    std::stable_sort(schedule.begin(), schedule.end(),
+                     [](const TaskingAssignment& a, const TaskingAssignment& b) {
+                         return a.jd < b.jd;
+                     });
+    return schedule;
+}
+
+}  // namespace sim
@@ -0,0 +1,130 @@
+/**
+ * Sensor Tasking — observation schedules for catalog maintenance
+ *
+ * Chooses which object each radar and optical site tracks, and when, to
+ * shrink the catalogue's total uncertainty over a planning span.
+ *
+ *   1. Access: AccessPlanner enumerates every object-sensor window. The
+ *      sampler runs once over the span; every `cache_step` its snapshot
+ *      is kept as the state cache.
+ *   2. Candidates: each window offers samples_per_window observations
+ *      (the peak, or evenly spread over the pass). For each, the object's
+ *      state comes from one Kepler step off the nearest cached snapshot.
+ *      The measurement rows are cached in the object's epoch frame:
+ *      position-only rows (range for radar, two cross line-of-sight
+ *      angles for both types) whitened by their sigmas, rotated into the
+ *      object's radial / in-track / cross-track (RIC) frame, and carried
+ *      back to start_jd through the Clohessy-Wiltshire transition matrix
+ *      at the object's mean motion. Uncertainty growth between
+ *      observations is therefore along-track drift, with no process noise.
+ *   3. Assignment: the objective is the catalogue's log-det information,
+ *      sum_i priority_i log det(P_i^-1). An observation with rows H adds
+ *      (1/2) log det(I + H P H^T), which is submodular, so greedy
+ *      selection with lazy re-evaluation applies: a stale gain is an upper
+ *      bound. Each sensor keeps a max-heap of its candidates. Per round,
+ *      every sensor (in parallel) pops until its best feasible candidate
+ *      is fresh against the current covariances. The proposals then commit
+ *      in gain order; a proposal whose object already changed this round
+ *      goes back on its heap. A commit takes one of the sensor's
+ *      `capacity` tracks in its `track_time` slot and updates the object's
+ *      covariance by the information form (rank <= 3 Woodbury).
+ *
+ * Object covariances are 6x6 RIC position / velocity at start_jd. The
+ * schedule does not depend on the thread count. There are no lighting
+ * constraints on optical sites, and no slew time beyond track_time.
+ */
+
+#ifndef SIM_SENSOR_TASKING_HPP
+#define SIM_SENSOR_TASKING_HPP
+
+#include "propagators/access_planner.hpp"
+#include "propagators/collision_probability.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sim {
+
+class ThreadPool;
+
+enum class SensorType {
+    RADAR,                            // Range and angles
+    OPTICAL                           // Angles only
+};
+
+struct TaskingSensor {
+    GroundStation site;
+    SensorType type = SensorType::RADAR;
+    double range_sigma = 20.0;        // [m] (radar)
+    double angle_sigma = 1e-3;        // [rad]
+    double track_time = 60.0;         // Slot length per track [s]
+    int capacity = 1;                 // Simultaneous tracks per slot
+};
+
+/// One catalogue object
+struct TaskingObject {
+    Covariance6 covariance{};         // RIC position / velocity at start_jd [m, m/s]
+    double priority = 1.0;            // Weight on its information gain
+};
+
+struct TaskingConfig {
+    AccessConfig access;              // Window search (its num_threads is ignored)
+    int samples_per_window = 1;       // Candidates per window; 1 = at peak elevation
+    double cache_step = 600.0;        // State cache spacing [s]
+    double min_gain = 1e-3;           // Stop below this gain [nats]
+    int num_threads = 0;              // 0 = hardware concurrency, 1 = serial
+};
+
+/// One scheduled track
+struct TaskingAssignment {
+    size_t object;
+    size_t sensor;
+    double jd;
+    double gain;                      // Weighted information gain [nats]
+};
+
+struct TaskingStats {
+    size_t windows = 0;
+    size_t candidates = 0;
+    size_t assignments = 0;
+    size_t evaluations = 0;           // Gain evaluations, initial ones included
+    size_t rounds = 0;
+    double information_gain = 0.0;    // Sum of assignment gains [nats]
+    double initial_sigma = 0.0;       // Mean 1-sigma position at end_jd, unobserved [m]
+    double final_sigma = 0.0;         // The same after the schedule [m]
+};
+
+class SensorTasker {
+public:
+    using Sampler = AccessPlanner::Sampler;
+
+    explicit SensorTasker(std::vector<TaskingSensor> sensors,
+                          const TaskingConfig& config = TaskingConfig());
+    ~SensorTasker();
+
+    /**
+     * Schedule over [start_jd, end_jd]; the sampler covers the objects as
+     * in AccessPlanner::plan() and is called once over the span
+     * @return Assignments by time
+     */
+    std::vector<TaskingAssignment> plan(const std::vector<TaskingObject>& objects,
+                                        const Sampler& sampler, double start_jd, double end_jd);
+
+    /// Covariances at start_jd after the last plan's schedule, per object
+    const std::vector<Covariance6>& covariances() const { return covariances_; }
+
+    const std::vector<TaskingSensor>& sensors() const { return sensors_; }
+    const TaskingStats& stats() const { return stats_; }
+
+private:
+    std::vector<TaskingSensor> sensors_;
+    TaskingConfig config_;
+    AccessPlanner access_;
+    std::vector<Covariance6> covariances_;
+    TaskingStats stats_;
+    std::shared_ptr<ThreadPool> pool_;   // Null when serial
+};
+
+}  // namespace sim
+
+#endif  // SIM_SENSOR_TASKING_HPP
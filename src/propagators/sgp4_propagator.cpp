@@ -0,0 +1,862 @@
+/**
+ * SGP4/SDP4 Implementation
+ *
+ * Follows Vallado's reference sgp4init / sgp4 / dscom / dpper / dsinit /
+ * dspace routine for routine, so results can be checked against the
+ * published verification vectors. The record is never written during
+ * propagation: the resonance integrator restarts from epoch on every
+ * call (the reference caches its last step, which yields the same
+ * sequence of steps).
+ */
+
+#include "propagators/sgp4_propagator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace sim {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double TWO_PI = 2.0 * PI;
+constexpr double DEG2RAD = PI / 180.0;
+constexpr double X2O3 = 2.0 / 3.0;
+
+// WGS72 (the constants TLEs are generated with)
+constexpr double MU = 398600.8;              // [km^3/s^2]
+constexpr double RE = 6378.135;              // [km]
+constexpr double J2 = 0.001082616;
+constexpr double J3 = -0.00000253881;
+constexpr double J4 = -0.00000165597;
+constexpr double J3OJ2 = J3 / J2;
+const double XKE = 60.0 / std::sqrt(RE * RE * RE / MU);   // [er^1.5/min]
+const double VKMPERSEC = RE * XKE / 60.0;
+
+// Deep-space periodic constants
+constexpr double ZNS = 1.19459e-5;
+constexpr double ZES = 0.01675;
+constexpr double ZNL = 1.5835218e-4;
+constexpr double ZEL = 0.05490;
+constexpr double RPTIM = 4.37526908801129966e-3;   // Earth rotation [rad/min]
+
+/// Greenwich sidereal time [rad] (IAU-82)
+double gstime(double jdut1) {
+    double tut1 = (jdut1 - 2451545.0) / 36525.0;
+    double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                  (876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841;
+    temp = std::fmod(temp * DEG2RAD / 240.0, TWO_PI);
+    if (temp < 0.0) temp += TWO_PI;
+    return temp;
+}
+
+/// Julian date of a TLE epoch (two-digit year, fractional day of year)
+double tle_epoch_jd(int epoch_year, double epoch_day) {
+    int year = epoch_year < 57 ? 2000 + epoch_year : 1900 + epoch_year;
+    // jday(year, 1, 1, 0, 0, 0)
+    double jd_jan1 = 367.0 * year - std::floor(7.0 * year / 4.0) + 30.0 + 1.0 + 1721013.5;
+    return jd_jan1 + epoch_day - 1.0;
+}
+
+/// dscom outputs used by dsinit and stored for dpper
+struct DeepCommon {
+    double snodm, cnodm, sinim, cosim, sinomm, cosomm, day, emsq, gam, rtemsq;
+    double s1, s2, s3, s4, s5, s6, s7;
+    double ss1, ss2, ss3, ss4, ss5, ss6, ss7;
+    double sz1, sz2, sz3, sz11, sz12, sz13, sz21, sz22, sz23, sz31, sz32, sz33;
+    double z1, z2, z3, z11, z12, z13, z21, z22, z23, z31, z32, z33;
+    double em, nm;
+};
+
+/// Lunar-solar terms common to initialization (Vallado dscom)
+void dscom(double epoch, double ep, double argpp, double tc, double inclp,
+           double nodep, double np, DeepCommon& d, SGP4Record& r) {
+    constexpr double C1SS = 2.9864797e-6;
+    constexpr double C1L = 4.7968065e-7;
+    constexpr double ZSINIS = 0.39785416;
+    constexpr double ZCOSIS = 0.91744867;
+    constexpr double ZCOSGS = 0.1945905;
+    constexpr double ZSINGS = -0.98088458;
+
+    d.nm = np;
+    d.em = ep;
+    d.snodm = std::sin(nodep);
+    d.cnodm = std::cos(nodep);
+    d.sinomm = std::sin(argpp);
+    d.cosomm = std::cos(argpp);
+    d.sinim = std::sin(inclp);
+    d.cosim = std::cos(inclp);
+    d.emsq = d.em * d.em;
+    double betasq = 1.0 - d.emsq;
+    d.rtemsq = std::sqrt(betasq);
+
+    r.peo = r.pinco = r.plo = r.pgho = r.pho = 0.0;
+    d.day = epoch + 18261.5 + tc / 1440.0;
+    double xnodce = std::fmod(4.5236020 - 9.2422029e-4 * d.day, TWO_PI);
+    double stem = std::sin(xnodce);
+    double ctem = std::cos(xnodce);
+    double zcosil = 0.91375164 - 0.03568096 * ctem;
+    double zsinil = std::sqrt(1.0 - zcosil * zcosil);
+    double zsinhl = 0.089683511 * stem / zsinil;
+    double zcoshl = std::sqrt(1.0 - zsinhl * zsinhl);
+    d.gam = 5.8351514 + 0.0019443680 * d.day;
+    double zx = 0.39785416 * stem / zsinil;
+    double zy = zcoshl * ctem + 0.91744867 * zsinhl * stem;
+    zx = std::atan2(zx, zy);
+    zx = d.gam + zx - xnodce;
+    double zcosgl = std::cos(zx);
+    double zsingl = std::sin(zx);
+
+    // Solar pass, then lunar
+    double zcosg = ZCOSGS, zsing = ZSINGS, zcosi = ZCOSIS, zsini = ZSINIS;
+    double zcosh = d.cnodm, zsinh = d.snodm;
+    double cc = C1SS;
+    double xnoi = 1.0 / d.nm;
+
+    for (int lsflg = 1; lsflg <= 2; lsflg++) {
+        double a1 = zcosg * zcosh + zsing * zcosi * zsinh;
+        double a3 = -zsing * zcosh + zcosg * zcosi * zsinh;
+        double a7 = -zcosg * zsinh + zsing * zcosi * zcosh;
+        double a8 = zsing * zsini;
+        double a9 = zsing * zsinh + zcosg * zcosi * zcosh;
+        double a10 = zcosg * zsini;
+        double a2 = d.cosim * a7 + d.sinim * a8;
+        double a4 = d.cosim * a9 + d.sinim * a10;
+        double a5 = -d.sinim * a7 + d.cosim * a8;
+        double a6 = -d.sinim * a9 + d.cosim * a10;
+
+        double x1 = a1 * d.cosomm + a2 * d.sinomm;
+        double x2 = a3 * d.cosomm + a4 * d.sinomm;
+        double x3 = -a1 * d.sinomm + a2 * d.cosomm;
+        double x4 = -a3 * d.sinomm + a4 * d.cosomm;
+        double x5 = a5 * d.sinomm;
+        double x6 = a6 * d.sinomm;
+        double x7 = a5 * d.cosomm;
+        double x8 = a6 * d.cosomm;
+
+        d.z31 = 12.0 * x1 * x1 - 3.0 * x3 * x3;
+        d.z32 = 24.0 * x1 * x2 - 6.0 * x3 * x4;
+        d.z33 = 12.0 * x2 * x2 - 3.0 * x4 * x4;
+        d.z1 = 3.0 * (a1 * a1 + a2 * a2) + d.z31 * d.emsq;
+        d.z2 = 6.0 * (a1 * a3 + a2 * a4) + d.z32 * d.emsq;
+        d.z3 = 3.0 * (a3 * a3 + a4 * a4) + d.z33 * d.emsq;
+        d.z11 = -6.0 * a1 * a5 + d.emsq * (-24.0 * x1 * x7 - 6.0 * x3 * x5);
+        d.z12 = -6.0 * (a1 * a6 + a3 * a5) +
+                d.emsq * (-24.0 * (x2 * x7 + x1 * x8) - 6.0 * (x3 * x6 + x4 * x5));
+        d.z13 = -6.0 * a3 * a6 + d.emsq * (-24.0 * x2 * x8 - 6.0 * x4 * x6);
+        d.z21 = 6.0 * a2 * a5 + d.emsq * (24.0 * x1 * x5 - 6.0 * x3 * x7);
+        d.z22 = 6.0 * (a4 * a5 + a2 * a6) +
+                d.emsq * (24.0 * (x2 * x5 + x1 * x6) - 6.0 * (x4 * x7 + x3 * x8));
+        d.z23 = 6.0 * a4 * a6 + d.emsq * (24.0 * x2 * x6 - 6.0 * x4 * x8);
+        d.z1 = d.z1 + d.z1 + betasq * d.z31;
+        d.z2 = d.z2 + d.z2 + betasq * d.z32;
+        d.z3 = d.z3 + d.z3 + betasq * d.z33;
+        d.s3 = cc * xnoi;
+        d.s2 = -0.5 * d.s3 / d.rtemsq;
+        d.s4 = d.s3 * d.rtemsq;
+        d.s1 = -15.0 * d.em * d.s4;
+        d.s5 = x1 * x3 + x2 * x4;
+        d.s6 = x2 * x3 + x1 * x4;
+        d.s7 = x2 * x4 - x1 * x3;
+
+        if (lsflg == 1) {
+            d.ss1 = d.s1; d.ss2 = d.s2; d.ss3 = d.s3; d.ss4 = d.s4;
+            d.ss5 = d.s5; d.ss6 = d.s6; d.ss7 = d.s7;
+            d.sz1 = d.z1; d.sz2 = d.z2; d.sz3 = d.z3;
+            d.sz11 = d.z11; d.sz12 = d.z12; d.sz13 = d.z13;
+            d.sz21 = d.z21; d.sz22 = d.z22; d.sz23 = d.z23;
+            d.sz31 = d.z31; d.sz32 = d.z32; d.sz33 = d.z33;
+            zcosg = zcosgl;
+            zsing = zsingl;
+            zcosi = zcosil;
+            zsini = zsinil;
+            zcosh = zcoshl * d.cnodm + zsinhl * d.snodm;
+            zsinh = d.snodm * zcoshl - d.cnodm * zsinhl;
+            cc = C1L;
+        }
+    }
+
+    r.zmol = std::fmod(4.7199672 + 0.22997150 * d.day - d.gam, TWO_PI);
+    r.zmos = std::fmod(6.2565837 + 0.017201977 * d.day, TWO_PI);
+
+    // Solar terms
+    r.se2 = 2.0 * d.ss1 * d.ss6;
+    r.se3 = 2.0 * d.ss1 * d.ss7;
+    r.si2 = 2.0 * d.ss2 * d.sz12;
+    r.si3 = 2.0 * d.ss2 * (d.sz13 - d.sz11);
+    r.sl2 = -2.0 * d.ss3 * d.sz2;
+    r.sl3 = -2.0 * d.ss3 * (d.sz3 - d.sz1);
+    r.sl4 = -2.0 * d.ss3 * (-21.0 - 9.0 * d.emsq) * ZES;
+    r.sgh2 = 2.0 * d.ss4 * d.sz32;
+    r.sgh3 = 2.0 * d.ss4 * (d.sz33 - d.sz31);
+    r.sgh4 = -18.0 * d.ss4 * ZES;
+    r.sh2 = -2.0 * d.ss2 * d.sz22;
+    r.sh3 = -2.0 * d.ss2 * (d.sz23 - d.sz21);
+
+    // Lunar terms
+    r.ee2 = 2.0 * d.s1 * d.s6;
+    r.e3 = 2.0 * d.s1 * d.s7;
+    r.xi2 = 2.0 * d.s2 * d.z12;
+    r.xi3 = 2.0 * d.s2 * (d.z13 - d.z11);
+    r.xl2 = -2.0 * d.s3 * d.z2;
+    r.xl3 = -2.0 * d.s3 * (d.z3 - d.z1);
+    r.xl4 = -2.0 * d.s3 * (-21.0 - 9.0 * d.emsq) * ZEL;
+    r.xgh2 = 2.0 * d.s4 * d.z32;
+    r.xgh3 = 2.0 * d.s4 * (d.z33 - d.z31);
+    r.xgh4 = -18.0 * d.s4 * ZEL;
+    r.xh2 = -2.0 * d.s2 * d.z22;
+    r.xh3 = -2.0 * d.s2 * (d.z23 - d.z21);
+}
+
+/// Lunar-solar periodics applied at time t (Vallado dpper, init = 'n')
+void dpper(const SGP4Record& r, double t, double& ep, double& inclp,
+           double& nodep, double& argpp, double& mp) {
+    double zm = r.zmos + ZNS * t;
+    double zf = zm + 2.0 * ZES * std::sin(zm);
+    double sinzf = std::sin(zf);
+    double f2 = 0.5 * sinzf * sinzf - 0.25;
+    double f3 = -0.5 * sinzf * std::cos(zf);
+    double ses = r.se2 * f2 + r.se3 * f3;
+    double sis = r.si2 * f2 + r.si3 * f3;
+    double sls = r.sl2 * f2 + r.sl3 * f3 + r.sl4 * sinzf;
+    double sghs = r.sgh2 * f2 + r.sgh3 * f3 + r.sgh4 * sinzf;
+    double shs = r.sh2 * f2 + r.sh3 * f3;
+
+    zm = r.zmol + ZNL * t;
+    zf = zm + 2.0 * ZEL * std::sin(zm);
+    sinzf = std::sin(zf);
+    f2 = 0.5 * sinzf * sinzf - 0.25;
+    f3 = -0.5 * sinzf * std::cos(zf);
+    double sel = r.ee2 * f2 + r.e3 * f3;
+    double sil = r.xi2 * f2 + r.xi3 * f3;
+    double sll = r.xl2 * f2 + r.xl3 * f3 + r.xl4 * sinzf;
+    double sghl = r.xgh2 * f2 + r.xgh3 * f3 + r.xgh4 * sinzf;
+    double shll = r.xh2 * f2 + r.xh3 * f3;
+
+    double pe = ses + sel - r.peo;
+    double pinc = sis + sil - r.pinco;
+    double pl = sls + sll - r.plo;
+    double pgh = sghs + sghl - r.pgho;
+    double ph = shs + shll - r.pho;
+
+    inclp += pinc;
+    ep += pe;
+    double sinip = std::sin(inclp);
+    double cosip = std::cos(inclp);
+
+    if (inclp >= 0.2) {
+        ph /= sinip;
+        pgh -= cosip * ph;
+        argpp += pgh;
+        nodep += ph;
+        mp += pl;
+    } else {
+        // Lyddane modification for low inclination
+        double sinop = std::sin(nodep);
+        double cosop = std::cos(nodep);
+        double alfdp = sinip * sinop;
+        double betdp = sinip * cosop;
+        double dalf = ph * cosop + pinc * cosip * sinop;
+        double dbet = -ph * sinop + pinc * cosip * cosop;
+        alfdp += dalf;
+        betdp += dbet;
+        nodep = std::fmod(nodep, TWO_PI);
+        double xls = mp + argpp + cosip * nodep;
+        double dls = pl + pgh - pinc * nodep * sinip;
+        xls += dls;
+        double xnoh = nodep;
+        nodep = std::atan2(alfdp, betdp);
+        if (std::fabs(xnoh - nodep) > PI) {
+            if (nodep < xnoh) nodep += TWO_PI;
+            else nodep -= TWO_PI;
+        }
+        mp += pl;
+        argpp = xls - mp - cosip * nodep;
+    }
+}
+
+/// Deep-space secular rates and resonance setup (Vallado dsinit at t = 0)
+void dsinit(const DeepCommon& d, double eccsq, double xpidot, SGP4Record& r) {
+    constexpr double Q22 = 1.7891679e-6;
+    constexpr double Q31 = 2.1460748e-6;
+    constexpr double Q33 = 2.2123015e-7;
+    constexpr double ROOT22 = 1.7891679e-6;
+    constexpr double ROOT44 = 7.3636953e-9;
+    constexpr double ROOT54 = 2.1765803e-9;
+    constexpr double ROOT32 = 3.7393792e-7;
+    constexpr double ROOT52 = 1.1428639e-7;
+
+    const double nm = d.nm;
+    const double inclm = r.inclo;
+    const double sinim = d.sinim, cosim = d.cosim;
+    double em = d.em, emsq = d.emsq;
+
+    r.irez = 0;
+    if (nm < 0.0052359877 && nm > 0.0034906585) r.irez = 1;
+    if (nm >= 8.26e-3 && nm <= 9.24e-3 && em >= 0.5) r.irez = 2;
+
+    // Solar terms
+    double ses = d.ss1 * ZNS * d.ss5;
+    double sis = d.ss2 * ZNS * (d.sz11 + d.sz13);
+    double sls = -ZNS * d.ss3 * (d.sz1 + d.sz3 - 14.0 - 6.0 * emsq);
+    double sghs = d.ss4 * ZNS * (d.sz31 + d.sz33 - 6.0);
+    double shs = -ZNS * d.ss2 * (d.sz21 + d.sz23);
+    if (inclm < 5.2359877e-2 || inclm > PI - 5.2359877e-2) shs = 0.0;
+    if (sinim != 0.0) shs /= sinim;
+    double sgs = sghs - cosim * shs;
+
+    // Lunar terms
+    r.dedt = ses + d.s1 * ZNL * d.s5;
+    r.didt = sis + d.s2 * ZNL * (d.z11 + d.z13);
+    r.dmdt = sls - ZNL * d.s3 * (d.z1 + d.z3 - 14.0 - 6.0 * emsq);
+    double sghl = d.s4 * ZNL * (d.z31 + d.z33 - 6.0);
+    double shll = -ZNL * d.s2 * (d.z21 + d.z23);
+    if (inclm < 5.2359877e-2 || inclm > PI - 5.2359877e-2) shll = 0.0;
+    r.domdt = sgs + sghl;
+    r.dnodt = shs;
+    if (sinim != 0.0) {
+        r.domdt -= cosim / sinim * shll;
+        r.dnodt += shll / sinim;
+    }
+
+    if (r.irez == 0) return;
+
+    const double theta = std::fmod(r.gsto, TWO_PI);
+    const double aonv = std::pow(nm / XKE, X2O3);
+
+    if (r.irez == 2) {
+        // Geopotential resonance for 12 hour orbits
+        double cosisq = cosim * cosim;
+        double emo = em;
+        em = r.ecco;
+        double emsqo = emsq;
+        emsq = eccsq;
+        double eoc = em * emsq;
+        double g201 = -0.306 - (em - 0.64) * 0.440;
+        double g211, g310, g322, g410, g422, g520, g533, g521, g532;
+
+        if (em <= 0.65) {
+            g211 = 3.616 - 13.2470 * em + 16.2900 * emsq;
+            g310 = -19.302 + 117.3900 * em - 228.4190 * emsq + 156.5910 * eoc;
+            g322 = -18.9068 + 109.7927 * em - 214.6334 * emsq + 146.5816 * eoc;
+            g410 = -41.122 + 242.6940 * em - 471.0940 * emsq + 313.9530 * eoc;
+            g422 = -146.407 + 841.8800 * em - 1629.014 * emsq + 1083.4350 * eoc;
+            g520 = -532.114 + 3017.977 * em - 5740.032 * emsq + 3708.2760 * eoc;
+        } else {
+            g211 = -72.099 + 331.819 * em - 508.738 * emsq + 266.724 * eoc;
+            g310 = -346.844 + 1582.851 * em - 2415.925 * emsq + 1246.113 * eoc;
+            g322 = -342.585 + 1554.908 * em - 2366.899 * emsq + 1215.972 * eoc;
+            g410 = -1052.797 + 4758.686 * em - 7193.992 * emsq + 3651.957 * eoc;
+            g422 = -3581.690 + 16178.110 * em - 24462.770 * emsq + 12422.520 * eoc;
+            if (em > 0.715) {
+                g520 = -5149.66 + 29936.92 * em - 54087.36 * emsq + 31324.56 * eoc;
+            } else {
+                g520 = 1464.74 - 4664.75 * em + 3763.64 * emsq;
+            }
+        }
+        if (em < 0.7) {
+            g533 = -919.22770 + 4988.6100 * em - 9064.7700 * emsq + 5542.21 * eoc;
+            g521 = -822.71072 + 4568.6173 * em - 8491.4146 * emsq + 5337.524 * eoc;
+            g532 = -853.66600 + 4690.2500 * em - 8624.7700 * emsq + 5341.4 * eoc;
+        } else {
+            g533 = -37995.780 + 161616.52 * em - 229838.20 * emsq + 109377.94 * eoc;
+            g521 = -51752.104 + 218913.95 * em - 309468.16 * emsq + 146349.42 * eoc;
+            g532 = -40023.880 + 170470.89 * em - 242699.48 * emsq + 115605.82 * eoc;
+        }
+
+        double sini2 = sinim * sinim;
+        double f220 = 0.75 * (1.0 + 2.0 * cosim + cosisq);
+        double f221 = 1.5 * sini2;
+        double f321 = 1.875 * sinim * (1.0 - 2.0 * cosim - 3.0 * cosisq);
+        double f322 = -1.875 * sinim * (1.0 + 2.0 * cosim - 3.0 * cosisq);
+        double f441 = 35.0 * sini2 * f220;
+        double f442 = 39.3750 * sini2 * sini2;
+        double f522 = 9.84375 * sinim * (sini2 * (1.0 - 2.0 * cosim - 5.0 * cosisq) +
+                      0.33333333 * (-2.0 + 4.0 * cosim + 6.0 * cosisq));
+        double f523 = sinim * (4.92187512 * sini2 * (-2.0 - 4.0 * cosim + 10.0 * cosisq) +
+                      6.56250012 * (1.0 + 2.0 * cosim - 3.0 * cosisq));
+        double f542 = 29.53125 * sinim * (2.0 - 8.0 * cosim +
+                      cosisq * (-12.0 + 8.0 * cosim + 10.0 * cosisq));
+        double f543 = 29.53125 * sinim * (-2.0 - 8.0 * cosim +
+                      cosisq * (12.0 + 8.0 * cosim - 10.0 * cosisq));
+
+        double xno2 = nm * nm;
+        double ainv2 = aonv * aonv;
+        double temp1 = 3.0 * xno2 * ainv2;
+        double temp = temp1 * ROOT22;
+        r.d2201 = temp * f220 * g201;
+        r.d2211 = temp * f221 * g211;
+        temp1 *= aonv;
+        temp = temp1 * ROOT32;
+        r.d3210 = temp * f321 * g310;
+        r.d3222 = temp * f322 * g322;
+        temp1 *= aonv;
+        temp = 2.0 * temp1 * ROOT44;
+        r.d4410 = temp * f441 * g410;
+        r.d4422 = temp * f442 * g422;
+        temp1 *= aonv;
+        temp = temp1 * ROOT52;
+        r.d5220 = temp * f522 * g520;
+        r.d5232 = temp * f523 * g532;
+        temp = 2.0 * temp1 * ROOT54;
+        r.d5421 = temp * f542 * g521;
+        r.d5433 = temp * f543 * g533;
+        r.xlamo = std::fmod(r.mo + r.nodeo + r.nodeo - theta - theta, TWO_PI);
+        r.xfact = r.mdot + r.dmdt + 2.0 * (r.nodedot + r.dnodt - RPTIM) - r.no;
+        em = emo;
+        emsq = emsqo;
+    }
+
+    if (r.irez == 1) {
+        // Synchronous resonance
+        double g200 = 1.0 + emsq * (-2.5 + 0.8125 * emsq);
+        double g310 = 1.0 + 2.0 * emsq;
+        double g300 = 1.0 + emsq * (-6.0 + 6.60937 * emsq);
+        double f220 = 0.75 * (1.0 + cosim) * (1.0 + cosim);
+        double f311 = 0.9375 * sinim * sinim * (1.0 + 3.0 * cosim) - 0.75 * (1.0 + cosim);
+        double f330 = 1.0 + cosim;
+        f330 = 1.875 * f330 * f330 * f330;
+        r.del1 = 3.0 * nm * nm * aonv * aonv;
+        r.del2 = 2.0 * r.del1 * f220 * g200 * Q22;
+        r.del3 = 3.0 * r.del1 * f330 * g300 * Q33 * aonv;
+        r.del1 = r.del1 * f311 * g310 * Q31 * aonv;
+        r.xlamo = std::fmod(r.mo + r.nodeo + r.argpo - theta, TWO_PI);
+        r.xfact = r.mdot + xpidot - RPTIM + r.dmdt + r.domdt + r.dnodt - r.no;
+    }
+}
+
+/// Deep-space secular effects and resonance integration (Vallado dspace)
+void dspace(const SGP4Record& r, double t, double& em, double& argpm, double& inclm,
+            double& mm, double& nodem, double& nm) {
+    constexpr double FASX2 = 0.13130908;
+    constexpr double FASX4 = 2.8843198;
+    constexpr double FASX6 = 0.37448087;
+    constexpr double G22 = 5.7686396;
+    constexpr double G32 = 0.95240898;
+    constexpr double G44 = 1.8014998;
+    constexpr double G52 = 1.0508330;
+    constexpr double G54 = 4.4108898;
+    constexpr double STEPP = 720.0;
+    constexpr double STEPN = -720.0;
+    constexpr double STEP2 = 259200.0;
+
+    double dndt = 0.0;
+    const double theta = std::fmod(r.gsto + t * RPTIM, TWO_PI);
+    em += r.dedt * t;
+    inclm += r.didt * t;
+    argpm += r.domdt * t;
+    nodem += r.dnodt * t;
+    mm += r.dmdt * t;
+
+    if (r.irez == 0) return;
+
+    // Integrate the resonance terms from epoch
+    double atime = 0.0;
+    double xni = r.no;
+    double xli = r.xlamo;
+    double delt = t > 0.0 ? STEPP : STEPN;
+    double ft = 0.0, xndt = 0.0, xldot = 0.0, xnddt = 0.0;
+
+    for (;;) {
+        if (r.irez != 2) {
+            xndt = r.del1 * std::sin(xli - FASX2) + r.del2 * std::sin(2.0 * (xli - FASX4)) +
+                   r.del3 * std::sin(3.0 * (xli - FASX6));
+            xldot = xni + r.xfact;
+            xnddt = r.del1 * std::cos(xli - FASX2) + 2.0 * r.del2 * std::cos(2.0 * (xli - FASX4)) +
+                    3.0 * r.del3 * std::cos(3.0 * (xli - FASX6));
+            xnddt *= xldot;
+        } else {
+            double xomi = r.argpo + r.argpdot * atime;
+            double x2omi = xomi + xomi;
+            double x2li = xli + xli;
+            xndt = r.d2201 * std::sin(x2omi + xli - G22) + r.d2211 * std::sin(xli - G22) +
+                   r.d3210 * std::sin(xomi + xli - G32) + r.d3222 * std::sin(-xomi + xli - G32) +
+                   r.d4410 * std::sin(x2omi + x2li - G44) + r.d4422 * std::sin(x2li - G44) +
+                   r.d5220 * std::sin(xomi + xli - G52) + r.d5232 * std::sin(-xomi + xli - G52) +
+                   r.d5421 * std::sin(xomi + x2li - G54) + r.d5433 * std::sin(-xomi + x2li - G54);
+            xldot = xni + r.xfact;
+            xnddt = r.d2201 * std::cos(x2omi + xli - G22) + r.d2211 * std::cos(xli - G22) +
+                    r.d3210 * std::cos(xomi + xli - G32) + r.d3222 * std::cos(-xomi + xli - G32) +
+                    r.d5220 * std::cos(xomi + xli - G52) + r.d5232 * std::cos(-xomi + xli - G52) +
+                    2.0 * (r.d4410 * std::cos(x2omi + x2li - G44) +
+                           r.d4422 * std::cos(x2li - G44) +
+                           r.d5421 * std::cos(xomi + x2li - G54) +
+                           r.d5433 * std::cos(-xomi + x2li - G54));
+            xnddt *= xldot;
+        }
+
+        if (std::fabs(t - atime) < STEPP) {
+            ft = t - atime;
+            break;
+        }
+        xli += xldot * delt + xndt * STEP2;
+        xni += xndt * delt + xnddt * STEP2;
+        atime += delt;
+    }
+
+    nm = xni + xndt * ft + xnddt * ft * ft * 0.5;
+    double xl = xli + xldot * ft + xndt * ft * ft * 0.5;
+    if (r.irez != 1) {
+        mm = xl - 2.0 * nodem + 2.0 * theta;
+    } else {
+        mm = xl - nodem - argpm + theta;
+    }
+    dndt = nm - r.no;
+    nm = r.no + dndt;
+}
+
+}  // namespace
+
+// ─────────────────────────────────────────────────────────────
+// Initialization (sgp4init)
+// ─────────────────────────────────────────────────────────────
+
+SGP4Record SGP4Propagator::initialize(const TLE& tle) {
+    SGP4Record r;
+    r.epoch_jd = tle_epoch_jd(tle.epoch_year, tle.epoch_day);
+    const double epoch = r.epoch_jd - 2433281.5;   // days since 1950 Jan 0
+
+    const double no_kozai = tle.mean_motion * TWO_PI / 1440.0;
+    r.ecco = tle.eccentricity;
+    r.inclo = tle.inclination * DEG2RAD;
+    r.nodeo = tle.raan * DEG2RAD;
+    r.argpo = tle.arg_perigee * DEG2RAD;
+    r.mo = tle.mean_anomaly * DEG2RAD;
+    r.bstar = tle.bstar_drag;
+
+    // initl: un-Kozai the mean motion
+    const double eccsq = r.ecco * r.ecco;
+    const double omeosq = 1.0 - eccsq;
+    const double rteosq = std::sqrt(omeosq);
+    const double cosio = std::cos(r.inclo);
+    const double cosio2 = cosio * cosio;
+    const double ak = std::pow(XKE / no_kozai, X2O3);
+    const double d1 = 0.75 * J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    const double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    r.no = no_kozai / (1.0 + del);
+
+    const double ao = std::pow(XKE / r.no, X2O3);
+    const double sinio = std::sin(r.inclo);
+    const double po = ao * omeosq;
+    const double con42 = 1.0 - 5.0 * cosio2;
+    r.con41 = -con42 - cosio2 - cosio2;
+    const double posq = po * po;
+    const double rp = ao * (1.0 - r.ecco);
+    r.gsto = gstime(epoch + 2433281.5);
+
+    if (omeosq < 0.0 && r.no < 0.0) {
+        r.init_error = SGP4Error::ECCENTRICITY;
+        return r;
+    }
+
+    r.simplified = rp < (220.0 / RE + 1.0);
+
+    // Atmospheric density fit parameters, lowered for low perigees
+    const double ss = 78.0 / RE + 1.0;
+    const double qzms2t = std::pow((120.0 - 78.0) / RE, 4);
+    double sfour = ss;
+    double qzms24 = qzms2t;
+    const double perige = (rp - 1.0) * RE;
+    if (perige < 156.0) {
+        sfour = perige - 78.0;
+        if (perige < 98.0) sfour = 20.0;
+        qzms24 = std::pow((120.0 - sfour) / RE, 4);
+        sfour = sfour / RE + 1.0;
+    }
+    const double pinvsq = 1.0 / posq;
+
+    const double tsi = 1.0 / (ao - sfour);
+    r.eta = ao * r.ecco * tsi;
+    const double etasq = r.eta * r.eta;
+    const double eeta = r.ecco * r.eta;
+    const double psisq = std::fabs(1.0 - etasq);
+    const double coef = qzms24 * std::pow(tsi, 4);
+    const double coef1 = coef / std::pow(psisq, 3.5);
+    const double cc2 = coef1 * r.no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                       0.375 * J2 * tsi / psisq * r.con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    r.cc1 = r.bstar * cc2;
+    double cc3 = 0.0;
+    if (r.ecco > 1.0e-4) cc3 = -2.0 * coef * tsi * J3OJ2 * r.no * sinio / r.ecco;
+    r.x1mth2 = 1.0 - cosio2;
+    r.cc4 = 2.0 * r.no * coef1 * ao * omeosq *
+            (r.eta * (2.0 + 0.5 * etasq) + r.ecco * (0.5 + 2.0 * etasq) -
+             J2 * tsi / (ao * psisq) *
+             (-3.0 * r.con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+              0.75 * r.x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * r.argpo)));
+    r.cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    // Secular rates
+    const double cosio4 = cosio2 * cosio2;
+    const double temp1 = 1.5 * J2 * pinvsq * r.no;
+    const double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    const double temp3 = -0.46875 * J4 * pinvsq * pinvsq * r.no;
+    r.mdot = r.no + 0.5 * temp1 * rteosq * r.con41 +
+             0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    r.argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+                temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    const double xhdot1 = -temp1 * cosio;
+    r.nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) +
+                2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+    const double xpidot = r.argpdot + r.nodedot;
+    r.omgcof = r.bstar * cc3 * std::cos(r.argpo);
+    r.xmcof = 0.0;
+    if (r.ecco > 1.0e-4) r.xmcof = -X2O3 * coef * r.bstar / eeta;
+    r.nodecf = 3.5 * omeosq * xhdot1 * r.cc1;
+    r.t2cof = 1.5 * r.cc1;
+    const double den = std::fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12;
+    r.xlcof = -0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) / den;
+    r.aycof = -0.5 * J3OJ2 * sinio;
+    const double delmotemp = 1.0 + r.eta * std::cos(r.mo);
+    r.delmo = delmotemp * delmotemp * delmotemp;
+    r.sinmao = std::sin(r.mo);
+    r.x7thm1 = 7.0 * cosio2 - 1.0;
+
+    // Deep space: period >= 225 min
+    if (TWO_PI / r.no >= 225.0) {
+        r.deep_space = true;
+        r.simplified = true;
+        DeepCommon d{};
+        dscom(epoch, r.ecco, r.argpo, 0.0, r.inclo, r.nodeo, r.no, d, r);
+        dsinit(d, eccsq, xpidot, r);
+    }
+
+    if (!r.simplified) {
+        const double cc1sq = r.cc1 * r.cc1;
+        r.d2 = 4.0 * ao * tsi * cc1sq;
+        const double temp = r.d2 * tsi * r.cc1 / 3.0;
+        r.d3 = (17.0 * ao + sfour) * temp;
+        r.d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * r.cc1;
+        r.t3cof = r.d2 + 2.0 * cc1sq;
+        r.t4cof = 0.25 * (3.0 * r.d3 + r.cc1 * (12.0 * r.d2 + 10.0 * cc1sq));
+        r.t5cof = 0.2 * (3.0 * r.d4 + 12.0 * r.cc1 * r.d3 + 6.0 * r.d2 * r.d2 +
+                         15.0 * cc1sq * (2.0 * r.d2 + cc1sq));
+    }
+
+    // As sgp4init: a failing epoch evaluation marks the record
+    Vec3 pos, vel;
+    r.init_error = propagate(r, 0.0, pos, vel);
+    return r;
+}
+
+SGP4Propagator::SGP4Propagator(const TLE& tle) : rec_(initialize(tle)) {}
+
+// ─────────────────────────────────────────────────────────────
+// Propagation (sgp4)
+// ─────────────────────────────────────────────────────────────
+
+SGP4Error SGP4Propagator::propagate(const SGP4Record& r, double t, Vec3& pos, Vec3& vel) {
+    pos = Vec3(0.0, 0.0, 0.0);
+    vel = Vec3(0.0, 0.0, 0.0);
+
+    // Secular gravity and atmospheric drag
+    const double xmdf = r.mo + r.mdot * t;
+    const double argpdf = r.argpo + r.argpdot * t;
+    const double nodedf = r.nodeo + r.nodedot * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    const double t2 = t * t;
+    double nodem = nodedf + r.nodecf * t2;
+    double tempa = 1.0 - r.cc1 * t;
+    double tempe = r.bstar * r.cc4 * t;
+    double templ = r.t2cof * t2;
+
+    if (!r.simplified) {
+        const double delomg = r.omgcof * t;
+        const double delmtemp = 1.0 + r.eta * std::cos(xmdf);
+        const double delm = r.xmcof * (delmtemp * delmtemp * delmtemp - r.delmo);
+        const double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        const double t3 = t2 * t;
+        const double t4 = t3 * t;
+        tempa = tempa - r.d2 * t2 - r.d3 * t3 - r.d4 * t4;
+        tempe = tempe + r.bstar * r.cc5 * (std::sin(mm) - r.sinmao);
+        templ = templ + r.t3cof * t3 + t4 * (r.t4cof + t * r.t5cof);
+    }
+
+    double nm = r.no;
+    double em = r.ecco;
+    double inclm = r.inclo;
+    if (r.deep_space) dspace(r, t, em, argpm, inclm, mm, nodem, nm);
+
+    if (nm <= 0.0) return SGP4Error::MEAN_MOTION;
+    const double am = std::pow(XKE / nm, X2O3) * tempa * tempa;
+    nm = XKE / std::pow(am, 1.5);
+    em -= tempe;
+    if (em >= 1.0 || em < -0.001) return SGP4Error::ECCENTRICITY;
+    if (em < 1.0e-6) em = 1.0e-6;
+    mm += r.no * templ;
+    double xlm = mm + argpm + nodem;
+    nodem = std::fmod(nodem, TWO_PI);
+    argpm = std::fmod(argpm, TWO_PI);
+    xlm = std::fmod(xlm, TWO_PI);
+    mm = std::fmod(xlm - argpm - nodem, TWO_PI);
+
+    // Lunar-solar periodics
+    double ep = em, xincp = inclm, argpp = argpm, nodep = nodem, mp = mm;
+    double sinip = std::sin(inclm);
+    double cosip = std::cos(inclm);
+    double aycof = r.aycof, xlcof = r.xlcof;
+    double con41 = r.con41, x1mth2 = r.x1mth2, x7thm1 = r.x7thm1;
+    if (r.deep_space) {
+        dpper(r, t, ep, xincp, nodep, argpp, mp);
+        if (xincp < 0.0) {
+            xincp = -xincp;
+            nodep += PI;
+            argpp -= PI;
+        }
+        if (ep < 0.0 || ep > 1.0) return SGP4Error::PERTURBED_ECCENTRICITY;
+
+        sinip = std::sin(xincp);
+        cosip = std::cos(xincp);
+        aycof = -0.5 * J3OJ2 * sinip;
+        const double den = std::fabs(cosip + 1.0) > 1.5e-12 ? 1.0 + cosip : 1.5e-12;
+        xlcof = -0.25 * J3OJ2 * sinip * (3.0 + 5.0 * cosip) / den;
+    }
+
+    // Long-period periodics
+    const double axnl = ep * std::cos(argpp);
+    double temp = 1.0 / (am * (1.0 - ep * ep));
+    const double aynl = ep * std::sin(argpp) + temp * aycof;
+    const double xl = mp + argpp + nodep + temp * xlcof * axnl;
+
+    // Kepler's equation
+    const double u = std::fmod(xl - nodep, TWO_PI);
+    double eo1 = u;
+    double tem5 = 9999.9;
+    double sineo1 = 0.0, coseo1 = 0.0;
+    for (int ktr = 1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+        sineo1 = std::sin(eo1);
+        coseo1 = std::cos(eo1);
+        tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (std::fabs(tem5) >= 0.95) tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        eo1 += tem5;
+    }
+
+    // Short-period periodics
+    const double ecose = axnl * coseo1 + aynl * sineo1;
+    const double esine = axnl * sineo1 - aynl * coseo1;
+    const double el2 = axnl * axnl + aynl * aynl;
+    const double pl = am * (1.0 - el2);
+    if (pl < 0.0) return SGP4Error::SEMI_LATUS_RECTUM;
+
+    const double rl = am * (1.0 - ecose);
+    const double rdotl = std::sqrt(am) * esine / rl;
+    const double rvdotl = std::sqrt(pl) / rl;
+    const double betal = std::sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    const double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    const double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = std::atan2(sinu, cosu);
+    const double sin2u = (cosu + cosu) * sinu;
+    const double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    const double temp1 = 0.5 * J2 * temp;
+    const double temp2 = temp1 * temp;
+
+    if (r.deep_space) {
+        const double cosisq = cosip * cosip;
+        con41 = 3.0 * cosisq - 1.0;
+        x1mth2 = 1.0 - cosisq;
+        x7thm1 = 7.0 * cosisq - 1.0;
+    }
+    const double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41) + 0.5 * temp1 * x1mth2 * cos2u;
+    su -= 0.25 * temp2 * x7thm1 * sin2u;
+    const double xnode = nodep + 1.5 * temp2 * cosip * sin2u;
+    const double xinc = xincp + 1.5 * temp2 * cosip * sinip * cos2u;
+    const double mvt = rdotl - nm * temp1 * x1mth2 * sin2u / XKE;
+    const double rvdot = rvdotl + nm * temp1 * (x1mth2 * cos2u + 1.5 * con41) / XKE;
+
+    // Orientation vectors
+    const double sinsu = std::sin(su), cossu = std::cos(su);
+    const double snod = std::sin(xnode), cnod = std::cos(xnode);
+    const double sini = std::sin(xinc), cosi = std::cos(xinc);
+    const double xmx = -snod * cosi;
+    const double xmy = cnod * cosi;
+    const double ux = xmx * sinsu + cnod * cossu;
+    const double uy = xmy * sinsu + snod * cossu;
+    const double uz = sini * sinsu;
+    const double vx = xmx * cossu - cnod * sinsu;
+    const double vy = xmy * cossu - snod * sinsu;
+    const double vz = sini * cossu;
+
+    if (mrt < 1.0) return SGP4Error::DECAYED;
+
+    const double mr = mrt * RE * 1000.0;             // [m]
+    const double vscale = VKMPERSEC * 1000.0;        // [m/s]
+    pos = Vec3(mr * ux, mr * uy, mr * uz);
+    vel = Vec3(vscale * (mvt * ux + rvdot * vx),
+               vscale * (mvt * uy + rvdot * vy),
+               vscale * (mvt * uz + rvdot * vz));
+    return SGP4Error::NONE;
+}
+
+StateVector SGP4Propagator::at_minutes(double tsince) const {
+    StateVector s;
+    SGP4Error err = propagate(rec_, tsince, s.position, s.velocity);
+    if (err != SGP4Error::NONE) {
+        throw std::runtime_error("SGP4 propagation failed (error " +
+                                 std::to_string(static_cast<int>(err)) + ")");
+    }
+    s.time = tsince * 60.0;
+    s.frame = CoordinateFrame::TEME;
+    return s;
+}
+
+StateVector SGP4Propagator::at_jd(double jd) const {
+    return at_minutes((jd - rec_.epoch_jd) * 1440.0);
+}
+
+// ─────────────────────────────────────────────────────────────
+// Batch evaluation
+// ─────────────────────────────────────────────────────────────
+
+size_t SGP4Batch::add(const TLE& tle) {
+    records_.push_back(SGP4Propagator::initialize(tle));
+    return records_.size() - 1;
+}
+
+void SGP4Batch::evaluate(double jd, int num_threads) {
+    const size_t n = records_.size();
+    for (auto* v : {&x_, &y_, &z_, &vx_, &vy_, &vz_}) v->resize(n);
+    errors_.resize(n);
+
+    size_t threads = num_threads > 0 ? static_cast<size_t>(num_threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+    // Keep shards large enough to be worth a thread
+    threads = std::max<size_t>(1, std::min(threads, n / 256));
+
+    if (threads == 1) {
+        evaluate_range(0, n, jd);
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back(&SGP4Batch::evaluate_range, this,
+                          n * t / threads, n * (t + 1) / threads, jd);
+    }
+    for (auto& th : pool) th.join();
+}
+
+void SGP4Batch::evaluate_range(size_t begin, size_t end, double jd) {
+    Vec3 pos, vel;
+    for (size_t i = begin; i < end; i++) {
+        const SGP4Record& r = records_[i];
+        errors_[i] = r.init_error != SGP4Error::NONE
+            ? r.init_error
+            : SGP4Propagator::propagate(r, (jd - r.epoch_jd) * 1440.0, pos, vel);
+        if (errors_[i] != SGP4Error::NONE) {
+            pos = Vec3(0.0, 0.0, 0.0);
+            vel = Vec3(0.0, 0.0, 0.0);
+        }
+        x_[i] = pos.x;  y_[i] = pos.y;  z_[i] = pos.z;
+        vx_[i] = vel.x; vy_[i] = vel.y; vz_[i] = vel.z;
+    }
+}
+
+}  // namespace sim
@@ -0,0 +1,159 @@
+/**
+ * SGP4/SDP4 Propagator
+ *
+ * The analytic theory TLE mean elements are fitted against (Spacetrack
+ * Report #3 as revised by Vallado et al., AIAA 2006-6753, WGS72
+ * constants, "improved" operation mode). Near-earth objects (period
+ * < 225 min) use SGP4; deep-space objects add the SDP4 lunar-solar
+ * periodics and, for 12 h and 24 h orbits, the resonance integrator.
+ *
+ * sgp4init's work is done once per TLE into an SGP4Record; a state at
+ * any time is then a closed-form evaluation with no stepping (resonant
+ * deep-space objects integrate their resonance terms from epoch in
+ * 720 min steps). Evaluation does not modify the record, so one record
+ * serves any number of threads.
+ *
+ * Output is TEME, in meters and m/s.
+ *
+ * SGP4Batch holds many records contiguously and evaluates all of them at
+ * one Julian date into per-axis buffers, sharded across threads — for
+ * catalog snapshots and conjunction screening.
+ */
+
+#ifndef SIM_SGP4_PROPAGATOR_HPP
+#define SIM_SGP4_PROPAGATOR_HPP
+
+#include "core/state_vector.hpp"
+#include "io/tle_parser.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sim {
+
+/// Propagation outcome (Vallado's error codes)
+enum class SGP4Error : uint8_t {
+    NONE = 0,
+    ECCENTRICITY = 1,             // Mean eccentricity out of [0, 1)
+    MEAN_MOTION = 2,              // Mean motion <= 0
+    PERTURBED_ECCENTRICITY = 3,   // Eccentricity after periodics out of [0, 1]
+    SEMI_LATUS_RECTUM = 4,        // Semi-latus rectum < 0
+    DECAYED = 6                   // Radius below one Earth radius
+};
+
+/// Per-TLE initialization (sgp4init output); read-only during propagation
+struct SGP4Record {
+    double epoch_jd = 0.0;        // TLE epoch, Julian date (UTC)
+
+    // Mean elements at epoch [rad, rad/min]
+    double no = 0.0;              // Un-Kozai'd mean motion
+    double ecco = 0.0, inclo = 0.0, nodeo = 0.0, argpo = 0.0, mo = 0.0;
+    double bstar = 0.0;
+
+    bool deep_space = false;
+    bool simplified = false;      // isimp: perigee < 220 km drag terms dropped
+    SGP4Error init_error = SGP4Error::NONE;
+
+    // Near-earth secular, drag and long-period coefficients
+    double aycof = 0.0, con41 = 0.0, cc1 = 0.0, cc4 = 0.0, cc5 = 0.0;
+    double d2 = 0.0, d3 = 0.0, d4 = 0.0, delmo = 0.0, eta = 0.0;
+    double argpdot = 0.0, omgcof = 0.0, sinmao = 0.0;
+    double t2cof = 0.0, t3cof = 0.0, t4cof = 0.0, t5cof = 0.0;
+    double x1mth2 = 0.0, x7thm1 = 0.0, mdot = 0.0, nodedot = 0.0;
+    double xlcof = 0.0, xmcof = 0.0, nodecf = 0.0;
+
+    // Deep space: lunar-solar periodics
+    double e3 = 0.0, ee2 = 0.0, peo = 0.0, pgho = 0.0, pho = 0.0, pinco = 0.0, plo = 0.0;
+    double se2 = 0.0, se3 = 0.0, sgh2 = 0.0, sgh3 = 0.0, sgh4 = 0.0, sh2 = 0.0, sh3 = 0.0;
+    double si2 = 0.0, si3 = 0.0, sl2 = 0.0, sl3 = 0.0, sl4 = 0.0;
+    double xgh2 = 0.0, xgh3 = 0.0, xgh4 = 0.0, xh2 = 0.0, xh3 = 0.0;
+    double xi2 = 0.0, xi3 = 0.0, xl2 = 0.0, xl3 = 0.0, xl4 = 0.0;
+    double zmol = 0.0, zmos = 0.0;
+
+    // Deep space: secular rates and resonance
+    int irez = 0;                 // 0 none, 1 synchronous, 2 half-day
+    double gsto = 0.0;
+    double dedt = 0.0, didt = 0.0, dmdt = 0.0, dnodt = 0.0, domdt = 0.0;
+    double d2201 = 0.0, d2211 = 0.0, d3210 = 0.0, d3222 = 0.0, d4410 = 0.0;
+    double d4422 = 0.0, d5220 = 0.0, d5232 = 0.0, d5421 = 0.0, d5433 = 0.0;
+    double del1 = 0.0, del2 = 0.0, del3 = 0.0;
+    double xfact = 0.0, xlamo = 0.0;
+};
+
+class SGP4Propagator {
+public:
+    /** Run sgp4init for one TLE. Check init_error() before use. */
+    explicit SGP4Propagator(const TLE& tle);
+
+    /** Build the initialization record for a TLE. */
+    static SGP4Record initialize(const TLE& tle);
+
+    /**
+     * Evaluate a record `tsince` minutes from its epoch.
+     * @param pos TEME position [m]
+     * @param vel TEME velocity [m/s]
+     */
+    static SGP4Error propagate(const SGP4Record& rec, double tsince, Vec3& pos, Vec3& vel);
+
+    /**
+     * State `tsince` minutes from epoch (TEME, time in seconds from epoch).
+     * @throws std::runtime_error if propagation fails (e.g. decayed)
+     */
+    StateVector at_minutes(double tsince) const;
+
+    /** State at a Julian date; see at_minutes(). */
+    StateVector at_jd(double jd) const;
+
+    double epoch_jd() const { return rec_.epoch_jd; }
+    bool is_deep_space() const { return rec_.deep_space; }
+    SGP4Error init_error() const { return rec_.init_error; }
+    const SGP4Record& record() const { return rec_; }
+
+private:
+    SGP4Record rec_;
+};
+
+/**
+ * Many SGP4 records evaluated together at a common Julian date.
+ */
+class SGP4Batch {
+public:
+    /** Add a TLE. @return its index in the output buffers */
+    size_t add(const TLE& tle);
+
+    /** Add an already initialized record (e.g. from a TLECatalog). */
+    size_t add(const SGP4Record& rec) {
+        records_.push_back(rec);
+        return records_.size() - 1;
+    }
+
+    void reserve(size_t n) { records_.reserve(n); }
+    size_t size() const { return records_.size(); }
+    const SGP4Record& record(size_t i) const { return records_[i]; }
+
+    /**
+     * Evaluate every record at `jd` into the output buffers.
+     * @param num_threads 0 = hardware concurrency
+     */
+    void evaluate(double jd, int num_threads = 0);
+
+    // Per-axis TEME outputs of the last evaluate() [m, m/s]
+    const double* x() const { return x_.data(); }
+    const double* y() const { return y_.data(); }
+    const double* z() const { return z_.data(); }
+    const double* vx() const { return vx_.data(); }
+    const double* vy() const { return vy_.data(); }
+    const double* vz() const { return vz_.data(); }
+    /** Per-object outcome of the last evaluate(); positions are 0 on error. */
+    const SGP4Error* errors() const { return errors_.data(); }
+
+private:
+    std::vector<SGP4Record> records_;
+    std::vector<double> x_, y_, z_, vx_, vy_, vz_;
+    std::vector<SGP4Error> errors_;
+
+    void evaluate_range(size_t begin, size_t end, double jd);
+};
+
+}  // namespace sim
+
+#endif  // SIM_SGP4_PROPAGATOR_HPP
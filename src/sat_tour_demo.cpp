@@ -5,13 +5,19 @@
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <cstdlib>
+#include <string>
 
 #include "core/state_vector.hpp"
 #include "physics/orbital_elements.hpp"
 #include "physics/gravity_model.hpp"
 #include "physics/nonlinear_rendezvous.hpp"
+#include "physics/tour_optimizer.hpp"
 #include "propagators/rk4_integrator.hpp"
 #include "io/tle_parser.hpp"
+#include "io/czml_writer.hpp"
+#include "io/trajectory_archive.hpp"
+#include "io/async_output.hpp"
 #include "coordinate/time_utils.hpp"
 #include "coordinate/frame_transformer.hpp"
 
@@ -66,21 +72,10 @@ OrbitalElements tle_to_elements(const TLE& tle) {
     elem.raan = tle.raan * DEG_TO_RAD;
     elem.arg_periapsis = tle.arg_perigee * DEG_TO_RAD;
 
-    // Convert mean anomaly to true anomaly (simplified for near-circular)
+    // Convert mean anomaly to true anomaly
     double M = tle.mean_anomaly * DEG_TO_RAD;
     double e = tle.eccentricity;
-
-    // Newton's method for eccentric anomaly
-    double E = M;
-    for (int i = 0; i < 10; i++) {
-        E = M + e * std::sin(E);
-    }
-
-    // True anomaly from eccentric anomaly
-    double nu = 2.0 * std::atan2(
-        std::sqrt(1 + e) * std::sin(E / 2),
-        std::sqrt(1 - e) * std::cos(E / 2)
-    );
+    double nu = OrbitalMechanics::mean_to_true_anomaly(M, e);
     elem.true_anomaly = nu;
 
     return elem;
@@ -109,6 +104,14 @@ int main(int argc, char* argv[]) {
     std::string tle_file = "data/tles/satcat.txt";
     int num_targets = 30;
     double tof_hours = 4.33;
+    bool optimize_tour = false;   // --optimize: beam-searched visit order
+    double tour_budget = 2000.0;  // [m/s] with --optimize
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--optimize") optimize_tour = true;
+        else if (arg == "--budget" && i + 1 < argc) tour_budget = std::atof(argv[++i]);
+    }
 
     std::cout << std::fixed << std::setprecision(4);
     std::cout << "=== Satellite Tour: 30 Target Rendezvous ===" << std::endl;
@@ -116,7 +119,8 @@ int main(int argc, char* argv[]) {
     std::cout << "Loading TLEs from: " << tle_file << std::endl;
 
     // Load TLEs
-    std::vector<TLE> tles = TLEParser::parse_file(tle_file);
+    auto catalog = TLEParser::load_file(tle_file);
+    const std::vector<TLE>& tles = *catalog;
 
     if (tles.empty()) {
         std::cerr << "Failed to load TLEs" << std::endl;
@@ -199,6 +203,30 @@ int main(int argc, char* argv[]) {
         return closest;
     };
 
+    // Optional: plan the whole visit order up front instead of walking
+    // to the nearest longitude
+    std::vector<size_t> tour_order;
+    if (optimize_tour) {
+        std::vector<TourCandidate> candidates;
+        for (int i = 0; i < num_targets && best_start + i < static_cast<int>(targets.size()); i++) {
+            const SatTarget& t = targets[best_start + i];
+            candidates.push_back({t.name, t.norad_id, t.state});
+        }
+        TourOptimizerConfig tour_cfg;
+        tour_cfg.hop_time = tof_hours * 3600.0;
+        tour_cfg.delta_v_budget = tour_budget;
+        tour_cfg.max_hops = num_targets - 1;
+        tour_cfg.mu = mu;
+
+        TourOptimizer optimizer(candidates, tour_cfg);
+        TourResult plan = optimizer.solve(0);
+        for (size_t k = 1; k < plan.sequence.size(); k++) {
+            tour_order.push_back(best_start + plan.sequence[k]);
+        }
+        std::cout << "Optimized tour: " << tour_order.size() << " targets, "
+                  << plan.total_delta_v << " m/s planned (budget " << tour_budget << " m/s)" << std::endl;
+    }
+
     // Setup solver
     ForceModelConfig force_cfg;
     force_cfg.mu = mu;
@@ -218,6 +246,28 @@ int main(int argc, char* argv[]) {
     std::vector<StateVector> chase_trajectory;
     chase_trajectory.push_back(chase_state);
 
+    // Chase trajectory streamed as CZML while it is propagated
+    CzmlOptions czml_options;
+    czml_options.chunk_seconds = tof_hours * 3600.0;   // One packet per hop
+    czml_options.min_sample_interval = 300.0;
+    czml_options.clock_multiplier = 100.0;
+    CzmlWriter czml("sat_tour.czml", "30-Satellite Rendezvous Tour",
+                    TimeUtils::J2000_EPOCH_JD, czml_options);
+    CzmlEntity chase_entity;
+    chase_entity.id = "chase";
+    chase_entity.name = "Chase Vehicle";
+    chase_entity.rgba = {0, 255, 0, 255};
+    chase_entity.point_size = 12.0;
+    size_t czml_chase = czml.add_entity(chase_entity);
+    czml.add_sample(czml_chase, 0.0, chase_state.position);
+
+    // ...and archived at full rate for time-indexed access
+    TrajectoryArchiveOptions archive_options;
+    archive_options.frame = traj::FRAME_ECI;
+    TrajectoryArchiveWriter archive;
+    archive.open("sat_tour.traj", {"chase"}, archive_options);
+    archive.add_sample(0.0, &chase_state.position);
+
     // Store all target trajectories for Cesium
     struct SatTrajectory {
         std::string name;
@@ -230,8 +280,13 @@ int main(int argc, char* argv[]) {
     std::cout << "\n=== Beginning Tour ===" << std::endl;
 
     for (int hop = 1; hop <= num_targets; hop++) {
-        // Find closest unvisited target by longitude
-        SatTarget* next_target = find_closest_by_longitude();
+        // Next target: planned order, or closest unvisited by longitude
+        SatTarget* next_target = nullptr;
+        if (!optimize_tour) {
+            next_target = find_closest_by_longitude();
+        } else if (static_cast<size_t>(hop - 1) < tour_order.size()) {
+            next_target = &targets[tour_order[hop - 1]];
+        }
         if (!next_target) {
             std::cout << "No more targets available" << std::endl;
             break;
@@ -298,6 +353,8 @@ int main(int argc, char* argv[]) {
             double step = std::min(60.0, tof_sec - t);
             chase_state = propagate_state(chase_state, step);
             t += step;
+            czml.add_sample(czml_chase, current_time + t, chase_state.position);
+            archive.add_sample(current_time + t, &chase_state.position);
 
             if (std::fmod(t, record_interval) < 60.0) {
                 StateVector record_state = chase_state;
@@ -354,7 +411,7 @@ int main(int argc, char* argv[]) {
               << current_time/86400.0 << " days)" << std::endl;
 
     // Export to JSON for Cesium
-    std::ofstream json("sat_tour_data.json");
+    AsyncOFStream json("sat_tour_data.json");
     json << std::fixed << std::setprecision(6);
     json << "{\n";
     json << "  \"metadata\": {\n";
@@ -434,5 +491,9 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\nExported to: sat_tour_data.json" << std::endl;
 
+    czml.close();
+    std::cout << "Exported to: sat_tour.czml (" << czml.samples_written() << " samples)" << std::endl;
+    if (archive.close()) std::cout << "Exported to: sat_tour.traj" << std::endl;
+
     return 0;
 }
@@ -24,6 +24,19 @@ namespace {
         return EARTH_RADIUS * c;
     }
 
+    // Single-wrap, branch-free forms of normalize_heading / normalize_angle
+    // (exact whenever one wrap suffices: heading in [-360, 720),
+    // angle in (-540, 540))
+    inline double wrap_heading(double heading) {
+        heading = heading < 0.0 ? heading + 360.0 : heading;
+        return heading >= 360.0 ? heading - 360.0 : heading;
+    }
+
+    inline double wrap_angle(double angle) {
+        angle = angle > 180.0 ? angle - 360.0 : angle;
+        return angle < -180.0 ? angle + 360.0 : angle;
+    }
+
     // Compute bearing from point 1 to point 2
     double compute_bearing(double lat1, double lon1, double lat2, double lon2) {
         double lat1_rad = lat1 * DEG_TO_RAD;
@@ -34,10 +47,7 @@ namespace {
         double x = std::cos(lat1_rad) * std::sin(lat2_rad) -
                    std::sin(lat1_rad) * std::cos(lat2_rad) * std::cos(dlon);
 
-        double bearing = std::atan2(y, x) * RAD_TO_DEG;
-        while (bearing < 0) bearing += 360.0;
-        while (bearing >= 360.0) bearing -= 360.0;
-        return bearing;
+        return wrap_heading(std::atan2(y, x) * RAD_TO_DEG);
     }
 
     double normalize_angle(double angle) {
@@ -53,89 +63,144 @@ namespace {
     }
 }
 
-GuidanceCommand proportional_navigation(
-    const MissileState& missile,
-    const GuidanceTarget& target,
-    double N) {
-
-    GuidanceCommand cmd;
+namespace {
 
-    // Compute geometry
-    double range_h = compute_range(missile.latitude, missile.longitude,
-                                   target.latitude, target.longitude);
-    double range_v = target.altitude - missile.altitude;
-    double range_3d = std::sqrt(range_h * range_h + range_v * range_v);
+/// Engagement geometry shared by every law
+struct Geometry {
+    double range_h;        // Ground range [m]
+    double range_v;        // Target altitude above missile [m]
+    double range_3d;
+    double los_azimuth;    // Bearing to target [deg]
+    double los_elevation;  // [deg]
+    double cos_az, sin_az; // Of los_azimuth
+    double cos_el, sin_el, tan_el;
+};
+
+/**
+ * compute_range and compute_bearing in one pass: the latitude and
+ * half-longitude trig is shared, and the LOS direction cosines come from
+ * the same components instead of further trig calls
+ */
+inline Geometry engagement_geometry(double lat, double lon, double alt,
+                                    double t_lat, double t_lon, double t_alt) {
+    Geometry g;
+    double lat1_rad = lat * DEG_TO_RAD;
+    double lat2_rad = t_lat * DEG_TO_RAD;
+    double s_hlat = std::sin((t_lat - lat) * DEG_TO_RAD / 2);
+    double s_hlon = std::sin((t_lon - lon) * DEG_TO_RAD / 2);
+    double c_hlon = std::cos((t_lon - lon) * DEG_TO_RAD / 2);
+    double cos_lat1 = std::cos(lat1_rad), sin_lat1 = std::sin(lat1_rad);
+    double cos_lat2 = std::cos(lat2_rad), sin_lat2 = std::sin(lat2_rad);
+
+    double a = s_hlat * s_hlat + cos_lat1 * cos_lat2 * s_hlon * s_hlon;
+    g.range_h = EARTH_RADIUS * 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+    g.range_v = t_alt - alt;
+    g.range_3d = std::sqrt(g.range_h * g.range_h + g.range_v * g.range_v);
+
+    double sin_dlon = 2 * s_hlon * c_hlon;
+    double cos_dlon = 1 - 2 * s_hlon * s_hlon;
+    double y = sin_dlon * cos_lat2;
+    double x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_dlon;
+    g.los_azimuth = wrap_heading(std::atan2(y, x) * RAD_TO_DEG);
+    g.los_elevation = std::atan2(g.range_v, g.range_h) * RAD_TO_DEG;
+
+    double h = std::sqrt(x * x + y * y);
+    g.cos_az = h > 0.0 ? x / h : 1.0;
+    g.sin_az = h > 0.0 ? y / h : 0.0;
+    g.cos_el = g.range_3d > 0.0 ? g.range_h / g.range_3d : 1.0;
+    g.sin_el = g.range_3d > 0.0 ? g.range_v / g.range_3d : 0.0;
+    g.tan_el = g.range_v / g.range_h;
+    return g;
+}
 
-    // Line of sight angles
-    double los_azimuth = compute_bearing(missile.latitude, missile.longitude,
-                                         target.latitude, target.longitude);
-    double los_elevation = std::atan2(range_v, range_h) * RAD_TO_DEG;
+/// Proportional navigation terms (the scalar and batched laws share these)
+struct PNTerms {
+    double closing_velocity;
+    double time_to_intercept;
+    double los_rate_az;    // [deg/s]
+    double los_rate_el;    // [deg/s]
+    double acceleration;   // [g]
+    double heading;        // Commanded [deg]
+    double flight_path;    // Commanded [deg]
+};
+
+inline PNTerms pn_terms(const Geometry& g, double speed, double heading, double fpa,
+                        double t_speed, double t_heading, double t_fpa, double N) {
+    PNTerms pn;
 
     // Relative velocity components
-    double v_m_north = missile.speed * std::cos(missile.heading * DEG_TO_RAD) *
-                       std::cos(missile.flight_path_angle * DEG_TO_RAD);
-    double v_m_east = missile.speed * std::sin(missile.heading * DEG_TO_RAD) *
-                      std::cos(missile.flight_path_angle * DEG_TO_RAD);
-    double v_m_up = missile.speed * std::sin(missile.flight_path_angle * DEG_TO_RAD);
-
-    double v_t_north = target.speed * std::cos(target.heading * DEG_TO_RAD) *
-                       std::cos(target.flight_path_angle * DEG_TO_RAD);
-    double v_t_east = target.speed * std::sin(target.heading * DEG_TO_RAD) *
-                      std::cos(target.flight_path_angle * DEG_TO_RAD);
-    double v_t_up = target.speed * std::sin(target.flight_path_angle * DEG_TO_RAD);
+    double v_m_horiz = speed * std::cos(fpa * DEG_TO_RAD);
+    double v_m_north = v_m_horiz * std::cos(heading * DEG_TO_RAD);
+    double v_m_east = v_m_horiz * std::sin(heading * DEG_TO_RAD);
+    double v_m_up = speed * std::sin(fpa * DEG_TO_RAD);
+
+    double v_t_horiz = t_speed * std::cos(t_fpa * DEG_TO_RAD);
+    double v_t_north = v_t_horiz * std::cos(t_heading * DEG_TO_RAD);
+    double v_t_east = v_t_horiz * std::sin(t_heading * DEG_TO_RAD);
+    double v_t_up = t_speed * std::sin(t_fpa * DEG_TO_RAD);
 
     double v_rel_north = v_t_north - v_m_north;
     double v_rel_east = v_t_east - v_m_east;
     double v_rel_up = v_t_up - v_m_up;
 
     // Closing velocity (positive = closing)
-    double los_unit_n = std::cos(los_azimuth * DEG_TO_RAD);
-    double los_unit_e = std::sin(los_azimuth * DEG_TO_RAD);
-    double los_unit_u = std::sin(los_elevation * DEG_TO_RAD);
+    double los_unit_n = g.cos_az;
+    double los_unit_e = g.sin_az;
+    double los_unit_u = g.sin_el;
 
-    cmd.closing_velocity = -(v_rel_north * los_unit_n + v_rel_east * los_unit_e +
-                             v_rel_up * los_unit_u * std::cos(los_elevation * DEG_TO_RAD));
+    pn.closing_velocity = -(v_rel_north * los_unit_n + v_rel_east * los_unit_e +
+                            v_rel_up * los_unit_u * g.cos_el);
 
     // Time to intercept (rough estimate)
-    if (cmd.closing_velocity > 10.0) {
-        cmd.time_to_intercept = range_3d / cmd.closing_velocity;
-    } else {
-        cmd.time_to_intercept = 999.0;
-    }
+    pn.time_to_intercept = pn.closing_velocity > 10.0 ? g.range_3d / pn.closing_velocity : 999.0;
 
-    // LOS rate (simplified - using angle differences)
-    // In a real implementation, this would use previous LOS measurements
-    double los_rate_az = 0.0;
-    double los_rate_el = 0.0;
-
-    // Estimate LOS rate from perpendicular velocity components
-    if (range_3d > 100.0) {
-        double v_perp_az = -v_rel_north * std::sin(los_azimuth * DEG_TO_RAD) +
-                           v_rel_east * std::cos(los_azimuth * DEG_TO_RAD);
-        double v_perp_el = v_rel_up - (v_rel_north * los_unit_n + v_rel_east * los_unit_e) *
-                           std::tan(los_elevation * DEG_TO_RAD);
-
-        los_rate_az = v_perp_az / range_h * RAD_TO_DEG;
-        los_rate_el = v_perp_el / range_3d * RAD_TO_DEG;
-    }
+    // LOS rate estimated from perpendicular velocity components
+    // (in a real implementation, this would use previous LOS measurements)
+    double v_perp_az = -v_rel_north * los_unit_e + v_rel_east * los_unit_n;
+    double v_perp_el = v_rel_up - (v_rel_north * los_unit_n + v_rel_east * los_unit_e) *
+                       g.tan_el;
+    bool resolved = g.range_3d > 100.0;
+    pn.los_rate_az = resolved ? v_perp_az / g.range_h * RAD_TO_DEG : 0.0;
+    pn.los_rate_el = resolved ? v_perp_el / g.range_3d * RAD_TO_DEG : 0.0;
 
     // PN command: a_cmd = N * Vc * LOS_rate
-    double a_cmd_lat = N * cmd.closing_velocity * los_rate_az * DEG_TO_RAD;
-    double a_cmd_vert = N * cmd.closing_velocity * los_rate_el * DEG_TO_RAD;
+    double a_cmd_lat = N * pn.closing_velocity * pn.los_rate_az * DEG_TO_RAD;
+    double a_cmd_vert = N * pn.closing_velocity * pn.los_rate_el * DEG_TO_RAD;
 
     // Convert to g's
-    cmd.commanded_acceleration = std::sqrt(a_cmd_lat * a_cmd_lat + a_cmd_vert * a_cmd_vert) / GRAVITY;
+    pn.acceleration = std::sqrt(a_cmd_lat * a_cmd_lat + a_cmd_vert * a_cmd_vert) / GRAVITY;
 
     // Convert acceleration to heading/flight path commands
     // Simplified: point toward where the acceleration command points
-    double heading_correction = std::atan2(a_cmd_lat, missile.speed) * RAD_TO_DEG;
-    double fpa_correction = std::atan2(a_cmd_vert, missile.speed) * RAD_TO_DEG;
+    double heading_correction = std::atan2(a_cmd_lat, speed) * RAD_TO_DEG;
+    double fpa_correction = std::atan2(a_cmd_vert, speed) * RAD_TO_DEG;
 
-    cmd.commanded_heading = normalize_heading(los_azimuth + heading_correction * 0.5);
-    cmd.commanded_flight_path = std::clamp(los_elevation + fpa_correction * 0.5, -45.0, 45.0);
+    pn.heading = wrap_heading(g.los_azimuth + heading_correction * 0.5);
+    pn.flight_path = std::clamp(g.los_elevation + fpa_correction * 0.5, -45.0, 45.0);
+    return pn;
+}
+
+} // namespace
+
+GuidanceCommand proportional_navigation(
+    const MissileState& missile,
+    const GuidanceTarget& target,
+    double N) {
+
+    GuidanceCommand cmd;
+    Geometry g = engagement_geometry(missile.latitude, missile.longitude, missile.altitude,
+                                     target.latitude, target.longitude, target.altitude);
+    PNTerms pn = pn_terms(g, missile.speed, missile.heading, missile.flight_path_angle,
+                          target.speed, target.heading, target.flight_path_angle, N);
+
+    cmd.closing_velocity = pn.closing_velocity;
+    cmd.time_to_intercept = pn.time_to_intercept;
+    cmd.commanded_acceleration = pn.acceleration;
+    cmd.commanded_heading = pn.heading;
+    cmd.commanded_flight_path = pn.flight_path;
 
     // Check if target in FOV
-    double off_boresight = std::abs(normalize_angle(los_azimuth - missile.heading));
+    double off_boresight = std::abs(normalize_angle(g.los_azimuth - missile.heading));
     cmd.target_in_fov = (off_boresight < missile.seeker_fov);
 
     return cmd;
@@ -165,15 +230,12 @@ GuidanceCommand pure_pursuit(
     GuidanceCommand cmd;
 
     // Simply point at target
-    double range_h = compute_range(missile.latitude, missile.longitude,
-                                   target.latitude, target.longitude);
-    double range_v = target.altitude - missile.altitude;
-    double range_3d = std::sqrt(range_h * range_h + range_v * range_v);
+    Geometry g = engagement_geometry(missile.latitude, missile.longitude, missile.altitude,
+                                     target.latitude, target.longitude, target.altitude);
+    double range_3d = g.range_3d;
 
-    cmd.commanded_heading = compute_bearing(missile.latitude, missile.longitude,
-                                            target.latitude, target.longitude);
-    cmd.commanded_flight_path = std::atan2(range_v, range_h) * RAD_TO_DEG;
-    cmd.commanded_flight_path = std::clamp(cmd.commanded_flight_path, -45.0, 45.0);
+    cmd.commanded_heading = g.los_azimuth;
+    cmd.commanded_flight_path = std::clamp(g.los_elevation, -45.0, 45.0);
 
     // Compute required acceleration to turn
     double heading_error = std::abs(normalize_angle(cmd.commanded_heading - missile.heading));
@@ -205,8 +267,9 @@ GuidanceCommand lead_pursuit(
     GuidanceCommand cmd;
 
     // Point ahead of target
-    double bearing_to_target = compute_bearing(missile.latitude, missile.longitude,
-                                               target.latitude, target.longitude);
+    Geometry g = engagement_geometry(missile.latitude, missile.longitude, missile.altitude,
+                                     target.latitude, target.longitude, target.altitude);
+    double bearing_to_target = g.los_azimuth;
 
     // Add lead in direction of target motion
     double target_velocity_heading = target.heading;
@@ -215,13 +278,8 @@ GuidanceCommand lead_pursuit(
 
     cmd.commanded_heading = normalize_heading(bearing_to_target + lead_sign * lead_angle);
 
-    double range_h = compute_range(missile.latitude, missile.longitude,
-                                   target.latitude, target.longitude);
-    double range_v = target.altitude - missile.altitude;
-    double range_3d = std::sqrt(range_h * range_h + range_v * range_v);
-
-    cmd.commanded_flight_path = std::atan2(range_v, range_h) * RAD_TO_DEG;
-    cmd.commanded_flight_path = std::clamp(cmd.commanded_flight_path, -45.0, 45.0);
+    double range_3d = g.range_3d;
+    cmd.commanded_flight_path = std::clamp(g.los_elevation, -45.0, 45.0);
 
     double heading_error = std::abs(normalize_angle(cmd.commanded_heading - missile.heading));
     cmd.commanded_acceleration = (heading_error / 10.0) * (missile.speed / 100.0);
@@ -259,6 +317,111 @@ GuidanceCommand compute_guidance(
     }
 }
 
+// ============================================================================
+// Batched guidance
+// ============================================================================
+
+void GuidanceBatch::resize(size_t n) {
+    for (auto* v : {&latitude, &longitude, &altitude, &speed, &heading, &flight_path_angle,
+                    &seeker_fov, &navigation_constant, &target_accel,
+                    &target_latitude, &target_longitude, &target_altitude,
+                    &target_speed, &target_heading, &target_flight_path_angle,
+                    &los_rate_azimuth, &los_rate_elevation, &commanded_heading,
+                    &commanded_flight_path, &commanded_acceleration, &time_to_intercept,
+                    &closing_velocity}) {
+        v->resize(n);
+    }
+    law.resize(n);
+    target_in_fov.resize(n);
+}
+
+void GuidanceBatch::set(size_t i, const MissileState& missile, const GuidanceTarget& target,
+                        const GuidanceParams& params, double accel) {
+    latitude[i] = missile.latitude;
+    longitude[i] = missile.longitude;
+    altitude[i] = missile.altitude;
+    speed[i] = missile.speed;
+    heading[i] = missile.heading;
+    flight_path_angle[i] = missile.flight_path_angle;
+    seeker_fov[i] = missile.seeker_fov;
+    law[i] = static_cast<uint8_t>(params.law);
+    navigation_constant[i] = params.navigation_constant;
+    target_accel[i] = accel;
+
+    target_latitude[i] = target.latitude;
+    target_longitude[i] = target.longitude;
+    target_altitude[i] = target.altitude;
+    target_speed[i] = target.speed;
+    target_heading[i] = target.heading;
+    target_flight_path_angle[i] = target.flight_path_angle;
+}
+
+GuidanceCommand GuidanceBatch::command(size_t i) const {
+    GuidanceCommand cmd;
+    cmd.commanded_heading = commanded_heading[i];
+    cmd.commanded_flight_path = commanded_flight_path[i];
+    cmd.commanded_acceleration = commanded_acceleration[i];
+    cmd.target_in_fov = target_in_fov[i] != 0;
+    cmd.time_to_intercept = time_to_intercept[i];
+    cmd.closing_velocity = closing_velocity[i];
+    return cmd;
+}
+
+void compute_guidance(GuidanceBatch& b) {
+    constexpr double LEAD_ANGLE = 15.0;   // As compute_guidance's LEAD_PURSUIT
+    const size_t n = b.size();
+
+    for (size_t i = 0; i < n; i++) {
+        const double speed = b.speed[i];
+        const double t_speed = b.target_speed[i];
+        const double t_heading = b.target_heading[i];
+
+        // ── Shared geometry ──
+        Geometry g = engagement_geometry(b.latitude[i], b.longitude[i], b.altitude[i],
+                                         b.target_latitude[i], b.target_longitude[i],
+                                         b.target_altitude[i]);
+        const double los_azimuth = g.los_azimuth;
+        const double range_3d = g.range_3d;
+        double off_boresight = std::abs(wrap_angle(los_azimuth - b.heading[i]));
+        bool in_fov = off_boresight < b.seeker_fov[i];
+
+        // ── Proportional navigation ──
+        const double N = b.navigation_constant[i];
+        PNTerms pn = pn_terms(g, speed, b.heading[i], b.flight_path_angle[i],
+                              t_speed, t_heading, b.target_flight_path_angle[i], N);
+        double acc_apn = pn.acceleration + (N / 2.0) * b.target_accel[i];
+
+        // ── Pure pursuit ──
+        double fpa_pursuit = std::clamp(g.los_elevation, -45.0, 45.0);
+        double acc_pp = (off_boresight / 10.0) * (speed / 100.0);
+        double cv_pp = speed - t_speed * std::cos((t_heading - los_azimuth) * DEG_TO_RAD);
+        double tti_pp = cv_pp > 10.0 ? range_3d / cv_pp : 999.0;
+
+        // ── Lead pursuit ──
+        double lead_sign = wrap_angle(t_heading - los_azimuth) > 0 ? 1.0 : -1.0;
+        double heading_lp = wrap_heading(los_azimuth + lead_sign * LEAD_ANGLE);
+        double acc_lp = (std::abs(wrap_angle(heading_lp - b.heading[i])) / 10.0) * (speed / 100.0);
+        double cv_lp = speed + t_speed * 0.5;
+        double tti_lp = range_3d / cv_lp;
+
+        // ── Law selection; unknown laws fall back to PN ──
+        const uint8_t law = b.law[i];
+        const bool apn = law == static_cast<uint8_t>(GuidanceLaw::AUGMENTED_PN);
+        const bool pp = law == static_cast<uint8_t>(GuidanceLaw::PURE_PURSUIT);
+        const bool lp = law == static_cast<uint8_t>(GuidanceLaw::LEAD_PURSUIT);
+        const bool pn_family = !pp && !lp;
+
+        b.los_rate_azimuth[i] = pn_family ? pn.los_rate_az : 0.0;
+        b.los_rate_elevation[i] = pn_family ? pn.los_rate_el : 0.0;
+        b.commanded_heading[i] = pp ? los_azimuth : lp ? heading_lp : pn.heading;
+        b.commanded_flight_path[i] = pn_family ? pn.flight_path : fpa_pursuit;
+        b.commanded_acceleration[i] = pp ? acc_pp : lp ? acc_lp : apn ? acc_apn : pn.acceleration;
+        b.closing_velocity[i] = pp ? cv_pp : lp ? cv_lp : pn.closing_velocity;
+        b.time_to_intercept[i] = pp ? tti_pp : lp ? tti_lp : pn.time_to_intercept;
+        b.target_in_fov[i] = in_fov;
+    }
+}
+
 void update_missile_state(
     MissileState& missile,
     const GuidanceCommand& cmd,
@@ -1,6 +1,7 @@
 #ifndef MISSILE_GUIDANCE_HPP
 #define MISSILE_GUIDANCE_HPP
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -14,6 +15,9 @@ namespace sim {
  * - Augmented Proportional Navigation (APN)
  * - Pure Pursuit
  * - Lead Pursuit
+ *
+ * GuidanceBatch runs the same laws over a salvo in structure-of-arrays
+ * form, one pass for every missile and law.
  */
 
 /**
@@ -170,6 +174,64 @@ GuidanceCommand lead_pursuit(
     const GuidanceTarget& target,
     double lead_angle);
 
+/**
+ * Structure-of-arrays guidance inputs and outputs for a salvo
+ *
+ * Slot i pairs one missile with its target. compute_guidance(batch)
+ * evaluates the shared geometry (range, LOS, relative velocity) once per
+ * slot, forms every law's command from it, and picks each slot's law with
+ * a select mask instead of a per-missile dispatch. The loop body has no
+ * data-dependent branches, so it vectorizes wherever vector trig is
+ * available. Per slot the results equal compute_guidance() on the same
+ * missile and target, provided headings lie within (-540, 540) degrees
+ * (update_missile_state keeps them in [0, 360)).
+ *
+ * Usage:
+ *   GuidanceBatch batch;
+ *   batch.resize(n);
+ *   for (size_t i = 0; i < n; i++) batch.set(i, missiles[i], targets[i], params);
+ *   compute_guidance(batch);
+ *   update_missile_state(missiles[i], batch.command(i), dt);
+ */
+struct GuidanceBatch {
+    // Missiles
+    std::vector<double> latitude, longitude, altitude;     // degrees, degrees, meters
+    std::vector<double> speed, heading, flight_path_angle; // m/s, degrees, degrees
+    std::vector<double> seeker_fov;                        // degrees (half-angle)
+    std::vector<uint8_t> law;                              // GuidanceLaw
+    std::vector<double> navigation_constant;
+    std::vector<double> target_accel;                      // g's (APN compensation)
+
+    // Targets
+    std::vector<double> target_latitude, target_longitude, target_altitude;
+    std::vector<double> target_speed, target_heading, target_flight_path_angle;
+
+    // Outputs
+    std::vector<double> los_rate_azimuth;                  // deg/s (PN family)
+    std::vector<double> los_rate_elevation;                // deg/s (PN family)
+    std::vector<double> commanded_heading;                 // degrees
+    std::vector<double> commanded_flight_path;             // degrees
+    std::vector<double> commanded_acceleration;            // g's
+    std::vector<double> time_to_intercept;                 // seconds
+    std::vector<double> closing_velocity;                  // m/s
+    std::vector<uint8_t> target_in_fov;
+
+    size_t size() const { return latitude.size(); }
+    void resize(size_t n);
+
+    /** Fill slot i (target_accel feeds AUGMENTED_PN; compute_guidance uses 0) */
+    void set(size_t i, const MissileState& missile, const GuidanceTarget& target,
+             const GuidanceParams& params, double target_accel = 0.0);
+
+    /** Slot i's outputs as a scalar command */
+    GuidanceCommand command(size_t i) const;
+};
+
+/**
+ * Guidance commands for every slot of a batch
+ */
+void compute_guidance(GuidanceBatch& batch);
+
 /**
  * Update missile state based on guidance command
  *
@@ -1,5 +1,6 @@
 #include "tactical_ai.hpp"
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
 
 namespace sim {
@@ -68,39 +69,144 @@ TacticalAI::TacticalAI(const EngagementParams& params)
     , guns_remaining_(params.guns_rounds) {
 }
 
-TargetInfo* TacticalAI::select_priority_target(std::vector<TargetInfo>& targets) {
-    TargetInfo* best = nullptr;
-    double best_score = -1e12;
+double TacticalAI::score_target(const TargetInfo& t) const {
+    // Scoring: closer = higher priority, head-on = higher
+    double score = 0.0;
 
-    for (auto& t : targets) {
-        if (!t.is_hostile) continue;
+    // Range factor (closer is better, but not too close)
+    if (t.range_km < params_.wvr_range_km) {
+        score += 100.0;  // Immediate threat
+    } else if (t.range_km < params_.bvr_max_range_km) {
+        score += 50.0 * (params_.bvr_max_range_km - t.range_km) / params_.bvr_max_range_km;
+    }
 
-        // Scoring: closer = higher priority, head-on = higher
-        double score = 0.0;
+    // Aspect factor (head-on is higher threat)
+    double aspect_factor = std::abs(std::cos(t.aspect_deg * M_PI / 180.0));
+    score += 20.0 * aspect_factor;
 
-        // Range factor (closer is better, but not too close)
-        if (t.range_km < params_.wvr_range_km) {
-            score += 100.0;  // Immediate threat
-        } else if (t.range_km < params_.bvr_max_range_km) {
-            score += 50.0 * (params_.bvr_max_range_km - t.range_km) / params_.bvr_max_range_km;
-        }
+    // Closure rate (closing fast = higher threat)
+    if (t.closure_rate_mps > 0) {
+        score += t.closure_rate_mps / 10.0;
+    }
+    return score;
+}
+
+int TacticalAI::range_band(double range_km) const {
+    if (range_km < params_.wvr_range_km) return 0;
+    if (range_km < params_.bvr_max_range_km) return 1;
+    return 2;
+}
+
+void TacticalAI::clear_threats() {
+    threats_.clear();
+    slot_by_id_.clear();
+    slot_map_.clear();
+    heap_ = {};
+    under_attack_ = 0;
+}
+
+size_t TacticalAI::find_slot(int id) const {
+    if (id >= 0 && id < DIRECT_IDS) {
+        return static_cast<size_t>(id) < slot_by_id_.size() ? slot_by_id_[id] : NO_SLOT;
+    }
+    auto it = slot_map_.find(id);
+    return it == slot_map_.end() ? NO_SLOT : it->second;
+}
+
+void TacticalAI::set_slot(int id, size_t slot) {
+    if (id >= 0 && id < DIRECT_IDS) {
+        if (static_cast<size_t>(id) >= slot_by_id_.size()) slot_by_id_.resize(id + 1, NO_SLOT);
+        slot_by_id_[id] = slot;
+    } else {
+        slot_map_[id] = slot;
+    }
+}
 
-        // Aspect factor (head-on is higher threat)
-        double aspect_factor = std::abs(std::cos(t.aspect_deg * M_PI / 180.0));
-        score += 20.0 * aspect_factor;
+void TacticalAI::erase_slot(int id) {
+    if (id >= 0 && id < DIRECT_IDS) {
+        slot_by_id_[id] = NO_SLOT;
+    } else {
+        slot_map_.erase(id);
+    }
+}
+
+void TacticalAI::update_threats(const std::vector<TargetInfo>& targets) {
+    const uint32_t epoch = ++epoch_;
+    size_t seen = 0;
 
-        // Closure rate (closing fast = higher threat)
-        if (t.closure_rate_mps > 0) {
-            score += t.closure_rate_mps / 10.0;
+    for (const auto& t : targets) {
+        if (!t.is_hostile) continue;
+
+        size_t slot = find_slot(t.id);
+        bool fresh = slot == NO_SLOT;
+        if (fresh) {
+            slot = threats_.size();
+            threats_.emplace_back();
+            set_slot(t.id, slot);
+        }
+        Threat& th = threats_[slot];
+        if (!fresh && th.seen == epoch) continue;   // duplicate ID: first entry wins
+        th.id = t.id;
+        th.info = &t;
+        th.seen = epoch;
+        seen++;
+
+        bool attacking = t.closure_rate_mps > 200.0 && t.range_km < params_.bvr_max_range_km;
+        if (attacking != th.attacking) {
+            under_attack_ += attacking ? 1 : -1;
+            th.attacking = attacking;
         }
 
-        if (score > best_score) {
-            best_score = score;
-            best = &t;
+        // Rescore on new targets, gate crossings and drift past tolerance
+        int band = range_band(t.range_km);
+        if (fresh || band != th.band ||
+            std::abs(t.range_km - th.scored_range_km) > params_.threat_range_tol_km ||
+            std::abs(t.aspect_deg - th.scored_aspect_deg) > params_.threat_aspect_tol_deg ||
+            std::abs(t.closure_rate_mps - th.scored_closure_mps) > params_.threat_closure_tol_mps) {
+            th.score = score_target(t);
+            th.scored_range_km = t.range_km;
+            th.scored_aspect_deg = t.aspect_deg;
+            th.scored_closure_mps = t.closure_rate_mps;
+            th.band = band;
+            th.version++;
+            heap_.push({th.score, t.id, th.version});
+        }
+    }
+
+    // Lost targets leave the board (swap-remove; their heap nodes go stale)
+    for (size_t i = 0; seen != threats_.size() && i < threats_.size();) {
+        if (threats_[i].seen == epoch) {
+            i++;
+            continue;
         }
+        if (threats_[i].attacking) under_attack_--;
+        erase_slot(threats_[i].id);
+        if (i + 1 != threats_.size()) {
+            threats_[i] = threats_.back();
+            set_slot(threats_[i].id, i);
+        }
+        threats_.pop_back();
     }
 
-    return best;
+    // Bound the stale nodes a long engagement leaves behind
+    if (heap_.size() > 2 * threats_.size() + 16) {
+        std::vector<HeapNode> live;
+        live.reserve(threats_.size());
+        for (const Threat& th : threats_) live.push_back({th.score, th.id, th.version});
+        heap_ = std::priority_queue<HeapNode>(std::less<HeapNode>(), std::move(live));
+    }
+}
+
+const TargetInfo* TacticalAI::top_threat() {
+    while (!heap_.empty()) {
+        const HeapNode& top = heap_.top();
+        size_t slot = find_slot(top.id);
+        if (slot != NO_SLOT && threats_[slot].version == top.version) {
+            return threats_[slot].info;
+        }
+        heap_.pop();
+    }
+    return nullptr;
 }
 
 double TacticalAI::compute_intercept_heading(double own_heading, const TargetInfo& target) {
@@ -136,31 +242,14 @@ TacticalDecision TacticalAI::update(
     decision.target_id = -1;
     decision.reason = "";
 
-    // Make a mutable copy for target selection
-    std::vector<TargetInfo> mutable_targets = targets;
-
-    // Find hostile targets
-    std::vector<TargetInfo*> hostile_targets;
-    for (auto& t : mutable_targets) {
-        if (t.is_hostile) {
-            hostile_targets.push_back(&t);
-        }
-    }
-
-    // Check for incoming threats (anyone shooting at us)
-    bool under_attack = false;
-    for (const auto& t : targets) {
-        if (t.is_hostile && t.closure_rate_mps > 200.0 && t.range_km < params_.bvr_max_range_km) {
-            under_attack = true;
-            break;
-        }
-    }
+    update_threats(targets);
+    const bool under_attack = under_attack_ > 0;
 
     // State machine
     switch (current_state) {
         case TacticalState::PATROL: {
             // Searching - maintain patrol heading
-            if (!hostile_targets.empty()) {
+            if (!threats_.empty()) {
                 decision.new_state = TacticalState::DETECTED;
                 decision.reason = "Contact detected";
             }
@@ -169,7 +258,7 @@ TacticalDecision TacticalAI::update(
 
         case TacticalState::DETECTED: {
             // Evaluate and decide to engage
-            TargetInfo* priority = select_priority_target(mutable_targets);
+            const TargetInfo* priority = top_threat();
             if (!priority) {
                 decision.new_state = TacticalState::PATROL;
                 decision.reason = "Lost contact";
@@ -191,7 +280,7 @@ TacticalDecision TacticalAI::update(
         }
 
         case TacticalState::COMMIT: {
-            TargetInfo* priority = select_priority_target(mutable_targets);
+            const TargetInfo* priority = top_threat();
             if (!priority) {
                 decision.new_state = TacticalState::PATROL;
                 decision.reason = "Lost target";
@@ -225,7 +314,7 @@ TacticalDecision TacticalAI::update(
 
         case TacticalState::LAUNCH: {
             // Transition to crank after launch
-            TargetInfo* priority = select_priority_target(mutable_targets);
+            const TargetInfo* priority = top_threat();
             if (priority) {
                 decision.target_id = priority->id;
                 decision.commanded_heading_deg = compute_crank_heading(own_heading, *priority);
@@ -237,7 +326,7 @@ TacticalDecision TacticalAI::update(
 
         case TacticalState::CRANK: {
             // Maintain crank maneuver
-            TargetInfo* priority = select_priority_target(mutable_targets);
+            const TargetInfo* priority = top_threat();
             if (priority) {
                 decision.target_id = priority->id;
                 decision.commanded_heading_deg = compute_crank_heading(own_heading, *priority);
@@ -279,10 +368,10 @@ TacticalDecision TacticalAI::update(
         case TacticalState::DEFEND: {
             // Defensive maneuvers
             // Turn perpendicular to threat, descend, increase speed
-            TargetInfo* threat = nullptr;
-            for (auto* t : hostile_targets) {
-                if (t->closure_rate_mps > 200.0) {
-                    threat = t;
+            const TargetInfo* threat = nullptr;
+            for (const auto& t : targets) {
+                if (t.is_hostile && t.closure_rate_mps > 200.0) {
+                    threat = &t;
                     break;
                 }
             }
@@ -307,7 +396,7 @@ TacticalDecision TacticalAI::update(
 
         case TacticalState::MERGE: {
             // Close range fight
-            TargetInfo* priority = select_priority_target(mutable_targets);
+            const TargetInfo* priority = top_threat();
             if (priority) {
                 decision.target_id = priority->id;
                 decision.commanded_heading_deg = compute_intercept_heading(own_heading, *priority);
@@ -334,12 +423,12 @@ TacticalDecision TacticalAI::update(
 
         case TacticalState::DISENGAGE: {
             // Break off and extend
-            TargetInfo* nearest = nullptr;
+            const TargetInfo* nearest = nullptr;
             double min_range = 1e12;
-            for (auto* t : hostile_targets) {
-                if (t->range_km < min_range) {
-                    min_range = t->range_km;
-                    nearest = t;
+            for (const auto& t : targets) {
+                if (t.is_hostile && t.range_km < min_range) {
+                    min_range = t.range_km;
+                    nearest = &t;
                 }
             }
 
@@ -1,7 +1,10 @@
 #ifndef TACTICAL_AI_HPP
 #define TACTICAL_AI_HPP
 
+#include <cstdint>
+#include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace sim {
@@ -76,6 +79,13 @@ struct EngagementParams {
     // Maneuver parameters
     double crank_angle_deg = 70.0;       // Angle off for crank maneuver
     double pump_turn_deg = 120.0;        // Turn angle for pump
+
+    // Threat board: a target's score is recomputed only once its inputs
+    // move past these since it was last scored, or its range crosses the
+    // WVR / BVR-max gate (0 = rescore on any change)
+    double threat_range_tol_km = 0.5;
+    double threat_aspect_tol_deg = 2.0;
+    double threat_closure_tol_mps = 10.0;
 };
 
 /**
@@ -112,6 +122,15 @@ struct TacticalDecision {
  * Tactical AI Controller
  *
  * Manages state transitions and tactical decision-making for a single aircraft.
+ *
+ * Hostile targets live on an incremental threat board keyed by target ID:
+ * each update() refreshes the entries from the picture, rescores only the
+ * ones whose geometry moved past the EngagementParams tolerances (or that
+ * are new, or crossed a range gate), drops targets that left the picture,
+ * and takes the top threat from a max-heap with lazy deletion. Equal scores
+ * go to the lower ID. The "under attack" test (closure > 200 m/s inside
+ * BVR range) is kept as a count updated per entry, so no per-call pass
+ * over the picture scores, sorts or copies it.
  */
 class TacticalAI {
 public:
@@ -156,6 +175,12 @@ public:
     int get_wvr_remaining() const { return wvr_remaining_; }
     int get_guns_remaining() const { return guns_remaining_; }
 
+    /** Hostile targets on the threat board after the last update(). */
+    size_t threat_count() const { return threats_.size(); }
+
+    /** Forget every tracked threat (e.g. on respawn). */
+    void clear_threats();
+
 private:
     EngagementParams params_;
     int bvr_remaining_;
@@ -166,8 +191,50 @@ private:
     int last_target_id_ = -1;
     double time_since_last_shot_ = 999.0;
 
+    // ── Threat board ──
+    struct Threat {
+        int id = -1;
+        const TargetInfo* info = nullptr;   // entry in the current update's picture
+        double score = 0.0;
+        double scored_range_km = 0.0;   // inputs at the last rescore
+        double scored_aspect_deg = 0.0;
+        double scored_closure_mps = 0.0;
+        int band = 0;              // range gate: 0 WVR, 1 BVR, 2 beyond
+        uint32_t version = 0;      // bumped on rescore; stale heap nodes differ
+        uint32_t seen = 0;         // update() epoch that last saw it
+        bool attacking = false;    // counts toward under_attack_
+    };
+    struct HeapNode {
+        double score;
+        int id;
+        uint32_t version;
+        bool operator<(const HeapNode& o) const {
+            return score < o.score || (score == o.score && id > o.id);
+        }
+    };
+    std::vector<Threat> threats_;
+    // Target ID -> threats_ index: a flat table for IDs below DIRECT_IDS
+    // (entity IDs are small and dense), a map for the rest
+    static constexpr int DIRECT_IDS = 1 << 16;
+    static constexpr size_t NO_SLOT = SIZE_MAX;
+    std::vector<size_t> slot_by_id_;
+    std::unordered_map<int, size_t> slot_map_;
+
+    size_t find_slot(int id) const;
+    void set_slot(int id, size_t slot);
+    void erase_slot(int id);
+    std::priority_queue<HeapNode> heap_;
+    uint32_t epoch_ = 0;
+    int under_attack_ = 0;
+
+    /** Refresh the board from this update's picture. */
+    void update_threats(const std::vector<TargetInfo>& targets);
+    /** Highest-scoring threat (nullptr if none). */
+    const TargetInfo* top_threat();
+    double score_target(const TargetInfo& t) const;
+    int range_band(double range_km) const;
+
     // Decision helpers
-    TargetInfo* select_priority_target(std::vector<TargetInfo>& targets);
     double compute_intercept_heading(double own_heading, const TargetInfo& target);
     double compute_crank_heading(double own_heading, const TargetInfo& target);
 };
@@ -0,0 +1,172 @@
+#include "cw_propagator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sim {
+
+CWPropagator::CWPropagator(double n, double grid_step, size_t grid_size)
+    : n_(n), grid_step_(grid_step) {
+    if (!(n > 0.0) || !(grid_step > 0.0) || grid_size == 0) {
+        throw std::invalid_argument("CWPropagator: mean motion, grid step and size must be positive");
+    }
+
+    cos_.resize(grid_size);
+    sin_.resize(grid_size);
+    grid_.resize(grid_size);
+    for (size_t k = 0; k < grid_size; k++) {
+        double nt = n_ * (static_cast<double>(k) * grid_step_);
+        cos_[k] = std::cos(nt);
+        sin_[k] = std::sin(nt);
+        grid_[k] = CWTargeting::compute_state_matrix(n_, nt, cos_[k], sin_[k]);
+    }
+}
+
+void CWPropagator::phase(double dt, double& c, double& s) const {
+    double k_real = std::floor(dt / grid_step_);
+    double k_max = static_cast<double>(grid_.size() - 1);
+    size_t k = static_cast<size_t>(std::min(std::max(k_real, 0.0), k_max));
+
+    double rem = dt - static_cast<double>(k) * grid_step_;
+    if (rem == 0.0) {
+        c = cos_[k];
+        s = sin_[k];
+        return;
+    }
+
+    // cos(a + b), sin(a + b)
+    double cr = std::cos(n_ * rem);
+    double sr = std::sin(n_ * rem);
+    c = cos_[k] * cr - sin_[k] * sr;
+    s = sin_[k] * cr + cos_[k] * sr;
+}
+
+CWStateMatrix CWPropagator::state_matrix(double dt) const {
+    double k_real = dt / grid_step_;
+    if (k_real >= 0.0 && k_real < static_cast<double>(grid_.size()) &&
+        k_real == std::floor(k_real)) {
+        return grid_[static_cast<size_t>(k_real)];
+    }
+
+    double c, s;
+    phase(dt, c, s);
+    return CWTargeting::compute_state_matrix(n_, n_ * dt, c, s);
+}
+
+void CWPropagator::propagate(const Vec3& r0_ric, const Vec3& v0_ric, double dt,
+                             Vec3& r_ric, Vec3& v_ric) const {
+    CWTargeting::apply_state_matrix(state_matrix(dt), r0_ric, v0_ric, r_ric, v_ric);
+}
+
+void CWPropagator::sweep_phases(double first_tof, double tof_step, size_t count,
+                                std::vector<double>& c, std::vector<double>& s) const {
+    c.resize(count);
+    s.resize(count);
+
+    // Fixed rotation per candidate, re-anchored to the table periodically
+    double cd = std::cos(n_ * tof_step);
+    double sd = std::sin(n_ * tof_step);
+    for (size_t j = 0; j < count; j++) {
+        if (j % RENORM_INTERVAL == 0) {
+            phase(first_tof + static_cast<double>(j) * tof_step, c[j], s[j]);
+        } else {
+            c[j] = c[j - 1] * cd - s[j - 1] * sd;
+            s[j] = s[j - 1] * cd + c[j - 1] * sd;
+        }
+    }
+}
+
+void CWPropagator::two_burn_delta_v(const Vec3& r0_ric, const Vec3& v0_ric,
+                                    double first_tof, double tof_step, size_t count,
+                                    double* total_dv) const {
+    std::vector<double> cs, sn;
+    sweep_phases(first_tof, tof_step, count, cs, sn);
+
+    const double n = n_;
+    const double inv_n = 1.0 / n_;
+    const double x = r0_ric.x, y = r0_ric.y, z = r0_ric.z;
+    const double vx = v0_ric.x, vy = v0_ric.y, vz = v0_ric.z;
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    // CWTargeting::solve_two_burn_rendezvous with the zero entries of the
+    // matrices dropped
+    for (size_t j = 0; j < count; j++) {
+        double nt = n * (first_tof + static_cast<double>(j) * tof_step);
+        double c = cs[j];
+        double s = sn[j];
+
+        double rv00 = s * inv_n;
+        double rv01 = 2.0 * (1.0 - c) * inv_n;
+        double rv10 = 2.0 * (c - 1.0) * inv_n;
+        double rv11 = (4.0 * s - 3.0 * nt) * inv_n;
+
+        double rhs_x = -((4.0 - 3.0 * c) * x) - (rv00 * vx + rv01 * vy);
+        double rhs_y = -(6.0 * (s - nt) * x + y) - (rv10 * vx + rv11 * vy);
+        double rhs_z = -(c * z) - (rv00 * vz);
+
+        double det = rv00 * rv11 - rv01 * rv10;
+        bool singular = std::abs(det) < 1e-12;
+        double inv_det = singular ? 0.0 : 1.0 / det;
+
+        double d1x = (rv11 * rhs_x - rv01 * rhs_y) * inv_det;
+        double d1y = (-rv10 * rhs_x + rv00 * rhs_y) * inv_det;
+        double d1z = std::abs(rv00) > 1e-12 ? rhs_z / rv00 : 0.0;
+
+        double wx = vx + d1x, wy = vy + d1y, wz = vz + d1z;
+        double ax = 3.0 * n * s * x + c * wx + 2.0 * s * wy;
+        double ay = 6.0 * n * (c - 1.0) * x - 2.0 * s * wx + (4.0 * c - 3.0) * wy;
+        double az = -n * s * z + c * wz;
+
+        double dv = std::sqrt(d1x * d1x + d1y * d1y + d1z * d1z) +
+                    std::sqrt(ax * ax + ay * ay + az * az);
+        total_dv[j] = singular ? INF : dv;
+    }
+}
+
+void CWPropagator::optimal_delta_v(const Vec3& r0_ric, const Vec3& v0_ric,
+                                   double first_tof, double tof_step, size_t count,
+                                   double v_circ, double* total_dv) const {
+    (void)v_circ;  // solve_phasing_maneuver does not use it either
+    two_burn_delta_v(r0_ric, v0_ric, first_tof, tof_step, count, total_dv);
+
+    // The closed-form alternatives of CWTargeting::solve_optimal, by
+    // transfer time window
+    const double T_half = M_PI / n_;
+    const double I0 = r0_ric.y;
+    const double half_period_dv = 2.0 * std::abs(I0 * n_ / 4.0);
+    const bool in_track = std::abs(I0) > 5.0 * std::abs(r0_ric.x);
+
+    for (size_t j = 0; j < count; j++) {
+        double tof = first_tof + static_cast<double>(j) * tof_step;
+        double best = total_dv[j];
+
+        if (std::abs(tof - T_half) / T_half < 0.1) {
+            best = std::min(best, half_period_dv);
+        }
+        if (in_track && tof > T_half) {
+            double delta_a = 2.0 * I0 / (3.0 * n_ * tof);
+            best = std::min(best, 2.0 * (n_ * std::abs(delta_a) / 2.0));
+        }
+        total_dv[j] = best;
+    }
+}
+
+CWManeuver CWPropagator::solve_optimal(const Vec3& r0_ric, const Vec3& v0_ric,
+                                       double first_tof, double tof_step, size_t count,
+                                       double v_circ) const {
+    if (count == 0) return CWTargeting::solve_optimal(r0_ric, v0_ric, first_tof, n_, v_circ);
+
+    std::vector<double> total(count);
+    optimal_delta_v(r0_ric, v0_ric, first_tof, tof_step, count, v_circ, total.data());
+
+    size_t best = 0;
+    for (size_t j = 1; j < count; j++) {
+        if (total[j] < total[best]) best = j;
+    }
+
+    double tof = first_tof + static_cast<double>(best) * tof_step;
+    return CWTargeting::solve_optimal(r0_ric, v0_ric, tof, n_, v_circ);
+}
+
+} // namespace sim
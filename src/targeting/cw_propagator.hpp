@@ -0,0 +1,104 @@
+#ifndef CW_PROPAGATOR_HPP
+#define CW_PROPAGATOR_HPP
+
+#include <cstddef>
+#include <vector>
+#include "core/state_vector.hpp"
+#include "cw_targeting.hpp"
+
+namespace sim {
+
+/**
+ * Clohessy-Wiltshire propagator bound to one reference orbit
+ *
+ * CWTargeting::compute_state_matrix evaluates cos(nt) and sin(nt) for every
+ * query. Planners that sweep many transfer times about the same target
+ * repeat that work for each candidate. This object fixes the mean motion and
+ * tabulates the phase (cos, sin) and the full matrices on a dt grid once.
+ *
+ * Every CW matrix entry is a function of nt, cos(nt) and sin(nt) only, so
+ * Phi(a + b) = Phi(a) Phi(b) reduces to the angle-addition
+ * identities. Off-grid times compose the nearest grid phase below with
+ * the remainder's phase (one sin/cos pair). Evenly spaced sweeps
+ * advance the phase by a fixed rotation and need no trig per candidate.
+ * They are re-anchored to the table every RENORM_INTERVAL candidates so
+ * rounding does not accumulate.
+ *
+ * The batch solvers write one total delta-V per candidate into a flat
+ * array, in loops without calls or allocation (singular cases are
+ * selects) that the compiler can vectorize.
+ *
+ * Usage:
+ *   CWPropagator cw(n, 60.0, 200);          // 60 s grid out to 200 min
+ *   CWManeuver best = cw.solve_optimal(r0, v0, 600.0, 30.0, 400, v_circ);
+ */
+class CWPropagator {
+public:
+    /**
+     * @param n Mean motion of the reference orbit (rad/s)
+     * @param grid_step Tabulated dt spacing (seconds)
+     * @param grid_size Number of tabulated times, starting at dt = 0
+     */
+    CWPropagator(double n, double grid_step, size_t grid_size);
+
+    double mean_motion() const { return n_; }
+    double grid_step() const { return grid_step_; }
+    size_t grid_size() const { return grid_.size(); }
+
+    /// Cached matrices at dt = k * grid_step
+    const CWStateMatrix& grid_matrix(size_t k) const { return grid_[k]; }
+
+    /// State transition matrices for any dt (cached when dt is on the grid)
+    CWStateMatrix state_matrix(double dt) const;
+
+    /// Propagate relative state by dt
+    void propagate(const Vec3& r0_ric, const Vec3& v0_ric, double dt,
+                   Vec3& r_ric, Vec3& v_ric) const;
+
+    /**
+     * Two-burn rendezvous total delta-V for transfer times
+     * first_tof + j * tof_step, j < count
+     * @param total_dv Output, count entries (m/s); +inf where the CW system
+     *                 is singular (CWTargeting::solve_two_burn_rendezvous invalid)
+     */
+    void two_burn_delta_v(const Vec3& r0_ric, const Vec3& v0_ric,
+                          double first_tof, double tof_step, size_t count,
+                          double* total_dv) const;
+
+    /**
+     * CWTargeting::solve_optimal's total delta-V for each transfer time
+     * first_tof + j * tof_step, j < count
+     * @param total_dv Output, count entries (m/s); +inf where no method is valid
+     */
+    void optimal_delta_v(const Vec3& r0_ric, const Vec3& v0_ric,
+                         double first_tof, double tof_step, size_t count,
+                         double v_circ, double* total_dv) const;
+
+    /**
+     * Time-of-flight search: the minimum delta-V of optimal_delta_v,
+     * re-solved by CWTargeting::solve_optimal at that transfer time
+     */
+    CWManeuver solve_optimal(const Vec3& r0_ric, const Vec3& v0_ric,
+                             double first_tof, double tof_step, size_t count,
+                             double v_circ) const;
+
+private:
+    static constexpr size_t RENORM_INTERVAL = 64;
+
+    double n_;
+    double grid_step_;
+    std::vector<double> cos_;
+    std::vector<double> sin_;
+    std::vector<CWStateMatrix> grid_;
+
+    /// cos(n dt), sin(n dt) by composition with the table
+    void phase(double dt, double& c, double& s) const;
+
+    /// Phases of first_tof + j * tof_step into c[j], s[j]
+    void sweep_phases(double first_tof, double tof_step, size_t count,
+                      std::vector<double>& c, std::vector<double>& s) const;
+};
+
+} // namespace sim
+
+#endif // CW_PROPAGATOR_HPP
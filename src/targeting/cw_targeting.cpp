@@ -5,11 +5,12 @@
 namespace sim {
 
 CWStateMatrix CWTargeting::compute_state_matrix(double n, double dt) {
-    CWStateMatrix m;
-
     double nt = n * dt;
-    double c = std::cos(nt);
-    double s = std::sin(nt);
+    return compute_state_matrix(n, nt, std::cos(nt), std::sin(nt));
+}
+
+CWStateMatrix CWTargeting::compute_state_matrix(double n, double nt, double c, double s) {
+    CWStateMatrix m;
 
     // Position to position (Phi_rr)
     // R row
@@ -75,7 +76,13 @@ void CWTargeting::propagate_relative_state(
     double n, double dt,
     Vec3& r_ric, Vec3& v_ric) {
 
-    CWStateMatrix m = compute_state_matrix(n, dt);
+    apply_state_matrix(compute_state_matrix(n, dt), r0_ric, v0_ric, r_ric, v_ric);
+}
+
+void CWTargeting::apply_state_matrix(
+    const CWStateMatrix& m,
+    const Vec3& r0_ric, const Vec3& v0_ric,
+    Vec3& r_ric, Vec3& v_ric) {
 
     // r(t) = Phi_rr * r0 + Phi_rv * v0
     r_ric.x = m.Phi_rr[0][0] * r0_ric.x + m.Phi_rr[0][1] * r0_ric.y + m.Phi_rr[0][2] * r0_ric.z
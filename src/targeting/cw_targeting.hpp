@@ -54,6 +54,16 @@ public:
      */
     static CWStateMatrix compute_state_matrix(double n, double dt);
 
+    /**
+     * CW state transition matrices from a precomputed phase
+     * @param n Mean motion of the reference orbit (rad/s)
+     * @param nt Phase angle n * dt (rad)
+     * @param c cos(nt)
+     * @param s sin(nt)
+     * @return State transition matrix components
+     */
+    static CWStateMatrix compute_state_matrix(double n, double nt, double c, double s);
+
     /**
      * Propagate relative state using CW equations
      * @param r0_ric Initial relative position in RIC (m)
@@ -68,6 +78,19 @@ public:
         double n, double dt,
         Vec3& r_ric, Vec3& v_ric);
 
+    /**
+     * Propagate relative state through precomputed CW matrices
+     * @param m State transition matrix components for the interval
+     * @param r0_ric Initial relative position in RIC (m)
+     * @param v0_ric Initial relative velocity in RIC (m/s)
+     * @param r_ric Output: final relative position
+     * @param v_ric Output: final relative velocity
+     */
+    static void apply_state_matrix(
+        const CWStateMatrix& m,
+        const Vec3& r0_ric, const Vec3& v0_ric,
+        Vec3& r_ric, Vec3& v_ric);
+
     /**
      * Two-burn CW rendezvous solution
      * Computes delta-V to achieve both position and velocity match at target.
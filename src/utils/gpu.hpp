@@ -0,0 +1,51 @@
+/**
+ * GPU — Optional accelerator support (header-only)
+ *
+ * The project builds without a GPU toolchain. Configuring with
+ * -DSIM_ENABLE_CUDA=ON compiles the CUDA backends (fom_device.cu,
+ * kepler_device.cu) and defines SIM_HAVE_CUDA; the CPU paths stay in
+ * place and are used whenever gpu_available() is false.
+ *
+ * Kernels share their per-element math with the CPU code through SIM_HD
+ * functions (host and device under nvcc, plain inline otherwise), so the
+ * two paths evaluate the same expressions.
+ *
+ * Setting SIM_GPU=0 in the environment forces the CPU paths on a GPU host.
+ */
+
+#ifndef SIM_GPU_HPP
+#define SIM_GPU_HPP
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef SIM_HAVE_CUDA
+#include <cuda_runtime_api.h>
+#endif
+
+#ifdef __CUDACC__
+#define SIM_HD __host__ __device__
+#else
+#define SIM_HD
+#endif
+
+namespace sim {
+
+/** True when a GPU backend is built, a device is present and SIM_GPU != 0 */
+inline bool gpu_available() {
+    static const bool available = [] {
+        const char* env = std::getenv("SIM_GPU");
+        if (env && std::strcmp(env, "0") == 0) return false;
+#ifdef SIM_HAVE_CUDA
+        int count = 0;
+        return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+#else
+        return false;
+#endif
+    }();
+    return available;
+}
+
+} // namespace sim
+
+#endif // SIM_GPU_HPP
@@ -0,0 +1,180 @@
+/**
+ * Memory accounting — Per-subsystem byte counters (header-only)
+ *
+ * Each MemoryTag owns a MemoryAccount with the bytes currently held, the
+ * peak, and the number of allocations charged. The big consumers charge
+ * their account as they grow:
+ *
+ *   - REPLAY       ReplayWriter per-entity trajectories and sample times
+ *   - FOM_FRAMES   FOMFrame cell values (kept frames and in-flight ones)
+ *   - JSON_DOM     JsonDocument arena blocks and owned input text
+ *   - MC_ENTITIES  MCWorld entity arrays (prototypes and per-run copies)
+ *   - EPHEMERIS    SharedEphemeris rows (MCConfig::shared_ephemeris)
+ *
+ * Containers opt in through TrackedAllocator<T, Tag>, a stateless
+ * std::allocator wrapper; arenas call charge()/release() directly. Only
+ * the container storage itself is counted (an entity's strings are not).
+ *
+ * An account may carry a budget. A charge that would take it past the
+ * budget throws MemoryBudgetExceeded before allocating, so the run fails
+ * with a message naming the subsystem instead of the process being
+ * OOM-killed; callers that can stream instead (mc_engine --replay) check
+ * an estimate against budget() up front.
+ *
+ * Usage:
+ *   std::vector<Vec3, TrackedAllocator<Vec3, MemoryTag::REPLAY>> positions;
+ *   memory_account(MemoryTag::REPLAY).peak();
+ */
+
+#ifndef SIM_MEMORY_ACCOUNTING_HPP
+#define SIM_MEMORY_ACCOUNTING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace sim {
+
+enum class MemoryTag : uint8_t {
+    REPLAY,
+    FOM_FRAMES,
+    JSON_DOM,
+    MC_ENTITIES,
+    EPHEMERIS,
+    COUNT
+};
+
+inline const char* memory_tag_name(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::REPLAY:      return "replay";
+        case MemoryTag::FOM_FRAMES:  return "fom_frames";
+        case MemoryTag::JSON_DOM:    return "json_dom";
+        case MemoryTag::MC_ENTITIES: return "mc_entities";
+        case MemoryTag::EPHEMERIS:   return "ephemeris";
+        default:                     return "unknown";
+    }
+}
+
+class MemoryBudgetExceeded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class MemoryAccount {
+public:
+    explicit MemoryAccount(MemoryTag tag = MemoryTag::COUNT) : tag_(tag) {}
+
+    /**
+     * Count `bytes` as held.
+     * @throws MemoryBudgetExceeded if that would pass the budget
+     */
+    void charge(size_t bytes) {
+        const int64_t b = static_cast<int64_t>(bytes);
+        const int64_t now = current_.fetch_add(b, std::memory_order_relaxed) + b;
+        const int64_t budget = budget_.load(std::memory_order_relaxed);
+        if (budget > 0 && now > budget) {
+            current_.fetch_sub(b, std::memory_order_relaxed);
+            throw MemoryBudgetExceeded(std::string("Memory budget exceeded for ") +
+                                       memory_tag_name(tag_) + ": " + std::to_string(now) +
+                                       " > " + std::to_string(budget) + " bytes");
+        }
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        int64_t peak = peak_.load(std::memory_order_relaxed);
+        while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+
+    void release(size_t bytes) {
+        current_.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+    }
+
+    int64_t current() const { return current_.load(std::memory_order_relaxed); }
+    int64_t peak() const { return peak_.load(std::memory_order_relaxed); }
+    uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+
+    /** Hard limit in bytes (0 = none). */
+    int64_t budget() const { return budget_.load(std::memory_order_relaxed); }
+    void set_budget(int64_t bytes) { budget_.store(bytes, std::memory_order_relaxed); }
+
+private:
+    MemoryTag tag_;
+    std::atomic<int64_t> current_{0};
+    std::atomic<int64_t> peak_{0};
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<int64_t> budget_{0};
+};
+
+inline constexpr size_t NUM_MEMORY_TAGS = static_cast<size_t>(MemoryTag::COUNT);
+
+/** The process-wide account of a subsystem. */
+inline MemoryAccount& memory_account(MemoryTag tag) {
+    static MemoryAccount accounts[NUM_MEMORY_TAGS] = {
+        MemoryAccount(MemoryTag::REPLAY), MemoryAccount(MemoryTag::FOM_FRAMES),
+        MemoryAccount(MemoryTag::JSON_DOM), MemoryAccount(MemoryTag::MC_ENTITIES),
+        MemoryAccount(MemoryTag::EPHEMERIS)};
+    return accounts[static_cast<size_t>(tag)];
+}
+
+/** Per-subsystem table (current, peak, allocations, budget) for --profile. */
+inline void write_memory_summary(std::ostream& out) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-14s %12s %12s %12s %12s\n",
+                  "subsystem", "current MB", "peak MB", "allocs", "budget MB");
+    out << line;
+    for (size_t t = 0; t < NUM_MEMORY_TAGS; t++) {
+        const MemoryTag tag = static_cast<MemoryTag>(t);
+        const MemoryAccount& a = memory_account(tag);
+        char budget[16] = "-";
+        if (a.budget() > 0) std::snprintf(budget, sizeof(budget), "%.1f", a.budget() / 1048576.0);
+        std::snprintf(line, sizeof(line), "%-14s %12.2f %12.2f %12llu %12s\n",
+                      memory_tag_name(tag), a.current() / 1048576.0, a.peak() / 1048576.0,
+                      static_cast<unsigned long long>(a.allocations()), budget);
+        out << line;
+    }
+}
+
+/**
+ * std::allocator that charges every allocation to the account of Tag.
+ * Stateless: all instances compare equal, so containers move and swap
+ * as with std::allocator.
+ */
+template <typename T, MemoryTag Tag>
+class TrackedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = TrackedAllocator<U, Tag>; };
+
+    TrackedAllocator() noexcept = default;
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        memory_account(Tag).charge(n * sizeof(T));
+        try {
+            return std::allocator<T>().allocate(n);
+        } catch (...) {
+            memory_account(Tag).release(n * sizeof(T));
+            throw;
+        }
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+        memory_account(Tag).release(n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const TrackedAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+} // namespace sim
+
+#endif // SIM_MEMORY_ACCOUNTING_HPP
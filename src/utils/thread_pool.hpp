@@ -0,0 +1,435 @@
+/**
+ * ThreadPool — Work-stealing index-range pool (header-only)
+ *
+ * Persistent worker threads that execute parallel_for() jobs over an
+ * index range [0, count). Each participant starts with a contiguous slice
+ * of the range; when its slice runs dry it steals the upper half of the
+ * largest remaining slice from another participant. The calling thread
+ * participates as worker 0, so a pool of N threads spawns N-1 workers.
+ *
+ * Usage:
+ *   ThreadPool pool(8);
+ *   std::vector<double> out(n);
+ *   pool.parallel_for(n, [&](size_t i) { out[i] = expensive(i); });
+ *
+ * Writes to distinct elements of a pre-sized container need no locking,
+ * which is how callers keep results in deterministic index order.
+ * The (index, worker) overload exposes the participant id in [0, size())
+ * so callers can keep per-thread scratch state without thread_local.
+ *
+ * NUMA placement (ThreadPlacement): with `numa` set, participants are
+ * grouped by NUMA node, filling the caller's node first and spilling to
+ * the next only when it has no CPU left, and each worker is confined to
+ * its node's CPUs. Participants of one node hold adjacent slices, so a
+ * node works through one contiguous part of the range; a thread out of
+ * work steals from its own node and crosses nodes only when every slice
+ * there is empty. Memory that a job allocates and first writes inside fn
+ * (per-worker scratch sized lazily, per-run copies) is then placed on the
+ * worker's node by the kernel's first-touch policy. `pin` additionally
+ * binds each worker to one CPU. The calling thread is never moved.
+ * Topology comes from /sys/devices/system/node, restricted to the CPUs
+ * the process may run on; elsewhere placement is a no-op.
+ */
+
+#ifndef SIM_THREAD_POOL_HPP
+#define SIM_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
+namespace sim {
+
+/** Where a pool's worker threads run. */
+struct ThreadPlacement {
+    bool numa = false;   // Group workers by NUMA node, steal across nodes last
+    bool pin = false;    // Bind each worker to one CPU (implies numa)
+
+    bool active() const { return numa || pin; }
+};
+
+/** Allowed CPUs of each NUMA node (one node on non-NUMA hosts). */
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes;
+
+    /** Node of `cpu`, or 0 if unknown */
+    int node_of(int cpu) const {
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (std::find(nodes[n].begin(), nodes[n].end(), cpu) != nodes[n].end()) {
+                return static_cast<int>(n);
+            }
+        }
+        return 0;
+    }
+
+    /** Topology of this host, read once */
+    static const CpuTopology& system() {
+        static const CpuTopology topo = detect();
+        return topo;
+    }
+
+    /** CPU the calling thread is running on (-1 if unknown) */
+    static int current_cpu() {
+#ifdef __linux__
+        return ::sched_getcpu();
+#else
+        return -1;
+#endif
+    }
+
+private:
+    static CpuTopology detect() {
+        CpuTopology topo;
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        bool have_mask = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        auto usable = [&](int cpu) {
+            return cpu >= 0 && cpu < CPU_SETSIZE && (!have_mask || CPU_ISSET(cpu, &allowed));
+        };
+
+        // Nodes may be sparse (node0, node2); stop after a run of misses
+        for (int n = 0, misses = 0; misses < 8; n++) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+            std::string list;
+            if (!in || !std::getline(in, list)) {
+                misses++;
+                continue;
+            }
+            misses = 0;
+            std::vector<int> cpus;
+            for (int cpu : parse_cpulist(list)) {
+                if (usable(cpu)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) topo.nodes.push_back(std::move(cpus));
+        }
+        if (topo.nodes.empty() && have_mask) {
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) topo.nodes.push_back(std::move(cpus));
+        }
+#endif
+        return topo;
+    }
+
+#ifdef __linux__
+    /** "0-3,8-11" -> {0,1,2,3,8,9,10,11} */
+    static std::vector<int> parse_cpulist(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            auto dash = range.find('-');
+            try {
+                int lo = std::stoi(range.substr(0, dash));
+                int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                for (int c = lo; c <= hi; c++) cpus.push_back(c);
+            } catch (const std::exception&) {
+                // Malformed entry: skip it
+            }
+        }
+        return cpus;
+    }
+#endif
+};
+
+class ThreadPool {
+public:
+    /**
+     * @param num_threads Total participants including the caller
+     *                    (0 = std::thread::hardware_concurrency()).
+     * @param placement   NUMA grouping and CPU pinning of the workers
+     */
+    explicit ThreadPool(int num_threads = 0, const ThreadPlacement& placement = ThreadPlacement()) {
+        if (num_threads <= 0) num_threads = hardware_threads();
+        slices_.reserve(static_cast<size_t>(num_threads));
+        for (int i = 0; i < num_threads; i++) {
+            slices_.push_back(std::make_unique<Slice>());
+        }
+        place(num_threads, placement);
+        workers_.reserve(static_cast<size_t>(num_threads - 1));
+        for (int i = 1; i < num_threads; i++) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Number of participants (worker threads + calling thread)
+    int size() const { return static_cast<int>(slices_.size()); }
+
+    /// NUMA nodes the participants span (1 without NUMA placement)
+    int num_nodes() const { return num_nodes_; }
+
+    /// Pool-local node index of a participant, in [0, num_nodes())
+    int node(int worker) const { return node_[static_cast<size_t>(worker)]; }
+
+    /// Hardware thread count, at least 1
+    static int hardware_threads() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n > 0 ? static_cast<int>(n) : 1;
+    }
+
+    /**
+     * Invoke fn(i) for every i in [0, count) and block until all complete.
+     * The first exception thrown by fn is rethrown here after the job drains.
+     * Not reentrant: fn must not call parallel_for on the same pool.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+        parallel_for(count, [&fn](size_t i, int) { fn(i); });
+    }
+
+    /**
+     * As above, with fn(i, worker) receiving the participant id.
+     * A given worker id never runs two indices concurrently.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t, int)>& fn) {
+        if (count == 0) return;
+
+        // Small jobs or single-thread pools run inline
+        size_t n = slices_.size();
+        if (n == 1 || count == 1) {
+            for (size_t i = 0; i < count; i++) fn(i, 0);
+            return;
+        }
+
+        // Partition [0, count) into contiguous per-participant slices
+        for (size_t w = 0; w < n; w++) {
+            std::lock_guard<std::mutex> lock(slices_[w]->mutex);
+            slices_[w]->next = count * w / n;
+            slices_[w]->end  = count * (w + 1) / n;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            error_ = nullptr;
+            pending_ = static_cast<int>(n - 1);
+            generation_++;
+        }
+        start_cv_.notify_all();
+
+        run_slices(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        if (error_) {
+            std::exception_ptr err = error_;
+            error_ = nullptr;
+            std::rethrow_exception(err);
+        }
+    }
+
+private:
+    struct alignas(64) Slice {
+        std::mutex mutex;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::unique_ptr<Slice>> slices_;
+    std::vector<std::thread> workers_;
+
+    // Placement: per participant its node, the CPUs it may run on (empty =
+    // unrestricted), and steal victims on its own node / on other nodes
+    int num_nodes_ = 1;
+    std::vector<int> node_;
+    std::vector<std::vector<int>> cpus_;
+    std::vector<std::vector<int>> near_;
+    std::vector<std::vector<int>> far_;
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(size_t, int)>* job_ = nullptr;
+    std::exception_ptr error_;
+    unsigned long generation_ = 0;
+    int pending_ = 0;
+    bool shutdown_ = false;
+
+    /**
+     * Assign participants to nodes (caller's node first, filled in order)
+     * and work out CPU sets and steal order. Without placement every
+     * participant is on node 0 and every other one is a near victim.
+     */
+    void place(int n, const ThreadPlacement& placement) {
+        node_.assign(static_cast<size_t>(n), 0);
+        cpus_.assign(static_cast<size_t>(n), {});
+
+        const CpuTopology& topo = CpuTopology::system();
+        if (placement.active() && !topo.nodes.empty()) {
+            const int here = CpuTopology::current_cpu();
+            const int home = topo.node_of(here);
+            std::vector<int> order{home};
+            for (int k = 0; k < static_cast<int>(topo.nodes.size()); k++) {
+                if (k != home) order.push_back(k);
+            }
+
+            // The caller takes its own CPU; workers fill the rest of its
+            // node, then the next node. Oversubscribed pools wrap around.
+            std::vector<std::pair<int, int>> seats;   // (pool node, cpu)
+            for (size_t k = 0; k < order.size(); k++) {
+                std::vector<int> cpus = topo.nodes[static_cast<size_t>(order[k])];
+                auto self = std::find(cpus.begin(), cpus.end(), here);
+                if (self != cpus.end()) std::rotate(cpus.begin(), self, self + 1);
+                for (int cpu : cpus) seats.emplace_back(static_cast<int>(k), cpu);
+            }
+            int used_nodes = 1;
+            for (int w = 0; w < n; w++) {
+                const auto& seat = seats[static_cast<size_t>(w) % seats.size()];
+                node_[w] = seat.first;
+                used_nodes = std::max(used_nodes, seat.first + 1);
+                if (w == 0) continue;   // The caller is not moved
+                if (placement.pin) {
+                    cpus_[w] = {seat.second};
+                } else if (topo.nodes.size() > 1) {
+                    cpus_[w] = topo.nodes[static_cast<size_t>(order[static_cast<size_t>(seat.first)])];
+                }
+            }
+            num_nodes_ = used_nodes;
+        }
+
+        near_.assign(static_cast<size_t>(n), {});
+        far_.assign(static_cast<size_t>(n), {});
+        for (int self = 0; self < n; self++) {
+            for (int k = 1; k < n; k++) {
+                int w = (self + k) % n;
+                (node_[w] == node_[self] ? near_ : far_)[self].push_back(w);
+            }
+        }
+    }
+
+    /// Confine the calling worker thread to its CPUs (best effort)
+    void apply_affinity(int self) const {
+#ifdef __linux__
+        const std::vector<int>& cpus = cpus_[static_cast<size_t>(self)];
+        if (cpus.empty()) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) CPU_SET(cpu, &set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#else
+        (void)self;
+#endif
+    }
+
+    void worker_loop(int self) {
+        apply_affinity(self);
+        unsigned long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen; });
+                if (shutdown_) return;
+                seen = generation_;
+            }
+
+            run_slices(self);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_cv_.notify_one();
+        }
+    }
+
+    /// Drain own slice, then steal until every slice is empty
+    void run_slices(int self) {
+        const auto& fn = *job_;
+        size_t idx;
+        while (pop_local(self, idx) || steal(self, idx)) {
+            try {
+                fn(idx, self);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+        }
+    }
+
+    bool pop_local(int self, size_t& idx) {
+        Slice& s = *slices_[self];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.next >= s.end) return false;
+        idx = s.next++;
+        return true;
+    }
+
+    /**
+     * Steal the upper half of the largest remaining slice, looking at
+     * participants on our own node first and other nodes only when those
+     * are all empty. The first stolen index is returned; the rest become
+     * our own slice.
+     */
+    bool steal(int self, size_t& idx) {
+        for (;;) {
+            // Find the victim with the most remaining work
+            int victim = largest(near_[self]);
+            if (victim < 0) victim = largest(far_[self]);
+            if (victim < 0) return false;
+
+            size_t begin, end;
+            {
+                Slice& v = *slices_[victim];
+                std::lock_guard<std::mutex> lock(v.mutex);
+                if (v.next >= v.end) continue;  // raced with its owner — rescan
+                size_t mid = v.next + (v.end - v.next) / 2;
+                begin = mid;
+                end = v.end;
+                v.end = mid;
+            }
+
+            Slice& s = *slices_[self];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.next = begin + 1;
+            s.end = end;
+            idx = begin;
+            return true;
+        }
+    }
+
+    /// Participant among `victims` with the most remaining work, or -1
+    int largest(const std::vector<int>& victims) {
+        int victim = -1;
+        size_t best = 0;
+        for (int w : victims) {
+            std::lock_guard<std::mutex> lock(slices_[w]->mutex);
+            size_t remaining = slices_[w]->end - slices_[w]->next;
+            if (slices_[w]->next < slices_[w]->end && remaining > best) {
+                best = remaining;
+                victim = w;
+            }
+        }
+        return victim;
+    }
+};
+
+} // namespace sim
+
+#endif // SIM_THREAD_POOL_HPP
@@ -0,0 +1,196 @@
+#include "wasm/catalog_module.hpp"
+#include "coordinate/time_utils.hpp"
+#include "fom/fom_ephemeris.hpp"
+#include "fom/pdop_kernel.hpp"
+#include "io/tle_parser.hpp"
+#include "physics/kepler_solver.hpp"
+#include "propagators/sgp4_propagator.hpp"
+#include <cmath>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace sim;
+
+namespace {
+
+/// The loaded catalog and its output buffers (one per module)
+struct Catalog {
+    SGP4Batch sgp4;
+    std::vector<fom::KeplerOrbit> orbits;
+    std::vector<double> epoch_jd;           // Per object, for the Kepler model
+    std::vector<uint8_t> kepler_error;      // SGP4Error for elements Kepler can't take
+    std::vector<double> M, e, E, sin_E, cos_E;
+    std::string names;
+    std::vector<int32_t> norad;
+
+    std::vector<double> positions;          // 3 per object, ECEF [m]
+    std::vector<uint8_t> errors;
+    std::vector<double> sx, sy, sz;         // sim_pdop_grid satellite scratch
+};
+
+Catalog g_catalog;
+std::string g_error;
+
+int fail(const char* what, const std::exception& ex) {
+    g_error = std::string(what) + ": " + ex.what();
+    return -1;
+}
+
+void propagate_sgp4(Catalog& c, double jd, double cos_g, double sin_g) {
+    c.sgp4.evaluate(jd, 1);   // The worker is the parallelism
+    const SGP4Error* err = c.sgp4.errors();
+    for (size_t i = 0; i < c.sgp4.size(); i++) {
+        c.errors[i] = static_cast<uint8_t>(err[i]);
+        Vec3 r = fom::eci_to_ecef(Vec3(c.sgp4.x()[i], c.sgp4.y()[i], c.sgp4.z()[i]), cos_g, sin_g);
+        c.positions[3 * i] = r.x;
+        c.positions[3 * i + 1] = r.y;
+        c.positions[3 * i + 2] = r.z;
+    }
+}
+
+void propagate_kepler(Catalog& c, double jd, double cos_g, double sin_g) {
+    const size_t n = c.orbits.size();
+    for (size_t i = 0; i < n; i++) {
+        c.M[i] = c.kepler_error[i] ? 0.0
+                                   : c.orbits[i].mean_anomaly((jd - c.epoch_jd[i]) * 86400.0);
+    }
+    kepler::eccentric_anomalies(c.M.data(), c.e.data(), c.E.data(), n,
+                                c.sin_E.data(), c.cos_E.data());
+    for (size_t i = 0; i < n; i++) {
+        c.errors[i] = c.kepler_error[i];
+        Vec3 r = c.kepler_error[i] ? Vec3()
+                                   : fom::eci_to_ecef(c.orbits[i].eci(c.sin_E[i], c.cos_E[i]),
+                                                      cos_g, sin_g);
+        c.positions[3 * i] = r.x;
+        c.positions[3 * i + 1] = r.y;
+        c.positions[3 * i + 2] = r.z;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+int sim_catalog_load(const char* tle_text) {
+    if (!tle_text) {
+        g_error = "sim_catalog_load: no text";
+        return -1;
+    }
+    try {
+        TLEParseOptions options;
+        options.num_threads = 1;
+        std::vector<TLE> tles = TLEParser::parse_text(tle_text, options, "catalog");
+
+        Catalog c;
+        const size_t n = tles.size();
+        c.sgp4.reserve(n);
+        c.orbits.reserve(n);
+        c.norad.reserve(n);
+        c.epoch_jd.reserve(n);
+        c.kepler_error.reserve(n);
+        c.e.reserve(n);
+        for (const TLE& tle : tles) {
+            c.sgp4.add(tle);
+            c.names += tle.name;
+            c.names += '\n';
+            c.norad.push_back(tle.satellite_number);
+            c.epoch_jd.push_back(TimeUtils::tle_epoch_to_jd(tle.epoch_year, tle.epoch_day));
+
+            // Mean elements as a fixed ellipse; SGP4's checks for what it can't take
+            SGP4Error bad = tle.mean_motion <= 0.0 ? SGP4Error::MEAN_MOTION
+                          : (tle.eccentricity < 0.0 || tle.eccentricity >= 1.0)
+                              ? SGP4Error::ECCENTRICITY : SGP4Error::NONE;
+            c.kepler_error.push_back(static_cast<uint8_t>(bad));
+            c.orbits.push_back(bad == SGP4Error::NONE ? fom::KeplerOrbit(fom::elements_from_tle(tle))
+                                                      : fom::KeplerOrbit());
+            c.e.push_back(c.orbits.back().e);
+        }
+        for (auto* v : {&c.M, &c.E, &c.sin_E, &c.cos_E}) v->assign(n, 0.0);
+        c.positions.assign(3 * n, 0.0);
+        c.errors.assign(n, 0);
+
+        g_catalog = std::move(c);
+        g_error.clear();
+        return static_cast<int>(n);
+    } catch (const std::exception& ex) {
+        return fail("sim_catalog_load", ex);
+    }
+}
+
+int sim_catalog_size(void) {
+    return static_cast<int>(g_catalog.norad.size());
+}
+
+const char* sim_catalog_names(void) {
+    return g_catalog.names.c_str();
+}
+
+const int32_t* sim_catalog_norad(void) {
+    return g_catalog.norad.data();
+}
+
+int sim_catalog_propagate(double jd, int model) {
+    try {
+        const double gmst = TimeUtils::compute_gmst(jd);
+        const double cos_g = std::cos(gmst), sin_g = std::sin(gmst);
+        switch (model) {
+            case SIM_MODEL_SGP4:   propagate_sgp4(g_catalog, jd, cos_g, sin_g); break;
+            case SIM_MODEL_KEPLER: propagate_kepler(g_catalog, jd, cos_g, sin_g); break;
+            default:
+                g_error = "sim_catalog_propagate: unknown model " + std::to_string(model);
+                return -1;
+        }
+    } catch (const std::exception& ex) {
+        return fail("sim_catalog_propagate", ex);
+    }
+    int failed = 0;
+    for (uint8_t err : g_catalog.errors) failed += err != 0;
+    return failed;
+}
+
+double* sim_catalog_positions(void) {
+    return g_catalog.positions.data();
+}
+
+const uint8_t* sim_catalog_errors(void) {
+    return g_catalog.errors.data();
+}
+
+int sim_pdop_grid(const double* sats, int num_sats, const double* cells, int num_cells,
+                  double min_elevation, double* pdop) {
+    if (num_sats < 0 || num_cells < 0 || (num_sats > 0 && !sats) ||
+        (num_cells > 0 && (!cells || !pdop))) {
+        g_error = "sim_pdop_grid: bad arguments";
+        return -1;
+    }
+    try {
+        // pdop_cell takes the satellites per axis
+        Catalog& c = g_catalog;
+        c.sx.resize(static_cast<size_t>(num_sats));
+        c.sy.resize(static_cast<size_t>(num_sats));
+        c.sz.resize(static_cast<size_t>(num_sats));
+        for (int s = 0; s < num_sats; s++) {
+            c.sx[s] = sats[3 * s];
+            c.sy[s] = sats[3 * s + 1];
+            c.sz[s] = sats[3 * s + 2];
+        }
+        const double min_cos_zenith = std::sin(min_elevation * fom::DEG_TO_RAD);
+        for (int k = 0; k < num_cells; k++) {
+            const double phi = cells[2 * k] * fom::DEG_TO_RAD;
+            const double lam = cells[2 * k + 1] * fom::DEG_TO_RAD;
+            pdop[k] = fom::pdop_cell(std::cos(phi) * std::cos(lam), std::cos(phi) * std::sin(lam),
+                                     std::sin(phi), c.sx.data(), c.sy.data(), c.sz.data(),
+                                     num_sats, min_cos_zenith);
+        }
+    } catch (const std::exception& ex) {
+        return fail("sim_pdop_grid", ex);
+    }
+    return num_cells;
+}
+
+const char* sim_catalog_error(void) {
+    return g_error.c_str();
+}
+
+} // extern "C"
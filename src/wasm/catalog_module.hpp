@@ -0,0 +1,95 @@
+/**
+ * Catalog Module — Batch catalog propagation and PDOP for the browser
+ *
+ * The C interface of the WebAssembly build (emcmake cmake, target
+ * sim_catalog; see src/wasm/CMakeLists.txt): a whole TLE catalog loaded
+ * once, then evaluated at a Julian date per call with SGP4Batch or with
+ * the batch Kepler solver (kepler::eccentric_anomalies on simd::DoubleN
+ * packets, two lanes under -msimd128), and the FOM PDOP kernel
+ * (fom::pdop_cell) over a set of ground cells. The viewer runs it in a
+ * Web Worker (visualization/cesium/js/catalog_worker.js) in place of its
+ * JavaScript propagation.
+ *
+ * Output lives in the module's memory and stays at the same address
+ * until the next sim_catalog_load(): with shared memory (the default
+ * build) the page views it directly as a Float64Array, and a propagation
+ * overwrites it in place. Positions are ECEF [m], interleaved x, y, z per
+ * object, rotated from TEME (SGP4) or ECI (Kepler) by GMST at the date;
+ * an object that fails to propagate has position 0 and a non-zero
+ * errors() entry (an SGP4Error code).
+ *
+ * Nothing here throws across the boundary: failures return -1 and leave
+ * a message in sim_catalog_error(). Calls are not thread-safe; one worker
+ * owns the module.
+ *
+ * Also compiles natively (the exports are plain C functions there).
+ */
+
+#ifndef SIM_WASM_CATALOG_MODULE_HPP
+#define SIM_WASM_CATALOG_MODULE_HPP
+
+#include <cstdint>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#define SIM_WASM_EXPORT EMSCRIPTEN_KEEPALIVE
+#else
+#define SIM_WASM_EXPORT
+#endif
+
+extern "C" {
+
+/// Propagation models for sim_catalog_propagate()
+enum SimCatalogModel {
+    SIM_MODEL_SGP4 = 0,       // SGP4/SDP4 from the TLE (TEME)
+    SIM_MODEL_KEPLER = 1      // Two-body from the TLE mean elements (ECI)
+};
+
+/**
+ * Replace the catalog with the three-line entries (name, line 1, line 2)
+ * in `tle_text`; entries that fail to parse are skipped.
+ * @return objects loaded, or -1 on error
+ */
+SIM_WASM_EXPORT int sim_catalog_load(const char* tle_text);
+
+/** Objects in the catalog */
+SIM_WASM_EXPORT int sim_catalog_size(void);
+
+/** Object names, in catalog order, each terminated by '\n' */
+SIM_WASM_EXPORT const char* sim_catalog_names(void);
+
+/** NORAD catalog numbers, in catalog order */
+SIM_WASM_EXPORT const int32_t* sim_catalog_norad(void);
+
+/**
+ * Evaluate every object at Julian date `jd` (UTC) into
+ * sim_catalog_positions() and sim_catalog_errors()
+ * @param model SimCatalogModel
+ * @return objects that failed to propagate, or -1 on error
+ */
+SIM_WASM_EXPORT int sim_catalog_propagate(double jd, int model);
+
+/** ECEF positions [m] of the last propagation, 3 per object (x, y, z) */
+SIM_WASM_EXPORT double* sim_catalog_positions(void);
+
+/** Per-object outcome of the last propagation (SGP4Error, 0 = ok) */
+SIM_WASM_EXPORT const uint8_t* sim_catalog_errors(void);
+
+/**
+ * PDOP at ground cells from satellite ECEF positions
+ * @param sats            3 per satellite (x, y, z) [m], e.g. sim_catalog_positions()
+ * @param cells           2 per cell: latitude, longitude [deg] on the spherical
+ *                        Earth (as FOMGrid)
+ * @param min_elevation   Mask angle [deg]
+ * @param pdop            num_cells outputs (99 where fewer than 4 are in view)
+ * @return num_cells, or -1 on error
+ */
+SIM_WASM_EXPORT int sim_pdop_grid(const double* sats, int num_sats, const double* cells,
+                                  int num_cells, double min_elevation, double* pdop);
+
+/** Message of the last call that returned -1 ("" if none) */
+SIM_WASM_EXPORT const char* sim_catalog_error(void);
+
+} // extern "C"
+
+#endif // SIM_WASM_CATALOG_MODULE_HPP
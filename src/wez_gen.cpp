@@ -0,0 +1,115 @@
+/**
+ * wez_gen — Generate weapon engagement zone tables for mc_engine --wez.
+ *
+ * Flies MissileFlyout bodies over each weapon's default launch grid (see
+ * wez_table.hpp) and writes one <name>.wez per weapon into the output
+ * directory. Without --sam it tabulates every A2A weapon; each --sam adds
+ * a surface-launched table that SAM batteries select with their weapon
+ * component's "wez" field.
+ *
+ * Usage:
+ *   wez_gen --output <dir> [--threads N] [--no-a2a]
+ *           [--sam NAME --speed S --max-range R [--wvr]]...
+ */
+
+#include "montecarlo/a2a_missile.hpp"
+#include "montecarlo/wez_table.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace sim::mc;
+
+namespace {
+
+void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " --output <dir> [options]\n\n"
+              << "  --output <dir>       Directory for the .wez files (created if absent)\n"
+              << "  --threads N          Worker threads (default: all cores)\n"
+              << "  --no-a2a             Skip the A2A weapons (aim120, aim9, r77, r73)\n"
+              << "  --sam NAME           Add a SAM table named NAME (repeatable); then\n"
+              << "  --speed S              missile speed [m/s] (default: 1200)\n"
+              << "  --max-range R          maximum range [m] (default: 150000)\n"
+              << "  --wvr                  fly an AIM-9-like body instead of AIM-120-like\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output_dir;
+    int threads = 0;
+    bool a2a = true;
+    std::vector<WEZWeapon> sams;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_next = i + 1 < argc;
+            if (arg == "--output" && has_next) {
+                output_dir = argv[++i];
+            } else if (arg == "--threads" && has_next) {
+                threads = std::stoi(argv[++i]);
+            } else if (arg == "--no-a2a") {
+                a2a = false;
+            } else if (arg == "--sam" && has_next) {
+                WEZWeapon w;
+                w.name = argv[++i];
+                w.surface = true;
+                w.speed = 1200.0;
+                w.max_range = 150000.0;
+                sams.push_back(w);
+            } else if (arg == "--speed" && has_next && !sams.empty()) {
+                sams.back().speed = std::stod(argv[++i]);
+            } else if (arg == "--max-range" && has_next && !sams.empty()) {
+                sams.back().max_range = std::stod(argv[++i]);
+            } else if (arg == "--wvr" && !sams.empty()) {
+                sams.back().bvr = false;
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                std::cerr << "Unknown or incomplete argument: " << arg << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: bad argument value (" << e.what() << ")\n";
+        return 1;
+    }
+    if (output_dir.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<WEZWeapon> weapons;
+    if (a2a) {
+        for (A2AWeapon w : {A2AWeapon::AIM120, A2AWeapon::AIM9, A2AWeapon::R77, A2AWeapon::R73}) {
+            weapons.push_back(A2AMissile::wez_weapon(w));
+        }
+    }
+    weapons.insert(weapons.end(), sams.begin(), sams.end());
+    if (weapons.empty()) {
+        std::cerr << "Error: no weapons to tabulate\n";
+        return 1;
+    }
+
+    ::mkdir(output_dir.c_str(), 0755);
+    try {
+        for (const WEZWeapon& weapon : weapons) {
+            auto start = std::chrono::steady_clock::now();
+            WEZTable table = generate_wez(weapon, WEZAxes::defaults(weapon), threads);
+            std::string path = output_dir + "/" + weapon.name + ".wez";
+            table.write(path);
+            double secs = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            std::cerr << path << ": " << table.cells() << " cells in " << secs << " s\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -4,7 +4,9 @@
  * Modal dialog for configuring and launching Monte Carlo batch runs.
  * Allows user to set number of runs, base seed, and max sim time.
  * Displays a progress bar during execution and auto-opens the
- * MCAnalysis results panel on completion.
+ * MCAnalysis results panel on completion. C++ batches also show the
+ * engine's running survival estimates (95% Wilson intervals) from the
+ * job's aggregate snapshot, so a batch can be cancelled once they settle.
  *
  * Usage:
  *   MCPanel.init();    // inject CSS and create DOM (idempotent)
@@ -22,6 +24,8 @@ var MCPanel = (function() {
     var _modal = null;
     var _progressFill = null;
     var _statusText = null;
+    var _snapshotDiv = null;
+    var _cppJobId = null;
     var _warningDiv = null;
     var _btnStart = null;
     var _btnCancel = null;
@@ -125,6 +129,10 @@ var MCPanel = (function() {
             '#mcStatusText {',
             '  font-size: 11px; color: #888; margin-top: 4px;',
             '}',
+            '#mcSnapshot {',
+            '  font-size: 10px; color: #aaa; margin-top: 4px;',
+            '  max-height: 140px; overflow-y: auto; white-space: pre;',
+            '}',
             '#mcModal .mc-btn-row {',
             '  display: flex; justify-content: center; gap: 16px;',
             '  margin-top: 12px; padding-top: 12px; border-top: 1px solid #334;',
@@ -325,6 +333,10 @@ var MCPanel = (function() {
         _statusText.textContent = 'Ready';
         progressSection.appendChild(_statusText);
 
+        _snapshotDiv = document.createElement('div');
+        _snapshotDiv.id = 'mcSnapshot';
+        progressSection.appendChild(_snapshotDiv);
+
         _modal.appendChild(progressSection);
 
         // --- Buttons ---
@@ -407,6 +419,7 @@ var MCPanel = (function() {
             progressTextEl.textContent = '0%';
         }
         _statusText.textContent = 'Ready';
+        _snapshotDiv.textContent = '';
     }
 
     /**
@@ -503,7 +516,27 @@ var MCPanel = (function() {
         });
     }
 
+    /**
+     * Show a running batch's survival estimates (the server's merged
+     * aggregate snapshot): one line per entity, p and its 95% interval.
+     */
+    function _renderSnapshot(snap) {
+        if (!snap || !snap.entities) {
+            _snapshotDiv.textContent = '';
+            return;
+        }
+        var lines = ['Survival after ' + snap.runs + ' runs (95% CI):'];
+        Object.keys(snap.entities).sort().forEach(function(id) {
+            var e = snap.entities[id];
+            var label = (e.name || id) + (e.team ? ' [' + e.team + ']' : '');
+            lines.push('  ' + label + '  ' + (e.pSurvive * 100).toFixed(1) + '%  [' +
+                (e.wilsonLow * 100).toFixed(1) + ', ' + (e.wilsonHigh * 100).toFixed(1) + ']');
+        });
+        _snapshotDiv.textContent = lines.join('\n');
+    }
+
     function _pollBatchJob(jobId, numRuns) {
+        _cppJobId = jobId;
         _pollTimer = setInterval(function() {
             fetch('/api/mc/jobs/' + jobId)
             .then(function(resp) { return resp.json(); })
@@ -527,9 +560,11 @@ var MCPanel = (function() {
                     } else {
                         _statusText.textContent = 'C++ engine: ' + pct + '%';
                     }
+                    if (job.snapshot) _renderSnapshot(job.snapshot);
                 } else if (job.status === 'complete') {
                     clearInterval(_pollTimer);
                     _pollTimer = null;
+                    _cppJobId = null;
 
                     var elapsed = ((Date.now() - _startTime) / 1000).toFixed(2);
                     _setProgress(100, '100%');
@@ -550,9 +585,17 @@ var MCPanel = (function() {
                     if (typeof BuilderApp !== 'undefined' && BuilderApp.showMessage) {
                         BuilderApp.showMessage('C++ MC complete: ' + numRuns + ' runs in ' + elapsed + 's');
                     }
-                } else if (job.status === 'failed') {
+                } else if (job.status === 'failed' || job.status === 'cancelled') {
                     clearInterval(_pollTimer);
                     _pollTimer = null;
+                    _cppJobId = null;
+                    if (job.status === 'cancelled') {
+                        _statusText.textContent = 'Cancelled';
+                        _btnStart.disabled = false;
+                        _btnCancel.disabled = true;
+                        _abortController = null;
+                        return;
+                    }
                     _statusText.textContent = 'Error: ' + (job.error || 'unknown');
                     _btnStart.disabled = false;
                     _btnCancel.disabled = true;
@@ -743,6 +786,16 @@ var MCPanel = (function() {
             _abortController = null;
         }
 
+        // Stop a running C++ job; its last snapshot stays on screen
+        if (_cppJobId) {
+            fetch('/api/mc/jobs/' + _cppJobId, { method: 'DELETE' }).catch(function() {});
+            _cppJobId = null;
+            if (_pollTimer) {
+                clearInterval(_pollTimer);
+                _pollTimer = null;
+            }
+        }
+
         // Cancel JS runner if active
         if (typeof MCRunner !== 'undefined' && MCRunner.cancel) {
             MCRunner.cancel();
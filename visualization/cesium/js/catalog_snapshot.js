@@ -0,0 +1,92 @@
+// =========================================================================
+// CATALOG SNAPSHOT READER — Decoder for export_all_sats' all_sats.bin
+// =========================================================================
+// Reads the columnar format written by sim::CatalogSnapshot
+// (src/io/catalog_snapshot.hpp) into typed arrays viewing the downloaded
+// buffer: every column is 8-byte aligned, so nothing is copied except the
+// names.
+//
+// Usage:
+//   var cat = await CatalogSnapshot.load('all_sats.bin');
+//   cat.count, cat.names[i], cat.norad[i], cat.type[i] ('LEO'|'MEO'|'GEO')
+//   cat.lat[i], cat.lon[i] [deg], cat.alt[i] [m]
+//   cat.trackSteps;                     // 0 = no track
+//   cat.trackPosition(s, i);            // ECEF [m] {x, y, z} at sample s
+//   cat.trackJulianDate(s);             // Julian date of sample s
+// =========================================================================
+'use strict';
+
+var CatalogSnapshot = (function() {
+
+    var HEADER = 64;
+    var ORBIT_TYPES = ['LEO', 'MEO', 'GEO'];
+
+    function tag(view, offset) {
+        return String.fromCharCode(view.getUint8(offset), view.getUint8(offset + 1),
+                                   view.getUint8(offset + 2), view.getUint8(offset + 3));
+    }
+
+    function pad8(n) { return n + ((8 - n % 8) % 8); }
+
+    function decode(buf) {
+        var hv = new DataView(buf);
+        if (buf.byteLength < HEADER || tag(hv, 0) !== 'SATB') {
+            throw new Error('CatalogSnapshot: not a catalog snapshot');
+        }
+        var n = hv.getUint32(8, true);
+        var steps = hv.getUint32(12, true);
+        var cat = {
+            version: hv.getUint32(4, true),
+            count: n,
+            trackSteps: steps,
+            epochJd: hv.getFloat64(16, true),
+            propagateSeconds: hv.getFloat64(24, true),
+            trackStepSeconds: hv.getFloat64(32, true)
+        };
+        var namesBytes = hv.getUint32(40, true);
+
+        var offset = HEADER;
+        function take(Type, count) {
+            var a = new Type(buf, offset, count);
+            offset = pad8(offset + count * Type.BYTES_PER_ELEMENT);
+            return a;
+        }
+        cat.norad = take(Int32Array, n);
+        var types = take(Uint8Array, n);
+        take(Uint32Array, 2 * n);                   // TLE hashes (u64)
+        cat.lat = take(Float64Array, n);
+        cat.lon = take(Float64Array, n);
+        cat.alt = take(Float64Array, n);
+        cat.elements = take(Float32Array, 6 * n);   // [a, e, i, raan, argp, nu][n]
+
+        var nameEnd = new Uint32Array(buf, offset, n);
+        var bytes = new Uint8Array(buf, offset + n * 4, namesBytes);
+        offset = pad8(offset + n * 4 + namesBytes);
+        var decoder = new TextDecoder();
+        cat.names = new Array(n);
+        cat.type = new Array(n);
+        for (var i = 0, begin = 0; i < n; i++) {
+            cat.names[i] = decoder.decode(bytes.subarray(begin, nameEnd[i]));
+            cat.type[i] = ORBIT_TYPES[types[i]] || 'LEO';
+            begin = nameEnd[i];
+        }
+
+        cat.track = take(Float32Array, steps * n * 3);
+        cat.trackPosition = function(s, i) {
+            var k = (s * n + i) * 3;
+            return { x: cat.track[k], y: cat.track[k + 1], z: cat.track[k + 2] };
+        };
+        cat.trackJulianDate = function(s) {
+            return cat.epochJd + (cat.propagateSeconds + s * cat.trackStepSeconds) / 86400;
+        };
+        return cat;
+    }
+
+    async function load(url) {
+        var response = await fetch(url);
+        if (!response.ok) throw new Error('HTTP ' + response.status);
+        return decode(await response.arrayBuffer());
+    }
+
+    return { load: load, decode: decode };
+})();
@@ -0,0 +1,128 @@
+// =========================================================================
+// CATALOG WASM — Whole-catalog propagation in a Web Worker
+// =========================================================================
+// Client for catalog_worker.js, which runs the C++ SGP4 / batch Kepler
+// catalog propagators and the PDOP kernel compiled to WebAssembly
+// (src/wasm/catalog_module.hpp; build with emcmake and copy
+// sim_catalog.js / sim_catalog.wasm into js/wasm/). The main thread only
+// posts a Julian date and reads the result.
+//
+// Positions are ECEF [m], x, y, z per object. With shared module memory
+// (the default build, on a cross-origin isolated page) the Float64Array a
+// propagation resolves with is a view into the worker's memory, rewritten
+// in place by the next propagate(): read it (e.g. into the Cesium point
+// positions) before asking for the next frame. Otherwise each frame is a
+// transferred copy.
+//
+// Usage:
+//   CatalogWasm.create({ workerUrl: 'js/catalog_worker.js',
+//                        moduleUrl: 'wasm/sim_catalog.js' })   // relative to the worker
+//     .then(function(cat) { return cat.load(tleText).then(function(info) {
+//         // info: { count, names[], norad (Int32Array) }
+//         return cat.propagate(jd, CatalogWasm.SGP4);
+//     }); })
+//     .then(function(frame) {
+//         // frame: { positions (Float64Array), errors (Uint8Array), failed, ms }
+//     });
+//   cat.pdop(cellsLatLon, minElevationDeg)   // → Float64Array, from the last frame
+//   cat.terminate();
+// =========================================================================
+'use strict';
+
+var CatalogWasm = (function() {
+
+    var SGP4 = 0;
+    var KEPLER = 1;
+
+    function Catalog(worker) {
+        this._worker = worker;
+        this._seq = 0;
+        this._pending = {};
+        this._count = 0;
+        this._positions = null;        // Views into shared memory (null = copies)
+        this._errors = null;
+
+        var self = this;
+        worker.onmessage = function(ev) {
+            var msg = ev.data;
+            var p = self._pending[msg.id];
+            if (!p) return;
+            delete self._pending[msg.id];
+            if (msg.type === 'error') p.reject(new Error('CatalogWasm: ' + msg.message));
+            else p.resolve(msg);
+        };
+        worker.onerror = function(ev) {
+            var err = new Error('CatalogWasm: ' + (ev.message || 'worker failed'));
+            Object.keys(self._pending).forEach(function(id) { self._pending[id].reject(err); });
+            self._pending = {};
+        };
+    }
+
+    Catalog.prototype._request = function(msg, transfer) {
+        var self = this;
+        msg.id = ++this._seq;
+        return new Promise(function(resolve, reject) {
+            self._pending[msg.id] = { resolve: resolve, reject: reject };
+            self._worker.postMessage(msg, transfer || []);
+        });
+    };
+
+    /** Replace the catalog with three-line TLE text */
+    Catalog.prototype.load = function(text) {
+        var self = this;
+        return this._request({ type: 'load', text: text }).then(function(r) {
+            self._count = r.count;
+            if (r.shared) {
+                self._positions = new Float64Array(r.buffer, r.positionsOffset, 3 * r.count);
+                self._errors = new Uint8Array(r.buffer, r.errorsOffset, r.count);
+            } else {
+                self._positions = self._errors = null;
+            }
+            return { count: r.count, names: r.names, norad: r.norad };
+        });
+    };
+
+    /** Every object at Julian date jd (UTC); model CatalogWasm.SGP4 or KEPLER */
+    Catalog.prototype.propagate = function(jd, model) {
+        var self = this;
+        return this._request({ type: 'propagate', jd: jd, model: model || SGP4 }).then(function(r) {
+            return {
+                jd: r.jd,
+                positions: self._positions || r.positions,
+                errors: self._errors || r.errors,
+                failed: r.failed,
+                ms: r.ms
+            };
+        });
+    };
+
+    /** PDOP at cells (lat, lon [deg] pairs) from the last propagation */
+    Catalog.prototype.pdop = function(cells, minElevation) {
+        var copy = new Float64Array(cells);
+        return this._request({ type: 'pdop', cells: copy, minElevation: minElevation || 0 },
+                             [copy.buffer]).then(function(r) { return r.values; });
+    };
+
+    Catalog.prototype.count = function() { return this._count; };
+    Catalog.prototype.isShared = function() { return this._positions !== null; };
+
+    Catalog.prototype.terminate = function() {
+        this._worker.terminate();
+        this._pending = {};
+    };
+
+    /** Start the worker and load the module; resolves to a Catalog */
+    function create(options) {
+        options = options || {};
+        var worker = new Worker(options.workerUrl || 'js/catalog_worker.js');
+        var catalog = new Catalog(worker);
+        return catalog._request({ type: 'init', moduleUrl: options.moduleUrl || 'wasm/sim_catalog.js' })
+            .then(function() { return catalog; });
+    }
+
+    return {
+        SGP4: SGP4,
+        KEPLER: KEPLER,
+        create: create
+    };
+})();
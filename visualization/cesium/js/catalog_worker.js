@@ -0,0 +1,134 @@
+// =========================================================================
+// CATALOG WORKER — Web Worker hosting the sim_catalog WebAssembly module
+// =========================================================================
+// Runs src/wasm/catalog_module (SGP4 / batch Kepler catalog propagation
+// and the PDOP kernel) off the main thread. Driven by CatalogWasm
+// (catalog_wasm.js); the messages are:
+//
+//   → { id, type: 'init', moduleUrl }
+//   → { id, type: 'load', text }                 three-line TLE text
+//   → { id, type: 'propagate', jd, model }       0 SGP4, 1 Kepler
+//   → { id, type: 'pdop', cells, minElevation }  cells: Float64Array lat, lon [deg]
+//   ← { id, type: 'ok', ... } or { id, type: 'error', message }
+//
+// With shared module memory (SIM_WASM_SHARED_MEMORY, the default) 'load'
+// returns the memory's SharedArrayBuffer and the byte offsets of the
+// position and error arrays, and 'propagate' rewrites them in place;
+// otherwise every 'propagate' transfers copies.
+// =========================================================================
+'use strict';
+
+var _module = null;
+var _fn = null;                        // cwrap'd exports
+var _count = 0;
+
+function exportsOf(m) {
+    return {
+        load: m.cwrap('sim_catalog_load', 'number', ['number']),
+        propagate: m.cwrap('sim_catalog_propagate', 'number', ['number', 'number']),
+        positions: m.cwrap('sim_catalog_positions', 'number', []),
+        errors: m.cwrap('sim_catalog_errors', 'number', []),
+        names: m.cwrap('sim_catalog_names', 'number', []),
+        norad: m.cwrap('sim_catalog_norad', 'number', []),
+        pdop: m.cwrap('sim_pdop_grid', 'number',
+                      ['number', 'number', 'number', 'number', 'number', 'number']),
+        error: m.cwrap('sim_catalog_error', 'number', [])
+    };
+}
+
+function shared() {
+    return typeof SharedArrayBuffer !== 'undefined' &&
+           _module.HEAPU8.buffer instanceof SharedArrayBuffer;
+}
+
+function fail(what) {
+    throw new Error(what + ': ' + _module.UTF8ToString(_fn.error()));
+}
+
+function init(msg) {
+    importScripts(msg.moduleUrl);
+    return SimCatalogModule().then(function(m) {
+        _module = m;
+        _fn = exportsOf(m);
+        return { shared: shared() };
+    });
+}
+
+function load(msg) {
+    var text = _module.stringToNewUTF8(msg.text);
+    var n = _fn.load(text);
+    _module._free(text);
+    if (n < 0) fail('load');
+    _count = n;
+    var names = _module.UTF8ToString(_fn.names()).split('\n');
+    names.length = n;
+    var reply = {
+        count: n,
+        names: names,
+        norad: _module.HEAP32.slice(_fn.norad() >> 2, (_fn.norad() >> 2) + n),
+        shared: shared()
+    };
+    if (reply.shared) {
+        reply.buffer = _module.HEAPU8.buffer;
+        reply.positionsOffset = _fn.positions();
+        reply.errorsOffset = _fn.errors();
+    }
+    return reply;
+}
+
+function propagate(msg) {
+    var t0 = performance.now();
+    var failed = _fn.propagate(msg.jd, msg.model || 0);
+    if (failed < 0) fail('propagate');
+    var reply = { jd: msg.jd, failed: failed, ms: performance.now() - t0 };
+    if (!shared()) {
+        var p = _fn.positions() >> 3;
+        reply.positions = _module.HEAPF64.slice(p, p + 3 * _count);
+        reply.errors = _module.HEAPU8.slice(_fn.errors(), _fn.errors() + _count);
+        reply.transfer = [reply.positions.buffer, reply.errors.buffer];
+    }
+    return reply;
+}
+
+// PDOP at the cells from the last propagation's positions
+function pdop(msg) {
+    var cells = msg.cells;
+    var numCells = cells.length / 2;
+    var cellPtr = _module._malloc(cells.byteLength);
+    var outPtr = _module._malloc(numCells * 8);
+    try {
+        _module.HEAPF64.set(cells, cellPtr >> 3);
+        var r = _fn.pdop(_fn.positions(), _count, cellPtr, numCells,
+                         msg.minElevation || 0, outPtr);
+        if (r < 0) fail('pdop');
+        var values = _module.HEAPF64.slice(outPtr >> 3, (outPtr >> 3) + numCells);
+        return { values: values, transfer: [values.buffer] };
+    } finally {
+        _module._free(cellPtr);
+        _module._free(outPtr);
+    }
+}
+
+var HANDLERS = { init: init, load: load, propagate: propagate, pdop: pdop };
+
+self.onmessage = function(ev) {
+    var msg = ev.data;
+    function reply(result) {
+        var transfer = result.transfer || [];
+        delete result.transfer;
+        result.id = msg.id;
+        result.type = 'ok';
+        self.postMessage(result, transfer);
+    }
+    function error(err) {
+        self.postMessage({ id: msg.id, type: 'error', message: String(err && err.message || err) });
+    }
+    try {
+        var handler = HANDLERS[msg.type];
+        if (!handler) throw new Error('unknown request ' + msg.type);
+        if (msg.type !== 'init' && !_module) throw new Error('module not initialized');
+        Promise.resolve(handler(msg)).then(reply, error);
+    } catch (err) {
+        error(err);
+    }
+};
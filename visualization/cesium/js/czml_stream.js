@@ -0,0 +1,89 @@
+// =========================================================================
+// CZML STREAM — Progressive loader for files written by sim::CzmlWriter
+// =========================================================================
+// CzmlWriter (src/io/czml_writer.hpp) puts one packet per line, so the
+// document can be handed to Cesium while it downloads: complete lines are
+// parsed as they arrive and processed in batches, and position chunks
+// merge into each entity's sampled position.
+//
+// Usage:
+//   var ds = await CzmlStream.load(viewer, 'sat_tour.czml', {
+//       onProgress: function(packets) { ... }
+//   });
+// =========================================================================
+'use strict';
+
+var CzmlStream = (function() {
+
+    // Packet from one line of the array ('[' / ']' lines and commas dropped)
+    function parseLine(line) {
+        line = line.trim();
+        if (line.charAt(line.length - 1) === ',') line = line.slice(0, -1);
+        if (line === '' || line === '[' || line === ']') return null;
+        return JSON.parse(line);
+    }
+
+    async function load(viewer, url, options) {
+        options = options || {};
+        var batchSize = options.batchSize || 64;
+        var dataSource = new Cesium.CzmlDataSource();
+        viewer.dataSources.add(dataSource);
+
+        var started = false, total = 0, batch = [];
+        async function submit() {
+            if (batch.length === 0) return;
+            var packets = batch;
+            batch = [];
+            if (!started) {
+                await dataSource.load(packets);   // Begins with the document packet
+                started = true;
+            } else {
+                await dataSource.process(packets);
+            }
+            total += packets.length;
+            if (options.onProgress) options.onProgress(total);
+        }
+
+        var response = await fetch(url);
+        if (!response.ok) throw new Error('HTTP ' + response.status);
+
+        if (!response.body || !response.body.getReader) {
+            var lines = (await response.text()).split('\n');
+            for (var i = 0; i < lines.length; i++) {
+                var p = parseLine(lines[i]);
+                if (p) batch.push(p);
+            }
+            await submit();
+        } else {
+            var reader = response.body.getReader();
+            var decoder = new TextDecoder();
+            var rest = '';
+            for (;;) {
+                var chunk = await reader.read();
+                rest += chunk.done ? decoder.decode() : decoder.decode(chunk.value, { stream: true });
+                var lines = rest.split('\n');
+                rest = chunk.done ? '' : lines.pop();
+                for (var k = 0; k < lines.length; k++) {
+                    var packet = parseLine(lines[k]);
+                    if (!packet) continue;
+                    batch.push(packet);
+                    if (batch.length >= batchSize) await submit();
+                }
+                if (chunk.done) break;
+            }
+            await submit();
+        }
+
+        if (dataSource.clock) {
+            viewer.clock.startTime = dataSource.clock.startTime.clone();
+            viewer.clock.stopTime = dataSource.clock.stopTime.clone();
+            viewer.clock.currentTime = dataSource.clock.currentTime.clone();
+            viewer.clock.multiplier = dataSource.clock.multiplier;
+            viewer.clock.clockRange = dataSource.clock.clockRange;
+            if (viewer.timeline) viewer.timeline.zoomTo(viewer.clock.startTime, viewer.clock.stopTime);
+        }
+        return dataSource;
+    }
+
+    return { load: load, parseLine: parseLine };
+})();
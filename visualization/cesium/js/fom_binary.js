@@ -0,0 +1,189 @@
+// =========================================================================
+// FOM BINARY READER — Progressive decoder for .fomb figure-of-merit files
+// =========================================================================
+// Reads the quantized binary format written by sim::fom::FOMBinaryWriter
+// (src/fom/fom_binary.hpp): the grid table once, then frames chunk by
+// chunk. When the server honours HTTP Range requests only the header, the
+// index and the chunks actually viewed are downloaded; otherwise the whole
+// file is fetched once and decoded on demand.
+//
+// Usage:
+//   var fom = await FOMBinary.open('gps_pdop.fomb');
+//   fom.metadata;                       // {name, unit, invalid_value, ...}
+//   fom.lat, fom.lon;                   // Float32Array per cell
+//   var frame = await fom.frame(i);     // {time, values: Float32Array}
+//   // invalid cells carry metadata.invalid_value
+// =========================================================================
+'use strict';
+
+var FOMBinary = (function() {
+
+    var HEADER_FIXED = 60;      // Bytes before the metadata JSON
+    var FOOTER = 20;            // num_frames, num_chunks, index offset, "FOMI"
+    var INDEX_ENTRY = 24;
+
+    function tag(view, offset) {
+        return String.fromCharCode(view.getUint8(offset), view.getUint8(offset + 1),
+                                   view.getUint8(offset + 2), view.getUint8(offset + 3));
+    }
+
+    // Byte source: Range requests when available, else one full download
+    async function makeSource(url) {
+        var probe = await fetch(url, { headers: { Range: 'bytes=0-0' } });
+        if (probe.status === 206) {
+            var total = parseInt((probe.headers.get('Content-Range') || '').split('/')[1], 10);
+            return {
+                size: total,
+                read: async function(offset, length) {
+                    var r = await fetch(url, {
+                        headers: { Range: 'bytes=' + offset + '-' + (offset + length - 1) }
+                    });
+                    return await r.arrayBuffer();
+                }
+            };
+        }
+        var whole = await probe.arrayBuffer();
+        if (probe.status !== 200 || whole.byteLength <= 1) {
+            whole = await (await fetch(url)).arrayBuffer();
+        }
+        return {
+            size: whole.byteLength,
+            read: async function(offset, length) { return whole.slice(offset, offset + length); }
+        };
+    }
+
+    // Decode one frame's payload into codes (Uint32Array)
+    function decodeCodes(buf, offset, length, bits, encoding, numCells, prev) {
+        var words = bits === 8 ? new Uint8Array(buf, offset, length)
+                               : new Uint16Array(buf, offset, length / 2);
+        var codes = new Uint32Array(numCells);
+        if (encoding & 2) {
+            var k = 0;
+            for (var w = 0; w + 1 < words.length; w += 2) {
+                var count = words[w], code = words[w + 1];
+                for (var c = 0; c < count && k < numCells; c++) codes[k++] = code;
+            }
+        } else {
+            codes.set(words.subarray(0, numCells));
+        }
+        if (encoding & 1) {
+            var mask = (1 << bits) - 1;
+            for (var i = 0; i < numCells; i++) codes[i] = (codes[i] + prev[i]) & mask;
+        }
+        return codes;
+    }
+
+    // Decode a chunk into frames
+    function decodeChunk(file, buf) {
+        var view = new DataView(buf);
+        if (tag(view, 0) !== 'CHNK') throw new Error('FOMBinary: bad chunk');
+        var count = view.getUint32(4, true);
+        var n = file.numCells, bits = file.bits;
+        var invalidCode = (1 << bits) - 1, levels = invalidCode - 1;
+        var invalid = file.metadata.invalid_value;
+        var offset = 16, prev = null, frames = [];
+
+        for (var f = 0; f < count; f++) {
+            var time = view.getFloat64(offset, true);
+            var lo = view.getFloat32(offset + 8, true);
+            var hi = view.getFloat32(offset + 12, true);
+            var length = view.getUint32(offset + 16, true);
+            var encoding = view.getUint8(offset + 20);
+            offset += 24;
+
+            var codes = decodeCodes(buf, offset, length, bits, encoding, n, prev);
+            offset += length + ((4 - length % 4) % 4);
+            prev = codes;
+
+            var values = new Float32Array(n);
+            var step = levels > 0 ? (hi - lo) / levels : 0;
+            for (var i = 0; i < n; i++) {
+                values[i] = codes[i] === invalidCode ? invalid : lo + codes[i] * step;
+            }
+            frames.push({ time: time, values: values });
+        }
+        return frames;
+    }
+
+    async function open(url) {
+        var src = await makeSource(url);
+
+        var head = await src.read(0, HEADER_FIXED);
+        var hv = new DataView(head);
+        if (tag(hv, 0) !== 'FOMB') throw new Error('FOMBinary: not a FOM binary file');
+
+        var file = {
+            version: hv.getUint32(4, true),
+            numCells: hv.getUint32(8, true),
+            bits: hv.getUint32(12, true),
+            flags: hv.getUint32(16, true),
+            framesPerChunk: hv.getUint32(20, true)
+        };
+        var metaLen = hv.getUint32(56, true);
+        var metaPadded = metaLen + ((4 - metaLen % 4) % 4);
+        var gridBytes = file.numCells * 8;
+
+        var rest = await src.read(HEADER_FIXED, metaPadded + gridBytes);
+        var metadata = JSON.parse(new TextDecoder().decode(new Uint8Array(rest, 0, metaLen)));
+        metadata.invalid_value = hv.getFloat64(24, true);
+        metadata.min_value = hv.getFloat64(32, true);
+        metadata.max_value = hv.getFloat64(40, true);
+        metadata.grid_size_km = hv.getFloat64(48, true);
+        metadata.num_grid_cells = file.numCells;
+        file.metadata = metadata;
+        file.lat = new Float32Array(rest.slice(metaPadded, metaPadded + file.numCells * 4));
+        file.lon = new Float32Array(rest.slice(metaPadded + file.numCells * 4, metaPadded + gridBytes));
+
+        // Chunk index from the footer
+        var foot = new DataView(await src.read(src.size - FOOTER, FOOTER));
+        if (tag(foot, 16) !== 'FOMI') throw new Error('FOMBinary: missing index');
+        file.numFrames = foot.getUint32(0, true);
+        var numChunks = foot.getUint32(4, true);
+        var indexOffset = Number(foot.getBigUint64(8, true));
+        var iv = new DataView(await src.read(indexOffset, numChunks * INDEX_ENTRY));
+        var chunks = [];
+        for (var c = 0; c < numChunks; c++) {
+            var o = c * INDEX_ENTRY;
+            chunks.push({
+                offset: Number(iv.getBigUint64(o, true)),
+                bytes: iv.getUint32(o + 8, true),
+                firstFrame: iv.getUint32(o + 12, true),
+                frameCount: iv.getUint32(o + 16, true),
+                frames: null,
+                pending: null
+            });
+        }
+        metadata.num_time_steps = file.numFrames;
+
+        async function loadChunk(chunk) {
+            if (chunk.frames) return chunk.frames;
+            if (!chunk.pending) {
+                chunk.pending = src.read(chunk.offset, chunk.bytes).then(function(buf) {
+                    chunk.frames = decodeChunk(file, buf);
+                    return chunk.frames;
+                });
+            }
+            return chunk.pending;
+        }
+
+        // Frame i (loads its chunk on first use)
+        file.frame = async function(i) {
+            var c = Math.floor(i / file.framesPerChunk);
+            if (c < 0 || c >= chunks.length) throw new Error('FOMBinary: frame out of range');
+            var frames = await loadChunk(chunks[c]);
+            return frames[i - chunks[c].firstFrame];
+        };
+
+        // Drop decoded chunks other than the one holding frame i
+        file.evict = function(i) {
+            var keep = Math.floor(i / file.framesPerChunk);
+            for (var c = 0; c < chunks.length; c++) {
+                if (c !== keep) { chunks[c].frames = null; chunks[c].pending = null; }
+            }
+        };
+
+        return file;
+    }
+
+    return { open: open };
+})();
@@ -0,0 +1,299 @@
+// =========================================================================
+// LIVE STREAM — Viewer for a simulation run natively by mc_engine --live
+// =========================================================================
+// mc_engine --live (src/montecarlo/mc_live_server.hpp) runs physics, AI
+// and weapons at native speed and sends binary state deltas over a
+// WebSocket; this client only draws them. Each update is an ECEF position
+// (quantized) and velocity at the frame's sim time; between updates the
+// entity is carried forward at that velocity, as the server assumes when
+// it decides what to resend (dead reckoning).
+//
+// Click an orbital or flight entity to take control of it (its AI stops);
+// Esc releases it.
+//   Orbital  W/S prograde/retrograde, Q/E radial out/in   (1 m/s, Shift 10)
+//   Flight   A/D roll, W/S throttle, R/F angle of attack
+//   Space pauses, [ / ] halves / doubles the time scale
+// Commands are aimed at the tick after the latest frame, so every viewer
+// sees them take effect at the same tick.
+//
+// Usage:
+//   LiveStream.connect(viewer, 'ws://localhost:8765', {
+//       fps: 30, tolerance: 10,
+//       onHello: function(info) { ... },   // { entityCount, dt, timeScale }
+//       onStatus: function(text) { ... },
+//       onEnd: function(msg) { ... }
+//   });
+// =========================================================================
+'use strict';
+
+var LiveStream = (function() {
+
+    var OMEGA_EARTH = 7.2921159e-5;    // rad/s, GMST = 0 at t = 0 (as the server)
+    var HEADER_BYTES = 32;             // live_wire::FrameHeader
+    var RECORD_BYTES = 28;             // live_wire::EntityRecord
+
+    var TEAM_COLORS = {
+        blue: Cesium.Color.DODGERBLUE,
+        red: Cesium.Color.RED,
+        neutral: Cesium.Color.LIGHTGRAY
+    };
+
+    var _viewer = null;
+    var _socket = null;
+    var _options = {};
+    var _points = null;
+    var _labels = null;
+    var _entities = [];                // By handle
+    var _seq = 0;
+    var _tick = 0;
+    var _simTime = 0;                  // Of the latest frame
+    var _wallTime = 0;                 // performance.now() it arrived at [ms]
+    var _timeScale = 1;
+    var _paused = false;
+    var _controlled = null;            // Handle this viewer flies
+    var _flight = { roll: 0, throttle: 0.8, alpha: 0 };
+
+    function status(text) {
+        if (_options.onStatus) _options.onStatus(text);
+    }
+
+    function send(msg) {
+        if (!_socket || _socket.readyState !== WebSocket.OPEN) return;
+        msg.seq = ++_seq;
+        _socket.send(JSON.stringify(msg));
+    }
+
+    // ---------------------------------------------------------------------
+    // Messages
+    // ---------------------------------------------------------------------
+
+    function onHello(msg) {
+        _points.removeAll();
+        _labels.removeAll();
+        _entities = msg.entities.map(function(e) {
+            return {
+                h: e.h, id: e.id, name: e.name, team: e.team, physics: e.physics,
+                pos: new Cesium.Cartesian3(), vel: new Cesium.Cartesian3(), t0: 0,
+                point: null, label: null
+            };
+        });
+        _tick = msg.tick;
+        _simTime = msg.simTime;
+        _wallTime = performance.now();
+        _timeScale = msg.timeScale;
+        send({ type: 'subscribe', fps: _options.fps || 30, tolerance: _options.tolerance || 10 });
+        if (_options.onHello) {
+            _options.onHello({ entityCount: _entities.length, dt: msg.dt, timeScale: msg.timeScale });
+        }
+    }
+
+    function onFrame(buffer) {
+        var view = new DataView(buffer);
+        var magic = String.fromCharCode(view.getUint8(0), view.getUint8(1),
+                                        view.getUint8(2), view.getUint8(3));
+        if (magic !== 'LSB1') return;
+        _tick = view.getUint32(4, true);
+        _simTime = view.getFloat64(8, true);
+        _wallTime = performance.now();
+        var quantum = view.getFloat32(16, true);
+        var count = view.getUint32(20, true);
+        var removed = view.getUint32(24, true);
+        var recordBytes = view.getUint32(28, true) || RECORD_BYTES;
+
+        var off = HEADER_BYTES;
+        for (var i = 0; i < count; i++, off += recordBytes) {
+            var e = _entities[view.getUint32(off, true)];
+            if (!e) continue;
+            e.pos.x = view.getInt32(off + 4, true) * quantum;
+            e.pos.y = view.getInt32(off + 8, true) * quantum;
+            e.pos.z = view.getInt32(off + 12, true) * quantum;
+            e.vel.x = view.getFloat32(off + 16, true);
+            e.vel.y = view.getFloat32(off + 20, true);
+            e.vel.z = view.getFloat32(off + 24, true);
+            e.t0 = _simTime;
+            if (!e.point) show(e);
+        }
+        for (var j = 0; j < removed; j++, off += 4) {
+            hide(_entities[view.getUint32(off, true)]);
+        }
+    }
+
+    function onText(msg) {
+        switch (msg.type) {
+            case 'hello': onHello(msg); break;
+            case 'event':
+                if (msg.result === 'KILL' && _entities[msg.target]) {
+                    status(_entities[msg.source].name + ' killed ' + _entities[msg.target].name);
+                }
+                break;
+            case 'error': status('Server: ' + msg.message); break;
+            case 'end':
+                status('Run ended at t=' + msg.simTime.toFixed(1) + ' s');
+                if (_options.onEnd) _options.onEnd(msg);
+                break;
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Rendering
+    // ---------------------------------------------------------------------
+
+    function show(e) {
+        var color = TEAM_COLORS[e.team] || TEAM_COLORS.neutral;
+        e.point = _points.add({ position: e.pos, pixelSize: 7, color: color,
+                                outlineColor: Cesium.Color.WHITE, id: e.h });
+        e.label = _labels.add({
+            position: e.pos, text: e.name || e.id, font: '12px sans-serif',
+            fillColor: color, pixelOffset: new Cesium.Cartesian2(8, -8),
+            distanceDisplayCondition: new Cesium.DistanceDisplayCondition(0, 2.0e7)
+        });
+    }
+
+    function hide(e) {
+        if (!e || !e.point) return;
+        _points.remove(e.point);
+        _labels.remove(e.label);
+        e.point = null;
+        e.label = null;
+        if (_controlled === e.h) _controlled = null;
+    }
+
+    var _scratch = new Cesium.Cartesian3();
+
+    function currentSimTime() {
+        if (_paused) return _simTime;
+        return _simTime + (performance.now() - _wallTime) * 0.001 * _timeScale;
+    }
+
+    function render() {
+        var t = currentSimTime();
+        for (var i = 0; i < _entities.length; i++) {
+            var e = _entities[i];
+            if (!e.point) continue;
+            Cesium.Cartesian3.multiplyByScalar(e.vel, t - e.t0, _scratch);
+            Cesium.Cartesian3.add(e.pos, _scratch, _scratch);
+            e.point.position = _scratch;
+            e.label.position = _scratch;
+            e.point.outlineWidth = e.h === _controlled ? 2 : 0;
+        }
+    }
+
+    // ---------------------------------------------------------------------
+    // Control
+    // ---------------------------------------------------------------------
+
+    function takeControl(h) {
+        var e = _entities[h];
+        if (!e || (e.physics !== 'orbital' && e.physics !== 'flight')) return;
+        if (_controlled !== null) release();
+        _controlled = h;
+        _flight = { roll: 0, throttle: 0.8, alpha: 0 };
+        send({ type: 'control', id: e.id, tick: _tick + 1 });
+        status('Controlling ' + (e.name || e.id));
+    }
+
+    function release() {
+        if (_controlled === null) return;
+        send({ type: 'control', id: _entities[_controlled].id, release: true, tick: _tick + 1 });
+        status('Released ' + (_entities[_controlled].name || _entities[_controlled].id));
+        _controlled = null;
+    }
+
+    // Delta-V along the velocity (prograde) or position (radial), in ECI as the server expects
+    function orbitalBurn(e, prograde, radial) {
+        var t = e.t0;
+        // Inertial velocity in ECEF axes: v_ecef + omega x r
+        var v = new Cesium.Cartesian3(e.vel.x - OMEGA_EARTH * e.pos.y,
+                                      e.vel.y + OMEGA_EARTH * e.pos.x, e.vel.z);
+        var dir = new Cesium.Cartesian3();
+        Cesium.Cartesian3.normalize(v, v);
+        Cesium.Cartesian3.normalize(e.pos, dir);
+        var d = new Cesium.Cartesian3(v.x * prograde + dir.x * radial,
+                                      v.y * prograde + dir.y * radial,
+                                      v.z * prograde + dir.z * radial);
+        var c = Math.cos(OMEGA_EARTH * t), s = Math.sin(OMEGA_EARTH * t);
+        send({ type: 'maneuver', id: e.id, tick: _tick + 1,
+               dv: [c * d.x - s * d.y, s * d.x + c * d.y, d.z] });
+    }
+
+    function onKey(ev) {
+        var key = ev.key.toLowerCase();
+        if (key === ' ') {
+            _simTime = currentSimTime();
+            _wallTime = performance.now();
+            _paused = !_paused;
+            send({ type: 'speed', paused: _paused });
+            return;
+        }
+        if (key === '[' || key === ']') {
+            _simTime = currentSimTime();
+            _wallTime = performance.now();
+            _timeScale = key === ']' ? _timeScale * 2 : _timeScale / 2;
+            send({ type: 'speed', scale: _timeScale });
+            status('Time scale ' + _timeScale + 'x');
+            return;
+        }
+        if (_controlled === null) return;
+        if (key === 'escape') { release(); return; }
+
+        var e = _entities[_controlled];
+        if (e.physics === 'orbital') {
+            var dv = ev.shiftKey ? 10 : 1;
+            if (key === 'w') orbitalBurn(e, dv, 0);
+            else if (key === 's') orbitalBurn(e, -dv, 0);
+            else if (key === 'q') orbitalBurn(e, 0, dv);
+            else if (key === 'e') orbitalBurn(e, 0, -dv);
+            return;
+        }
+        if (key === 'a') _flight.roll = Math.max(_flight.roll - 0.1, -1.4);
+        else if (key === 'd') _flight.roll = Math.min(_flight.roll + 0.1, 1.4);
+        else if (key === 'w') _flight.throttle = Math.min(_flight.throttle + 0.1, 1);
+        else if (key === 's') _flight.throttle = Math.max(_flight.throttle - 0.1, 0);
+        else if (key === 'r') _flight.alpha = Math.min(_flight.alpha + 0.02, 0.35);
+        else if (key === 'f') _flight.alpha = Math.max(_flight.alpha - 0.02, -0.35);
+        else return;
+        send({ type: 'maneuver', id: e.id, tick: _tick + 1,
+               roll: _flight.roll, throttle: _flight.throttle, alpha: _flight.alpha });
+    }
+
+    // ---------------------------------------------------------------------
+    // Connection
+    // ---------------------------------------------------------------------
+
+    function connect(viewer, url, options) {
+        _viewer = viewer;
+        _options = options || {};
+        _points = viewer.scene.primitives.add(new Cesium.PointPrimitiveCollection());
+        _labels = viewer.scene.primitives.add(new Cesium.LabelCollection());
+
+        viewer.scene.preRender.addEventListener(render);
+        var handler = new Cesium.ScreenSpaceEventHandler(viewer.scene.canvas);
+        handler.setInputAction(function(click) {
+            var picked = viewer.scene.pick(click.position);
+            if (picked && picked.primitive instanceof Cesium.PointPrimitive) takeControl(picked.id);
+        }, Cesium.ScreenSpaceEventType.LEFT_CLICK);
+        document.addEventListener('keydown', onKey);
+
+        status('Connecting to ' + url + '...');
+        _socket = new WebSocket(url);
+        _socket.binaryType = 'arraybuffer';
+        _socket.onmessage = function(ev) {
+            if (typeof ev.data === 'string') onText(JSON.parse(ev.data));
+            else onFrame(ev.data);
+        };
+        _socket.onclose = function() { status('Disconnected'); };
+        _socket.onerror = function() { status('Connection to ' + url + ' failed'); };
+    }
+
+    function disconnect() {
+        if (_socket) _socket.close();
+        _socket = null;
+    }
+
+    return {
+        connect: connect,
+        disconnect: disconnect,
+        takeControl: takeControl,
+        release: release
+    };
+})();
@@ -0,0 +1,210 @@
+// =========================================================================
+// REPLAY TILES READER — Multi-resolution replay windows for long runs
+// =========================================================================
+// Reads the tiled replay written by mc_engine --replay-tiles
+// (src/montecarlo/replay_writer.hpp): the tiles.json manifest once, then
+// only the tiles a time window touches, at the level whose sample spacing
+// suits the window. Level L holds every 4^L-th sample and the last level
+// is the overview. Tile files are cached as text; a window is decoded from
+// the keyframe at or before its start, so a narrow window in a long tile
+// skips the rows ahead of it.
+//
+// Usage:
+//   var tiles = await ReplayTiles.open('run/tiles.json');
+//   tiles.manifest;                            // tiles.json
+//   var L = tiles.levelFor(t0, t1, 2000);      // finest level with <= 2000 samples
+//   var w = await tiles.window(L, t0, t1);
+//   w.tracks[e].times, w.tracks[e].positions;  // Float64Arrays (x y z per sample, m)
+//   var m = ReplayTiles.merge(overview, w);    // w spliced into a coarser window
+//   var ev = await tiles.events();             // engagement events, by time
+// =========================================================================
+'use strict';
+
+var ReplayTiles = (function() {
+
+    var CACHE_TILES = 256;
+
+    // Tile text, header line and index line
+    function parseTile(text) {
+        var headerEnd = text.indexOf('\n');
+        var indexStart = text.lastIndexOf('\n', text.length - 2) + 1;
+        return {
+            header: JSON.parse(text.slice(0, headerEnd)),
+            index: JSON.parse(text.slice(indexStart)),
+            text: text,
+            rowsEnd: indexStart
+        };
+    }
+
+    // Rows of a tile with t0 <= t <= t1, plus the one before and after for
+    // interpolation, appended to tracks. Decoding starts at the last
+    // keyframe at or before t0; positions there are absolute.
+    function decodeWindow(tile, t0, t1, tracks) {
+        var h = tile.header, keys = tile.index.keyframes;
+        var k = 0;
+        while (k + 1 < keys.length && keys[k + 1][1] <= t0) k++;
+        var row = keys.length ? keys[k][0] : 0;
+        var pos = keys.length ? keys[k][2] : tile.text.indexOf('\n') + 1;
+
+        var n = h.entities, q = h.quantum;
+        var last = new Array(n * 3).fill(0);
+        var present = new Array(n).fill(false);
+        var pending = null;   // last row before t0
+        while (pos < tile.rowsEnd) {
+            var end = tile.text.indexOf('\n', pos);
+            var r = JSON.parse(tile.text.slice(pos, end));
+            pos = end + 1;
+            var keyframe = row % h.keyframeEvery === 0;
+            var j = 1;
+            for (var e = 0; e < n; e++) {
+                if (r[j] === null) {
+                    present[e] = false;
+                    j++;
+                    continue;
+                }
+                for (var c = 0; c < 3; c++) {
+                    last[e * 3 + c] = (keyframe || !present[e]) ? r[j + c] : last[e * 3 + c] + r[j + c];
+                }
+                present[e] = true;
+                j += 3;
+            }
+            row++;
+
+            var t = r[0];
+            var snapshot = { t: t, last: last.slice(), present: present.slice() };
+            if (t < t0) {
+                pending = snapshot;
+                continue;
+            }
+            if (pending) {
+                appendRow(tracks, h.firstEntity, pending, q);
+                pending = null;
+            }
+            appendRow(tracks, h.firstEntity, snapshot, q);
+            if (t > t1) break;
+        }
+        if (pending) appendRow(tracks, h.firstEntity, pending, q);
+    }
+
+    function appendRow(tracks, first, snap, q) {
+        for (var e = 0; e < snap.present.length; e++) {
+            if (!snap.present[e]) continue;
+            var tr = tracks[first + e];
+            if (tr.times.length && tr.times[tr.times.length - 1] >= snap.t) continue;
+            tr.times.push(snap.t);
+            tr.positions.push(snap.last[e * 3] * q, snap.last[e * 3 + 1] * q, snap.last[e * 3 + 2] * q);
+        }
+    }
+
+    function toArrays(tracks) {
+        return tracks.map(function(tr) {
+            return { times: new Float64Array(tr.times), positions: new Float64Array(tr.positions) };
+        });
+    }
+
+    // manifest: tiles.json already fetched, or omitted to fetch it
+    async function open(url, manifest) {
+        if (!manifest) {
+            var resp = await fetch(url);
+            if (!resp.ok) throw new Error('ReplayTiles: HTTP ' + resp.status + ' for ' + url);
+            manifest = await resp.json();
+        }
+        if (manifest.format !== 'replay_tiles_v1') throw new Error('ReplayTiles: not a tile manifest');
+        var base = url.slice(0, url.lastIndexOf('/') + 1);
+        var groupSize = manifest.config.groupSize;
+        var cache = new Map();
+
+        async function fetchTile(level, tile, group) {
+            var path = base + level + '/' + tile + '-' + group + '.jsonl';
+            var hit = cache.get(path);
+            if (hit) {
+                cache.delete(path);   // most recently used last
+                cache.set(path, hit);
+                return hit;
+            }
+            var resp = await fetch(path);
+            if (!resp.ok) throw new Error('ReplayTiles: HTTP ' + resp.status + ' for ' + path);
+            var parsed = parseTile(await resp.text());
+            cache.set(path, parsed);
+            if (cache.size > CACHE_TILES) cache.delete(cache.keys().next().value);
+            return parsed;
+        }
+
+        var tiles = { manifest: manifest, levels: manifest.levels };
+
+        // Finest level with at most maxSamples samples in [t0, t1]
+        tiles.levelFor = function(t0, t1, maxSamples) {
+            var interval = manifest.config.sampleInterval;
+            for (var l = 0; l < manifest.levels.length; l++) {
+                if ((t1 - t0) / (interval * manifest.levels[l].stride) <= maxSamples) return l;
+            }
+            return manifest.levels.length - 1;
+        };
+
+        // Every entity's samples at `level` for t0 <= t <= t1 (and one either
+        // side). groups: entity group indices to read (default all).
+        tiles.window = async function(level, t0, t1, groups) {
+            var spans = manifest.levels[level].tiles;
+            var tracks = manifest.entities.map(function() { return { times: [], positions: [] }; });
+            if (!groups) {
+                groups = [];
+                for (var g = 0; g < manifest.groups; g++) groups.push(g);
+            }
+            // Tiles overlapping the window, widened to the neighbours that
+            // hold the samples just outside it
+            var first = 0;
+            while (first + 1 < spans.length && spans[first + 1][0] <= t0) first++;
+            var last = first;
+            while (last + 1 < spans.length && spans[last][1] < t1) last++;
+            for (var ti = first; ti <= last; ti++) {
+                var loaded = await Promise.all(groups.map(function(gi) {
+                    return fetchTile(level, ti, gi);
+                }));
+                loaded.forEach(function(tile) { decodeWindow(tile, t0, t1, tracks); });
+            }
+            return { level: level, t0: t0, t1: t1, tracks: toArrays(tracks), groupSize: groupSize };
+        };
+
+        // Engagement events (events.jsonl), fetched once
+        var events = null;
+        tiles.events = async function() {
+            if (events) return events;
+            var resp = await fetch(base + manifest.events);
+            if (!resp.ok) return (events = []);
+            events = (await resp.text()).split('\n').filter(function(l) {
+                return l.trim();
+            }).map(JSON.parse);
+            events.sort(function(a, b) { return a.time - b.time; });
+            return events;
+        };
+
+        tiles.evict = function() { cache.clear(); };
+
+        return tiles;
+    }
+
+    // A finer window spliced into a coarser one: coarse samples outside the
+    // fine window's time span, the fine samples inside it
+    function merge(coarse, fine) {
+        return {
+            level: fine.level, t0: fine.t0, t1: fine.t1,
+            tracks: coarse.tracks.map(function(c, e) {
+                var f = fine.tracks[e], nf = f.times.length;
+                if (nf === 0) return c;
+                var lo = f.times[0], hi = f.times[nf - 1];
+                var times = [], positions = [];
+                function push(src, k) {
+                    times.push(src.times[k]);
+                    positions.push(src.positions[k * 3], src.positions[k * 3 + 1], src.positions[k * 3 + 2]);
+                }
+                var k = 0;
+                for (; k < c.times.length && c.times[k] < lo; k++) push(c, k);
+                for (var m = 0; m < nf; m++) push(f, m);
+                for (; k < c.times.length; k++) if (c.times[k] > hi) push(c, k);
+                return { times: new Float64Array(times), positions: new Float64Array(positions) };
+            })
+        };
+    }
+
+    return { open: open, merge: merge };
+})();
@@ -0,0 +1,225 @@
+// =========================================================================
+// TRAJECTORY ARCHIVE READER — Windowed decoder for .traj trajectory files
+// =========================================================================
+// Reads the time-indexed format written by sim::TrajectoryArchiveWriter
+// (src/io/trajectory_archive.hpp): the header, entity ids and index once,
+// then only the windows a time range touches. When the server honours HTTP
+// Range requests (mc_server.js /api/mc/archives/:id) just those bytes are
+// downloaded; otherwise the whole file is fetched once and decoded on
+// demand.
+//
+// Usage:
+//   var traj = await TrajectoryArchive.open(results.archiveUrl);
+//   traj.ids;                              // Entity ids
+//   traj.frame;                            // 'ECI', 'ECEF' or ''
+//   var r = await traj.range('blue_1', t0, t1);
+//   r.times;                               // Float64Array
+//   r.positions;                           // Float64Array, x y z per sample [m]
+//   var p = await traj.positionAt('blue_1', t);   // [x, y, z] or null
+// =========================================================================
+'use strict';
+
+var TrajectoryArchive = (function() {
+
+    var HEADER = 64;
+    var FOOTER = 32;            // index offset, num_samples, num_windows, "TRJI"
+    var WINDOW_ENTRY = 32;
+    var BLOCK_ENTRY = 16;
+    var FRAMES = ['', 'ECI', 'ECEF'];
+
+    function tag(view, offset) {
+        return String.fromCharCode(view.getUint8(offset), view.getUint8(offset + 1),
+                                   view.getUint8(offset + 2), view.getUint8(offset + 3));
+    }
+
+    // Byte source: Range requests when available, else one full download
+    async function makeSource(url) {
+        var probe = await fetch(url, { headers: { Range: 'bytes=0-0' } });
+        if (probe.status === 206) {
+            var total = parseInt((probe.headers.get('Content-Range') || '').split('/')[1], 10);
+            return {
+                size: total,
+                read: async function(offset, length) {
+                    if (length <= 0) return new ArrayBuffer(0);
+                    var r = await fetch(url, {
+                        headers: { Range: 'bytes=' + offset + '-' + (offset + length - 1) }
+                    });
+                    return await r.arrayBuffer();
+                }
+            };
+        }
+        var whole = await probe.arrayBuffer();
+        if (probe.status !== 200 || whole.byteLength <= 1) {
+            whole = await (await fetch(url)).arrayBuffer();
+        }
+        return {
+            size: whole.byteLength,
+            read: async function(offset, length) { return whole.slice(offset, offset + length); }
+        };
+    }
+
+    // Decode a block: quantized first position, then zigzag varint second
+    // differences per axis. Values stay below 2^53, so plain Number maths.
+    function decodeBlock(bytes, count, quantum) {
+        var out = new Float64Array(count * 3);
+        var prev = [0, 0, 0], prev2 = [0, 0, 0];
+        var p = 0;
+        for (var k = 0; k < count; k++) {
+            for (var c = 0; c < 3; c++) {
+                var v = 0, scale = 1, b;
+                do {
+                    if (p >= bytes.length) throw new Error('TrajectoryArchive: truncated block');
+                    b = bytes[p++];
+                    v += (b & 0x7F) * scale;
+                    scale *= 128;
+                } while (b & 0x80);
+                var residual = (v % 2) ? -(v + 1) / 2 : v / 2;
+                var q = residual;
+                if (k === 1) q = residual + prev[c];
+                else if (k > 1) q = residual + 2 * prev[c] - prev2[c];
+                prev2[c] = prev[c];
+                prev[c] = q;
+                out[k * 3 + c] = q * quantum;
+            }
+        }
+        return out;
+    }
+
+    async function open(url) {
+        var src = await makeSource(url);
+
+        var hv = new DataView(await src.read(0, HEADER));
+        if (tag(hv, 0) !== 'TRJA') throw new Error('TrajectoryArchive: not a trajectory archive');
+        var numEntities = hv.getUint32(8, true);
+        var archive = {
+            version: hv.getUint32(4, true),
+            blockSamples: hv.getUint32(12, true),
+            quantum: hv.getFloat64(16, true),
+            frame: FRAMES[hv.getUint32(24, true)] || '',
+            ids: []
+        };
+        var idsBytes = hv.getUint32(28, true);
+
+        // Entity ids: u32 end offsets, then the bytes
+        var idBuf = await src.read(HEADER, numEntities * 4 + idsBytes);
+        var ends = new DataView(idBuf);
+        var byteView = new Uint8Array(idBuf, numEntities * 4, idsBytes);
+        var start = 0;
+        for (var i = 0; i < numEntities; i++) {
+            var end = ends.getUint32(i * 4, true);
+            archive.ids.push(new TextDecoder().decode(byteView.subarray(start, end)));
+            start = end;
+        }
+        var entityIndex = {};
+        archive.ids.forEach(function(id, i) { entityIndex[id] = i; });
+
+        // Index from the footer
+        var foot = new DataView(await src.read(src.size - FOOTER, FOOTER));
+        if (tag(foot, 28) !== 'TRJI') throw new Error('TrajectoryArchive: missing index');
+        var indexOffset = Number(foot.getBigUint64(0, true));
+        archive.numSamples = Number(foot.getBigUint64(8, true));
+        var numWindows = foot.getUint32(16, true);
+        var iv = new DataView(await src.read(indexOffset,
+                                             numWindows * (WINDOW_ENTRY + numEntities * BLOCK_ENTRY)));
+        var windows = [];
+        for (var w = 0; w < numWindows; w++) {
+            var o = w * WINDOW_ENTRY;
+            windows.push({
+                offset: Number(iv.getBigUint64(o, true)),
+                tFirst: iv.getFloat64(o + 8, true),
+                tLast: iv.getFloat64(o + 16, true),
+                count: iv.getUint32(o + 24, true),
+                times: null
+            });
+        }
+        var blockBase = numWindows * WINDOW_ENTRY;
+        function blockEntry(w, e) {
+            var o = blockBase + (w * numEntities + e) * BLOCK_ENTRY;
+            return {
+                offset: Number(iv.getBigUint64(o, true)),
+                bytes: iv.getUint32(o + 8, true),
+                first: iv.getUint16(o + 12, true),
+                count: iv.getUint16(o + 14, true)
+            };
+        }
+
+        archive.startTime = numWindows ? windows[0].tFirst : 0;
+        archive.endTime = numWindows ? windows[numWindows - 1].tLast : 0;
+
+        function entityOf(id) {
+            var e = typeof id === 'number' ? id : entityIndex[id];
+            if (e === undefined || e < 0 || e >= numEntities) {
+                throw new Error('TrajectoryArchive: unknown entity ' + id);
+            }
+            return e;
+        }
+
+        async function windowTimes(win) {
+            if (!win.times) {
+                win.times = new Float64Array(await src.read(win.offset, win.count * 8));
+            }
+            return win.times;
+        }
+
+        // One entity's samples in window w: {times, positions}
+        async function readBlock(w, e) {
+            var b = blockEntry(w, e);
+            if (b.count === 0 || b.offset === 0) return null;
+            var times = await windowTimes(windows[w]);
+            var bytes = new Uint8Array(await src.read(b.offset, b.bytes));
+            return {
+                times: times.subarray(b.first, b.first + b.count),
+                positions: decodeBlock(bytes, b.count, archive.quantum)
+            };
+        }
+
+        // Samples of an entity with t0 <= t <= t1, fetching only the windows involved
+        archive.range = async function(id, t0, t1) {
+            var e = entityOf(id);
+            var times = [], positions = [];
+            for (var w = 0; w < numWindows; w++) {
+                if (windows[w].tLast < t0 || windows[w].tFirst > t1) continue;
+                var blk = await readBlock(w, e);
+                if (!blk) continue;
+                for (var k = 0; k < blk.times.length; k++) {
+                    var t = blk.times[k];
+                    if (t < t0 || t > t1) continue;
+                    times.push(t);
+                    positions.push(blk.positions[k * 3], blk.positions[k * 3 + 1], blk.positions[k * 3 + 2]);
+                }
+            }
+            return { times: new Float64Array(times), positions: new Float64Array(positions) };
+        };
+
+        // Position at t, linear between the samples around it (null outside them)
+        archive.positionAt = async function(id, t) {
+            var w = 0;
+            while (w < numWindows && windows[w].tLast < t) w++;
+            if (w === numWindows) return null;
+            // Samples around t lie in window w, or straddle it and the one before
+            var lo = w > 0 ? windows[w - 1].tLast : windows[w].tFirst;
+            var r = await archive.range(id, lo, windows[w].tLast);
+            var n = r.times.length;
+            if (n === 0 || t < r.times[0] || t > r.times[n - 1]) return null;
+            var k = 0;
+            while (k + 1 < n && r.times[k + 1] < t) k++;
+            if (k + 1 >= n || r.times[k] === t) {
+                return [r.positions[k * 3], r.positions[k * 3 + 1], r.positions[k * 3 + 2]];
+            }
+            var f = (t - r.times[k]) / (r.times[k + 1] - r.times[k]);
+            var p = r.positions;
+            return [p[k * 3] + f * (p[k * 3 + 3] - p[k * 3]),
+                    p[k * 3 + 1] + f * (p[k * 3 + 4] - p[k * 3 + 1]),
+                    p[k * 3 + 2] + f * (p[k * 3 + 5] - p[k * 3 + 2])];
+        };
+
+        // Drop cached window times
+        archive.evict = function() {
+            for (var w = 0; w < numWindows; w++) windows[w].times = null;
+        };
+
+        return archive;
+    }
+
+    return { open: open };
+})();
@@ -11,10 +11,20 @@
  *   POST /api/mc/replay   - Start single replay, return { jobId } for polling
  *   POST /api/mc/doe      - Start DOE parameter sweep (multiple arena configs)
  *   GET  /api/mc/jobs/:id - Poll job status/progress/results
+ *   DELETE /api/mc/jobs/:id - Cancel a running batch or replay; the job
+ *                           keeps its last aggregate snapshot
+ *   GET  /api/mc/archives/:id - Replay trajectory archive (.traj), honours
+ *                           Range requests (js/trajectory_archive.js)
  *   GET  /api/mc/status   - Check if mc_engine binary exists and server is ready
  *
  * The browser polls GET /api/mc/jobs/:id every 500ms to get real-time progress
- * from the C++ engine's --progress JSON-Lines output.
+ * from the C++ engine's --progress JSON-Lines output. While a batch runs,
+ * job polls also carry `snapshot`: the engine's aggregate snapshot lines
+ * (survival with Wilson intervals, weapons and kill matrices, a
+ * simTimeFinal histogram) merged into one cumulative object, so the
+ * dashboard can show estimates before the results file exists. A replay posted with
+ * { archive: true } also keeps a time-indexed trajectory archive until the
+ * job is cleaned up; its results carry archiveUrl.
  *
  * Usage:
  *   node mc_server.js [port]
@@ -74,8 +84,48 @@ function jsonResponse(res, code, data) {
 
 function corsHeaders(res) {
     res.setHeader('Access-Control-Allow-Origin', '*');
-    res.setHeader('Access-Control-Allow-Methods', 'GET, POST, OPTIONS');
-    res.setHeader('Access-Control-Allow-Headers', 'Content-Type');
+    res.setHeader('Access-Control-Allow-Methods', 'GET, HEAD, POST, DELETE, OPTIONS');
+    res.setHeader('Access-Control-Allow-Headers', 'Content-Type, Range');
+    res.setHeader('Access-Control-Expose-Headers', 'Content-Range, Content-Length, Accept-Ranges');
+}
+
+// Serve a file, or the single byte range a Range header asks for
+function serveFileRange(req, res, file, contentType) {
+    let size;
+    try {
+        size = fs.statSync(file).size;
+    } catch {
+        jsonResponse(res, 404, { error: 'File not found' });
+        return;
+    }
+
+    const headers = { 'Content-Type': contentType, 'Accept-Ranges': 'bytes' };
+    let start = 0, end = size - 1, code = 200;
+
+    const range = req.headers.range && req.headers.range.match(/^bytes=(\d*)-(\d*)$/);
+    if (range && (range[1] || range[2])) {
+        if (range[1]) {
+            start = parseInt(range[1], 10);
+            if (range[2]) end = Math.min(parseInt(range[2], 10), size - 1);
+        } else {
+            start = Math.max(0, size - parseInt(range[2], 10));  // Suffix: last N bytes
+        }
+        if (start > end || start >= size) {
+            res.writeHead(416, { 'Content-Range': `bytes */${size}` });
+            res.end();
+            return;
+        }
+        code = 206;
+        headers['Content-Range'] = `bytes ${start}-${end}/${size}`;
+    }
+    headers['Content-Length'] = size === 0 ? 0 : end - start + 1;
+
+    res.writeHead(code, headers);
+    if (req.method === 'HEAD' || size === 0) {
+        res.end();
+        return;
+    }
+    fs.createReadStream(file, { start, end }).pipe(res);
 }
 
 function engineExists() {
@@ -102,6 +152,8 @@ function parseProgressLine(line, job) {
                 total: msg.total,
                 pct: Math.round((msg.run / msg.total) * 100)
             };
+        } else if (msg.type === 'snapshot') {
+            mergeSnapshot(job, msg);
         } else if (msg.type === 'replay_progress') {
             job.progress = {
                 step: msg.step,
@@ -112,12 +164,43 @@ function parseProgressLine(line, job) {
         } else if (msg.type === 'done') {
             job.progress.pct = 100;
             job.progress.elapsed = msg.elapsed;
+            if (msg.outputStalls !== undefined) {
+                // Back-pressure: time the engine waited on the output disk
+                job.progress.outputStalls = msg.outputStalls;
+                job.progress.outputStallSeconds = msg.outputStallSeconds;
+            }
         }
     } catch {
         // Not valid JSON — skip (e.g. [EVENT] lines)
     }
 }
 
+/**
+ * Fold an engine snapshot line (a delta: changed weapons and histogram
+ * bins only, names on first appearance) into job.snapshot.
+ */
+function mergeSnapshot(job, msg) {
+    const snap = job.snapshot || (job.snapshot = {
+        entities: {}, weapons: {}, timeFinal: { bins: [] }
+    });
+    snap.seq = msg.seq;
+    snap.runs = msg.runs;
+    snap.total = msg.total;
+    snap.errors = msg.errors;
+    snap.elapsed = msg.elapsed;
+    for (const [id, e] of Object.entries(msg.entities || {})) {
+        snap.entities[id] = Object.assign(snap.entities[id] || {}, e);
+    }
+    Object.assign(snap.weapons, msg.weapons || {});
+    const t = msg.timeFinal || {};
+    const bins = snap.timeFinal.bins;
+    const changed = t.bins || [];
+    Object.assign(snap.timeFinal, t);
+    for (let i = 0; i + 1 < changed.length; i += 2) bins[changed[i]] = changed[i + 1];
+    for (let i = 0; i < bins.length; i++) if (bins[i] === undefined) bins[i] = 0;
+    snap.timeFinal.bins = bins;
+}
+
 // ── Launch mc_engine as a job ──
 
 function startJob(mode, scenario, opts) {
@@ -134,6 +217,7 @@ function startJob(mode, scenario, opts) {
         args.push('--seed', String(opts.seed !== undefined ? opts.seed : 42));
         args.push('--max-time', String(opts.maxTime || 600));
         args.push('--dt', String(opts.dt || 0.1));
+        args.push('--snapshot-interval', '1');
     } else {
         args.push('--replay');
         args.push('--seed', String(opts.seed !== undefined ? opts.seed : 42));
@@ -142,16 +226,21 @@ function startJob(mode, scenario, opts) {
         args.push('--sample-interval', String(opts.sampleInterval || 2));
     }
 
+    const archiveFile = mode === 'replay' && opts.archive ? tempFile('mc_replay', '.traj') : null;
+    if (archiveFile) args.push('--archive', archiveFile);
+
     const job = {
         id: jobId,
         mode: mode,
         status: 'running',
         progress: { pct: 0 },
+        snapshot: null,
         results: null,
         error: null,
         startTime: Date.now(),
         scenarioFile: scenarioFile,
-        outputFile: outputFile
+        outputFile: outputFile,
+        archiveFile: archiveFile
     };
 
     jobs.set(jobId, job);
@@ -160,6 +249,7 @@ function startJob(mode, scenario, opts) {
         cwd: path.dirname(MC_ENGINE),
         timeout: mode === 'batch' ? 300000 : 60000
     });
+    job.proc = proc;
 
     let stderrBuf = '';
 
@@ -185,11 +275,17 @@ function startJob(mode, scenario, opts) {
 
         // Clean up scenario temp file
         try { fs.unlinkSync(scenarioFile); } catch {}
+        job.proc = null;
 
-        if (code !== 0) {
+        if (job.status === 'cancelled') {
+            try { fs.unlinkSync(outputFile); } catch {}
+            if (archiveFile) try { fs.unlinkSync(archiveFile); } catch {}
+            console.log(`[MC] Job ${jobId} cancelled after ${elapsed.toFixed(2)}s`);
+        } else if (code !== 0) {
             job.status = 'failed';
             job.error = `mc_engine exited with code ${code}`;
             try { fs.unlinkSync(outputFile); } catch {}
+            if (archiveFile) try { fs.unlinkSync(archiveFile); } catch {}
             console.log(`[MC] Job ${jobId} failed (code ${code})`);
         } else {
             try {
@@ -197,6 +293,9 @@ function startJob(mode, scenario, opts) {
                 fs.unlinkSync(outputFile);
                 data._serverMeta = { elapsed, engine: 'c++', mode: mode };
                 if (mode === 'batch') data._serverMeta.runs = opts.runs;
+                if (archiveFile && fs.existsSync(archiveFile)) {
+                    data.archiveUrl = '/api/mc/archives/' + jobId;
+                }
                 job.results = data;
                 job.status = 'complete';
                 job.progress.pct = 100;
@@ -210,7 +309,10 @@ function startJob(mode, scenario, opts) {
         }
 
         // Schedule cleanup
-        setTimeout(() => { jobs.delete(jobId); }, JOB_CLEANUP_MS);
+        setTimeout(() => {
+            jobs.delete(jobId);
+            if (archiveFile) try { fs.unlinkSync(archiveFile); } catch {}
+        }, JOB_CLEANUP_MS);
     });
 
     proc.on('error', (err) => {
@@ -575,6 +677,7 @@ const server = http.createServer(async (req, res) => {
                 progress: job.progress,
                 elapsed: (Date.now() - job.startTime) / 1000
             };
+            if (job.snapshot) response.snapshot = job.snapshot;
 
             if (job.status === 'complete') {
                 response.results = job.results;
@@ -586,6 +689,36 @@ const server = http.createServer(async (req, res) => {
             return;
         }
 
+        // DELETE /api/mc/jobs/:id
+        const cancelMatch = req.method === 'DELETE' &&
+            req.url.match(/^\/api\/mc\/jobs\/([a-zA-Z0-9_]+)$/);
+        if (cancelMatch) {
+            const job = jobs.get(cancelMatch[1]);
+            if (!job) {
+                jsonResponse(res, 404, { error: 'Job not found: ' + cancelMatch[1] });
+                return;
+            }
+            if (job.status === 'running') {
+                job.status = 'cancelled';
+                if (job.proc) job.proc.kill('SIGTERM');
+            }
+            jsonResponse(res, 200, { jobId: job.id, status: job.status, snapshot: job.snapshot });
+            return;
+        }
+
+        // GET|HEAD /api/mc/archives/:id
+        const archiveMatch = (req.method === 'GET' || req.method === 'HEAD') &&
+            req.url.match(/^\/api\/mc\/archives\/([a-zA-Z0-9_]+)$/);
+        if (archiveMatch) {
+            const job = jobs.get(archiveMatch[1]);
+            if (!job || !job.archiveFile || job.status !== 'complete') {
+                jsonResponse(res, 404, { error: 'Archive not found: ' + archiveMatch[1] });
+                return;
+            }
+            serveFileRange(req, res, job.archiveFile, 'application/octet-stream');
+            return;
+        }
+
         // POST /api/mc/batch
         if (req.method === 'POST' && req.url === '/api/mc/batch') {
             if (!engineExists()) {
@@ -672,7 +805,8 @@ const server = http.createServer(async (req, res) => {
                 seed: payload.seed !== undefined ? payload.seed : 42,
                 maxTime: payload.maxTime || 600,
                 dt: payload.dt || 0.1,
-                sampleInterval: payload.sampleInterval || 2
+                sampleInterval: payload.sampleInterval || 2,
+                archive: !!payload.archive
             };
 
             const jobId = startJob('replay', scenario, opts);
@@ -698,5 +832,7 @@ server.listen(PORT, () => {
     console.log('  POST /api/mc/replay      — Start replay gen (returns jobId)');
     console.log('  POST /api/mc/doe         — Start DOE parameter sweep (returns jobId)');
     console.log('  GET  /api/mc/jobs/:id    — Poll job progress/results');
+    console.log('  DELETE /api/mc/jobs/:id  — Cancel a job');
+    console.log('  GET  /api/mc/archives/:id — Replay trajectory archive (Range requests)');
     console.log('  GET  /api/mc/status      — Check engine availability');
 });